@@ -47,6 +47,12 @@ class ServiceData {
       folly::StringPiece key,
       int64_t value,
       stats::ExportType exportType) {}
+  bool addHistogram(folly::StringPiece, int64_t, int64_t, int64_t) {
+    return true;
+  }
+  template <typename... Percentiles>
+  void exportHistogramPercentile(folly::StringPiece, Percentiles...) {}
+  void addHistogramValue(folly::StringPiece, int64_t) {}
 
  private:
   DynamicCounters counters_;
@@ -2,52 +2,273 @@
 #pragma once
 
 #include <chrono>
+#include <memory>
+#include <mutex>
+#include <unordered_set>
 #include <folly/Range.h>
+#include <folly/SpinLock.h>
 #include <folly/Synchronized.h>
+#include <folly/stats/Histogram.h>
+#include <folly/stats/MultiLevelTimeSeries.h>
 #include <folly/stats/TimeseriesHistogram.h>
+#include <glog/logging.h>
 
 #include "common/stats/ExportType.h"
 
 namespace facebook { namespace stats {
 
-class TLStatsThreadSafe {};
+/*
+ * LockTraits for ThreadLocalStatsT.
+ *
+ * With TLStatsNoLocking, aggregate() must run on the same thread that updates
+ * the stats.  TLStatsThreadSafe lets another thread, like a stats publishing
+ * thread, call aggregate() while the owner keeps updating them.  The owner
+ * then takes an uncontended spinlock per update, only ever contended for the
+ * moment aggregate() swaps out that stat's pending values.
+ */
+class TLStatsNoLocking {
+ public:
+  struct LockType {
+    void lock() {}
+    void unlock() {}
+  };
+};
 
+class TLStatsThreadSafe {
+ public:
+  using LockType = folly::SpinLock;
+};
+
+/*
+ * ThreadLocalStatsT is meant to be owned by the one thread that updates its
+ * stats.  Updates only touch that thread's copy of each stat, and
+ * aggregate() folds what was added since the last call into the stat's
+ * timeseries, where it can be read.
+ */
 template <class LockTraits>
 class ThreadLocalStatsT {
  public:
-  // TODO: This stub implementation just uses folly::Synchronized, and is not
-  // actually thread-local for now.
-  class TLHistogram {
+  using LockType = typename LockTraits::LockType;
+  using Duration = folly::TimeseriesHistogram<int64_t>::Duration;
+  using TimePoint = folly::TimeseriesHistogram<int64_t>::TimePoint;
+
+  class TLStat {
    public:
-     template <typename... ExportArgs>
-     TLHistogram(ThreadLocalStatsT *container, folly::StringPiece name,
-                 size_t bucketWidth, int64_t minValue, int64_t maxValue,
-                 ExportArgs... exports)
-         : histogram_(
-               folly::in_place, bucketWidth, minValue, maxValue,
-               folly::MultiLevelTimeSeries<int64_t>{
-                   /* num buckets */ 60,
-                   {
-                       std::chrono::seconds{60}, std::chrono::seconds{600},
-                       std::chrono::seconds{3600}, std::chrono::seconds{0},
-                   }}) {
-       // We don't handle setting up exports for now.
+    explicit TLStat(ThreadLocalStatsT* container, folly::StringPiece name)
+        : container_(container), name_(name.str()) {
+      container_->registerStat(this);
+    }
+    virtual ~TLStat() {
+      unregister();
+    }
+
+    const std::string& name() const {
+      return name_;
+    }
+
+    virtual void aggregate(TimePoint now) = 0;
+
+   protected:
+    // Derived stats call this first thing in their destructor, so a
+    // concurrent aggregate() never sees a partly destroyed stat.
+    void unregister() {
+      container_->unregisterStat(this);
+    }
+
+    LockType lock_;
+
+   private:
+    TLStat(const TLStat&) = delete;
+    TLStat& operator=(const TLStat&) = delete;
+
+    ThreadLocalStatsT* const container_;
+    const std::string name_;
+  };
+
+  class TLTimeseries : public TLStat {
+   public:
+    template <typename... ExportArgs>
+    TLTimeseries(ThreadLocalStatsT* container, folly::StringPiece name,
+                 ExportArgs... /*exports*/)
+        : TLStat(container, name),
+          timeseries_(folly::in_place, defaultLevels()) {
+      // We don't handle setting up exports for now.
+    }
+    ~TLTimeseries() override {
+      this->unregister();
     }
 
     void addValue(int64_t value) {
-      // The default TimeseriesHistogram clock does not implement now;
-      // set the time using steady_clock here.
-      auto now = std::chrono::duration_cast<
-          folly::TimeseriesHistogram<int64_t>::Duration>(
-          std::chrono::steady_clock::now().time_since_epoch());
-      histogram_->addValue(now, value);
+      std::lock_guard<LockType> g(this->lock_);
+      sum_ += value;
+      ++count_;
+    }
+    void addValueAggregated(int64_t sum, int64_t count) {
+      std::lock_guard<LockType> g(this->lock_);
+      sum_ += sum;
+      count_ += count;
     }
 
-  private:
-    folly::Synchronized<folly::TimeseriesHistogram<int64_t>> histogram_;
+    void aggregate(TimePoint now) override {
+      int64_t sum;
+      int64_t count;
+      {
+        std::lock_guard<LockType> g(this->lock_);
+        sum = sum_;
+        count = count_;
+        sum_ = 0;
+        count_ = 0;
+      }
+      auto timeseries = timeseries_.wlock();
+      if (count > 0) {
+        timeseries->addValueAggregated(now, sum, count);
+      }
+      timeseries->update(now);
+    }
+
+    // Values as of the last aggregate()
+    int64_t sum(size_t level) const {
+      return timeseries_.rlock()->sum(level);
+    }
+    int64_t count(size_t level) const {
+      return timeseries_.rlock()->count(level);
+    }
+
+   private:
+    int64_t sum_{0};
+    int64_t count_{0};
+    folly::Synchronized<folly::MultiLevelTimeSeries<int64_t>> timeseries_;
+  };
+
+  /*
+   * The timeseries behind a TLHistogram, buckets times levels times 60
+   * slots, is only allocated once the histogram first gets a value, and is
+   * freed again once the histogram has been idle for longer than its longest
+   * finite level.  Most per port or per queue histograms never see a value.
+   */
+  class TLHistogram : public TLStat {
+   public:
+    template <typename... ExportArgs>
+    TLHistogram(ThreadLocalStatsT* container, folly::StringPiece name,
+                size_t bucketWidth, int64_t minValue, int64_t maxValue,
+                ExportArgs... /*exports*/)
+        : TLStat(container, name),
+          pending_(bucketWidth, minValue, maxValue) {
+      // We don't handle setting up exports for now.
+    }
+    ~TLHistogram() override {
+      this->unregister();
+    }
+
+    void addValue(int64_t value) {
+      std::lock_guard<LockType> g(this->lock_);
+      pending_.addValue(value);
+      ++pendingCount_;
+    }
+    void addRepeatedValue(int64_t value, int64_t nsamples) {
+      std::lock_guard<LockType> g(this->lock_);
+      pending_.addRepeatedValue(value, nsamples);
+      pendingCount_ += nsamples;
+    }
+
+    void aggregate(TimePoint now) override {
+      // The longest finite level of defaultLevels()
+      constexpr std::chrono::seconds kIdleTimeout{3600};
+
+      bool hasValues;
+      {
+        std::lock_guard<LockType> g(this->lock_);
+        hasValues = pendingCount_ > 0;
+      }
+      auto histogram = histogram_.wlock();
+      if (hasValues) {
+        folly::Histogram<int64_t> values(
+            pending_.getBucketSize(), pending_.getMin(), pending_.getMax());
+        {
+          std::lock_guard<LockType> g(this->lock_);
+          std::swap(values, pending_);
+          pendingCount_ = 0;
+        }
+        if (!*histogram) {
+          *histogram = std::make_unique<folly::TimeseriesHistogram<int64_t>>(
+              values.getBucketSize(), values.getMin(), values.getMax(),
+              defaultLevels());
+        }
+        (*histogram)->addValues(now, values);
+        lastValue_ = now;
+      } else if (!*histogram) {
+        return;
+      }
+      (*histogram)->update(now);
+      if (now - lastValue_ > kIdleTimeout) {
+        // Every finite level is empty by now; only the all-time level,
+        // which starts over, is lost
+        histogram->reset();
+      }
+    }
+
+    // Values as of the last aggregate()
+    int64_t count(size_t level) const {
+      auto histogram = histogram_.rlock();
+      return *histogram ? (*histogram)->count(level) : 0;
+    }
+    int64_t getPercentileEstimate(double pct, size_t level) const {
+      auto histogram = histogram_.rlock();
+      return *histogram ? (*histogram)->getPercentileEstimate(pct, level) : 0;
+    }
+
+   private:
+    // Values added since the last aggregate()
+    folly::Histogram<int64_t> pending_;
+    int64_t pendingCount_{0};
+    folly::Synchronized<std::unique_ptr<folly::TimeseriesHistogram<int64_t>>>
+        histogram_;
+    // Only accessed by aggregate(), under histogram_'s lock
+    TimePoint lastValue_;
   };
 
-  void aggregate() {}
+  ThreadLocalStatsT() {}
+  ~ThreadLocalStatsT() {
+    // Every stat must be destroyed before the container it registered with
+    DCHECK(stats_.empty());
+  }
+
+  void aggregate() {
+    // The default TimeseriesHistogram clock does not implement now;
+    // set the time using steady_clock here.
+    auto now = TimePoint(std::chrono::duration_cast<Duration>(
+        std::chrono::steady_clock::now().time_since_epoch()));
+    std::lock_guard<LockType> g(lock_);
+    for (auto* stat : stats_) {
+      stat->aggregate(now);
+    }
+  }
+
+ private:
+  ThreadLocalStatsT(const ThreadLocalStatsT&) = delete;
+  ThreadLocalStatsT& operator=(const ThreadLocalStatsT&) = delete;
+
+  static folly::MultiLevelTimeSeries<int64_t> defaultLevels() {
+    return folly::MultiLevelTimeSeries<int64_t>{
+        /* num buckets */ 60,
+        {
+            std::chrono::seconds{60}, std::chrono::seconds{600},
+            std::chrono::seconds{3600}, std::chrono::seconds{0},
+        }};
+  }
+
+  void registerStat(TLStat* stat) {
+    std::lock_guard<LockType> g(lock_);
+    stats_.insert(stat);
+  }
+  void unregisterStat(TLStat* stat) {
+    std::lock_guard<LockType> g(lock_);
+    stats_.erase(stat);
+  }
+
+  // Protects stats_, which aggregate() may walk from another thread
+  LockType lock_;
+  std::unordered_set<TLStat*> stats_;
 };
 
 } // stats
@@ -9,6 +9,7 @@
  */
 #include "fboss/agent/AgentConfig.h"
 
+#include "fboss/agent/CompiledConfigCache.h"
 #include "fboss/agent/FbossError.h"
 
 #include <folly/FileUtil.h>
@@ -17,6 +18,7 @@
 #include <iostream>
 
 DEFINE_string(config, "", "The path to the local JSON configuration file");
+DECLARE_string(config_cache_dir);
 
 // NOTE: we use std::cerr because logging libs are likely not
 // initialized yet...
@@ -40,6 +42,16 @@ std::unique_ptr<AgentConfig> AgentConfig::fromFile(folly::StringPiece path) {
 
 std::unique_ptr<AgentConfig> AgentConfig::fromRawConfig(
     const std::string& configStr) {
+  std::unique_ptr<CompiledConfigCache> cache;
+  if (!FLAGS_config_cache_dir.empty()) {
+    cache = std::make_unique<CompiledConfigCache>(FLAGS_config_cache_dir);
+    if (auto cached = cache->loadConfig(configStr)) {
+      std::cerr << "Loaded compiled config from " << FLAGS_config_cache_dir
+                << std::endl;
+      return cached;
+    }
+  }
+
   cfg::AgentConfig agentConfig;
 
   apache::thrift::SimpleJSONSerializer::deserialize<cfg::AgentConfig>(
@@ -61,7 +73,17 @@ std::unique_ptr<AgentConfig> AgentConfig::fromRawConfig(
         configStr.c_str(), agentConfig.sw);
   }
 
-  return std::make_unique<AgentConfig>(std::move(agentConfig), configStr);
+  auto config =
+      std::make_unique<AgentConfig>(std::move(agentConfig), configStr);
+  if (cache) {
+    try {
+      cache->storeConfig(*config);
+    } catch (const std::exception& ex) {
+      std::cerr << "Failed to cache compiled config: " << ex.what()
+                << std::endl;
+    }
+  }
+  return config;
 }
 
 const std::string AgentConfig::swConfigRaw() const {
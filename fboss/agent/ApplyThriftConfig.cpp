@@ -10,13 +10,18 @@
 #include "fboss/agent/ApplyThriftConfig.h"
 
 #include <folly/FileUtil.h>
+#include <folly/futures/Future.h>
 #include <folly/gen/Base.h>
+#include <folly/io/async/ScopedEventBaseThread.h>
+#include <folly/logging/xlog.h>
+#include <gflags/gflags.h>
 #include <thrift/lib/cpp2/protocol/Serializer.h>
 
 #include "fboss/agent/FbossError.h"
 #include "fboss/agent/LacpTypes.h"
 #include "fboss/agent/LoadBalancerConfigApplier.h"
 #include "fboss/agent/Platform.h"
+#include "fboss/agent/capture/PktCaptureManager.h"
 #include "fboss/agent/rib/RoutingInformationBase.h"
 #include "fboss/agent/state/AclEntry.h"
 #include "fboss/agent/state/AclMap.h"
@@ -45,9 +50,13 @@
 
 #include <algorithm>
 #include <boost/container/flat_set.hpp>
+#include <chrono>
 #include <boost/container/flat_map.hpp>
 #include <cmath>
 #include <folly/Range.h>
+#include <functional>
+#include <limits>
+#include <memory>
 #include <utility>
 #include <vector>
 
@@ -66,6 +75,13 @@ using folly::CIDRNetwork;
 using std::make_shared;
 using std::shared_ptr;
 
+DEFINE_int32(
+    config_apply_threads,
+    4,
+    "Number of threads to build independent parts of the switch state on "
+    "when applying config. With 1 or less they are built on the calling "
+    "thread.");
+
 namespace {
 
 const uint8_t kV6LinkLocalAddrMask{64};
@@ -76,9 +92,10 @@ void updateFibFromConfig(
     facebook::fboss::RouterID vrf,
     const facebook::fboss::rib::IPv4NetworkToRouteMap& v4NetworkToRoute,
     const facebook::fboss::rib::IPv6NetworkToRouteMap& v6NetworkToRoute,
+    const facebook::fboss::rib::ChangedPrefixes* changedPrefixes,
     void* cookie) {
   facebook::fboss::rib::ForwardingInformationBaseUpdater fibUpdater(
-      vrf, v4NetworkToRoute, v6NetworkToRoute);
+      vrf, v4NetworkToRoute, v6NetworkToRoute, changedPrefixes);
 
   auto nextStatePtr =
       static_cast<std::shared_ptr<facebook::fboss::SwitchState>*>(cookie);
@@ -86,6 +103,41 @@ void updateFibFromConfig(
   fibUpdater(*nextStatePtr);
 }
 
+/*
+ * Run each of fns on one of the config threads and wait for all of them.
+ * The first error is rethrown, as running them one after the other would
+ * have.
+ */
+void runInParallel(const std::vector<std::function<void()>>& fns) {
+  if (FLAGS_config_apply_threads <= 1) {
+    for (const auto& fn : fns) {
+      fn();
+    }
+    return;
+  }
+
+  // Leaked so they are never torn down under a config being applied at exit
+  static auto* threads = [] {
+    auto* ret =
+        new std::vector<std::unique_ptr<folly::ScopedEventBaseThread>>();
+    for (int i = 0; i < FLAGS_config_apply_threads; ++i) {
+      ret->push_back(std::make_unique<folly::ScopedEventBaseThread>(
+          folly::to<std::string>("ConfigApply", i)));
+    }
+    return ret;
+  }();
+
+  std::vector<folly::Future<folly::Unit>> futs;
+  for (size_t i = 0; i < fns.size(); ++i) {
+    const auto& fn = fns[i];
+    futs.push_back(folly::via(
+        (*threads)[i % threads->size()]->getEventBase(), [&fn] { fn(); }));
+  }
+  for (auto& result : folly::collectAll(futs.begin(), futs.end()).get()) {
+    result.value();
+  }
+}
+
 } // anonymous namespace
 
 namespace facebook { namespace fboss {
@@ -118,6 +170,32 @@ class ThriftConfigApplier {
   ThriftConfigApplier(ThriftConfigApplier const &) = delete;
   ThriftConfigApplier& operator=(ThriftConfigApplier const &) = delete;
 
+  // Run one section of the config and log how long it took
+  template <typename Fn>
+  void timeSection(StringPiece name, Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    XLOG(DBG1) << "config section " << name << " applied in "
+               << std::chrono::duration_cast<std::chrono::microseconds>(
+                      std::chrono::steady_clock::now() - start)
+                      .count()
+               << "us";
+  }
+
+  /*
+   * Like timeSection(), but skip the section altogether if the config
+   * fields it is built from, as returned by fields(), are the same as in the
+   * previously applied config.
+   */
+  template <typename Fields, typename Fn>
+  void applySection(StringPiece name, Fields fields, Fn fn) {
+    if (prevCfg_ && fields(*prevCfg_) == fields(*cfg_)) {
+      XLOG(DBG1) << "config section " << name << " unchanged, skipped";
+      return;
+    }
+    timeSection(name, fn);
+  }
+
   template<typename Node, typename NodeMap>
   bool updateMap(NodeMap* map,
                  std::shared_ptr<Node> origNode,
@@ -199,13 +277,17 @@ class ThriftConfigApplier {
   std::shared_ptr<AggregatePort> createAggPort(const cfg::AggregatePort& cfg);
   std::vector<AggregatePort::Subport> getSubportsSorted(
       const cfg::AggregatePort& cfg);
+  folly::Optional<AggregatePort::MicroBfd> getMicroBfd(
+      const cfg::AggregatePort& cfg);
+  BfdPeers getBfdPeers();
   std::pair<folly::MacAddress, uint16_t> getSystemLacpConfig();
   uint8_t computeMinimumLinkCount(const cfg::AggregatePort& cfg);
   std::shared_ptr<VlanMap> updateVlans();
   std::shared_ptr<Vlan> createVlan(const cfg::Vlan* config);
   std::shared_ptr<Vlan> updateVlan(const std::shared_ptr<Vlan>& orig,
                                    const cfg::Vlan* config);
-  std::shared_ptr<AclMap> updateAcls();
+  std::shared_ptr<AclMap> updateAcls(
+      const std::shared_ptr<MirrorMap>& mirrors);
   std::shared_ptr<AclEntry> createAcl(const cfg::AclEntry* config,
       int priority,
       const MatchAction* action = nullptr);
@@ -283,113 +365,216 @@ shared_ptr<SwitchState> ThriftConfigApplier::run() {
   new_ = orig_->clone();
   bool changed = false;
 
-  {
-    auto newControlPlane = updateControlPlane();
-    if (newControlPlane) {
-      new_->resetControlPlane(std::move(newControlPlane));
-      changed = true;
-    }
-  }
-
   processVlanPorts();
 
-  {
-    auto newPorts = updatePorts();
-    if (newPorts) {
-      new_->resetPorts(std::move(newPorts));
-      changed = true;
-    }
+  // These sections only read orig_ and cfg_, so they are built in parallel
+  // and put into new_ once all of them are done.
+  shared_ptr<ControlPlane> newControlPlane;
+  shared_ptr<PortMap> newPorts;
+  shared_ptr<AggregatePortMap> newAggPorts;
+  shared_ptr<QosPolicyMap> newQosPolicies;
+  shared_ptr<InterfaceMap> newIntfs;
+  shared_ptr<SflowCollectorMap> newCollectors;
+  shared_ptr<LoadBalancerMap> newLoadBalancers;
+  runInParallel({
+      [&] {
+        applySection(
+            "controlPlane",
+            [](const cfg::SwitchConfig& c) {
+              return std::tie(
+                  c.cpuQueues,
+                  c.cpuTrafficPolicy,
+                  c.__isset.cpuTrafficPolicy,
+                  c.dataPlaneTrafficPolicy,
+                  c.__isset.dataPlaneTrafficPolicy);
+            },
+            [&] { newControlPlane = updateControlPlane(); });
+      },
+      [&] {
+        applySection(
+            "ports",
+            [](const cfg::SwitchConfig& c) {
+              return std::tie(
+                  c.ports,
+                  c.vlanPorts,
+                  c.defaultPortQueues,
+                  c.dataPlaneTrafficPolicy,
+                  c.__isset.dataPlaneTrafficPolicy);
+            },
+            [&] { newPorts = updatePorts(); });
+      },
+      [&] {
+        applySection(
+            "aggregatePorts",
+            [](const cfg::SwitchConfig& c) {
+              return std::tie(c.aggregatePorts, c.lacp, c.__isset.lacp);
+            },
+            [&] { newAggPorts = updateAggregatePorts(); });
+      },
+      [&] {
+        applySection(
+            "qosPolicies",
+            [](const cfg::SwitchConfig& c) { return std::tie(c.qosPolicies); },
+            [&] { newQosPolicies = updateQosPolicies(); });
+      },
+      [&] {
+        // Always run, as it also populates vlanInterfaces_ and
+        // intfRouteTables_ for the sections below.
+        timeSection("interfaces", [&] { newIntfs = updateInterfaces(); });
+      },
+      [&] {
+        applySection(
+            "sFlowCollectors",
+            [](const cfg::SwitchConfig& c) {
+              return std::tie(c.sFlowCollectors);
+            },
+            [&] { newCollectors = updateSflowCollectors(); });
+      },
+      [&] {
+        applySection(
+            "loadBalancers",
+            [](const cfg::SwitchConfig& c) {
+              return std::tie(c.loadBalancers);
+            },
+            [&] {
+              LoadBalancerConfigApplier loadBalancerConfigApplier(
+                  orig_->getLoadBalancers(),
+                  cfg_->get_loadBalancers(),
+                  platform_);
+              newLoadBalancers =
+                  loadBalancerConfigApplier.updateLoadBalancers();
+            });
+      },
+  });
+
+  if (newControlPlane) {
+    new_->resetControlPlane(std::move(newControlPlane));
+    changed = true;
   }
-
-  {
-    auto newAggPorts = updateAggregatePorts();
-    if (newAggPorts) {
-      new_->resetAggregatePorts(std::move(newAggPorts));
-      changed = true;
-    }
+  if (newPorts) {
+    new_->resetPorts(std::move(newPorts));
+    changed = true;
   }
-
-  // updateMirrors must be called after updatePorts, mirror needs ports!
-  {
-    auto newMirrors = updateMirrors();
-    if (newMirrors) {
-      new_->resetMirrors(std::move(newMirrors));
-      changed = true;
-    }
+  if (newAggPorts) {
+    new_->resetAggregatePorts(std::move(newAggPorts));
+    changed = true;
   }
-
-  // updateAcls must be called after updateMirrors, acls may need mirror!
-  {
-    auto newAcls = updateAcls();
-    if (newAcls) {
-      new_->resetAcls(std::move(newAcls));
-      changed = true;
-    }
+  if (newQosPolicies) {
+    new_->resetQosPolicies(std::move(newQosPolicies));
+    changed = true;
   }
-
-  {
-    auto newQosPolicies = updateQosPolicies();
-    if (newQosPolicies) {
-      new_->resetQosPolicies(std::move(newQosPolicies));
-      changed = true;
-    }
+  if (newIntfs) {
+    new_->resetIntfs(std::move(newIntfs));
+    changed = true;
   }
-
-  {
-    auto newIntfs = updateInterfaces();
-    if (newIntfs) {
-      new_->resetIntfs(std::move(newIntfs));
-      changed = true;
-    }
+  if (newCollectors) {
+    new_->resetSflowCollectors(std::move(newCollectors));
+    changed = true;
+  }
+  if (newLoadBalancers) {
+    new_->resetLoadBalancers(std::move(newLoadBalancers));
+    changed = true;
   }
 
-  // Note: updateInterfaces() must be called before updateVlans(),
-  // as updateInterfaces() populates the vlanInterfaces_ data structure.
-  {
-    auto newVlans = updateVlans();
-    if (newVlans) {
-      new_->resetVlans(std::move(newVlans));
-      changed = true;
-    }
+  // The second round needs the ports above and what updateInterfaces()
+  // collected, and is built in parallel the same way. Mirrors need the new
+  // ports and ACLs need the new mirrors, so those two run one after the
+  // other. Without a RIB the interface and static routes are built here too.
+  shared_ptr<MirrorMap> newMirrors;
+  shared_ptr<AclMap> newAcls;
+  shared_ptr<VlanMap> newVlanMap;
+  shared_ptr<RouteTableMap> newTables;
+  runInParallel({
+      [&] {
+        applySection(
+            "mirrors",
+            [](const cfg::SwitchConfig& c) {
+              return std::tie(c.mirrors, c.ports, c.interfaces);
+            },
+            [&] { newMirrors = updateMirrors(); });
+        applySection(
+            "acls",
+            [](const cfg::SwitchConfig& c) {
+              return std::tie(
+                  c.acls,
+                  c.trafficCounters,
+                  c.mirrors,
+                  c.cpuTrafficPolicy,
+                  c.__isset.cpuTrafficPolicy,
+                  c.dataPlaneTrafficPolicy,
+                  c.__isset.dataPlaneTrafficPolicy);
+            },
+            [&] {
+              newAcls =
+                  updateAcls(newMirrors ? newMirrors : new_->getMirrors());
+            });
+      },
+      [&] {
+        applySection(
+            "vlans",
+            [](const cfg::SwitchConfig& c) {
+              return std::tie(c.vlans, c.vlanPorts, c.interfaces);
+            },
+            [&] { newVlanMap = updateVlans(); });
+      },
+      [&] {
+        if (rib_) {
+          return;
+        }
+        timeSection("routes", [&] {
+          // Note: updateInterfaceRoutes() should be the first call for
+          // updating RouteTable as this will take the RouteTable from orig_
+          // and add Interface routes. Calling this after other RouteTable
+          // updates will result in other routes getting removed during
+          // updateInterfaceRoutes()
+          newTables = updateInterfaceRoutes();
+
+          // Pass the interface routes to syncStaticRoutes so that they
+          // would not be excluded.
+          auto newerTables = syncStaticRoutes(
+              newTables ? newTables : new_->getRouteTables());
+          if (newerTables) {
+            newTables = std::move(newerTables);
+          }
+        });
+      },
+  });
+
+  if (newMirrors) {
+    new_->resetMirrors(std::move(newMirrors));
+    changed = true;
+  }
+  if (newAcls) {
+    new_->resetAcls(std::move(newAcls));
+    changed = true;
+  }
+  if (newVlanMap) {
+    new_->resetVlans(std::move(newVlanMap));
+    changed = true;
+  }
+  if (newTables) {
+    new_->resetRouteTables(std::move(newTables));
+    changed = true;
   }
 
   if (rib_) {
-    auto newFibs = updateForwardingInformationBaseContainers();
-    if (newFibs) {
-      new_->resetForwardingInformationBases(newFibs);
-      changed = true;
-    }
-
-    rib_->reconfigure(
-        intfRouteTables_,
-        cfg_->staticRoutesWithNhops,
-        cfg_->staticRoutesToNull,
-        cfg_->staticRoutesToCPU,
-        &updateFibFromConfig,
-        static_cast<void*>(&new_));
-  } else {
-    // Note: updateInterfaces() must be called before updateInterfaceRoutes(),
-    // as updateInterfaces() populates the intfRouteTables_ data structure.
-    // Also, updateInterfaceRoutes() should be the first call for updating
-    // RouteTable as this will take the RouteTable from orig_ and add Interface
-    // routes. Calling this after other RouteTable updates will result in other
-    // routes getting removed during updateInterfaceRoutes()
-
-    auto newTables = updateInterfaceRoutes();
-    if (newTables) {
-      new_->resetRouteTables(newTables);
-      changed = true;
-    }
+    // The RIB writes the new FIBs straight into new_, so this stays on the
+    // calling thread.
+    timeSection("routes", [&] {
+      auto newFibs = updateForwardingInformationBaseContainers();
+      if (newFibs) {
+        new_->resetForwardingInformationBases(newFibs);
+        changed = true;
+      }
 
-    // Retrieve RouteTableMap from new_ as this will have
-    // all the routes updated until now. Pass this to syncStaticRoutes
-    // so that routes added until now would not be excluded.
-    auto updatedRoutes = new_->getRouteTables();
-    auto newerTables = syncStaticRoutes(updatedRoutes);
-    if (newerTables) {
-      new_->resetRouteTables(std::move(newerTables));
-      changed = true;
-    }
+      rib_->reconfigure(
+          intfRouteTables_,
+          cfg_->staticRoutesWithNhops,
+          cfg_->staticRoutesToNull,
+          cfg_->staticRoutesToCPU,
+          &updateFibFromConfig,
+          static_cast<void*>(&new_));
+    });
   }
 
   auto newVlans = new_->getVlans();
@@ -485,23 +670,10 @@ shared_ptr<SwitchState> ThriftConfigApplier::run() {
     changed = true;
   }
 
-  // Add sFlow collectors
-  {
-    auto newCollectors = updateSflowCollectors();
-    if (newCollectors) {
-      new_->resetSflowCollectors(std::move(newCollectors));
-      changed = true;
-    }
-  }
-
-  {
-    LoadBalancerConfigApplier loadBalancerConfigApplier(
-        orig_->getLoadBalancers(), cfg_->get_loadBalancers(), platform_);
-    auto newLoadBalancers = loadBalancerConfigApplier.updateLoadBalancers();
-    if (newLoadBalancers) {
-      new_->resetLoadBalancers(std::move(newLoadBalancers));
-      changed = true;
-    }
+  auto bfdPeers = getBfdPeers();
+  if (orig_->getBfdPeers() != bfdPeers) {
+    new_->setBfdPeers(std::move(bfdPeers));
+    changed = true;
   }
 
   if (!changed) {
@@ -860,12 +1032,14 @@ shared_ptr<AggregatePort> ThriftConfigApplier::updateAggPort(
   std::tie(cfgSystemID, cfgSystemPriority) = getSystemLacpConfig();
 
   auto cfgMinLinkCount = computeMinimumLinkCount(cfg);
+  auto cfgMicroBfd = getMicroBfd(cfg);
 
   if (origAggPort->getName() == cfg.name &&
       origAggPort->getDescription() == cfg.description &&
       origAggPort->getSystemPriority() == cfgSystemPriority &&
       origAggPort->getSystemID() == cfgSystemID &&
       origAggPort->getMinimumLinkCount() == cfgMinLinkCount &&
+      origAggPort->getMicroBfd() == cfgMicroBfd &&
       std::equal(
           origSubports.begin(), origSubports.end(), cfgSubports.begin())) {
     return nullptr;
@@ -878,6 +1052,7 @@ shared_ptr<AggregatePort> ThriftConfigApplier::updateAggPort(
   newAggPort->setSystemID(cfgSystemID);
   newAggPort->setMinimumLinkCount(cfgMinLinkCount);
   newAggPort->setSubports(folly::range(cfgSubports.begin(), cfgSubports.end()));
+  newAggPort->setMicroBfd(std::move(cfgMicroBfd));
 
   return newAggPort;
 }
@@ -892,7 +1067,7 @@ shared_ptr<AggregatePort> ThriftConfigApplier::createAggPort(
 
   auto cfgMinLinkCount = computeMinimumLinkCount(cfg);
 
-  return AggregatePort::fromSubportRange(
+  auto aggPort = AggregatePort::fromSubportRange(
       AggregatePortID(cfg.key),
       cfg.name,
       cfg.description,
@@ -900,6 +1075,43 @@ shared_ptr<AggregatePort> ThriftConfigApplier::createAggPort(
       cfgSystemID,
       cfgMinLinkCount,
       folly::range(subports.begin(), subports.end()));
+  aggPort->setMicroBfd(getMicroBfd(cfg));
+  return aggPort;
+}
+
+folly::Optional<AggregatePort::MicroBfd> ThriftConfigApplier::getMicroBfd(
+    const cfg::AggregatePort& cfg) {
+  if (!cfg.__isset.microBfd) {
+    return folly::none;
+  }
+  const auto& microBfd = cfg.microBfd_ref().value_unchecked();
+  if (microBfd.intervalMsecs <= 0 || microBfd.detectMultiplier <= 0 ||
+      microBfd.detectMultiplier > std::numeric_limits<uint8_t>::max()) {
+    throw FbossError("Invalid micro-BFD timers for AggregatePort ", cfg.key);
+  }
+  return AggregatePort::MicroBfd(
+      folly::IPAddress(microBfd.peerAddress),
+      std::chrono::milliseconds(microBfd.intervalMsecs),
+      microBfd.detectMultiplier);
+}
+
+BfdPeers ThriftConfigApplier::getBfdPeers() {
+  BfdPeers bfdPeers;
+  for (const auto& peer : cfg_->bfdPeers) {
+    if (peer.intervalMsecs <= 0 || peer.detectMultiplier <= 0 ||
+        peer.detectMultiplier > std::numeric_limits<uint8_t>::max()) {
+      throw FbossError("Invalid BFD timers for ", peer.address);
+    }
+    auto inserted = bfdPeers.emplace(
+        folly::IPAddress(peer.address),
+        BfdPeer(
+            std::chrono::milliseconds(peer.intervalMsecs),
+            peer.detectMultiplier));
+    if (!inserted.second) {
+      throw FbossError("Duplicate BFD peer ", peer.address);
+    }
+  }
+  return bfdPeers;
 }
 
 std::vector<AggregatePort::Subport> ThriftConfigApplier::getSubportsSorted(
@@ -1139,7 +1351,8 @@ shared_ptr<QosPolicy> ThriftConfigApplier::createQosPolicy(
   return make_shared<QosPolicy>(qosPolicy.name, rules);
 }
 
-std::shared_ptr<AclMap> ThriftConfigApplier::updateAcls() {
+std::shared_ptr<AclMap> ThriftConfigApplier::updateAcls(
+    const std::shared_ptr<MirrorMap>& mirrors) {
   AclMap::NodeContainer newAcls;
   bool changed = false;
   int numExistingProcessed = 0;
@@ -1233,11 +1446,11 @@ std::shared_ptr<AclMap> ThriftConfigApplier::updateAcls() {
         const auto& inMirror = acl->getAclAction().value().getIngressMirror();
         const auto& egMirror = acl->getAclAction().value().getIngressMirror();
         if (inMirror.hasValue() &&
-            !new_->getMirrors()->getMirrorIf(inMirror.value())) {
+            !mirrors->getMirrorIf(inMirror.value())) {
           throw FbossError("Mirror ", inMirror.value(), " is undefined");
         }
         if (egMirror.hasValue() &&
-            !new_->getMirrors()->getMirrorIf(egMirror.value())) {
+            !mirrors->getMirrorIf(egMirror.value())) {
           throw FbossError("Mirror ", egMirror.value(), " is undefined");
         }
       }
@@ -1260,6 +1473,15 @@ std::shared_ptr<AclMap> ThriftConfigApplier::updateAcls() {
         addToAcls(cfg_->dataPlaneTrafficPolicy_ref().value_unchecked())) |
         folly::gen::appendTo(newAcls);
   }
+
+  // Dataplane packet captures add ACLs of their own, which stay until the
+  // capture stops
+  for (const auto& acl : *orig_->getAcls()) {
+    if (PktCaptureManager::isDataplaneCaptureEntry(acl->getID())) {
+      updateMap(&newAcls, acl, std::shared_ptr<AclEntry>());
+      ++numExistingProcessed;
+    }
+  }
   if (numExistingProcessed != orig_->getAcls()->size()) {
     // Some existing ACLs were removed.
     changed = true;
@@ -1949,6 +2171,13 @@ std::shared_ptr<MirrorMap> ThriftConfigApplier::updateMirrors() {
     }
     changed |= updateMap(&newMirrors, origMirror, newMirror);
   }
+  // Dataplane packet captures add mirrors too
+  for (const auto& mirror : *origMirrors) {
+    if (PktCaptureManager::isDataplaneCaptureEntry(mirror->getID())) {
+      updateMap(&newMirrors, mirror, std::shared_ptr<Mirror>());
+      ++numExistingProcessed;
+    }
+  }
 
   if (numExistingProcessed != origMirrors->size()) {
     // Some existing Mirrors were removed.
@@ -2102,14 +2331,7 @@ shared_ptr<SwitchState> applyThriftConfig(
     const Platform* platform,
     rib::RoutingInformationBase* rib,
     const cfg::SwitchConfig* prevConfig) {
-  cfg::SwitchConfig emptyConfig;
-  return ThriftConfigApplier(
-             state,
-             config,
-             platform,
-             rib,
-             prevConfig ? prevConfig : &emptyConfig)
-      .run();
+  return ThriftConfigApplier(state, config, platform, rib, prevConfig).run();
 }
 
 std::pair<std::shared_ptr<SwitchState>, std::string> applyThriftConfigFile(
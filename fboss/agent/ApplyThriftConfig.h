@@ -31,6 +31,13 @@ class SwitchState;
  *
  * Returns a new SwitchState object with the resulting state, or null if
  * the config file results in no changes.
+ *
+ * If prevConfig is the config state was last built from, sections of config
+ * that are the same as in prevConfig (ports, ACLs, ...) are skipped instead
+ * of being rebuilt and compared node by node.
+ *
+ * Sections that do not depend on each other are built in parallel on
+ * --config_apply_threads threads.
  */
 std::shared_ptr<SwitchState> applyThriftConfig(
     const std::shared_ptr<SwitchState>& state,
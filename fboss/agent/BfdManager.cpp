@@ -0,0 +1,437 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/BfdManager.h"
+
+#include "fboss/agent/FbossError.h"
+#include "fboss/agent/NeighborUpdater.h"
+#include "fboss/agent/SwSwitch.h"
+#include "fboss/agent/TxPacket.h"
+#include "fboss/agent/UDPHeader.h"
+#include "fboss/agent/packet/EthHdr.h"
+#include "fboss/agent/packet/Ethertype.h"
+#include "fboss/agent/packet/IPProto.h"
+#include "fboss/agent/packet/IPv4Hdr.h"
+#include "fboss/agent/packet/IPv6Hdr.h"
+#include "fboss/agent/state/Interface.h"
+#include "fboss/agent/state/InterfaceMap.h"
+#include "fboss/agent/state/StateDelta.h"
+
+#include <folly/ExceptionString.h>
+#include <folly/Random.h>
+#include <folly/logging/xlog.h>
+
+#include <algorithm>
+
+using folly::io::RWPrivateCursor;
+using std::chrono::duration_cast;
+using std::chrono::microseconds;
+using std::chrono::milliseconds;
+
+namespace {
+// Timers are rounded up to this, well within the detection times in use
+constexpr milliseconds kWheelTick(5);
+
+// RFC 5881 section 4: single hop BFD is sent and received with a TTL of 255
+constexpr uint8_t kTtl = 255;
+// ... from a source port in the dynamic range
+constexpr uint16_t kMinSrcPort = 49152;
+constexpr uint16_t kSrcPortRange = 16384;
+} // namespace
+
+namespace facebook {
+namespace fboss {
+
+class BfdManager::Session : public folly::HHWheelTimer::Callback {
+ public:
+  Session(
+      BfdManager* manager,
+      const folly::IPAddress& peer,
+      const BfdPeer& config,
+      uint32_t discriminator)
+      : manager_(manager),
+        peer_(peer),
+        config_(config),
+        session_(
+            discriminator,
+            duration_cast<microseconds>(config.interval),
+            config.detectMultiplier) {}
+
+  void received(const BfdControlPacket& packet) {
+    auto now = BfdSession::Clock::now();
+    auto changed = session_.received(packet, now);
+    if (changed) {
+      stateChanged();
+    }
+    // Answer a Poll, and tell the peer of a new state, without waiting
+    if (changed || session_.finalPending()) {
+      manager_->queueTransmit(this);
+    } else {
+      schedule(now);
+    }
+  }
+
+  BfdControlPacket nextPacket() {
+    return session_.nextPacket();
+  }
+
+  void transmitted(BfdSession::Clock::time_point now) {
+    transmitQueued = false;
+    // RFC 5880 section 6.8.7: each interval is cut by up to a quarter, and
+    // by at least a tenth with a detect multiplier of one
+    auto percent =
+        folly::Random::rand32(75, config_.detectMultiplier == 1 ? 90 : 100);
+    nextTransmit_ = now + session_.txInterval() * percent / 100;
+    schedule(now);
+  }
+
+  const folly::IPAddress& getPeer() const {
+    return peer_;
+  }
+
+  const BfdPeer& getConfig() const {
+    return config_;
+  }
+
+  // The vlan the neighbor is held down on, if it is
+  const folly::Optional<VlanID>& getHeldVlan() const {
+    return heldVlan_;
+  }
+
+  bool transmitQueued{false};
+
+ private:
+  void timeoutExpired() noexcept override {
+    auto now = BfdSession::Clock::now();
+    if (session_.checkDetectionTime(now)) {
+      stateChanged();
+    }
+    if (now >= nextTransmit_) {
+      manager_->queueTransmit(this);
+    } else {
+      schedule(now);
+    }
+  }
+
+  void schedule(BfdSession::Clock::time_point now) {
+    if (transmitQueued) {
+      // transmitted() schedules again
+      return;
+    }
+    auto next = nextTransmit_;
+    auto deadline = session_.detectionDeadline();
+    if (deadline) {
+      next = std::min(next, *deadline);
+    }
+    auto wait = next > now ? duration_cast<milliseconds>(next - now)
+                           : milliseconds(0);
+    manager_->wheel_->scheduleTimeout(this, wait);
+  }
+
+  void stateChanged() {
+    auto up = session_.getState() == BfdSession::State::UP;
+    XLOG(DBG2) << "BFD session with " << peer_ << " is now "
+               << static_cast<int>(session_.getState());
+    if (up) {
+      wasUp_ = true;
+      if (heldVlan_) {
+        manager_->release(peer_, *heldVlan_);
+        heldVlan_.clear();
+      }
+    } else if (wasUp_ && !heldVlan_) {
+      XLOG(WARNING) << "BFD session with " << peer_ << " went down";
+      heldVlan_ = manager_->holdDown(peer_);
+    }
+  }
+
+  BfdManager* manager_{nullptr};
+  const folly::IPAddress peer_;
+  const BfdPeer config_;
+  BfdSession session_;
+  BfdSession::Clock::time_point nextTransmit_;
+  bool wasUp_{false};
+  folly::Optional<VlanID> heldVlan_;
+};
+
+BfdManager::BfdManager(SwSwitch* sw)
+    : AutoRegisterStateObserver(sw, "BfdManager"),
+      sw_(sw),
+      thread_("Bfd") {
+  thread_.getEventBase()->runInEventBaseThreadAndWait([this] {
+    wheel_ = folly::HHWheelTimer::newTimer(thread_.getEventBase(), kWheelTick);
+  });
+}
+
+BfdManager::~BfdManager() {
+  thread_.getEventBase()->runInEventBaseThreadAndWait([this] {
+    cancelLoopCallback();
+    pendingTransmits_.clear();
+    sessions_.clear();
+    wheel_.reset();
+  });
+}
+
+void BfdManager::stateUpdated(const StateDelta& delta) {
+  if (delta.oldState()->getBfdPeers() == delta.newState()->getBfdPeers()) {
+    return;
+  }
+  auto peers = delta.newState()->getBfdPeers();
+  thread_.getEventBase()->runInEventBaseThread(
+      [this, peers = std::move(peers)]() mutable {
+        updateSessions(std::move(peers));
+      });
+}
+
+void BfdManager::updateSessions(BfdPeers peers) {
+  std::vector<folly::IPAddress> removed;
+  for (const auto& session : sessions_) {
+    auto peer = peers.find(session.first);
+    if (peer == peers.end() || peer->second != session.second->getConfig()) {
+      removed.push_back(session.first);
+    } else {
+      peers.erase(peer);
+    }
+  }
+  for (const auto& peer : removed) {
+    removeSession(peer);
+  }
+
+  for (const auto& peer : peers) {
+    auto discriminator = nextDiscriminator_++;
+    if (nextDiscriminator_ == 0) {
+      nextDiscriminator_ = 1;
+    }
+    auto session =
+        std::make_unique<Session>(this, peer.first, peer.second, discriminator);
+    queueTransmit(session.get());
+    sessions_.emplace(peer.first, std::move(session));
+  }
+}
+
+void BfdManager::removeSession(const folly::IPAddress& peer) {
+  auto it = sessions_.find(peer);
+  if (it == sessions_.end()) {
+    return;
+  }
+  auto* session = it->second.get();
+  pendingTransmits_.erase(
+      std::remove(pendingTransmits_.begin(), pendingTransmits_.end(), session),
+      pendingTransmits_.end());
+  if (session->getHeldVlan()) {
+    release(peer, *session->getHeldVlan());
+  }
+  sessions_.erase(it);
+}
+
+void BfdManager::handlePacket(
+    const folly::IPAddress& src,
+    uint8_t ttl,
+    folly::io::Cursor cursor) {
+  if (ttl != kTtl) {
+    XLOG(DBG3) << "Dropping BFD packet from " << src << " with TTL "
+               << static_cast<int>(ttl);
+    return;
+  }
+
+  BfdControlPacket packet;
+  try {
+    packet = BfdControlPacket::from(&cursor);
+  } catch (const std::exception& ex) {
+    XLOG(DBG3) << "Dropping malformed BFD packet from " << src << ": "
+               << folly::exceptionStr(ex);
+    return;
+  }
+  if (!packet.isValid()) {
+    XLOG(DBG3) << "Dropping invalid BFD packet from " << src << ": "
+               << packet.describe();
+    return;
+  }
+
+  thread_.getEventBase()->runInEventBaseThread(
+      [this, src, packet] { received(src, packet); });
+}
+
+void BfdManager::received(
+    const folly::IPAddress& src,
+    const BfdControlPacket& packet) {
+  auto it = sessions_.find(src);
+  if (it == sessions_.end()) {
+    XLOG(DBG3) << "No BFD session with " << src;
+    return;
+  }
+  it->second->received(packet);
+}
+
+void BfdManager::queueTransmit(Session* session) {
+  if (session->transmitQueued) {
+    return;
+  }
+  session->transmitQueued = true;
+  session->cancelTimeout();
+  if (pendingTransmits_.empty()) {
+    thread_.getEventBase()->runInLoop(this, true /* thisIteration */);
+  }
+  pendingTransmits_.push_back(session);
+}
+
+void BfdManager::runLoopCallback() noexcept {
+  auto pending = std::move(pendingTransmits_);
+  pendingTransmits_.clear();
+
+  auto state = sw_->getState();
+  auto now = BfdSession::Clock::now();
+  for (auto* session : pending) {
+    transmit(state, session->getPeer(), session->nextPacket());
+    session->transmitted(now);
+  }
+}
+
+void BfdManager::transmit(
+    const std::shared_ptr<SwitchState>& state,
+    const folly::IPAddress& peer,
+    const BfdControlPacket& packet) {
+  auto intfAddr = state->getInterfaces()->getIntfAddrToReach(RouterID(0), peer);
+  if (!intfAddr.intf) {
+    XLOG(DBG4) << "No interface to reach BFD peer " << peer;
+    return;
+  }
+  auto vlan = intfAddr.intf->getVlanID();
+
+  // Sent to the next hop itself, even while it is held out of forwarding
+  folly::Optional<std::pair<folly::MacAddress, PortDescriptor>> neighbor;
+  try {
+    neighbor = sw_->getNeighborUpdater()->getResolvedNeighbor(vlan, peer);
+  } catch (const FbossError& ex) {
+    XLOG(DBG4) << "Cannot look up BFD peer " << peer << ": "
+               << folly::exceptionStr(ex);
+    return;
+  }
+  if (!neighbor) {
+    XLOG(DBG4) << "BFD peer " << peer << " is not resolved";
+    return;
+  }
+
+  auto pkt = makePacket(
+      sw_,
+      neighbor->first,
+      intfAddr.intf->getMac(),
+      vlan,
+      *intfAddr.addr,
+      peer,
+      BfdControlPacket::UDP_PORT,
+      packet);
+  if (!pkt) {
+    return;
+  }
+  sw_->sendNetworkControlPacketAsync(std::move(pkt), neighbor->second);
+}
+
+folly::Optional<VlanID> BfdManager::holdDown(const folly::IPAddress& peer) {
+  auto state = sw_->getState();
+  auto intfAddr = state->getInterfaces()->getIntfAddrToReach(RouterID(0), peer);
+  if (!intfAddr.intf) {
+    return folly::none;
+  }
+  auto vlan = intfAddr.intf->getVlanID();
+  try {
+    sw_->getNeighborUpdater()->livenessChanged(vlan, peer, false);
+  } catch (const FbossError& ex) {
+    XLOG(ERR) << "Cannot hold down BFD peer " << peer << ": "
+              << folly::exceptionStr(ex);
+    return folly::none;
+  }
+  return vlan;
+}
+
+void BfdManager::release(const folly::IPAddress& peer, VlanID vlan) {
+  try {
+    sw_->getNeighborUpdater()->livenessChanged(vlan, peer, true);
+  } catch (const FbossError& ex) {
+    // The vlan, and its neighbor entries, are gone
+    XLOG(DBG2) << "Cannot release BFD peer " << peer << ": "
+               << folly::exceptionStr(ex);
+  }
+}
+
+std::unique_ptr<TxPacket> BfdManager::makePacket(
+    SwSwitch* sw,
+    folly::MacAddress dstMac,
+    folly::MacAddress srcMac,
+    VlanID vlan,
+    const folly::IPAddress& srcIp,
+    const folly::IPAddress& dstIp,
+    uint16_t dstPort,
+    const BfdControlPacket& packet) {
+  UDPHeader udpHdr(
+      kMinSrcPort + packet.myDiscriminator % kSrcPortRange,
+      dstPort,
+      UDPHeader::size() + BfdControlPacket::LENGTH);
+  auto ipHdrSize = dstIp.isV4() ? IPv4Hdr::minSize() : IPv6Hdr::size();
+  auto pkt = sw->allocatePacket(EthHdr::SIZE + ipHdrSize + udpHdr.length);
+  if (!pkt) {
+    XLOG(DBG4) << "Failed to allocate tx packet for BFD";
+    return nullptr;
+  }
+
+  RWPrivateCursor cursor(pkt->buf());
+  if (dstIp.isV4()) {
+    IPv4Hdr ipHdr(
+        4, // version
+        IPv4Hdr::minSize() / 4, // ihl in 32 bit chunks
+        0, // dscp
+        0, // ecn
+        ipHdrSize + udpHdr.length, // length
+        0, // id
+        false, // Don't fragment
+        false, // More fragments
+        0, // Fragment offset
+        kTtl, // TTL
+        static_cast<uint8_t>(IP_PROTO::IP_PROTO_UDP), // Protocol
+        0, // Checksum
+        srcIp.asV4(), // Source
+        dstIp.asV4() // Destination IP
+    );
+    ipHdr.computeChecksum();
+    TxPacket::writeEthHeader(
+        &cursor,
+        dstMac,
+        srcMac,
+        vlan,
+        static_cast<uint16_t>(ETHERTYPE::ETHERTYPE_IPV4));
+    ipHdr.write(&cursor);
+    udpHdr.write(&cursor);
+    RWPrivateCursor csumCursor(cursor);
+    csumCursor.retreat(2);
+    folly::io::Cursor payloadStart(cursor);
+    packet.to(&cursor);
+    csumCursor.writeBE<uint16_t>(udpHdr.computeChecksum(ipHdr, payloadStart));
+  } else {
+    IPv6Hdr ipHdr(srcIp.asV6(), dstIp.asV6());
+    ipHdr.payloadLength = udpHdr.length;
+    ipHdr.nextHeader = static_cast<uint8_t>(IP_PROTO::IP_PROTO_UDP);
+    ipHdr.hopLimit = kTtl;
+    TxPacket::writeEthHeader(
+        &cursor,
+        dstMac,
+        srcMac,
+        vlan,
+        static_cast<uint16_t>(ETHERTYPE::ETHERTYPE_IPV6));
+    ipHdr.serialize(&cursor);
+    udpHdr.write(&cursor);
+    RWPrivateCursor csumCursor(cursor);
+    csumCursor.retreat(2);
+    folly::io::Cursor payloadStart(cursor);
+    packet.to(&cursor);
+    csumCursor.writeBE<uint16_t>(udpHdr.computeChecksum(ipHdr, payloadStart));
+  }
+  return pkt;
+}
+
+} // namespace fboss
+} // namespace facebook
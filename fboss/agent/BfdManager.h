@@ -0,0 +1,109 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include "fboss/agent/BfdSession.h"
+#include "fboss/agent/StateObserver.h"
+#include "fboss/agent/state/SwitchState.h"
+#include "fboss/agent/types.h"
+
+#include <folly/IPAddress.h>
+#include <folly/MacAddress.h>
+#include <folly/Optional.h>
+#include <folly/io/Cursor.h>
+#include <folly/io/async/EventBase.h>
+#include <folly/io/async/HHWheelTimer.h>
+#include <folly/io/async/ScopedEventBaseThread.h>
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace facebook {
+namespace fboss {
+
+class StateDelta;
+class SwSwitch;
+class TxPacket;
+
+/*
+ * Runs an RFC 5881 single hop BFD session with each configured next hop.
+ * When a session that has been up goes down, the NeighborUpdater holds the
+ * next hop's neighbor entry pending until it comes back up, which takes the
+ * next hop out of every ECMP group in the hardware within the detection time
+ * instead of after routing protocol hold timers.
+ *
+ * A next hop whose session never came up is left alone, so a peer without
+ * BFD configured does not lose its traffic.
+ *
+ * The sessions run on their own thread, on a timer wheel so thousands of
+ * them cost one timer, and the packets of all sessions due in the same loop
+ * iteration are built from one SwitchState snapshot and sent together.
+ */
+class BfdManager : public AutoRegisterStateObserver,
+                   private folly::EventBase::LoopCallback {
+ public:
+  explicit BfdManager(SwSwitch* sw);
+  ~BfdManager() override;
+
+  void stateUpdated(const StateDelta& delta) override;
+
+  // Takes a BFD packet sent to us, with the UDP header read
+  void handlePacket(
+      const folly::IPAddress& src,
+      uint8_t ttl,
+      folly::io::Cursor cursor);
+
+  // A BFD control packet in UDP, as single hop BFD and micro-BFD send it
+  static std::unique_ptr<TxPacket> makePacket(
+      SwSwitch* sw,
+      folly::MacAddress dstMac,
+      folly::MacAddress srcMac,
+      VlanID vlan,
+      const folly::IPAddress& srcIp,
+      const folly::IPAddress& dstIp,
+      uint16_t dstPort,
+      const BfdControlPacket& packet);
+
+ private:
+  class Session;
+
+  void updateSessions(BfdPeers peers);
+  void removeSession(const folly::IPAddress& peer);
+  void received(const folly::IPAddress& src, const BfdControlPacket& packet);
+
+  void queueTransmit(Session* session);
+  void runLoopCallback() noexcept override;
+  void transmit(
+      const std::shared_ptr<SwitchState>& state,
+      const folly::IPAddress& peer,
+      const BfdControlPacket& packet);
+
+  // Returns the vlan the neighbor was held down on
+  folly::Optional<VlanID> holdDown(const folly::IPAddress& peer);
+  void release(const folly::IPAddress& peer, VlanID vlan);
+
+  // Forbidden copy constructor and assignment operator
+  BfdManager(BfdManager const&) = delete;
+  BfdManager& operator=(BfdManager const&) = delete;
+
+  SwSwitch* sw_{nullptr};
+
+  // Only accessed from thread_
+  std::unordered_map<folly::IPAddress, std::unique_ptr<Session>> sessions_;
+  std::vector<Session*> pendingTransmits_;
+  uint32_t nextDiscriminator_{1};
+
+  folly::ScopedEventBaseThread thread_;
+  folly::HHWheelTimer::UniquePtr wheel_;
+};
+
+} // namespace fboss
+} // namespace facebook
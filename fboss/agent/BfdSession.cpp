@@ -0,0 +1,206 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/BfdSession.h"
+
+#include "fboss/agent/FbossError.h"
+
+#include <folly/Conv.h>
+
+#include <algorithm>
+
+namespace {
+// RFC 5880 section 6.8.3: no faster than this while the session is not up
+constexpr std::chrono::microseconds kSlowTxInterval(1000000);
+
+constexpr uint8_t kPoll = 0x20;
+constexpr uint8_t kFinal = 0x10;
+constexpr uint8_t kAuthPresent = 0x04;
+constexpr uint8_t kMultipoint = 0x01;
+} // namespace
+
+namespace facebook {
+namespace fboss {
+
+BfdControlPacket BfdControlPacket::from(folly::io::Cursor* c) {
+  if (!c->canAdvance(LENGTH)) {
+    throw FbossError("BFD control packet shorter than ", LENGTH, " bytes");
+  }
+  BfdControlPacket packet;
+  auto versionAndDiag = c->read<uint8_t>();
+  packet.version = versionAndDiag >> 5;
+  packet.diag = static_cast<Diag>(versionAndDiag & 0x1f);
+  auto stateAndFlags = c->read<uint8_t>();
+  packet.state = static_cast<State>(stateAndFlags >> 6);
+  packet.poll = stateAndFlags & kPoll;
+  packet.final = stateAndFlags & kFinal;
+  packet.authPresent = stateAndFlags & kAuthPresent;
+  packet.multipoint = stateAndFlags & kMultipoint;
+  packet.detectMultiplier = c->read<uint8_t>();
+  packet.length = c->read<uint8_t>();
+  packet.myDiscriminator = c->readBE<uint32_t>();
+  packet.yourDiscriminator = c->readBE<uint32_t>();
+  packet.desiredMinTxInterval =
+      std::chrono::microseconds(c->readBE<uint32_t>());
+  packet.requiredMinRxInterval =
+      std::chrono::microseconds(c->readBE<uint32_t>());
+  packet.requiredMinEchoRxInterval =
+      std::chrono::microseconds(c->readBE<uint32_t>());
+  return packet;
+}
+
+void BfdControlPacket::to(folly::io::RWPrivateCursor* c) const {
+  c->write<uint8_t>((version << 5) | static_cast<uint8_t>(diag));
+  c->write<uint8_t>(
+      (static_cast<uint8_t>(state) << 6) | (poll ? kPoll : 0) |
+      (final ? kFinal : 0) | (authPresent ? kAuthPresent : 0) |
+      (multipoint ? kMultipoint : 0));
+  c->write<uint8_t>(detectMultiplier);
+  c->write<uint8_t>(length);
+  c->writeBE<uint32_t>(myDiscriminator);
+  c->writeBE<uint32_t>(yourDiscriminator);
+  c->writeBE<uint32_t>(desiredMinTxInterval.count());
+  c->writeBE<uint32_t>(requiredMinRxInterval.count());
+  c->writeBE<uint32_t>(requiredMinEchoRxInterval.count());
+}
+
+bool BfdControlPacket::isValid() const {
+  // Authentication is not supported, so a packet asking for it is dropped
+  return version == VERSION && length >= LENGTH && !authPresent &&
+      detectMultiplier != 0 && !multipoint && myDiscriminator != 0 &&
+      (yourDiscriminator != 0 || state == State::DOWN ||
+       state == State::ADMIN_DOWN);
+}
+
+std::string BfdControlPacket::describe() const {
+  return folly::to<std::string>(
+      "state=",
+      static_cast<int>(state),
+      " diag=",
+      static_cast<int>(diag),
+      " poll=",
+      poll,
+      " final=",
+      final,
+      " mult=",
+      detectMultiplier,
+      " myDisc=",
+      myDiscriminator,
+      " yourDisc=",
+      yourDiscriminator,
+      " minTx=",
+      desiredMinTxInterval.count(),
+      "us minRx=",
+      requiredMinRxInterval.count(),
+      "us");
+}
+
+BfdSession::BfdSession(
+    uint32_t localDiscriminator,
+    std::chrono::microseconds interval,
+    uint8_t detectMultiplier)
+    : localDiscriminator_(localDiscriminator),
+      interval_(interval),
+      detectMultiplier_(detectMultiplier) {}
+
+BfdControlPacket BfdSession::nextPacket() {
+  BfdControlPacket packet;
+  packet.diag = diag_;
+  packet.state = state_;
+  // Poll and Final may not go together; the Poll waits for the next packet
+  packet.final = finalPending_;
+  packet.poll = pollPending_ && !finalPending_;
+  packet.detectMultiplier = detectMultiplier_;
+  packet.myDiscriminator = localDiscriminator_;
+  packet.yourDiscriminator = remoteDiscriminator_;
+  packet.desiredMinTxInterval = desiredMinTxInterval();
+  packet.requiredMinRxInterval = interval_;
+  finalPending_ = false;
+  return packet;
+}
+
+bool BfdSession::received(
+    const BfdControlPacket& packet,
+    Clock::time_point now) {
+  if (packet.yourDiscriminator != 0 &&
+      packet.yourDiscriminator != localDiscriminator_) {
+    return false;
+  }
+
+  remoteDiscriminator_ = packet.myDiscriminator;
+  remoteState_ = packet.state;
+  remoteDetectMultiplier_ = packet.detectMultiplier;
+  remoteDesiredMinTxInterval_ = packet.desiredMinTxInterval;
+  remoteMinRxInterval_ = packet.requiredMinRxInterval;
+  lastReceived_ = now;
+  if (packet.final) {
+    pollPending_ = false;
+  }
+  if (packet.poll) {
+    finalPending_ = true;
+  }
+
+  auto oldState = state_;
+  if (remoteState_ == State::ADMIN_DOWN) {
+    if (state_ != State::DOWN) {
+      setState(State::DOWN, Diag::NEIGHBOR_SIGNALED_DOWN);
+    }
+  } else if (state_ == State::DOWN) {
+    if (remoteState_ == State::DOWN) {
+      setState(State::INIT, Diag::NONE);
+    } else if (remoteState_ == State::INIT) {
+      setState(State::UP, Diag::NONE);
+    }
+  } else if (state_ == State::INIT) {
+    if (remoteState_ == State::INIT || remoteState_ == State::UP) {
+      setState(State::UP, Diag::NONE);
+    }
+  } else if (remoteState_ == State::DOWN) {
+    setState(State::DOWN, Diag::NEIGHBOR_SIGNALED_DOWN);
+  }
+  return state_ != oldState;
+}
+
+bool BfdSession::checkDetectionTime(Clock::time_point now) {
+  auto deadline = detectionDeadline();
+  if (!deadline || now < *deadline) {
+    return false;
+  }
+  setState(State::DOWN, Diag::DETECTION_TIME_EXPIRED);
+  remoteDiscriminator_ = 0;
+  return true;
+}
+
+std::chrono::microseconds BfdSession::txInterval() const {
+  return std::max(desiredMinTxInterval(), remoteMinRxInterval_);
+}
+
+folly::Optional<BfdSession::Clock::time_point>
+BfdSession::detectionDeadline() const {
+  if (state_ != State::INIT && state_ != State::UP) {
+    return folly::none;
+  }
+  return lastReceived_ +
+      remoteDetectMultiplier_ *
+      std::max(interval_, remoteDesiredMinTxInterval_);
+}
+
+void BfdSession::setState(State state, Diag diag) {
+  // Going up lowers the interval sent, which a Poll sequence announces
+  pollPending_ = state == State::UP;
+  state_ = state;
+  diag_ = diag;
+}
+
+std::chrono::microseconds BfdSession::desiredMinTxInterval() const {
+  return state_ == State::UP ? interval_ : std::max(interval_, kSlowTxInterval);
+}
+
+} // namespace fboss
+} // namespace facebook
@@ -0,0 +1,140 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include <folly/MacAddress.h>
+#include <folly/Optional.h>
+#include <folly/io/Cursor.h>
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace facebook {
+namespace fboss {
+
+/*
+ * An RFC 5880 BFD control packet without authentication, the UDP payload of
+ * single hop BFD (RFC 5881) and of micro-BFD (RFC 7130).
+ */
+struct BfdControlPacket {
+  enum { LENGTH = 24 };
+  enum : uint8_t { VERSION = 1 };
+  // RFC 7130 gives micro-BFD its own UDP port and destination MAC
+  enum : uint16_t { UDP_PORT = 3784, MICRO_BFD_UDP_PORT = 6784 };
+
+  enum class State : uint8_t { ADMIN_DOWN = 0, DOWN = 1, INIT = 2, UP = 3 };
+  enum class Diag : uint8_t {
+    NONE = 0,
+    DETECTION_TIME_EXPIRED = 1,
+    NEIGHBOR_SIGNALED_DOWN = 3,
+  };
+
+  // Throws FbossError if the cursor runs out
+  static BfdControlPacket from(folly::io::Cursor* c);
+  void to(folly::io::RWPrivateCursor* c) const;
+
+  // The checks of RFC 5880 section 6.8.6 that do not need the session
+  bool isValid() const;
+
+  std::string describe() const;
+
+  static const folly::MacAddress& kMicroBfdDstMac() {
+    static const folly::MacAddress dstMac("01:00:5e:90:00:01");
+    return dstMac;
+  }
+
+  uint8_t version{VERSION};
+  Diag diag{Diag::NONE};
+  State state{State::DOWN};
+  bool poll{false};
+  bool final{false};
+  bool authPresent{false};
+  bool multipoint{false};
+  uint8_t detectMultiplier{0};
+  uint8_t length{LENGTH};
+  uint32_t myDiscriminator{0};
+  uint32_t yourDiscriminator{0};
+  std::chrono::microseconds desiredMinTxInterval{0};
+  std::chrono::microseconds requiredMinRxInterval{0};
+  std::chrono::microseconds requiredMinEchoRxInterval{0};
+};
+
+/*
+ * The asynchronous mode state machine of one BFD session. This only decides
+ * what to send and when the session is up; the caller sends the packets and
+ * runs the timers.
+ *
+ * Until the session is up, packets are sent at most once a second as RFC 5880
+ * asks; once up, they are sent every interval and a Poll sequence tells the
+ * peer of the faster rate.
+ */
+class BfdSession {
+ public:
+  using State = BfdControlPacket::State;
+  using Diag = BfdControlPacket::Diag;
+  using Clock = std::chrono::steady_clock;
+
+  BfdSession(
+      uint32_t localDiscriminator,
+      std::chrono::microseconds interval,
+      uint8_t detectMultiplier);
+
+  // The packet to send now. Sending it answers any Poll received.
+  BfdControlPacket nextPacket();
+
+  // Returns whether the session state changed
+  bool received(const BfdControlPacket& packet, Clock::time_point now);
+
+  // Takes the session down if nothing was received for the detection time.
+  // Returns whether it did.
+  bool checkDetectionTime(Clock::time_point now);
+
+  // How long to wait between packets, before jitter
+  std::chrono::microseconds txInterval() const;
+
+  // When checkDetectionTime() is next due, none while the session is down
+  folly::Optional<Clock::time_point> detectionDeadline() const;
+
+  // Whether a received Poll is still to be answered
+  bool finalPending() const {
+    return finalPending_;
+  }
+
+  State getState() const {
+    return state_;
+  }
+
+  uint32_t getLocalDiscriminator() const {
+    return localDiscriminator_;
+  }
+
+ private:
+  void setState(State state, Diag diag);
+  std::chrono::microseconds desiredMinTxInterval() const;
+
+  const uint32_t localDiscriminator_;
+  const std::chrono::microseconds interval_;
+  const uint8_t detectMultiplier_;
+
+  State state_{State::DOWN};
+  Diag diag_{Diag::NONE};
+  State remoteState_{State::DOWN};
+  uint32_t remoteDiscriminator_{0};
+  uint8_t remoteDetectMultiplier_{0};
+  std::chrono::microseconds remoteDesiredMinTxInterval_{0};
+  std::chrono::microseconds remoteMinRxInterval_{1};
+  Clock::time_point lastReceived_;
+  bool pollPending_{false};
+  bool finalPending_{false};
+};
+
+} // namespace fboss
+} // namespace facebook
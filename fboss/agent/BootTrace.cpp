@@ -0,0 +1,145 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/BootTrace.h"
+
+#include <folly/ExceptionString.h>
+#include <folly/FileUtil.h>
+#include <folly/Synchronized.h>
+#include <folly/dynamic.h>
+#include <folly/json.h>
+#include <folly/logging/xlog.h>
+#include <folly/system/ThreadName.h>
+
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace facebook {
+namespace fboss {
+
+using namespace std::chrono;
+using TimePoint = steady_clock::time_point;
+
+namespace {
+// Bounds the memory used if the FIB never gets synced
+constexpr size_t kMaxEvents = 100000;
+
+struct Event {
+  std::string name;
+  TimePoint begin;
+  steady_clock::duration duration;
+  bool instant;
+  pid_t tid;
+};
+
+struct Trace {
+  std::vector<Event> events;
+  std::map<pid_t, std::string> threadNames;
+};
+
+std::atomic<bool> recording{true};
+
+folly::Synchronized<Trace, std::mutex>& trace() {
+  // Leaked, so spans ending during shutdown still find it
+  static auto trace = new folly::Synchronized<Trace, std::mutex>();
+  return *trace;
+}
+
+void record(
+    folly::StringPiece name,
+    TimePoint begin,
+    steady_clock::duration duration,
+    bool instant) {
+  if (!recording.load(std::memory_order_relaxed)) {
+    return;
+  }
+  auto tid = static_cast<pid_t>(syscall(SYS_gettid));
+  auto locked = trace().lock();
+  if (locked->events.size() >= kMaxEvents) {
+    return;
+  }
+  locked->events.push_back({name.str(), begin, duration, instant, tid});
+  if (locked->threadNames.find(tid) == locked->threadNames.end()) {
+    auto threadName = folly::getCurrentThreadName();
+    locked->threadNames.emplace(
+        tid, threadName ? *threadName : std::to_string(tid));
+  }
+}
+
+int64_t micros(steady_clock::duration duration) {
+  return duration_cast<microseconds>(duration).count();
+}
+} // namespace
+
+namespace boot_trace {
+
+Span::Span(folly::StringPiece name)
+    : name_(name), begin_(steady_clock::now()) {}
+
+Span::~Span() {
+  record(name_, begin_, steady_clock::now() - begin_, false);
+}
+
+void instant(folly::StringPiece name) {
+  record(name, steady_clock::now(), steady_clock::duration(0), true);
+}
+
+void dump(const std::string& path) {
+  if (!recording.exchange(false)) {
+    return;
+  }
+  Trace done;
+  std::swap(done, *trace().lock());
+  if (path.empty()) {
+    return;
+  }
+
+  // Timestamps are from steady_clock, like the restart_time events, so the
+  // timelines of all threads line up
+  auto pid = getpid();
+  folly::dynamic events = folly::dynamic::array;
+  for (const auto& thread : done.threadNames) {
+    events.push_back(folly::dynamic::object("name", "thread_name")("ph", "M")(
+        "pid", pid)("tid", thread.first)(
+        "args", folly::dynamic::object("name", thread.second)));
+  }
+  for (const auto& event : done.events) {
+    auto entry = folly::dynamic::object("name", event.name)("pid", pid)(
+        "tid", event.tid)("ts", micros(event.begin.time_since_epoch()));
+    if (event.instant) {
+      entry["ph"] = "i";
+      entry["s"] = "p";
+    } else {
+      entry["ph"] = "X";
+      entry["dur"] = micros(event.duration);
+    }
+    events.push_back(std::move(entry));
+  }
+
+  try {
+    folly::writeFileAtomic(
+        path,
+        folly::toJson(folly::dynamic::object("traceEvents", std::move(events))(
+            "displayTimeUnit", "ms")));
+    XLOG(INFO) << "Wrote boot trace of " << done.events.size() << " events to "
+               << path;
+  } catch (const std::exception& ex) {
+    XLOG(WARNING) << "Failed to write boot trace to " << path << ": "
+                  << folly::exceptionStr(ex);
+  }
+}
+
+} // namespace boot_trace
+
+} // namespace fboss
+} // namespace facebook
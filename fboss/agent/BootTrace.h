@@ -0,0 +1,54 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include <folly/Range.h>
+
+#include <chrono>
+#include <string>
+
+/**
+ * A timeline of how the agent spends its time coming up, for finding the
+ * critical path of warm and cold boots.
+ *
+ * A Span records how long the scope it lives in took, and on which thread.
+ * The restart_time events are recorded as instants alongside them.  Once the
+ * FIB is synced, dump() writes everything out in the Chrome trace event
+ * format, which chrome://tracing and Perfetto open, and recording stops.
+ */
+
+namespace facebook {
+namespace fboss {
+
+namespace boot_trace {
+
+// The name is not copied until the span ends, so it should be a literal
+class Span {
+ public:
+  explicit Span(folly::StringPiece name);
+  ~Span();
+
+ private:
+  // Forbidden copy constructor and assignment operator
+  Span(Span const&) = delete;
+  Span& operator=(Span const&) = delete;
+
+  const folly::StringPiece name_;
+  const std::chrono::steady_clock::time_point begin_;
+};
+
+void instant(folly::StringPiece name);
+// Write the timeline to path, and stop recording
+void dump(const std::string& path);
+
+} // namespace boot_trace
+
+} // namespace fboss
+} // namespace facebook
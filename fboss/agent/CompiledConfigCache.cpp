@@ -0,0 +1,206 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/CompiledConfigCache.h"
+
+#include "fboss/agent/AgentConfig.h"
+#include "fboss/agent/Utils.h"
+#include "fboss/agent/state/AggregatePortMap.h"
+#include "fboss/agent/state/SwitchState.h"
+
+#include <folly/FileUtil.h>
+#include <folly/hash/SpookyHashV2.h>
+#include <folly/json.h>
+#include <thrift/lib/cpp2/protocol/Serializer.h>
+
+#include <sys/stat.h>
+
+DEFINE_string(
+    config_cache_dir,
+    "",
+    "Directory to cache the parsed config, and the state it gives on a cold "
+    "boot, in. A cold boot with an unchanged config then skips parsing and "
+    "applying it.");
+
+using folly::hash::SpookyHashV2;
+using std::chrono::seconds;
+
+namespace {
+constexpr auto kConfigFile = "agent_config.cache";
+constexpr auto kStateFile = "config_state.cache";
+
+constexpr auto kKey = "key";
+constexpr auto kBootState = "bootState";
+constexpr auto kState = "state";
+
+constexpr auto kAggregatePorts = "aggregatePorts";
+constexpr auto kArpTimeout = "arpTimeout";
+constexpr auto kNdpTimeout = "ndpTimeout";
+constexpr auto kArpAgerInterval = "arpAgerInterval";
+constexpr auto kMaxNeighborProbes = "maxNeighborProbes";
+constexpr auto kStaleEntryInterval = "staleEntryInterval";
+constexpr auto kDhcpV4RelaySrc = "dhcpV4RelaySrc";
+constexpr auto kDhcpV6RelaySrc = "dhcpV6RelaySrc";
+constexpr auto kDhcpV4ReplySrc = "dhcpV4ReplySrc";
+constexpr auto kDhcpV6ReplySrc = "dhcpV6ReplySrc";
+constexpr auto kBfdPeers = "bfdPeers";
+constexpr auto kAddress = "address";
+constexpr auto kIntervalMsecs = "intervalMsecs";
+constexpr auto kDetectMultiplier = "detectMultiplier";
+
+// A new agent binary may parse or apply the same config differently
+uint64_t binaryHash() {
+  struct stat st;
+  if (stat("/proc/self/exe", &st) != 0) {
+    return 0;
+  }
+  uint64_t id[] = {static_cast<uint64_t>(st.st_size),
+                   static_cast<uint64_t>(st.st_mtim.tv_sec),
+                   static_cast<uint64_t>(st.st_mtim.tv_nsec)};
+  return SpookyHashV2::Hash64(id, sizeof(id), 0);
+}
+
+int64_t stateHash(const facebook::fboss::SwitchState& state) {
+  auto json = folly::toJson(state.toFollyDynamic());
+  return SpookyHashV2::Hash64(json.data(), json.size(), 0);
+}
+} // namespace
+
+namespace facebook {
+namespace fboss {
+
+CompiledConfigCache::CompiledConfigCache(const std::string& dir)
+    : configFile_(dir + "/" + kConfigFile),
+      stateFile_(dir + "/" + kStateFile) {
+  utilCreateDir(dir);
+}
+
+uint64_t CompiledConfigCache::configKey(const std::string& raw) {
+  static const uint64_t binary = binaryHash();
+  return SpookyHashV2::Hash64(raw.data(), raw.size(), binary);
+}
+
+std::unique_ptr<AgentConfig> CompiledConfigCache::loadConfig(
+    const std::string& raw) const {
+  std::string contents;
+  if (!folly::readFile(configFile_.c_str(), contents)) {
+    return nullptr;
+  }
+  cfg::CompiledAgentConfig compiled;
+  try {
+    apache::thrift::CompactSerializer::deserialize<cfg::CompiledAgentConfig>(
+        contents, compiled);
+  } catch (const std::exception&) {
+    return nullptr;
+  }
+  if (static_cast<uint64_t>(compiled.key) != configKey(raw)) {
+    return nullptr;
+  }
+  return std::make_unique<AgentConfig>(std::move(compiled.config), raw);
+}
+
+void CompiledConfigCache::storeConfig(const AgentConfig& config) const {
+  cfg::CompiledAgentConfig compiled;
+  compiled.key = configKey(config.raw);
+  compiled.config = config.thrift;
+  folly::writeFileAtomic(
+      configFile_,
+      apache::thrift::CompactSerializer::serialize<std::string>(compiled));
+}
+
+std::shared_ptr<SwitchState> CompiledConfigCache::loadState(
+    const AgentConfig& config,
+    const SwitchState& bootState) const {
+  std::string contents;
+  if (!folly::readFile(stateFile_.c_str(), contents)) {
+    return nullptr;
+  }
+  std::shared_ptr<SwitchState> state;
+  try {
+    auto json = folly::parseJson(contents);
+    if (static_cast<uint64_t>(json[kKey].asInt()) != configKey(config.raw) ||
+        json[kBootState].asInt() != stateHash(bootState)) {
+      return nullptr;
+    }
+    state = deserializeState(json[kState]);
+  } catch (const std::exception&) {
+    return nullptr;
+  }
+  // Stands in for the clone of bootState config apply would return
+  state->inheritGeneration(bootState);
+  return state;
+}
+
+void CompiledConfigCache::storeState(
+    const AgentConfig& config,
+    const SwitchState& bootState,
+    const SwitchState& state) const {
+  folly::dynamic json = folly::dynamic::object;
+  json[kKey] = static_cast<int64_t>(configKey(config.raw));
+  json[kBootState] = stateHash(bootState);
+  json[kState] = serializeState(state);
+  folly::writeFileAtomic(stateFile_, folly::toJson(json));
+}
+
+folly::dynamic CompiledConfigCache::serializeState(const SwitchState& state) {
+  auto json = state.toFollyDynamic();
+  json[kAggregatePorts] = state.getAggregatePorts()->toFollyDynamic();
+  json[kArpTimeout] = state.getArpTimeout().count();
+  json[kNdpTimeout] = state.getNdpTimeout().count();
+  json[kArpAgerInterval] = state.getArpAgerInterval().count();
+  json[kMaxNeighborProbes] = state.getMaxNeighborProbes();
+  json[kStaleEntryInterval] = state.getStaleEntryInterval().count();
+  json[kDhcpV4RelaySrc] = state.getDhcpV4RelaySrc().str();
+  json[kDhcpV6RelaySrc] = state.getDhcpV6RelaySrc().str();
+  json[kDhcpV4ReplySrc] = state.getDhcpV4ReplySrc().str();
+  json[kDhcpV6ReplySrc] = state.getDhcpV6ReplySrc().str();
+  folly::dynamic bfdPeers = folly::dynamic::array;
+  for (const auto& peer : state.getBfdPeers()) {
+    folly::dynamic peerJson = folly::dynamic::object;
+    peerJson[kAddress] = peer.first.str();
+    peerJson[kIntervalMsecs] = peer.second.interval.count();
+    peerJson[kDetectMultiplier] = peer.second.detectMultiplier;
+    bfdPeers.push_back(std::move(peerJson));
+  }
+  json[kBfdPeers] = std::move(bfdPeers);
+  return json;
+}
+
+std::shared_ptr<SwitchState> CompiledConfigCache::deserializeState(
+    const folly::dynamic& json) {
+  auto state = SwitchState::fromFollyDynamic(json);
+  state->resetAggregatePorts(
+      AggregatePortMap::fromFollyDynamic(json[kAggregatePorts]));
+  state->setArpTimeout(seconds(json[kArpTimeout].asInt()));
+  state->setNdpTimeout(seconds(json[kNdpTimeout].asInt()));
+  state->setArpAgerInterval(seconds(json[kArpAgerInterval].asInt()));
+  state->setMaxNeighborProbes(json[kMaxNeighborProbes].asInt());
+  state->setStaleEntryInterval(seconds(json[kStaleEntryInterval].asInt()));
+  state->setDhcpV4RelaySrc(
+      folly::IPAddressV4(json[kDhcpV4RelaySrc].asString()));
+  state->setDhcpV6RelaySrc(
+      folly::IPAddressV6(json[kDhcpV6RelaySrc].asString()));
+  state->setDhcpV4ReplySrc(
+      folly::IPAddressV4(json[kDhcpV4ReplySrc].asString()));
+  state->setDhcpV6ReplySrc(
+      folly::IPAddressV6(json[kDhcpV6ReplySrc].asString()));
+  BfdPeers bfdPeers;
+  for (const auto& peerJson : json[kBfdPeers]) {
+    bfdPeers.emplace(
+        folly::IPAddress(peerJson[kAddress].asString()),
+        BfdPeer(
+            std::chrono::milliseconds(peerJson[kIntervalMsecs].asInt()),
+            peerJson[kDetectMultiplier].asInt()));
+  }
+  state->setBfdPeers(std::move(bfdPeers));
+  return state;
+}
+
+} // namespace fboss
+} // namespace facebook
@@ -0,0 +1,72 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include <folly/dynamic.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace facebook {
+namespace fboss {
+
+struct AgentConfig;
+class SwitchState;
+
+/*
+ * A cache of what the agent makes of its config on a cold boot: the parsed
+ * AgentConfig, and the state applying it to the boot state gives. A cold boot
+ * with the same config and binary loads both instead of parsing the config
+ * and applying it from scratch, which takes seconds for large configs.
+ *
+ * Entries are keyed by a hash of the raw config and of the agent binary, and
+ * the state also by the boot state it was built from. Anything that does not
+ * match is ignored, and the caller parses and applies as usual.
+ */
+class CompiledConfigCache {
+ public:
+  explicit CompiledConfigCache(const std::string& dir);
+
+  // Returns null if raw is not the config that was cached
+  std::unique_ptr<AgentConfig> loadConfig(const std::string& raw) const;
+  void storeConfig(const AgentConfig& config) const;
+
+  // Returns null unless the cached state was built from config and bootState
+  std::shared_ptr<SwitchState> loadState(
+      const AgentConfig& config,
+      const SwitchState& bootState) const;
+  void storeState(
+      const AgentConfig& config,
+      const SwitchState& bootState,
+      const SwitchState& state) const;
+
+  /*
+   * The warm boot format leaves out what config apply sets again after a warm
+   * boot, so these also keep aggregate ports, neighbor timeouts, DHCP relay
+   * addresses and BFD peers.
+   */
+  static folly::dynamic serializeState(const SwitchState& state);
+  static std::shared_ptr<SwitchState> deserializeState(
+      const folly::dynamic& json);
+
+ private:
+  // Forbidden copy constructor and assignment operator
+  CompiledConfigCache(CompiledConfigCache const &) = delete;
+  CompiledConfigCache& operator=(CompiledConfigCache const &) = delete;
+
+  static uint64_t configKey(const std::string& raw);
+
+  std::string configFile_;
+  std::string stateFile_;
+};
+
+} // namespace fboss
+} // namespace facebook
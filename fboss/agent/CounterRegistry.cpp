@@ -0,0 +1,232 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/CounterRegistry.h"
+
+#include "fboss/agent/FbossError.h"
+
+#include <folly/String.h>
+
+#include <algorithm>
+#include <regex>
+
+namespace facebook { namespace fboss {
+
+constexpr CounterRegistry::Handle CounterRegistry::kInvalidHandle;
+constexpr size_t CounterRegistry::kChunkSize;
+constexpr size_t CounterRegistry::kMaxChunks;
+constexpr size_t CounterRegistry::kMaxCachedRegexes;
+
+CounterRegistry::CounterRegistry() {}
+
+CounterRegistry::~CounterRegistry() {
+  for (auto& chunk : chunks_) {
+    delete[] chunk.load(std::memory_order_relaxed);
+  }
+}
+
+CounterRegistry* CounterRegistry::get() {
+  // Leaked, so it outlives any thread local stats still releasing counters
+  // during shutdown
+  static auto registry = new CounterRegistry();
+  return registry;
+}
+
+CounterRegistry::Handle CounterRegistry::acquire(folly::StringPiece name) {
+  return acquireLocked(*names_.wlock(), name);
+}
+
+std::vector<CounterRegistry::Handle> CounterRegistry::acquireAll(
+    const std::vector<std::string>& names) {
+  std::vector<Handle> handles;
+  handles.reserve(names.size());
+  auto locked = names_.wlock();
+  for (const auto& name : names) {
+    handles.push_back(acquireLocked(*locked, name));
+  }
+  return handles;
+}
+
+void CounterRegistry::release(Handle handle) {
+  releaseLocked(*names_.wlock(), handle);
+}
+
+void CounterRegistry::releaseAll(const std::vector<Handle>& handles) {
+  auto locked = names_.wlock();
+  for (auto handle : handles) {
+    releaseLocked(*locked, handle);
+  }
+}
+
+CounterRegistry::Handle CounterRegistry::acquireLocked(
+    Names& names,
+    folly::StringPiece name) {
+  auto key = name.str();
+  auto iter = names.handles.find(key);
+  if (iter != names.handles.end()) {
+    ++names.refs[iter->second];
+    return iter->second;
+  }
+
+  Handle handle;
+  if (!names.freeHandles.empty()) {
+    handle = names.freeHandles.back();
+    names.freeHandles.pop_back();
+    names.names[handle] = key;
+    names.refs[handle] = 1;
+  } else {
+    handle = names.names.size();
+    if (handle >= kChunkSize * kMaxChunks) {
+      throw FbossError("too many counters to register ", name);
+    }
+    auto& chunk = chunks_[handle / kChunkSize];
+    if (!chunk.load(std::memory_order_relaxed)) {
+      chunk.store(new Slot[kChunkSize], std::memory_order_release);
+    }
+    names.names.push_back(key);
+    names.refs.push_back(1);
+  }
+  names.handles.emplace(std::move(key), handle);
+  indexComponents(names, handle, true);
+  ++names.generation;
+  return handle;
+}
+
+void CounterRegistry::releaseLocked(Names& names, Handle handle) {
+  if (handle >= names.refs.size() || names.refs[handle] == 0) {
+    throw FbossError("releasing unregistered counter handle ", handle);
+  }
+  if (--names.refs[handle] > 0) {
+    return;
+  }
+  indexComponents(names, handle, false);
+  ++names.generation;
+  names.handles.erase(names.names[handle]);
+  names.names[handle].clear();
+  clearValue(handle);
+  names.freeHandles.push_back(handle);
+}
+
+void CounterRegistry::getCounters(
+    std::map<std::string, int64_t>& counters) const {
+  auto names = names_.rlock();
+  for (Handle handle = 0; handle < names->names.size(); ++handle) {
+    const auto& counter = slot(handle);
+    if (names->refs[handle] > 0 &&
+        counter.hasValue.load(std::memory_order_acquire)) {
+      counters[names->names[handle]] =
+          counter.value.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+void CounterRegistry::indexComponents(Names& names, Handle handle, bool add) {
+  std::vector<folly::StringPiece> components;
+  folly::split('.', names.names[handle], components);
+  for (auto component : components) {
+    if (component.empty()) {
+      continue;
+    }
+    if (add) {
+      names.components[component.str()].insert(handle);
+      continue;
+    }
+    auto iter = names.components.find(component.str());
+    if (iter != names.components.end()) {
+      iter->second.erase(handle);
+      if (iter->second.empty()) {
+        names.components.erase(iter);
+      }
+    }
+  }
+}
+
+const std::vector<CounterRegistry::Handle>& CounterRegistry::matchRegexLocked(
+    const Names& names,
+    RegexCache& cache,
+    const std::string& regex) const {
+  if (cache.generation != names.generation) {
+    cache.matches.clear();
+    cache.generation = names.generation;
+  }
+  auto iter = cache.matches.find(regex);
+  if (iter != cache.matches.end()) {
+    return iter->second;
+  }
+
+  std::regex compiled;
+  try {
+    compiled.assign(regex, std::regex::ECMAScript | std::regex::optimize);
+  } catch (const std::regex_error& ex) {
+    throw FbossError("invalid counter regex ", regex, ": ", ex.what());
+  }
+  std::vector<Handle> matches;
+  for (const auto& entry : names.handles) {
+    if (std::regex_match(entry.first, compiled)) {
+      matches.push_back(entry.second);
+    }
+  }
+  if (cache.matches.size() >= kMaxCachedRegexes) {
+    cache.matches.clear();
+  }
+  return cache.matches.emplace(regex, std::move(matches)).first->second;
+}
+
+std::vector<std::pair<std::string, int64_t>> CounterRegistry::query(
+    const Query& query) const {
+  auto names = names_.rlock();
+  std::vector<Handle> handles;
+  for (const auto& key : query.keys) {
+    auto iter = names->handles.find(key);
+    if (iter != names->handles.end()) {
+      handles.push_back(iter->second);
+    }
+  }
+  for (const auto& prefix : query.prefixes) {
+    for (auto iter = names->handles.lower_bound(prefix);
+         iter != names->handles.end() &&
+         folly::StringPiece(iter->first).startsWith(prefix);
+         ++iter) {
+      handles.push_back(iter->second);
+    }
+  }
+  for (const auto& component : query.components) {
+    auto iter = names->components.find(component);
+    if (iter != names->components.end()) {
+      handles.insert(handles.end(), iter->second.begin(), iter->second.end());
+    }
+  }
+  if (!query.regexes.empty()) {
+    auto cache = regexCache_.wlock();
+    for (const auto& regex : query.regexes) {
+      const auto& matches = matchRegexLocked(*names, *cache, regex);
+      handles.insert(handles.end(), matches.begin(), matches.end());
+    }
+  }
+  std::sort(handles.begin(), handles.end());
+  handles.erase(std::unique(handles.begin(), handles.end()), handles.end());
+
+  std::vector<std::pair<std::string, int64_t>> values;
+  values.reserve(handles.size());
+  for (auto handle : handles) {
+    const auto& counter = slot(handle);
+    if (counter.hasValue.load(std::memory_order_acquire)) {
+      values.emplace_back(
+          names->names[handle], counter.value.load(std::memory_order_relaxed));
+    }
+  }
+  std::sort(values.begin(), values.end());
+  return values;
+}
+
+size_t CounterRegistry::size() const {
+  return names_.rlock()->handles.size();
+}
+
+}} // facebook::fboss
@@ -0,0 +1,156 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include <folly/Range.h>
+#include <folly/Synchronized.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace facebook { namespace fboss {
+
+/*
+ * Interned counters.
+ *
+ * A counter's name is only looked up when it is acquired, which hands back a
+ * small integer handle.  Updates through the handle go straight to a slot in
+ * a dense array, without formatting or looking up any strings, and from any
+ * thread.  Names are only resolved again when the counters are exported.
+ *
+ * Acquiring the same name again returns the same handle, and the counter
+ * stays registered until every acquire() has been matched by a release().
+ *
+ * Names are kept sorted and indexed by each of their '.' separated
+ * components, such as a port name, "queue3" or "out_bytes", so that queries
+ * for a subset of the counters only visit that subset.  The names matching a
+ * regex are cached until a counter is next added or removed.
+ */
+class CounterRegistry {
+ public:
+  using Handle = uint32_t;
+  static constexpr Handle kInvalidHandle = std::numeric_limits<Handle>::max();
+
+  CounterRegistry();
+  ~CounterRegistry();
+
+  static CounterRegistry* get();
+
+  Handle acquire(folly::StringPiece name);
+  void release(Handle handle);
+
+  // Register or release a whole batch of counters, such as all those of a
+  // port, under one acquisition of the registry lock.  Handles come back in
+  // the order of the names.
+  std::vector<Handle> acquireAll(const std::vector<std::string>& names);
+  void releaseAll(const std::vector<Handle>& handles);
+
+  void setValue(Handle handle, int64_t value) {
+    auto& counter = slot(handle);
+    counter.value.store(value, std::memory_order_relaxed);
+    counter.hasValue.store(true, std::memory_order_release);
+  }
+  void incrementValue(Handle handle, int64_t amount = 1) {
+    auto& counter = slot(handle);
+    counter.value.fetch_add(amount, std::memory_order_relaxed);
+    counter.hasValue.store(true, std::memory_order_release);
+  }
+  // Stop exporting the counter until it is next set
+  void clearValue(Handle handle) {
+    auto& counter = slot(handle);
+    counter.hasValue.store(false, std::memory_order_relaxed);
+    counter.value.store(0, std::memory_order_relaxed);
+  }
+  int64_t getValue(Handle handle) const {
+    return slot(handle).value.load(std::memory_order_relaxed);
+  }
+
+  // Add the name and value of every counter that has a value
+  void getCounters(std::map<std::string, int64_t>& counters) const;
+
+  /*
+   * Counters to look up with query().  A counter matches if it matches any
+   * one of the criteria.
+   */
+  struct Query {
+    std::vector<std::string> keys;
+    std::vector<std::string> prefixes;
+    std::vector<std::string> components;
+    // Matched against the whole name
+    std::vector<std::string> regexes;
+  };
+
+  // The names and values, sorted by name, of the counters with a value that
+  // match query.  Throws FbossError for an invalid regex.
+  std::vector<std::pair<std::string, int64_t>> query(const Query& query) const;
+
+  // Number of registered counters
+  size_t size() const;
+
+ private:
+  struct Slot {
+    std::atomic<int64_t> value{0};
+    std::atomic<bool> hasValue{false};
+  };
+  // Slots are allocated a chunk at a time, and chunks are never moved or
+  // freed, so updates need no lock to find their slot.
+  static constexpr size_t kChunkSize = 1024;
+  static constexpr size_t kMaxChunks = 1024;
+
+  static constexpr size_t kMaxCachedRegexes = 128;
+
+  struct Names {
+    std::vector<std::string> names;
+    std::vector<uint32_t> refs;
+    // Sorted, so that a prefix is a range of it
+    std::map<std::string, Handle> handles;
+    std::unordered_map<std::string, std::unordered_set<Handle>> components;
+    std::vector<Handle> freeHandles;
+    // Bumped whenever a name is added or removed
+    uint64_t generation{0};
+  };
+
+  struct RegexCache {
+    uint64_t generation{0};
+    std::unordered_map<std::string, std::vector<Handle>> matches;
+  };
+
+  // Forbidden copy constructor and assignment operator
+  CounterRegistry(CounterRegistry const&) = delete;
+  CounterRegistry& operator=(CounterRegistry const&) = delete;
+
+  Handle acquireLocked(Names& names, folly::StringPiece name);
+  void releaseLocked(Names& names, Handle handle);
+  static void indexComponents(Names& names, Handle handle, bool add);
+  const std::vector<Handle>& matchRegexLocked(
+      const Names& names,
+      RegexCache& cache,
+      const std::string& regex) const;
+
+  Slot& slot(Handle handle) const {
+    return chunks_[handle / kChunkSize].load(std::memory_order_acquire)
+        [handle % kChunkSize];
+  }
+
+  std::array<std::atomic<Slot*>, kMaxChunks> chunks_{};
+  folly::Synchronized<Names> names_;
+  // Only taken with names_ held
+  mutable folly::Synchronized<RegexCache> regexCache_;
+};
+
+}} // facebook::fboss
@@ -13,6 +13,7 @@
 #include <folly/io/Cursor.h>
 #include <folly/io/IOBuf.h>
 #include <folly/logging/xlog.h>
+#include <algorithm>
 #include <string>
 #include "FbossError.h"
 #include "Platform.h"
@@ -112,21 +113,15 @@ void sendDHCPPacket(SwSwitch* sw, const EthHdr& ethHdr, const IPv4Hdr& ipHdr,
   sw->sendPacketSwitchedAsync(std::move(txPacket));
 }
 
-int processOption(const DHCPv4Packet::Options& optionsIn, int optIndex,
-    DHCPv4Packet& dhcpPacketOut, bool toAppend) {
-
-  uint8_t op = optionsIn[optIndex];
-  uint8_t optLen = DHCPv4Packet::isOptionWithoutLength(op) ?
-      0 : optionsIn[optIndex + 1];
-  const uint8_t* optBytes = optLen == 0 ? nullptr :
-    &optionsIn[optIndex + 2];
-  if (toAppend) {
-    dhcpPacketOut.appendOption(op, optLen, optBytes);
-  }
-  return optLen == 0 ?
-      1 :          // option byte
-      2 + optLen;  // Option byte + len + option data
-
+// Bytes of the option at optIndex, including its op and length bytes
+size_t optionSize(const DHCPv4Packet::Options& options, size_t optIndex) {
+  uint8_t op = options[optIndex];
+  size_t size = DHCPv4Packet::isOptionWithoutLength(op) ||
+          optIndex + 1 == options.size()
+      ? 1
+      : 2 + options[optIndex + 1];
+  // A truncated last option ends with the options
+  return std::min(size, options.size() - optIndex);
 }
 
 }
@@ -194,8 +189,7 @@ void DHCPv4Handler::handlePacket(
 
 void DHCPv4Handler::processRequest(SwSwitch* sw, std::unique_ptr<RxPacket> pkt,
     MacAddress srcMac, const IPv4Hdr& origIPHdr,
-    const DHCPv4Packet& dhcpPacket) {
-  auto dhcpPacketOut(dhcpPacket);
+    DHCPv4Packet& dhcpPacket) {
   auto state = sw->getState();
   auto vlan = state->getVlans()->getVlanIf(pkt->getSrcVlan());
   if (!vlan) {
@@ -243,8 +237,7 @@ void DHCPv4Handler::processRequest(SwSwitch* sw, std::unique_ptr<RxPacket> pkt,
 
   XLOG(DBG4) << " Got switch ip : " << switchIp;
   // Prepare DHCP packet to relay
-  if (!addAgentOptions(sw, pkt->getSrcPort(), switchIp, dhcpPacket,
-        dhcpPacketOut)) {
+  if (!addAgentOptions(sw, pkt->getSrcPort(), switchIp, dhcpPacket)) {
     sw->portStats(pkt->getSrcPort())->dhcpV4BadPkt();
     XLOG(DBG4) << "Bad DHCP packet, error adding agent options."
                << " DHCP packet dropped";
@@ -255,32 +248,32 @@ void DHCPv4Handler::processRequest(SwSwitch* sw, std::unique_ptr<RxPacket> pkt,
   // where not incrementing this on the DHCP request causes
   // the server to drop our request.
   const int kMaxHops = 255;
-  if (dhcpPacketOut.hops < kMaxHops) {
-    dhcpPacketOut.hops++;
+  if (dhcpPacket.hops < kMaxHops) {
+    dhcpPacket.hops++;
   } else {
     XLOG(DBG4) << "Max hops exceeded for dhcp packet";
     sw->portStats(pkt->getSrcPort())->dhcpV4BadPkt();
     return;
   }
-  dhcpPacketOut.giaddr = switchIp;
+  dhcpPacket.giaddr = switchIp;
   // Look up cpu mac from platform
   MacAddress cpuMac = sw->getPlatform()->getLocalMac();
 
   // Prepare the packet to be sent out
   EthHdr ethHdr = makeEthHdr(cpuMac, cpuMac, pkt->getSrcVlan());
   auto ipHdr = makeIpv4Header(switchIp, dhcpServer, origIPHdr.ttl - 1,
-      IPv4Hdr::minSize() + UDPHeader::size() + dhcpPacketOut.size());
+      IPv4Hdr::minSize() + UDPHeader::size() + dhcpPacket.size());
   UDPHeader udpHdr(kBootPSPort, kBootPSPort,
-      UDPHeader::size() + dhcpPacketOut.size());
+      UDPHeader::size() + dhcpPacket.size());
   // Send packet
-  sendDHCPPacket(sw, ethHdr, ipHdr, udpHdr, dhcpPacketOut);
+  sendDHCPPacket(sw, ethHdr, ipHdr, udpHdr, dhcpPacket);
+  sw->stats()->dhcpV4Relayed(pkt->getSrcVlan());
 }
 
 void DHCPv4Handler::processReply(SwSwitch* sw, std::unique_ptr<RxPacket> pkt,
-      const IPv4Hdr& origIPHdr, const DHCPv4Packet& dhcpPacket) {
-  auto dhcpPacketOut(dhcpPacket);
+      const IPv4Hdr& origIPHdr, DHCPv4Packet& dhcpPacket) {
   auto state = sw->getState();
-  if (!stripAgentOptions(sw, pkt->getSrcPort(), dhcpPacket, dhcpPacketOut)) {
+  if (!stripAgentOptions(sw, pkt->getSrcPort(), dhcpPacket)) {
     sw->portStats(pkt->getSrcPort())->dhcpV4BadPkt();
     XLOG(DBG4) << "Bad DHCP packet, error stripping agent options."
                << " DHCP packet dropped";
@@ -297,12 +290,12 @@ void DHCPv4Handler::processReply(SwSwitch* sw, std::unique_ptr<RxPacket> pkt,
   MacAddress cpuMac = sw->getPlatform()->getLocalMac();
   // Extract client MAC address from dhcp reply
   uint8_t chaddr[MacAddress::SIZE];
-  memcpy(chaddr, dhcpPacketOut.chaddr.data(), MacAddress::SIZE);
+  memcpy(chaddr, dhcpPacket.chaddr.data(), MacAddress::SIZE);
   MacAddress dstMac = MacAddress::fromBinary(
     folly::ByteRange(chaddr, MacAddress::SIZE));
 
   // Clear out the relay address field
-  dhcpPacketOut.giaddr = IPAddressV4();
+  dhcpPacket.giaddr = IPAddressV4();
 
   // TODO we should add router id information to the packet
   // to get the VRF of the interface that this packet came
@@ -319,33 +312,30 @@ void DHCPv4Handler::processReply(SwSwitch* sw, std::unique_ptr<RxPacket> pkt,
   // Prepare the packet to be sent out
   EthHdr ethHdr = makeEthHdr(cpuMac, dstMac, intf->getVlanID());
   auto ipHdr = makeIpv4Header(switchIp, clientIP, origIPHdr.ttl - 1,
-      IPv4Hdr::minSize() + UDPHeader::size() + dhcpPacketOut.size());
+      IPv4Hdr::minSize() + UDPHeader::size() + dhcpPacket.size());
   UDPHeader udpHdr(kBootPSPort, kBootPCPort,
-      UDPHeader::size() + dhcpPacketOut.size());
+      UDPHeader::size() + dhcpPacket.size());
 
-  sendDHCPPacket(sw, ethHdr, ipHdr, udpHdr, dhcpPacketOut);
+  sendDHCPPacket(sw, ethHdr, ipHdr, udpHdr, dhcpPacket);
+  sw->stats()->dhcpV4Relayed(intf->getVlanID());
 }
 
 bool DHCPv4Handler::addAgentOptions(
     SwSwitch* /*sw*/,
     PortID /*port*/,
     IPAddressV4 relayAddr,
-    const DHCPv4Packet& dhcpPacketIn,
-    DHCPv4Packet& dhcpPacketOut) {
-  dhcpPacketOut.clearOptions();
-  const auto& optionsIn = dhcpPacketIn.options;
-  auto optIndex = 0;
+    DHCPv4Packet& dhcpPacket) {
+  auto& options = dhcpPacket.options;
+  size_t optIndex = 0;
   bool isDHCP = false;
-  bool done = false;
   uint16_t maxMsgSize = 0;
-  while (optIndex < optionsIn.size() && !done) {
-    bool appendOption = true;
-    switch(optionsIn[optIndex]) {
+  while (optIndex < options.size() && options[optIndex] != END) {
+    switch(options[optIndex]) {
       case DHCP_MESSAGE_TYPE:
         isDHCP = true;
         break;
       case DHCP_MAX_MESSAGE_SIZE:
-        maxMsgSize = ntohs(optionsIn[optIndex + 2]);
+        maxMsgSize = ntohs(options[optIndex + 2]);
         break;
       case DHCP_AGENT_OPTIONS:
         if (isDHCP) {
@@ -355,14 +345,11 @@ bool DHCPv4Handler::addAgentOptions(
           return false; //Options already present discard packet
         }
         break;
-      case END:
-        done = true;
-        appendOption = false;
-        break;
     }
-    optIndex += processOption(optionsIn, optIndex, dhcpPacketOut,
-        appendOption);
+    optIndex += optionSize(options, optIndex);
   }
+  // Everything from END on is replaced by the agent option and a new END
+  options.resize(optIndex);
   if (isDHCP) {
     //Append agent option
     uint8_t optlen = 2 + relayAddr.byteCount();
@@ -370,11 +357,11 @@ bool DHCPv4Handler::addAgentOptions(
     subOptArray[0] = AGENT_CIRCUIT_ID;
     subOptArray[1] = relayAddr.byteCount();
     memcpy(subOptArray + 2, relayAddr.bytes(), relayAddr.byteCount());
-    dhcpPacketOut.appendOption(DHCP_AGENT_OPTIONS, optlen, subOptArray);
+    dhcpPacket.appendOption(DHCP_AGENT_OPTIONS, optlen, subOptArray);
   }
-  dhcpPacketOut.appendOption(END, 0, nullptr);
-  dhcpPacketOut.padToMinLength();
-  if (isDHCP && maxMsgSize && dhcpPacketOut.size() > maxMsgSize) {
+  dhcpPacket.appendOption(END, 0, nullptr);
+  dhcpPacket.padToMinLength();
+  if (isDHCP && maxMsgSize && dhcpPacket.size() > maxMsgSize) {
     return false;
   }
 
@@ -384,33 +371,28 @@ bool DHCPv4Handler::addAgentOptions(
 bool DHCPv4Handler::stripAgentOptions(
     SwSwitch* /*sw*/,
     PortID /*port*/,
-    const DHCPv4Packet& dhcpPacketIn,
-    DHCPv4Packet& dhcpPacketOut) {
-  dhcpPacketOut.clearOptions();
-  const auto& optionsIn = dhcpPacketIn.options;
-  auto optIndex = 0;
+    DHCPv4Packet& dhcpPacket) {
+  auto& options = dhcpPacket.options;
+  size_t optIndex = 0;
   bool isDHCP = false;
-  bool done = false;
-  while (optIndex < optionsIn.size() && !done) {
-    bool appendOption = true;
-    switch(optionsIn[optIndex]) {
-      case DHCP_MESSAGE_TYPE:
-        isDHCP = true;
-        break;
-      case DHCP_AGENT_OPTIONS:
-        if (isDHCP) {
-          appendOption = false;
-        }
-        break;
-      case END:
-        done = true;
-        appendOption = true;
-        break;
+  while (optIndex < options.size()) {
+    auto op = options[optIndex];
+    auto size = optionSize(options, optIndex);
+    if (op == DHCP_MESSAGE_TYPE) {
+      isDHCP = true;
+    } else if (op == DHCP_AGENT_OPTIONS && isDHCP) {
+      options.erase(
+          options.begin() + optIndex, options.begin() + optIndex + size);
+      continue;
+    }
+    optIndex += size;
+    if (op == END) {
+      break;
     }
-    optIndex += processOption(optionsIn, optIndex, dhcpPacketOut,
-        appendOption);
   }
-  dhcpPacketOut.padToMinLength();
+  // Drop anything after END, the padding is redone below
+  options.resize(optIndex);
+  dhcpPacket.padToMinLength();
   return isDHCP;
 }
 
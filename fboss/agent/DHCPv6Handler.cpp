@@ -200,11 +200,13 @@ void DHCPv6Handler::processDHCPv6Packet(
 
   // use the client src mac address as the interface id
   relayFwdPkt.addInterfaceIDOption(srcMac);
-  // add relay message option
-  relayFwdPkt.addRelayMessageOption(dhcpPacket);
+  // The relay message option goes last, and is written straight from
+  // dhcpPacket into the packet we send rather than copied into relayFwdPkt
+  auto relayMsgLength = dhcpPacket.computePacketLength();
+  auto relayFwdLength = relayFwdPkt.computePacketLength() +
+      DHCPv6Packet::OPTION_HEADER_BYTES + relayMsgLength;
 
-  if (relayFwdPkt.computePacketLength() >
-      DHCPv6Packet::MAX_DHCPV6_MSG_LENGTH) {
+  if (relayFwdLength > DHCPv6Packet::MAX_DHCPV6_MSG_LENGTH) {
     XLOG(DBG2) << "DHCPv6 relay forward message exceeds max length, drop it.";
     sw->portStats(pkt->getSrcPort())->dhcpV6BadPkt();
     return;
@@ -215,12 +217,17 @@ void DHCPv6Handler::processDHCPv6Packet(
   MacAddress cpuMac = sw->getPlatform()->getLocalMac();
   auto serializeBody = [&](RWPrivateCursor* sendCursor) {
     relayFwdPkt.write(sendCursor);
+    sendCursor->writeBE<uint16_t>(
+        static_cast<uint16_t>(DHCPv6OptionType::DHCPv6_OPTION_RELAY_MSG));
+    sendCursor->writeBE<uint16_t>(relayMsgLength);
+    dhcpPacket.write(sendCursor);
   };
 
   sendDHCPv6Packet(sw, cpuMac, cpuMac, vlanId, dhcp6ServerIp, switchIp,
       DHCPv6Packet::DHCP6_SERVERAGENT_UDPPORT,
       DHCPv6Packet::DHCP6_SERVERAGENT_UDPPORT,
-      relayFwdPkt.computePacketLength(), serializeBody);
+      relayFwdLength, serializeBody);
+  sw->stats()->dhcpV6Relayed(vlanId);
 }
 
 void DHCPv6Handler::processDHCPv6RelayForward(SwSwitch* sw,
@@ -246,6 +253,7 @@ void DHCPv6Handler::processDHCPv6RelayForward(SwSwitch* sw,
       ipHdr.srcAddr, DHCPv6Packet::DHCP6_SERVERAGENT_UDPPORT,
       DHCPv6Packet::DHCP6_SERVERAGENT_UDPPORT,
       dhcpPacket.computePacketLength(), serializeBody);
+  sw->stats()->dhcpV6Relayed(vlan);
 }
 
 void DHCPv6Handler::processDHCPv6RelayReply(
@@ -310,6 +318,7 @@ void DHCPv6Handler::processDHCPv6RelayReply(
       dhcpPacket.peerAddr, switchIp, DHCPv6Packet::DHCP6_CLIENT_UDPPORT,
       DHCPv6Packet::DHCP6_SERVERAGENT_UDPPORT,
       relayLen, serializeBody);
+  sw->stats()->dhcpV6Relayed(intf->getVlanID());
 }
 
 }} //facebook::fboss
@@ -9,6 +9,34 @@
  */
 #include "fboss/agent/HwSwitch.h"
 
+#include "fboss/agent/FbossError.h"
+
 namespace facebook { namespace fboss {
 
+void HwSwitch::setPortFastSampling(
+    const std::vector<PortID>& /*ports*/,
+    std::chrono::milliseconds /*interval*/) {
+  throw FbossError("fast port sampling is not supported on this switch");
+}
+
+PortFastSamples HwSwitch::getPortFastSamples(PortID /*port*/) const {
+  throw FbossError("fast port sampling is not supported on this switch");
+}
+
+void HwSwitch::watchAclStats(
+    const std::vector<std::string>& /*statNames*/,
+    std::chrono::seconds /*duration*/) {
+  throw FbossError("watching ACL stats is not supported on this switch");
+}
+
+std::vector<BufferCongestionEvent> HwSwitch::getBufferCongestionEvents()
+    const {
+  throw FbossError(
+      "buffer congestion events are not supported on this switch");
+}
+
+HwApiTrace HwSwitch::getHwApiTrace() const {
+  throw FbossError("SDK call tracing is not supported on this switch");
+}
+
 }} // facebook::fboss
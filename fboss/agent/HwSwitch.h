@@ -16,8 +16,12 @@
 #include <folly/IPAddress.h>
 #include <folly/Optional.h>
 
+#include <chrono>
+#include <map>
 #include <memory>
+#include <set>
 #include <utility>
+#include <vector>
 
 namespace folly{
 struct dynamic;
@@ -31,6 +35,9 @@ class StateDelta;
 class RxPacket;
 class TxPacket;
 
+// The (vrf, ip) of every arp/ndp entry that has been hit
+using NeighborHits = std::set<std::pair<RouterID, folly::IPAddress>>;
+
 struct HwInitResult {
   std::shared_ptr<SwitchState> switchState{nullptr};
   std::shared_ptr<SwitchState> switchStateDesired{nullptr};
@@ -83,6 +90,17 @@ class HwSwitch {
      */
     virtual void linkStateChanged(PortID port, bool up) = 0;
 
+    /*
+     * linkStatesChanged() is invoked instead when the HwSwitch sees several
+     * link changes at once, with the changes in the order they happened.
+     */
+    virtual void linkStatesChanged(
+        const std::vector<std::pair<PortID, bool>>& changes) {
+      for (const auto& change : changes) {
+        linkStateChanged(change.first, change.second);
+      }
+    }
+
     /*
      * Used to notify the SwSwitch of a fatal error so the implementation can
      * provide special behavior when a crash occurs.
@@ -245,12 +263,64 @@ class HwSwitch {
   virtual bool getAndClearNeighborHit(RouterID vrf,
                                       folly::IPAddress& ip) = 0;
 
+  /*
+   * Returns every arp/ndp entry that has been hit since the last call,
+   * clearing the hit bits in a single walk of the host table.  Returns
+   * folly::none if the hardware can only be asked one entry at a time, in
+   * which case getAndClearNeighborHit() should be used.
+   */
+  virtual folly::Optional<NeighborHits> getAndClearNeighborHits() {
+    return folly::none;
+  }
+
   /*
    * Clear port stats for specified port
    */
   virtual void clearPortStats(
       const std::unique_ptr<std::vector<int32_t>>& ports) = 0;
 
+  /*
+   * Hardware stats of every port, as of the last updateStats() call.
+   */
+  virtual std::map<PortID, HwPortStats> getPortStats() const {
+    return {};
+  }
+
+  /*
+   * Sample the counters of the given ports every interval, keeping the most
+   * recent samples for getPortFastSamples().  Replaces any previous set of
+   * ports; an empty list stops sampling.
+   *
+   * Not every HwSwitch supports this; the default throws.
+   */
+  virtual void setPortFastSampling(
+      const std::vector<PortID>& ports,
+      std::chrono::milliseconds interval);
+  virtual PortFastSamples getPortFastSamples(PortID port) const;
+
+  /*
+   * Poll the named ACL stats every stats cycle for the next duration.
+   *
+   * Not every HwSwitch supports this; the default throws.
+   */
+  virtual void watchAclStats(
+      const std::vector<std::string>& statNames,
+      std::chrono::seconds duration);
+
+  /*
+   * Recent buffer congestion events, oldest first.
+   *
+   * Not every HwSwitch supports this; the default throws.
+   */
+  virtual std::vector<BufferCongestionEvent> getBufferCongestionEvents() const;
+
+  /*
+   * Time spent in SDK calls, per API, and the most recent calls.
+   *
+   * Not every HwSwitch supports this; the default throws.
+   */
+  virtual HwApiTrace getHwApiTrace() const;
+
   virtual BootType getBootType() const = 0;
 
   virtual cfg::PortSpeed getPortMaxSpeed(PortID /* port */) const = 0;
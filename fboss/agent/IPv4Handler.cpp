@@ -15,11 +15,14 @@
 #include <folly/io/Cursor.h>
 #include <folly/logging/xlog.h>
 #include "fboss/agent/ArpHandler.h"
+#include "fboss/agent/BfdManager.h"
 #include "fboss/agent/DHCPv4Handler.h"
 #include "fboss/agent/FbossError.h"
 #include "fboss/agent/HwSwitch.h"
 #include "fboss/agent/IPHeaderV4.h"
+#include "fboss/agent/MicroBfdManager.h"
 #include "fboss/agent/NeighborUpdater.h"
+#include "fboss/agent/PendingPacketQueue.h"
 #include "fboss/agent/Platform.h"
 #include "fboss/agent/PortStats.h"
 #include "fboss/agent/RxPacket.h"
@@ -151,6 +154,18 @@ void IPv4Handler::handlePacket(unique_ptr<RxPacket> pkt,
           udpHdr, udpCursor);
       return;
     }
+    auto microBfdManager = sw_->getMicroBfdManager();
+    if (microBfdManager &&
+        udpHdr.dstPort == BfdControlPacket::MICRO_BFD_UDP_PORT) {
+      microBfdManager->handlePacket(
+          port, IPAddress(v4Hdr.srcAddr), v4Hdr.ttl, udpCursor);
+      return;
+    }
+    auto bfdManager = sw_->getBfdManager();
+    if (bfdManager && udpHdr.dstPort == BfdControlPacket::UDP_PORT) {
+      bfdManager->handlePacket(IPAddress(v4Hdr.srcAddr), v4Hdr.ttl, udpCursor);
+      return;
+    }
   }
 
   // Handle packets destined for us
@@ -201,6 +216,11 @@ void IPv4Handler::handlePacket(unique_ptr<RxPacket> pkt,
     stats->port(port)->pktDropped();
     stats->port(port)->ipv4TtlExceeded();
     // Look up cpu mac from platform
+    if (!icmpRateLimiter_.allow(
+            IcmpRateLimiter::Type::V4_TTL_EXCEEDED, v4Hdr.srcAddr)) {
+      stats->port(port)->icmpRateLimited();
+      return;
+    }
     MacAddress cpuMac = sw_->getPlatform()->getLocalMac();
     sendICMPTimeExceeded(pkt->getSrcVlan(), cpuMac, cpuMac, v4Hdr, cursor);
     return;
@@ -220,28 +240,32 @@ void IPv4Handler::handlePacket(unique_ptr<RxPacket> pkt,
   // We will need to manage the rate somehow. Either from HW
   // or a SW control here
   stats->port(port)->ipv4Nexthop();
-  if (!resolveMac(state, port, v4Hdr.dstAddr)) {
+  bool queued = false;
+  if (!resolveMac(state, port, v4Hdr.dstAddr, pkt.get(), &queued)) {
     stats->port(port)->ipv4NoArp();
     XLOG(DBG4) << "Cannot find the interface to send out ARP request for "
                << v4Hdr.dstAddr.str();
   }
-  // TODO: ideally, we need to store this packet until the ARP is done and
-  // then send this pkt out. For now, just drop it.
-  stats->port(port)->pktDropped();
+  if (!queued) {
+    stats->port(port)->pktDropped();
+  }
 }
 
-// Return true if we successfully sent an ARP request, false otherwise
+// Return true if we sent an ARP request, or the neighbor cache is already
+// sending them, false otherwise
 bool IPv4Handler::resolveMac(
     std::shared_ptr<SwitchState> state,
     PortID ingressPort,
-    IPAddressV4 dest) {
+    IPAddressV4 dest,
+    const RxPacket* pkt,
+    bool* queued) {
   // need to find out our own IP and MAC addresses so that we can send the
   // ARP request out. Since the request will be broadcast, there is no need to
   // worry about which port to send the packet out.
 
   // TODO(samank): avoid hard coding VRF
 
-  auto route = sw_->longestMatch(state, dest, RouterID(0));
+  auto route = sw_->cachedLongestMatch(state, dest, RouterID(0));
   if (!route || !route->isResolved()) {
     sw_->portStats(ingressPort)->ipv4DstLookupFailure();
     // No way to reach dest
@@ -266,18 +290,29 @@ bool IPv4Handler::resolveMac(
       if (vlan) {
         auto entry = vlan->getArpTable()->getEntryIf(target);
         if (entry == nullptr) {
-          // No entry in ARP table, send ARP request
-          auto mac = intf->getMac();
-          ArpHandler::sendArpRequest(sw_, vlanID, mac, source, target);
+          auto updater = sw_->getNeighborUpdater();
+          if (updater->isProbing(vlanID, target)) {
+            // The cache's pending entry has not reached the switch state
+            // yet, but the cache is already sending requests for it
+            sw_->stats()->neighborRequestSuppressed();
+          } else {
+            // No entry in ARP table, send ARP request
+            auto mac = intf->getMac();
+            ArpHandler::sendArpRequest(sw_, vlanID, mac, source, target);
 
-          // Notify the updater that we sent an arp request
-          sw_->getNeighborUpdater()->sentArpRequest(vlanID, target);
+            // Notify the updater that we sent an arp request
+            updater->sentArpRequest(vlanID, target);
+          }
           sent = true;
         } else {
           XLOG(DBG4) << "not sending arp for " << target.str() << ", "
                      << ((entry->isPending()) ? "pending " : "")
                      << "entry already exists";
         }
+        if (pkt && !*queued && (!entry || entry->isPending())) {
+          *queued = sw_->getPendingPacketQueue()->enqueue(
+              vlanID, IPAddress(target), pkt);
+        }
       }
     }
   }
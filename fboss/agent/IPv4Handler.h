@@ -9,6 +9,7 @@
  */
 #pragma once
 
+#include "fboss/agent/IcmpRateLimiter.h"
 #include "fboss/agent/types.h"
 
 #include <memory>
@@ -42,11 +43,17 @@ class IPv4Handler {
   /*
    * TODO(aeckert): t17949183 unify packet handling pipeline and then
    * make this private again.
+   *
+   * If pkt is given, a copy of it is held until the first unresolved next
+   * hop of dest resolves, and *queued is set if it was. queued must be given
+   * along with pkt.
    */
   bool resolveMac(
       std::shared_ptr<SwitchState> state,
       PortID ingressPort,
-      folly::IPAddressV4 dest);
+      folly::IPAddressV4 dest,
+      const RxPacket* pkt = nullptr,
+      bool* queued = nullptr);
 
  private:
   void sendICMPTimeExceeded(VlanID srcVlan,
@@ -60,6 +67,7 @@ class IPv4Handler {
   IPv4Handler& operator=(IPv4Handler const &) = delete;
 
   SwSwitch* sw_{nullptr};
+  IcmpRateLimiter icmpRateLimiter_;
 };
 
 }} // facebook::fboss
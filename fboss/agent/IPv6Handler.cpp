@@ -12,9 +12,12 @@
 #include <folly/Format.h>
 #include <folly/MacAddress.h>
 #include <folly/logging/xlog.h>
+#include "fboss/agent/BfdManager.h"
 #include "fboss/agent/DHCPv6Handler.h"
 #include "fboss/agent/FbossError.h"
+#include "fboss/agent/MicroBfdManager.h"
 #include "fboss/agent/NeighborUpdater.h"
+#include "fboss/agent/PendingPacketQueue.h"
 #include "fboss/agent/Platform.h"
 #include "fboss/agent/RxPacket.h"
 #include "fboss/agent/SwSwitch.h"
@@ -40,6 +43,7 @@
 #include "fboss/agent/state/Vlan.h"
 #include "fboss/agent/state/VlanMap.h"
 
+using folly::IPAddress;
 using folly::IPAddressV6;
 using folly::MacAddress;
 using folly::io::Cursor;
@@ -87,7 +91,8 @@ struct IPv6Handler::ICMPHeaders {
 
 IPv6Handler::IPv6Handler(SwSwitch* sw)
     : AutoRegisterStateObserver(sw, "IPv6Handler"),
-      sw_(sw) {
+      sw_(sw),
+      routeAdvertiser_(sw) {
 }
 
 void IPv6Handler::stateUpdated(const StateDelta& delta) {
@@ -97,10 +102,7 @@ void IPv6Handler::stateUpdated(const StateDelta& delta) {
     } else if (!entry.getNew()) {
       intfDeleted(entry.getOld().get());
     } else {
-      // TODO: We could add an intfChanged() method to re-use the existing
-      // IPv6RouteAdvertiser object.
-      intfDeleted(entry.getOld().get());
-      intfAdded(delta.newState().get(), entry.getNew().get());
+      intfChanged(entry.getOld().get(), entry.getNew().get());
     }
   }
 }
@@ -109,23 +111,36 @@ bool IPv6Handler::raEnabled(const Interface* intf) const {
   return intf->getNdpConfig().routerAdvertisementSeconds > 0;
 }
 
-void IPv6Handler::intfAdded(const SwitchState* state, const Interface* intf) {
+void IPv6Handler::intfAdded(
+    const SwitchState* /*state*/,
+    const Interface* intf) {
   // If IPv6 router advertisement isn't enabled on this interface, ignore it.
   if (!raEnabled(intf)) {
     return;
   }
 
-  IPv6RouteAdvertiser adv(sw_, state, intf);
-  auto ret = routeAdvertisers_.emplace(intf->getID(), std::move(adv));
-  CHECK(ret.second);
+  routeAdvertiser_.setInterface(intf);
+}
+
+void IPv6Handler::intfChanged(
+    const Interface* oldIntf,
+    const Interface* newIntf) {
+  if (!raEnabled(newIntf)) {
+    intfDeleted(oldIntf);
+    return;
+  }
+  // Keep sending the RA we have unless its contents changed
+  if (!raEnabled(oldIntf) ||
+      IPv6RouteAdvertiser::advertisementChanged(oldIntf, newIntf)) {
+    routeAdvertiser_.setInterface(newIntf);
+  }
 }
 
 void IPv6Handler::intfDeleted(const Interface* intf) {
   if (!raEnabled(intf)) {
     return;
   }
-  auto numErased = routeAdvertisers_.erase(intf->getID());
-  CHECK_EQ(numErased, 1);
+  routeAdvertiser_.removeInterface(intf->getID());
 }
 
 void IPv6Handler::handlePacket(unique_ptr<RxPacket> pkt,
@@ -163,6 +178,18 @@ void IPv6Handler::handlePacket(unique_ptr<RxPacket> pkt,
           udpHdr, udpCursor);
       return;
     }
+    auto microBfdManager = sw_->getMicroBfdManager();
+    if (microBfdManager &&
+        udpHdr.dstPort == BfdControlPacket::MICRO_BFD_UDP_PORT) {
+      microBfdManager->handlePacket(
+          port, IPAddress(ipv6.srcAddr), ipv6.hopLimit, udpCursor);
+      return;
+    }
+    auto bfdManager = sw_->getBfdManager();
+    if (bfdManager && udpHdr.dstPort == BfdControlPacket::UDP_PORT) {
+      bfdManager->handlePacket(IPAddress(ipv6.srcAddr), ipv6.hopLimit, udpCursor);
+      return;
+    }
   }
 
   // Get the Interface to which this packet should be forwarded in host
@@ -199,6 +226,11 @@ void IPv6Handler::handlePacket(unique_ptr<RxPacket> pkt,
     sw_->portStats(port)->pktDropped();
     sw_->portStats(port)->ipv6HopExceeded();
     // Look up cpu mac from platform
+    if (!icmpRateLimiter_.allow(
+            IcmpRateLimiter::Type::V6_HOP_LIMIT_EXCEEDED, ipv6.srcAddr)) {
+      sw_->portStats(port)->icmpRateLimited();
+      return;
+    }
     MacAddress cpuMac = sw_->getPlatform()->getLocalMac();
     sendICMPv6TimeExceeded(pkt->getSrcVlan(), cpuMac, cpuMac, ipv6, cursor);
     return;
@@ -211,8 +243,13 @@ void IPv6Handler::handlePacket(unique_ptr<RxPacket> pkt,
     PortID portID = pkt->getSrcPort();
     if (ipv6.payloadLength > intf->getMtu()) {
       // Generate PTB as interface to dst intf has MTU smaller than payload
-      sendICMPv6PacketTooBig(
-          portID, pkt->getSrcVlan(), src, dst, ipv6, intf->getMtu(), cursor);
+      if (icmpRateLimiter_.allow(
+              IcmpRateLimiter::Type::V6_PACKET_TOO_BIG, ipv6.srcAddr)) {
+        sendICMPv6PacketTooBig(
+            portID, pkt->getSrcVlan(), src, dst, ipv6, intf->getMtu(), cursor);
+      } else {
+        sw_->portStats(portID)->icmpRateLimited();
+      }
       sw_->portStats(portID)->pktDropped();
       return;
     }
@@ -236,8 +273,6 @@ void IPv6Handler::handlePacket(unique_ptr<RxPacket> pkt,
   if (!ipv6.dstAddr.isMulticast() && !ipv6.dstAddr.isLinkLocalBroadcast()) {
     // If IP is not multicast or linklocal broadcast, we need to resolve the IP
     // for this packet.
-    // TODO: Add rate limiting so we don't generate too many requests for the
-    // same IP.  Following the rules in RFC 4861 should be sufficient.
     resolveDestAndHandlePacket(ipv6, std::move(pkt), dst, src, cursor);
   }
 }
@@ -721,7 +756,7 @@ void IPv6Handler::resolveDestAndHandlePacket(
   auto targetIP = hdr.dstAddr;
   auto state = sw_->getState();
 
-  auto route = sw_->longestMatch(state, targetIP, RouterID(0));
+  auto route = sw_->cachedLongestMatch(state, targetIP, RouterID(0));
   if (!route || !route->isResolved()) {
     sw_->portStats(ingressPort)->ipv6DstLookupFailure();
     // No way to reach targetIP
@@ -730,6 +765,7 @@ void IPv6Handler::resolveDestAndHandlePacket(
 
   auto interfaces = state->getInterfaces();
   auto nexthops = route->getForwardInfo().getNextHopSet();
+  bool queued = false;
 
   for (auto nexthop : nexthops) {
     // get interface needed to reach next hop
@@ -763,24 +799,43 @@ void IPv6Handler::resolveDestAndHandlePacket(
         if (vlan) {
           auto entry = vlan->getNdpTable()->getEntryIf(target);
           if (nullptr == entry) {
-            // No entry in NDP table, create a neighbor solicitation packet
-            sendMulticastNeighborSolicitation(
-                sw_, target, intf->getMac(), vlan->getID());
-            // Notify the updater that we sent a solicitation out
-            sw_->getNeighborUpdater()->sentNeighborSolicitation(vlanID, target);
+            solicitUnlessProbing(target, intf->getMac(), vlanID);
           } else {
             XLOG(DBG5) << "not sending neighbor solicitation for "
                        << target.str() << ", "
                        << ((entry->isPending()) ? "pending" : "")
                        << " entry already exists";
           }
+          if (!queued && (!entry || entry->isPending())) {
+            queued = sw_->getPendingPacketQueue()->enqueue(
+                vlanID, IPAddress(target), pkt.get());
+          }
         }
       }
     }
   }
-  sw_->portStats(pkt)->pktDropped();
+  if (!queued) {
+    sw_->portStats(pkt)->pktDropped();
+  }
 } // namespace fboss
 
+void IPv6Handler::solicitUnlessProbing(
+    const IPAddressV6& target,
+    MacAddress srcMac,
+    VlanID vlanID) {
+  auto updater = sw_->getNeighborUpdater();
+  if (updater->isProbing(vlanID, target)) {
+    // The cache's pending entry has not reached the switch state yet, but
+    // the cache is already sending solicitations for it
+    sw_->stats()->neighborRequestSuppressed();
+    return;
+  }
+  // No entry in NDP table, create a neighbor solicitation packet
+  sendMulticastNeighborSolicitation(sw_, target, srcMac, vlanID);
+  // Notify the updater that we sent a solicitation out
+  updater->sentNeighborSolicitation(vlanID, target);
+}
+
 void IPv6Handler::sendMulticastNeighborSolicitations(
     PortID ingressPort,
     const folly::IPAddressV6& targetIP) {
@@ -791,7 +846,7 @@ void IPv6Handler::sendMulticastNeighborSolicitations(
 
   auto state = sw_->getState();
 
-  auto route = sw_->longestMatch(state, targetIP, RouterID(0));
+  auto route = sw_->cachedLongestMatch(state, targetIP, RouterID(0));
   if (!route || !route->isResolved()) {
     sw_->portStats(ingressPort)->ipv6DstLookupFailure();
     // No way to reach targetIP
@@ -815,12 +870,7 @@ void IPv6Handler::sendMulticastNeighborSolicitations(
       if (vlan) {
         auto entry = vlan->getNdpTable()->getEntryIf(target);
         if (entry == nullptr) {
-          // No entry in NDP table, create a neighbor solicitation packet
-          sendMulticastNeighborSolicitation(
-              sw_, target, intf->getMac(), vlan->getID());
-
-          // Notify the updater that we sent a solicitation out
-          sw_->getNeighborUpdater()->sentNeighborSolicitation(vlanID, target);
+          solicitUnlessProbing(target, intf->getMac(), vlanID);
         } else {
           XLOG(DBG5) << "not sending neighbor solicitation for " << target.str()
                      << ", " << ((entry->isPending()) ? "pending" : "")
@@ -9,6 +9,7 @@
  */
 #pragma once
 
+#include "fboss/agent/IcmpRateLimiter.h"
 #include "fboss/agent/StateObserver.h"
 #include "fboss/agent/ndp/IPv6RouteAdvertiser.h"
 #include "fboss/agent/packet/ICMPHdr.h"
@@ -87,7 +88,6 @@ class IPv6Handler : public AutoRegisterStateObserver {
 
  private:
   struct ICMPHeaders;
-  typedef boost::container::flat_map<InterfaceID, IPv6RouteAdvertiser> RAMap;
 
   // Forbidden copy constructor and assignment operator
   IPv6Handler(IPv6Handler const &) = delete;
@@ -95,6 +95,7 @@ class IPv6Handler : public AutoRegisterStateObserver {
 
   bool raEnabled(const Interface* intf) const;
   void intfAdded(const SwitchState* state, const Interface* intf);
+  void intfChanged(const Interface* oldIntf, const Interface* newIntf);
   void intfDeleted(const Interface* intf);
 
   void sendICMPv6TimeExceeded(VlanID srcVlan,
@@ -160,6 +161,13 @@ class IPv6Handler : public AutoRegisterStateObserver {
       folly::MacAddress src,
       folly::io::Cursor cursor);
 
+  // Solicit target, which is not in the NDP table, unless the neighbor
+  // cache is already probing for it
+  void solicitUnlessProbing(
+      const folly::IPAddressV6& target,
+      folly::MacAddress srcMac,
+      VlanID vlanID);
+
   static void sendNeighborSolicitation(
       SwSwitch* sw,
       const folly::IPAddressV6& dstIP,
@@ -173,7 +181,8 @@ class IPv6Handler : public AutoRegisterStateObserver {
       const NDPOptions& options = NDPOptions());
 
   SwSwitch* sw_{nullptr};
-  RAMap routeAdvertisers_;
+  IPv6RouteAdvertiser routeAdvertiser_;
+  IcmpRateLimiter icmpRateLimiter_;
 };
 
 }} // facebook::fboss
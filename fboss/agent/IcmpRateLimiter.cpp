@@ -0,0 +1,74 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/IcmpRateLimiter.h"
+
+#include <boost/functional/hash.hpp>
+#include <gflags/gflags.h>
+
+#include <algorithm>
+
+DEFINE_int32(
+    icmp_rate_limit_pps,
+    100,
+    "ICMP errors generated per second for each error type and source prefix; "
+    "0 to not rate limit them");
+DEFINE_int32(
+    icmp_rate_limit_burst,
+    100,
+    "ICMP errors of one type that a source prefix may trigger at once");
+DEFINE_int32(
+    icmp_rate_limit_v4_prefix_len,
+    24,
+    "Length of the IPv4 source prefixes that share an ICMP rate limit");
+DEFINE_int32(
+    icmp_rate_limit_v6_prefix_len,
+    64,
+    "Length of the IPv6 source prefixes that share an ICMP rate limit");
+DEFINE_int32(
+    icmp_rate_limit_sources,
+    8192,
+    "Number of source prefixes whose ICMP rate limits are tracked");
+
+namespace facebook { namespace fboss {
+
+IcmpRateLimiter::IcmpRateLimiter()
+    : buckets_(std::max(FLAGS_icmp_rate_limit_sources, 1)) {}
+
+size_t IcmpRateLimiter::KeyHash::operator()(const Key& key) const {
+  size_t hash = std::hash<folly::IPAddress>()(key.prefix);
+  boost::hash_combine(hash, static_cast<uint8_t>(key.type));
+  return hash;
+}
+
+bool IcmpRateLimiter::allow(
+    Type type,
+    const folly::IPAddress& src,
+    double nowInSeconds) {
+  if (FLAGS_icmp_rate_limit_pps <= 0) {
+    return true;
+  }
+  auto prefixLen = src.isV4() ? FLAGS_icmp_rate_limit_v4_prefix_len
+                              : FLAGS_icmp_rate_limit_v6_prefix_len;
+  Key key{type, src.mask(prefixLen)};
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto bucket = buckets_.find(key);
+  if (bucket == buckets_.end()) {
+    double rate = FLAGS_icmp_rate_limit_pps;
+    double burst = std::max(FLAGS_icmp_rate_limit_burst, 1);
+    // Zeroed long enough ago that the new bucket starts full
+    buckets_.set(
+        key, folly::TokenBucket(rate, burst, nowInSeconds - burst / rate));
+    bucket = buckets_.find(key);
+  }
+  return bucket->second.consume(1, nowInSeconds);
+}
+
+}} // facebook::fboss
@@ -0,0 +1,71 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include <folly/IPAddress.h>
+#include <folly/TokenBucket.h>
+#include <folly/container/EvictingCacheMap.h>
+
+#include <mutex>
+
+namespace facebook { namespace fboss {
+
+/*
+ * Token buckets for the ICMP errors the agent generates itself, one per
+ * error type and source prefix of the packets that trigger them. The
+ * handlers check here before building an error, so a traceroute storm or a
+ * flood of packets over the MTU costs a lookup per packet rather than an
+ * allocation and serialization.
+ *
+ * The rate, burst and prefix lengths come from the icmp_rate_limit_* flags.
+ * Only the most recently limited sources are tracked; a source that falls
+ * out of the table starts again with a full bucket.
+ */
+class IcmpRateLimiter {
+ public:
+  enum class Type : uint8_t {
+    V4_TTL_EXCEEDED,
+    V6_HOP_LIMIT_EXCEEDED,
+    V6_PACKET_TOO_BIG,
+  };
+
+  IcmpRateLimiter();
+
+  /*
+   * Whether an error of this type may be sent for a packet from src now. If
+   * so, this takes a token from src's bucket.
+   */
+  bool allow(
+      Type type,
+      const folly::IPAddress& src,
+      double nowInSeconds = folly::TokenBucket::defaultClockNow());
+
+ private:
+  struct Key {
+    Type type;
+    folly::IPAddress prefix;
+
+    bool operator==(const Key& other) const {
+      return type == other.type && prefix == other.prefix;
+    }
+  };
+  struct KeyHash {
+    size_t operator()(const Key& key) const;
+  };
+
+  // Forbidden copy constructor and assignment operator
+  IcmpRateLimiter(IcmpRateLimiter const &) = delete;
+  IcmpRateLimiter& operator=(IcmpRateLimiter const &) = delete;
+
+  std::mutex mutex_;
+  folly::EvictingCacheMap<Key, folly::TokenBucket, KeyHash> buckets_;
+};
+
+}} // facebook::fboss
@@ -153,6 +153,10 @@ void LacpController::ntt() {
   tx_.ntt(LACPDU(actorInfo(), partnerInfo()));
 }
 
+void LacpController::periodicNtt() {
+  tx_.periodicNtt(LACPDU(actorInfo(), partnerInfo()));
+}
+
 PortID LacpController::portID() const {
   return portID_;
 }
@@ -70,6 +70,7 @@ class LacpController : public std::enable_shared_from_this<LacpController> {
   void setActorState(LacpState state);
 
   void ntt();
+  void periodicNtt();
   void selected();
   void selected(folly::Range<std::vector<PortID>::const_iterator> ports);
 
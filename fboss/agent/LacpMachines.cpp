@@ -144,7 +144,7 @@ const std::chrono::seconds ReceiveMachine::SLOW_EPOCH_DURATION(90);
 ReceiveMachine::ReceiveMachine(
     LacpController& controller,
     folly::EventBase* evb)
-    : folly::AsyncTimeout(evb), controller_(controller) {}
+    : LacpTimer::Timeout(evb), controller_(controller) {}
 
 ReceiveMachine::~ReceiveMachine() {}
 
@@ -375,7 +375,7 @@ const std::chrono::seconds PeriodicTransmissionMachine::LONG_PERIOD(30);
 PeriodicTransmissionMachine::PeriodicTransmissionMachine(
     LacpController& controller,
     folly::EventBase* evb)
-    : folly::AsyncTimeout(evb), controller_(controller) {}
+    : LacpTimer::Timeout(evb), controller_(controller) {}
 
 PeriodicTransmissionMachine::~PeriodicTransmissionMachine() {}
 
@@ -431,7 +431,7 @@ void PeriodicTransmissionMachine::timeoutExpired() noexcept {
 
     state_ = PeriodicState::TX;
 
-    controller_.ntt();
+    controller_.periodicNtt();
 
     state_ = determineTransmissionRate();
 
@@ -466,9 +466,14 @@ TransmitMachine::TransmitMachine(
     LacpController& controller,
     folly::EventBase* evb,
     LacpServicerIf* servicer)
-    : folly::AsyncTimeout(evb), controller_(controller), servicer_(servicer) {}
+    : LacpTimer::Timeout(evb), controller_(controller), servicer_(servicer) {}
 
-TransmitMachine::~TransmitMachine() {}
+TransmitMachine::~TransmitMachine() {
+  // controller_ is already being torn down, so use our own EventBase
+  if (getEventBase()->isInEventBaseThread()) {
+    LacpTimer::get(getEventBase()).cancelTransmissions(this);
+  }
+}
 
 void TransmitMachine::start() {
   scheduleTimeout(TransmitMachine::TX_REPLENISH_RATE);
@@ -476,6 +481,7 @@ void TransmitMachine::start() {
 
 void TransmitMachine::stop() {
   cancelTimeout();
+  LacpTimer::get(controller_.evb()).cancelTransmissions(this);
 }
 
 void TransmitMachine::timeoutExpired() noexcept {
@@ -500,14 +506,31 @@ void TransmitMachine::ntt(LACPDU lacpdu) {
   }
 
   auto outPort = controller_.portID();
-  if (!servicer_->transmit(lacpdu, outPort)) {
+  transmitted(lacpdu, servicer_->transmit(lacpdu, outPort));
+}
+
+void TransmitMachine::periodicNtt(LACPDU lacpdu) {
+  CHECK(controller_.evb()->inRunningEventBaseThread());
+
+  if (transmissionsLeft_ == 0) {
+    XLOG(DBG4) << "TransmitMachine[" << controller_.portID() << "]: "
+               << "skipping periodic ntt request";
+    return;
+  }
+
+  LacpTimer::get(controller_.evb())
+      .queueTransmission(this, servicer_, controller_.portID(), lacpdu);
+}
+
+void TransmitMachine::transmitted(const LACPDU& lacpdu, bool sent) {
+  if (!sent) {
     return;
   }
 
   XLOG(DBG4) << "TransmitMachine[" << controller_.portID() << "]: "
              << "TX(" << lacpdu.describe() << ")";
 
-  --transmissionsLeft_;
+  transmissionsLeft_ = std::max(transmissionsLeft_ - 1, 0);
   XLOG(DBG4) << transmissionsLeft_ << " transmissions left";
 }
 
@@ -516,7 +539,7 @@ MuxMachine::MuxMachine(
     LacpController& controller,
     folly::EventBase* evb,
     LacpServicerIf* servicer)
-    : AsyncTimeout(evb), controller_(controller), servicer_(servicer) {}
+    : LacpTimer::Timeout(evb), controller_(controller), servicer_(servicer) {}
 
 MuxMachine::~MuxMachine() {}
 
@@ -9,11 +9,11 @@
  */
 #pragma once
 
-#include <folly/io/async/AsyncTimeout.h>
 #include <folly/Optional.h>
 
 #include <boost/container/flat_map.hpp>
 
+#include "fboss/agent/LacpTimer.h"
 #include "fboss/agent/LacpTypes.h"
 #include "fboss/agent/state/AggregatePort.h"
 #include "fboss/agent/types.h"
@@ -31,7 +31,7 @@ class LacpServicerIf;
  * See IEEE 802.3AD-2000 43.4.3 for an overview of each state machine
  */
 
-class ReceiveMachine : private folly::AsyncTimeout {
+class ReceiveMachine : private LacpTimer::Timeout {
  public:
   explicit ReceiveMachine(LacpController& controller, folly::EventBase* evb);
   ~ReceiveMachine() override;
@@ -94,7 +94,7 @@ class ReceiveMachine : private folly::AsyncTimeout {
 void toAppend(ReceiveMachine::ReceiveState state, std::string* result);
 std::ostream& operator<<(std::ostream& out, ReceiveMachine::ReceiveState s);
 
-class PeriodicTransmissionMachine : private folly::AsyncTimeout {
+class PeriodicTransmissionMachine : private LacpTimer::Timeout {
  public:
   explicit PeriodicTransmissionMachine(
       LacpController& controller,
@@ -128,7 +128,7 @@ void toAppend(
     PeriodicTransmissionMachine::PeriodicState state,
     std::string* result);
 
-class TransmitMachine : private folly::AsyncTimeout {
+class TransmitMachine : private LacpTimer::Timeout {
  public:
   TransmitMachine(
       LacpController& controller,
@@ -137,6 +137,11 @@ class TransmitMachine : private folly::AsyncTimeout {
   ~TransmitMachine() override;
 
   void ntt(LACPDU lacpdu);
+  // Like ntt() but sent in the same batch as every other periodic LACPDU
+  // due this tick
+  void periodicNtt(LACPDU lacpdu);
+  // Invoked by LacpTimer once a batched LACPDU has been handed off
+  void transmitted(const LACPDU& lacpdu, bool sent);
 
   void start();
   void stop();
@@ -155,7 +160,7 @@ class TransmitMachine : private folly::AsyncTimeout {
   LacpServicerIf* servicer_{nullptr};
 };
 
-class MuxMachine : private folly::AsyncTimeout {
+class MuxMachine : private LacpTimer::Timeout {
  public:
   MuxMachine(
       LacpController& controller,
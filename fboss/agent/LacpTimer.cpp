@@ -0,0 +1,127 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/LacpTimer.h"
+
+#include "common/stats/ThreadCachedServiceData.h"
+#include "fboss/agent/LacpMachines.h"
+#include "fboss/agent/LinkAggregationManager.h"
+
+#include <folly/io/async/EventBaseLocal.h>
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <utility>
+
+namespace facebook {
+namespace fboss {
+
+using facebook::stats::AVG;
+using facebook::stats::SUM;
+
+constexpr std::chrono::milliseconds LacpTimer::kTickInterval;
+
+LacpTimer::Timeout::Timeout(folly::EventBase* evb)
+    : evb_(evb), callback_(this) {}
+
+LacpTimer::Timeout::~Timeout() {
+  cancelTimeout();
+}
+
+void LacpTimer::Timeout::scheduleTimeout(std::chrono::milliseconds timeout) {
+  deadline_ = std::chrono::steady_clock::now() + timeout;
+  LacpTimer::get(evb_).wheel().scheduleTimeout(&callback_, timeout);
+}
+
+void LacpTimer::Timeout::cancelTimeout() {
+  callback_.cancelTimeout();
+}
+
+bool LacpTimer::Timeout::isScheduled() const {
+  return callback_.isScheduled();
+}
+
+void LacpTimer::Timeout::Callback::timeoutExpired() noexcept {
+  auto late = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - timeout_->deadline_);
+  LacpTimer::get(timeout_->evb_).recordJitter(late);
+  timeout_->timeoutExpired();
+}
+
+LacpTimer& LacpTimer::get(folly::EventBase* evb) {
+  // Leaked so it outlives any EventBase still holding a LacpTimer at exit
+  static auto* timers = new folly::EventBaseLocal<LacpTimer>();
+  return timers->getOrCreate(*evb, evb);
+}
+
+LacpTimer::LacpTimer(folly::EventBase* evb)
+    : evb_(evb), wheel_(folly::HHWheelTimer::newTimer(evb, kTickInterval)) {}
+
+LacpTimer::~LacpTimer() {
+  cancelLoopCallback();
+}
+
+void LacpTimer::queueTransmission(
+    TransmitMachine* tx,
+    LacpServicerIf* servicer,
+    PortID portID,
+    LACPDU lacpdu) {
+  CHECK(evb_->inRunningEventBaseThread());
+  if (pending_.empty()) {
+    // Runs after every timeout that expired in this loop iteration
+    evb_->runInLoop(this, true /* thisIteration */);
+  }
+  pending_.push_back({tx, servicer, portID, std::move(lacpdu)});
+}
+
+void LacpTimer::cancelTransmissions(TransmitMachine* tx) {
+  pending_.erase(
+      std::remove_if(
+          pending_.begin(),
+          pending_.end(),
+          [tx](const PendingTransmission& p) { return p.tx == tx; }),
+      pending_.end());
+}
+
+void LacpTimer::runLoopCallback() noexcept {
+  auto pending = std::move(pending_);
+  pending_.clear();
+
+  // One submission per servicer; in practice these all go to the one
+  // LinkAggregationManager.
+  while (!pending.empty()) {
+    auto servicer = pending.front().servicer;
+    std::vector<std::pair<LACPDU, PortID>> batch;
+    std::vector<PendingTransmission> rest;
+    std::vector<TransmitMachine*> senders;
+    for (auto& p : pending) {
+      if (p.servicer == servicer) {
+        batch.emplace_back(p.lacpdu, p.portID);
+        senders.push_back(p.tx);
+      } else {
+        rest.push_back(std::move(p));
+      }
+    }
+    pending = std::move(rest);
+
+    auto sent = servicer->transmitBatch(batch);
+    tcData().addStatValue("lacp.tx_batch_size", batch.size(), AVG);
+    for (size_t i = 0; i < batch.size(); ++i) {
+      senders[i]->transmitted(batch[i].first, i < sent.size() && sent[i]);
+    }
+  }
+}
+
+void LacpTimer::recordJitter(std::chrono::milliseconds late) {
+  tcData().addStatValue("lacp.timer_jitter_ms", late.count(), AVG);
+  tcData().addStatValue("lacp.timer_expirations", 1, SUM);
+}
+
+} // namespace fboss
+} // namespace facebook
@@ -0,0 +1,116 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include <folly/io/async/EventBase.h>
+#include <folly/io/async/HHWheelTimer.h>
+
+#include "fboss/agent/LacpTypes.h"
+#include "fboss/agent/types.h"
+
+#include <chrono>
+#include <vector>
+
+namespace facebook {
+namespace fboss {
+
+struct LacpServicerIf;
+class TransmitMachine;
+
+/*
+ * State shared by the LACP state machines of every LacpController running
+ * on one EventBase.
+ *
+ * All of the machines' timers hang off a single hashed timing wheel rather
+ * than each arming its own libevent timer, so fast-rate LACP across many
+ * member ports costs one timer per tick. Periodic LACPDUs that come due in
+ * the same tick are queued here and handed to each servicer as one batch
+ * once the tick's timeouts have run.
+ */
+class LacpTimer : private folly::EventBase::LoopCallback {
+ public:
+  /*
+   * A timeout on the shared wheel. Drop-in replacement for the parts of
+   * folly::AsyncTimeout the machines use.
+   */
+  class Timeout {
+   public:
+    explicit Timeout(folly::EventBase* evb);
+    virtual ~Timeout();
+
+    void scheduleTimeout(std::chrono::milliseconds timeout);
+    void cancelTimeout();
+    bool isScheduled() const;
+
+    folly::EventBase* getEventBase() const {
+      return evb_;
+    }
+
+   protected:
+    virtual void timeoutExpired() noexcept = 0;
+
+   private:
+    class Callback : public folly::HHWheelTimer::Callback {
+     public:
+      explicit Callback(Timeout* timeout) : timeout_(timeout) {}
+      void timeoutExpired() noexcept override;
+      void callbackCanceled() noexcept override {}
+
+     private:
+      Timeout* timeout_;
+    };
+
+    folly::EventBase* evb_;
+    Callback callback_;
+    std::chrono::steady_clock::time_point deadline_;
+  };
+
+  // Must be called from evb's thread
+  static LacpTimer& get(folly::EventBase* evb);
+
+  explicit LacpTimer(folly::EventBase* evb);
+  ~LacpTimer() override;
+
+  folly::HHWheelTimer& wheel() {
+    return *wheel_;
+  }
+
+  void queueTransmission(
+      TransmitMachine* tx,
+      LacpServicerIf* servicer,
+      PortID portID,
+      LACPDU lacpdu);
+  // Drops the transmissions tx has queued, e.g. because it is going away
+  void cancelTransmissions(TransmitMachine* tx);
+
+  static constexpr std::chrono::milliseconds kTickInterval{10};
+
+ private:
+  struct PendingTransmission {
+    TransmitMachine* tx;
+    LacpServicerIf* servicer;
+    PortID portID;
+    LACPDU lacpdu;
+  };
+
+  void runLoopCallback() noexcept override;
+  void recordJitter(std::chrono::milliseconds late);
+
+  folly::EventBase* evb_;
+  folly::HHWheelTimer::UniquePtr wheel_;
+  std::vector<PendingTransmission> pending_;
+
+  // Forbidden copy constructor and assignment operator
+  LacpTimer(LacpTimer const&) = delete;
+  LacpTimer& operator=(LacpTimer const&) = delete;
+};
+
+} // namespace fboss
+} // namespace facebook
@@ -38,9 +38,12 @@ ProgramForwardingState::ProgramForwardingState(
     PortID portID,
     AggregatePortID aggPortID,
     AggregatePort::Forwarding fwdState)
-    : portID_(portID),
-      aggregatePortID_(aggPortID),
-      forwardingState_(fwdState) {}
+    : ProgramForwardingState(aggPortID, {{portID, fwdState}}) {}
+
+ProgramForwardingState::ProgramForwardingState(
+    AggregatePortID aggPortID,
+    MemberForwardingStates memberStates)
+    : aggregatePortID_(aggPortID), memberStates_(std::move(memberStates)) {}
 
 std::shared_ptr<SwitchState> ProgramForwardingState::operator()(
     const std::shared_ptr<SwitchState>& state) {
@@ -52,14 +55,16 @@ std::shared_ptr<SwitchState> ProgramForwardingState::operator()(
     return nullptr;
   }
 
-  XLOG(DBG2) << "Updating " << aggPort->getName() << ": ForwardingState["
-             << nextState->getPorts()->getPort(portID_)->getName() << "] --> "
-             << (forwardingState_ == AggregatePort::Forwarding::ENABLED
-                     ? "ENABLED"
-                     : "DISABLED");
-
   aggPort = aggPort->modify(&nextState);
-  aggPort->setForwardingState(portID_, forwardingState_);
+  for (const auto& memberState : memberStates_) {
+    XLOG(DBG2) << "Updating " << aggPort->getName() << ": ForwardingState["
+               << nextState->getPorts()->getPort(memberState.first)->getName()
+               << "] --> "
+               << (memberState.second == AggregatePort::Forwarding::ENABLED
+                       ? "ENABLED"
+                       : "DISABLED");
+    aggPort->setForwardingState(memberState.first, memberState.second);
+  }
 
   return nextState;
 }
@@ -262,6 +267,27 @@ void LinkAggregationManager::populatePartnerPairs(
 bool LinkAggregationManager::transmit(LACPDU lacpdu, PortID portID) {
   CHECK(sw_->getLacpEvb()->inRunningEventBaseThread());
 
+  return transmit(sw_->getState(), lacpdu, portID);
+}
+
+std::vector<bool> LinkAggregationManager::transmitBatch(
+    const std::vector<std::pair<LACPDU, PortID>>& lacpdus) {
+  CHECK(sw_->getLacpEvb()->inRunningEventBaseThread());
+
+  // One SwitchState snapshot serves the whole tick
+  auto state = sw_->getState();
+  std::vector<bool> sent;
+  sent.reserve(lacpdus.size());
+  for (const auto& lacpdu : lacpdus) {
+    sent.push_back(transmit(state, lacpdu.first, lacpdu.second));
+  }
+  return sent;
+}
+
+bool LinkAggregationManager::transmit(
+    const std::shared_ptr<SwitchState>& state,
+    const LACPDU& lacpdu,
+    PortID portID) {
   auto pkt = sw_->allocatePacket(LACPDU::LENGTH);
   if (!pkt) {
     XLOG(DBG4) << "Failed to allocate tx packet for LACPDU transmission";
@@ -272,7 +298,7 @@ bool LinkAggregationManager::transmit(LACPDU lacpdu, PortID portID) {
 
   folly::MacAddress cpuMac = sw_->getPlatform()->getLocalMac();
 
-  auto port = sw_->getState()->getPorts()->getPortIf(portID);
+  auto port = state->getPorts()->getPortIf(portID);
   CHECK(port);
 
   TxPacket::writeEthHeader(
@@ -298,11 +324,13 @@ void LinkAggregationManager::enableForwarding(
     AggregatePortID aggPortID) {
   CHECK(sw_->getLacpEvb()->inRunningEventBaseThread());
 
-  auto enableFwdStateFn = ProgramForwardingState(
-      portID, aggPortID, AggregatePort::Forwarding::ENABLED);
-
-  sw_->updateStateNoCoalescing(
-      "AggregatePort ForwardingState", std::move(enableFwdStateFn));
+  lacpForwarding_.insert(portID);
+  if (microBfdDown_.count(portID)) {
+    XLOG(DBG2) << "Not enabling forwarding on port " << portID
+               << " while its micro-BFD session is down";
+    return;
+  }
+  queueForwardingState(portID, aggPortID, AggregatePort::Forwarding::ENABLED);
 }
 
 void LinkAggregationManager::disableForwarding(
@@ -310,11 +338,53 @@ void LinkAggregationManager::disableForwarding(
     AggregatePortID aggPortID) {
   CHECK(sw_->getLacpEvb()->inRunningEventBaseThread());
 
-  auto disableFwdStateFn = ProgramForwardingState(
-      portID, aggPortID, AggregatePort::Forwarding::DISABLED);
+  lacpForwarding_.erase(portID);
+  queueForwardingState(portID, aggPortID, AggregatePort::Forwarding::DISABLED);
+}
+
+void LinkAggregationManager::microBfdStateChanged(
+    PortID portID,
+    AggregatePortID aggPortID,
+    bool up) {
+  CHECK(sw_->getLacpEvb()->inRunningEventBaseThread());
+
+  if (up) {
+    microBfdDown_.erase(portID);
+  } else {
+    microBfdDown_.insert(portID);
+  }
+  if (!lacpForwarding_.count(portID)) {
+    return;
+  }
+  queueForwardingState(
+      portID,
+      aggPortID,
+      up ? AggregatePort::Forwarding::ENABLED
+         : AggregatePort::Forwarding::DISABLED);
+}
+
+void LinkAggregationManager::queueForwardingState(
+    PortID portID,
+    AggregatePortID aggPortID,
+    AggregatePort::Forwarding fwdState) {
+  if (pendingForwardingStates_.empty()) {
+    sw_->getLacpEvb()->runInLoop(this, true /* thisIteration */);
+  }
+  // A later change to the same member within the tick supersedes earlier ones
+  pendingForwardingStates_[aggPortID][portID] = fwdState;
+}
+
+void LinkAggregationManager::runLoopCallback() noexcept {
+  auto pending = std::move(pendingForwardingStates_);
+  pendingForwardingStates_.clear();
 
-  sw_->updateStateNoCoalescing(
-      "AggregatePort ForwardingState", std::move(disableFwdStateFn));
+  for (auto& aggPortAndMembers : pending) {
+    sw_->updateStateNoCoalescing(
+        "AggregatePort ForwardingState",
+        ProgramForwardingState(
+            aggPortAndMembers.first, std::move(aggPortAndMembers.second)),
+        StateUpdate::Priority::LINK);
+  }
 }
 
 std::vector<std::shared_ptr<LacpController>>
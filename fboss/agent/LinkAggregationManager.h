@@ -15,11 +15,14 @@
 #include "fboss/agent/types.h"
 
 #include <boost/container/flat_map.hpp>
+#include <boost/container/flat_set.hpp>
 
 #include <folly/SharedMutex.h>
 #include <folly/io/Cursor.h>
+#include <folly/io/async/EventBase.h>
 
 #include <memory>
+#include <utility>
 #include <vector>
 
 namespace facebook {
@@ -36,6 +39,16 @@ struct LacpServicerIf {
   virtual ~LacpServicerIf() {}
 
   virtual bool transmit(LACPDU lacpdu, PortID portID) = 0;
+  // Transmits the periodic LACPDUs of every port due in the same tick.
+  // Returns whether each was sent.
+  virtual std::vector<bool> transmitBatch(
+      const std::vector<std::pair<LACPDU, PortID>>& lacpdus) {
+    std::vector<bool> sent;
+    for (const auto& lacpdu : lacpdus) {
+      sent.push_back(transmit(lacpdu.first, lacpdu.second));
+    }
+    return sent;
+  }
   virtual void enableForwarding(PortID portID, AggregatePortID aggPortID) = 0;
   virtual void disableForwarding(PortID portID, AggregatePortID aggPortID) = 0;
   // If Selector was a static member of LinkAggregationManager, this wouldn't be
@@ -46,21 +59,27 @@ struct LacpServicerIf {
 
 class ProgramForwardingState {
  public:
+  using MemberForwardingStates =
+      boost::container::flat_map<PortID, AggregatePort::Forwarding>;
+
   ProgramForwardingState(
       PortID portID,
       AggregatePortID aggPortID,
       AggregatePort::Forwarding fwdState);
+  ProgramForwardingState(
+      AggregatePortID aggPortID,
+      MemberForwardingStates memberStates);
   std::shared_ptr<SwitchState> operator()(
       const std::shared_ptr<SwitchState>& state);
 
  private:
-  PortID portID_;
   AggregatePortID aggregatePortID_;
-  AggregatePort::Forwarding forwardingState_;
+  MemberForwardingStates memberStates_;
 };
 
 class LinkAggregationManager : public AutoRegisterStateObserver,
-                               public LacpServicerIf {
+                               public LacpServicerIf,
+                               private folly::EventBase::LoopCallback {
  public:
   explicit LinkAggregationManager(SwSwitch* sw);
   ~LinkAggregationManager() override;
@@ -72,11 +91,19 @@ class LinkAggregationManager : public AutoRegisterStateObserver,
   void populatePartnerPairs(std::vector<LacpPartnerPair>& partnerPairs);
 
   bool transmit(LACPDU lacpdu, PortID portID) override;
+  std::vector<bool> transmitBatch(
+      const std::vector<std::pair<LACPDU, PortID>>& lacpdus) override;
   void enableForwarding(PortID portID, AggregatePortID aggPortID) override;
   void disableForwarding(PortID portID, AggregatePortID aggPortID) override;
   std::vector<std::shared_ptr<LacpController>> getControllersFor(
       folly::Range<std::vector<PortID>::const_iterator> ports) override;
 
+  /*
+   * A member whose micro-BFD session is down is kept out of forwarding
+   * whatever LACP decides. Must be called from the LACP EventBase.
+   */
+  void microBfdStateChanged(PortID portID, AggregatePortID aggPortID, bool up);
+
  private:
   void aggregatePortRemoved(const std::shared_ptr<AggregatePort>& aggPort);
   void aggregatePortAdded(const std::shared_ptr<AggregatePort>& aggPort);
@@ -87,6 +114,22 @@ class LinkAggregationManager : public AutoRegisterStateObserver,
       const std::shared_ptr<Port>& oldPort,
       const std::shared_ptr<Port>& newPort);
 
+  /*
+   * Forwarding changes are collected for the rest of the LACP EventBase's
+   * loop iteration, so when a whole LAG flaps the members of each
+   * AggregatePort are reprogrammed with one state update.
+   */
+  void queueForwardingState(
+      PortID portID,
+      AggregatePortID aggPortID,
+      AggregatePort::Forwarding fwdState);
+  void runLoopCallback() noexcept override;
+
+  bool transmit(
+      const std::shared_ptr<SwitchState>& state,
+      const LACPDU& lacpdu,
+      PortID portID);
+
   void updateAggregatePortStats(
       const std::shared_ptr<AggregatePort>& oldAggPort,
       const std::shared_ptr<AggregatePort>& newAggPort);
@@ -103,6 +146,15 @@ class LinkAggregationManager : public AutoRegisterStateObserver,
 
   PortIDToController portToController_;
   mutable folly::SharedMutexWritePriority controllersLock_;
+
+  // Only accessed from the LACP EventBase
+  boost::container::flat_map<
+      AggregatePortID,
+      ProgramForwardingState::MemberForwardingStates>
+      pendingForwardingStates_;
+  // Members LACP has enabled, and members whose micro-BFD session is down
+  boost::container::flat_set<PortID> lacpForwarding_;
+  boost::container::flat_set<PortID> microBfdDown_;
   SwSwitch* sw_{nullptr};
 };
 } // namespace fboss
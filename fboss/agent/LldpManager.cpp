@@ -16,6 +16,8 @@
 #include <folly/io/Cursor.h>
 #include <folly/logging/xlog.h>
 #include <unistd.h>
+#include <array>
+#include <cstring>
 #include "fboss/agent/RxPacket.h"
 #include "fboss/agent/SwSwitch.h"
 #include "fboss/agent/SwitchStats.h"
@@ -148,14 +150,35 @@ void LldpManager::timeoutExpired() noexcept {
 void LldpManager::sendLldpOnAllPorts() {
   // send lldp frames through all the ports here.
   std::shared_ptr<SwitchState> state = sw_->getState();
+  MacAddress cpuMac = sw_->getPlatform()->getLocalMac();
+
+  const size_t kMaxLen = 64;
+  std::array<char, kMaxLen> hostnameBuf;
+  if (0 == gethostname(hostnameBuf.data(), kMaxLen)) {
+    // make sure it is null terminated
+    hostnameBuf[kMaxLen - 1] = '\0';
+  } else {
+    hostnameBuf[0] = '\0';
+  }
+  std::string hostname(hostnameBuf.data());
+
   for (const auto& port : *state->getPorts()) {
     if (port->isPortUp()) {
-      sendLldpInfo(port);
+      sendLldpInfo(port, cpuMac, hostname);
     } else {
       XLOG(DBG5) << "Skipping LLDP send as this port is disabled "
                  << port->getID();
     }
   }
+
+  // Forget the frames of ports that have gone away
+  for (auto it = frameTemplates_.begin(); it != frameTemplates_.end();) {
+    if (state->getPorts()->getPortIf(it->first)) {
+      ++it;
+    } else {
+      it = frameTemplates_.erase(it);
+    }
+  }
 }
 
 uint16_t tlvHeader(uint16_t type, uint16_t length) {
@@ -293,24 +316,44 @@ LldpManager::createLldpPkt(SwSwitch* sw,
   return pkt;
 }
 
-void LldpManager::sendLldpInfo(const std::shared_ptr<Port>& port) {
-  MacAddress cpuMac = sw_->getPlatform()->getLocalMac();
-  PortID thisPortID = port->getID();
-
-  const size_t kMaxLen = 64;
-  std::array<char, kMaxLen> hostname;
-  if (0 == gethostname(hostname.data(), kMaxLen)) {
-    // make sure it is null terminated
-    hostname[kMaxLen - 1] = '\0';
-  } else {
-    hostname[0] = '\0';
+const folly::IOBuf& LldpManager::getFrameTemplate(
+    const std::shared_ptr<Port>& port,
+    const MacAddress& cpuMac,
+    const std::string& hostname) {
+  auto& tmpl = frameTemplates_[port->getID()];
+  if (tmpl.frame && tmpl.cpuMac == cpuMac &&
+      tmpl.vlan == port->getIngressVlan() && tmpl.hostname == hostname &&
+      tmpl.portName == port->getName() &&
+      tmpl.portDesc == port->getDescription()) {
+    return *tmpl.frame;
   }
 
   auto pkt = LldpManager::createLldpPkt(sw_, cpuMac, port->getIngressVlan(),
-                                        std::string(hostname.data()),
+                                        hostname,
                                         port->getName(), port->getDescription(),
                                         TTL_TLV_VALUE,
                                         SYSTEM_CAPABILITY_ROUTER);
+  tmpl.cpuMac = cpuMac;
+  tmpl.vlan = port->getIngressVlan();
+  tmpl.hostname = hostname;
+  tmpl.portName = port->getName();
+  tmpl.portDesc = port->getDescription();
+  // Keep our own copy rather than holding on to a switch packet buffer
+  tmpl.frame =
+      folly::IOBuf::copyBuffer(pkt->buf()->data(), pkt->buf()->length());
+  XLOG(DBG4) << "rebuilt LLDP frame for port " << port->getID();
+  return *tmpl.frame;
+}
+
+void LldpManager::sendLldpInfo(
+    const std::shared_ptr<Port>& port,
+    const MacAddress& cpuMac,
+    const std::string& hostname) {
+  PortID thisPortID = port->getID();
+
+  const auto& frame = getFrameTemplate(port, cpuMac, hostname);
+  auto pkt = sw_->allocatePacket(frame.length());
+  memcpy(pkt->buf()->writableData(), frame.data(), frame.length());
 
   // this LLDP packet HAS to exit out of the port specified here.
   sw_->sendNetworkControlPacketAsync(
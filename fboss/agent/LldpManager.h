@@ -9,9 +9,13 @@
  */
 // Copyright 2014-present Facebook. All Rights Reserved.
 #pragma once
+#include <boost/container/flat_map.hpp>
+#include <folly/MacAddress.h>
+#include <folly/io/IOBuf.h>
 #include <folly/io/async/AsyncTimeout.h>
 #include <unordered_map>
 #include <memory>
+#include <string>
 #include "fboss/agent/Platform.h"
 #include "fboss/agent/lldp/LinkNeighborDB.h"
 #include "fboss/agent/state/Port.h"
@@ -106,12 +110,34 @@ class LldpManager : private folly::AsyncTimeout {
                          const std::string& sysDesc);
 
  private:
+  /*
+   * The serialized LLDPDU for a port along with everything it encodes, so
+   * the periodic send only has to copy it out until one of those changes.
+   */
+  struct FrameTemplate {
+    folly::MacAddress cpuMac;
+    VlanID vlan{0};
+    std::string hostname;
+    std::string portName;
+    std::string portDesc;
+    std::unique_ptr<folly::IOBuf> frame;
+  };
+
   void timeoutExpired() noexcept override;
-  void sendLldpInfo(const std::shared_ptr<Port>& port);
+  void sendLldpInfo(
+      const std::shared_ptr<Port>& port,
+      const folly::MacAddress& cpuMac,
+      const std::string& hostname);
+  const folly::IOBuf& getFrameTemplate(
+      const std::shared_ptr<Port>& port,
+      const folly::MacAddress& cpuMac,
+      const std::string& hostname);
 
   SwSwitch* sw_{nullptr};
   std::chrono::milliseconds intervalMsecs_;
   LinkNeighborDB db_;
+  // Only used from sendLldpOnAllPorts()
+  boost::container::flat_map<PortID, FrameTemplate> frameTemplates_;
 };
 
 }} // facebook::fboss
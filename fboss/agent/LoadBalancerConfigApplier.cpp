@@ -51,6 +51,23 @@ std::shared_ptr<LoadBalancer> LoadBalancerConfigParser::parse(
   auto seed = cfg.__isset.seed
       ? cfg.seed_ref().value_unchecked()
       : LoadBalancer::generateDeterministicSeed(loadBalancerID, platform_);
+  uint32_t resilientFlowsetSize = 0;
+  if (cfg.__isset.resilientFlowsetSize) {
+    if (loadBalancerID != LoadBalancerID::ECMP) {
+      throw FbossError(
+          "LoadBalancer ",
+          loadBalancerID,
+          ": resilient hashing is only supported for ECMP");
+    }
+    if (cfg.resilientFlowsetSize_ref().value_unchecked() <= 0) {
+      throw FbossError(
+          "LoadBalancer ",
+          loadBalancerID,
+          ": invalid resilient flowset size ",
+          cfg.resilientFlowsetSize_ref().value_unchecked());
+    }
+    resilientFlowsetSize = cfg.resilientFlowsetSize_ref().value_unchecked();
+  }
 
   return std::make_shared<LoadBalancer>(
       loadBalancerID,
@@ -58,7 +75,8 @@ std::shared_ptr<LoadBalancer> LoadBalancerConfigParser::parse(
       seed,
       std::get<0>(fields),
       std::get<1>(fields),
-      std::get<2>(fields));
+      std::get<2>(fields),
+      resilientFlowsetSize);
 }
 
 LoadBalancerConfigApplier::LoadBalancerConfigApplier(
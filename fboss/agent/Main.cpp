@@ -22,12 +22,14 @@
 #include "common/stats/ServiceData.h"
 #include "fboss/agent/AgentConfig.h"
 #include "fboss/agent/ApplyThriftConfig.h"
+#include "fboss/agent/BootTrace.h"
 #include "fboss/agent/HwSwitch.h"
 #include "fboss/agent/Platform.h"
 #include "fboss/agent/RestartTimeTracker.h"
 #include "fboss/agent/SetupThrift.h"
 #include "fboss/agent/SwSwitch.h"
 #include "fboss/agent/SwitchStats.h"
+#include "fboss/agent/ThreadPlacement.h"
 #include "fboss/agent/ThriftHandler.h"
 #include "fboss/agent/TunManager.h"
 
@@ -68,6 +70,10 @@ DEFINE_bool(publish_boot_type, true,
             "Publish boot type on startup");
 DEFINE_int32(flush_warmboot_cache_secs, 60,
     "Seconds to wait before flushing warm boot cache");
+DEFINE_int32(warm_boot_checkpoint_interval_s, 0,
+    "How often to convert the switch state for warm boot ahead of a graceful "
+    "exit, which then only has to if the state changed since. This keeps a "
+    "copy of the state in memory. 0 to only convert it on exit");
 DECLARE_int32(thrift_idle_timeout);
 DEFINE_bool(
     enable_standalone_rib,
@@ -141,6 +147,7 @@ class Initializer {
   }
 
   void initImpl() {
+    boot_trace::Span span("Initializer::initImpl");
     auto startTime = steady_clock::now();
     std::lock_guard<mutex> g(initLock_);
     // Determining the local MAC address can also take a few seconds the first
@@ -190,6 +197,13 @@ class Initializer {
     fs_->addFunction(flushWarmbootFunc, seconds(1), flushWarmboot,
         seconds(FLAGS_flush_warmboot_cache_secs)/*initial delay*/);
 
+    if (FLAGS_warm_boot_checkpoint_interval_s > 0) {
+      fs_->addFunction(
+          [=]() { sw_->checkpointWarmBootState(); },
+          seconds(FLAGS_warm_boot_checkpoint_interval_s),
+          "checkpointWarmBootState");
+    }
+
     fs_->start();
     XLOG(INFO) << "Started background thread: UpdateStatsThread";
     initCondition_.notify_all();
@@ -267,6 +281,7 @@ int fbossMain(int argc, char** argv, PlatformInitFn initPlatform) {
   initFlagDefaults(config->thrift.defaultCommandLineArgs);
 
   fbossInit(argc, argv);
+  thread_placement::init(config->thrift.threads);
 
   // Allow the fb303 setOption() call to update the command line flag
   // settings.  This allows us to change the log levels on the fly using
@@ -0,0 +1,302 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/MicroBfdManager.h"
+
+#include "fboss/agent/BfdManager.h"
+#include "fboss/agent/FbossError.h"
+#include "fboss/agent/LinkAggregationManager.h"
+#include "fboss/agent/Platform.h"
+#include "fboss/agent/SwSwitch.h"
+#include "fboss/agent/TxPacket.h"
+#include "fboss/agent/Utils.h"
+#include "fboss/agent/state/AggregatePortMap.h"
+#include "fboss/agent/state/DeltaFunctions.h"
+#include "fboss/agent/state/Port.h"
+#include "fboss/agent/state/PortMap.h"
+#include "fboss/agent/state/StateDelta.h"
+#include "fboss/agent/state/SwitchState.h"
+
+#include <folly/ExceptionString.h>
+#include <folly/Random.h>
+#include <folly/io/async/AsyncTimeout.h>
+#include <folly/logging/xlog.h>
+
+#include <algorithm>
+
+using std::chrono::duration_cast;
+using std::chrono::microseconds;
+using std::chrono::milliseconds;
+
+namespace {
+// RFC 5881 section 4: single hop BFD is sent and received with a TTL of 255
+constexpr uint8_t kTtl = 255;
+} // namespace
+
+namespace facebook {
+namespace fboss {
+
+class MicroBfdManager::Session : private folly::AsyncTimeout {
+ public:
+  Session(
+      MicroBfdManager* manager,
+      PortID port,
+      AggregatePortID aggPortID,
+      const AggregatePort::MicroBfd& config,
+      uint32_t discriminator)
+      : folly::AsyncTimeout(manager->thread_.getEventBase()),
+        manager_(manager),
+        port_(port),
+        aggPortID_(aggPortID),
+        config_(config),
+        session_(
+            discriminator,
+            duration_cast<microseconds>(config.interval),
+            config.detectMultiplier) {}
+
+  void start() {
+    transmit(BfdSession::Clock::now());
+  }
+
+  void received(const BfdControlPacket& packet) {
+    auto now = BfdSession::Clock::now();
+    auto changed = session_.received(packet, now);
+    if (changed) {
+      XLOG(DBG2) << "Micro-BFD session on port " << port_ << " is now "
+                 << static_cast<int>(session_.getState());
+      reportState();
+    }
+    // Answer a Poll, and tell the peer of a new state, without waiting
+    if (changed || session_.finalPending()) {
+      transmit(now);
+    } else {
+      schedule(now);
+    }
+  }
+
+  AggregatePortID getAggregatePortID() const {
+    return aggPortID_;
+  }
+
+  const AggregatePort::MicroBfd& getConfig() const {
+    return config_;
+  }
+
+ private:
+  void timeoutExpired() noexcept override {
+    auto now = BfdSession::Clock::now();
+    if (session_.checkDetectionTime(now)) {
+      XLOG(WARNING) << "Micro-BFD detection time expired on port " << port_;
+      reportState();
+    }
+    if (now >= nextTransmit_) {
+      transmit(now);
+    } else {
+      schedule(now);
+    }
+  }
+
+  void transmit(BfdSession::Clock::time_point now) {
+    manager_->transmit(port_, config_.peer, session_.nextPacket());
+
+    // RFC 5880 section 6.8.7: each interval is cut by up to a quarter, and
+    // by at least a tenth with a detect multiplier of one
+    auto percent = folly::Random::rand32(
+        75, config_.detectMultiplier == 1 ? 90 : 100);
+    nextTransmit_ = now + session_.txInterval() * percent / 100;
+    schedule(now);
+  }
+
+  void schedule(BfdSession::Clock::time_point now) {
+    auto next = nextTransmit_;
+    auto deadline = session_.detectionDeadline();
+    if (deadline) {
+      next = std::min(next, *deadline);
+    }
+    auto wait = next > now ? duration_cast<milliseconds>(next - now)
+                           : milliseconds(0);
+    scheduleTimeout(wait);
+  }
+
+  void reportState() {
+    auto up = session_.getState() == BfdSession::State::UP;
+    if (up != reportedUp_) {
+      reportedUp_ = up;
+      manager_->sessionStateChanged(port_, aggPortID_, up);
+    }
+  }
+
+  MicroBfdManager* manager_{nullptr};
+  const PortID port_;
+  const AggregatePortID aggPortID_;
+  const AggregatePort::MicroBfd config_;
+  BfdSession session_;
+  BfdSession::Clock::time_point nextTransmit_;
+  bool reportedUp_{false};
+};
+
+MicroBfdManager::MicroBfdManager(SwSwitch* sw)
+    : AutoRegisterStateObserver(sw, "MicroBfdManager"),
+      sw_(sw),
+      thread_("MicroBfd") {}
+
+MicroBfdManager::~MicroBfdManager() {
+  thread_.getEventBase()->runInEventBaseThreadAndWait(
+      [this] { sessions_.clear(); });
+}
+
+void MicroBfdManager::stateUpdated(const StateDelta& delta) {
+  if (DeltaFunctions::isEmpty(delta.getAggregatePortsDelta())) {
+    return;
+  }
+
+  std::map<PortID, MemberConfig> members;
+  for (const auto& aggPort : *delta.newState()->getAggregatePorts()) {
+    const auto& microBfd = aggPort->getMicroBfd();
+    if (!microBfd) {
+      continue;
+    }
+    for (const auto& subport : aggPort->sortedSubports()) {
+      members.emplace(
+          subport.portID, MemberConfig(aggPort->getID(), *microBfd));
+    }
+  }
+
+  thread_.getEventBase()->runInEventBaseThread(
+      [this, members = std::move(members)]() mutable {
+        updateSessions(std::move(members));
+      });
+}
+
+void MicroBfdManager::updateSessions(std::map<PortID, MemberConfig> members) {
+  for (auto it = sessions_.begin(); it != sessions_.end();) {
+    auto member = members.find(it->first);
+    if (member != members.end() &&
+        member->second.first == it->second->getAggregatePortID() &&
+        member->second.second == it->second->getConfig()) {
+      members.erase(member);
+      ++it;
+      continue;
+    }
+    // Leave forwarding of the member to LACP again
+    sessionStateChanged(it->first, it->second->getAggregatePortID(), true);
+    it = sessions_.erase(it);
+  }
+
+  for (const auto& member : members) {
+    auto discriminator = nextDiscriminator_++;
+    if (nextDiscriminator_ == 0) {
+      nextDiscriminator_ = 1;
+    }
+    auto session = std::make_unique<Session>(
+        this,
+        member.first,
+        member.second.first,
+        member.second.second,
+        discriminator);
+    // The member stays out of forwarding until its session comes up
+    sessionStateChanged(member.first, member.second.first, false);
+    session->start();
+    sessions_.emplace(member.first, std::move(session));
+  }
+}
+
+void MicroBfdManager::handlePacket(
+    PortID port,
+    const folly::IPAddress& src,
+    uint8_t ttl,
+    folly::io::Cursor cursor) {
+  if (ttl != kTtl) {
+    XLOG(DBG3) << "Dropping micro-BFD packet on port " << port
+               << " with TTL " << static_cast<int>(ttl);
+    return;
+  }
+
+  BfdControlPacket packet;
+  try {
+    packet = BfdControlPacket::from(&cursor);
+  } catch (const std::exception& ex) {
+    XLOG(DBG3) << "Dropping malformed micro-BFD packet on port " << port
+               << ": " << folly::exceptionStr(ex);
+    return;
+  }
+  if (!packet.isValid()) {
+    XLOG(DBG3) << "Dropping invalid micro-BFD packet on port " << port << ": "
+               << packet.describe();
+    return;
+  }
+
+  thread_.getEventBase()->runInEventBaseThread(
+      [this, port, src, packet] { received(port, src, packet); });
+}
+
+void MicroBfdManager::received(
+    PortID port,
+    const folly::IPAddress& src,
+    const BfdControlPacket& packet) {
+  auto it = sessions_.find(port);
+  if (it == sessions_.end() || it->second->getConfig().peer != src) {
+    XLOG(DBG3) << "No micro-BFD session on port " << port << " for " << src;
+    return;
+  }
+  it->second->received(packet);
+}
+
+void MicroBfdManager::transmit(
+    PortID port,
+    const folly::IPAddress& peer,
+    const BfdControlPacket& packet) {
+  auto state = sw_->getState();
+  auto swPort = state->getPorts()->getPortIf(port);
+  if (!swPort) {
+    return;
+  }
+  auto vlan = swPort->getIngressVlan();
+
+  std::unique_ptr<TxPacket> pkt;
+  try {
+    auto srcIp = peer.isV4() ? folly::IPAddress(getSwitchVlanIP(state, vlan))
+                             : folly::IPAddress(getSwitchVlanIPv6(state, vlan));
+    pkt = BfdManager::makePacket(
+        sw_,
+        BfdControlPacket::kMicroBfdDstMac(),
+        sw_->getPlatform()->getLocalMac(),
+        vlan,
+        srcIp,
+        peer,
+        BfdControlPacket::MICRO_BFD_UDP_PORT,
+        packet);
+  } catch (const FbossError& ex) {
+    XLOG(ERR) << "Cannot send micro-BFD on port " << port << ": "
+              << folly::exceptionStr(ex);
+    return;
+  }
+  if (!pkt) {
+    return;
+  }
+
+  // Sent out of the member itself, not hashed across the LAG
+  sw_->sendNetworkControlPacketAsync(std::move(pkt), PortDescriptor(port));
+}
+
+void MicroBfdManager::sessionStateChanged(
+    PortID port,
+    AggregatePortID aggPortID,
+    bool up) {
+  auto lagManager = sw_->getLagManager();
+  if (!lagManager) {
+    return;
+  }
+  sw_->getLacpEvb()->runInEventBaseThread([lagManager, port, aggPortID, up] {
+    lagManager->microBfdStateChanged(port, aggPortID, up);
+  });
+}
+
+} // namespace fboss
+} // namespace facebook
@@ -0,0 +1,84 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include "fboss/agent/BfdSession.h"
+#include "fboss/agent/StateObserver.h"
+#include "fboss/agent/state/AggregatePort.h"
+#include "fboss/agent/types.h"
+
+#include <folly/IPAddress.h>
+#include <folly/io/Cursor.h>
+#include <folly/io/async/ScopedEventBaseThread.h>
+
+#include <map>
+#include <memory>
+#include <utility>
+
+namespace facebook {
+namespace fboss {
+
+class StateDelta;
+class SwSwitch;
+
+/*
+ * Runs an RFC 7130 micro-BFD session on every member of each AggregatePort
+ * with micro-BFD configured. A member whose session is not up is kept out of
+ * forwarding by the LinkAggregationManager, whatever LACP decides, so a link
+ * that fails without losing carrier leaves the LAG within the detection time
+ * rather than after the LACP timeout.
+ *
+ * The sessions run on their own thread so that their timers are not held up
+ * behind LACP or the rx path.
+ */
+class MicroBfdManager : public AutoRegisterStateObserver {
+ public:
+  explicit MicroBfdManager(SwSwitch* sw);
+  ~MicroBfdManager() override;
+
+  void stateUpdated(const StateDelta& delta) override;
+
+  // Takes a micro-BFD packet received on port, with the UDP header read
+  void handlePacket(
+      PortID port,
+      const folly::IPAddress& src,
+      uint8_t ttl,
+      folly::io::Cursor cursor);
+
+ private:
+  class Session;
+  using MemberConfig = std::pair<AggregatePortID, AggregatePort::MicroBfd>;
+
+  void updateSessions(std::map<PortID, MemberConfig> members);
+  void received(
+      PortID port,
+      const folly::IPAddress& src,
+      const BfdControlPacket& packet);
+  void transmit(
+      PortID port,
+      const folly::IPAddress& peer,
+      const BfdControlPacket& packet);
+  void sessionStateChanged(PortID port, AggregatePortID aggPortID, bool up);
+
+  // Forbidden copy constructor and assignment operator
+  MicroBfdManager(MicroBfdManager const&) = delete;
+  MicroBfdManager& operator=(MicroBfdManager const&) = delete;
+
+  SwSwitch* sw_{nullptr};
+
+  // Only accessed from thread_
+  std::map<PortID, std::unique_ptr<Session>> sessions_;
+  uint32_t nextDiscriminator_{1};
+
+  folly::ScopedEventBaseThread thread_;
+};
+
+} // namespace fboss
+} // namespace facebook
@@ -2,6 +2,7 @@
 #include "fboss/agent/MirrorManager.h"
 
 #include <tuple>
+#include <vector>
 #include <boost/container/flat_set.hpp>
 #include "fboss/agent/state/DeltaFunctions.h"
 #include "fboss/agent/state/Interface.h"
@@ -10,46 +11,179 @@
 #include "fboss/agent/state/RouteTable.h"
 #include "fboss/agent/state/RouteTableRib.h"
 #include "fboss/agent/state/SwitchState.h"
+#include "fboss/agent/state/Vlan.h"
+#include "fboss/lib/RadixTree.h"
 
 using boost::container::flat_set;
-using facebook::fboss::DeltaFunctions::isEmpty;
 using folly::IPAddress;
 using folly::Optional;
 
 namespace facebook {
 namespace fboss {
 
+namespace {
+
+struct NeighborChanges {
+  // MACs of neighbors that changed or went away
+  flat_set<folly::MacAddress> macs;
+  bool any{false};
+  bool added{false};
+};
+
+template <typename NeighborDelta>
+void collectNeighborChanges(
+    const NeighborDelta& delta,
+    NeighborChanges* changes) {
+  using EntryT = typename NeighborDelta::Node;
+  DeltaFunctions::forEachChanged(
+      delta,
+      [&](const std::shared_ptr<EntryT>& oldEntry,
+          const std::shared_ptr<EntryT>& /*newEntry*/) {
+        changes->macs.insert(oldEntry->getMac());
+        changes->any = true;
+      },
+      [&](const std::shared_ptr<EntryT>& /*newEntry*/) {
+        changes->any = true;
+        changes->added = true;
+      },
+      [&](const std::shared_ptr<EntryT>& oldEntry) {
+        changes->macs.insert(oldEntry->getMac());
+        changes->any = true;
+      });
+}
+
+template <typename RoutesDelta>
+void collectRouteChanges(
+    const RoutesDelta& delta,
+    network::RadixTree<IPAddress, bool>* changedPrefixes) {
+  using RouteT = typename RoutesDelta::Node;
+  auto insert = [&](const std::shared_ptr<RouteT>& route) {
+    const auto& prefix = route->prefix();
+    changedPrefixes->insert(IPAddress(prefix.network), prefix.mask, true);
+  };
+  DeltaFunctions::forEachChanged(
+      delta,
+      [&](const std::shared_ptr<RouteT>& /*oldRoute*/,
+          const std::shared_ptr<RouteT>& newRoute) { insert(newRoute); },
+      insert,
+      insert);
+}
+
+} // namespace
+
 void MirrorManager::stateUpdated(const StateDelta& delta) {
-  if (!hasMirrorChanges(delta)) {
+  if (delta.newState()->getMirrors()->size() == 0) {
+    return;
+  }
+  auto affected = affectedMirrors(delta);
+  if (affected.empty()) {
     return;
   }
 
+  bool scheduled = !pendingMirrors_.empty();
+  pendingMirrors_.insert(affected.begin(), affected.end());
+  if (scheduled) {
+    // The update already queued will pick these up too
+    return;
+  }
   auto updateMirrorsFn = [this](const std::shared_ptr<SwitchState>& state) {
-    return resolveMirrors(state);
+    auto ids = std::move(pendingMirrors_);
+    pendingMirrors_.clear();
+    return resolveMirrors(state, ids);
   };
-  sw_->updateState("Updating mirrors", updateMirrorsFn);
+  sw_->updateState(
+      "Updating mirrors", updateMirrorsFn, StateUpdate::Priority::NEIGHBOR);
+}
+
+MirrorManager::MirrorIDs MirrorManager::affectedMirrors(
+    const StateDelta& delta) const {
+  network::RadixTree<IPAddress, bool> changedPrefixes;
+  for (const auto& rtDelta : delta.getRouteTablesDelta()) {
+    collectRouteChanges(rtDelta.getRoutesV4Delta(), &changedPrefixes);
+    collectRouteChanges(rtDelta.getRoutesV6Delta(), &changedPrefixes);
+  }
+  NeighborChanges v4Neighbors;
+  NeighborChanges v6Neighbors;
+  for (const auto& vlanDelta : delta.getVlansDelta()) {
+    collectNeighborChanges(vlanDelta.getArpDelta(), &v4Neighbors);
+    collectNeighborChanges(vlanDelta.getNdpDelta(), &v6Neighbors);
+  }
+
+  MirrorIDs ids;
+  // Mirrors resolved here change in the next delta too, so only pick up
+  // changed mirrors whose destination moved
+  DeltaFunctions::forEachChanged(
+      delta.getMirrorsDelta(),
+      [&](const std::shared_ptr<Mirror>& oldMirror,
+          const std::shared_ptr<Mirror>& newMirror) {
+        if (oldMirror->getDestinationIp() != newMirror->getDestinationIp()) {
+          ids.insert(newMirror->getID());
+        }
+      },
+      [&](const std::shared_ptr<Mirror>& newMirror) {
+        ids.insert(newMirror->getID());
+      },
+      [](const std::shared_ptr<Mirror>& /*oldMirror*/) {});
+  if (changedPrefixes.size() == 0 && !v4Neighbors.any && !v6Neighbors.any) {
+    return ids;
+  }
+
+  for (const auto& mirror : *delta.newState()->getMirrors()) {
+    if (!mirror->getDestinationIp()) {
+      /* SPAN mirror does not require resolving */
+      continue;
+    }
+    const auto destination = mirror->getDestinationIp().value();
+    if (changedPrefixes.longestMatch(destination, destination.bitCount()) !=
+        changedPrefixes.end()) {
+      ids.insert(mirror->getID());
+      continue;
+    }
+    // A new neighbor may resolve the mirror through another next hop, and a
+    // changed one may be the neighbor the tunnel goes through
+    const auto& neighbors = destination.isV4() ? v4Neighbors : v6Neighbors;
+    const auto tunnel = mirror->getMirrorTunnel();
+    if (neighbors.added || (neighbors.any && !tunnel) ||
+        (tunnel && neighbors.macs.count(tunnel->dstMac))) {
+      ids.insert(mirror->getID());
+    }
+  }
+  return ids;
 }
 
 std::shared_ptr<SwitchState> MirrorManager::resolveMirrors(
-    const std::shared_ptr<SwitchState>& state) {
+    const std::shared_ptr<SwitchState>& state,
+    const MirrorIDs& ids) {
   auto mirrors = state->getMirrors()->clone();
   bool mirrorsUpdated = false;
 
-  for (const auto& mirror : *state->getMirrors()) {
-    if (!mirror->getDestinationIp()) {
-      /* SPAN mirror does not require resolving */
+  std::vector<std::shared_ptr<Mirror>> v4Mirrors;
+  std::vector<std::shared_ptr<Mirror>> v6Mirrors;
+  for (const auto& id : ids) {
+    auto mirror = state->getMirrors()->getMirrorIf(id);
+    if (!mirror || !mirror->getDestinationIp()) {
+      // Removed since, or a SPAN mirror, which does not require resolving
       continue;
     }
-    const auto destinationIp = mirror->getDestinationIp().value();
-    std::shared_ptr<Mirror> updatedMirror = destinationIp.isV4()
-        ? v4Manager_->updateMirror(mirror)
-        : v6Manager_->updateMirror(mirror);
-    if (updatedMirror) {
-      XLOG(INFO) << "Mirror: " << updatedMirror->getID() << " updated.";
-      mirrors->updateNode(updatedMirror);
-      mirrorsUpdated = true;
+    if (mirror->getDestinationIp().value().isV4()) {
+      v4Mirrors.push_back(mirror);
+    } else {
+      v6Mirrors.push_back(mirror);
     }
   }
+
+  auto applyUpdatedMirrors =
+      [&](const std::vector<std::shared_ptr<Mirror>>& updatedMirrors) {
+        for (const auto& updatedMirror : updatedMirrors) {
+          if (updatedMirror) {
+            XLOG(INFO) << "Mirror: " << updatedMirror->getID() << " updated.";
+            mirrors->updateNode(updatedMirror);
+            mirrorsUpdated = true;
+          }
+        }
+      };
+  applyUpdatedMirrors(v4Manager_->updateMirrors(v4Mirrors));
+  applyUpdatedMirrors(v6Manager_->updateMirrors(v6Mirrors));
   if (!mirrorsUpdated) {
     return std::shared_ptr<SwitchState>(nullptr);
   }
@@ -58,17 +192,5 @@ std::shared_ptr<SwitchState> MirrorManager::resolveMirrors(
   return updatedState;
 }
 
-bool MirrorManager::hasMirrorChanges(const StateDelta& delta) {
-  return (sw_->getState()->getMirrors()->size() > 0) &&
-      (!isEmpty(delta.getRouteTablesDelta()) ||
-       std::any_of(
-           std::begin(delta.getVlansDelta()),
-           std::end(delta.getVlansDelta()),
-           [](const VlanDelta& vlanDelta) {
-             return !isEmpty(vlanDelta.getArpDelta()) ||
-                 !isEmpty(vlanDelta.getNdpDelta());
-           }));
-}
-
 } // namespace fboss
 } // namespace facebook
@@ -7,9 +7,20 @@
 #include "fboss/agent/state/RouteNextHop.h"
 #include "fboss/agent/state/StateDelta.h"
 
+#include <boost/container/flat_set.hpp>
+
+#include <string>
+
 namespace facebook {
 namespace fboss {
 
+/*
+ * Keeps the tunnels of ERSPAN mirrors resolved as routes and neighbors
+ * change.  Only the mirrors a delta can affect are re-resolved: those whose
+ * destination is covered by a changed route, and those whose neighbor may
+ * have changed.  All mirrors found affected before the update that resolves
+ * them runs are resolved in that one update.
+ */
 class MirrorManager : public AutoRegisterStateObserver {
  public:
   explicit MirrorManager(SwSwitch* sw)
@@ -26,10 +37,17 @@ class MirrorManager : public AutoRegisterStateObserver {
   std::unique_ptr<MirrorManagerV4> v4Manager_;
   std::unique_ptr<MirrorManagerV6> v6Manager_;
 
-  bool hasMirrorChanges(const StateDelta& delta);
+  using MirrorIDs = boost::container::flat_set<std::string>;
+
+  MirrorIDs affectedMirrors(const StateDelta& delta) const;
 
   std::shared_ptr<SwitchState> resolveMirrors(
-      const std::shared_ptr<SwitchState>& state);
+      const std::shared_ptr<SwitchState>& state,
+      const MirrorIDs& ids);
+
+  // Mirrors waiting for the scheduled update to resolve them.  Only used on
+  // the update thread.
+  MirrorIDs pendingMirrors_;
 };
 } // namespace fboss
 } // namespace facebook
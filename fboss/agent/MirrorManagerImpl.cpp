@@ -21,13 +21,38 @@ using NeighborEntryT =
 namespace facebook {
 namespace fboss {
 
+template <typename AddrT>
+std::vector<std::shared_ptr<Mirror>> MirrorManagerImpl<AddrT>::updateMirrors(
+    const std::vector<std::shared_ptr<Mirror>>& mirrors) {
+  if (mirrors.empty()) {
+    return {};
+  }
+  const auto state = sw_->getState();
+  std::vector<AddrT> destinationIps;
+  destinationIps.reserve(mirrors.size());
+  for (const auto& mirror : mirrors) {
+    destinationIps.push_back(
+        getIPAddress<AddrT>(mirror->getDestinationIp().value()));
+  }
+  const auto routes = sw_->longestMatchBatch<AddrT>(
+      state, folly::range(destinationIps), RouterID(0));
+
+  std::vector<std::shared_ptr<Mirror>> updatedMirrors;
+  updatedMirrors.reserve(mirrors.size());
+  for (size_t i = 0; i < mirrors.size(); ++i) {
+    updatedMirrors.push_back(updateMirror(state, mirrors[i], routes[i]));
+  }
+  return updatedMirrors;
+}
+
 template <typename AddrT>
 std::shared_ptr<Mirror> MirrorManagerImpl<AddrT>::updateMirror(
-    const std::shared_ptr<Mirror>& mirror) {
+    const std::shared_ptr<SwitchState>& state,
+    const std::shared_ptr<Mirror>& mirror,
+    const std::shared_ptr<Route<AddrT>>& route) {
   const AddrT destinationIp =
       getIPAddress<AddrT>(mirror->getDestinationIp().value());
-  const auto state = sw_->getState();
-  const auto nexthops = resolveMirrorNextHops(state, destinationIp);
+  const auto nexthops = resolveMirrorNextHops(route);
 
   auto newMirror = std::make_shared<Mirror>(
       mirror->getID(),
@@ -57,10 +82,7 @@ std::shared_ptr<Mirror> MirrorManagerImpl<AddrT>::updateMirror(
 
 template <typename AddrT>
 RouteNextHopEntry::NextHopSet MirrorManagerImpl<AddrT>::resolveMirrorNextHops(
-    const std::shared_ptr<SwitchState>& state,
-    const AddrT& destinationIp) {
-  const auto route =
-      sw_->longestMatch<AddrT>(state, destinationIp, RouterID(0));
+    const std::shared_ptr<Route<AddrT>>& route) {
   if (!route || !route->isResolved()) {
     return RouteNextHopEntry::NextHopSet();
   }
@@ -5,6 +5,9 @@
 #include <folly/IPAddressV4.h>
 #include <folly/IPAddressV6.h>
 
+#include <memory>
+#include <vector>
+
 #include "fboss/agent/state/ArpEntry.h"
 #include "fboss/agent/state/NdpEntry.h"
 #include "fboss/agent/state/RouteNextHopEntry.h"
@@ -15,6 +18,8 @@ namespace fboss {
 class Mirror;
 class MirrorTunnel;
 class SwSwitch;
+template <typename AddrT>
+class Route;
 
 template <typename AddrT>
 class MirrorManagerImpl {
@@ -28,12 +33,21 @@ class MirrorManagerImpl {
   explicit MirrorManagerImpl(SwSwitch* sw) : sw_(sw) {}
   ~MirrorManagerImpl() {}
 
-  std::shared_ptr<Mirror> updateMirror(const std::shared_ptr<Mirror>& mirror);
+  /*
+   * Resolve mirrors whose destinations are AddrT, looking all destinations
+   * up in the FIB as one batch. The i'th result is the updated mirrors[i],
+   * or null if it did not change.
+   */
+  std::vector<std::shared_ptr<Mirror>> updateMirrors(
+      const std::vector<std::shared_ptr<Mirror>>& mirrors);
 
 private:
- NextHopSet resolveMirrorNextHops(
+ std::shared_ptr<Mirror> updateMirror(
      const std::shared_ptr<SwitchState>& state,
-     const AddrT& destinationIp);
+     const std::shared_ptr<Mirror>& mirror,
+     const std::shared_ptr<Route<AddrT>>& route);
+
+ NextHopSet resolveMirrorNextHops(const std::shared_ptr<Route<AddrT>>& route);
 
  std::shared_ptr<NeighborEntryT> resolveMirrorNextHopNeighbor(
      const std::shared_ptr<SwitchState>& state,
@@ -67,6 +67,23 @@ class NeighborCache {
     impl_->portDown(port);
   }
 
+  /*
+   * While ip is held down its entry is written to the SwitchState as
+   * pending however it resolves, so the hardware stops forwarding to it.
+   * The cache itself keeps resolving and refreshing the entry as usual.
+   */
+  void setHeldDown(AddressType ip, bool down) {
+    std::lock_guard<std::mutex> g(cacheLock_);
+    impl_->setHeldDown(ip, down);
+  }
+
+  // The MAC and port ip resolved to, held down or not
+  folly::Optional<std::pair<folly::MacAddress, PortDescriptor>>
+  getResolvedNeighbor(AddressType ip) {
+    std::lock_guard<std::mutex> g(cacheLock_);
+    return impl_->getResolvedNeighbor(ip);
+  }
+
   template <typename NeighborEntryThrift>
   std::list<NeighborEntryThrift> getCacheData() {
     std::lock_guard<std::mutex> g(cacheLock_);
@@ -79,6 +96,15 @@ class NeighborCache {
     return impl_->template getCacheData<NeighborEntryThrift>(ip);
   }
 
+  /*
+   * Whether the cache is probing for ip itself, because its entry is
+   * INCOMPLETE or PROBE. Another solicitation for ip is redundant then.
+   */
+  bool isProbing(AddressType ip) {
+    std::lock_guard<std::mutex> g(cacheLock_);
+    return impl_->isProbing(ip);
+  }
+
   void setTimeout(std::chrono::seconds timeout) {
     timeout_ = timeout;
   }
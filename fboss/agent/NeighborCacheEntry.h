@@ -12,6 +12,8 @@
 #include "fboss/agent/AddressUtil.h"
 #include "fboss/agent/SwSwitch.h"
 #include "fboss/agent/FbossError.h"
+#include "fboss/agent/NeighborTimer.h"
+#include "fboss/agent/SwitchStats.h"
 #include "fboss/agent/types.h"
 #include "fboss/agent/state/NeighborEntry.h"
 #include "fboss/agent/state/PortDescriptor.h"
@@ -55,6 +57,8 @@
  * its next update. When that timeout expires, the state machine is run and the
  * next update is scheduled. If the entry ever transitions to the EXPIRED state,
  * we do not schedule another update and the cache will flush the entry.
+ * The timeouts all share the NeighborTimer wheel of the cache's EventBase, and
+ * are jittered so that entries created together don't keep probing together.
  *
  * There is no locking in this class. Instead, the class relies on the
  * synchronization provided by NeighborCache, which should lock around all calls
@@ -78,7 +82,7 @@ enum class NeighborEntryState : uint8_t {
 template <typename NTable> class NeighborCache;
 
 template <typename NTable>
-class NeighborCacheEntry : private folly::AsyncTimeout {
+class NeighborCacheEntry : private NeighborTimer::Timeout {
  public:
   typedef typename NTable::Entry::AddressType AddressType;
   typedef NeighborCache<NTable> Cache;
@@ -88,7 +92,7 @@ class NeighborCacheEntry : private folly::AsyncTimeout {
                      folly::EventBase* evb,
                      Cache* cache,
                      NeighborEntryState state)
-      : AsyncTimeout(evb),
+      : Timeout(evb),
         fields_(fields),
         cache_(cache),
         evb_(evb),
@@ -241,11 +245,12 @@ class NeighborCacheEntry : private folly::AsyncTimeout {
         scheduleTimeout(lifetime);
         break;
       case NeighborEntryState::STALE:
-        scheduleTimeout(std::chrono::seconds(cache_->getStaleEntryInterval()));
+        scheduleTimeout(NeighborTimer::jittered(
+            std::chrono::seconds(cache_->getStaleEntryInterval())));
         break;
       case NeighborEntryState::PROBE:
       case NeighborEntryState::INCOMPLETE:
-        scheduleTimeout(std::chrono::seconds(1));
+        scheduleTimeout(NeighborTimer::jittered(std::chrono::seconds(1)));
         break;
       case NeighborEntryState::EXPIRED:
         // This entry is expired and is already flushed. Don't schedule a
@@ -320,6 +325,7 @@ class NeighborCacheEntry : private folly::AsyncTimeout {
         /* entry is PROBE, issue unicast probe */
         cache_->checkReachability(getIP(), getMac(), getPort());
       }
+      cache_->getSw()->stats()->neighborProbeSent();
       --probesLeft_;
     } else {
       state_ = NeighborEntryState::EXPIRED;
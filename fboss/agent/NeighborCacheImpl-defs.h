@@ -14,7 +14,12 @@
 #include <folly/futures/Future.h>
 #include <folly/io/async/EventBase.h>
 #include <folly/logging/xlog.h>
+#include <gflags/gflags.h>
+#include <algorithm>
+#include <chrono>
 #include <list>
+#include <mutex>
+#include <vector>
 #include "fboss/agent/ArpHandler.h"
 #include "fboss/agent/IPv6Handler.h"
 #include "fboss/agent/NeighborCacheImpl.h"
@@ -25,6 +30,9 @@
 #include "fboss/agent/state/Vlan.h"
 #include "fboss/agent/types.h"
 
+DECLARE_int32(neighbor_update_batch_ms);
+DECLARE_int32(neighbor_update_batch_size);
+
 namespace facebook { namespace fboss {
 
 namespace ncachehelpers {
@@ -58,93 +66,282 @@ bool checkVlanAndIntf(
   return true;
 }
 
+/*
+ * Write a resolved entry into the SwitchState. Returns false if the state
+ * did not need to change.
+ */
+template <typename NTable>
+bool programEntry(
+    std::shared_ptr<SwitchState>* state,
+    const typename NeighborCacheEntry<NTable>::EntryFields& fields,
+    VlanID vlanID) {
+  if (!checkVlanAndIntf<NTable>(*state, fields, vlanID)) {
+    // Either the vlan or intf is no longer valid.
+    return false;
+  }
+
+  auto vlan = (*state)->getVlans()->getVlanIf(vlanID).get();
+  auto* table = vlan->template getNeighborTable<NTable>().get();
+  auto node = table->getNodeIf(fields.ip);
+
+  if (!node) {
+    table = table->modify(&vlan, state);
+    table->addEntry(fields);
+    XLOG(DBG2) << "Adding entry for " << fields.ip << " --> " << fields.mac
+               << " on interface " << fields.interfaceID << " for vlan "
+               << vlanID;
+  } else {
+    if (node->getMac() == fields.mac &&
+        node->getPort() == fields.port &&
+        node->getIntfID() == fields.interfaceID &&
+        node->getState() == fields.state &&
+        !node->isPending()) {
+      // This entry was already updated while we were waiting on the lock.
+      return false;
+    }
+    table = table->modify(&vlan, state);
+    table->updateEntry(fields);
+    XLOG(DBG2) << "Converting pending entry for " << fields.ip << " --> "
+               << fields.mac << " on interface " << fields.interfaceID
+               << " for vlan " << vlanID;
+  }
+  return true;
 }
 
+/*
+ * Write a pending entry into the SwitchState. An existing entry is only
+ * replaced if force is set. Returns false if the state did not change.
+ */
 template <typename NTable>
-void NeighborCacheImpl<NTable>::programEntry(Entry* entry) {
-  CHECK(!entry->isPending());
+bool programPendingEntry(
+    std::shared_ptr<SwitchState>* state,
+    const typename NeighborCacheEntry<NTable>::EntryFields& fields,
+    VlanID vlanID,
+    bool force) {
+  if (!checkVlanAndIntf<NTable>(*state, fields, vlanID)) {
+    // Either the vlan or intf is no longer valid.
+    return false;
+  }
 
-  auto fields = entry->getFields();
-  auto vlanID = vlanID_;
-  auto updateFn = [fields, vlanID](const std::shared_ptr<SwitchState>& state)
-      -> std::shared_ptr<SwitchState> {
-    if (!ncachehelpers::checkVlanAndIntf<NTable>(state, fields, vlanID)) {
-      // Either the vlan or intf is no longer valid.
-      return nullptr;
-    }
+  auto vlan = (*state)->getVlans()->getVlanIf(vlanID).get();
+  auto* table = vlan->template getNeighborTable<NTable>().get();
+  auto node = table->getNodeIf(fields.ip);
+  if (node && !force) {
+    // don't replace an existing entry with a pending one unless
+    // explicitly allowed
+    return false;
+  }
 
-    auto vlan = state->getVlans()->getVlanIf(vlanID).get();
-    std::shared_ptr<SwitchState> newState{state};
-    auto* table = vlan->template getNeighborTable<NTable>().get();
-    auto node = table->getNodeIf(fields.ip);
-
-    if (!node) {
-      table = table->modify(&vlan, &newState);
-      table->addEntry(fields);
-      XLOG(DBG2) << "Adding entry for " << fields.ip << " --> " << fields.mac
-                 << " on interface " << fields.interfaceID << " for vlan "
-                 << vlanID;
-    } else {
-      if (node->getMac() == fields.mac &&
-          node->getPort() == fields.port &&
-          node->getIntfID() == fields.interfaceID &&
-          node->getState() == fields.state &&
-          !node->isPending()) {
-        // This entry was already updated while we were waiting on the lock.
-        return nullptr;
-      }
-      table = table->modify(&vlan, &newState);
-      table->updateEntry(fields);
-      XLOG(DBG2) << "Converting pending entry for " << fields.ip << " --> "
-                 << fields.mac << " on interface " << fields.interfaceID
-                 << " for vlan " << vlanID;
-    }
-    return newState;
-  };
+  table = table->modify(&vlan, state);
+  if (node) {
+    table->removeEntry(fields.ip);
+  }
+  table->addPendingEntry(fields.ip, fields.interfaceID);
 
-  sw_->updateState(folly::to<std::string>("add neighbor ", fields.ip),
-                   std::move(updateFn));
+  XLOG(DBG4) << "Adding pending entry for " << fields.ip << " on interface "
+             << fields.interfaceID << " for vlan " << vlanID;
+  return true;
 }
 
+/*
+ * Remove an entry from the SwitchState. Returns false if there was no
+ * entry to remove.
+ */
+template <typename NTable>
+bool flushEntry(
+    std::shared_ptr<SwitchState>* state,
+    typename NTable::Entry::AddressType ip,
+    VlanID vlanID) {
+  auto* vlan = (*state)->getVlans()->getVlanIf(vlanID).get();
+  if (!vlan) {
+    return false;
+  }
+  auto* table = vlan->template getNeighborTable<NTable>().get();
+  const auto& entry = table->getNodeIf(ip);
+  if (!entry) {
+    return false;
+  }
+
+  table = table->modify(&vlan, state);
+  table->removeNode(ip);
+  return true;
+}
+
+}
+
+template <typename NTable>
+void NeighborCacheImpl<NTable>::programEntry(Entry* entry) {
+  CHECK(!entry->isPending());
+  if (heldDown_.count(entry->getIP())) {
+    queueChange(
+        PendingChange::Type::FORCE_PENDING_ENTRY,
+        EntryFields(entry->getIP(), intfID_, NeighborState::PENDING));
+    return;
+  }
+  queueChange(PendingChange::Type::ENTRY, entry->getFields());
+}
 
 template <typename NTable>
 void NeighborCacheImpl<NTable>::programPendingEntry(Entry* entry, bool force) {
   CHECK(entry->isPending());
+  queueChange(
+      force ? PendingChange::Type::FORCE_PENDING_ENTRY
+            : PendingChange::Type::PENDING_ENTRY,
+      entry->getFields());
+}
 
-  auto fields = entry->getFields();
-  auto vlanID = vlanID_;
-  auto updateFn = [fields, vlanID, force](
-    const std::shared_ptr<SwitchState>& state)
-      -> std::shared_ptr<SwitchState> {
-    if (!ncachehelpers::checkVlanAndIntf<NTable>(state, fields, vlanID)) {
-      // Either the vlan or intf is no longer valid.
-      return nullptr;
+template <typename NTable>
+void NeighborCacheImpl<NTable>::queueChange(
+    typename PendingChange::Type type,
+    EntryFields fields) {
+  bool isPendingEntry = type == PendingChange::Type::PENDING_ENTRY ||
+      type == PendingChange::Type::FORCE_PENDING_ENTRY;
+  PendingChange change{
+      type, std::move(fields), std::chrono::steady_clock::now()};
+
+  auto pending = pendingChanges_;
+  bool added{false};
+  if (pending) {
+    std::lock_guard<std::mutex> g(pending->lock);
+    // Pending entries may not join an update already queued to coalesce,
+    // and resolved entries may not hide pending ones from the HwSwitch
+    bool canAdd = isPendingEntry
+        ? !pending->queued || pending->hasPendingEntries
+        : type != PendingChange::Type::ENTRY || !pending->hasPendingEntries;
+    if (!pending->closed && canAdd) {
+      pending->changes.push_back(std::move(change));
+      pending->hasPendingEntries |= isPendingEntry;
+      added = true;
     }
+  }
 
-    auto vlan = state->getVlans()->getVlanIf(vlanID).get();
-    std::shared_ptr<SwitchState> newState{state};
-    auto* table = vlan->template getNeighborTable<NTable>().get();
-    auto node = table->getNodeIf(fields.ip);
-    table = table->modify(&vlan, &newState);
-
-    if (node) {
-      if (!force) {
-        // don't replace an existing entry with a pending one unless
-        // explicitly allowed
-        return nullptr;
-      }
-      table->removeEntry(fields.ip);
+  if (!added) {
+    // Write out whatever is still waiting first, to keep changes in order
+    closePendingChanges();
+    pending = std::make_shared<PendingChanges>();
+    pending->changes.push_back(std::move(change));
+    pending->hasPendingEntries = isPendingEntry;
+    pendingChanges_ = pending;
+
+    if (FLAGS_neighbor_update_batch_ms <= 0) {
+      // Changes made before the update runs still go along with it
+      submitPendingChanges(sw_, vlanID_, pending);
+    } else {
+      auto sw = sw_;
+      auto vlanID = vlanID_;
+      auto evb = evb_;
+      evb_->runInEventBaseThread([sw, vlanID, evb, pending]() {
+        evb->runAfterDelay(
+            [sw, vlanID, pending]() {
+              submitPendingChanges(sw, vlanID, pending);
+            },
+            FLAGS_neighbor_update_batch_ms);
+      });
+    }
+  }
+
+  size_t numChanges;
+  {
+    std::lock_guard<std::mutex> g(pending->lock);
+    numChanges = pending->changes.size();
+  }
+  if (numChanges >= std::max(1, FLAGS_neighbor_update_batch_size)) {
+    closePendingChanges();
+  }
+}
+
+template <typename NTable>
+void NeighborCacheImpl<NTable>::closePendingChanges() {
+  if (!pendingChanges_) {
+    return;
+  }
+  auto pending = std::move(pendingChanges_);
+  {
+    std::lock_guard<std::mutex> g(pending->lock);
+    pending->closed = true;
+  }
+  submitPendingChanges(sw_, vlanID_, pending);
+}
+
+template <typename NTable>
+void NeighborCacheImpl<NTable>::submitPendingChanges(
+    SwSwitch* sw,
+    VlanID vlanID,
+    const std::shared_ptr<PendingChanges>& pending) {
+  bool noCoalescing;
+  {
+    std::lock_guard<std::mutex> g(pending->lock);
+    if (pending->queued) {
+      return;
     }
-    table->addPendingEntry(fields.ip, fields.interfaceID);
+    pending->queued = true;
+    noCoalescing = pending->hasPendingEntries;
+  }
 
-    XLOG(DBG4) << "Adding pending entry for " << fields.ip << " on interface "
-               << fields.interfaceID << " for vlan " << vlanID;
-    return newState;
+  auto updateFn = [sw, vlanID, pending](
+                      const std::shared_ptr<SwitchState>& state) {
+    return applyPendingChanges(sw, vlanID, pending, state);
   };
+  auto name = folly::to<std::string>("update neighbors on vlan ", vlanID);
+  if (noCoalescing) {
+    sw->updateStateNoCoalescing(
+        name, std::move(updateFn), StateUpdate::Priority::NEIGHBOR);
+  } else {
+    sw->updateState(
+        name, std::move(updateFn), StateUpdate::Priority::NEIGHBOR);
+  }
+}
 
-  sw_->updateStateNoCoalescing(
-    folly::to<std::string>("add pending entry ", fields.ip),
-    std::move(updateFn));
+template <typename NTable>
+std::shared_ptr<SwitchState> NeighborCacheImpl<NTable>::applyPendingChanges(
+    SwSwitch* sw,
+    VlanID vlanID,
+    const std::shared_ptr<PendingChanges>& pending,
+    const std::shared_ptr<SwitchState>& state) {
+  std::vector<PendingChange> changes;
+  {
+    std::lock_guard<std::mutex> g(pending->lock);
+    pending->closed = true;
+    changes.swap(pending->changes);
+  }
+  if (changes.empty()) {
+    return nullptr;
+  }
+
+  auto now = std::chrono::steady_clock::now();
+  std::shared_ptr<SwitchState> newState{state};
+  bool changed{false};
+  for (const auto& change : changes) {
+    switch (change.type) {
+      case PendingChange::Type::ENTRY:
+        changed = ncachehelpers::programEntry<NTable>(
+                      &newState, change.fields, vlanID) ||
+            changed;
+        sw->stats()->neighborResolutionLatency(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                now - change.queued));
+        break;
+      case PendingChange::Type::PENDING_ENTRY:
+      case PendingChange::Type::FORCE_PENDING_ENTRY:
+        changed = ncachehelpers::programPendingEntry<NTable>(
+                      &newState,
+                      change.fields,
+                      vlanID,
+                      change.type ==
+                          PendingChange::Type::FORCE_PENDING_ENTRY) ||
+            changed;
+        break;
+      case PendingChange::Type::FLUSH:
+        changed = ncachehelpers::flushEntry<NTable>(
+                      &newState, change.fields.ip, vlanID) ||
+            changed;
+        break;
+    }
+  }
+  sw->stats()->neighborUpdateBatch(changes.size());
+  XLOG(DBG4) << "Wrote " << changes.size() << " neighbor changes for vlan "
+             << vlanID;
+  return changed ? newState : nullptr;
 }
 
 template <typename NTable>
@@ -182,7 +379,7 @@ void NeighborCacheImpl<NTable>::clearEntries() {
    * As a result, it is possible for entries_ to be empty,
    * but for there to still be cancelTimeout lambdas scheduled. On its own
    * this is not so bad, but it is also possible for there to be a last
-   * lambda scheduled from the AsyncTimeout itself, ahead of the cancel. If
+   * lambda scheduled from the entry's timeout itself, ahead of the cancel. If
    * that happens, then that code can race with destroying the Cache* which
    * can cause a use-after-free.
    *
@@ -196,6 +393,7 @@ void NeighborCacheImpl<NTable>::clearEntries() {
   }
   folly::collectAllSemiFuture(stopTasks).get();
   entries_.clear();
+  portEntries_.clear();
 }
 
 template <typename NTable>
@@ -251,7 +449,9 @@ NeighborCacheEntry<NTable>* NeighborCacheImpl<NTable>::setEntryInternal(
   if (entry) {
     auto changed = !entry->fieldsMatch(fields);
     if (changed) {
+      unindexEntry(*entry);
       entry->updateFields(fields);
+      indexEntry(*entry);
     }
     entry->updateState(state);
     return changed ? entry : nullptr;
@@ -292,6 +492,12 @@ void NeighborCacheImpl<NTable>::processEntry(AddressType ip) {
   }
 }
 
+template <typename NTable>
+bool NeighborCacheImpl<NTable>::isProbing(AddressType ip) const {
+  auto entry = getCacheEntry(ip);
+  return entry && entry->isProbing();
+}
+
 template <typename NTable>
 NeighborCacheEntry<NTable>* NeighborCacheImpl<NTable>::getCacheEntry(
     AddressType ip) const {
@@ -305,7 +511,29 @@ NeighborCacheEntry<NTable>* NeighborCacheImpl<NTable>::getCacheEntry(
 template <typename NTable>
 void NeighborCacheImpl<NTable>::setCacheEntry(std::shared_ptr<Entry> entry) {
   const auto& ip = entry->getIP();
-  entries_[ip] = std::move(entry);
+  auto& stored = entries_[ip];
+  if (stored) {
+    unindexEntry(*stored);
+  }
+  indexEntry(*entry);
+  stored = std::move(entry);
+}
+
+template <typename NTable>
+void NeighborCacheImpl<NTable>::indexEntry(const Entry& entry) {
+  portEntries_[entry.getPort()].insert(entry.getIP());
+}
+
+template <typename NTable>
+void NeighborCacheImpl<NTable>::unindexEntry(const Entry& entry) {
+  auto it = portEntries_.find(entry.getPort());
+  if (it == portEntries_.end()) {
+    return;
+  }
+  it->second.erase(entry.getIP());
+  if (it->second.empty()) {
+    portEntries_.erase(it);
+  }
 }
 
 template <typename NTable>
@@ -315,6 +543,8 @@ bool NeighborCacheImpl<NTable>::removeEntry(AddressType ip) {
     return false;
   }
 
+  unindexEntry(*it->second);
+
   // This asynchronously destroys the entries. This is needed because
   // entries need to be destroyed on the background thread, but we
   // likely have the cache level lock here and the background thread could be
@@ -327,21 +557,6 @@ bool NeighborCacheImpl<NTable>::removeEntry(AddressType ip) {
   return true;
 }
 
-template <typename NTable>
-bool NeighborCacheImpl<NTable>::flushEntryFromSwitchState(
-    std::shared_ptr<SwitchState>* state, AddressType ip) {
-  auto* vlan = (*state)->getVlans()->getVlan(vlanID_).get();
-  auto* table = vlan->template getNeighborTable<NTable>().get();
-  const auto& entry = table->getNodeIf(ip);
-  if (!entry) {
-    return false;
-  }
-
-  table = table->modify(&vlan, state);
-  table->removeNode(ip);
-  return true;
-}
-
 template <typename NTable>
 bool NeighborCacheImpl<NTable>::flushEntryBlocking(AddressType ip) {
   bool flushed{false};
@@ -356,27 +571,32 @@ void NeighborCacheImpl<NTable>::flushEntry(AddressType ip, bool* flushed) {
     return;
   }
 
-  // flush from SwitchState
-  auto updateFn =
-    [this, ip, flushed](const std::shared_ptr<SwitchState>& state)
-        -> std::shared_ptr<SwitchState> {
+  if (!flushed) {
+    // flush from SwitchState along with the other queued changes
+    queueChange(
+        PendingChange::Type::FLUSH,
+        EntryFields(ip, intfID_, NeighborState::PENDING));
+    return;
+  }
+
+  // need a blocking state update if the caller wants to know if an entry
+  // was actually flushed. Changes queued before this are written first.
+  closePendingChanges();
+  auto vlanID = vlanID_;
+  auto updateFn = [ip, vlanID, flushed](
+                      const std::shared_ptr<SwitchState>& state)
+      -> std::shared_ptr<SwitchState> {
     std::shared_ptr<SwitchState> newState{state};
-    if (flushEntryFromSwitchState(&newState, ip)) {
-      if (flushed) {
-        *flushed = true;
-      }
+    if (ncachehelpers::flushEntry<NTable>(&newState, ip, vlanID)) {
+      *flushed = true;
       return newState;
     }
     return nullptr;
   };
-
-  if (flushed) {
-    // need a blocking state update if the caller wants to know if an entry
-    // was actually flushed
-    sw_->updateStateBlocking("flush neighbor entry", std::move(updateFn));
-  } else {
-    sw_->updateState("remove neighbor entry", std::move(updateFn));
-  }
+  sw_->updateStateBlocking(
+      "flush neighbor entry",
+      std::move(updateFn),
+      StateUpdate::Priority::NEIGHBOR);
 }
 
 template <typename NTable>
@@ -391,11 +611,13 @@ NeighborCacheImpl<NTable>::cloneEntryFields(AddressType ip) {
 
 template <typename NTable>
 void NeighborCacheImpl<NTable>::portDown(PortDescriptor port) {
-  for (auto item : entries_) {
-    if (item.second->getPort() != port) {
-      continue;
-    }
-
+  auto it = portEntries_.find(port);
+  if (it == portEntries_.end()) {
+    return;
+  }
+  // Making the entries pending moves them off the port, and out of the index
+  std::vector<AddressType> ips(it->second.begin(), it->second.end());
+  for (const auto& ip : ips) {
     // TODO(aeckert): It would be nicer if we could just mark this
     // entry stale on port down so we don't need to unprogram the
     // entry (for fast port flaps).  However, we have seen packet
@@ -404,8 +626,36 @@ void NeighborCacheImpl<NTable>::portDown(PortDescriptor port) {
     // programmed. Also we need to notify the HwSwitch for ECMP expand
     // when the port comes back up and changing an entry from pending
     // to reachable is how we currently do this.
-    setPendingEntry(item.second->getIP(), true);
+    setPendingEntry(ip, true);
+  }
+}
+
+template <typename NTable>
+void NeighborCacheImpl<NTable>::setHeldDown(AddressType ip, bool down) {
+  auto wasDown = heldDown_.count(ip) > 0;
+  if (down == wasDown) {
+    return;
+  }
+  if (down) {
+    heldDown_.insert(ip);
+  } else {
+    heldDown_.erase(ip);
+  }
+  // Only a resolved entry is written differently while held down
+  auto entry = getCacheEntry(ip);
+  if (entry && !entry->isPending()) {
+    programEntry(entry);
+  }
+}
+
+template <typename NTable>
+folly::Optional<std::pair<folly::MacAddress, PortDescriptor>>
+NeighborCacheImpl<NTable>::getResolvedNeighbor(AddressType ip) const {
+  auto entry = getCacheEntry(ip);
+  if (!entry || entry->isPending()) {
+    return folly::none;
   }
+  return std::make_pair(entry->getMac(), entry->getPort());
 }
 
 template <typename NTable>
@@ -19,8 +19,16 @@
 #include <folly/IPAddress.h>
 #include <folly/Optional.h>
 #include <folly/Random.h>
+#include <chrono>
 #include <list>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 namespace facebook { namespace fboss {
 
@@ -62,7 +70,7 @@ class NeighborCacheImpl {
         vlanID_(vlanID),
         vlanName_(vlanName),
         intfID_(intfID),
-        evb_(sw->getNeighborCacheEvb()) {}
+        evb_(sw->getNeighborCacheEvb(vlanID)) {}
 
   // Methods useful for subclasses
   void setPendingEntry(AddressType ip,
@@ -83,8 +91,15 @@ class NeighborCacheImpl {
 
   std::unique_ptr<EntryFields> cloneEntryFields(AddressType ip);
 
+  // Whether the entry for ip is sending its own probes
+  bool isProbing(AddressType ip) const;
+
   void portDown(PortDescriptor port);
 
+  void setHeldDown(AddressType ip, bool down);
+  folly::Optional<std::pair<folly::MacAddress, PortDescriptor>>
+  getResolvedNeighbor(AddressType ip) const;
+
   SwSwitch* getSw() const {
     return sw_;
   }
@@ -131,13 +146,14 @@ class NeighborCacheImpl {
   // was actually flushed from the switch state
   void flushEntry (AddressType ip, bool* flushed = nullptr);
 
-  bool flushEntryFromSwitchState(std::shared_ptr<SwitchState>* state,
-                                 AddressType ip);
-
   Entry* getCacheEntry(AddressType ip) const;
   void setCacheEntry(std::shared_ptr<Entry> entry);
   bool removeEntry(AddressType ip);
 
+  // Keep portEntries_ in step with the port of entry
+  void indexEntry(const Entry& entry);
+  void unindexEntry(const Entry& entry);
+
   Entry* setEntryInternal(const EntryFields& fields,
                           NeighborEntryState state,
                           bool add = true);
@@ -155,6 +171,49 @@ class NeighborCacheImpl {
 
   // Map of all entries
   std::unordered_map<AddressType, std::shared_ptr<Entry>> entries_;
+  // The entries learned on each port, so portDown() only visits those
+  std::map<PortDescriptor, std::unordered_set<AddressType>> portEntries_;
+  // Neighbors whose entries are kept pending in the SwitchState
+  std::unordered_set<AddressType> heldDown_;
+
+  /*
+   * Arp/Ndp changes waiting to be written to the SwitchState. Changes are
+   * collected for --neighbor_update_batch_ms, or until there are
+   * --neighbor_update_batch_size of them, and then written in order by a
+   * single state update, so a burst of replies or a port going down becomes
+   * one update per vlan rather than one per entry. The batch is shared with
+   * the update function, which closes it once it has taken the changes.
+   */
+  struct PendingChange {
+    enum class Type { ENTRY, PENDING_ENTRY, FORCE_PENDING_ENTRY, FLUSH };
+    Type type;
+    EntryFields fields;
+    std::chrono::steady_clock::time_point queued;
+  };
+  struct PendingChanges {
+    std::mutex lock;
+    std::vector<PendingChange> changes;
+    // a pending entry must be seen by the HwSwitch even if the entry
+    // resolves right after, so it is never coalesced with later updates
+    bool hasPendingEntries{false};
+    bool queued{false};
+    bool closed{false};
+  };
+
+  void queueChange(typename PendingChange::Type type, EntryFields fields);
+  // Stop adding changes to the current batch, writing it right away
+  void closePendingChanges();
+  static void submitPendingChanges(
+      SwSwitch* sw,
+      VlanID vlanID,
+      const std::shared_ptr<PendingChanges>& pending);
+  static std::shared_ptr<SwitchState> applyPendingChanges(
+      SwSwitch* sw,
+      VlanID vlanID,
+      const std::shared_ptr<PendingChanges>& pending,
+      const std::shared_ptr<SwitchState>& state);
+
+  std::shared_ptr<PendingChanges> pendingChanges_;
 };
 
 }} // facebook::fboss
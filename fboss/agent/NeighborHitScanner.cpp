@@ -0,0 +1,73 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/NeighborHitScanner.h"
+
+#include "fboss/agent/SwSwitch.h"
+
+#include <folly/ExceptionString.h>
+#include <folly/logging/xlog.h>
+
+namespace facebook { namespace fboss {
+
+NeighborHitScanner::NeighborHitScanner(
+    SwSwitch* sw,
+    std::chrono::milliseconds interval)
+    : sw_(sw), interval_(interval), thread_("NeighborHitScan") {
+  attachEventBase(thread_.getEventBase());
+}
+
+NeighborHitScanner::~NeighborHitScanner() {
+  thread_.getEventBase()->runInEventBaseThreadAndWait([this] {
+    cancelTimeout();
+    detachEventBase();
+  });
+}
+
+void NeighborHitScanner::start() {
+  thread_.getEventBase()->runInEventBaseThread(
+      [this] { this->timeoutExpired(); });
+}
+
+void NeighborHitScanner::stop() {
+  thread_.getEventBase()->runInEventBaseThreadAndWait(
+      [this] { this->cancelTimeout(); });
+}
+
+void NeighborHitScanner::scan() {
+  auto hits = sw_->getHw()->getAndClearNeighborHits();
+  if (hits) {
+    XLOG(DBG4) << hits->size() << " neighbor entries hit since the last scan";
+  }
+  *hits_.wlock() = std::move(hits);
+}
+
+folly::Optional<bool> NeighborHitScanner::isHit(
+    RouterID vrf,
+    const folly::IPAddress& ip) const {
+  auto hits = hits_.rlock();
+  if (!hits->hasValue()) {
+    return folly::none;
+  }
+  return (*hits)->count(std::make_pair(vrf, ip)) > 0;
+}
+
+void NeighborHitScanner::timeoutExpired() noexcept {
+  try {
+    scan();
+  } catch (const std::exception& ex) {
+    XLOG(ERR) << "Failed to scan neighbor hit bits: "
+              << folly::exceptionStr(ex);
+    // Fall back to asking per entry rather than using old hits
+    hits_.wlock()->clear();
+  }
+  scheduleTimeout(interval_);
+}
+
+}} // facebook::fboss
@@ -0,0 +1,66 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include "fboss/agent/HwSwitch.h"
+#include "fboss/agent/types.h"
+
+#include <folly/IPAddress.h>
+#include <folly/Optional.h>
+#include <folly/Synchronized.h>
+#include <folly/io/async/AsyncTimeout.h>
+#include <folly/io/async/ScopedEventBaseThread.h>
+
+#include <chrono>
+
+namespace facebook { namespace fboss {
+
+class SwSwitch;
+
+/*
+ * Periodically reads and clears the hit bits of all arp/ndp entries in one
+ * pass, on its own thread, so that the neighbor caches can check whether a
+ * STALE entry is in use without going to the hardware for each entry.
+ *
+ * Only does anything if HwSwitch::getAndClearNeighborHits() is supported.
+ */
+class NeighborHitScanner : private folly::AsyncTimeout {
+ public:
+  NeighborHitScanner(SwSwitch* sw, std::chrono::milliseconds interval);
+  ~NeighborHitScanner() override;
+
+  void start();
+  void stop();
+
+  // Reads and clears the hit bits now, and keeps the result
+  void scan();
+
+  /*
+   * Whether the entry was hit before the last scan, or folly::none if there
+   * hasn't been a scan yet or the hardware can't be scanned.
+   *
+   * This may be called from any thread.
+   */
+  folly::Optional<bool> isHit(RouterID vrf, const folly::IPAddress& ip) const;
+
+ private:
+  void timeoutExpired() noexcept override;
+
+  // Forbidden copy constructor and assignment operator
+  NeighborHitScanner(NeighborHitScanner const&) = delete;
+  NeighborHitScanner& operator=(NeighborHitScanner const&) = delete;
+
+  SwSwitch* sw_{nullptr};
+  std::chrono::milliseconds interval_;
+  folly::Synchronized<folly::Optional<NeighborHits>> hits_;
+  folly::ScopedEventBaseThread thread_;
+};
+
+}} // facebook::fboss
@@ -0,0 +1,72 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/NeighborTimer.h"
+
+#include "common/stats/ThreadCachedServiceData.h"
+
+#include <folly/Random.h>
+#include <folly/io/async/EventBaseLocal.h>
+
+namespace facebook {
+namespace fboss {
+
+using facebook::stats::SUM;
+
+constexpr std::chrono::milliseconds NeighborTimer::kTickInterval;
+
+NeighborTimer::Timeout::Timeout(folly::EventBase* evb)
+    : evb_(evb), callback_(this) {}
+
+NeighborTimer::Timeout::~Timeout() {
+  cancelTimeout();
+}
+
+void NeighborTimer::Timeout::scheduleTimeout(
+    std::chrono::milliseconds timeout) {
+  NeighborTimer::get(evb_).wheel().scheduleTimeout(&callback_, timeout);
+  tcData().addStatValue("neighbor.timer_scheduled", 1, SUM);
+}
+
+void NeighborTimer::Timeout::cancelTimeout() {
+  if (callback_.isScheduled()) {
+    callback_.cancelTimeout();
+    tcData().addStatValue("neighbor.timer_cancelled", 1, SUM);
+  }
+}
+
+bool NeighborTimer::Timeout::isScheduled() const {
+  return callback_.isScheduled();
+}
+
+void NeighborTimer::Timeout::Callback::timeoutExpired() noexcept {
+  tcData().addStatValue("neighbor.timer_expirations", 1, SUM);
+  timeout_->timeoutExpired();
+}
+
+NeighborTimer& NeighborTimer::get(folly::EventBase* evb) {
+  // Leaked so it outlives any EventBase still holding a NeighborTimer at exit
+  static auto* timers = new folly::EventBaseLocal<NeighborTimer>();
+  return timers->getOrCreate(*evb, evb);
+}
+
+NeighborTimer::NeighborTimer(folly::EventBase* evb)
+    : wheel_(folly::HHWheelTimer::newTimer(evb, kTickInterval)) {}
+
+std::chrono::milliseconds NeighborTimer::jittered(
+    std::chrono::milliseconds interval) {
+  auto spread = interval.count() / 10;
+  if (spread <= 0) {
+    return interval;
+  }
+  return interval - std::chrono::milliseconds(folly::Random::rand64(spread));
+}
+
+} // namespace fboss
+} // namespace facebook
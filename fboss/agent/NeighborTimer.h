@@ -0,0 +1,89 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include <folly/io/async/EventBase.h>
+#include <folly/io/async/HHWheelTimer.h>
+
+#include <chrono>
+
+namespace facebook {
+namespace fboss {
+
+/*
+ * The timing wheel shared by every NeighborCacheEntry running on one
+ * neighbor cache EventBase.
+ *
+ * Entries used to each be their own folly::AsyncTimeout, so a large table
+ * kept one libevent timer armed per neighbor. They now hang off a single
+ * hashed timing wheel per EventBase, which only arms one timer per tick.
+ */
+class NeighborTimer {
+ public:
+  /*
+   * A timeout on the shared wheel. Drop-in replacement for the parts of
+   * folly::AsyncTimeout the cache entries use.
+   */
+  class Timeout {
+   public:
+    explicit Timeout(folly::EventBase* evb);
+    virtual ~Timeout();
+
+    void scheduleTimeout(std::chrono::milliseconds timeout);
+    void cancelTimeout();
+    bool isScheduled() const;
+
+   protected:
+    virtual void timeoutExpired() noexcept = 0;
+
+   private:
+    class Callback : public folly::HHWheelTimer::Callback {
+     public:
+      explicit Callback(Timeout* timeout) : timeout_(timeout) {}
+      void timeoutExpired() noexcept override;
+      void callbackCanceled() noexcept override {}
+
+     private:
+      Timeout* timeout_;
+    };
+
+    folly::EventBase* evb_;
+    Callback callback_;
+  };
+
+  // Must be called from evb's thread
+  static NeighborTimer& get(folly::EventBase* evb);
+
+  explicit NeighborTimer(folly::EventBase* evb);
+
+  folly::HHWheelTimer& wheel() {
+    return *wheel_;
+  }
+
+  /*
+   * interval shortened by a random amount of up to a tenth of it, so that
+   * entries which were scheduled together, e.g. after a bulk resolution,
+   * don't all come due in the same tick. Shortened rather than stretched so an
+   * entry is never probed or aged later than configured.
+   */
+  static std::chrono::milliseconds jittered(std::chrono::milliseconds interval);
+
+  static constexpr std::chrono::milliseconds kTickInterval{10};
+
+ private:
+  folly::HHWheelTimer::UniquePtr wheel_;
+
+  // Forbidden copy constructor and assignment operator
+  NeighborTimer(NeighborTimer const&) = delete;
+  NeighborTimer& operator=(NeighborTimer const&) = delete;
+};
+
+} // namespace fboss
+} // namespace facebook
@@ -25,6 +25,7 @@
 #include "fboss/agent/NdpCache.h"
 
 #include <boost/container/flat_map.hpp>
+#include <folly/SharedMutex.h>
 #include <folly/logging/xlog.h>
 #include <list>
 #include <mutex>
@@ -67,19 +68,19 @@ NeighborUpdater::~NeighborUpdater() {
 }
 
 shared_ptr<ArpCache> NeighborUpdater::getArpCacheFor(VlanID vlan) {
-  std::lock_guard<std::mutex> g(cachesMutex_);
+  folly::SharedMutexWritePriority::ReadHolder g(&cachesMutex_);
   return getArpCacheInternal(vlan);
 }
 
 shared_ptr<NdpCache> NeighborUpdater::getNdpCacheFor(VlanID vlan) {
-  std::lock_guard<std::mutex> g(cachesMutex_);
+  folly::SharedMutexWritePriority::ReadHolder g(&cachesMutex_);
   return getNdpCacheInternal(vlan);
 }
 
 void NeighborUpdater::getArpCacheData(std::vector<ArpEntryThrift>& arpTable) {
   std::list<ArpEntryThrift> entries;
   {
-    std::lock_guard<std::mutex> g(cachesMutex_);
+    folly::SharedMutexWritePriority::ReadHolder g(&cachesMutex_);
     for (auto it = caches_.begin(); it != caches_.end(); ++it) {
       entries.splice(entries.end(), it->second->arpCache->getArpCacheData());
     }
@@ -93,7 +94,7 @@ void NeighborUpdater::getArpCacheData(std::vector<ArpEntryThrift>& arpTable) {
 void NeighborUpdater::getNdpCacheData(std::vector<NdpEntryThrift>& ndpTable) {
   std::list<NdpEntryThrift> entries;
   {
-    std::lock_guard<std::mutex> g(cachesMutex_);
+    folly::SharedMutexWritePriority::ReadHolder g(&cachesMutex_);
     for (auto it = caches_.begin(); it != caches_.end(); ++it) {
       entries.splice(entries.end(), it->second->ndpCache->getNdpCacheData());
     }
@@ -119,6 +120,14 @@ shared_ptr<NdpCache> NeighborUpdater::getNdpCacheInternal(VlanID vlan) {
   return res->second->ndpCache;
 }
 
+bool NeighborUpdater::isProbing(VlanID vlan, IPAddressV4 ip) {
+  return getArpCacheFor(vlan)->isProbing(ip);
+}
+
+bool NeighborUpdater::isProbing(VlanID vlan, IPAddressV6 ip) {
+  return getNdpCacheFor(vlan)->isProbing(ip);
+}
+
 void NeighborUpdater::sentNeighborSolicitation(VlanID vlan,
                                                IPAddressV6 ip) {
   auto cache = getNdpCacheFor(vlan);
@@ -181,6 +190,22 @@ void NeighborUpdater::portDown(PortDescriptor port) {
   }
 }
 
+void NeighborUpdater::livenessChanged(VlanID vlan, IPAddress ip, bool up) {
+  if (ip.isV4()) {
+    getArpCacheFor(vlan)->setHeldDown(ip.asV4(), !up);
+  } else {
+    getNdpCacheFor(vlan)->setHeldDown(ip.asV6(), !up);
+  }
+}
+
+folly::Optional<std::pair<folly::MacAddress, PortDescriptor>>
+NeighborUpdater::getResolvedNeighbor(VlanID vlan, IPAddress ip) {
+  if (ip.isV4()) {
+    return getArpCacheFor(vlan)->getResolvedNeighbor(ip.asV4());
+  }
+  return getNdpCacheFor(vlan)->getResolvedNeighbor(ip.asV6());
+}
+
 // expects the cachesMutex_ to be held
 bool NeighborUpdater::flushEntryImpl(VlanID vlan, IPAddress ip) {
   if (ip.isV4()) {
@@ -195,7 +220,7 @@ uint32_t NeighborUpdater::flushEntry(VlanID vlan, IPAddress ip) {
   // clone caches_ so we don't need to hold the lock while flushing entries
   boost::container::flat_map<VlanID, std::shared_ptr<NeighborCaches>> caches;
   {
-    std::lock_guard<std::mutex> g(cachesMutex_);
+    folly::SharedMutexWritePriority::ReadHolder g(&cachesMutex_);
     caches = caches_;
   }
 
@@ -236,7 +261,7 @@ void NeighborUpdater::stateUpdated(const StateDelta& delta) {
       oldState->getNdpTimeout() != newState->getNdpTimeout() ||
       oldState->getMaxNeighborProbes() != newState->getMaxNeighborProbes() ||
       oldState->getStaleEntryInterval() != newState->getStaleEntryInterval()) {
-    std::lock_guard<std::mutex> g(cachesMutex_);
+    folly::SharedMutexWritePriority::ReadHolder g(&cachesMutex_);
     for (auto& vlanAndCaches : caches_) {
       auto& arpCache = vlanAndCaches.second->arpCache;
       auto& ndpCache = vlanAndCaches.second->ndpCache;
@@ -258,34 +283,34 @@ void NeighborUpdater::stateUpdated(const StateDelta& delta) {
 
 template<typename T>
 void collectPresenceChange(const T& delta,
-                          std::vector<std::string>* added,
-                          std::vector<std::string>* deleted) {
+                          std::vector<folly::IPAddress>* added,
+                          std::vector<folly::IPAddress>* deleted) {
   for (const auto& entry : delta) {
     auto oldEntry = entry.getOld();
     auto newEntry = entry.getNew();
     if (oldEntry && !newEntry) {
       if (oldEntry->nonZeroPort()) {
-        deleted->push_back(folly::to<std::string>(oldEntry->getIP()));
+        deleted->push_back(oldEntry->getIP());
       }
     } else if (newEntry && !oldEntry) {
       if (newEntry->nonZeroPort()) {
-        added->push_back(folly::to<std::string>(newEntry->getIP()));
+        added->push_back(newEntry->getIP());
       }
     } else {
       if (oldEntry->zeroPort() && newEntry->nonZeroPort()) {
         // Entry was resolved, add it
-        added->push_back(folly::to<std::string>(newEntry->getIP()));
+        added->push_back(newEntry->getIP());
       } else if (oldEntry->nonZeroPort() && newEntry->zeroPort()) {
         // Entry became unresolved, prune it
-        deleted->push_back(folly::to<std::string>(oldEntry->getIP()));
+        deleted->push_back(oldEntry->getIP());
       }
     }
   }
 }
 
 void NeighborUpdater::sendNeighborUpdates(const VlanDelta& delta) {
-  std::vector<std::string> added;
-  std::vector<std::string> deleted;
+  std::vector<folly::IPAddress> added;
+  std::vector<folly::IPAddress> deleted;
   collectPresenceChange(delta.getArpDelta(), &added, &deleted);
   collectPresenceChange(delta.getNdpDelta(), &added, &deleted);
   if (!(added.empty() && deleted.empty())) {
@@ -309,7 +334,7 @@ void NeighborUpdater::vlanAdded(const SwitchState* state, const Vlan* vlan) {
   caches->ndpCache->repopulate(vlan->getNdpTable());
 
   {
-    std::lock_guard<std::mutex> g(cachesMutex_);
+    folly::SharedMutexWritePriority::WriteHolder g(&cachesMutex_);
     caches_.emplace(vlan->getID(), std::move(caches));
   }
 }
@@ -318,7 +343,7 @@ void NeighborUpdater::vlanDeleted(const Vlan* vlan) {
   CHECK(sw_->getUpdateEvb()->inRunningEventBaseThread());
   std::shared_ptr<NeighborCaches> removedEntry;
   {
-    std::lock_guard<std::mutex> g(cachesMutex_);
+    folly::SharedMutexWritePriority::WriteHolder g(&cachesMutex_);
     auto iter = caches_.find(vlan->getID());
     if (iter != caches_.end()) {
       // we copy the entry over so we don't destroy the
@@ -343,7 +368,7 @@ void NeighborUpdater::vlanChanged(const Vlan* oldVlan, const Vlan* newVlan) {
 
   CHECK(sw_->getUpdateEvb()->inRunningEventBaseThread());
   {
-    std::lock_guard<std::mutex> g(cachesMutex_);
+    folly::SharedMutexWritePriority::ReadHolder g(&cachesMutex_);
     auto iter = caches_.find(newVlan->getID());
     if (iter != caches_.end()) {
       auto intfID = newVlan->getInterfaceID();
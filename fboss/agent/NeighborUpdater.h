@@ -15,6 +15,8 @@
 #include "fboss/agent/ArpCache.h"
 #include "fboss/agent/NdpCache.h"
 #include "fboss/agent/state/PortDescriptor.h"
+#include <folly/Optional.h>
+#include <folly/SharedMutex.h>
 #include <list>
 #include <mutex>
 #include <string>
@@ -51,6 +53,13 @@ class NeighborUpdater : public AutoRegisterStateObserver {
 
   uint32_t flushEntry (VlanID vlan, folly::IPAddress ip);
 
+  /*
+   * Whether the neighbor cache of vlan is already probing for ip, so that
+   * the packet handlers need not send a request of their own.
+   */
+  bool isProbing(VlanID vlan, folly::IPAddressV4 ip);
+  bool isProbing(VlanID vlan, folly::IPAddressV6 ip);
+
   // Ndp events
   void sentNeighborSolicitation(VlanID vlan,
                                 folly::IPAddressV6 ip);
@@ -85,6 +94,15 @@ class NeighborUpdater : public AutoRegisterStateObserver {
 
   void portDown(PortDescriptor port);
 
+  /*
+   * Next hop liveness, as BFD sees it. While a neighbor is down its entry
+   * is kept pending in the SwitchState, which takes it out of the ECMP
+   * groups in the hardware, though it stays resolved in the cache.
+   */
+  void livenessChanged(VlanID vlan, folly::IPAddress ip, bool up);
+  folly::Optional<std::pair<folly::MacAddress, PortDescriptor>>
+  getResolvedNeighbor(VlanID vlan, folly::IPAddress ip);
+
   void getArpCacheData(std::vector<ArpEntryThrift>& arpTable);
 
   void getNdpCacheData(std::vector<NdpEntryThrift>& ndpTable);
@@ -138,9 +156,12 @@ class NeighborUpdater : public AutoRegisterStateObserver {
    * with cachesMutex_. Note that this means that the cache implmentation cade
    * should NOT ever call back into NeighborUpdater because of this, as it would
    * likely be a lock ordering issue.
+   *
+   * Lookups, from packet handling and the neighbor cache threads, only take
+   * it shared; it is held exclusively only to add or remove a vlan.
    */
   boost::container::flat_map<VlanID, std::shared_ptr<NeighborCaches>> caches_;
-  std::mutex cachesMutex_;
+  folly::SharedMutexWritePriority cachesMutex_;
   SwSwitch* sw_{nullptr};
 };
 
@@ -0,0 +1,172 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/PendingPacketQueue.h"
+
+#include "fboss/agent/RxPacket.h"
+#include "fboss/agent/SwitchStats.h"
+#include "fboss/agent/TxPacket.h"
+#include "fboss/agent/state/ArpTable.h"
+#include "fboss/agent/state/DeltaFunctions.h"
+#include "fboss/agent/state/NdpTable.h"
+#include "fboss/agent/state/StateDelta.h"
+#include "fboss/agent/state/Vlan.h"
+
+#include <boost/functional/hash.hpp>
+#include <folly/io/Cursor.h>
+#include <gflags/gflags.h>
+
+#include <algorithm>
+
+DEFINE_int32(
+    pending_packets_per_neighbor,
+    0,
+    "Packets held for each unresolved next hop until it resolves; "
+    "0 to drop them");
+DEFINE_int32(
+    pending_packet_timeout_ms,
+    1000,
+    "How long packets are held for an unresolved next hop");
+DEFINE_int32(
+    pending_packet_neighbors,
+    1024,
+    "Number of unresolved next hops that packets are held for");
+
+using std::chrono::steady_clock;
+
+namespace facebook { namespace fboss {
+
+namespace {
+
+template <typename NeighborDelta>
+void collectResolved(
+    VlanID vlan,
+    const NeighborDelta& delta,
+    std::vector<std::pair<VlanID, folly::IPAddress>>* resolved) {
+  using EntryT = typename NeighborDelta::Node;
+  auto collect = [&](const std::shared_ptr<EntryT>& entry) {
+    if (!entry->isPending()) {
+      resolved->emplace_back(vlan, folly::IPAddress(entry->getIP()));
+    }
+  };
+  DeltaFunctions::forEachChanged(
+      delta,
+      [&](const std::shared_ptr<EntryT>& /*oldEntry*/,
+          const std::shared_ptr<EntryT>& newEntry) { collect(newEntry); },
+      collect,
+      [](const std::shared_ptr<EntryT>& /*oldEntry*/) {});
+}
+
+} // namespace
+
+PendingPacketQueue::PendingPacketQueue(SwSwitch* sw)
+    : AutoRegisterStateObserver(sw, "PendingPacketQueue"),
+      sw_(sw),
+      pending_(std::max(FLAGS_pending_packet_neighbors, 1)) {}
+
+PendingPacketQueue::~PendingPacketQueue() {}
+
+size_t PendingPacketQueue::KeyHash::operator()(const Key& key) const {
+  size_t hash = std::hash<folly::IPAddress>()(key.second);
+  boost::hash_combine(hash, static_cast<uint16_t>(key.first));
+  return hash;
+}
+
+bool PendingPacketQueue::expired(
+    const Pending& pending,
+    steady_clock::time_point now) {
+  return now - pending.firstQueued >
+      std::chrono::milliseconds(FLAGS_pending_packet_timeout_ms);
+}
+
+bool PendingPacketQueue::enqueue(
+    VlanID vlan,
+    const folly::IPAddress& nextHop,
+    const RxPacket* pkt) {
+  if (FLAGS_pending_packets_per_neighbor <= 0) {
+    return false;
+  }
+  Key key{vlan, nextHop};
+  auto now = steady_clock::now();
+  // Copy the packet out of the driver's buffer before taking the lock
+  auto buf =
+      folly::IOBuf::copyBuffer(pkt->buf()->data(), pkt->buf()->length());
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = pending_.find(key);
+  if (it == pending_.end()) {
+    pending_.set(key, Pending{now, {}});
+    it = pending_.find(key);
+  } else if (expired(it->second, now)) {
+    it->second.firstQueued = now;
+    it->second.packets.clear();
+  }
+  auto& packets = it->second.packets;
+  if (packets.size() >=
+      static_cast<size_t>(FLAGS_pending_packets_per_neighbor)) {
+    return false;
+  }
+  packets.push_back(std::move(buf));
+  sw_->stats()->pendingPktQueued();
+  return true;
+}
+
+void PendingPacketQueue::stateUpdated(const StateDelta& delta) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (pending_.empty()) {
+      return;
+    }
+  }
+  std::vector<Key> resolved;
+  for (const auto& vlanDelta : delta.getVlansDelta()) {
+    const auto& newVlan = vlanDelta.getNew();
+    if (!newVlan) {
+      continue;
+    }
+    collectResolved(newVlan->getID(), vlanDelta.getArpDelta(), &resolved);
+    collectResolved(newVlan->getID(), vlanDelta.getNdpDelta(), &resolved);
+  }
+  if (!resolved.empty()) {
+    flush(resolved);
+  }
+}
+
+void PendingPacketQueue::flush(const std::vector<Key>& resolved) {
+  auto now = steady_clock::now();
+  std::vector<std::unique_ptr<folly::IOBuf>> toSend;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& key : resolved) {
+      auto it = pending_.find(key);
+      if (it == pending_.end()) {
+        continue;
+      }
+      if (!expired(it->second, now)) {
+        std::move(
+            it->second.packets.begin(),
+            it->second.packets.end(),
+            std::back_inserter(toSend));
+      }
+      pending_.erase(key);
+    }
+  }
+
+  for (auto& buf : toSend) {
+    // The frame is still addressed to our MAC, so the hardware routes it
+    // now that the next hop is resolved
+    auto pkt = sw_->allocatePacket(buf->length());
+    folly::io::RWPrivateCursor cursor(pkt->buf());
+    cursor.push(buf->data(), buf->length());
+    sw_->sendPacketSwitchedAsync(std::move(pkt));
+    sw_->stats()->pendingPktFlushed();
+  }
+}
+
+}} // facebook::fboss
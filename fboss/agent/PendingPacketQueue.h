@@ -0,0 +1,86 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include "fboss/agent/StateObserver.h"
+#include "fboss/agent/types.h"
+
+#include <folly/IPAddress.h>
+#include <folly/container/EvictingCacheMap.h>
+#include <folly/io/IOBuf.h>
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace facebook { namespace fboss {
+
+class RxPacket;
+
+/*
+ * Packets trapped to the CPU because their next hop is not resolved yet.
+ * Rather than drop them, the IPv4 and IPv6 handlers keep a copy of the first
+ * few for each next hop here. Once the neighbor entry for that next hop is
+ * resolved in the SwitchState, the copies are sent back into the pipeline,
+ * which can now route them in hardware.
+ *
+ * The number of packets held per neighbor, how long they are held and how
+ * many neighbors are tracked come from the pending_packet* flags; nothing is
+ * held unless pending_packets_per_neighbor is set. Packets for a neighbor
+ * that is not resolved in time are dropped the next time one is queued for
+ * it or it resolves; neighbors that fall out of the table drop theirs right
+ * away.
+ */
+class PendingPacketQueue : public AutoRegisterStateObserver {
+ public:
+  explicit PendingPacketQueue(SwSwitch* sw);
+  ~PendingPacketQueue() override;
+
+  /*
+   * Keep a copy of pkt until nextHop on vlan is resolved. Returns false if
+   * the packet was not queued, because the neighbor already has as many
+   * packets held as it may.
+   */
+  bool enqueue(
+      VlanID vlan,
+      const folly::IPAddress& nextHop,
+      const RxPacket* pkt);
+
+  void stateUpdated(const StateDelta& delta) override;
+
+ private:
+  using Key = std::pair<VlanID, folly::IPAddress>;
+  struct KeyHash {
+    size_t operator()(const Key& key) const;
+  };
+  struct Pending {
+    std::chrono::steady_clock::time_point firstQueued;
+    std::vector<std::unique_ptr<folly::IOBuf>> packets;
+  };
+
+  // Forbidden copy constructor and assignment operator
+  PendingPacketQueue(PendingPacketQueue const &) = delete;
+  PendingPacketQueue& operator=(PendingPacketQueue const &) = delete;
+
+  static bool expired(
+      const Pending& pending,
+      std::chrono::steady_clock::time_point now);
+
+  // Send out the packets held for the neighbors resolved in this delta
+  void flush(const std::vector<Key>& resolved);
+
+  SwSwitch* sw_{nullptr};
+  std::mutex mutex_;
+  folly::EvictingCacheMap<Key, Pending, KeyHash> pending_;
+};
+
+}} // facebook::fboss
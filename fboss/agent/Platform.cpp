@@ -19,11 +19,22 @@ DEFINE_string(crash_switch_state_file, "crash_switch_state",
 DEFINE_string(crash_hw_state_file, "crash_hw_state",
               "File for dumping HW state on crash");
 
+DEFINE_string(boot_trace_file, "boot_trace.json",
+              "File for dumping a Chrome trace of startup once the FIB is "
+              "synced, empty to not dump one");
+
 namespace facebook { namespace fboss {
 
 Platform::Platform() {}
 Platform::~Platform() {}
 
+std::string Platform::getBootTraceFile() const {
+  if (FLAGS_boot_trace_file.empty()) {
+    return "";
+  }
+  return getPersistentStateDir() + "/" + FLAGS_boot_trace_file;
+}
+
 std::string Platform::getCrashHwStateFile() const {
   return getCrashInfoDir() + "/" + FLAGS_crash_hw_state_file;
 }
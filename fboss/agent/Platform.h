@@ -158,6 +158,10 @@ class Platform {
    * Get filename for where we dump switch state on crash
    */
   std::string getCrashSwitchStateFile() const;
+  /*
+   * Get filename for where we dump the startup timeline, empty if disabled
+   */
+  std::string getBootTraceFile() const;
   /*
    * For a specific logical port, return the transceiver and channel
    * it represents if available
@@ -0,0 +1,172 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/PortInfoCache.h"
+
+#include "common/stats/ServiceData.h"
+#include "fboss/agent/HwSwitch.h"
+#include "fboss/agent/SwSwitch.h"
+#include "fboss/agent/state/DeltaFunctions.h"
+#include "fboss/agent/state/Port.h"
+#include "fboss/agent/state/PortMap.h"
+#include "fboss/agent/state/PortQueue.h"
+#include "fboss/agent/state/StateDelta.h"
+#include "fboss/agent/state/SwitchState.h"
+
+#include <folly/Conv.h>
+#include <folly/Range.h>
+#include <folly/logging/xlog.h>
+
+using folly::StringPiece;
+
+namespace facebook {
+namespace fboss {
+
+PortInfoCache::PortInfoCache(SwSwitch* sw)
+    : AutoRegisterStateObserver(sw, "PortInfoCache"),
+      sw_(sw),
+      snapshot_(std::make_shared<PortInfoMap>()) {}
+
+void PortInfoCache::stateUpdated(const StateDelta& delta) {
+  if (delta.oldState()->getPorts() == delta.newState()->getPorts()) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> g(updateMutex_);
+  auto ports = std::make_shared<PortInfoMap>(*snapshot_.copy());
+  auto rebuild = [&](const std::shared_ptr<Port>& port) {
+    PortInfoThrift info;
+    fillPortInfo(port, &info);
+    fillPortStats(&info);
+    (*ports)[port->getID()] = std::move(info);
+  };
+  DeltaFunctions::forEachChanged(
+      delta.getPortsDelta(),
+      [&](const std::shared_ptr<Port>& /*oldPort*/,
+          const std::shared_ptr<Port>& newPort) { rebuild(newPort); },
+      rebuild,
+      [&](const std::shared_ptr<Port>& oldPort) {
+        ports->erase(oldPort->getID());
+      });
+  *snapshot_.wlock() = std::move(ports);
+}
+
+void PortInfoCache::statsUpdated() {
+  std::lock_guard<std::mutex> g(updateMutex_);
+  auto ports = std::make_shared<PortInfoMap>(*snapshot_.copy());
+  for (auto& entry : *ports) {
+    fillPortStats(&entry.second);
+  }
+  *snapshot_.wlock() = std::move(ports);
+}
+
+void PortInfoCache::fillPortInfo(
+    const std::shared_ptr<Port>& port,
+    PortInfoThrift* info) const {
+  info->portId = port->getID();
+  info->name = port->getName();
+  info->description = port->getDescription();
+  info->speedMbps = static_cast<int>(port->getSpeed());
+  for (auto entry : port->getVlans()) {
+    info->vlans.push_back(entry.first);
+  }
+
+  for (const auto& queue : port->getPortQueues()) {
+    PortQueueThrift pq;
+    pq.id = queue->getID();
+    pq.mode = cfg::_QueueScheduling_VALUES_TO_NAMES.find(
+        queue->getScheduling())->second;
+    if (queue->getScheduling() == cfg::QueueScheduling::WEIGHTED_ROUND_ROBIN) {
+      pq.weight_ref() = queue->getWeight();
+    }
+    if (queue->getReservedBytes()) {
+      pq.reservedBytes_ref() = queue->getReservedBytes().value();
+    }
+    if (queue->getScalingFactor()) {
+      pq.scalingFactor_ref() = cfg::_MMUScalingFactor_VALUES_TO_NAMES
+                                   .find(queue->getScalingFactor().value())
+                                   ->second;
+    }
+    if (!queue->getAqms().empty()) {
+      std::vector<ActiveQueueManagement> aqms;
+      for (const auto& aqm: queue->getAqms()) {
+        ActiveQueueManagement aqmThrift;
+        switch (aqm.second.detection.getType()) {
+          case cfg::QueueCongestionDetection::Type::linear:
+            aqmThrift.detection.linear_ref().value_unchecked().minimumLength =
+                aqm.second.detection.get_linear().minimumLength;
+            aqmThrift.detection.linear_ref().value_unchecked().maximumLength =
+                aqm.second.detection.get_linear().maximumLength;
+            aqmThrift.detection.__isset.linear = true;
+            break;
+          case cfg::QueueCongestionDetection::Type::__EMPTY__:
+            XLOG(WARNING) << "Invalid queue congestion detection config";
+            break;
+        }
+        aqmThrift.behavior = QueueCongestionBehavior(aqm.first);
+        aqms.push_back(aqmThrift);
+      }
+      pq.aqms_ref().value_unchecked().swap(aqms);
+      pq.__isset.aqms = true;
+    }
+    if (queue->getName()) {
+      pq.name = queue->getName().value();
+    }
+    info->portQueues.push_back(pq);
+  }
+
+  info->adminState =
+      PortAdminState(port->getAdminState() == cfg::PortState::ENABLED);
+  info->operState =
+      PortOperState(port->getOperState() == Port::OperState::UP);
+  info->fecEnabled = sw_->getHw()->getPortFECEnabled(port->getID());
+
+  auto pause = port->getPause();
+  info->txPause = pause.tx;
+  info->rxPause = pause.rx;
+}
+
+void PortInfoCache::fillPortStats(PortInfoThrift* info) {
+  auto statMap = fbData->getStatMap();
+  auto portName = info->name.empty()
+      ? folly::to<std::string>("port", info->portId)
+      : info->name;
+
+  auto getSumStat = [&] (StringPiece prefix, StringPiece name) {
+    auto statName = folly::to<std::string>(portName, ".", prefix, name);
+    auto statPtr = statMap->getLockedStatPtr(statName);
+    auto numLevels = statPtr->numLevels();
+    // Cumulative (ALLTIME) counters are at (numLevels - 1)
+    return statPtr->sum(numLevels - 1);
+  };
+
+  auto fillPortCounters = [&] (PortCounters& ctr, StringPiece prefix) {
+    ctr.bytes = getSumStat(prefix, "bytes");
+    ctr.ucastPkts = getSumStat(prefix, "unicast_pkts");
+    ctr.multicastPkts = getSumStat(prefix, "multicast_pkts");
+    ctr.broadcastPkts = getSumStat(prefix, "broadcast_pkts");
+    ctr.errors.errors = getSumStat(prefix, "errors");
+    ctr.errors.discards = getSumStat(prefix, "discards");
+  };
+
+  fillPortCounters(info->output, "out_");
+  fillPortCounters(info->input, "in_");
+  info->output.unicast.clear();
+  for (size_t i = 0; i < info->portQueues.size(); i++) {
+    auto queue = folly::to<std::string>("queue", i, ".");
+    QueueStats stats;
+    stats.congestionDiscards =
+        getSumStat(queue, "out_congestion_discards_bytes");
+    stats.outBytes = getSumStat(queue, "out_bytes");
+    info->output.unicast.push_back(stats);
+  }
+}
+
+} // namespace fboss
+} // namespace facebook
@@ -0,0 +1,69 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include "fboss/agent/StateObserver.h"
+#include "fboss/agent/if/gen-cpp2/ctrl_types.h"
+
+#include <folly/Synchronized.h>
+
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace facebook {
+namespace fboss {
+
+class Port;
+class StateDelta;
+class SwSwitch;
+
+/*
+ * Keeps the getAllPortInfo() response ready to hand out.
+ *
+ * The config and state fields of a port are rebuilt only when that port
+ * changes in a StateDelta, and the counters of all ports are refreshed once
+ * at the end of each stats cycle, rather than on every thrift call.  Readers
+ * get a shared immutable snapshot, so the counters are as of the last stats
+ * cycle.
+ */
+class PortInfoCache : public AutoRegisterStateObserver {
+ public:
+  using PortInfoMap = std::map<int32_t, PortInfoThrift>;
+
+  explicit PortInfoCache(SwSwitch* sw);
+
+  void stateUpdated(const StateDelta& delta) override;
+
+  // Called from the stats thread once the port counters have been updated
+  void statsUpdated();
+
+  std::shared_ptr<const PortInfoMap> getSnapshot() const {
+    return snapshot_.copy();
+  }
+
+ private:
+  void fillPortInfo(const std::shared_ptr<Port>& port, PortInfoThrift* info)
+      const;
+  static void fillPortStats(PortInfoThrift* info);
+
+  // Forbidden copy constructor and assignment operator
+  PortInfoCache(PortInfoCache const&) = delete;
+  PortInfoCache& operator=(PortInfoCache const&) = delete;
+
+  SwSwitch* sw_{nullptr};
+  // Serializes the state and stats updates, which copy the snapshot, change
+  // the copy and publish it
+  std::mutex updateMutex_;
+  folly::Synchronized<std::shared_ptr<const PortInfoMap>> snapshot_;
+};
+
+} // namespace fboss
+} // namespace facebook
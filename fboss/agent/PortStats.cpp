@@ -19,12 +19,14 @@ namespace facebook { namespace fboss {
 const std::string kNameKeySeperator = ".";
 const std::string kUp = "up";
 const std::string kLinkStateFlap = "link_state.flap";
+const std::string kAdmissionDrop = "trapped.admission_drops";
 
 PortStats::PortStats(PortID portID, std::string portName,
                      SwitchStats *switchStats)
   : portID_(portID),
     portName_(portName),
     switchStats_(switchStats) {
+  initCounters();
 }
 
 PortStats::~PortStats() {
@@ -36,6 +38,16 @@ void PortStats::setPortName(const std::string &portName) {
   // clear counter
   clearPortStatusCounter();
   portName_ = portName;
+  initCounters();
+}
+
+void PortStats::initCounters() {
+  if (portName_.empty()) {
+    return;
+  }
+  linkStateFlapKey_ = getCounterKey(kLinkStateFlap);
+  admissionDropKey_ = getCounterKey(kAdmissionDrop);
+  upCounter_ = CounterRegistry::get()->acquire(getCounterKey(kUp));
 }
 
 void PortStats::trappedPkt() {
@@ -53,6 +65,16 @@ void PortStats::pktError() {
 void PortStats::pktUnhandled() {
   switchStats_->pktUnhandled();
 }
+void PortStats::pktRxQueueDrop(size_t queue) {
+  switchStats_->rxQueueDrop(queue);
+}
+void PortStats::pktAdmissionDrop() {
+  // Kept per port, like linkStateChange(), to tell which neighbor floods us
+  if (!portName_.empty()) {
+    tcData().addStatValue(admissionDropKey_, 1, SUM);
+  }
+  switchStats_->rxAdmissionDrop();
+}
 void PortStats::pktToHost(uint32_t bytes) {
   switchStats_->pktToHost(bytes);
 }
@@ -115,6 +137,10 @@ void PortStats::ipv6HopExceeded() {
   switchStats_->ipv6HopExceeded();
 }
 
+void PortStats::icmpRateLimited() {
+  switchStats_->icmpRateLimited();
+}
+
 void PortStats::udpTooSmall() {
   switchStats_->udpTooSmall();
 }
@@ -151,7 +177,7 @@ void PortStats::linkStateChange() {
   // Using tcData() can make sure we don't have to maintain the lifecycle of
   // TLTimeseries and leave ThreadLocalStats do it for us.
   if (!portName_.empty()) {
-    tcData().addStatValue(getCounterKey(kLinkStateFlap), 1, SUM);
+    tcData().addStatValue(linkStateFlapKey_, 1, SUM);
   }
   switchStats_->linkStateChange();
 }
@@ -165,14 +191,16 @@ void PortStats::ipv6DstLookupFailure() {
 }
 
 void PortStats::setPortStatus(bool isUp) {
-  if (!portName_.empty()) {
-    tcData().setCounter(getCounterKey(kUp), isUp);
+  if (upCounter_ != CounterRegistry::kInvalidHandle) {
+    CounterRegistry::get()->setValue(upCounter_, isUp);
   }
 }
 
 void PortStats::clearPortStatusCounter() {
-  if (!portName_.empty()) {
-    tcData().clearCounter(getCounterKey(kUp));
+  if (upCounter_ != CounterRegistry::kInvalidHandle) {
+    CounterRegistry::get()->clearValue(upCounter_);
+    CounterRegistry::get()->release(upCounter_);
+    upCounter_ = CounterRegistry::kInvalidHandle;
   }
 }
 
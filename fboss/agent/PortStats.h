@@ -9,6 +9,7 @@
  */
 #pragma once
 
+#include "fboss/agent/CounterRegistry.h"
 #include "fboss/agent/types.h"
 
 namespace facebook { namespace fboss {
@@ -25,6 +26,10 @@ class PortStats {
   void pktBogus();
   void pktError();
   void pktUnhandled();
+  // dropped because its RxPacketDispatcher queue was full
+  void pktRxQueueDrop(size_t queue);
+  // Over the port's rate for its kind of packet in RxAdmissionControl
+  void pktAdmissionDrop();
   void pktToHost(uint32_t bytes); // number of packets forward to host
 
   void arpPkt();
@@ -50,6 +55,8 @@ class PortStats {
 
   void ipv6HopExceeded();
 
+  void icmpRateLimited();
+
   void dhcpV4Pkt();
   void dhcpV4BadPkt();
   void dhcpV4DropPkt();
@@ -78,6 +85,8 @@ class PortStats {
   PortStats& operator=(PortStats const &) = delete;
 
   std::string getCounterKey(const std::string& key);
+  // (Re)compute everything derived from portName_
+  void initCounters();
 
   /*
    * It's useful to store this
@@ -89,6 +98,11 @@ class PortStats {
    */
   std::string portName_;
 
+  // Counter identities, computed once per port name rather than per update
+  std::string linkStateFlapKey_;
+  std::string admissionDropKey_;
+  CounterRegistry::Handle upCounter_{CounterRegistry::kInvalidHandle};
+
   // Pointer to main SwitchStats object so that we can forward method calls
   // that we do not want to track ourselves.
   SwitchStats *switchStats_;
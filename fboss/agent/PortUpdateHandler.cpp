@@ -17,6 +17,8 @@
 #include "fboss/agent/SwitchStats.h"
 #include "fboss/agent/PortStats.h"
 
+#include <vector>
+
 namespace facebook { namespace fboss {
 
 PortUpdateHandler::PortUpdateHandler(SwSwitch* sw)
@@ -25,8 +27,9 @@ PortUpdateHandler::PortUpdateHandler(SwSwitch* sw)
 }
 
 void PortUpdateHandler::stateUpdated(const StateDelta& delta) {
-  // For now, the stateUpdated is only used to update the portName of PortStats
-  // for all threads.
+  // Updates the portName and status of PortStats for all threads, and tells
+  // port status listeners about the ports whose status changed.
+  std::vector<std::shared_ptr<Port>> statusChanged;
   DeltaFunctions::forEachChanged(
       delta.getPortsDelta(),
       [&](const std::shared_ptr<Port>& oldPort,
@@ -55,9 +58,15 @@ void PortUpdateHandler::stateUpdated(const StateDelta& delta) {
             }
           }
         }
+        if (oldPort->isUp() != newPort->isUp() ||
+            oldPort->isEnabled() != newPort->isEnabled() ||
+            oldPort->getSpeed() != newPort->getSpeed()) {
+          statusChanged.push_back(newPort);
+        }
       },
       [&](const std::shared_ptr<Port>& newPort) {
         sw_->portStats(newPort->getID())->setPortStatus(newPort->isUp());
+        statusChanged.push_back(newPort);
       },
       [&](const std::shared_ptr<Port>& oldPort) {
         for (SwitchStats& switchStats : sw_->getAllThreadsSwitchStats()) {
@@ -67,5 +76,6 @@ void PortUpdateHandler::stateUpdated(const StateDelta& delta) {
           sw_->getLldpMgr()->portDown(oldPort->getID());
         }
       });
+  sw_->publishPortStatus(statusChanged);
 }
 }}
@@ -10,6 +10,7 @@
 #include "fboss/agent/RestartTimeTracker.h"
 
 #include "common/stats/ServiceData.h"
+#include "fboss/agent/BootTrace.h"
 #include "fboss/agent/Utils.h"
 
 #include <folly/Conv.h>
@@ -22,6 +23,8 @@
 #include <sys/stat.h>
 #include <unistd.h>
 #include <mutex>
+#include <utility>
+#include <vector>
 
 namespace facebook {
 namespace fboss {
@@ -90,6 +93,10 @@ std::string to_string(RestartEvent type) {
       return "parent_process_started";
     case RestartEvent::PROCESS_STARTED:
       return "process_started";
+    case RestartEvent::ASIC_INITIALIZED:
+      return "asic_initialized";
+    case RestartEvent::PORTS_INITIALIZED:
+      return "ports_initialized";
     case RestartEvent::INITIALIZED:
       return "initialized";
     case RestartEvent::CONFIGURED:
@@ -100,6 +107,20 @@ std::string to_string(RestartEvent type) {
       return "signal_received";
     case RestartEvent::SHUTDOWN:
       return "shutdown";
+    case RestartEvent::WARM_BOOT_STATE_LOADING:
+      return "warm_boot_state_loading";
+    case RestartEvent::WARM_BOOT_STATE_LOADED:
+      return "warm_boot_state_loaded";
+    case RestartEvent::WARM_BOOT_SW_STATE_DECODED:
+      return "warm_boot_sw_state_decoded";
+    case RestartEvent::WARM_BOOT_HOSTS_READ:
+      return "warm_boot_hosts_read";
+    case RestartEvent::WARM_BOOT_ROUTES_READ:
+      return "warm_boot_routes_read";
+    case RestartEvent::WARM_BOOT_EGRESSES_READ:
+      return "warm_boot_egresses_read";
+    case RestartEvent::WARM_BOOT_CACHE_POPULATED:
+      return "warm_boot_cache_populated";
     default:
       throw std::runtime_error(folly::to<std::string>(
           "Unhandled RestartEvent: ", static_cast<uint16_t>(type)));
@@ -138,8 +159,10 @@ class RestartTimeTracker {
     }
   }
 
-  folly::Optional<TimePoint> newEvent(RestartEvent type) {
-    auto tp = create(type);
+  folly::Optional<TimePoint> newEvent(
+      RestartEvent type,
+      folly::Optional<TimePoint> at = folly::none) {
+    auto tp = at ? at : create(type);
 
     if (tp) {
       if (lastEvent_) {
@@ -176,9 +199,18 @@ class RestartTimeTracker {
         return processStartTime(getppid());
       case RestartEvent::PROCESS_STARTED:
         return processStartTime(getpid());
+      case RestartEvent::ASIC_INITIALIZED:
+      case RestartEvent::PORTS_INITIALIZED:
       case RestartEvent::INITIALIZED:
       case RestartEvent::CONFIGURED:
       case RestartEvent::FIB_SYNCED:
+      case RestartEvent::WARM_BOOT_STATE_LOADING:
+      case RestartEvent::WARM_BOOT_STATE_LOADED:
+      case RestartEvent::WARM_BOOT_SW_STATE_DECODED:
+      case RestartEvent::WARM_BOOT_HOSTS_READ:
+      case RestartEvent::WARM_BOOT_ROUTES_READ:
+      case RestartEvent::WARM_BOOT_EGRESSES_READ:
+      case RestartEvent::WARM_BOOT_CACHE_POPULATED:
         return steady_clock::now();
       case RestartEvent::SIGNAL_RECEIVED:
       case RestartEvent::SHUTDOWN:
@@ -203,28 +235,40 @@ class RestartTimeTracker {
 
 namespace restart_time {
 
-folly::Synchronized<std::unique_ptr<RestartTimeTracker>, std::mutex> impl_;
+struct TrackerState {
+  std::unique_ptr<RestartTimeTracker> tracker;
+  // Events marked before init(), e.g. while the hardware is initializing
+  std::vector<std::pair<RestartEvent, TimePoint>> earlyEvents;
+};
+
+folly::Synchronized<TrackerState, std::mutex> impl_;
 
 void init(const std::string& warmBootDir, bool warmBoot) {
-  auto tracker = impl_.lock();
-  if (*tracker) {
+  auto state = impl_.lock();
+  if (state->tracker) {
     throw std::runtime_error("Called restart_time::init twice...");
   }
-  *tracker = std::make_unique<RestartTimeTracker>(warmBootDir, warmBoot);
+  state->tracker = std::make_unique<RestartTimeTracker>(warmBootDir, warmBoot);
+  for (const auto& event : state->earlyEvents) {
+    state->tracker->newEvent(event.first, event.second);
+  }
+  state->earlyEvents.clear();
 }
 
 void mark(RestartEvent event) {
-  auto tracker = impl_.lock();
-  if (!*tracker) {
-    throw std::runtime_error(
-        "Cannot call restart_time::mark() before restart_time::init");
+  boot_trace::instant(to_string(event));
+  auto state = impl_.lock();
+  if (!state->tracker) {
+    state->earlyEvents.emplace_back(event, steady_clock::now());
+    return;
   }
-  (*tracker)->newEvent(event);
+  state->tracker->newEvent(event);
 }
 
 void stop() {
-  auto tracker = impl_.lock();
-  (*tracker).reset();
+  auto state = impl_.lock();
+  state->tracker.reset();
+  state->earlyEvents.clear();
 }
 
 } // namespace restart_time
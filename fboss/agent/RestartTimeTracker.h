@@ -36,13 +36,30 @@ enum class RestartEvent : uint16_t {
   SHUTDOWN,
   PARENT_PROCESS_STARTED,
   PROCESS_STARTED,
+  ASIC_INITIALIZED,
+  PORTS_INITIALIZED,
   INITIALIZED,
   CONFIGURED,
   FIB_SYNCED,
+  WARM_BOOT_STATE_LOADING,
+  WARM_BOOT_STATE_LOADED,
+  WARM_BOOT_SW_STATE_DECODED,
+  WARM_BOOT_HOSTS_READ,
+  WARM_BOOT_ROUTES_READ,
+  WARM_BOOT_EGRESSES_READ,
+  WARM_BOOT_CACHE_POPULATED,
 };
 
 namespace restart_time {
 void init(const std::string& warmBootDir, bool warmBoot);
+/*
+ * Events marked before init() are held on to, and exported in order once
+ * init() has determined the boot type.
+ *
+ * Each event's stage duration is the time since the previous event.  Phases
+ * that run concurrently are marked as they finish, so the stages show the
+ * critical path through them.
+ */
 void mark(RestartEvent event);
 void stop();
 }; // namespace restart_time
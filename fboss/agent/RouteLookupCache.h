@@ -0,0 +1,116 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include "fboss/agent/state/Route.h"
+#include "fboss/agent/state/SwitchState.h"
+#include "fboss/agent/types.h"
+
+#include <array>
+#include <functional>
+#include <memory>
+
+namespace facebook { namespace fboss {
+
+/*
+ * A small direct mapped cache of longest match results, for one thread.
+ *
+ * Trapped packets are often for the same few destinations, and even more so
+ * while traffic is being black holed, so the rx handlers look their routes
+ * up here first.  Misses, where there is no route, are cached as well.
+ *
+ * Entries are only valid for the SwitchState they were looked up in.  The
+ * first lookup in any other state, or another generation of it, empties the
+ * cache.
+ */
+template <typename AddressT>
+class RouteLookupCache {
+ public:
+  static constexpr size_t kSize = 64;
+
+  RouteLookupCache() {}
+
+  /*
+   * If the longest match for address in vrf of state is cached, set route to
+   * it, which may be null, and return true.
+   */
+  bool lookup(
+      const std::shared_ptr<SwitchState>& state,
+      RouterID vrf,
+      const AddressT& address,
+      std::shared_ptr<Route<AddressT>>* route) {
+    if (!isCurrent(state)) {
+      reset(state);
+      return false;
+    }
+    const auto& entry = entries_[slot(address)];
+    if (!entry.valid || entry.vrf != vrf || entry.address != address) {
+      return false;
+    }
+    *route = entry.route;
+    return true;
+  }
+
+  void insert(
+      const std::shared_ptr<SwitchState>& state,
+      RouterID vrf,
+      const AddressT& address,
+      std::shared_ptr<Route<AddressT>> route) {
+    if (!isCurrent(state)) {
+      reset(state);
+    }
+    auto& entry = entries_[slot(address)];
+    entry.address = address;
+    entry.vrf = vrf;
+    entry.route = std::move(route);
+    entry.valid = true;
+  }
+
+ private:
+  struct Entry {
+    AddressT address;
+    RouterID vrf{0};
+    std::shared_ptr<Route<AddressT>> route;
+    bool valid{false};
+  };
+
+  // Forbidden copy constructor and assignment operator
+  RouteLookupCache(RouteLookupCache const &) = delete;
+  RouteLookupCache& operator=(RouteLookupCache const &) = delete;
+
+  static size_t slot(const AddressT& address) {
+    return std::hash<AddressT>()(address) % kSize;
+  }
+
+  bool isCurrent(const std::shared_ptr<SwitchState>& state) const {
+    // Comparing owners rather than pointers, so that a new state allocated
+    // where a freed one used to be is not mistaken for it
+    return !state_.owner_before(state) && !state.owner_before(state_) &&
+        state->getGeneration() == generation_;
+  }
+
+  void reset(const std::shared_ptr<SwitchState>& state) {
+    for (auto& entry : entries_) {
+      entry.route.reset();
+      entry.valid = false;
+    }
+    state_ = state;
+    generation_ = state->getGeneration();
+  }
+
+  std::weak_ptr<SwitchState> state_;
+  uint32_t generation_{0};
+  std::array<Entry, kSize> entries_;
+};
+
+template <typename AddressT>
+constexpr size_t RouteLookupCache<AddressT>::kSize;
+
+}} // facebook::fboss
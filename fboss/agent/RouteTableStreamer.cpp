@@ -0,0 +1,130 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/RouteTableStreamer.h"
+
+#include "fboss/agent/AddressUtil.h"
+#include "fboss/agent/FbossError.h"
+#include "fboss/agent/state/Route.h"
+#include "fboss/agent/state/RouteNextHopEntry.h"
+#include "fboss/agent/state/SwitchState.h"
+
+#include <algorithm>
+
+using facebook::network::toBinaryAddress;
+using facebook::network::toIPAddress;
+
+namespace facebook {
+namespace fboss {
+
+RouteTableStreamer::RouteTableStreamer(
+    std::shared_ptr<SwitchState> state,
+    const RouteTableFilter& filter,
+    size_t chunkSize)
+    : state_(std::move(state)), chunkSize_(std::max<size_t>(chunkSize, 1)) {
+  if (filter.__isset.prefix) {
+    const auto& prefix = filter.prefix_ref().value_unchecked();
+    auto network = toIPAddress(prefix.ip);
+    if (prefix.prefixLength < 0 || prefix.prefixLength > network.bitCount()) {
+      throw FbossError(
+          "Invalid prefix length ",
+          prefix.prefixLength,
+          " for ",
+          network.str());
+    }
+    prefix_ = folly::CIDRNetwork(
+        network.mask(prefix.prefixLength), prefix.prefixLength);
+  }
+  if (filter.__isset.clientId) {
+    client_ = ClientID(filter.clientId_ref().value_unchecked());
+  }
+
+  table_ = state_->getRouteTables()->begin();
+  tablesEnd_ = state_->getRouteTables()->end();
+  if (table_ != tablesEnd_) {
+    startTable();
+  }
+}
+
+void RouteTableStreamer::startTable() {
+  const auto& table = *table_;
+  v4_ = table->getRibV4()->routes()->begin();
+  v4End_ = table->getRibV4()->routes()->end();
+  v6_ = table->getRibV6()->routes()->begin();
+  v6End_ = table->getRibV6()->routes()->end();
+}
+
+folly::Optional<std::vector<UnicastRoute>> RouteTableStreamer::nextChunk() {
+  std::vector<UnicastRoute> chunk;
+  chunk.reserve(chunkSize_);
+  while (chunk.size() < chunkSize_ && table_ != tablesEnd_) {
+    fill(&chunk, &v4_, v4End_);
+    fill(&chunk, &v6_, v6End_);
+    if (v4_ == v4End_ && v6_ == v6End_) {
+      ++table_;
+      if (table_ != tablesEnd_) {
+        startTable();
+      }
+    }
+  }
+  if (chunk.empty()) {
+    return folly::none;
+  }
+  return chunk;
+}
+
+template <typename Iter>
+void RouteTableStreamer::fill(
+    std::vector<UnicastRoute>* chunk,
+    Iter* it,
+    Iter end) const {
+  for (; chunk->size() < chunkSize_ && *it != end; ++*it) {
+    UnicastRoute route;
+    if (toThrift(***it, &route)) {
+      chunk->push_back(std::move(route));
+    }
+  }
+}
+
+template <typename RouteT>
+bool RouteTableStreamer::toThrift(const RouteT& route, UnicastRoute* out)
+    const {
+  const auto& prefix = route.prefix();
+  if (prefix_ &&
+      (prefix.mask < prefix_->second ||
+       !folly::IPAddress(prefix.network)
+            .inSubnet(prefix_->first, prefix_->second))) {
+    return false;
+  }
+
+  const RouteNextHopSet* nextHops;
+  if (client_) {
+    auto entry = route.getEntryForClient(*client_);
+    if (!entry) {
+      return false;
+    }
+    nextHops = &entry->getNextHopSet();
+  } else {
+    if (!route.isResolved()) {
+      return false;
+    }
+    nextHops = &route.getForwardInfo().getNextHopSet();
+  }
+
+  out->dest.ip = toBinaryAddress(prefix.network);
+  out->dest.prefixLength = prefix.mask;
+  out->nextHops = util::fromRouteNextHopSet(*nextHops);
+  for (const auto& nh : out->nextHops) {
+    out->nextHopAddrs.emplace_back(nh.address);
+  }
+  return true;
+}
+
+} // namespace fboss
+} // namespace facebook
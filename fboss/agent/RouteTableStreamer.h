@@ -0,0 +1,78 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include "fboss/agent/if/gen-cpp2/ctrl_types.h"
+#include "fboss/agent/state/RouteTable.h"
+#include "fboss/agent/state/RouteTableMap.h"
+#include "fboss/agent/state/RouteTableRib.h"
+#include "fboss/agent/types.h"
+
+#include <folly/IPAddress.h>
+#include <folly/Optional.h>
+
+#include <memory>
+#include <vector>
+
+namespace facebook {
+namespace fboss {
+
+class SwitchState;
+
+/*
+ * Walks the route tables of one SwitchState and hands out the routes that
+ * match a RouteTableFilter in chunks, converting each route to thrift only
+ * as its chunk is asked for.  The state is held for as long as the streamer
+ * lives, so later updates don't change what it returns.
+ *
+ * Without a client filter only resolved routes are returned, with their
+ * forwarding next hops, as from getRouteTable().  With one, the client's
+ * routes are returned with the next hops it gave, as from
+ * getRouteTableByClient().
+ */
+class RouteTableStreamer {
+ public:
+  RouteTableStreamer(
+      std::shared_ptr<SwitchState> state,
+      const RouteTableFilter& filter,
+      size_t chunkSize);
+
+  // The next chunk of matching routes, or none once all have been returned
+  folly::Optional<std::vector<UnicastRoute>> nextChunk();
+
+ private:
+  template <typename RibT>
+  using RouteIter = typename RibT::RoutesNodeMap::Iterator;
+
+  void startTable();
+  template <typename Iter>
+  void fill(std::vector<UnicastRoute>* chunk, Iter* it, Iter end) const;
+  template <typename RouteT>
+  bool toThrift(const RouteT& route, UnicastRoute* out) const;
+
+  // Forbidden copy constructor and assignment operator
+  RouteTableStreamer(RouteTableStreamer const&) = delete;
+  RouteTableStreamer& operator=(RouteTableStreamer const&) = delete;
+
+  std::shared_ptr<SwitchState> state_;
+  folly::Optional<folly::CIDRNetwork> prefix_;
+  folly::Optional<ClientID> client_;
+  const size_t chunkSize_;
+
+  RouteTableMap::Iterator table_;
+  RouteTableMap::Iterator tablesEnd_;
+  RouteIter<RouteTable::RibTypeV4> v4_;
+  RouteIter<RouteTable::RibTypeV4> v4End_;
+  RouteIter<RouteTable::RibTypeV6> v6_;
+  RouteIter<RouteTable::RibTypeV6> v6End_;
+};
+
+} // namespace fboss
+} // namespace facebook
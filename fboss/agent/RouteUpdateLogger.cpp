@@ -9,78 +9,107 @@
  */
 
 #include "RouteUpdateLogger.h"
+#include "common/stats/ThreadCachedServiceData.h"
 #include "fboss/agent/state/DeltaFunctions.h"
 
-namespace facebook {
-namespace fboss {
+#include <gflags/gflags.h>
 
-namespace {
-template <typename AddrT>
-void handleChangedRoute(
-    const RouteUpdateLoggingPrefixTracker& tracker,
-    const std::unique_ptr<RouteLogger<AddrT>>& logger,
-    const std::shared_ptr<Route<AddrT>>& oldRoute,
-    const std::shared_ptr<Route<AddrT>>& newRoute) {
-  std::vector<std::string> matchedIdentifiers;
-  auto prefix = oldRoute->prefix();
-  if (tracker.tracking(prefix, matchedIdentifiers)) {
-    logger->logChangedRoute(oldRoute, newRoute, matchedIdentifiers);
-  }
-}
+#include <algorithm>
 
-template <typename AddrT>
-void handleRemovedRoute(
-    const RouteUpdateLoggingPrefixTracker& tracker,
-    const std::unique_ptr<RouteLogger<AddrT>>& logger,
-    const std::shared_ptr<Route<AddrT>>& oldRoute) {
-  std::vector<std::string> matchedIdentifiers;
-  auto prefix = oldRoute->prefix();
-  if (tracker.tracking(prefix, matchedIdentifiers)) {
-    logger->logRemovedRoute(oldRoute, matchedIdentifiers);
-  }
-}
+DEFINE_int32(
+    route_update_log_queue_size,
+    1024,
+    "Number of route update logs that may wait for the logging thread "
+    "before further ones are dropped; 0 logs on the update thread");
 
-template <typename AddrT>
-void handleAddedRoute(
-    const RouteUpdateLoggingPrefixTracker& tracker,
-    const std::unique_ptr<RouteLogger<AddrT>>& logger,
-    const std::shared_ptr<Route<AddrT>>& newRoute) {
-  std::vector<std::string> matchedIdentifiers;
-  auto prefix = newRoute->prefix();
-  if (tracker.tracking(prefix, matchedIdentifiers)) {
-    logger->logAddedRoute(newRoute, matchedIdentifiers);
-  }
-}
-} // anonymous namespace
+namespace facebook {
+namespace fboss {
+
+using facebook::stats::SUM;
 
 RouteUpdateLogger::RouteUpdateLogger(SwSwitch* sw)
     : RouteUpdateLogger(
-          sw, getDefaultV4RouteLogger(), getDefaultV6RouteLogger()) {}
+          sw,
+          getDefaultV4RouteLogger(),
+          getDefaultV6RouteLogger(),
+          std::max(FLAGS_route_update_log_queue_size, 0)) {}
 
 RouteUpdateLogger::RouteUpdateLogger(
     SwSwitch* sw,
     std::unique_ptr<RouteLogger<folly::IPAddressV4>> routeLoggerV4,
-    std::unique_ptr<RouteLogger<folly::IPAddressV6>> routeLoggerV6)
+    std::unique_ptr<RouteLogger<folly::IPAddressV6>> routeLoggerV6,
+    size_t maxQueuedLogs)
     : AutoRegisterStateObserver(sw, "RouteUpdateLogger"),
       routeLoggerV4_(std::move(routeLoggerV4)),
-      routeLoggerV6_(std::move(routeLoggerV6)) {}
+      routeLoggerV6_(std::move(routeLoggerV6)),
+      maxQueuedLogs_(maxQueuedLogs) {
+  if (maxQueuedLogs_ > 0) {
+    logThread_ = std::make_unique<folly::ScopedEventBaseThread>(
+        "RouteUpdateLog");
+  }
+}
 
 void RouteUpdateLogger::stateUpdated(const StateDelta& delta) {
+  if (prefixTracker_.empty()) {
+    return;
+  }
   for (const auto& rtDelta : delta.getRouteTablesDelta()) {
-    DeltaFunctions::forEachChanged(
-        rtDelta.getRoutesV4Delta(),
-        &handleChangedRoute<folly::IPAddressV4>,
-        &handleAddedRoute<folly::IPAddressV4>,
-        &handleRemovedRoute<folly::IPAddressV4>,
-        prefixTracker_,
-        routeLoggerV4_);
-    DeltaFunctions::forEachChanged(
-        rtDelta.getRoutesV6Delta(),
-        &handleChangedRoute<folly::IPAddressV6>,
-        &handleAddedRoute<folly::IPAddressV6>,
-        &handleRemovedRoute<folly::IPAddressV6>,
-        prefixTracker_,
-        routeLoggerV6_);
+    logRoutesDelta(rtDelta.getRoutesV4Delta(), routeLoggerV4_.get());
+    logRoutesDelta(rtDelta.getRoutesV6Delta(), routeLoggerV6_.get());
+  }
+}
+
+template <typename AddrT>
+void RouteUpdateLogger::logRoutesDelta(
+    const NodeMapDelta<RouteTableRibNodeMap<AddrT>>& delta,
+    RouteLogger<AddrT>* logger) {
+  using RouteT = std::shared_ptr<Route<AddrT>>;
+  std::vector<std::string> ids;
+  DeltaFunctions::forEachChanged(
+      delta,
+      [&](const RouteT& oldRoute, const RouteT& newRoute) {
+        if (prefixTracker_.tracking(oldRoute->prefix(), ids)) {
+          log([logger, oldRoute, newRoute, ids]() {
+            logger->logChangedRoute(oldRoute, newRoute, ids);
+          });
+        }
+      },
+      [&](const RouteT& newRoute) {
+        if (prefixTracker_.tracking(newRoute->prefix(), ids)) {
+          log([logger, newRoute, ids]() {
+            logger->logAddedRoute(newRoute, ids);
+          });
+        }
+      },
+      [&](const RouteT& oldRoute) {
+        if (prefixTracker_.tracking(oldRoute->prefix(), ids)) {
+          log([logger, oldRoute, ids]() {
+            logger->logRemovedRoute(oldRoute, ids);
+          });
+        }
+      });
+}
+
+void RouteUpdateLogger::log(std::function<void()> fn) {
+  if (!logThread_) {
+    fn();
+    return;
+  }
+  if (queuedLogs_.fetch_add(1) >= maxQueuedLogs_) {
+    --queuedLogs_;
+    tcData().addStatValue("route_update_logger.dropped", 1, SUM);
+    return;
+  }
+  logThread_->getEventBase()->runInEventBaseThread(
+      [this, fn = std::move(fn)]() {
+        fn();
+        --queuedLogs_;
+      });
+}
+
+void RouteUpdateLogger::flush() {
+  if (logThread_) {
+    logThread_->getEventBase()->runInEventBaseThreadAndWait([]() {});
   }
 }
 
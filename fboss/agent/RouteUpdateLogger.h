@@ -10,13 +10,17 @@
 #pragma once
 
 #include <folly/IPAddress.h>
+#include <folly/io/async/ScopedEventBaseThread.h>
 #include <folly/logging/xlog.h>
 #include "fboss/agent/RouteUpdateLoggingPrefixTracker.h"
 #include "fboss/agent/StateObserver.h"
 #include "fboss/agent/state/Route.h"
+#include "fboss/agent/state/RouteDelta.h"
 #include "fboss/agent/state/RouteTypes.h"
 #include "fboss/agent/state/StateDelta.h"
 
+#include <atomic>
+#include <functional>
 #include <memory>
 #include <vector>
 
@@ -78,6 +82,11 @@ class GlogRouteLogger : public RouteLogger<AddrT> {
  * (or more specific location with that prefix) is added, removed, or
  * changes, log that information. The logger is pluggable, but by default
  * we use GLOG.
+ *
+ * Nothing is looked at when no prefix is tracked. With maxQueuedLogs set,
+ * matched routes are handed to the loggers on a separate thread so the
+ * update thread doesn't wait on logging; once maxQueuedLogs are waiting,
+ * further ones are dropped and counted in route_update_logger.dropped.
  */
 class RouteUpdateLogger : public AutoRegisterStateObserver {
  public:
@@ -85,7 +94,8 @@ class RouteUpdateLogger : public AutoRegisterStateObserver {
   RouteUpdateLogger(
       SwSwitch* sw,
       std::unique_ptr<RouteLogger<folly::IPAddressV4>> routeLoggerV4,
-      std::unique_ptr<RouteLogger<folly::IPAddressV6>> routeLoggerV6);
+      std::unique_ptr<RouteLogger<folly::IPAddressV6>> routeLoggerV6,
+      size_t maxQueuedLogs = 0);
 
   ~RouteUpdateLogger() override = default;
 
@@ -105,14 +115,27 @@ class RouteUpdateLogger : public AutoRegisterStateObserver {
     return routeLoggerV6_.get();
   }
 
+  // Wait for all queued logs to be handed to the loggers
+  void flush();
+
  private:
   static std::unique_ptr<RouteLogger<folly::IPAddressV4>>
     getDefaultV4RouteLogger();
   static std::unique_ptr<RouteLogger<folly::IPAddressV6>>
     getDefaultV6RouteLogger();
+  template <typename AddrT>
+  void logRoutesDelta(
+      const NodeMapDelta<RouteTableRibNodeMap<AddrT>>& delta,
+      RouteLogger<AddrT>* logger);
+  void log(std::function<void()> fn);
+
   RouteUpdateLoggingPrefixTracker prefixTracker_;
   std::unique_ptr<RouteLogger<folly::IPAddressV4>> routeLoggerV4_;
   std::unique_ptr<RouteLogger<folly::IPAddressV6>> routeLoggerV6_;
+  const size_t maxQueuedLogs_;
+  std::atomic<size_t> queuedLogs_{0};
+  // Destroyed first, so queued logs finish while the loggers still exist
+  std::unique_ptr<folly::ScopedEventBaseThread> logThread_;
 };
 
 }} // facebook::fboss
@@ -33,6 +33,8 @@ void RouteUpdateLoggingPrefixTracker::track(
     // Use the most recently set configuration
     if (!found.second) {
       found.first.value() = req;
+    } else {
+      ++numTracked_;
     }
   }
 }
@@ -47,7 +49,9 @@ void RouteUpdateLoggingPrefixTracker::stopTracking(
     if (itr == trackedPrefixes_.end()) {
       return;
     }
-    itr->second.erase(prefix.network, prefix.mask);
+    if (itr->second.erase(prefix.network, prefix.mask)) {
+      --numTracked_;
+    }
   }
 }
 
@@ -55,7 +59,14 @@ void RouteUpdateLoggingPrefixTracker::stopTracking(
 void RouteUpdateLoggingPrefixTracker::stopTracking(
     const std::string& identifier) {
   XLOG(INFO) << "Stop tracking all prefixes for " << identifier;
-  trackedPrefixes_->erase(identifier);
+  SYNCHRONIZED(trackedPrefixes_) {
+    auto itr = trackedPrefixes_.find(identifier);
+    if (itr == trackedPrefixes_.end()) {
+      return;
+    }
+    numTracked_ -= itr->second.size();
+    trackedPrefixes_.erase(itr);
+  }
 }
 
 bool RouteUpdateLoggingPrefixTracker::trackingImpl(
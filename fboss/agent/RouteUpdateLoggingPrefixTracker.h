@@ -13,6 +13,7 @@
 #include "fboss/agent/state/RouteTypes.h"
 #include <folly/Synchronized.h>
 
+#include <atomic>
 #include <memory>
 #include <vector>
 #include <unordered_map>
@@ -61,6 +62,11 @@ class RouteUpdateLoggingPrefixTracker {
   void stopTracking(const std::string& identifier);
   std::vector<RouteUpdateLoggingInstance> getTrackedPrefixes() const;
 
+  // Whether nothing is tracked at all; doesn't take the lock
+  bool empty() const {
+    return numTracked_.load(std::memory_order_acquire) == 0;
+  }
+
   /* Returns whether or not the prefix is tracked for logging.
    * Will also populate identifiers with all of the identifiers that
    * tracking for this prefix was turned on with.
@@ -82,6 +88,8 @@ class RouteUpdateLoggingPrefixTracker {
       std::string,
       network::RadixTree<folly::IPAddress, RouteUpdateLoggingInstance>>>
       trackedPrefixes_;
+  // Number of prefixes in trackedPrefixes_, over all identifiers
+  std::atomic<size_t> numTracked_{0};
 };
 
 }} // facebook::fboss
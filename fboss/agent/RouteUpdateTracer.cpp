@@ -0,0 +1,90 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/RouteUpdateTracer.h"
+
+#include "common/stats/ServiceData.h"
+
+#include <folly/Conv.h>
+
+#include <algorithm>
+
+namespace facebook {
+namespace fboss {
+
+RouteUpdateTracer::RouteUpdateTracer(uint32_t sampleRate, size_t maxTraces)
+    : sampleRate_(std::max<uint32_t>(sampleRate, 1)),
+      maxTraces_(std::max<size_t>(maxTraces, 1)) {}
+
+std::string RouteUpdateTracer::histogramName(
+    ClientID client,
+    folly::StringPiece what) {
+  return folly::to<std::string>(
+      "route_update.client.", static_cast<int>(client), ".", what);
+}
+
+void RouteUpdateTracer::record(
+    const Update& update,
+    std::chrono::system_clock::time_point now) {
+  bool sampled;
+  {
+    auto state = state_.wlock();
+    if (state->clients.insert(update.client).second) {
+      for (auto what : {"queue.us", "rib.us", "fib.us"}) {
+        auto name = histogramName(update.client, what);
+        fbData->addHistogram(name, 1000, 0, 1000000);
+        fbData->exportHistogramPercentile(name, 50, 99);
+      }
+      auto name = histogramName(update.client, "routes");
+      fbData->addHistogram(name, 100, 0, 10000);
+      fbData->exportHistogramPercentile(name, 50, 99);
+    }
+    sampled = state->numUpdates++ % sampleRate_ == 0;
+  }
+
+  fbData->addHistogramValue(
+      histogramName(update.client, "queue.us"), update.queue.count());
+  fbData->addHistogramValue(
+      histogramName(update.client, "rib.us"), update.rib.count());
+  fbData->addHistogramValue(
+      histogramName(update.client, "fib.us"), update.fib.count());
+  fbData->addHistogramValue(
+      histogramName(update.client, "routes"),
+      update.routesAdded + update.routesDeleted);
+
+  if (!sampled) {
+    return;
+  }
+  RouteUpdateTrace trace;
+  trace.timestampMsecs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                             now.time_since_epoch())
+                             .count();
+  trace.clientId = static_cast<int16_t>(update.client);
+  trace.updateType = update.updateType;
+  trace.routesAdded = update.routesAdded;
+  trace.routesDeleted = update.routesDeleted;
+  trace.queueUsecs = update.queue.count();
+  trace.ribUsecs = update.rib.count();
+  trace.fibUsecs = update.fib.count();
+
+  auto state = state_.wlock();
+  if (state->traces.size() >= maxTraces_) {
+    state->traces.pop_front();
+  }
+  state->traces.push_back(std::move(trace));
+}
+
+std::vector<RouteUpdateTrace> RouteUpdateTracer::getTraces() const {
+  auto state = state_.rlock();
+  return std::vector<RouteUpdateTrace>(
+      state->traces.begin(), state->traces.end());
+}
+
+} // namespace fboss
+} // namespace facebook
@@ -0,0 +1,77 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include "fboss/agent/if/gen-cpp2/ctrl_types.h"
+#include "fboss/agent/types.h"
+
+#include <folly/Range.h>
+#include <folly/Synchronized.h>
+
+#include <chrono>
+#include <deque>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace facebook {
+namespace fboss {
+
+/*
+ * Breaks route updates down by client.
+ *
+ * Every update feeds the route_update.client.<id>.{queue,rib,fib}.us
+ * histograms, with the time spent waiting to be processed, computing the new
+ * routes and programming them, and route_update.client.<id>.routes with the
+ * number of routes.  Every sampleRate-th update is also kept as a trace;
+ * only the most recent maxTraces traces are kept.
+ */
+class RouteUpdateTracer {
+ public:
+  struct Update {
+    ClientID client{0};
+    std::string updateType;
+    uint32_t routesAdded{0};
+    uint32_t routesDeleted{0};
+    std::chrono::microseconds queue{0};
+    std::chrono::microseconds rib{0};
+    std::chrono::microseconds fib{0};
+  };
+
+  RouteUpdateTracer(uint32_t sampleRate, size_t maxTraces);
+
+  void record(
+      const Update& update,
+      std::chrono::system_clock::time_point now =
+          std::chrono::system_clock::now());
+
+  // Sampled traces, oldest first
+  std::vector<RouteUpdateTrace> getTraces() const;
+
+  static std::string histogramName(ClientID client, folly::StringPiece what);
+
+ private:
+  struct State {
+    std::set<ClientID> clients;
+    std::deque<RouteUpdateTrace> traces;
+    uint64_t numUpdates{0};
+  };
+
+  // Forbidden copy constructor and assignment operator
+  RouteUpdateTracer(RouteUpdateTracer const&) = delete;
+  RouteUpdateTracer& operator=(RouteUpdateTracer const&) = delete;
+
+  const uint32_t sampleRate_;
+  const size_t maxTraces_;
+  folly::Synchronized<State> state_;
+};
+
+} // namespace fboss
+} // namespace facebook
@@ -0,0 +1,155 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/RxAdmissionControl.h"
+
+#include "fboss/agent/LacpTypes.h"
+#include "fboss/agent/LldpManager.h"
+#include "fboss/agent/packet/Ethertype.h"
+#include "fboss/agent/packet/IPProto.h"
+
+#include <gflags/gflags.h>
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+DEFINE_int32(
+    rx_admission_pps,
+    5000,
+    "Trapped Arp, IPv4, IPv6 or other packets handled per second from each "
+    "port for each of those kinds; 0 to not rate limit trapped packets");
+DEFINE_int32(
+    rx_admission_burst,
+    5000,
+    "Trapped packets of one kind that a port may send at once");
+DEFINE_int32(
+    rx_admission_control_pps,
+    20000,
+    "Trapped LACP, LLDP and BGP packets handled per second from each port");
+DEFINE_int32(
+    rx_admission_control_burst,
+    20000,
+    "Trapped LACP, LLDP and BGP packets that a port may send at once");
+
+using folly::IPAddress;
+using folly::io::Cursor;
+
+namespace {
+constexpr uint16_t kBgpPort = 179;
+}
+
+namespace facebook { namespace fboss {
+
+constexpr size_t RxAdmissionControl::kNumClasses;
+
+RxAdmissionControl::RxAdmissionControl(
+    std::function<bool(const IPAddress&)> isLocalAddress)
+    : isLocalAddress_(std::move(isLocalAddress)) {}
+
+RxAdmissionControl::Class RxAdmissionControl::classify(
+    uint16_t ethertype,
+    Cursor cursor) const {
+  switch (ethertype) {
+    case LldpManager::ETHERTYPE_LLDP:
+    case LACPDU::EtherType::SLOW_PROTOCOLS:
+      return Class::CONTROL;
+    case static_cast<uint16_t>(ETHERTYPE::ETHERTYPE_ARP):
+      return Class::ARP;
+    case static_cast<uint16_t>(ETHERTYPE::ETHERTYPE_IPV4):
+      try {
+        // Only the fields we need; the handler validates the rest
+        Cursor ip(cursor);
+        auto headerLen = (ip.read<uint8_t>() & 0x0f) * 4;
+        ip += 5;
+        auto fragment = ip.readBE<uint16_t>() & 0x1fff;
+        ip += 1;
+        auto protocol = ip.read<uint8_t>();
+        ip += 6;
+        auto dst = IPAddress::fromLongHBO(ip.readBE<uint32_t>());
+        if (fragment == 0 && headerLen >= 20) {
+          Cursor tcp(cursor);
+          tcp += headerLen;
+          if (isBgpToUs(protocol, dst, tcp)) {
+            return Class::CONTROL;
+          }
+        }
+      } catch (const std::out_of_range&) {
+      }
+      return Class::IPV4;
+    case static_cast<uint16_t>(ETHERTYPE::ETHERTYPE_IPV6):
+      try {
+        // BGP does not use extension headers, so only look past the
+        // fixed header
+        Cursor ip(cursor);
+        ip += 6;
+        auto nextHeader = ip.read<uint8_t>();
+        ip += 17;
+        std::array<uint8_t, 16> dstBytes;
+        ip.pull(dstBytes.data(), dstBytes.size());
+        auto dst = IPAddress::fromBinary(
+            folly::ByteRange(dstBytes.data(), dstBytes.size()));
+        if (isBgpToUs(nextHeader, dst, ip)) {
+          return Class::CONTROL;
+        }
+      } catch (const std::out_of_range&) {
+      }
+      return Class::IPV6;
+    default:
+      return Class::OTHER;
+  }
+}
+
+bool RxAdmissionControl::isBgpToUs(
+    uint8_t protocol,
+    const IPAddress& dst,
+    Cursor cursor) const {
+  if (protocol != static_cast<uint8_t>(IP_PROTO::IP_PROTO_TCP)) {
+    return false;
+  }
+  auto srcPort = cursor.readBE<uint16_t>();
+  auto dstPort = cursor.readBE<uint16_t>();
+  return (srcPort == kBgpPort || dstPort == kBgpPort) && isLocalAddress_(dst);
+}
+
+bool RxAdmissionControl::admit(PortID port, Class cls, double nowInSeconds) {
+  if (FLAGS_rx_admission_pps <= 0) {
+    return true;
+  }
+  auto index = static_cast<size_t>(cls);
+
+  {
+    auto ports = ports_.rlock();
+    auto it = ports->find(port);
+    if (it != ports->end()) {
+      return (*it->second)[index].consume(1, nowInSeconds);
+    }
+  }
+
+  auto ports = ports_.wlock();
+  auto& buckets = (*ports)[port];
+  if (!buckets) {
+    buckets = std::make_unique<PortBuckets>();
+    for (size_t i = 0; i < kNumClasses; ++i) {
+      auto control = static_cast<Class>(i) == Class::CONTROL;
+      double rate = std::max(
+          control ? FLAGS_rx_admission_control_pps : FLAGS_rx_admission_pps,
+          1);
+      double burst = std::max(
+          control ? FLAGS_rx_admission_control_burst
+                  : FLAGS_rx_admission_burst,
+          1);
+      // Zeroed long enough ago that the new bucket starts full
+      buckets->emplace_back(rate, burst, nowInSeconds - burst / rate);
+    }
+  }
+  return (*buckets)[index].consume(1, nowInSeconds);
+}
+
+}} // facebook::fboss
@@ -0,0 +1,90 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include "fboss/agent/types.h"
+
+#include <folly/IPAddress.h>
+#include <folly/SharedMutex.h>
+#include <folly/Synchronized.h>
+#include <folly/TokenBucket.h>
+#include <folly/io/Cursor.h>
+
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace facebook { namespace fboss {
+
+/*
+ * Token buckets that SwSwitch::handlePacket() checks right after parsing
+ * the Ethernet header, one per receiving port and class of packet, so a
+ * misbehaving neighbor can only use up its own port's share of the agent's
+ * rx capacity, and only for the kind of packet it is flooding.
+ *
+ * LACP, LLDP and BGP to one of our addresses are CONTROL packets, which
+ * have a bucket of their own per port with a higher rate. A flood of Arp or
+ * IP packets on a port therefore never holds up its protocol sessions.
+ *
+ * The rates and bursts come from the rx_admission_* flags when a port's
+ * buckets are first used.
+ */
+class RxAdmissionControl {
+ public:
+  enum class Class : uint8_t {
+    CONTROL,
+    ARP,
+    IPV4,
+    IPV6,
+    OTHER,
+  };
+  static constexpr size_t kNumClasses = 5;
+
+  explicit RxAdmissionControl(
+      std::function<bool(const folly::IPAddress&)> isLocalAddress);
+
+  /*
+   * The class of a packet with ethertype, given a cursor just past the
+   * ethertype.
+   */
+  Class classify(uint16_t ethertype, folly::io::Cursor cursor) const;
+
+  /*
+   * Whether a packet of cls received on port may be handled now. If so, this
+   * takes a token from the port's bucket for cls.
+   */
+  bool admit(
+      PortID port,
+      Class cls,
+      double nowInSeconds = folly::TokenBucket::defaultClockNow());
+
+ private:
+  using PortBuckets = std::vector<folly::TokenBucket>;
+
+  // Forbidden copy constructor and assignment operator
+  RxAdmissionControl(RxAdmissionControl const &) = delete;
+  RxAdmissionControl& operator=(RxAdmissionControl const &) = delete;
+
+  bool isBgpToUs(
+      uint8_t protocol,
+      const folly::IPAddress& dst,
+      folly::io::Cursor cursor) const;
+
+  std::function<bool(const folly::IPAddress&)> isLocalAddress_;
+  // Buckets are only added, so lookups share the lock and consume() from
+  // several rx threads at once, which TokenBucket allows
+  folly::Synchronized<
+      std::unordered_map<PortID, std::unique_ptr<PortBuckets>>,
+      folly::SharedMutex>
+      ports_;
+};
+
+}} // facebook::fboss
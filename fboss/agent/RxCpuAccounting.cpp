@@ -0,0 +1,195 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/RxCpuAccounting.h"
+
+#include <folly/Conv.h>
+#include <folly/String.h>
+#include <folly/logging/xlog.h>
+
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+using std::chrono::steady_clock;
+
+namespace facebook { namespace fboss {
+
+constexpr size_t RxCpuAccounting::kNumHandlers;
+constexpr size_t RxCpuAccounting::kMaxCpuQueues;
+constexpr size_t RxCpuAccounting::kWindowSeconds;
+
+const char* RxCpuAccounting::handlerName(Handler handler) {
+  switch (handler) {
+    case Handler::ARP:
+      return "arp";
+    case Handler::LLDP:
+      return "lldp";
+    case Handler::IPV4:
+      return "ipv4";
+    case Handler::IPV6:
+      return "ipv6";
+    case Handler::LACP:
+      return "lacp";
+    case Handler::OTHER:
+      break;
+  }
+  return "other";
+}
+
+RxCpuAccounting::RxCpuAccounting() {}
+
+int64_t RxCpuAccounting::toSecond(steady_clock::time_point now) {
+  return std::chrono::duration_cast<std::chrono::seconds>(
+             now.time_since_epoch())
+      .count();
+}
+
+void RxCpuAccounting::record(
+    Handler handler,
+    int cosQueue,
+    std::chrono::nanoseconds cpuTime,
+    steady_clock::time_point now) {
+  auto second = toSecond(now);
+  auto& slot = slots_[second % kWindowSeconds];
+  auto slotSecond = slot.second.load(std::memory_order_acquire);
+  if (slotSecond != second &&
+      slot.second.compare_exchange_strong(slotSecond, second)) {
+    // First packet of a new second on this slot. Packets other threads add
+    // while we reset are lost, which is fine for this purpose.
+    for (auto& counter : slot.handlers) {
+      counter.packets.store(0, std::memory_order_relaxed);
+      counter.nanos.store(0, std::memory_order_relaxed);
+      counter.dtlbMisses.store(0, std::memory_order_relaxed);
+    }
+    for (auto& counter : slot.cpuQueues) {
+      counter.packets.store(0, std::memory_order_relaxed);
+      counter.nanos.store(0, std::memory_order_relaxed);
+      counter.dtlbMisses.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  auto nanos = static_cast<uint64_t>(std::max<int64_t>(cpuTime.count(), 0));
+  auto& byHandler = slot.handlers[static_cast<size_t>(handler)];
+  byHandler.packets.fetch_add(1, std::memory_order_relaxed);
+  byHandler.nanos.fetch_add(nanos, std::memory_order_relaxed);
+  if (cosQueue >= 0) {
+    auto queue = std::min<size_t>(cosQueue, kMaxCpuQueues - 1);
+    auto& byQueue = slot.cpuQueues[queue];
+    byQueue.packets.fetch_add(1, std::memory_order_relaxed);
+    byQueue.nanos.fetch_add(nanos, std::memory_order_relaxed);
+  }
+}
+
+void RxCpuAccounting::recordDtlbMisses(
+    Handler handler,
+    int cosQueue,
+    uint64_t misses,
+    steady_clock::time_point now) {
+  auto second = toSecond(now);
+  auto& slot = slots_[second % kWindowSeconds];
+  if (slot.second.load(std::memory_order_acquire) != second) {
+    // The second turned over since record(), let it go
+    return;
+  }
+  slot.handlers[static_cast<size_t>(handler)].dtlbMisses.fetch_add(
+      misses, std::memory_order_relaxed);
+  if (cosQueue >= 0) {
+    auto queue = std::min<size_t>(cosQueue, kMaxCpuQueues - 1);
+    slot.cpuQueues[queue].dtlbMisses.fetch_add(
+        misses, std::memory_order_relaxed);
+  }
+}
+
+bool RxCpuAccounting::readThreadDtlbMisses(uint64_t* misses) {
+  struct PerfCounter {
+    PerfCounter() {
+      struct perf_event_attr attr = {};
+      attr.size = sizeof(attr);
+      attr.type = PERF_TYPE_HW_CACHE;
+      attr.config = PERF_COUNT_HW_CACHE_DTLB |
+          (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+          (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+      // User space only, which unprivileged processes may count
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      fd = syscall(
+          SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC);
+      if (fd < 0) {
+        XLOG(WARN) << "Unable to count data TLB misses on this thread: "
+                   << folly::errnoStr(errno);
+      }
+    }
+    ~PerfCounter() {
+      if (fd >= 0) {
+        close(fd);
+      }
+    }
+    int fd{-1};
+  };
+  static thread_local PerfCounter counter;
+  return counter.fd >= 0 &&
+      read(counter.fd, misses, sizeof(*misses)) == sizeof(*misses);
+}
+
+std::vector<RxCpuAccounting::Usage> RxCpuAccounting::top(
+    std::chrono::seconds window,
+    size_t count,
+    steady_clock::time_point now) const {
+  std::array<Usage, kNumHandlers> handlers;
+  std::array<Usage, kMaxCpuQueues> cpuQueues;
+  auto add = [](const Counter& counter, Usage* usage) {
+    usage->packets += counter.packets.load(std::memory_order_relaxed);
+    usage->cpuTime += std::chrono::nanoseconds(
+        counter.nanos.load(std::memory_order_relaxed));
+    usage->dtlbMisses += counter.dtlbMisses.load(std::memory_order_relaxed);
+  };
+
+  auto second = toSecond(now);
+  auto seconds = std::min<int64_t>(
+      std::max<int64_t>(window.count(), 1), kWindowSeconds);
+  for (const auto& slot : slots_) {
+    auto slotSecond = slot.second.load(std::memory_order_acquire);
+    if (slotSecond > second || slotSecond <= second - seconds) {
+      continue;
+    }
+    for (size_t i = 0; i < kNumHandlers; ++i) {
+      add(slot.handlers[i], &handlers[i]);
+    }
+    for (size_t i = 0; i < kMaxCpuQueues; ++i) {
+      add(slot.cpuQueues[i], &cpuQueues[i]);
+    }
+  }
+
+  std::vector<Usage> usages;
+  for (size_t i = 0; i < kNumHandlers; ++i) {
+    if (handlers[i].packets) {
+      handlers[i].name = folly::to<std::string>(
+          "handler.", handlerName(static_cast<Handler>(i)));
+      usages.push_back(std::move(handlers[i]));
+    }
+  }
+  for (size_t i = 0; i < kMaxCpuQueues; ++i) {
+    if (cpuQueues[i].packets) {
+      cpuQueues[i].name = folly::to<std::string>("cpu_queue.", i);
+      usages.push_back(std::move(cpuQueues[i]));
+    }
+  }
+  std::sort(usages.begin(), usages.end(), [](const Usage& a, const Usage& b) {
+    return a.cpuTime > b.cpuTime;
+  });
+  if (usages.size() > count) {
+    usages.resize(count);
+  }
+  return usages;
+}
+
+}} // facebook::fboss
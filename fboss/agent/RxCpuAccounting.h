@@ -0,0 +1,117 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace facebook { namespace fboss {
+
+/*
+ * CPU time SwSwitch::handlePacket() spends on trapped packets, by the
+ * handler the packet went to and by the CPU queue it was trapped to, over
+ * the last kWindowSeconds. Packets are recorded from every RX thread, so
+ * each one costs a few relaxed atomic adds; reading the totals walks the
+ * window.
+ *
+ * The per thread histograms of the same times are in SwitchStats.
+ */
+class RxCpuAccounting {
+ public:
+  enum class Handler : uint8_t {
+    ARP,
+    LLDP,
+    IPV4,
+    IPV6,
+    LACP,
+    // Bogus and unhandled packets
+    OTHER,
+  };
+  static constexpr size_t kNumHandlers = 6;
+  // Packets on higher CPU queues are recorded on the last one
+  static constexpr size_t kMaxCpuQueues = 48;
+  static constexpr size_t kWindowSeconds = 60;
+
+  static const char* handlerName(Handler handler);
+
+  struct Usage {
+    // "handler.<name>" or "cpu_queue.<queue>"
+    std::string name;
+    uint64_t packets{0};
+    std::chrono::nanoseconds cpuTime{0};
+    // Only counted with --rx_tlb_counters
+    uint64_t dtlbMisses{0};
+  };
+
+  RxCpuAccounting();
+
+  void record(
+      Handler handler,
+      int cosQueue,
+      std::chrono::nanoseconds cpuTime,
+      std::chrono::steady_clock::time_point now =
+          std::chrono::steady_clock::now());
+
+  /*
+   * Data TLB misses handling a packet took, recorded after the packet's
+   * record().
+   */
+  void recordDtlbMisses(
+      Handler handler,
+      int cosQueue,
+      uint64_t misses,
+      std::chrono::steady_clock::time_point now =
+          std::chrono::steady_clock::now());
+
+  /*
+   * The calling thread's data TLB load misses so far, from a perf counter
+   * opened on the thread's first call. False if the counter can't be
+   * opened, as on a virtual machine or with perf events restricted.
+   */
+  static bool readThreadDtlbMisses(uint64_t* misses);
+
+  /*
+   * The handlers and CPU queues that used the most CPU time in the last
+   * window seconds, most first. At most count are returned; ones that saw
+   * no packets are left out.
+   */
+  std::vector<Usage> top(
+      std::chrono::seconds window,
+      size_t count,
+      std::chrono::steady_clock::time_point now =
+          std::chrono::steady_clock::now()) const;
+
+ private:
+  struct Counter {
+    std::atomic<uint64_t> packets{0};
+    std::atomic<uint64_t> nanos{0};
+    std::atomic<uint64_t> dtlbMisses{0};
+  };
+  // One second of the window
+  struct Slot {
+    std::atomic<int64_t> second{-1};
+    std::array<Counter, kNumHandlers> handlers;
+    std::array<Counter, kMaxCpuQueues> cpuQueues;
+  };
+
+  // Forbidden copy constructor and assignment operator
+  RxCpuAccounting(RxCpuAccounting const &) = delete;
+  RxCpuAccounting& operator=(RxCpuAccounting const &) = delete;
+
+  static int64_t toSecond(std::chrono::steady_clock::time_point now);
+
+  std::array<Slot, kWindowSeconds> slots_;
+};
+
+}} // facebook::fboss
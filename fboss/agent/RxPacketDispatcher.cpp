@@ -0,0 +1,128 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/RxPacketDispatcher.h"
+
+#include "fboss/agent/LacpTypes.h"
+#include "fboss/agent/LldpManager.h"
+#include "fboss/agent/PortStats.h"
+#include "fboss/agent/RxPacket.h"
+#include "fboss/agent/SwSwitch.h"
+#include "fboss/agent/SwitchStats.h"
+#include "fboss/agent/Utils.h"
+
+#include <folly/Conv.h>
+#include <folly/hash/Hash.h>
+#include <folly/io/Cursor.h>
+#include <folly/logging/xlog.h>
+
+using folly::io::Cursor;
+
+namespace facebook { namespace fboss {
+
+namespace {
+constexpr uint16_t kEthertypeVlan = 0x8100;
+// dst mac, src mac, and a possible 802.1Q tag ahead of the ethertype
+constexpr size_t kMinPeekLength = 12 + 4 + 2;
+}
+
+constexpr size_t RxPacketDispatcher::kControlQueue;
+
+RxPacketDispatcher::RxPacketDispatcher(
+    SwSwitch* sw,
+    Handler handler,
+    size_t numDataQueues,
+    size_t queueDepth)
+    : sw_(sw), handler_(std::move(handler)) {
+  CHECK_GT(numDataQueues, 0);
+  CHECK_GT(queueDepth, 0);
+  for (size_t i = 0; i < numDataQueues + 1; ++i) {
+    queues_.push_back(std::make_unique<Queue>(queueDepth));
+  }
+}
+
+RxPacketDispatcher::~RxPacketDispatcher() {
+  stop();
+}
+
+void RxPacketDispatcher::start() {
+  if (running_.exchange(true)) {
+    return;
+  }
+  for (size_t i = 0; i < queues_.size(); ++i) {
+    queues_[i]->thread =
+        std::make_unique<std::thread>([this, i] { workerLoop(i); });
+  }
+}
+
+void RxPacketDispatcher::stop() {
+  if (!running_.exchange(false)) {
+    return;
+  }
+  // A null packet tells a worker to exit. Use a blocking write so the
+  // sentinel gets in even if the queue is full.
+  for (auto& queue : queues_) {
+    queue->packets.blockingWrite(nullptr);
+  }
+  for (auto& queue : queues_) {
+    queue->thread->join();
+    queue->thread.reset();
+  }
+}
+
+void RxPacketDispatcher::dispatch(std::unique_ptr<RxPacket> pkt) {
+  auto queue = queueFor(pkt.get(), queues_.size() - 1);
+  auto port = pkt->getSrcPort();
+  auto& packets = queues_[queue]->packets;
+  if (!running_.load() || !packets.write(std::move(pkt))) {
+    sw_->portStats(port)->pktRxQueueDrop(queue);
+    return;
+  }
+  sw_->stats()->rxQueueDepth(queue, std::max<ssize_t>(packets.size(), 0));
+}
+
+size_t RxPacketDispatcher::queueFor(
+    const RxPacket* pkt,
+    size_t numDataQueues) {
+  uint16_t ethertype{0};
+  if (pkt->getLength() >= kMinPeekLength) {
+    Cursor c(pkt->buf());
+    c += 12;
+    ethertype = c.readBE<uint16_t>();
+    if (ethertype == kEthertypeVlan) {
+      c += 2;
+      ethertype = c.readBE<uint16_t>();
+    }
+  }
+  if (ethertype == LldpManager::ETHERTYPE_LLDP ||
+      ethertype == LACPDU::EtherType::SLOW_PROTOCOLS) {
+    return kControlQueue;
+  }
+  auto hash = folly::hash::hash_combine(
+      ethertype, static_cast<uint16_t>(pkt->getSrcPort()));
+  return 1 + hash % numDataQueues;
+}
+
+void RxPacketDispatcher::workerLoop(size_t queue) {
+  initThread(
+      queue == kControlQueue ? std::string("fbossRxControlThread")
+                             : folly::to<std::string>("fbossRxThread", queue));
+  auto& packets = queues_[queue]->packets;
+  while (true) {
+    std::unique_ptr<RxPacket> pkt;
+    packets.blockingRead(pkt);
+    if (!pkt) {
+      break;
+    }
+    handler_(std::move(pkt));
+  }
+  XLOG(DBG2) << "rx queue " << queue << " worker exiting";
+}
+
+}} // facebook::fboss
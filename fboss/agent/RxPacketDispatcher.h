@@ -0,0 +1,89 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include <folly/Function.h>
+#include <folly/MPMCQueue.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace facebook { namespace fboss {
+
+class RxPacket;
+class SwSwitch;
+
+/*
+ * RxPacketDispatcher moves trapped packet handling off the HwSwitch RX
+ * thread. Packets are sorted into bounded queues, each drained by its own
+ * worker thread:
+ *
+ *  - queue 0 (CONTROL) carries LACP and LLDP frames only, so protocol
+ *    timers never wait behind a flood of Arp, Ndp or IP packets.
+ *  - the remaining data queues carry everything else, hashed by ethertype
+ *    and source port, which keeps packets of one protocol from one port in
+ *    order while spreading load over the workers.
+ *
+ * A packet that finds its queue full is dropped and counted against both
+ * the queue and the receiving port.
+ */
+class RxPacketDispatcher {
+ public:
+  using Handler = folly::Function<void(std::unique_ptr<RxPacket>)>;
+
+  static constexpr size_t kControlQueue = 0;
+
+  RxPacketDispatcher(
+      SwSwitch* sw,
+      Handler handler,
+      size_t numDataQueues,
+      size_t queueDepth);
+  ~RxPacketDispatcher();
+
+  void start();
+  // Workers hand off whatever is already queued and then exit
+  void stop();
+
+  /*
+   * Queue pkt for one of the workers. Safe to call from any thread.
+   */
+  void dispatch(std::unique_ptr<RxPacket> pkt);
+
+  size_t numQueues() const {
+    return queues_.size();
+  }
+
+  /*
+   * The queue a packet belongs on, given numDataQueues data queues.
+   */
+  static size_t queueFor(const RxPacket* pkt, size_t numDataQueues);
+
+ private:
+  // Forbidden copy constructor and assignment operator
+  RxPacketDispatcher(RxPacketDispatcher const&) = delete;
+  RxPacketDispatcher& operator=(RxPacketDispatcher const&) = delete;
+
+  struct Queue {
+    explicit Queue(size_t depth) : packets(depth) {}
+    folly::MPMCQueue<std::unique_ptr<RxPacket>> packets;
+    std::unique_ptr<std::thread> thread;
+  };
+
+  void workerLoop(size_t queue);
+
+  SwSwitch* sw_;
+  Handler handler_;
+  std::vector<std::unique_ptr<Queue>> queues_;
+  std::atomic<bool> running_{false};
+};
+
+}} // facebook::fboss
@@ -9,7 +9,14 @@
  */
 #include "fboss/agent/SetupThrift.h"
 
+#include "common/stats/ThreadCachedServiceData.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include <folly/Conv.h>
 #include <folly/io/async/EventBase.h>
+#include <thrift/lib/cpp/concurrency/ThreadManager.h>
 #include <thrift/lib/cpp2/server/ThriftServer.h>
 #include <gflags/gflags.h>
 
@@ -17,3 +24,65 @@ DEFINE_int32(thrift_idle_timeout, 60, "Thrift idle timeout in seconds.");
 // Programming 16K routes can take 20+ seconds
 DEFINE_int32(thrift_task_expire_timeout, 30,
     "Thrift task expire timeout in seconds.");
+DEFINE_int32(thrift_high_pri_threads, 4,
+    "Thrift workers for route programming and health checks");
+DEFINE_int32(thrift_normal_pri_threads, 8,
+    "Thrift workers for calls without a priority class");
+DEFINE_int32(thrift_best_effort_threads, 2,
+    "Thrift workers for large getters, such as state and route table dumps");
+DEFINE_int32(thrift_max_queue_len, 0,
+    "Requests each thrift priority class queues before rejecting more; "
+    "0 for no limit");
+
+using apache::thrift::concurrency::PriorityThreadManager;
+using apache::thrift::concurrency::ThreadManager;
+using facebook::stats::AVG;
+
+namespace facebook {
+namespace fboss {
+
+namespace {
+
+/*
+ * Exports how long requests waited for a worker, per thread pool. The pools
+ * of the priority thread manager are named <prefix>-pri<priority>.
+ */
+class QueueTimeObserver : public ThreadManager::Observer {
+ public:
+  void preRun(folly::RequestContext* /*ctx*/) override {}
+  void postRun(
+      folly::RequestContext* /*ctx*/,
+      const ThreadManager::RunStats& stats) override {
+    auto queued = std::chrono::duration_cast<std::chrono::microseconds>(
+        stats.workBegin - stats.queueBegin);
+    tcData().addStatValue(
+        folly::to<std::string>(
+            "thrift.", stats.threadPoolName, ".queue_time_us"),
+        queued.count(),
+        AVG);
+  }
+};
+
+} // namespace
+
+void setupThriftThreadManager(apache::thrift::ThriftServer& server) {
+  auto threads = [](int32_t count) {
+    return static_cast<size_t>(std::max(count, 1));
+  };
+  // Indexed by PRIORITY; HIGH_IMPORTANT and IMPORTANT are not used
+  auto threadManager = PriorityThreadManager::newPriorityThreadManager(
+      {{1,
+        threads(FLAGS_thrift_high_pri_threads),
+        1,
+        threads(FLAGS_thrift_normal_pri_threads),
+        threads(FLAGS_thrift_best_effort_threads)}},
+      true /* enableTaskStats */,
+      std::max(FLAGS_thrift_max_queue_len, 0));
+  threadManager->setNamePrefix("ThriftCPU");
+  threadManager->start();
+  ThreadManager::setObserver(std::make_shared<QueueTimeObserver>());
+  server.setThreadManager(threadManager);
+}
+
+} // namespace fboss
+} // namespace facebook
@@ -24,6 +24,13 @@ namespace fboss {
 
 void serverSSLSetup(apache::thrift::ThriftServer& server);
 
+/*
+ * Gives each request priority class its own workers and queue, so large
+ * getters can't starve route programming or health checks. Which methods
+ * get which priority is up to ThriftHandler::getRequestPriority().
+ */
+void setupThriftThreadManager(apache::thrift::ThriftServer& server);
+
 template<typename THRIFT_HANDLER>
 std::unique_ptr<apache::thrift::ThriftServer> setupThriftServer(
     folly::EventBase& eventBase,
@@ -35,6 +42,7 @@ std::unique_ptr<apache::thrift::ThriftServer> setupThriftServer(
         FLAGS_thrift_task_expire_timeout * 1000));
   server->getEventBaseManager()->setEventBase(&eventBase, false);
   server->setInterface(handler);
+  setupThriftThreadManager(*server);
   if (isDuplex) {
     server->setDuplex(true);
   }
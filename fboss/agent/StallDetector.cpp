@@ -0,0 +1,283 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/StallDetector.h"
+
+#include <folly/Synchronized.h>
+#include <folly/logging/xlog.h>
+#include <folly/system/ThreadName.h>
+#include <gflags/gflags.h>
+
+#include <execinfo.h>
+#include <pthread.h>
+#include <signal.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+DEFINE_int32(
+    stall_threshold_ms,
+    1000,
+    "Capture the stack of an update or rx thread whose current work has been "
+    "running for longer than this; 0 turns stall detection off");
+
+using namespace std::chrono;
+
+namespace {
+constexpr size_t kMaxStalls = 32;
+constexpr int kMaxFrames = 64;
+constexpr auto kCaptureTimeout = milliseconds(100);
+
+using facebook::fboss::ThreadStall;
+
+struct ThreadState {
+  pthread_t thread;
+  std::string name;
+
+  // Only used by the thread itself
+  int depth{0};
+
+  // Bumped by each outermost Work, so that each is reported once
+  std::atomic<uint64_t> generation{0};
+  // steady_clock nanoseconds the current work started at, 0 when idle
+  std::atomic<int64_t> busySince{0};
+  // Written by the thread itself, read by the checker under the lock
+  std::mutex sourceLock;
+  std::string source;
+
+  // Only used by the checker, under the registry lock
+  uint64_t reportedGeneration{0};
+
+  // Filled in by the signal handler on the thread itself
+  std::atomic<bool> captureRequested{false};
+  std::atomic<bool> captured{false};
+  void* frames[kMaxFrames];
+  int numFrames{0};
+};
+
+struct Registry {
+  std::mutex lock;
+  std::vector<ThreadState*> threads;
+};
+
+Registry& registry() {
+  // Leaked, so that threads exiting late at shutdown can still unregister
+  static auto* threads = new Registry();
+  return *threads;
+}
+
+folly::Synchronized<std::deque<ThreadStall>>& stalls() {
+  static auto* recent = new folly::Synchronized<std::deque<ThreadStall>>();
+  return *recent;
+}
+
+// For the signal handler, which must not touch anything that is lazily
+// constructed
+thread_local ThreadState* currentThread{nullptr};
+
+int stallSignal() {
+  return SIGRTMIN + 1;
+}
+
+void captureStack(int /*signal*/) {
+  auto savedErrno = errno;
+  auto* state = currentThread;
+  if (state && state->captureRequested.exchange(false)) {
+    state->numFrames = backtrace(state->frames, kMaxFrames);
+    state->captured.store(true);
+  }
+  errno = savedErrno;
+}
+
+int64_t steadyNow() {
+  return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch())
+      .count();
+}
+
+std::vector<std::string> waitForStack(ThreadState* state) {
+  std::vector<std::string> stack;
+  state->captured.store(false);
+  state->captureRequested.store(true);
+  if (pthread_kill(state->thread, stallSignal()) != 0) {
+    state->captureRequested.store(false);
+    return stack;
+  }
+  auto deadline = steady_clock::now() + kCaptureTimeout;
+  while (!state->captured.load()) {
+    if (steady_clock::now() >= deadline) {
+      // Blocked with the signal masked; give up on this one
+      state->captureRequested.store(false);
+      return stack;
+    }
+    std::this_thread::sleep_for(milliseconds(1));
+  }
+
+  // Leave out the frame of the signal handler itself
+  auto symbols = backtrace_symbols(state->frames, state->numFrames);
+  if (symbols) {
+    for (int i = 1; i < state->numFrames; ++i) {
+      stack.emplace_back(symbols[i]);
+    }
+    free(symbols);
+  }
+  return stack;
+}
+
+void checkThreads(milliseconds threshold) {
+  std::vector<ThreadStall> found;
+  {
+    std::lock_guard<std::mutex> g(registry().lock);
+    for (auto* state : registry().threads) {
+      auto busySince = state->busySince.load();
+      if (!busySince) {
+        continue;
+      }
+      auto generation = state->generation.load();
+      if (generation == state->reportedGeneration) {
+        continue;
+      }
+      auto stalled = nanoseconds(steadyNow() - busySince);
+      if (stalled < threshold) {
+        continue;
+      }
+
+      ThreadStall stall;
+      {
+        std::lock_guard<std::mutex> sourceGuard(state->sourceLock);
+        stall.source = state->source;
+      }
+      if (state->generation.load() != generation) {
+        // The work finished while we looked at it
+        continue;
+      }
+      state->reportedGeneration = generation;
+      stall.threadName = state->name;
+      stall.timestampMsecs =
+          duration_cast<milliseconds>(system_clock::now().time_since_epoch())
+              .count();
+      stall.stalledMsecs = duration_cast<milliseconds>(stalled).count();
+      stall.stack = waitForStack(state);
+      found.push_back(std::move(stall));
+    }
+  }
+
+  for (auto& stall : found) {
+    XLOG(WARNING) << stall.threadName << " stalled for " << stall.stalledMsecs
+                  << "ms in " << stall.source << ", captured "
+                  << stall.stack.size() << " frames";
+    auto recent = stalls().wlock();
+    if (recent->size() >= kMaxStalls) {
+      recent->pop_front();
+    }
+    recent->push_back(std::move(stall));
+  }
+}
+
+void checkLoop() {
+  folly::setThreadName("StallDetector");
+  while (true) {
+    auto threshold = FLAGS_stall_threshold_ms;
+    if (threshold <= 0) {
+      std::this_thread::sleep_for(milliseconds(100));
+      continue;
+    }
+    std::this_thread::sleep_for(milliseconds(std::max(threshold / 4, 5)));
+    checkThreads(milliseconds(threshold));
+  }
+}
+
+void startChecker() {
+  static std::once_flag started;
+  std::call_once(started, [] {
+    // backtrace() loads libgcc on its first call, which is not safe to do
+    // from a signal handler
+    void* frame;
+    backtrace(&frame, 1);
+
+    struct sigaction action = {};
+    action.sa_handler = captureStack;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    sigaction(stallSignal(), &action, nullptr);
+
+    std::thread(checkLoop).detach();
+  });
+}
+
+class ThreadRegistration {
+ public:
+  ThreadRegistration() : state_(std::make_unique<ThreadState>()) {
+    state_->thread = pthread_self();
+    state_->name = folly::getCurrentThreadName().value_or("unnamed");
+    startChecker();
+    std::lock_guard<std::mutex> g(registry().lock);
+    registry().threads.push_back(state_.get());
+    currentThread = state_.get();
+  }
+
+  ~ThreadRegistration() {
+    std::lock_guard<std::mutex> g(registry().lock);
+    auto& threads = registry().threads;
+    threads.erase(std::remove(threads.begin(), threads.end(), state_.get()));
+    currentThread = nullptr;
+  }
+
+  ThreadState* get() const {
+    return state_.get();
+  }
+
+ private:
+  std::unique_ptr<ThreadState> state_;
+};
+
+ThreadState* thisThread() {
+  static thread_local ThreadRegistration registration;
+  return registration.get();
+}
+} // namespace
+
+namespace facebook {
+namespace fboss {
+
+StallDetector::Work::Work(folly::StringPiece source) {
+  auto* state = thisThread();
+  if (state->depth++ > 0) {
+    return;
+  }
+  // Most work on the rx threads has the same name, so skip the lock then
+  if (source != folly::StringPiece(state->source)) {
+    std::lock_guard<std::mutex> g(state->sourceLock);
+    state->source.assign(source.data(), source.size());
+  }
+  state->generation.fetch_add(1);
+  state->busySince.store(steadyNow());
+}
+
+StallDetector::Work::~Work() {
+  auto* state = thisThread();
+  if (--state->depth > 0) {
+    return;
+  }
+  state->busySince.store(0);
+}
+
+std::vector<ThreadStall> StallDetector::getStalls() {
+  auto recent = stalls().rlock();
+  return std::vector<ThreadStall>(recent->begin(), recent->end());
+}
+
+} // namespace fboss
+} // namespace facebook
@@ -0,0 +1,52 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include "fboss/agent/if/gen-cpp2/ctrl_types.h"
+
+#include <folly/Range.h>
+
+#include <vector>
+
+namespace facebook {
+namespace fboss {
+
+/*
+ * Watches the threads that run StallDetector::Work. When one piece of work
+ * has been running for longer than --stall_threshold_ms, the stack of the
+ * thread is captured while it is still stuck, by signalling it, and
+ * remembered with the name of the work for getStalls().
+ *
+ * Unlike the slow loops ThreadHeartbeat records once a loop has ended, this
+ * tells where a thread is spending its time, not just that it did.
+ */
+class StallDetector {
+ public:
+  /*
+   * Marks the calling thread busy with source until destroyed. Work nested
+   * in other work on the same thread is charged to the outer work.
+   */
+  class Work {
+   public:
+    explicit Work(folly::StringPiece source);
+    ~Work();
+
+   private:
+    // Forbidden copy constructor and assignment operator
+    Work(Work const&) = delete;
+    Work& operator=(Work const&) = delete;
+  };
+
+  // The recent stalls of all threads, oldest first
+  static std::vector<ThreadStall> getStalls();
+};
+
+} // namespace fboss
+} // namespace facebook
@@ -24,8 +24,20 @@ class StateObserver : public boost::noncopyable {
 
 class AutoRegisterStateObserver : public StateObserver {
  public:
-  AutoRegisterStateObserver(SwSwitch* sw, const std::string& name) : sw_(sw) {
-    sw_->registerStateObserver(this, name);
+  /*
+   * If evb is set the observer is registered in async mode, and is notified
+   * on evb instead of the update thread.
+   */
+  AutoRegisterStateObserver(
+      SwSwitch* sw,
+      const std::string& name,
+      folly::EventBase* evb = nullptr)
+      : sw_(sw) {
+    if (evb) {
+      sw_->registerAsyncStateObserver(this, name, evb);
+    } else {
+      sw_->registerStateObserver(this, name);
+    }
   }
   ~AutoRegisterStateObserver() override { sw_->unregisterStateObserver(this); }
 
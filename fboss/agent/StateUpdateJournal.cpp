@@ -0,0 +1,431 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/StateUpdateJournal.h"
+
+#include "fboss/agent/FbossError.h"
+#include "fboss/agent/state/AclMap.h"
+#include "fboss/agent/state/ControlPlane.h"
+#include "fboss/agent/state/Interface.h"
+#include "fboss/agent/state/InterfaceMap.h"
+#include "fboss/agent/state/LabelForwardingInformationBase.h"
+#include "fboss/agent/state/LoadBalancerMap.h"
+#include "fboss/agent/state/MirrorMap.h"
+#include "fboss/agent/state/Port.h"
+#include "fboss/agent/state/PortMap.h"
+#include "fboss/agent/state/QosPolicyMap.h"
+#include "fboss/agent/state/RouteTable.h"
+#include "fboss/agent/state/RouteTableMap.h"
+#include "fboss/agent/state/SflowCollectorMap.h"
+#include "fboss/agent/state/StateDelta.h"
+#include "fboss/agent/state/SwitchState.h"
+#include "fboss/agent/state/Vlan.h"
+#include "fboss/agent/state/VlanMap.h"
+
+#include <folly/ScopeGuard.h>
+#include <folly/json.h>
+
+#include <cerrno>
+#include <cstring>
+
+namespace {
+
+constexpr auto kState = "state";
+constexpr auto kNames = "names";
+constexpr auto kApplyUs = "applyUs";
+constexpr auto kSummary = "summary";
+constexpr auto kDelta = "delta";
+
+// Compact delta fields
+constexpr auto kPorts = "ports";
+constexpr auto kVlans = "vlans";
+constexpr auto kInterfaces = "interfaces";
+constexpr auto kRouteTables = "routeTables";
+constexpr auto kSet = "set";
+constexpr auto kRemoved = "removed";
+constexpr auto kRouterId = "routerId";
+constexpr auto kV4 = "v4";
+constexpr auto kV6 = "v6";
+constexpr auto kAcls = "acls";
+constexpr auto kSflowCollectors = "sflowCollectors";
+constexpr auto kQosPolicies = "qosPolicies";
+constexpr auto kControlPlane = "controlPlane";
+constexpr auto kLoadBalancers = "loadBalancers";
+constexpr auto kMirrors = "mirrors";
+constexpr auto kLabelFib = "labelFib";
+constexpr auto kDefaultVlan = "defaultVlan";
+
+// Summary fields
+constexpr auto kRoutesAdded = "routesAdded";
+constexpr auto kRoutesChanged = "routesChanged";
+constexpr auto kRoutesRemoved = "routesRemoved";
+constexpr auto kOther = "other";
+
+using facebook::fboss::SwitchState;
+
+// Changed nodes of a map with integer keys, as {"set": [...], "removed": [...]}
+template <typename DeltaT>
+folly::dynamic serializeNodes(const DeltaT& delta) {
+  folly::dynamic set = folly::dynamic::array;
+  folly::dynamic removed = folly::dynamic::array;
+  for (const auto& nodeDelta : delta) {
+    if (nodeDelta.getNew()) {
+      set.push_back(nodeDelta.getNew()->toFollyDynamic());
+    } else {
+      removed.push_back(static_cast<int64_t>(nodeDelta.getOld()->getID()));
+    }
+  }
+  if (set.empty() && removed.empty()) {
+    return nullptr;
+  }
+  return folly::dynamic::object(kSet, std::move(set))(
+      kRemoved, std::move(removed));
+}
+
+template <typename MapT>
+std::shared_ptr<MapT> applyNodes(
+    const std::shared_ptr<MapT>& map,
+    const folly::dynamic& json) {
+  auto newMap = map->clone();
+  for (const auto& key : json[kRemoved]) {
+    newMap->removeNode(typename MapT::KeyType(key.asInt()));
+  }
+  for (const auto& nodeJson : json[kSet]) {
+    auto node = MapT::Node::fromFollyDynamic(nodeJson);
+    if (newMap->getNodeIf(node->getID())) {
+      newMap->updateNode(node);
+    } else {
+      newMap->addNode(node);
+    }
+  }
+  return newMap;
+}
+
+template <typename RoutesDeltaT>
+folly::dynamic serializeRoutes(
+    const RoutesDeltaT& delta,
+    folly::dynamic* summary) {
+  folly::dynamic set = folly::dynamic::array;
+  folly::dynamic removed = folly::dynamic::array;
+  for (const auto& routeDelta : delta) {
+    const auto& oldRoute = routeDelta.getOld();
+    const auto& newRoute = routeDelta.getNew();
+    if (newRoute) {
+      set.push_back(newRoute->toFollyDynamic());
+      auto counter = oldRoute ? kRoutesChanged : kRoutesAdded;
+      (*summary)[counter] = (*summary)[counter].asInt() + 1;
+    } else {
+      removed.push_back(oldRoute->prefix().toFollyDynamic());
+      (*summary)[kRoutesRemoved] = (*summary)[kRoutesRemoved].asInt() + 1;
+    }
+  }
+  return folly::dynamic::object(kSet, std::move(set))(
+      kRemoved, std::move(removed));
+}
+
+template <typename AddrT>
+void applyRoutes(
+    facebook::fboss::RouterID id,
+    std::shared_ptr<SwitchState>* state,
+    const folly::dynamic& json) {
+  using RouteT = facebook::fboss::Route<AddrT>;
+  using PrefixT = facebook::fboss::RoutePrefix<AddrT>;
+  if (json[kSet].empty() && json[kRemoved].empty()) {
+    return;
+  }
+  auto rib = (*state)->getRouteTables()->getRouteTable(id)->template getRib<
+      AddrT>()->modify(id, state);
+  for (const auto& prefixJson : json[kRemoved]) {
+    auto prefix = PrefixT::fromFollyDynamic(prefixJson);
+    auto route = rib->exactMatch(prefix);
+    if (!route) {
+      throw facebook::fboss::FbossError(
+          "journal removes missing route ", prefix.str());
+    }
+    rib->removeRoute(route);
+    rib->removeRouteInRadixTree(route);
+  }
+  for (const auto& routeJson : json[kSet]) {
+    auto route = RouteT::fromFollyDynamic(routeJson);
+    if (rib->exactMatch(route->prefix())) {
+      rib->updateRoute(route);
+      rib->updateRouteInRadixTree(route);
+    } else {
+      rib->addRoute(route);
+      rib->addRouteInRadixTree(route);
+    }
+  }
+}
+
+template <typename NodeT>
+void serializeIfChanged(
+    const std::shared_ptr<NodeT>& oldNode,
+    const std::shared_ptr<NodeT>& newNode,
+    const char* name,
+    folly::dynamic* delta) {
+  if (oldNode != newNode) {
+    (*delta)[name] = newNode->toFollyDynamic();
+  }
+}
+
+std::FILE* openFile(const std::string& path, const char* mode) {
+  auto file = std::fopen(path.c_str(), mode);
+  if (!file) {
+    throw facebook::fboss::FbossError(
+        "unable to open journal ", path, ": ", std::strerror(errno));
+  }
+  return file;
+}
+
+} // namespace
+
+namespace facebook { namespace fboss {
+
+StateUpdateJournal::StateUpdateJournal(const std::string& path)
+    : file_(openFile(path, "w")) {}
+
+StateUpdateJournal::~StateUpdateJournal() {
+  std::fclose(file_);
+}
+
+void StateUpdateJournal::append(
+    const std::vector<std::string>& names,
+    const StateDelta& delta,
+    std::chrono::microseconds applyTime) {
+  if (!last_) {
+    last_ = delta.oldState();
+    writeLine(folly::dynamic::object(kState, last_->toFollyDynamic()));
+  }
+  // Journalled against the last journalled state, which differs from
+  // delta.oldState() when the hardware could not take all of the last batch
+  StateDelta journalled(last_, delta.newState());
+  folly::dynamic namesJson = folly::dynamic::array;
+  for (const auto& name : names) {
+    namesJson.push_back(name);
+  }
+  folly::dynamic summary;
+  auto deltaJson = serializeDelta(journalled, &summary);
+  writeLine(folly::dynamic::object(kNames, std::move(namesJson))(
+      kApplyUs, applyTime.count())(kSummary, std::move(summary))(
+      kDelta, std::move(deltaJson)));
+  last_ = delta.newState();
+}
+
+void StateUpdateJournal::writeLine(const folly::dynamic& json) {
+  auto line = folly::toJson(json);
+  line.push_back('\n');
+  if (std::fwrite(line.data(), 1, line.size(), file_) != line.size() ||
+      std::fflush(file_) != 0) {
+    throw FbossError("failed to write state update journal");
+  }
+}
+
+folly::dynamic StateUpdateJournal::serializeDelta(
+    const StateDelta& delta,
+    folly::dynamic* summary) {
+  const auto& oldState = delta.oldState();
+  const auto& newState = delta.newState();
+  folly::dynamic json = folly::dynamic::object;
+  folly::dynamic counts = folly::dynamic::object(kRoutesAdded, 0)(
+      kRoutesChanged, 0)(kRoutesRemoved, 0);
+
+  auto ports = serializeNodes(delta.getPortsDelta());
+  if (!ports.isNull()) {
+    json[kPorts] = std::move(ports);
+  }
+  auto vlans = serializeNodes(delta.getVlansDelta());
+  if (!vlans.isNull()) {
+    json[kVlans] = std::move(vlans);
+  }
+  auto intfs = serializeNodes(delta.getIntfsDelta());
+  if (!intfs.isNull()) {
+    json[kInterfaces] = std::move(intfs);
+  }
+
+  folly::dynamic tables = folly::dynamic::array;
+  for (const auto& tableDelta : delta.getRouteTablesDelta()) {
+    auto id = tableDelta.getNew() ? tableDelta.getNew()->getID()
+                                  : tableDelta.getOld()->getID();
+    folly::dynamic table =
+        folly::dynamic::object(kRouterId, static_cast<int64_t>(id));
+    if (!tableDelta.getNew()) {
+      table[kRemoved] = true;
+    } else {
+      table[kV4] = serializeRoutes(tableDelta.getRoutesV4Delta(), &counts);
+      table[kV6] = serializeRoutes(tableDelta.getRoutesV6Delta(), &counts);
+    }
+    tables.push_back(std::move(table));
+  }
+  if (!tables.empty()) {
+    json[kRouteTables] = std::move(tables);
+  }
+
+  serializeIfChanged(oldState->getAcls(), newState->getAcls(), kAcls, &json);
+  serializeIfChanged(
+      oldState->getSflowCollectors(),
+      newState->getSflowCollectors(),
+      kSflowCollectors,
+      &json);
+  serializeIfChanged(
+      oldState->getQosPolicies(),
+      newState->getQosPolicies(),
+      kQosPolicies,
+      &json);
+  serializeIfChanged(
+      oldState->getControlPlane(),
+      newState->getControlPlane(),
+      kControlPlane,
+      &json);
+  serializeIfChanged(
+      oldState->getLoadBalancers(),
+      newState->getLoadBalancers(),
+      kLoadBalancers,
+      &json);
+  serializeIfChanged(
+      oldState->getMirrors(), newState->getMirrors(), kMirrors, &json);
+  serializeIfChanged(
+      oldState->getLabelForwardingInformationBase(),
+      newState->getLabelForwardingInformationBase(),
+      kLabelFib,
+      &json);
+  if (oldState->getDefaultVlan() != newState->getDefaultVlan()) {
+    json[kDefaultVlan] = static_cast<int64_t>(newState->getDefaultVlan());
+  }
+
+  if (summary) {
+    folly::dynamic other = folly::dynamic::array;
+    for (const auto& field : json.items()) {
+      auto name = field.first.asString();
+      if (name == kPorts || name == kVlans || name == kInterfaces) {
+        counts[name] =
+            field.second[kSet].size() + field.second[kRemoved].size();
+      } else if (name != kRouteTables) {
+        other.push_back(name);
+      }
+    }
+    counts[kOther] = std::move(other);
+    *summary = std::move(counts);
+  }
+  return json;
+}
+
+std::shared_ptr<SwitchState> StateUpdateJournal::applyDelta(
+    const std::shared_ptr<SwitchState>& state,
+    const folly::dynamic& delta) {
+  auto newState = state->clone();
+  if (delta.count(kPorts)) {
+    newState->resetPorts(applyNodes(newState->getPorts(), delta[kPorts]));
+  }
+  if (delta.count(kVlans)) {
+    newState->resetVlans(applyNodes(newState->getVlans(), delta[kVlans]));
+  }
+  if (delta.count(kInterfaces)) {
+    newState->resetIntfs(
+        applyNodes(newState->getInterfaces(), delta[kInterfaces]));
+  }
+  if (delta.count(kRouteTables)) {
+    for (const auto& table : delta[kRouteTables]) {
+      RouterID id(table[kRouterId].asInt());
+      auto existing = newState->getRouteTables()->getRouteTableIf(id);
+      if (table.count(kRemoved)) {
+        if (existing) {
+          newState->getRouteTables()->modify(&newState)->removeRouteTable(
+              existing);
+        }
+        continue;
+      }
+      if (!existing) {
+        newState->getRouteTables()->modify(&newState)->addRouteTable(
+            std::make_shared<RouteTable>(id));
+      }
+      applyRoutes<folly::IPAddressV4>(id, &newState, table[kV4]);
+      applyRoutes<folly::IPAddressV6>(id, &newState, table[kV6]);
+    }
+  }
+  if (delta.count(kAcls)) {
+    newState->resetAcls(AclMap::fromFollyDynamic(delta[kAcls]));
+  }
+  if (delta.count(kSflowCollectors)) {
+    newState->resetSflowCollectors(
+        SflowCollectorMap::fromFollyDynamic(delta[kSflowCollectors]));
+  }
+  if (delta.count(kQosPolicies)) {
+    newState->resetQosPolicies(
+        QosPolicyMap::fromFollyDynamic(delta[kQosPolicies]));
+  }
+  if (delta.count(kControlPlane)) {
+    newState->resetControlPlane(
+        ControlPlane::fromFollyDynamic(delta[kControlPlane]));
+  }
+  if (delta.count(kLoadBalancers)) {
+    newState->resetLoadBalancers(
+        LoadBalancerMap::fromFollyDynamic(delta[kLoadBalancers]));
+  }
+  if (delta.count(kMirrors)) {
+    newState->resetMirrors(MirrorMap::fromFollyDynamic(delta[kMirrors]));
+  }
+  if (delta.count(kLabelFib)) {
+    newState->resetLabelForwardingInformationBase(
+        LabelForwardingInformationBase::fromFollyDynamic(delta[kLabelFib]));
+  }
+  if (delta.count(kDefaultVlan)) {
+    newState->setDefaultVlan(VlanID(delta[kDefaultVlan].asInt()));
+  }
+  return newState;
+}
+
+StateUpdateJournalReader::StateUpdateJournalReader(const std::string& path)
+    : file_(openFile(path, "r")) {
+  SCOPE_FAIL {
+    std::fclose(file_);
+  };
+  folly::dynamic json;
+  if (!readLine(&json) || !json.count(kState)) {
+    throw FbossError("no initial state in journal ", path);
+  }
+  initialState_ = SwitchState::fromFollyDynamic(json[kState]);
+  initialState_->publish();
+  last_ = initialState_;
+}
+
+StateUpdateJournalReader::~StateUpdateJournalReader() {
+  std::fclose(file_);
+}
+
+bool StateUpdateJournalReader::next(Update* update) {
+  folly::dynamic json;
+  if (!readLine(&json)) {
+    return false;
+  }
+  update->names.clear();
+  for (const auto& name : json[kNames]) {
+    update->names.push_back(name.asString());
+  }
+  update->applyTime = std::chrono::microseconds(json[kApplyUs].asInt());
+  update->summary = json[kSummary];
+  update->state = StateUpdateJournal::applyDelta(last_, json[kDelta]);
+  update->state->publish();
+  last_ = update->state;
+  return true;
+}
+
+bool StateUpdateJournalReader::readLine(folly::dynamic* json) {
+  std::string line;
+  int c;
+  while ((c = std::fgetc(file_)) != EOF && c != '\n') {
+    line.push_back(static_cast<char>(c));
+  }
+  if (line.empty()) {
+    return false;
+  }
+  *json = folly::parseJson(line);
+  return true;
+}
+
+}} // facebook::fboss
@@ -0,0 +1,116 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include <folly/dynamic.h>
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace facebook { namespace fboss {
+
+class StateDelta;
+class SwitchState;
+
+/*
+ * A journal of the state updates SwSwitch applies, so that an update sequence
+ * seen in production can be replayed against a sim switch to reproduce, and
+ * bisect, its update latencies.
+ *
+ * The journal is a file of JSON lines. The first holds the state the journal
+ * starts from. Each one after it is a batch of updates handlePendingUpdates()
+ * applied together:
+ *
+ *   {"names": [...], "applyUs": <time the hardware took>,
+ *    "summary": {...}, "delta": {...}}
+ *
+ * The delta is compact: for ports, VLANs, interfaces and routes it holds the
+ * nodes that were added or changed and the keys of the removed ones; the
+ * other parts of the state are only written, in full, when they change.
+ * States are serialized as for warm boot, so what warm boot does not keep
+ * (aggregate ports, for one) is not journalled either.
+ */
+class StateUpdateJournal {
+ public:
+  explicit StateUpdateJournal(const std::string& path);
+  ~StateUpdateJournal();
+
+  /*
+   * Record a batch of updates taking the state from delta.oldState() to
+   * delta.newState(). The first call also records delta.oldState() as the
+   * initial state.
+   */
+  void append(
+      const std::vector<std::string>& names,
+      const StateDelta& delta,
+      std::chrono::microseconds applyTime);
+
+  /*
+   * The compact delta, and the state it takes `state` to. summary, if not
+   * null, gets the counts of what changed that are journalled with it.
+   */
+  static folly::dynamic serializeDelta(
+      const StateDelta& delta,
+      folly::dynamic* summary = nullptr);
+  static std::shared_ptr<SwitchState> applyDelta(
+      const std::shared_ptr<SwitchState>& state,
+      const folly::dynamic& delta);
+
+ private:
+  // Forbidden copy constructor and assignment operator
+  StateUpdateJournal(StateUpdateJournal const &) = delete;
+  StateUpdateJournal& operator=(StateUpdateJournal const &) = delete;
+
+  void writeLine(const folly::dynamic& json);
+
+  std::FILE* file_{nullptr};
+  // The new state of the last batch journalled, which the next batch's delta
+  // is taken from so the journal replays as one chain of states
+  std::shared_ptr<SwitchState> last_;
+};
+
+class StateUpdateJournalReader {
+ public:
+  struct Update {
+    std::vector<std::string> names;
+    std::chrono::microseconds applyTime{0};
+    folly::dynamic summary;
+    // Published, with the generation of the state it was journalled after
+    std::shared_ptr<SwitchState> state;
+  };
+
+  // Reads the initial state; throws FbossError for an invalid journal
+  explicit StateUpdateJournalReader(const std::string& path);
+  ~StateUpdateJournalReader();
+
+  const std::shared_ptr<SwitchState>& getInitialState() const {
+    return initialState_;
+  }
+
+  // Read the next batch, false at the end of the journal
+  bool next(Update* update);
+
+ private:
+  // Forbidden copy constructor and assignment operator
+  StateUpdateJournalReader(StateUpdateJournalReader const &) = delete;
+  StateUpdateJournalReader& operator=(StateUpdateJournalReader const &) =
+      delete;
+
+  bool readLine(folly::dynamic* json);
+
+  std::FILE* file_{nullptr};
+  std::shared_ptr<SwitchState> initialState_;
+  std::shared_ptr<SwitchState> last_;
+};
+
+}} // facebook::fboss
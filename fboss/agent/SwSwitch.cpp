@@ -18,20 +18,28 @@
 #include <folly/GLog.h>
 #include <folly/MacAddress.h>
 #include <folly/MapUtil.h>
+#include <folly/ScopeGuard.h>
 #include <folly/SocketAddress.h>
 #include <folly/String.h>
+#include <folly/experimental/bser/Bser.h>
 #include <folly/logging/xlog.h>
 #include <folly/system/ThreadName.h>
 #include <glog/logging.h>
+#include <boost/container/flat_set.hpp>
+#include <algorithm>
 #include <chrono>
 #include <condition_variable>
 #include <exception>
 #include <tuple>
+#include <unistd.h>
 #include "common/stats/ServiceData.h"
 #include "fboss/agent/AgentConfig.h"
 #include "fboss/agent/AlpmUtils.h"
 #include "fboss/agent/ApplyThriftConfig.h"
 #include "fboss/agent/ArpHandler.h"
+#include "fboss/agent/BfdManager.h"
+#include "fboss/agent/BootTrace.h"
+#include "fboss/agent/CompiledConfigCache.h"
 #include "fboss/agent/Constants.h"
 #include "fboss/agent/FbossError.h"
 #include "fboss/agent/HwSwitch.h"
@@ -39,28 +47,43 @@
 #include "fboss/agent/IPv6Handler.h"
 #include "fboss/agent/LacpTypes.h"
 #include "fboss/agent/LinkAggregationManager.h"
+#include "fboss/agent/MicroBfdManager.h"
 #include "fboss/agent/LldpManager.h"
 #include "fboss/agent/MirrorManager.h"
+#include "fboss/agent/NeighborHitScanner.h"
 #include "fboss/agent/NeighborUpdater.h"
+#include "fboss/agent/PendingPacketQueue.h"
 #include "fboss/agent/Platform.h"
+#include "fboss/agent/PortInfoCache.h"
 #include "fboss/agent/PortStats.h"
 #include "fboss/agent/PortUpdateHandler.h"
 #include "fboss/agent/RestartTimeTracker.h"
+#include "fboss/agent/RxAdmissionControl.h"
+#include "fboss/agent/RouteLookupCache.h"
 #include "fboss/agent/RouteUpdateLogger.h"
+#include "fboss/agent/RxCpuAccounting.h"
 #include "fboss/agent/RxPacket.h"
+#include "fboss/agent/RxPacketDispatcher.h"
+#include "fboss/agent/StallDetector.h"
+#include "fboss/agent/StateUpdateJournal.h"
 #include "fboss/agent/SwitchStats.h"
+#include "fboss/agent/ThreadPlacement.h"
 #include "fboss/agent/ThriftHandler.h"
 #include "fboss/agent/TunManager.h"
 #include "fboss/agent/TxPacket.h"
 #include "fboss/agent/Utils.h"
+#include "fboss/agent/capture/PcapShmRing.h"
 #include "fboss/agent/capture/PktCaptureManager.h"
 #include "fboss/agent/gen-cpp2/switch_config_types_custom_protocol.h"
 #include "fboss/agent/packet/EthHdr.h"
 #include "fboss/agent/packet/IPv4Hdr.h"
 #include "fboss/agent/packet/IPv6Hdr.h"
 #include "fboss/agent/packet/PktUtil.h"
+#include "fboss/agent/rib/ForwardingInformationBaseUpdater.h"
 #include "fboss/agent/state/AggregatePort.h"
+#include "fboss/agent/state/InterfaceMap.h"
 #include "fboss/agent/state/StateDelta.h"
+#include "fboss/agent/state/StateMemoryUsage.h"
 #include "fboss/agent/state/StateUpdateHelpers.h"
 #include "fboss/agent/state/SwitchState.h"
 #include "fboss/pcap_distribution_service/if/gen-cpp2/PcapPushSubscriber.h"
@@ -89,10 +112,77 @@ using namespace apache::thrift::async;
 
 
 DEFINE_int32(thread_heartbeat_ms, 1000, "Thread heartbeat interval (ms)");
+DEFINE_int32(
+    neighbor_cache_threads,
+    1,
+    "Number of threads processing Arp/Ndp caches, vlans are spread over them");
+DEFINE_int32(
+    neighbor_update_batch_ms,
+    0,
+    "How long Arp/Ndp changes on a vlan are collected before being written "
+    "to the SwitchState in one update, 0 to write them right away");
+DEFINE_int32(
+    neighbor_update_batch_size,
+    1000,
+    "Maximum number of Arp/Ndp changes written in one SwitchState update");
+DEFINE_int32(
+    neighbor_hit_scan_interval_s,
+    10,
+    "How often the hit bits of all Arp/Ndp entries are read in one pass, 0 "
+    "to read them one entry at a time when an entry goes stale");
+DEFINE_int32(
+    rx_dispatch_queues,
+    0,
+    "Number of queues, each with its own thread, that trapped packets are "
+    "spread over besides the LACP/LLDP queue. 0 handles packets on the "
+    "HwSwitch RX thread");
+DEFINE_int32(
+    rx_dispatch_queue_depth,
+    1024,
+    "Number of trapped packets each rx queue holds before dropping");
 DEFINE_int32(
     distribution_timeout_ms,
     1000,
     "Timeout for sending to distribution_service (ms)");
+DEFINE_string(
+    pcap_shm_ring,
+    "/fboss_pcap_ring",
+    "Shared memory ring to publish packets to distribution_service through, "
+    "if it created one; empty to always publish over thrift");
+DEFINE_int32(
+    rib_stale_route_timeout_s,
+    300,
+    "How long routes restored from the RIB snapshot on warm boot are kept "
+    "for a client that has not synced its routes yet");
+DEFINE_int32(
+    rib_route_coalescing_ms,
+    0,
+    "How long the standalone RIB holds back the change of a prefix that was "
+    "published to the FIB less than this long ago, folding further changes "
+    "into it, so flapping prefixes are not programmed on every flap; 0 to "
+    "publish every change right away");
+DEFINE_int32(
+    state_memory_stats_interval_s,
+    300,
+    "How often the memory used by each part of the SwitchState is exported "
+    "as counters, 0 to never walk the state for it");
+DEFINE_bool(
+    rx_tlb_counters,
+    false,
+    "Count the data TLB misses each rx handler takes with a per thread "
+    "perf counter, to see what huge pages buy on the packet path");
+DEFINE_string(
+    state_update_journal,
+    "",
+    "File to journal every state update applied to, for replaying the "
+    "sequence against a sim switch; empty for no journal");
+DEFINE_bool(
+    pipeline_state_updates,
+    false,
+    "Program the hardware on its own thread, so that the next batch of "
+    "state updates is computed while the current one is being programmed");
+
+DECLARE_string(config_cache_dir);
 
 namespace {
 
@@ -118,6 +208,40 @@ folly::MacAddress getMulticastMacAddr(folly::IPAddressV4 addr) {
       bytes.begin(), bytes.end()));
 }
 
+constexpr auto kRibSnapshotFile = "rib_snapshot";
+
+void staleRouteFibUpdate(
+    facebook::fboss::RouterID vrf,
+    const facebook::fboss::rib::IPv4NetworkToRouteMap& v4NetworkToRoute,
+    const facebook::fboss::rib::IPv6NetworkToRouteMap& v6NetworkToRoute,
+    const facebook::fboss::rib::ChangedPrefixes* changedPrefixes,
+    void* cookie) {
+  facebook::fboss::rib::ForwardingInformationBaseUpdater fibUpdater(
+      vrf, v4NetworkToRoute, v6NetworkToRoute, changedPrefixes);
+
+  auto sw = static_cast<facebook::fboss::SwSwitch*>(cookie);
+  sw->updateStateBlocking(
+      "sweep stale routes",
+      std::move(fibUpdater),
+      facebook::fboss::StateUpdate::Priority::ROUTE);
+}
+
+void coalescedRouteFibUpdate(
+    facebook::fboss::RouterID vrf,
+    const facebook::fboss::rib::IPv4NetworkToRouteMap& v4NetworkToRoute,
+    const facebook::fboss::rib::IPv6NetworkToRouteMap& v6NetworkToRoute,
+    const facebook::fboss::rib::ChangedPrefixes* changedPrefixes,
+    void* cookie) {
+  facebook::fboss::rib::ForwardingInformationBaseUpdater fibUpdater(
+      vrf, v4NetworkToRoute, v6NetworkToRoute, changedPrefixes);
+
+  auto sw = static_cast<facebook::fboss::SwSwitch*>(cookie);
+  sw->updateStateBlocking(
+      "publish coalesced routes",
+      std::move(fibUpdater),
+      facebook::fboss::StateUpdate::Priority::ROUTE);
+}
+
 facebook::fboss::PortStatus fillInPortStatus(
     const facebook::fboss::Port& port,
     const facebook::fboss::SwSwitch* sw) {
@@ -136,6 +260,17 @@ facebook::fboss::PortStatus fillInPortStatus(
   }
   return status;
 }
+
+/*
+ * The packet ring takes one contiguous buffer; returns null if buf already
+ * is one.
+ */
+std::unique_ptr<folly::IOBuf> coalescedCopy(const folly::IOBuf* buf) {
+  if (!buf->isChained()) {
+    return nullptr;
+  }
+  return buf->cloneCoalesced();
+}
 } // anonymous namespace
 
 namespace facebook { namespace fboss {
@@ -161,11 +296,18 @@ SwSwitch::SwSwitch(std::unique_ptr<Platform> platform)
       ipv4_(new IPv4Handler(this)),
       ipv6_(new IPv6Handler(this)),
       nUpdater_(new NeighborUpdater(this)),
+      pendingPackets_(new PendingPacketQueue(this)),
+      rxAdmission_(new RxAdmissionControl([this](const folly::IPAddress& ip) {
+        return getState()->getInterfaces()->getInterfaceIf(RouterID(0), ip) !=
+            nullptr;
+      })),
+      rxCpuAccounting_(new RxCpuAccounting()),
       pcapMgr_(new PktCaptureManager(this)),
       mirrorManager_(new MirrorManager(this)),
       routeUpdateLogger_(new RouteUpdateLogger(this)),
       rib_(new rib::RoutingInformationBase()),
-      portUpdateHandler_(new PortUpdateHandler(this)) {
+      portUpdateHandler_(new PortUpdateHandler(this)),
+      portInfoCache_(new PortInfoCache(this)) {
   // Create the platform-specific state directories if they
   // don't exist already.
   utilCreateDir(platform_->getVolatileStateDir());
@@ -173,10 +315,16 @@ SwSwitch::SwSwitch(std::unique_ptr<Platform> platform)
 
   // doesnt need to be guarded, only accessed by 1 event base
   pcapPusher_ = nullptr;
+
+  auto numNeighborCacheThreads = std::max(1, FLAGS_neighbor_cache_threads);
+  for (int i = 0; i < numNeighborCacheThreads; ++i) {
+    neighborCacheEventBases_.push_back(std::make_unique<folly::EventBase>());
+  }
 }
 
 void SwSwitch::destroyPushClient(){
   distributionServiceReady_.store(false);
+  std::atomic_store(&pcapRing_, std::shared_ptr<PcapShmRing>());
 }
 
 void SwSwitch::constructPushClient(uint16_t port) {
@@ -189,6 +337,16 @@ void SwSwitch::constructPushClient(uint16_t port) {
     chan->setCloseCallback(closer_.get());
     pcapPusher_ =
         std::make_unique<PcapPushSubscriberAsyncClient>(std::move(chan));
+    std::shared_ptr<PcapShmRing> ring;
+    if (!FLAGS_pcap_shm_ring.empty()) {
+      try {
+        ring = PcapShmRing::open(FLAGS_pcap_shm_ring);
+      } catch (const std::exception& ex) {
+        XLOG(INFO) << "Publishing packets to distribution service over "
+                   << "thrift: " << ex.what();
+      }
+    }
+    std::atomic_store(&pcapRing_, std::move(ring));
     distributionServiceReady_.store(true);
   };
   pcapDistributionEventBase_.runInEventBaseThread(creation);
@@ -213,6 +371,9 @@ void SwSwitch::stop() {
   // After this we should no longer receive packets or link state changed events
   // while we are destroying ourselves
   hw_->unregisterCallbacks();
+  if (rxDispatcher_) {
+    rxDispatcher_->stop();
+  }
 
   // Stop tunMgr so we don't get any packets to process
   // in software that were sent to the switch ip or were
@@ -229,12 +390,20 @@ void SwSwitch::stop() {
   // this is not the case for ipv6_ and tunMgr_, which may be accessed in a
   // packet handling callback as well while stopping the switch.
   //
+  // BFD holds neighbor entries down through the NeighborUpdater
+  bfdManager_.reset();
   nUpdater_.reset();
 
   if (lldpManager_) {
     lldpManager_->stop();
   }
 
+  if (neighborHitScanner_) {
+    neighborHitScanner_->stop();
+  }
+
+  // Stop the sessions before the LinkAggregationManager they report to
+  microBfdManager_.reset();
   if (lagManager_) {
     lagManager_.reset();
   }
@@ -251,7 +420,8 @@ void SwSwitch::stop() {
   updThreadHeartbeat_.reset();
   packetTxThreadHeartbeat_.reset();
   lacpThreadHeartbeat_.reset();
-  neighborCacheThreadHeartbeat_.reset();
+  qsfpCacheThreadHeartbeat_.reset();
+  neighborCacheThreadHeartbeats_.clear();
   rib_.reset();
 
   // stops the background and update threads.
@@ -300,6 +470,7 @@ void SwSwitch::onSwitchRunStateChange(SwitchRunState newState) {
     restart_time::mark(RestartEvent::CONFIGURED);
   } else if (newState == SwitchRunState::FIB_SYNCED) {
     restart_time::mark(RestartEvent::FIB_SYNCED);
+    boot_trace::dump(platform_->getBootTraceFile());
   }
   getHw()->switchRunStateChanged(newState);
 }
@@ -331,8 +502,22 @@ void SwSwitch::gracefulExit() {
     // file. Right now we just serialize applied state and
     // then rely on a route/FIB sync on warm boot to recover
     // desired state.
-    switchState[kSwSwitch] = getAppliedState()->toFollyDynamic();
+    {
+      std::lock_guard<std::mutex> guard(warmBootCheckpointLock_);
+      auto appliedState = getAppliedState();
+      if (warmBootCheckpoint_.state.lock() == appliedState) {
+        XLOG(INFO) << "[Exit] Using switch state checkpointed at generation "
+                   << appliedState->getGeneration();
+        switchState[kSwSwitch] = std::move(warmBootCheckpoint_.switchState);
+        warmBootCheckpoint_ = WarmBootCheckpoint();
+      } else {
+        switchState[kSwSwitch] = appliedState->toFollyDynamic();
+      }
+    }
     updateAclsForWarmboot(switchState);
+    if (isStandaloneRibEnabled()) {
+      saveRibSnapshot();
+    }
 
     steady_clock::time_point switchStateToFollyDone = steady_clock::now();
     XLOG(INFO) << "[Exit] Switch state to folly dynamic "
@@ -347,12 +532,83 @@ void SwSwitch::gracefulExit() {
   }
 }
 
+void SwSwitch::saveRibSnapshot() {
+  auto snapshotFile = platform_->getWarmBootDir() + "/" + kRibSnapshotFile;
+  try {
+    auto snapshot = folly::bser::toBser(
+        rib_->toFollyDynamic(), folly::bser::serialization_opts());
+    if (!folly::writeFile(snapshot, snapshotFile.c_str())) {
+      XLOG(ERR) << "[Exit] Unable to write RIB snapshot to " << snapshotFile;
+    }
+  } catch (const std::exception& ex) {
+    XLOG(ERR) << "[Exit] Unable to save RIB snapshot: "
+              << folly::exceptionStr(ex);
+  }
+}
+
+void SwSwitch::restoreRibSnapshot() {
+  auto snapshotFile = platform_->getWarmBootDir() + "/" + kRibSnapshotFile;
+  std::string snapshot;
+  if (!folly::readFile(snapshotFile.c_str(), snapshot)) {
+    XLOG(INFO) << "No RIB snapshot at " << snapshotFile
+               << ", waiting for clients to sync their routes";
+    return;
+  }
+  // Only ever good for the boot right after it was written
+  ::unlink(snapshotFile.c_str());
+
+  try {
+    rib_->restore(folly::bser::parseBser(snapshot));
+  } catch (const std::exception& ex) {
+    XLOG(ERR) << "Ignoring RIB snapshot " << snapshotFile << ": "
+              << folly::exceptionStr(ex);
+    return;
+  }
+
+  auto timeout = std::chrono::seconds(FLAGS_rib_stale_route_timeout_s);
+  backgroundEventBase_.runInEventBaseThread([this, timeout] {
+    backgroundEventBase_.runAfterDelay(
+        [this] { sweepStaleRibRoutes(); },
+        duration_cast<milliseconds>(timeout).count());
+  });
+}
+
+void SwSwitch::sweepStaleRibRoutes() {
+  auto removed = rib_->sweepStaleRoutes(&staleRouteFibUpdate, this);
+  XLOG(INFO) << "Removed " << removed
+             << " restored routes of clients that did not sync";
+}
+
+void SwSwitch::publishCoalescedRibRoutes() {
+  auto window = milliseconds(FLAGS_rib_route_coalescing_ms);
+  rib_->publishCoalescedRoutes(&coalescedRouteFibUpdate, this);
+  backgroundEventBase_.runAfterDelay(
+      [this] { publishCoalescedRibRoutes(); }, window.count());
+}
+
+void SwSwitch::checkpointWarmBootState() {
+  std::lock_guard<std::mutex> guard(warmBootCheckpointLock_);
+  auto appliedState = getAppliedState();
+  if (!appliedState || warmBootCheckpoint_.state.lock() == appliedState) {
+    return;
+  }
+  auto begin = steady_clock::now();
+  warmBootCheckpoint_.switchState = appliedState->toFollyDynamic();
+  warmBootCheckpoint_.state = appliedState;
+  XLOG(DBG2) << "Checkpointed switch state generation "
+             << appliedState->getGeneration() << " in "
+             << duration_cast<milliseconds>(steady_clock::now() - begin)
+                    .count()
+             << "ms";
+}
+
 void SwSwitch::getProductInfo(ProductInfo& productInfo) const {
   platform_->getProductInfo(productInfo);
 }
 
 void SwSwitch::updateStats() {
   updateRouteStats();
+  updateStateMemoryStats();
   updatePortInfo();
   try {
     getHw()->updateStats(stats());
@@ -360,26 +616,118 @@ void SwSwitch::updateStats() {
     stats()->updateStatsException();
     XLOG(ERR) << "Error running updateStats: " << folly::exceptionStr(ex);
   }
+  portInfoCache_->statsUpdated();
+  publishHwStats();
+}
+
+void SwSwitch::updateStateMemoryStats() {
+  auto now = steady_clock::now();
+  if (FLAGS_state_memory_stats_interval_s <= 0 ||
+      now - lastStateMemoryStats_ <
+          seconds(FLAGS_state_memory_stats_interval_s)) {
+    return;
+  }
+  lastStateMemoryStats_ = now;
+  auto states = getStates();
+  StateMemoryUsage memory(states.second, states.first);
+  for (const auto& subtree : memory.getSubtrees()) {
+    fbData->setCounter(
+        folly::to<std::string>("state_memory.", subtree.first, ".bytes"),
+        subtree.second.bytes);
+    fbData->setCounter(
+        folly::to<std::string>("state_memory.", subtree.first, ".nodes"),
+        subtree.second.nodes);
+  }
+  const auto& total = memory.getTotal();
+  fbData->setCounter("state_memory.total.bytes", total.bytes);
+  fbData->setCounter("state_memory.total.nodes", total.nodes);
+  fbData->setCounter("state_memory.total.shared_bytes", total.sharedBytes);
+  fbData->setCounter("state_memory.total.shared_nodes", total.sharedNodes);
+}
+
+void SwSwitch::publishHwStats() {
+  StatsListener listener;
+  {
+    lock_guard<mutex> g(statsListenerMutex_);
+    listener = statsListener_;
+  }
+  if (!listener) {
+    return;
+  }
+
+  auto full = std::make_shared<HwStatsUpdate>();
+  full->timestampSecs = std::chrono::duration_cast<std::chrono::seconds>(
+                            std::chrono::system_clock::now().time_since_epoch())
+                            .count();
+  full->full = true;
+  auto delta = std::make_shared<HwStatsUpdate>();
+  delta->timestampSecs = full->timestampSecs;
+  delta->full = false;
+  for (auto& entry : getHw()->getPortStats()) {
+    auto last = lastPublishedPortStats_.find(entry.first);
+    if (last == lastPublishedPortStats_.end() || last->second != entry.second) {
+      delta->portStats.emplace(entry.first, entry.second);
+    }
+    full->portStats.emplace(entry.first, std::move(entry.second));
+  }
+  lastPublishedPortStats_ = full->portStats;
+  listener(std::move(full), std::move(delta));
 }
 
 void SwSwitch::registerNeighborListener(
-    std::function<void(const std::vector<std::string>& added,
-                       const std::vector<std::string>& deleted)> callback) {
+    std::function<void(const std::vector<folly::IPAddress>& added,
+                       const std::vector<folly::IPAddress>& deleted)>
+        callback) {
   XLOG(DBG2) << "Registering neighbor listener";
   lock_guard<mutex> g(neighborListenerMutex_);
   neighborListener_ = std::move(callback);
 }
 
 void SwSwitch::invokeNeighborListener(
-    const std::vector<std::string>& added,
-    const std::vector<std::string>& removed) {
+    const std::vector<folly::IPAddress>& added,
+    const std::vector<folly::IPAddress>& removed) {
   lock_guard<mutex> g(neighborListenerMutex_);
   if (neighborListener_) {
     neighborListener_(added, removed);
   }
 }
 
+void SwSwitch::registerStatsListener(StatsListener callback) {
+  XLOG(DBG2) << "Registering stats listener";
+  lock_guard<mutex> g(statsListenerMutex_);
+  statsListener_ = std::move(callback);
+}
+
+void SwSwitch::registerPortStatusListener(PortStatusListener callback) {
+  XLOG(DBG2) << "Registering port status listener";
+  lock_guard<mutex> g(portStatusListenerMutex_);
+  portStatusListener_ = std::move(callback);
+}
+
+void SwSwitch::publishPortStatus(
+    const std::vector<std::shared_ptr<Port>>& ports) {
+  PortStatusListener listener;
+  {
+    lock_guard<mutex> g(portStatusListenerMutex_);
+    listener = portStatusListener_;
+  }
+  if (!listener || ports.empty()) {
+    return;
+  }
+  std::map<int32_t, PortStatus> changed;
+  for (const auto& port : ports) {
+    changed.emplace(port->getID(), fillInPortStatus(*port, this));
+  }
+  listener(std::move(changed));
+}
+
 bool SwSwitch::getAndClearNeighborHit(RouterID vrf, folly::IPAddress ip) {
+  if (neighborHitScanner_) {
+    auto hit = neighborHitScanner_->isHit(vrf, ip);
+    if (hit) {
+      return *hit;
+    }
+  }
   return hw_->getAndClearNeighborHit(vrf, ip);
 }
 
@@ -397,6 +745,24 @@ void SwSwitch::clearWarmBootCache() {
 }
 
 void SwSwitch::publishRxPacket(RxPacket* pkt, uint16_t ethertype){
+  if (auto ring = std::atomic_load(&pcapRing_)) {
+    std::vector<std::pair<int32_t, std::string>> reasons;
+    for (auto& r : pkt->getReasons()) {
+      reasons.emplace_back(r.bytes, std::move(r.description));
+    }
+    auto flat = coalescedCopy(pkt->buf());
+    auto buf = flat ? flat.get() : pkt->buf();
+    if (!ring->writeRx(
+            pkt->getSrcPort(),
+            pkt->getSrcVlan(),
+            reasons,
+            ethertype,
+            folly::ByteRange(buf->data(), buf->length()))) {
+      stats()->pcapDistFailure();
+    }
+    return;
+  }
+
   RxPacketData pubPkt;
   pubPkt.srcPort = pkt->getSrcPort();
   pubPkt.srcVlan = pkt->getSrcVlan();
@@ -421,6 +787,16 @@ void SwSwitch::publishRxPacket(RxPacket* pkt, uint16_t ethertype){
 }
 
 void SwSwitch::publishTxPacket(TxPacket* pkt, uint16_t ethertype){
+  if (auto ring = std::atomic_load(&pcapRing_)) {
+    auto flat = coalescedCopy(pkt->buf());
+    auto buf = flat ? flat.get() : pkt->buf();
+    if (!ring->writeTx(
+            ethertype, folly::ByteRange(buf->data(), buf->length()))) {
+      stats()->pcapDistFailure();
+    }
+    return;
+  }
+
   TxPacketData pubPkt;
   folly::IOBuf copy_buf;
   pkt->buf()->cloneInto(copy_buf);
@@ -435,9 +811,12 @@ void SwSwitch::publishTxPacket(TxPacket* pkt, uint16_t ethertype){
 }
 
 void SwSwitch::init(std::unique_ptr<TunManager> tunMgr, SwitchFlags flags) {
+  boot_trace::Span span("SwSwitch::init");
   auto begin = steady_clock::now();
   flags_ = flags;
   auto hwInitRet = hw_->init(this);
+  // The SDK has started its threads
+  thread_placement::applyToRunningThreads();
   auto initialState = hwInitRet.switchState;
   // for now, warmboot is not keeping failed routes, so keep the same state as
   // applied and desired.
@@ -450,6 +829,21 @@ void SwSwitch::init(std::unique_ptr<TunManager> tunMgr, SwitchFlags flags) {
   restart_time::init(
       platform_->getWarmBootDir(), bootType_ == BootType::WARM_BOOT);
 
+  if (bootType_ == BootType::WARM_BOOT && isStandaloneRibEnabled()) {
+    boot_trace::Span ribSpan("restoreRibSnapshot");
+    restoreRibSnapshot();
+  }
+  if (FLAGS_rib_route_coalescing_ms > 0 && isStandaloneRibEnabled()) {
+    rib_->setCoalescingWindow(milliseconds(FLAGS_rib_route_coalescing_ms));
+    backgroundEventBase_.runInEventBaseThread(
+        [this] { publishCoalescedRibRoutes(); });
+  }
+
+  if (!FLAGS_state_update_journal.empty()) {
+    stateUpdateJournal_ =
+        std::make_unique<StateUpdateJournal>(FLAGS_state_update_journal);
+  }
+
   // Store the initial state
   initialState->publish();
   initialStateDesired->publish();
@@ -487,6 +881,9 @@ void SwSwitch::init(std::unique_ptr<TunManager> tunMgr, SwitchFlags flags) {
   }
 
   startThreads();
+  if (bootType_ == BootType::WARM_BOOT) {
+    pcapMgr_->removeStaleDataplaneCaptures();
+  }
   XLOG(INFO)
       << "Time to init switch and start all threads "
       << duration_cast<duration<float>>(steady_clock::now() - begin).count();
@@ -507,6 +904,15 @@ void SwSwitch::init(std::unique_ptr<TunManager> tunMgr, SwitchFlags flags) {
 
   if (flags & SwitchFlags::ENABLE_LACP) {
     lagManager_ = std::make_unique<LinkAggregationManager>(this);
+    microBfdManager_ = std::make_unique<MicroBfdManager>(this);
+  }
+
+  bfdManager_ = std::make_unique<BfdManager>(this);
+
+  if (FLAGS_neighbor_hit_scan_interval_s > 0) {
+    neighborHitScanner_ = std::make_unique<NeighborHitScanner>(
+        this, std::chrono::seconds(FLAGS_neighbor_hit_scan_interval_s));
+    neighborHitScanner_->start();
   }
 
   auto bgHeartbeatStatsFunc = [this] (int delay, int backLog) {
@@ -545,21 +951,33 @@ void SwSwitch::init(std::unique_ptr<TunManager> tunMgr, SwitchFlags flags) {
       FLAGS_thread_heartbeat_ms,
       updateLacpThreadHeartbeatStats);
 
-  neighborCacheThreadHeartbeat_ = std::make_unique<ThreadHeartbeat>(
-      &neighborCacheEventBase_,
-      *folly::getThreadName(neighborCacheThread_->get_id()),
+  qsfpCacheThreadHeartbeat_ = std::make_unique<ThreadHeartbeat>(
+      &qsfpCacheEventBase_,
+      "fbossQsfpCacheThread",
       FLAGS_thread_heartbeat_ms,
-      [this](int delay, int backlog) {
-        stats()->neighborCacheHeartbeatDelay(delay);
-        stats()->neighborCacheEventBacklog(backlog);
+      [this](int delay, int backLog) {
+        stats()->qsfpCacheHeartbeatDelay(delay);
+        stats()->qsfpCacheEventBacklog(backLog);
       });
 
+  for (size_t i = 0; i < neighborCacheThreads_.size(); ++i) {
+    neighborCacheThreadHeartbeats_.push_back(std::make_unique<ThreadHeartbeat>(
+        neighborCacheEventBases_[i].get(),
+        *folly::getThreadName(neighborCacheThreads_[i]->get_id()),
+        FLAGS_thread_heartbeat_ms,
+        [this](int delay, int backlog) {
+          stats()->neighborCacheHeartbeatDelay(delay);
+          stats()->neighborCacheEventBacklog(backlog);
+        }));
+  }
+
   setSwitchRunState(SwitchRunState::INITIALIZED);
 
   constructPushClient(pcap_pubsub_constants::PCAP_PUBSUB_PORT());
 }
 
 void SwSwitch::initialConfigApplied(const steady_clock::time_point& startTime) {
+  boot_trace::Span span("SwSwitch::initialConfigApplied");
   // notify the hw
   hw_->initialConfigApplied();
   platform_->onInitialConfigApplied(this);
@@ -619,15 +1037,46 @@ void SwSwitch::fibSynced() {
 void SwSwitch::registerStateObserver(StateObserver* observer,
                                      const string name) {
   XLOG(DBG2) << "Registering state observer: " << name;
-  updateEventBase_.runImmediatelyOrRunInEventBaseThreadAndWait([=]() {
-      addStateObserver(observer, name);
+  StateObserverInfo info;
+  info.name = name;
+  updateEventBase_.runImmediatelyOrRunInEventBaseThreadAndWait([&]() {
+      addStateObserver(observer, std::move(info));
+  });
+}
+
+void SwSwitch::registerAsyncStateObserver(
+    StateObserver* observer,
+    const std::string& name,
+    folly::EventBase* evb,
+    uint32_t maxPendingDeltas) {
+  XLOG(DBG2) << "Registering async state observer: " << name;
+  CHECK(evb);
+  CHECK_NE(evb, &updateEventBase_);
+  CHECK_GT(maxPendingDeltas, 0);
+  StateObserverInfo info;
+  info.name = name;
+  info.evb = evb;
+  info.maxPendingDeltas = maxPendingDeltas;
+  info.async = std::make_shared<AsyncStateObserverState>();
+  updateEventBase_.runImmediatelyOrRunInEventBaseThreadAndWait([&]() {
+    addStateObserver(observer, std::move(info));
   });
 }
 
 void SwSwitch::unregisterStateObserver(StateObserver* observer) {
-  updateEventBase_.runImmediatelyOrRunInEventBaseThreadAndWait([=]() {
+  folly::EventBase* observerEvb{nullptr};
+  updateEventBase_.runImmediatelyOrRunInEventBaseThreadAndWait([&]() {
+    auto iter = stateObservers_.find(observer);
+    if (iter != stateObservers_.end() && iter->second.async) {
+      iter->second.async->registered = false;
+      observerEvb = iter->second.evb;
+    }
     removeStateObserver(observer);
   });
+  if (observerEvb && observerEvb->isRunning()) {
+    // Wait out a delivery that may be using the observer right now
+    observerEvb->runImmediatelyOrRunInEventBaseThreadAndWait([]() {});
+  }
 }
 
 bool SwSwitch::stateObserverRegistered(StateObserver* observer) {
@@ -643,12 +1092,19 @@ void SwSwitch::removeStateObserver(StateObserver* observer) {
   }
 }
 
-void SwSwitch::addStateObserver(StateObserver* observer, const string& name) {
+void SwSwitch::addStateObserver(
+    StateObserver* observer,
+    StateObserverInfo info) {
   DCHECK(updateEventBase_.isInEventBaseThread());
   if (stateObserverRegistered(observer)) {
-    throw FbossError("State observer add failed: ", name, " already exists");
+    throw FbossError(
+        "State observer add failed: ", info.name, " already exists");
   }
-  stateObservers_.emplace(observer, name);
+  info.latencyHistogram =
+      folly::to<string>("state_observer.", info.name, ".us");
+  fbData->addHistogram(info.latencyHistogram, 1000, 0, 1000000);
+  fbData->exportHistogramPercentile(info.latencyHistogram, 50, 99);
+  stateObservers_.emplace(observer, std::move(info));
 }
 
 void SwSwitch::notifyStateObservers(const StateDelta& delta) {
@@ -657,24 +1113,77 @@ void SwSwitch::notifyStateObservers(const StateDelta& delta) {
     // Make sure the SwSwitch is not already being destroyed
     return;
   }
-  for (auto observerName : stateObservers_) {
+  for (const auto& observerInfo : stateObservers_) {
+    auto observer = observerInfo.first;
+    const auto& info = observerInfo.second;
+    if (info.evb) {
+      notifyAsyncStateObserver(observer, info, delta);
+      continue;
+    }
+    auto start = steady_clock::now();
     try {
-      auto observer = observerName.first;
       observer->stateUpdated(delta);
     } catch (const std::exception& ex) {
     // TODO: Figure out the best way to handle errors here.
-    XLOG(FATAL) << "error notifying " << observerName.second
+    XLOG(FATAL) << "error notifying " << info.name
                 << " of update: " << folly::exceptionStr(ex);
     }
-  }
+    fbData->addHistogramValue(
+        info.latencyHistogram,
+        duration_cast<microseconds>(steady_clock::now() - start).count());
+  }
+}
+
+void SwSwitch::notifyAsyncStateObserver(
+    StateObserver* observer,
+    const StateObserverInfo& info,
+    const StateDelta& delta) {
+  auto async = info.async;
+  if (async->pendingDeltas >= info.maxPendingDeltas &&
+      info.evb->isRunning()) {
+    // Backpressure: let the observer drain its queue before we hand it any
+    // more work.
+    XLOG(DBG2) << info.name << " has " << async->pendingDeltas
+               << " pending state deltas, waiting for it to catch up";
+    info.evb->runInEventBaseThreadAndWait([]() {});
+  }
+  ++async->pendingDeltas;
+  // The latency of async observers includes the time spent queued on evb.
+  auto queued = steady_clock::now();
+  info.evb->runInEventBaseThread([observer,
+                                  async,
+                                  oldState = delta.oldState(),
+                                  newState = delta.newState(),
+                                  queued,
+                                  name = info.name,
+                                  histogram = info.latencyHistogram]() {
+    if (async->registered) {
+      try {
+        observer->stateUpdated(StateDelta(oldState, newState));
+      } catch (const std::exception& ex) {
+        XLOG(FATAL) << "error notifying " << name
+                    << " of update: " << folly::exceptionStr(ex);
+      }
+      fbData->addHistogramValue(
+          histogram,
+          duration_cast<microseconds>(steady_clock::now() - queued).count());
+    }
+    --async->pendingDeltas;
+  });
 }
 
 void SwSwitch::updateState(
     unique_ptr<StateUpdate> update) {
+  auto priority = update->getPriority();
+  auto index = static_cast<size_t>(priority);
+  update->queuedAt_ = std::chrono::steady_clock::now();
+  size_t queueDepth;
   {
     folly::SpinLockGuard guard(pendingUpdatesLock_);
-    pendingUpdates_.push_back(*update.release());
+    pendingUpdates_[index].push_back(*update.release());
+    queueDepth = ++pendingUpdateCounts_[index];
   }
+  stats()->stateUpdateQueued(priority, queueDepth);
 
   // Signal the update thread that updates are pending.
   // We call runInEventBaseThread() with a static function pointer since this
@@ -687,12 +1196,11 @@ void SwSwitch::queueStateUpdateForGettingHwInSync(
     StateUpdateFn fn) {
   auto update = make_unique<FunctionStateUpdate>(name, std::move(fn));
   {
-    // Push the state update in front to preserver ordering.
-    // This is not particularly necessary, since this state
-    // update is freely coalesced with other state updates when
-    // we come to processing pending updates
+    // This update takes us from the applied state to the desired state, so it
+    // has to be applied before any other update.  handlePendingUpdates()
+    // puts it at the front of whichever priority class it runs next.
     folly::SpinLockGuard guard(pendingUpdatesLock_);
-    pendingUpdates_.push_front(*update.release());
+    hwSyncUpdates_.push_back(*update.release());
   }
   // Don't inform updateEventBase about this update being queued.
   // Rather let this update be processed with the next incoming update.
@@ -709,19 +1217,29 @@ void SwSwitch::queueStateUpdateForGettingHwInSync(
 
 void SwSwitch::updateState(
     StringPiece name,
-    StateUpdateFn fn) {
-  auto update = make_unique<FunctionStateUpdate>(name, std::move(fn));
+    StateUpdateFn fn,
+    StateUpdate::Priority priority) {
+  auto update =
+      make_unique<FunctionStateUpdate>(name, std::move(fn), true, priority);
   updateState(std::move(update));
 }
 
-void SwSwitch::updateStateNoCoalescing(StringPiece name, StateUpdateFn fn) {
-  auto update = make_unique<FunctionStateUpdate>(name, std::move(fn), false);
+void SwSwitch::updateStateNoCoalescing(
+    StringPiece name,
+    StateUpdateFn fn,
+    StateUpdate::Priority priority) {
+  auto update =
+      make_unique<FunctionStateUpdate>(name, std::move(fn), false, priority);
   updateState(std::move(update));
 }
 
-void SwSwitch::updateStateBlocking(folly::StringPiece name, StateUpdateFn fn) {
+void SwSwitch::updateStateBlocking(
+    folly::StringPiece name,
+    StateUpdateFn fn,
+    StateUpdate::Priority priority) {
   auto result = std::make_shared<BlockingUpdateResult>();
-  auto update = make_unique<BlockingStateUpdate>(name, std::move(fn), result);
+  auto update = make_unique<BlockingStateUpdate>(
+      name, std::move(fn), result, true, priority);
   updateState(std::move(update));
   result->wait();
 }
@@ -737,23 +1255,48 @@ void SwSwitch::handlePendingUpdates() {
   // were scheduled before we had a chance to process them.  In some cases we
   // might also end up finding 0 updates to process if a previous
   // handlePendingUpdates() call processed multiple updates.
+  //
+  // Only the highest priority class with pending updates is processed, so a
+  // bulk route update never delays a link or neighbor update by more than the
+  // batch that is already running.  Each updateState() call schedules one
+  // handlePendingUpdates() call and each call consumes at least one update, so
+  // lower priority classes are drained by later calls.
   StateUpdateList updates;
+  size_t numUpdates = 0;
   {
     folly::SpinLockGuard guard(pendingUpdatesLock_);
-    // When deciding how many elements to pull off the pendingUpdates_
-    // list, we pull as many as we can, while making sure we don't
-    // include any updates after an update that does not allow
-    // coalescing.
-    auto iter = pendingUpdates_.begin();
-    while (iter != pendingUpdates_.end()) {
-      StateUpdate* update = &(*iter);
-      ++iter;
-      if (!update->allowsCoalescing()) {
-        break;
+    updates.splice(updates.end(), hwSyncUpdates_);
+    for (size_t i = 0; i < StateUpdate::kNumPriorities; ++i) {
+      auto& pending = pendingUpdates_[i];
+      if (pending.empty()) {
+        continue;
+      }
+      // When deciding how many elements to pull off the list, we pull as many
+      // as we can, while making sure we don't include any updates after an
+      // update that does not allow coalescing.
+      auto iter = pending.begin();
+      while (iter != pending.end()) {
+        StateUpdate* update = &(*iter);
+        ++iter;
+        ++numUpdates;
+        if (!update->allowsCoalescing()) {
+          break;
+        }
       }
+      updates.splice(updates.end(), pending, pending.begin(), iter);
+      pendingUpdateCounts_[i] -= numUpdates;
+      break;
+    }
+  }
+
+  auto now = std::chrono::steady_clock::now();
+  for (const auto& update : updates) {
+    if (update.queuedAt_ != std::chrono::steady_clock::time_point()) {
+      stats()->stateUpdateDequeued(
+          update.getPriority(),
+          std::chrono::duration_cast<std::chrono::microseconds>(
+              now - update.queuedAt_));
     }
-    updates.splice(updates.begin(), pendingUpdates_,
-                   pendingUpdates_.begin(), iter);
   }
 
   // handlePendingUpdates() is invoked once for each update, but a previous
@@ -762,6 +1305,15 @@ void SwSwitch::handlePendingUpdates() {
   if (updates.empty()) {
     return;
   }
+  auto source = updates.size() == 1
+      ? updates.front().getName()
+      : folly::to<string>(
+            updates.front().getName(),
+            " and ",
+            updates.size() - 1,
+            " more state updates");
+  ThreadHeartbeat::setLoopSource(source);
+  StallDetector::Work work(source);
 
 
   // This function should never be called with valid updates while we are
@@ -777,7 +1329,13 @@ void SwSwitch::handlePendingUpdates() {
   // oldDesiredState. This is the one we always enqueue at the front of the
   // queue whenever applied and desired states diverge. After that, other
   // supplied state updates are applied (that were spliced above).
-  auto newDesiredState = oldAppliedState;
+  //
+  // While the hardware thread programs a batch, we start from the desired
+  // state handed to it instead. That batch is programmed from whatever was
+  // applied before it, so it also retries what failed before it.
+  auto baseState = hwPipelineDesired_ ? hwPipelineDesired_ : oldAppliedState;
+  auto newDesiredState = baseState;
+  std::vector<std::string> appliedNames;
   auto iter = updates.begin();
   while (iter != updates.end()) {
     StateUpdate* update = &(*iter);
@@ -804,62 +1362,220 @@ void SwSwitch::handlePendingUpdates() {
       // existing state, leaving it in an invalid state.
       intermediateState->publish();
       newDesiredState = intermediateState;
+      if (stateUpdateJournal_) {
+        appliedNames.push_back(update->getName());
+      }
+    }
+  }
+
+  if (FLAGS_pipeline_state_updates) {
+    auto batch = std::make_unique<HwUpdateBatch>();
+    batch->desired = newDesiredState;
+    batch->updates.splice(batch->updates.end(), updates);
+    batch->names = std::move(appliedNames);
+    if (newDesiredState != baseState) {
+      hwPipelineDesired_ = newDesiredState;
+      setDesiredState(newDesiredState);
     }
+    queueHwUpdate(std::move(batch));
+    return;
   }
 
   // Now apply the update and notify subscribers
   if (newDesiredState != oldAppliedState) {
     // There was some change during these state updates
+    auto applyStart = std::chrono::steady_clock::now();
     auto newAppliedState = applyUpdate(oldAppliedState, newDesiredState);
+    if (stateUpdateJournal_) {
+      journalStateUpdate(
+          appliedNames,
+          StateDelta(oldAppliedState, newDesiredState),
+          std::chrono::duration_cast<std::chrono::microseconds>(
+              std::chrono::steady_clock::now() - applyStart));
+    }
     // Stick the initial applied->desired in the beginning
     bool newOutOfSync = (newAppliedState != newDesiredState);
     fbData->setCounter("hw_out_of_sync", newOutOfSync);
     if (newOutOfSync) {
       // If we could not apply the whole delta successfully, put the difference
       // as a state update at the beginning
-      queueStateUpdateForGettingHwInSync(
-          "state update for failed hardware application",
-          [newDesiredState,
-           newAppliedState](const std::shared_ptr<SwitchState>& /*oldState*/) {
-            // clone the newDesiredState and then inheritGeneration from
-            // newAppliedState otherwise the return state has a smaller gen#
-            // than the one of appliedState
-            auto hwOutOfSyncState = newDesiredState->clone();
-            hwOutOfSyncState->inheritGeneration(*newAppliedState);
-            return hwOutOfSyncState;
-          });
+      queueHwSyncUpdate(newDesiredState, newAppliedState);
     }
   }
 
+  notifyUpdatesSucceeded(&updates);
+}
+
+void SwSwitch::queueHwSyncUpdate(
+    const std::shared_ptr<SwitchState>& newDesiredState,
+    const std::shared_ptr<SwitchState>& newAppliedState) {
+  queueStateUpdateForGettingHwInSync(
+      "state update for failed hardware application",
+      [newDesiredState,
+       newAppliedState](const std::shared_ptr<SwitchState>& /*oldState*/) {
+        // clone the newDesiredState and then inheritGeneration from
+        // newAppliedState otherwise the return state has a smaller gen#
+        // than the one of appliedState
+        auto hwOutOfSyncState = newDesiredState->clone();
+        hwOutOfSyncState->inheritGeneration(*newAppliedState);
+        return hwOutOfSyncState;
+      });
+}
+
+void SwSwitch::notifyUpdatesSucceeded(StateUpdateList* updates) {
   // Notify all of the updates of success, and delete them. Success is defined
   // as SwSwitch's attempt to apply them to hw, even though they might have not
   // actually been applied yet.
-  while (!updates.empty()) {
-    unique_ptr<StateUpdate> update(&updates.front());
-    updates.pop_front();
+  while (!updates->empty()) {
+    unique_ptr<StateUpdate> update(&updates->front());
+    updates->pop_front();
     update->onSuccess();
   }
 }
 
+void SwSwitch::queueHwUpdate(std::unique_ptr<HwUpdateBatch> batch) {
+  DCHECK(updateEventBase_.isInEventBaseThread());
+  if (!hwUpdateInFlight_) {
+    startHwUpdate(std::move(batch));
+  } else if (!waitingHwUpdate_) {
+    waitingHwUpdate_ = std::move(batch);
+  } else {
+    // Coalesce with the batch already waiting for the hardware thread
+    waitingHwUpdate_->desired = batch->desired;
+    waitingHwUpdate_->updates.splice(
+        waitingHwUpdate_->updates.end(), batch->updates);
+    waitingHwUpdate_->names.insert(
+        waitingHwUpdate_->names.end(),
+        batch->names.begin(),
+        batch->names.end());
+  }
+}
+
+void SwSwitch::startHwUpdate(std::unique_ptr<HwUpdateBatch> batch) {
+  auto oldAppliedState = getAppliedState();
+  if (batch->desired == oldAppliedState || isExiting()) {
+    hwPipelineDesired_.reset();
+    notifyUpdatesSucceeded(&batch->updates);
+    return;
+  }
+  DCHECK_GT(
+      batch->desired->getGeneration(), oldAppliedState->getGeneration());
+  hwUpdateInFlight_ = true;
+  hwUpdateEventBase_.runInEventBaseThread(
+      [this, oldAppliedState, batch = std::move(batch)]() mutable {
+        auto start = std::chrono::steady_clock::now();
+        XLOG(INFO) << "Updating state: old_gen="
+                   << oldAppliedState->getGeneration()
+                   << " new_gen=" << batch->desired->getGeneration();
+        auto newAppliedState = isExiting()
+            ? oldAppliedState
+            : programHw(StateDelta(oldAppliedState, batch->desired));
+        auto hwTime = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start);
+        updateEventBase_.runInEventBaseThread(
+            [this,
+             oldAppliedState,
+             newAppliedState,
+             start,
+             hwTime,
+             batch = std::move(batch)]() mutable {
+              hwUpdateDone(
+                  std::move(batch),
+                  oldAppliedState,
+                  newAppliedState,
+                  start,
+                  hwTime);
+            });
+      });
+}
+
+void SwSwitch::hwUpdateDone(
+    std::unique_ptr<HwUpdateBatch> batch,
+    const std::shared_ptr<SwitchState>& oldAppliedState,
+    const std::shared_ptr<SwitchState>& newAppliedState,
+    std::chrono::steady_clock::time_point start,
+    std::chrono::microseconds hwTime) {
+  hwUpdateInFlight_ = false;
+  StateDelta delta(oldAppliedState, batch->desired);
+  // Keep the desired state of a batch already computed on top of this one
+  setStateInternal(
+      newAppliedState,
+      waitingHwUpdate_ ? waitingHwUpdate_->desired : batch->desired);
+  notifyStateObservers(delta);
+  auto duration = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start);
+  stats()->stateUpdate(duration);
+  XLOG(DBG0) << "Update state took " << duration.count() << "us";
+  if (stateUpdateJournal_) {
+    journalStateUpdate(batch->names, delta, hwTime);
+  }
+
+  bool newOutOfSync = (newAppliedState != batch->desired);
+  fbData->setCounter("hw_out_of_sync", newOutOfSync);
+  if (waitingHwUpdate_) {
+    // Programmed from newAppliedState, so whatever failed is retried
+    startHwUpdate(std::move(waitingHwUpdate_));
+  } else {
+    hwPipelineDesired_.reset();
+    if (newOutOfSync) {
+      queueHwSyncUpdate(batch->desired, newAppliedState);
+    }
+  }
+  notifyUpdatesSucceeded(&batch->updates);
+}
+
+void SwSwitch::journalStateUpdate(
+    const std::vector<std::string>& names,
+    const StateDelta& delta,
+    std::chrono::microseconds applyTime) {
+  try {
+    stateUpdateJournal_->append(names, delta, applyTime);
+  } catch (const std::exception& ex) {
+    // A journal with a gap can't be replayed, so stop writing it
+    XLOG(ERR) << "Stopping the state update journal: "
+              << folly::exceptionStr(ex);
+    stateUpdateJournal_.reset();
+  }
+}
+
 void SwSwitch::setStateInternal(
     std::shared_ptr<SwitchState> newAppliedState,
     std::shared_ptr<SwitchState> newDesiredState) {
-  // This is one of the only two places that should ever directly access
-  // stateDontUseDirectly_.  (getState() being the other one.)
   CHECK(bool(newAppliedState));
   CHECK(bool(newDesiredState));
   CHECK(newAppliedState->isPublished());
   CHECK(newDesiredState->isPublished());
-  folly::SpinLockGuard guard(stateLock_);
-  appliedStateDontUseDirectly_.swap(newAppliedState);
-  desiredStateDontUseDirectly_.swap(newDesiredState);
+  publishStates(std::move(newAppliedState), std::move(newDesiredState));
 }
 
 void SwSwitch::setDesiredState(std::shared_ptr<SwitchState> newDesiredState) {
   CHECK(bool(newDesiredState));
   CHECK(newDesiredState->isPublished());
-  folly::SpinLockGuard guard(stateLock_);
-  desiredStateDontUseDirectly_.swap(newDesiredState);
+  publishStates(nullptr, std::move(newDesiredState));
+}
+
+void SwSwitch::publishStates(
+    std::shared_ptr<SwitchState> newAppliedState,
+    std::shared_ptr<SwitchState> newDesiredState) {
+  // This is the only place that should ever store to statesDontUseDirectly_.
+  // Declared before the lock so that the old states are destroyed after it is
+  // released.
+  std::shared_ptr<const StateSnapshot> oldStates;
+  auto stats = this->stats();
+  std::unique_lock<folly::SpinLock> guard(stateLock_, std::try_to_lock);
+  if (!guard.owns_lock()) {
+    stats->stateLockContended();
+    guard.lock();
+  }
+  stats->stateLockAcquired();
+  oldStates = statesDontUseDirectly_.load(std::memory_order_acquire);
+  if (!newAppliedState) {
+    newAppliedState = oldStates->applied;
+  }
+  statesDontUseDirectly_.store(
+      std::make_shared<const StateSnapshot>(StateSnapshot{
+          std::move(newAppliedState), std::move(newDesiredState)}),
+      std::memory_order_release);
 }
 
 std::shared_ptr<SwitchState> SwSwitch::applyUpdate(
@@ -880,12 +1596,31 @@ std::shared_ptr<SwitchState> SwSwitch::applyUpdate(
     return oldState;
   }
 
+  auto newAppliedState = programHw(delta);
+
+  setStateInternal(newAppliedState, newState);
+
+  // Notifies all observers of the current state update. We notify them that
+  // the state changed to "desired state", even if the whole state might not
+  // have been applied yet. If an observer wants to know the applied state,
+  // they can query the SwSwitch about it.
+  notifyStateObservers(delta);
+
+  auto end = std::chrono::steady_clock::now();
+  auto duration =
+    std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+  stats()->stateUpdate(duration);
+  XLOG(DBG0) << "Update state took " << duration.count() << "us";
+  return newAppliedState;
+}
+
+std::shared_ptr<SwitchState> SwSwitch::programHw(const StateDelta& delta) {
   std::shared_ptr<SwitchState> newAppliedState;
 
   // Inform the HwSwitch of the change.
   //
-  // Note that at this point we have already updated the state pointer and
-  // released stateLock_, so the new state is already published and visible to
+  // Note that at this point we have already published the new state
+  // snapshot, so the new state is already published and visible to
   // other threads.  This does mean that there is a window where the new state
   // is visible but the hardware is not using the new configuration yet.
   //
@@ -895,6 +1630,8 @@ std::shared_ptr<SwitchState> SwSwitch::applyUpdate(
   // undesirable.  So far I don't think this brief discrepancy should cause
   // major issues.
   try {
+    boot_trace::Span span("HwSwitch::stateChanged");
+    StallDetector::Work work("HwSwitch::stateChanged");
     newAppliedState = hw_->stateChanged(delta);
   } catch (const std::exception& ex) {
     // Notify the hw_ of the crash so it can execute any device specific
@@ -905,20 +1642,6 @@ std::shared_ptr<SwitchState> SwSwitch::applyUpdate(
     XLOG(FATAL) << "error applying state change to hardware: "
                 << folly::exceptionStr(ex);
   }
-
-  setStateInternal(newAppliedState, newState);
-
-  // Notifies all observers of the current state update. We notify them that
-  // the state changed to "desired state", even if the whole state might not
-  // have been applied yet. If an observer wants to know the applied state,
-  // they can query the SwSwitch about it.
-  notifyStateObservers(delta);
-
-  auto end = std::chrono::steady_clock::now();
-  auto duration =
-    std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-  stats()->stateUpdate(duration);
-  XLOG(DBG0) << "Update state took " << duration.count() << "us";
   return newAppliedState;
 }
 
@@ -974,7 +1697,16 @@ void SwSwitch::setPortStatusCounter(PortID port, bool up) {
 }
 
 void SwSwitch::packetReceived(std::unique_ptr<RxPacket> pkt) noexcept {
+  if (rxDispatcher_) {
+    rxDispatcher_->dispatch(std::move(pkt));
+    return;
+  }
+  receivePacket(std::move(pkt));
+}
+
+void SwSwitch::receivePacket(std::unique_ptr<RxPacket> pkt) noexcept {
   PortID port = pkt->getSrcPort();
+  StallDetector::Work work("packet rx");
   try {
     handlePacket(std::move(pkt));
   } catch (const std::exception& ex) {
@@ -998,10 +1730,37 @@ void SwSwitch::handlePacket(std::unique_ptr<RxPacket> pkt) {
     XLOG(DBG3) << "Dropping received packets received on UNINITIALIZED switch";
     return;
   }
+  // Charged to whichever handler the packet ends up with
+  auto handlingStart = steady_clock::now();
+  auto handler = RxCpuAccounting::Handler::OTHER;
+  auto cosQueue = pkt->cosQueue();
+  uint64_t dtlbStart = 0;
+  bool countTlb = FLAGS_rx_tlb_counters &&
+      RxCpuAccounting::readThreadDtlbMisses(&dtlbStart);
+  SCOPE_EXIT {
+    auto cpuTime = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        steady_clock::now() - handlingStart);
+    stats()->rxHandlerCpuTime(handler, cpuTime);
+    rxCpuAccounting_->record(handler, cosQueue, cpuTime);
+    uint64_t dtlbEnd = 0;
+    if (countTlb && RxCpuAccounting::readThreadDtlbMisses(&dtlbEnd)) {
+      stats()->rxHandlerDtlbMisses(handler, dtlbEnd - dtlbStart);
+      rxCpuAccounting_->recordDtlbMisses(
+          handler, cosQueue, dtlbEnd - dtlbStart);
+    }
+  };
+
   PortID port = pkt->getSrcPort();
   portStats(port)->trappedPkt();
+  if (cosQueue >= 0) {
+    stats()->trappedPktOnCpuQueue(cosQueue);
+  }
 
   pcapMgr_->packetReceived(pkt.get());
+  if (pcapMgr_->isDataplaneCopy(pkt.get())) {
+    // Forwarded by the hardware already; only mirrored here to be captured
+    return;
+  }
 
   // The minimum required frame length for ethernet is 64 bytes.
   // Abort processing early if the packet is too short.
@@ -1022,6 +1781,11 @@ void SwSwitch::handlePacket(std::unique_ptr<RxPacket> pkt) {
     ethertype = c.readBE<uint16_t>();
   }
 
+  if (!rxAdmission_->admit(port, rxAdmission_->classify(ethertype, c))) {
+    portStats(port)->pktAdmissionDrop();
+    return;
+  }
+
   if (distributionServiceReady_.load()) {
     publishRxPacket(pkt.get(), ethertype);
   }
@@ -1037,18 +1801,22 @@ void SwSwitch::handlePacket(std::unique_ptr<RxPacket> pkt) {
 
   switch (ethertype) {
   case ArpHandler::ETHERTYPE_ARP:
+    handler = RxCpuAccounting::Handler::ARP;
     arp_->handlePacket(std::move(pkt), dstMac, srcMac, c);
     return;
   case LldpManager::ETHERTYPE_LLDP:
     if (lldpManager_) {
+      handler = RxCpuAccounting::Handler::LLDP;
       lldpManager_->handlePacket(std::move(pkt), dstMac, srcMac, c);
       return;
     }
     break;
   case IPv4Handler::ETHERTYPE_IPV4:
+    handler = RxCpuAccounting::Handler::IPV4;
     ipv4_->handlePacket(std::move(pkt), dstMac, srcMac, c);
     return;
   case IPv6Handler::ETHERTYPE_IPV6:
+    handler = RxCpuAccounting::Handler::IPV6;
     ipv6_->handlePacket(std::move(pkt), dstMac, srcMac, c);
     return;
   case LACPDU::EtherType::SLOW_PROTOCOLS:
@@ -1058,6 +1826,7 @@ void SwSwitch::handlePacket(std::unique_ptr<RxPacket> pkt) {
     auto subtype = c.readBE<uint8_t>();
     if (subtype == LACPDU::EtherSubtype::LACP) {
       if (lagManager_) {
+        handler = RxCpuAccounting::Handler::LACP;
         lagManager_->handlePacket(std::move(pkt), c);
       } else {
         LOG_EVERY_N(WARNING, 60) << "Received LACP frame but LACP not enabled";
@@ -1078,32 +1847,58 @@ void SwSwitch::handlePacket(std::unique_ptr<RxPacket> pkt) {
 }
 
 void SwSwitch::linkStateChanged(PortID portId, bool up) {
-  XLOG(INFO) << "Link state changed: " << portId << "->"
-             << (up ? "UP" : "DOWN");
+  linkStatesChanged({{portId, up}});
+}
+
+void SwSwitch::linkStatesChanged(
+    const std::vector<std::pair<PortID, bool>>& changes) {
+  for (const auto& change : changes) {
+    XLOG(INFO) << "Link state changed: " << change.first << "->"
+               << (change.second ? "UP" : "DOWN");
+  }
   if (not isFullyInitialized()) {
     return;
   }
 
-  // Schedule an update for port's operational status
-  auto updateOperStateFn = [=](const std::shared_ptr<SwitchState>& state) {
-    std::shared_ptr<SwitchState> newState(state);
-    auto* port = newState->getPorts()->getPortIf(portId).get();
-    if (not port) {
-      throw FbossError("Port ", portId, " doesn't exists in SwitchState.");
+  // Schedule one update of the ports' operational status for the whole
+  // batch. A port that changes again starts another update, so the hardware
+  // still sees it go down before it comes back up.
+  auto begin = changes.begin();
+  while (begin != changes.end()) {
+    boost::container::flat_set<PortID> ports;
+    auto end = begin;
+    while (end != changes.end() && ports.insert(end->first).second) {
+      ++end;
     }
+    std::vector<std::pair<PortID, bool>> batch(begin, end);
+    auto updateOperStateFn =
+        [batch](const std::shared_ptr<SwitchState>& state) {
+          std::shared_ptr<SwitchState> newState(state);
+          for (const auto& change : batch) {
+            auto* port = newState->getPorts()->getPortIf(change.first).get();
+            if (not port) {
+              XLOG(ERR) << "Port " << change.first
+                        << " doesn't exists in SwitchState.";
+              continue;
+            }
+            port = port->modify(&newState);
+            port->setOperState(change.second);
+          }
+          return newState;
+        };
+    updateStateNoCoalescing(
+        "Port OperState Update",
+        std::move(updateOperStateFn),
+        StateUpdate::Priority::LINK);
+    begin = end;
+  }
 
-    port = port->modify(&newState);
-    port->setOperState(up);
-
-    return newState;
-  };
-  updateStateNoCoalescing(
-      "Port OperState Update", std::move(updateOperStateFn));
-
-  // Log event and update counters
-  logLinkStateEvent(portId, up);
-  setPortStatusCounter(portId, up);
-  portStats(portId)->linkStateChange();
+  // Log events and update counters
+  for (const auto& change : changes) {
+    logLinkStateEvent(change.first, change.second);
+    setPortStatusCounter(change.first, change.second);
+    portStats(change.first)->linkStateChange();
+  }
 }
 
 void SwSwitch::startThreads() {
@@ -1111,6 +1906,11 @@ void SwSwitch::startThreads() {
       [=] { this->threadLoop("fbossBgThread", &backgroundEventBase_); }));
   updateThread_.reset(new std::thread(
       [=] { this->threadLoop("fbossUpdateThread", &updateEventBase_); }));
+  if (FLAGS_pipeline_state_updates) {
+    hwUpdateThread_.reset(new std::thread([=] {
+      this->threadLoop("fbossHwUpdateThread", &hwUpdateEventBase_);
+    }));
+  }
   packetTxThread_.reset(new std::thread(
       [=] { this->threadLoop("fbossPktTxThread", &packetTxEventBase_); }));
   pcapDistributionThread_.reset(new std::thread([=] {
@@ -1121,9 +1921,23 @@ void SwSwitch::startThreads() {
       [=] { this->threadLoop("fbossQsfpCacheThread", &qsfpCacheEventBase_); }));
   lacpThread_.reset(new std::thread(
       [=] { this->threadLoop("fbossLacpThread", &lacpEventBase_); }));
-  neighborCacheThread_.reset(new std::thread([=] {
-    this->threadLoop("fbossNeighborCacheThread", &neighborCacheEventBase_);
-  }));
+  for (size_t i = 0; i < neighborCacheEventBases_.size(); ++i) {
+    auto name = i == 0 ? std::string("fbossNeighborCacheThread")
+                       : folly::to<std::string>("fbossNeighborCache", i);
+    auto* evb = neighborCacheEventBases_[i].get();
+    neighborCacheThreads_.push_back(std::make_unique<std::thread>(
+        [=] { this->threadLoop(name, evb); }));
+  }
+  if (FLAGS_rx_dispatch_queues > 0) {
+    rxDispatcher_ = std::make_unique<RxPacketDispatcher>(
+        this,
+        [this](std::unique_ptr<RxPacket> pkt) {
+          receivePacket(std::move(pkt));
+        },
+        FLAGS_rx_dispatch_queues,
+        std::max(1, FLAGS_rx_dispatch_queue_depth));
+    rxDispatcher_->start();
+  }
 }
 
 void SwSwitch::stopThreads() {
@@ -1133,6 +1947,10 @@ void SwSwitch::stopThreads() {
   //
   // Alternatively, it would be nicer to update EventBase so it can notify
   // callbacks when the event loop is being stopped.
+  if (rxDispatcher_) {
+    // rx workers post work to the other threads
+    rxDispatcher_->stop();
+  }
   if (backgroundThread_) {
     backgroundEventBase_.runInEventBaseThread(
         [this] { backgroundEventBase_.terminateLoopSoon(); });
@@ -1141,6 +1959,10 @@ void SwSwitch::stopThreads() {
     updateEventBase_.runInEventBaseThread(
         [this] { updateEventBase_.terminateLoopSoon(); });
   }
+  if (hwUpdateThread_) {
+    hwUpdateEventBase_.runInEventBaseThread(
+        [this] { hwUpdateEventBase_.terminateLoopSoon(); });
+  }
   if (packetTxThread_) {
     packetTxEventBase_.runInEventBaseThread(
         [this] { packetTxEventBase_.terminateLoopSoon(); });
@@ -1157,9 +1979,9 @@ void SwSwitch::stopThreads() {
     lacpEventBase_.runInEventBaseThread(
         [this] { lacpEventBase_.terminateLoopSoon(); });
   }
-  if (neighborCacheThread_) {
-    neighborCacheEventBase_.runInEventBaseThread(
-        [this] { neighborCacheEventBase_.terminateLoopSoon(); });
+  for (size_t i = 0; i < neighborCacheThreads_.size(); ++i) {
+    auto* evb = neighborCacheEventBases_[i].get();
+    evb->runInEventBaseThread([evb] { evb->terminateLoopSoon(); });
   }
   if (backgroundThread_) {
     backgroundThread_->join();
@@ -1167,6 +1989,9 @@ void SwSwitch::stopThreads() {
   if (updateThread_) {
     updateThread_->join();
   }
+  if (hwUpdateThread_) {
+    hwUpdateThread_->join();
+  }
   if (packetTxThread_) {
     packetTxThread_->join();
   }
@@ -1179,8 +2004,8 @@ void SwSwitch::stopThreads() {
   if (lacpThread_) {
     lacpThread_->join();
   }
-  if (neighborCacheThread_) {
-    neighborCacheThread_->join();
+  for (auto& thread : neighborCacheThreads_) {
+    thread->join();
   }
 }
 
@@ -1483,6 +2308,7 @@ bool SwSwitch::sendPacketToHost(
 }
 
 void SwSwitch::applyConfig(const std::string& reason, bool reload) {
+  boot_trace::Span span("SwSwitch::applyConfig");
   // We don't need to hold a lock here. updateStateBlocking() does that for us.
   updateStateBlocking(
       reason,
@@ -1490,12 +2316,37 @@ void SwSwitch::applyConfig(const std::string& reason, bool reload) {
         auto target = reload ? platform_->reloadConfig() : platform_->config();
 
         const auto& newConfig = target->thrift.sw;
-        auto newState = applyThriftConfig(
-            state,
-            &newConfig,
-            getPlatform(),
-            (getFlags() & SwitchFlags::ENABLE_STANDALONE_RIB) ? rib() : nullptr,
-            &curConfig_);
+        // The first config of a cold boot is applied to the same boot state
+        // each time. The standalone RIB takes routes from the config as it
+        // is applied, so it always needs the full apply.
+        std::unique_ptr<CompiledConfigCache> cache;
+        shared_ptr<SwitchState> newState;
+        if (!FLAGS_config_cache_dir.empty() && !reload &&
+            curConfigStr_.empty() && bootType_ == BootType::COLD_BOOT &&
+            !isStandaloneRibEnabled()) {
+          cache = make_unique<CompiledConfigCache>(FLAGS_config_cache_dir);
+          newState = cache->loadState(*target, *state);
+          if (newState) {
+            XLOG(INFO) << "Loaded config state from " << FLAGS_config_cache_dir;
+          }
+        }
+        if (!newState) {
+          boot_trace::Span span("applyThriftConfig");
+          newState = applyThriftConfig(
+              state,
+              &newConfig,
+              getPlatform(),
+              isStandaloneRibEnabled() ? rib() : nullptr,
+              &curConfig_);
+          if (newState && cache) {
+            try {
+              cache->storeState(*target, *state, *newState);
+            } catch (const std::exception& ex) {
+              XLOG(WARNING) << "Failed to cache config state: "
+                            << folly::exceptionStr(ex);
+            }
+          }
+        }
 
         if (!newState) {
           // if config is not updated, the new state will return null
@@ -1584,6 +2435,46 @@ std::shared_ptr<Route<AddressT>> SwSwitch::longestMatch(
   }
 }
 
+template <typename AddressT>
+std::shared_ptr<Route<AddressT>> SwSwitch::cachedLongestMatch(
+    const std::shared_ptr<SwitchState>& state,
+    const AddressT& address,
+    RouterID vrf) {
+  static thread_local RouteLookupCache<AddressT> cache;
+  std::shared_ptr<Route<AddressT>> route;
+  if (cache.lookup(state, vrf, address, &route)) {
+    stats()->routeLookupCacheHit();
+    return route;
+  }
+  stats()->routeLookupCacheMiss();
+  route = longestMatch(state, address, vrf);
+  cache.insert(state, vrf, address, route);
+  return route;
+}
+
+template <typename AddressT>
+std::vector<std::shared_ptr<Route<AddressT>>> SwSwitch::longestMatchBatch(
+    std::shared_ptr<SwitchState> state,
+    folly::Range<const AddressT*> addresses,
+    RouterID vrf) {
+  if (isStandaloneRibEnabled()) {
+    auto fibContainer = state->getFibs()->getFibContainer(vrf);
+
+    return fibContainer->getFib<AddressT>()->longestMatchBatch(addresses);
+  } else {
+    // The legacy RIB keeps a radix tree, lookups are cheap one at a time
+    auto routeTable = state->getRouteTables()->getRouteTable(vrf);
+    auto rib = routeTable->getRib<AddressT>();
+
+    std::vector<std::shared_ptr<Route<AddressT>>> matches;
+    matches.reserve(addresses.size());
+    for (const auto& address : addresses) {
+      matches.push_back(rib->longestMatch(address));
+    }
+    return matches;
+  }
+}
+
 template std::shared_ptr<Route<folly::IPAddressV4>> SwSwitch::longestMatch(
     std::shared_ptr<SwitchState> state,
     const folly::IPAddressV4& address,
@@ -1593,5 +2484,27 @@ template std::shared_ptr<Route<folly::IPAddressV6>> SwSwitch::longestMatch(
     const folly::IPAddressV6& address,
     RouterID vrf);
 
+template std::shared_ptr<Route<folly::IPAddressV4>>
+SwSwitch::cachedLongestMatch(
+    const std::shared_ptr<SwitchState>& state,
+    const folly::IPAddressV4& address,
+    RouterID vrf);
+template std::shared_ptr<Route<folly::IPAddressV6>>
+SwSwitch::cachedLongestMatch(
+    const std::shared_ptr<SwitchState>& state,
+    const folly::IPAddressV6& address,
+    RouterID vrf);
+
+template std::vector<std::shared_ptr<Route<folly::IPAddressV4>>>
+SwSwitch::longestMatchBatch(
+    std::shared_ptr<SwitchState> state,
+    folly::Range<const folly::IPAddressV4*> addresses,
+    RouterID vrf);
+template std::vector<std::shared_ptr<Route<folly::IPAddressV6>>>
+SwSwitch::longestMatchBatch(
+    std::shared_ptr<SwitchState> state,
+    folly::Range<const folly::IPAddressV6*> addresses,
+    RouterID vrf);
+
 } // namespace fboss
 } // namespace facebook
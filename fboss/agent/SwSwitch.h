@@ -20,16 +20,22 @@
 #include "fboss/agent/rib/RoutingInformationBase.h"
 
 #include <folly/SpinLock.h>
+#include <folly/concurrency/AtomicSharedPtr.h>
+#include <folly/IPAddress.h>
 #include <folly/IntrusiveList.h>
 #include <folly/Range.h>
 #include <folly/ThreadLocal.h>
 #include <folly/io/async/EventBase.h>
 #include <folly/Optional.h>
+#include <folly/dynamic.h>
 
+#include <array>
 #include <atomic>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <thread>
+#include <vector>
 
 namespace facebook { namespace fboss {
 
@@ -37,22 +43,32 @@ class ArpHandler;
 class ChannelCloser;
 class IPv4Handler;
 class IPv6Handler;
+class BfdManager;
 class LinkAggregationManager;
+class MicroBfdManager;
 class LldpManager;
+class NeighborHitScanner;
 class PcapPushSubscriberAsyncClient;
+class PcapShmRing;
 class PktCaptureManager;
 class Platform;
 class Port;
 class PortDescriptor;
+class PortInfoCache;
 class PortStats;
 class PortUpdateHandler;
 class RxPacket;
+class RxPacketDispatcher;
 class SwitchState;
 class SwitchStats;
 class StateDelta;
 class NeighborUpdater;
+class PendingPacketQueue;
 class RouteUpdateLogger;
+class RxAdmissionControl;
+class RxCpuAccounting;
 class StateObserver;
+class StateUpdateJournal;
 class TunManager;
 class MirrorManager;
 
@@ -175,6 +191,9 @@ class SwSwitch : public HwSwitch::Callback {
    * in which case the caller may now have an out-of-date copy of the state.
    * See the comments in SwitchState.h for more details about the copy-on-write
    * semantics of SwitchState.
+   *
+   * This does not take any lock, so it is cheap to call from hot paths such
+   * as packet processing.
    */
   std::shared_ptr<SwitchState> getState() const {
     return getDesiredState();
@@ -215,10 +234,14 @@ class SwSwitch : public HwSwitch::Callback {
    * send a single update notification to the HwSwitch and other update
    * subscribers.  Therefore the StateUpdateFn may be called with an
    * unpublished SwitchState in some cases.
+   *
+   * Updates are applied highest priority class first, and are only batched
+   * with other updates of the same class.  See StateUpdate::Priority.
    */
   void updateState(
       folly::StringPiece name,
-      StateUpdateFn fn);
+      StateUpdateFn fn,
+      StateUpdate::Priority priority = StateUpdate::Priority::CONFIG);
 
   /**
    * Schedule an update to the switch state.
@@ -232,7 +255,10 @@ class SwSwitch : public HwSwitch::Callback {
    * but can be used when there is an update that MUST be seen by the hw
    * implementation, even if the inverse update is immediately applied.
    */
-  void updateStateNoCoalescing(folly::StringPiece name, StateUpdateFn fn);
+  void updateStateNoCoalescing(
+      folly::StringPiece name,
+      StateUpdateFn fn,
+      StateUpdate::Priority priority = StateUpdate::Priority::CONFIG);
 
   /*
    * A version of updateState() that doesn't return until the update has been
@@ -248,7 +274,10 @@ class SwSwitch : public HwSwitch::Callback {
    * thread, and would simply block the calling thread until the operation
    * completes.
    */
-  void updateStateBlocking(folly::StringPiece name, StateUpdateFn fn);
+  void updateStateBlocking(
+      folly::StringPiece name,
+      StateUpdateFn fn,
+      StateUpdate::Priority priority = StateUpdate::Priority::CONFIG);
 
   /**
    * Apply config from the config file (specified in 'config' flag).
@@ -268,8 +297,30 @@ class SwSwitch : public HwSwitch::Callback {
    * count on this always being called from the update thread.
    */
   void registerStateObserver(StateObserver* observer, const std::string name);
+
+  /*
+   * Registers an observer that is notified on evb rather than on the update
+   * thread, so a slow observer doesn't delay the next state update.  Deltas
+   * are delivered in order.
+   *
+   * At most maxPendingDeltas deltas may be queued for the observer.  Past
+   * that the update thread waits for the observer to catch up, so the
+   * observer must never block on a state update from evb.
+   */
+  void registerAsyncStateObserver(
+      StateObserver* observer,
+      const std::string& name,
+      folly::EventBase* evb,
+      uint32_t maxPendingDeltas = kDefaultMaxPendingStateDeltas);
+
+  /*
+   * For async observers this also waits for any delivery already running on
+   * the observer's EventBase, and drops deliveries that have not started yet.
+   */
   void unregisterStateObserver(StateObserver* observer);
 
+  static constexpr uint32_t kDefaultMaxPendingStateDeltas = 16;
+
   /*
    * Signal to the switch that initial config is applied.
    * The switch may then use this to start certain functions
@@ -395,10 +446,12 @@ class SwSwitch : public HwSwitch::Callback {
   }
 
   /*
-   * Get the EventBase for Arp/Ndp Cache
+   * Get the EventBase for the Arp/Ndp caches of a vlan. Vlans are spread
+   * over a pool of --neighbor_cache_threads threads.
    */
-  folly::EventBase* getNeighborCacheEvb() {
-    return &neighborCacheEventBase_;
+  folly::EventBase* getNeighborCacheEvb(VlanID vlan) {
+    auto shard = static_cast<size_t>(vlan) % neighborCacheEventBases_.size();
+    return neighborCacheEventBases_[shard].get();
   }
 
   /**
@@ -413,6 +466,8 @@ class SwSwitch : public HwSwitch::Callback {
   // HwSwitch::Callback methods
   void packetReceived(std::unique_ptr<RxPacket> pkt) noexcept override;
   void linkStateChanged(PortID port, bool up) override;
+  void linkStatesChanged(
+      const std::vector<std::pair<PortID, bool>>& changes) override;
   void exitFatal() const noexcept override;
 
   /*
@@ -521,6 +576,21 @@ class SwSwitch : public HwSwitch::Callback {
     return nUpdater_.get();
   }
 
+  /**
+   * Get the PendingPacketQueue object, which holds packets waiting for their
+   * next hop to resolve.
+   */
+  PendingPacketQueue* getPendingPacketQueue() {
+    return pendingPackets_.get();
+  }
+
+  /*
+   * CPU time spent handling trapped packets over the last minute.
+   */
+  const RxCpuAccounting* getRxCpuAccounting() const {
+    return rxCpuAccounting_.get();
+  }
+
   /*
    * Get the PktCaptureManager object.
    */
@@ -546,6 +616,21 @@ class SwSwitch : public HwSwitch::Callback {
     return lagManager_.get();
   }
 
+  MicroBfdManager* getMicroBfdManager() {
+    return microBfdManager_.get();
+  }
+
+  BfdManager* getBfdManager() {
+    return bfdManager_.get();
+  }
+
+  /*
+   * Get the PortInfoCache object, which serves getAllPortInfo()
+   */
+  PortInfoCache* getPortInfoCache() {
+    return portInfoCache_.get();
+  }
+
   rib::RoutingInformationBase* rib() {
     return rib_.get();
   }
@@ -565,6 +650,14 @@ class SwSwitch : public HwSwitch::Callback {
    */
   void gracefulExit();
 
+  /*
+   * Convert the applied state to the form gracefulExit() saves for warm
+   * boot, if it changed since the last checkpoint. gracefulExit() reuses the
+   * checkpoint when the state has not changed again since, which takes most
+   * of the serialization off the shutdown path.
+   */
+  void checkpointWarmBootState();
+
   /*
    * Done with programming.
    * This is primarily used to signal to warm boot code
@@ -589,14 +682,44 @@ class SwSwitch : public HwSwitch::Callback {
    * times will overwrite the current listener.
    */
   void registerNeighborListener(
-      std::function<void(const std::vector<std::string>& added,
-                         const std::vector<std::string>& deleted)> callback);
+      std::function<void(const std::vector<folly::IPAddress>& added,
+                         const std::vector<folly::IPAddress>& deleted)>
+          callback);
+
+  void invokeNeighborListener(const std::vector<folly::IPAddress>& added,
+                               const std::vector<folly::IPAddress>& deleted);
 
-  void invokeNeighborListener(const std::vector<std::string>& added,
-                               const std::vector<std::string>& deleted);
+  /*
+   * Register a function to receive the hardware stats after every stats
+   * update, both in full and with only the ports that changed since the
+   * previous update.  Only one stats listener is supported, and calling this
+   * multiple times will overwrite the current listener.
+   */
+  using StatsListener = std::function<void(
+      std::shared_ptr<const HwStatsUpdate> full,
+      std::shared_ptr<const HwStatsUpdate> delta)>;
+  void registerStatsListener(StatsListener callback);
+
+  /*
+   * Register a function to receive the status of ports whose status changed,
+   * whenever a state update changes them.  Only one port status listener is
+   * supported, and calling this multiple times will overwrite the current
+   * listener.
+   */
+  using PortStatusListener =
+      std::function<void(std::map<int32_t, PortStatus> changed)>;
+  void registerPortStatusListener(PortStatusListener callback);
+
+  /*
+   * Send the status of these ports, as of the state they are from, to the
+   * port status listener if there is one.
+   */
+  void publishPortStatus(const std::vector<std::shared_ptr<Port>>& ports);
 
   /*
    * Returns true if the arp/ndp entry for the passed in ip has been hit.
+   * Answered from the last --neighbor_hit_scan_interval_s scan of the host
+   * table if there is one.
    */
   bool getAndClearNeighborHit(RouterID vrf, folly::IPAddress ip);
 
@@ -608,8 +731,7 @@ class SwSwitch : public HwSwitch::Callback {
    * to h/w
    */
   std::shared_ptr<SwitchState> getAppliedState() const {
-    folly::SpinLockGuard guard(stateLock_);
-    return appliedStateDontUseDirectly_;
+    return statesDontUseDirectly_.load(std::memory_order_acquire)->applied;
   }
 
   /*
@@ -631,8 +753,7 @@ class SwSwitch : public HwSwitch::Callback {
    *
    */
   std::shared_ptr<SwitchState> getDesiredState() const {
-    folly::SpinLockGuard guard(stateLock_);
-    return desiredStateDontUseDirectly_;
+    return statesDontUseDirectly_.load(std::memory_order_acquire)->desired;
   }
 
   void publishRxPacket(RxPacket* packet, uint16_t ethertype);
@@ -650,6 +771,27 @@ class SwSwitch : public HwSwitch::Callback {
       const AddressT& address,
       RouterID vrf);
 
+  /*
+   * longestMatch() through a per-thread RouteLookupCache, for the rx
+   * handlers, which look the same few destinations up over and over.
+   */
+  template <typename AddressT>
+  std::shared_ptr<Route<AddressT>> cachedLongestMatch(
+      const std::shared_ptr<SwitchState>& state,
+      const AddressT& address,
+      RouterID vrf);
+
+  /*
+   * Longest match for each of a batch of addresses, cheaper than calling
+   * longestMatch() in a loop. The i'th result is the match for
+   * addresses[i], or null.
+   */
+  template <typename AddressT>
+  std::vector<std::shared_ptr<Route<AddressT>>> longestMatchBatch(
+      std::shared_ptr<SwitchState> state,
+      folly::Range<const AddressT*> addresses,
+      RouterID vrf);
+
  private:
   void queueStateUpdateForGettingHwInSync(
       folly::StringPiece name,
@@ -664,11 +806,19 @@ class SwSwitch : public HwSwitch::Callback {
 
   std::pair<std::shared_ptr<SwitchState>, std::shared_ptr<SwitchState>>
   getStates() const {
-    folly::SpinLockGuard guard(stateLock_);
-    return std::make_pair(
-        appliedStateDontUseDirectly_, desiredStateDontUseDirectly_);
+    auto states = statesDontUseDirectly_.load(std::memory_order_acquire);
+    return std::make_pair(states->applied, states->desired);
   }
 
+  /*
+   * Journal a batch of state updates handed to the hardware together, with
+   * the time it took.
+   */
+  void journalStateUpdate(
+      const std::vector<std::string>& names,
+      const StateDelta& delta,
+      std::chrono::microseconds applyTime);
+
   /*
    * Update the current states.
    */
@@ -676,14 +826,38 @@ class SwSwitch : public HwSwitch::Callback {
       std::shared_ptr<SwitchState> newAppliedState,
       std::shared_ptr<SwitchState> newDesiredState);
 
+  /*
+   * Publish a new StateSnapshot. A null newAppliedState keeps the current
+   * applied state.
+   */
+  void publishStates(
+      std::shared_ptr<SwitchState> newAppliedState,
+      std::shared_ptr<SwitchState> newDesiredState);
+
   void setDesiredState(std::shared_ptr<SwitchState> newDesiredState);
 
+  /*
+   * Write the standalone RIB to the warm boot directory on exit, and load it
+   * back on a warm boot, so routes are there before clients reconnect.
+   * Restored routes of clients that do not sync within
+   * rib_stale_route_timeout_s are removed.
+   */
+  void saveRibSnapshot();
+  void restoreRibSnapshot();
+  void sweepStaleRibRoutes();
+  // With --rib_route_coalescing_ms, reschedules itself every window
+  void publishCoalescedRibRoutes();
+
   void publishInitTimes(std::string name, const float& time);
   void updatePortInfo();
   void updateRouteStats();
+  void updateStateMemoryStats();
+  void publishHwStats();
   void publishSwitchInfo(struct HwInitResult hwInitRet);
   void setSwitchRunState(SwitchRunState desiredState);
   SwitchStats* createSwitchStats();
+  // Handle pkt, counting rather than propagating any error
+  void receivePacket(std::unique_ptr<RxPacket> pkt) noexcept;
   void handlePacket(std::unique_ptr<RxPacket> pkt);
 
   static void handlePendingUpdatesHelper(SwSwitch* sw);
@@ -691,6 +865,32 @@ class SwSwitch : public HwSwitch::Callback {
   std::shared_ptr<SwitchState> applyUpdate(
       const std::shared_ptr<SwitchState>& oldState,
       const std::shared_ptr<SwitchState>& newState);
+  // Returns the state the hardware managed to apply
+  std::shared_ptr<SwitchState> programHw(const StateDelta& delta);
+  void queueHwSyncUpdate(
+      const std::shared_ptr<SwitchState>& newDesiredState,
+      const std::shared_ptr<SwitchState>& newAppliedState);
+  static void notifyUpdatesSucceeded(StateUpdateList* updates);
+
+  /*
+   * With --pipeline_state_updates the hardware is programmed on
+   * hwUpdateThread_, one batch at a time. The update thread computes the next
+   * batch on top of the desired state of the one being programmed; it waits
+   * behind it, and batches computed meanwhile are coalesced into it.
+   */
+  struct HwUpdateBatch {
+    std::shared_ptr<SwitchState> desired;
+    StateUpdateList updates;
+    std::vector<std::string> names;
+  };
+  void queueHwUpdate(std::unique_ptr<HwUpdateBatch> batch);
+  void startHwUpdate(std::unique_ptr<HwUpdateBatch> batch);
+  void hwUpdateDone(
+      std::unique_ptr<HwUpdateBatch> batch,
+      const std::shared_ptr<SwitchState>& oldAppliedState,
+      const std::shared_ptr<SwitchState>& newAppliedState,
+      std::chrono::steady_clock::time_point start,
+      std::chrono::microseconds hwTime);
 
   void startThreads();
   void stopThreads();
@@ -701,9 +901,14 @@ class SwSwitch : public HwSwitch::Callback {
    * Helpers to add/remove state observers. These should only be
    * called from the update thread, if the update thread is running.
    */
+  struct StateObserverInfo;
   bool stateObserverRegistered(StateObserver* observer);
-  void addStateObserver(StateObserver* observer, const std::string& name);
+  void addStateObserver(StateObserver* observer, StateObserverInfo info);
   void removeStateObserver(StateObserver* observer);
+  void notifyAsyncStateObserver(
+      StateObserver* observer,
+      const StateObserverInfo& info,
+      const StateDelta& delta);
 
   /*
    * File where switch state gets dumped on exit
@@ -745,10 +950,18 @@ class SwSwitch : public HwSwitch::Callback {
   std::unique_ptr<TunManager> tunMgr_;
 
   /*
-   * A list of pending state updates to be applied.
+   * Pending state updates to be applied, one list per
+   * StateUpdate::Priority class, plus the number of updates in each list.
+   *
+   * hwSyncUpdates_ holds the update that takes the applied state back to the
+   * desired state after a failed hardware update.  It must run before
+   * anything else, so it is applied at the front of whichever class runs
+   * next.
    */
   folly::SpinLock pendingUpdatesLock_;
-  StateUpdateList pendingUpdates_;
+  std::array<StateUpdateList, StateUpdate::kNumPriorities> pendingUpdates_;
+  std::array<size_t, StateUpdate::kNumPriorities> pendingUpdateCounts_{};
+  StateUpdateList hwSyncUpdates_;
 
   /*
    * The current switch state: modelled as two states:
@@ -762,9 +975,13 @@ class SwSwitch : public HwSwitch::Callback {
    * short amounts of time when state is being applied, but otherwise should be
    * the same.
    *
+   * Both are published together as one immutable StateSnapshot, so readers
+   * can load a consistent pair with a single atomic load and never take a
+   * lock.  Writers build a new snapshot and swap it in while holding
+   * stateLock_, which only serializes writers against each other.
+   *
    * BEWARE: You generally shouldn't access these states directly, even
-   * internally within SwSwitch private methods.  These should only be accessed
-   * while holding stateLock_.
+   * internally within SwSwitch private methods.
    *
    * You almost certainly should call getAppliedState() or getDesiredState() or
    * setStateInternal() instead of directly accessing these.
@@ -772,9 +989,13 @@ class SwSwitch : public HwSwitch::Callback {
    * This intentionally has an awkward name so people won't forget and try to
    * directly access this pointer.
    */
-  std::shared_ptr<SwitchState> appliedStateDontUseDirectly_;
-  std::shared_ptr<SwitchState> desiredStateDontUseDirectly_;
-  mutable folly::SpinLock stateLock_;
+  struct StateSnapshot {
+    std::shared_ptr<SwitchState> applied;
+    std::shared_ptr<SwitchState> desired;
+  };
+  folly::atomic_shared_ptr<const StateSnapshot> statesDontUseDirectly_{
+      std::make_shared<const StateSnapshot>()};
+  folly::SpinLock stateLock_;
 
   /*
    * A thread for performing various background tasks.
@@ -803,12 +1024,15 @@ class SwSwitch : public HwSwitch::Callback {
    */
   std::unique_ptr<std::thread> qsfpCacheThread_;
   folly::EventBase qsfpCacheEventBase_;
+  std::unique_ptr<ThreadHeartbeat> qsfpCacheThreadHeartbeat_;
 
   /*
    * A thread for processing SwitchState updates.
    */
   std::unique_ptr<std::thread> updateThread_;
   folly::EventBase updateEventBase_;
+  std::unique_ptr<std::thread> hwUpdateThread_;
+  folly::EventBase hwUpdateEventBase_;
   std::unique_ptr<ThreadHeartbeat> updThreadHeartbeat_;
 
   /*
@@ -819,45 +1043,107 @@ class SwSwitch : public HwSwitch::Callback {
   std::unique_ptr<ThreadHeartbeat> lacpThreadHeartbeat_;
 
   /*
-   * A thread dedicated to Arp and Ndp cache entry processing.
+   * Threads dedicated to Arp and Ndp cache entry processing. Each vlan's
+   * caches run on one of them, see getNeighborCacheEvb().
    */
-  std::unique_ptr<std::thread> neighborCacheThread_;
-  folly::EventBase neighborCacheEventBase_;
-  std::unique_ptr<ThreadHeartbeat> neighborCacheThreadHeartbeat_;
+  std::vector<std::unique_ptr<std::thread>> neighborCacheThreads_;
+  std::vector<std::unique_ptr<folly::EventBase>> neighborCacheEventBases_;
+  std::vector<std::unique_ptr<ThreadHeartbeat>> neighborCacheThreadHeartbeats_;
+
+  /*
+   * Worker threads handling trapped packets, when --rx_dispatch_queues is
+   * set. Otherwise packets are handled on the HwSwitch RX thread.
+   */
+  std::unique_ptr<RxPacketDispatcher> rxDispatcher_;
 
   /*
    * A callback for listening to neighbors coming and going.
    */
   std::mutex neighborListenerMutex_;
-  std::function<void(const std::vector<std::string>& added,
-                       const std::vector<std::string>& deleted)>
+  std::function<void(const std::vector<folly::IPAddress>& added,
+                       const std::vector<folly::IPAddress>& deleted)>
     neighborListener_{nullptr};
 
+  /*
+   * A callback for the hardware stats, and the port stats it was last
+   * given, which only the stats thread touches.
+   */
+  std::mutex statsListenerMutex_;
+  StatsListener statsListener_{nullptr};
+  std::map<int32_t, HwPortStats> lastPublishedPortStats_;
+
+  // When updateStateMemoryStats() last walked the state
+  std::chrono::steady_clock::time_point lastStateMemoryStats_;
+
+  std::mutex portStatusListenerMutex_;
+  PortStatusListener portStatusListener_{nullptr};
+
   /*
    * The list of classes to notify on a state update. This container should only
    * be accessed/modified from the update thread. This removes the need for
    * locking when we access the container during a state update.
    */
-  std::map<StateObserver*, std::string> stateObservers_;
+  struct AsyncStateObserverState {
+    // Deltas handed to the observer's EventBase that it hasn't finished yet
+    std::atomic<uint32_t> pendingDeltas{0};
+    // Cleared on unregister, so queued deliveries are dropped
+    std::atomic<bool> registered{true};
+  };
+  struct StateObserverInfo {
+    std::string name;
+    // Name of the histogram of stateUpdated() latency for this observer
+    std::string latencyHistogram;
+    // Null for observers notified on the update thread
+    folly::EventBase* evb{nullptr};
+    uint32_t maxPendingDeltas{0};
+    // Shared with in flight deliveries on evb
+    std::shared_ptr<AsyncStateObserverState> async;
+  };
+  std::map<StateObserver*, StateObserverInfo> stateObservers_;
 
   std::unique_ptr<ChannelCloser> closer_; // must be before pcapPusher_
   std::unique_ptr<PcapPushSubscriberAsyncClient> pcapPusher_;
   std::atomic<bool> distributionServiceReady_{false};
-
+  // Set while packets go to the distribution service over shared memory
+  // instead of pcapPusher_; accessed with std::atomic_load/store
+  std::shared_ptr<PcapShmRing> pcapRing_;
+
+  struct WarmBootCheckpoint {
+    // Not kept alive by the checkpoint
+    std::weak_ptr<SwitchState> state;
+    folly::dynamic switchState{nullptr};
+  };
+  std::mutex warmBootCheckpointLock_;
+  WarmBootCheckpoint warmBootCheckpoint_;
 
   std::unique_ptr<ArpHandler> arp_;
   std::unique_ptr<IPv4Handler> ipv4_;
   std::unique_ptr<IPv6Handler> ipv6_;
   std::unique_ptr<NeighborUpdater> nUpdater_;
+  std::unique_ptr<PendingPacketQueue> pendingPackets_;
+  std::unique_ptr<RxAdmissionControl> rxAdmission_;
+  std::unique_ptr<RxCpuAccounting> rxCpuAccounting_;
   std::unique_ptr<PktCaptureManager> pcapMgr_;
   std::unique_ptr<MirrorManager> mirrorManager_;
   std::unique_ptr<RouteUpdateLogger> routeUpdateLogger_;
+  // With --state_update_journal, written on the update thread
+  std::unique_ptr<StateUpdateJournal> stateUpdateJournal_;
+  // With --pipeline_state_updates, only accessed on the update thread.
+  // hwPipelineDesired_ is the desired state of the last batch queued for the
+  // hardware thread, null once it has programmed them all.
+  bool hwUpdateInFlight_{false};
+  std::unique_ptr<HwUpdateBatch> waitingHwUpdate_;
+  std::shared_ptr<SwitchState> hwPipelineDesired_;
   std::unique_ptr<LinkAggregationManager> lagManager_;
+  std::unique_ptr<MicroBfdManager> microBfdManager_;
+  std::unique_ptr<BfdManager> bfdManager_;
   std::unique_ptr<rib::RoutingInformationBase> rib_{nullptr};
 
   BootType bootType_{BootType::UNINITIALIZED};
   std::unique_ptr<LldpManager> lldpManager_;
+  std::unique_ptr<NeighborHitScanner> neighborHitScanner_;
   std::unique_ptr<PortUpdateHandler> portUpdateHandler_;
+  std::unique_ptr<PortInfoCache> portInfoCache_;
   SwitchFlags flags_{SwitchFlags::DEFAULT};
 };
 
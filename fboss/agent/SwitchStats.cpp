@@ -10,6 +10,7 @@
 #include "fboss/agent/SwitchStats.h"
 
 #include "fboss/agent/PortStats.h"
+#include <folly/Conv.h>
 #include <folly/Memory.h>
 
 using facebook::stats::SUM;
@@ -18,6 +19,13 @@ using facebook::stats::RATE;
 
 namespace facebook { namespace fboss {
 
+namespace {
+std::string rxQueueName(size_t queue) {
+  // queue 0 is the RxPacketDispatcher control queue
+  return queue == 0 ? "control" : folly::to<std::string>(queue);
+}
+}
+
 // set to empty string, we'll prepend prefix when fbagent collects counters
 std::string SwitchStats::kCounterPrefix = "";
 
@@ -31,6 +39,11 @@ SwitchStats::SwitchStats(ThreadLocalStatsMap* map)
       trapPktBogus_(map, kCounterPrefix + "trapped.bogus", SUM, RATE),
       trapPktErrors_(map, kCounterPrefix + "trapped.error", SUM, RATE),
       trapPktUnhandled_(map, kCounterPrefix + "trapped.unhandled", SUM, RATE),
+      trapPktAdmissionDrops_(
+          map,
+          kCounterPrefix + "trapped.admission_drops",
+          SUM,
+          RATE),
       trapPktToHost_(map, kCounterPrefix + "host.rx", SUM, RATE),
       trapPktToHostBytes_(map, kCounterPrefix + "host.rx.bytes", SUM, RATE),
       pktFromHost_(map, kCounterPrefix + "host.tx", SUM, RATE),
@@ -53,6 +66,23 @@ SwitchStats::SwitchStats(ThreadLocalStatsMap* map)
       ipv4NoArp_(map, kCounterPrefix + "ipv4.no_arp", SUM, RATE),
       ipv4TtlExceeded_(map, kCounterPrefix + "ipv4.ttl_exceeded", SUM, RATE),
       ipv6HopExceeded_(map, kCounterPrefix + "ipv6.hop_exceeded", SUM, RATE),
+      icmpRateLimited_(map, kCounterPrefix + "icmp.rate_limited", SUM, RATE),
+      pendingPktQueued_(
+          map,
+          kCounterPrefix + "pending_pkt.queued",
+          SUM,
+          RATE),
+      pendingPktFlushed_(
+          map,
+          kCounterPrefix + "pending_pkt.flushed",
+          SUM,
+          RATE),
+      neighborRequestSuppressed_(
+          map,
+          kCounterPrefix + "neighbor_request.suppressed",
+          SUM,
+          RATE),
+      neighborProbeSent_(map, kCounterPrefix + "neighbor_probe.tx", SUM, RATE),
       udpTooSmall_(map, kCounterPrefix + "udp.too_small", SUM, RATE),
       dhcpV4Pkt_(map, kCounterPrefix + "dhcpV4.pkt", SUM, RATE),
       dhcpV4BadPkt_(map, kCounterPrefix + "dhcpV4.bad_pkt", SUM, RATE),
@@ -79,8 +109,46 @@ SwitchStats::SwitchStats(ThreadLocalStatsMap* map)
           kCounterPrefix + "ip.dst_lookup_failure",
           SUM,
           RATE),
+      routeLookupCacheHits_(
+          map,
+          kCounterPrefix + "route_lookup_cache.hits",
+          SUM,
+          RATE),
+      routeLookupCacheMisses_(
+          map,
+          kCounterPrefix + "route_lookup_cache.misses",
+          SUM,
+          RATE),
       updateState_(map, kCounterPrefix + "state_update.us", 50000, 0, 1000000),
       routeUpdate_(map, kCounterPrefix + "route_update.us", 50, 0, 500),
+      routeBatchQueueDepth_(
+          map,
+          kCounterPrefix + "route_update.async.queue_depth",
+          1,
+          0,
+          100,
+          AVG,
+          50,
+          100),
+      routeBatchesCoalesced_(
+          map,
+          kCounterPrefix + "route_update.async.batches_coalesced",
+          1,
+          0,
+          100,
+          AVG,
+          50,
+          100),
+      ribRoutesHeld_(
+          map,
+          kCounterPrefix + "route_update.rib.held",
+          SUM,
+          RATE),
+      ribRoutesCoalesced_(
+          map,
+          kCounterPrefix + "route_update.rib.coalesced",
+          SUM,
+          RATE),
       bgHeartbeatDelay_(
           map,
           kCounterPrefix + "bg_heartbeat_delay.ms",
@@ -117,6 +185,15 @@ SwitchStats::SwitchStats(ThreadLocalStatsMap* map)
           AVG,
           50,
           100),
+      qsfpCacheHeartbeatDelay_(
+          map,
+          kCounterPrefix + "qsfp_cache_heartbeat_delay.ms",
+          100,
+          0,
+          20000,
+          AVG,
+          50,
+          100),
       neighborCacheHeartbeatDelay_(
           map,
           kCounterPrefix + "neighbor_cache_heartbeat_delay.ms",
@@ -162,6 +239,15 @@ SwitchStats::SwitchStats(ThreadLocalStatsMap* map)
           AVG,
           50,
           100),
+      qsfpCacheEventBacklog_(
+          map,
+          kCounterPrefix + "qsfp_cache_event_backlog",
+          1,
+          0,
+          200,
+          AVG,
+          50,
+          100),
       neighborCacheEventBacklog_(
           map,
           kCounterPrefix + "neighborCache_event_backlog",
@@ -171,6 +257,33 @@ SwitchStats::SwitchStats(ThreadLocalStatsMap* map)
           AVG,
           50,
           100),
+      tunPacketsPerWakeup_(
+          map,
+          kCounterPrefix + "tun.pkts_per_wakeup",
+          1,
+          0,
+          256,
+          AVG,
+          50,
+          100),
+      neighborUpdateBatchSize_(
+          map,
+          kCounterPrefix + "neighbor_update.batch_size",
+          10,
+          0,
+          2000,
+          AVG,
+          50,
+          100),
+      neighborResolutionLatency_(
+          map,
+          kCounterPrefix + "neighbor_resolution.us",
+          1000,
+          0,
+          100000,
+          AVG,
+          50,
+          100),
       linkStateChange_(map, kCounterPrefix + "link_state.flap", SUM),
       pcapDistFailure_(map, kCounterPrefix + "pcap_dist_failure.error"),
       updateStatsExceptions_(
@@ -182,13 +295,158 @@ SwitchStats::SwitchStats(ThreadLocalStatsMap* map)
           kCounterPrefix + "trapped.packet_too_big",
           SUM,
           RATE),
+      stateLockAcquired_(map, kCounterPrefix + "state_lock.acquired", SUM, RATE),
+      stateLockContended_(
+          map,
+          kCounterPrefix + "state_lock.contended",
+          SUM,
+          RATE),
       LldpRecvdPkt_(map, kCounterPrefix + "lldp.recvd", SUM, RATE),
       LldpBadPkt_(map, kCounterPrefix + "lldp.recv_bad", SUM, RATE),
       LldpValidateMisMatch_(
         map,
         kCounterPrefix + "lldp.validate_mismatch",
-        SUM, RATE)
-      {}
+        SUM, RATE) {
+  for (size_t i = 0; i < StateUpdate::kNumPriorities; ++i) {
+    stateUpdateClasses_[i] = std::make_unique<StateUpdateClassStats>(
+        map, static_cast<StateUpdate::Priority>(i));
+  }
+  map_ = map;
+}
+
+SwitchStats::StateUpdateClassStats::StateUpdateClassStats(
+    ThreadLocalStatsMap* map,
+    StateUpdate::Priority p)
+    : queueDepth(
+          map,
+          kCounterPrefix + "state_update." + StateUpdate::priorityName(p) +
+              ".queue_depth",
+          1,
+          0,
+          200,
+          AVG,
+          50,
+          100),
+      queueLatency(
+          map,
+          kCounterPrefix + "state_update." + StateUpdate::priorityName(p) +
+              ".queue_latency.us",
+          50000,
+          0,
+          1000000,
+          AVG,
+          50,
+          100) {}
+
+SwitchStats::RxQueueStats::RxQueueStats(
+    ThreadLocalStatsMap* map,
+    size_t queue)
+    : queueDepth(
+          map,
+          kCounterPrefix + "rx_queue." + rxQueueName(queue) + ".queue_depth",
+          10,
+          0,
+          10000,
+          AVG,
+          50,
+          100),
+      drops(
+          map,
+          kCounterPrefix + "rx_queue." + rxQueueName(queue) + ".drops",
+          SUM,
+          RATE) {}
+
+SwitchStats::RxQueueStats* SwitchStats::rxQueueStats(size_t queue) {
+  auto it = rxQueues_.find(queue);
+  if (it == rxQueues_.end()) {
+    it = rxQueues_.emplace(queue, std::make_unique<RxQueueStats>(map_, queue))
+             .first;
+  }
+  return it->second.get();
+}
+
+SwitchStats::VlanDhcpStats::VlanDhcpStats(
+    ThreadLocalStatsMap* map,
+    VlanID vlan)
+    : v4Relayed(
+          map,
+          folly::to<std::string>(
+              kCounterPrefix,
+              "vlan.",
+              static_cast<uint16_t>(vlan),
+              ".dhcpV4.relayed"),
+          SUM,
+          RATE),
+      v6Relayed(
+          map,
+          folly::to<std::string>(
+              kCounterPrefix,
+              "vlan.",
+              static_cast<uint16_t>(vlan),
+              ".dhcpV6.relayed"),
+          SUM,
+          RATE) {}
+
+SwitchStats::VlanDhcpStats* SwitchStats::vlanDhcpStats(VlanID vlan) {
+  auto it = vlanDhcp_.find(vlan);
+  if (it == vlanDhcp_.end()) {
+    it = vlanDhcp_.emplace(vlan, std::make_unique<VlanDhcpStats>(map_, vlan))
+             .first;
+  }
+  return it->second.get();
+}
+
+SwitchStats::TLTimeseries* SwitchStats::cpuQueueTrapped(int queue) {
+  auto it = cpuQueueTrapped_.find(queue);
+  if (it == cpuQueueTrapped_.end()) {
+    auto name = folly::to<std::string>(
+        kCounterPrefix, "cpu.queue", queue, ".trapped_pkts");
+    it = cpuQueueTrapped_
+             .emplace(
+                 queue,
+                 std::make_unique<TLTimeseries>(map_, name, SUM, RATE))
+             .first;
+  }
+  return it->second.get();
+}
+
+SwitchStats::TLHistogram* SwitchStats::rxHandlerCpuHistogram(
+    RxCpuAccounting::Handler handler) {
+  auto& hist = rxHandlerCpuTime_[static_cast<size_t>(handler)];
+  if (!hist) {
+    hist = std::make_unique<TLHistogram>(
+        map_,
+        folly::to<std::string>(
+            kCounterPrefix,
+            "rx_handler.",
+            RxCpuAccounting::handlerName(handler),
+            ".cpu_time.ns"),
+        1000,
+        0,
+        100000,
+        AVG,
+        50,
+        99);
+  }
+  return hist.get();
+}
+
+SwitchStats::TLTimeseries* SwitchStats::rxHandlerDtlbTimeseries(
+    RxCpuAccounting::Handler handler) {
+  auto& ts = rxHandlerDtlbMisses_[static_cast<size_t>(handler)];
+  if (!ts) {
+    ts = std::make_unique<TLTimeseries>(
+        map_,
+        folly::to<std::string>(
+            kCounterPrefix,
+            "rx_handler.",
+            RxCpuAccounting::handlerName(handler),
+            ".dtlb_misses"),
+        SUM,
+        RATE);
+  }
+  return ts.get();
+}
 
 PortStats* FOLLY_NULLABLE SwitchStats::port(PortID portID) {
   auto it = ports_.find(portID);
@@ -11,10 +11,13 @@
 
 #include <boost/container/flat_map.hpp>
 #include <boost/noncopyable.hpp>
+#include <array>
 #include <chrono>
 #include "common/stats/ThreadCachedServiceData.h"
 #include "fboss/agent/AggregatePortStats.h"
 #include "fboss/agent/PortStats.h"
+#include "fboss/agent/RxCpuAccounting.h"
+#include "fboss/agent/state/StateUpdate.h"
 #include "fboss/agent/types.h"
 
 namespace facebook { namespace fboss {
@@ -160,6 +163,23 @@ class SwitchStats : public boost::noncopyable {
     ipv6HopExceeded_.addValue(1);
   }
 
+  void icmpRateLimited() {
+    icmpRateLimited_.addValue(1);
+  }
+
+  void pendingPktQueued() {
+    pendingPktQueued_.addValue(1);
+  }
+  void pendingPktFlushed() {
+    pendingPktFlushed_.addValue(1);
+  }
+  void neighborRequestSuppressed() {
+    neighborRequestSuppressed_.addValue(1);
+  }
+  void neighborProbeSent() {
+    neighborProbeSent_.addValue(1);
+  }
+
   void udpTooSmall() {
     udpTooSmall_.addValue(1);
   }
@@ -222,6 +242,13 @@ class SwitchStats : public boost::noncopyable {
     dstLookupFailure_.addValue(1);
   }
 
+  void routeLookupCacheHit() {
+    routeLookupCacheHits_.addValue(1);
+  }
+  void routeLookupCacheMiss() {
+    routeLookupCacheMisses_.addValue(1);
+  }
+
   void stateUpdate(std::chrono::microseconds us) {
     updateState_.addValue(us.count());
   }
@@ -234,6 +261,21 @@ class SwitchStats : public boost::noncopyable {
     routeUpdate_.addRepeatedValue(us.count() / routes, routes);
   }
 
+  // Route batches queued by async_tm_addUnicastRoutes()
+  void routeBatchQueued(size_t queueDepth) {
+    routeBatchQueueDepth_.addValue(queueDepth);
+  }
+  void routeBatchesCoalesced(size_t batches) {
+    routeBatchesCoalesced_.addValue(batches);
+  }
+
+  // Route changes the RIB held back from the FIB, and those it folded into
+  // one already held back
+  void ribRoutesCoalesced(uint64_t held, uint64_t coalesced) {
+    ribRoutesHeld_.addValue(held);
+    ribRoutesCoalesced_.addValue(coalesced);
+  }
+
   void bgHeartbeatDelay(int delay) {
     bgHeartbeatDelay_.addValue(delay);
   }
@@ -250,6 +292,10 @@ class SwitchStats : public boost::noncopyable {
     lacpHeartbeatDelay_.addValue(value);
   }
 
+  void qsfpCacheHeartbeatDelay(int value) {
+    qsfpCacheHeartbeatDelay_.addValue(value);
+  }
+
   void neighborCacheHeartbeatDelay(int value) {
     neighborCacheHeartbeatDelay_.addValue(value);
   }
@@ -266,6 +312,10 @@ class SwitchStats : public boost::noncopyable {
     lacpEventBacklog_.addValue(value);
   }
 
+  void qsfpCacheEventBacklog(int value) {
+    qsfpCacheEventBacklog_.addValue(value);
+  }
+
   void packetTxEventBacklog(int value) {
     packetTxEventBacklog_.addValue(value);
   }
@@ -274,6 +324,18 @@ class SwitchStats : public boost::noncopyable {
     neighborCacheEventBacklog_.addValue(value);
   }
 
+  void tunPacketsPerWakeup(int packets) {
+    tunPacketsPerWakeup_.addValue(packets);
+  }
+
+  void neighborUpdateBatch(size_t changes) {
+    neighborUpdateBatchSize_.addValue(changes);
+  }
+
+  void neighborResolutionLatency(std::chrono::microseconds us) {
+    neighborResolutionLatency_.addValue(us.count());
+  }
+
   void linkStateChange() {
     linkStateChange_.addValue(1);
   }
@@ -290,6 +352,73 @@ class SwitchStats : public boost::noncopyable {
     trapPktTooBig_.addValue(1);
   }
 
+  void stateUpdateQueued(StateUpdate::Priority priority, size_t queueDepth) {
+    stateUpdateClass(priority)->queueDepth.addValue(queueDepth);
+  }
+  void stateUpdateDequeued(
+      StateUpdate::Priority priority,
+      std::chrono::microseconds queueLatency) {
+    stateUpdateClass(priority)->queueLatency.addValue(queueLatency.count());
+  }
+
+  /*
+   * Stats for the RxPacketDispatcher queues, queue 0 is the control queue.
+   */
+  void rxQueueDepth(size_t queue, size_t depth) {
+    rxQueueStats(queue)->queueDepth.addValue(depth);
+  }
+  void rxQueueDrop(size_t queue) {
+    rxQueueStats(queue)->drops.addValue(1);
+    trapPktDrops_.addValue(1);
+  }
+  void rxAdmissionDrop() {
+    trapPktAdmissionDrops_.addValue(1);
+    trapPktDrops_.addValue(1);
+  }
+
+  /*
+   * Time SwSwitch::handlePacket() spent on a trapped packet, by the handler
+   * it went to.
+   */
+  void rxHandlerCpuTime(
+      RxCpuAccounting::Handler handler,
+      std::chrono::nanoseconds cpuTime) {
+    rxHandlerCpuHistogram(handler)->addValue(cpuTime.count());
+  }
+
+  /*
+   * Data TLB misses taken handling a trapped packet, with --rx_tlb_counters.
+   */
+  void rxHandlerDtlbMisses(RxCpuAccounting::Handler handler, uint64_t misses) {
+    rxHandlerDtlbTimeseries(handler)->addValue(misses);
+  }
+
+  /*
+   * Packets that reached the agent from a CPU cos queue. These line up with
+   * the hardware's cpu.queue<n> counters, so the two show how much of what
+   * each queue punts the agent gets to handle.
+   */
+  void trappedPktOnCpuQueue(int queue) {
+    cpuQueueTrapped(queue)->addValue(1);
+  }
+
+  /*
+   * DHCP messages relayed for clients on a vlan, in both directions
+   */
+  void dhcpV4Relayed(VlanID vlan) {
+    vlanDhcpStats(vlan)->v4Relayed.addValue(1);
+  }
+  void dhcpV6Relayed(VlanID vlan) {
+    vlanDhcpStats(vlan)->v6Relayed.addValue(1);
+  }
+
+  void stateLockAcquired() {
+    stateLockAcquired_.addValue(1);
+  }
+  void stateLockContended() {
+    stateLockContended_.addValue(1);
+  }
+
   void LldpRecvdPkt() {
     LldpRecvdPkt_.addValue(1);
   }
@@ -313,6 +442,22 @@ class SwitchStats : public boost::noncopyable {
 
   explicit SwitchStats(ThreadLocalStatsMap *map);
 
+  /*
+   * Queueing stats for one StateUpdate priority class.
+   */
+  struct StateUpdateClassStats {
+    StateUpdateClassStats(ThreadLocalStatsMap* map, StateUpdate::Priority p);
+
+    // Number of pending updates in the class, sampled on each enqueue
+    TLHistogram queueDepth;
+    // Time from enqueue until the update thread picked the update up (us)
+    TLHistogram queueLatency;
+  };
+
+  StateUpdateClassStats* stateUpdateClass(StateUpdate::Priority priority) {
+    return stateUpdateClasses_[static_cast<size_t>(priority)].get();
+  }
+
   // Total number of trapped packets
   TLTimeseries trapPkts_;
   // Number of trapped packets that were intentionally dropped.
@@ -324,6 +469,8 @@ class SwitchStats : public boost::noncopyable {
   TLTimeseries trapPktErrors_;
   // Trapped packets that the controller didn't know how to handle.
   TLTimeseries trapPktUnhandled_;
+  // Trapped packets over their port's RxAdmissionControl rate
+  TLTimeseries trapPktAdmissionDrops_;
   // Trapped packets forwarded to host
   TLTimeseries trapPktToHost_;
   // Trapped packets forwarded to host in bytes
@@ -372,6 +519,19 @@ class SwitchStats : public boost::noncopyable {
   // IPv6 hop count exceeded
   TLTimeseries ipv6HopExceeded_;
 
+  // ICMP errors not sent, as their source was over its ICMP rate limit
+  TLTimeseries icmpRateLimited_;
+
+  // Packets held until their next hop resolves
+  TLTimeseries pendingPktQueued_;
+  // Held packets sent out once their next hop resolved
+  TLTimeseries pendingPktFlushed_;
+  // ARP requests and neighbor solicitations not sent, as the neighbor cache
+  // was already probing for the target
+  TLTimeseries neighborRequestSuppressed_;
+  // Probes sent by neighbor cache entries that are INCOMPLETE or PROBE
+  TLTimeseries neighborProbeSent_;
+
   // UDP packets dropped due to smaller packet size
   TLTimeseries udpTooSmall_;
 
@@ -406,6 +566,10 @@ class SwitchStats : public boost::noncopyable {
   TLTimeseries dstLookupFailureV6_;
   TLTimeseries dstLookupFailure_;
 
+  // Rx handler route lookups answered by, or missing, the RouteLookupCache
+  TLTimeseries routeLookupCacheHits_;
+  TLTimeseries routeLookupCacheMisses_;
+
   /**
    * Histogram for time used for SwSwitch::updateState() (in ms)
    */
@@ -416,6 +580,20 @@ class SwitchStats : public boost::noncopyable {
    */
   TLHistogram routeUpdate_;
 
+  /**
+   * Async route batches waiting when one is queued, and how many batches
+   * went into each route update
+   */
+  TLHistogram routeBatchQueueDepth_;
+  TLHistogram routeBatchesCoalesced_;
+
+  /**
+   * Route changes held back by RIB flap coalescing, and the hardware updates
+   * it saved by folding changes into held back ones
+   */
+  TLTimeseries ribRoutesHeld_;
+  TLTimeseries ribRoutesCoalesced_;
+
   /**
    * Background thread heartbeat delay (ms)
    */
@@ -433,6 +611,10 @@ class SwitchStats : public boost::noncopyable {
    * LACP thread heartbeat delay in milliseconds
    */
   TLHistogram lacpHeartbeatDelay_;
+  /**
+   * QsfpCache thread heartbeat delay in milliseconds
+   */
+  TLHistogram qsfpCacheHeartbeatDelay_;
   /**
    * Arp Cache thread heartbeat delay in milliseconds
    */
@@ -453,11 +635,30 @@ class SwitchStats : public boost::noncopyable {
   TLHistogram packetTxEventBacklog_;
 
   TLHistogram lacpEventBacklog_;
+  /**
+   * Number of events queued in QsfpCache thread
+   */
+  TLHistogram qsfpCacheEventBacklog_;
   /**
    * Number of events queued in fboss Arp Cache thread
    */
   TLHistogram neighborCacheEventBacklog_;
 
+  /**
+   * Number of packets read from a tun interface per wakeup
+   */
+  TLHistogram tunPacketsPerWakeup_;
+
+  /**
+   * Number of Arp/Ndp changes written by one neighbor table state update
+   */
+  TLHistogram neighborUpdateBatchSize_;
+  /**
+   * Time from an Arp/Ndp entry resolving until it is written to the
+   * SwitchState (in microsecond)
+   */
+  TLHistogram neighborResolutionLatency_;
+
   /**
    * Link state up/down change count
    */
@@ -477,6 +678,58 @@ class SwitchStats : public boost::noncopyable {
   // Number of packet too big ICMPv6 triggered
   TLTimeseries trapPktTooBig_;
 
+  // Number of times the SwSwitch state lock was taken to publish new states.
+  // Readers of the state never take it.
+  TLTimeseries stateLockAcquired_;
+  // Number of those acquisitions that had to wait for another writer.
+  TLTimeseries stateLockContended_;
+
+  /*
+   * Stats for one RxPacketDispatcher queue.
+   */
+  struct RxQueueStats {
+    RxQueueStats(ThreadLocalStatsMap* map, size_t queue);
+
+    // Number of packets waiting in the queue, sampled on each enqueue
+    TLHistogram queueDepth;
+    // Packets dropped because the queue was full
+    TLTimeseries drops;
+  };
+  RxQueueStats* rxQueueStats(size_t queue);
+
+  /*
+   * DHCP relay stats for one vlan.
+   */
+  struct VlanDhcpStats {
+    VlanDhcpStats(ThreadLocalStatsMap* map, VlanID vlan);
+
+    TLTimeseries v4Relayed;
+    TLTimeseries v6Relayed;
+  };
+  VlanDhcpStats* vlanDhcpStats(VlanID vlan);
+
+  TLTimeseries* cpuQueueTrapped(int queue);
+  TLHistogram* rxHandlerCpuHistogram(RxCpuAccounting::Handler handler);
+  TLTimeseries* rxHandlerDtlbTimeseries(RxCpuAccounting::Handler handler);
+
+  std::array<
+      std::unique_ptr<StateUpdateClassStats>,
+      StateUpdate::kNumPriorities>
+      stateUpdateClasses_;
+
+  // Created on first use, as the number of queues is set at startup
+  ThreadLocalStatsMap* map_{nullptr};
+  boost::container::flat_map<size_t, std::unique_ptr<RxQueueStats>>
+      rxQueues_;
+  boost::container::flat_map<VlanID, std::unique_ptr<VlanDhcpStats>>
+      vlanDhcp_;
+  boost::container::flat_map<int, std::unique_ptr<TLTimeseries>>
+      cpuQueueTrapped_;
+  std::array<std::unique_ptr<TLHistogram>, RxCpuAccounting::kNumHandlers>
+      rxHandlerCpuTime_;
+  std::array<std::unique_ptr<TLTimeseries>, RxCpuAccounting::kNumHandlers>
+      rxHandlerDtlbMisses_;
+
   // Number of LLDP packets.
   TLTimeseries LldpRecvdPkt_;
   // Number of bad LLDP packets.
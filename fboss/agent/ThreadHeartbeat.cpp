@@ -9,12 +9,134 @@
  */
 // Copyright 2014-present Facebook. All Rights Reserved.
 #include "fboss/agent/ThreadHeartbeat.h"
+
+#include "common/stats/ServiceData.h"
+
+#include <folly/Conv.h>
+#include <folly/Synchronized.h>
 #include <folly/logging/xlog.h>
+#include <gflags/gflags.h>
+
+#include <algorithm>
+#include <deque>
+
+DEFINE_int32(
+    event_loop_sample_rate,
+    1,
+    "Sample one in this many EventBase loops into the event loop latency "
+    "histograms; 0 turns loop sampling off");
+DEFINE_int32(
+    slow_event_loop_ms,
+    100,
+    "Sampled EventBase loops busy for longer than this are remembered for "
+    "getSlowEventLoops()");
 
 using namespace std::chrono;
 
+namespace {
+constexpr size_t kMaxSlowLoops = 128;
+
+// The work most recently named on this thread
+thread_local std::string loopSource;
+
+folly::Synchronized<std::deque<facebook::fboss::EventLoopSample>>&
+slowLoops() {
+  // Leaked so heartbeats destroyed late at exit can still use it
+  static auto* loops =
+      new folly::Synchronized<std::deque<facebook::fboss::EventLoopSample>>();
+  return *loops;
+}
+} // namespace
+
 namespace facebook { namespace fboss {
 
+class ThreadHeartbeat::LoopObserver : public folly::EventBaseObserver {
+ public:
+  explicit LoopObserver(const std::string& threadName)
+      : threadName_(threadName),
+        histogram_(folly::to<std::string>(
+            "event_loop.", threadName, ".busy.us")) {
+    fbData->addHistogram(histogram_, 1000, 0, 1000000);
+    fbData->exportHistogramPercentile(histogram_, 50, 99, 100);
+  }
+
+  uint32_t getSampleRate() const override {
+    // EventBase samples a loop once more than this many have gone unsampled
+    return std::max(FLAGS_event_loop_sample_rate, 1) - 1;
+  }
+
+  void loopSample(int64_t busyTime, int64_t /*idleTime*/) override {
+    fbData->addHistogramValue(histogram_, busyTime);
+    if (busyTime >= FLAGS_slow_event_loop_ms * 1000) {
+      EventLoopSample sample;
+      sample.threadName = threadName_;
+      sample.timestampMsecs = duration_cast<milliseconds>(
+                                  system_clock::now().time_since_epoch())
+                                  .count();
+      sample.busyUsecs = busyTime;
+      sample.source = loopSource;
+      auto loops = slowLoops().wlock();
+      if (loops->size() >= kMaxSlowLoops) {
+        loops->pop_front();
+      }
+      loops->push_back(std::move(sample));
+    }
+    loopSource.clear();
+  }
+
+ private:
+  const std::string threadName_;
+  const std::string histogram_;
+};
+
+ThreadHeartbeat::ThreadHeartbeat(
+    folly::EventBase* evb,
+    std::string threadName,
+    int intervalMsecs,
+    std::function<void(int, int)> heartbeatStatsFunc)
+    : AsyncTimeout(evb),
+      evb_(evb),
+      threadName_(threadName),
+      intervalMsecs_(intervalMsecs),
+      heartbeatStatsFunc_(heartbeatStatsFunc),
+      loopObserver_(std::make_shared<LoopObserver>(threadName_)) {
+  XLOG(DBG2) << "ThreadHeartbeat intervalMsecs:" << intervalMsecs_.count();
+  evb_->runInEventBaseThread([this]() {
+    if (FLAGS_event_loop_sample_rate > 0) {
+      evb_->setObserver(loopObserver_);
+    }
+    scheduleFirstHeartbeat();
+  });
+}
+
+ThreadHeartbeat::~ThreadHeartbeat() {
+  evb_->runImmediatelyOrRunInEventBaseThreadAndWait([this]() {
+    cancelTimeout();
+    if (evb_->getObserver() == loopObserver_) {
+      evb_->setObserver(nullptr);
+    }
+  });
+}
+
+void ThreadHeartbeat::setLoopSource(folly::StringPiece source) {
+  loopSource.assign(source.data(), source.size());
+}
+
+std::vector<EventLoopSample> ThreadHeartbeat::getSlowLoops() {
+  std::vector<EventLoopSample> loops;
+  {
+    auto locked = slowLoops().rlock();
+    loops.assign(locked->begin(), locked->end());
+  }
+  std::stable_sort(
+      loops.begin(),
+      loops.end(),
+      [](const EventLoopSample& a, const EventLoopSample& b) {
+        return a.busyUsecs > b.busyUsecs;
+      });
+  return loops;
+}
+
 void ThreadHeartbeat::timeoutExpired() noexcept {
   CHECK(evb_->inRunningEventBaseThread());
   auto now = steady_clock::now();
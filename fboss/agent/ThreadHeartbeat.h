@@ -9,10 +9,15 @@
  */
 // Copyright 2014-present Facebook. All Rights Reserved.
 #pragma once
+#include "fboss/agent/if/gen-cpp2/ctrl_types.h"
+
+#include <folly/Range.h>
 #include <folly/io/async/AsyncTimeout.h>
 #include <folly/io/async/EventBase.h>
 #include <folly/logging/xlog.h>
 #include <chrono>
+#include <memory>
+#include <vector>
 
 namespace facebook { namespace fboss {
 
@@ -21,30 +26,30 @@ class ThreadHeartbeat : private folly::AsyncTimeout {
    * Send heartbeat at regular interval to thread.  Measure delay between
    * time we expect heartbeat to be processed vs. time actually processed,
    * and record it to ods.
+   *
+   * Also samples every --event_loop_sample_rate-th loop of the EventBase
+   * into the event_loop.<thread>.busy.us histogram, and remembers loops
+   * that ran longer than --slow_event_loop_ms for getSlowLoops().
    */
  public:
   ThreadHeartbeat(folly::EventBase* evb, std::string threadName,
                   int intervalMsecs,
-                  std::function<void(int, int)> heartbeatStatsFunc) :
-      AsyncTimeout(evb),
-      evb_(evb),
-      threadName_(threadName),
-      intervalMsecs_(intervalMsecs),
-      heartbeatStatsFunc_(heartbeatStatsFunc) {
-    XLOG(DBG2) << "ThreadHeartbeat intervalMsecs:" << intervalMsecs_.count();
-    evb_->runInEventBaseThread([this]() {
-        scheduleFirstHeartbeat();
-      });
-  }
+                  std::function<void(int, int)> heartbeatStatsFunc);
 
-  ~ThreadHeartbeat() override {
-    evb_->runImmediatelyOrRunInEventBaseThreadAndWait(
-      [this]() {
-        cancelTimeout();
-      });
-  }
+  ~ThreadHeartbeat() override;
+
+  /*
+   * Name the work the calling thread is running, so that a slow loop can be
+   * attributed to it.  The name is kept until the next sampled loop ends.
+   */
+  static void setLoopSource(folly::StringPiece source);
+
+  // The recent slow loops of all threads, slowest first
+  static std::vector<EventLoopSample> getSlowLoops();
 
  private:
+  class LoopObserver;
+
   void timeoutExpired() noexcept override;
 
   void scheduleFirstHeartbeat() {
@@ -58,6 +63,7 @@ class ThreadHeartbeat : private folly::AsyncTimeout {
   std::chrono::milliseconds intervalMsecs_;
   std::function<void(int, int)> heartbeatStatsFunc_;
   std::chrono::time_point<std::chrono::steady_clock> lastTime_;
+  std::shared_ptr<LoopObserver> loopObserver_;
   //XXX: these thresholds could be made configurable if needed
   int delayThresholdMsecs_ = 1000;
   int backlogThreshold_ = 10;
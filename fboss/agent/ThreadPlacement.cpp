@@ -0,0 +1,223 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/ThreadPlacement.h"
+
+#include <dirent.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <folly/Conv.h>
+#include <folly/FileUtil.h>
+#include <folly/String.h>
+#include <folly/Synchronized.h>
+#include <folly/logging/xlog.h>
+
+#include "fboss/agent/FbossError.h"
+
+namespace facebook {
+namespace fboss {
+namespace thread_placement {
+
+namespace {
+
+// The kernel keeps thread names to 15 characters
+constexpr size_t kMaxThreadName = 15;
+
+folly::Synchronized<std::map<std::string, cfg::ThreadPlacement>> placements;
+
+pid_t currentTid() {
+  return static_cast<pid_t>(syscall(SYS_gettid));
+}
+
+bool matches(folly::StringPiece pattern, folly::StringPiece name, bool cut) {
+  if (pattern.endsWith('*')) {
+    pattern.pop_back();
+    if (cut && pattern.size() > kMaxThreadName) {
+      pattern = pattern.subpiece(0, kMaxThreadName);
+    }
+    return name.startsWith(pattern);
+  }
+  if (cut && pattern.size() > kMaxThreadName) {
+    pattern = pattern.subpiece(0, kMaxThreadName);
+  }
+  return pattern == name;
+}
+
+// An exact name wins over prefixes, and a longer prefix over a shorter one
+const cfg::ThreadPlacement* findPlacement(
+    const std::map<std::string, cfg::ThreadPlacement>& all,
+    folly::StringPiece name,
+    bool cut) {
+  const cfg::ThreadPlacement* best = nullptr;
+  size_t bestLen = 0;
+  for (const auto& entry : all) {
+    if (!matches(entry.first, name, cut)) {
+      continue;
+    }
+    if (!folly::StringPiece(entry.first).endsWith('*')) {
+      return &entry.second;
+    }
+    if (!best || entry.first.size() > bestLen) {
+      best = &entry.second;
+      bestLen = entry.first.size();
+    }
+  }
+  return best;
+}
+
+void applyTo(
+    pid_t tid,
+    folly::StringPiece name,
+    const cfg::ThreadPlacement& placement) {
+  if (!placement.cpus.empty()) {
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    for (auto cpu : placement.cpus) {
+      CPU_SET(cpu, &cpus);
+    }
+    if (sched_setaffinity(tid, sizeof(cpus), &cpus) != 0) {
+      XLOG(ERR) << "Unable to pin thread " << name << " to cpus "
+                << folly::join(",", placement.cpus) << ": "
+                << folly::errnoStr(errno);
+    }
+  }
+
+  struct sched_param param {};
+  int policy = SCHED_OTHER;
+  switch (placement.policy) {
+    case cfg::ThreadSchedPolicy::FIFO:
+      policy = SCHED_FIFO;
+      param.sched_priority = placement.priority;
+      break;
+    case cfg::ThreadSchedPolicy::RR:
+      policy = SCHED_RR;
+      param.sched_priority = placement.priority;
+      break;
+    case cfg::ThreadSchedPolicy::OTHER:
+      break;
+  }
+  if (sched_setscheduler(tid, policy, &param) != 0) {
+    XLOG(ERR) << "Unable to set the scheduling policy of thread " << name
+              << ": " << folly::errnoStr(errno);
+  }
+  // On Linux the nice value is per thread
+  if (policy == SCHED_OTHER &&
+      setpriority(PRIO_PROCESS, tid, placement.nice) != 0) {
+    XLOG(ERR) << "Unable to set the nice value of thread " << name << ": "
+              << folly::errnoStr(errno);
+  }
+  XLOG(DBG1) << "Placed thread " << name << " (" << tid << ")";
+}
+
+std::vector<std::pair<pid_t, std::string>> runningThreads() {
+  std::vector<std::pair<pid_t, std::string>> threads;
+  auto dir = opendir("/proc/self/task");
+  if (!dir) {
+    XLOG(ERR) << "Unable to list threads: " << folly::errnoStr(errno);
+    return threads;
+  }
+  while (auto entry = readdir(dir)) {
+    auto tid = folly::tryTo<pid_t>(entry->d_name);
+    if (!tid.hasValue()) {
+      continue;
+    }
+    std::string name;
+    folly::readFile(
+        folly::to<std::string>("/proc/self/task/", *tid, "/comm").c_str(),
+        name);
+    threads.emplace_back(*tid, folly::rtrimWhitespace(name).str());
+  }
+  closedir(dir);
+  return threads;
+}
+
+} // namespace
+
+void init(const std::map<std::string, cfg::ThreadPlacement>& config) {
+  for (const auto& entry : config) {
+    const auto& placement = entry.second;
+    for (auto cpu : placement.cpus) {
+      if (cpu < 0 || cpu >= CPU_SETSIZE) {
+        throw FbossError("invalid cpu ", cpu, " for thread ", entry.first);
+      }
+    }
+    if (placement.policy != cfg::ThreadSchedPolicy::OTHER &&
+        (placement.priority < 1 || placement.priority > 99)) {
+      throw FbossError(
+          "real time priority for thread ", entry.first, " must be 1-99");
+    }
+    if (placement.nice < -20 || placement.nice > 19) {
+      throw FbossError("nice for thread ", entry.first, " must be -20-19");
+    }
+  }
+  *placements.wlock() = config;
+}
+
+void apply(folly::StringPiece name) {
+  auto all = placements.rlock();
+  if (auto placement = findPlacement(*all, name, false)) {
+    applyTo(currentTid(), name, *placement);
+  }
+}
+
+void applyToRunningThreads() {
+  auto all = placements.rlock();
+  if (all->empty()) {
+    return;
+  }
+  for (const auto& thread : runningThreads()) {
+    if (auto placement = findPlacement(*all, thread.second, true)) {
+      applyTo(thread.first, thread.second, *placement);
+    }
+  }
+}
+
+std::vector<ThreadPlacementInfo> current() {
+  std::vector<ThreadPlacementInfo> infos;
+  for (const auto& thread : runningThreads()) {
+    ThreadPlacementInfo info;
+    info.tid = thread.first;
+    info.name = thread.second;
+    cpu_set_t cpus;
+    if (sched_getaffinity(thread.first, sizeof(cpus), &cpus) == 0) {
+      for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &cpus)) {
+          info.cpus.push_back(cpu);
+        }
+      }
+    }
+    struct sched_param param {};
+    sched_getparam(thread.first, &param);
+    info.priority = param.sched_priority;
+    switch (sched_getscheduler(thread.first)) {
+      case SCHED_FIFO:
+        info.policy = "FIFO";
+        break;
+      case SCHED_RR:
+        info.policy = "RR";
+        break;
+      case SCHED_OTHER:
+        info.policy = "OTHER";
+        break;
+      default:
+        info.policy = "UNKNOWN";
+        break;
+    }
+    info.nice = getpriority(PRIO_PROCESS, thread.first);
+    infos.push_back(std::move(info));
+  }
+  return infos;
+}
+
+} // namespace thread_placement
+} // namespace fboss
+} // namespace facebook
@@ -0,0 +1,60 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <folly/Range.h>
+
+#include "fboss/agent/gen-cpp2/agent_config_types.h"
+#include "fboss/agent/if/gen-cpp2/ctrl_types.h"
+
+/**
+ * This module pins agent threads to CPUs and sets their scheduling policy,
+ * from the threads section of the agent config, so that the update thread
+ * is not preempted by stats collection or thrift serving.
+ *
+ * Threads the agent starts apply their placement through initThread(), as
+ * they start. Threads the SDK starts are found by name once the hardware is
+ * initialized. Failing to apply a placement, as setting a real time policy
+ * without CAP_SYS_NICE, is logged and the thread runs as it would have.
+ */
+
+namespace facebook {
+namespace fboss {
+namespace thread_placement {
+
+/*
+ * Throws FbossError if a placement is invalid. Must be called before the
+ * threads it places start.
+ */
+void init(const std::map<std::string, cfg::ThreadPlacement>& placements);
+
+/*
+ * Apply the placement for name, if any, to the calling thread.
+ */
+void apply(folly::StringPiece name);
+
+/*
+ * Apply placements to the threads already running, matched by the name
+ * the kernel has for them.
+ */
+void applyToRunningThreads();
+
+/*
+ * The placement every thread of the agent actually has.
+ */
+std::vector<ThreadPlacementInfo> current();
+
+} // namespace thread_placement
+} // namespace fboss
+} // namespace facebook
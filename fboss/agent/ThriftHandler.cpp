@@ -15,20 +15,31 @@
 #include "common/stats/ServiceData.h"
 #include "fboss/agent/AddressUtil.h"
 #include "fboss/agent/ArpHandler.h"
+#include "fboss/agent/BootTrace.h"
+#include "fboss/agent/CounterRegistry.h"
 #include "fboss/agent/state/AclMap.h"
 #include "fboss/agent/IPv6Handler.h"
 #include "fboss/agent/LinkAggregationManager.h"
 #include "fboss/agent/LldpManager.h"
 #include "fboss/agent/NeighborUpdater.h"
+#include "fboss/agent/PortInfoCache.h"
+#include "fboss/agent/RouteTableStreamer.h"
 #include "fboss/agent/RouteUpdateLogger.h"
+#include "fboss/agent/RouteUpdateTracer.h"
+#include "fboss/agent/RxCpuAccounting.h"
+#include "fboss/agent/StallDetector.h"
 #include "fboss/agent/SwSwitch.h"
 #include "fboss/agent/SwitchStats.h"
+#include "fboss/agent/ThreadHeartbeat.h"
+#include "fboss/agent/ThreadPlacement.h"
 #include "fboss/agent/TxPacket.h"
 #include "fboss/agent/Utils.h"
 #include "fboss/agent/capture/PktCapture.h"
 #include "fboss/agent/capture/PktCaptureManager.h"
 #include "fboss/agent/hw/mock/MockRxPacket.h"
 #include "fboss/agent/if/gen-cpp2/NeighborListenerClient.h"
+#include "fboss/agent/if/gen-cpp2/PortStatusListenerClient.h"
+#include "fboss/agent/if/gen-cpp2/StatsListenerClient.h"
 #include "fboss/agent/state/AggregatePort.h"
 #include "fboss/agent/state/AggregatePortMap.h"
 #include "fboss/agent/state/ArpEntry.h"
@@ -44,14 +55,18 @@
 #include "fboss/agent/state/RouteTable.h"
 #include "fboss/agent/state/RouteTableRib.h"
 #include "fboss/agent/state/RouteUpdater.h"
+#include "fboss/agent/state/StateMemoryUsage.h"
 #include "fboss/agent/state/StateUtils.h"
 #include "fboss/agent/state/SwitchState.h"
+#include "fboss/agent/state/SwitchStateJson.h"
 #include "fboss/agent/state/Vlan.h"
 #include "fboss/agent/state/VlanMap.h"
 
 #include "fboss/lib/LogThriftCall.h"
 
+#include <boost/container/flat_set.hpp>
 #include <folly/MoveWrapper.h>
+#include <folly/Optional.h>
 #include <folly/Range.h>
 #include <folly/functional/Partial.h>
 #include <folly/io/Cursor.h>
@@ -59,7 +74,10 @@
 #include <folly/json_pointer.h>
 #include <folly/logging/xlog.h>
 #include <thrift/lib/cpp2/async/DuplexChannel.h>
+#include <thrift/lib/cpp2/async/StreamGenerator.h>
 
+#include <algorithm>
+#include <iterator>
 #include <limits>
 
 #include "fboss/agent/rib/ForwardingInformationBaseUpdater.h"
@@ -90,22 +108,45 @@ using facebook::network::toBinaryAddress;
 using facebook::network::toAddress;
 using facebook::network::toIPAddress;
 
+DECLARE_int32(capture_cpu_queue);
+
 DEFINE_bool(
     enable_running_config_mutations,
     false,
     "Allow external mutations of running config");
 
+DEFINE_int32(
+    route_update_trace_sample_rate,
+    10,
+    "Keep a trace of one in this many route updates");
+DEFINE_int32(
+    route_update_traces,
+    256,
+    "Number of sampled route update traces to keep");
+DEFINE_int32(
+    neighbor_listener_batch_ms,
+    100,
+    "How long to gather neighbor changes for before sending them to "
+    "batched neighbor listeners");
+DEFINE_int32(
+    neighbor_listener_max_pending,
+    16384,
+    "Neighbor changes to hold for a batched neighbor listener that is "
+    "behind, past which it is told to resync instead");
+
 namespace {
 void dynamicFibUpdate(
     facebook::fboss::RouterID vrf,
     const facebook::fboss::rib::IPv4NetworkToRouteMap& v4NetworkToRoute,
     const facebook::fboss::rib::IPv6NetworkToRouteMap& v6NetworkToRoute,
+    const facebook::fboss::rib::ChangedPrefixes* changedPrefixes,
     void* cookie) {
   facebook::fboss::rib::ForwardingInformationBaseUpdater fibUpdater(
-      vrf, v4NetworkToRoute, v6NetworkToRoute);
+      vrf, v4NetworkToRoute, v6NetworkToRoute, changedPrefixes);
 
   auto sw = static_cast<facebook::fboss::SwSwitch*>(cookie);
-  sw->updateStateBlocking("", std::move(fibUpdater));
+  sw->updateStateBlocking(
+      "", std::move(fibUpdater), facebook::fboss::StateUpdate::Priority::ROUTE);
 }
 } // namespace
 
@@ -145,31 +186,113 @@ std::vector<NextHopThrift> thriftNextHopsFromAddresses(
 
 class RouteUpdateStats {
  public:
-  RouteUpdateStats(SwSwitch *sw, const std::string& func, uint32_t routes)
+  RouteUpdateStats(
+      SwSwitch* sw,
+      RouteUpdateTracer* tracer,
+      const std::string& func,
+      ClientID client,
+      uint32_t added,
+      uint32_t deleted)
       : sw_(sw),
+        tracer_(tracer),
         func_(func),
-        routes_(routes),
+        client_(client),
+        added_(added),
+        deleted_(deleted),
         start_(std::chrono::steady_clock::now()) {
   }
   ~RouteUpdateStats() {
     auto end = std::chrono::steady_clock::now();
     auto duration =
       std::chrono::duration_cast<std::chrono::microseconds>(end - start_);
-    sw_->stats()->routeUpdate(duration, routes_);
-    XLOG(DBG0) << func_ << " " << routes_ << " routes took " << duration.count()
+    auto routes = added_ + deleted_;
+    sw_->stats()->routeUpdate(duration, routes);
+    XLOG(DBG0) << func_ << " " << routes << " routes took " << duration.count()
                << "us";
+
+    // If the update function never ran, all of it was spent queued
+    auto computeStart = computeStart_.value_or(end);
+    auto computeEnd = computeEnd_.value_or(end);
+    RouteUpdateTracer::Update update;
+    update.client = client_;
+    update.updateType = func_;
+    update.routesAdded = added_;
+    update.routesDeleted = deleted_;
+    update.queue = std::chrono::duration_cast<std::chrono::microseconds>(
+        computeStart - start_);
+    update.rib = std::chrono::duration_cast<std::chrono::microseconds>(
+        computeEnd - computeStart);
+    update.fib =
+        std::chrono::duration_cast<std::chrono::microseconds>(end - computeEnd);
+    tracer_->record(update);
+  }
+
+  // Called by the update function as it starts and finishes computing the
+  // new routes, to split the time queued from the time programming them
+  void computeStarted() {
+    computeStart_ = std::chrono::steady_clock::now();
+  }
+  void computeDone() {
+    computeEnd_ = std::chrono::steady_clock::now();
   }
+
  private:
   SwSwitch* sw_;
+  RouteUpdateTracer* tracer_;
   const std::string func_;
-  uint32_t routes_;
+  ClientID client_;
+  uint32_t added_;
+  uint32_t deleted_;
   std::chrono::time_point<std::chrono::steady_clock> start_;
+  folly::Optional<std::chrono::time_point<std::chrono::steady_clock>>
+      computeStart_;
+  folly::Optional<std::chrono::time_point<std::chrono::steady_clock>>
+      computeEnd_;
 };
 
-ThriftHandler::ThriftHandler(SwSwitch* sw) : FacebookBase2("FBOSS"), sw_(sw) {
+static void recordRibUpdate(
+    RouteUpdateTracer* tracer,
+    ClientID client,
+    folly::StringPiece updateType,
+    const rib::RoutingInformationBase::UpdateStatistics& stats) {
+  RouteUpdateTracer::Update update;
+  update.client = client;
+  update.updateType = updateType.str();
+  update.routesAdded = stats.v4RoutesAdded + stats.v6RoutesAdded;
+  update.routesDeleted = stats.v4RoutesDeleted + stats.v6RoutesDeleted;
+  update.queue = stats.lockWait;
+  update.fib = stats.fibUpdateDuration;
+  update.rib = std::max(
+      stats.duration - stats.lockWait - stats.fibUpdateDuration,
+      std::chrono::microseconds(0));
+  tracer->record(update);
+}
+
+ThriftHandler::ThriftHandler(SwSwitch* sw)
+    : FacebookBase2("FBOSS"),
+      sw_(sw),
+      routeUpdateTracer_(
+          FLAGS_route_update_trace_sample_rate,
+          FLAGS_route_update_traces) {
   sw->registerNeighborListener(
-    [=](const std::vector<std::string>& added,
-        const std::vector<std::string>& deleted) {
+    [=](const std::vector<folly::IPAddress>& addedIPs,
+        const std::vector<folly::IPAddress>& deletedIPs) {
+      for (auto& listener : batchedNeighborListeners_.accessAllThreads()) {
+        auto listenerPtr = &listener;
+        listener.eventBase->runInEventBaseThread([=] {
+          queueNeighborChanges(listenerPtr, addedIPs, deletedIPs);
+        });
+      }
+      // The original listeners get the addresses as strings, one event at
+      // a time
+      std::vector<std::string> added;
+      std::vector<std::string> deleted;
+      for (const auto& ip : addedIPs) {
+        added.push_back(ip.str());
+      }
+      for (const auto& ip : deletedIPs) {
+        deleted.push_back(ip.str());
+      }
       for (auto& listener : listeners_.accessAllThreads()) {
         XLOG(INFO) << "Sending notification to bgpD";
         auto listenerPtr = &listener;
@@ -191,6 +314,40 @@ fb_status ThriftHandler::getStatus() {
   }
 }
 
+apache::thrift::concurrency::PRIORITY ThriftHandler::getRequestPriority(
+    apache::thrift::Cpp2RequestContext* ctx,
+    apache::thrift::concurrency::PRIORITY prio) {
+  using apache::thrift::concurrency::BEST_EFFORT;
+  using apache::thrift::concurrency::HIGH;
+  static const std::unordered_map<
+      std::string,
+      apache::thrift::concurrency::PRIORITY>
+      kPriorities = {
+          {"getStatus", HIGH},
+          {"aliveSince", HIGH},
+          {"addUnicastRoute", HIGH},
+          {"addUnicastRoutes", HIGH},
+          {"deleteUnicastRoute", HIGH},
+          {"deleteUnicastRoutes", HIGH},
+          {"syncFib", HIGH},
+          {"addMplsRoutes", HIGH},
+          {"deleteMplsRoutes", HIGH},
+          {"syncMplsFib", HIGH},
+          {"getRouteTable", BEST_EFFORT},
+          {"getRouteTableByClient", BEST_EFFORT},
+          {"getRouteTableDetails", BEST_EFFORT},
+          {"getCurrentStateJSON", BEST_EFFORT},
+          {"getCurrentStateJSONPage", BEST_EFFORT},
+          {"getAllPortInfo", BEST_EFFORT},
+          {"getL2Table", BEST_EFFORT},
+          {"getAclTable", BEST_EFFORT},
+          {"getArpTable", BEST_EFFORT},
+          {"getNdpTable", BEST_EFFORT},
+      };
+  auto it = kPriorities.find(ctx->getMethodName());
+  return it == kPriorities.end() ? prio : it->second;
+}
+
 void ThriftHandler::async_tm_getStatus(ThriftCallback<fb_status> callback) {
   callback->result(getStatus());
 }
@@ -205,6 +362,52 @@ void ThriftHandler::flushCountersNow() {
   stats::ThreadCachedServiceData::get()->publishStats();
 }
 
+void ThriftHandler::getCounters(std::map<std::string, int64_t>& counters) {
+  // Not logged, as monitoring calls this all the time
+  fbData->getCounters(counters);
+  CounterRegistry::get()->getCounters(counters);
+}
+
+void ThriftHandler::getCounterValues(
+    CounterValues& values,
+    std::unique_ptr<CounterQuery> query) {
+  // Not logged, as collectors poll this like getCounters()
+  CounterRegistry::Query registryQuery;
+  registryQuery.keys = std::move(query->keys);
+  registryQuery.prefixes = std::move(query->prefixes);
+  registryQuery.components = std::move(query->components);
+  registryQuery.regexes = std::move(query->regexes);
+  auto counters = CounterRegistry::get()->query(registryQuery);
+  values.names.reserve(counters.size());
+  values.values.reserve(counters.size());
+  for (auto& counter : counters) {
+    values.names.push_back(std::move(counter.first));
+    values.values.push_back(counter.second);
+  }
+}
+
+void ThriftHandler::getSelectedCounters(
+    std::map<std::string, int64_t>& counters,
+    std::unique_ptr<std::vector<std::string>> keys) {
+  CounterRegistry::Query query;
+  query.keys = std::move(*keys);
+  for (auto& counter : CounterRegistry::get()->query(query)) {
+    counters.emplace_hint(
+        counters.end(), std::move(counter.first), counter.second);
+  }
+}
+
+void ThriftHandler::getRegexCounters(
+    std::map<std::string, int64_t>& counters,
+    std::unique_ptr<std::string> regex) {
+  CounterRegistry::Query query;
+  query.regexes.push_back(std::move(*regex));
+  for (auto& counter : CounterRegistry::get()->query(query)) {
+    counters.emplace_hint(
+        counters.end(), std::move(counter.first), counter.second);
+  }
+}
+
 void ThriftHandler::addUnicastRoute(
     int16_t client, std::unique_ptr<UnicastRoute> route) {
   LogThriftCall log(__func__, getConnectionContext());
@@ -229,6 +432,71 @@ void ThriftHandler::addUnicastRoutes(
   updateUnicastRoutesImpl(client, routes, "addUnicastRoutes", false);
 }
 
+void ThriftHandler::async_tm_addUnicastRoutes(
+    ThriftCallback<void> callback,
+    int16_t client,
+    std::unique_ptr<std::vector<UnicastRoute>> routes) {
+  LogThriftCall log(__func__, callback->getConnectionContext());
+  try {
+    ensureConfigured("addUnicastRoutes");
+    ensureFibSynced("addUnicastRoutes");
+  } catch (const std::exception& ex) {
+    fail(callback, ex);
+    return;
+  }
+
+  size_t depth;
+  {
+    auto pending = pendingRouteBatches_.wlock();
+    pending->push_back({client, std::move(routes), std::move(callback)});
+    depth = pending->size();
+  }
+  sw_->stats()->routeBatchQueued(depth);
+  if (depth == 1) {
+    // The queue was empty, so no drain is pending yet
+    routeBatchThread_.getEventBase()->runInEventBaseThread(
+        [this] { processRouteBatches(); });
+  }
+}
+
+void ThriftHandler::processRouteBatches() {
+  std::deque<PendingRouteBatch> batches;
+  pendingRouteBatches_.wlock()->swap(batches);
+  while (!batches.empty()) {
+    // Consecutive batches from one client go into a single update.  Routes
+    // are added in the order they were sent, so a later batch still wins
+    // over an earlier one for the same prefix.
+    auto client = batches.front().client;
+    auto routes = std::make_unique<std::vector<UnicastRoute>>();
+    std::vector<ThriftCallback<void>> callbacks;
+    while (!batches.empty() && batches.front().client == client) {
+      auto& batch = batches.front();
+      routes->insert(
+          routes->end(),
+          std::make_move_iterator(batch.routes->begin()),
+          std::make_move_iterator(batch.routes->end()));
+      callbacks.push_back(std::move(batch.callback));
+      batches.pop_front();
+    }
+    sw_->stats()->routeBatchesCoalesced(callbacks.size());
+
+    try {
+      updateUnicastRoutesImpl(client, routes, "addUnicastRoutes", false);
+    } catch (const std::exception& ex) {
+      XLOG(ERR) << "Failed to add " << routes->size() << " routes from "
+                << callbacks.size() << " batches of client " << client << ": "
+                << folly::exceptionStr(ex);
+      for (const auto& callback : callbacks) {
+        fail(callback, ex);
+      }
+      continue;
+    }
+    for (const auto& callback : callbacks) {
+      callback->done();
+    }
+  }
+}
+
 void ThriftHandler::getProductInfo(ProductInfo& productInfo) {
   LogThriftCall log(__func__, getConnectionContext());
   sw_->getProductInfo(productInfo);
@@ -259,18 +527,29 @@ void ThriftHandler::deleteUnicastRoutes(
 
     sw_->stats()->delRoutesV4(stats.v4RoutesDeleted);
     sw_->stats()->delRoutesV6(stats.v6RoutesDeleted);
+    sw_->stats()->ribRoutesCoalesced(stats.routesHeld, stats.routesCoalesced);
 
     auto totalRouteCount = stats.v4RoutesDeleted + stats.v6RoutesDeleted;
     sw_->stats()->routeUpdate(stats.duration, totalRouteCount);
+    recordRibUpdate(
+        &routeUpdateTracer_, clientID, "delete unicast route", stats);
     XLOG(DBG0) << "Delete " << totalRouteCount << " routes took "
-               << stats.duration.count() << "us";
+               << stats.duration.count() << "us, re-resolved "
+               << stats.routesResolved << " routes";
 
     return;
   }
 
-  RouteUpdateStats stats(sw_, "Delete", prefixes->size());
+  RouteUpdateStats stats(
+      sw_,
+      &routeUpdateTracer_,
+      "Delete",
+      ClientID(client),
+      0,
+      prefixes->size());
   // Perform the update
   auto updateFn = [&](const shared_ptr<SwitchState>& state) {
+    stats.computeStarted();
     RouteUpdater updater(state->getRouteTables());
     RouterID routerId = RouterID(0); // TODO, default vrf for now
     for (const auto& prefix : *prefixes) {
@@ -284,6 +563,7 @@ void ThriftHandler::deleteUnicastRoutes(
       updater.delRoute(routerId, network, mask, ClientID(client));
     }
     auto newRt = updater.updateDone();
+    stats.computeDone();
     if (!newRt) {
       return shared_ptr<SwitchState>();
     }
@@ -291,14 +571,18 @@ void ThriftHandler::deleteUnicastRoutes(
     newState->resetRouteTables(std::move(newRt));
     return newState;
   };
-  sw_->updateStateBlocking("delete unicast route", updateFn);
+  sw_->updateStateBlocking(
+      "delete unicast route", updateFn, StateUpdate::Priority::ROUTE);
 }
 
 void ThriftHandler::syncFib(
     int16_t client, std::unique_ptr<std::vector<UnicastRoute>> routes) {
   LogThriftCall log(__func__, getConnectionContext());
   ensureConfigured("syncFib");
-  updateUnicastRoutesImpl(client, routes, "syncFib", true);
+  {
+    boot_trace::Span span("ThriftHandler::syncFib");
+    updateUnicastRoutesImpl(client, routes, "syncFib", true);
+  }
   if (!sw_->isFibSynced()) {
     sw_->fibSynced();
   }
@@ -325,32 +609,50 @@ void ThriftHandler::updateUnicastRoutesImpl(
 
     sw_->stats()->addRoutesV4(stats.v4RoutesAdded);
     sw_->stats()->addRoutesV6(stats.v6RoutesAdded);
+    sw_->stats()->ribRoutesCoalesced(stats.routesHeld, stats.routesCoalesced);
 
     auto totalRouteCount = stats.v4RoutesAdded + stats.v6RoutesAdded;
     sw_->stats()->routeUpdate(stats.duration, totalRouteCount);
+    recordRibUpdate(&routeUpdateTracer_, clientID, updType, stats);
     XLOG(DBG0) << updType << " " << totalRouteCount << " routes took "
-               << stats.duration.count() << "us";
+               << stats.duration.count() << "us, re-resolved "
+               << stats.routesResolved << " routes";
 
     return;
   }
 
-  RouteUpdateStats stats(sw_, updType, routes->size());
+  RouteUpdateStats stats(
+      sw_,
+      &routeUpdateTracer_,
+      updType,
+      ClientID(client),
+      routes->size(),
+      0);
 
   // Note that we capture routes by reference here, since it is a unique_ptr.
   // This is safe since we use updateStateBlocking(), so routes will still
   // be valid in our scope when updateFn() is called.
   // We could use folly::MoveWrapper if we did need to capture routes by value.
   auto updateFn = [&](const shared_ptr<SwitchState>& state) {
+    stats.computeStarted();
     // create an update object starting from empty
     RouteUpdater updater(state->getRouteTables());
     RouterID routerId = RouterID(0); // TODO, default vrf for now
     auto clientIdToAdmin = sw_->clientIdToAdminDistance(client);
-    if (sync) {
-      updater.removeAllRoutesForClient(routerId, ClientID(client));
-    }
+    // A sync re-adds the routes the client still has, which leaves the
+    // unchanged ones alone, and then removes only the ones it dropped
+    boost::container::flat_set<RouteUpdater::PrefixV4> keepV4;
+    boost::container::flat_set<RouteUpdater::PrefixV6> keepV6;
     for (const auto& route : *routes) {
       folly::IPAddress network = toIPAddress(route.dest.ip);
       uint8_t mask = static_cast<uint8_t>(route.dest.prefixLength);
+      if (sync) {
+        if (network.isV4()) {
+          keepV4.insert({network.asV4().mask(mask), mask});
+        } else {
+          keepV6.insert({network.asV6().mask(mask), mask});
+        }
+      }
       auto adminDistance = route.__isset.adminDistance
           ? route.adminDistance_ref().value_unchecked()
           : clientIdToAdmin;
@@ -377,7 +679,12 @@ void ThriftHandler::updateUnicastRoutesImpl(
         sw_->stats()->addRouteV6();
       }
     }
+    if (sync) {
+      updater.removeRoutesForClientExcept(
+          routerId, ClientID(client), keepV4, keepV6);
+    }
     auto newRt = updater.updateDone();
+    stats.computeDone();
     if (!newRt) {
       return shared_ptr<SwitchState>();
     }
@@ -385,7 +692,7 @@ void ThriftHandler::updateUnicastRoutesImpl(
     newState->resetRouteTables(std::move(newRt));
     return newState;
   };
-  sw_->updateStateBlocking(updType, updateFn);
+  sw_->updateStateBlocking(updType, updateFn, StateUpdate::Priority::ROUTE);
 }
 
 static void populateInterfaceDetail(InterfaceDetail& interfaceDetail,
@@ -456,6 +763,41 @@ void ThriftHandler::getL2Table(std::vector<L2EntryThrift>& l2Table) {
   XLOG(DBG6) << "L2 Table size:" << l2Table.size();
 }
 
+apache::thrift::Stream<L2TableChunk> ThriftHandler::streamL2Table(
+    int32_t chunkSize) {
+  LogThriftCall log(__func__, getConnectionContext());
+  ensureConfigured(__func__);
+  if (chunkSize <= 0) {
+    throw FbossError("chunkSize must be positive, not ", chunkSize);
+  }
+  struct Snapshot {
+    folly::Optional<std::vector<L2EntryThrift>> entries;
+    size_t next{0};
+  };
+  auto snapshot = std::make_shared<Snapshot>();
+  auto hw = sw_->getHw();
+  return apache::thrift::StreamGenerator::create(
+      folly::getKeepAliveToken(l2StreamThread_.getEventBase()),
+      [snapshot, hw, chunkSize]() -> folly::Optional<L2TableChunk> {
+        auto& entries = snapshot->entries;
+        if (!entries) {
+          entries.emplace();
+          hw->fetchL2Table(&*entries);
+          XLOG(DBG6) << "L2 Table size:" << entries->size();
+        }
+        if (snapshot->next >= entries->size()) {
+          return folly::none;
+        }
+        auto end = std::min(entries->size(), snapshot->next + chunkSize);
+        L2TableChunk chunk;
+        chunk.entries.assign(
+            std::make_move_iterator(entries->begin() + snapshot->next),
+            std::make_move_iterator(entries->begin() + end));
+        snapshot->next = end;
+        return chunk;
+      });
+}
+
 AclEntryThrift ThriftHandler::populateAclEntryThrift(
     const AclEntry& aclEntry) {
     AclEntryThrift aclEntryThrift;
@@ -603,140 +945,72 @@ void ThriftHandler::getAggregatePortTable(
   }
 }
 
-void ThriftHandler::fillPortStats(PortInfoThrift& portInfo, int numPortQs) {
-  auto portId = portInfo.portId;
-  auto statMap = fbData->getStatMap();
-
-  auto getSumStat = [&] (StringPiece prefix, StringPiece name) {
-    auto portName =  portInfo.name.empty() ?
-      folly::to<std::string>("port", portId) : portInfo.name;
-    auto statName = folly::to<std::string>(portName, ".", prefix, name);
-    auto statPtr = statMap->getLockedStatPtr(statName);
-    auto numLevels = statPtr->numLevels();
-    // Cumulative (ALLTIME) counters are at (numLevels - 1)
-    return statPtr->sum(numLevels - 1);
-  };
-
-  auto fillPortCounters = [&] (PortCounters& ctr, StringPiece prefix) {
-    ctr.bytes = getSumStat(prefix, "bytes");
-    ctr.ucastPkts = getSumStat(prefix, "unicast_pkts");
-    ctr.multicastPkts = getSumStat(prefix, "multicast_pkts");
-    ctr.broadcastPkts = getSumStat(prefix, "broadcast_pkts");
-    ctr.errors.errors = getSumStat(prefix, "errors");
-    ctr.errors.discards = getSumStat(prefix, "discards");
-  };
+void ThriftHandler::getPortInfo(PortInfoThrift &portInfo, int32_t portId) {
+  LogThriftCall log(__func__, getConnectionContext());
+  ensureConfigured();
 
-  fillPortCounters(portInfo.output, "out_");
-  fillPortCounters(portInfo.input, "in_");
-  for (int i=0; i<numPortQs; i++) {
-    auto queue = folly::to<std::string>("queue", i, ".");
-    QueueStats stats;
-    stats.congestionDiscards =
-        getSumStat(queue, "out_congestion_discards_bytes");
-    stats.outBytes = getSumStat(queue, "out_bytes");
-    portInfo.output.unicast.push_back(stats);
-  }
-}
-
-void ThriftHandler::getPortInfoHelper(
-    PortInfoThrift& portInfo,
-    const std::shared_ptr<Port> port) {
-  portInfo.portId = port->getID();
-  portInfo.name = port->getName();
-  portInfo.description = port->getDescription();
-  portInfo.speedMbps = static_cast<int>(port->getSpeed());
-  for (auto entry : port->getVlans()) {
-    portInfo.vlans.push_back(entry.first);
-  }
-
-  for (const auto& queue : port->getPortQueues()) {
-    PortQueueThrift pq;
-    pq.id = queue->getID();
-    pq.mode = cfg::_QueueScheduling_VALUES_TO_NAMES.find(
-        queue->getScheduling())->second;
-    if (queue->getScheduling() == cfg::QueueScheduling::WEIGHTED_ROUND_ROBIN) {
-      pq.weight_ref() = queue->getWeight();
-    }
-    if (queue->getReservedBytes()) {
-      pq.reservedBytes_ref() = queue->getReservedBytes().value();
-    }
-    if (queue->getScalingFactor()) {
-      pq.scalingFactor_ref() = cfg::_MMUScalingFactor_VALUES_TO_NAMES
-                                   .find(queue->getScalingFactor().value())
-                                   ->second;
-    }
-    if (!queue->getAqms().empty()) {
-      std::vector<ActiveQueueManagement> aqms;
-      for (const auto& aqm: queue->getAqms()) {
-        ActiveQueueManagement aqmThrift;
-        switch (aqm.second.detection.getType()) {
-          case cfg::QueueCongestionDetection::Type::linear:
-            aqmThrift.detection.linear_ref().value_unchecked().minimumLength =
-                aqm.second.detection.get_linear().minimumLength;
-            aqmThrift.detection.linear_ref().value_unchecked().maximumLength =
-                aqm.second.detection.get_linear().maximumLength;
-            aqmThrift.detection.__isset.linear = true;
-            break;
-          case cfg::QueueCongestionDetection::Type::__EMPTY__:
-            XLOG(WARNING) << "Invalid queue congestion detection config";
-            break;
-        }
-        aqmThrift.behavior = QueueCongestionBehavior(aqm.first);
-        aqms.push_back(aqmThrift);
-      }
-      pq.aqms_ref().value_unchecked().swap(aqms);
-      pq.__isset.aqms = true;
-    }
-    if (queue->getName()) {
-      pq.name = queue->getName().value();
-    }
-    portInfo.portQueues.push_back(pq);
+  auto ports = sw_->getPortInfoCache()->getSnapshot();
+  auto it = ports->find(portId);
+  if (it == ports->end()) {
+    throw FbossError("no such port ", portId);
   }
+  portInfo = it->second;
+}
 
-  portInfo.adminState =
-      PortAdminState(port->getAdminState() == cfg::PortState::ENABLED);
-  portInfo.operState =
-      PortOperState(port->getOperState() == Port::OperState::UP);
-  portInfo.fecEnabled = sw_->getHw()->getPortFECEnabled(port->getID());
-
-  auto pause = port->getPause();
-  portInfo.txPause = pause.tx;
-  portInfo.rxPause = pause.rx;
+void ThriftHandler::getAllPortInfo(map<int32_t, PortInfoThrift>& portInfoMap) {
+  LogThriftCall log(__func__, getConnectionContext());
+  ensureConfigured();
 
-  fillPortStats(portInfo, portInfo.portQueues.size());
+  // Counters are as of the end of the last stats cycle
+  portInfoMap = *sw_->getPortInfoCache()->getSnapshot();
 }
 
-void ThriftHandler::getPortInfo(PortInfoThrift &portInfo, int32_t portId) {
+void ThriftHandler::clearPortStats(unique_ptr<vector<int32_t>> ports) {
   LogThriftCall log(__func__, getConnectionContext());
   ensureConfigured();
+  sw_->clearPortStats(ports);
+}
 
-  const auto port =
-      sw_->getState()->getPorts()->getPortIf(PortID(portId));
-  if (!port) {
-    throw FbossError("no such port ", portId);
+void ThriftHandler::setPortFastSampling(
+    unique_ptr<vector<int32_t>> ports,
+    int32_t intervalMsecs) {
+  LogThriftCall log(__func__, getConnectionContext());
+  ensureConfigured();
+  std::vector<PortID> portIds;
+  for (auto port : *ports) {
+    portIds.push_back(PortID(port));
   }
+  sw_->getHw()->setPortFastSampling(
+      portIds, std::chrono::milliseconds(intervalMsecs));
+}
 
-  getPortInfoHelper(portInfo, port);
+void ThriftHandler::getPortFastSamples(
+    PortFastSamples& samples,
+    int32_t portId) {
+  LogThriftCall log(__func__, getConnectionContext());
+  ensureConfigured();
+  samples = sw_->getHw()->getPortFastSamples(PortID(portId));
 }
 
-void ThriftHandler::getAllPortInfo(map<int32_t, PortInfoThrift>& portInfoMap) {
+void ThriftHandler::watchAclStats(
+    unique_ptr<vector<std::string>> statNames,
+    int32_t durationSecs) {
   LogThriftCall log(__func__, getConnectionContext());
   ensureConfigured();
+  sw_->getHw()->watchAclStats(*statNames, std::chrono::seconds(durationSecs));
+}
 
-  // NOTE: important to take pointer to switch state before iterating over
-  // list of ports
-  std::shared_ptr<SwitchState> swState = sw_->getState();
-  for (const auto& port : *(swState->getPorts())) {
-    auto portId = port->getID();
-    auto& portInfo = portInfoMap[portId];
-    getPortInfoHelper(portInfo, port);
-  }
+void ThriftHandler::getBufferCongestionEvents(
+    std::vector<BufferCongestionEvent>& events) {
+  LogThriftCall log(__func__, getConnectionContext());
+  ensureConfigured();
+  events = sw_->getHw()->getBufferCongestionEvents();
 }
 
-void ThriftHandler::clearPortStats(unique_ptr<vector<int32_t>> ports) {
+void ThriftHandler::getHwApiTrace(HwApiTrace& trace) {
   LogThriftCall log(__func__, getConnectionContext());
   ensureConfigured();
-  sw_->clearPortStats(ports);
+  trace = sw_->getHw()->getHwApiTrace();
 }
 
 void ThriftHandler::getPortStats(PortInfoThrift& portInfo, int32_t portId) {
@@ -767,9 +1041,27 @@ void ThriftHandler::getCurrentStateJSON(
   if (!jsonPtr) {
     throw FbossError("Malformed JSON Pointer");
   }
-  auto swState = sw_->getState()->toFollyDynamic();
-  auto dyn = swState.get_ptr(jsonPtr.value());
-  ret = folly::json::serialize(*dyn, folly::json::serialization_opts{});
+  auto dyn = switchStateToFollyDynamic(*sw_->getState(), jsonPtr.value());
+  ret = folly::json::serialize(dyn, folly::json::serialization_opts{});
+}
+
+void ThriftHandler::getCurrentStateJSONPage(
+    std::string& ret,
+    std::unique_ptr<std::string> jsonPointerStr,
+    int64_t offset,
+    int32_t limit) {
+  LogThriftCall log(__func__, getConnectionContext());
+  ensureConfigured();
+  if (offset < 0 || limit < 0) {
+    throw FbossError("Invalid page offset ", offset, " or limit ", limit);
+  }
+  auto const jsonPtr = folly::json_pointer::try_parse(*jsonPointerStr);
+  if (!jsonPtr) {
+    throw FbossError("Malformed JSON Pointer");
+  }
+  auto dyn = switchStateEntriesToFollyDynamic(
+      *sw_->getState(), jsonPtr.value(), offset, limit);
+  ret = folly::json::serialize(dyn, folly::json::serialization_opts{});
 }
 
 void ThriftHandler::patchCurrentStateJSON(
@@ -835,7 +1127,8 @@ void ThriftHandler::setPortState(int32_t portNum, bool enable) {
     newPort->setAdminState(newPortState);
     return newState;
   };
-  sw_->updateStateBlocking("set port state", updateFn);
+  sw_->updateStateBlocking(
+      "set port state", updateFn, StateUpdate::Priority::LINK);
 }
 
 void ThriftHandler::getRouteTable(std::vector<UnicastRoute>& routes) {
@@ -878,11 +1171,10 @@ void ThriftHandler::getRouteTableByClient(
   ensureConfigured();
   auto state = sw_->getState();
   for (const auto& routeTable : (*state->getRouteTables())) {
-    for (const auto& ipv4 : *(routeTable->getRibV4()->routes())) {
+    auto ribV4 = routeTable->getRibV4();
+    for (const auto& prefix : ribV4->prefixesForClient(ClientID(client))) {
+      auto ipv4 = ribV4->exactMatch(prefix);
       auto entry = ipv4->getEntryForClient(ClientID(client));
-      if (not entry) {
-        continue;
-      }
 
       UnicastRoute tempRoute;
       tempRoute.dest.ip = toBinaryAddress(ipv4->prefix().network);
@@ -894,11 +1186,10 @@ void ThriftHandler::getRouteTableByClient(
       routes.emplace_back(std::move(tempRoute));
     }
 
-    for (const auto& ipv6 : *(routeTable->getRibV6()->routes())) {
+    auto ribV6 = routeTable->getRibV6();
+    for (const auto& prefix : ribV6->prefixesForClient(ClientID(client))) {
+      auto ipv6 = ribV6->exactMatch(prefix);
       auto entry = ipv6->getEntryForClient(ClientID(client));
-      if (not entry) {
-        continue;
-      }
 
       UnicastRoute tempRoute;
       tempRoute.dest.ip = toBinaryAddress(ipv6->prefix().network);
@@ -912,6 +1203,93 @@ void ThriftHandler::getRouteTableByClient(
   }
 }
 
+apache::thrift::Stream<RouteTableChunk> ThriftHandler::streamRouteTable(
+    std::unique_ptr<RouteTableFilter> filter,
+    int32_t chunkSize) {
+  LogThriftCall log(__func__, getConnectionContext());
+  ensureConfigured(__func__);
+  if (chunkSize <= 0) {
+    throw FbossError("chunkSize must be positive, not ", chunkSize);
+  }
+  auto streamer = std::make_shared<RouteTableStreamer>(
+      sw_->getAppliedState(), *filter, chunkSize);
+  // Chunks are built on routeStreamThread_ as the client asks for them
+  return apache::thrift::StreamGenerator::create(
+      folly::getKeepAliveToken(routeStreamThread_.getEventBase()),
+      [streamer]() -> folly::Optional<RouteTableChunk> {
+        auto routes = streamer->nextChunk();
+        if (!routes) {
+          return folly::none;
+        }
+        RouteTableChunk chunk;
+        chunk.routes = std::move(*routes);
+        return chunk;
+      });
+}
+
+void ThriftHandler::getRouteUpdateTraces(
+    std::vector<RouteUpdateTrace>& traces) {
+  LogThriftCall log(__func__, getConnectionContext());
+  traces = routeUpdateTracer_.getTraces();
+}
+
+void ThriftHandler::getSlowEventLoops(std::vector<EventLoopSample>& loops) {
+  LogThriftCall log(__func__, getConnectionContext());
+  loops = ThreadHeartbeat::getSlowLoops();
+}
+
+void ThriftHandler::getThreadStalls(std::vector<ThreadStall>& stalls) {
+  LogThriftCall log(__func__, getConnectionContext());
+  stalls = StallDetector::getStalls();
+}
+
+void ThriftHandler::getRxCpuUsage(
+    std::vector<RxCpuUsage>& usages,
+    int32_t windowSeconds,
+    int32_t count) {
+  LogThriftCall log(__func__, getConnectionContext());
+  auto top = sw_->getRxCpuAccounting()->top(
+      std::chrono::seconds(windowSeconds), std::max(count, 0));
+  for (const auto& usage : top) {
+    RxCpuUsage out;
+    out.name = usage.name;
+    out.packets = usage.packets;
+    out.cpuTimeUsecs =
+        std::chrono::duration_cast<std::chrono::microseconds>(usage.cpuTime)
+            .count();
+    out.dtlbMisses = usage.dtlbMisses;
+    usages.push_back(std::move(out));
+  }
+}
+
+void ThriftHandler::getStateMemoryUsage(
+    std::vector<StateSubtreeMemory>& usages) {
+  LogThriftCall log(__func__, getConnectionContext());
+  ensureConfigured();
+  StateMemoryUsage memory(sw_->getDesiredState(), sw_->getAppliedState());
+  auto addUsage = [&usages](
+                      const std::string& name,
+                      const StateMemoryUsage::Usage& usage) {
+    StateSubtreeMemory out;
+    out.name = name;
+    out.bytes = usage.bytes;
+    out.nodes = usage.nodes;
+    out.sharedBytes = usage.sharedBytes;
+    out.sharedNodes = usage.sharedNodes;
+    usages.push_back(std::move(out));
+  };
+  for (const auto& subtree : memory.getSubtrees()) {
+    addUsage(subtree.first, subtree.second);
+  }
+  addUsage("total", memory.getTotal());
+}
+
+void ThriftHandler::getThreadPlacement(
+    std::vector<ThreadPlacementInfo>& threads) {
+  LogThriftCall log(__func__, getConnectionContext());
+  threads = thread_placement::current();
+}
+
 void ThriftHandler::getRouteTableDetails(std::vector<RouteDetails>& routes) {
   LogThriftCall log(__func__, getConnectionContext());
   ensureConfigured();
@@ -1066,13 +1444,245 @@ void ThriftHandler::async_eb_registerForNeighborChanged(
   cb->done();
 }
 
+void ThriftHandler::async_eb_registerForNeighborChangesBatched(
+    ThriftCallback<void> cb) {
+  auto ctx = cb->getConnectionContext()->getConnectionContext();
+  auto client = ctx->getDuplexClient<NeighborListenerClientAsyncClient>();
+  CHECK(cb->getEventBase()->isInEventBaseThread());
+  auto info = batchedNeighborListeners_.get();
+  if (!info) {
+    info = new ThreadLocalBatchedNeighborListener(cb->getEventBase());
+    batchedNeighborListeners_.reset(info);
+  }
+  DCHECK_EQ(info->eventBase, cb->getEventBase());
+  info->clients[ctx].client = client;
+  cb->done();
+}
+
+void ThriftHandler::queueNeighborChanges(
+    ThreadLocalBatchedNeighborListener* listener,
+    const std::vector<folly::IPAddress>& added,
+    const std::vector<folly::IPAddress>& removed) {
+  for (auto& entry : listener->clients) {
+    auto& client = entry.second;
+    if (client.resync) {
+      // Nothing to gain from changes it will fetch anyway
+      continue;
+    }
+    for (const auto& ip : added) {
+      client.pending[ip] = true;
+    }
+    for (const auto& ip : removed) {
+      client.pending[ip] = false;
+    }
+    if (client.pending.size() >
+        static_cast<size_t>(FLAGS_neighbor_listener_max_pending)) {
+      XLOG(WARNING) << "Neighbor listener fell behind by "
+                    << client.pending.size() << " changes, sending resync";
+      client.pending.clear();
+      client.resync = true;
+    }
+  }
+  scheduleNeighborFlush(listener);
+}
+
+void ThriftHandler::scheduleNeighborFlush(
+    ThreadLocalBatchedNeighborListener* listener) {
+  if (listener->flushScheduled) {
+    return;
+  }
+  listener->flushScheduled = true;
+  listener->eventBase->runAfterDelay(
+      [this, listener] { flushNeighborChanges(listener); },
+      FLAGS_neighbor_listener_batch_ms);
+}
+
+void ThriftHandler::flushNeighborChanges(
+    ThreadLocalBatchedNeighborListener* listener) {
+  listener->flushScheduled = false;
+  for (auto& entry : listener->clients) {
+    auto& client = entry.second;
+    // A client still taking the last batch gets this one once it is done
+    if (client.inFlight || (client.pending.empty() && !client.resync)) {
+      continue;
+    }
+    NeighborChanges changes;
+    changes.resync = client.resync;
+    for (const auto& change : client.pending) {
+      auto& list = change.second ? changes.added : changes.removed;
+      list.push_back(toBinaryAddress(change.first));
+    }
+    client.pending.clear();
+    client.resync = false;
+    client.inFlight = true;
+    auto ctx = entry.first;
+    auto clientDone = [this, listener, ctx](ClientReceiveState&& state) {
+      auto iter = listener->clients.find(ctx);
+      try {
+        NeighborListenerClientAsyncClient::recv_neighborChangesBatched(state);
+        if (iter != listener->clients.end()) {
+          iter->second.inFlight = false;
+          if (!iter->second.pending.empty() || iter->second.resync) {
+            scheduleNeighborFlush(listener);
+          }
+        }
+      } catch (const std::exception& ex) {
+        XLOG(ERR) << "Exception in batched neighbor listener: " << ex.what();
+        if (iter != listener->clients.end()) {
+          listener->clients.erase(iter);
+        }
+      }
+    };
+    client.client->neighborChangesBatched(clientDone, changes);
+  }
+}
+
+void ThriftHandler::invokeStatsListeners(
+    ThreadLocalStatsListener* listener,
+    const std::shared_ptr<const HwStatsUpdate>& full,
+    const std::shared_ptr<const HwStatsUpdate>& delta) {
+  for (auto& entry : listener->clients) {
+    auto& client = entry.second;
+    if (client.inFlight) {
+      // Don't queue up updates behind a slow client.  It missed this delta,
+      // so it needs every port again next time.
+      client.synced = false;
+      continue;
+    }
+    const auto& update = client.synced ? *delta : *full;
+    client.synced = true;
+    client.inFlight = true;
+    auto ctx = entry.first;
+    auto clientDone = [listener, ctx](ClientReceiveState&& state) {
+      auto iter = listener->clients.find(ctx);
+      try {
+        StatsListenerClientAsyncClient::recv_statsUpdated(state);
+        if (iter != listener->clients.end()) {
+          iter->second.inFlight = false;
+        }
+      } catch (const std::exception& ex) {
+        XLOG(ERR) << "Exception in stats listener: " << ex.what();
+        if (iter != listener->clients.end()) {
+          listener->clients.erase(iter);
+        }
+      }
+    };
+    client.client->statsUpdated(clientDone, update);
+  }
+}
+
+void ThriftHandler::async_eb_registerForStatsUpdates(ThriftCallback<void> cb) {
+  auto ctx = cb->getConnectionContext()->getConnectionContext();
+  auto client = ctx->getDuplexClient<StatsListenerClientAsyncClient>();
+  CHECK(cb->getEventBase()->isInEventBaseThread());
+  auto info = statsListeners_.get();
+  if (!info) {
+    info = new ThreadLocalStatsListener(cb->getEventBase());
+    statsListeners_.reset(info);
+  }
+  DCHECK_EQ(info->eventBase, cb->getEventBase());
+  info->clients[ctx].client = client;
+
+  // Only pay for building the updates once someone wants them
+  std::call_once(statsListenerRegistered_, [this] {
+    sw_->registerStatsListener(
+        [this](
+            std::shared_ptr<const HwStatsUpdate> full,
+            std::shared_ptr<const HwStatsUpdate> delta) {
+          for (auto& listener : statsListeners_.accessAllThreads()) {
+            auto listenerPtr = &listener;
+            listener.eventBase->runInEventBaseThread([=] {
+              invokeStatsListeners(listenerPtr, full, delta);
+            });
+          }
+        });
+  });
+  cb->done();
+}
+
+void ThriftHandler::sendPortStatus(
+    ThreadLocalPortStatusListener* listener,
+    const TConnectionContext* ctx,
+    const std::map<int32_t, PortStatus>& ports,
+    bool full) {
+  auto iter = listener->clients.find(ctx);
+  if (iter == listener->clients.end()) {
+    return;
+  }
+  auto clientDone = [listener, ctx](ClientReceiveState&& state) {
+    try {
+      PortStatusListenerClientAsyncClient::recv_portStatusChanged(state);
+    } catch (const std::exception& ex) {
+      XLOG(ERR) << "Exception in port status listener: " << ex.what();
+      listener->clients.erase(ctx);
+    }
+  };
+  iter->second->portStatusChanged(clientDone, ports, full);
+}
+
+void ThriftHandler::invokePortStatusListeners(
+    ThreadLocalPortStatusListener* listener,
+    const std::shared_ptr<const std::map<int32_t, PortStatus>>& changed) {
+  std::vector<const TConnectionContext*> ctxs;
+  for (const auto& client : listener->clients) {
+    ctxs.push_back(client.first);
+  }
+  // A failed send may erase its client, so don't iterate the map itself
+  for (auto ctx : ctxs) {
+    sendPortStatus(listener, ctx, *changed, false);
+  }
+}
+
+void ThriftHandler::async_eb_registerForPortStatusChanged(
+    ThriftCallback<void> cb) {
+  auto ctx = cb->getConnectionContext()->getConnectionContext();
+  auto client = ctx->getDuplexClient<PortStatusListenerClientAsyncClient>();
+  CHECK(cb->getEventBase()->isInEventBaseThread());
+  auto info = portStatusListeners_.get();
+  if (!info) {
+    info = new ThreadLocalPortStatusListener(cb->getEventBase());
+    portStatusListeners_.reset(info);
+  }
+  DCHECK_EQ(info->eventBase, cb->getEventBase());
+  info->clients[ctx] = client;
+
+  std::call_once(portStatusListenerRegistered_, [this] {
+    sw_->registerPortStatusListener(
+        [this](std::map<int32_t, PortStatus> changed) {
+          auto shared = std::make_shared<const std::map<int32_t, PortStatus>>(
+              std::move(changed));
+          for (auto& listener : portStatusListeners_.accessAllThreads()) {
+            auto listenerPtr = &listener;
+            listener.eventBase->runInEventBaseThread(
+                [=] { invokePortStatusListeners(listenerPtr, shared); });
+          }
+        });
+  });
+  cb->done();
+  // Changes published from now on are sent from this thread too, so the
+  // client gets them after this snapshot
+  sendPortStatus(info, ctx, sw_->getPortStatus(), true);
+}
+
 void ThriftHandler::startPktCapture(unique_ptr<CaptureInfo> info) {
   LogThriftCall log(__func__, getConnectionContext());
   ensureConfigured();
   auto* mgr = sw_->getCaptureMgr();
+  const DataplaneCapture* dataplane = nullptr;
+  if (info->__isset.dataplane) {
+    dataplane = &info->dataplane_ref().value_unchecked();
+    // Only the copies, which are only received
+    info->direction = CaptureDirection::CAPTURE_ONLY_RX;
+    info->filter.rxCaptureFilter.cosQueues = {
+        static_cast<CpuCosQueueId>(FLAGS_capture_cpu_queue)};
+  }
   auto capture = make_unique<PktCapture>(
-       info->name, info->maxPackets, info->direction, info->filter);
-  mgr->startCapture(std::move(capture));
+       info->name, info->maxPackets, info->direction, info->filter,
+       info->dropPolicy);
+  if (info->maxFileBytes > 0) {
+    capture->setFileRotation(info->maxFileBytes, info->maxFiles);
+  }
+  mgr->startCapture(std::move(capture), dataplane);
 }
 
 void ThriftHandler::stopPktCapture(unique_ptr<std::string> name) {
@@ -1089,6 +1699,15 @@ void ThriftHandler::stopAllPktCaptures() {
   mgr->forgetAllCaptures();
 }
 
+void ThriftHandler::getPktCaptureStats(
+    CaptureStats& stats,
+    unique_ptr<std::string> name) {
+  LogThriftCall log(__func__, getConnectionContext());
+  ensureConfigured();
+  auto* mgr = sw_->getCaptureMgr();
+  stats = mgr->getCaptureStats(*name);
+}
+
 void ThriftHandler::startLoggingRouteUpdates(
     std::unique_ptr<RouteUpdateLoggingInfo> info) {
   LogThriftCall log(__func__, getConnectionContext());
@@ -1199,6 +1818,23 @@ void ThriftHandler::txPktL3(unique_ptr<fbstring> payload) {
   sw_->sendL3Packet(std::move(pkt));
 }
 
+void ThriftHandler::txPktBatch(unique_ptr<vector<TxPkt>> pkts) {
+  LogThriftCall log(__func__, getConnectionContext());
+  ensureConfigured("txPktBatch");
+
+  for (auto& txPkt : *pkts) {
+    unique_ptr<TxPacket> pkt = sw_->allocatePacket(txPkt.data.size());
+    RWPrivateCursor cursor(pkt->buf());
+    cursor.push(StringPiece(txPkt.data));
+    if (txPkt.__isset.port) {
+      sw_->sendPacketOutOfPortAsync(
+          std::move(pkt), PortID(txPkt.port_ref().value_unchecked()));
+    } else {
+      sw_->sendPacketSwitchedAsync(std::move(pkt));
+    }
+  }
+}
+
 Vlan* ThriftHandler::getVlan(int32_t vlanId) {
   ensureConfigured();
   return sw_->getState()->getVlans()->getVlan(VlanID(vlanId)).get();
@@ -1292,6 +1928,18 @@ void ThriftHandler::connectionDestroyed(TConnectionContext* ctx) {
   if (listeners_) {
     listeners_->clients.erase(ctx);
   }
+  // Stats update notifications
+  if (statsListeners_) {
+    statsListeners_->clients.erase(ctx);
+  }
+  // Batched neighbor change notifications
+  if (batchedNeighborListeners_) {
+    batchedNeighborListeners_->clients.erase(ctx);
+  }
+  // Port status change notifications
+  if (portStatusListeners_) {
+    portStatusListeners_->clients.erase(ctx);
+  }
 }
 
 int32_t ThriftHandler::getIdleTimeout() {
@@ -1372,7 +2020,8 @@ void ThriftHandler::addMplsRoutes(
     }
     return newState;
   };
-  sw_->updateStateBlocking("addMplsRoutes", updateFn);
+  sw_->updateStateBlocking(
+      "addMplsRoutes", updateFn, StateUpdate::Priority::ROUTE);
 }
 
 void ThriftHandler::addMplsRoutesImpl(
@@ -1418,7 +2067,8 @@ void ThriftHandler::deleteMplsRoutes(
     }
     return newState;
   };
-  sw_->updateStateBlocking("deleteMplsRoutes", updateFn);
+  sw_->updateStateBlocking(
+      "deleteMplsRoutes", updateFn, StateUpdate::Priority::ROUTE);
 }
 
 void ThriftHandler::syncMplsFib(
@@ -1431,14 +2081,20 @@ void ThriftHandler::syncMplsFib(
     auto newState = state->clone();
     auto labelFib = newState->getLabelForwardingInformationBase();
 
-    labelFib->purgeEntriesForClient(&newState, ClientID(clientId));
+    // Only the labels that go away or change end up in the StateDelta
+    boost::container::flat_set<MplsLabel> keep;
+    for (const auto& route : routes) {
+      keep.insert(route.topLabel);
+    }
+    labelFib->purgeEntriesForClient(&newState, ClientID(clientId), keep);
     addMplsRoutesImpl(&newState, ClientID(clientId), routes);
     if (!sw_->isValidStateUpdate(StateDelta(state, newState))) {
       throw FbossError("Invalid MPLS routes");
     }
     return newState;
   };
-  sw_->updateStateBlocking("syncMplsFib", updateFn);
+  sw_->updateStateBlocking(
+      "syncMplsFib", updateFn, StateUpdate::Priority::ROUTE);
 }
 
 void ThriftHandler::getMplsRouteTableByClient(
@@ -9,19 +9,26 @@
  */
 #pragma once
 
+#include <deque>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <map>
 
 #include "common/fb303/cpp/FacebookBase2.h"
 #include "fboss/agent/FbossError.h"
+#include "fboss/agent/RouteUpdateTracer.h"
 #include "fboss/agent/types.h"
 #include "fboss/agent/if/gen-cpp2/FbossCtrl.h"
 #include "fboss/agent/if/gen-cpp2/NeighborListenerClient.h"
+#include "fboss/agent/if/gen-cpp2/PortStatusListenerClient.h"
+#include "fboss/agent/if/gen-cpp2/StatsListenerClient.h"
 #include "fboss/agent/gen-cpp2/switch_config_types.h"
 
 #include <folly/Synchronized.h>
+#include <folly/io/async/ScopedEventBaseThread.h>
 #include <folly/String.h>
 #include <thrift/lib/cpp/server/TServerEventHandler.h>
 #include <thrift/lib/cpp2/async/DuplexChannel.h>
@@ -52,15 +59,41 @@ class ThriftHandler : virtual public FbossCtrlSvIf,
 
   explicit ThriftHandler(SwSwitch* sw);
 
+  /*
+   * Route programming and health checks run at HIGH priority, and the
+   * getters that dump large tables at BEST_EFFORT, each on their own
+   * workers (see setupThriftThreadManager()).
+   */
+  apache::thrift::concurrency::PRIORITY getRequestPriority(
+      apache::thrift::Cpp2RequestContext* ctx,
+      apache::thrift::concurrency::PRIORITY prio) override;
+
   fb303::cpp2::fb_status getStatus() override;
 
   void async_tm_getStatus(ThriftCallback<fb303::cpp2::fb_status> cb) override;
 
   void async_eb_registerForNeighborChanged(
       ThriftCallback<void> callback) override;
+  void async_eb_registerForNeighborChangesBatched(
+      ThriftCallback<void> callback) override;
+  void async_eb_registerForStatsUpdates(ThriftCallback<void> callback) override;
+  void async_eb_registerForPortStatusChanged(
+      ThriftCallback<void> callback) override;
 
   void flushCountersNow() override;
 
+  // fb303 counters, plus the ones interned in the CounterRegistry
+  void getCounters(std::map<std::string, int64_t>& counters) override;
+  void getCounterValues(
+      CounterValues& values,
+      std::unique_ptr<CounterQuery> query) override;
+  void getSelectedCounters(
+      std::map<std::string, int64_t>& counters,
+      std::unique_ptr<std::vector<std::string>> keys) override;
+  void getRegexCounters(
+      std::map<std::string, int64_t>& counters,
+      std::unique_ptr<std::string> regex) override;
+
   void addUnicastRoute(
       int16_t client, std::unique_ptr<UnicastRoute> route) override;
   void deleteUnicastRoute(
@@ -68,6 +101,20 @@ class ThriftHandler : virtual public FbossCtrlSvIf,
   void addUnicastRoutes(
       int16_t client,
       std::unique_ptr<std::vector<UnicastRoute>> routes) override;
+  /*
+   * Thrift calls to addUnicastRoutes() come in here rather than to the
+   * blocking version above, which is kept for in-process callers.
+   *
+   * The batch is queued and the thrift worker is free as soon as it is, so
+   * a client can have several batches in flight.  The callback completes
+   * once the routes are programmed.  Batches queued while an update is
+   * running are applied together, with consecutive batches from one client
+   * going into a single RIB and hardware update.
+   */
+  void async_tm_addUnicastRoutes(
+      ThriftCallback<void> callback,
+      int16_t client,
+      std::unique_ptr<std::vector<UnicastRoute>> routes) override;
   void deleteUnicastRoutes(
       int16_t client, std::unique_ptr<std::vector<IpPrefix>> prefixes) override;
   void syncFib(
@@ -116,6 +163,7 @@ class ThriftHandler : virtual public FbossCtrlSvIf,
   void txPkt(int32_t port, std::unique_ptr<folly::fbstring> data) override;
   void txPktL2(std::unique_ptr<folly::fbstring> data) override;
   void txPktL3(std::unique_ptr<folly::fbstring> payload) override;
+  void txPktBatch(std::unique_ptr<std::vector<TxPkt>> pkts) override;
 
   int32_t flushNeighborEntry(std::unique_ptr<BinaryAddress> ip,
                              int32_t vlan) override;
@@ -139,6 +187,18 @@ class ThriftHandler : virtual public FbossCtrlSvIf,
   void getRouteTableByClient(
       std::vector<UnicastRoute>& routeTable, int16_t clientId) override;
   void getRouteTableDetails(std::vector<RouteDetails>& routeTable) override;
+  apache::thrift::Stream<RouteTableChunk> streamRouteTable(
+      std::unique_ptr<RouteTableFilter> filter,
+      int32_t chunkSize) override;
+  void getRouteUpdateTraces(std::vector<RouteUpdateTrace>& traces) override;
+  void getSlowEventLoops(std::vector<EventLoopSample>& loops) override;
+  void getThreadStalls(std::vector<ThreadStall>& stalls) override;
+  void getRxCpuUsage(
+      std::vector<RxCpuUsage>& usages,
+      int32_t windowSeconds,
+      int32_t count) override;
+  void getStateMemoryUsage(std::vector<StateSubtreeMemory>& usages) override;
+  void getThreadPlacement(std::vector<ThreadPlacementInfo>& threads) override;
 
   void getPortStatus(std::map<int32_t, PortStatus>& status,
                      std::unique_ptr<std::vector<int32_t>> ports)
@@ -149,11 +209,23 @@ class ThriftHandler : virtual public FbossCtrlSvIf,
   void getPortInfo(PortInfoThrift& portInfo, int32_t portId) override;
   void getAllPortInfo(std::map<int32_t, PortInfoThrift>& portInfo) override;
   void clearPortStats(std::unique_ptr<std::vector<int32_t>> ports) override;
+  void setPortFastSampling(
+      std::unique_ptr<std::vector<int32_t>> ports,
+      int32_t intervalMsecs) override;
+  void getPortFastSamples(PortFastSamples& samples, int32_t portId) override;
+  void watchAclStats(
+      std::unique_ptr<std::vector<std::string>> statNames,
+      int32_t durationSecs) override;
+  void getBufferCongestionEvents(
+      std::vector<BufferCongestionEvent>& events) override;
+  void getHwApiTrace(HwApiTrace& trace) override;
   void getPortStats(PortInfoThrift& portInfo, int32_t portId) override;
   void getAllPortStats(std::map<int32_t, PortInfoThrift>& portInfo) override;
   void getRunningConfig(std::string& configStr) override;
   void getArpTable(std::vector<ArpEntryThrift>& arpTable) override;
   void getL2Table(std::vector<L2EntryThrift>& l2Table) override;
+  apache::thrift::Stream<L2TableChunk> streamL2Table(
+      int32_t chunkSize) override;
   void getAclTable(std::vector<AclEntryThrift>& AclTable) override;
   void getAggregatePort(
       AggregatePortThrift& aggregatePortThrift,
@@ -176,6 +248,9 @@ class ThriftHandler : virtual public FbossCtrlSvIf,
   void startPktCapture(std::unique_ptr<CaptureInfo> info) override;
   void stopPktCapture(std::unique_ptr<std::string> name) override;
   void stopAllPktCaptures() override;
+  void getPktCaptureStats(
+      CaptureStats& stats,
+      std::unique_ptr<std::string> name) override;
 
   void startLoggingRouteUpdates(
       std::unique_ptr<RouteUpdateLoggingInfo> info) override;
@@ -241,6 +316,16 @@ class ThriftHandler : virtual public FbossCtrlSvIf,
   void getCurrentStateJSON(std::string& ret, std::unique_ptr<std::string>)
       override;
 
+  /**
+   * Serialize one page of the list of nodes at the path pointed to by JSON
+   * Pointer, e.g. the routes of one RIB or the ARP table of one VLAN
+   */
+  void getCurrentStateJSONPage(
+      std::string& ret,
+      std::unique_ptr<std::string> jsonPointer,
+      int64_t offset,
+      int32_t limit) override;
+
   /**
    * Patch live running switch state at path pointed by jsonPointer using the
    * JSON merge patch supplied in jsonPatch
@@ -289,7 +374,81 @@ class ThriftHandler : virtual public FbossCtrlSvIf,
   };
   folly::ThreadLocalPtr<ThreadLocalListener, int> listeners_;
 
-  void onPortStatusChanged(PortID id, PortStatus st);
+  /*
+   * Listeners to batched neighbor changes. Each client holds the latest
+   * change to each neighbor that it has not been sent yet, up to
+   * --neighbor_listener_max_pending of them; past that they are dropped and
+   * the client is told to resync instead.
+   */
+  struct ThreadLocalBatchedNeighborListener {
+    struct Client {
+      std::shared_ptr<NeighborListenerClientAsyncClient> client;
+      // True if the neighbor was added, false if removed
+      std::unordered_map<folly::IPAddress, bool> pending;
+      bool resync{false};
+      bool inFlight{false};
+    };
+    EventBase* eventBase;
+    std::unordered_map<const apache::thrift::server::TConnectionContext*,
+                       Client>
+        clients;
+    bool flushScheduled{false};
+
+    explicit ThreadLocalBatchedNeighborListener(EventBase* eb)
+        : eventBase(eb) {}
+  };
+  folly::ThreadLocalPtr<ThreadLocalBatchedNeighborListener, int>
+      batchedNeighborListeners_;
+
+  void queueNeighborChanges(
+      ThreadLocalBatchedNeighborListener* listener,
+      const std::vector<folly::IPAddress>& added,
+      const std::vector<folly::IPAddress>& removed);
+  void scheduleNeighborFlush(ThreadLocalBatchedNeighborListener* listener);
+  void flushNeighborChanges(ThreadLocalBatchedNeighborListener* listener);
+
+  struct ThreadLocalStatsListener {
+    struct Client {
+      std::shared_ptr<StatsListenerClientAsyncClient> client;
+      // Whether the client has the stats of every port, so deltas suffice
+      bool synced{false};
+      bool inFlight{false};
+    };
+    EventBase* eventBase;
+    std::unordered_map<const apache::thrift::server::TConnectionContext*,
+                       Client>
+        clients;
+
+    explicit ThreadLocalStatsListener(EventBase* eb) : eventBase(eb) {}
+  };
+  folly::ThreadLocalPtr<ThreadLocalStatsListener, int> statsListeners_;
+  std::once_flag statsListenerRegistered_;
+
+  void invokeStatsListeners(
+      ThreadLocalStatsListener* listener,
+      const std::shared_ptr<const HwStatsUpdate>& full,
+      const std::shared_ptr<const HwStatsUpdate>& delta);
+
+  struct ThreadLocalPortStatusListener {
+    EventBase* eventBase;
+    std::unordered_map<const apache::thrift::server::TConnectionContext*,
+                       std::shared_ptr<PortStatusListenerClientAsyncClient>>
+        clients;
+
+    explicit ThreadLocalPortStatusListener(EventBase* eb) : eventBase(eb) {}
+  };
+  folly::ThreadLocalPtr<ThreadLocalPortStatusListener, int>
+      portStatusListeners_;
+  std::once_flag portStatusListenerRegistered_;
+
+  void invokePortStatusListeners(
+      ThreadLocalPortStatusListener* listener,
+      const std::shared_ptr<const std::map<int32_t, PortStatus>>& changed);
+  void sendPortStatus(
+      ThreadLocalPortStatusListener* listener,
+      const apache::thrift::server::TConnectionContext* ctx,
+      const std::map<int32_t, PortStatus>& ports,
+      bool full);
 
   void invokeNeighborListeners(ThreadLocalListener* info,
                                 std::vector<std::string> added,
@@ -299,10 +458,13 @@ class ThriftHandler : virtual public FbossCtrlSvIf,
     int16_t client, const std::unique_ptr<std::vector<UnicastRoute>>& routes,
     const std::string& updType, bool sync);
 
-  void getPortInfoHelper(
-      PortInfoThrift& portInfo,
-      const std::shared_ptr<Port> port);
-  void fillPortStats(PortInfoThrift& portInfo, int numPortQs = 0);
+  struct PendingRouteBatch {
+    int16_t client;
+    std::unique_ptr<std::vector<UnicastRoute>> routes;
+    ThriftCallback<void> callback;
+  };
+  // Runs on routeBatchThread_
+  void processRouteBatches();
 
   Vlan* getVlan(int32_t vlanId);
   Vlan* getVlan(const std::string& vlanName);
@@ -337,9 +499,23 @@ class ThriftHandler : virtual public FbossCtrlSvIf,
    */
   SwSwitch* sw_;
 
+  // Per-client route update histograms and sampled traces
+  RouteUpdateTracer routeUpdateTracer_;
+
   int thriftIdleTimeout_;
   std::vector<const TConnectionContext*> brokenClients_;
 
   apache::thrift::SSLPolicy sslPolicy_;
+
+  // Builds the chunks of streamRouteTable() streams
+  folly::ScopedEventBaseThread routeStreamThread_{"RouteTableStream"};
+  // Reads the hardware L2 table for streamL2Table() streams, so a slow
+  // traversal doesn't hold up route streams
+  folly::ScopedEventBaseThread l2StreamThread_{"L2TableStream"};
+
+  // Batches from async_tm_addUnicastRoutes() waiting for routeBatchThread_.
+  // The thread is last so it stops before anything it uses is destroyed.
+  folly::Synchronized<std::deque<PendingRouteBatch>> pendingRouteBatches_;
+  folly::ScopedEventBaseThread routeBatchThread_{"RouteBatches"};
 };
 }} // facebook::fboss
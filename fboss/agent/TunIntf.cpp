@@ -13,6 +13,7 @@ extern "C" {
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <sys/ioctl.h>
+#include <sys/uio.h>
 #include <fcntl.h>
 #include <libnetlink.h>
 #include <linux/if.h>
@@ -23,14 +24,24 @@ extern "C" {
 }
 
 #include <folly/io/async/EventBase.h>
+#include <folly/hash/Hash.h>
 #include <folly/io/async/EventHandler.h>
 #include <folly/logging/xlog.h>
+#include <gflags/gflags.h>
+#include <algorithm>
 #include "fboss/agent/NlError.h"
 #include "fboss/agent/RxPacket.h"
 #include "fboss/agent/SwSwitch.h"
+#include "fboss/agent/SwitchStats.h"
 #include "fboss/agent/SysError.h"
 #include "fboss/agent/TxPacket.h"
 #include "fboss/agent/packet/EthHdr.h"
+#include "fboss/agent/packet/IPProto.h"
+
+DEFINE_int32(
+    tun_read_batch_size,
+    16,
+    "Max packets read from a tun interface per wakeup before yielding");
 
 namespace facebook { namespace fboss {
 
@@ -38,8 +49,6 @@ namespace {
 
 const std::string kTunDev = "/dev/net/tun";
 
-// Max packets to be processed which are received from host
-const int kMaxSentOneTime = 16;
 
 // Definition of `iplink_req` as it is not well defined in any header files
 struct iplink_req {
@@ -64,22 +73,20 @@ struct iplink_req {
 
 TunIntf::TunIntf(
     SwSwitch *sw,
-    folly::EventBase *evb,
+    const std::vector<folly::EventBase*>& evbs,
     InterfaceID ifID,
     int ifIndex,
     int mtu)
-    : folly::EventHandler(evb),
-      sw_(sw),
+    : sw_(sw),
       name_(util::createTunIntfName(ifID)),
       ifID_(ifID),
       ifIndex_(ifIndex),
       mtu_(mtu) {
   DCHECK(sw) << "NULL pointer to SwSwitch.";
-  DCHECK(evb) << "NULL pointer to EventBase";
 
-  openFD();
+  openQueues(evbs, true);
   SCOPE_FAIL {
-    closeFD();
+    queues_.clear();
   };
 
   // XXX: Disabling mode on existing interface so that we end up removing
@@ -87,37 +94,35 @@ TunIntf::TunIntf(
   // next release onwards we will not need it
   disableIPv6AddrGenMode(ifIndex_);
 
-  XLOG(INFO) << "Added interface " << name_ << " with fd " << fd_ << " @ index "
-             << ifIndex_ << ", "
+  XLOG(INFO) << "Added interface " << name_ << " with " << queues_.size()
+             << " queues @ index " << ifIndex_ << ", "
              << "DOWN";
 }
 
 TunIntf::TunIntf(
     SwSwitch *sw,
-    folly::EventBase *evb,
+    const std::vector<folly::EventBase*>& evbs,
     InterfaceID ifID,
     bool status,
     const Interface::Addresses& addr,
     int mtu)
-    : folly::EventHandler(evb),
-      sw_(sw),
+    : sw_(sw),
       name_(util::createTunIntfName(ifID)),
       ifID_(ifID),
       status_(status),
       addrs_(addr),
       mtu_(mtu) {
   DCHECK(sw) << "NULL pointer to SwSwitch.";
-  DCHECK(evb) << "NULL pointer to EventBase";
 
-  // Open Tun interface FD for socket-IO
-  openFD();
+  // Open Tun interface FDs for socket-IO
+  openQueues(evbs, false);
   SCOPE_FAIL {
-    closeFD();
+    queues_.clear();
   };
 
   // Make the Tun interface persistent, so that the network sessions from the
   // application (i.e. BGP)  will not be reset if controller restarts
-  auto ret = ioctl(fd_, TUNSETPERSIST, 1);
+  auto ret = ioctl(queues_.front()->getFD(), TUNSETPERSIST, 1);
   sysCheckError(ret, "Failed to set persist interface ", name_);
 
   // TODO: if needed, we can adjust send buffer size, TUNSETSNDBUF
@@ -147,83 +152,146 @@ TunIntf::TunIntf(
   // Disable v6 link-local address assignment on Tun interface
   disableIPv6AddrGenMode(ifIndex_);
 
-  XLOG(INFO) << "Created interface " << name_ << " with fd " << fd_
-             << " @ index " << ifIndex_ << ", " << (status ? "UP" : "DOWN");
+  XLOG(INFO) << "Created interface " << name_ << " with " << queues_.size()
+             << " queues @ index " << ifIndex_ << ", "
+             << (status ? "UP" : "DOWN");
 }
 
 TunIntf::~TunIntf() {
   stop();
 
   // We must have a valid fd to TunIntf
-  CHECK_NE(fd_, -1);
+  CHECK(!queues_.empty());
 
   // Delete interface if need be
   if (toDelete_) {
-    auto ret = ioctl(fd_, TUNSETPERSIST, 0);
+    auto ret = ioctl(queues_.front()->getFD(), TUNSETPERSIST, 0);
     sysLogError(ret, "Failed to unset persist interface ", name_);
   }
 
-  // Close FD. This will delete the interface if TUNSETPERSIST is not on
-  closeFD();
+  // Close FDs. This will delete the interface if TUNSETPERSIST is not on
+  queues_.clear();
   XLOG(INFO) << (toDelete_ ? "Delete" : "Detach") << " interface " << name_;
 }
 
 void TunIntf::stop() {
-  unregisterHandler();
+  for (auto& queue : queues_) {
+    queue->stop();
+  }
 }
 
 void TunIntf::start() {
-  if (fd_ != -1 && !isHandlerRegistered()) {
-    changeHandlerFD(folly::NetworkSocket::fromFd(fd_));
-    registerHandler(folly::EventHandler::READ | folly::EventHandler::PERSIST);
+  for (auto& queue : queues_) {
+    queue->start();
+  }
+}
+
+void TunIntf::openQueues(
+    const std::vector<folly::EventBase*>& evbs,
+    bool attachAny) {
+  CHECK(!evbs.empty()) << "No EventBase for interface " << name_;
+  bool multiQueue = evbs.size() > 1;
+  int fd = -1;
+  try {
+    fd = openFD(multiQueue);
+  } catch (const SysError& ex) {
+    if (!attachAny) {
+      throw;
+    }
+    // The device was created with the other queueing mode, by an agent
+    // running with a different --tun_queues
+    XLOG(WARNING) << "Attaching to " << name_ << " with a single queue: "
+                  << folly::exceptionStr(ex);
+    multiQueue = !multiQueue;
+    fd = openFD(multiQueue);
+    queues_.push_back(std::make_unique<Queue>(this, evbs.front(), fd));
+    setMtu(mtu_);
+    return;
   }
+  queues_.push_back(std::make_unique<Queue>(this, evbs.front(), fd));
+  for (size_t i = 1; i < evbs.size(); ++i) {
+    queues_.push_back(std::make_unique<Queue>(this, evbs[i], openFD(true)));
+  }
+
+  // Set configured MTU
+  setMtu(mtu_);
 }
 
-void TunIntf::openFD() {
-  fd_ = open(kTunDev.c_str(), O_RDWR);
-  sysCheckError(fd_, "Cannot open ", kTunDev.c_str());
+int TunIntf::openFD(bool multiQueue) {
+  int fd = open(kTunDev.c_str(), O_RDWR);
+  sysCheckError(fd, "Cannot open ", kTunDev.c_str());
   SCOPE_FAIL {
-    closeFD();
+    closeFD(fd);
   };
 
   struct ifreq ifr;
   memset(&ifr, 0, sizeof(ifr));
-  // Flags: IFF_TUN   - TUN device (no Ethernet headers)
-  //        IFF_NO_PI - Do not provide packet information
+  // Flags: IFF_TUN         - TUN device (no Ethernet headers)
+  //        IFF_NO_PI       - Do not provide packet information
+  //        IFF_MULTI_QUEUE - One queue per fd attached to the device
   ifr.ifr_flags = IFF_TUN | IFF_NO_PI;
+  if (multiQueue) {
+    ifr.ifr_flags |= IFF_MULTI_QUEUE;
+  }
   bzero(ifr.ifr_name, sizeof(ifr.ifr_name));
   size_t len = std::min(name_.size(), sizeof(ifr.ifr_name));
   memmove(ifr.ifr_name, name_.c_str(), len);
-  auto ret = ioctl(fd_, TUNSETIFF, (void *) &ifr);
+  auto ret = ioctl(fd, TUNSETIFF, (void *) &ifr);
   sysCheckError(ret, "Failed to create/attach interface ", name_);
 
-  // Set configured MTU
-  setMtu(mtu_);
-
   // make fd non-blocking
-  auto flags = fcntl(fd_, F_GETFL);
-  sysCheckError(flags, "Failed to get flags from fd ", fd_);
+  auto flags = fcntl(fd, F_GETFL);
+  sysCheckError(flags, "Failed to get flags from fd ", fd);
   flags |= O_NONBLOCK;
-  ret = fcntl(fd_, F_SETFL, flags);
+  ret = fcntl(fd, F_SETFL, flags);
   sysCheckError(ret, "Failed to set non-blocking flags ", flags,
-                " to fd ", fd_);
-  flags = fcntl(fd_, F_GETFD);
-  sysCheckError(flags, "Failed to get flags from fd ", fd_);
+                " to fd ", fd);
+  flags = fcntl(fd, F_GETFD);
+  sysCheckError(flags, "Failed to get flags from fd ", fd);
   flags |= FD_CLOEXEC;
-  ret = fcntl(fd_, F_SETFD, flags);
+  ret = fcntl(fd, F_SETFD, flags);
   sysCheckError(ret, "Failed to set close-on-exec flags ", flags,
-                " to fd ", fd_);
+                " to fd ", fd);
 
-  XLOG(INFO) << "Create/attach to tun interface " << name_ << " @ fd " << fd_;
+  XLOG(INFO) << "Create/attach to tun interface " << name_ << " @ fd " << fd;
+  return fd;
 }
 
-void TunIntf::closeFD() noexcept {
-  auto ret = close(fd_);
-  sysLogError(ret, "Failed to close fd ", fd_, " for interface ", name_);
+void TunIntf::closeFD(int fd) noexcept {
+  auto ret = close(fd);
+  sysLogError(ret, "Failed to close fd ", fd, " for interface ", name_);
   if (ret == 0) {
-    XLOG(INFO) << "Closed fd " << fd_ << " for interface " << name_;
-    fd_ = -1;
+    XLOG(INFO) << "Closed fd " << fd << " for interface " << name_;
+  }
+}
+
+TunIntf::Queue::Queue(TunIntf* intf, folly::EventBase* evb, int fd)
+    : folly::EventHandler(evb), intf_(intf), evb_(evb), fd_(fd) {
+  DCHECK(evb) << "NULL pointer to EventBase";
+}
+
+TunIntf::Queue::~Queue() {
+  stop();
+  intf_->closeFD(fd_);
+}
+
+void TunIntf::Queue::start() {
+  evb_->runImmediatelyOrRunInEventBaseThreadAndWait([this]() {
+    if (!isHandlerRegistered()) {
+      changeHandlerFD(folly::NetworkSocket::fromFd(fd_));
+      registerHandler(
+          folly::EventHandler::READ | folly::EventHandler::PERSIST);
+    }
+  });
+}
+
+void TunIntf::Queue::stop() {
+  if (!isHandlerRegistered()) {
+    // Nothing to wait for, e.g. on a queue that was never started
+    return;
   }
+  evb_->runImmediatelyOrRunInEventBaseThreadAndWait(
+      [this]() { unregisterHandler(); });
 }
 
 void TunIntf::addAddress(const folly::IPAddress& addr, uint8_t mask) {
@@ -252,7 +320,7 @@ void TunIntf::setMtu(int mtu) {
   ifr.ifr_mtu = mtu_;
   auto ret = ioctl(sock, SIOCSIFMTU, (void*)&ifr);
   sysCheckError(ret, "Failed to set MTU ", ifr.ifr_mtu,
-                " to fd ", fd_, " errno = ", errno);
+                " to interface ", name_, " errno = ", errno);
   XLOG(DBG3) << "Set tun " << name_ << " MTU to " << mtu;
 }
 
@@ -293,8 +361,10 @@ void TunIntf::disableIPv6AddrGenMode(int ifIndex) {
   return;
 }
 
-void TunIntf::handlerReady(uint16_t /*events*/) noexcept {
+void TunIntf::Queue::handlerReady(uint16_t /*events*/) noexcept {
   CHECK(fd_ != -1);
+  auto sw = intf_->sw_;
+  int mtu = intf_->mtu_;
 
   // Since this is L3 packet size, we should also reserve some space for L2
   // header, which is 18 bytes (including one vlan tag)
@@ -303,10 +373,13 @@ void TunIntf::handlerReady(uint16_t /*events*/) noexcept {
   uint64_t bytes = 0;
   bool fdFail = false;
   try {
-    while (sent + dropped < kMaxSentOneTime) {
-      std::unique_ptr<TxPacket> pkt;
-      pkt = sw_->allocateL3TxPacket(mtu_);
-      auto buf = pkt->buf();
+    auto maxPackets = std::max(1, FLAGS_tun_read_batch_size);
+    while (sent + dropped < maxPackets) {
+      if (!spare_ || spareMtu_ != mtu) {
+        spare_ = sw->allocateL3TxPacket(mtu);
+        spareMtu_ = mtu;
+      }
+      auto buf = spare_->buf();
       int ret = 0;
       do {
         ret = read(fd_, buf->writableTail(), buf->tailroom());
@@ -333,7 +406,7 @@ void TunIntf::handlerReady(uint16_t /*events*/) noexcept {
       } else {
         bytes += ret;
         buf->append(ret);
-        sw_->sendL3Packet(std::move(pkt), ifID_);
+        sw->sendL3Packet(std::move(spare_), intf_->ifID_);
         ++sent;
       }
     } // while
@@ -344,15 +417,44 @@ void TunIntf::handlerReady(uint16_t /*events*/) noexcept {
 
   if (fdFail) {
     unregisterHandler();
+    spare_.reset();
   }
+  sw->stats()->tunPacketsPerWakeup(sent + dropped);
 
   XLOG(DBG4) << "Forwarded " << sent << " packets (" << bytes
-             << " bytes) from host @ fd " << fd_ << " for interface " << name_
-             << " dropped:" << dropped;
+             << " bytes) from host @ fd " << fd_ << " for interface "
+             << intf_->name_ << " dropped:" << dropped;
+}
+
+TunIntf::Queue* TunIntf::getQueueForPacket(const uint8_t* data, size_t len)
+    const {
+  if (queues_.size() == 1) {
+    return queues_.front().get();
+  }
+  // Hash the addresses, and the ports of TCP and UDP, so that the packets of
+  // a flow stay in order on one queue
+  uint32_t hash = folly::hash::FNV_32_HASH_START;
+  uint8_t proto = 0;
+  size_t l4Offset = 0;
+  if (len >= 20 && (data[0] >> 4) == 4) {
+    hash = folly::hash::fnv32_buf(data + 12, 8, hash);
+    proto = data[9];
+    l4Offset = (data[0] & 0x0f) * 4;
+  } else if (len >= 40 && (data[0] >> 4) == 6) {
+    hash = folly::hash::fnv32_buf(data + 8, 32, hash);
+    proto = data[6];
+    l4Offset = 40;
+  }
+  if ((proto == static_cast<uint8_t>(IP_PROTO::IP_PROTO_TCP) ||
+       proto == static_cast<uint8_t>(IP_PROTO::IP_PROTO_UDP)) &&
+      len >= l4Offset + 4) {
+    hash = folly::hash::fnv32_buf(data + l4Offset, 4, hash);
+  }
+  return queues_[hash % queues_.size()].get();
 }
 
 bool TunIntf::sendPacketToHost(std::unique_ptr<RxPacket> pkt) {
-  CHECK(fd_ != -1);
+  CHECK(!queues_.empty());
   const int l2Len = EthHdr::SIZE;
 
   auto buf = pkt->buf();
@@ -364,16 +466,22 @@ bool TunIntf::sendPacketToHost(std::unique_ptr<RxPacket> pkt) {
   // skip L2 header
   buf->trimStart(l2Len);
 
-  int ret = 0;
+  // The buffer is the one the packet was received into (for BcmRxPacket
+  // the SDK DMA buffer), so hand it and anything chained to it straight
+  // to the kernel rather than coalescing into a copy first.
+  auto iov = buf->getIov();
+  auto len = buf->computeChainDataLength();
+  auto fd = getQueueForPacket(buf->data(), buf->length())->getFD();
+  ssize_t ret = 0;
   do {
-    ret = write(fd_, buf->data(), buf->length());
+    ret = writev(fd, iov.data(), iov.size());
   } while (ret == -1 && errno == EINTR);
   if (ret < 0) {
     sysLogError(ret, "Failed to send packet to host from Interface ", ifID_);
     return false;
-  } else if (ret < buf->length()) {
+  } else if (static_cast<size_t>(ret) < len) {
     XLOG(ERR) << "Failed to send full packet to host from Interface " << ifID_
-              << ". " << ret << " bytes sent instead of " << buf->length();
+              << ". " << ret << " bytes sent instead of " << len;
     return false;
   }
 
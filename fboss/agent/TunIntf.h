@@ -14,23 +14,37 @@
 #include "fboss/agent/state/StateUtils.h"
 #include <folly/io/async/EventBase.h>
 #include <folly/io/async/EventHandler.h>
+#include <atomic>
+#include <memory>
+#include <vector>
 
 namespace facebook { namespace fboss {
 
 class SwSwitch;
 class RxPacket;
-
-class TunIntf : private folly::EventHandler {
+class TxPacket;
+
+/**
+ * A Tun interface has one queue per EventBase it is given, each with its own
+ * fd. With more than one, the interface is an IFF_MULTI_QUEUE tun device:
+ * the kernel spreads the flows sent by the host over the queues, each read
+ * on its own EventBase, and packets to the host are written to a queue
+ * picked by their flow hash.
+ */
+class TunIntf {
  public:
   /**
    * Creates a TunIntf object of already existing linux interface. Initial
    * status is set to `false` for discovered interfaces because we do not
    * have real port-status info. Once initial config is applied in TunManager
    * their actual status will be reflected.
+   *
+   * An existing interface created with a different number of queues is
+   * attached to with a single queue.
    */
   TunIntf(
       SwSwitch *sw,
-      folly::EventBase *evb,
+      const std::vector<folly::EventBase*>& evbs,
       InterfaceID ifID,
       int ifIndex /* linux */,
       int mtu);
@@ -40,7 +54,7 @@ class TunIntf : private folly::EventHandler {
    */
   TunIntf(
       SwSwitch *sw,
-      folly::EventBase *evb,
+      const std::vector<folly::EventBase*>& evbs,
       InterfaceID ifID,   // Switch interface ID
       bool status,
       const Interface::Addresses& addrs,
@@ -119,23 +133,72 @@ class TunIntf : private folly::EventHandler {
     return mtu_;
   }
 
+  size_t getNumQueues() const {
+    return queues_.size();
+  }
+
   bool getStatus() const {
     return status_;
   }
 
  private:
   /**
-   * Callback for event on Tun interface's read socket-fd
-   * Override's folly::EventHandler handlerReady callback.
+   * One fd of the interface, read from on its EventBase. Its handler is
+   * (un)registered on that EventBase's thread.
    */
-  void handlerReady(uint16_t events) noexcept override;
+  class Queue : private folly::EventHandler {
+   public:
+    Queue(TunIntf* intf, folly::EventBase* evb, int fd);
+    ~Queue() override;
+
+    void start();
+    void stop();
+
+    int getFD() const {
+      return fd_;
+    }
+
+   private:
+    // Forbidden copy constructor and assignment operator
+    Queue(Queue const &) = delete;
+    Queue& operator=(Queue const &) = delete;
+
+    /**
+     * Callback for event on the queue's read socket-fd
+     * Override's folly::EventHandler handlerReady callback.
+     */
+    void handlerReady(uint16_t events) noexcept override;
+
+    TunIntf* intf_{nullptr};
+    folly::EventBase* evb_{nullptr};
+    int fd_{-1};
+
+    /**
+     * Packet buffer allocated for the next read from fd_. The read that finds
+     * the fd drained would otherwise allocate (and free) a packet on every
+     * wakeup, so it is kept for the next one. spareMtu_ is the mtu it was
+     * sized for.
+     */
+    std::unique_ptr<TxPacket> spare_;
+    int spareMtu_{-1};
+  };
 
   /**
-   * Open/Close a new socket-fd to read/write data from Tun interface.
-   * fd_ is mutated.
+   * Open a new socket-fd to read/write data from Tun interface, as a queue
+   * of a multi-queue device if multiQueue is set.
    */
-  void openFD();
-  void closeFD() noexcept;
+  int openFD(bool multiQueue);
+  void closeFD(int fd) noexcept;
+
+  /**
+   * Open a queue on each of evbs. If attachAny is set and the device exists
+   * with a different number of queues, a single queue is opened on the first
+   * of evbs instead.
+   */
+  void openQueues(const std::vector<folly::EventBase*>& evbs, bool attachAny);
+
+  // The queue to send a packet of L3 length len at data to the host on
+  Queue* getQueueForPacket(const uint8_t* data, size_t len) const;
 
   /**
    * In newer kernel an interface is automatically gets link-local IPv6 address
@@ -158,11 +221,12 @@ class TunIntf : private folly::EventHandler {
   Interface::Addresses addrs_;  // The IP addresses assigned to this intf
 
   /**
-   * File descriptor for this interface through which packets can
-   * be received from or sent to.
+   * Queues of this interface, through which packets can be received from
+   * or sent to. The first one's fd holds the interface's persist flag.
    */
-  int fd_{-1};
-  int mtu_{-1};
+  std::vector<std::unique_ptr<Queue>> queues_;
+  // Read by the queues on their EventBases
+  std::atomic<int> mtu_{-1};
 };
 
 }}  // nanesoace facebook::fboss
@@ -18,10 +18,12 @@ extern "C" {
 #include <sys/ioctl.h>
 }
 
+#include <folly/Conv.h>
 #include <folly/Demangle.h>
 #include <folly/MapUtil.h>
 #include <folly/io/async/EventBase.h>
 #include <folly/logging/xlog.h>
+#include <gflags/gflags.h>
 #include "fboss/agent/NlError.h"
 #include "fboss/agent/RxPacket.h"
 #include "fboss/agent/SysError.h"
@@ -29,10 +31,19 @@ extern "C" {
 #include "fboss/agent/state/Interface.h"
 #include "fboss/agent/state/InterfaceMap.h"
 #include "fboss/agent/state/Port.h"
+#include "fboss/agent/state/StateDelta.h"
 #include "fboss/agent/state/SwitchState.h"
+#include "fboss/agent/state/Vlan.h"
+#include "fboss/agent/state/VlanMap.h"
 
 #include <boost/container/flat_set.hpp>
 
+DEFINE_int32(
+    tun_queues,
+    1,
+    "Queues per tun interface, each read on its own thread. With more than "
+    "one the interfaces are multi-queue, so host traffic scales across cores");
+
 namespace {
   const int kDefaultMtu = 1500;
 }
@@ -52,6 +63,19 @@ TunManager::TunManager(SwSwitch *sw, EventBase *evb) : sw_(sw), evb_(evb) {
   }
   auto error = nl_connect(sock_, NETLINK_ROUTE);
   nlCheckError(error, "failed to connect netlink socket to NETLINK_ROUTE");
+
+  for (int i = 1; i < FLAGS_tun_queues; ++i) {
+    queueThreads_.push_back(std::make_unique<folly::ScopedEventBaseThread>(
+        folly::to<std::string>("TunQueue", i)));
+  }
+}
+
+std::vector<EventBase*> TunManager::getQueueEventBases() const {
+  std::vector<EventBase*> evbs{evb_};
+  for (const auto& thread : queueThreads_) {
+    evbs.push_back(thread->getEventBase());
+  }
+  return evbs;
 }
 
 TunManager::~TunManager() {
@@ -65,32 +89,88 @@ TunManager::~TunManager() {
 }
 
 void TunManager::startObservingUpdates() {
-  sw_->registerStateObserver(this, "TunManager");
+  // sync() does netlink calls, so keep it off the update thread
+  sw_->registerAsyncStateObserver(this, "TunManager", evb_);
   observingState_ = true;
 }
 
 void TunManager::stateUpdated(const StateDelta& delta) {
-  // TODO(aeckert): t15067879 We currently compare the entire
-  // interface map instead of using the iterator in this delta because
-  // some of the interfaces may get get probed from hardware before
-  // they are in the SwitchState. It would be nicer if we did a little
-  // more work at startup to sync the state, perhaps updating the
-  // SwitchState with the probed interfaces. This would allow us to
-  // reuse the iterator in the delta for more readable code and also
-  // not have to worry about waiting to listen to updates until the
-  // SwSwitch is in the configured state. t4155406 should also help
-  // with that.
-
-  auto state = delta.newState();
-  evb_->runInEventBaseThread([this, state]() {
-    this->sync(state);
-  });
+  // Called on evb_ since we observe updates asynchronously
+  DCHECK(evb_->isInEventBaseThread());
+
+  // Until the first sync some of the interfaces may have been probed from
+  // the host without being in the SwitchState yet, so the first sync must
+  // compare the entire interface map. After that intfs_ mirrors the kernel
+  // and only the interfaces touched by this delta can need any work.
+  if (numSyncs_ == 0) {
+    sync(delta.newState());
+    return;
+  }
+
+  auto changed = getChangedInterfaces(delta);
+  if (changed.empty()) {
+    return;
+  }
+  doSync(delta.newState(), &changed);
+}
+
+TunManager::InterfaceIDs TunManager::getChangedInterfaces(
+    const StateDelta& delta) {
+  InterfaceIDs changed;
+  for (const auto& intfDelta : delta.getIntfsDelta()) {
+    const auto& intf =
+        intfDelta.getNew() ? intfDelta.getNew() : intfDelta.getOld();
+    changed.insert(intf->getID());
+  }
+
+  for (const auto& vlanDelta : delta.getVlansDelta()) {
+    auto oldVlan = vlanDelta.getOld();
+    auto newVlan = vlanDelta.getNew();
+    if (oldVlan && newVlan &&
+        oldVlan->getInterfaceID() == newVlan->getInterfaceID()) {
+      // Neighbor table churn does not affect the host interfaces
+      continue;
+    }
+    if (oldVlan) {
+      changed.insert(oldVlan->getInterfaceID());
+    }
+    if (newVlan) {
+      changed.insert(newVlan->getInterfaceID());
+    }
+  }
+
+  // Port up/down and membership changes may flip an interface's status
+  auto addPortIntfs = [&changed](
+                          const std::shared_ptr<SwitchState>& state,
+                          const Port* port) {
+    for (const auto& vlanIDToInfo : port->getVlans()) {
+      auto vlan = state->getVlans()->getVlanIf(vlanIDToInfo.first);
+      if (vlan) {
+        changed.insert(vlan->getInterfaceID());
+      }
+    }
+  };
+  for (const auto& portDelta : delta.getPortsDelta()) {
+    auto oldPort = portDelta.getOld();
+    auto newPort = portDelta.getNew();
+    if (oldPort && newPort && oldPort->isPortUp() == newPort->isPortUp() &&
+        oldPort->getVlans() == newPort->getVlans()) {
+      continue;
+    }
+    if (oldPort) {
+      addPortIntfs(delta.oldState(), oldPort.get());
+    }
+    if (newPort) {
+      addPortIntfs(delta.newState(), newPort.get());
+    }
+  }
+  return changed;
 }
 
 bool TunManager::sendPacketToHost(
     InterfaceID dstIfID,
     std::unique_ptr<RxPacket> pkt) {
-  std::lock_guard<std::mutex> lock(mutex_);
+  folly::SharedMutex::ReadHolder lock(mutex_);
   auto iter = intfs_.find(dstIfID);
   if (iter == intfs_.end()) {
     // the Interface ID has been deleted, make a log, and skip the pkt
@@ -113,7 +193,8 @@ void TunManager::addExistingIntf(
     intfs_.erase(ret.first);
   };
   ret.first->second.reset(
-      new TunIntf(sw_, evb_, ifID, ifIndex, getInterfaceMtu(ifID)));
+      new TunIntf(
+          sw_, getQueueEventBases(), ifID, ifIndex, getInterfaceMtu(ifID)));
 }
 
 void TunManager::addNewIntf(
@@ -129,7 +210,7 @@ void TunManager::addNewIntf(
     intfs_.erase(ret.first);
   };
   auto intf = std::make_unique<TunIntf>(
-      sw_, evb_, ifID, isUp, addrs, getInterfaceMtu(ifID));
+      sw_, getQueueEventBases(), ifID, isUp, addrs, getInterfaceMtu(ifID));
 
   SCOPE_FAIL {
     intf->setDelete();
@@ -522,11 +603,11 @@ void TunManager::addressProcessor(struct nl_object *obj, void *data) {
 }
 
 void TunManager::probe() {
-  std::lock_guard<std::mutex> lock(mutex_);
+  folly::SharedMutex::WriteHolder lock(mutex_);
   doProbe(lock);
 }
 
-void TunManager::doProbe(std::lock_guard<std::mutex>& /* lock */) {
+void TunManager::doProbe(folly::SharedMutex::WriteHolder& /* lock */) {
   const auto startTs = std::chrono::steady_clock::now();
   SCOPE_EXIT {
     const auto endTs = std::chrono::steady_clock::now();
@@ -602,6 +683,12 @@ void TunManager::forceInitialSync() {
 }
 
 void TunManager::sync(std::shared_ptr<SwitchState> state) {
+  doSync(state, nullptr);
+}
+
+void TunManager::doSync(
+    std::shared_ptr<SwitchState> state,
+    const InterfaceIDs* intfIDs) {
   CHECK(evb_->isInEventBaseThread());
   using Addresses = Interface::Addresses;
   using ConstAddressesIter = Addresses::const_iterator;
@@ -615,7 +702,13 @@ void TunManager::sync(std::shared_ptr<SwitchState> state) {
   // prepare new addresses
   IntfToAddrsMap newIntfToInfo;
   auto intfMap = state->getInterfaces();
+  auto isSynced = [intfIDs](InterfaceID ifID) {
+    return !intfIDs || intfIDs->count(ifID);
+  };
   for (const auto& intf : intfMap->getAllNodes()) {
+    if (!isSynced(intf.first)) {
+      continue;
+    }
     const auto& addrs = intf.second->getAddresses();
 
     // Ideally all interfaces should be present in intfStatusMap as either
@@ -628,7 +721,7 @@ void TunManager::sync(std::shared_ptr<SwitchState> state) {
   }
 
   // Hold mutex while changing interfaces
-  std::lock_guard<std::mutex> lock(mutex_);
+  folly::SharedMutex::WriteHolder lock(mutex_);
   if (!probeDone_) {
     doProbe(lock);
   }
@@ -636,6 +729,9 @@ void TunManager::sync(std::shared_ptr<SwitchState> state) {
   // prepare old addresses
   IntfToAddrsMap oldIntfToInfo;
   for (const auto& intf : intfs_) {
+    if (!isSynced(intf.first)) {
+      continue;
+    }
     const auto& addrs = intf.second->getAddresses();
     bool status = intf.second->getStatus();
     oldIntfToInfo[intf.first] = {status, addrs};
@@ -12,9 +12,12 @@
 #include "fboss/agent/types.h"
 #include "fboss/agent/StateObserver.h"
 #include "fboss/agent/state/Interface.h"
+#include <folly/SharedMutex.h>
 #include <folly/io/async/EventBase.h>
+#include <folly/io/async/ScopedEventBaseThread.h>
 
 #include <boost/container/flat_map.hpp>
+#include <boost/container/flat_set.hpp>
 
 extern "C" {
 #include <netlink/socket.h>
@@ -35,8 +38,12 @@ class TunManager : public StateObserver {
 
   /**
    * Update the intfs_ map based on the given state update. This
-   * overrides the StateObserver stateUpdated api, which is always
-   * guaranteed to be called from the update thread.
+   * overrides the StateObserver stateUpdated api. TunManager observes
+   * updates asynchronously, so this is called from the thread serving evb_.
+   *
+   * Once the initial sync is done only the interfaces touched by the delta
+   * are compared against intfs_, which mirrors what we programmed in the
+   * kernel, so unrelated updates cost no netlink calls at all.
    */
   void stateUpdated(const StateDelta& delta) override;
 
@@ -182,7 +189,7 @@ class TunManager : public StateObserver {
   /**
    * Lookup host for existing Tun interfaces and their addresses.
    */
-  virtual void doProbe(std::lock_guard<std::mutex>& mutex);
+  virtual void doProbe(folly::SharedMutex::WriteHolder& lock);
 
   /**
    * Add an address to a TUN interface during probe process.
@@ -194,6 +201,21 @@ class TunManager : public StateObserver {
    */
   int getInterfaceMtu(InterfaceID ifID) const;
 
+  using InterfaceIDs = boost::container::flat_set<InterfaceID>;
+
+  /**
+   * Interfaces whose status, addresses or MTU may differ between the old
+   * and new state of the delta: changed interfaces, interfaces of VLANs
+   * that changed and interfaces of ports that went up/down or changed VLANs.
+   */
+  static InterfaceIDs getChangedInterfaces(const StateDelta& delta);
+
+  /**
+   * Bring the kernel in line with the given state. If intfIDs is non-null
+   * only those interfaces are synced and the rest of intfs_ is left alone.
+   */
+  void doSync(std::shared_ptr<SwitchState> state, const InterfaceIDs* intfIDs);
+
   /**
    * Get Interface statuses map from a given SwitchState. In switch each
    * Interface/VLAN consists of multiple Ports. We derive state of Interface
@@ -207,19 +229,30 @@ class TunManager : public StateObserver {
   void applyChanges(const MAPNAME& oldMap, const MAPNAME& newMap,
                     CHANGEFN changeFn, ADDFN addFn, REMOVEFN removeFn);
 
+  // EventBases the queues of each interface are read on, see TunIntf
+  std::vector<folly::EventBase*> getQueueEventBases() const;
+
   SwSwitch *sw_{nullptr};
   folly::EventBase *evb_{nullptr};
 
+  /**
+   * With --tun_queues > 1, threads for all but the first queue of each
+   * interface, which is read on evb_. They outlive intfs_.
+   */
+  std::vector<std::unique_ptr<folly::ScopedEventBaseThread>> queueThreads_;
+
   // Netlink socket for managing interface/addresses in Host/Linux
   nl_sock *sock_{nullptr};
 
   /**
    * The mutex used to protect `intfs_` which can be used by
    * sync() could manipulate intfs_. Called on the thread that serves evb_.
-   * sendPacketToHost() uses intfs_, it can be called from any thread.
+   * sendPacketToHost() uses intfs_, it can be called from any thread, and
+   * only takes it shared so packets to different interfaces or queues are
+   * sent in parallel.
    */
   boost::container::flat_map<InterfaceID, std::unique_ptr<TunIntf>> intfs_;
-  std::mutex mutex_;
+  folly::SharedMutex mutex_;
 
   // Whether the manager has registered itself to listen for state updates
   // from sw_
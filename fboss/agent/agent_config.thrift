@@ -8,6 +8,25 @@ namespace cpp2 facebook.fboss.cfg
 include "fboss/agent/switch_config.thrift"
 include "fboss/agent/platform_config.thrift"
 
+enum ThreadSchedPolicy {
+  // The default time sharing policy, prioritized by nice
+  OTHER = 0,
+  // Real time, prioritized by priority
+  FIFO = 1,
+  RR = 2,
+}
+
+// Where and how an agent thread is scheduled
+struct ThreadPlacement {
+  // CPUs the thread may run on, all if empty
+  1: list<i32> cpus = [],
+  2: ThreadSchedPolicy policy = OTHER,
+  // 1-99, for FIFO and RR
+  3: i32 priority = 0,
+  // -20-19, for OTHER
+  4: i32 nice = 0,
+}
+
 struct AgentConfig {
   // This is used to override the default command line arguments we
   // pass to the agent.
@@ -21,4 +40,17 @@ struct AgentConfig {
   // configuration (e.g broadcom config), as well as low-level port
   // tuning params.
   3: optional platform_config.PlatformConfig platform,
+
+  // Placement of agent threads, applied as they start, keyed by thread name
+  // (eg "fbossUpdateThread"), or by a name prefix followed by '*' (eg
+  // "fbossNeighborCache*"). Threads the SDK starts are matched by their
+  // names under /proc/self/task, which are cut to 15 characters.
+  4: map<string, ThreadPlacement> threads = {},
+}
+
+// An AgentConfig as kept by --config_cache_dir, so an unchanged config need
+// not be parsed again. key identifies the raw config and the agent binary.
+struct CompiledAgentConfig {
+  1: i64 key,
+  2: AgentConfig config,
 }
@@ -9,19 +9,38 @@
  */
 #include "fboss/agent/capture/PcapFile.h"
 
+#include "fboss/agent/FbossError.h"
 #include "fboss/agent/capture/PcapPkt.h"
 
+#include <folly/Bits.h>
 #include <folly/Exception.h>
 #include <folly/FileUtil.h>
+#include <folly/io/Cursor.h>
 
 #include <chrono>
 
 using folly::IOBuf;
+using folly::readFull;
 using folly::writeFull;
 using folly::writevFull;
 using std::chrono::microseconds;
 using std::chrono::seconds;
 
+namespace {
+constexpr uint32_t kPcapMagic = 0xa1b2c3d4;
+constexpr uint32_t kLinkTypeEthernet = 1;
+
+struct GlobalHeader {
+  uint32_t magic;
+  uint16_t versionMajor;
+  uint16_t versionMinor;
+  uint32_t tzOffset;
+  uint32_t sigfigs;
+  uint32_t snaplen;
+  uint32_t linkType;
+};
+} // namespace
+
 namespace facebook { namespace fboss {
 
 PcapFile::PktHeader::PktHeader(const PcapPkt& pkt) {
@@ -44,6 +63,8 @@ PcapFile::PcapFile(folly::StringPiece path,
   : file_(path.str().c_str(), openFlags(overwriteExisting), 0644) {
 }
 
+PcapFile::PcapFile(folly::File file) : file_(std::move(file)) {}
+
 PcapFile::~PcapFile() {
 }
 
@@ -52,16 +73,8 @@ void PcapFile::close() {
 }
 
 void PcapFile::writeGlobalHeader() {
-  struct GlobalHeader {
-    uint32_t magic;
-    uint16_t versionMajor;
-    uint16_t versionMinor;
-    uint32_t tzOffset;
-    uint32_t sigfigs;
-    uint32_t snaplen;
-    uint32_t linkType;
-  } hdr;
-  hdr.magic = 0xa1b2c3d4;
+  GlobalHeader hdr;
+  hdr.magic = kPcapMagic;
   hdr.versionMajor = 2;
   hdr.versionMinor = 4;
   hdr.tzOffset = 0;
@@ -69,7 +82,7 @@ void PcapFile::writeGlobalHeader() {
   hdr.snaplen = 0xffff;
   // Link type 1 is ethernet.  Other possible types we might want to use
   // include 113 for linux "cooked" capture format.
-  hdr.linkType = 1;
+  hdr.linkType = kLinkTypeEthernet;
 
   int ret = writeFull(file_.fd(), &hdr, sizeof(hdr));
   folly::checkUnixError(ret, "error writing pcap global header");
@@ -96,6 +109,76 @@ void PcapFile::writePackets(const std::vector<PcapPkt>& pkts) {
   folly::checkUnixError(ret, "error writing pcap data");
 }
 
+void PcapFile::write(const IOBuf& buf) {
+  folly::fbvector<struct iovec> iov;
+  buf.appendToIov(&iov);
+  int ret = writevFull(file_.fd(), iov.data(), iov.size());
+  folly::checkUnixError(ret, "error writing pcap data");
+}
+
+bool PcapFile::appendPacket(const PcapPkt& pkt, IOBuf* buf) {
+  PktHeader hdr(pkt);
+  if (buf->tailroom() < sizeof(PktHeader) + hdr.includedLen) {
+    return false;
+  }
+  memcpy(buf->writableTail(), &hdr, sizeof(PktHeader));
+  buf->append(sizeof(PktHeader));
+  folly::io::Cursor(pkt.buf()).pull(buf->writableTail(), hdr.includedLen);
+  buf->append(hdr.includedLen);
+  return true;
+}
+
+PcapFile PcapFile::openForReading(folly::StringPiece path) {
+  return PcapFile(folly::File(path.str().c_str(), O_RDONLY));
+}
+
+void PcapFile::readGlobalHeader() {
+  GlobalHeader hdr;
+  auto ret = readFull(file_.fd(), &hdr, sizeof(hdr));
+  folly::checkUnixError(ret, "error reading pcap global header");
+  if (ret != static_cast<ssize_t>(sizeof(hdr))) {
+    throw FbossError("truncated pcap global header");
+  }
+  if (hdr.magic == folly::Endian::swap(kPcapMagic)) {
+    swapped_ = true;
+  } else if (hdr.magic != kPcapMagic) {
+    throw FbossError("not a pcap file, magic ", hdr.magic);
+  }
+  if (fromFile(hdr.linkType) != kLinkTypeEthernet) {
+    throw FbossError("pcap link type ", fromFile(hdr.linkType),
+                     " is not ethernet");
+  }
+}
+
+bool PcapFile::readPacket(
+    std::chrono::system_clock::time_point* timestamp,
+    std::unique_ptr<IOBuf>* buf) {
+  PktHeader hdr;
+  auto ret = readFull(file_.fd(), &hdr, sizeof(hdr));
+  folly::checkUnixError(ret, "error reading pcap packet header");
+  if (ret == 0) {
+    return false;
+  } else if (ret != static_cast<ssize_t>(sizeof(hdr))) {
+    throw FbossError("truncated pcap packet header");
+  }
+  uint32_t len = fromFile(hdr.includedLen);
+  auto data = IOBuf::create(len);
+  ret = readFull(file_.fd(), data->writableData(), len);
+  folly::checkUnixError(ret, "error reading pcap packet data");
+  if (ret != static_cast<ssize_t>(len)) {
+    throw FbossError("truncated pcap packet of ", len, " bytes");
+  }
+  data->append(len);
+  *timestamp = std::chrono::system_clock::time_point(
+      seconds(fromFile(hdr.timeSec)) + microseconds(fromFile(hdr.timeUsec)));
+  *buf = std::move(data);
+  return true;
+}
+
+uint32_t PcapFile::fromFile(uint32_t value) const {
+  return swapped_ ? folly::Endian::swap(value) : value;
+}
+
 int PcapFile::openFlags(bool overwriteExisting) {
   int flags = O_CREAT | O_WRONLY;
   if (!overwriteExisting) {
@@ -11,6 +11,9 @@
 
 #include <folly/File.h>
 #include <folly/Range.h>
+#include <folly/io/IOBuf.h>
+#include <chrono>
+#include <memory>
 #include <vector>
 
 namespace facebook { namespace fboss {
@@ -18,7 +21,8 @@ namespace facebook { namespace fboss {
 class PcapPkt;
 
 /*
- * PcapFile supports writing packets to a file in pcap format.
+ * PcapFile supports writing packets to a file in pcap format, and reading
+ * them back.
  *
  * PcapFile uses blocking I/O.  If you are recording packets from a
  * non-blocking thread, you should use PcapWriter instead of using PcapFile
@@ -35,12 +39,44 @@ class PcapFile {
   void writeGlobalHeader();
   void writePackets(const std::vector<PcapPkt>& pkt);
 
+  /*
+   * Write out a buffer of records built with appendPacket(), so callers can
+   * format packets in one thread and do the blocking write in another.
+   */
+  void write(const folly::IOBuf& buf);
+
+  /*
+   * Append the pcap record for pkt to the tailroom of buf.  Returns false,
+   * leaving buf untouched, if the record does not fit.
+   */
+  static bool appendPacket(const PcapPkt& pkt, folly::IOBuf* buf);
+
+  /*
+   * Open an existing pcap file to read its packets with readGlobalHeader()
+   * and readPacket().
+   */
+  static PcapFile openForReading(folly::StringPiece path);
+
+  /*
+   * Read the global header.  Throws an FbossError if this is not a pcap file
+   * of ethernet frames.  Files written on hosts of either byte order work.
+   */
+  void readGlobalHeader();
+
+  /*
+   * Read the next packet, returning false at the end of the file.
+   */
+  bool readPacket(
+      std::chrono::system_clock::time_point* timestamp,
+      std::unique_ptr<folly::IOBuf>* buf);
+
   // Move constructor and assignment operator
   PcapFile(PcapFile&&) = default;
   PcapFile& operator=(PcapFile&&) = default;
 
  private:
   struct PktHeader {
+    PktHeader() {}
     explicit PktHeader(const PcapPkt& pkt);
 
     uint32_t timeSec{0};
@@ -53,9 +89,14 @@ class PcapFile {
   PcapFile(PcapFile const &) = delete;
   PcapFile& operator=(PcapFile const &) = delete;
 
+  explicit PcapFile(folly::File file);
+
   static int openFlags(bool overwriteExisting);
+  uint32_t fromFile(uint32_t value) const;
 
   folly::File file_;
+  // Whether the file being read was written in the other byte order
+  bool swapped_{false};
 };
 
 }} // facebook::fboss
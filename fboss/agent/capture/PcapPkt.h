@@ -79,7 +79,7 @@ class PcapPkt {
   const folly::IOBuf* buf() const {
     return &buf_;
   }
-  std::vector<RxReason> getReasons(){
+  std::vector<RxReason> getReasons() const {
     return reasons_;
   }
 
@@ -11,7 +11,6 @@
 
 #include "fboss/agent/RxPacket.h"
 #include "fboss/agent/TxPacket.h"
-#include "fboss/agent/capture/PcapPkt.h"
 
 DEFINE_int32(fboss_pcap_queue_depth, 10240,
              "When taking packet captures, the maximum number of packets "
@@ -20,99 +19,148 @@ DEFINE_int32(fboss_pcap_queue_depth, 10240,
 
 namespace facebook { namespace fboss {
 
-PcapQueue::PcapQueue(uint32_t pktCapacity, uint64_t bytesCapacity)
+PcapQueue::PcapQueue(uint32_t pktCapacity, uint64_t bytesCapacity,
+                     DropPolicy dropPolicy)
   : pktCapacity_(pktCapacity == 0 ?
                  FLAGS_fboss_pcap_queue_depth : pktCapacity),
-    bytesCapacity_(bytesCapacity) {
-  queue_.reserve(pktCapacity_);
+    bytesCapacity_(bytesCapacity),
+    dropPolicy_(dropPolicy),
+    queue_(pktCapacity_ + 1) {
 }
 
 PcapQueue::~PcapQueue() {
 }
 
+bool PcapQueue::isFull(uint64_t newBytes) const {
+  if (queue_.sizeGuess() >= static_cast<ssize_t>(pktCapacity_)) {
+    return true;
+  }
+  return bytesCapacity_ > 0 &&
+    bytesInQueue_.load(std::memory_order_relaxed) + newBytes >= bytesCapacity_;
+}
+
+void PcapQueue::pktRemoved(const PcapPkt& pkt) {
+  if (bytesCapacity_ > 0) {
+    bytesInQueue_.fetch_sub(pkt.buf()->computeChainDataLength(),
+                            std::memory_order_relaxed);
+  }
+}
+
 template<typename PktType>
 void PcapQueue::addPktInternal(const PktType* pkt) {
-  // Check to see if this would exceed the queue capacity.
-  if (queue_.size() >= pktCapacity_) {
-    pktsDropped_ += 1;
+  if (finished_.load(std::memory_order_acquire)) {
     return;
   }
-  auto newBytes = bytesInQueue_ + pkt->buf()->computeChainDataLength();
-  if (bytesCapacity_ > 0 && newBytes >= bytesCapacity_) {
-    pktsDropped_ += 1;
+
+  uint64_t newBytes =
+    bytesCapacity_ > 0 ? pkt->buf()->computeChainDataLength() : 0;
+  if (dropPolicy_ == DropPolicy::DROP_OLDEST) {
+    // Make room by throwing away whatever has waited longest.
+    while (isFull(newBytes)) {
+      PcapPkt oldest;
+      if (!queue_.read(oldest)) {
+        // The reader emptied the ring before we could.
+        break;
+      }
+      if (!oldest.initialized()) {
+        // We raced with finish() and took its end marker.  Put it back;
+        // nothing more is being captured anyway.
+        queue_.blockingWrite(std::move(oldest));
+        pktsDropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+      pktRemoved(oldest);
+      pktsDropped_.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+  if (isFull(newBytes)) {
+    pktsDropped_.fetch_add(1, std::memory_order_relaxed);
     return;
   }
 
-  queue_.emplace_back(pkt);
-}
-
-void PcapQueue::addPkt(const RxPacket* pkt) {
-  {
-    std::lock_guard<std::mutex> guard(mutex_);
-    addPktInternal(pkt);
+  if (bytesCapacity_ > 0) {
+    bytesInQueue_.fetch_add(newBytes, std::memory_order_relaxed);
+  }
+  if (!queue_.write(pkt)) {
+    // Another writer took the last slot after our capacity check
+    if (bytesCapacity_ > 0) {
+      bytesInQueue_.fetch_sub(newBytes, std::memory_order_relaxed);
+    }
+    pktsDropped_.fetch_add(1, std::memory_order_relaxed);
   }
-  cv_.notify_one();
 }
 
-void PcapQueue::addPktLocked(const RxPacket* pkt) {
+void PcapQueue::addPkt(const RxPacket* pkt) {
   addPktInternal(pkt);
-  // It is preferred not to be holding the lock when we signal cv_,
-  // but it is okay to call it with the lock held anyway.  (Having the lock
-  // held will just prevent the reader thread from being able to acquire it
-  // immediately when the reader wakes.)
-  cv_.notify_one();
 }
 
 void PcapQueue::addPkt(const TxPacket* pkt) {
-  {
-    std::lock_guard<std::mutex> guard(mutex_);
-    addPktInternal(pkt);
-  }
-  cv_.notify_one();
-}
-
-void PcapQueue::addPktLocked(const TxPacket* pkt) {
   addPktInternal(pkt);
-  // It is preferred not to be holding the lock when we signal cv_,
-  // but it is okay to call it with the lock held anyway.  (Having the lock
-  // held will just prevent the reader thread from being able to acquire it
-  // immediately when the reader wakes.)
-  cv_.notify_one();
 }
 
 void PcapQueue::finish() {
-  std::lock_guard<std::mutex> guard(mutex_);
-  finished_ = true;
-  cv_.notify_all();
+  if (finished_.exchange(true, std::memory_order_acq_rel)) {
+    return;
+  }
+  // An uninitialized PcapPkt marks the end of the queue for the reader.
+  // The spare slot is normally free for it, unless writers racing the
+  // capacity check filled it, in which case drop the oldest to make room.
+  while (!queue_.write()) {
+    PcapPkt oldest;
+    if (queue_.read(oldest)) {
+      pktRemoved(oldest);
+      pktsDropped_.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
 }
 
 bool PcapQueue::isFinished() const {
-  std::lock_guard<std::mutex> guard(mutex_);
-  return finished_;
+  return finished_.load(std::memory_order_acquire);
 }
 
 uint64_t PcapQueue::numDropped() const {
-  std::lock_guard<std::mutex> guard(mutex_);
-  return pktsDropped_;
+  return pktsDropped_.load(std::memory_order_relaxed);
 }
 
 bool PcapQueue::wait(std::vector<PcapPkt>* swapQueue) {
   swapQueue->clear();
-  swapQueue->reserve(pktCapacity_);
-
-  std::unique_lock<std::mutex> guard(mutex_);
-  while (queue_.empty() && !finished_) {
-    cv_.wait(guard);
+  if (readerDone_) {
+    return false;
   }
-  if (queue_.empty()) {
-    DCHECK(finished_);
-    queue_.shrink_to_fit();
+
+  PcapPkt pkt;
+  queue_.blockingRead(pkt);
+  return drain(std::move(pkt), swapQueue);
+}
+
+bool PcapQueue::wait(std::vector<PcapPkt>* swapQueue,
+                     std::chrono::milliseconds timeout) {
+  swapQueue->clear();
+  if (readerDone_) {
     return false;
   }
 
-  swapQueue->swap(queue_);
-  bytesInQueue_ = 0;
-  return true;
+  PcapPkt pkt;
+  auto deadline = std::chrono::steady_clock::now() + timeout;
+  if (!queue_.tryReadUntil(deadline, pkt)) {
+    return true;
+  }
+  return drain(std::move(pkt), swapQueue);
+}
+
+bool PcapQueue::drain(PcapPkt pkt, std::vector<PcapPkt>* swapQueue) {
+  swapQueue->reserve(pktCapacity_);
+  while (pkt.initialized()) {
+    pktRemoved(pkt);
+    swapQueue->push_back(std::move(pkt));
+    if (swapQueue->size() >= pktCapacity_ || !queue_.read(pkt)) {
+      return true;
+    }
+  }
+
+  // We got the end marker from finish()
+  readerDone_ = true;
+  return !swapQueue->empty();
 }
 
 }} // facebook::fboss
@@ -9,48 +9,51 @@
  */
 #pragma once
 
-#include <condition_variable>
-#include <mutex>
+#include "fboss/agent/capture/PcapPkt.h"
+
+#include <folly/MPMCQueue.h>
+
+#include <atomic>
+#include <chrono>
 #include <vector>
 
 namespace facebook { namespace fboss {
 
 class RxPacket;
 class TxPacket;
-class PcapPkt;
 
 /*
  * PcapQueue stores a queue of PcapPkt objects, for transferring packets
  * from an asynchronous capture thread to a blocking thread that will process
  * the packets.  (For instance, writing them to disk using blocking I/O.)
  *
- * There can only be a single reader.
+ * The queue is a bounded lock-free ring, so adding a packet never blocks
+ * the RX or TX path behind the reader.  Once the ring is full, the drop
+ * policy picks which packet is lost: the one being added, or the oldest one
+ * still waiting to be read.
+ *
+ * Packets may be added from any thread.  There can only be a single reader.
  */
 class PcapQueue {
  public:
-  explicit PcapQueue(uint32_t pktCapacity, uint64_t bytesCapacity = 0);
+  enum class DropPolicy {
+    DROP_NEWEST,
+    DROP_OLDEST,
+  };
+
+  explicit PcapQueue(uint32_t pktCapacity, uint64_t bytesCapacity = 0,
+                     DropPolicy dropPolicy = DropPolicy::DROP_NEWEST);
   virtual ~PcapQueue();
 
   uint32_t getPktCapacity() const {
-    // pktCapacity_ is const, so no need for locking
     return pktCapacity_;
   }
-
-  /*
-   * Get the mutex protecting this PcapQueue.
-   *
-   * This is exposed to allow callers to also protect their own data
-   * with the same mutex if desired.  Callers should call addPktLocked()
-   * instead of addPkt() when they are already holding the PcapQueue mutex.
-   */
-  std::mutex& mutex() const {
-    return mutex_;
+  DropPolicy getDropPolicy() const {
+    return dropPolicy_;
   }
 
   void addPkt(const RxPacket* pkt);
-  void addPktLocked(const RxPacket* pkt);
   void addPkt(const TxPacket* pkt);
-  void addPktLocked(const TxPacket* pkt);
 
   /*
    * finish() signals that no more packets will be added to the queue.
@@ -71,13 +74,21 @@ class PcapQueue {
   uint64_t numDropped() const;
 
   /*
-   * Wait for new packets from the queue.
+   * Wait for new packets from the queue, and move everything queued so far
+   * (up to the packet capacity) into swapQueue.
    *
    * Note: for best performance, the writer should re-use the same vector
    * for multiple wait() calls.  On subsequent calls the queue will already
    * have the desired capacity, and will not need to reallocate memory.
    */
   bool wait(std::vector<PcapPkt>* swapQueue);
+  /*
+   * As above, but give up after timeout if no packets arrive.  This still
+   * returns true on timeout, since more packets may follow, just with an
+   * empty swapQueue.
+   */
+  bool wait(std::vector<PcapPkt>* swapQueue,
+            std::chrono::milliseconds timeout);
 
  private:
   // Forbidden copy constructor and assignment operator
@@ -86,16 +97,25 @@ class PcapQueue {
 
   template<typename PktType>
   void addPktInternal(const PktType* pkt);
+  bool drain(PcapPkt pkt, std::vector<PcapPkt>* swapQueue);
+  bool isFull(uint64_t newBytes) const;
+  // Account for a packet that has been taken off the ring
+  void pktRemoved(const PcapPkt& pkt);
 
-  mutable std::mutex mutex_;
-  std::condition_variable cv_;
-
-  bool finished_{false};
   const uint32_t pktCapacity_{0};
-  uint64_t bytesCapacity_{0};
-  uint64_t bytesInQueue_{0};
-  uint64_t pktsDropped_{0};
-  std::vector<PcapPkt> queue_;
+  const uint64_t bytesCapacity_{0};
+  const DropPolicy dropPolicy_{DropPolicy::DROP_NEWEST};
+
+  std::atomic<bool> finished_{false};
+  std::atomic<uint64_t> bytesInQueue_{0};
+  std::atomic<uint64_t> pktsDropped_{0};
+  // Only touched by the reader
+  bool readerDone_{false};
+  /*
+   * One slot more than pktCapacity_, so finish() always has room for the
+   * uninitialized PcapPkt that tells the reader no more packets are coming.
+   */
+  folly::MPMCQueue<PcapPkt> queue_;
 };
 
 }} // facebook::fboss
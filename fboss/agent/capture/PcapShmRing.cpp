@@ -0,0 +1,351 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/capture/PcapShmRing.h"
+
+#include "fboss/agent/FbossError.h"
+
+#include <folly/Conv.h>
+#include <folly/String.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <limits>
+#include <new>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace facebook { namespace fboss {
+
+namespace {
+
+constexpr uint64_t kRingMagic = 0x46424f5353504350; // "FBOSSPCP"
+constexpr size_t kAlign = 8;
+
+enum RecordKind : uint8_t {
+  PAD = 0, // filler up to the end of the ring
+  RX = 1,
+  TX = 2,
+};
+
+/*
+ * Every record starts on an 8 byte boundary. A PAD record only has its size
+ * and kind, since the space left at the end of the ring may be that small.
+ * RX and TX records are followed by their reasons, each an i32 reason and an
+ * u16 length prefixed description, then the packet.
+ */
+struct RecordHeader {
+  uint32_t size;
+  uint8_t kind;
+  uint8_t numReasons;
+  uint16_t ethertype;
+  int32_t srcPort;
+  int32_t srcVlan;
+  uint32_t dataLen;
+  uint32_t reserved;
+};
+static_assert(sizeof(RecordHeader) % kAlign == 0, "unaligned record header");
+
+constexpr size_t kReasonHeaderLen = sizeof(int32_t) + sizeof(uint16_t);
+
+size_t alignUp(size_t n) {
+  return (n + kAlign - 1) & ~(kAlign - 1);
+}
+
+void futexWake(std::atomic<uint32_t>* word) {
+  syscall(
+      SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAKE, 1, nullptr,
+      nullptr, 0);
+}
+
+void futexWait(
+    std::atomic<uint32_t>* word,
+    uint32_t expected,
+    std::chrono::milliseconds timeout) {
+  auto secs = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+  struct timespec ts;
+  ts.tv_sec = secs.count();
+  ts.tv_nsec =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(timeout - secs)
+          .count();
+  syscall(
+      SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAIT, expected, &ts,
+      nullptr, 0);
+}
+
+} // namespace
+
+/*
+ * Lives at the start of the shared memory, ahead of the ring itself. head and
+ * tail only ever grow; their offset into the ring is modulo capacity.
+ */
+struct PcapShmRing::Header {
+  uint64_t magic;
+  uint64_t capacity;
+  alignas(64) std::atomic<uint64_t> head;
+  alignas(64) std::atomic<uint64_t> tail;
+  std::atomic<uint64_t> dropped;
+  // Set by the reader while it sleeps on notify
+  std::atomic<uint32_t> waiting;
+  std::atomic<uint32_t> notify;
+};
+static_assert(sizeof(PcapShmRing::Header) % 64 == 0, "unaligned ring header");
+
+std::unique_ptr<PcapShmRing> PcapShmRing::create(
+    const std::string& name,
+    size_t bytes) {
+  auto capacity = alignUp(bytes);
+  if (capacity < sizeof(RecordHeader)) {
+    throw FbossError("pcap ring ", name, " too small: ", bytes, " bytes");
+  }
+  auto size = sizeof(Header) + capacity;
+
+  shm_unlink(name.c_str());
+  int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0) {
+    throw FbossError(
+        "unable to create pcap ring ", name, ": ", folly::errnoStr(errno));
+  }
+  if (ftruncate(fd, size) != 0) {
+    auto err = errno;
+    close(fd);
+    shm_unlink(name.c_str());
+    throw FbossError(
+        "unable to size pcap ring ", name, ": ", folly::errnoStr(err));
+  }
+  auto addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (addr == MAP_FAILED) {
+    auto err = errno;
+    close(fd);
+    shm_unlink(name.c_str());
+    throw FbossError(
+        "unable to map pcap ring ", name, ": ", folly::errnoStr(err));
+  }
+
+  auto header = new (addr) Header();
+  header->capacity = capacity;
+  header->head.store(0);
+  header->tail.store(0);
+  header->dropped.store(0);
+  header->waiting.store(0);
+  header->notify.store(0);
+  // Publish the magic last, writers check it before using the ring
+  std::atomic_thread_fence(std::memory_order_release);
+  header->magic = kRingMagic;
+  return std::unique_ptr<PcapShmRing>(
+      new PcapShmRing(name, true, fd, addr, size));
+}
+
+std::unique_ptr<PcapShmRing> PcapShmRing::open(const std::string& name) {
+  int fd = shm_open(name.c_str(), O_RDWR, 0);
+  if (fd < 0) {
+    throw FbossError(
+        "unable to open pcap ring ", name, ": ", folly::errnoStr(errno));
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 ||
+      static_cast<size_t>(st.st_size) < sizeof(Header) + sizeof(RecordHeader)) {
+    close(fd);
+    throw FbossError("pcap ring ", name, " is not initialized");
+  }
+  auto size = static_cast<size_t>(st.st_size);
+  auto addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (addr == MAP_FAILED) {
+    auto err = errno;
+    close(fd);
+    throw FbossError(
+        "unable to map pcap ring ", name, ": ", folly::errnoStr(err));
+  }
+  std::unique_ptr<PcapShmRing> ring(
+      new PcapShmRing(name, false, fd, addr, size));
+  auto header = ring->header_;
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (header->magic != kRingMagic ||
+      header->capacity != size - sizeof(Header)) {
+    throw FbossError("pcap ring ", name, " is not initialized");
+  }
+  return ring;
+}
+
+PcapShmRing::PcapShmRing(
+    std::string name,
+    bool owner,
+    int fd,
+    void* addr,
+    size_t size)
+    : name_(std::move(name)),
+      owner_(owner),
+      fd_(fd),
+      mapSize_(size),
+      header_(static_cast<Header*>(addr)),
+      ring_(static_cast<uint8_t*>(addr) + sizeof(Header)) {}
+
+PcapShmRing::~PcapShmRing() {
+  munmap(header_, mapSize_);
+  close(fd_);
+  if (owner_) {
+    shm_unlink(name_.c_str());
+  }
+}
+
+bool PcapShmRing::writeRx(
+    int32_t srcPort,
+    int32_t srcVlan,
+    const std::vector<std::pair<int32_t, std::string>>& reasons,
+    uint16_t ethertype,
+    folly::ByteRange data) {
+  return write(true, srcPort, srcVlan, &reasons, ethertype, data);
+}
+
+bool PcapShmRing::writeTx(uint16_t ethertype, folly::ByteRange data) {
+  return write(false, 0, 0, nullptr, ethertype, data);
+}
+
+bool PcapShmRing::write(
+    bool rx,
+    int32_t srcPort,
+    int32_t srcVlan,
+    const std::vector<std::pair<int32_t, std::string>>* reasons,
+    uint16_t ethertype,
+    folly::ByteRange data) {
+  size_t numReasons = 0;
+  size_t reasonsLen = 0;
+  if (reasons) {
+    numReasons = std::min<size_t>(
+        reasons->size(), std::numeric_limits<uint8_t>::max());
+    for (size_t i = 0; i < numReasons; ++i) {
+      reasonsLen += kReasonHeaderLen +
+          std::min<size_t>((*reasons)[i].second.size(),
+                           std::numeric_limits<uint16_t>::max());
+    }
+  }
+  auto capacity = header_->capacity;
+  auto need = alignUp(sizeof(RecordHeader) + reasonsLen + data.size());
+  if (need > capacity) {
+    header_->dropped.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  {
+    std::lock_guard<std::mutex> g(writeLock_);
+    auto head = header_->head.load(std::memory_order_relaxed);
+    auto tail = header_->tail.load(std::memory_order_acquire);
+    auto offset = head % capacity;
+    auto contiguous = capacity - offset;
+    auto pad = contiguous < need ? contiguous : 0;
+    if (capacity - (head - tail) < need + pad) {
+      header_->dropped.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    if (pad) {
+      auto padSize = static_cast<uint32_t>(pad);
+      auto kind = static_cast<uint8_t>(PAD);
+      memcpy(ring_ + offset, &padSize, sizeof(padSize));
+      memcpy(
+          ring_ + offset + offsetof(RecordHeader, kind), &kind, sizeof(kind));
+      head += pad;
+      offset = 0;
+    }
+
+    auto out = ring_ + offset;
+    RecordHeader rec;
+    rec.size = static_cast<uint32_t>(need);
+    rec.kind = rx ? RX : TX;
+    rec.numReasons = static_cast<uint8_t>(numReasons);
+    rec.ethertype = ethertype;
+    rec.srcPort = srcPort;
+    rec.srcVlan = srcVlan;
+    rec.dataLen = static_cast<uint32_t>(data.size());
+    rec.reserved = 0;
+    memcpy(out, &rec, sizeof(rec));
+    out += sizeof(rec);
+    for (size_t i = 0; i < numReasons; ++i) {
+      const auto& reason = (*reasons)[i];
+      auto len = static_cast<uint16_t>(std::min<size_t>(
+          reason.second.size(), std::numeric_limits<uint16_t>::max()));
+      memcpy(out, &reason.first, sizeof(reason.first));
+      memcpy(out + sizeof(reason.first), &len, sizeof(len));
+      out += kReasonHeaderLen;
+      memcpy(out, reason.second.data(), len);
+      out += len;
+    }
+    memcpy(out, data.data(), data.size());
+    // Pairs with the reader setting waiting before it checks head, so
+    // either it sees this packet or we see it asleep
+    header_->head.store(head + need, std::memory_order_seq_cst);
+  }
+
+  if (header_->waiting.load(std::memory_order_seq_cst)) {
+    header_->notify.fetch_add(1, std::memory_order_release);
+    futexWake(&header_->notify);
+  }
+  return true;
+}
+
+size_t PcapShmRing::read(const std::function<void(const Record&)>& fn) {
+  auto capacity = header_->capacity;
+  auto tail = header_->tail.load(std::memory_order_relaxed);
+  auto head = header_->head.load(std::memory_order_acquire);
+  size_t count = 0;
+  Record record;
+  while (tail != head) {
+    auto in = ring_ + tail % capacity;
+    uint32_t size;
+    uint8_t kind;
+    memcpy(&size, in, sizeof(size));
+    memcpy(&kind, in + offsetof(RecordHeader, kind), sizeof(kind));
+    if (kind != PAD) {
+      RecordHeader rec;
+      memcpy(&rec, in, sizeof(rec));
+      auto p = in + sizeof(rec);
+      record.rx = rec.kind == RX;
+      record.ethertype = rec.ethertype;
+      record.srcPort = rec.srcPort;
+      record.srcVlan = rec.srcVlan;
+      record.reasons.clear();
+      for (uint8_t i = 0; i < rec.numReasons; ++i) {
+        int32_t bytes;
+        uint16_t len;
+        memcpy(&bytes, p, sizeof(bytes));
+        memcpy(&len, p + sizeof(bytes), sizeof(len));
+        p += kReasonHeaderLen;
+        record.reasons.emplace_back(
+            bytes, folly::StringPiece(reinterpret_cast<const char*>(p), len));
+        p += len;
+      }
+      record.data = folly::ByteRange(p, rec.dataLen);
+      fn(record);
+      ++count;
+    }
+    tail += size;
+    // Give the space back as we go, so writers are not held up by fn
+    header_->tail.store(tail, std::memory_order_release);
+  }
+  return count;
+}
+
+void PcapShmRing::wait(std::chrono::milliseconds timeout) {
+  auto seq = header_->notify.load(std::memory_order_acquire);
+  header_->waiting.store(1, std::memory_order_seq_cst);
+  if (header_->head.load(std::memory_order_seq_cst) ==
+      header_->tail.load(std::memory_order_relaxed)) {
+    futexWait(&header_->notify, seq, timeout);
+  }
+  header_->waiting.store(0, std::memory_order_relaxed);
+}
+
+uint64_t PcapShmRing::dropped() const {
+  return header_->dropped.load(std::memory_order_relaxed);
+}
+
+}} // facebook::fboss
@@ -0,0 +1,121 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include <folly/Range.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace facebook { namespace fboss {
+
+/*
+ * A ring of captured packets in POSIX shared memory, written by the agent and
+ * read by the pcap distribution service. Publishing a packet is a copy into
+ * the ring rather than a thrift call per packet.
+ *
+ * The service creates the ring before it asks the agent to start the packet
+ * dump, and the agent maps it by name. There is a single reader. Writers never
+ * block: a packet that does not fit in the free space is dropped and counted.
+ * The reader sleeps on a futex in the ring header while it is empty, and
+ * writers only make the wake up call when it is asleep.
+ */
+class PcapShmRing {
+ public:
+  struct Header;
+
+  /*
+   * A packet as read back out of the ring. The ranges point into the ring
+   * and are only valid inside the read() callback.
+   */
+  struct Record {
+    bool rx{false};
+    uint16_t ethertype{0};
+    int32_t srcPort{0};
+    int32_t srcVlan{0};
+    std::vector<std::pair<int32_t, folly::StringPiece>> reasons;
+    folly::ByteRange data;
+  };
+
+  /*
+   * Create the ring, for the reader. Any ring left by a previous reader under
+   * the same name is replaced; writers still mapping it must reopen.
+   */
+  static std::unique_ptr<PcapShmRing> create(
+      const std::string& name,
+      size_t bytes);
+
+  /*
+   * Map the ring the reader created. Throws if there is none.
+   */
+  static std::unique_ptr<PcapShmRing> open(const std::string& name);
+
+  ~PcapShmRing();
+
+  /*
+   * Writer side. Returns false if the packet was dropped for lack of space.
+   */
+  bool writeRx(
+      int32_t srcPort,
+      int32_t srcVlan,
+      const std::vector<std::pair<int32_t, std::string>>& reasons,
+      uint16_t ethertype,
+      folly::ByteRange data);
+  bool writeTx(uint16_t ethertype, folly::ByteRange data);
+
+  /*
+   * Reader side. Hand every packet in the ring to fn, and return how many.
+   */
+  size_t read(const std::function<void(const Record&)>& fn);
+
+  /*
+   * Reader side. Sleep until a writer publishes a packet, or the timeout
+   * passes. Returns right away if the ring is not empty.
+   */
+  void wait(std::chrono::milliseconds timeout);
+
+  /*
+   * Packets dropped by writers because the ring was full
+   */
+  uint64_t dropped() const;
+
+ private:
+  PcapShmRing(std::string name, bool owner, int fd, void* addr, size_t size);
+
+  // Forbidden copy constructor and assignment operator
+  PcapShmRing(PcapShmRing const &) = delete;
+  PcapShmRing& operator=(PcapShmRing const &) = delete;
+
+  bool write(
+      bool rx,
+      int32_t srcPort,
+      int32_t srcVlan,
+      const std::vector<std::pair<int32_t, std::string>>* reasons,
+      uint16_t ethertype,
+      folly::ByteRange data);
+
+  std::string name_;
+  bool owner_{false};
+  int fd_{-1};
+  size_t mapSize_{0};
+  Header* header_{nullptr};
+  uint8_t* ring_{nullptr};
+  // Writers are all the agent threads sending or receiving packets
+  std::mutex writeLock_;
+};
+
+}} // facebook::fboss
@@ -11,23 +11,74 @@
 
 #include "fboss/agent/capture/PcapPkt.h"
 
+#include <folly/Conv.h>
+#include <folly/Exception.h>
 #include <folly/String.h>
 #include <folly/logging/xlog.h>
+#include <gflags/gflags.h>
 
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+
+DEFINE_int32(fboss_pcap_write_buffer_kb, 1024,
+             "Size of each buffer packet captures are formatted into before "
+             "being written to disk");
+DEFINE_int32(fboss_pcap_write_buffers, 4,
+             "Number of write buffers per packet capture.  While one buffer "
+             "is being written to disk the others keep taking packets");
+DEFINE_int32(fboss_pcap_flush_interval_ms, 1000,
+             "Write a partially filled capture buffer to disk after this "
+             "long without filling up");
+
+using folly::IOBuf;
 using folly::StringPiece;
+using std::chrono::duration_cast;
+using std::chrono::microseconds;
+using std::chrono::milliseconds;
+using std::chrono::steady_clock;
+
+namespace {
+// Large enough to always hold a full snaplen record
+constexpr size_t kMinBufferKb = 128;
+// Page alignment, so the kernel can copy whole pages out of the buffers
+constexpr size_t kBufferAlign = 4096;
+
+size_t bufferSize() {
+  return std::max<size_t>(FLAGS_fboss_pcap_write_buffer_kb, kMinBufferKb) *
+    1024;
+}
+
+size_t numBuffers() {
+  return std::max(FLAGS_fboss_pcap_write_buffers, 2);
+}
+
+std::unique_ptr<IOBuf> allocBuffer(size_t size) {
+  void* data{nullptr};
+  int err = posix_memalign(&data, kBufferAlign, size);
+  if (err != 0) {
+    folly::throwSystemErrorExplicit(err, "failed to allocate pcap buffer");
+  }
+  return IOBuf::takeOwnership(
+      data, size, 0, [](void* buf, void* /*userData*/) { free(buf); });
+}
+} // unnamed namespace
 
 namespace facebook { namespace fboss {
 
-PcapWriter::PcapWriter(uint32_t maxBufferedPkts)
-  : queue_(maxBufferedPkts) {
+PcapWriter::PcapWriter(uint32_t maxBufferedPkts,
+                       PcapQueue::DropPolicy dropPolicy)
+  : queue_(maxBufferedPkts, 0, dropPolicy),
+    dirty_(numBuffers()),
+    free_(numBuffers()) {
 }
 
 PcapWriter::PcapWriter(StringPiece path,
                        bool overwriteExisting,
-                       uint32_t maxBufferedPkts)
-  : file_(path, overwriteExisting),
-    queue_(maxBufferedPkts),
-    thread_(&PcapWriter::threadMain, this) {
+                       uint32_t maxBufferedPkts,
+                       PcapQueue::DropPolicy dropPolicy)
+  : PcapWriter(maxBufferedPkts, dropPolicy) {
+  start(path, overwriteExisting);
 }
 
 PcapWriter::~PcapWriter() {
@@ -42,8 +93,19 @@ PcapWriter::~PcapWriter() {
   }
 }
 
+void PcapWriter::setFileRotation(uint64_t maxFileBytes, uint32_t maxFiles) {
+  maxFileBytes_ = maxFileBytes;
+  maxFiles_ = maxFiles;
+}
+
 void PcapWriter::start(folly::StringPiece path, bool overwriteExisting) {
+  path_ = path.str();
   file_ = PcapFile(path, overwriteExisting);
+  buf_ = allocBuffer(bufferSize());
+  for (size_t n = 1; n < numBuffers(); ++n) {
+    free_.blockingWrite(allocBuffer(bufferSize()));
+  }
+  flushThread_ = std::thread(&PcapWriter::flushMain, this);
   thread_ = std::thread(&PcapWriter::threadMain, this);
 }
 
@@ -55,34 +117,137 @@ void PcapWriter::finish() {
 
   queue_.finish();
   thread_.join();
+  flushThread_.join();
   if (ex_) {
     std::rethrow_exception(ex_);
   }
+  if (flushEx_) {
+    std::rethrow_exception(flushEx_);
+  }
 }
 
 void PcapWriter::threadMain() {
   try {
-    file_.writeGlobalHeader();
     writeLoop();
-    file_.close();
   } catch (const std::exception& ex) {
     XLOG(ERR) << "error writing to pcap file: " << folly::exceptionStr(ex);
     ex_ = std::current_exception();
   }
+  // Let the flush thread write out what it has and close the file
+  dirty_.blockingWrite(nullptr);
 }
 
 void PcapWriter::writeLoop() {
   std::vector<PcapPkt> pkts;
+  const milliseconds flushInterval(FLAGS_fboss_pcap_flush_interval_ms);
+  auto lastFlush = steady_clock::now();
   while (true) {
-    pkts.clear();
-    if (!queue_.wait(&pkts)) {
-      DCHECK(pkts.empty());
+    bool more = queue_.wait(&pkts, flushInterval);
+    for (const auto& pkt : pkts) {
+      if (!PcapFile::appendPacket(pkt, buf_.get())) {
+        flushBuffer();
+        if (!PcapFile::appendPacket(pkt, buf_.get())) {
+          XLOG(ERR) << "pcap record of " << pkt.buf()->computeChainDataLength()
+                    << " bytes does not fit in a write buffer";
+        }
+      }
+    }
+    if (!more) {
+      flushBuffer();
       return;
     }
 
-    DCHECK(!pkts.empty());
-    file_.writePackets(pkts);
+    auto now = steady_clock::now();
+    if (now - lastFlush >= flushInterval) {
+      flushBuffer();
+      lastFlush = now;
+    }
+  }
+}
+
+void PcapWriter::flushBuffer() {
+  if (buf_->length() == 0) {
+    return;
+  }
+  dirty_.blockingWrite(std::move(buf_));
+  // Only blocks if every other buffer is still waiting on the disk
+  free_.blockingRead(buf_);
+}
+
+void PcapWriter::flushMain() {
+  try {
+    file_.writeGlobalHeader();
+  } catch (const std::exception& ex) {
+    XLOG(ERR) << "error writing to pcap file: " << folly::exceptionStr(ex);
+    flushEx_ = std::current_exception();
+  }
+
+  std::unique_ptr<IOBuf> buf;
+  while (true) {
+    dirty_.blockingRead(buf);
+    if (!buf) {
+      break;
+    }
+    // After an error keep handing buffers back, so the writer thread never
+    // blocks on us, but leave the file alone.
+    if (!flushEx_) {
+      try {
+        writeBuffer(*buf);
+      } catch (const std::exception& ex) {
+        XLOG(ERR) << "error writing to pcap file: " << folly::exceptionStr(ex);
+        flushEx_ = std::current_exception();
+      }
+    }
+    buf->clear();
+    free_.blockingWrite(std::move(buf));
+  }
+
+  try {
+    file_.close();
+  } catch (const std::exception& ex) {
+    XLOG(ERR) << "error closing pcap file: " << folly::exceptionStr(ex);
+    if (!flushEx_) {
+      flushEx_ = std::current_exception();
+    }
+  }
+}
+
+void PcapWriter::writeBuffer(const IOBuf& buf) {
+  auto start = steady_clock::now();
+  file_.write(buf);
+  uint64_t usecs =
+    duration_cast<microseconds>(steady_clock::now() - start).count();
+
+  bytesWritten_.fetch_add(buf.length(), std::memory_order_relaxed);
+  // This is the only thread updating the max
+  if (usecs > maxFlushUsecs_.load(std::memory_order_relaxed)) {
+    maxFlushUsecs_.store(usecs, std::memory_order_relaxed);
+  }
+
+  fileBytes_ += buf.length();
+  if (maxFileBytes_ > 0 && fileBytes_ >= maxFileBytes_) {
+    rotateFile();
+  }
+}
+
+void PcapWriter::rotateFile() {
+  file_.close();
+  if (maxFiles_ <= 1) {
+    // Nothing to keep, just start over
+    ::unlink(path_.c_str());
+  }
+  // <path>.<n - 1> becomes <path>.<n>, with <path> itself as <path>.0
+  for (uint32_t n = maxFiles_ > 0 ? maxFiles_ - 1 : 0; n > 0; --n) {
+    auto from = n == 1 ? path_ : folly::to<std::string>(path_, ".", n - 1);
+    auto to = folly::to<std::string>(path_, ".", n);
+    if (::rename(from.c_str(), to.c_str()) != 0 && errno != ENOENT) {
+      XLOG(ERR) << "failed to rotate pcap file " << from << " to " << to
+                << ": " << folly::errnoStr(errno);
+    }
   }
+  file_ = PcapFile(path_, true);
+  file_.writeGlobalHeader();
+  fileBytes_ = 0;
 }
 
 }} // facebook::fboss
@@ -12,6 +12,13 @@
 #include "fboss/agent/capture/PcapFile.h"
 #include "fboss/agent/capture/PcapQueue.h"
 
+#include <folly/MPMCQueue.h>
+#include <folly/io/IOBuf.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
 #include <thread>
 
 namespace facebook { namespace fboss {
@@ -21,40 +28,43 @@ namespace facebook { namespace fboss {
  * to a pcap file.
  *
  * It performs blocking disk I/O, so it performs the writes in its own thread.
+ * Two threads in fact: one drains the queue and formats records into large
+ * page aligned buffers, and a second one writes full buffers to disk.  A
+ * slow disk then only holds up the flush thread, while the queue keeps
+ * being drained into the spare buffers.
+ *
+ * Optionally the capture can be split over a bounded set of files, see
+ * setFileRotation().
  */
 class PcapWriter {
  public:
-  explicit PcapWriter(uint32_t maxBufferedPkts = 0);
+  explicit PcapWriter(uint32_t maxBufferedPkts = 0,
+                      PcapQueue::DropPolicy dropPolicy =
+                        PcapQueue::DropPolicy::DROP_NEWEST);
   explicit PcapWriter(folly::StringPiece path,
                       bool overwriteExisting = false,
-                      uint32_t maxBufferedPkts = 0);
+                      uint32_t maxBufferedPkts = 0,
+                      PcapQueue::DropPolicy dropPolicy =
+                        PcapQueue::DropPolicy::DROP_NEWEST);
   virtual ~PcapWriter();
 
   void start(folly::StringPiece path, bool overwriteExisting = false);
 
   /*
-   * Get the mutex protecting this PcapWriter.
+   * Once the current file reaches maxFileBytes, rename it to <path>.1
+   * (shifting older files up to <path>.<maxFiles - 1>, and deleting the
+   * oldest) and start a new file at <path>.  0 disables rotation.
    *
-   * This is exposed to allow callers to also protect their own data
-   * with the same mutex if desired.  Callers should call addPktLocked()
-   * instead of addPkt() when they are already holding the PcapWriter mutex.
+   * Must be called before start().
    */
-  std::mutex& mutex() const {
-    return queue_.mutex();
-  }
+  void setFileRotation(uint64_t maxFileBytes, uint32_t maxFiles);
 
   void addPkt(const RxPacket* pkt) {
     queue_.addPkt(pkt);
   }
-  void addPktLocked(const RxPacket* pkt) {
-    queue_.addPktLocked(pkt);
-  }
   void addPkt(const TxPacket* pkt) {
     queue_.addPkt(pkt);
   }
-  void addPktLocked(const TxPacket* pkt) {
-    queue_.addPktLocked(pkt);
-  }
   void finish();
 
   /*
@@ -67,19 +77,51 @@ class PcapWriter {
     return queue_.numDropped();
   }
 
+  // Bytes of packet records written to disk, over all files
+  uint64_t bytesWritten() const {
+    return bytesWritten_.load(std::memory_order_relaxed);
+  }
+  // The longest a single buffer flush has taken so far
+  std::chrono::microseconds maxFlushTime() const {
+    return std::chrono::microseconds(
+        maxFlushUsecs_.load(std::memory_order_relaxed));
+  }
+
  private:
   // Forbidden copy constructor and assignment operator
   PcapWriter(PcapWriter const &) = delete;
   PcapWriter& operator=(PcapWriter const &) = delete;
 
   void threadMain();
-  void writeHeader();
   void writeLoop();
+  void flushBuffer();
+
+  void flushMain();
+  void writeBuffer(const folly::IOBuf& buf);
+  void rotateFile();
 
+  std::string path_;
+  uint64_t maxFileBytes_{0};
+  uint32_t maxFiles_{0};
+  // Only used by the flush thread once started
   PcapFile file_;
+  uint64_t fileBytes_{0};
+
   PcapQueue queue_;
+  // The buffer the writer thread is currently filling
+  std::unique_ptr<folly::IOBuf> buf_;
+  // Full buffers for the flush thread, and a null one to make it exit
+  folly::MPMCQueue<std::unique_ptr<folly::IOBuf>> dirty_;
+  // Flushed buffers going back to the writer thread
+  folly::MPMCQueue<std::unique_ptr<folly::IOBuf>> free_;
+
+  std::atomic<uint64_t> bytesWritten_{0};
+  std::atomic<uint64_t> maxFlushUsecs_{0};
+
   std::exception_ptr ex_;
+  std::exception_ptr flushEx_;
   std::thread thread_;
+  std::thread flushThread_;
 };
 
 }} // facebook::fboss
@@ -9,14 +9,94 @@
  */
 #include "fboss/agent/capture/PktCapture.h"
 
+#include "fboss/agent/packet/Ethertype.h"
+#include "fboss/agent/packet/IPProto.h"
+
 #include <folly/Conv.h>
+#include <folly/io/Cursor.h>
 #include <folly/logging/xlog.h>
 #include <sstream>
 
 using folly::StringPiece;
+using folly::io::Cursor;
 
 namespace facebook { namespace fboss {
 
+HeaderFilter::HeaderFilter(const CaptureFilter& captureFilter) {
+  for (auto etherType : captureFilter.etherTypes) {
+    etherTypes_.insert(static_cast<uint16_t>(etherType));
+  }
+  for (auto proto : captureFilter.ipProtocols) {
+    ipProtocols_.insert(static_cast<uint8_t>(proto));
+  }
+  for (auto port : captureFilter.l4Ports) {
+    l4Ports_.insert(static_cast<uint16_t>(port));
+  }
+  matchAll_ = etherTypes_.empty() && ipProtocols_.empty() && l4Ports_.empty();
+}
+
+bool HeaderFilter::passesImpl(const folly::IOBuf* buf) const {
+  Cursor cursor(buf);
+  // Anything too short to hold the headers we match on can't match.
+  try {
+    // dst and src mac
+    cursor.skip(12);
+    auto etherType = cursor.readBE<uint16_t>();
+    while (etherType == static_cast<uint16_t>(ETHERTYPE::ETHERTYPE_VLAN) ||
+           etherType == static_cast<uint16_t>(ETHERTYPE::ETHERTYPE_QINQ)) {
+      cursor.skip(2);
+      etherType = cursor.readBE<uint16_t>();
+    }
+    if (!etherTypes_.empty() &&
+        etherTypes_.find(etherType) == etherTypes_.end()) {
+      return false;
+    }
+    if (ipProtocols_.empty() && l4Ports_.empty()) {
+      return true;
+    }
+
+    uint8_t proto;
+    bool firstFragment = true;
+    if (etherType == static_cast<uint16_t>(ETHERTYPE::ETHERTYPE_IPV4)) {
+      auto ihl = cursor.read<uint8_t>() & 0x0f;
+      if (ihl < 5) {
+        return false;
+      }
+      cursor.skip(5);
+      firstFragment = (cursor.readBE<uint16_t>() & 0x1fff) == 0;
+      cursor.skip(1);
+      proto = cursor.read<uint8_t>();
+      cursor.skip(ihl * 4 - 10);
+    } else if (etherType == static_cast<uint16_t>(ETHERTYPE::ETHERTYPE_IPV6)) {
+      // Extension headers are not walked, so this is the first next header.
+      cursor.skip(6);
+      proto = cursor.read<uint8_t>();
+      cursor.skip(33);
+    } else {
+      return false;
+    }
+    if (!ipProtocols_.empty() &&
+        ipProtocols_.find(proto) == ipProtocols_.end()) {
+      return false;
+    }
+    if (l4Ports_.empty()) {
+      return true;
+    }
+
+    if (!firstFragment ||
+        (proto != static_cast<uint8_t>(IP_PROTO::IP_PROTO_TCP) &&
+         proto != static_cast<uint8_t>(IP_PROTO::IP_PROTO_UDP))) {
+      return false;
+    }
+    auto srcPort = cursor.readBE<uint16_t>();
+    auto dstPort = cursor.readBE<uint16_t>();
+    return l4Ports_.find(srcPort) != l4Ports_.end() ||
+      l4Ports_.find(dstPort) != l4Ports_.end();
+  } catch (const std::out_of_range&) {
+    return false;
+  }
+}
+
 PktCapture::PktCapture(folly::StringPiece name, uint64_t maxPackets,
                          CaptureDirection direction)
     : PktCapture(name, maxPackets, direction, CaptureFilter()) {
@@ -24,8 +104,12 @@ PktCapture::PktCapture(folly::StringPiece name, uint64_t maxPackets,
 
 PktCapture::PktCapture(folly::StringPiece name, uint64_t maxPackets,
                        CaptureDirection direction,
-                       const CaptureFilter& captureFilter)
+                       const CaptureFilter& captureFilter,
+                       CaptureDropPolicy dropPolicy)
   : name_(name.str()),
+    writer_(0, dropPolicy == CaptureDropPolicy::DROP_OLDEST
+                 ? PcapQueue::DropPolicy::DROP_OLDEST
+                 : PcapQueue::DropPolicy::DROP_NEWEST),
     maxPackets_(maxPackets),
     direction_(direction),
     packetFilter_(captureFilter) {
@@ -43,24 +127,34 @@ void PktCapture::stop() {
 }
 
 bool PktCapture::packetReceived(const RxPacket* pkt) {
-  std::lock_guard<std::mutex> guard(writer_.mutex());
   if (direction_ != CaptureDirection::CAPTURE_ONLY_TX &&
       true == packetFilter_.passes(pkt)) {
     ++numPacketsReceived_;
-    writer_.addPktLocked(pkt);
+    writer_.addPkt(pkt);
   }
   return (numPacketsSent_ + numPacketsReceived_) < maxPackets_;
 }
 
 bool PktCapture::packetSent(const TxPacket* pkt) {
-  std::lock_guard<std::mutex> guard(writer_.mutex());
-  if (direction_ != CaptureDirection::CAPTURE_ONLY_RX) {
+  if (direction_ != CaptureDirection::CAPTURE_ONLY_RX &&
+      packetFilter_.passes(pkt)) {
     ++numPacketsSent_;
-    writer_.addPktLocked(pkt);
+    writer_.addPkt(pkt);
   }
   return (numPacketsSent_ + numPacketsReceived_) < maxPackets_;
 }
 
+CaptureStats PktCapture::getStats() const {
+  CaptureStats stats;
+  stats.name = name_;
+  stats.packetsReceived = numPacketsReceived_;
+  stats.packetsSent = numPacketsSent_;
+  stats.packetsDropped = writer_.numDropped();
+  stats.bytesWritten = writer_.bytesWritten();
+  stats.maxFlushUsecs = writer_.maxFlushTime().count();
+  return stats;
+}
+
 std::string PktCapture::toString(bool withStats) const {
   std::stringstream ss;
   ss << "Name:\"" << name_ << "\", maxPackets:" << maxPackets_
@@ -72,7 +166,10 @@ std::string PktCapture::toString(bool withStats) const {
             : "TX only"));
   if (withStats) {
     ss << ", Packet received:" << numPacketsReceived_
-       << ", Packet sent:" << numPacketsSent_;
+       << ", Packet sent:" << numPacketsSent_
+       << ", Packet dropped:" << writer_.numDropped()
+       << ", Bytes written:" << writer_.bytesWritten()
+       << ", Max flush time:" << writer_.maxFlushTime().count() << "us";
   }
   return ss.str();
 }
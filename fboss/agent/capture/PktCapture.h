@@ -13,6 +13,7 @@
 #include "fboss/agent/if/gen-cpp2/ctrl_types.h"
 
 #include <folly/Range.h>
+#include <atomic>
 #include <string>
 #include "fboss/agent/RxPacket.h"
 #include "fboss/agent/TxPacket.h"
@@ -35,16 +36,44 @@ class RxPacketFilter {
   boost::container::flat_set<CpuCosQueueId> cosQueues_;
 };
 
+/*
+ * Matches packets on their ethernet, IP and TCP/UDP headers.
+ *
+ * The lists in the CaptureFilter are turned into sets once, when the capture
+ * is created, and a filter with nothing to match on never parses the packet.
+ */
+class HeaderFilter {
+ public:
+  explicit HeaderFilter(const CaptureFilter& captureFilter);
+
+  bool passes(const folly::IOBuf* buf) const {
+    return matchAll_ || passesImpl(buf);
+  }
+
+ private:
+  bool passesImpl(const folly::IOBuf* buf) const;
+
+  boost::container::flat_set<uint16_t> etherTypes_;
+  boost::container::flat_set<uint8_t> ipProtocols_;
+  boost::container::flat_set<uint16_t> l4Ports_;
+  bool matchAll_{true};
+};
+
 class PacketFilter {
  public:
    explicit PacketFilter(const CaptureFilter & captureFilter) :
-   rxPacketFilter_(captureFilter.get_rxCaptureFilter()) {}
+   rxPacketFilter_(captureFilter.get_rxCaptureFilter()),
+   headerFilter_(captureFilter) {}
 
    bool passes(const RxPacket* pkt) {
-     return rxPacketFilter_.passes(pkt);
+     return rxPacketFilter_.passes(pkt) && headerFilter_.passes(pkt->buf());
+   }
+   bool passes(const TxPacket* pkt) {
+     return headerFilter_.passes(pkt->buf());
    }
  private:
    RxPacketFilter rxPacketFilter_;
+   HeaderFilter headerFilter_;
 };
 
 /*
@@ -55,18 +84,25 @@ class PktCapture {
   PktCapture(folly::StringPiece name, uint64_t maxPackets,
              CaptureDirection direction);
   PktCapture(folly::StringPiece name, uint64_t maxPackets,
-             CaptureDirection direction, const CaptureFilter& captureFilter);
+             CaptureDirection direction, const CaptureFilter& captureFilter,
+             CaptureDropPolicy dropPolicy = CaptureDropPolicy::DROP_NEWEST);
 
   const std::string& name() const {
     return name_;
   }
 
+  // Split the capture over a bounded set of files, see PcapWriter
+  void setFileRotation(uint64_t maxFileBytes, uint32_t maxFiles) {
+    writer_.setFileRotation(maxFileBytes, maxFiles);
+  }
+
   void start(folly::StringPiece path);
   void stop();
 
   bool packetReceived(const RxPacket* pkt);
   bool packetSent(const TxPacket* pkt);
 
+  CaptureStats getStats() const;
   std::string toString(bool withStats = false) const;
 
  private:
@@ -76,12 +112,11 @@ class PktCapture {
 
   const std::string name_;
 
-  // Note: the rest of the state in this class is protcted by
-  // the PcapWriter's mutex.
   PcapWriter writer_;
   uint64_t maxPackets_{0};
-  uint64_t numPacketsReceived_{0};
-  uint64_t numPacketsSent_{0};
+  // Updated from the RX and TX paths, read by getStats() from any thread
+  std::atomic<uint64_t> numPacketsReceived_{0};
+  std::atomic<uint64_t> numPacketsSent_{0};
   CaptureDirection direction_{CaptureDirection::CAPTURE_TX_RX};
   PacketFilter packetFilter_;
 };
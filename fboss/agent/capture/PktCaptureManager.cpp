@@ -9,22 +9,62 @@
  */
 #include "fboss/agent/capture/PktCaptureManager.h"
 
+#include "fboss/agent/AddressUtil.h"
 #include "fboss/agent/FbossError.h"
 #include "fboss/agent/Platform.h"
+#include "fboss/agent/RxPacket.h"
 #include "fboss/agent/SwSwitch.h"
 #include "fboss/agent/Utils.h"
 #include "fboss/agent/capture/PktCapture.h"
+#include "fboss/agent/state/AclEntry.h"
+#include "fboss/agent/state/AclMap.h"
+#include "fboss/agent/state/MatchAction.h"
+#include "fboss/agent/state/Mirror.h"
+#include "fboss/agent/state/MirrorMap.h"
+#include "fboss/agent/state/SwitchState.h"
 
 #include <folly/String.h>
+#include <folly/io/async/EventBase.h>
 #include <folly/logging/xlog.h>
+#include <gflags/gflags.h>
+
+#include <algorithm>
+
+DEFINE_int32(
+    capture_cpu_queue,
+    3,
+    "CPU cos queue that dataplane captures have their copies sent to. Its "
+    "rate limit in the cpuQueues config bounds the rate of the copies, so "
+    "it should be a queue that nothing else uses");
 
 using folly::StringPiece;
+using std::make_shared;
+using std::shared_ptr;
 using std::string;
 using std::unique_ptr;
 
+namespace {
+constexpr auto kDataplaneCapturePrefix = "pktcapture.";
+// Past the priorities that config ACLs get, so that a capture never changes
+// the action taken on traffic that a config ACL matches
+constexpr int kDataplaneCaptureStartPriority = 1000000;
+// The CPU as a mirror destination
+const facebook::fboss::PortID kCpuPort(0);
+
+string dataplaneEntryName(StringPiece captureName) {
+  return folly::to<string>(kDataplaneCapturePrefix, captureName);
+}
+
+folly::CIDRNetwork toCIDRNetwork(const facebook::fboss::IpPrefix& prefix) {
+  return std::make_pair(
+      facebook::network::toIPAddress(prefix.ip),
+      static_cast<uint8_t>(prefix.prefixLength));
+}
+} // namespace
+
 namespace facebook { namespace fboss {
 
-PktCaptureManager::PktCaptureManager(SwSwitch* sw) {
+PktCaptureManager::PktCaptureManager(SwSwitch* sw) : sw_(sw) {
   auto persistDir = sw->getPlatform()->getPersistentStateDir();
   captureDir_ = folly::to<string>(persistDir, "/captures");
   utilCreateDir(captureDir_);
@@ -33,22 +73,216 @@ PktCaptureManager::PktCaptureManager(SwSwitch* sw) {
 PktCaptureManager::~PktCaptureManager() {
 }
 
-void PktCaptureManager::startCapture(unique_ptr<PktCapture> capture) {
+void PktCaptureManager::startCapture(
+    unique_ptr<PktCapture> capture,
+    const DataplaneCapture* dataplane) {
   checkCaptureName(capture->name());
 
   auto path = folly::to<std::string>(captureDir_, "/",
                                      capture->name(), ".pcap");
+  auto name = capture->name();
+
+  {
+    std::lock_guard<std::mutex> g(mutex_);
+
+    if (activeCaptures_.find(name) != activeCaptures_.end()) {
+      throw FbossError(
+          "an active capture named \"", name, "\" already exists");
+    }
+
+    capture->start(path);
+    capturesRunning_.store(true, std::memory_order_release);
+    activeCaptures_[name] = std::move(capture);
+  }
+
+  if (!dataplane) {
+    return;
+  }
+  try {
+    // Not under mutex_, as the update thread may be sending a packet
+    installDataplaneCapture(name, *dataplane);
+  } catch (const std::exception& ex) {
+    XLOG(ERR) << "failed to mirror dataplane traffic for capture \"" << name
+              << "\": " << folly::exceptionStr(ex);
+    forgetCapture(name);
+    throw;
+  }
+}
+
+void PktCaptureManager::installDataplaneCapture(
+    const string& name,
+    const DataplaneCapture& dataplane) {
+  if (dataplane.timeoutSeconds <= 0) {
+    throw FbossError("dataplane capture timeout must be positive");
+  }
+  if (dataplane.__isset.ipProtocol &&
+      (dataplane.ipProtocol_ref().value_unchecked() < 0 ||
+       dataplane.ipProtocol_ref().value_unchecked() > 255)) {
+    throw FbossError(
+        "invalid IP protocol ", dataplane.ipProtocol_ref().value_unchecked());
+  }
+  for (const auto* port : {&dataplane.l4SrcPort, &dataplane.l4DstPort}) {
+    if (*port < 0 || *port > AclEntryFields::kMaxL4Port) {
+      throw FbossError("invalid L4 port ", *port);
+    }
+  }
+
+  // Everything that can throw is done before the update itself
+  auto entry = dataplaneEntryName(name);
+  auto acl = make_shared<AclEntry>(0, entry);
+  if (dataplane.__isset.srcIp) {
+    acl->setSrcIp(toCIDRNetwork(dataplane.srcIp_ref().value_unchecked()));
+  }
+  if (dataplane.__isset.dstIp) {
+    acl->setDstIp(toCIDRNetwork(dataplane.dstIp_ref().value_unchecked()));
+  }
+  if (dataplane.__isset.ipProtocol) {
+    acl->setProto(dataplane.ipProtocol_ref().value_unchecked());
+  }
+  if (dataplane.__isset.l4SrcPort) {
+    acl->setL4SrcPort(dataplane.l4SrcPort_ref().value_unchecked());
+  }
+  if (dataplane.__isset.l4DstPort) {
+    acl->setL4DstPort(dataplane.l4DstPort_ref().value_unchecked());
+  }
+  cfg::QueueMatchAction queue;
+  queue.queueId = FLAGS_capture_cpu_queue;
+  MatchAction action;
+  action.setSendToQueue(std::make_pair(queue, true));
+  action.setIngressMirror(entry);
+  acl->setAclAction(action);
+  auto mirror = make_shared<Mirror>(entry, kCpuPort, folly::none);
+
+  uint64_t id;
+  {
+    std::lock_guard<std::mutex> g(mutex_);
+    if (activeCaptures_.find(name) == activeCaptures_.end()) {
+      // Stopped already
+      return;
+    }
+    id = nextDataplaneId_++;
+    dataplaneCaptures_[name] = id;
+    dataplaneCapturesRunning_.store(true, std::memory_order_release);
+  }
+
+  auto install = [this, name, id, acl, mirror](
+                     const shared_ptr<SwitchState>& state)
+      -> shared_ptr<SwitchState> {
+    {
+      // A stop that raced with this update has nothing to remove yet
+      std::lock_guard<std::mutex> g(mutex_);
+      auto it = dataplaneCaptures_.find(name);
+      if (it == dataplaneCaptures_.end() || it->second != id) {
+        return nullptr;
+      }
+    }
+    int priority = kDataplaneCaptureStartPriority;
+    for (const auto& existing : *state->getAcls()) {
+      priority = std::max(priority, existing->getPriority() + 1);
+    }
+    AclEntryFields fields(*acl->getFields());
+    fields.priority = priority;
+    auto newAcl = make_shared<AclEntry>(fields);
+
+    auto newState = state;
+    newState->getMirrors()->modify(&newState)->addMirror(mirror);
+    newState->getAcls()->modify(&newState)->addEntry(newAcl);
+    return newState;
+  };
+  sw_->updateStateBlocking(
+      folly::to<string>("start dataplane capture ", name), install);
 
+  auto timeout = std::chrono::seconds(dataplane.timeoutSeconds);
+  auto* evb = sw_->getBackgroundEvb();
+  evb->runInEventBaseThread([this, evb, name, id, timeout]() {
+    evb->runAfterDelay(
+        [this, name, id]() { dataplaneCaptureTimedOut(name, id); },
+        std::chrono::duration_cast<std::chrono::milliseconds>(timeout)
+            .count());
+  });
+  XLOG(INFO) << "mirroring dataplane traffic for capture \"" << name
+             << "\" to CPU queue " << FLAGS_capture_cpu_queue << " for "
+             << dataplane.timeoutSeconds << "s";
+}
+
+void PktCaptureManager::removeDataplaneCaptureLocked(const string& name) {
+  auto it = dataplaneCaptures_.find(name);
+  if (it == dataplaneCaptures_.end()) {
+    return;
+  }
+  dataplaneCaptures_.erase(it);
+  dataplaneCapturesRunning_.store(
+      !dataplaneCaptures_.empty(), std::memory_order_release);
+
+  // Not blocking, since this may be called from an rx thread
+  auto entry = dataplaneEntryName(name);
+  sw_->updateState(
+      folly::to<string>("stop dataplane capture ", name),
+      [entry](const shared_ptr<SwitchState>& state) {
+        return removeDataplaneCaptureEntries(
+            state, [&](StringPiece entryName) { return entryName == entry; });
+      });
+}
+
+void PktCaptureManager::dataplaneCaptureTimedOut(
+    const string& name,
+    uint64_t id) {
   std::lock_guard<std::mutex> g(mutex_);
+  auto it = dataplaneCaptures_.find(name);
+  if (it == dataplaneCaptures_.end() || it->second != id) {
+    return;
+  }
+  XLOG(INFO) << "dataplane capture \"" << name << "\" timed out";
+  removeDataplaneCaptureLocked(name);
+  auto activeIt = activeCaptures_.find(name);
+  if (activeIt != activeCaptures_.end()) {
+    activeIt->second->stop();
+    inactiveCaptures_[name] = std::move(activeIt->second);
+    activeCaptures_.erase(activeIt);
+    capturesRunning_.store(
+        !activeCaptures_.empty(), std::memory_order_release);
+  }
+}
+
+void PktCaptureManager::removeStaleDataplaneCaptures() {
+  // Captures do not survive a restart, but their mirrors and ACLs are
+  // still in the warm boot state
+  sw_->updateState(
+      "remove stale dataplane captures",
+      [](const shared_ptr<SwitchState>& state) {
+        return removeDataplaneCaptureEntries(state, isDataplaneCaptureEntry);
+      });
+}
 
-  const auto& name = capture->name();
-  if (activeCaptures_.find(name) != activeCaptures_.end()) {
-    throw FbossError("an active capture named \"", name, "\" already exists");
+shared_ptr<SwitchState> PktCaptureManager::removeDataplaneCaptureEntries(
+    const shared_ptr<SwitchState>& state,
+    const std::function<bool(StringPiece)>& matches) {
+  auto newState = state;
+  for (const auto& acl : *state->getAcls()) {
+    if (matches(acl->getID())) {
+      newState->getAcls()->modify(&newState)->removeEntry(acl->getID());
+    }
+  }
+  if (state->getMirrors()) {
+    for (const auto& mirror : *state->getMirrors()) {
+      if (matches(mirror->getID())) {
+        newState->getMirrors()->modify(&newState)->removeNode(
+            mirror->getID());
+      }
+    }
   }
+  if (newState == state) {
+    return nullptr;
+  }
+  return newState;
+}
 
-  capture->start(path);
-  capturesRunning_.store(true, std::memory_order_release);
-  activeCaptures_[name] = std::move(capture);
+bool PktCaptureManager::isDataplaneCopyImpl(const RxPacket* pkt) const {
+  return pkt->cosQueue() == FLAGS_capture_cpu_queue;
+}
+
+bool PktCaptureManager::isDataplaneCaptureEntry(StringPiece name) {
+  return name.startsWith(kDataplaneCapturePrefix);
 }
 
 void PktCaptureManager::stopCapture(StringPiece name) {
@@ -63,6 +297,7 @@ void PktCaptureManager::stopCapture(StringPiece name) {
   inactiveCaptures_[nameStr] = std::move(it->second);
   activeCaptures_.erase(it);
   capturesRunning_.store(!activeCaptures_.empty(), std::memory_order_release);
+  removeDataplaneCaptureLocked(nameStr);
 }
 
 unique_ptr<PktCapture> PktCaptureManager::forgetCapture(StringPiece name) {
@@ -75,6 +310,7 @@ unique_ptr<PktCapture> PktCaptureManager::forgetCapture(StringPiece name) {
     capturesRunning_.store(!activeCaptures_.empty(),
                            std::memory_order_release);
     capture->stop();
+    removeDataplaneCaptureLocked(nameStr);
     return capture;
   }
 
@@ -88,6 +324,26 @@ unique_ptr<PktCapture> PktCaptureManager::forgetCapture(StringPiece name) {
   throw FbossError("no capture found with name \"", name, "\"");
 }
 
+CaptureStats PktCaptureManager::getCaptureStats(StringPiece name) {
+  std::lock_guard<std::mutex> g(mutex_);
+  auto nameStr = name.str();
+  auto activeIt = activeCaptures_.find(nameStr);
+  if (activeIt != activeCaptures_.end()) {
+    auto stats = activeIt->second->getStats();
+    stats.active = true;
+    return stats;
+  }
+
+  auto inactiveIt = inactiveCaptures_.find(nameStr);
+  if (inactiveIt != inactiveCaptures_.end()) {
+    auto stats = inactiveIt->second->getStats();
+    stats.active = false;
+    return stats;
+  }
+
+  throw FbossError("no capture found with name \"", name, "\"");
+}
+
 void PktCaptureManager::stopAllCaptures() {
   std::lock_guard<std::mutex> g(mutex_);
 
@@ -131,6 +387,7 @@ void PktCaptureManager::invokeCaptures(const Fn& fn) {
                   << " to the inactive list";
         // Can't do much else here.  Just continue and forget the capture.
       }
+      removeDataplaneCaptureLocked(thisIt->first);
       activeCaptures_.erase(thisIt);
     }
   }
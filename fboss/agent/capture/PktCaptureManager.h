@@ -9,9 +9,12 @@
  */
 #pragma once
 
+#include "fboss/agent/if/gen-cpp2/ctrl_types.h"
+
 #include <folly/Range.h>
 
 #include <atomic>
+#include <functional>
 #include <map>
 #include <memory>
 #include <mutex>
@@ -22,6 +25,7 @@ namespace facebook { namespace fboss {
 class PktCapture;
 class RxPacket;
 class SwSwitch;
+class SwitchState;
 class TxPacket;
 
 class PktCaptureManager {
@@ -32,14 +36,30 @@ class PktCaptureManager {
   /*
    * Start a new packet capture.
    *
-   * This method is safe to call from any thread.
+   * With dataplane set, this also installs a mirror to the CPU and an ACL
+   * that sends the traffic it matches there, on the capture_cpu_queue, so
+   * that the capture sees forwarded packets and not only trapped ones.  The
+   * CPU queue's rate limit keeps the copies from overrunning the agent.
+   * Both are removed when the capture stops, or after
+   * dataplane->timeoutSeconds.
+   *
+   * This method is safe to call from any thread other than the update
+   * thread.
    */
-  void startCapture(std::unique_ptr<PktCapture> capture);
+  void startCapture(
+      std::unique_ptr<PktCapture> capture,
+      const DataplaneCapture* dataplane = nullptr);
 
   void stopCapture(folly::StringPiece name);
   std::unique_ptr<PktCapture> forgetCapture(folly::StringPiece name);
 
   void stopAllCaptures();
+
+  /*
+   * Return the packet and drop counts of the named capture, whether it is
+   * still running or has stopped.
+   */
+  CaptureStats getCaptureStats(folly::StringPiece name);
   void forgetAllCaptures();
 
   /*
@@ -56,6 +76,29 @@ class PktCaptureManager {
     packetReceivedImpl(pkt);
   }
 
+  /*
+   * Whether pkt is one of the copies that a dataplane capture asked for,
+   * which the SwSwitch captures but does not otherwise handle.
+   */
+  bool isDataplaneCopy(const RxPacket* pkt) const {
+    if (!dataplaneCapturesRunning_.load(std::memory_order_acquire)) {
+      return false;
+    }
+    return isDataplaneCopyImpl(pkt);
+  }
+
+  /*
+   * Whether name is a mirror or ACL that a dataplane capture installed,
+   * which config changes leave in place.
+   */
+  static bool isDataplaneCaptureEntry(folly::StringPiece name);
+
+  /*
+   * Remove the mirrors and ACLs of dataplane captures from before a warm
+   * boot.
+   */
+  void removeStaleDataplaneCaptures();
+
   /*
    * packetSent() is called by the SwSwitch whenever a packet is transmitted.
    *
@@ -86,10 +129,26 @@ class PktCaptureManager {
   void invokeCaptures(const Fn& fn);
   void packetReceivedImpl(const RxPacket* pkt);
   void packetSentImpl(const TxPacket* pkt);
-
+  bool isDataplaneCopyImpl(const RxPacket* pkt) const;
+
+  void installDataplaneCapture(
+      const std::string& name,
+      const DataplaneCapture& dataplane);
+  // Must be called with mutex_ held
+  void removeDataplaneCaptureLocked(const std::string& name);
+  void dataplaneCaptureTimedOut(const std::string& name, uint64_t id);
+  static std::shared_ptr<SwitchState> removeDataplaneCaptureEntries(
+      const std::shared_ptr<SwitchState>& state,
+      const std::function<bool(folly::StringPiece)>& matches);
+
+  SwSwitch* sw_{nullptr};
   std::atomic<bool> capturesRunning_{false};
+  std::atomic<bool> dataplaneCapturesRunning_{false};
 
   std::mutex mutex_;
+  // Running dataplane captures, by the id that their timeout checks for
+  std::map<std::string, uint64_t> dataplaneCaptures_;
+  uint64_t nextDataplaneId_{1};
   std::string captureDir_;
   std::map<std::string, std::unique_ptr<PktCapture>> activeCaptures_;
   std::map<std::string, std::unique_ptr<PktCapture>> inactiveCaptures_;
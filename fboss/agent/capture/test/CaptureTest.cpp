@@ -270,3 +270,52 @@ TEST(CaptureTest, FullCapture) {
   //
   // EXPECT_BUF_EQ(updatedIpPktData, pcapPkts.at(4).data);
 }
+
+TEST(CaptureTest, HeaderFilter) {
+  auto pkt = MockRxPacket::fromHex(
+    // dst mac, src mac
+    "02 00 01 00 00 01  02 00 02 01 02 03"
+    // 802.1q, VLAN 1
+    "81 00 00 01"
+    // IPv4
+    "08 00"
+    // Version(4), IHL(5), DSCP(0), ECN(0), Total Length(28)
+    "45  00  00 1c"
+    // Identification(0), Flags(0), Fragment offset(0)
+    "00 00  00 00"
+    // TTL(31), Protocol(17), Checksum (0, fake)
+    "1F  11  00 00"
+    // Source IP (1.2.3.4)
+    "01 02 03 04"
+    // Destination IP (10.0.0.10)
+    "0a 00 00 0a"
+    // UDP src port(67), dst port(68), length(8), checksum(0)
+    "00 43  00 44  00 08  00 00"
+  );
+
+  CaptureFilter captureFilter;
+  EXPECT_TRUE(HeaderFilter(captureFilter).passes(pkt->buf()));
+
+  captureFilter.etherTypes = {0x0800};
+  EXPECT_TRUE(HeaderFilter(captureFilter).passes(pkt->buf()));
+  captureFilter.etherTypes = {0x86dd, 0x88cc};
+  EXPECT_FALSE(HeaderFilter(captureFilter).passes(pkt->buf()));
+
+  captureFilter.etherTypes = {};
+  captureFilter.ipProtocols = {17};
+  EXPECT_TRUE(HeaderFilter(captureFilter).passes(pkt->buf()));
+  captureFilter.ipProtocols = {6};
+  EXPECT_FALSE(HeaderFilter(captureFilter).passes(pkt->buf()));
+
+  captureFilter.ipProtocols = {};
+  captureFilter.l4Ports = {68};
+  EXPECT_TRUE(HeaderFilter(captureFilter).passes(pkt->buf()));
+  captureFilter.l4Ports = {179};
+  EXPECT_FALSE(HeaderFilter(captureFilter).passes(pkt->buf()));
+
+  // A truncated packet never matches a header filter
+  auto shortPkt = MockRxPacket::fromHex("02 00 01 00 00 01  02 00 02 01");
+  captureFilter.l4Ports = {};
+  captureFilter.etherTypes = {0x0800};
+  EXPECT_FALSE(HeaderFilter(captureFilter).passes(shortPkt->buf()));
+}
@@ -72,3 +72,65 @@ TEST(PcapQueueTest, SimpleAdd) {
   ByteRange waitedPktData = waitedPktBufClone->coalesce();
   EXPECT_EQ(expectedPktData, waitedPktData);
 }
+
+namespace {
+std::unique_ptr<MockRxPacket> makeRxPacket(PortID port) {
+  auto pkt = MockRxPacket::fromHex(
+    // dst mac, src mac
+    "02 00 01 00 00 01  02 00 02 01 02 03"
+    // 802.1q, VLAN 1
+    "81 00 00 01"
+    // Ethertype (fake)
+    "88 b5"
+  );
+  pkt->padToLength(68);
+  pkt->setSrcPort(port);
+  pkt->setSrcVlan(VlanID(1));
+  return pkt;
+}
+
+std::vector<PcapPkt> fillAndDrain(PcapQueue* queue, int numPkts) {
+  for (int n = 1; n <= numPkts; ++n) {
+    auto pkt = makeRxPacket(PortID(n));
+    queue->addPkt(pkt.get());
+  }
+  queue->finish();
+
+  std::vector<PcapPkt> results;
+  pktWaitThread(queue, &results);
+  return results;
+}
+} // unnamed namespace
+
+TEST(PcapQueueTest, DropNewest) {
+  PcapQueue queue(2);
+  auto pkts = fillAndDrain(&queue, 5);
+
+  EXPECT_EQ(3, queue.numDropped());
+  ASSERT_EQ(2, pkts.size());
+  EXPECT_EQ(PortID(1), pkts[0].port());
+  EXPECT_EQ(PortID(2), pkts[1].port());
+}
+
+TEST(PcapQueueTest, DropOldest) {
+  PcapQueue queue(2, 0, PcapQueue::DropPolicy::DROP_OLDEST);
+  auto pkts = fillAndDrain(&queue, 5);
+
+  EXPECT_EQ(3, queue.numDropped());
+  ASSERT_EQ(2, pkts.size());
+  EXPECT_EQ(PortID(4), pkts[0].port());
+  EXPECT_EQ(PortID(5), pkts[1].port());
+}
+
+TEST(PcapQueueTest, AddAfterFinish) {
+  PcapQueue queue(2);
+  queue.finish();
+  EXPECT_TRUE(queue.isFinished());
+
+  auto pkt = makeRxPacket(PortID(1));
+  queue.addPkt(pkt.get());
+  std::vector<PcapPkt> pkts;
+  EXPECT_FALSE(queue.wait(&pkts));
+  EXPECT_TRUE(pkts.empty());
+  EXPECT_EQ(0, queue.numDropped());
+}
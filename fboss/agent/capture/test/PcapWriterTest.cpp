@@ -7,10 +7,12 @@
  *  of patent rights can be found in the PATENTS file in the same directory.
  *
  */
+#include "fboss/agent/capture/PcapFile.h"
 #include "fboss/agent/capture/PcapWriter.h"
 #include "fboss/agent/capture/test/PcapUtil.h"
 #include "fboss/agent/hw/mock/MockRxPacket.h"
 
+#include <folly/Conv.h>
 #include <folly/Exception.h>
 #include <folly/ScopeGuard.h>
 #include <gtest/gtest.h>
@@ -102,3 +104,60 @@ TEST(PcapWriterTest, Drop) {
     EXPECT_EQ(68, pktInfo.hdr.caplen);
   }
 }
+
+TEST(PcapWriterTest, Rotate) {
+  char tmpPath[] = "fbossPcapTest.XXXXXX";
+  int tmpFD = mkstemp(tmpPath);
+  folly::checkUnixError(tmpFD, "failed to create temporary file");
+  auto rotatedPath = folly::to<std::string>(tmpPath, ".1");
+  SCOPE_EXIT {
+    close(tmpFD);
+    unlink(tmpPath);
+    unlink(rotatedPath.c_str());
+  };
+
+  PcapWriter writer;
+  writer.setFileRotation(1000, 2);
+  writer.start(tmpPath, true);
+  uint32_t numPkts = 100;
+  addPackets(&writer, numPkts);
+  writer.finish();
+
+  // Each record is a 16 byte header plus the 68 byte packet.  They all fit
+  // in one buffer, and the file is rotated once that buffer is written.
+  EXPECT_EQ(numPkts * (16 + 68), writer.bytesWritten());
+  EXPECT_EQ(numPkts, readPcapFile(rotatedPath.c_str()).size());
+  EXPECT_EQ(0, readPcapFile(tmpPath).size());
+}
+
+TEST(PcapWriterTest, ReadBack) {
+  char tmpPath[] = "fbossPcapTest.XXXXXX";
+  int tmpFD = mkstemp(tmpPath);
+  folly::checkUnixError(tmpFD, "failed to create temporary file");
+  SCOPE_EXIT {
+    close(tmpFD);
+    unlink(tmpPath);
+  };
+
+  PcapWriter writer(tmpPath, true);
+  uint32_t numPkts = 10;
+  addPackets(&writer, numPkts);
+  writer.finish();
+
+  auto expected = readPcapFile(tmpPath);
+  auto file = PcapFile::openForReading(tmpPath);
+  file.readGlobalHeader();
+  std::chrono::system_clock::time_point timestamp;
+  std::unique_ptr<folly::IOBuf> buf;
+  for (const auto& pktInfo : expected) {
+    ASSERT_TRUE(file.readPacket(&timestamp, &buf));
+    EXPECT_EQ(pktInfo.data, buf->moveToFbString().toStdString());
+    auto usecs = std::chrono::duration_cast<std::chrono::microseconds>(
+        timestamp.time_since_epoch());
+    EXPECT_EQ(
+        pktInfo.hdr.ts.tv_sec * 1000000 + pktInfo.hdr.ts.tv_usec,
+        usecs.count());
+  }
+  EXPECT_EQ(numPkts, expected.size());
+  EXPECT_FALSE(file.readPacket(&timestamp, &buf));
+}
@@ -0,0 +1,83 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/hw/BufferCongestionTracker.h"
+
+#include <folly/logging/xlog.h>
+
+#include <algorithm>
+
+namespace facebook {
+namespace fboss {
+
+BufferCongestionTracker::BufferCongestionTracker(
+    uint64_t thresholdBytes,
+    size_t maxEvents)
+    : thresholdBytes_(std::max<uint64_t>(thresholdBytes, 1)),
+      maxEvents_(std::max<size_t>(maxEvents, 1)) {}
+
+bool BufferCongestionTracker::update(
+    const std::string& portName,
+    Direction dir,
+    unsigned int cosQ,
+    uint64_t bytesUsed,
+    std::chrono::system_clock::time_point now) {
+  auto state = state_.wlock();
+  auto& queue = state->queues[QueueKey(portName, dir, cosQ)];
+  if (queue.congested) {
+    queue.peakBytes = std::max(queue.peakBytes, bytesUsed);
+    if (bytesUsed >= thresholdBytes_ / 2) {
+      return true;
+    }
+  } else if (bytesUsed < thresholdBytes_) {
+    return false;
+  }
+
+  BufferCongestionEvent event;
+  event.timestampMsecs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                             now.time_since_epoch())
+                             .count();
+  event.portName = portName;
+  event.ingress = dir == Direction::Ingress;
+  event.queue = cosQ;
+  event.bytesUsed = bytesUsed;
+  event.thresholdBytes = thresholdBytes_;
+  if (queue.congested) {
+    event.peakBytesUsed = queue.peakBytes;
+    event.cleared = true;
+    queue = QueueState();
+    --state->numCongested;
+  } else {
+    queue.congested = true;
+    queue.peakBytes = bytesUsed;
+    ++state->numCongested;
+  }
+  XLOG(DBG2) << "Buffer congestion " << (event.cleared ? "cleared" : "started")
+             << " on " << portName << " " << BufferStatsLogger::dirStr(dir)
+             << " queue " << cosQ << ": " << bytesUsed << " bytes used";
+
+  if (state->events.size() >= maxEvents_) {
+    state->events.pop_front();
+  }
+  state->events.push_back(std::move(event));
+  return queue.congested;
+}
+
+bool BufferCongestionTracker::anyCongested() const {
+  return state_.rlock()->numCongested > 0;
+}
+
+std::vector<BufferCongestionEvent> BufferCongestionTracker::getEvents() const {
+  auto state = state_.rlock();
+  return std::vector<BufferCongestionEvent>(
+      state->events.begin(), state->events.end());
+}
+
+} // namespace fboss
+} // namespace facebook
@@ -0,0 +1,85 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include "fboss/agent/hw/BufferStatsLogger.h"
+#include "fboss/agent/if/gen-cpp2/ctrl_types.h"
+
+#include <folly/Synchronized.h>
+
+#include <chrono>
+#include <deque>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace facebook {
+namespace fboss {
+
+/*
+ * Turns per-queue buffer use into congestion events.
+ *
+ * A queue becomes congested when its buffer use reaches the threshold, and
+ * stays congested until use drops below half the threshold, so a queue
+ * hovering around the threshold doesn't flood the event ring.  Only the
+ * most recent maxEvents events are kept.
+ */
+class BufferCongestionTracker {
+ public:
+  using Direction = BufferStatsLogger::Direction;
+
+  BufferCongestionTracker(uint64_t thresholdBytes, size_t maxEvents);
+
+  /*
+   * Record a queue's current buffer use.  Returns true while the queue is
+   * congested.
+   */
+  bool update(
+      const std::string& portName,
+      Direction dir,
+      unsigned int cosQ,
+      uint64_t bytesUsed,
+      std::chrono::system_clock::time_point now =
+          std::chrono::system_clock::now());
+
+  // Whether any queue is still above the clear threshold
+  bool anyCongested() const;
+
+  // Recent events, oldest first
+  std::vector<BufferCongestionEvent> getEvents() const;
+
+  uint64_t getThresholdBytes() const {
+    return thresholdBytes_;
+  }
+
+ private:
+  using QueueKey = std::tuple<std::string, Direction, unsigned int>;
+  struct QueueState {
+    bool congested{false};
+    uint64_t peakBytes{0};
+  };
+  struct State {
+    std::map<QueueKey, QueueState> queues;
+    std::deque<BufferCongestionEvent> events;
+    size_t numCongested{0};
+  };
+
+  // Forbidden copy constructor and assignment operator
+  BufferCongestionTracker(BufferCongestionTracker const&) = delete;
+  BufferCongestionTracker& operator=(BufferCongestionTracker const&) = delete;
+
+  const uint64_t thresholdBytes_;
+  const size_t maxEvents_;
+  folly::Synchronized<State> state_;
+};
+
+} // namespace fboss
+} // namespace facebook
@@ -43,6 +43,12 @@ public:
   folly::Optional<std::string> getIngressAclMirror();
   folly::Optional<std::string> getEgressAclMirror();
 
+  /*
+   * Re-prioritize the entry in place for acl, which only differs from the
+   * current ACL in priority. Qualifiers, actions and the stat are kept.
+   */
+  void setPriority(const std::shared_ptr<AclEntry>& acl);
+
   void applyMirrorAction(
       const std::string& mirrorName,
       MirrorAction action,
@@ -17,8 +17,55 @@
 
 #include <folly/CppAttributes.h>
 
+#include <unordered_map>
+
 namespace facebook { namespace fboss {
 
+namespace {
+bool sameExceptPriority(
+    const std::shared_ptr<AclEntry>& oldAcl,
+    const std::shared_ptr<AclEntry>& newAcl) {
+  auto fields = *newAcl->getFields();
+  fields.priority = oldAcl->getPriority();
+  return *oldAcl == AclEntry(fields);
+}
+} // namespace
+
+BcmAclTable::AclChanges BcmAclTable::computeAclChanges(
+    const AclMapDelta& delta) {
+  // Pair up old and new ACLs by name, whatever priority they had
+  std::unordered_map<std::string, std::shared_ptr<AclEntry>> oldAcls;
+  std::vector<std::shared_ptr<AclEntry>> newAcls;
+  for (const auto& entry : delta) {
+    const auto& oldAcl = entry.getOld();
+    const auto& newAcl = entry.getNew();
+    if (oldAcl) {
+      oldAcls.emplace(oldAcl->getID(), oldAcl);
+    }
+    if (newAcl) {
+      newAcls.push_back(newAcl);
+    }
+  }
+
+  AclChanges changes;
+  for (const auto& newAcl : newAcls) {
+    auto oldAcl = oldAcls.find(newAcl->getID());
+    if (oldAcl != oldAcls.end() &&
+        sameExceptPriority(oldAcl->second, newAcl)) {
+      if (oldAcl->second->getPriority() != newAcl->getPriority()) {
+        changes.moved.emplace_back(oldAcl->second, newAcl);
+      }
+      oldAcls.erase(oldAcl);
+      continue;
+    }
+    changes.added.push_back(newAcl);
+  }
+  for (const auto& nameAndAcl : oldAcls) {
+    changes.removed.push_back(nameAndAcl.second);
+  }
+  return changes;
+}
+
 /*
  * Release all acl, stat entries.
  * Should only be called when we are about to reset/destroy the acl table
@@ -53,6 +100,30 @@ void BcmAclTable::processRemovedAcl(
   }
 }
 
+void BcmAclTable::processMovedAcls(const AclChanges& changes) {
+  // Take every moving entry out first, as an ACL may be moving to the
+  // priority another one is moving away from
+  std::vector<std::unique_ptr<BcmAclEntry>> entries;
+  for (const auto& oldAndNew : changes.moved) {
+    auto iter = aclEntryMap_.find(oldAndNew.first->getPriority());
+    if (iter == aclEntryMap_.end()) {
+      throw FbossError("ACL=", oldAndNew.first->getID(), " does not exist");
+    }
+    entries.push_back(std::move(iter->second));
+    aclEntryMap_.erase(iter);
+  }
+  for (size_t i = 0; i < entries.size(); ++i) {
+    const auto& newAcl = changes.moved[i].second;
+    entries[i]->setPriority(newAcl);
+    const auto& entry =
+        aclEntryMap_.emplace(newAcl->getPriority(), std::move(entries[i]));
+    if (!entry.second) {
+      throw FbossError(
+          "Failed to move ACL=", newAcl->getID(), " to an existing priority");
+    }
+  }
+}
+
 BcmAclEntry* FOLLY_NULLABLE BcmAclTable::getAclIf(int priority) const {
   auto iter = aclEntryMap_.find(priority);
   if (iter == aclEntryMap_.end()) {
@@ -12,6 +12,7 @@
 #include "fboss/agent/Utils.h"
 #include "fboss/agent/hw/bcm/BcmAclEntry.h"
 #include "fboss/agent/hw/bcm/BcmAclStat.h"
+#include "fboss/agent/state/AclMap.h"
 
 #include <boost/container/flat_map.hpp>
 
@@ -32,10 +33,35 @@ class BcmAclTable {
       MapFilter<int, std::unique_ptr<BcmAclEntry>>::Entry;
   using FilterAction = std::function<void(const FilterEntry&)>;
 
+  /*
+   * The FP entry work an ACL delta boils down to.
+   *
+   * ApplyThriftConfig numbers ACLs consecutively, so inserting one near the
+   * top of a large list renumbers every ACL below it, and the delta shows
+   * each of those priorities as changed. An ACL whose name and content are
+   * unchanged only needs its existing entry moved to the new priority; only
+   * ACLs that are new or whose match or action changed get a new entry.
+   */
+  struct AclChanges {
+    std::vector<std::shared_ptr<AclEntry>> removed;
+    // old and new version of each ACL that only changed priority
+    std::vector<
+        std::pair<std::shared_ptr<AclEntry>, std::shared_ptr<AclEntry>>>
+        moved;
+    std::vector<std::shared_ptr<AclEntry>> added;
+  };
+  static AclChanges computeAclChanges(const AclMapDelta& delta);
+
   explicit BcmAclTable(BcmSwitch* hw) : hw_(hw) {}
   ~BcmAclTable() {}
   void processAddedAcl(const int groupId, const std::shared_ptr<AclEntry>& acl);
   void processRemovedAcl(const std::shared_ptr<AclEntry>& acl);
+  /*
+   * Move the entries of ACLs that only changed priority, keeping their
+   * qualifiers, actions and stats. Removed ACLs must already be gone so
+   * their priorities are free.
+   */
+  void processMovedAcls(const AclChanges& changes);
   void releaseAcls();
 
   // Throw exception if not found
@@ -9,13 +9,42 @@
  */
 #pragma once
 
+#include "fboss/agent/hw/BufferCongestionTracker.h"
 #include "fboss/agent/hw/BufferStatsLogger.h"
 #include "fboss/agent/hw/bcm/BcmPort.h"
 #include "fboss/agent/hw/bcm/BcmSwitch.h"
+#include "fboss/agent/hw/bcm/BcmSwitchEventCallback.h"
+
+#include <atomic>
 
 namespace facebook {
 namespace fboss {
 
+/*
+ * Notes BST threshold triggers, so buffer stats only need to be read once a
+ * queue has crossed its trigger threshold.  The callback runs on the SDK's
+ * event thread, so it only sets a flag for the stats thread to pick up.
+ */
+class BcmBstTriggerCallback : public BcmSwitchEventCallback {
+ public:
+  void callback(
+      const int /*unit*/,
+      const opennsl_switch_event_t /*eventID*/,
+      const uint32_t /*arg1*/,
+      const uint32_t /*arg2*/,
+      const uint32_t /*arg3*/) override {
+    triggered_.store(true, std::memory_order_release);
+  }
+
+  // Whether a trigger fired since the last call
+  bool consumeTrigger() {
+    return triggered_.exchange(false, std::memory_order_acq_rel);
+  }
+
+ private:
+  std::atomic<bool> triggered_{false};
+};
+
 /*
  * Class for BST configuration and stats update
  */
@@ -48,6 +77,21 @@ class BcmBstStatsMgr {
 
   void updateStats();
 
+  /*
+   * Feed a queue's buffer use to the congestion tracker, if the switch
+   * tracks congestion events.  syncStats() calls this for every queue it
+   * reads.
+   */
+  void recordQueueUsage(
+      const std::string& portName,
+      BufferStatsLogger::Direction dir,
+      unsigned int cosQ,
+      uint64_t bytesUsed) const {
+    if (auto tracker = hw_->getBufferCongestionTracker()) {
+      tracker->update(portName, dir, cosQ, bytesUsed);
+    }
+  }
+
  private:
   void syncStats();
   void exportDeviceBufferUsage();
@@ -9,14 +9,33 @@
  */
 #include "fboss/agent/hw/bcm/BcmControlPlane.h"
 #include "fboss/agent/hw/bcm/BcmControlPlaneQueueManager.h"
+#include "fboss/agent/hw/bcm/BcmError.h"
+#include "fboss/agent/hw/bcm/BcmSwitch.h"
+
+#include <folly/logging/xlog.h>
 
 extern "C" {
+#include <opennsl/rx.h>
 #include <opennsl/types.h>
 }
 
 namespace {
 constexpr auto kCPUName = "cpu";
-}
+
+using facebook::fboss::BcmControlPlane;
+using facebook::fboss::cfg::PacketRxReason;
+
+// UNMATCHED has no SDK reason, it matches whatever the others do not
+const BcmControlPlane::BcmRxReasons kBcmRxReasons = {
+    {PacketRxReason::ARP, opennslRxReasonArp},
+    {PacketRxReason::DHCP, opennslRxReasonDhcp},
+    {PacketRxReason::BPDU, opennslRxReasonBpdu},
+    {PacketRxReason::L3_SLOW_PATH, opennslRxReasonL3Slowpath},
+    {PacketRxReason::L3_DEST_MISS, opennslRxReasonL3DestMiss},
+    {PacketRxReason::TTL_1, opennslRxReasonTtl1},
+    {PacketRxReason::CPU_IS_NHOP, opennslRxReasonNhop},
+};
+} // namespace
 
 namespace facebook {
 namespace fboss {
@@ -31,8 +50,48 @@ void BcmControlPlane::setupQueue(const PortQueue& queue) {
 }
 
 void BcmControlPlane::setupRxReasonToQueue(
-    const ControlPlane::RxReasonToQueue& /*reasonToQueue*/) {
-  // TODO(joseph5wu) Implement the logic of setting reason mapping to bcm
+    const ControlPlane::RxReasonToQueue& reasonToQueue) {
+  auto unit = hw_->getUnit();
+  // The SDK checks the mappings in index order, so the catch all goes last
+  int index = 0;
+  for (const auto& reason : kBcmRxReasons) {
+    auto queue = reasonToQueue.find(reason.first);
+    if (queue == reasonToQueue.end()) {
+      continue;
+    }
+    opennsl_rx_reasons_t reasons;
+    OPENNSL_RX_REASON_CLEAR_ALL(reasons);
+    OPENNSL_RX_REASON_SET(reasons, reason.second);
+    auto rv = opennsl_rx_cosq_mapping_set(
+        unit, index, reasons, reasons, 0, 0, 0, 0, queue->second);
+    bcmCheckError(
+        rv, "failed to map rx reason ",
+        cfg::_PacketRxReason_VALUES_TO_NAMES.find(reason.first)->second,
+        " to cpu queue ", static_cast<int>(queue->second));
+    ++index;
+  }
+  auto unmatched = reasonToQueue.find(cfg::PacketRxReason::UNMATCHED);
+  if (unmatched != reasonToQueue.end()) {
+    opennsl_rx_reasons_t none;
+    OPENNSL_RX_REASON_CLEAR_ALL(none);
+    auto rv = opennsl_rx_cosq_mapping_set(
+        unit, index, none, none, 0, 0, 0, 0, unmatched->second);
+    bcmCheckError(
+        rv, "failed to map unmatched rx reasons to cpu queue ",
+        static_cast<int>(unmatched->second));
+    ++index;
+  }
+  // Drop whatever is left of the last mapping
+  for (int stale = index; stale < numRxReasonMappings_; ++stale) {
+    auto rv = opennsl_rx_cosq_mapping_delete(unit, stale);
+    bcmCheckError(rv, "failed to delete rx reason mapping ", stale);
+  }
+  XLOG(DBG1) << "Programmed " << index << " rx reason to cpu queue mappings";
+  numRxReasonMappings_ = index;
+}
+
+const BcmControlPlane::BcmRxReasons& BcmControlPlane::bcmRxReasons() {
+  return kBcmRxReasons;
 }
 
 } // namespace fboss
@@ -14,6 +14,7 @@
 #include "fboss/agent/state/ControlPlane.h"
 
 extern "C" {
+#include <opennsl/rx.h>
 #include <opennsl/types.h>
 }
 
@@ -44,10 +45,18 @@ public:
   void setupQueue(const PortQueue& queue);
 
   /**
-   * Set up the rx packet reason to queue mapping
+   * Set up the rx packet reason to queue mapping. Reasons that are not in
+   * the map are left to the SDK's default queue.
    */
   void setupRxReasonToQueue(const ControlPlane::RxReasonToQueue& reasonToQueue);
 
+  /**
+   * The SDK rx reason for each config reason but UNMATCHED
+   */
+  using BcmRxReasons =
+      std::vector<std::pair<cfg::PacketRxReason, opennsl_rx_reason_t>>;
+  static const BcmRxReasons& bcmRxReasons();
+
   void setupIngressQosPolicy(const folly::Optional<std::string>& qosPolicyName);
 
   void updateQueueCounters();
@@ -65,5 +74,7 @@ private:
   // Broadcom global port number
   const opennsl_gport_t gport_;
   std::unique_ptr<BcmCosQueueManager> queueManager_;
+  // Number of rx reason to queue mappings in hardware
+  int numRxReasonMappings_{0};
 };
 }} // facebook::fboss
@@ -8,10 +8,51 @@
  *
  */
 #include "fboss/agent/hw/bcm/BcmCosQueueManager.h"
+#include "fboss/agent/hw/bcm/BcmStats.h"
 #include "fboss/agent/hw/bcm/CounterUtils.h"
 
+#include <algorithm>
+#include <tuple>
+
 namespace facebook { namespace fboss {
 
+constexpr int BcmCosQueueManager::kAggregatedQueue;
+
+void BcmCosQueueManager::programChanged(
+    const PortQueue& oldQueue,
+    const PortQueue& newQueue) {
+  if (oldQueue.getID() != newQueue.getID() ||
+      oldQueue.getStreamType() != newQueue.getStreamType() ||
+      oldQueue.getScalingFactor() != newQueue.getScalingFactor() ||
+      oldQueue.getAqms() != newQueue.getAqms()) {
+    program(newQueue);
+    return;
+  }
+  programChangedCommon(
+      getQueueGPort(newQueue.getStreamType(), newQueue.getID()),
+      oldQueue,
+      newQueue);
+}
+
+void BcmCosQueueManager::programChangedCommon(
+    opennsl_gport_t gport,
+    const PortQueue& oldQueue,
+    const PortQueue& newQueue) {
+  auto cosQ = newQueue.getID();
+  if (oldQueue.getScheduling() != newQueue.getScheduling() ||
+      oldQueue.getWeight() != newQueue.getWeight()) {
+    programSchedulingAndWeight(gport, cosQ, newQueue);
+  }
+  if (oldQueue.getReservedBytes() != newQueue.getReservedBytes()) {
+    programReservedBytes(gport, cosQ, newQueue);
+  }
+  if (oldQueue.getSharedBytes() != newQueue.getSharedBytes()) {
+    programSharedBytes(gport, cosQ, newQueue);
+  }
+  if (oldQueue.getPacketsPerSec() != newQueue.getPacketsPerSec()) {
+    programBandwidth(gport, cosQ, newQueue);
+  }
+}
 
 void BcmCosQueueManager::fillOrReplaceCounter(
     const BcmCosQueueCounterType& type,
@@ -86,26 +127,47 @@ void BcmCosQueueManager::setupQueueCounters(
   for (const auto& type : getQueueCounterTypes()) {
     setupQueueCounter(type, queueConfig);
   }
+  buildQueueStatReads();
 }
 
-void BcmCosQueueManager::updateQueueStats(
-    std::chrono::seconds now,
-    HwPortStats* portStats) {
-  for (const auto& cntr: queueCounters_) {
+void BcmCosQueueManager::buildQueueStatReads() {
+  queueStatReads_.clear();
+  for (const auto& cntr : queueCounters_) {
     if (cntr.first.isScopeQueues()) {
-      for (auto& countersItr: cntr.second.queues) {
-        updateQueueStat(
-            countersItr.first,
-            cntr.first,
-            countersItr.second.get(),
-            now,
-            portStats);
+      for (const auto& counter : cntr.second.queues) {
+        queueStatReads_.push_back(
+            {cntr.first, counter.first, counter.second.get()});
       }
     }
     if (cntr.first.isScopeAggregated()) {
-      updateQueueAggregatedStat(
-          cntr.first, cntr.second.aggregated.get(), now, portStats);
+      queueStatReads_.push_back(
+          {cntr.first, kAggregatedQueue, cntr.second.aggregated.get()});
+    }
+  }
+  std::sort(
+      queueStatReads_.begin(),
+      queueStatReads_.end(),
+      [](const QueueStatRead& a, const QueueStatRead& b) {
+        return std::tie(a.type.streamType, a.cosQ, a.type.statType) <
+            std::tie(b.type.streamType, b.cosQ, b.type.statType);
+      });
+}
+
+void BcmCosQueueManager::updateQueueStats(
+    std::chrono::seconds now,
+    HwPortStats* portStats) {
+  // All the counters are read in one pass, and updated with the same
+  // timestamp
+  auto start = std::chrono::steady_clock::now();
+  for (const auto& read : queueStatReads_) {
+    if (read.cosQ == kAggregatedQueue) {
+      updateQueueAggregatedStat(read.type, read.counter, now, portStats);
+    } else {
+      updateQueueStat(read.cosQ, read.type, read.counter, now, portStats);
     }
   }
+  BcmStats::get()->queueStatsCollected(
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::steady_clock::now() - start));
 }
 }} // facebook::fboss
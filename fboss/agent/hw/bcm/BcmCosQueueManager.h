@@ -89,6 +89,16 @@ public:
 
   virtual void program(const PortQueue& queue) = 0;
 
+  /*
+   * Program only the settings of newQueue that differ from oldQueue, as the
+   * queue was last programmed, rather than every setting as program() does.
+   * Settings this manager cannot program on their own fall back to
+   * program().
+   */
+  virtual void programChanged(
+      const PortQueue& oldQueue,
+      const PortQueue& newQueue);
+
   struct QueueStatCounters {
     std::unique_ptr<facebook::stats::MonotonicCounter> aggregated = nullptr;
     boost::container::
@@ -147,6 +157,15 @@ protected:
                         opennsl_cos_queue_t cosQ,
                         const PortQueue& queue);
 
+  /*
+   * Program the changes to scheduling, weight, reserved and shared bytes and
+   * bandwidth, which all queues have. Callers handle any other changes.
+   */
+  void programChangedCommon(
+      opennsl_gport_t gport,
+      const PortQueue& oldQueue,
+      const PortQueue& newQueue);
+
   virtual const PortQueue& getDefaultQueueSettings(
     cfg::StreamType streamType) const = 0;
 
@@ -186,6 +205,23 @@ private:
                                std::chrono::seconds now,
                                HwPortStats* portStats = nullptr) = 0;
 
+  // One counter read in an updateQueueStats() pass
+  struct QueueStatRead {
+    BcmCosQueueCounterType type;
+    // kAggregatedQueue for the counter of all queues together
+    int cosQ;
+    facebook::stats::MonotonicCounter* counter;
+  };
+  static constexpr int kAggregatedQueue = -1;
+
+  void buildQueueStatReads();
+
   std::map<BcmCosQueueCounterType, QueueStatCounters> queueCounters_;
+  /*
+   * Every counter in queueCounters_, ordered by queue rather than by counter
+   * type, so a pass reads all the stats of one queue before the next.
+   * Rebuilt whenever the counters are set up again.
+   */
+  std::vector<QueueStatRead> queueStatReads_;
 };
 }} //facebook::fboss
@@ -13,6 +13,7 @@
 #include "fboss/agent/hw/bcm/BcmEgressManager.h"
 #include "fboss/agent/hw/bcm/BcmError.h"
 #include "fboss/agent/hw/bcm/BcmHost.h"
+#include "fboss/agent/hw/bcm/BcmSdkTracer.h"
 #include "fboss/agent/hw/bcm/BcmSwitch.h"
 #include "fboss/agent/hw/bcm/BcmWarmBootCache.h"
 
@@ -29,7 +30,8 @@ bool BcmEgress::alreadyExists(const opennsl_l3_egress_t& newEgress) const {
     return false;
   }
   opennsl_l3_egress_t existingEgress;
-  auto rv = opennsl_l3_egress_get(hw_->getUnit(), id_, &existingEgress);
+  auto rv = BCM_SDK_TRACE(
+      opennsl_l3_egress_get, hw_->getUnit(), id_, &existingEgress);
   bcmCheckError(rv, "Egress object ", id_, " does not exist");
   return newEgress == existingEgress;
 }
@@ -38,7 +40,7 @@ void BcmEgress::verifyDropEgress(int unit) {
   const auto id = getDropEgressId();
   opennsl_l3_egress_t egress;
   opennsl_l3_egress_t_init(&egress);
-  auto ret = opennsl_l3_egress_get(unit, id, &egress);
+  auto ret = BCM_SDK_TRACE(opennsl_l3_egress_get, unit, id, &egress);
   bcmCheckError(ret, "failed to verify drop egress ", id);
   if (!(egress.flags & OPENNSL_L3_DST_DISCARD)) {
     throw FbossError("Egress ID ", id, " is not programmed as drop");
@@ -203,7 +205,8 @@ void BcmEgress::programToCPU() {
   if (id_ != INVALID) {
     flags |= OPENNSL_L3_REPLACE|OPENNSL_L3_WITH_ID;
   }
-  auto rc = opennsl_l3_egress_create(hw_->getUnit(), flags, &eObj, &id_);
+  auto rc = BCM_SDK_TRACE(
+      opennsl_l3_egress_create, hw_->getUnit(), flags, &eObj, &id_);
   bcmCheckError(rc, "failed to program L3 egress object ", id_,
                 " to CPU on unit ", hw_->getUnit());
   XLOG(DBG2) << "programmed L3 egress object " << id_ << " to CPU on unit "
@@ -214,23 +217,22 @@ BcmEgress::~BcmEgress() {
   if (id_ == INVALID) {
     return;
   }
-  auto rc = opennsl_l3_egress_destroy(hw_->getUnit(), id_);
+  auto rc = BCM_SDK_TRACE(opennsl_l3_egress_destroy, hw_->getUnit(), id_);
   bcmLogFatal(rc, hw_, "failed to destroy L3 egress object ",
       id_, " on unit ", hw_->getUnit());
   XLOG(DBG2) << "destroyed L3 egress object " << id_ << " on unit "
              << hw_->getUnit();
 }
 
-BcmEcmpEgress::BcmEcmpEgress(const BcmSwitchIf* hw, const Paths& paths)
-    : BcmEgressBase(hw), paths_(paths) {
+BcmEcmpEgress::BcmEcmpEgress(
+    const BcmSwitchIf* hw,
+    const Paths& paths,
+    uint32_t flowsetSize)
+    : BcmEgressBase(hw), paths_(paths), flowsetSize_(flowsetSize) {
   program();
 }
 
 void BcmEcmpEgress::program() {
-  opennsl_l3_egress_ecmp_t obj;
-  opennsl_l3_egress_ecmp_t_init(&obj);
-  obj.max_paths = ((paths_.size() + 3) >> 2) << 2; // multiple of 4
-
   const auto warmBootCache = hw_->getWarmBootCache();
   auto egressIds2EcmpCItr = warmBootCache->findEcmp(paths_);
   if (egressIds2EcmpCItr != warmBootCache->egressIds2Ecmp_end()) {
@@ -241,48 +243,94 @@ void BcmEcmpEgress::program() {
     // imply that less number of next hops got programmed
     // but just that the max_paths did not get rounded to
     // the next multiple of 4 as we desired.
-    // CHECK(obj.max_paths == existing.max_paths);
+    // CHECK(max_paths == existing.max_paths);
     id_ = existing.ecmp_intf;
     XLOG(DBG1) << "Ecmp egress object for egress : "
                << BcmWarmBootCache::toEgressIdsStr(paths_)
                << " already exists ";
+    uint32_t existingFlowsetSize =
+        existing.dynamic_mode == OPENNSL_L3_ECMP_DYNAMIC_MODE_RESILIENT
+        ? existing.dynamic_size
+        : 0;
     warmBootCache->programmed(egressIds2EcmpCItr);
+    if (existingFlowsetSize != flowsetSize_) {
+      // Hashing mode changed across the restart
+      programHw();
+    }
   } else {
     XLOG(DBG1) << "Adding ecmp egress with egress : "
                << BcmWarmBootCache::toEgressIdsStr(paths_);
-    if (id_ != INVALID) {
-      obj.flags |= OPENNSL_L3_REPLACE|OPENNSL_L3_WITH_ID;
-      obj.ecmp_intf = id_;
-    }
-    opennsl_if_t pathsArray[paths_.size()];
-    auto index = 0;
-    for (const auto& path : paths_) {
-      if (hw_->getEgressManager()->isResolved(path)) {
-        pathsArray[index++] = path;
-      } else {
-        XLOG(DBG1) << "Skipping unresolved egress : " << path << " while "
-                   << "programming ECMP group ";
-      }
+    programHw();
+  }
+  CHECK_NE(id_, INVALID);
+}
+
+void BcmEcmpEgress::programHw() {
+  opennsl_l3_egress_ecmp_t obj;
+  opennsl_l3_egress_ecmp_t_init(&obj);
+  obj.max_paths = ((paths_.size() + 3) >> 2) << 2; // multiple of 4
+  if (id_ != INVALID) {
+    obj.flags |= OPENNSL_L3_REPLACE|OPENNSL_L3_WITH_ID;
+    obj.ecmp_intf = id_;
+  }
+  if (flowsetSize_ > 0) {
+    obj.dynamic_mode = OPENNSL_L3_ECMP_DYNAMIC_MODE_RESILIENT;
+    obj.dynamic_size = flowsetSize_;
+  }
+  opennsl_if_t pathsArray[paths_.size()];
+  auto index = 0;
+  for (const auto& path : paths_) {
+    if (hw_->getEgressManager()->isResolved(path)) {
+      pathsArray[index++] = path;
+    } else {
+      XLOG(DBG1) << "Skipping unresolved egress : " << path << " while "
+                 << "programming ECMP group ";
     }
+  }
 
-    XLOG(DBG2) << "Programming L3 ECMP egress object "
-               << ((id_ != INVALID) ? folly::to<std::string>(id_) :
-                   "(invalid id)")
-               << " for "
-               << paths_.size() << " paths"
-               << ((obj.flags & OPENNSL_L3_REPLACE) ? " replace" :
-                   " noreplace")
-               << ((obj.flags & OPENNSL_L3_WITH_ID) ? " with id" :
-                   " without id");
-    auto ret = opennsl_l3_egress_ecmp_create(hw_->getUnit(), &obj, index,
-                                             pathsArray);
-    bcmCheckError(ret, "failed to program L3 ECMP egress object ", id_,
-                " with ", paths_.size(), " paths");
-    id_ = obj.ecmp_intf;
-    XLOG(DBG2) << "Programmed L3 ECMP egress object " << id_ << " for "
-               << paths_.size() << " paths";
+  XLOG(DBG2) << "Programming L3 ECMP egress object "
+             << ((id_ != INVALID) ? folly::to<std::string>(id_) :
+                 "(invalid id)")
+             << " for "
+             << paths_.size() << " paths"
+             << ((obj.flags & OPENNSL_L3_REPLACE) ? " replace" :
+                 " noreplace")
+             << ((obj.flags & OPENNSL_L3_WITH_ID) ? " with id" :
+                 " without id")
+             << (flowsetSize_ > 0
+                     ? folly::to<std::string>(" resilient with ",
+                                              flowsetSize_, " flowsets")
+                     : "");
+  auto ret = BCM_SDK_TRACE(
+      opennsl_l3_egress_ecmp_create, hw_->getUnit(), &obj, index, pathsArray);
+  bcmCheckError(ret, "failed to program L3 ECMP egress object ", id_,
+              " with ", paths_.size(), " paths");
+  id_ = obj.ecmp_intf;
+  XLOG(DBG2) << "Programmed L3 ECMP egress object " << id_ << " for "
+             << paths_.size() << " paths";
+}
+
+void BcmEcmpEgress::setPathsHwLocked(const Paths& paths) {
+  CHECK_NE(id_, INVALID);
+  if (paths == paths_) {
+    return;
   }
+  XLOG(DBG1) << "Updating ecmp egress " << id_ << " from egress : "
+             << BcmWarmBootCache::toEgressIdsStr(paths_)
+             << " to egress : " << BcmWarmBootCache::toEgressIdsStr(paths);
+  paths_ = paths;
+  programHw();
+}
+
+void BcmEcmpEgress::setFlowsetSizeHwLocked(uint32_t flowsetSize) {
   CHECK_NE(id_, INVALID);
+  if (flowsetSize == flowsetSize_) {
+    return;
+  }
+  XLOG(DBG1) << "Updating ecmp egress " << id_ << " from " << flowsetSize_
+             << " to " << flowsetSize << " resilient flowsets";
+  flowsetSize_ = flowsetSize;
+  programHw();
 }
 
 BcmEcmpEgress::~BcmEcmpEgress() {
@@ -292,7 +340,8 @@ BcmEcmpEgress::~BcmEcmpEgress() {
   opennsl_l3_egress_ecmp_t obj;
   opennsl_l3_egress_ecmp_t_init(&obj);
   obj.ecmp_intf = id_;
-  auto ret = opennsl_l3_egress_ecmp_destroy(hw_->getUnit(), &obj);
+  auto ret =
+      BCM_SDK_TRACE(opennsl_l3_egress_ecmp_destroy, hw_->getUnit(), &obj);
   bcmLogFatal(ret, hw_, "failed to destroy L3 ECMP egress object ",
       id_, " on unit ", hw_->getUnit());
   XLOG(DBG2) << "Destroyed L3 ECMP egress object " << id_ << " on unit "
@@ -316,6 +365,25 @@ bool BcmEcmpEgress::removeEgressIdHwLocked(
   return removeEgressIdHwNotLocked(unit, ecmpId, toRemove);
 }
 
+bool BcmEcmpEgress::setEgressIdsHwNotLocked(
+    int unit,
+    opennsl_l3_egress_ecmp_t ecmp,
+    const std::vector<EgressId>& paths) {
+  ecmp.flags |= OPENNSL_L3_REPLACE | OPENNSL_L3_WITH_ID;
+  std::vector<opennsl_if_t> pathsArray(paths.begin(), paths.end());
+  auto ret = BCM_SDK_TRACE(
+      opennsl_l3_egress_ecmp_create,
+      unit, &ecmp, pathsArray.size(), pathsArray.data());
+  bcmLogError(ret, "failed to update L3 ECMP egress object ",
+      ecmp.ecmp_intf, " to ", paths.size(), " paths");
+  if (OPENNSL_FAILURE(ret)) {
+    return false;
+  }
+  XLOG(DBG1) << "Updated ECMP egress " << ecmp.ecmp_intf << " to "
+             << paths.size() << " paths";
+  return true;
+}
+
 void BcmEgress::programToTrunk(opennsl_if_t intfId, opennsl_vrf_t /* vrf */,
                                const folly::IPAddress& /* ip */,
                                const MacAddress mac, opennsl_trunk_t trunk) {
@@ -332,8 +400,12 @@ void BcmEgress::programToTrunk(opennsl_if_t intfId, opennsl_vrf_t /* vrf */,
   }
 
   if (!alreadyExists(egress)) {
-    auto rc = opennsl_l3_egress_create(hw_->getUnit(), creationFlags, &egress,
-                                       &id_);
+    auto rc = BCM_SDK_TRACE(
+        opennsl_l3_egress_create,
+        hw_->getUnit(),
+        creationFlags,
+        &egress,
+        &id_);
 
     auto desc = folly::to<std::string>(
         "L3 egress object ",
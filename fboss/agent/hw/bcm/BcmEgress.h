@@ -24,6 +24,8 @@ extern "C" {
 #include <boost/noncopyable.hpp>
 #include <boost/container/flat_set.hpp>
 
+#include <vector>
+
 namespace facebook { namespace fboss {
 
 class BcmSwitchIf;
@@ -152,13 +154,34 @@ class BcmEcmpEgress : public BcmEgressBase {
   using Paths = boost::container::flat_multiset<EgressId>;
   enum class Action { SHRINK, EXPAND, SKIP };
 
-  BcmEcmpEgress(const BcmSwitchIf* hw, const Paths& paths);
+  /*
+   * A non-zero flowsetSize programs the group for resilient hashing, with
+   * that many flowsets mapping flows to its members.
+   */
+  BcmEcmpEgress(
+      const BcmSwitchIf* hw,
+      const Paths& paths,
+      uint32_t flowsetSize = 0);
   ~BcmEcmpEgress() override;
   bool pathUnreachableHwLocked(EgressId path);
   bool pathReachableHwLocked(EgressId path);
+  /*
+   * Replace the members of this ECMP egress in HW, keeping its id. Lets
+   * routes pointing to this egress follow a membership change without
+   * being reprogrammed.
+   */
+  void setPathsHwLocked(const Paths& paths);
   const Paths& paths() const {
     return paths_;
   }
+  uint32_t getFlowsetSize() const {
+    return flowsetSize_;
+  }
+  /*
+   * Switch the group between regular (0) and resilient hashing, keeping its
+   * id and members.
+   */
+  void setFlowsetSizeHwLocked(uint32_t flowsetSize);
   bool isEcmp() const override {
     return true;
   }
@@ -183,10 +206,20 @@ class BcmEcmpEgress : public BcmEgressBase {
   removeEgressIdHwNotLocked(int unit, EgressId ecmpId, EgressId toRemove);
   static bool
   removeEgressIdHwLocked(int unit, EgressId ecmpId, EgressId toRemove);
+  /*
+   * Replace all members of an ECMP egress in HW with a single call, e.g.,
+   * to prune several members at once. ecmp is the group as read from HW.
+   */
+  static bool setEgressIdsHwNotLocked(
+      int unit,
+      opennsl_l3_egress_ecmp_t ecmp,
+      const std::vector<EgressId>& paths);
 
  private:
   void program();
-  const Paths paths_;
+  void programHw();
+  Paths paths_;
+  uint32_t flowsetSize_{0};
 };
 
 bool operator==(const opennsl_l3_egress_t& lhs, const opennsl_l3_egress_t& rhs);
@@ -2,8 +2,11 @@
 
 #include "fboss/agent/hw/bcm/BcmEgressManager.h"
 #include "fboss/agent/hw/bcm/BcmHost.h"
+#include "fboss/agent/hw/bcm/BcmStats.h"
 #include "fboss/agent/hw/bcm/BcmSwitch.h"
 
+#include <chrono>
+
 namespace facebook {
 namespace fboss {
 
@@ -76,23 +79,49 @@ void BcmEgressManager::linkStateChangedMaybeLocked(
   }
 }
 
+void BcmEgressManager::linksDownHwNotLocked(
+    const std::vector<opennsl_gport_t>& gports) {
+  auto portAndEgressIdMapping = getPortAndEgressIdsMap();
+  EgressIdSet affectedEgressIds;
+  for (auto gport : gports) {
+    const auto portAndEgressIds =
+        portAndEgressIdMapping->getPortAndEgressIdsIf(gport);
+    if (portAndEgressIds) {
+      const auto& egressIds = portAndEgressIds->getEgressIds();
+      affectedEgressIds.insert(egressIds.begin(), egressIds.end());
+    }
+  }
+  if (affectedEgressIds.empty()) {
+    return;
+  }
+  egressResolutionChangedHwNotLocked(
+      hw_->getUnit(), affectedEgressIds, false /*down*/);
+}
+
 int BcmEgressManager::removeAllEgressesFromEcmpCallback(
-    int unit,
+    int /*unit*/,
     opennsl_l3_egress_ecmp_t* ecmp,
     int intfCount,
     opennsl_if_t* intfArray,
     void* userData) {
-  // loop over the egresses present in the ecmp group. For each that is
-  // in the passed in list of egresses to remove (userData),
-  // remove it from the ecmp group.
-  EgressIdSet* egressesToRemove = static_cast<EgressIdSet*>(userData);
+  // Work out what is left of each ecmp group once the passed in egresses
+  // are removed. The groups are rewritten after the traversal, so each is
+  // updated once however many of its egresses went away.
+  auto* prune = static_cast<EcmpPrune*>(userData);
+  std::vector<opennsl_if_t> remaining;
+  remaining.reserve(intfCount);
   for (int i = 0; i < intfCount; ++i) {
     opennsl_if_t egressInHw = intfArray[i];
-    if (egressesToRemove->find(egressInHw) != egressesToRemove->end()) {
-      BcmEcmpEgress::removeEgressIdHwNotLocked(
-          unit, ecmp->ecmp_intf, egressInHw);
+    if (prune->toRemove->find(egressInHw) == prune->toRemove->end()) {
+      remaining.push_back(egressInHw);
     }
   }
+  // Leave groups alone if nothing changes, or if it would remove their
+  // last path: routes over them then keep forwarding until they are
+  // reprogrammed.
+  if (static_cast<int>(remaining.size()) != intfCount && !remaining.empty()) {
+    prune->groups.emplace_back(*ecmp, std::move(remaining));
+  }
   return 0;
 }
 
@@ -101,9 +130,20 @@ void BcmEgressManager::egressResolutionChangedHwNotLocked(
     const EgressIdSet& affectedEgressIds,
     bool up) {
   CHECK(!up);
-  EgressIdSet tmpEgressIds(affectedEgressIds);
+  auto start = std::chrono::steady_clock::now();
+  EcmpPrune prune(&affectedEgressIds);
   opennsl_l3_egress_ecmp_traverse(
-      unit, removeAllEgressesFromEcmpCallback, &tmpEgressIds);
+      unit, removeAllEgressesFromEcmpCallback, &prune);
+  for (const auto& ecmpAndPaths : prune.groups) {
+    BcmEcmpEgress::setEgressIdsHwNotLocked(
+        unit, ecmpAndPaths.first, ecmpAndPaths.second);
+  }
+  auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start);
+  BcmStats::get()->ecmpPruned(elapsed);
+  XLOG(DBG2) << "Pruned " << affectedEgressIds.size() << " egresses from "
+             << prune.groups.size() << " ECMP groups in " << elapsed.count()
+             << "us";
 }
 
 } // namespace fboss
@@ -13,6 +13,9 @@
 
 #include <folly/SpinLock.h>
 
+#include <utility>
+#include <vector>
+
 extern "C" {
 #include <opennsl/l3.h>
 #include <opennsl/types.h>
@@ -47,6 +50,13 @@ class BcmEgressManager {
     linkStateChangedMaybeLocked(
         BcmTrunk::asGPort(trunk), false /*down*/, false /*not locked*/);
   }
+  /*
+   * Batched down handling for ports and trunks (as gports) that went down
+   * together, e.g., in one linkscan burst. The egresses going over all of
+   * them are pruned from the ECMP groups in a single pass, so each affected
+   * group is updated in HW once rather than once per egress.
+   */
+  void linksDownHwNotLocked(const std::vector<opennsl_gport_t>& gports);
   void linkDownHwLocked(opennsl_port_t port) {
     // Just call the non locked counterpart here.
     // We don't really need the lock for link down
@@ -95,13 +105,20 @@ class BcmEgressManager {
       int unit,
       const EgressIdSet& affectedEgressIds,
       bool up);
+  // ECMP groups to update, collected by removeAllEgressesFromEcmpCallback
+  struct EcmpPrune {
+    explicit EcmpPrune(const EgressIdSet* toRemove) : toRemove(toRemove) {}
+    const EgressIdSet* toRemove;
+    std::vector<std::pair<opennsl_l3_egress_ecmp_t, std::vector<opennsl_if_t>>>
+        groups;
+  };
   // Callback for traversal in egressResolutionChangedHwNotLocked
   static int removeAllEgressesFromEcmpCallback(
       int unit,
       opennsl_l3_egress_ecmp_t* ecmp, // ecmp object being traversed
       int intfCount, // number of egresses in the ecmp group
       opennsl_if_t* intfArray, // array of egresses in the ecmp group
-      void* userData); // egresses we intend to remove from the ecmp group
+      void* userData); // EcmpPrune
   void setPort2EgressIdsInternal(std::shared_ptr<PortAndEgressIdsMap> newMap);
 
   const BcmSwitchIf* hw_;
@@ -21,6 +21,7 @@
 #include "fboss/agent/hw/bcm/BcmNextHop.h"
 #include "fboss/agent/hw/bcm/BcmPort.h"
 #include "fboss/agent/hw/bcm/BcmPortTable.h"
+#include "fboss/agent/hw/bcm/BcmSdkTracer.h"
 #include "fboss/agent/hw/bcm/BcmSwitch.h"
 #include "fboss/agent/hw/bcm/BcmTrunkTable.h"
 #include "fboss/agent/hw/bcm/BcmWarmBootCache.h"
@@ -105,6 +106,16 @@ void BcmHost::addToBcmHostTable(bool isMultipath, bool replace) {
     return;
   }
 
+  auto* hostTable = hw_->writableHostTable();
+  if (hostTable->isHostBatchOpen()) {
+    hostTable->queueHostAdd(this, isMultipath, replace);
+    return;
+  }
+  writeToBcmHostTable(isMultipath, replace);
+}
+
+void BcmHost::writeToBcmHostTable(bool isMultipath, bool replace) {
+  const auto& addr = key_.addr();
   opennsl_l3_host_t host;
   initHostCommon(&host);
   if (isMultipath) {
@@ -151,7 +162,7 @@ void BcmHost::addToBcmHostTable(bool isMultipath, bool replace) {
   if (needToAddInHw) {
     XLOG(DBG3) << (host.l3a_flags & OPENNSL_L3_REPLACE ? "Replacing" : "Adding")
                << "host entry for : " << addr;
-    auto rc = opennsl_l3_host_add(hw_->getUnit(), &host);
+    auto rc = BCM_SDK_TRACE(opennsl_l3_host_add, hw_->getUnit(), &host);
     bcmCheckError(rc, "failed to program L3 host object for ", key_.str(),
       " @egress ", getEgressId());
     XLOG(DBG3) << "Programmed L3 host object for " << key_.str() << " @egress "
@@ -300,10 +311,13 @@ void BcmHost::programToTrunk(opennsl_if_t intf,
 }
 
 BcmHost::~BcmHost() {
+  if (queuedForHW_) {
+    hw_->writableHostTable()->unqueueHostAdd(this);
+  }
   if (addedInHW_) {
     opennsl_l3_host_t host;
     initHostCommon(&host);
-    auto rc = opennsl_l3_host_delete(hw_->getUnit(), &host);
+    auto rc = BCM_SDK_TRACE(opennsl_l3_host_delete, hw_->getUnit(), &host);
     bcmLogFatal(rc, hw_, "failed to delete L3 host object for ", key_.str());
     XLOG(DBG3) << "deleted L3 host object for " << key_.str();
   } else {
@@ -354,7 +368,7 @@ BcmHost* FOLLY_NULLABLE BcmHostTable::getBcmHostIf(const BcmHostKey& key) const
 
 void BcmHostTable::warmBootHostEntriesSynced() {
   opennsl_port_config_t pcfg;
-  auto rv = opennsl_port_config_get(hw_->getUnit(), &pcfg);
+  auto rv = BCM_SDK_TRACE(opennsl_port_config_get, hw_->getUnit(), &pcfg);
   bcmCheckError(rv, "failed to get port configuration");
   // Ideally we should call this only for ports which were
   // down when we went down, but since we don't record that
@@ -376,6 +390,72 @@ void BcmHostTable::warmBootHostEntriesSynced() {
   }
 }
 
+void BcmHostTable::startHostBatch() {
+  CHECK(!hostBatchOpen_);
+  hostBatchOpen_ = true;
+}
+
+std::vector<BcmHostKey> BcmHostTable::commitHostBatch() {
+  CHECK(hostBatchOpen_);
+  hostBatchOpen_ = false;
+  std::vector<QueuedHostAdd> queued;
+  queued.swap(queuedHostAdds_);
+  for (const auto& add : queued) {
+    if (add.host) {
+      add.host->queuedForHW_ = false;
+    }
+  }
+
+  std::vector<BcmHostKey> failed;
+  for (const auto& add : queued) {
+    if (!add.host) {
+      continue;
+    }
+    try {
+      add.host->writeToBcmHostTable(add.isMultipath, add.replace);
+    } catch (const BcmError& error) {
+      if (error.getBcmError() != OPENNSL_E_FULL) {
+        throw;
+      }
+      XLOG(WARNING) << error.what();
+      failed.push_back(add.host->getHostKey());
+    }
+  }
+  XLOG(DBG3) << "Wrote batch of " << queued.size() << " host entries, "
+             << failed.size() << " failed";
+  return failed;
+}
+
+void BcmHostTable::discardHostBatch() {
+  hostBatchOpen_ = false;
+  for (const auto& add : queuedHostAdds_) {
+    if (add.host) {
+      add.host->queuedForHW_ = false;
+    }
+  }
+  queuedHostAdds_.clear();
+}
+
+void BcmHostTable::queueHostAdd(
+    BcmHost* host,
+    bool isMultipath,
+    bool replace) {
+  if (host->queuedForHW_) {
+    return;
+  }
+  host->queuedForHW_ = true;
+  queuedHostAdds_.push_back(QueuedHostAdd{host, isMultipath, replace});
+}
+
+void BcmHostTable::unqueueHostAdd(BcmHost* host) {
+  for (auto& add : queuedHostAdds_) {
+    if (add.host == host) {
+      add.host = nullptr;
+    }
+  }
+  host->queuedForHW_ = false;
+}
+
 std::shared_ptr<BcmHost> BcmHostTable::refOrEmplace(const BcmHostKey& key) {
   auto rv = hosts_.refOrEmplace(key, hw_, key);
   if (rv.second) {
@@ -31,6 +31,8 @@ extern "C" {
 #include <boost/container/flat_map.hpp>
 #include <boost/container/flat_set.hpp>
 
+#include <vector>
+
 namespace facebook { namespace fboss {
 
 class BcmEcmpEgress;
@@ -159,9 +161,11 @@ class BcmHost {
   }
 
  private:
+  friend class BcmHostTable;
   // no copy or assignment
   BcmHost(BcmHost const &) = delete;
   BcmHost& operator=(BcmHost const &) = delete;
+  void writeToBcmHostTable(bool isMultipath, bool replace);
   void program(opennsl_if_t intf, const folly::MacAddress *mac,
                opennsl_port_t port, RouteForwardAction action);
   void initHostCommon(opennsl_l3_host_t *host) const;
@@ -177,6 +181,7 @@ class BcmHost {
   // well
   folly::Optional<BcmPortDescriptor> egressPort_;
   bool addedInHW_{false}; // if added to the HW host(ARP) table or not
+  bool queuedForHW_{false}; // if waiting in an open host batch
   int lookupClassId_{0}; // DST Lookup Class
   RouteForwardAction action_{DROP};
   std::unique_ptr<BcmHostEgress> egress_;
@@ -229,6 +234,23 @@ class BcmHostTable {
 
   std::shared_ptr<BcmHost> refOrEmplace(const BcmHostKey& key);
 
+  /*
+   * While a host batch is open, host entries that would be added to the HW
+   * table are queued instead, and are written in one pass by
+   * commitHostBatch().  This keeps the per neighbor work of a large
+   * neighbor update down to programming its egress object.
+   *
+   * commitHostBatch() returns the keys of the host entries that could not be
+   * written because the HW table is full, and throws on any other error.
+   * discardHostBatch() drops the queued entries without writing them.
+   */
+  void startHostBatch();
+  std::vector<BcmHostKey> commitHostBatch();
+  void discardHostBatch();
+  bool isHostBatchOpen() const {
+    return hostBatchOpen_;
+  }
+
   HostConstIterator begin() const {
     return hosts_.begin();
   }
@@ -238,9 +260,22 @@ class BcmHostTable {
   }
 
  private:
+  friend class BcmHost;
+
+  struct QueuedHostAdd {
+    BcmHost* host;
+    bool isMultipath;
+    bool replace;
+  };
+
+  void queueHostAdd(BcmHost* host, bool isMultipath, bool replace);
+  void unqueueHostAdd(BcmHost* host);
+
   const BcmSwitchIf* hw_{nullptr};
 
   HostRefMap hosts_;
+  bool hostBatchOpen_{false};
+  std::vector<QueuedHostAdd> queuedHostAdds_;
 };
 
 class BcmNeighborTable {
@@ -2,26 +2,75 @@
 
 #include "fboss/agent/hw/bcm/BcmMultiPathNextHop.h"
 
+#include "fboss/agent/hw/bcm/BcmError.h"
 #include "fboss/agent/hw/bcm/BcmHost.h"
 #include "fboss/agent/hw/bcm/BcmIntf.h"
 #include "fboss/agent/hw/bcm/BcmNextHop.h"
+#include "fboss/agent/hw/bcm/BcmStats.h"
 #include "fboss/agent/hw/bcm/BcmSwitch.h"
 #include "fboss/agent/hw/bcm/BcmWarmBootCache.h"
 
-namespace facebook {
-namespace fboss {
+#include <gflags/gflags.h>
 
-BcmMultiPathNextHop::BcmMultiPathNextHop(
-    const BcmSwitchIf* hw,
-    BcmMultiPathNextHopKey key)
-    : hw_(hw), vrf_(key.first) {
-  auto& fwd = key.second;
+#include <algorithm>
+
+DEFINE_int32(
+    ecmp_group_limit,
+    0,
+    "Most ECMP groups to program, 0 for as many as the hardware takes. "
+    "Routes needing more are spilled onto existing groups or single paths");
+DEFINE_bool(
+    recursive_next_hops,
+    false,
+    "Point routes resolved through other routes at an ECMP egress shared by "
+    "the routes with the same unresolved next hops, which is updated in "
+    "place when they resolve differently. Takes an ECMP group per set of "
+    "unresolved next hops");
+
+namespace {
+
+bool sameNextHop(
+    const facebook::fboss::NextHop& a,
+    const facebook::fboss::NextHop& b) {
+  // Ignoring weights
+  return a.addr() == b.addr() && a.intfID() == b.intfID() &&
+      a.labelForwardingAction() == b.labelForwardingAction();
+}
+
+// Whether every next hop of `group` is one of `nhops`
+bool forwardsWithin(
+    const facebook::fboss::RouteNextHopSet& group,
+    const facebook::fboss::RouteNextHopSet& nhops) {
+  return std::all_of(group.begin(), group.end(), [&](const auto& member) {
+    return std::any_of(nhops.begin(), nhops.end(), [&](const auto& nhop) {
+      return sameNextHop(member, nhop);
+    });
+  });
+}
+
+std::shared_ptr<facebook::fboss::BcmNextHop> refOrEmplaceNextHop(
+    const facebook::fboss::BcmSwitchIf* hw,
+    const facebook::fboss::HostKey& key) {
+  if (key.hasLabel()) {
+    return hw->writableMplsNextHopTable()->referenceOrEmplaceNextHop(
+        folly::poly_cast<facebook::fboss::BcmLabeledHostKey>(key));
+  }
+  return hw->writableL3NextHopTable()->referenceOrEmplaceNextHop(
+      folly::poly_cast<facebook::fboss::BcmHostKey>(key));
+}
+
+// Reference a NextHop object for each of `fwd`, returning the ECMP paths
+// over them
+facebook::fboss::BcmEcmpEgress::Paths referenceNextHops(
+    const facebook::fboss::BcmSwitchIf* hw,
+    opennsl_vrf_t vrf,
+    const facebook::fboss::RouteNextHopSet& fwd,
+    std::vector<std::shared_ptr<facebook::fboss::BcmNextHop>>* nexthops) {
   CHECK_GT(fwd.size(), 0);
-  BcmEcmpEgress::Paths paths;
-  std::vector<std::shared_ptr<BcmNextHop>> nexthops;
-  // allocate a NextHop object for each path in this ECMP
+  facebook::fboss::BcmEcmpEgress::Paths paths;
   for (const auto& nhop : fwd) {
-    auto nexthopSharedPtr = refOrEmplaceNextHop(getNextHopKey(vrf_, nhop));
+    auto nexthopSharedPtr =
+        refOrEmplaceNextHop(hw, facebook::fboss::getNextHopKey(vrf, nhop));
     auto* nexthop = nexthopSharedPtr.get();
     // TODO:
     // Below comment appplies for L3 Nexthop only
@@ -36,24 +85,40 @@ BcmMultiPathNextHop::BcmMultiPathNextHop(
     for (int i = 0; i < nhop.weight(); ++i) {
       paths.insert(nexthop->getEgressId());
     }
-    nexthops.push_back(std::move(nexthopSharedPtr));
+    nexthops->push_back(std::move(nexthopSharedPtr));
   }
-  if (paths.size() > 1) {
-    // BcmEcmpEgress object only for more than 1 paths.
-    ecmpEgress_ = std::make_unique<BcmEcmpEgress>(hw, std::move(paths));
-  }
-  fwd_ = std::move(fwd);
-  nexthops_ = std::move(nexthops);
+  return paths;
 }
 
-std::shared_ptr<BcmNextHop> BcmMultiPathNextHop::refOrEmplaceNextHop(
-    const HostKey& key) {
-  if (key.hasLabel()) {
-    return hw_->writableMplsNextHopTable()->referenceOrEmplaceNextHop(
-        folly::poly_cast<facebook::fboss::BcmLabeledHostKey>(key));
+} // namespace
+
+namespace facebook {
+namespace fboss {
+
+BcmMultiPathNextHop::BcmMultiPathNextHop(
+    const BcmSwitchIf* hw,
+    BcmMultiPathNextHopKey key,
+    BcmMultiPathNextHop* replaced)
+    : hw_(hw), vrf_(key.first) {
+  auto& fwd = key.second;
+  std::vector<std::shared_ptr<BcmNextHop>> nexthops;
+  // allocate a NextHop object for each path in this ECMP
+  auto paths = referenceNextHops(hw, vrf_, fwd, &nexthops);
+  if (nexthops.size() > 1) {
+    // BcmEcmpEgress object only for more than 1 next hop. A single weighted
+    // next hop forwards through its own egress, see getEgressId().
+    if (replaced && replaced->ecmpEgress_) {
+      ecmpEgress_ = std::move(replaced->ecmpEgress_);
+      ecmpEgress_->setPathsHwLocked(paths);
+    } else {
+      ecmpEgress_ = std::make_unique<BcmEcmpEgress>(
+          hw,
+          std::move(paths),
+          hw->getMultiPathNextHopTable()->getResilientFlowsetSize());
+    }
   }
-  return hw_->writableL3NextHopTable()->referenceOrEmplaceNextHop(
-      folly::poly_cast<facebook::fboss::BcmHostKey>(key));
+  fwd_ = std::move(fwd);
+  nexthops_ = std::move(nexthops);
 }
 
 opennsl_if_t BcmMultiPathNextHop::getEgressId() const {
@@ -67,13 +132,178 @@ BcmMultiPathNextHop::~BcmMultiPathNextHop() {
   XLOG(DBG3) << "Removing egress object for " << fwd_;
 }
 
+BcmRecursiveNextHop::BcmRecursiveNextHop(
+    const BcmSwitchIf* hw,
+    BcmRecursiveNextHopKey key,
+    const RouteNextHopSet& resolved)
+    : hw_(hw), key_(std::move(key)), resolved_(resolved) {
+  auto paths = referenceNextHops(hw, key_.first, resolved_, &nexthops_);
+  ecmpEgress_ = std::make_unique<BcmEcmpEgress>(
+      hw, paths, hw->getMultiPathNextHopTable()->getResilientFlowsetSize());
+}
+
+BcmRecursiveNextHop::~BcmRecursiveNextHop() {
+  XLOG(DBG3) << "Removing recursive egress object for " << key_.second;
+}
+
+void BcmRecursiveNextHop::resolveHwLocked(const RouteNextHopSet& resolved) {
+  std::vector<std::shared_ptr<BcmNextHop>> nexthops;
+  auto paths = referenceNextHops(hw_, key_.first, resolved, &nexthops);
+  ecmpEgress_->setPathsHwLocked(paths);
+  XLOG(DBG2) << "recursive next hops " << key_.second << "@vrf " << key_.first
+             << " resolved from " << resolved_ << " to " << resolved
+             << " in place on ECMP egress " << ecmpEgress_->getID();
+  // The old next hops are released once the egress no longer uses them
+  nexthops_.swap(nexthops);
+  resolved_ = resolved;
+}
+
 long BcmMultiPathNextHopTable::getEcmpEgressCount() const {
-  return std::count_if(
-      getNextHops().begin(),
-      getNextHops().end(),
-      [](const auto& entry) -> bool {
-        return entry.second.lock()->getEgress();
+  return recursiveNextHops_.size() +
+      std::count_if(getNextHops().begin(),
+                    getNextHops().end(),
+                    [](const auto& entry) -> bool {
+                      return entry.second.lock()->getEgress();
+                    });
+}
+
+std::shared_ptr<BcmMultiPathNextHop>
+BcmMultiPathNextHopTable::referenceOrEmplaceNextHop(
+    const BcmMultiPathNextHopKey& key) {
+  if (key.second.size() <= 1 || getNextHopIf(key) || !ecmpGroupsExhausted()) {
+    try {
+      return BcmMultiPathNextHopTableBase::referenceOrEmplaceNextHop(key);
+    } catch (const BcmError& error) {
+      if (error.getBcmError() != OPENNSL_E_FULL) {
+        throw;
+      }
+      XLOG(WARNING) << "ECMP group table full: " << error.what();
+    }
+  }
+  return spillHwLocked(key);
+}
+
+bool BcmMultiPathNextHopTable::ecmpGroupsExhausted() const {
+  return FLAGS_ecmp_group_limit > 0 &&
+      getEcmpEgressCount() >= FLAGS_ecmp_group_limit;
+}
+
+std::shared_ptr<BcmMultiPathNextHop> BcmMultiPathNextHopTable::spillHwLocked(
+    const BcmMultiPathNextHopKey& key) {
+  const auto& nhops = key.second;
+  const BcmMultiPathNextHopKey* best = nullptr;
+  for (const auto& entry : getNextHops()) {
+    const auto& groupKey = entry.first;
+    if (groupKey.first != key.first || !entry.second.lock()->getEgress() ||
+        !forwardsWithin(groupKey.second, nhops)) {
+      continue;
+    }
+    if (!best || groupKey.second.size() > best->second.size()) {
+      best = &groupKey;
+    }
+  }
+  if (best) {
+    XLOG(DBG2) << "no ECMP group left for " << nhops << "@vrf " << key.first
+               << ", merged into the group for " << best->second;
+    BcmStats::get()->ecmpGroupMerged();
+    return BcmMultiPathNextHopTableBase::referenceOrEmplaceNextHop(*best);
+  }
+
+  auto heaviest = std::max_element(
+      nhops.begin(), nhops.end(), [](const auto& a, const auto& b) {
+        return a.weight() < b.weight();
       });
+  XLOG(DBG2) << "no ECMP group left for " << nhops << "@vrf " << key.first
+             << ", using the single path " << *heaviest;
+  BcmStats::get()->ecmpGroupSinglePath();
+  return BcmMultiPathNextHopTableBase::referenceOrEmplaceNextHop(
+      BcmMultiPathNextHopKey(key.first, RouteNextHopSet{*heaviest}));
+}
+
+std::shared_ptr<BcmRecursiveNextHop>
+BcmMultiPathNextHopTable::referenceOrEmplaceRecursiveNextHop(
+    const BcmRecursiveNextHopKey& key,
+    const RouteNextHopSet& resolved) {
+  auto existing = recursiveNextHops_.get(key);
+  if (existing) {
+    if (existing->getResolved() != resolved) {
+      return nullptr;
+    }
+  } else if (ecmpGroupsExhausted()) {
+    return nullptr;
+  }
+  try {
+    return recursiveNextHops_
+        .refOrEmplace(key, getBcmSwitch(), key, resolved)
+        .first;
+  } catch (const BcmError& error) {
+    if (error.getBcmError() != OPENNSL_E_FULL) {
+      throw;
+    }
+    XLOG(WARNING) << "ECMP group table full: " << error.what();
+  }
+  return nullptr;
+}
+
+bool BcmMultiPathNextHopTable::updateRecursiveNextHopHwLocked(
+    const BcmRecursiveNextHopKey& key,
+    const RouteNextHopSet& resolved,
+    long routes) {
+  auto recursive = recursiveNextHops_.get(key);
+  if (!recursive || recursive->getResolved() == resolved ||
+      recursiveNextHops_.referenceCount(key) != routes) {
+    return false;
+  }
+  recursive->resolveHwLocked(resolved);
+  BcmStats::get()->recursiveNextHopUpdated(routes);
+  return true;
+}
+
+void BcmMultiPathNextHopTable::setResilientFlowsetSizeHwLocked(
+    uint32_t flowsetSize) {
+  if (flowsetSize == resilientFlowsetSize_) {
+    return;
+  }
+  XLOG(DBG2) << "ECMP resilient flowset size changing from "
+             << resilientFlowsetSize_ << " to " << flowsetSize;
+  resilientFlowsetSize_ = flowsetSize;
+  for (const auto& entry : getNextHops()) {
+    auto ecmpEgress = entry.second.lock()->getEgress();
+    if (ecmpEgress) {
+      ecmpEgress->setFlowsetSizeHwLocked(flowsetSize);
+    }
+  }
+  for (const auto& entry : recursiveNextHops_) {
+    entry.second.lock()->getEgress()->setFlowsetSizeHwLocked(flowsetSize);
+  }
+}
+
+long BcmMultiPathNextHopTable::getResilientFlowsetsUsed() const {
+  long used = 0;
+  for (const auto& entry : getNextHops()) {
+    auto ecmpEgress = entry.second.lock()->getEgress();
+    if (ecmpEgress) {
+      used += ecmpEgress->getFlowsetSize();
+    }
+  }
+  for (const auto& entry : recursiveNextHops_) {
+    used += entry.second.lock()->getEgress()->getFlowsetSize();
+  }
+  return used;
+}
+
+std::shared_ptr<BcmMultiPathNextHop>
+BcmMultiPathNextHopTable::updateNextHopsInPlaceHwLocked(
+    BcmMultiPathNextHop* group,
+    const BcmMultiPathNextHopKey& key) {
+  CHECK_EQ(group->getKey().first, key.first);
+  auto rv = writableNextHops().refOrEmplace(key, getBcmSwitch(), key, group);
+  CHECK(rv.second) << "next hop " << key.second << "@vrf " << key.first
+                   << " already exists";
+  XLOG(DBG2) << "updated next hops of ECMP egress " << rv.first->getEgressId()
+             << " in place from " << group->getKey().second << " to "
+             << key.second;
+  return rv.first;
 }
 
 void BcmMultiPathNextHopTable::egressResolutionChangedHwLocked(
@@ -83,13 +313,19 @@ void BcmMultiPathNextHopTable::egressResolutionChangedHwLocked(
     return;
   }
 
+  std::vector<BcmEcmpEgress*> ecmpEgresses;
   for (const auto& nextHopsAndEcmpHostInfo : getNextHops()) {
     auto weakPtr = nextHopsAndEcmpHostInfo.second;
     auto ecmpHost = weakPtr.lock();
     auto ecmpEgress = ecmpHost->getEgress();
-    if (!ecmpEgress) {
-      continue;
+    if (ecmpEgress) {
+      ecmpEgresses.push_back(ecmpEgress);
     }
+  }
+  for (const auto& entry : recursiveNextHops_) {
+    ecmpEgresses.push_back(entry.second.lock()->getEgress());
+  }
+  for (auto ecmpEgress : ecmpEgresses) {
     for (auto egrId : affectedEgressIds) {
       switch (action) {
         case BcmEcmpEgress::Action::EXPAND:
@@ -32,9 +32,22 @@ class BcmNextHop;
 
 class BcmMultiPathNextHop {
  public:
-  BcmMultiPathNextHop(const BcmSwitchIf* hw, BcmMultiPathNextHopKey key);
+  BcmMultiPathNextHop(const BcmSwitchIf* hw, BcmMultiPathNextHopKey key)
+      : BcmMultiPathNextHop(hw, std::move(key), nullptr) {}
+  /*
+   * Take over the ECMP egress of `replaced` and update its members to the
+   * new next hops, rather than allocating a new ECMP egress. `replaced` is
+   * left without an egress; it must not be programmed any further.
+   */
+  BcmMultiPathNextHop(
+      const BcmSwitchIf* hw,
+      BcmMultiPathNextHopKey key,
+      BcmMultiPathNextHop* replaced);
   virtual ~BcmMultiPathNextHop();
   opennsl_if_t getEgressId() const;
+  BcmMultiPathNextHopKey getKey() const {
+    return std::make_pair(vrf_, fwd_);
+  }
   opennsl_if_t getEcmpEgressId() const {
     return ecmpEgress_ ? ecmpEgress_->getID() : BcmEgressBase::INVALID;
   }
@@ -44,8 +57,6 @@ class BcmMultiPathNextHop {
   }
 
  private:
-  std::shared_ptr<BcmNextHop> refOrEmplaceNextHop(const HostKey& key);
-
   const BcmSwitchIf* hw_;
   opennsl_vrf_t vrf_;
   RouteNextHopSet fwd_;
@@ -53,6 +64,56 @@ class BcmMultiPathNextHop {
   std::unique_ptr<BcmEcmpEgress> ecmpEgress_;
 };
 
+/**
+ * With --recursive_next_hops, routes resolved through other routes, e.g., BGP
+ * routes over the IGP, point to a BcmRecursiveNextHop for the next hops they
+ * were given rather than to the BcmMultiPathNextHop for the next hops they
+ * resolve to. It always has an ECMP egress, even for a single path. When the
+ * underlay changes and all routes over the same recursive next hops resolve
+ * to new next hops, the members of that one egress are updated in place and
+ * none of the routes, however many there are, need to be reprogrammed.
+ *
+ * The key holds the unresolved next hops.
+ */
+using BcmRecursiveNextHopKey = std::pair<opennsl_vrf_t, RouteNextHopSet>;
+
+class BcmRecursiveNextHop {
+ public:
+  BcmRecursiveNextHop(
+      const BcmSwitchIf* hw,
+      BcmRecursiveNextHopKey key,
+      const RouteNextHopSet& resolved);
+  ~BcmRecursiveNextHop();
+
+  const BcmRecursiveNextHopKey& getKey() const {
+    return key_;
+  }
+  // The next hops the recursive ones resolve to
+  const RouteNextHopSet& getResolved() const {
+    return resolved_;
+  }
+  opennsl_if_t getEgressId() const {
+    return ecmpEgress_->getID();
+  }
+  BcmEcmpEgress* getEgress() const {
+    return ecmpEgress_.get();
+  }
+
+  // Move the ECMP egress to the paths of `resolved`, keeping its id
+  void resolveHwLocked(const RouteNextHopSet& resolved);
+
+ private:
+  // Forbidden copy constructor and assignment operator
+  BcmRecursiveNextHop(BcmRecursiveNextHop const &) = delete;
+  BcmRecursiveNextHop& operator=(BcmRecursiveNextHop const &) = delete;
+
+  const BcmSwitchIf* hw_;
+  BcmRecursiveNextHopKey key_;
+  RouteNextHopSet resolved_;
+  std::vector<std::shared_ptr<BcmNextHop>> nexthops_;
+  std::unique_ptr<BcmEcmpEgress> ecmpEgress_;
+};
+
 using BcmMultiPathNextHopTableBase =
     BcmNextHopTable<BcmMultiPathNextHopKey, BcmMultiPathNextHop>;
 class BcmMultiPathNextHopTable : public BcmMultiPathNextHopTableBase {
@@ -72,6 +133,75 @@ class BcmMultiPathNextHopTable : public BcmMultiPathNextHopTableBase {
   }
 
   long getEcmpEgressCount() const;
+
+  /*
+   * Reference the next hops for `key`, creating them if needed. When that
+   * takes a new ECMP group and none is left, because --ecmp_group_limit
+   * groups are in use or the hardware table is full, `key` is spilled onto
+   * next hops that only forward to members of `key`: preferably an existing
+   * group over the most of its members (the same members with other weights
+   * first), otherwise a single path to its heaviest member. Spilled routes
+   * get their own group the next time they are programmed.
+   */
+  std::shared_ptr<BcmMultiPathNextHop> referenceOrEmplaceNextHop(
+      const BcmMultiPathNextHopKey& key);
+
+  /*
+   * Flowsets per ECMP group when the ECMP LoadBalancer uses resilient
+   * hashing, 0 otherwise. New ECMP egresses are programmed with it, and
+   * changing it reprograms the existing ones.
+   */
+  uint32_t getResilientFlowsetSize() const {
+    return resilientFlowsetSize_;
+  }
+  void setResilientFlowsetSizeHwLocked(uint32_t flowsetSize);
+  // Flowset table entries taken by the ECMP egresses
+  long getResilientFlowsetsUsed() const;
+
+  /*
+   * Move the ECMP egress of `group` to a new entry for `key`, updating its
+   * members in HW. Routes still referencing `group` keep forwarding through
+   * the same ECMP egress id, now with the new members, and do not need to
+   * be reprogrammed when they move to `key`. Callers must make sure that
+   * every user of `group` is moving to `key` and that `key` is not in the
+   * table yet.
+   */
+  std::shared_ptr<BcmMultiPathNextHop> updateNextHopsInPlaceHwLocked(
+      BcmMultiPathNextHop* group,
+      const BcmMultiPathNextHopKey& key);
+
+  using RecursiveMapT =
+      FlatRefMap<BcmRecursiveNextHopKey, BcmRecursiveNextHop>;
+  const RecursiveMapT& getRecursiveNextHops() const {
+    return recursiveNextHops_;
+  }
+  /*
+   * Reference the recursive next hop for `key`, creating it resolved to
+   * `resolved` if needed. Returns null when it exists but resolves to other
+   * next hops, as routes it was not updated for still use it, or when no
+   * ECMP group is left for a new one. The route should then use the next
+   * hops it resolves to directly.
+   */
+  std::shared_ptr<BcmRecursiveNextHop> referenceOrEmplaceRecursiveNextHop(
+      const BcmRecursiveNextHopKey& key,
+      const RouteNextHopSet& resolved);
+  /*
+   * Resolve the recursive next hop for `key` to `resolved` in place, if
+   * `routes` are all of the routes using it, i.e., none is left behind on
+   * the old resolution. Returns whether it was updated.
+   */
+  bool updateRecursiveNextHopHwLocked(
+      const BcmRecursiveNextHopKey& key,
+      const RouteNextHopSet& resolved,
+      long routes);
+
+ private:
+  bool ecmpGroupsExhausted() const;
+  std::shared_ptr<BcmMultiPathNextHop> spillHwLocked(
+      const BcmMultiPathNextHopKey& key);
+
+  uint32_t resilientFlowsetSize_{0};
+  RecursiveMapT recursiveNextHops_;
 };
 
 } // namespace fboss
@@ -96,6 +96,11 @@ class BcmNextHopTable {
     return hw_;
   }
 
+ protected:
+  MapT& writableNextHops() {
+    return nexthops_;
+  }
+
 private:
   BcmSwitch* hw_;
   MapT nexthops_;
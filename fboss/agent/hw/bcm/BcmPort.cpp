@@ -23,9 +23,11 @@
 #include "fboss/agent/hw/bcm/BcmPlatformPort.h"
 #include "fboss/agent/hw/bcm/BcmPortGroup.h"
 #include "fboss/agent/hw/bcm/BcmPortQueueManager.h"
+#include "fboss/agent/hw/bcm/BcmSdkTracer.h"
 #include "fboss/agent/hw/bcm/BcmStatsConstants.h"
 #include "fboss/agent/hw/bcm/BcmSwitch.h"
 #include "fboss/agent/hw/bcm/BcmPlatform.h"
+#include "fboss/agent/hw/bcm/BcmVlanPortUpdate.h"
 #include "fboss/agent/hw/bcm/BcmWarmBootCache.h"
 #include "fboss/agent/hw/bcm/CounterUtils.h"
 #include "fboss/agent/state/Port.h"
@@ -74,6 +76,71 @@ static const std::vector<opennsl_stat_val_t> kOutPktLengthStats = {
   snmpOpenNSLTransmittedPkts9217to16383Octets,
 };
 
+namespace {
+struct PortCounter {
+  folly::StringPiece key;
+  opennsl_stat_val_t type;
+  int64_t HwPortStats::*field;
+};
+
+// The counters read from hardware on every BcmPort::updateStats() pass
+const std::vector<PortCounter>& portCounters() {
+  static const std::vector<PortCounter> kPortCounters = {
+      {kInBytes(), opennsl_spl_snmpIfHCInOctets, &HwPortStats::inBytes_},
+      {kInUnicastPkts(),
+       opennsl_spl_snmpIfHCInUcastPkts,
+       &HwPortStats::inUnicastPkts_},
+      {kInMulticastPkts(),
+       opennsl_spl_snmpIfHCInMulticastPkts,
+       &HwPortStats::inMulticastPkts_},
+      {kInBroadcastPkts(),
+       opennsl_spl_snmpIfHCInBroadcastPkts,
+       &HwPortStats::inBroadcastPkts_},
+      {kInDiscardsRaw(),
+       opennsl_spl_snmpIfInDiscards,
+       &HwPortStats::inDiscardsRaw_},
+      {kInErrors(), opennsl_spl_snmpIfInErrors, &HwPortStats::inErrors_},
+      {kInIpv4HdrErrors(),
+       opennsl_spl_snmpIpInHdrErrors,
+       &HwPortStats::inIpv4HdrErrors_},
+      {kInIpv6HdrErrors(),
+       opennsl_spl_snmpIpv6IfStatsInHdrErrors,
+       &HwPortStats::inIpv6HdrErrors_},
+      {kInPause(), opennsl_spl_snmpDot3InPauseFrames, &HwPortStats::inPause_},
+      // Egress Stats
+      {kOutBytes(), opennsl_spl_snmpIfHCOutOctets, &HwPortStats::outBytes_},
+      {kOutUnicastPkts(),
+       opennsl_spl_snmpIfHCOutUcastPkts,
+       &HwPortStats::outUnicastPkts_},
+      {kOutMulticastPkts(),
+       opennsl_spl_snmpIfHCOutMulticastPkts,
+       &HwPortStats::outMulticastPkts_},
+      {kOutBroadcastPkts(),
+       opennsl_spl_snmpIfHCOutBroadcastPckts,
+       &HwPortStats::outBroadcastPkts_},
+      {kOutDiscards(),
+       opennsl_spl_snmpIfOutDiscards,
+       &HwPortStats::outDiscards_},
+      {kOutErrors(), opennsl_spl_snmpIfOutErrors, &HwPortStats::outErrors_},
+      {kOutPause(),
+       opennsl_spl_snmpDot3OutPauseFrames,
+       &HwPortStats::outPause_},
+  };
+  return kPortCounters;
+}
+
+const std::vector<opennsl_stat_val_t>& portCounterTypes() {
+  static const std::vector<opennsl_stat_val_t> kPortCounterTypes = [] {
+    std::vector<opennsl_stat_val_t> types;
+    for (const auto& counter : portCounters()) {
+      types.push_back(counter.type);
+    }
+    return types;
+  }();
+  return kPortCounterTypes;
+}
+} // namespace
+
 // This allows mapping from a speed and port transmission technology
 // to a broadcom supported interface
 static const std::map<cfg::PortSpeed,
@@ -135,16 +202,16 @@ void BcmPort::updateName(const std::string& newName) {
 
 MonotonicCounter* BcmPort::getPortCounterIf(folly::StringPiece statKey) {
   auto pcitr = portCounters_.find(statKey.str());
-  return pcitr != portCounters_.end() ? &pcitr->second : nullptr;
+  return pcitr != portCounters_.end() ? pcitr->second.get_pointer() : nullptr;
 }
 
-void BcmPort::reinitPortStat(folly::StringPiece statKey) {
-  auto stat = getPortCounterIf(statKey);
+void BcmPort::reinitPortStat(folly::StringPiece statKey, bool lazy) {
+  auto& stat = portCounters_[statKey.str()];
 
   if (!stat) {
-    portCounters_.emplace(
-        statKey.str(),
-        MonotonicCounter({statName(statKey), stats::SUM, stats::RATE}));
+    if (!lazy) {
+      stat.emplace(statName(statKey), stats::SUM, stats::RATE);
+    }
   } else if (stat->getName() != statName(statKey)) {
     MonotonicCounter newStat{statName(statKey), stats::SUM, stats::RATE};
     stat->swap(newStat);
@@ -160,10 +227,10 @@ void BcmPort::reinitPortStats() {
   reinitPortStat(kInDiscardsRaw());
   reinitPortStat(kInDiscards());
   reinitPortStat(kInErrors());
-  reinitPortStat(kInPause());
-  reinitPortStat(kInIpv4HdrErrors());
-  reinitPortStat(kInIpv6HdrErrors());
-  reinitPortStat(kInDstNullDiscards());
+  reinitPortStat(kInPause(), true);
+  reinitPortStat(kInIpv4HdrErrors(), true);
+  reinitPortStat(kInIpv6HdrErrors(), true);
+  reinitPortStat(kInDstNullDiscards(), true);
 
   reinitPortStat(kOutBytes());
   reinitPortStat(kOutUnicastPkts());
@@ -171,8 +238,8 @@ void BcmPort::reinitPortStats() {
   reinitPortStat(kOutBroadcastPkts());
   reinitPortStat(kOutDiscards());
   reinitPortStat(kOutErrors());
-  reinitPortStat(kOutPause());
-  reinitPortStat(kOutEcnCounter());
+  reinitPortStat(kOutPause(), true);
+  reinitPortStat(kOutEcnCounter(), true);
 
   queueManager_->setupQueueCounters();
 
@@ -208,7 +275,7 @@ BcmPort::BcmPort(
       portName_(folly::to<string>("port", platformPort_->getPortID())) {
 
   // Obtain the gport handle from the port handle.
-  int rv = opennsl_port_gport_get(unit_, port_, &gport_);
+  int rv = BCM_SDK_TRACE(opennsl_port_gport_get, unit_, port_, &gport_);
   bcmCheckError(rv, "Failed to get gport for BCM port ", port_);
 
   queueManager_ = std::make_unique<BcmPortQueueManager>(
@@ -232,7 +299,7 @@ void BcmPort::init(bool warmBoot) {
     // Get port status from HW on warm boot.
     // All ports are initially down on a cold boot.
     int linkStatus;
-    opennsl_port_link_status_get(unit_, port_, &linkStatus);
+    BCM_SDK_TRACE(opennsl_port_link_status_get, unit_, port_, &linkStatus);
     up = (linkStatus == OPENNSL_PORT_LINK_STATUS_UP);
   } else {
     // In open source code, we don't have any guarantees for the
@@ -241,7 +308,7 @@ void BcmPort::init(bool warmBoot) {
     //
     // We should only be doing this on cold boot, since warm booting
     // should be initializing the state for us.
-    auto rv = opennsl_port_enable_set(unit_, port_, false);
+    auto rv = BCM_SDK_TRACE(opennsl_port_enable_set, unit_, port_, false);
     bcmCheckError(rv, "failed to set port to known state: ", port_);
   }
   initCustomStats();
@@ -271,42 +338,54 @@ bool BcmPort::supportsSpeed(cfg::PortSpeed speed) {
   return speed <= getMaxSpeed();
 }
 
-opennsl_pbmp_t BcmPort::getPbmp() {
-  opennsl_pbmp_t pbmp;
-  OPENNSL_PBMP_PORT_SET(pbmp, port_);
-  return pbmp;
-}
-
 void BcmPort::disable(const std::shared_ptr<Port>& swPort) {
   if (!isEnabled()) {
     // Already disabled
     return;
   }
 
-  auto pbmp = getPbmp();
-  for (auto entry : swPort->getVlans()) {
-    auto rv = opennsl_vlan_port_remove(unit_, entry.first, pbmp);
-    bcmCheckError(rv, "failed to remove disabled port ",
-                  swPort->getID(), " from VLAN ", entry.first);
-  }
-
   disableStatCollection();
 
   // Disable sFlow sampling
   disableSflow();
 
-  auto rv = opennsl_port_enable_set(unit_, port_, false);
+  auto rv = BCM_SDK_TRACE(opennsl_port_enable_set, unit_, port_, false);
   bcmCheckError(rv, "failed to disable port ", swPort->getID());
 }
 
+void BcmPort::addToVlans(
+    const std::shared_ptr<Port>& swPort,
+    BcmVlanPortUpdate* update) {
+  if (isEnabled()) {
+    // Already in its VLANs, as enable() will not enable it again
+    return;
+  }
+  for (const auto& entry : swPort->getVlans()) {
+    update->addPort(entry.first, port_, entry.second.tagged);
+  }
+}
+
+void BcmPort::removeFromVlans(
+    const std::shared_ptr<Port>& swPort,
+    BcmVlanPortUpdate* update) {
+  if (!isEnabled()) {
+    // Already out of its VLANs
+    return;
+  }
+  for (const auto& entry : swPort->getVlans()) {
+    update->removePort(entry.first, port_);
+  }
+}
+
 void BcmPort::disableLinkscan() {
-  int rv = opennsl_linkscan_mode_set(unit_, port_, OPENNSL_LINKSCAN_MODE_NONE);
+  int rv = BCM_SDK_TRACE(
+      opennsl_linkscan_mode_set, unit_, port_, OPENNSL_LINKSCAN_MODE_NONE);
   bcmCheckError(rv, "Failed to disable linkscan on port ", port_);
 }
 
 bool BcmPort::isEnabled() {
   int enabled;
-  auto rv = opennsl_port_enable_get(unit_, port_, &enabled);
+  auto rv = BCM_SDK_TRACE(opennsl_port_enable_get, unit_, port_, &enabled);
   bcmCheckError(rv, "Failed to determine if port is already disabled");
   return static_cast<bool>(enabled);
 }
@@ -316,7 +395,8 @@ bool BcmPort::isUp() {
     return false;
   }
   int linkStatus;
-  auto rv = opennsl_port_link_status_get(hw_->getUnit(), port_, &linkStatus);
+  auto rv = BCM_SDK_TRACE(
+      opennsl_port_link_status_get, hw_->getUnit(), port_, &linkStatus);
   bcmCheckError(rv, "could not find if the port ", port_, " is up or down...");
   return linkStatus == OPENNSL_PORT_LINK_STATUS_UP;
 }
@@ -327,25 +407,13 @@ void BcmPort::enable(const std::shared_ptr<Port>& swPort) {
     return;
   }
 
-  auto pbmp = getPbmp();
-  opennsl_pbmp_t emptyPortList;
-  OPENNSL_PBMP_CLEAR(emptyPortList);
-  int rv;
-  for (auto entry : swPort->getVlans()) {
-    if (!entry.second.tagged) {
-      rv = opennsl_vlan_port_add(unit_, entry.first, pbmp, pbmp);
-    } else {
-      rv = opennsl_vlan_port_add(unit_, entry.first, pbmp, emptyPortList);
-    }
-    bcmCheckError(rv, "failed to add enabled port ",
-                  swPort->getID(), " to VLAN ", entry.first);
-  }
-
   // Drop packets to/from this port that are tagged with a VLAN that this
   // port isn't a member of.
-  rv = opennsl_port_vlan_member_set(unit_, port_,
-                                    OPENNSL_PORT_VLAN_MEMBER_INGRESS |
-                                    OPENNSL_PORT_VLAN_MEMBER_EGRESS);
+  auto rv = BCM_SDK_TRACE(
+      opennsl_port_vlan_member_set,
+      unit_,
+      port_,
+      OPENNSL_PORT_VLAN_MEMBER_INGRESS | OPENNSL_PORT_VLAN_MEMBER_EGRESS);
   bcmCheckError(rv, "failed to set VLAN filtering on port ",
                 swPort->getID());
 
@@ -354,12 +422,13 @@ void BcmPort::enable(const std::shared_ptr<Port>& swPort) {
 
   enableStatCollection();
 
-  rv = opennsl_port_enable_set(unit_, port_, true);
+  rv = BCM_SDK_TRACE(opennsl_port_enable_set, unit_, port_, true);
   bcmCheckError(rv, "failed to enable port ", swPort->getID());
 }
 
 void BcmPort::enableLinkscan() {
-  int rv = opennsl_linkscan_mode_set(unit_, port_, OPENNSL_LINKSCAN_MODE_SW);
+  int rv = BCM_SDK_TRACE(
+      opennsl_linkscan_mode_set, unit_, port_, OPENNSL_LINKSCAN_MODE_SW);
   bcmCheckError(rv, "Failed to enable linkscan on port ", port_);
 }
 
@@ -401,12 +470,14 @@ void BcmPort::linkStatusChanged(const std::shared_ptr<Port>& port) {
 
 void BcmPort::setIngressVlan(const shared_ptr<Port>& swPort) {
   opennsl_vlan_t currVlan;
-  auto rv = opennsl_port_untagged_vlan_get(unit_, port_, &currVlan);
+  auto rv = BCM_SDK_TRACE(
+      opennsl_port_untagged_vlan_get, unit_, port_, &currVlan);
   bcmCheckError(rv, "failed to get ingress VLAN for port ", swPort->getID());
 
   opennsl_vlan_t bcmVlan = swPort->getIngressVlan();
   if (bcmVlan != currVlan) {
-    rv = opennsl_port_untagged_vlan_set(unit_, port_, bcmVlan);
+    rv = BCM_SDK_TRACE(
+        opennsl_port_untagged_vlan_set, unit_, port_, bcmVlan);
     bcmCheckError(rv, "failed to set ingress VLAN for port ",
                   swPort->getID(), " to ", swPort->getIngressVlan());
   }
@@ -455,7 +526,7 @@ opennsl_port_if_t BcmPort::getDesiredInterfaceMode(cfg::PortSpeed speed,
 
 cfg::PortSpeed BcmPort::getSpeed() const {
   int curSpeed{0};
-  auto rv = opennsl_port_speed_get(unit_, port_, &curSpeed);
+  auto rv = BCM_SDK_TRACE(opennsl_port_speed_get, unit_, port_, &curSpeed);
   bcmCheckError(
     rv, "Failed to get current speed for port ", port_);
   return cfg::PortSpeed(curSpeed);
@@ -465,7 +536,7 @@ cfg::PortSpeed BcmPort::getDesiredPortSpeed(
     const std::shared_ptr<Port>& swPort) {
   if (swPort->getSpeed() == cfg::PortSpeed::DEFAULT) {
     int speed;
-    auto ret = opennsl_port_speed_max(unit_, port_, &speed);
+    auto ret = BCM_SDK_TRACE(opennsl_port_speed_max, unit_, port_, &speed);
     bcmCheckError(ret, "failed to get max speed for port", swPort->getID());
     return cfg::PortSpeed(speed);
   } else {
@@ -481,7 +552,8 @@ void BcmPort::setInterfaceMode(const shared_ptr<Port>& swPort) {
 
   // Check whether we have the correct interface set
   opennsl_port_if_t curMode = opennsl_port_if_t(0);
-  auto ret = opennsl_port_interface_get(unit_, port_, &curMode);
+  auto ret = BCM_SDK_TRACE(
+      opennsl_port_interface_get, unit_, port_, &curMode);
   bcmCheckError(ret, "Failed to get current interface setting for port ",
                      swPort->getID());
 
@@ -498,7 +570,8 @@ void BcmPort::setInterfaceMode(const shared_ptr<Port>& swPort) {
   if (curMode != desiredMode || !portUp) {
     // Changes to the interface setting only seem to take effect on the next
     // call to opennsl_port_speed_set()
-    ret = opennsl_port_interface_set(unit_, port_, desiredMode);
+    ret = BCM_SDK_TRACE(
+        opennsl_port_interface_set, unit_, port_, desiredMode);
     bcmCheckError(ret, "failed to set interface type for port ",
                        swPort->getID());
   }
@@ -555,7 +628,7 @@ void BcmPort::setSpeed(const shared_ptr<Port>& swPort) {
     // transitions. We ensure that the port is down for these
     // potentially unnecessary calls, as otherwise this will cause
     // port flaps on ports where link is up.
-    ret = opennsl_port_speed_set(unit_, port_, desiredSpeed);
+    ret = BCM_SDK_TRACE(opennsl_port_speed_set, unit_, port_, desiredSpeed);
     bcmCheckError(
       ret,
       "failed to set speed to ",
@@ -614,78 +687,7 @@ void BcmPort::updateStats() {
       curPortStats.inDiscards_ == hardware_stats_constants::STAT_UNINITIALIZED()
       ? 0
       : curPortStats.inDiscards_;
-  updateStat(
-      now, kInBytes(), opennsl_spl_snmpIfHCInOctets, &curPortStats.inBytes_);
-  updateStat(
-      now,
-      kInUnicastPkts(),
-      opennsl_spl_snmpIfHCInUcastPkts,
-      &curPortStats.inUnicastPkts_);
-  updateStat(
-      now,
-      kInMulticastPkts(),
-      opennsl_spl_snmpIfHCInMulticastPkts,
-      &curPortStats.inMulticastPkts_);
-  updateStat(
-      now,
-      kInBroadcastPkts(),
-      opennsl_spl_snmpIfHCInBroadcastPkts,
-      &curPortStats.inBroadcastPkts_);
-  updateStat(
-      now,
-      kInDiscardsRaw(),
-      opennsl_spl_snmpIfInDiscards,
-      &curPortStats.inDiscardsRaw_);
-  updateStat(
-      now, kInErrors(), opennsl_spl_snmpIfInErrors, &curPortStats.inErrors_);
-  updateStat(
-      now,
-      kInIpv4HdrErrors(),
-      opennsl_spl_snmpIpInHdrErrors,
-      &curPortStats.inIpv4HdrErrors_);
-  updateStat(
-      now,
-      kInIpv6HdrErrors(),
-      opennsl_spl_snmpIpv6IfStatsInHdrErrors,
-      &curPortStats.inIpv6HdrErrors_);
-  updateStat(
-      now,
-      kInPause(),
-      opennsl_spl_snmpDot3InPauseFrames,
-      &curPortStats.inPause_);
-  // Egress Stats
-  updateStat(
-      now,
-      kOutBytes(),
-      opennsl_spl_snmpIfHCOutOctets,
-      &curPortStats.outBytes_);
-  updateStat(
-      now,
-      kOutUnicastPkts(),
-      opennsl_spl_snmpIfHCOutUcastPkts,
-      &curPortStats.outUnicastPkts_);
-  updateStat(
-      now,
-      kOutMulticastPkts(),
-      opennsl_spl_snmpIfHCOutMulticastPkts,
-      &curPortStats.outMulticastPkts_);
-  updateStat(
-      now,
-      kOutBroadcastPkts(),
-      opennsl_spl_snmpIfHCOutBroadcastPckts,
-      &curPortStats.outBroadcastPkts_);
-  updateStat(
-      now,
-      kOutDiscards(),
-      opennsl_spl_snmpIfOutDiscards,
-      &curPortStats.outDiscards_);
-  updateStat(
-      now, kOutErrors(), opennsl_spl_snmpIfOutErrors, &curPortStats.outErrors_);
-  updateStat(
-      now,
-      kOutPause(),
-      opennsl_spl_snmpDot3OutPauseFrames,
-      &curPortStats.outPause_);
+  updatePortCounters(now, &curPortStats);
 
   updateBcmStats(now, &curPortStats);
 
@@ -717,7 +719,8 @@ void BcmPort::updateStats() {
 
   // Update the queue length stat
   uint32_t qlength;
-  auto ret = opennsl_port_queued_count_get(unit_, port_, &qlength);
+  auto ret = BCM_SDK_TRACE(
+      opennsl_port_queued_count_get, unit_, port_, &qlength);
   if (OPENNSL_FAILURE(ret)) {
     XLOG(ERR) << "Failed to get queue length for port " << port_ << " :"
               << opennsl_errmsg(ret);
@@ -742,21 +745,78 @@ void BcmPort::updateStat(
     folly::StringPiece statKey,
     opennsl_stat_val_t type,
     int64_t* statVal) {
-  auto stat = getPortCounterIf(statKey);
   // Use the non-sync API to just get the values accumulated in software.
   // The Broadom SDK's counter thread syncs the HW counters to software every
   // 500000us (defined in config.bcm).
   uint64_t value;
-  auto ret = opennsl_stat_get(unit_, port_, type, &value);
+  auto ret = BCM_SDK_TRACE(opennsl_stat_get, unit_, port_, type, &value);
   if (OPENNSL_FAILURE(ret)) {
     XLOG(ERR) << "Failed to get stat " << type << " for port " << port_ << " :"
               << opennsl_errmsg(ret);
     return;
   }
-  stat->updateValue(now, value);
+  updatePortCounter(now, statKey, *statVal, value);
   *statVal = value;
 }
 
+void BcmPort::updatePortCounter(
+    std::chrono::seconds now,
+    folly::StringPiece statKey,
+    int64_t lastValue,
+    int64_t value) {
+  auto pcitr = portCounters_.find(statKey.str());
+  if (pcitr == portCounters_.end()) {
+    return;
+  }
+  auto& stat = pcitr->second;
+  if (!stat) {
+    if (lastValue == hardware_stats_constants::STAT_UNINITIALIZED() ||
+        value == lastValue) {
+      return;
+    }
+    stat.emplace(statName(statKey), stats::SUM, stats::RATE);
+    // Start from the last reading so that this first increment is counted
+    stat->updateValue(getTimeRetrieved(), lastValue);
+  }
+  stat->updateValue(now, value);
+}
+
+void BcmPort::updatePortCounters(
+    std::chrono::seconds now,
+    HwPortStats* curPortStats) {
+  const auto& counters = portCounters();
+  const auto& types = portCounterTypes();
+  // Read all the counters in one SDK call rather than one call (and one
+  // round of SDK locking) per counter.  Like updateStat(), this only reads
+  // the values the SDK counter thread has already synced to software.
+  std::vector<uint64_t> values(types.size());
+  // opennsl_stat_multi_get() doesn't const qualify its stats argument
+  auto ret = BCM_SDK_TRACE(
+      opennsl_stat_multi_get,
+      unit_,
+      port_,
+      types.size(),
+      const_cast<opennsl_stat_val_t*>(types.data()),
+      values.data());
+  if (OPENNSL_FAILURE(ret)) {
+    XLOG(DBG2) << "Failed to get port counters for port " << port_
+               << " in bulk, reading them one at a time: "
+               << opennsl_errmsg(ret);
+    // One unsupported counter fails the whole bulk read, so fall back to
+    // reading them one at a time to still get the rest.
+    for (const auto& counter : counters) {
+      updateStat(
+          now, counter.key, counter.type, &(curPortStats->*counter.field));
+    }
+    return;
+  }
+  for (size_t i = 0; i < counters.size(); ++i) {
+    auto& field = curPortStats->*counters[i].field;
+    updatePortCounter(now, counters[i].key, field, values[i]);
+    field = values[i];
+  }
+}
+
 bool BcmPort::isMmuLossy() const {
   return hw_->getMmuState() == BcmSwitch::MmuState::MMU_LOSSY;
 }
@@ -771,8 +831,8 @@ void BcmPort::updatePktLenHist(
   // it's stats arguments right now.
   opennsl_stat_val_t* statsArg =
       const_cast<opennsl_stat_val_t*>(&stats.front());
-  auto ret = opennsl_stat_multi_get(unit_, port_,
-                                stats.size(), statsArg, counters);
+  auto ret = BCM_SDK_TRACE(
+      opennsl_stat_multi_get, unit_, port_, stats.size(), statsArg, counters);
   if (OPENNSL_FAILURE(ret)) {
     XLOG(ERR) << "Failed to get packet length stats for port " << port_ << " :"
               << opennsl_errmsg(ret);
@@ -863,7 +923,7 @@ bool BcmPort::shouldReportStats() const {
 
 void BcmPort::enableStatCollection() {
   // Enable packet and byte counter statistic collection.
-  auto rv = opennsl_port_stat_enable_set(unit_, gport_, true);
+  auto rv = BCM_SDK_TRACE(opennsl_port_stat_enable_set, unit_, gport_, true);
   if (rv != OPENNSL_E_EXISTS) {
     // Don't throw an error if counter collection is already enabled
     bcmCheckError(rv, "Unexpected error enabling counter DMA on port ", port_);
@@ -875,7 +935,8 @@ void BcmPort::enableStatCollection() {
 
 void BcmPort::disableStatCollection() {
   // Disable packet and byte counter statistic collection.
-  auto rv = opennsl_port_stat_enable_set(unit_, gport_, false);
+  auto rv =
+      BCM_SDK_TRACE(opennsl_port_stat_enable_set, unit_, gport_, false);
   bcmCheckError(rv, "Unexpected error disabling counter DMA on port ", port_);
 
   statCollectionEnabled_.store(false);
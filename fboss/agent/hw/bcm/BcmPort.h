@@ -24,6 +24,7 @@ extern "C" {
 #include "fboss/agent/hw/gen-cpp2/hardware_stats_types.h"
 #include "fboss/agent/state/Port.h"
 
+#include <folly/Optional.h>
 #include <folly/Range.h>
 #include <folly/Synchronized.h>
 #include <mutex>
@@ -33,6 +34,7 @@ namespace facebook { namespace fboss {
 
 class BcmSwitch;
 class BcmPortGroup;
+class BcmVlanPortUpdate;
 class SwitchState;
 enum class MirrorDirection;
 enum class MirrorAction;
@@ -54,10 +56,23 @@ class BcmPort {
 
   void init(bool warmBoot);
 
+  /*
+   * enable() does not add the port to its VLANs, nor disable() remove it
+   * from them. Callers collect those changes for all the ports they enable
+   * or disable with addToVlans() or removeFromVlans(), called while the port
+   * is still disabled or enabled, and apply them at once before enabling or
+   * after disabling the ports.
+   */
   void enable(const std::shared_ptr<Port>& swPort);
   void enableLinkscan();
   void disable(const std::shared_ptr<Port>& swPort);
   void disableLinkscan();
+  void addToVlans(
+      const std::shared_ptr<Port>& swPort,
+      BcmVlanPortUpdate* update);
+  void removeFromVlans(
+      const std::shared_ptr<Port>& swPort,
+      BcmVlanPortUpdate* update);
   void program(const std::shared_ptr<Port>& swPort);
   void setupQueue(const PortQueue& queue);
 
@@ -126,6 +141,8 @@ class BcmPort {
   void setIngressVlan(const std::shared_ptr<Port>& swPort);
   void setSpeed(const std::shared_ptr<Port>& swPort);
   void setSflowRates(const std::shared_ptr<Port>& swPort);
+  // Rates other than the configured ones, for adaptive sFlow sampling
+  void setSflowRates(int64_t ingressRate, int64_t egressRate);
   void disableSflow();
   void setPortResource(const std::shared_ptr<Port>& swPort);
 
@@ -200,11 +217,17 @@ class BcmPort {
   stats::MonotonicCounter* getPortCounterIf(folly::StringPiece statName);
   bool shouldReportStats() const;
   void reinitPortStats();
-  void reinitPortStat(folly::StringPiece newName);
+  void reinitPortStat(folly::StringPiece newName, bool lazy = false);
+  void updatePortCounter(
+      std::chrono::seconds now,
+      folly::StringPiece statName,
+      int64_t lastValue,
+      int64_t value);
   void updateStat(std::chrono::seconds now,
                   folly::StringPiece statName,
                   opennsl_stat_val_t type,
                   int64_t* portStatVal);
+  void updatePortCounters(std::chrono::seconds now, HwPortStats* curPortStats);
   void updateBcmStats(std::chrono::seconds now, HwPortStats* curPortStats);
   void updatePktLenHist(std::chrono::seconds now,
                         stats::ExportedHistogramMapImpl::LockableHistogram* hist,
@@ -225,8 +248,6 @@ class BcmPort {
       const folly::Optional<std::string>& swMirrorName,
       MirrorDirection direction);
 
-  opennsl_pbmp_t getPbmp();
-
   void setInterfaceMode(const std::shared_ptr<Port>& swPort);
   void setFEC(const std::shared_ptr<Port>& swPort);
   void setPause(const std::shared_ptr<Port>& swPort);
@@ -260,7 +281,10 @@ class BcmPort {
   // The port group this port is a part of
   BcmPortGroup* portGroup_{nullptr};
 
-  std::map<std::string, stats::MonotonicCounter> portCounters_;
+  // Counters that are rarely bumped stay empty, and unregistered, until
+  // their value first changes
+  std::map<std::string, folly::Optional<stats::MonotonicCounter>>
+      portCounters_;
   std::unique_ptr<BcmCosQueueManager> queueManager_;
 
   stats::ExportedStatMapImpl::LockableStat outQueueLen_;
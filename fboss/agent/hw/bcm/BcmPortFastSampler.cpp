@@ -0,0 +1,215 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/hw/bcm/BcmPortFastSampler.h"
+
+#include "fboss/agent/FbossError.h"
+#include "fboss/agent/Utils.h"
+
+#include <folly/logging/xlog.h>
+#include <gflags/gflags.h>
+
+extern "C" {
+#include <opennsl/port.h>
+#include <opennsl/stat.h>
+}
+
+DEFINE_int32(bcm_fast_port_samples, 1024,
+             "Number of samples the fast port sampler keeps per port");
+DEFINE_bool(bcm_fast_port_sample_sync, true,
+            "Sync hardware counters to software before each fast port "
+            "sample.  Without this, samples only see counter changes as "
+            "often as the SDK counter thread syncs them");
+
+namespace {
+// Not const, as opennsl_stat_multi_get() doesn't const qualify its stats
+std::vector<opennsl_stat_val_t> kFastSampleStats = {
+    opennsl_spl_snmpIfHCInOctets,
+    opennsl_spl_snmpIfHCOutOctets,
+    opennsl_spl_snmpIfInDiscards,
+    opennsl_spl_snmpIfOutDiscards,
+};
+
+int64_t perSecond(int64_t delta, int64_t usecs) {
+  return usecs > 0 ? delta * 1000000 / usecs : 0;
+}
+} // namespace
+
+namespace facebook { namespace fboss {
+
+void BcmPortFastSampler::SampleRing::add(const Sample& sample) {
+  auto index = head_.load(std::memory_order_relaxed);
+  auto& slot = slots_[index % slots_.size()];
+  slot.seq.store(2 * (index + 1) + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  for (size_t i = 0; i < NUM_FIELDS; ++i) {
+    slot.values[i].store(sample[i], std::memory_order_relaxed);
+  }
+  slot.seq.store(2 * (index + 1), std::memory_order_release);
+  head_.store(index + 1, std::memory_order_release);
+}
+
+std::vector<BcmPortFastSampler::Sample>
+BcmPortFastSampler::SampleRing::snapshot() const {
+  auto end = head_.load(std::memory_order_acquire);
+  auto begin = end > slots_.size() ? end - slots_.size() : 0;
+
+  std::vector<Sample> samples;
+  samples.reserve(end - begin);
+  for (auto index = begin; index < end; ++index) {
+    const auto& slot = slots_[index % slots_.size()];
+    auto seq = slot.seq.load(std::memory_order_acquire);
+    if (seq != 2 * (index + 1)) {
+      // Already overwritten by a newer sample
+      continue;
+    }
+    Sample sample;
+    for (size_t i = 0; i < NUM_FIELDS; ++i) {
+      sample[i] = slot.values[i].load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.seq.load(std::memory_order_relaxed) == seq) {
+      samples.push_back(sample);
+    }
+  }
+  return samples;
+}
+
+BcmPortFastSampler::BcmPortFastSampler(
+    int unit,
+    const std::map<opennsl_port_t, PortID>& ports,
+    std::chrono::milliseconds interval)
+    : unit_(unit), interval_(interval) {
+  auto ringSize = std::max(FLAGS_bcm_fast_port_samples, 1);
+  for (const auto& port : ports) {
+    ports_.emplace(
+        port.first, std::make_unique<PortSamples>(port.second, ringSize));
+  }
+  thread_ = std::thread([this] { run(); });
+}
+
+BcmPortFastSampler::~BcmPortFastSampler() {
+  {
+    std::lock_guard<std::mutex> g(stopLock_);
+    stop_ = true;
+  }
+  stopCv_.notify_one();
+  thread_.join();
+}
+
+PortFastSamples BcmPortFastSampler::getSamples(opennsl_port_t port) const {
+  auto iter = ports_.find(port);
+  if (iter == ports_.end()) {
+    throw FbossError("port ", port, " is not being fast sampled");
+  }
+  auto& samples = *iter->second;
+
+  PortFastSamples result;
+  result.portId = samples.portId;
+  result.intervalMsecs = interval_.count();
+  for (const auto& sample : samples.ring.snapshot()) {
+    PortFastSample out;
+    out.timestampUsecs = sample[TIMESTAMP_USECS];
+    out.inBytes = sample[IN_BYTES];
+    out.outBytes = sample[OUT_BYTES];
+    out.inDiscards = sample[IN_DISCARDS];
+    out.outDiscards = sample[OUT_DISCARDS];
+    out.outQueueLength = sample[OUT_QUEUE_LENGTH];
+    result.samples.push_back(out);
+  }
+  // The time series report their lowest value until anything is added
+  result.maxInBytesPerSec =
+      std::max<int64_t>(samples.inBytesPerSec.getMax(), 0);
+  result.maxOutBytesPerSec =
+      std::max<int64_t>(samples.outBytesPerSec.getMax(), 0);
+  result.maxOutQueueLength =
+      std::max<int64_t>(samples.outQueueLength.getMax(), 0);
+  return result;
+}
+
+void BcmPortFastSampler::run() {
+  initThread("BcmFastSampler");
+  auto next = std::chrono::steady_clock::now();
+  std::unique_lock<std::mutex> lk(stopLock_);
+  while (!stop_) {
+    lk.unlock();
+    sampleAll();
+    lk.lock();
+    next += interval_;
+    auto now = std::chrono::steady_clock::now();
+    if (next < now) {
+      // Fell behind; skip the missed samples rather than bunching them up
+      next = now;
+    }
+    stopCv_.wait_until(lk, next, [this] { return stop_; });
+  }
+}
+
+void BcmPortFastSampler::sampleAll() {
+  if (FLAGS_bcm_fast_port_sample_sync) {
+    auto ret = opennsl_stat_sync(unit_);
+    if (OPENNSL_FAILURE(ret)) {
+      XLOG(DBG2) << "Failed to sync counters for fast port sampling: "
+                 << opennsl_errmsg(ret);
+    }
+  }
+  for (auto& port : ports_) {
+    samplePort(port.first, port.second.get());
+  }
+}
+
+void BcmPortFastSampler::samplePort(
+    opennsl_port_t port,
+    PortSamples* samples) {
+  uint64_t counters[4];
+  auto ret = opennsl_stat_multi_get(
+      unit_, port, kFastSampleStats.size(), kFastSampleStats.data(), counters);
+  if (OPENNSL_FAILURE(ret)) {
+    XLOG(DBG2) << "Failed to get fast sample counters for port " << port
+               << ": " << opennsl_errmsg(ret);
+    return;
+  }
+  uint32_t qlength = 0;
+  ret = opennsl_port_queued_count_get(unit_, port, &qlength);
+  if (OPENNSL_FAILURE(ret)) {
+    XLOG(DBG2) << "Failed to get queue length for port " << port << ": "
+               << opennsl_errmsg(ret);
+  }
+
+  auto now = std::chrono::system_clock::now();
+  Sample sample;
+  sample[TIMESTAMP_USECS] =
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          now.time_since_epoch())
+          .count();
+  sample[IN_BYTES] = counters[0];
+  sample[OUT_BYTES] = counters[1];
+  sample[IN_DISCARDS] = counters[2];
+  sample[OUT_DISCARDS] = counters[3];
+  sample[OUT_QUEUE_LENGTH] = qlength;
+  samples->ring.add(sample);
+
+  samples->outQueueLength.addValue(qlength);
+  if (samples->last) {
+    const auto& last = *samples->last;
+    auto usecs = sample[TIMESTAMP_USECS] - last[TIMESTAMP_USECS];
+    // Counters can go backwards when they are cleared
+    if (sample[IN_BYTES] >= last[IN_BYTES]) {
+      samples->inBytesPerSec.addValue(
+          perSecond(sample[IN_BYTES] - last[IN_BYTES], usecs));
+    }
+    if (sample[OUT_BYTES] >= last[OUT_BYTES]) {
+      samples->outBytesPerSec.addValue(
+          perSecond(sample[OUT_BYTES] - last[OUT_BYTES], usecs));
+    }
+  }
+  samples->last = sample;
+}
+
+}} // facebook::fboss
@@ -0,0 +1,120 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+extern "C" {
+#include <opennsl/types.h>
+}
+
+#include "fboss/agent/if/gen-cpp2/ctrl_types.h"
+#include "fboss/agent/types.h"
+#include "fboss/lib/TimeSeriesWithMinMax.h"
+
+#include <folly/Optional.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace facebook { namespace fboss {
+
+/*
+ * Samples a small set of counters (bytes, discards and egress queue length)
+ * on a few ports at a much shorter interval than the regular stats update,
+ * so that microbursts which average out over a second can still be seen.
+ *
+ * Sampling runs on its own thread from construction until destruction.  The
+ * set of ports is fixed; to sample a different set, replace the sampler.
+ */
+class BcmPortFastSampler {
+ public:
+  BcmPortFastSampler(
+      int unit,
+      const std::map<opennsl_port_t, PortID>& ports,
+      std::chrono::milliseconds interval);
+  ~BcmPortFastSampler();
+
+  // Throws FbossError if the port is not being sampled
+  PortFastSamples getSamples(opennsl_port_t port) const;
+
+ private:
+  enum SampleField : size_t {
+    TIMESTAMP_USECS,
+    IN_BYTES,
+    OUT_BYTES,
+    IN_DISCARDS,
+    OUT_DISCARDS,
+    OUT_QUEUE_LENGTH,
+    NUM_FIELDS,
+  };
+  using Sample = std::array<int64_t, NUM_FIELDS>;
+
+  /*
+   * A fixed size ring of the most recent samples, written only by the
+   * sampling thread and read by any number of threads without locking.
+   *
+   * Each slot is guarded by a sequence number: odd while the slot is being
+   * written, and 2 * (index + 1) once sample number index is in it.  Readers
+   * skip slots that change while they are copying them.
+   */
+  class SampleRing {
+   public:
+    explicit SampleRing(size_t size) : slots_(size) {}
+    void add(const Sample& sample);
+    std::vector<Sample> snapshot() const;
+
+   private:
+    struct Slot {
+      std::atomic<uint64_t> seq{0};
+      std::array<std::atomic<int64_t>, NUM_FIELDS> values{};
+    };
+    // Number of samples added so far
+    std::atomic<uint64_t> head_{0};
+    std::vector<Slot> slots_;
+  };
+
+  struct PortSamples {
+    PortSamples(PortID id, size_t ringSize) : portId(id), ring(ringSize) {}
+    const PortID portId;
+    SampleRing ring;
+    // Peaks over the last minute, in one second buckets
+    TimeSeriesWithMinMax<int64_t> inBytesPerSec;
+    TimeSeriesWithMinMax<int64_t> outBytesPerSec;
+    TimeSeriesWithMinMax<int64_t> outQueueLength;
+    // Only touched by the sampling thread
+    folly::Optional<Sample> last;
+  };
+
+  // Forbidden copy constructor and assignment operator
+  BcmPortFastSampler(BcmPortFastSampler const&) = delete;
+  BcmPortFastSampler& operator=(BcmPortFastSampler const&) = delete;
+
+  void run();
+  void sampleAll();
+  void samplePort(opennsl_port_t port, PortSamples* samples);
+
+  const int unit_;
+  const std::chrono::milliseconds interval_;
+  // Fixed at construction, so it can be read without locking
+  std::map<opennsl_port_t, std::unique_ptr<PortSamples>> ports_;
+
+  std::mutex stopLock_;
+  std::condition_variable stopCv_;
+  bool stop_{false};
+  std::thread thread_;
+};
+
+}} // facebook::fboss
@@ -12,10 +12,18 @@
 #include "fboss/agent/hw/bcm/BcmPortTable.h"
 #include "fboss/agent/hw/bcm/BcmPort.h"
 #include "fboss/agent/hw/bcm/BcmError.h"
+#include "fboss/agent/hw/bcm/BcmStats.h"
+#include "fboss/agent/hw/bcm/BcmVlanPortUpdate.h"
 
 #include <folly/logging/xlog.h>
 #include "fboss/agent/state/Port.h"
 
+#include <chrono>
+
+using std::chrono::duration_cast;
+using std::chrono::microseconds;
+using std::chrono::steady_clock;
+
 namespace {
 using facebook::fboss::BcmPortGroup;
 using facebook::fboss::cfg::PortSpeed;
@@ -159,45 +167,114 @@ bool BcmPortGroup::validConfiguration(
 }
 
 void BcmPortGroup::reconfigureIfNeeded(
-  const std::shared_ptr<SwitchState>& state) {
+    const std::vector<BcmPortGroup*>& portGroups,
+    const std::shared_ptr<SwitchState>& state) {
   // This logic is a bit messy. We could encode some notion of port
   // groups into the swith state somehow so it is easy to generate
   // deltas for these. For now, we need pass around the SwitchState
   // object and get the relevant ports manually.
-  auto ports = getSwPorts(state);
-  // ports is guaranteed to be the same size as allPorts_
-  auto speedChanged = ports[0]->getSpeed() != portSpeed_;
-  auto desiredLaneMode = calculateDesiredLaneMode(
-    ports, controllingPort_->supportedLaneSpeeds());
-  if (speedChanged) {
-    controllingPort_->getPlatformPort()->linkSpeedChanged(ports[0]->getSpeed());
-  }
-  if (desiredLaneMode != laneMode_) {
-    reconfigureLaneMode(state, desiredLaneMode);
+  struct Reconfiguration {
+    BcmPortGroup* portGroup;
+    LaneMode laneMode;
+    std::chrono::microseconds elapsed{0};
+  };
+  std::vector<Reconfiguration> reconfigurations;
+  for (auto portGroup : portGroups) {
+    auto ports = portGroup->getSwPorts(state);
+    // ports is guaranteed to be the same size as allPorts_
+    auto speed = ports[0]->getSpeed();
+    auto desiredLaneMode = calculateDesiredLaneMode(
+        ports, portGroup->controllingPort_->supportedLaneSpeeds());
+    if (speed != portGroup->portSpeed_) {
+      portGroup->controllingPort_->getPlatformPort()->linkSpeedChanged(speed);
+      portGroup->portSpeed_ = speed;
+    }
+    if (desiredLaneMode != portGroup->laneMode_) {
+      XLOG(DBG1) << "Reconfiguring port "
+                 << portGroup->controllingPort_->getBcmPortId() << " from "
+                 << portGroup->laneMode_ << " active ports to "
+                 << desiredLaneMode << " active ports";
+      reconfigurations.push_back({portGroup, desiredLaneMode});
+    }
   }
-}
 
-void BcmPortGroup::reconfigureLaneMode(
-  const std::shared_ptr<SwitchState>& state,
-  LaneMode newLaneMode
-) {
   // The logic for this follows the steps required for flex-port support
-  // outlined in the sdk documentation.
-  XLOG(DBG1) << "Reconfiguring port " << controllingPort_->getBcmPortId()
-             << " from " << laneMode_ << " active ports to " << newLaneMode
-             << " active ports";
+  // outlined in the sdk documentation. Each step is done for all the port
+  // groups before the next, so none of them waits on another's ports to come
+  // back up before starting.
+  auto timed = [](Reconfiguration& reconfiguration, auto&& fn) {
+    auto start = steady_clock::now();
+    fn(reconfiguration.portGroup);
+    reconfiguration.elapsed +=
+        duration_cast<microseconds>(steady_clock::now() - start);
+  };
+
+  if (reconfigurations.empty()) {
+    return;
+  }
+  // VLAN membership of all the groups' ports is changed together
+  auto unit = reconfigurations.front().portGroup->hw_->getUnit();
+  BcmVlanPortUpdate vlanUpdate;
+
+  // 1. Disable linkscan, then disable ports and take them out of their VLANs.
+  for (auto& reconfiguration : reconfigurations) {
+    timed(reconfiguration, [&](BcmPortGroup* portGroup) {
+      portGroup->disablePorts(state, &vlanUpdate);
+    });
+  }
+  vlanUpdate.apply(unit);
 
-  // 1. Disable linkscan, then disable ports.
+  // 2. Set the opennslPortControlLanes setting
+  for (auto& reconfiguration : reconfigurations) {
+    timed(reconfiguration, [&](BcmPortGroup* portGroup) {
+      portGroup->setActiveLanes(reconfiguration.laneMode);
+      portGroup->laneMode_ = reconfiguration.laneMode;
+    });
+  }
+
+  // 3. Put the enabled ports back in their VLANs, enable linkscan, then
+  // enable ports.
+  for (auto& reconfiguration : reconfigurations) {
+    reconfiguration.portGroup->addEnabledPortsToVlans(state, &vlanUpdate);
+  }
+  vlanUpdate.apply(unit);
+  for (auto& reconfiguration : reconfigurations) {
+    timed(reconfiguration, [&](BcmPortGroup* portGroup) {
+      portGroup->enablePorts(state);
+    });
+  }
+
+  for (const auto& reconfiguration : reconfigurations) {
+    XLOG(DBG1) << "Reconfigured port "
+               << reconfiguration.portGroup->controllingPort_->getBcmPortId()
+               << " in " << reconfiguration.elapsed.count() << "us";
+    BcmStats::get()->portGroupReconfigured(reconfiguration.elapsed);
+  }
+}
+
+void BcmPortGroup::disablePorts(
+    const std::shared_ptr<SwitchState>& state,
+    BcmVlanPortUpdate* vlanUpdate) {
   for (auto& bcmPort : allPorts_) {
     auto swPort = bcmPort->getSwitchStatePort(state);
     bcmPort->disableLinkscan();
+    bcmPort->removeFromVlans(swPort, vlanUpdate);
     bcmPort->disable(swPort);
   }
+}
 
-  // 2. Set the opennslPortControlLanes setting
-  setActiveLanes(newLaneMode);
+void BcmPortGroup::addEnabledPortsToVlans(
+    const std::shared_ptr<SwitchState>& state,
+    BcmVlanPortUpdate* vlanUpdate) {
+  for (auto& bcmPort : allPorts_) {
+    auto swPort = bcmPort->getSwitchStatePort(state);
+    if (swPort->isEnabled()) {
+      bcmPort->addToVlans(swPort, vlanUpdate);
+    }
+  }
+}
 
-  // 3. Enable linkscan, then enable ports.
+void BcmPortGroup::enablePorts(const std::shared_ptr<SwitchState>& state) {
   for (auto& bcmPort : allPorts_) {
     auto swPort = bcmPort->getSwitchStatePort(state);
     if (swPort->isEnabled()) {
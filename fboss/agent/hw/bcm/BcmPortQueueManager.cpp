@@ -99,6 +99,24 @@ BcmPortQueueConfig BcmPortQueueManager::getCurrentQueueSettings() const {
                             std::move(multicastQueues));
 }
 
+void BcmPortQueueManager::programChanged(
+    const PortQueue& oldQueue,
+    const PortQueue& newQueue) {
+  if (oldQueue.getID() != newQueue.getID() ||
+      oldQueue.getStreamType() != newQueue.getStreamType()) {
+    program(newQueue);
+    return;
+  }
+  auto gport = getQueueGPort(newQueue.getStreamType(), newQueue.getID());
+  programChangedCommon(gport, oldQueue, newQueue);
+  if (oldQueue.getScalingFactor() != newQueue.getScalingFactor()) {
+    programAlpha(gport, newQueue.getID(), newQueue);
+  }
+  if (oldQueue.getAqms() != newQueue.getAqms()) {
+    programAqms(gport, newQueue.getID(), newQueue);
+  }
+}
+
 const PortQueue& BcmPortQueueManager::getDefaultQueueSettings(
     cfg::StreamType streamType) const {
   return hw_->getPlatform()->getDefaultPortQueueSettings(streamType);
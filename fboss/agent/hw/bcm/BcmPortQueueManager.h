@@ -33,6 +33,8 @@ public:
   BcmPortQueueConfig getCurrentQueueSettings() const override;
 
   void program(const PortQueue& queue) override;
+  void programChanged(const PortQueue& oldQueue, const PortQueue& newQueue)
+      override;
 
   const std::vector<BcmCosQueueCounterType>&
   getQueueCounterTypes() const override;
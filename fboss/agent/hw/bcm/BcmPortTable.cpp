@@ -9,6 +9,8 @@
  */
 #include "fboss/agent/hw/bcm/BcmPortTable.h"
 
+#include <chrono>
+#include <gflags/gflags.h>
 
 #include "common/stats/MonotonicCounter.h"
 #include "fboss/agent/hw/bcm/BcmError.h"
@@ -16,14 +18,22 @@
 #include "fboss/agent/hw/bcm/BcmPlatformPort.h"
 #include "fboss/agent/hw/bcm/BcmPort.h"
 #include "fboss/agent/hw/bcm/BcmPortGroup.h"
+#include "fboss/agent/hw/bcm/BcmStats.h"
 #include "fboss/agent/hw/bcm/BcmSwitch.h"
 
+#include <folly/Conv.h>
 #include <folly/Memory.h>
+#include <folly/futures/Future.h>
+#include <folly/io/async/ScopedEventBaseThread.h>
 
 extern "C" {
 #include <opennsl/port.h>
 }
 
+DEFINE_int32(bcm_port_stats_threads, 4,
+             "Number of threads to collect per-port hardware stats on. "
+             "0 or 1 collects them serially on the stats update thread");
+
 namespace facebook { namespace fboss {
 
 using std::make_unique;
@@ -32,6 +42,12 @@ using std::make_pair;
 
 BcmPortTable::BcmPortTable(BcmSwitch *hw)
   : hw_(hw) {
+  if (FLAGS_bcm_port_stats_threads > 1) {
+    for (int i = 0; i < FLAGS_bcm_port_stats_threads; ++i) {
+      statsThreads_.push_back(std::make_unique<folly::ScopedEventBaseThread>(
+          folly::to<std::string>("BcmPortStats", i)));
+    }
+  }
 }
 
 BcmPortTable::~BcmPortTable() {
@@ -103,10 +119,39 @@ BcmPort* BcmPortTable::getBcmPortIf(PortID id) const {
 }
 
 void BcmPortTable::updatePortStats() {
- for (const auto& entry : bcmPhysicalPorts_) {
-   BcmPort* bcmPort = entry.second.get();
-   bcmPort->updateStats();
- }
+  auto start = std::chrono::steady_clock::now();
+  if (statsThreads_.empty()) {
+    for (const auto& entry : bcmPhysicalPorts_) {
+      BcmPort* bcmPort = entry.second.get();
+      bcmPort->updateStats();
+    }
+  } else {
+    // Most of the time here goes to SDK calls for one port at a time, so
+    // spread the ports across the stats threads and wait for all of them.
+    // Each BcmPort is only ever updated by one thread in a pass.
+    std::vector<BcmPort*> ports;
+    ports.reserve(bcmPhysicalPorts_.size());
+    for (const auto& entry : bcmPhysicalPorts_) {
+      ports.push_back(entry.second.get());
+    }
+    auto numThreads = statsThreads_.size();
+    std::vector<folly::Future<folly::Unit>> futs;
+    for (size_t i = 0; i < numThreads; ++i) {
+      futs.push_back(folly::via(
+          statsThreads_[i]->getEventBase(), [&ports, i, numThreads] {
+            for (auto idx = i; idx < ports.size(); idx += numThreads) {
+              ports[idx]->updateStats();
+            }
+          }));
+    }
+    for (auto& result : folly::collectAll(futs.begin(), futs.end()).get()) {
+      // Rethrow any error, as the serial update would have
+      result.value();
+    }
+  }
+  BcmStats::get()->portStatsCollected(
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::steady_clock::now() - start));
 }
 
 void BcmPortTable::forFilteredEach(Filter predicate, FilterAction action)
@@ -18,9 +18,15 @@ extern "C" {
 #include "fboss/agent/hw/bcm/BcmPort.h"
 #include "fboss/agent/types.h"
 
+#include <memory>
 #include <mutex>
+#include <vector>
 #include <boost/container/flat_map.hpp>
 
+namespace folly {
+class ScopedEventBaseThread;
+}
+
 namespace facebook { namespace fboss {
 
 class BcmSwitch;
@@ -72,6 +78,9 @@ class BcmPortTable {
 
   /*
    * Update all ports' statistics.
+   *
+   * The ports are spread across --bcm_port_stats_threads threads, and this
+   * returns once all of them have been updated.
    */
   void updatePortStats();
 
@@ -121,6 +130,10 @@ class BcmPortTable {
   // outside of the BcmPort objects. This is mainly here to keep a simple
   // ownership model for the port group objects
   BcmPortGroupList bcmPortGroups_;
+
+  // Threads updatePortStats() collects port stats on.  Empty if it collects
+  // them serially.
+  std::vector<std::unique_ptr<folly::ScopedEventBaseThread>> statsThreads_;
 };
 
 }} // namespace facebook::fboss
@@ -10,29 +10,11 @@
 #include "fboss/agent/hw/bcm/BcmQosPolicy.h"
 
 #include "fboss/agent/hw/bcm/BcmQosMap.h"
-#include "fboss/agent/hw/bcm/BcmSwitch.h"
-#include "fboss/agent/hw/bcm/BcmWarmBootCache.h"
 #include "fboss/agent/state/QosPolicy.h"
 
 namespace facebook {
 namespace fboss {
 
-BcmQosPolicy::BcmQosPolicy(
-    BcmSwitch* hw,
-    const std::shared_ptr<QosPolicy>& qosPolicy) {
-  auto warmBootCache = hw->getWarmBootCache();
-  auto qosMapItr = warmBootCache->findIngressQosMap(qosPolicy->getRules());
-  if (qosMapItr != warmBootCache->ingressQosMaps_end()) {
-    qosMap_ = std::move(*qosMapItr);
-    warmBootCache->programmed(qosMapItr);
-  } else {
-    qosMap_ = std::make_unique<BcmQosMap>(hw);
-    for (const auto& qosRule : qosPolicy->getRules()) {
-      qosMap_->addRule(qosRule);
-    }
-  }
-}
-
 BcmQosPolicyHandle BcmQosPolicy::getHandle() const {
   return static_cast<BcmQosPolicyHandle>(qosMap_->getHandle());
 }
@@ -16,21 +16,33 @@
 namespace facebook {
 namespace fboss {
 
-class BcmSwitch;
 class QosPolicy;
 
+/*
+ * A QoS policy programmed in hardware. The BcmQosMap holding its rules is
+ * owned by the BcmQosPolicyTable, and shared with every other policy that
+ * has the same rules.
+ */
 class BcmQosPolicy {
  public:
-  BcmQosPolicy(BcmSwitch* hw, const std::shared_ptr<QosPolicy>& qosPolicy);
+  explicit BcmQosPolicy(BcmQosMap* qosMap) : qosMap_(qosMap) {}
 
+  /*
+   * Adds and removes the rules that differ between the two policies on the
+   * map in place. Only for a map no other policy uses.
+   */
   void update(
       const std::shared_ptr<QosPolicy>& oldQosPolicy,
       const std::shared_ptr<QosPolicy>& newQosPolicy);
   BcmQosPolicyHandle getHandle() const;
   bool policyMatches(const std::shared_ptr<QosPolicy>& qosPolicy) const;
 
+  void setQosMap(BcmQosMap* qosMap) {
+    qosMap_ = qosMap;
+  }
+
  private:
-  std::unique_ptr<BcmQosMap> qosMap_;
+  BcmQosMap* qosMap_;
 };
 
 } // namespace fboss
@@ -10,7 +10,9 @@
 #include "fboss/agent/hw/bcm/BcmQosPolicyTable.h"
 #include "fboss/agent/FbossError.h"
 #include "fboss/agent/hw/bcm/BcmQosPolicy.h"
+#include "fboss/agent/hw/bcm/BcmQosMap.h"
 #include "fboss/agent/hw/bcm/BcmSwitch.h"
+#include "fboss/agent/hw/bcm/BcmWarmBootCache.h"
 #include "fboss/agent/hw/bcm/types.h"
 #include <folly/logging/xlog.h>
 
@@ -39,19 +41,75 @@ int BcmQosPolicyTable::getNumQosPolicies() const {
   return qosPolicyMap_.size();
 }
 
+int BcmQosPolicyTable::getNumQosMaps() const {
+  return qosMaps_.size();
+}
+
+BcmQosMap* BcmQosPolicyTable::acquireQosMap(
+    const std::set<QosRule>& qosRules) {
+  auto& shared = qosMaps_[qosRules];
+  if (!shared.qosMap) {
+    auto warmBootCache = hw_->getWarmBootCache();
+    auto qosMapItr = warmBootCache->findIngressQosMap(qosRules);
+    if (qosMapItr != warmBootCache->ingressQosMaps_end()) {
+      shared.qosMap = std::move(*qosMapItr);
+      warmBootCache->programmed(qosMapItr);
+    } else {
+      shared.qosMap = std::make_unique<BcmQosMap>(hw_);
+      for (const auto& qosRule : qosRules) {
+        shared.qosMap->addRule(qosRule);
+      }
+    }
+  }
+  ++shared.users;
+  return shared.qosMap.get();
+}
+
+void BcmQosPolicyTable::releaseQosMap(const std::set<QosRule>& qosRules) {
+  auto iter = qosMaps_.find(qosRules);
+  CHECK(iter != qosMaps_.end());
+  if (--iter->second.users == 0) {
+    qosMaps_.erase(iter);
+  }
+}
+
 void BcmQosPolicyTable::processAddedQosPolicy(
     const std::shared_ptr<QosPolicy>& qosPolicy) {
   if (qosPolicyMap_.find(qosPolicy->getName()) != qosPolicyMap_.end()) {
     throw FbossError("BcmQosPolicy=", qosPolicy->getName(), " already exists");
   }
   qosPolicyMap_.emplace(
-      qosPolicy->getName(), std::make_unique<BcmQosPolicy>(hw_, qosPolicy));
+      qosPolicy->getName(),
+      std::make_unique<BcmQosPolicy>(acquireQosMap(qosPolicy->getRules())));
 }
 
-void BcmQosPolicyTable::processChangedQosPolicy(
+bool BcmQosPolicyTable::processChangedQosPolicy(
     const std::shared_ptr<QosPolicy>& oldQosPolicy,
     const std::shared_ptr<QosPolicy>& newQosPolicy) {
-  getQosPolicy(newQosPolicy->getName())->update(oldQosPolicy, newQosPolicy);
+  auto bcmQosPolicy = getQosPolicy(newQosPolicy->getName());
+  const auto& oldRules = oldQosPolicy->getRules();
+  const auto& newRules = newQosPolicy->getRules();
+  if (oldRules == newRules) {
+    return false;
+  }
+
+  auto current = qosMaps_.find(oldRules);
+  CHECK(current != qosMaps_.end());
+  if (current->second.users == 1 &&
+      qosMaps_.find(newRules) == qosMaps_.end()) {
+    // Nobody else uses the map, so only the rules that differ are
+    // reprogrammed and the handle stays the same
+    auto shared = std::move(current->second);
+    qosMaps_.erase(current);
+    bcmQosPolicy->update(oldQosPolicy, newQosPolicy);
+    qosMaps_.emplace(newRules, std::move(shared));
+    return false;
+  }
+  // Either another policy still uses the old rules, or one already has the
+  // new ones and we can share its map
+  bcmQosPolicy->setQosMap(acquireQosMap(newRules));
+  releaseQosMap(oldRules);
+  return true;
 }
 
 void BcmQosPolicyTable::processRemovedQosPolicy(
@@ -61,6 +119,7 @@ void BcmQosPolicyTable::processRemovedQosPolicy(
     throw FbossError("BcmQosPolicy=", qosPolicy->getName(), " does not exist");
   }
   qosPolicyMap_.erase(iter);
+  releaseQosMap(qosPolicy->getRules());
 }
 
 /*
@@ -14,6 +14,9 @@
 
 #include <boost/container/flat_map.hpp>
 
+#include <map>
+#include <set>
+
 namespace facebook {
 namespace fboss {
 
@@ -24,12 +27,18 @@ class BcmQosPolicyTable {
   explicit BcmQosPolicyTable(BcmSwitch* hw) : hw_(hw) {}
 
   void processAddedQosPolicy(const std::shared_ptr<QosPolicy>& qosPolicy);
-  void processChangedQosPolicy(
+  /*
+   * Returns whether the policy's handle changed, in which case the ports
+   * using it have to be attached to it again.
+   */
+  bool processChangedQosPolicy(
       const std::shared_ptr<QosPolicy>& oldQosPolicy,
       const std::shared_ptr<QosPolicy>& newQosPolicy);
   void processRemovedQosPolicy(const std::shared_ptr<QosPolicy>& qosPolicy);
 
   int getNumQosPolicies() const;
+  // Hardware maps programmed, one per distinct set of rules
+  int getNumQosMaps() const;
   // Throw exception if not found
   BcmQosPolicy* getQosPolicy(const std::string& name) const;
   // return nullptr if not found
@@ -41,7 +50,21 @@ class BcmQosPolicyTable {
   using BcmQosPolicyMap =
       boost::container::flat_map<std::string, std::unique_ptr<BcmQosPolicy>>;
 
+  /*
+   * Policies with the same rules share one hardware map, which is destroyed
+   * once the last of them goes away.
+   */
+  struct SharedQosMap {
+    std::unique_ptr<BcmQosMap> qosMap;
+    int users{0};
+  };
+
+  BcmQosMap* acquireQosMap(const std::set<QosRule>& qosRules);
+  void releaseQosMap(const std::set<QosRule>& qosRules);
+
   BcmSwitch* hw_;
+  // Declared ahead of the policies, which point into it
+  std::map<std::set<QosRule>, SharedQosMap> qosMaps_;
   BcmQosPolicyMap qosPolicyMap_;
 };
 
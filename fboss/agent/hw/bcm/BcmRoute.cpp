@@ -23,12 +23,17 @@ extern "C" {
 #include "fboss/agent/hw/bcm/BcmIntf.h"
 #include "fboss/agent/hw/bcm/BcmMultiPathNextHop.h"
 #include "fboss/agent/hw/bcm/BcmPlatform.h"
+#include "fboss/agent/hw/bcm/BcmSdkTracer.h"
 #include "fboss/agent/hw/bcm/BcmSwitch.h"
 #include "fboss/agent/hw/bcm/BcmWarmBootCache.h"
 #include "fboss/agent/if/gen-cpp2/ctrl_types.h"
 
 #include "fboss/agent/state/RouteTypes.h"
 
+#include <algorithm>
+
+DECLARE_bool(recursive_next_hops);
+
 namespace facebook { namespace fboss {
 
 namespace {
@@ -41,6 +46,33 @@ auto constexpr kRoutes = "routes";
 
 // TODO: Assumes we have only one VRF
 auto constexpr kDefaultVrf = 0;
+
+// The forwarding info a route is programmed with in HW
+template <typename RouteT>
+RouteNextHopEntry hwForwardInfo(const RouteT* route) {
+  RouteNextHopEntry fwd(route->getForwardInfo());
+  if (fwd.getAction() == RouteForwardAction::NEXTHOPS) {
+    fwd = RouteNextHopEntry(fwd.normalizedNextHops(), fwd.getAdminDistance());
+  }
+  return fwd;
+}
+
+// The unresolved next hops of a route resolved through other routes, which
+// it forwards through with --recursive_next_hops, empty otherwise. Routes of
+// the standalone RIB's FIBs only carry their resolved next hops.
+template <typename RouteT>
+RouteNextHopSet hwRecursiveNextHops(const RouteT* route) {
+  if (!FLAGS_recursive_next_hops || route->hasNoEntry() ||
+      route->getForwardInfo().getAction() != RouteForwardAction::NEXTHOPS) {
+    return RouteNextHopSet();
+  }
+  const auto& nhops = route->getBestEntry().second->getNextHopSet();
+  auto recursive =
+      std::any_of(nhops.begin(), nhops.end(), [](const NextHop& nhop) {
+        return !nhop.intfID().hasValue();
+      });
+  return recursive ? nhops : RouteNextHopSet();
+}
 }
 
 BcmRoute::BcmRoute(
@@ -84,13 +116,17 @@ bool BcmRoute::canUseHostTable() const {
   return isHostRoute() && hw_->getPlatform()->canUseHostTableForHostRoutes();
 }
 
-void BcmRoute::program(const RouteNextHopEntry& fwd) {
+void BcmRoute::program(
+    const RouteNextHopEntry& fwd,
+    const RouteNextHopSet& recursive) {
   // if the route has been programmed to the HW, check if the forward info is
   // changed or not. If not, nothing to do.
-  if (added_ && fwd == fwd_) {
+  if (added_ && fwd == fwd_ && recursive == recursive_) {
     return;
   }
   std::shared_ptr<BcmMultiPathNextHop> nexthopReference;
+  std::shared_ptr<BcmRecursiveNextHop> recursiveReference;
+  bool multipath = false;
 
   auto action = fwd.getAction();
   // find out the egress object ID
@@ -103,11 +139,39 @@ void BcmRoute::program(const RouteNextHopEntry& fwd) {
     CHECK(action == RouteForwardAction::NEXTHOPS);
     const auto& nhops = fwd.getNextHopSet();
     CHECK_GT(nhops.size(), 0);
-    // need to get an entry from the host table for the forward info
-    nexthopReference =
-        hw_->writableMultiPathNextHopTable()->referenceOrEmplaceNextHop(
-            BcmMultiPathNextHopKey(vrf_, fwd.getNextHopSet()));
-    egressId = nexthopReference->getEgressId();
+    auto table = hw_->writableMultiPathNextHopTable();
+    if (!recursive.empty()) {
+      recursiveReference = table->referenceOrEmplaceRecursiveNextHop(
+          BcmRecursiveNextHopKey(vrf_, recursive), nhops);
+    }
+    if (recursiveReference) {
+      egressId = recursiveReference->getEgressId();
+      multipath = true;
+    } else {
+      // need to get an entry from the host table for the forward info
+      nexthopReference = table->referenceOrEmplaceNextHop(
+          BcmMultiPathNextHopKey(vrf_, nhops));
+      egressId = nexthopReference->getEgressId();
+      // Not the same as having several next hops, as routes may be spilled
+      // onto a single path for lack of ECMP groups
+      multipath = nexthopReference->getEgress() != nullptr;
+    }
+  }
+
+  if (added_ && egressId == egressId_ && multipath == multipath_ &&
+      action == RouteForwardAction::NEXTHOPS &&
+      fwd_.getAction() == RouteForwardAction::NEXTHOPS) {
+    // The next hops changed but still resolve to the egress this route
+    // points to, e.g., because its ECMP group or recursive next hop was
+    // updated in place. There is nothing to reprogram, just move our
+    // reference to the new next hops.
+    XLOG(DBG3) << "route " << prefix_ << "/" << static_cast<int>(len_)
+               << " keeps egress " << egressId << " for " << fwd;
+    nextHopHostReference_ = std::move(nexthopReference);
+    recursiveNextHop_ = std::move(recursiveReference);
+    fwd_ = fwd;
+    recursive_ = recursive;
+    return;
   }
 
   // At this point host and egress objects for next hops have been
@@ -127,7 +191,7 @@ void BcmRoute::program(const RouteNextHopEntry& fwd) {
       hostRouteEntry_.reset();
     }
     hostRouteEntry_ =
-        programHostRoute(egressId, fwd, entryExistsInRouteTable);
+        programHostRoute(egressId, fwd, multipath, entryExistsInRouteTable);
     if (entryExistsInRouteTable) {
       // If the entry already exists in the route table, programHostRoute()
       // removes it as well.
@@ -135,11 +199,14 @@ void BcmRoute::program(const RouteNextHopEntry& fwd) {
       warmBootCache->programmed(vrfAndIP2RouteCitr);
     }
   } else {
-    programLpmRoute(egressId, fwd);
+    programLpmRoute(egressId, fwd, multipath);
   }
   nextHopHostReference_ = std::move(nexthopReference);
+  recursiveNextHop_ = std::move(recursiveReference);
   egressId_ = egressId;
+  multipath_ = multipath;
   fwd_ = fwd;
+  recursive_ = recursive;
 
   // new nexthop has been stored in fwd_. From now on, it is up to
   // ~BcmRoute() to clean up such nexthop.
@@ -149,22 +216,23 @@ void BcmRoute::program(const RouteNextHopEntry& fwd) {
 std::shared_ptr<BcmHost> BcmRoute::programHostRoute(
     opennsl_if_t egressId,
     const RouteNextHopEntry& fwd,
+    bool multipath,
     bool replace) {
   XLOG(DBG3) << "creating a host route entry for " << prefix_.str()
              << " @egress " << egressId << " with " << fwd;
   auto prefixHost =
       hw_->writableHostTable()->refOrEmplace(BcmHostKey(vrf_, prefix_));
   prefixHost->setEgressId(egressId);
-  prefixHost->addToBcmHostTable(fwd.getNextHopSet().size() > 1, replace);
+  prefixHost->addToBcmHostTable(multipath, replace);
   return prefixHost;
 }
 
 void BcmRoute::programLpmRoute(opennsl_if_t egressId,
-    const RouteNextHopEntry& fwd) {
+    const RouteNextHopEntry& fwd, bool multipath) {
   opennsl_l3_route_t rt;
   initL3RouteT(&rt);
   rt.l3a_intf = egressId;
-  if (fwd.getNextHopSet().size() > 1) {         // multipath
+  if (multipath) {
     rt.l3a_flags |= OPENNSL_L3_MULTIPATH;
   } else if (fwd.getAction() == RouteForwardAction::DROP) {
     rt.l3a_flags |= OPENNSL_L3_DST_DISCARD;
@@ -205,7 +273,7 @@ void BcmRoute::programLpmRoute(opennsl_if_t egressId,
     if (added_) {
       rt.l3a_flags |= OPENNSL_L3_REPLACE;
     }
-    auto rc = opennsl_l3_route_add(hw_->getUnit(), &rt);
+    auto rc = BCM_SDK_TRACE(opennsl_l3_route_add, hw_->getUnit(), &rt);
     bcmCheckError(rc, "failed to create a route entry for ", prefix_, "/",
         static_cast<int>(len_), " @ ", fwd, " @egress ", egressId);
     XLOG(DBG3) << "created a route entry for " << prefix_.str() << "/"
@@ -223,7 +291,7 @@ bool BcmRoute::deleteLpmRoute(int unitNumber,
                               uint8_t prefixLength) {
   opennsl_l3_route_t rt;
   initL3RouteFromArgs(&rt, vrf, prefix, prefixLength);
-  auto rc = opennsl_l3_route_delete(unitNumber, &rt);
+  auto rc = BCM_SDK_TRACE(opennsl_l3_route_delete, unitNumber, &rt);
   if (OPENNSL_FAILURE(rc)) {
     XLOG(ERR) << "Failed to delete a route entry for " << prefix << "/"
               << static_cast<int>(prefixLength)
@@ -305,11 +373,7 @@ void BcmRouteTable::addRoute(opennsl_vrf_t vrf, const RouteT *route) {
                                         prefix.mask));
   }
   CHECK(route->isResolved());
-  RouteNextHopEntry fwd(route->getForwardInfo());
-  if (fwd.getAction() == RouteForwardAction::NEXTHOPS) {
-    fwd = RouteNextHopEntry(fwd.normalizedNextHops(), fwd.getAdminDistance());
-  }
-  ret.first->second->program(fwd);
+  ret.first->second->program(hwForwardInfo(route), hwRecursiveNextHops(route));
 }
 
 template<typename RouteT>
@@ -323,6 +387,120 @@ void BcmRouteTable::deleteRoute(opennsl_vrf_t vrf, const RouteT *route) {
   fib_.erase(iter);
 }
 
+BcmEcmpGroupUpdater::BcmEcmpGroupUpdater(BcmSwitch* hw) : hw_(hw) {}
+
+template <typename RouteT>
+void BcmEcmpGroupUpdater::routeAdded(
+    opennsl_vrf_t vrf,
+    const RouteT* newRoute) {
+  if (!newRoute->isResolved() ||
+      recursiveRouteChanged(vrf, newRoute, true /* added */)) {
+    return;
+  }
+  auto fwd = hwForwardInfo(newRoute);
+  if (fwd.getAction() == RouteForwardAction::NEXTHOPS) {
+    referencedKeys_.insert(
+        BcmMultiPathNextHopKey(vrf, fwd.getNextHopSet()));
+  }
+}
+
+template <typename RouteT>
+void BcmEcmpGroupUpdater::routeChanged(
+    opennsl_vrf_t vrf,
+    const RouteT* newRoute) {
+  // Routes which stop using their group are not counted below, which
+  // keeps their group from being updated in place.
+  if (!newRoute->isResolved() ||
+      recursiveRouteChanged(vrf, newRoute, false /* added */)) {
+    return;
+  }
+  auto fwd = hwForwardInfo(newRoute);
+  if (fwd.getAction() != RouteForwardAction::NEXTHOPS) {
+    return;
+  }
+  BcmMultiPathNextHopKey key(vrf, fwd.getNextHopSet());
+  referencedKeys_.insert(key);
+
+  const auto& prefix = newRoute->prefix();
+  auto bcmRoute = hw_->routeTable()->getBcmRouteIf(
+      vrf, folly::IPAddress(prefix.network), prefix.mask);
+  if (!bcmRoute || !bcmRoute->getNextHop() ||
+      !bcmRoute->getNextHop()->getEgress()) {
+    return;
+  }
+  auto& update = updates_[bcmRoute->getNextHop().get()];
+  if (update.routes == 0) {
+    update.key = std::move(key);
+  } else if (update.key != key) {
+    // Users of this group are moving to different next hops
+    update.diverged = true;
+  }
+  ++update.routes;
+}
+
+template <typename RouteT>
+bool BcmEcmpGroupUpdater::recursiveRouteChanged(
+    opennsl_vrf_t vrf,
+    const RouteT* newRoute,
+    bool added) {
+  auto recursive = hwRecursiveNextHops(newRoute);
+  if (recursive.empty()) {
+    return false;
+  }
+  auto fwd = hwForwardInfo(newRoute);
+  const auto& resolved = fwd.getNextHopSet();
+  // In case the route falls back to the resolved next hops
+  referencedKeys_.insert(BcmMultiPathNextHopKey(vrf, resolved));
+
+  BcmRecursiveNextHopKey key(vrf, std::move(recursive));
+  auto iter = recursiveUpdates_.find(key);
+  if (iter == recursiveUpdates_.end()) {
+    iter = recursiveUpdates_.emplace(key, RecursiveUpdate()).first;
+    iter->second.resolved = resolved;
+  } else if (iter->second.resolved != resolved) {
+    iter->second.diverged = true;
+  }
+  if (!added) {
+    const auto& prefix = newRoute->prefix();
+    auto bcmRoute = hw_->routeTable()->getBcmRouteIf(
+        vrf, folly::IPAddress(prefix.network), prefix.mask);
+    if (bcmRoute && bcmRoute->getRecursiveNextHop() &&
+        bcmRoute->getRecursiveNextHop()->getKey() == key) {
+      ++iter->second.routes;
+    }
+  }
+  return true;
+}
+
+void BcmEcmpGroupUpdater::updateHwLocked() {
+  auto table = hw_->writableMultiPathNextHopTable();
+  for (const auto& groupAndUpdate : updates_) {
+    auto group = groupAndUpdate.first;
+    const auto& update = groupAndUpdate.second;
+    auto oldKey = group->getKey();
+    if (update.diverged || referencedKeys_.count(oldKey) ||
+        table->getNextHopIf(update.key) ||
+        table->getNextHops().referenceCount(oldKey) != update.routes) {
+      continue;
+    }
+    updated_.push_back(table->updateNextHopsInPlaceHwLocked(group, update.key));
+  }
+  updates_.clear();
+
+  for (const auto& keyAndUpdate : recursiveUpdates_) {
+    const auto& update = keyAndUpdate.second;
+    if (!update.diverged) {
+      table->updateRecursiveNextHopHwLocked(
+          keyAndUpdate.first, update.resolved, update.routes);
+    }
+  }
+  recursiveUpdates_.clear();
+}
+
+template void BcmEcmpGroupUpdater::routeAdded(opennsl_vrf_t, const RouteV4*);
+template void BcmEcmpGroupUpdater::routeAdded(opennsl_vrf_t, const RouteV6*);
+template void BcmEcmpGroupUpdater::routeChanged(opennsl_vrf_t, const RouteV4*);
+template void BcmEcmpGroupUpdater::routeChanged(opennsl_vrf_t, const RouteV6*);
 template void BcmRouteTable::addRoute(opennsl_vrf_t, const RouteV4 *);
 template void BcmRouteTable::addRoute(opennsl_vrf_t, const RouteV6 *);
 template void BcmRouteTable::deleteRoute(opennsl_vrf_t, const RouteV4 *);
@@ -17,16 +17,20 @@ extern "C" {
 #include <folly/dynamic.h>
 #include <folly/IPAddress.h>
 #include "fboss/agent/types.h"
+#include "fboss/agent/hw/bcm/BcmMultiPathNextHop.h"
 #include "fboss/agent/state/Route.h"
 #include "fboss/agent/state/RouteNextHopEntry.h"
 
 #include <boost/container/flat_map.hpp>
 
+#include <map>
+#include <set>
+#include <vector>
+
 namespace facebook { namespace fboss {
 
 class BcmSwitch;
 class BcmHost;
-class BcmMultiPathNextHop;
 
 /**
  * BcmRoute represents a L3 route object.
@@ -39,7 +43,14 @@ class BcmRoute {
       const folly::IPAddress& addr,
       uint8_t len);
   ~BcmRoute();
-  void program(const RouteNextHopEntry& fwd);
+  /*
+   * recursive holds the unresolved next hops of a route resolved through
+   * other routes, to forward through their BcmRecursiveNextHop; empty
+   * otherwise.
+   */
+  void program(
+      const RouteNextHopEntry& fwd,
+      const RouteNextHopSet& recursive = RouteNextHopSet());
   static bool deleteLpmRoute(int unit,
                              opennsl_vrf_t vrf,
                              const folly::IPAddress& prefix,
@@ -57,13 +68,20 @@ class BcmRoute {
   std::shared_ptr<BcmMultiPathNextHop> getNextHop() const {
     return nextHopHostReference_;
   }
+  const std::shared_ptr<BcmRecursiveNextHop>& getRecursiveNextHop() const {
+    return recursiveNextHop_;
+  }
 
  private:
   std::shared_ptr<BcmHost> programHostRoute(
       opennsl_if_t egressId,
       const RouteNextHopEntry& fwd,
+      bool multipath,
       bool replace);
-  void programLpmRoute(opennsl_if_t egressId, const RouteNextHopEntry& fwd);
+  void programLpmRoute(
+      opennsl_if_t egressId,
+      const RouteNextHopEntry& fwd,
+      bool multipath);
   /*
    * Check whether we can use the host route table. BCM platforms
    * support this from TD2 onwards
@@ -79,11 +97,14 @@ class BcmRoute {
   uint8_t len_;
   RouteNextHopEntry fwd_{RouteNextHopEntry::Action::DROP,
                          AdminDistance::MAX_ADMIN_DISTANCE};
+  RouteNextHopSet recursive_;
   bool added_{false}; // if the route added to HW or not
   opennsl_if_t egressId_{-1};
+  bool multipath_{false}; // if egressId_ is an ECMP egress
   void initL3RouteT(opennsl_l3_route_t* rt) const;
   std::shared_ptr<BcmMultiPathNextHop>
       nextHopHostReference_; // reference to nexthops
+  std::shared_ptr<BcmRecursiveNextHop> recursiveNextHop_;
   std::shared_ptr<BcmHost> hostRouteEntry_; // for host routes
 };
 
@@ -119,4 +140,57 @@ class BcmRouteTable {
   boost::container::flat_map<Key, std::unique_ptr<BcmRoute>> fib_;
 };
 
+/**
+ * BcmEcmpGroupUpdater looks at the added and changed routes of a state
+ * update before any of them is programmed. When every route using an ECMP
+ * group moves to the same new next hop set, e.g., because one member of the
+ * set went away, the group's members are updated in place. Its ECMP egress
+ * id stays the same, so none of those routes need to be reprogrammed.
+ * Recursive next hops are updated in place the same way when all routes over
+ * them resolve to the same new next hops.
+ *
+ * Groups updated in place are held until the updater is destroyed, which
+ * should happen only after the routes have been programmed and reference
+ * them.
+ */
+class BcmEcmpGroupUpdater {
+ public:
+  explicit BcmEcmpGroupUpdater(BcmSwitch* hw);
+
+  template <typename RouteT>
+  void routeAdded(opennsl_vrf_t vrf, const RouteT* newRoute);
+  template <typename RouteT>
+  void routeChanged(opennsl_vrf_t vrf, const RouteT* newRoute);
+
+  void updateHwLocked();
+
+ private:
+  struct Update {
+    BcmMultiPathNextHopKey key;
+    long routes{0};
+    bool diverged{false};
+  };
+  struct RecursiveUpdate {
+    RouteNextHopSet resolved;
+    // Routes currently using the recursive next hop
+    long routes{0};
+    bool diverged{false};
+  };
+  template <typename RouteT>
+  bool recursiveRouteChanged(
+      opennsl_vrf_t vrf,
+      const RouteT* newRoute,
+      bool added);
+  // no copy or assign
+  BcmEcmpGroupUpdater(const BcmEcmpGroupUpdater&) = delete;
+  BcmEcmpGroupUpdater& operator=(const BcmEcmpGroupUpdater&) = delete;
+
+  BcmSwitch* hw_;
+  std::map<BcmMultiPathNextHop*, Update> updates_;
+  std::map<BcmRecursiveNextHopKey, RecursiveUpdate> recursiveUpdates_;
+  // next hops which routes of this update will reference
+  std::set<BcmMultiPathNextHopKey> referencedKeys_;
+  std::vector<std::shared_ptr<BcmMultiPathNextHop>> updated_;
+};
+
 }}
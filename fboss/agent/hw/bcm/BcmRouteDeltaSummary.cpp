@@ -0,0 +1,165 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/hw/bcm/BcmRouteDeltaSummary.h"
+
+#include "fboss/agent/state/ForwardingInformationBase.h"
+#include "fboss/agent/state/ForwardingInformationBaseContainer.h"
+#include "fboss/agent/state/ForwardingInformationBaseDelta.h"
+#include "fboss/agent/state/ForwardingInformationBaseMap.h"
+#include "fboss/agent/state/NodeMapDelta-defs.h"
+#include "fboss/agent/state/NodeMapDelta.h"
+#include "fboss/agent/state/RouteDelta.h"
+#include "fboss/agent/state/RouteTable.h"
+#include "fboss/agent/state/RouteTableMap.h"
+#include "fboss/agent/state/RouteTableRib.h"
+#include "fboss/agent/state/StateDelta.h"
+#include "fboss/agent/state/SwitchState.h"
+
+#include <algorithm>
+#include <tuple>
+
+namespace facebook { namespace fboss {
+
+namespace {
+
+template <typename RouteT>
+bool isLabeledRouteValid(const RouteT& route, uint32_t maxLabelStackDepth) {
+  for (const auto& nhop : route.getForwardInfo().getNextHopSet()) {
+    if (!nhop.labelForwardingAction()) {
+      continue;
+    }
+    if (nhop.labelForwardingAction()->type() !=
+        LabelForwardingAction::LabelForwardingType::PUSH) {
+      return false;
+    }
+    if (nhop.labelForwardingAction()->pushStack()->size() >
+        maxLabelStackDepth) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/*
+ * With ALPM, routes are placed in buckets under pivot prefixes, and a bucket
+ * that fills up is split.  Programming a large delta in container order keeps
+ * inserting prefixes below pivots that have not been created yet, causing
+ * repeated splits and moves, so for ALPM the shorter prefixes go first, and
+ * prefixes of the same length that share leading bits (and so likely a
+ * pivot) are kept together.
+ */
+template <typename RoutePtr>
+void sortForAlpm(std::vector<std::pair<RoutePtr, RoutePtr>>* routes) {
+  std::stable_sort(
+      routes->begin(),
+      routes->end(),
+      [](const std::pair<RoutePtr, RoutePtr>& a,
+         const std::pair<RoutePtr, RoutePtr>& b) {
+        const auto& pa = a.second->prefix();
+        const auto& pb = b.second->prefix();
+        return std::tie(pa.mask, pa.network) < std::tie(pb.mask, pb.network);
+      });
+}
+
+} // namespace
+
+BcmRouteDeltaSummary::BcmRouteDeltaSummary(
+    const StateDelta& delta,
+    uint32_t maxLabelStackDepth,
+    bool alpmOrder)
+    : maxLabelStackDepth_(maxLabelStackDepth), alpmOrder_(alpmOrder) {
+  for (const auto& rtDelta : delta.getRouteTablesDelta()) {
+    auto table = rtDelta.getNew() ? rtDelta.getNew() : rtDelta.getOld();
+    auto vrf = table->getID();
+    collect(vrf, rtDelta.getRoutesV4Delta(), true, &routeTablesV4_);
+    collect(vrf, rtDelta.getRoutesV6Delta(), true, &routeTablesV6_);
+  }
+  for (const auto& fibDelta : delta.getFibsDelta()) {
+    auto fib = fibDelta.getNew() ? fibDelta.getNew() : fibDelta.getOld();
+    auto vrf = fib->getID();
+    collect(vrf, fibDelta.getV4FibDelta(), false, &fibsV4_);
+    collect(vrf, fibDelta.getV6FibDelta(), false, &fibsV6_);
+  }
+}
+
+uint64_t BcmRouteDeltaSummary::numFibChanges() const {
+  uint64_t changes = 0;
+  for (const auto& vrfChanges : fibsV4_) {
+    changes += vrfChanges.removed.size() + vrfChanges.addedChanged.size();
+  }
+  for (const auto& vrfChanges : fibsV6_) {
+    changes += vrfChanges.removed.size() + vrfChanges.addedChanged.size();
+  }
+  return changes;
+}
+
+void BcmRouteDeltaSummary::compressFibs(
+    FibCompressors<folly::IPAddressV4>* v4,
+    FibCompressors<folly::IPAddressV6>* v6) {
+  compress(&fibsV4_, v4);
+  compress(&fibsV6_, v6);
+}
+
+template <typename AddrT>
+void BcmRouteDeltaSummary::compress(
+    Changes<AddrT>* changes,
+    FibCompressors<AddrT>* compressors) {
+  for (auto& vrfChanges : *changes) {
+    auto& compressor = (*compressors)[vrfChanges.vrf];
+    if (!compressor) {
+      compressor = std::make_unique<rib::FibCompressor<AddrT>>();
+    }
+    for (const auto& route : vrfChanges.removed) {
+      compressor->update(route, nullptr);
+    }
+    for (const auto& route : vrfChanges.addedChanged) {
+      compressor->update(route.first, route.second);
+    }
+    auto compressed = compressor->flush();
+    numChanges_ -= vrfChanges.removed.size() + vrfChanges.addedChanged.size();
+    numChanges_ += compressed.removed.size() + compressed.addedChanged.size();
+    vrfChanges.removed = std::move(compressed.removed);
+    vrfChanges.addedChanged = std::move(compressed.addedChanged);
+    if (alpmOrder_) {
+      sortForAlpm(&vrfChanges.addedChanged);
+    }
+  }
+}
+
+template <typename AddrT, typename RoutesDeltaT>
+void BcmRouteDeltaSummary::collect(
+    RouterID vrf,
+    const RoutesDeltaT& routesDelta,
+    bool validate,
+    Changes<AddrT>* changes) {
+  VrfChanges<AddrT> vrfChanges(vrf);
+  for (const auto& entry : routesDelta) {
+    ++numChanges_;
+    const auto& newRoute = entry.getNew();
+    if (!newRoute) {
+      vrfChanges.removed.push_back(entry.getOld());
+      continue;
+    }
+    if (validate && valid_ &&
+        !isLabeledRouteValid(*newRoute, maxLabelStackDepth_)) {
+      valid_ = false;
+    }
+    vrfChanges.addedChanged.emplace_back(entry.getOld(), newRoute);
+  }
+  if (vrfChanges.removed.empty() && vrfChanges.addedChanged.empty()) {
+    return;
+  }
+  if (alpmOrder_) {
+    sortForAlpm(&vrfChanges.addedChanged);
+  }
+  changes->push_back(std::move(vrfChanges));
+}
+
+}} // facebook::fboss
@@ -0,0 +1,138 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include "fboss/agent/rib/FibCompressor.h"
+#include "fboss/agent/state/Route.h"
+#include "fboss/agent/types.h"
+
+#include <folly/IPAddressV4.h>
+#include <folly/IPAddressV6.h>
+
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace facebook { namespace fboss {
+
+class StateDelta;
+
+/*
+ * The route changes of a StateDelta, collected in a single walk over its
+ * route table and FIB deltas, along with whether they can be programmed.
+ *
+ * BcmSwitch used to walk the route deltas once to count them, once more for
+ * each address family to validate them, then again to remove, to collect
+ * ECMP group updates and to program. It now builds one of these per update
+ * and does all of that from the lists here.
+ */
+class BcmRouteDeltaSummary {
+ public:
+  template <typename AddrT>
+  struct VrfChanges {
+    using RoutePtr = std::shared_ptr<Route<AddrT>>;
+
+    explicit VrfChanges(RouterID vrf) : vrf(vrf) {}
+
+    RouterID vrf;
+    std::vector<RoutePtr> removed;
+    // (old, new) pairs, old being null for added routes, in programming order
+    std::vector<std::pair<RoutePtr, RoutePtr>> addedChanged;
+  };
+  template <typename AddrT>
+  using Changes = std::vector<VrfChanges<AddrT>>;
+  template <typename AddrT>
+  using FibCompressors =
+      std::map<RouterID, std::unique_ptr<rib::FibCompressor<AddrT>>>;
+
+  /*
+   * maxLabelStackDepth is the deepest label stack a route may push. With
+   * alpmOrder, the added and changed routes are ordered for ALPM, see
+   * sortForAlpm().
+   */
+  BcmRouteDeltaSummary(
+      const StateDelta& delta,
+      uint32_t maxLabelStackDepth,
+      bool alpmOrder);
+
+  // Routes added, changed or removed across all tables and FIBs
+  uint64_t numChanges() const {
+    return numChanges_;
+  }
+  // Routes added, changed or removed across the FIBs
+  uint64_t numFibChanges() const;
+
+  /*
+   * Replace the FIB changes with the changes they make to the compressed
+   * FIBs kept in v4 and v6, by VRF, so that the compressed FIBs are what
+   * gets programmed. See rib::FibCompressor.
+   */
+  void compressFibs(
+      FibCompressors<folly::IPAddressV4>* v4,
+      FibCompressors<folly::IPAddressV6>* v6);
+
+  /*
+   * Whether every added or changed route table route can be programmed:
+   * labeled next hops may only push, and no deeper than maxLabelStackDepth.
+   */
+  bool isValid() const {
+    return valid_;
+  }
+
+  // Changes to the route tables, with the RouteTableRib
+  template <typename AddrT>
+  const Changes<AddrT>& routeTables() const;
+  // Changes to the FIBs, with the standalone RIB
+  template <typename AddrT>
+  const Changes<AddrT>& fibs() const;
+
+ private:
+  template <typename AddrT, typename RoutesDeltaT>
+  void collect(
+      RouterID vrf,
+      const RoutesDeltaT& routesDelta,
+      bool validate,
+      Changes<AddrT>* changes);
+  template <typename AddrT>
+  void compress(Changes<AddrT>* changes, FibCompressors<AddrT>* compressors);
+
+  uint32_t maxLabelStackDepth_;
+  bool alpmOrder_;
+  uint64_t numChanges_{0};
+  bool valid_{true};
+  Changes<folly::IPAddressV4> routeTablesV4_;
+  Changes<folly::IPAddressV6> routeTablesV6_;
+  Changes<folly::IPAddressV4> fibsV4_;
+  Changes<folly::IPAddressV6> fibsV6_;
+};
+
+template <>
+inline const BcmRouteDeltaSummary::Changes<folly::IPAddressV4>&
+BcmRouteDeltaSummary::routeTables<folly::IPAddressV4>() const {
+  return routeTablesV4_;
+}
+template <>
+inline const BcmRouteDeltaSummary::Changes<folly::IPAddressV6>&
+BcmRouteDeltaSummary::routeTables<folly::IPAddressV6>() const {
+  return routeTablesV6_;
+}
+template <>
+inline const BcmRouteDeltaSummary::Changes<folly::IPAddressV4>&
+BcmRouteDeltaSummary::fibs<folly::IPAddressV4>() const {
+  return fibsV4_;
+}
+template <>
+inline const BcmRouteDeltaSummary::Changes<folly::IPAddressV6>&
+BcmRouteDeltaSummary::fibs<folly::IPAddressV6>() const {
+  return fibsV6_;
+}
+
+}} // facebook::fboss
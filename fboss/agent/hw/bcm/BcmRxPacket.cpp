@@ -8,11 +8,29 @@
  *
  */
 #include "fboss/agent/hw/bcm/BcmRxPacket.h"
+
+#include "fboss/agent/hw/bcm/BcmControlPlane.h"
+#include "fboss/lib/HugePageMemory.h"
+
+#include <folly/MPMCQueue.h>
+#include <folly/logging/xlog.h>
+#include <gflags/gflags.h>
+
 extern "C" {
 #include <opennsl/rx.h>
 }
 
+DEFINE_bool(
+    bcm_rx_packet_hugepages,
+    false,
+    "Allocate received packets from huge page backed memory");
+DEFINE_int32(
+    bcm_rx_packet_pool_size,
+    8192,
+    "Number of received packets the huge page backed pool holds");
+
 using folly::IOBuf;
+using facebook::fboss::HugePageMemory;
 
 namespace {
 
@@ -21,12 +39,73 @@ void freeRxBuf(void *ptr, void* arg) {
   opennsl_rx_free(unit, ptr);
 }
 
+// Keep slots on their own cache lines, packets are freed on other threads
+constexpr size_t kSlotAlign = 64;
+
+/*
+ * Fixed size slots carved out of one huge page backed region. Packets are
+ * allocated on the RX thread and freed on whichever thread handled them.
+ */
+class RxPacketSlab {
+ public:
+  RxPacketSlab(size_t slotSize, size_t slots)
+      : slotSize_((slotSize + kSlotAlign - 1) & ~(kSlotAlign - 1)),
+        memory_(slotSize_ * slots),
+        free_(slots) {
+    auto base = static_cast<char*>(memory_.data());
+    for (size_t i = 0; i < slots; ++i) {
+      free_.write(base + i * slotSize_);
+    }
+    XLOG(INFO) << "Pooled " << slots << " rx packets in "
+               << HugePageMemory::backingName(memory_.backing()) << " pages";
+  }
+
+  size_t slotSize() const {
+    return slotSize_;
+  }
+
+  void* alloc() {
+    void* slot{nullptr};
+    free_.read(slot);
+    return slot;
+  }
+
+  bool owns(void* ptr) const {
+    auto base = static_cast<char*>(memory_.data());
+    auto p = static_cast<char*>(ptr);
+    return p >= base && p < base + memory_.getSize();
+  }
+
+  void free(void* ptr) {
+    // Holds every slot, so there is always room
+    free_.blockingWrite(ptr);
+  }
+
+ private:
+  const size_t slotSize_;
+  HugePageMemory memory_;
+  folly::MPMCQueue<void*> free_;
+};
+
+RxPacketSlab* rxPacketSlab() {
+  // Never destroyed, packets can still be freed while the process exits
+  static RxPacketSlab* slab = []() -> RxPacketSlab* {
+    if (!FLAGS_bcm_rx_packet_hugepages || FLAGS_bcm_rx_packet_pool_size <= 0) {
+      return nullptr;
+    }
+    return new RxPacketSlab(
+        sizeof(facebook::fboss::BcmRxPacket),
+        FLAGS_bcm_rx_packet_pool_size);
+  }();
+  return slab;
+}
+
 }
 
 namespace facebook { namespace fboss {
 
 BcmRxPacket::BcmRxPacket(const opennsl_pkt_t* pkt)
-  : unit_(pkt->unit) {
+  : unit_(pkt->unit), cosQueue_(pkt->cos), reasons_(pkt->rx_reasons) {
   // The BCM RX code always uses a single buffer.
   // As long as there is just a single buffer, we don't need to allocate
   // a separate array of opennsl_pkt_blk_t objects.
@@ -45,9 +124,40 @@ BcmRxPacket::BcmRxPacket(const opennsl_pkt_t* pkt)
   len_ = pkt->pkt_len;
 }
 
+void* BcmRxPacket::operator new(size_t size) {
+  auto slab = rxPacketSlab();
+  if (slab && size <= slab->slotSize()) {
+    if (auto slot = slab->alloc()) {
+      return slot;
+    }
+  }
+  return ::operator new(size);
+}
+
+void BcmRxPacket::operator delete(void* ptr) {
+  auto slab = rxPacketSlab();
+  if (slab && slab->owns(ptr)) {
+    slab->free(ptr);
+    return;
+  }
+  ::operator delete(ptr);
+}
+
 BcmRxPacket::~BcmRxPacket() {
   // Nothing to do.  The IOBuf destructor will call freeRxBuf()
   // to free the packet data
 }
 
+std::vector<RxPacket::RxReason> BcmRxPacket::getReasons() {
+  std::vector<RxReason> reasons;
+  for (const auto& reason : BcmControlPlane::bcmRxReasons()) {
+    if (OPENNSL_RX_REASON_GET(reasons_, reason.second)) {
+      reasons.push_back(
+          {reason.second,
+           cfg::_PacketRxReason_VALUES_TO_NAMES.find(reason.first)->second});
+    }
+  }
+  return reasons;
+}
+
 }} // facebook::fboss
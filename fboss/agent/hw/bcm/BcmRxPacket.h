@@ -24,13 +24,35 @@ class BcmRxPacket : public RxPacket {
    *
    * The rx callback should return OPENNSL_RX_HANDLED_OWNED after successful
    * creation of the BcmRxPacket.
+   *
+   * buf() wraps the SDK's DMA buffer itself, and hands it back with
+   * opennsl_rx_free() once the last IOBuf referencing it goes away. Keep
+   * the packet (or a clone of buf()) rather than copying the data when
+   * forwarding it, e.g. to the host.
    */
   explicit BcmRxPacket(const opennsl_pkt_t* pkt);
 
   ~BcmRxPacket() override;
 
+  int cosQueue() const override {
+    return cosQueue_;
+  }
+  std::vector<RxReason> getReasons() override;
+
+  /*
+   * With --bcm_rx_packet_hugepages, packets come from a pool of slots in
+   * huge page backed memory rather than from the heap, so the packets in
+   * flight on the RX path take a few TLB entries rather than one per page
+   * they landed on. The pool falls back to the heap when it is empty.
+   */
+  static void* operator new(size_t size);
+  static void operator delete(void* ptr);
+
  private:
   int unit_{-1};
+  // The CPU queue the packet came in on
+  int cosQueue_{-1};
+  opennsl_rx_reasons_t reasons_;
 };
 
 }} // facebook::fboss
@@ -0,0 +1,182 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/hw/bcm/BcmSdkTracer.h"
+
+#include <gflags/gflags.h>
+
+#include <algorithm>
+#include <vector>
+
+DEFINE_bool(
+    bcm_sdk_trace,
+    false,
+    "Time the SDK calls made by the Bcm* wrappers, for getHwApiTrace()");
+
+using std::chrono::duration_cast;
+using std::chrono::microseconds;
+using std::chrono::system_clock;
+
+namespace facebook { namespace fboss {
+
+constexpr size_t BcmSdkTracer::kNumRecentCalls;
+constexpr size_t BcmSdkTracer::kNumBuckets;
+constexpr uint64_t BcmSdkTracer::kDigestSeed;
+
+namespace {
+
+size_t bucketFor(uint64_t nanos) {
+  size_t bucket = 0;
+  while (nanos > 1 && bucket < BcmSdkTracer::kNumBuckets - 1) {
+    nanos >>= 1;
+    ++bucket;
+  }
+  return bucket;
+}
+
+int64_t percentileUsecs(
+    const std::array<uint64_t, BcmSdkTracer::kNumBuckets>& buckets,
+    uint64_t total,
+    double pct) {
+  uint64_t seen = 0;
+  for (size_t i = 0; i < buckets.size(); ++i) {
+    seen += buckets[i];
+    if (seen >= total * pct) {
+      // Report the upper bound of the bucket
+      return (uint64_t(1) << (i + 1)) / 1000;
+    }
+  }
+  return 0;
+}
+
+} // namespace
+
+BcmSdkTracer::BcmSdkTracer() {}
+
+BcmSdkTracer* BcmSdkTracer::get() {
+  // Leaked, as call sites cache pointers into it until exit
+  static auto tracer = new BcmSdkTracer();
+  return tracer;
+}
+
+bool BcmSdkTracer::enabled() {
+  return FLAGS_bcm_sdk_trace;
+}
+
+BcmSdkTracer::ApiStats* BcmSdkTracer::api(const char* name) {
+  std::lock_guard<std::mutex> g(apisLock_);
+  auto& stats = apis_[name];
+  if (!stats) {
+    stats = std::make_unique<ApiStats>(name);
+  }
+  return stats.get();
+}
+
+void BcmSdkTracer::digestBytes(
+    uint64_t* digest,
+    const void* data,
+    size_t len) {
+  // FNV-1a
+  auto bytes = static_cast<const uint8_t*>(data);
+  for (size_t i = 0; i < len; ++i) {
+    *digest = (*digest ^ bytes[i]) * 0x100000001b3ULL;
+  }
+}
+
+void BcmSdkTracer::record(
+    ApiStats* api,
+    uint64_t argsDigest,
+    std::chrono::nanoseconds latency,
+    int rc) {
+  auto nanos = static_cast<uint64_t>(std::max<int64_t>(latency.count(), 0));
+  api->calls.fetch_add(1, std::memory_order_relaxed);
+  if (rc < 0) {
+    api->errors.fetch_add(1, std::memory_order_relaxed);
+  }
+  api->totalNanos.fetch_add(nanos, std::memory_order_relaxed);
+  api->buckets[bucketFor(nanos)].fetch_add(1, std::memory_order_relaxed);
+  auto max = api->maxNanos.load(std::memory_order_relaxed);
+  while (nanos > max &&
+         !api->maxNanos.compare_exchange_weak(
+             max, nanos, std::memory_order_relaxed)) {
+  }
+
+  auto index = nextCall_.fetch_add(1, std::memory_order_relaxed);
+  auto& call = calls_[index % kNumRecentCalls];
+  // A writer that laps a slower one on the same slot may leave it torn; the
+  // sequence check makes dump() skip it
+  call.seq.store(2 * index + 1, std::memory_order_release);
+  call.api = api;
+  call.argsDigest = argsDigest;
+  call.timestampUsecs =
+      duration_cast<microseconds>(system_clock::now().time_since_epoch())
+          .count();
+  call.latencyNanos = nanos;
+  call.rc = rc;
+  call.seq.store(2 * index + 2, std::memory_order_release);
+}
+
+HwApiTrace BcmSdkTracer::dump() const {
+  HwApiTrace trace;
+  {
+    std::lock_guard<std::mutex> g(apisLock_);
+    for (const auto& entry : apis_) {
+      const auto& api = *entry.second;
+      HwApiCallStats stats;
+      stats.api = api.api;
+      stats.calls = api.calls.load(std::memory_order_relaxed);
+      if (!stats.calls) {
+        continue;
+      }
+      stats.errors = api.errors.load(std::memory_order_relaxed);
+      stats.totalUsecs =
+          api.totalNanos.load(std::memory_order_relaxed) / 1000;
+      stats.maxUsecs = api.maxNanos.load(std::memory_order_relaxed) / 1000;
+      std::array<uint64_t, kNumBuckets> buckets;
+      uint64_t total = 0;
+      for (size_t i = 0; i < kNumBuckets; ++i) {
+        buckets[i] = api.buckets[i].load(std::memory_order_relaxed);
+        total += buckets[i];
+      }
+      stats.p50Usecs = percentileUsecs(buckets, total, 0.5);
+      stats.p99Usecs = percentileUsecs(buckets, total, 0.99);
+      trace.apis.push_back(std::move(stats));
+    }
+  }
+  std::sort(
+      trace.apis.begin(),
+      trace.apis.end(),
+      [](const HwApiCallStats& a, const HwApiCallStats& b) {
+        return a.totalUsecs > b.totalUsecs;
+      });
+
+  auto end = nextCall_.load(std::memory_order_acquire);
+  auto begin = end > kNumRecentCalls ? end - kNumRecentCalls : 0;
+  for (auto index = begin; index < end; ++index) {
+    const auto& call = calls_[index % kNumRecentCalls];
+    auto seq = call.seq.load(std::memory_order_acquire);
+    if (seq != 2 * index + 2) {
+      continue;
+    }
+    HwApiCall out;
+    out.api = call.api->api;
+    out.argsDigest = static_cast<int64_t>(call.argsDigest);
+    out.timestampUsecs = call.timestampUsecs;
+    out.latencyNsecs = call.latencyNanos;
+    out.rc = call.rc;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (call.seq.load(std::memory_order_relaxed) != seq) {
+      continue;
+    }
+    trace.recentCalls.push_back(std::move(out));
+  }
+  return trace;
+}
+
+}} // facebook::fboss
@@ -0,0 +1,175 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include "fboss/agent/if/gen-cpp2/ctrl_types.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace facebook { namespace fboss {
+
+/*
+ * Times the SDK calls the Bcm* wrappers make, when --bcm_sdk_trace is set,
+ * to tell how much of a slow state update is spent in the SDK and in which
+ * APIs. Calls go through BCM_SDK_TRACE() rather than straight to opennsl_*:
+ *
+ *   auto rc = BCM_SDK_TRACE(opennsl_l3_route_add, unit, &rt);
+ *
+ * Each API gets a latency histogram, and the most recent calls are kept with
+ * a digest of their arguments in a ring. Recording is lock free: the per API
+ * stats are found once per call site, and ring slots are claimed with an
+ * atomic increment. With tracing off a call costs a flag check.
+ */
+class BcmSdkTracer {
+ public:
+  static constexpr size_t kNumRecentCalls = 4096;
+  // Latency buckets are powers of two nanoseconds
+  static constexpr size_t kNumBuckets = 32;
+
+  struct ApiStats {
+    explicit ApiStats(std::string name) : api(std::move(name)) {}
+
+    const std::string api;
+    std::atomic<uint64_t> calls{0};
+    std::atomic<uint64_t> errors{0};
+    std::atomic<uint64_t> totalNanos{0};
+    std::atomic<uint64_t> maxNanos{0};
+    std::array<std::atomic<uint64_t>, kNumBuckets> buckets{};
+  };
+
+  static BcmSdkTracer* get();
+
+  static bool enabled();
+
+  /*
+   * The stats for api, created on first use. Call sites keep the pointer.
+   */
+  ApiStats* api(const char* name);
+
+  void record(
+      ApiStats* api,
+      uint64_t argsDigest,
+      std::chrono::nanoseconds latency,
+      int rc);
+
+  /*
+   * Per API stats, slowest in total first, and the recent calls, oldest
+   * first.
+   */
+  HwApiTrace dump() const;
+
+  template <typename ApiFn, typename Ret, typename... Params, typename... Args>
+  static Ret call(ApiFn apiStats, Ret (*func)(Params...), Args&&... args) {
+    if (!enabled()) {
+      return func(std::forward<Args>(args)...);
+    }
+    uint64_t digest = kDigestSeed;
+    digestArgs(&digest, args...);
+    auto start = std::chrono::steady_clock::now();
+    Ret rc = func(std::forward<Args>(args)...);
+    get()->record(
+        apiStats(),
+        digest,
+        std::chrono::steady_clock::now() - start,
+        static_cast<int>(rc));
+    return rc;
+  }
+
+ private:
+  struct Call {
+    // Odd while the slot is being written
+    std::atomic<uint64_t> seq{0};
+    ApiStats* api{nullptr};
+    uint64_t argsDigest{0};
+    uint64_t timestampUsecs{0};
+    uint64_t latencyNanos{0};
+    int rc{0};
+  };
+
+  static constexpr uint64_t kDigestSeed = 0xcbf29ce484222325ULL;
+
+  BcmSdkTracer();
+
+  // Forbidden copy constructor and assignment operator
+  BcmSdkTracer(BcmSdkTracer const &) = delete;
+  BcmSdkTracer& operator=(BcmSdkTracer const &) = delete;
+
+  static void digestBytes(uint64_t* digest, const void* data, size_t len);
+
+  // Values are digested; pointers to plain structs, the struct they point to
+  template <typename T>
+  static void digestArg(uint64_t* digest, const T& arg) {
+    digestArg(digest, arg, std::is_pointer<T>());
+  }
+  template <typename T>
+  static void digestArg(uint64_t* digest, const T& arg, std::false_type) {
+    static_assert(
+        std::is_trivially_copyable<T>::value, "SDK arguments are plain data");
+    digestBytes(digest, &arg, sizeof(arg));
+  }
+  template <typename T>
+  static void digestArg(uint64_t* digest, const T& arg, std::true_type) {
+    using Pointee = typename std::remove_pointer<T>::type;
+    digestPointee(
+        digest,
+        arg,
+        std::integral_constant<
+            bool,
+            !std::is_void<Pointee>::value &&
+                std::is_trivially_copyable<Pointee>::value>());
+  }
+  template <typename P>
+  static void digestPointee(uint64_t* digest, P ptr, std::true_type) {
+    if (ptr) {
+      digestBytes(digest, ptr, sizeof(*ptr));
+    }
+  }
+  template <typename P>
+  static void digestPointee(uint64_t* /*digest*/, P /*ptr*/, std::false_type) {
+  }
+
+  static void digestArgs(uint64_t* /*digest*/) {}
+  template <typename T, typename... Rest>
+  static void digestArgs(uint64_t* digest, const T& arg, const Rest&... rest) {
+    digestArg(digest, arg);
+    digestArgs(digest, rest...);
+  }
+
+  mutable std::mutex apisLock_;
+  std::map<std::string, std::unique_ptr<ApiStats>> apis_;
+
+  std::atomic<uint64_t> nextCall_{0};
+  std::array<Call, kNumRecentCalls> calls_;
+};
+
+}} // facebook::fboss
+
+/*
+ * Make an SDK call through BcmSdkTracer. The static in the lambda caches
+ * the API's stats for this call site.
+ */
+#define BCM_SDK_TRACE(func, ...)                                        \
+  ::facebook::fboss::BcmSdkTracer::call(                                \
+      []() {                                                            \
+        static auto apiStats =                                          \
+            ::facebook::fboss::BcmSdkTracer::get()->api(#func);         \
+        return apiStats;                                                \
+      },                                                                \
+      &func,                                                            \
+      __VA_ARGS__)
@@ -9,22 +9,59 @@
  */
 #include "BcmSflowExporter.h"
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
+#include <limits>
 #include <vector>
 
 #include <fcntl.h>
 #include <ifaddrs.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
 
 #include <folly/Optional.h>
 #include <folly/Range.h>
+#include <folly/io/Cursor.h>
 #include <folly/logging/xlog.h>
+#include <gflags/gflags.h>
 #include <glog/logging.h>
 
-#include <thrift/lib/cpp2/protocol/Serializer.h>
-
+#include "common/stats/ServiceData.h"
 #include "fboss/agent/FbossError.h"
-
+#include "fboss/agent/SwitchStats.h"
+#include "fboss/agent/Utils.h"
+#include "fboss/agent/hw/bcm/BcmStats.h"
+#include "fboss/agent/packet/SflowStructs.h"
+
+DEFINE_int32(
+    sflow_export_queue_size,
+    4096,
+    "Number of sFlow samples that may wait for export before new "
+    "samples are dropped");
+DEFINE_int32(
+    sflow_samples_per_datagram,
+    8,
+    "Maximum number of flow samples packed into one sFlow datagram");
+DEFINE_int32(
+    sflow_counter_interval_s,
+    20,
+    "Seconds between sFlow counter samples for each sampled port, "
+    "0 to disable them");
+DEFINE_int32(
+    sflow_adaptive_max_samples_per_sec,
+    0,
+    "Scale up the sFlow sampling rates of all ports while more samples than "
+    "this arrive per second; 0 to always use the configured rates");
+DEFINE_int32(
+    sflow_adaptive_max_cpu_percent,
+    80,
+    "Also scale up the sFlow sampling rates while the agent uses more than "
+    "this percent of a CPU; 0 to not take CPU use into account");
+DEFINE_int32(
+    sflow_adaptive_max_scale,
+    64,
+    "Most that the configured sFlow sampling rates are multiplied by");
 
 using namespace std;
 
@@ -101,6 +138,62 @@ folly::IPAddress getLocalIPv6() {
   XLOG(DBG2) << "Failed to get loopback ipv6 address, returned default one ::";
   return folly::IPAddress("::");
 }
+
+// Enough for the L2-L4 headers, the sFlow agent default
+constexpr size_t kMaxHeaderBytes = 128;
+// Stay under a typical path MTU
+constexpr size_t kMaxDatagramBytes = 1400;
+// Upper bound on what the export thread drains per wakeup
+constexpr size_t kMaxExportBatch = 512;
+
+// sFlow v5 enterprise 0 formats
+constexpr facebook::fboss::sflow::DataFormat kRawPacketHeader = 1;
+constexpr facebook::fboss::sflow::DataFormat kFlowSampleFormat = 1;
+constexpr facebook::fboss::sflow::DataFormat kCountersSampleFormat = 2;
+constexpr facebook::fboss::sflow::DataFormat kGenericIfCounters = 1;
+
+// ifType ethernetCsmacd, ifDirection full duplex
+constexpr uint32_t kIfTypeEthernet = 6;
+constexpr uint32_t kIfDirectionFullDuplex = 1;
+
+// How often the sampling rates are adapted
+constexpr auto kAdaptInterval = std::chrono::seconds(1);
+
+// User and system time of the whole agent
+std::chrono::microseconds processCpuTime() {
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return std::chrono::microseconds(0);
+  }
+  auto toUsecs = [](const timeval& tv) {
+    return std::chrono::seconds(tv.tv_sec) +
+        std::chrono::microseconds(tv.tv_usec);
+  };
+  return toUsecs(usage.ru_utime) + toUsecs(usage.ru_stime);
+}
+
+// sFlow reports counters the agent does not know as all ones
+uint32_t counter32(int64_t val) {
+  return val < 0 ? std::numeric_limits<uint32_t>::max() : uint32_t(val);
+}
+uint64_t counter64(int64_t val) {
+  return val < 0 ? std::numeric_limits<uint64_t>::max() : uint64_t(val);
+}
+
+size_t xdrPadded(size_t len) {
+  auto block = facebook::fboss::sflow::XDR_BASIC_BLOCK_SIZE;
+  return (len + block - 1) / block * block;
+}
+
+// version, agent address, sub agent, sequence, uptime, sample count
+size_t datagramHeaderSize(const folly::IPAddress& agent) {
+  return 4 + 4 + agent.byteCount() + 4 * 4;
+}
+
+// sample type, length and the padded flow_sample
+size_t sampleRecordSize(size_t flowSampleLen) {
+  return 4 + 4 + xdrPadded(flowSampleLen);
+}
 } // namespace
 
 namespace facebook {
@@ -188,25 +281,88 @@ ssize_t BcmSflowExporter::sendUDPDatagram(iovec* vec, const size_t iovec_len) {
   return ret;
 }
 
+int BcmSflowExporter::sendUDPDatagrams(
+    const std::vector<folly::ByteRange>& datagrams) {
+  if (datagrams.empty()) {
+    return 0;
+  }
+  sockaddr_storage addrStorage;
+  address_.getAddress(&addrStorage);
+
+  std::vector<iovec> vecs(datagrams.size());
+  std::vector<mmsghdr> msgs(datagrams.size());
+  for (size_t i = 0; i < datagrams.size(); ++i) {
+    vecs[i].iov_base = const_cast<uint8_t*>(datagrams[i].data());
+    vecs[i].iov_len = datagrams[i].size();
+    auto& msg = msgs[i].msg_hdr;
+    msg = {};
+    msg.msg_name = reinterpret_cast<void*>(&addrStorage);
+    msg.msg_namelen = address_.getActualSize();
+    msg.msg_iov = &vecs[i];
+    msg.msg_iovlen = 1;
+  }
+
+  // sendmmsg() stops at the first datagram that fails, so pick up after it
+  size_t sent = 0;
+  size_t failed = 0;
+  while (sent + failed < msgs.size()) {
+    auto next = sent + failed;
+    auto ret = ::sendmmsg(socket_, &msgs[next], msgs.size() - next, 0);
+    if (ret < 0) {
+      XLOG(DBG1) << "Failed sending sFlow packets to " << address_.describe()
+                 << " reason: " << folly::errnoStr(errno);
+      BcmStats::get()->sflowSendError();
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        break;
+      }
+      // Skip the datagram the kernel refused
+      ++failed;
+      continue;
+    }
+    sent += ret;
+  }
+  XLOG(DBG4) << "Sent " << sent << " sFlow datagrams to "
+             << address_.describe();
+  return sent;
+}
+
 BcmSflowExporter::~BcmSflowExporter() {
   if (socket_ != -1) {
     close(socket_);
   }
 }
 
+BcmSflowExporterTable::BcmSflowExporterTable(RateProgrammer programRates)
+    : lastCpuTime_(processCpuTime()),
+      programRates_(std::move(programRates)),
+      queue_(FLAGS_sflow_export_queue_size) {
+  thread_ = std::make_unique<std::thread>([this]() {
+    initThread("fbossSflowExport");
+    exportLoop();
+  });
+}
+
+BcmSflowExporterTable::~BcmSflowExporterTable() {
+  queue_.blockingWrite(nullptr);
+  thread_->join();
+}
+
 bool BcmSflowExporterTable::contains(
     const shared_ptr<SflowCollector>& c) const {
+  std::lock_guard<std::mutex> g(mutex_);
   auto iter = map_.find(c->getID());
   return iter != map_.end();
 }
 
 size_t BcmSflowExporterTable::size() const {
+  std::lock_guard<std::mutex> g(mutex_);
   return map_.size();
 }
 
 void BcmSflowExporterTable::addExporter(const shared_ptr<SflowCollector>& c) {
   try {
     auto exporter = make_unique<BcmSflowExporter>(c->getAddress());
+    std::lock_guard<std::mutex> g(mutex_);
     map_.emplace(c->getID(), move(exporter));
   } catch (const fboss::thrift::FbossBaseError& ex) {
     XLOG(ERR) << "Could not add exporter: "
@@ -221,6 +377,7 @@ void BcmSflowExporterTable::addExporter(const shared_ptr<SflowCollector>& c) {
 
 void BcmSflowExporterTable::removeExporter(const std::string& id) {
   XLOG(INFO) << "Removed sFlow exporter " << id;
+  std::lock_guard<std::mutex> g(mutex_);
   map_.erase(id);
 }
 
@@ -228,6 +385,10 @@ void BcmSflowExporterTable::updateSamplingRates(
     PortID id,
     int64_t inRate,
     int64_t outRate) {
+  // We piggyback the update of local IPv6
+  auto localIP = getLocalIPv6();
+
+  std::lock_guard<std::mutex> g(mutex_);
   std::pair<int64_t, int64_t> rates(inRate, outRate);
   auto it = port2samplingRates_.find(id);
   if (it != port2samplingRates_.end()) {
@@ -235,36 +396,385 @@ void BcmSflowExporterTable::updateSamplingRates(
   } else {
     port2samplingRates_.insert(std::make_pair(id, rates));
   }
-
-  // We piggyback the update of local IPv6
-  localIP_ = getLocalIPv6();
+  if (rateScale_ > 1) {
+    // The new rates were programmed unscaled
+    reprogramRates_ = true;
+  }
+  if (inRate == 0 && outRate == 0) {
+    // No longer sampled, so stop its counter samples too
+    auto counters = port2counters_.find(id);
+    if (counters != port2counters_.end()) {
+      counters->second.hasStats = false;
+    }
+  }
+  localIP_ = localIP;
 }
 
 void BcmSflowExporterTable::sendToAll(const SflowPacketInfo& info) {
-  if (map_.empty()) {
+  if (size() == 0) {
     XLOG(DBG1)
         << "zero sFlow collectors with sflow enabled, skipping sample export";
     return;
   }
-  // Serialize info to a string and wrap it in an IOBuf for sending
-  string output;
-  apache::thrift::BinarySerializer::serialize(info, &output);
-  auto buf = folly::IOBuf::wrapBuffer(output.data(), output.length());
+  ++arrivals_;
+  if (!queue_.write(std::make_unique<SflowPacketInfo>(info))) {
+    ++drops_;
+    BcmStats::get()->sflowSampleDrop();
+  }
+}
+
+void BcmSflowExporterTable::updatePortStats(
+    PortID id,
+    const HwPortStats& stats) {
+  std::lock_guard<std::mutex> g(mutex_);
+  // Only sampled ports get counter samples
+  auto rates = port2samplingRates_.find(id);
+  if (rates == port2samplingRates_.end() ||
+      (rates->second.first == 0 && rates->second.second == 0)) {
+    return;
+  }
+  auto& counters = port2counters_[id];
+  counters.stats = stats;
+  counters.hasStats = true;
+}
+
+void BcmSflowExporterTable::updatePortStatus(
+    PortID id,
+    uint64_t speedBps,
+    bool adminUp,
+    bool operUp) {
+  std::lock_guard<std::mutex> g(mutex_);
+  auto& counters = port2counters_[id];
+  counters.speedBps = speedBps;
+  counters.status = (adminUp ? 1 : 0) | (operUp ? 2 : 0);
+}
+
+bool BcmSflowExporterTable::countersDue(
+    std::chrono::steady_clock::time_point now) const {
+  return FLAGS_sflow_counter_interval_s > 0 && now >= nextCounterExport_;
+}
+
+folly::Optional<std::chrono::steady_clock::time_point>
+BcmSflowExporterTable::nextWakeup() const {
+  folly::Optional<std::chrono::steady_clock::time_point> wakeup;
+  if (FLAGS_sflow_counter_interval_s > 0) {
+    wakeup = nextCounterExport_;
+  }
+  if (FLAGS_sflow_adaptive_max_samples_per_sec > 0 || rateScale_ > 1) {
+    auto adapt = lastAdapt_ + kAdaptInterval;
+    wakeup = wakeup ? std::min(*wakeup, adapt) : adapt;
+  }
+  return wakeup;
+}
+
+void BcmSflowExporterTable::exportLoop() {
+  std::vector<std::unique_ptr<SflowPacketInfo>> samples;
+  while (true) {
+    std::unique_ptr<SflowPacketInfo> sample;
+    bool haveSample = false;
+    auto wakeup = nextWakeup();
+    if (wakeup) {
+      // Wake up for the counter samples and the sampling rates even if
+      // nothing gets sampled
+      haveSample = queue_.tryReadUntil(*wakeup, sample);
+    } else {
+      queue_.blockingRead(sample);
+      haveSample = true;
+    }
+    bool stop = haveSample && !sample;
+    if (haveSample && !stop) {
+      samples.push_back(std::move(sample));
+    }
+    // Take whatever else has piled up so it can share datagrams
+    while (!stop && samples.size() < kMaxExportBatch &&
+           queue_.read(sample)) {
+      if (!sample) {
+        stop = true;
+        break;
+      }
+      samples.push_back(std::move(sample));
+    }
+    exportSamples(samples);
+    samples.clear();
+    if (stop) {
+      return;
+    }
+    auto now = std::chrono::steady_clock::now();
+    if (now >= lastAdapt_ + kAdaptInterval) {
+      adaptSamplingRates(now);
+    }
+  }
+}
+
+void BcmSflowExporterTable::adaptSamplingRates(
+    std::chrono::steady_clock::time_point now) {
+  auto elapsed =
+      std::chrono::duration_cast<std::chrono::microseconds>(now - lastAdapt_);
+  lastAdapt_ = now;
+  auto arrivals = arrivals_.load();
+  auto cpuTime = processCpuTime();
+  if (elapsed.count() <= 0) {
+    return;
+  }
+  double samplesPerSec = (arrivals - lastArrivals_) * 1e6 / elapsed.count();
+  double cpuPercent = (cpuTime - lastCpuTime_).count() * 100.0 /
+      elapsed.count();
+  lastArrivals_ = arrivals;
+  lastCpuTime_ = cpuTime;
+
+  auto maxSamples = FLAGS_sflow_adaptive_max_samples_per_sec;
+  auto maxCpu = FLAGS_sflow_adaptive_max_cpu_percent;
+  auto maxScale = std::max<int64_t>(FLAGS_sflow_adaptive_max_scale, 1);
+  bool overBudget = maxSamples > 0 &&
+      (samplesPerSec > maxSamples || (maxCpu > 0 && cpuPercent > maxCpu));
+  // Halving the scale doubles the samples, and roughly their CPU cost
+  bool halfWithinBudget = samplesPerSec * 2 <= maxSamples &&
+      (maxCpu <= 0 || cpuPercent * 2 <= maxCpu);
+
+  std::vector<std::pair<PortID, std::pair<int64_t, int64_t>>> program;
+  int64_t scale;
+  {
+    std::lock_guard<std::mutex> g(mutex_);
+    scale = rateScale_;
+    if (maxSamples <= 0) {
+      scale = 1;
+    } else if (overBudget) {
+      scale = std::min(scale * 2, maxScale);
+    } else if (scale > 1 && halfWithinBudget) {
+      scale /= 2;
+    }
+    scale = std::min(scale, maxScale);
+    if (scale == rateScale_ && !reprogramRates_) {
+      return;
+    }
+    if (scale != rateScale_) {
+      XLOG(INFO) << "sFlow sampling rates scaled by " << scale << " at "
+                 << samplesPerSec << " samples/s and " << cpuPercent
+                 << "% CPU";
+    }
+    rateScale_ = scale;
+    reprogramRates_ = false;
+    for (const auto& portAndRates : port2samplingRates_) {
+      program.emplace_back(
+          portAndRates.first,
+          std::make_pair(
+              portAndRates.second.first * scale,
+              portAndRates.second.second * scale));
+    }
+  }
+
+  fbData->setCounter(
+      SwitchStats::kCounterPrefix + "sflow.sampling_rate_scale", scale);
+  if (!programRates_) {
+    return;
+  }
+  // Outside of mutex_, as the programmer takes the hardware's locks,
+  // which the update thread holds while calling updateSamplingRates()
+  for (const auto& portAndRates : program) {
+    programRates_(
+        portAndRates.first,
+        portAndRates.second.first,
+        portAndRates.second.second);
+  }
+}
+
+void BcmSflowExporterTable::exportSamples(
+    const std::vector<std::unique_ptr<SflowPacketInfo>>& samples) {
+  auto now = std::chrono::steady_clock::now();
+  bool exportCounters = countersDue(now);
+  if (exportCounters) {
+    nextCounterExport_ =
+        now + std::chrono::seconds(FLAGS_sflow_counter_interval_s);
+  }
+  if (samples.empty() && !exportCounters) {
+    return;
+  }
+  std::lock_guard<std::mutex> g(mutex_);
+  if (map_.empty()) {
+    return;
+  }
+
+  std::vector<EncodedSample> encoded;
+  encoded.reserve(samples.size());
+  for (const auto& sample : samples) {
+    encoded.push_back(encodeFlowSample(*sample));
+  }
+  if (exportCounters) {
+    for (const auto& portAndCounters : port2counters_) {
+      if (portAndCounters.second.hasStats) {
+        encoded.push_back(encodeCountersSample(
+            portAndCounters.first, portAndCounters.second));
+      }
+    }
+  }
+
+  // Split the samples into datagrams no larger than kMaxDatagramBytes
+  std::vector<std::unique_ptr<folly::IOBuf>> datagrams;
+  auto headerSize = datagramHeaderSize(localIP_);
+  size_t begin = 0;
+  while (begin < encoded.size()) {
+    auto end = begin;
+    auto size = headerSize;
+    while (end < encoded.size() &&
+           end - begin < size_t(FLAGS_sflow_samples_per_datagram)) {
+      auto recordSize = sampleRecordSize(encoded[end].data.size());
+      // Always take at least one, whatever its size
+      if (end > begin && size + recordSize > kMaxDatagramBytes) {
+        break;
+      }
+      size += recordSize;
+      ++end;
+    }
+    datagrams.push_back(buildDatagram(encoded, begin, end));
+    BcmStats::get()->sflowDatagram(end - begin);
+    begin = end;
+  }
 
-  // Map the IOBuf to a Linux iovec like a champ
-  iovec vec[16] = {};
-  size_t iovec_len = buf->fillIov(vec, sizeof(vec) / sizeof(vec[0])).numIovecs;
-  if (UNLIKELY(iovec_len == 0)) {
-    buf->coalesce();
-    vec[0].iov_base = const_cast<uint8_t*>(buf->data());
-    vec[0].iov_len = buf->length();
-    iovec_len = 1;
+  std::vector<folly::ByteRange> ranges;
+  ranges.reserve(datagrams.size());
+  for (const auto& datagram : datagrams) {
+    ranges.emplace_back(datagram->data(), datagram->length());
+  }
+  for (const auto& c : map_) {
+    c.second->sendUDPDatagrams(ranges);
   }
+}
 
-  for (const auto& c: map_) {
-    // TODO: prob need to handle ret code?
-    c.second->sendUDPDatagram(vec, iovec_len);
+BcmSflowExporterTable::EncodedSample BcmSflowExporterTable::encodeFlowSample(
+    const SflowPacketInfo& info) {
+  sflow::SampledHeader header;
+  header.protocol = sflow::HeaderProtocol::ETHERNET_ISO88023;
+  header.frameLength = info.frameLength;
+  header.stripped = info.payloadRemoved;
+  header.headerLength = std::min(info.packetData.size(), kMaxHeaderBytes);
+  header.header = reinterpret_cast<const sflow::byte*>(info.packetData.data());
+
+  std::vector<uint8_t> headerBytes(xdrPadded(header.size()));
+  auto headerBuf =
+      folly::IOBuf::wrapBuffer(headerBytes.data(), headerBytes.size());
+  folly::io::RWPrivateCursor headerCursor(headerBuf.get());
+  header.serialize(&headerCursor);
+
+  sflow::FlowRecord record;
+  record.flowFormat = kRawPacketHeader;
+  record.flowDataLen = headerBytes.size();
+  record.flowData = headerBytes.data();
+
+  int64_t samplingRate = 0;
+  auto rates = port2samplingRates_.find(PortID(info.srcPort));
+  if (rates != port2samplingRates_.end()) {
+    samplingRate =
+        info.ingressSampled ? rates->second.first : rates->second.second;
+    // What the hardware samples at now, not what was configured
+    samplingRate *= rateScale_;
   }
+
+  sflow::FlowSample sample;
+  sample.sequenceNumber = ++sampleSequence_;
+  sample.sourceID = info.srcPort;
+  sample.samplingRate = samplingRate;
+  samplePool_ += samplingRate;
+  sample.samplePool = samplePool_;
+  sample.drops = drops_;
+  sample.input = info.srcPort;
+  sample.output = info.dstPort;
+  sample.flowRecordsCnt = 1;
+  sample.flowRecords = &record;
+
+  EncodedSample encoded{kFlowSampleFormat,
+                        std::vector<uint8_t>(
+                            sample.size(xdrPadded(record.size())))};
+  auto sampleBuf =
+      folly::IOBuf::wrapBuffer(encoded.data.data(), encoded.data.size());
+  folly::io::RWPrivateCursor sampleCursor(sampleBuf.get());
+  sample.serialize(&sampleCursor);
+  return encoded;
+}
+
+BcmSflowExporterTable::EncodedSample
+BcmSflowExporterTable::encodeCountersSample(
+    PortID id,
+    const PortCounters& counters) {
+  const auto& stats = counters.stats;
+  sflow::IfCounters ifCounters;
+  ifCounters.ifIndex = id;
+  ifCounters.ifType = kIfTypeEthernet;
+  ifCounters.ifSpeed = counters.speedBps;
+  ifCounters.ifDirection = kIfDirectionFullDuplex;
+  ifCounters.ifStatus = counters.status;
+  ifCounters.ifInOctets = counter64(stats.inBytes_);
+  ifCounters.ifInUcastPkts = counter32(stats.inUnicastPkts_);
+  ifCounters.ifInMulticastPkts = counter32(stats.inMulticastPkts_);
+  ifCounters.ifInBroadcastPkts = counter32(stats.inBroadcastPkts_);
+  ifCounters.ifInDiscards = counter32(stats.inDiscards_);
+  ifCounters.ifInErrors = counter32(stats.inErrors_);
+  ifCounters.ifInUnknownProtos = std::numeric_limits<uint32_t>::max();
+  ifCounters.ifOutOctets = counter64(stats.outBytes_);
+  ifCounters.ifOutUcastPkts = counter32(stats.outUnicastPkts_);
+  ifCounters.ifOutMulticastPkts = counter32(stats.outMulticastPkts_);
+  ifCounters.ifOutBroadcastPkts = counter32(stats.outBroadcastPkts_);
+  ifCounters.ifOutDiscards = counter32(stats.outDiscards_);
+  ifCounters.ifOutErrors = counter32(stats.outErrors_);
+  ifCounters.ifPromiscuousMode = 0;
+
+  std::vector<uint8_t> counterBytes(ifCounters.size());
+  auto counterBuf =
+      folly::IOBuf::wrapBuffer(counterBytes.data(), counterBytes.size());
+  folly::io::RWPrivateCursor counterCursor(counterBuf.get());
+  ifCounters.serialize(&counterCursor);
+
+  sflow::CounterRecord record;
+  record.counterFormat = kGenericIfCounters;
+  record.counterDataLen = counterBytes.size();
+  record.counterData = counterBytes.data();
+
+  sflow::CountersSample sample;
+  sample.sequenceNumber = ++counterSequence_;
+  sample.sourceID = id;
+  sample.counterRecordsCnt = 1;
+  sample.counterRecords = &record;
+
+  EncodedSample encoded{kCountersSampleFormat,
+                        std::vector<uint8_t>(sample.size(record.size()))};
+  auto sampleBuf =
+      folly::IOBuf::wrapBuffer(encoded.data.data(), encoded.data.size());
+  folly::io::RWPrivateCursor sampleCursor(sampleBuf.get());
+  sample.serialize(&sampleCursor);
+  return encoded;
+}
+
+std::unique_ptr<folly::IOBuf> BcmSflowExporterTable::buildDatagram(
+    const std::vector<EncodedSample>& samples,
+    size_t begin,
+    size_t end) {
+  std::vector<sflow::SampleRecord> records(end - begin);
+  auto size = datagramHeaderSize(localIP_);
+  for (size_t i = begin; i < end; ++i) {
+    auto& record = records[i - begin];
+    record.sampleType = samples[i].sampleType;
+    record.sampleDataLen = samples[i].data.size();
+    record.sampleData = const_cast<sflow::byte*>(samples[i].data.data());
+    size += sampleRecordSize(samples[i].data.size());
+  }
+
+  sflow::SampleDatagram datagram;
+  datagram.datagramV5.agentAddress = localIP_;
+  datagram.datagramV5.subAgentID = 0;
+  datagram.datagramV5.sequenceNumber = ++datagramSequence_;
+  datagram.datagramV5.uptime =
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          std::chrono::steady_clock::now() - start_)
+          .count();
+  datagram.datagramV5.samplesCnt = records.size();
+  datagram.datagramV5.samples = records.data();
+
+  auto buf = folly::IOBuf::create(size);
+  buf->append(size);
+  folly::io::RWPrivateCursor cursor(buf.get());
+  datagram.serialize(&cursor);
+  // Anything the size estimate over-counted
+  buf->trimEnd(cursor.length());
+  return buf;
 }
 
 } // namespace fboss
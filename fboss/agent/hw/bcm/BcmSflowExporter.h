@@ -9,11 +9,23 @@
  */
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
 #include <folly/IPAddress.h>
+#include <folly/MPMCQueue.h>
+#include <folly/Optional.h>
+#include <folly/Range.h>
 #include <folly/SocketAddress.h>
+#include <folly/io/IOBuf.h>
 
+#include "fboss/agent/hw/gen-cpp2/hardware_stats_types.h"
 #include "fboss/agent/if/gen-cpp2/sflow_types.h"
 #include "fboss/agent/state/SflowCollector.h"
 #include "fboss/agent/types.h"
@@ -36,6 +48,12 @@ class BcmSflowExporter {
    */
   ssize_t sendUDPDatagram(iovec* vec, const size_t iovec_len);
 
+  /*
+   * Send each buffer as its own UDP datagram, all with one sendmmsg().
+   * Returns how many were sent.
+   */
+  int sendUDPDatagrams(const std::vector<folly::ByteRange>& datagrams);
+
  private:
   // no copy or assignment
   BcmSflowExporter(BcmSflowExporter const &) = delete;
@@ -45,10 +63,37 @@ class BcmSflowExporter {
   int socket_{-1};
 };
 
+/*
+ * Exports sampled packets to every sFlow collector.
+ *
+ * sendToAll() only queues the sample, so the RX thread never waits on a
+ * socket. A dedicated thread packs whatever was queued since its last
+ * wakeup into sFlow v5 datagrams of several flow samples each, and hands
+ * them to each collector with a single sendmmsg(). Samples that find the
+ * queue full are dropped and counted.
+ *
+ * Every --sflow_counter_interval_s the same thread also emits a counter
+ * sample per sampled port. These are built from the port stats the stats
+ * thread already collected, handed over with updatePortStats(), and share
+ * datagrams with the flow samples.
+ *
+ * With --sflow_adaptive_max_samples_per_sec the export thread also watches
+ * how many samples arrive, and the agent's CPU use, once a second. Over
+ * either budget it doubles every port's sampling rate, up to
+ * --sflow_adaptive_max_scale times the configured one, and halves it again
+ * once half the rate would still be within budget. The rates are
+ * reprogrammed through the callback given at construction, and the flow
+ * samples carry the scaled rate so collectors still scale up correctly.
+ */
 class BcmSflowExporterTable {
   public:
-    BcmSflowExporterTable() = default;
-    ~BcmSflowExporterTable() = default;
+    // Programs a port's sampling rates in the hardware
+    using RateProgrammer =
+        std::function<void(PortID, int64_t ingressRate, int64_t egressRate)>;
+
+    explicit BcmSflowExporterTable(RateProgrammer programRates = nullptr);
+    // Exports whatever is still queued before returning
+    ~BcmSflowExporterTable();
 
     bool contains(const std::shared_ptr<SflowCollector>& collector) const;
     size_t size() const;
@@ -57,18 +102,89 @@ class BcmSflowExporterTable {
 
     void updateSamplingRates(PortID id, int64_t inRate, int64_t outRate);
 
+    // Latest counters and link status for the next counter samples
+    void updatePortStats(PortID id, const HwPortStats& stats);
+    void updatePortStatus(
+        PortID id,
+        uint64_t speedBps,
+        bool adminUp,
+        bool operUp);
+
+    // Queue info for export. Safe to call from any thread.
     void sendToAll(const SflowPacketInfo& info);
   private:
+    struct PortCounters {
+      HwPortStats stats;
+      bool hasStats{false};
+      uint64_t speedBps{0};
+      uint32_t status{0}; // bit 0 admin up, bit 1 oper up
+    };
+    struct EncodedSample {
+      uint32_t sampleType;
+      std::vector<uint8_t> data;
+    };
+
     // no copy or assignment
     BcmSflowExporterTable(BcmSflowExporterTable const &) = delete;
     BcmSflowExporterTable& operator=(BcmSflowExporterTable const &) = delete;
 
+    void exportLoop();
+    // Pack samples, and counter samples if they are due, into as few
+    // datagrams as fit, then send them everywhere
+    void exportSamples(
+        const std::vector<std::unique_ptr<SflowPacketInfo>>& samples);
+    bool countersDue(std::chrono::steady_clock::time_point now) const;
+    // When the export thread next has something to do besides samples
+    folly::Optional<std::chrono::steady_clock::time_point> nextWakeup() const;
+    // Rescale the sampling rates to the sample and CPU budgets
+    void adaptSamplingRates(std::chrono::steady_clock::time_point now);
+    // XDR encoded flow_sample for info
+    EncodedSample encodeFlowSample(const SflowPacketInfo& info);
+    // XDR encoded counters_sample with the generic interface counters
+    EncodedSample encodeCountersSample(
+        PortID id,
+        const PortCounters& counters);
+    std::unique_ptr<folly::IOBuf> buildDatagram(
+        const std::vector<EncodedSample>& samples,
+        size_t begin,
+        size_t end);
+
+    // Protects the collectors, rates, counters and local address, which
+    // the export thread shares with the update and stats threads
+    mutable std::mutex mutex_;
     std::unordered_map<std::string, std::unique_ptr<BcmSflowExporter>> map_;
     std::unordered_map<
         PortID,
         std::pair<int64_t /* ingress rate */, int64_t /* egress rate */>>
         port2samplingRates_;
+    std::unordered_map<PortID, PortCounters> port2counters_;
     folly::IPAddress localIP_;
+    // The configured rates are multiplied by this in the hardware
+    int64_t rateScale_{1};
+    // A configured rate changed, so the scaled rates need programming
+    bool reprogramRates_{false};
+
+    // Only used by the export thread
+    uint32_t datagramSequence_{0};
+    uint32_t sampleSequence_{0};
+    uint32_t samplePool_{0};
+    uint32_t counterSequence_{0};
+    const std::chrono::steady_clock::time_point start_{
+        std::chrono::steady_clock::now()};
+    std::chrono::steady_clock::time_point nextCounterExport_{start_};
+    std::chrono::steady_clock::time_point lastAdapt_{start_};
+    uint64_t lastArrivals_{0};
+    std::chrono::microseconds lastCpuTime_{0};
+
+    const RateProgrammer programRates_;
+    // Samples handed to sendToAll(), for the adaptive sampling rates
+    std::atomic<uint64_t> arrivals_{0};
+
+    // Samples sendToAll() found no room for
+    std::atomic<uint32_t> drops_{0};
+    // A null entry tells the export thread to exit
+    folly::MPMCQueue<std::unique_ptr<SflowPacketInfo>> queue_;
+    std::unique_ptr<std::thread> thread_;
 };
 
 } // namespace fboss
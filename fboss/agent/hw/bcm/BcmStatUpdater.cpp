@@ -13,11 +13,22 @@
 #include "fboss/agent/hw/bcm/BcmAddressFBConvertors.h"
 
 #include <boost/container/flat_map.hpp>
+#include <gflags/gflags.h>
+
+#include <algorithm>
+
+DEFINE_int32(bcm_table_stats_refresh_interval_s, 30,
+             "How often to reconcile hardware table usage stats with the "
+             "SDK.  They are kept up to date from state changes in between");
+DEFINE_int32(acl_stat_idle_interval_s, 60,
+             "How often to poll ACL stats that nobody is watching, see "
+             "watchAclStats().  0 polls them every stats cycle");
 
 namespace facebook { namespace fboss {
 
 using std::chrono::duration_cast;
 using std::chrono::seconds;
+using std::chrono::steady_clock;
 using std::chrono::system_clock;
 
 BcmStatUpdater::BcmStatUpdater(BcmSwitch* hw, bool isAlpmEnabled)
@@ -40,8 +51,7 @@ void BcmStatUpdater::toBeAddedAclStat(
     const std::string& name,
     const std::vector<cfg::CounterType>& counterTypes) {
   for (auto type : counterTypes) {
-    std::string counterName = name + "." + counterTypeToString(type);
-    toBeAddedAclStats_.emplace(counterName, AclCounterDescriptor(handle, type));
+    toBeAddedAclStats_.emplace(name, AclCounterDescriptor(handle, type));
   }
 }
 
@@ -49,6 +59,17 @@ void BcmStatUpdater::toBeRemovedAclStat(BcmAclStatHandle handle) {
   toBeRemovedAclStats_.emplace(handle);
 }
 
+void BcmStatUpdater::watchAclStats(
+    const std::vector<std::string>& names,
+    std::chrono::seconds duration) {
+  auto until = steady_clock::now() + duration;
+  auto watched = watchedAclStats_.wlock();
+  for (const auto& name : names) {
+    auto& watchedUntil = (*watched)[name];
+    watchedUntil = std::max(watchedUntil, until);
+  }
+}
+
 void BcmStatUpdater::refreshPostBcmStateChange(const StateDelta& delta) {
   refreshHwTableStats(delta);
   refreshAclStats();
@@ -61,18 +82,52 @@ void BcmStatUpdater::updateStats() {
 
 void BcmStatUpdater::updateAclStats() {
   auto now = duration_cast<seconds>(system_clock::now().time_since_epoch());
+  auto steadyNow = steady_clock::now();
+  auto idleInterval = seconds(FLAGS_acl_stat_idle_interval_s);
+
+  std::unordered_map<std::string, steady_clock::time_point> watched;
+  {
+    auto lockedWatched = watchedAclStats_.wlock();
+    for (auto iter = lockedWatched->begin(); iter != lockedWatched->end();) {
+      if (iter->second <= steadyNow) {
+        iter = lockedWatched->erase(iter);
+      } else {
+        ++iter;
+      }
+    }
+    watched = *lockedWatched;
+  }
+
+  // aclStats_ is ordered by handle, so the counters of one stat are read
+  // back to back
   auto lockedAclStats = aclStats_.wlock();
   for (auto& entry : *lockedAclStats) {
+    auto& aclCounter = entry.second;
+    bool due = steadyNow - aclCounter.lastUpdated >= idleInterval ||
+        watched.find(aclCounter.statName) != watched.end();
+    if (!due) {
+      continue;
+    }
+    aclCounter.lastUpdated = steadyNow;
     updateAclStat(
         hw_->getUnit(),
         entry.first.handle,
         entry.first.counterType,
         now,
-        entry.second.get());
+        aclCounter.counter.get());
   }
 }
 
 void BcmStatUpdater::updateHwTableStats() {
+  auto now = steady_clock::now();
+  if (now - lastTableStatsRefresh_ >=
+      seconds(FLAGS_bcm_table_stats_refresh_interval_s)) {
+    lastTableStatsRefresh_ = now;
+    // Hold the lock across the SDK pass, so a delta applied meanwhile is
+    // neither lost nor counted twice.
+    auto stats = tableStats_.wlock();
+    bcmTableStatsManager_->refresh(&(*stats));
+  }
   bcmTableStatsManager_->publish(*tableStats_.rlock());
 }
 
@@ -84,7 +139,7 @@ MonotonicCounter* FOLLY_NULLABLE
 BcmStatUpdater::getCounterIf(BcmAclStatHandle handle, cfg::CounterType type) {
   auto lockedAclStats = aclStats_.rlock();
   auto iter = lockedAclStats->find(AclCounterDescriptor(handle, type));
-  return iter != lockedAclStats->end() ? iter->second.get() : nullptr;
+  return iter != lockedAclStats->end() ? iter->second.counter.get() : nullptr;
 }
 
 void BcmStatUpdater::clearPortStats(
@@ -102,7 +157,7 @@ void BcmStatUpdater::clearPortStats(
 
 void BcmStatUpdater::refreshHwTableStats(const StateDelta& delta) {
   auto stats = tableStats_.wlock();
-  bcmTableStatsManager_->refresh(delta, &(*stats));
+  bcmTableStatsManager_->applyDelta(delta, &(*stats));
 }
 
 void BcmStatUpdater::refreshAclStats() {
@@ -126,11 +181,16 @@ void BcmStatUpdater::refreshAclStats() {
   }
 
   while (!toBeAddedAclStats_.empty()) {
-    const std::string& name = toBeAddedAclStats_.front().first;
+    const std::string& statName = toBeAddedAclStats_.front().first;
     auto aclCounterDescriptor = toBeAddedAclStats_.front().second;
+    auto name =
+        statName + "." + counterTypeToString(aclCounterDescriptor.counterType);
+    AclCounter aclCounter;
+    aclCounter.statName = statName;
+    aclCounter.counter =
+        std::make_unique<MonotonicCounter>(name, stats::SUM, stats::RATE);
     auto inserted = lockedAclStats->emplace(
-        aclCounterDescriptor,
-        std::make_unique<MonotonicCounter>(name, stats::SUM, stats::RATE));
+        aclCounterDescriptor, std::move(aclCounter));
     if (!inserted.second) {
       throw FbossError(
           "Duplicate ACL stat handle, handle=",
@@ -14,7 +14,9 @@
 #include "fboss/agent/hw/bcm/types.h"
 #include "fboss/agent/types.h"
 
+#include <chrono>
 #include <queue>
+#include <unordered_map>
 #include <folly/Synchronized.h>
 #include <boost/container/flat_map.hpp>
 
@@ -58,6 +60,16 @@ class BcmStatUpdater {
       const std::string& name,
       const std::vector<cfg::CounterType>& counterTypes);
   void toBeRemovedAclStat(BcmAclStatHandle handle);
+
+  /*
+   * Poll the counters of the named ACL stats every stats cycle for the
+   * next duration, e.g. while a dashboard is reading them. Stats nobody
+   * watches are only polled every --acl_stat_idle_interval_s. Safe to call
+   * from any thread.
+   */
+  void watchAclStats(
+      const std::vector<std::string>& names,
+      std::chrono::seconds duration);
   void refreshPostBcmStateChange(const StateDelta& delta);
 
   /* Functions to be called during stats collection (UpdateStatsThread) */
@@ -97,12 +109,23 @@ class BcmStatUpdater {
     BcmAclStatHandle handle;
     cfg::CounterType counterType;
   };
+  struct AclCounter {
+    std::string statName;
+    std::unique_ptr<MonotonicCounter> counter;
+    // Never polled yet if unset
+    std::chrono::steady_clock::time_point lastUpdated;
+  };
   folly::Synchronized<BcmHwTableStats> tableStats_;
+  // Only accessed from the stats thread
+  std::chrono::steady_clock::time_point lastTableStatsRefresh_;
   std::queue<BcmAclStatHandle> toBeRemovedAclStats_;
+  // ACL stat name and the counter to add for it
   std::queue<std::pair<std::string, AclCounterDescriptor>> toBeAddedAclStats_;
+  folly::Synchronized<std::map<AclCounterDescriptor, AclCounter>> aclStats_;
+  // When each watched ACL stat stops being watched
   folly::Synchronized<
-      std::map<AclCounterDescriptor, std::unique_ptr<MonotonicCounter>>>
-      aclStats_;
+      std::unordered_map<std::string, std::chrono::steady_clock::time_point>>
+      watchedAclStats_;
 };
 
 }} // facebook::fboss
@@ -18,6 +18,54 @@ namespace facebook { namespace fboss {
 
 folly::ThreadLocalPtr<BcmStats> BcmStats::stats_;
 
+const char* stateUpdatePhaseName(BcmStateUpdatePhase phase) {
+  switch (phase) {
+    case BcmStateUpdatePhase::DISABLED_PORTS:
+      return "disabled_ports";
+    case BcmStateUpdatePhase::LOAD_BALANCERS:
+      return "load_balancers";
+    case BcmStateUpdatePhase::REMOVED_ROUTES:
+      return "removed_routes";
+    case BcmStateUpdatePhase::REMOVED_INTERFACES:
+      return "removed_interfaces";
+    case BcmStateUpdatePhase::VLANS:
+      return "vlans";
+    case BcmStateUpdatePhase::INTERFACES:
+      return "interfaces";
+    case BcmStateUpdatePhase::QOS:
+      return "qos";
+    case BcmStateUpdatePhase::CONTROL_PLANE:
+      return "control_plane";
+    case BcmStateUpdatePhase::NEIGHBORS:
+      return "neighbors";
+    case BcmStateUpdatePhase::LABEL_FIB:
+      return "label_fib";
+    case BcmStateUpdatePhase::MIRRORS:
+      return "mirrors";
+    case BcmStateUpdatePhase::ACLS:
+      return "acls";
+    case BcmStateUpdatePhase::SFLOW:
+      return "sflow";
+    case BcmStateUpdatePhase::ROUTES:
+      return "routes";
+    case BcmStateUpdatePhase::AGGREGATE_PORTS:
+      return "aggregate_ports";
+    case BcmStateUpdatePhase::PORT_GROUPS:
+      return "port_groups";
+    case BcmStateUpdatePhase::PORTS:
+      return "ports";
+    case BcmStateUpdatePhase::REMOVED_MIRRORS:
+      return "removed_mirrors";
+    case BcmStateUpdatePhase::LINK_STATUS:
+      return "link_status";
+    case BcmStateUpdatePhase::ENABLED_PORTS:
+      return "enabled_ports";
+    case BcmStateUpdatePhase::NUM_PHASES:
+      break;
+  }
+  return "unknown";
+}
+
 BcmStats::BcmStats()
     : BcmStats(stats::ThreadCachedServiceData::get()->getThreadStats()) {
 }
@@ -27,6 +75,8 @@ BcmStats::BcmStats(ThreadLocalStatsMap *map)
                   SUM, RATE),
       txPktFree_(map, SwitchStats::kCounterPrefix + "bcm.tx.pkt.freed",
                  SUM, RATE),
+      txPktPoolEmpty_(map, SwitchStats::kCounterPrefix +
+                      "bcm.tx.pkt.pool.empty", SUM, RATE),
       txSent_(map, SwitchStats::kCounterPrefix + "bcm.tx.pkt.sent",
               SUM, RATE),
       txSentDone_(map, SwitchStats::kCounterPrefix + "bcm.tx.pkt.sent.done",
@@ -37,6 +87,22 @@ BcmStats::BcmStats(ThreadLocalStatsMap *map)
           "bcm.tx.pkt.allocation.errors", SUM, RATE),
       txQueued_(map, SwitchStats::kCounterPrefix + "bcm.tx.pkt.queued_us",
                 100, 0, 1000),
+      txRingDepth_(map, SwitchStats::kCounterPrefix + "bcm.tx.ring.depth",
+                   10, 0, 10000),
+      txRingLatency_(map, SwitchStats::kCounterPrefix +
+                     "bcm.tx.ring.latency_us", 100, 0, 10000),
+      txRingBatch_(map, SwitchStats::kCounterPrefix + "bcm.tx.ring.batch",
+                   1, 0, 256),
+      txRingDrops_(map, SwitchStats::kCounterPrefix + "bcm.tx.ring.drops",
+                   SUM, RATE),
+      sflowSampleDrops_(map, SwitchStats::kCounterPrefix +
+                        "bcm.sflow.sample.drops", SUM, RATE),
+      sflowDatagrams_(map, SwitchStats::kCounterPrefix + "bcm.sflow.datagrams",
+                      SUM, RATE),
+      sflowDatagramSamples_(map, SwitchStats::kCounterPrefix +
+                            "bcm.sflow.datagram.samples", 1, 0, 64),
+      sflowSendErrors_(map, SwitchStats::kCounterPrefix +
+                       "bcm.sflow.send.errors", SUM, RATE),
       parityErrors_(map, SwitchStats::kCounterPrefix + "bcm.parity.errors",
                     SUM, RATE),
       corrParityErrors_(map, SwitchStats::kCounterPrefix + "bcm.parity.corr",
@@ -44,7 +110,44 @@ BcmStats::BcmStats(ThreadLocalStatsMap *map)
       uncorrParityErrors_(map, SwitchStats::kCounterPrefix +
                           "bcm.parity.uncorr", SUM, RATE),
       asicErrors_(map, SwitchStats::kCounterPrefix +
-                  "bcm.asic.error", SUM, RATE) {
+                  "bcm.asic.error", SUM, RATE),
+      routeInsertFailures_(map, SwitchStats::kCounterPrefix +
+                           "bcm.route.insert.failures", SUM, RATE),
+      fibCompressionFibChanges_(map, SwitchStats::kCounterPrefix +
+                                "bcm.fib_compression.fib_changes", SUM, RATE),
+      fibCompressionHwChanges_(map, SwitchStats::kCounterPrefix +
+                               "bcm.fib_compression.hw_changes", SUM, RATE),
+      ecmpGroupsMerged_(map, SwitchStats::kCounterPrefix +
+                        "bcm.ecmp.overflow.merged", SUM, RATE),
+      ecmpGroupsSinglePath_(map, SwitchStats::kCounterPrefix +
+                            "bcm.ecmp.overflow.single_path", SUM, RATE),
+      recursiveNextHopUpdates_(map, SwitchStats::kCounterPrefix +
+                               "bcm.recursive_next_hop.updates", SUM, RATE),
+      recursiveNextHopRoutes_(map, SwitchStats::kCounterPrefix +
+                              "bcm.recursive_next_hop.routes", SUM, RATE),
+      ecmpPruneUs_(map, SwitchStats::kCounterPrefix + "bcm.ecmp.prune_us",
+                   1000, 0, 100000),
+      portGroupReconfigureUs_(map, SwitchStats::kCounterPrefix +
+                              "bcm.port_group.reconfigure_us",
+                              100000, 0, 10000000),
+      portStatsCollectionUs_(map, SwitchStats::kCounterPrefix +
+                             "bcm.stats.port_collection_us",
+                             10000, 0, 1000000),
+      queueStatsCollectionUs_(map, SwitchStats::kCounterPrefix +
+                              "bcm.stats.queue_collection_us",
+                              100, 0, 10000),
+      globalStatsCollectionUs_(map, SwitchStats::kCounterPrefix +
+                               "bcm.stats.collection_us",
+                               10000, 0, 1000000) {
+  auto numPhases = static_cast<size_t>(BcmStateUpdatePhase::NUM_PHASES);
+  for (size_t i = 0; i < numPhases; ++i) {
+    auto prefix = SwitchStats::kCounterPrefix + "bcm.state_update." +
+        stateUpdatePhaseName(static_cast<BcmStateUpdatePhase>(i));
+    stateUpdatePhaseUs_.push_back(std::make_unique<TLHistogram>(
+        map, prefix + ".us", 50000, 0, 1000000));
+    stateUpdatePhaseObjects_.push_back(std::make_unique<TLHistogram>(
+        map, prefix + ".objects", 100, 0, 10000));
+  }
 }
 
 BcmStats* BcmStats::createThreadStats() {
@@ -12,8 +12,41 @@
 #include "common/stats/ThreadCachedServiceData.h"
 #include <folly/ThreadLocal.h>
 
+#include <chrono>
+#include <memory>
+#include <vector>
+
 namespace facebook { namespace fboss {
 
+/*
+ * The phases of BcmSwitch::stateChangedImpl(), in the order they run.
+ */
+enum class BcmStateUpdatePhase {
+  DISABLED_PORTS,
+  LOAD_BALANCERS,
+  REMOVED_ROUTES,
+  REMOVED_INTERFACES,
+  VLANS,
+  INTERFACES,
+  QOS,
+  CONTROL_PLANE,
+  NEIGHBORS,
+  LABEL_FIB,
+  MIRRORS,
+  ACLS,
+  SFLOW,
+  ROUTES,
+  AGGREGATE_PORTS,
+  PORT_GROUPS,
+  PORTS,
+  REMOVED_MIRRORS,
+  LINK_STATUS,
+  ENABLED_PORTS,
+  NUM_PHASES
+};
+
+const char* stateUpdatePhaseName(BcmStateUpdatePhase phase);
+
 class BcmStats {
  public:
   BcmStats();
@@ -38,6 +71,10 @@ class BcmStats {
   void txPktFree() {
     txPktFree_.addValue(1);
   }
+  // No pooled buffer of the right size, one came from the SDK instead
+  void txPktPoolEmpty() {
+    txPktPoolEmpty_.addValue(1);
+  }
   void txSent() {
     txSent_.addValue(1);
   }
@@ -45,6 +82,30 @@ class BcmStats {
     txSentDone_.addValue(1);
     txQueued_.addValue(q);
   }
+  // BcmTxRing
+  void txRingDepth(size_t depth) {
+    txRingDepth_.addValue(depth);
+  }
+  void txRingLatency(std::chrono::microseconds us) {
+    txRingLatency_.addValue(us.count());
+  }
+  void txRingBatch(int packets) {
+    txRingBatch_.addValue(packets);
+  }
+  void txRingDrop() {
+    txRingDrops_.addValue(1);
+  }
+  // BcmSflowExporterTable
+  void sflowSampleDrop() {
+    sflowSampleDrops_.addValue(1);
+  }
+  void sflowDatagram(int samples) {
+    sflowDatagrams_.addValue(1);
+    sflowDatagramSamples_.addValue(samples);
+  }
+  void sflowSendError() {
+    sflowSendErrors_.addValue(1);
+  }
   void txError() {
     txErrors_.addValue(1);
   }
@@ -67,6 +128,72 @@ class BcmStats {
     asicErrors_.addValue(1);
   }
 
+  /*
+   * Record how long one phase of a hardware state update took, and how many
+   * objects (ports, routes, neighbors, ...) it had to look at.
+   */
+  void stateUpdatePhase(
+      BcmStateUpdatePhase phase,
+      std::chrono::microseconds us,
+      uint64_t objects) {
+    auto idx = static_cast<size_t>(phase);
+    stateUpdatePhaseUs_[idx]->addValue(us.count());
+    stateUpdatePhaseObjects_[idx]->addValue(objects);
+  }
+
+  // A route the hardware did not take
+  void routeInsertFailure() {
+    routeInsertFailures_.addValue(1);
+  }
+
+  // FIB route changes, and the hardware route changes --fib_compression
+  // turned them into
+  void fibCompressed(uint64_t fibChanges, uint64_t hwChanges) {
+    fibCompressionFibChanges_.addValue(fibChanges);
+    fibCompressionHwChanges_.addValue(hwChanges);
+  }
+
+  // Routes spilled onto an existing ECMP group, or onto a single path, for
+  // lack of a new ECMP group
+  void ecmpGroupMerged() {
+    ecmpGroupsMerged_.addValue(1);
+  }
+  void ecmpGroupSinglePath() {
+    ecmpGroupsSinglePath_.addValue(1);
+  }
+
+  // Recursive next hops resolved in place, and the routes that kept their
+  // egress through it
+  void recursiveNextHopUpdated(long routes) {
+    recursiveNextHopUpdates_.addValue(1);
+    recursiveNextHopRoutes_.addValue(routes);
+  }
+
+  // Time taken to prune down egresses from all ECMP groups on link down
+  void ecmpPruned(std::chrono::microseconds us) {
+    ecmpPruneUs_.addValue(us.count());
+  }
+
+  // Time spent changing the lane mode of one flex port group
+  void portGroupReconfigured(std::chrono::microseconds us) {
+    portGroupReconfigureUs_.addValue(us.count());
+  }
+
+  // Time taken to collect the hardware counters of all ports
+  void portStatsCollected(std::chrono::microseconds us) {
+    portStatsCollectionUs_.addValue(us.count());
+  }
+
+  // Time taken to collect the queue counters of one port
+  void queueStatsCollected(std::chrono::microseconds us) {
+    queueStatsCollectionUs_.addValue(us.count());
+  }
+
+  // Time taken to collect all hardware stats in one updateGlobalStats() pass
+  void globalStatsCollected(std::chrono::microseconds us) {
+    globalStatsCollectionUs_.addValue(us.count());
+  }
+
  private:
   // Forbidden copy constructor and assignment operator
   BcmStats(BcmStats const &) = delete;
@@ -86,6 +213,7 @@ class BcmStats {
   // Total number of Tx packet allocated right now
   TLTimeseries txPktAlloc_;
   TLTimeseries txPktFree_;
+  TLTimeseries txPktPoolEmpty_;
   TLTimeseries txSent_;
   TLTimeseries txSentDone_;
   // Errors in sending packets
@@ -95,6 +223,23 @@ class BcmStats {
   // Time spent for each Tx packet queued in HW
   TLHistogram txQueued_;
 
+  // Packets waiting in the BcmTxRing, sampled on each enqueue
+  TLHistogram txRingDepth_;
+  // Time from enqueue on the BcmTxRing until handed to the SDK
+  TLHistogram txRingLatency_;
+  // Packets handed to the SDK per BcmTxRing wakeup
+  TLHistogram txRingBatch_;
+  // Packets dropped because the BcmTxRing was full
+  TLTimeseries txRingDrops_;
+
+  // sFlow samples dropped because the export queue was full
+  TLTimeseries sflowSampleDrops_;
+  // sFlow datagrams built, and the flow samples packed into each
+  TLTimeseries sflowDatagrams_;
+  TLHistogram sflowDatagramSamples_;
+  // sFlow datagrams a collector socket did not take
+  TLTimeseries sflowSendErrors_;
+
   // parity errors
   TLTimeseries parityErrors_;
   TLTimeseries corrParityErrors_;
@@ -103,6 +248,36 @@ class BcmStats {
   // Other ASIC errors
   TLTimeseries asicErrors_;
 
+  // Routes the hardware did not take
+  TLTimeseries routeInsertFailures_;
+
+  // With --fib_compression, their ratio is the update amplification
+  TLTimeseries fibCompressionFibChanges_;
+  TLTimeseries fibCompressionHwChanges_;
+
+  // ECMP group overflow spills
+  TLTimeseries ecmpGroupsMerged_;
+  TLTimeseries ecmpGroupsSinglePath_;
+
+  // Recursive next hops updated in place on underlay changes
+  TLTimeseries recursiveNextHopUpdates_;
+  TLTimeseries recursiveNextHopRoutes_;
+
+  // Time spent pruning ECMP groups on link down
+  TLHistogram ecmpPruneUs_;
+
+  // Time spent reconfiguring flex port groups
+  TLHistogram portGroupReconfigureUs_;
+
+  // Time spent collecting hardware stats
+  TLHistogram portStatsCollectionUs_;
+  TLHistogram queueStatsCollectionUs_;
+  TLHistogram globalStatsCollectionUs_;
+
+  // Time spent, and objects processed, in each BcmStateUpdatePhase
+  std::vector<std::unique_ptr<TLHistogram>> stateUpdatePhaseUs_;
+  std::vector<std::unique_ptr<TLHistogram>> stateUpdatePhaseObjects_;
+
   static folly::ThreadLocalPtr<BcmStats> stats_;
 };
 
@@ -9,21 +9,30 @@
  */
 #include "fboss/agent/hw/bcm/BcmSwitch.h"
 
+#include <algorithm>
 #include <fstream>
+#include <future>
+#include <set>
+#include <tuple>
 
 #include <boost/cast.hpp>
+#include <boost/container/flat_set.hpp>
 #include <folly/Conv.h>
 #include <folly/FileUtil.h>
 #include <folly/Memory.h>
 #include <folly/Optional.h>
 #include <folly/hash/Hash.h>
 #include <folly/logging/xlog.h>
+#include "common/stats/ServiceData.h"
 #include "common/time/Time.h"
+#include "fboss/agent/BootTrace.h"
 #include "fboss/agent/Constants.h"
 #include "fboss/agent/FbossError.h"
+#include "fboss/agent/RestartTimeTracker.h"
 #include "fboss/agent/SwSwitch.h"
 #include "fboss/agent/SwitchStats.h"
 #include "fboss/agent/Utils.h"
+#include "fboss/agent/hw/BufferCongestionTracker.h"
 #include "fboss/agent/hw/BufferStatsLogger.h"
 #include "fboss/agent/hw/bcm/BcmAPI.h"
 #include "fboss/agent/hw/bcm/BcmAclTable.h"
@@ -41,19 +50,25 @@
 #include "fboss/agent/hw/bcm/BcmPlatform.h"
 #include "fboss/agent/hw/bcm/BcmPort.h"
 #include "fboss/agent/hw/bcm/BcmPortGroup.h"
+#include "fboss/agent/hw/bcm/BcmPortFastSampler.h"
 #include "fboss/agent/hw/bcm/BcmPortTable.h"
 #include "fboss/agent/hw/bcm/BcmQosPolicyTable.h"
 #include "fboss/agent/hw/bcm/BcmRoute.h"
 #include "fboss/agent/hw/bcm/BcmRtag7LoadBalancer.h"
 #include "fboss/agent/hw/bcm/BcmRxPacket.h"
+#include "fboss/agent/hw/bcm/BcmSdkTracer.h"
 #include "fboss/agent/hw/bcm/BcmSflowExporter.h"
 #include "fboss/agent/hw/bcm/BcmStatUpdater.h"
+#include "fboss/agent/hw/bcm/BcmStats.h"
 #include "fboss/agent/hw/bcm/BcmSwitchEventCallback.h"
 #include "fboss/agent/hw/bcm/BcmSwitchEventUtils.h"
 #include "fboss/agent/hw/bcm/BcmTableStats.h"
 #include "fboss/agent/hw/bcm/BcmTrunkTable.h"
 #include "fboss/agent/hw/bcm/BcmTxPacket.h"
+#include "fboss/agent/hw/bcm/BcmTxPacketPool.h"
+#include "fboss/agent/hw/bcm/BcmTxRing.h"
 #include "fboss/agent/hw/bcm/BcmUnit.h"
+#include "fboss/agent/hw/bcm/BcmVlanPortUpdate.h"
 #include "fboss/agent/hw/bcm/BcmWarmBootCache.h"
 #include "fboss/agent/hw/bcm/BcmWarmBootState.h"
 #include "fboss/agent/hw/bcm/BcmWarmBootHelper.h"
@@ -61,6 +76,7 @@
 #include "fboss/agent/state/AclEntry.h"
 #include "fboss/agent/state/AggregatePort.h"
 #include "fboss/agent/state/ArpEntry.h"
+#include "fboss/agent/state/ControlPlane.h"
 #include "fboss/agent/state/DeltaFunctions.h"
 #include "fboss/agent/state/ForwardingInformationBase.h"
 #include "fboss/agent/state/ForwardingInformationBaseContainer.h"
@@ -74,6 +90,7 @@
 #include "fboss/agent/state/NodeMapDelta.h"
 #include "fboss/agent/state/Port.h"
 #include "fboss/agent/state/PortMap.h"
+#include "fboss/agent/state/QosPolicy.h"
 #include "fboss/agent/state/Route.h"
 #include "fboss/agent/state/RouteDelta.h"
 #include "fboss/agent/state/RouteTable.h"
@@ -116,13 +133,46 @@ using namespace std::chrono;
 
 DEFINE_int32(linkscan_interval_us, 250000,
              "The Broadcom linkscan interval");
+DEFINE_int32(
+    linkscan_coalesce_ms,
+    1,
+    "Wait this long after a link changes for other ports to change with it, "
+    "and handle them all as one update. 0 handles each as soon as possible");
 DEFINE_bool(flexports, false,
             "Load the agent with flexport support enabled");
 DEFINE_int32(
     update_bststats_interval_s,
     60,
     "Update BST stats for ODS interval in seconds");
+DEFINE_bool(
+    bcm_bst_event_driven,
+    false,
+    "Only read BST stats after a BST threshold trigger, and while queues "
+    "stay congested, recording congestion events for "
+    "getBufferCongestionEvents()");
+DEFINE_int64(
+    bcm_bst_congestion_threshold_bytes,
+    1 << 20,
+    "Queue buffer use that counts as congestion with --bcm_bst_event_driven");
+DEFINE_int32(
+    bcm_bst_congestion_events,
+    1024,
+    "Number of recent buffer congestion events to keep");
 DEFINE_bool(force_init_fp, true, "Force full field processor initialization");
+DEFINE_int32(
+    slow_hw_update_ms,
+    1000,
+    "Log the slowest phase of hardware state updates taking this long");
+DEFINE_int32(
+    bcm_tx_ring_depth,
+    0,
+    "Queue asynchronously sent packets on a tx ring of this many packets, "
+    "sent to the SDK from its own thread. 0 sends them on the caller's thread");
+DEFINE_bool(
+    fib_compression,
+    false,
+    "Program the smallest set of routes that forwards like the FIB, merging "
+    "adjacent routes with the same next hops. Only set at startup");
 
 enum : uint8_t {
   kRxCallbackPriority = 1,
@@ -136,6 +186,9 @@ constexpr int kLogBcmErrorFreqMs = 3000;
  */
 constexpr folly::StringPiece kAlpmSetting = "l3_alpm_enable";
 
+// The BcmSwitch lock domains the calling thread holds, one bit per domain
+thread_local uint32_t heldLockDomains = 0;
+
 void rethrowIfHwNotFull(const facebook::fboss::BcmError& error) {
   if (error.getBcmError() != OPENNSL_E_FULL) {
     // If this is not because of TCAM being full, rethrow the exception.
@@ -158,6 +211,67 @@ bool bothStandAloneRibOrRouteTableRibUsed(
     const facebook::fboss::StateDelta& delta) {
   return routeTableModified(delta) && fibModified(delta);
 }
+
+template <typename DeltaT>
+uint64_t numChanges(const DeltaT& delta) {
+  uint64_t count = 0;
+  for (auto itr = delta.begin(); itr != delta.end(); ++itr) {
+    ++count;
+  }
+  return count;
+}
+
+uint64_t numNeighborChanges(const facebook::fboss::StateDelta& delta) {
+  uint64_t count = 0;
+  for (const auto& vlanDelta : delta.getVlansDelta()) {
+    count += numChanges(vlanDelta.getArpDelta()) +
+        numChanges(vlanDelta.getNdpDelta());
+  }
+  return count;
+}
+
+/*
+ * Times each phase of a hardware state update into the BcmStats phase
+ * histograms, and remembers the slowest one so that a slow update can say
+ * where the time went.
+ */
+class StateUpdatePhaseTimer {
+ public:
+  using Phase = facebook::fboss::BcmStateUpdatePhase;
+
+  template <typename Fn>
+  void time(Phase phase, uint64_t objects, Fn&& fn) {
+    auto start = steady_clock::now();
+    fn();
+    auto elapsed =
+        duration_cast<microseconds>(steady_clock::now() - start);
+    facebook::fboss::BcmStats::get()->stateUpdatePhase(
+        phase, elapsed, objects);
+    total_ += elapsed;
+    if (elapsed >= slowest_) {
+      slowest_ = elapsed;
+      slowestPhase_ = phase;
+      slowestObjects_ = objects;
+    }
+  }
+
+  void logIfSlow() const {
+    if (total_ < milliseconds(FLAGS_slow_hw_update_ms)) {
+      return;
+    }
+    XLOG(WARNING) << "Hardware state update took " << total_.count()
+                  << "us, dominated by "
+                  << facebook::fboss::stateUpdatePhaseName(slowestPhase_)
+                  << " which took " << slowest_.count() << "us for "
+                  << slowestObjects_ << " objects";
+  }
+
+ private:
+  microseconds total_{0};
+  microseconds slowest_{0};
+  Phase slowestPhase_{Phase::DISABLED_PORTS};
+  uint64_t slowestObjects_{0};
+};
 }
 
 namespace facebook { namespace fboss {
@@ -171,6 +285,70 @@ bool BcmSwitch::getPortFECEnabled(PortID port) const {
   return getPortTable()->getBcmPort(port)->isFECEnabled();
 }
 
+std::map<PortID, HwPortStats> BcmSwitch::getPortStats() const {
+  std::map<PortID, HwPortStats> portStats;
+  for (const auto& entry : *getPortTable()) {
+    portStats.emplace(entry.first, entry.second->getPortStats());
+  }
+  return portStats;
+}
+
+void BcmSwitch::setPortFastSampling(
+    const std::vector<PortID>& ports,
+    std::chrono::milliseconds interval) {
+  std::shared_ptr<BcmPortFastSampler> sampler;
+  if (!ports.empty()) {
+    if (interval.count() < 1 || interval.count() > 1000) {
+      throw FbossError(
+          "fast port sampling interval must be between 1 and 1000ms, got ",
+          interval.count());
+    }
+    std::map<opennsl_port_t, PortID> bcmPorts;
+    for (auto port : ports) {
+      // relies on getBcmPort() to throw if not found
+      bcmPorts.emplace(getPortTable()->getBcmPort(port)->getBcmPortId(), port);
+    }
+    sampler = std::make_shared<BcmPortFastSampler>(unit_, bcmPorts, interval);
+  }
+  // The old sampler waits for its thread to finish when destroyed, so let
+  // that happen after releasing the lock
+  portFastSampler_.wlock()->swap(sampler);
+}
+
+PortFastSamples BcmSwitch::getPortFastSamples(PortID port) const {
+  auto sampler = portFastSampler_.copy();
+  if (!sampler) {
+    throw FbossError("fast port sampling is not enabled");
+  }
+  return sampler->getSamples(getPortTable()->getBcmPort(port)->getBcmPortId());
+}
+
+void BcmSwitch::watchAclStats(
+    const std::vector<std::string>& statNames,
+    std::chrono::seconds duration) {
+  if (duration.count() < 1 || duration.count() > 3600) {
+    throw FbossError(
+        "ACL stat watch duration must be between 1 and 3600s, got ",
+        duration.count());
+  }
+  bcmStatUpdater_->watchAclStats(statNames, duration);
+}
+
+std::vector<BufferCongestionEvent> BcmSwitch::getBufferCongestionEvents()
+    const {
+  if (!bufferCongestionTracker_) {
+    throw FbossError("buffer congestion events need --bcm_bst_event_driven");
+  }
+  return bufferCongestionTracker_->getEvents();
+}
+
+HwApiTrace BcmSwitch::getHwApiTrace() const {
+  if (!BcmSdkTracer::enabled()) {
+    throw FbossError("SDK call tracing needs --bcm_sdk_trace");
+  }
+  return BcmSdkTracer::get()->dump();
+}
+
 cfg::PortSpeed BcmSwitch::getPortMaxSpeed(PortID port) const {
   return getPortTable()->getBcmPort(port)->getMaxSpeed();
 }
@@ -194,23 +372,63 @@ BcmSwitch::BcmSwitch(BcmPlatform* platform, uint32_t featuresDesired)
       qosPolicyTable_(new BcmQosPolicyTable(this)),
       aclTable_(new BcmAclTable(this)),
       trunkTable_(new BcmTrunkTable(this)),
-      sFlowExporterTable_(new BcmSflowExporterTable()),
+      sFlowExporterTable_(new BcmSflowExporterTable(sflowRateProgrammer())),
       rtag7LoadBalancer_(new BcmRtag7LoadBalancer(this)),
       mirrorTable_(new BcmMirrorTable(this)),
       bstStatsMgr_(new BcmBstStatsMgr(this)) {
+  if (FLAGS_bcm_bst_event_driven) {
+    bstTriggerCallback_ = std::make_shared<BcmBstTriggerCallback>();
+    bufferCongestionTracker_ = std::make_unique<BufferCongestionTracker>(
+        FLAGS_bcm_bst_congestion_threshold_bytes,
+        FLAGS_bcm_bst_congestion_events);
+  }
   exportSdkVersion();
 }
 
 BcmSwitch::~BcmSwitch() {
   XLOG(ERR) << "Destroying BcmSwitch";
+  // Sends whatever is still on the ring
+  txRing_.reset();
   resetTables();
+  BcmTxPacketPool::get()->clear();
   unitObject_->detachAndCleanupSDKUnit();
 }
 
+BcmSwitch::DomainLock::DomainLock(BcmSwitch* sw, LockDomain domain)
+    : bit_(1u << static_cast<uint32_t>(domain)),
+      guard_(sw->domainMutex(domain), std::defer_lock) {
+  // Every domain already held must come before this one
+  DCHECK_LT(heldLockDomains, bit_)
+      << "BcmSwitch lock domain " << static_cast<int>(domain)
+      << " taken out of order";
+  guard_.lock();
+  heldLockDomains |= bit_;
+}
+
+BcmSwitch::DomainLock::~DomainLock() {
+  heldLockDomains &= ~bit_;
+}
+
+std::mutex& BcmSwitch::domainMutex(LockDomain domain) {
+  switch (domain) {
+    case LockDomain::PROGRAMMING:
+      return lock_;
+    case LockDomain::PORTS:
+      return portsLock_;
+    case LockDomain::L3:
+      return l3Lock_;
+    case LockDomain::ACLS:
+      return aclLock_;
+  }
+  throw FbossError("Unknown BcmSwitch lock domain");
+}
+
 void BcmSwitch::resetTables() {
-  std::unique_lock<std::mutex> lk(lock_);
+  DomainLock g(this, LockDomain::PROGRAMMING);
   unregisterCallbacks();
   routeTable_.reset();
+  fibCompressorsV4_.clear();
+  fibCompressorsV6_.clear();
   labelMap_.reset();
   l3NextHopTable_.reset();
   mplsNextHopTable_.reset();
@@ -228,6 +446,7 @@ void BcmSwitch::resetTables() {
   multiPathNextHopTable_.reset();
   hostTable_.reset();
   toCPUEgress_.reset();
+  portFastSampler_.wlock()->reset();
   portTable_.reset();
   qosPolicyTable_.reset();
   aclTable_->releaseAcls();
@@ -244,7 +463,7 @@ void BcmSwitch::resetTables() {
 }
 
 void BcmSwitch::initTables(const folly::dynamic& warmBootState) {
-  std::lock_guard<std::mutex> g(lock_);
+  DomainLock g(this, LockDomain::PROGRAMMING);
   bcmStatUpdater_ = std::make_unique<BcmStatUpdater>(this, isAlpmEnabled());
   portTable_ = std::make_unique<BcmPortTable>(this);
   qosPolicyTable_ = std::make_unique<BcmQosPolicyTable>(this);
@@ -260,7 +479,8 @@ void BcmSwitch::initTables(const folly::dynamic& warmBootState) {
   routeTable_ = std::make_unique<BcmRouteTable>(this);
   aclTable_ = std::make_unique<BcmAclTable>(this);
   trunkTable_ = std::make_unique<BcmTrunkTable>(this);
-  sFlowExporterTable_ = std::make_unique<BcmSflowExporterTable>();
+  sFlowExporterTable_ =
+      std::make_unique<BcmSflowExporterTable>(sflowRateProgrammer());
   controlPlane_ = std::make_unique<BcmControlPlane>(this);
   rtag7LoadBalancer_ = std::make_unique<BcmRtag7LoadBalancer>(this);
   mirrorTable_ = std::make_unique<BcmMirrorTable>(this);
@@ -314,8 +534,9 @@ void BcmSwitch::gracefulExit(folly::dynamic& switchState) {
   // this is a concern, this can be moved to the updateEventBase_ of SwSwitch.
   portTable_->preparePortsForGracefulExit();
   bstStatsMgr_->stopBufferStatCollection();
+  portFastSampler_.wlock()->reset();
 
-  std::lock_guard<std::mutex> g(lock_);
+  DomainLock g(this, LockDomain::PROGRAMMING);
 
   // This will run some common shell commands to give more info about
   // the underlying bcm sdk state
@@ -334,12 +555,12 @@ folly::dynamic BcmSwitch::toFollyDynamic() const {
 }
 
 void BcmSwitch::clearWarmBootCache() {
-  std::lock_guard<std::mutex> g(lock_);
+  DomainLock g(this, LockDomain::PROGRAMMING);
   warmBootCache_->clear();
 }
 
 void BcmSwitch::switchRunStateChanged(SwitchRunState newState) {
-  std::lock_guard<std::mutex> g(lock_);
+  DomainLock g(this, LockDomain::PROGRAMMING);
   switch (newState) {
     case SwitchRunState::INITIALIZED:
       setupLinkscan();
@@ -389,6 +610,7 @@ std::shared_ptr<SwitchState> BcmSwitch::getColdBootSwitchState() const {
 }
 
 std::shared_ptr<SwitchState> BcmSwitch::applyAndGetWarmBootSwitchState() {
+  boot_trace::Span span("BcmSwitch::applyAndGetWarmBootSwitchState");
   auto warmBootState =  warmBootCache_->getDumpedSwSwitchState().clone();
   warmBootState->publish();
   // Force port/queue stat counter creation by initializing currState to
@@ -448,13 +670,17 @@ void BcmSwitch::setupLinkscan() {
 }
 
 HwInitResult BcmSwitch::init(Callback* callback) {
+  boot_trace::Span span("BcmSwitch::init");
   HwInitResult ret;
 
-  std::lock_guard<std::mutex> g(lock_);
+  DomainLock g(this, LockDomain::PROGRAMMING);
 
   steady_clock::time_point begin = steady_clock::now();
   CHECK(!unitObject_);
-  unitObject_ = BcmAPI::initOnlyUnit(platform_);
+  {
+    boot_trace::Span unitSpan("BcmAPI::initOnlyUnit");
+    unitObject_ = BcmAPI::initOnlyUnit(platform_);
+  }
   unit_ = unitObject_->getNumber();
   unitObject_->setCookie(this);
 
@@ -463,9 +689,13 @@ HwInitResult BcmSwitch::init(Callback* callback) {
       : BootType::COLD_BOOT;
   auto warmBoot = bootType_ == BootType::WARM_BOOT;
   callback_ = callback;
+  if (FLAGS_bcm_tx_ring_depth > 0) {
+    txRing_ = std::make_unique<BcmTxRing>(FLAGS_bcm_tx_ring_depth);
+  }
 
   // Possibly run pre-init bcm shell script before ASIC init.
   runBcmScriptPreAsicInit();
+  restart_time::mark(RestartEvent::ASIC_INITIALIZED);
 
   ret.initializedTime =
     duration_cast<duration<float>>(steady_clock::now() - begin).count();
@@ -487,6 +717,10 @@ HwInitResult BcmSwitch::init(Callback* callback) {
       unit_, OPENNSL_SWITCH_EVENT_WARM_BOOT_DOWNGRADE, fatalCob);
   BcmSwitchEventUtils::registerSwitchEventCallback(
       unit_, OPENNSL_SWITCH_EVENT_PARITY_ERROR, nonFatalCob);
+  if (bstTriggerCallback_) {
+    BcmSwitchEventUtils::registerSwitchEventCallback(
+        unit_, OPENNSL_SWITCH_EVENT_MMU_BST_TRIGGER, bstTriggerCallback_);
+  }
 
   // Create bcmStatUpdater to cache the stat ids
   bcmStatUpdater_ = std::make_unique<BcmStatUpdater>(this, isAlpmEnabled());
@@ -536,6 +770,7 @@ HwInitResult BcmSwitch::init(Callback* callback) {
   bcmCheckError(rv, "failed to set NDP trapping");
 
   if (FLAGS_force_init_fp || !warmBoot || haveMissingOrQSetChangedFPGroups()) {
+    boot_trace::Span fpSpan("BcmSwitch::setupFPGroups");
     initFieldProcessor();
     setupFPGroups();
   }
@@ -557,16 +792,26 @@ HwInitResult BcmSwitch::init(Callback* callback) {
   // verify the drop egress ID is really dropping
   BcmEgress::verifyDropEgress(unit_);
 
+  std::future<void> warmBootCachePopulated;
   if (warmBoot) {
     // This needs to be done after we have set
     // opennslSwitchL3EgressMode else the egress ids
     // in the host table don't show up correctly.
-    warmBootCache_->populate();
+    //
+    // It only reads the L3, vlan, ACL and mirror tables, which the port,
+    // queue and trunk setup below leave alone, so do that meanwhile.
+    warmBootCachePopulated = std::async(
+        std::launch::async, [this]() { warmBootCache_->populate(); });
+  }
+  {
+    boot_trace::Span portsSpan("BcmPortTable::initPorts");
+    portTable_->initPorts(&pcfg, warmBoot);
   }
-  setupToCpuEgress();
-  portTable_->initPorts(&pcfg, warmBoot);
 
-  setupCos();
+  {
+    boot_trace::Span cosSpan("BcmSwitch::setupCos");
+    setupCos();
+  }
   configureRxRateLimiting();
 
   bstStatsMgr_->startBufferStatCollection();
@@ -584,6 +829,15 @@ HwInitResult BcmSwitch::init(Callback* callback) {
     rv = opennsl_stg_stp_set(unit_, stg, idx, OPENNSL_STG_STP_FORWARD);
     bcmCheckError(rv, "failed to set spanning tree state on port ", idx);
   }
+  restart_time::mark(RestartEvent::PORTS_INITIALIZED);
+
+  if (warmBootCachePopulated.valid()) {
+    boot_trace::Span waitSpan("wait for BcmWarmBootCache::populate");
+    // The ToCPU egress is claimed from the cache. This also rethrows any
+    // error populating it.
+    warmBootCachePopulated.get();
+  }
+  setupToCpuEgress();
 
   ret.bootType = bootType_;
 
@@ -652,12 +906,35 @@ void BcmSwitch::setupPacketRx() {
 
 std::shared_ptr<SwitchState> BcmSwitch::stateChanged(const StateDelta& delta) {
   // Take the lock before modifying any objects
-  std::lock_guard<std::mutex> g(lock_);
+  DomainLock g(this, LockDomain::PROGRAMMING);
   auto appliedState = stateChangedImpl(delta);
   appliedState->publish();
   return appliedState;
 }
 
+template <typename AddrT>
+void BcmSwitch::exportFibCompressionStats(
+    const BcmRouteDeltaSummary::FibCompressors<AddrT>& compressors,
+    const std::string& prefix) const {
+  size_t numRoutes = 0;
+  size_t numEntries = 0;
+  for (const auto& vrfAndCompressor : compressors) {
+    numRoutes += vrfAndCompressor.second->numRoutes();
+    numEntries += vrfAndCompressor.second->numEntries();
+  }
+  fbData->setCounter(prefix + "routes", numRoutes);
+  fbData->setCounter(prefix + "entries", numEntries);
+  // Hardware entries per 100 FIB routes
+  fbData->setCounter(
+      prefix + "entries_pct", numRoutes ? numEntries * 100 / numRoutes : 100);
+}
+
+void BcmSwitch::exportFibCompressionStats() const {
+  auto prefix = SwitchStats::kCounterPrefix + "bcm.fib_compression.";
+  exportFibCompressionStats(fibCompressorsV4_, prefix + "v4.");
+  exportFibCompressionStats(fibCompressorsV6_, prefix + "v6.");
+}
+
 std::shared_ptr<SwitchState> BcmSwitch::stateChangedImpl(
     const StateDelta& delta) {
   forEachAdded(delta.getPortsDelta(), [this](const auto& newPort) {
@@ -674,111 +951,206 @@ std::shared_ptr<SwitchState> BcmSwitch::stateChangedImpl(
   // StateDelta, and isn't particularly hardware-specific.  I plan to refactor
   // it, and move it out into a common helper class that can be shared by
   // many different HwSwitch implementations.
+  using Phase = BcmStateUpdatePhase;
+  StateUpdatePhaseTimer timer;
+  auto portChanges = numChanges(delta.getPortsDelta());
+  // One walk over the route deltas, for validating and programming them
+  BcmRouteDeltaSummary routes(
+      delta, getPlatform()->maxLabelStackDepth(), isAlpmEnabled());
+  if (FLAGS_fib_compression) {
+    auto fibChanges = routes.numFibChanges();
+    routes.compressFibs(&fibCompressorsV4_, &fibCompressorsV6_);
+    BcmStats::get()->fibCompressed(fibChanges, routes.numFibChanges());
+    exportFibCompressionStats();
+  }
+  auto routeChanges = routes.numChanges();
+  auto intfChanges = numChanges(delta.getIntfsDelta());
+  auto mirrorChanges = numChanges(delta.getMirrorsDelta());
 
   // As the first step, disable ports that are now disabled.
   // This ensures that we immediately stop forwarding traffic on these ports.
-  processDisabledPorts(delta);
+  timer.time(Phase::DISABLED_PORTS, portChanges, [&] {
+    DomainLock g(this, LockDomain::PORTS);
+    processDisabledPorts(delta);
+  });
 
-  processLoadBalancerChanges(delta);
+  timer.time(
+      Phase::LOAD_BALANCERS, numChanges(delta.getLoadBalancersDelta()), [&] {
+        DomainLock g(this, LockDomain::L3);
+        processLoadBalancerChanges(delta);
+      });
 
   CHECK(!bothStandAloneRibOrRouteTableRibUsed(delta));
 
   // remove all routes to be deleted
-  processRemovedRoutes(delta);
-  processRemovedFibRoutes(delta);
+  timer.time(Phase::REMOVED_ROUTES, routeChanges, [&] {
+    DomainLock g(this, LockDomain::L3);
+    processRemovedRoutes(routes.routeTables<folly::IPAddressV4>());
+    processRemovedRoutes(routes.routeTables<folly::IPAddressV6>());
+    processRemovedRoutes(routes.fibs<folly::IPAddressV4>());
+    processRemovedRoutes(routes.fibs<folly::IPAddressV6>());
+  });
 
   // delete all interface not existing anymore. that should stop
   // all traffic on that interface now
-  forEachRemoved(delta.getIntfsDelta(), &BcmSwitch::processRemovedIntf, this);
-
-  // Add all new VLANs, and modify VLAN port memberships.
-  // We don't actually delete removed VLANs at this point, we simply remove
-  // all members from the VLAN.  This way any ports that ingress packets to this
-  // VLAN will still use this VLAN until we get the new VLAN fully configured.
-  forEachChanged(delta.getVlansDelta(),
-                 &BcmSwitch::processChangedVlan,
-                 &BcmSwitch::processAddedVlan,
-                 &BcmSwitch::preprocessRemovedVlan,
-                 this);
-
-  // Broadcom requires a default VLAN to always exist.
-  // This VLAN is used as the default ingress VLAN for ports that don't have a
-  // default ingress set.
-  //
-  // We always specify the ingress VLAN for all enabled ports, so this VLAN is
-  // never really used for us.  We instead always point the default VLAN.
-  if (delta.oldState()->getDefaultVlan() !=
-      delta.newState()->getDefaultVlan()) {
-    changeDefaultVlan(delta.newState()->getDefaultVlan());
-  }
+  timer.time(Phase::REMOVED_INTERFACES, intfChanges, [&] {
+    DomainLock g(this, LockDomain::L3);
+    forEachRemoved(
+        delta.getIntfsDelta(), &BcmSwitch::processRemovedIntf, this);
+  });
 
-  // Update changed interfaces
-  forEachChanged(delta.getIntfsDelta(), &BcmSwitch::processChangedIntf, this);
+  timer.time(Phase::VLANS, numChanges(delta.getVlansDelta()), [&] {
+    DomainLock g(this, LockDomain::L3);
+    // Add all new VLANs, and modify VLAN port memberships.
+    // We don't actually delete removed VLANs at this point, we simply remove
+    // all members from the VLAN.  This way any ports that ingress packets to
+    // this VLAN will still use this VLAN until we get the new VLAN fully
+    // configured.
+    forEachChanged(
+        delta.getVlansDelta(),
+        &BcmSwitch::processChangedVlan,
+        &BcmSwitch::processAddedVlan,
+        &BcmSwitch::preprocessRemovedVlan,
+        this);
+
+    // Broadcom requires a default VLAN to always exist.
+    // This VLAN is used as the default ingress VLAN for ports that don't have
+    // a default ingress set.
+    //
+    // We always specify the ingress VLAN for all enabled ports, so this VLAN
+    // is never really used for us.  We instead always point the default VLAN.
+    if (delta.oldState()->getDefaultVlan() !=
+        delta.newState()->getDefaultVlan()) {
+      changeDefaultVlan(delta.newState()->getDefaultVlan());
+    }
+  });
 
-  // Remove deleted VLANs
-  forEachRemoved(delta.getVlansDelta(), &BcmSwitch::processRemovedVlan, this);
+  timer.time(Phase::INTERFACES, intfChanges, [&] {
+    DomainLock g(this, LockDomain::L3);
+    // Update changed interfaces
+    forEachChanged(
+        delta.getIntfsDelta(), &BcmSwitch::processChangedIntf, this);
+
+    // Remove deleted VLANs
+    forEachRemoved(
+        delta.getVlansDelta(), &BcmSwitch::processRemovedVlan, this);
 
-  // Add all new interfaces
-  forEachAdded(delta.getIntfsDelta(), &BcmSwitch::processAddedIntf, this);
+    // Add all new interfaces
+    forEachAdded(delta.getIntfsDelta(), &BcmSwitch::processAddedIntf, this);
+  });
 
   // Any changes to the Qos maps
-  processQosChanges(delta);
+  timer.time(Phase::QOS, numChanges(delta.getQosPoliciesDelta()), [&] {
+    DomainLock g(this, LockDomain::PORTS);
+    processQosChanges(delta);
+  });
 
-  processControlPlaneChanges(delta);
+  auto controlPlaneDelta = delta.getControlPlaneDelta();
+  timer.time(
+      Phase::CONTROL_PLANE,
+      controlPlaneDelta.getOld() != controlPlaneDelta.getNew() ? 1 : 0,
+      [&] {
+        DomainLock g(this, LockDomain::PORTS);
+        processControlPlaneChanges(delta);
+      });
 
   // Any neighbor changes, and modify appliedState if some changes fail to apply
-  processNeighborChanges(delta, &appliedState);
+  timer.time(Phase::NEIGHBORS, numNeighborChanges(delta), [&] {
+    DomainLock g(this, LockDomain::L3);
+    processNeighborChanges(delta, &appliedState);
+  });
 
   // process label forwarding changes after neighbor entries are updated
-  processChangedLabelForwardingInformationBase(delta);
+  timer.time(
+      Phase::LABEL_FIB,
+      numChanges(delta.getLabelForwardingInformationBaseDelta()),
+      [&] {
+        DomainLock g(this, LockDomain::L3);
+        processChangedLabelForwardingInformationBase(delta);
+      });
 
   // Add/update mirrors before processing Acl and port changes
   // This is to ensure that port and acls can access latest mirrors
-  forEachAdded(
-      delta.getMirrorsDelta(),
-      &BcmMirrorTable::processAddedMirror,
-      writableBcmMirrorTable());
-  forEachChanged(
-      delta.getMirrorsDelta(),
-      &BcmMirrorTable::processChangedMirror,
-      writableBcmMirrorTable());
+  timer.time(Phase::MIRRORS, mirrorChanges, [&] {
+    DomainLock g(this, LockDomain::ACLS);
+    forEachAdded(
+        delta.getMirrorsDelta(),
+        &BcmMirrorTable::processAddedMirror,
+        writableBcmMirrorTable());
+    forEachChanged(
+        delta.getMirrorsDelta(),
+        &BcmMirrorTable::processChangedMirror,
+        writableBcmMirrorTable());
+  });
 
   // Any ACL changes
-  processAclChanges(delta);
+  timer.time(Phase::ACLS, numChanges(delta.getAclsDelta()), [&] {
+    DomainLock g(this, LockDomain::ACLS);
+    processAclChanges(delta);
+  });
 
-  // Any changes to the set of sFlow collectors
-  processSflowCollectorChanges(delta);
+  timer.time(
+      Phase::SFLOW, numChanges(delta.getSflowCollectorsDelta()), [&] {
+        DomainLock g(this, LockDomain::PORTS);
+        // Any changes to the set of sFlow collectors
+        processSflowCollectorChanges(delta);
 
-  // Any changes to the sampling rate of sflow
-  processSflowSamplingRateChanges(delta);
+        // Any changes to the sampling rate of sflow
+        processSflowSamplingRateChanges(delta);
+      });
 
   // Process any new routes or route changes
-  processAddedChangedRoutes(delta, &appliedState);
-  processAddedChangedFibRoutes(delta, &appliedState);
+  timer.time(Phase::ROUTES, routeChanges, [&] {
+    DomainLock g(this, LockDomain::L3);
+    processAddedChangedRoutes(delta, routes, &appliedState);
+    processAddedChangedFibRoutes(routes);
+  });
 
-  processAggregatePortChanges(delta);
+  timer.time(
+      Phase::AGGREGATE_PORTS,
+      numChanges(delta.getAggregatePortsDelta()),
+      [&] {
+        DomainLock g(this, LockDomain::PORTS);
+        processAggregatePortChanges(delta);
+      });
 
   // Reconfigure port groups in case we are changing between using a port as
   // 1, 2 or 4 ports. Only do this if flexports are enabled
   if (FLAGS_flexports) {
-    reconfigurePortGroups(delta);
+    timer.time(Phase::PORT_GROUPS, portChanges, [&] {
+      DomainLock g(this, LockDomain::PORTS);
+      reconfigurePortGroups(delta);
+    });
   }
 
-  processChangedPorts(delta);
+  timer.time(Phase::PORTS, portChanges, [&] {
+    DomainLock g(this, LockDomain::PORTS);
+    processChangedPorts(delta);
+  });
 
   // delete any removed mirrors after processing port and acl changes
-  forEachRemoved(
-      delta.getMirrorsDelta(),
-      &BcmMirrorTable::processRemovedMirror,
-      writableBcmMirrorTable());
+  timer.time(Phase::REMOVED_MIRRORS, mirrorChanges, [&] {
+    DomainLock g(this, LockDomain::ACLS);
+    forEachRemoved(
+        delta.getMirrorsDelta(),
+        &BcmMirrorTable::processRemovedMirror,
+        writableBcmMirrorTable());
+  });
 
-  pickupLinkStatusChanges(delta);
+  timer.time(Phase::LINK_STATUS, portChanges, [&] {
+    DomainLock g(this, LockDomain::PORTS);
+    pickupLinkStatusChanges(delta);
+  });
 
   // As the last step, enable newly enabled ports.  Doing this as the
   // last step ensures that we only start forwarding traffic once the
   // ports are correctly configured. Note that this will also set the
   // ingressVlan and speed correctly before enabling.
-  processEnabledPorts(delta);
+  timer.time(Phase::ENABLED_PORTS, portChanges, [&] {
+    DomainLock g(this, LockDomain::PORTS);
+    processEnabledPorts(delta);
+  });
+  timer.logIfSlow();
 
   bcmStatUpdater_->refreshPostBcmStateChange(delta);
 
@@ -800,14 +1172,17 @@ unique_ptr<TxPacket> BcmSwitch::allocatePacket(uint32_t size) {
 }
 
 void BcmSwitch::processDisabledPorts(const StateDelta& delta) {
+  BcmVlanPortUpdate vlanUpdate;
   forEachChanged(delta.getPortsDelta(),
     [&] (const shared_ptr<Port>& oldPort, const shared_ptr<Port>& newPort) {
       if (oldPort->isEnabled() && !newPort->isEnabled()) {
         auto bcmPort = portTable_->getBcmPort(newPort->getID());
         XLOG(INFO) << "Disabling port: " << newPort->getID();
+        bcmPort->removeFromVlans(newPort, &vlanUpdate);
         bcmPort->disable(newPort);
       }
     });
+  vlanUpdate.apply(unit_);
 }
 
 void BcmSwitch::processEnabledPortQueues(const shared_ptr<Port>& port) {
@@ -822,9 +1197,24 @@ void BcmSwitch::processEnabledPortQueues(const shared_ptr<Port>& port) {
 }
 
 void BcmSwitch::processEnabledPorts(const StateDelta& delta) {
+  auto enabled = [](const shared_ptr<Port>& oldPort,
+                    const shared_ptr<Port>& newPort) {
+    return !oldPort->isEnabled() && newPort->isEnabled();
+  };
+  // Ports join their VLANs before any of them starts forwarding
+  BcmVlanPortUpdate vlanUpdate;
+  forEachChanged(delta.getPortsDelta(),
+    [&] (const shared_ptr<Port>& oldPort, const shared_ptr<Port>& newPort) {
+      if (enabled(oldPort, newPort)) {
+        portTable_->getBcmPort(newPort->getID())
+            ->addToVlans(newPort, &vlanUpdate);
+      }
+    });
+  vlanUpdate.apply(unit_);
+
   forEachChanged(delta.getPortsDelta(),
     [&] (const shared_ptr<Port>& oldPort, const shared_ptr<Port>& newPort) {
-      if (!oldPort->isEnabled() && newPort->isEnabled()) {
+      if (enabled(oldPort, newPort)) {
         auto bcmPort = portTable_->getBcmPort(newPort->getID());
         bcmPort->enable(newPort);
         processEnabledPortQueues(newPort);
@@ -858,14 +1248,21 @@ void BcmSwitch::processChangedPortQueues(
   // We expect the number of port queues to remain constant because this is
   // defined by the hardware
   for (const auto& newQueue : newPort->getPortQueues()) {
-    if (oldPort->getPortQueues().size() > 0 &&
-        *(oldPort->getPortQueues().at(newQueue->getID())) == *newQueue) {
+    if (oldPort->getPortQueues().empty()) {
+      XLOG(DBG1) << "New cos queue settings on port " << id << " queue "
+                 << static_cast<int>(newQueue->getID());
+      bcmPort->setupQueue(*newQueue);
+      continue;
+    }
+    const auto& oldQueue = oldPort->getPortQueues().at(newQueue->getID());
+    if (*oldQueue == *newQueue) {
       continue;
     }
 
-    XLOG(DBG1) << "New cos queue settings on port " << id << " queue "
+    // Only the settings that changed are written
+    XLOG(DBG1) << "Changed cos queue settings on port " << id << " queue "
                << static_cast<int>(newQueue->getID());
-    bcmPort->setupQueue(*newQueue);
+    bcmPort->getQueueManager()->programChanged(*oldQueue, *newQueue);
   }
 }
 
@@ -983,7 +1380,10 @@ void BcmSwitch::reconfigurePortGroups(const StateDelta& delta) {
   // those methods as enabling or changing the speed of a port may require
   // changing the configuration of a port group.
 
+  // Groups with several changed ports are only reconfigured once, and all of
+  // the groups together
   auto newState = delta.newState();
+  std::vector<BcmPortGroup*> portGroups;
   forEachChanged(delta.getPortsDelta(),
     [&] (const shared_ptr<Port>& oldPort, const shared_ptr<Port>& newPort) {
       auto enabled = !oldPort->isEnabled() && newPort->isEnabled();
@@ -999,11 +1399,14 @@ void BcmSwitch::reconfigurePortGroups(const StateDelta& delta) {
         }
         auto bcmPort = portTable_->getBcmPort(newPort->getID());
         auto portGroup = bcmPort->getPortGroup();
-        if (portGroup) {
-          portGroup->reconfigureIfNeeded(newState);
+        if (portGroup &&
+            std::find(portGroups.begin(), portGroups.end(), portGroup) ==
+                portGroups.end()) {
+          portGroups.push_back(portGroup);
         }
       }
     });
+  BcmPortGroup::reconfigureIfNeeded(portGroups, newState);
 }
 
 bool BcmSwitch::isValidPortUpdate(const shared_ptr<Port>& oldPort,
@@ -1021,55 +1424,6 @@ bool BcmSwitch::isValidPortUpdate(const shared_ptr<Port>& oldPort,
   return true;
 }
 
-template <typename AddrT>
-bool BcmSwitch::isRouteUpdateValid(const StateDelta& delta) const {
-  using RouteT = Route<AddrT>;
-
-  auto maxLabelStackDepth = getPlatform()->maxLabelStackDepth();
-  auto validateLabeledRoute = [maxLabelStackDepth](const auto& route) {
-    for (const auto& nhop : route->getForwardInfo().getNextHopSet()) {
-      if (!nhop.labelForwardingAction()) {
-        continue;
-      }
-      if (nhop.labelForwardingAction()->type() !=
-          LabelForwardingAction::LabelForwardingType::PUSH) {
-        return false;
-      } else {
-        if (nhop.labelForwardingAction()->pushStack()->size() >
-            maxLabelStackDepth) {
-          return false;
-        }
-      }
-    }
-    return true;
-  };
-
-  bool isValid = true;
-  for (const auto& rDelta : delta.getRouteTablesDelta()) {
-    forEachChanged(
-        rDelta.template getRoutesDelta<AddrT>(),
-        [&isValid, validateLabeledRoute](
-            const std::shared_ptr<RouteT>& /*oldRoute*/,
-            const std::shared_ptr<RouteT>& newRoute) {
-          if (!validateLabeledRoute(newRoute)) {
-            isValid = false;
-            return LoopAction::BREAK;
-          }
-          return LoopAction::CONTINUE;
-        },
-        [&isValid,
-         validateLabeledRoute](const std::shared_ptr<RouteT>& addedRoute) {
-          if (!validateLabeledRoute(addedRoute)) {
-            isValid = false;
-            return LoopAction::BREAK;
-          }
-          return LoopAction::CONTINUE;
-        },
-        [](const std::shared_ptr<RouteT>& /*removedRoute*/) {});
-  }
-  return isValid;
-}
-
 bool BcmSwitch::isValidStateUpdate(const StateDelta& delta) const {
   auto newState = delta.newState();
   auto isValid = true;
@@ -1111,8 +1465,10 @@ bool BcmSwitch::isValidStateUpdate(const StateDelta& delta) const {
         // removed Fn
       });
 
-  isValid = isValid && isRouteUpdateValid<folly::IPAddressV4>(delta);
-  isValid = isValid && isRouteUpdateValid<folly::IPAddressV6>(delta);
+  isValid = isValid &&
+      BcmRouteDeltaSummary(
+          delta, getPlatform()->maxLabelStackDepth(), false /* alpmOrder */)
+          .isValid();
 
   return isValid;
 }
@@ -1124,13 +1480,9 @@ void BcmSwitch::changeDefaultVlan(VlanID id) {
 
 void BcmSwitch::processChangedVlan(const shared_ptr<Vlan>& oldVlan,
                                    const shared_ptr<Vlan>& newVlan) {
-  // Update port membership
-  opennsl_pbmp_t addedPorts;
-  OPENNSL_PBMP_CLEAR(addedPorts);
-  opennsl_pbmp_t addedUntaggedPorts;
-  OPENNSL_PBMP_CLEAR(addedUntaggedPorts);
-  opennsl_pbmp_t removedPorts;
-  OPENNSL_PBMP_CLEAR(removedPorts);
+  // Update port membership, including ports that only changed tagging,
+  // which are taken out of the VLAN and put back in
+  BcmVlanPortUpdate update;
   const auto& oldPorts = oldVlan->getPorts();
   const auto& newPorts = newVlan->getPorts();
 
@@ -1138,42 +1490,39 @@ void BcmSwitch::processChangedVlan(const shared_ptr<Vlan>& oldVlan,
   auto newIter = newPorts.begin();
   uint32_t numAdded{0};
   uint32_t numRemoved{0};
+  uint32_t numRetagged{0};
   while (oldIter != oldPorts.end() || newIter != newPorts.end()) {
-    LoopAction action = LoopAction::CONTINUE;
     if (oldIter == oldPorts.end() ||
         (newIter != newPorts.end() && newIter->first < oldIter->first)) {
       // This port was added
       ++numAdded;
-      opennsl_port_t bcmPort = portTable_->getBcmPortId(newIter->first);
-      OPENNSL_PBMP_PORT_ADD(addedPorts, bcmPort);
-      if (!newIter->second.tagged) {
-        OPENNSL_PBMP_PORT_ADD(addedUntaggedPorts, bcmPort);
-      }
+      update.addPort(newVlan->getID(),
+                     portTable_->getBcmPortId(newIter->first),
+                     newIter->second.tagged);
       ++newIter;
     } else if (newIter == newPorts.end() ||
         (oldIter != oldPorts.end() && oldIter->first < newIter->first)) {
       // This port was removed
       ++numRemoved;
-      opennsl_port_t bcmPort = portTable_->getBcmPortId(oldIter->first);
-      OPENNSL_PBMP_PORT_ADD(removedPorts, bcmPort);
+      update.removePort(newVlan->getID(),
+                        portTable_->getBcmPortId(oldIter->first));
       ++oldIter;
     } else {
+      if (oldIter->second.tagged != newIter->second.tagged) {
+        ++numRetagged;
+        auto bcmPort = portTable_->getBcmPortId(newIter->first);
+        update.removePort(newVlan->getID(), bcmPort);
+        update.addPort(newVlan->getID(), bcmPort, newIter->second.tagged);
+      }
       ++oldIter;
       ++newIter;
     }
   }
 
   XLOG(DBG2) << "updating VLAN " << newVlan->getID() << ": " << numAdded
-             << " ports added, " << numRemoved << " ports removed";
-  if (numRemoved) {
-    auto rv = opennsl_vlan_port_remove(unit_, newVlan->getID(), removedPorts);
-    bcmCheckError(rv, "failed to remove ports from VLAN ", newVlan->getID());
-  }
-  if (numAdded) {
-    auto rv = opennsl_vlan_port_add(unit_, newVlan->getID(),
-                                addedPorts, addedUntaggedPorts);
-    bcmCheckError(rv, "failed to add ports to VLAN ", newVlan->getID());
-  }
+             << " ports added, " << numRemoved << " ports removed, "
+             << numRetagged << " ports retagged";
+  update.apply(unit_);
 }
 
 void BcmSwitch::processAddedVlan(const shared_ptr<Vlan>& vlan) {
@@ -1256,12 +1605,40 @@ void BcmSwitch::processRemovedIntf(const shared_ptr<Interface>& intf) {
 }
 
 void BcmSwitch::processQosChanges(const StateDelta& delta) {
+  std::set<std::string> rehomedPolicies;
   forEachChanged(
       delta.getQosPoliciesDelta(),
-      &BcmQosPolicyTable::processChangedQosPolicy,
-      &BcmQosPolicyTable::processAddedQosPolicy,
-      &BcmQosPolicyTable::processRemovedQosPolicy,
-      qosPolicyTable_.get());
+      [&](const std::shared_ptr<QosPolicy>& oldQosPolicy,
+          const std::shared_ptr<QosPolicy>& newQosPolicy) {
+        if (qosPolicyTable_->processChangedQosPolicy(
+                oldQosPolicy, newQosPolicy)) {
+          rehomedPolicies.insert(newQosPolicy->getName());
+        }
+      },
+      [&](const std::shared_ptr<QosPolicy>& qosPolicy) {
+        qosPolicyTable_->processAddedQosPolicy(qosPolicy);
+      },
+      [&](const std::shared_ptr<QosPolicy>& qosPolicy) {
+        qosPolicyTable_->processRemovedQosPolicy(qosPolicy);
+      });
+  if (rehomedPolicies.empty()) {
+    return;
+  }
+
+  // These policies now point at a different (shared) map, so whoever uses
+  // them has to pick up the new handle
+  for (const auto& port : *delta.newState()->getPorts()) {
+    auto qosPolicy = port->getQosPolicy();
+    if (qosPolicy && rehomedPolicies.count(*qosPolicy)) {
+      portTable_->getBcmPort(port->getID())
+          ->attachIngressQosPolicy(*qosPolicy);
+    }
+  }
+  const auto& cpuQosPolicy =
+      delta.newState()->getControlPlane()->getQosPolicy();
+  if (cpuQosPolicy && rehomedPolicies.count(*cpuQosPolicy)) {
+    controlPlane_->setupIngressQosPolicy(cpuQosPolicy);
+  }
 }
 
 void BcmSwitch::processAclChanges(const StateDelta& delta) {
@@ -1270,12 +1647,15 @@ void BcmSwitch::processAclChanges(const StateDelta& delta) {
     return;
   }
 
-  forEachChanged(
-    delta.getAclsDelta(),
-    &BcmSwitch::processChangedAcl,
-    &BcmSwitch::processAddedAcl,
-    &BcmSwitch::processRemovedAcl,
-    this);
+  // Renumbered but otherwise unchanged ACLs keep their FP entries
+  auto changes = BcmAclTable::computeAclChanges(delta.getAclsDelta());
+  for (const auto& acl : changes.removed) {
+    processRemovedAcl(acl);
+  }
+  aclTable_->processMovedAcls(changes);
+  for (const auto& acl : changes.added) {
+    processAddedAcl(acl);
+  }
 }
 
 void BcmSwitch::processAggregatePortChanges(const StateDelta& delta) {
@@ -1327,9 +1707,30 @@ void BcmSwitch::processSflowSamplingRateChanges(const StateDelta& delta) {
           sFlowExporterTable_->updateSamplingRates(
               id, newIngressRate, newEgressRate);
         }
+        // Link status for the sFlow counter samples
+        if (sFlowChanged || oldPort->getSpeed() != newPort->getSpeed() ||
+            oldPort->getAdminState() != newPort->getAdminState() ||
+            oldPort->getOperState() != newPort->getOperState()) {
+          sFlowExporterTable_->updatePortStatus(
+              newPort->getID(),
+              static_cast<uint64_t>(newPort->getSpeed()) * 1000 * 1000,
+              newPort->isEnabled(),
+              newPort->isPortUp());
+        }
       });
 }
 
+std::function<void(PortID, int64_t, int64_t)>
+BcmSwitch::sflowRateProgrammer() {
+  return [this](PortID id, int64_t ingressRate, int64_t egressRate) {
+    DomainLock g(this, LockDomain::PORTS);
+    auto bcmPort = portTable_->getBcmPortIf(id);
+    if (bcmPort) {
+      bcmPort->setSflowRates(ingressRate, egressRate);
+    }
+  };
+}
+
 void BcmSwitch::processSflowCollectorChanges(const StateDelta& delta) {
   forEachChanged(
     delta.getSflowCollectorsDelta(),
@@ -1483,18 +1884,52 @@ void BcmSwitch::processNeighborTableDelta(
   using NeighborEntryDeltaT = DeltaValue<NeighborEntryT>;
   std::vector<NeighborEntryDeltaT> discardedNeighborEntryDelta;
 
-  for (const auto& vlanDelta : stateDelta.getVlansDelta()) {
-    auto oldVlan = vlanDelta.getOld();
-    auto newVlan = vlanDelta.getNew();
-
-    for (const auto& delta :
-         vlanDelta.template getNeighborDelta<NeighborTableT>()) {
-      try {
-        processNeighborEntryDelta<NeighborEntryDeltaT, NeighborTableT>(delta,
-            appliedState);
-      } catch (const BcmError& error) {
-        rethrowIfHwNotFull(error);
-        discardedNeighborEntryDelta.push_back(delta);
+  // Program the egress objects of all the neighbors first, and write their
+  // host entries in one batch at the end
+  hostTable_->startHostBatch();
+  try {
+    for (const auto& vlanDelta : stateDelta.getVlansDelta()) {
+      for (const auto& delta :
+           vlanDelta.template getNeighborDelta<NeighborTableT>()) {
+        try {
+          processNeighborEntryDelta<NeighborEntryDeltaT, NeighborTableT>(
+              delta, appliedState);
+        } catch (const BcmError& error) {
+          rethrowIfHwNotFull(error);
+          discardedNeighborEntryDelta.push_back(delta);
+        }
+      }
+    }
+  } catch (...) {
+    hostTable_->discardHostBatch();
+    throw;
+  }
+
+  auto failedHosts = hostTable_->commitHostBatch();
+  if (!failedHosts.empty()) {
+    boost::container::flat_set<BcmHostKey> failed(
+        failedHosts.begin(), failedHosts.end());
+    for (const auto& vlanDelta : stateDelta.getVlansDelta()) {
+      for (const auto& delta :
+           vlanDelta.template getNeighborDelta<NeighborTableT>()) {
+        const auto& newEntry = delta.getNew();
+        if (!newEntry) {
+          continue;
+        }
+        const auto* intf = getIntfTable()->getBcmIntf(newEntry->getIntfID());
+        auto neighborKey = BcmHostKey(
+            getBcmVrfId(intf->getInterface()->getRouterID()),
+            IPAddress(newEntry->getIP()),
+            newEntry->getIntfID());
+        if (failed.count(neighborKey) &&
+            std::none_of(
+                discardedNeighborEntryDelta.begin(),
+                discardedNeighborEntryDelta.end(),
+                [&](const NeighborEntryDeltaT& discarded) {
+                  return discarded.getNew() == newEntry;
+                })) {
+          discardedNeighborEntryDelta.push_back(delta);
+        }
       }
     }
   }
@@ -1556,98 +1991,77 @@ void BcmSwitch::processRemovedRoute(const RouterID id,
   routeTable_->deleteRoute(getBcmVrfId(id), route.get());
 }
 
-void BcmSwitch::processRemovedRoutes(const StateDelta& delta) {
-  for (auto const& rtDelta : delta.getRouteTablesDelta()) {
-    if (!rtDelta.getOld()) {
-      // no old route table, must not removed route, skip
-      continue;
+template <typename AddrT>
+void BcmSwitch::processRemovedRoutes(
+    const BcmRouteDeltaSummary::Changes<AddrT>& changes) {
+  for (const auto& vrfChanges : changes) {
+    for (const auto& route : vrfChanges.removed) {
+      processRemovedRoute(vrfChanges.vrf, route);
     }
-    RouterID id = rtDelta.getOld()->getID();
-    forEachRemoved(
-        rtDelta.getRoutesV4Delta(),
-        &BcmSwitch::processRemovedRoute<RouteV4>,
-        this,
-        id);
-    forEachRemoved(
-        rtDelta.getRoutesV6Delta(),
-        &BcmSwitch::processRemovedRoute<RouteV6>,
-        this,
-        id);
   }
 }
 
-void BcmSwitch::processRemovedFibRoutes(const StateDelta& delta) {
-  for (const auto& fibDelta : delta.getFibsDelta()) {
-    auto oldFib = fibDelta.getOld();
-
-    if (!oldFib) {
-      // This FIB did not exist in the previous state. Thus, all routes in it
-      // must necessarily have been _added_.
-      continue;
+template <typename AddrT>
+void BcmSwitch::collectEcmpGroupUpdates(
+    const BcmRouteDeltaSummary::Changes<AddrT>& changes,
+    BcmEcmpGroupUpdater* updater) const {
+  for (const auto& vrfChanges : changes) {
+    auto vrf = getBcmVrfId(vrfChanges.vrf);
+    for (const auto& route : vrfChanges.addedChanged) {
+      if (route.first) {
+        updater->routeChanged(vrf, route.second.get());
+      } else {
+        updater->routeAdded(vrf, route.second.get());
+      }
     }
-
-    CHECK(oldFib);
-    RouterID vrf = oldFib->getID();
-
-    forEachRemoved(
-        fibDelta.getV4FibDelta(),
-        &BcmSwitch::processRemovedRoute<RouteV4>,
-        this,
-        vrf);
-    forEachRemoved(
-        fibDelta.getV6FibDelta(),
-        &BcmSwitch::processRemovedRoute<RouteV6>,
-        this,
-        vrf);
   }
 }
 
 void BcmSwitch::processAddedChangedRoutes(
     const StateDelta& delta,
+    const BcmRouteDeltaSummary& routes,
     std::shared_ptr<SwitchState>* appliedState) {
-  processRouteTableDelta<folly::IPAddressV4>(delta, appliedState);
-  processRouteTableDelta<folly::IPAddressV6>(delta, appliedState);
+  if (!routes.isValid()) {
+    // typically indicate label stack depth exceeded.
+    throw FbossError("invalid route update");
+  }
+  // Held until all routes are programmed, see BcmEcmpGroupUpdater
+  BcmEcmpGroupUpdater ecmpGroupUpdater(this);
+  collectEcmpGroupUpdates(
+      routes.routeTables<folly::IPAddressV4>(), &ecmpGroupUpdater);
+  collectEcmpGroupUpdates(
+      routes.routeTables<folly::IPAddressV6>(), &ecmpGroupUpdater);
+  ecmpGroupUpdater.updateHwLocked();
+
+  processRouteTableDelta<folly::IPAddressV4>(delta, routes, appliedState);
+  processRouteTableDelta<folly::IPAddressV6>(delta, routes, appliedState);
 }
 
 template <typename AddrT>
 void BcmSwitch::processRouteTableDelta(
     const StateDelta& delta,
+    const BcmRouteDeltaSummary& routes,
     std::shared_ptr<SwitchState>* appliedState) {
   using RouteT = Route<AddrT>;
   using PrefixT = typename Route<AddrT>::Prefix;
   std::map<RouterID, std::vector<PrefixT>> discardedPrefixes;
-  if (!isRouteUpdateValid<AddrT>(delta)) {
-    // typically indicate label stack depth exceeded.
-    throw FbossError("invalid route update");
-  }
-  for (auto const& rtDelta : delta.getRouteTablesDelta()) {
-    if (!rtDelta.getNew()) {
-      // no new route table, must not have added or changed route, skip
-      continue;
+  for (const auto& vrfChanges : routes.routeTables<AddrT>()) {
+    RouterID id = vrfChanges.vrf;
+    for (const auto& route : vrfChanges.addedChanged) {
+      const shared_ptr<RouteT>& oldRoute = route.first;
+      const shared_ptr<RouteT>& newRoute = route.second;
+      try {
+        if (oldRoute) {
+          processChangedRoute(id, oldRoute, newRoute);
+        } else {
+          processAddedRoute(id, newRoute);
+        }
+      } catch (const BcmError& e) {
+        rethrowIfHwNotFull(e);
+        BcmStats::get()->routeInsertFailure();
+        discardedPrefixes[id].push_back(newRoute->prefix());
+      }
     }
-    RouterID id = rtDelta.getNew()->getID();
-    forEachChanged(
-        rtDelta.template getRoutesDelta<AddrT>(),
-        [&](const shared_ptr<RouteT>& oldRoute,
-            const shared_ptr<RouteT>& newRoute) {
-          try {
-            processChangedRoute(id, oldRoute, newRoute);
-          } catch (const BcmError& e) {
-            rethrowIfHwNotFull(e);
-            discardedPrefixes[id].push_back(oldRoute->prefix());
-          }
-        },
-        [&](const shared_ptr<RouteT>& addedRoute) {
-          try {
-            processAddedRoute(id, addedRoute);
-          } catch (const BcmError& e) {
-            rethrowIfHwNotFull(e);
-            discardedPrefixes[id].push_back(addedRoute->prefix());
-          }
-        },
-        [](const shared_ptr<RouteT>& /*deletedRoute*/) {
-          // do nothing
-        });
   }
 
   // discard  routes
@@ -1672,35 +2086,35 @@ void BcmSwitch::processRouteTableDelta(
 }
 
 void BcmSwitch::processAddedChangedFibRoutes(
-    const StateDelta& delta,
-    std::shared_ptr<SwitchState>* /* appliedState */) {
-  for (auto const& fibDelta : delta.getFibsDelta()) {
-    auto newFib = fibDelta.getNew();
+    const BcmRouteDeltaSummary& routes) {
+  // Held until all routes are programmed, see BcmEcmpGroupUpdater
+  BcmEcmpGroupUpdater ecmpGroupUpdater(this);
+  collectEcmpGroupUpdates(routes.fibs<folly::IPAddressV4>(), &ecmpGroupUpdater);
+  collectEcmpGroupUpdates(routes.fibs<folly::IPAddressV6>(), &ecmpGroupUpdater);
+  ecmpGroupUpdater.updateHwLocked();
 
-    if (!newFib) {
-      // This FIB does not exist in the new tate. Thus, all routes in it
-      // must necessarily have been deleted.
-      continue;
-    }
-
-    CHECK(newFib);
-    RouterID vrf = newFib->getID();
-
-    forEachChanged(
-        fibDelta.getV4FibDelta(),
-        &BcmSwitch::processChangedRoute<RouteV4>,
-        &BcmSwitch::processAddedRoute<RouteV4>,
-        [&](BcmSwitch*, const RouterID&, const shared_ptr<RouteV4>&) {},
-        this,
-        vrf);
+  for (const auto& vrfChanges : routes.fibs<folly::IPAddressV4>()) {
+    programAddedChangedFibRoutes(vrfChanges);
+  }
+  for (const auto& vrfChanges : routes.fibs<folly::IPAddressV6>()) {
+    programAddedChangedFibRoutes(vrfChanges);
+  }
+}
 
-    forEachChanged(
-        fibDelta.getV6FibDelta(),
-        &BcmSwitch::processChangedRoute<RouteV6>,
-        &BcmSwitch::processAddedRoute<RouteV6>,
-        [&](BcmSwitch*, const RouterID&, const shared_ptr<RouteV6>&) {},
-        this,
-        vrf);
+template <typename AddrT>
+void BcmSwitch::programAddedChangedFibRoutes(
+    const BcmRouteDeltaSummary::VrfChanges<AddrT>& changes) {
+  for (const auto& route : changes.addedChanged) {
+    try {
+      if (route.first) {
+        processChangedRoute(changes.vrf, route.first, route.second);
+      } else {
+        processAddedRoute(changes.vrf, route.second);
+      }
+    } catch (const BcmError&) {
+      BcmStats::get()->routeInsertFailure();
+      throw;
+    }
   }
 }
 
@@ -1713,8 +2127,26 @@ void BcmSwitch::linkscanCallback(
     BcmSwitch* sw = static_cast<BcmSwitch*>(unitObj->getCookie());
     bool up = info->linkstatus == OPENNSL_PORT_LINK_STATUS_UP;
 
-    sw->linkScanBottomHalfEventBase_.runInEventBaseThread(
-        [sw, bcmPort, up]() { sw->linkStateChangedHwNotLocked(bcmPort, up); });
+    bool firstPending;
+    {
+      std::lock_guard<std::mutex> guard(sw->pendingLinkStateChangesLock_);
+      firstPending = sw->pendingLinkStateChanges_.empty();
+      sw->pendingLinkStateChanges_.emplace_back(bcmPort, up);
+    }
+    // Changes arriving before the bottom half runs are handled along with
+    // this one. Ports failing together, e.g. all those of an optics group,
+    // are reported within a scan of each other, so wait a little for them.
+    if (firstPending) {
+      sw->linkScanBottomHalfEventBase_.runInEventBaseThread([sw]() {
+        if (FLAGS_linkscan_coalesce_ms <= 0) {
+          sw->linkStateChangedHwNotLocked();
+          return;
+        }
+        sw->linkScanBottomHalfEventBase_.runAfterDelay(
+            [sw]() { sw->linkStateChangedHwNotLocked(); },
+            FLAGS_linkscan_coalesce_ms);
+      });
+    }
   } catch (const std::exception& ex) {
     XLOG(ERR) << "unhandled exception while processing linkscan callback "
               << "for unit " << unit << " port " << bcmPort << ": "
@@ -1722,24 +2154,42 @@ void BcmSwitch::linkscanCallback(
   }
 }
 
-void BcmSwitch::linkStateChangedHwNotLocked(
-    opennsl_port_t bcmPortId,
-    bool up) {
+void BcmSwitch::linkStateChangedHwNotLocked() {
   CHECK(linkScanBottomHalfEventBase_.inRunningEventBaseThread());
 
-  if (!up) {
+  std::vector<std::pair<opennsl_port_t, bool>> changes;
+  {
+    std::lock_guard<std::mutex> guard(pendingLinkStateChangesLock_);
+    changes.swap(pendingLinkStateChanges_);
+  }
+
+  std::vector<opennsl_gport_t> downGPorts;
+  for (const auto& portAndUp : changes) {
+    // For port up events we wait till ARP/NDP entries
+    // are re resolved after port up before adding them
+    // back. Adding them earlier leads to packet loss.
+    if (portAndUp.second) {
+      continue;
+    }
+    auto bcmPortId = portAndUp.first;
     auto trunk = trunkTable_->linkDownHwNotLocked(bcmPortId);
     if (trunk != BcmTrunk::INVALID) {
       XLOG(INFO) << "Shrinking ECMP entries egressing over trunk " << trunk;
-      writableEgressManager()->trunkDownHwNotLocked(trunk);
+      downGPorts.push_back(BcmTrunk::asGPort(trunk));
     }
-    writableEgressManager()->linkDownHwNotLocked(bcmPortId);
-  } else {
-    // For port up events we wait till ARP/NDP entries
-    // are re resolved after port up before adding them
-    // back. Adding them earlier leads to packet loss.
+    downGPorts.push_back(BcmPort::asGPort(bcmPortId));
+  }
+  if (!downGPorts.empty()) {
+    writableEgressManager()->linksDownHwNotLocked(downGPorts);
+  }
+
+  std::vector<std::pair<PortID, bool>> portChanges;
+  portChanges.reserve(changes.size());
+  for (const auto& portAndUp : changes) {
+    portChanges.emplace_back(
+        portTable_->getPortId(portAndUp.first), portAndUp.second);
   }
-  callback_->linkStateChanged(portTable_->getPortId(bcmPortId), up);
+  callback_->linkStatesChanged(portChanges);
 }
 
 opennsl_rx_t BcmSwitch::packetRxCallback(int unit, opennsl_pkt_t* pkt,
@@ -1775,7 +2225,7 @@ opennsl_rx_t BcmSwitch::packetReceived(opennsl_pkt_t* pkt) noexcept {
 bool BcmSwitch::sendPacketSwitchedAsync(unique_ptr<TxPacket> pkt) noexcept {
   unique_ptr<BcmTxPacket> bcmPkt(
       boost::polymorphic_downcast<BcmTxPacket*>(pkt.release()));
-  return OPENNSL_SUCCESS(BcmTxPacket::sendAsync(std::move(bcmPkt)));
+  return sendAsync(std::move(bcmPkt));
 }
 
 bool BcmSwitch::sendPacketOutOfPortAsync(
@@ -1790,7 +2240,14 @@ bool BcmSwitch::sendPacketOutOfPortAsync(
   }
   XLOG(DBG4) << "sendPacketOutOfPortAsync for"
              << getPortTable()->getBcmPortId(portID);
-  return OPENNSL_SUCCESS(BcmTxPacket::sendAsync(std::move(bcmPkt)));
+  return sendAsync(std::move(bcmPkt));
+}
+
+bool BcmSwitch::sendAsync(unique_ptr<BcmTxPacket> pkt) noexcept {
+  if (txRing_) {
+    return txRing_->enqueue(std::move(pkt));
+  }
+  return OPENNSL_SUCCESS(BcmTxPacket::sendAsync(std::move(pkt)));
 }
 
 bool BcmSwitch::sendPacketSwitchedSync(unique_ptr<TxPacket> pkt) noexcept {
@@ -1832,6 +2289,7 @@ void BcmSwitch::updateStats(SwitchStats *switchStats) {
   // Update global statistics.
   updateGlobalStats();
   // Update cpu or host bound packet stats
+  DomainLock g(this, LockDomain::PORTS);
   controlPlane_->updateQueueCounters();
 }
 
@@ -1856,16 +2314,41 @@ void BcmSwitch::updateThreadLocalPortStats(
 }
 
 void BcmSwitch::updateGlobalStats() {
-  portTable_->updatePortStats();
-  trunkTable_->updateStats();
+  auto start = std::chrono::steady_clock::now();
+  {
+    // Only the port phases of a state update hold this up, not route
+    // programming
+    DomainLock g(this, LockDomain::PORTS);
+    portTable_->updatePortStats();
+    // sFlow counter samples reuse the port stats just collected
+    portTable_->forFilteredEach(
+        [](const BcmPortTable::FilterEntry&) { return true; },
+        [this](const BcmPortTable::FilterEntry& entry) {
+          sFlowExporterTable_->updatePortStats(
+              entry.first, entry.second->getPortStats());
+        });
+    trunkTable_->updateStats();
+  }
   bcmStatUpdater_->updateStats();
+  BcmTxPacketPool::get()->publishStats();
 
   auto now = WallClockUtil::NowInSecFast();
-  if ((now - bstStatsUpdateTime_ >= FLAGS_update_bststats_interval_s) ||
+  bool readBufferStats =
+      now - bstStatsUpdateTime_ >= FLAGS_update_bststats_interval_s;
+  if (bstTriggerCallback_) {
+    // Between triggers nothing is congested, so there is nothing to read.
+    // Once congested, keep reading every interval until it clears.
+    readBufferStats = bstTriggerCallback_->consumeTrigger() ||
+        (readBufferStats && bufferCongestionTracker_->anyCongested());
+  }
+  if (readBufferStats ||
       bstStatsMgr_->isFineGrainedBufferStatLoggingEnabled()) {
     bstStatsUpdateTime_ = now;
     bstStatsMgr_->updateStats();
   }
+  BcmStats::get()->globalStatsCollected(
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::steady_clock::now() - start));
 }
 
 opennsl_if_t BcmSwitch::getDropEgressId() const {
@@ -1892,6 +2375,24 @@ bool BcmSwitch::getAndClearNeighborHit(
   return true;
 }
 
+folly::Optional<NeighborHits> BcmSwitch::getAndClearNeighborHits() {
+  // One pass over the host table under the L3 lock, rather than one lookup
+  // per neighbor. Only the L3 phases of a state update hold this up.
+  NeighborHits hits;
+  DomainLock g(this, LockDomain::L3);
+  for (const auto& entry : *hostTable_) {
+    auto host = entry.second.lock();
+    if (!host || !host->isProgrammed() || host->getHostKey().hasLabel()) {
+      continue;
+    }
+    if (host->getAndClearHitBit()) {
+      const auto& key = host->getHostKey();
+      hits.emplace(getRouterId(key.getVrf()), key.addr());
+    }
+  }
+  return hits;
+}
+
 void BcmSwitch::exitFatal() const {
   utilCreateDir(platform_->getCrashInfoDir());
   dumpState(platform_->getCrashHwStateFile());
@@ -1936,18 +2437,29 @@ void BcmSwitch::processChangedLoadBalancer(
 
   XLOG(DBG2) << "reprogramming LoadBalancer " << oldLoadBalancer->getID();
   rtag7LoadBalancer_->programLoadBalancer(oldLoadBalancer, newLoadBalancer);
+  if (newLoadBalancer->getID() == LoadBalancerID::ECMP) {
+    multiPathNextHopTable_->setResilientFlowsetSizeHwLocked(
+        newLoadBalancer->getResilientFlowsetSize());
+  }
 }
 
 void BcmSwitch::processAddedLoadBalancer(
     const std::shared_ptr<LoadBalancer>& loadBalancer) {
   XLOG(DBG2) << "creating LoadBalancer " << loadBalancer->getID();
   rtag7LoadBalancer_->addLoadBalancer(loadBalancer);
+  if (loadBalancer->getID() == LoadBalancerID::ECMP) {
+    multiPathNextHopTable_->setResilientFlowsetSizeHwLocked(
+        loadBalancer->getResilientFlowsetSize());
+  }
 }
 
 void BcmSwitch::processRemovedLoadBalancer(
     const std::shared_ptr<LoadBalancer>& loadBalancer) {
   XLOG(DBG2) << "deleting LoadBalancer " << loadBalancer->getID();
   rtag7LoadBalancer_->deleteLoadBalancer(loadBalancer);
+  if (loadBalancer->getID() == LoadBalancerID::ECMP) {
+    multiPathNextHopTable_->setResilientFlowsetSizeHwLocked(0);
+  }
 }
 
 bool BcmSwitch::isControlPlaneQueueNameChanged(
@@ -1971,13 +2483,19 @@ void BcmSwitch::processChangedControlPlaneQueues(
     const shared_ptr<ControlPlane>& newCPU) {
   // first make sure queue settings changes applied
   for (const auto newQueue: newCPU->getQueues()) {
-    if (oldCPU->getQueues().size() > 0 &&
-        *(oldCPU->getQueues().at(newQueue->getID())) == *newQueue) {
+    if (oldCPU->getQueues().empty()) {
+      XLOG(DBG1) << "New cos queue settings on cpu queue "
+                 << static_cast<int>(newQueue->getID());
+      controlPlane_->setupQueue(*newQueue);
       continue;
     }
-    XLOG(DBG1) << "New cos queue settings on cpu queue "
+    const auto& oldQueue = oldCPU->getQueues().at(newQueue->getID());
+    if (*oldQueue == *newQueue) {
+      continue;
+    }
+    XLOG(DBG1) << "Changed cos queue settings on cpu queue "
                << static_cast<int>(newQueue->getID());
-    controlPlane_->setupQueue(*newQueue);
+    controlPlane_->getQueueManager()->programChanged(*oldQueue, *newQueue);
   }
 
   if (isControlPlaneQueueNameChanged(oldCPU, newCPU)) {
@@ -2054,8 +2572,12 @@ void BcmSwitch::processRemovedLabelForwardingEntry(
 }
 
 void BcmSwitch::processChangedLabelForwardingEntry(
-    const std::shared_ptr<LabelForwardingEntry>& /*oldEntry*/,
+    const std::shared_ptr<LabelForwardingEntry>& oldEntry,
     const std::shared_ptr<LabelForwardingEntry>& newEntry) {
+  if (oldEntry->getLabelNextHop() == newEntry->getLabelNextHop()) {
+    // Only a client that doesn't win changed, the label switch action stays
+    return;
+  }
   writableLabelMap()->processChangedLabelSwitchAction(
       newEntry->getID(), newEntry->getLabelNextHop());
 }
@@ -10,16 +10,21 @@
 #pragma once
 
 #include "fboss/agent/HwSwitch.h"
+#include "fboss/agent/hw/bcm/BcmRouteDeltaSummary.h"
 #include "fboss/agent/types.h"
 #include "fboss/agent/gen-cpp2/switch_config_types.h"
 #include <folly/dynamic.h>
 #include <folly/io/async/EventBase.h>
 #include <folly/Optional.h>
+#include <folly/Synchronized.h>
 #include <gtest/gtest_prod.h>
 
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <thread>
+#include <utility>
+#include <vector>
 #include <boost/container/flat_map.hpp>
 
 extern "C" {
@@ -51,13 +56,17 @@ class BcmNeighborTable;
 template <class K, class V>
 class BcmNextHopTable;
 class BcmPlatform;
+class BcmPortFastSampler;
 class BcmPortTable;
 class BcmQosPolicyTable;
 class BcmRouteTable;
+class BcmEcmpGroupUpdater;
 class BcmRxPacket;
 class BcmStatUpdater;
 class BcmSwitchEventCallback;
 class BcmTrunkTable;
+class BcmTxPacket;
+class BcmTxRing;
 class BcmUnit;
 class BcmWarmBootCache;
 class BcmWarmBootHelper;
@@ -79,6 +88,8 @@ class BcmMirror;
 class BcmMirrorTable;
 class ControlPlane;
 class BcmBstStatsMgr;
+class BcmBstTriggerCallback;
+class BufferCongestionTracker;
 class BcmLabelMap;
 
 /*
@@ -432,8 +443,26 @@ class BcmSwitch : public BcmSwitchIf {
   bool getAndClearNeighborHit(RouterID vrf,
                               folly::IPAddress& ip) override;
 
+  folly::Optional<NeighborHits> getAndClearNeighborHits() override;
+
   bool getPortFECEnabled(PortID port) const override;
 
+  std::map<PortID, HwPortStats> getPortStats() const override;
+
+  void setPortFastSampling(
+      const std::vector<PortID>& ports,
+      std::chrono::milliseconds interval) override;
+  PortFastSamples getPortFastSamples(PortID port) const override;
+
+  void watchAclStats(
+      const std::vector<std::string>& statNames,
+      std::chrono::seconds duration) override;
+
+  std::vector<BufferCongestionEvent> getBufferCongestionEvents()
+      const override;
+
+  HwApiTrace getHwApiTrace() const override;
+
   cfg::PortSpeed getPortMaxSpeed(PortID port) const override;
 
   bool isValidStateUpdate(const StateDelta& delta) const override;
@@ -455,6 +484,11 @@ class BcmSwitch : public BcmSwitchIf {
     return bstStatsMgr_.get();
   }
 
+  // Only set with --bcm_bst_event_driven
+  BufferCongestionTracker* getBufferCongestionTracker() const {
+    return bufferCongestionTracker_.get();
+  }
+
   /*
    * Friend tests. We want the abilty to test private methods
    * without comprimising encapsulation for code generally.
@@ -480,6 +514,8 @@ class BcmSwitch : public BcmSwitchIf {
   void setupToCpuEgress();
 
   std::unique_ptr<BcmRxPacket> createRxPacket(opennsl_pkt_t* pkt);
+  // Send pkt through txRing_ if there is one, or directly otherwise
+  bool sendAsync(std::unique_ptr<BcmTxPacket> pkt) noexcept;
   void changeDefaultVlan(VlanID id);
 
   void processChangedVlan(const std::shared_ptr<Vlan>& oldVlan,
@@ -538,20 +574,31 @@ class BcmSwitch : public BcmSwitchIf {
   template <typename RouteT>
   void processRemovedRoute(
       const RouterID id, const std::shared_ptr<RouteT>& route);
-  void processRemovedRoutes(const StateDelta& delta);
+  template <typename AddrT>
+  void processRemovedRoutes(
+      const BcmRouteDeltaSummary::Changes<AddrT>& changes);
   void processAddedChangedRoutes(
       const StateDelta& delta,
+      const BcmRouteDeltaSummary& routes,
       std::shared_ptr<SwitchState>* appliedState);
   template <typename AddrT>
   void processRouteTableDelta(
       const StateDelta& delta,
+      const BcmRouteDeltaSummary& routes,
       std::shared_ptr<SwitchState>* appliedState);
   template <typename AddrT>
-  bool isRouteUpdateValid(const StateDelta& delta) const;
-  void processRemovedFibRoutes(const StateDelta& delta);
-  void processAddedChangedFibRoutes(
-      const StateDelta& delta,
-      std::shared_ptr<SwitchState>* appliedState);
+  void collectEcmpGroupUpdates(
+      const BcmRouteDeltaSummary::Changes<AddrT>& changes,
+      BcmEcmpGroupUpdater* updater) const;
+  template <typename AddrT>
+  void programAddedChangedFibRoutes(
+      const BcmRouteDeltaSummary::VrfChanges<AddrT>& changes);
+  void processAddedChangedFibRoutes(const BcmRouteDeltaSummary& routes);
+  void exportFibCompressionStats() const;
+  template <typename AddrT>
+  void exportFibCompressionStats(
+      const BcmRouteDeltaSummary::FibCompressors<AddrT>& compressors,
+      const std::string& prefix) const;
 
   void processQosChanges(const StateDelta& delta);
 
@@ -582,6 +629,8 @@ class BcmSwitch : public BcmSwitchIf {
 
   void processSflowSamplingRateChanges(const StateDelta& delta);
   void processSflowCollectorChanges(const StateDelta& delta);
+  // For BcmSflowExporterTable to reprogram the adapted sampling rates
+  std::function<void(PortID, int64_t, int64_t)> sflowRateProgrammer();
   void processChangedSflowCollector(
       const std::shared_ptr<SflowCollector>& oldCollector,
       const std::shared_ptr<SflowCollector>& newCollector);
@@ -619,8 +668,12 @@ class BcmSwitch : public BcmSwitchIf {
    * try to acquire BcmUnitLock and block since the link scan thread is
    * holding that lock.
    * Back traces from deadlocked process here https://phabricator.fb.com/P20042479
+   *
+   * Handles all changes queued in pendingLinkStateChanges_ together, so the
+   * ECMP groups are pruned once for a burst of ports going down, and the
+   * SwSwitch gets them as one batch.
    */
-  void linkStateChangedHwNotLocked(opennsl_port_t port, bool up);
+  void linkStateChangedHwNotLocked();
 
   /*
    * For any actions that require a lock or might need to
@@ -833,6 +886,9 @@ class BcmSwitch : public BcmSwitchIf {
   std::unique_ptr<BcmMultiPathNextHopTable> multiPathNextHopTable_;
   std::unique_ptr<BcmLabelMap> labelMap_;
   std::unique_ptr<BcmRouteTable> routeTable_;
+  // What is programmed for each FIB, with --fib_compression
+  BcmRouteDeltaSummary::FibCompressors<folly::IPAddressV4> fibCompressorsV4_;
+  BcmRouteDeltaSummary::FibCompressors<folly::IPAddressV6> fibCompressorsV6_;
   std::unique_ptr<BcmQosPolicyTable> qosPolicyTable_;
   std::unique_ptr<BcmAclTable> aclTable_;
   std::unique_ptr<BcmStatUpdater> bcmStatUpdater_;
@@ -843,17 +899,68 @@ class BcmSwitch : public BcmSwitchIf {
   std::unique_ptr<BcmRtag7LoadBalancer> rtag7LoadBalancer_;
   std::unique_ptr<BcmMirrorTable> mirrorTable_;
   std::unique_ptr<BcmBstStatsMgr> bstStatsMgr_;
+  /*
+   * Only set with --bcm_bst_event_driven.  Unlike bstStatsMgr_, these are
+   * kept across resetTables(), so the congestion history survives.
+   */
+  std::shared_ptr<BcmBstTriggerCallback> bstTriggerCallback_;
+  std::unique_ptr<BufferCongestionTracker> bufferCongestionTracker_;
+  // Set by setPortFastSampling(), and null while no ports are sampled
+  folly::Synchronized<std::shared_ptr<BcmPortFastSampler>> portFastSampler_;
 
   std::unique_ptr<std::thread> linkScanBottomHalfThread_;
   folly::EventBase linkScanBottomHalfEventBase_;
+  /*
+   * (port, up) changes from linkscanCallback that the bottom half has not
+   * handled yet.
+   */
+  std::vector<std::pair<opennsl_port_t, bool>> pendingLinkStateChanges_;
+  std::mutex pendingLinkStateChangesLock_;
+
+  // Only set with --bcm_tx_ring_depth
+  std::unique_ptr<BcmTxRing> txRing_;
 
   std::unique_ptr<BcmUnit> unitObject_;
   BootType bootType_{BootType::UNINITIALIZED};
   int64_t bstStatsUpdateTime_{0};
 
   /*
-   * Lock to synchronize access to all BCM* data structures
+   * The locks guarding the BCM* data structures, by domain.
+   *
+   * PROGRAMMING (lock_) serializes state updates with init, graceful exit,
+   * the warm boot cache and run state changes. Each phase of a state update
+   * also holds the lock of the domain it programs, and threads that read a
+   * domain outside of a state update (stats collection, neighbor hit scans)
+   * take only that domain's lock. They then wait for the phases that touch
+   * what they read, rather than for the whole update.
+   *
+   * Domains must be taken in the order below. Debug builds check this.
    */
+  enum class LockDomain : uint8_t {
+    PROGRAMMING,
+    PORTS, // ports, queues, trunks, sFlow
+    L3, // vlans, interfaces, neighbors, next hops, routes, labels
+    ACLS, // ACLs and mirrors
+  };
+
+  class DomainLock {
+   public:
+    DomainLock(BcmSwitch* sw, LockDomain domain);
+    ~DomainLock();
+
+   private:
+    uint32_t bit_;
+    std::unique_lock<std::mutex> guard_;
+
+    DomainLock(DomainLock const&) = delete;
+    DomainLock& operator=(DomainLock const&) = delete;
+  };
+
+  std::mutex& domainMutex(LockDomain domain);
+
   std::mutex lock_;
+  std::mutex portsLock_;
+  std::mutex l3Lock_;
+  std::mutex aclLock_;
 };
 }} // facebook::fboss
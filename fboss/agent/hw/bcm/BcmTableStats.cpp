@@ -0,0 +1,139 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/hw/bcm/BcmTableStats.h"
+
+#include "fboss/agent/hw/bcm/BcmMultiPathNextHop.h"
+#include "fboss/agent/hw/bcm/BcmSwitch.h"
+#include "fboss/agent/hw/bcm/gen-cpp2/bcmswitch_constants.h"
+#include "fboss/agent/state/ArpTable.h"
+#include "fboss/agent/state/NdpTable.h"
+#include "fboss/agent/state/Route.h"
+#include "fboss/agent/state/Vlan.h"
+
+#include <gflags/gflags.h>
+
+#include <algorithm>
+
+DECLARE_int32(ecmp_group_limit);
+
+namespace {
+
+/*
+ * Net number of entries the delta adds, counting each node as count(node)
+ * entries.
+ */
+template <typename DeltaT, typename CountFn>
+int64_t netChange(const DeltaT& delta, CountFn count) {
+  int64_t change = 0;
+  for (const auto& entry : delta) {
+    if (entry.getNew()) {
+      change += count(*entry.getNew());
+    }
+    if (entry.getOld()) {
+      change -= count(*entry.getOld());
+    }
+  }
+  return change;
+}
+
+void adjust(int32_t* used, int32_t* free, int64_t change) {
+  auto uninitialized =
+      facebook::fboss::bcmswitch_constants::STAT_UNINITIALIZED();
+  // Only adjust what the hardware has reported at least once
+  if (change == 0 || *used == uninitialized) {
+    return;
+  }
+  *used = std::max<int64_t>(0, *used + change);
+  if (free && *free != uninitialized) {
+    *free = std::max<int64_t>(0, *free - change);
+  }
+}
+
+template <typename RouteT>
+int64_t programmed(const RouteT& route) {
+  // Unresolved routes are not programmed into hardware
+  return route.isResolved() ? 1 : 0;
+}
+
+template <typename RouteT>
+int64_t programmedV6Upto64(const RouteT& route) {
+  return route.prefix().mask <= 64 ? programmed(route) : 0;
+}
+
+template <typename RouteT>
+int64_t programmedV6Above64(const RouteT& route) {
+  return route.prefix().mask > 64 ? programmed(route) : 0;
+}
+
+template <typename EntryT>
+int64_t one(const EntryT& /*entry*/) {
+  return 1;
+}
+
+} // namespace
+
+namespace facebook { namespace fboss {
+
+void BcmHwTableStatManager::applyDelta(
+    const StateDelta& delta,
+    BcmHwTableStats* stats) {
+  updateBcmStateChangeStats(delta, stats);
+
+  int64_t v4Routes = 0;
+  int64_t v6RoutesUpto64 = 0;
+  int64_t v6RoutesAbove64 = 0;
+  for (const auto& rtDelta : delta.getRouteTablesDelta()) {
+    v4Routes += netChange(rtDelta.getRoutesV4Delta(), programmed<RouteV4>);
+    v6RoutesUpto64 += netChange(
+        rtDelta.getRoutesV6Delta(), programmedV6Upto64<RouteV6>);
+    v6RoutesAbove64 += netChange(
+        rtDelta.getRoutesV6Delta(), programmedV6Above64<RouteV6>);
+  }
+  for (const auto& fibDelta : delta.getFibsDelta()) {
+    v4Routes += netChange(fibDelta.getV4FibDelta(), programmed<RouteV4>);
+    v6RoutesUpto64 += netChange(
+        fibDelta.getV6FibDelta(), programmedV6Upto64<RouteV6>);
+    v6RoutesAbove64 += netChange(
+        fibDelta.getV6FibDelta(), programmedV6Above64<RouteV6>);
+  }
+
+  int64_t v4Hosts = 0;
+  int64_t v6Hosts = 0;
+  for (const auto& vlanDelta : delta.getVlansDelta()) {
+    v4Hosts += netChange(vlanDelta.getArpDelta(), one<ArpEntry>);
+    v6Hosts += netChange(vlanDelta.getNdpDelta(), one<NdpEntry>);
+  }
+
+  adjust(&stats->lpm_ipv4_used, &stats->lpm_ipv4_free, v4Routes);
+  adjust(
+      &stats->lpm_ipv6_mask_0_64_used,
+      &stats->lpm_ipv6_mask_0_64_free,
+      v6RoutesUpto64);
+  adjust(
+      &stats->lpm_ipv6_mask_65_127_used,
+      &stats->lpm_ipv6_mask_65_127_free,
+      v6RoutesAbove64);
+  adjust(&stats->l3_ipv4_host_used, nullptr, v4Hosts);
+  adjust(&stats->l3_ipv6_host_used, nullptr, v6Hosts);
+  adjust(&stats->l3_host_used, &stats->l3_host_free, v4Hosts + v6Hosts);
+
+  // Tracked in SW, the flowsets of each group are fixed in size
+  stats->l3_ecmp_flowsets_used =
+      hw_->getMultiPathNextHopTable()->getResilientFlowsetsUsed();
+  stats->l3_ecmp_groups_used =
+      hw_->getMultiPathNextHopTable()->getEcmpEgressCount();
+  if (FLAGS_ecmp_group_limit > 0) {
+    stats->l3_ecmp_groups_max = FLAGS_ecmp_group_limit;
+    stats->l3_ecmp_groups_free = std::max<int64_t>(
+        0, FLAGS_ecmp_group_limit - stats->l3_ecmp_groups_used);
+  }
+}
+
+}} // facebook::fboss
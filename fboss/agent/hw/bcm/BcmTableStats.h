@@ -23,7 +23,16 @@ class BcmHwTableStatManager {
       bool isAlpmEnabled = false)
       : hw_(hw), isAlpmEnabled_(isAlpmEnabled) {}
 
-  void refresh(const StateDelta& delta, BcmHwTableStats* stats);
+  /*
+   * Query the hardware for table usage.  This makes a pass over the SDK
+   * tables, so it is only done periodically, off the state update path.
+   */
+  void refresh(BcmHwTableStats* stats);
+  /*
+   * Adjust the table usage in stats by what the delta adds and removes.
+   * This only walks the delta, and is corrected by the next refresh().
+   */
+  void applyDelta(const StateDelta& delta, BcmHwTableStats* stats);
   void publish(BcmHwTableStats stats) const;
 
  private:
@@ -17,6 +17,7 @@ extern "C" {
 
 #include <folly/container/Enumerate.h>
 #include <folly/logging/xlog.h>
+#include <algorithm>
 #include <vector>
 
 #include "fboss/agent/hw/bcm/BcmPortTable.h"
@@ -102,6 +103,7 @@ void BcmTrunk::programForwardingState(
      AggregatePort::SubportAndForwardingStateConstRange newRange) {
   PortID oldSubport, newSubport;
   AggregatePort::Forwarding oldFwdState, newFwdState;
+  std::vector<PortID> added, removed;
 
   for (auto newSubportAndFwdState : newRange) {
     std::tie(newSubport, newFwdState) = newSubportAndFwdState;
@@ -117,10 +119,75 @@ void BcmTrunk::programForwardingState(
     std::tie(oldSubport, oldFwdState) = *oldSubportAndFwdStateIter;
     CHECK_EQ(oldSubport, newSubport);
     if (oldFwdState != newFwdState) {
-      modifyMemberPort(
-          newFwdState == AggregatePort::Forwarding::ENABLED, newSubport);
+      if (newFwdState == AggregatePort::Forwarding::ENABLED) {
+        added.push_back(newSubport);
+      } else {
+        removed.push_back(newSubport);
+      }
     }
   }
+
+  if (added.size() + removed.size() == 1) {
+    modifyMemberPort(!added.empty(), added.empty() ? removed[0] : added[0]);
+  } else if (!added.empty() || !removed.empty()) {
+    modifyMemberPorts(added, removed);
+  }
+}
+
+void BcmTrunk::modifyMemberPorts(
+    const std::vector<PortID>& added,
+    const std::vector<PortID>& removed) {
+  // Start from what is in hardware rather than from the old AggregatePort,
+  // as the link-scan thread may have already shrunk the trunk
+  opennsl_trunk_info_t info;
+  std::vector<opennsl_trunk_member_t> members(kMaxMemberPorts);
+  int memberCount = 0;
+  auto rv = opennsl_trunk_get(
+      hw_->getUnit(),
+      bcmTrunkID_,
+      &info,
+      members.size(),
+      members.data(),
+      &memberCount);
+  bcmCheckError(rv, "failed to get subports of trunk ", bcmTrunkID_);
+  members.resize(memberCount);
+
+  auto hasGport = [&members](opennsl_gport_t gport) {
+    return [gport](const opennsl_trunk_member_t& member) {
+      return member.gport == gport;
+    };
+  };
+  for (auto port : removed) {
+    auto gport = hw_->getPortTable()->getBcmPort(port)->getBcmGport();
+    members.erase(
+        std::remove_if(members.begin(), members.end(), hasGport(gport)),
+        members.end());
+  }
+  for (auto port : added) {
+    auto gport = hw_->getPortTable()->getBcmPort(port)->getBcmGport();
+    if (std::none_of(members.begin(), members.end(), hasGport(gport))) {
+      opennsl_trunk_member_t member;
+      opennsl_trunk_member_t_init(&member);
+      member.gport = gport;
+      members.push_back(member);
+    }
+  }
+
+  // A single opennsl_trunk_set swaps in the whole member set, so traffic
+  // never hashes over a half-updated trunk while a LAG flaps
+  rv = opennsl_trunk_set(
+      hw_->getUnit(), bcmTrunkID_, &info, members.size(), members.data());
+  bcmCheckError(rv, "failed to set subports for trunk ", bcmTrunkID_);
+
+  for (auto port : removed) {
+    trunkStats_.revokeMembership(port);
+  }
+  for (auto port : added) {
+    trunkStats_.grantMembership(port);
+  }
+  XLOG(INFO) << "added " << added.size() << " and deleted " << removed.size()
+             << " ports in trunk " << bcmTrunkID_ << ", which now has "
+             << members.size() << " members";
 }
 
 void BcmTrunk::modifyMemberPort(bool added, PortID memberPort) {
@@ -210,5 +277,9 @@ BcmTrunkStats& BcmTrunk::stats() {
   return trunkStats_;
 }
 
+const BcmTrunkStats& BcmTrunk::stats() const {
+  return trunkStats_;
+}
+
 } // namespace fboss
 } // namespace facebook
@@ -10,6 +10,7 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 
 extern "C" {
 #include <opennsl/types.h>
@@ -55,6 +56,7 @@ class BcmTrunk {
   static bool isValidTrunkPort(opennsl_gport_t gPort);
 
   BcmTrunkStats& stats();
+  const BcmTrunkStats& stats() const;
 
 private:
   static int rtag7();
@@ -64,6 +66,13 @@ private:
       AggregatePort::SubportAndForwardingStateConstRange oldRange,
       AggregatePort::SubportAndForwardingStateConstRange newRange);
   void modifyMemberPort(bool added, PortID memberPort);
+  // Adds and deletes several members with one update to the trunk
+  void modifyMemberPorts(
+      const std::vector<PortID>& added,
+      const std::vector<PortID>& removed);
+
+  // Upper bound on the members of a trunk we read back from hardware
+  static constexpr int kMaxMemberPorts = 64;
 
   // Forbidden copy constructor and assignment operator
   BcmTrunk(const BcmTrunk&) = delete;
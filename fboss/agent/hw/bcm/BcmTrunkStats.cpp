@@ -17,6 +17,68 @@
 #include <folly/logging/xlog.h>
 #include <chrono>
 
+namespace {
+using namespace facebook::fboss;
+
+/*
+ * The counters exported for each trunk, and the member port stats summed
+ * for them.
+ */
+struct TrunkCounter {
+  folly::StringPiece key;
+  int64_t HwPortStats::*memberField;
+  int64_t HwTrunkStats::*trunkField;
+};
+
+const TrunkCounter kTrunkCounters[] = {
+    {kInBytes(), &HwPortStats::inBytes_, &HwTrunkStats::inBytes_},
+    {kInUnicastPkts(),
+     &HwPortStats::inUnicastPkts_,
+     &HwTrunkStats::inUnicastPkts_},
+    {kInMulticastPkts(),
+     &HwPortStats::inMulticastPkts_,
+     &HwTrunkStats::inMulticastPkts_},
+    {kInBroadcastPkts(),
+     &HwPortStats::inBroadcastPkts_,
+     &HwTrunkStats::inBroadcastPkts_},
+    {kInDiscards(), &HwPortStats::inDiscards_, &HwTrunkStats::inDiscards_},
+    {kInDiscardsRaw(),
+     &HwPortStats::inDiscardsRaw_,
+     &HwTrunkStats::inDiscardsRaw_},
+    {kInErrors(), &HwPortStats::inErrors_, &HwTrunkStats::inErrors_},
+    {kInPause(), &HwPortStats::inPause_, &HwTrunkStats::inPause_},
+    {kInIpv4HdrErrors(),
+     &HwPortStats::inIpv4HdrErrors_,
+     &HwTrunkStats::inIpv4HdrErrors_},
+    {kInIpv6HdrErrors(),
+     &HwPortStats::inIpv6HdrErrors_,
+     &HwTrunkStats::inIpv6HdrErrors_},
+    {kInDstNullDiscards(),
+     &HwPortStats::inDstNullDiscards_,
+     &HwTrunkStats::inDstNullDiscards_},
+
+    {kOutBytes(), &HwPortStats::outBytes_, &HwTrunkStats::outBytes_},
+    {kOutUnicastPkts(),
+     &HwPortStats::outUnicastPkts_,
+     &HwTrunkStats::outUnicastPkts_},
+    {kOutMulticastPkts(),
+     &HwPortStats::outMulticastPkts_,
+     &HwTrunkStats::outMulticastPkts_},
+    {kOutBroadcastPkts(),
+     &HwPortStats::outBroadcastPkts_,
+     &HwTrunkStats::outBroadcastPkts_},
+    {kOutDiscards(), &HwPortStats::outDiscards_, &HwTrunkStats::outDiscards_},
+    {kOutErrors(), &HwPortStats::outErrors_, &HwTrunkStats::outErrors_},
+    {kOutPause(), &HwPortStats::outPause_, &HwTrunkStats::outPause_},
+    {kOutCongestionDiscards(),
+     &HwPortStats::outCongestionDiscardPkts_,
+     &HwTrunkStats::outCongestionDiscardPkts_},
+    {kOutEcnCounter(),
+     &HwPortStats::outEcnCounter_,
+     &HwTrunkStats::outEcnCounter_},
+};
+} // namespace
+
 namespace facebook {
 namespace fboss {
 
@@ -29,41 +91,19 @@ void BcmTrunkStats::initialize(
   aggregatePortID_ = aggPortID;
   trunkName_ = trunkName;
 
-  initializeCounter(kInBytes());
-  initializeCounter(kInUnicastPkts());
-  initializeCounter(kInMulticastPkts());
-  initializeCounter(kInBroadcastPkts());
-  initializeCounter(kInDiscards());
-  initializeCounter(kInDiscardsRaw());
-  initializeCounter(kInErrors());
-  initializeCounter(kInPause());
-  initializeCounter(kInIpv4HdrErrors());
-  initializeCounter(kInIpv6HdrErrors());
-  initializeCounter(kInDstNullDiscards());
-
-  initializeCounter(kOutBytes());
-  initializeCounter(kOutUnicastPkts());
-  initializeCounter(kOutMulticastPkts());
-  initializeCounter(kOutBroadcastPkts());
-  initializeCounter(kOutDiscards());
-  initializeCounter(kOutErrors());
-  initializeCounter(kOutPause());
-  initializeCounter(kOutCongestionDiscards());
-  initializeCounter(kOutEcnCounter());
-}
-
-void BcmTrunkStats::initializeCounter(folly::StringPiece counterKey) {
-  auto oldCounter = getCounterIf(counterKey);
-
-  auto externalCounterName = constructCounterName(counterKey);
-  auto newCounter =
-      stats::MonotonicCounter({externalCounterName, stats::SUM, stats::RATE});
-
-  if (oldCounter) {
-    oldCounter->swap(newCounter);
-    utility::deleteCounter(newCounter.getName());
-  } else {
-    counters_.emplace(counterKey.str(), std::move(newCounter));
+  // Renaming the trunk keeps the counters' values under their new names
+  bool renamed = !counters_.empty();
+  size_t i = 0;
+  for (const auto& trunkCounter : kTrunkCounters) {
+    auto externalCounterName = constructCounterName(trunkCounter.key);
+    auto newCounter =
+        stats::MonotonicCounter({externalCounterName, stats::SUM, stats::RATE});
+    if (renamed) {
+      counters_[i++].swap(newCounter);
+      utility::deleteCounter(newCounter.getName());
+    } else {
+      counters_.push_back(std::move(newCounter));
+    }
   }
 }
 
@@ -134,28 +174,9 @@ BcmTrunkStats::accumulateMemberStats() const {
       }
 
       auto memberStats = memberPort->getPortStats();
-      cumulativeSum.inBytes_ += memberStats.inBytes_;
-      cumulativeSum.inUnicastPkts_ += memberStats.inUnicastPkts_;
-      cumulativeSum.inMulticastPkts_ += memberStats.inMulticastPkts_;
-      cumulativeSum.inBroadcastPkts_ += memberStats.inBroadcastPkts_;
-      cumulativeSum.inDiscards_ += memberStats.inDiscards_;
-      cumulativeSum.inErrors_ += memberStats.inErrors_;
-      cumulativeSum.inPause_ += memberStats.inPause_;
-      cumulativeSum.inIpv4HdrErrors_ += memberStats.inIpv4HdrErrors_;
-      cumulativeSum.inIpv6HdrErrors_ += memberStats.inIpv6HdrErrors_;
-      cumulativeSum.inDiscardsRaw_ += memberStats.inDiscardsRaw_;
-      cumulativeSum.inDstNullDiscards_ +=
-          memberStats.inDstNullDiscards_;
-
-      cumulativeSum.outBytes_ += memberStats.outBytes_;
-      cumulativeSum.outUnicastPkts_ += memberStats.outUnicastPkts_;
-      cumulativeSum.outMulticastPkts_ += memberStats.outMulticastPkts_;
-      cumulativeSum.outBroadcastPkts_ += memberStats.outBroadcastPkts_;
-      cumulativeSum.outDiscards_ += memberStats.outDiscards_;
-      cumulativeSum.outErrors_ += memberStats.outErrors_;
-      cumulativeSum.outPause_ += memberStats.outPause_;
-      cumulativeSum.outCongestionDiscardPkts_ +=
-          memberStats.outCongestionDiscardPkts_;
+      for (const auto& counter : kTrunkCounters) {
+        cumulativeSum.*counter.trunkField += memberStats.*counter.memberField;
+      }
 
       if (!timeRetrievedFromMemberPort) {
         timeRetrieved = memberPort->getTimeRetrieved();
@@ -168,48 +189,9 @@ BcmTrunkStats::accumulateMemberStats() const {
 }
 
 void BcmTrunkStats::clearHwTrunkStats(HwTrunkStats& stats) {
-  stats.inBytes_            = 0;
-  stats.inUnicastPkts_      = 0;
-  stats.inMulticastPkts_    = 0;
-  stats.inBroadcastPkts_    = 0;
-  stats.inDiscards_         = 0;
-  stats.inErrors_           = 0;
-  stats.inPause_            = 0;
-  stats.inIpv4HdrErrors_    = 0;
-  stats.inIpv6HdrErrors_    = 0;
-  stats.inDiscardsRaw_      = 0;
-  stats.inDstNullDiscards_ = 0;
-
-  stats.outBytes_                 = 0;
-  stats.outUnicastPkts_           = 0;
-  stats.outMulticastPkts_         = 0;
-  stats.outBroadcastPkts_         = 0;
-  stats.outDiscards_              = 0;
-  stats.outErrors_                = 0;
-  stats.outPause_                 = 0;
-  stats.outCongestionDiscardPkts_ = 0;
-}
-
-stats::MonotonicCounter* FOLLY_NULLABLE BcmTrunkStats::getCounterIf(
-    folly::StringPiece counterKey) {
-  auto it = counters_.find(counterKey.str());
-  if (it == counters_.end()) {
-    return nullptr;
+  for (const auto& counter : kTrunkCounters) {
+    stats.*counter.trunkField = 0;
   }
-
-  return &(it->second);
-}
-
-void BcmTrunkStats::updateCounter(
-    std::chrono::seconds now,
-    folly::StringPiece counterKey,
-    int64_t value) {
-  auto counter = getCounterIf(counterKey);
-  if (!counter) {
-    return;
-  }
-
-  counter->updateValue(now, value);
 }
 
 void BcmTrunkStats::update() {
@@ -218,26 +200,10 @@ void BcmTrunkStats::update() {
 
   std::tie(stats, then) = accumulateMemberStats();
 
-  updateCounter(then, kInBytes(), stats.inBytes_);
-  updateCounter(then, kInUnicastPkts(), stats.inUnicastPkts_);
-  updateCounter(then, kInMulticastPkts(), stats.inMulticastPkts_);
-  updateCounter(then, kInBroadcastPkts(), stats.inBroadcastPkts_);
-  updateCounter(then, kInDiscards(), stats.inDiscards_);
-  updateCounter(then, kInErrors(), stats.inErrors_);
-  updateCounter(then, kInPause(), stats.inPause_);
-  updateCounter(then, kInIpv4HdrErrors(), stats.inIpv4HdrErrors_);
-  updateCounter(then, kInIpv6HdrErrors(), stats.inIpv6HdrErrors_);
-
-  updateCounter(then, kOutBytes(), stats.outBytes_);
-  updateCounter(then, kOutUnicastPkts(), stats.outUnicastPkts_);
-  updateCounter(then, kOutMulticastPkts(), stats.outMulticastPkts_);
-  updateCounter(then, kOutBroadcastPkts(), stats.outBroadcastPkts_);
-  updateCounter(then, kOutDiscards(), stats.outDiscards_);
-  updateCounter(then, kOutErrors(), stats.outErrors_);
-  updateCounter(then, kOutPause(), stats.outPause_);
-  updateCounter(
-      then, kOutCongestionDiscards(), stats.outCongestionDiscardPkts_);
-  updateCounter(then, kOutEcnCounter(), stats.outEcnCounter_);
+  for (size_t i = 0; i < counters_.size(); ++i) {
+    counters_[i].updateValue(then, stats.*kTrunkCounters[i].trunkField);
+  }
+  *lastStats_.wlock() = std::move(stats);
 }
 
 std::string BcmTrunkStats::constructCounterName(
@@ -15,13 +15,12 @@
 #include "fboss/agent/types.h"
 
 #include <boost/container/flat_set.hpp>
-#include <folly/CppAttributes.h>
 #include <folly/Range.h>
 #include <folly/Synchronized.h>
 
-#include <map>
 #include <string>
 #include <utility>
+#include <vector>
 
 namespace facebook {
 namespace fboss {
@@ -38,6 +37,14 @@ class BcmTrunkStats {
   void grantMembership(PortID memberPortID);
   void revokeMembership(PortID memberPortID);
 
+  /*
+   * The member ports' stats as summed by the last update(), so readers need
+   * neither add them up again nor look up the exported counters by name.
+   */
+  HwTrunkStats getHwTrunkStats() const {
+    return *lastStats_.rlock();
+  }
+
  private:
   BcmTrunkStats(const BcmTrunkStats&) = delete;
   BcmTrunkStats& operator=(const BcmTrunkStats&) = delete;
@@ -46,14 +53,6 @@ class BcmTrunkStats {
   static void clearHwTrunkStats(HwTrunkStats& stats);
   std::pair<HwTrunkStats, std::chrono::seconds> accumulateMemberStats() const;
 
-  // Helpers which operate on an individual counter
-  void initializeCounter(folly::StringPiece counterKey);
-  stats::MonotonicCounter* FOLLY_NULLABLE
-  getCounterIf(folly::StringPiece counterKey);
-  void updateCounter(
-      std::chrono::seconds now,
-      folly::StringPiece counterKey,
-      int64_t value);
   std::string constructCounterName(folly::StringPiece counterKey) const;
 
   const BcmSwitch* const hw_;
@@ -64,7 +63,9 @@ class BcmTrunkStats {
       folly::Synchronized<boost::container::flat_set<PortID>>;
   SynchronizedPortIDs memberPortIDs_;
 
-  std::map<std::string, stats::MonotonicCounter> counters_;
+  // One per entry of kTrunkCounters, in the same order
+  std::vector<stats::MonotonicCounter> counters_;
+  folly::Synchronized<HwTrunkStats> lastStats_;
 };
 
 } // namespace fboss
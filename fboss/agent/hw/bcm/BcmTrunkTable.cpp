@@ -148,5 +148,13 @@ void BcmTrunkTable::updateStats() {
     trunk->stats().update();
   }
 }
+
+HwTrunkStats BcmTrunkTable::getHwTrunkStats(AggregatePortID id) const {
+  auto iter = trunks_.find(id);
+  if (iter == trunks_.end()) {
+    throw FbossError("Cannot find the BCM trunk for aggregatePort ", id);
+  }
+  return iter->second->stats().getHwTrunkStats();
+}
 } // namespace fboss
 } // namespace facebook
@@ -19,6 +19,7 @@ extern "C" {
 #include <folly/dynamic.h>
 
 #include "fboss/agent/hw/bcm/MinimumLinkCountMap.h"
+#include "fboss/agent/hw/gen-cpp2/hardware_stats_types.h"
 #include "fboss/agent/types.h"
 
 namespace facebook {
@@ -52,6 +53,8 @@ class BcmTrunkTable {
   opennsl_trunk_t linkDownHwNotLocked(opennsl_port_t port);
 
   void updateStats();
+  // The trunk's stats as of the last updateStats()
+  HwTrunkStats getHwTrunkStats(AggregatePortID id) const;
   // Setup trunking machinery
   void setupTrunking();
 
@@ -11,6 +11,7 @@
 
 #include "fboss/agent/hw/bcm/BcmError.h"
 #include "fboss/agent/hw/bcm/BcmStats.h"
+#include "fboss/agent/hw/bcm/BcmTxPacketPool.h"
 
 
 extern "C" {
@@ -24,10 +25,7 @@ namespace {
 
 using namespace facebook::fboss;
 void freeTxBuf(void* /*ptr*/, void* arg) {
-  opennsl_pkt_t* pkt = reinterpret_cast<opennsl_pkt_t*>(arg);
-  int rv = opennsl_pkt_free(pkt->unit, pkt);
-  bcmLogError(rv, "Failed to free packet");
-  BcmStats::get()->txPktFree();
+  BcmTxPacketPool::get()->free(static_cast<BcmTxPacketPool::Entry*>(arg));
 }
 
 inline void txCallbackImpl(int /*unit*/, opennsl_pkt_t* pkt, void* cookie) {
@@ -49,29 +47,13 @@ inline void txCallbackImpl(int /*unit*/, opennsl_pkt_t* pkt, void* cookie) {
 
 namespace facebook { namespace fboss {
 
-std::mutex& BcmTxPacket::syncPktMutex() {
-  static std::mutex _syncPktMutex;
-  return _syncPktMutex;
-}
-
-std::condition_variable& BcmTxPacket::syncPktCV() {
-  static std::condition_variable _syncPktCV;
-  return _syncPktCV;
-}
-
-bool& BcmTxPacket::syncPacketSent() {
-  static bool _syncPktSent{false};
-  return _syncPktSent;
-}
-
 BcmTxPacket::BcmTxPacket(int unit, uint32_t size)
     : queued_(std::chrono::time_point<std::chrono::steady_clock>::min()) {
-  int rv = opennsl_pkt_alloc(unit, size,
-                             OPENNSL_TX_CRC_APPEND | OPENNSL_TX_ETHER, &pkt_);
-  bcmCheckError(rv, "Failed to allocate packet.");
-  buf_ = IOBuf::takeOwnership(pkt_->pkt_data->data, size,
-                              freeTxBuf, reinterpret_cast<void*>(pkt_));
-  BcmStats::get()->txPktAlloc();
+  auto entry = BcmTxPacketPool::get()->alloc(unit, size);
+  pkt_ = entry->pkt;
+  // The pooled buffer may be larger than asked for, offer all of it
+  buf_ = IOBuf::takeOwnership(entry->data, entry->capacity, size,
+                              freeTxBuf, entry);
 }
 
 void BcmTxPacket::enableHiGigHeader() {
@@ -115,10 +97,10 @@ void BcmTxPacket::txCallbackAsync(int unit, opennsl_pkt_t* pkt, void* cookie) {
 }
 
 void BcmTxPacket::txCallbackSync(int unit, opennsl_pkt_t* pkt, void* cookie) {
+  // txCallbackImpl deletes the packet
+  auto sent = static_cast<BcmTxPacket*>(cookie)->syncSent_;
   txCallbackImpl(unit, pkt, cookie);
-  std::lock_guard<std::mutex> lk(syncPktMutex());
-  syncPacketSent() = true;
-  syncPktCV().notify_one();
+  sent->post();
 }
 
 int BcmTxPacket::sendAsync(unique_ptr<BcmTxPacket> pkt) noexcept {
@@ -132,20 +114,15 @@ int BcmTxPacket::sendSync(unique_ptr<BcmTxPacket> pkt) noexcept {
   opennsl_pkt_t* bcmPkt = pkt->pkt_;
   DCHECK(bcmPkt->call_back == nullptr);
   bcmPkt->call_back = BcmTxPacket::txCallbackSync;
-  {
-    std::lock_guard<std::mutex> lk{syncPktMutex()};
-    syncPacketSent() = false;
-  }
-  // Give up the lock when calling sendPacketImpl. Callback
-  // on packet send complete, maybe invoked immediately on
-  // the same thread. Since the callback needs to acquire
-  // the same lock (to mark send as done). We need to give
-  // up the lock here to avoid deadlock. Further since
-  // sendImpl does not update any shared data structures
-  // its optimal to give up the lock anyways.
+  folly::Baton<> sent;
+  pkt->syncSent_ = &sent;
+  // The completion callback may run right away on this thread, before
+  // sendImpl returns. Only wait for it if the packet was actually queued,
+  // a failed send never calls back.
   auto rv = sendImpl(std::move(pkt));
-  std::unique_lock<std::mutex> lk{syncPktMutex()};
-  syncPktCV().wait(lk, [] { return syncPacketSent(); });
+  if (OPENNSL_SUCCESS(rv)) {
+    sent.wait();
+  }
   return rv;
 }
 
@@ -10,8 +10,8 @@
 #pragma once
 
 #include <chrono>
-#include <mutex>
-#include <condition_variable>
+
+#include <folly/synchronization/Baton.h>
 
 #include "fboss/agent/TxPacket.h"
 
@@ -83,13 +83,12 @@ class BcmTxPacket : public TxPacket {
   BcmTxPacket& operator=(BcmTxPacket const &) = delete;
   void enableHiGigHeader();
 
-  // Synchronization around synchrnous packet sending
-  static std::mutex& syncPktMutex();
-  static std::condition_variable& syncPktCV();
-  static bool& syncPacketSent();
-
   opennsl_pkt_t* pkt_{nullptr};
 
+  // Posted by txCallbackSync once a synchronous send completes. Each
+  // sendSync() waits on its own, so concurrent senders don't serialize.
+  folly::Baton<>* syncSent_{nullptr};
+
   // time point when the packet is queued to HW
   TimePoint queued_;
 };
@@ -0,0 +1,138 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/hw/bcm/BcmTxPacketPool.h"
+
+#include "common/stats/ServiceData.h"
+#include "fboss/agent/SwitchStats.h"
+#include "fboss/agent/hw/bcm/BcmError.h"
+#include "fboss/agent/hw/bcm/BcmStats.h"
+
+#include <gflags/gflags.h>
+
+#include <algorithm>
+
+extern "C" {
+#include <opennsl/tx.h>
+}
+
+DEFINE_int32(
+    bcm_tx_pool_size,
+    256,
+    "Number of freed tx packet buffers kept for reuse per size class");
+
+namespace {
+// Enough for control packets, a 1500 byte MTU frame, and a 9000 byte one
+constexpr uint32_t kSizeClasses[] = {256, 2048, 10240};
+constexpr uint32_t kTxFlags = OPENNSL_TX_CRC_APPEND | OPENNSL_TX_ETHER;
+}
+
+namespace facebook { namespace fboss {
+
+BcmTxPacketPool* BcmTxPacketPool::get() {
+  // Never destroyed, packets can still be freed while the process exits
+  static BcmTxPacketPool* pool = new BcmTxPacketPool();
+  return pool;
+}
+
+BcmTxPacketPool::BcmTxPacketPool() {
+  auto depth = static_cast<size_t>(std::max(1, FLAGS_bcm_tx_pool_size));
+  for (auto size : kSizeClasses) {
+    classes_.push_back(std::make_unique<SizeClass>(size, depth));
+  }
+}
+
+BcmTxPacketPool::Entry* BcmTxPacketPool::alloc(int unit, uint32_t size) {
+  int sizeClass = -1;
+  for (size_t i = 0; i < classes_.size(); ++i) {
+    if (size <= classes_[i]->size) {
+      sizeClass = i;
+      break;
+    }
+  }
+
+  Entry* entry{nullptr};
+  if (sizeClass >= 0 && classes_[sizeClass]->free.read(entry)) {
+    if (entry->pkt->unit == unit) {
+      // Undo whatever the last user of the packet changed
+      auto pkt = entry->pkt;
+      auto rv = opennsl_pkt_flags_init(unit, pkt, kTxFlags);
+      bcmCheckError(rv, "Failed to reset pooled packet");
+      OPENNSL_PBMP_CLEAR(pkt->tx_pbmp);
+      OPENNSL_PBMP_CLEAR(pkt->tx_upbmp);
+      pkt->cos = 0;
+      pkt->call_back = nullptr;
+      pkt->pkt_data->data = entry->data;
+      pkt->pkt_data->len = entry->capacity;
+    } else {
+      freeToSdk(entry);
+      entry = nullptr;
+    }
+  }
+
+  if (!entry) {
+    if (sizeClass >= 0) {
+      BcmStats::get()->txPktPoolEmpty();
+    }
+    auto capacity = sizeClass >= 0 ? classes_[sizeClass]->size : size;
+    opennsl_pkt_t* pkt{nullptr};
+    auto rv = opennsl_pkt_alloc(unit, capacity, kTxFlags, &pkt);
+    bcmCheckError(rv, "Failed to allocate packet.");
+    BcmStats::get()->txPktAlloc();
+    entry = new Entry();
+    entry->pkt = pkt;
+    entry->data = pkt->pkt_data->data;
+    entry->capacity = capacity;
+    entry->sizeClass = sizeClass;
+  }
+
+  auto inUse = ++inUse_;
+  auto highWatermark = inUseHighWatermark_.load();
+  while (inUse > highWatermark &&
+         !inUseHighWatermark_.compare_exchange_weak(highWatermark, inUse)) {
+  }
+  return entry;
+}
+
+void BcmTxPacketPool::free(Entry* entry) noexcept {
+  --inUse_;
+  if (entry->sizeClass < 0 || !classes_[entry->sizeClass]->free.write(entry)) {
+    freeToSdk(entry);
+  }
+}
+
+void BcmTxPacketPool::clear() {
+  for (auto& sizeClass : classes_) {
+    Entry* entry{nullptr};
+    while (sizeClass->free.read(entry)) {
+      freeToSdk(entry);
+    }
+  }
+}
+
+void BcmTxPacketPool::freeToSdk(Entry* entry) noexcept {
+  int rv = opennsl_pkt_free(entry->pkt->unit, entry->pkt);
+  bcmLogError(rv, "Failed to free packet");
+  BcmStats::get()->txPktFree();
+  delete entry;
+}
+
+void BcmTxPacketPool::publishStats() const {
+  int64_t free{0};
+  for (const auto& sizeClass : classes_) {
+    free += std::max<ssize_t>(sizeClass->free.size(), 0);
+  }
+  auto prefix = SwitchStats::kCounterPrefix + "bcm.tx.pkt.pool.";
+  fbData->setCounter(prefix + "in_use", inUse_.load());
+  fbData->setCounter(
+      prefix + "in_use.high_watermark", inUseHighWatermark_.load());
+  fbData->setCounter(prefix + "free", free);
+}
+
+}} // facebook::fboss
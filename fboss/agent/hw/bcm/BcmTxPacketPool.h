@@ -0,0 +1,83 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include <folly/MPMCQueue.h>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+extern "C" {
+#include <opennsl/pkt.h>
+}
+
+namespace facebook { namespace fboss {
+
+/*
+ * Free lists of SDK packets, by buffer size class, backing BcmTxPacket.
+ *
+ * Every packet we generate (Arp/Ndp, LLDP, LACP, traffic forwarded from the
+ * tun interfaces) needs a DMA buffer, and allocating one from the SDK is
+ * much slower than the packet it carries. Freed packets that fit a size
+ * class are kept, up to --bcm_tx_pool_size per class, and handed out again
+ * instead. Packets larger than the largest class are never pooled.
+ */
+class BcmTxPacketPool {
+ public:
+  /*
+   * One SDK packet and its DMA buffer. Stays with the buffer for as long as
+   * it is pooled, so it can ride along as the IOBuf free function argument.
+   */
+  struct Entry {
+    opennsl_pkt_t* pkt{nullptr};
+    // start of the DMA buffer, and its size
+    uint8_t* data{nullptr};
+    uint32_t capacity{0};
+    // index into classes_, or -1 if not pooled
+    int sizeClass{-1};
+  };
+
+  static BcmTxPacketPool* get();
+
+  /*
+   * Get a packet with room for at least size bytes, set up as if it had
+   * just been allocated from the SDK. Throws if the SDK is out of memory.
+   */
+  Entry* alloc(int unit, uint32_t size);
+  // Return a packet once nothing references its buffer anymore
+  void free(Entry* entry) noexcept;
+
+  // Give every pooled packet back to the SDK, e.g. before detaching a unit
+  void clear();
+
+  // Export in use and free counts, and the in use high watermark
+  void publishStats() const;
+
+ private:
+  BcmTxPacketPool();
+  // Forbidden copy constructor and assignment operator
+  BcmTxPacketPool(BcmTxPacketPool const&) = delete;
+  BcmTxPacketPool& operator=(BcmTxPacketPool const&) = delete;
+
+  struct SizeClass {
+    SizeClass(uint32_t size, size_t depth) : size(size), free(depth) {}
+    const uint32_t size;
+    folly::MPMCQueue<Entry*> free;
+  };
+
+  static void freeToSdk(Entry* entry) noexcept;
+
+  std::vector<std::unique_ptr<SizeClass>> classes_;
+  std::atomic<int64_t> inUse_{0};
+  std::atomic<int64_t> inUseHighWatermark_{0};
+};
+
+}} // facebook::fboss
@@ -0,0 +1,84 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/hw/bcm/BcmTxRing.h"
+
+#include "fboss/agent/Utils.h"
+#include "fboss/agent/hw/bcm/BcmStats.h"
+
+#include <gflags/gflags.h>
+
+#include <algorithm>
+
+DEFINE_int32(
+    bcm_tx_ring_batch_size,
+    128,
+    "Max packets the tx ring thread hands to the SDK per wakeup");
+
+using std::chrono::duration_cast;
+using std::chrono::microseconds;
+using std::chrono::steady_clock;
+
+namespace facebook { namespace fboss {
+
+BcmTxRing::BcmTxRing(size_t depth) : ring_(depth) {
+  thread_ = std::make_unique<std::thread>([this] {
+    initThread("fbossBcmTxRing");
+    txLoop();
+  });
+}
+
+BcmTxRing::~BcmTxRing() {
+  // A null packet tells the tx thread to exit, once everything queued ahead
+  // of it has been sent
+  ring_.blockingWrite(Entry{nullptr, steady_clock::now()});
+  thread_->join();
+}
+
+bool BcmTxRing::enqueue(std::unique_ptr<BcmTxPacket> pkt) noexcept {
+  if (!ring_.write(Entry{std::move(pkt), steady_clock::now()})) {
+    BcmStats::get()->txRingDrop();
+    return false;
+  }
+  BcmStats::get()->txRingDepth(std::max<ssize_t>(ring_.size(), 0));
+  return true;
+}
+
+void BcmTxRing::txLoop() {
+  auto batchSize = std::max(1, FLAGS_bcm_tx_ring_batch_size);
+  while (true) {
+    Entry entry;
+    ring_.blockingRead(entry);
+    int sent = 0;
+    bool done = false;
+    do {
+      if (!entry.pkt) {
+        done = true;
+        break;
+      }
+      send(std::move(entry));
+      ++sent;
+    } while (sent < batchSize && ring_.read(entry));
+    if (sent > 0) {
+      BcmStats::get()->txRingBatch(sent);
+    }
+    if (done) {
+      return;
+    }
+  }
+}
+
+void BcmTxRing::send(Entry entry) noexcept {
+  BcmStats::get()->txRingLatency(
+      duration_cast<microseconds>(steady_clock::now() - entry.queued));
+  // Errors are logged and counted by sendAsync
+  BcmTxPacket::sendAsync(std::move(entry.pkt));
+}
+
+}} // facebook::fboss
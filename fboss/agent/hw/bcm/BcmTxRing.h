@@ -0,0 +1,60 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include "fboss/agent/hw/bcm/BcmTxPacket.h"
+
+#include <folly/MPMCQueue.h>
+
+#include <chrono>
+#include <memory>
+#include <thread>
+
+namespace facebook { namespace fboss {
+
+/*
+ * BcmTxRing takes asynchronously sent packets off the sending threads.
+ * Senders only queue the packet, and a dedicated thread hands everything
+ * queued since its last wakeup to the SDK in one go. A burst, like LLDP or
+ * LACP going out of every port at once, then costs the senders one queue
+ * write per packet rather than a trip through opennsl_tx() each.
+ *
+ * Packets that find the ring full are dropped.
+ */
+class BcmTxRing {
+ public:
+  explicit BcmTxRing(size_t depth);
+  // Sends whatever is still queued before returning
+  ~BcmTxRing();
+
+  /*
+   * Queue pkt to be sent. Returns false if the ring is full, in which case
+   * the packet is dropped. Safe to call from any thread.
+   */
+  bool enqueue(std::unique_ptr<BcmTxPacket> pkt) noexcept;
+
+ private:
+  // Forbidden copy constructor and assignment operator
+  BcmTxRing(BcmTxRing const&) = delete;
+  BcmTxRing& operator=(BcmTxRing const&) = delete;
+
+  struct Entry {
+    std::unique_ptr<BcmTxPacket> pkt;
+    std::chrono::steady_clock::time_point queued;
+  };
+
+  void txLoop();
+  void send(Entry entry) noexcept;
+
+  folly::MPMCQueue<Entry> ring_;
+  std::unique_ptr<std::thread> thread_;
+};
+
+}} // facebook::fboss
@@ -0,0 +1,69 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/hw/bcm/BcmVlanPortUpdate.h"
+
+#include "fboss/agent/hw/bcm/BcmError.h"
+#include "fboss/agent/hw/bcm/BcmSdkTracer.h"
+
+#include <folly/logging/xlog.h>
+
+extern "C" {
+#include <opennsl/vlan.h>
+}
+
+namespace facebook { namespace fboss {
+
+BcmVlanPortUpdate::VlanPorts::VlanPorts() {
+  OPENNSL_PBMP_CLEAR(added);
+  OPENNSL_PBMP_CLEAR(addedUntagged);
+  OPENNSL_PBMP_CLEAR(removed);
+}
+
+void BcmVlanPortUpdate::addPort(
+    VlanID vlan,
+    opennsl_port_t port,
+    bool tagged) {
+  auto& ports = vlans_[vlan];
+  OPENNSL_PBMP_PORT_ADD(ports.added, port);
+  if (!tagged) {
+    OPENNSL_PBMP_PORT_ADD(ports.addedUntagged, port);
+  }
+  ports.hasAdded = true;
+}
+
+void BcmVlanPortUpdate::removePort(VlanID vlan, opennsl_port_t port) {
+  auto& ports = vlans_[vlan];
+  OPENNSL_PBMP_PORT_ADD(ports.removed, port);
+  ports.hasRemoved = true;
+}
+
+void BcmVlanPortUpdate::apply(int unit) {
+  if (vlans_.empty()) {
+    return;
+  }
+  for (const auto& vlanAndPorts : vlans_) {
+    auto vlan = vlanAndPorts.first;
+    const auto& ports = vlanAndPorts.second;
+    if (ports.hasRemoved) {
+      auto rv = BCM_SDK_TRACE(opennsl_vlan_port_remove, unit, vlan,
+          ports.removed);
+      bcmCheckError(rv, "failed to remove ports from VLAN ", vlan);
+    }
+    if (ports.hasAdded) {
+      auto rv = BCM_SDK_TRACE(opennsl_vlan_port_add, unit, vlan, ports.added,
+          ports.addedUntagged);
+      bcmCheckError(rv, "failed to add ports to VLAN ", vlan);
+    }
+  }
+  XLOG(DBG2) << "updated the ports of " << vlans_.size() << " VLANs";
+  vlans_.clear();
+}
+
+}} // facebook::fboss
@@ -0,0 +1,65 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+extern "C" {
+#include <opennsl/types.h>
+}
+
+#include "fboss/agent/types.h"
+
+#include <map>
+
+namespace facebook { namespace fboss {
+
+/*
+ * VLAN membership changes for any number of ports, programmed with one
+ * removal and one addition per VLAN rather than a call per port and VLAN.
+ *
+ * Flex port reconfiguration and config pushes enable, disable or move many
+ * ports at once, each in several VLANs, so the changes are collected here
+ * and applied together.
+ */
+class BcmVlanPortUpdate {
+ public:
+  BcmVlanPortUpdate() {}
+
+  void addPort(VlanID vlan, opennsl_port_t port, bool tagged);
+  void removePort(VlanID vlan, opennsl_port_t port);
+
+  bool empty() const {
+    return vlans_.empty();
+  }
+
+  /*
+   * Remove, then add, the ports of each VLAN. A port both removed and added
+   * is re-added, which is how a port's tagging in a VLAN is changed.
+   */
+  void apply(int unit);
+
+ private:
+  struct VlanPorts {
+    VlanPorts();
+
+    opennsl_pbmp_t added;
+    opennsl_pbmp_t addedUntagged;
+    opennsl_pbmp_t removed;
+    bool hasAdded{false};
+    bool hasRemoved{false};
+  };
+
+  // Forbidden copy constructor and assignment operator
+  BcmVlanPortUpdate(BcmVlanPortUpdate const &) = delete;
+  BcmVlanPortUpdate& operator=(BcmVlanPortUpdate const &) = delete;
+
+  std::map<VlanID, VlanPorts> vlans_;
+};
+
+}} // facebook::fboss
@@ -10,15 +10,19 @@
 #include "BcmWarmBootCache.h"
 #include <sstream>
 #include <algorithm>
+#include <future>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include <folly/Conv.h>
 #include <folly/dynamic.h>
 #include <folly/json.h>
 #include <folly/logging/xlog.h>
 
+#include "fboss/agent/BootTrace.h"
 #include "fboss/agent/Constants.h"
+#include "fboss/agent/RestartTimeTracker.h"
 #include "fboss/agent/SysError.h"
 #include "fboss/agent/hw/bcm/BcmAclTable.h"
 #include "fboss/agent/hw/bcm/BcmAddressFBConvertors.h"
@@ -150,15 +154,18 @@ folly::dynamic BcmWarmBootCache::getWarmBootState() const {
   return hw_->getPlatform()->getWarmBootHelper()->getWarmBootState();
 }
 
-void BcmWarmBootCache::populateFromWarmBootState(const folly::dynamic&
-    warmBootState) {
-
-  dumpedSwSwitchState_ =
-    SwitchState::uniquePtrFromFollyDynamic(warmBootState[kSwSwitch]);
-  dumpedSwSwitchState_->publish();
+void BcmWarmBootCache::populateSwitchStateFromWarmBootState(
+    const folly::dynamic& swSwitchState) {
+  boot_trace::Span span("BcmWarmBootCache::decodeSwitchState");
+  dumpedSwSwitchState_ = SwitchState::uniquePtrFromFollyDynamic(swSwitchState);
   CHECK(dumpedSwSwitchState_)
       << "Was not able to recover software state after warmboot";
+  dumpedSwSwitchState_->publish();
+  restart_time::mark(RestartEvent::WARM_BOOT_SW_STATE_DECODED);
+}
 
+void BcmWarmBootCache::populateFromWarmBootState(const folly::dynamic&
+    warmBootState) {
   // Extract ecmps for dumped host table
   auto hostTable = warmBootState[kHwSwitch][kHostTable];
   for (const auto& ecmpEntry : hostTable[kEcmpHosts]) {
@@ -246,11 +253,60 @@ BcmWarmBootCache::findEgressFromHost(
 }
 
 void BcmWarmBootCache::populate(folly::Optional<folly::dynamic> warmBootState) {
-  if (warmBootState) {
-    populateFromWarmBootState(*warmBootState);
-  } else {
-    populateFromWarmBootState(getWarmBootState());
+  boot_trace::Span span("BcmWarmBootCache::populate");
+  if (!warmBootState) {
+    warmBootState = getWarmBootState();
+  }
+  const folly::dynamic& savedState = *warmBootState;
+
+  // Decoding the saved SwitchState is the most expensive part of processing
+  // the warm boot file, and nothing read from hardware depends on it, so do
+  // it while the hardware tables are traversed.
+  auto swStateDecoded = std::async(std::launch::async, [this, &savedState]() {
+    populateSwitchStateFromWarmBootState(savedState[kSwSwitch]);
+  });
+  // The egress and ecmp traversals need the ecmp paths and host egresses
+  // saved by the BcmSwitch.
+  populateFromWarmBootState(savedState);
+
+  // Each table type fills in its own maps, so they can be read in parallel.
+  opennsl_l3_info_t l3Info;
+  opennsl_l3_info_t_init(&l3Info);
+  opennsl_l3_info(hw_->getUnit(), &l3Info);
+  std::vector<std::future<void>> tablesRead;
+  tablesRead.push_back(
+      std::async(std::launch::async, [this, &l3Info]() {
+        populateHosts(l3Info);
+      }));
+  tablesRead.push_back(
+      std::async(std::launch::async, [this, &l3Info]() {
+        populateRoutes(l3Info);
+      }));
+  tablesRead.push_back(
+      std::async(std::launch::async, [this]() { populateEgresses(); }));
+
+  populateVlans();
+  // populate acls, acl stats
+  populateAcls(
+    kACLFieldGroupID,
+    this->aclEntry2AclStat_,
+    this->priority2BcmAclEntryHandle_);
+
+  populateRtag7State();
+  populateMirrors();
+  populateMirroredPorts();
+  populateIngressQosMaps();
+  populateLabelSwitchActions();
+
+  // Rethrow any error from the other threads
+  for (auto& tableRead : tablesRead) {
+    tableRead.get();
   }
+  swStateDecoded.get();
+  restart_time::mark(RestartEvent::WARM_BOOT_CACHE_POPULATED);
+}
+
+void BcmWarmBootCache::populateVlans() {
   opennsl_vlan_data_t* vlanList = nullptr;
   int vlanCount = 0;
   SCOPE_EXIT {
@@ -301,9 +357,10 @@ void BcmWarmBootCache::populate(folly::Optional<folly::dynamic> warmBootState) {
       }
     }
   }
-  opennsl_l3_info_t l3Info;
-  opennsl_l3_info_t_init(&l3Info);
-  opennsl_l3_info(hw_->getUnit(), &l3Info);
+}
+
+void BcmWarmBootCache::populateHosts(const opennsl_l3_info_t& l3Info) {
+  boot_trace::Span span("BcmWarmBootCache::populateHosts");
   // Traverse V4 hosts
   opennsl_l3_host_traverse(hw_->getUnit(), 0, 0, l3Info.l3info_max_host,
       hostTraversalCallback, this);
@@ -312,6 +369,11 @@ void BcmWarmBootCache::populate(folly::Optional<folly::dynamic> warmBootState) {
       // Diag shell uses this for getting # of v6 host entries
       l3Info.l3info_max_host / 2,
       hostTraversalCallback, this);
+  restart_time::mark(RestartEvent::WARM_BOOT_HOSTS_READ);
+}
+
+void BcmWarmBootCache::populateRoutes(const opennsl_l3_info_t& l3Info) {
+  boot_trace::Span span("BcmWarmBootCache::populateRoutes");
   // Traverse V4 routes
   opennsl_l3_route_traverse(hw_->getUnit(), 0, 0, l3Info.l3info_max_route,
       routeTraversalCallback, this);
@@ -320,23 +382,17 @@ void BcmWarmBootCache::populate(folly::Optional<folly::dynamic> warmBootState) {
       // Diag shell uses this for getting # of v6 route entries
       l3Info.l3info_max_route / 2,
       routeTraversalCallback, this);
+  restart_time::mark(RestartEvent::WARM_BOOT_ROUTES_READ);
+}
+
+void BcmWarmBootCache::populateEgresses() {
+  boot_trace::Span span("BcmWarmBootCache::populateEgresses");
   // Get egress entries.
   opennsl_l3_egress_traverse(hw_->getUnit(), egressTraversalCallback, this);
   // Traverse ecmp egress entries
   opennsl_l3_egress_ecmp_traverse(hw_->getUnit(), ecmpEgressTraversalCallback,
       this);
-
-  // populate acls, acl stats
-  populateAcls(
-    kACLFieldGroupID,
-    this->aclEntry2AclStat_,
-    this->priority2BcmAclEntryHandle_);
-
-  populateRtag7State();
-  populateMirrors();
-  populateMirroredPorts();
-  populateIngressQosMaps();
-  populateLabelSwitchActions();
+  restart_time::mark(RestartEvent::WARM_BOOT_EGRESSES_READ);
 }
 
 bool BcmWarmBootCache::fillVlanPortInfo(Vlan* vlan) {
@@ -21,11 +21,14 @@ extern "C" {
 #include <folly/MacAddress.h>
 #include <folly/Optional.h>
 #include <folly/dynamic.h>
+#include <folly/hash/Hash.h>
 #include <folly/logging/xlog.h>
 #include <algorithm>
 #include <list>
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include "fboss/agent/hw/bcm/BcmMirror.h"
 #include "fboss/agent/hw/bcm/BcmQosMap.h"
@@ -55,6 +58,11 @@ class BcmWarmBootCache {
  public:
   explicit BcmWarmBootCache(const BcmSwitchIf* hw);
   folly::dynamic getWarmBootStateFollyDynamic() const;
+  /*
+   * Rebuild the cache from the saved warm boot state and the hardware
+   * tables. The saved SwitchState is decoded, and the host, route and
+   * egress tables are traversed, on separate threads.
+   */
   void populate(folly::Optional<folly::dynamic> warmBootState = folly::none);
   struct VlanInfo {
     VlanInfo(VlanID _vlan, opennsl_pbmp_t _untagged, opennsl_pbmp_t _allPorts,
@@ -80,7 +88,7 @@ class BcmWarmBootCache {
   typedef opennsl_if_t EcmpEgressId;
   typedef opennsl_if_t EgressId;
   typedef boost::container::flat_multiset<EgressId> EgressIds;
-  typedef boost::container::flat_map<EcmpEgressId, EgressIds> Ecmp2EgressIds;
+  typedef std::unordered_map<EcmpEgressId, EgressIds> Ecmp2EgressIds;
   static EgressIds toEgressIds(EgressId* egress, int count) {
     EgressIds egressIds;
     std::for_each(egress, egress + count, [&egressIds](EgressId egress) {
@@ -117,26 +125,56 @@ class BcmWarmBootCache {
   typedef std::tuple<opennsl_vrf_t, folly::IPAddress,
           folly::IPAddress> VrfAndPrefix;
   typedef std::pair<opennsl_vrf_t, folly::IPAddress> VrfAndIP;
+  struct VrfAndIPHash {
+    size_t operator()(const VrfAndIP& key) const {
+      return folly::hash::hash_combine(key.first, key.second);
+    }
+  };
+  struct VrfAndPrefixHash {
+    size_t operator()(const VrfAndPrefix& key) const {
+      return folly::hash::hash_combine(
+          std::get<0>(key), std::get<1>(key), std::get<2>(key));
+    }
+  };
+  struct HostKeyHash {
+    size_t operator()(const HostKey& key) const {
+      return folly::hash::hash_combine(
+          std::get<0>(key), std::get<1>(key), std::get<2>(key));
+    }
+  };
+  struct EgressIdsHash {
+    size_t operator()(const EgressIds& egressIds) const {
+      return folly::hash::hash_range(egressIds.begin(), egressIds.end());
+    }
+  };
   /*
    * Cache containers
+   *
+   * The host, route, egress, ecmp and acl tables can hold hundreds of
+   * thousands of entries, each of which is looked up and then erased once
+   * it is reprogrammed, so they are hashed to keep each of those O(1).
+   * Whatever is left once every object has been reprogrammed is unclaimed,
+   * and clear() removes it in one pass over each table.
    */
   typedef boost::container::flat_map<VlanID, VlanInfo> Vlan2VlanInfo;
   typedef boost::container::flat_map<VlanID, opennsl_l2_station_t> Vlan2Station;
   typedef boost::container::flat_map<VlanAndMac, opennsl_l3_intf_t>
     VlanAndMac2Intf;
-  typedef boost::container::flat_map<VrfAndIP,
-          opennsl_l3_host_t> VrfAndIP2Host;
-  typedef boost::container::flat_map<VrfAndPrefix, opennsl_l3_route_t>
-    VrfAndPrefix2Route;
-  typedef boost::container::flat_map<EgressIds, EcmpEgress> EgressIds2Ecmp;
+  typedef std::unordered_map<VrfAndIP, opennsl_l3_host_t, VrfAndIPHash>
+    VrfAndIP2Host;
+  typedef std::unordered_map<VrfAndPrefix, opennsl_l3_route_t,
+          VrfAndPrefixHash> VrfAndPrefix2Route;
+  typedef std::unordered_map<EgressIds, EcmpEgress, EgressIdsHash>
+    EgressIds2Ecmp;
   using VrfAndIP2Route =
-      boost::container::flat_map<VrfAndIP, opennsl_l3_route_t>;
-  using EgressId2Egress = boost::container::flat_map<EgressId, Egress>;
-  using HostTableInWarmBootFile = boost::container::flat_map<HostKey, EgressId>;
+      std::unordered_map<VrfAndIP, opennsl_l3_route_t, VrfAndIPHash>;
+  using EgressId2Egress = std::unordered_map<EgressId, Egress>;
+  using HostTableInWarmBootFile =
+      std::unordered_map<HostKey, EgressId, HostKeyHash>;
 
   // current h/w acls: key = priority, value = BcmAclEntryHandle
-  using Priority2BcmAclEntryHandle = boost::container::flat_map<
-        int, BcmAclEntryHandle>;
+  using Priority2BcmAclEntryHandle =
+      std::unordered_map<int, BcmAclEntryHandle>;
   using MirrorEgressPath2Handle = boost::container::flat_map<
       std::pair<opennsl_gport_t, folly::Optional<MirrorTunnel>>,
       BcmMirrorHandle>;
@@ -290,7 +328,7 @@ class BcmWarmBootCache {
   void programmed(EgressId2EgressCitr citr) {
     XLOG(DBG1) << "Programmed egress entry: " << citr->first
                << ". Removing from warmboot cache.";
-    egressId2Egress_.erase(citr->first);
+    egressId2Egress_.erase(citr);
   }
   /*
    * Iterators and find functions for finding opennsl_l3_host_t
@@ -496,7 +534,13 @@ class BcmWarmBootCache {
    */
   const EgressIds& getPathsForEcmp(EgressId ecmp) const;
   folly::dynamic getWarmBootState() const;
+  void populateSwitchStateFromWarmBootState(
+      const folly::dynamic& swSwitchState);
   void populateFromWarmBootState(const folly::dynamic& warmBootState);
+  void populateVlans();
+  void populateHosts(const opennsl_l3_info_t& l3Info);
+  void populateRoutes(const opennsl_l3_info_t& l3Info);
+  void populateEgresses();
   // No copy or assignment.
   BcmWarmBootCache(const BcmWarmBootCache&) = delete;
   BcmWarmBootCache& operator=(const BcmWarmBootCache&) = delete;
@@ -506,7 +550,7 @@ class BcmWarmBootCache {
   VlanAndMac2Intf vlanAndMac2Intf_;
 
   // This is the set of egress ids pointed by BcmHost in warm boot file.
-  EgressIds egressIdsFromBcmHostInWarmBootFile_;
+  std::unordered_set<EgressId> egressIdsFromBcmHostInWarmBootFile_;
   // Mapping from <vrf, ip, intf> to the egress,
   // based on the BcmHost in warm boot file.
   HostTableInWarmBootFile vrfIp2EgressFromBcmHostInWarmBootFile_;
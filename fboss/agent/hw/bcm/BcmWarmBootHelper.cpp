@@ -1,13 +1,24 @@
 // Copyright 2004-present Facebook. All Rights Reserved.
 #include "fboss/agent/hw/bcm/BcmWarmBootHelper.h"
 
+#include "common/stats/ServiceData.h"
+#include "fboss/agent/FbossError.h"
+#include "fboss/agent/RestartTimeTracker.h"
 #include "fboss/agent/SysError.h"
 #include "fboss/agent/Utils.h"
 
 #include <sys/stat.h>
 #include <fcntl.h>
 
+#include <chrono>
+#include <tuple>
+
+#include <folly/Bits.h>
 #include <folly/FileUtil.h>
+#include <folly/Optional.h>
+#include <folly/compression/Compression.h>
+#include <folly/experimental/bser/Bser.h>
+#include <folly/io/IOBuf.h>
 #include <folly/json.h>
 #include <folly/logging/xlog.h>
 #include <glog/logging.h>
@@ -17,7 +28,13 @@ using std::string;
 DEFINE_bool(can_warm_boot, true,
             "Enable/disable warm boot functionality");
 DEFINE_string(switch_state_file, "switch_state",
-    "File for dumping switch state JSON in on exit");
+    "File for dumping switch state on exit. The state is written in binary "
+    "to <switch_state_file>.bin, and as JSON if --dump_switch_state_json");
+DEFINE_bool(dump_switch_state_json, false,
+    "Also dump the warm boot switch state as JSON to <switch_state_file>, "
+    "for debugging");
+DEFINE_bool(compress_switch_state, true,
+    "Compress the binary warm boot switch state with zstd");
 
 namespace {
 constexpr auto wbFlagPrefix = "can_warm_boot_";
@@ -25,6 +42,97 @@ constexpr auto wbDataPrefix = "bcm_sdk_state_";
 constexpr auto forceColdBootPrefix = "cold_boot_once_";
 constexpr auto shutdownDumpPrefix = "sdk_shutdown_dump_";
 constexpr auto startupDumpPrefix = "sdk_startup_dump_";
+constexpr auto binaryStateSuffix = ".bin";
+
+/*
+ * The binary warm boot state is this header followed by the state encoded
+ * as BSER, folly's compact binary serialization of folly::dynamic. Version 2
+ * compresses the BSER with zstd, after the length it uncompresses to. Bump
+ * the version whenever the layout changes.
+ */
+constexpr folly::StringPiece kBinaryStateMagic{"FBOSSWB"};
+constexpr uint32_t kBinaryStateVersion = 1;
+constexpr uint32_t kCompressedBinaryStateVersion = 2;
+constexpr auto kBinaryStateHeaderSize =
+    kBinaryStateMagic.size() + sizeof(kBinaryStateVersion);
+
+template <typename T>
+void appendLittleEndian(folly::fbstring& contents, T value) {
+  value = folly::Endian::little(value);
+  contents.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+folly::fbstring serializeWarmBootState(const folly::dynamic& switchState) {
+  folly::bser::serialization_opts opts;
+  auto bser = folly::bser::toBser(switchState, opts);
+  bool compress = FLAGS_compress_switch_state &&
+      folly::io::hasCodec(folly::io::CodecType::ZSTD);
+
+  folly::fbstring contents(kBinaryStateMagic.begin(), kBinaryStateMagic.end());
+  if (!compress) {
+    appendLittleEndian(contents, kBinaryStateVersion);
+    contents.append(bser);
+    return contents;
+  }
+  appendLittleEndian(contents, kCompressedBinaryStateVersion);
+  appendLittleEndian(contents, static_cast<uint64_t>(bser.size()));
+  auto uncompressed = folly::IOBuf::wrapBuffer(bser.data(), bser.size());
+  auto compressed =
+      folly::io::getCodec(folly::io::CodecType::ZSTD)->compress(
+          uncompressed.get());
+  for (const auto& range : *compressed) {
+    contents.append(reinterpret_cast<const char*>(range.data()), range.size());
+  }
+  return contents;
+}
+
+folly::dynamic deserializeWarmBootState(
+    const std::string& contents,
+    const std::string& filename) {
+  if (contents.size() < kBinaryStateHeaderSize ||
+      !folly::StringPiece(contents).startsWith(kBinaryStateMagic)) {
+    throw facebook::fboss::FbossError(
+        filename, " is not a binary warm boot state file");
+  }
+  auto version = folly::Endian::little(folly::loadUnaligned<uint32_t>(
+      contents.data() + kBinaryStateMagic.size()));
+  auto data = reinterpret_cast<const uint8_t*>(contents.data()) +
+      kBinaryStateHeaderSize;
+  auto size = contents.size() - kBinaryStateHeaderSize;
+  if (version == kBinaryStateVersion) {
+    return folly::bser::parseBser(folly::ByteRange(data, size));
+  }
+  if (version != kCompressedBinaryStateVersion) {
+    throw facebook::fboss::FbossError(
+        "Unsupported warm boot state version ", version, " in ", filename);
+  }
+  if (size < sizeof(uint64_t)) {
+    throw facebook::fboss::FbossError("Truncated warm boot state ", filename);
+  }
+  auto uncompressedSize =
+      folly::Endian::little(folly::loadUnaligned<uint64_t>(data));
+  auto compressed = folly::IOBuf::wrapBuffer(
+      data + sizeof(uint64_t), size - sizeof(uint64_t));
+  auto bser = folly::io::getCodec(folly::io::CodecType::ZSTD)
+                  ->uncompress(compressed.get(), uncompressedSize);
+  bser->coalesce();
+  return folly::bser::parseBser(folly::ByteRange(bser->data(), bser->length()));
+}
+
+/*
+ * Modification time of the given file, or none if it does not exist
+ */
+folly::Optional<struct timespec> fileModifiedTime(const string& filename) {
+  struct stat st;
+  if (stat(filename.c_str(), &st) != 0) {
+    if (errno == ENOENT) {
+      return folly::none;
+    }
+    throw facebook::fboss::SysError(
+        errno, "error while trying to stat warm boot file ", filename);
+  }
+  return st.st_mtim;
+}
 
 /*
  * Remove the given file. Return true if file exists and
@@ -88,6 +196,10 @@ std::string DiscBackedBcmWarmBootHelper::warmBootSwitchStateFile() const {
   return folly::to<string>(warmBootDir_, "/", FLAGS_switch_state_file);
 }
 
+std::string DiscBackedBcmWarmBootHelper::warmBootSwitchStateBinaryFile() const {
+  return folly::to<string>(warmBootSwitchStateFile(), binaryStateSuffix);
+}
+
 std::string DiscBackedBcmWarmBootHelper::warmBootFlag() const {
   return folly::to<string>(warmBootDir_, "/", wbFlagPrefix, unit_);
 }
@@ -130,17 +242,45 @@ bool DiscBackedBcmWarmBootHelper::checkAndClearWarmBootFlags() {
 
 bool DiscBackedBcmWarmBootHelper::storeWarmBootState(
     const folly::dynamic& switchState) {
+  auto begin = std::chrono::steady_clock::now();
+  auto contents = serializeWarmBootState(switchState);
   warmBootStateWritten_ =
-      dumpStateToFile(warmBootSwitchStateFile(), switchState);
+      folly::writeFile(contents, warmBootSwitchStateBinaryFile().c_str());
+  auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - begin);
+  XLOG(INFO) << "[Exit] Wrote " << contents.size()
+             << " bytes of binary warm boot state in " << elapsed.count()
+             << "ms";
+  fbData->setCounter("warm_boot.state_bytes", contents.size());
+  fbData->setCounter("warm_boot.state_write_ms", elapsed.count());
+  if (FLAGS_dump_switch_state_json) {
+    warmBootStateWritten_ &=
+        dumpStateToFile(warmBootSwitchStateFile(), switchState);
+  }
   return warmBootStateWritten_;
 }
 
 folly::dynamic DiscBackedBcmWarmBootHelper::getWarmBootState() const {
-  std::string warmBootJson;
-  auto ret = folly::readFile(warmBootSwitchStateFile().c_str(), warmBootJson);
-  sysCheckError(
-      ret, "Unable to read switch state from : ", warmBootSwitchStateFile());
-  return folly::parseJson(warmBootJson);
+  restart_time::mark(RestartEvent::WARM_BOOT_STATE_LOADING);
+  // Agents before the binary format only wrote JSON, so fall back to the
+  // JSON dump if it is the more recent one.
+  auto binaryFile = warmBootSwitchStateBinaryFile();
+  auto jsonFile = warmBootSwitchStateFile();
+  auto binaryTime = fileModifiedTime(binaryFile);
+  auto jsonTime = fileModifiedTime(jsonFile);
+  bool useBinary = binaryTime &&
+      (!jsonTime ||
+       std::tie(binaryTime->tv_sec, binaryTime->tv_nsec) >=
+           std::tie(jsonTime->tv_sec, jsonTime->tv_nsec));
+
+  std::string contents;
+  auto stateFile = useBinary ? binaryFile : jsonFile;
+  auto ret = folly::readFile(stateFile.c_str(), contents);
+  sysCheckError(ret, "Unable to read switch state from : ", stateFile);
+  auto switchState = useBinary ? deserializeWarmBootState(contents, stateFile)
+                               : folly::parseJson(contents);
+  restart_time::mark(RestartEvent::WARM_BOOT_STATE_LOADED);
+  return switchState;
 }
 
 } // namespace fboss
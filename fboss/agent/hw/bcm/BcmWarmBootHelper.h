@@ -35,6 +35,10 @@ class BcmWarmBootHelper {
   virtual void warmBootRead(uint8_t* buf, int offset, int nbytes) = 0;
   virtual void warmBootWrite(const uint8_t* buf, int offset, int nbytes) = 0;
 
+  /*
+   * Save the switch state for the next warm boot, and read it back.
+   * The on-disk format is up to the implementation.
+   */
   virtual bool storeWarmBootState(const folly::dynamic& switchState) = 0;
   virtual folly::dynamic getWarmBootState() const = 0;
 
@@ -76,6 +80,7 @@ class DiscBackedBcmWarmBootHelper: public BcmWarmBootHelper {
   std::string warmBootFlag() const;
   std::string forceColdBootOnceFlag() const;
   std::string warmBootSwitchStateFile() const;
+  std::string warmBootSwitchStateBinaryFile() const;
 
   void setupWarmBootFile();
 
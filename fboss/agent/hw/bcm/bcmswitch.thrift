@@ -57,4 +57,7 @@ struct BcmHwTableStats {
   36: i32 mirrors_max = STAT_UNINITIALIZED
   37: i32 mirrors_span = STAT_UNINITIALIZED
   38: i32 mirrors_erspan = STAT_UNINITIALIZED
+
+  // Resilient ECMP
+  39: i32 l3_ecmp_flowsets_used = STAT_UNINITIALIZED
 }
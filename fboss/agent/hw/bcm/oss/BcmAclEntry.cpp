@@ -28,6 +28,8 @@ folly::Optional<std::string> BcmAclEntry::getEgressAclMirror() {
   return folly::Optional<std::string>();
 }
 
+void BcmAclEntry::setPriority(const std::shared_ptr<AclEntry>& /*acl*/) {}
+
 void BcmAclEntry::applyMirrorAction(
     const std::string& /*mirrorName*/,
     MirrorAction /*action*/,
@@ -9,6 +9,7 @@
  */
 #include "fboss/agent/hw/bcm/BcmPort.h"
 #include "fboss/agent/hw/bcm/BcmError.h"
+#include "fboss/agent/hw/bcm/BcmSdkTracer.h"
 #include "fboss/agent/gen-cpp2/switch_config_types.h"
 
 extern "C" {
@@ -29,6 +30,9 @@ bool BcmPort::isFECEnabled() {
 }
 
 void BcmPort::setSflowRates(const std::shared_ptr<Port>& /* swPort */) {}
+void BcmPort::setSflowRates(
+    int64_t /* ingressRate */,
+    int64_t /* egressRate */) {}
 void BcmPort::disableSflow() {}
 
 void BcmPort::initCustomStats() const {}
@@ -40,7 +44,8 @@ void BcmPort::setAdditionalStats(
 cfg::PortSpeed BcmPort::getMaxSpeed() const {
   int speed;
   auto unit = hw_->getUnit();
-  auto rv = opennsl_port_speed_max(hw_->getUnit(), port_, &speed);
+  auto rv =
+      BCM_SDK_TRACE(opennsl_port_speed_max, hw_->getUnit(), port_, &speed);
   bcmCheckError(rv, "Failed to get max speed for port ", port_);
   return cfg::PortSpeed(speed);
 }
@@ -14,7 +14,9 @@
 #include "fboss/agent/hw/bcm/BcmControlPlane.h"
 #include "fboss/agent/hw/bcm/BcmCosManager.h"
 #include "fboss/agent/hw/bcm/gen-cpp2/packettrace_types.h"
+#include "fboss/agent/state/StateDelta.h"
 
+#include <folly/MacAddress.h>
 #include <folly/Memory.h>
 #include <folly/logging/xlog.h>
 
@@ -119,22 +121,30 @@ void BcmSwitch::forceLinkscanOn(opennsl_pbmp_t /*ports*/) {}
 
 static int _addL2Entry(int /*unit*/, opennsl_l2_addr_t* l2addr,
                        void* user_data) {
-  L2EntryThrift entry;
-  auto l2Table = static_cast<std::vector<L2EntryThrift>*>(user_data);
-  entry.mac = folly::sformat("{0:02x}:{1:02x}:{2:02x}:{3:02x}:{4:02x}:{5:02x}",
-                             l2addr->mac[0], l2addr->mac[1], l2addr->mac[2],
-                             l2addr->mac[3], l2addr->mac[4], l2addr->mac[5]);
-  entry.vlanID = l2addr->vid;
-  entry.port = l2addr->port;
-  XLOG(DBG6) << "L2 entry: Mac:" << entry.mac << " Vid:" << entry.vlanID
-             << " Port:" << entry.port;
-  l2Table->push_back(entry);
+  // Only copy the entry while the SDK walks the table; formatting
+  // happens after the traversal, which holds the L2 table lock
+  auto l2addrs = static_cast<std::vector<opennsl_l2_addr_t>*>(user_data);
+  l2addrs->push_back(*l2addr);
   return 0;
 }
 
 void BcmSwitch::fetchL2Table(std::vector<L2EntryThrift> *l2Table) {
-  int rv = opennsl_l2_traverse(unit_, _addL2Entry, l2Table);
+  std::vector<opennsl_l2_addr_t> l2addrs;
+  int rv = opennsl_l2_traverse(unit_, _addL2Entry, &l2addrs);
   bcmCheckError(rv, "opennsl_l2_traverse failed");
+
+  l2Table->reserve(l2Table->size() + l2addrs.size());
+  for (const auto& l2addr : l2addrs) {
+    L2EntryThrift entry;
+    entry.mac = folly::MacAddress::fromBinary(
+                    folly::ByteRange(l2addr.mac, folly::MacAddress::SIZE))
+                    .toString();
+    entry.vlanID = l2addr.vid;
+    entry.port = l2addr.port;
+    XLOG(DBG6) << "L2 entry: Mac:" << entry.mac << " Vid:" << entry.vlanID
+               << " Port:" << entry.port;
+    l2Table->push_back(std::move(entry));
+  }
 }
 
 bool BcmSwitch::isValidLabelForwardingEntry(
@@ -142,5 +152,12 @@ bool BcmSwitch::isValidLabelForwardingEntry(
   return true;
 }
 
-void BcmSwitch::processControlPlaneChanges(const StateDelta& /*delta*/) {}
+void BcmSwitch::processControlPlaneChanges(const StateDelta& delta) {
+  const auto& controlPlaneDelta = delta.getControlPlaneDelta();
+  const auto& newCPU = controlPlaneDelta.getNew();
+  if (controlPlaneDelta.getOld()->getRxReasonToQueue() !=
+      newCPU->getRxReasonToQueue()) {
+    controlPlane_->setupRxReasonToQueue(newCPU->getRxReasonToQueue());
+  }
+}
 }} //facebook::fboss
@@ -40,7 +40,5 @@ void BcmHwTableStatManager::incrementBcmMirrorStat(
 
 void BcmHwTableStatManager::publish(BcmHwTableStats) const {}
 
-void BcmHwTableStatManager::refresh(
-    const StateDelta& /*delta*/,
-    BcmHwTableStats* /*stats*/) {}
+void BcmHwTableStatManager::refresh(BcmHwTableStats* /*stats*/) {}
 }}
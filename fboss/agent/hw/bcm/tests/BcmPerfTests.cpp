@@ -0,0 +1,279 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/hw/bcm/tests/BcmTest.h"
+
+#include "fboss/agent/hw/bcm/BcmEgressManager.h"
+#include "fboss/agent/hw/bcm/BcmPort.h"
+#include "fboss/agent/hw/bcm/BcmPortTable.h"
+#include "fboss/agent/hw/bcm/BcmSwitch.h"
+#include "fboss/agent/hw/test/ConfigFactory.h"
+#include "fboss/agent/hw/test/HwTestPerfUtils.h"
+#include "fboss/agent/hw/test/HwTestStatUtils.h"
+#include "fboss/agent/state/ArpTable.h"
+#include "fboss/agent/state/NdpTable.h"
+#include "fboss/agent/state/RouteUpdater.h"
+#include "fboss/agent/state/SwitchState.h"
+#include "fboss/agent/state/Vlan.h"
+
+#include <folly/MacAddress.h>
+#include <folly/logging/xlog.h>
+#include <gflags/gflags.h>
+
+#include <algorithm>
+
+DEFINE_int32(
+    perf_max_routes,
+    500000,
+    "Skip route scale performance tests with more routes than this, for "
+    "ASICs whose route tables are smaller");
+DEFINE_int32(
+    perf_neighbors,
+    4096,
+    "Neighbors to program in the neighbor programming performance test");
+DEFINE_int32(
+    perf_stats_cycles,
+    20,
+    "Stats collection cycles to time in the stats performance test");
+
+using folly::IPAddress;
+using folly::IPAddressV4;
+using folly::IPAddressV6;
+using folly::MacAddress;
+
+namespace {
+
+const ClientID kClient(1001);
+const RouterID kVrf(0);
+// Ports that neighbors and ECMP next hops are spread over
+constexpr size_t kMaxEcmpWidth = 8;
+
+MacAddress neighborMac(uint32_t index) {
+  return MacAddress::fromHBO(0x020000000000ULL + index);
+}
+
+// The index'th /24 from 10.0.0.0 up, enough for 500k of them
+IPAddress routePrefix(uint32_t index) {
+  return IPAddress(IPAddressV4::fromLongHBO((10U << 24) + (index << 8)));
+}
+
+} // namespace
+
+namespace facebook {
+namespace fboss {
+
+/*
+ * Timings of the switch operations whose speed matters when the agent
+ * starts, converges or collects stats. Each test records its results with
+ * utility::recordPerfResult(), so --perf_results_file collects them from a
+ * run of --gtest_filter=BcmPerfTest.* for comparing SDK or agent versions.
+ *
+ * Boot time covers whichever boot SetUp() did, so running the suite once
+ * with --setup_for_warmboot and then again measures a warm boot.
+ */
+class BcmPerfTest : public BcmTest {
+ protected:
+  cfg::SwitchConfig initialConfig() const override {
+    return utility::oneL3IntfNPortConfig(getHwSwitch(), ecmpPorts());
+  }
+
+  void SetUp() override {
+    BcmTest::SetUp();
+    applyNewConfig(initialConfig());
+  }
+
+  std::vector<PortID> ecmpPorts() const {
+    const auto& ports = masterLogicalPortIds();
+    return std::vector<PortID>(
+        ports.begin(), ports.begin() + std::min(ports.size(), kMaxEcmpWidth));
+  }
+
+  // One resolved Arp neighbor, 1.1.1.10 and up, on each of ecmpPorts()
+  std::vector<IPAddress> addEcmpNeighbors() {
+    auto newState = getProgrammedState()->clone();
+    auto arpTable = newState->getVlans()
+                        ->getVlan(VlanID(utility::kBaseVlanId))
+                        ->getArpTable()
+                        ->modify(VlanID(utility::kBaseVlanId), &newState);
+    std::vector<IPAddress> nextHops;
+    auto ports = ecmpPorts();
+    for (uint32_t i = 0; i < ports.size(); ++i) {
+      IPAddressV4 ip(IPAddressV4::fromLongHBO(0x0101010a + i));
+      arpTable->addEntry(
+          ip,
+          neighborMac(i),
+          PortDescriptor(ports[i]),
+          InterfaceID(utility::kBaseVlanId));
+      nextHops.emplace_back(ip);
+    }
+    applyNewState(newState);
+    return nextHops;
+  }
+
+  std::shared_ptr<SwitchState> withRoutes(
+      const std::function<void(RouteUpdater*)>& update) {
+    RouteUpdater updater(getProgrammedState()->getRouteTables());
+    update(&updater);
+    auto newState = getProgrammedState()->clone();
+    newState->resetRouteTables(updater.updateDone());
+    return newState;
+  }
+
+  void routeScale(uint32_t numRoutes) {
+    if (numRoutes > static_cast<uint32_t>(FLAGS_perf_max_routes)) {
+      XLOG(INFO) << "Skipping " << numRoutes << " routes, more than "
+                 << "--perf_max_routes";
+      return;
+    }
+    RouteNextHopSet nhops;
+    for (const auto& ip : addEcmpNeighbors()) {
+      nhops.emplace(UnresolvedNextHop(ip, ECMP_WEIGHT));
+    }
+
+    // Only programming is timed, not building the state
+    auto addState = withRoutes([&](RouteUpdater* updater) {
+      for (uint32_t i = 0; i < numRoutes; ++i) {
+        updater->addRoute(
+            kVrf,
+            routePrefix(i),
+            24,
+            kClient,
+            RouteNextHopEntry(nhops, AdminDistance::EBGP));
+      }
+    });
+    auto addSeconds =
+        utility::timeSeconds([&] { applyNewState(addState); });
+
+    auto delState = withRoutes([&](RouteUpdater* updater) {
+      for (uint32_t i = 0; i < numRoutes; ++i) {
+        updater->delRoute(kVrf, routePrefix(i), 24, kClient);
+      }
+    });
+    auto delSeconds =
+        utility::timeSeconds([&] { applyNewState(delState); });
+
+    folly::dynamic params = folly::dynamic::object("routes", numRoutes)(
+        "ecmpWidth", static_cast<int64_t>(nhops.size()));
+    utility::recordPerfResult("route_add_time", addSeconds, "s", params);
+    utility::recordPerfResult(
+        "route_add_rate", numRoutes / addSeconds, "routes/s", params);
+    utility::recordPerfResult("route_delete_time", delSeconds, "s", params);
+    utility::recordPerfResult(
+        "route_delete_rate", numRoutes / delSeconds, "routes/s", params);
+  }
+};
+
+TEST_F(BcmPerfTest, bootTime) {
+  auto warm = getHwSwitch()->getBootType() == BootType::WARM_BOOT;
+  utility::recordPerfResult(
+      warm ? "warm_boot_time" : "cold_boot_time",
+      getInitDuration().count(),
+      "s");
+}
+
+TEST_F(BcmPerfTest, routeScale10k) {
+  routeScale(10000);
+}
+
+TEST_F(BcmPerfTest, routeScale100k) {
+  routeScale(100000);
+}
+
+TEST_F(BcmPerfTest, routeScale500k) {
+  routeScale(500000);
+}
+
+TEST_F(BcmPerfTest, ecmpShrinkOnLinkDown) {
+  auto nextHops = addEcmpNeighbors();
+  ASSERT_LE(2, nextHops.size());
+
+  // A route, and so an ECMP group, for every set of two or more next hops
+  // that includes the first, all of which shrink when its port goes down
+  uint32_t numGroups = 0;
+  auto state = withRoutes([&](RouteUpdater* updater) {
+    for (uint32_t mask = 3; mask < (1U << nextHops.size()); mask += 2) {
+      RouteNextHopSet nhops;
+      for (uint32_t i = 0; i < nextHops.size(); ++i) {
+        if (mask & (1U << i)) {
+          nhops.emplace(UnresolvedNextHop(nextHops[i], ECMP_WEIGHT));
+        }
+      }
+      updater->addRoute(
+          kVrf,
+          routePrefix(numGroups++),
+          24,
+          kClient,
+          RouteNextHopEntry(nhops, AdminDistance::EBGP));
+    }
+  });
+  applyNewState(state);
+
+  auto bcmPort = getHwSwitch()->getPortTable()->getBcmPortId(ecmpPorts()[0]);
+  auto seconds = utility::timeSeconds([&] {
+    getHwSwitch()->writableEgressManager()->linksDownHwNotLocked(
+        {BcmPort::asGPort(bcmPort)});
+  });
+  utility::recordPerfResult(
+      "ecmp_shrink_time",
+      seconds,
+      "s",
+      folly::dynamic::object("ecmpGroups", numGroups)(
+          "ecmpWidth", static_cast<int64_t>(nextHops.size())));
+}
+
+TEST_F(BcmPerfTest, neighborProgramming) {
+  auto ports = ecmpPorts();
+  auto newState = getProgrammedState()->clone();
+  auto ndpTable = newState->getVlans()
+                      ->getVlan(VlanID(utility::kBaseVlanId))
+                      ->getNdpTable()
+                      ->modify(VlanID(utility::kBaseVlanId), &newState);
+  // In the interface's 1::/64, from 1::1:0 up
+  for (int32_t i = 0; i < FLAGS_perf_neighbors; ++i) {
+    auto bytes = IPAddressV6("1::").toByteArray();
+    uint32_t host = 0x10000 + i;
+    for (int b = 0; b < 4; ++b) {
+      bytes[15 - b] = (host >> (8 * b)) & 0xff;
+    }
+    ndpTable->addEntry(
+        IPAddressV6::fromBinary(folly::ByteRange(bytes.data(), bytes.size())),
+        neighborMac(i),
+        PortDescriptor(ports[i % ports.size()]),
+        InterfaceID(utility::kBaseVlanId));
+  }
+  auto seconds = utility::timeSeconds([&] { applyNewState(newState); });
+
+  folly::dynamic params =
+      folly::dynamic::object("neighbors", FLAGS_perf_neighbors);
+  utility::recordPerfResult("neighbor_add_time", seconds, "s", params);
+  utility::recordPerfResult(
+      "neighbor_add_rate",
+      FLAGS_perf_neighbors / seconds,
+      "neighbors/s",
+      params);
+}
+
+TEST_F(BcmPerfTest, statsCollection) {
+  double total = 0;
+  double slowest = 0;
+  for (int i = 0; i < FLAGS_perf_stats_cycles; ++i) {
+    auto seconds =
+        utility::timeSeconds([&] { updateHwSwitchStats(getHwSwitch()); });
+    total += seconds;
+    slowest = std::max(slowest, seconds);
+  }
+  folly::dynamic params = folly::dynamic::object(
+      "cycles", FLAGS_perf_stats_cycles)("ports", logicalPortIds().size());
+  utility::recordPerfResult(
+      "stats_cycle_time_avg", total / FLAGS_perf_stats_cycles, "s", params);
+  utility::recordPerfResult("stats_cycle_time_max", slowest, "s", params);
+}
+
+} // namespace fboss
+} // namespace facebook
@@ -0,0 +1,92 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/hw/bcm/BcmRouteDeltaSummary.h"
+
+#include "fboss/agent/state/RouteTableMap.h"
+#include "fboss/agent/state/RouteUpdater.h"
+#include "fboss/agent/state/StateDelta.h"
+#include "fboss/agent/state/SwitchState.h"
+
+#include <gtest/gtest.h>
+
+using namespace facebook::fboss;
+using folly::IPAddress;
+using folly::IPAddressV4;
+using folly::IPAddressV6;
+
+namespace {
+const ClientID kClient(1001);
+const RouterID kVrf(0);
+
+RouteNextHopEntry dropEntry() {
+  return RouteNextHopEntry(
+      RouteForwardAction::DROP, AdminDistance::MAX_ADMIN_DISTANCE);
+}
+
+std::shared_ptr<SwitchState> withRoutes(
+    const std::shared_ptr<SwitchState>& state,
+    const std::function<void(RouteUpdater*)>& update) {
+  RouteUpdater updater(state->getRouteTables());
+  update(&updater);
+  auto newState = state->clone();
+  newState->resetRouteTables(updater.updateDone());
+  newState->publish();
+  return newState;
+}
+} // namespace
+
+TEST(BcmRouteDeltaSummary, collectsChangesOnce) {
+  auto state0 = std::make_shared<SwitchState>();
+  state0->publish();
+  auto state1 = withRoutes(state0, [](RouteUpdater* updater) {
+    updater->addRoute(kVrf, IPAddress("10.1.0.0"), 16, kClient, dropEntry());
+    updater->addRoute(kVrf, IPAddress("10.0.0.0"), 8, kClient, dropEntry());
+    updater->addRoute(kVrf, IPAddress("10.2.0.0"), 16, kClient, dropEntry());
+    updater->addRoute(kVrf, IPAddress("2401::"), 64, kClient, dropEntry());
+  });
+  auto state2 = withRoutes(state1, [](RouteUpdater* updater) {
+    updater->delRoute(kVrf, IPAddress("10.1.0.0"), 16, kClient);
+    updater->addRoute(kVrf, IPAddress("10.3.0.0"), 16, kClient, dropEntry());
+  });
+
+  BcmRouteDeltaSummary added(StateDelta(state0, state1), 2, true);
+  EXPECT_TRUE(added.isValid());
+  EXPECT_TRUE(added.fibs<IPAddressV4>().empty());
+  ASSERT_EQ(1, added.routeTables<IPAddressV4>().size());
+  const auto& v4 = added.routeTables<IPAddressV4>().front();
+  EXPECT_EQ(kVrf, v4.vrf);
+  EXPECT_TRUE(v4.removed.empty());
+  // ALPM order puts shorter prefixes first
+  ASSERT_LE(3, v4.addedChanged.size());
+  uint8_t lastMask = 0;
+  for (const auto& route : v4.addedChanged) {
+    EXPECT_EQ(nullptr, route.first);
+    EXPECT_LE(lastMask, route.second->prefix().mask);
+    lastMask = route.second->prefix().mask;
+  }
+  ASSERT_EQ(1, added.routeTables<IPAddressV6>().size());
+  EXPECT_EQ(
+      added.numChanges(),
+      v4.addedChanged.size() +
+          added.routeTables<IPAddressV6>().front().addedChanged.size());
+
+  BcmRouteDeltaSummary changed(StateDelta(state1, state2), 2, false);
+  ASSERT_EQ(1, changed.routeTables<IPAddressV4>().size());
+  const auto& v4Changed = changed.routeTables<IPAddressV4>().front();
+  ASSERT_EQ(1, v4Changed.removed.size());
+  EXPECT_EQ(
+      IPAddressV4("10.1.0.0"), v4Changed.removed.front()->prefix().network);
+  ASSERT_EQ(1, v4Changed.addedChanged.size());
+  EXPECT_EQ(
+      IPAddressV4("10.3.0.0"),
+      v4Changed.addedChanged.front().second->prefix().network);
+  EXPECT_TRUE(changed.routeTables<IPAddressV6>().empty());
+  EXPECT_EQ(2, changed.numChanges());
+}
@@ -27,6 +27,7 @@
 
 extern "C" {
 #include <opennsl/port.h>
+#include <opennsl/vlan.h>
 }
 
 using std::make_shared;
@@ -107,5 +108,32 @@ TEST_F(BcmVlanTest, VlanApplyConfig) {
   };
   verifyAcrossWarmBoots(setup, verify);
 }
+
+TEST_F(BcmVlanTest, VlanPortTaggingChange) {
+  auto port = masterLogicalPortIds()[0];
+  auto setup = [=]() {
+    applyNewConfig(initialConfig());
+    // The port stays in its VLAN, only now tagged
+    auto config = initialConfig();
+    for (auto& vlanPort : config.vlanPorts) {
+      if (vlanPort.logicalPort == port) {
+        vlanPort.emitTags = true;
+      }
+    }
+    return applyNewConfig(config);
+  };
+
+  auto verify = [=]() {
+    opennsl_pbmp_t pbmp;
+    opennsl_pbmp_t ubmp;
+    auto rv = opennsl_vlan_port_get(
+        getUnit(), utility::kBaseVlanId, &pbmp, &ubmp);
+    bcmCheckError(rv, "failed to get ports of VLAN ", utility::kBaseVlanId);
+    auto bcmPort = getHwSwitch()->getPortTable()->getBcmPortId(port);
+    EXPECT_TRUE(OPENNSL_PBMP_MEMBER(pbmp, bcmPort));
+    EXPECT_FALSE(OPENNSL_PBMP_MEMBER(ubmp, bcmPort));
+  };
+  verifyAcrossWarmBoots(setup, verify);
+}
 } // namespace fboss
 } // namespace
@@ -35,6 +35,7 @@ class MockHwSwitch : public HwSwitch {
       stateChanged,
       std::shared_ptr<SwitchState>(const StateDelta& delta));
   MOCK_METHOD2(getAndClearNeighborHit, bool(RouterID, folly::IPAddress&));
+  MOCK_METHOD0(getAndClearNeighborHits, folly::Optional<NeighborHits>());
 
   std::unique_ptr<TxPacket> allocatePacket(uint32_t size) override;
 
@@ -14,6 +14,25 @@
 
 #include <functional>
 
+namespace facebook {
+namespace fboss {
+
+folly::dynamic FdbApiParameters::FdbEntry::toFollyDynamic() const {
+  return folly::dynamic::object("switchId", static_cast<int64_t>(switchId()))(
+      "bridgeId", static_cast<int64_t>(bridgeId()))("mac", mac().toString());
+}
+
+FdbApiParameters::FdbEntry FdbApiParameters::FdbEntry::fromFollyDynamic(
+    const folly::dynamic& json) {
+  return FdbEntry(
+      static_cast<sai_object_id_t>(json["switchId"].asInt()),
+      static_cast<sai_object_id_t>(json["bridgeId"].asInt()),
+      folly::MacAddress(json["mac"].asString()));
+}
+
+} // namespace fboss
+} // namespace facebook
+
 namespace std {
 size_t hash<facebook::fboss::FdbApiParameters::FdbEntry>::operator()(
     const facebook::fboss::FdbApiParameters::FdbEntry& fdbEntry) const {
@@ -17,6 +17,7 @@
 
 #include <folly/IPAddress.h>
 #include <folly/MacAddress.h>
+#include <folly/dynamic.h>
 #include <folly/logging/xlog.h>
 
 #include <iterator>
@@ -83,6 +84,8 @@ struct FdbApiParameters {
           switchId() == other.switchId() && bridgeId() == other.bridgeId() &&
           mac() == other.mac());
     }
+    folly::dynamic toFollyDynamic() const;
+    static FdbEntry fromFollyDynamic(const folly::dynamic& json);
 
    private:
     sai_fdb_entry_t fdb_entry;
@@ -201,7 +201,7 @@ class HostifApi : public SaiApi<HostifApi, HostifApiParameters> {
       const HostifApiParameters::TxPacketAttributes::TxAttributes& attributes,
       sai_object_id_t switch_id,
       HostifApiParameters::HostifApiPacket& txPacket) {
-    std::vector<sai_attribute_t> saiAttributeTs = attributes.saiAttrs();
+    auto saiAttributeTs = attributes.saiAttrArray();
     return api_->send_hostif_packet(
         switch_id,
         txPacket.size,
@@ -14,6 +14,27 @@
 
 #include <functional>
 
+namespace facebook {
+namespace fboss {
+
+folly::dynamic NeighborApiParameters::NeighborEntry::toFollyDynamic() const {
+  return folly::dynamic::object("switchId", static_cast<int64_t>(switchId()))(
+      "routerInterfaceId", static_cast<int64_t>(routerInterfaceId()))(
+      "ip", ip().str());
+}
+
+NeighborApiParameters::NeighborEntry
+NeighborApiParameters::NeighborEntry::fromFollyDynamic(
+    const folly::dynamic& json) {
+  return NeighborEntry(
+      static_cast<sai_object_id_t>(json["switchId"].asInt()),
+      static_cast<sai_object_id_t>(json["routerInterfaceId"].asInt()),
+      folly::IPAddress(json["ip"].asString()));
+}
+
+} // namespace fboss
+} // namespace facebook
+
 namespace std {
 size_t hash<facebook::fboss::NeighborApiParameters::NeighborEntry>::operator()(
     const facebook::fboss::NeighborApiParameters::NeighborEntry& n) const {
@@ -17,6 +17,7 @@
 
 #include <folly/IPAddress.h>
 #include <folly/MacAddress.h>
+#include <folly/dynamic.h>
 #include <folly/logging/xlog.h>
 
 #include <iterator>
@@ -82,6 +83,8 @@ struct NeighborApiParameters {
           routerInterfaceId() == other.routerInterfaceId() &&
           ip() == other.ip());
     }
+    folly::dynamic toFollyDynamic() const;
+    static NeighborEntry fromFollyDynamic(const folly::dynamic& json);
 
    private:
     sai_neighbor_entry_t neighbor_entry;
@@ -119,6 +119,37 @@ class NextHopGroupApi
   sai_status_t _removeMember(sai_object_id_t next_hop_group_member_id) {
     return api_->remove_next_hop_group_member(next_hop_group_member_id);
   }
+  sai_status_t _bulkCreateMembers(
+      sai_object_id_t switch_id,
+      uint32_t count,
+      const uint32_t* attr_counts,
+      const sai_attribute_t** attr_lists,
+      sai_bulk_op_error_mode_t mode,
+      sai_object_id_t* next_hop_group_member_ids,
+      sai_status_t* statuses) {
+    if (!api_->create_next_hop_group_members) {
+      return SAI_STATUS_NOT_IMPLEMENTED;
+    }
+    return api_->create_next_hop_group_members(
+        switch_id,
+        count,
+        attr_counts,
+        attr_lists,
+        mode,
+        next_hop_group_member_ids,
+        statuses);
+  }
+  sai_status_t _bulkRemoveMembers(
+      uint32_t count,
+      const sai_object_id_t* next_hop_group_member_ids,
+      sai_bulk_op_error_mode_t mode,
+      sai_status_t* statuses) {
+    if (!api_->remove_next_hop_group_members) {
+      return SAI_STATUS_NOT_IMPLEMENTED;
+    }
+    return api_->remove_next_hop_group_members(
+        count, next_hop_group_member_ids, mode, statuses);
+  }
   sai_status_t _getMemberAttr(sai_attribute_t* attr, sai_object_id_t handle)
       const {
     return api_->get_next_hop_group_member_attribute(handle, 1, attr);
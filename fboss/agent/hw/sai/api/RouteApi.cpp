@@ -14,6 +14,26 @@
 
 #include <functional>
 
+namespace facebook {
+namespace fboss {
+
+folly::dynamic RouteApiParameters::RouteEntry::toFollyDynamic() const {
+  return folly::dynamic::object("switchId", static_cast<int64_t>(switchId()))(
+      "virtualRouterId", static_cast<int64_t>(virtualRouterId()))(
+      "destination", folly::IPAddress::networkToString(destination()));
+}
+
+RouteApiParameters::RouteEntry RouteApiParameters::RouteEntry::fromFollyDynamic(
+    const folly::dynamic& json) {
+  return RouteEntry(
+      static_cast<sai_object_id_t>(json["switchId"].asInt()),
+      static_cast<sai_object_id_t>(json["virtualRouterId"].asInt()),
+      folly::IPAddress::createNetwork(json["destination"].asString()));
+}
+
+} // namespace fboss
+} // namespace facebook
+
 namespace std {
 size_t hash<facebook::fboss::RouteApiParameters::RouteEntry>::operator()(
     const facebook::fboss::RouteApiParameters::RouteEntry& r) const {
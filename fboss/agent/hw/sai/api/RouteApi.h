@@ -16,9 +16,11 @@
 #include "fboss/agent/hw/sai/api/SaiAttributeDataTypes.h"
 
 #include <folly/IPAddress.h>
+#include <folly/dynamic.h>
 #include <folly/logging/xlog.h>
 
 #include <iterator>
+#include <vector>
 
 extern "C" {
 #include <sai.h>
@@ -81,6 +83,8 @@ struct RouteApiParameters {
           virtualRouterId() == other.virtualRouterId() &&
           destination() == other.destination());
     }
+    folly::dynamic toFollyDynamic() const;
+    static RouteEntry fromFollyDynamic(const folly::dynamic& json);
 
    private:
     sai_route_entry_t route_entry;
@@ -117,6 +121,52 @@ class RouteApi : public SaiApi<RouteApi, RouteApiParameters> {
       const RouteApiParameters::RouteEntry& routeEntry) {
     return api_->set_route_entry_attribute(routeEntry.entry(), attr);
   }
+  sai_status_t _bulkCreate(
+      const std::vector<RouteApiParameters::RouteEntry>& routeEntries,
+      const uint32_t* attrCounts,
+      const sai_attribute_t** attrLists,
+      sai_bulk_op_error_mode_t mode,
+      sai_status_t* statuses) {
+    if (!api_->create_route_entries) {
+      return SAI_STATUS_NOT_IMPLEMENTED;
+    }
+    auto entries = saiRouteEntries(routeEntries);
+    return api_->create_route_entries(
+        entries.size(), entries.data(), attrCounts, attrLists, mode, statuses);
+  }
+  sai_status_t _bulkRemove(
+      const std::vector<RouteApiParameters::RouteEntry>& routeEntries,
+      sai_bulk_op_error_mode_t mode,
+      sai_status_t* statuses) {
+    if (!api_->remove_route_entries) {
+      return SAI_STATUS_NOT_IMPLEMENTED;
+    }
+    auto entries = saiRouteEntries(routeEntries);
+    return api_->remove_route_entries(
+        entries.size(), entries.data(), mode, statuses);
+  }
+  sai_status_t _bulkSetAttr(
+      const std::vector<RouteApiParameters::RouteEntry>& routeEntries,
+      const sai_attribute_t* attrs,
+      sai_bulk_op_error_mode_t mode,
+      sai_status_t* statuses) {
+    if (!api_->set_route_entries_attribute) {
+      return SAI_STATUS_NOT_IMPLEMENTED;
+    }
+    auto entries = saiRouteEntries(routeEntries);
+    return api_->set_route_entries_attribute(
+        entries.size(), entries.data(), attrs, mode, statuses);
+  }
+  // The bulk apis take a contiguous array of sai_route_entry_t
+  static std::vector<sai_route_entry_t> saiRouteEntries(
+      const std::vector<RouteApiParameters::RouteEntry>& routeEntries) {
+    std::vector<sai_route_entry_t> entries;
+    entries.reserve(routeEntries.size());
+    for (const auto& routeEntry : routeEntries) {
+      entries.push_back(*routeEntry.entry());
+    }
+    return entries;
+  }
   sai_route_api_t* api_;
   friend class SaiApi<RouteApi, RouteApiParameters>;
 };
@@ -11,9 +11,14 @@
 
 #include "fboss/agent/hw/sai/api/SaiApiError.h"
 #include "fboss/agent/hw/sai/api/SaiAttribute.h"
+#include "fboss/agent/hw/sai/api/SaiAttributeCache.h"
+#include "fboss/agent/hw/sai/api/SaiWarmBootRecords.h"
 #include "fboss/agent/hw/sai/api/Traits.h"
 
+#include <folly/Conv.h>
 #include <folly/Format.h>
+#include <folly/Synchronized.h>
+#include <folly/dynamic.h>
 #include <folly/logging/xlog.h>
 
 #include <boost/variant.hpp>
@@ -30,9 +35,24 @@ extern "C" {
 namespace facebook {
 namespace fboss {
 
+/*
+ * SaiApi keeps an attribute cache of what it has programmed on each object
+ * (see SaiAttributeCache). setAttribute() skips the adapter call when the
+ * attribute already has the desired value, and getAttribute() answers from
+ * the cache for attributes we have set. getAttributeFromHw() always asks the
+ * adapter, for debugging or for checking the cache against the hardware.
+ *
+ * It also keeps SaiWarmBootRecords of the objects it has created, which
+ * warmBootState() returns for writing out at graceful exit. After a warm
+ * boot, loadWarmBootState() hands them back, create() reclaims the objects
+ * that are still wanted instead of creating them again, and
+ * removeUnreclaimed() gets rid of the rest.
+ */
 template <typename ApiT, typename ApiParameters>
 class SaiApi {
  public:
+  using KeyType = typename apiKey<ApiParameters>::type;
+
   virtual ~SaiApi() = default;
   SaiApi() = default;
   SaiApi(const SaiApi& other) = delete;
@@ -50,14 +70,20 @@ class SaiApi {
     static_assert(
         std::is_same<T, ApiParameters>::value,
         "Attributes must come from correct ApiParameters");
+    auto createAttrsJson = createAttrs.toFollyDynamic();
+    auto reclaimed = warmBootRecords_.wlock()->reclaim(createAttrsJson);
+    if (reclaimed) {
+      return reclaimed.value();
+    }
     sai_object_id_t id;
-    std::vector<sai_attribute_t> saiAttributeTs = createAttrs.saiAttrs();
+    auto saiAttributeTs = createAttrs.saiAttrArray();
     sai_status_t status = impl()._create(
         &id,
         saiAttributeTs.data(),
         saiAttributeTs.size(),
         std::forward<Args>(args)...);
     saiApiCheckError(status, T::ApiType, "Failed to create2 sai entity");
+    warmBootRecords_.wlock()->created(id, std::move(createAttrsJson));
     return id;
   }
 
@@ -69,57 +95,269 @@ class SaiApi {
     static_assert(
         std::is_same<T, ApiParameters>::value,
         "Attributes and EntryType must come from correct ApiParameters");
-    std::vector<sai_attribute_t> saiAttributeTs = createAttrs.saiAttrs();
+    auto saiAttributeTs = createAttrs.saiAttrArray();
+    auto createAttrsJson = createAttrs.toFollyDynamic();
+    if (reclaimEntry(entry, saiAttributeTs, createAttrsJson)) {
+      return;
+    }
     sai_status_t status = impl()._create(
         entry,
         saiAttributeTs.data(),
         saiAttributeTs.size(),
         std::forward<Args>(args)...);
     saiApiCheckError(status, T::ApiType, "Failed to create2 sai entity");
+    warmBootRecords_.wlock()->created(entry, std::move(createAttrsJson));
   }
 
-  template <typename T>
-  void remove(const T& t) {
-    sai_status_t status = impl()._remove(t);
+  void remove(const KeyType& key) {
+    sai_status_t status = impl()._remove(key);
     saiApiCheckError(
         status, ApiParameters::ApiType, "Failed to remove sai entity");
+    attributeCache_.wlock()->erase(key);
+    warmBootRecords_.wlock()->erase(key);
+  }
+
+  /*
+   * Bulk versions of create(), remove() and setAttribute() for apis that use
+   * entries. Every entry is attempted even if some fail, and the status of
+   * each one is returned in the same order as the entries. Implementations
+   * whose SAI adapter does not support the bulk call fall back to one call
+   * per entry.
+   */
+  template <typename T = ApiParameters>
+  typename std::enable_if<apiUsesEntry<T>::value, std::vector<sai_status_t>>::
+      type
+      bulkCreate(
+          const std::vector<typename T::EntryType>& entries,
+          const std::vector<typename T::Attributes::CreateAttributes>&
+              createAttrs) {
+    static_assert(
+        std::is_same<T, ApiParameters>::value,
+        "Attributes and EntryType must come from correct ApiParameters");
+    if (entries.size() != createAttrs.size()) {
+      throw std::invalid_argument("Each entry needs its own attributes");
+    }
+    std::vector<sai_status_t> statuses(
+        entries.size(), SAI_STATUS_SUCCESS);
+    // Entries reclaimed after a warm boot are not created again
+    std::vector<size_t> toCreate;
+    std::vector<typename T::EntryType> createEntries;
+    std::vector<folly::dynamic> createAttrsJson;
+    std::vector<decltype(createAttrs[0].saiAttrArray())> saiAttributeTs;
+    saiAttributeTs.reserve(entries.size());
+    for (size_t i = 0; i < entries.size(); ++i) {
+      auto attrs = createAttrs[i].saiAttrArray();
+      auto attrsJson = createAttrs[i].toFollyDynamic();
+      if (reclaimEntry(entries[i], attrs, attrsJson)) {
+        continue;
+      }
+      toCreate.push_back(i);
+      createEntries.push_back(entries[i]);
+      createAttrsJson.push_back(std::move(attrsJson));
+      saiAttributeTs.push_back(attrs);
+    }
+    if (toCreate.empty()) {
+      return statuses;
+    }
+    std::vector<uint32_t> attrCounts;
+    std::vector<const sai_attribute_t*> attrLists;
+    for (const auto& attrs : saiAttributeTs) {
+      attrCounts.push_back(attrs.size());
+      attrLists.push_back(attrs.data());
+    }
+    std::vector<sai_status_t> createStatuses(
+        toCreate.size(), SAI_STATUS_NOT_EXECUTED);
+    sai_status_t status = impl()._bulkCreate(
+        createEntries,
+        attrCounts.data(),
+        attrLists.data(),
+        SAI_BULK_OP_ERROR_MODE_IGNORE_ERROR,
+        createStatuses.data());
+    if (bulkUnsupported(status)) {
+      for (size_t i = 0; i < createEntries.size(); ++i) {
+        createStatuses[i] = impl()._create(
+            createEntries[i],
+            saiAttributeTs[i].data(),
+            saiAttributeTs[i].size());
+      }
+    }
+    auto records = warmBootRecords_.wlock();
+    for (size_t i = 0; i < toCreate.size(); ++i) {
+      statuses[toCreate[i]] = createStatuses[i];
+      if (createStatuses[i] == SAI_STATUS_SUCCESS) {
+        records->created(createEntries[i], std::move(createAttrsJson[i]));
+      }
+    }
+    return statuses;
+  }
+
+  template <typename T = ApiParameters>
+  typename std::enable_if<apiUsesEntry<T>::value, std::vector<sai_status_t>>::
+      type
+      bulkRemove(const std::vector<typename T::EntryType>& entries) {
+    static_assert(
+        std::is_same<T, ApiParameters>::value,
+        "EntryType must come from correct ApiParameters");
+    std::vector<sai_status_t> statuses(
+        entries.size(), SAI_STATUS_NOT_EXECUTED);
+    sai_status_t status = impl()._bulkRemove(
+        entries, SAI_BULK_OP_ERROR_MODE_IGNORE_ERROR, statuses.data());
+    if (bulkUnsupported(status)) {
+      for (size_t i = 0; i < entries.size(); ++i) {
+        statuses[i] = impl()._remove(entries[i]);
+      }
+    }
+    auto cache = attributeCache_.wlock();
+    auto records = warmBootRecords_.wlock();
+    for (size_t i = 0; i < entries.size(); ++i) {
+      if (statuses[i] == SAI_STATUS_SUCCESS) {
+        cache->erase(entries[i]);
+        records->erase(entries[i]);
+      }
+    }
+    return statuses;
+  }
+
+  template <typename AttrT, typename T = ApiParameters>
+  typename std::enable_if<apiUsesEntry<T>::value, std::vector<sai_status_t>>::
+      type
+      bulkSetAttribute(
+          const std::vector<typename T::EntryType>& entries,
+          const std::vector<AttrT>& attrs) {
+    static_assert(
+        std::is_same<T, ApiParameters>::value,
+        "EntryType must come from correct ApiParameters");
+    if (entries.size() != attrs.size()) {
+      throw std::invalid_argument("Each entry needs its own attribute");
+    }
+    // Only send the entries whose cached value differs
+    std::vector<sai_status_t> statuses(entries.size(), SAI_STATUS_SUCCESS);
+    std::vector<size_t> toSet;
+    {
+      auto cache = attributeCache_.rlock();
+      for (size_t i = 0; i < entries.size(); ++i) {
+        if (!cache->contains(entries[i], attrs[i])) {
+          toSet.push_back(i);
+        }
+      }
+    }
+    if (toSet.empty()) {
+      return statuses;
+    }
+    std::vector<typename T::EntryType> setEntries;
+    std::vector<sai_attribute_t> saiAttributeTs;
+    setEntries.reserve(toSet.size());
+    saiAttributeTs.reserve(toSet.size());
+    for (auto i : toSet) {
+      setEntries.push_back(entries[i]);
+      saiAttributeTs.push_back(*attrs[i].saiAttr());
+    }
+    std::vector<sai_status_t> setStatuses(
+        toSet.size(), SAI_STATUS_NOT_EXECUTED);
+    sai_status_t status = impl()._bulkSetAttr(
+        setEntries,
+        saiAttributeTs.data(),
+        SAI_BULK_OP_ERROR_MODE_IGNORE_ERROR,
+        setStatuses.data());
+    if (bulkUnsupported(status)) {
+      for (size_t i = 0; i < toSet.size(); ++i) {
+        setStatuses[i] = impl()._setAttr(&saiAttributeTs[i], setEntries[i]);
+      }
+    }
+    auto cache = attributeCache_.wlock();
+    auto records = warmBootRecords_.wlock();
+    for (size_t i = 0; i < toSet.size(); ++i) {
+      statuses[toSet[i]] = setStatuses[i];
+      updateCache(*cache, setEntries[i], attrs[toSet[i]], setStatuses[i]);
+      updateRecords(
+          *records, setEntries[i], attrs[toSet[i]], setStatuses[i]);
+    }
+    return statuses;
   }
 
-  template <typename AttrT, typename... Args>
+  template <typename AttrT>
   typename std::remove_reference<AttrT>::type::ValueType getAttribute(
       AttrT&& attr,
-      Args&&... args) {
-    sai_status_t status =
-        impl()._getAttr(attr.saiAttr(), std::forward<Args>(args)...);
+      const KeyType& key) {
+    using Attr = typename std::decay<AttrT>::type;
+    auto cached = attributeCache_.rlock()->template get<Attr>(key);
+    if (cached) {
+      return cached.value();
+    }
+    return getAttributeFromHw(std::forward<AttrT>(attr), key);
+  }
+
+  // Read an attribute from the adapter, bypassing the attribute cache
+  template <typename AttrT>
+  typename std::remove_reference<AttrT>::type::ValueType getAttributeFromHw(
+      AttrT&& attr,
+      const KeyType& key) {
+    sai_status_t status = impl()._getAttr(attr.saiAttr(), key);
     saiApiCheckError(
         status, ApiParameters::ApiType, "Failed to get sai attribute");
     return attr.value();
   }
 
-  template <typename AttrT, typename... Args>
-  sai_status_t setAttribute(const AttrT& attr, Args&&... args) {
-    return impl()._setAttr(attr.saiAttr(), std::forward<Args>(args)...);
+  template <typename AttrT>
+  sai_status_t setAttribute(const AttrT& attr, const KeyType& key) {
+    if (attributeCache_.rlock()->contains(key, attr)) {
+      return SAI_STATUS_SUCCESS;
+    }
+    // Already programmed before a warm boot
+    if (warmBootRecords_.rlock()->reclaimedWith(key, attr.toFollyDynamic())) {
+      attributeCache_.wlock()->set(key, attr);
+      return SAI_STATUS_SUCCESS;
+    }
+    sai_status_t status = impl()._setAttr(attr.saiAttr(), key);
+    updateCache(*attributeCache_.wlock(), key, attr, status);
+    updateRecords(*warmBootRecords_.wlock(), key, attr, status);
+    return status;
   }
 
-  template <typename AttrT, typename... Args>
+  template <typename AttrT>
   typename std::remove_reference<AttrT>::type::ValueType getMemberAttribute(
       AttrT&& attr,
-      Args&&... args) {
-    sai_status_t status =
-        impl()._getMemberAttr(attr.saiAttr(), std::forward<Args>(args)...);
+      sai_object_id_t memberId) {
+    using Attr = typename std::decay<AttrT>::type;
+    auto cached = memberAttributeCache_.rlock()->template get<Attr>(memberId);
+    if (cached) {
+      return cached.value();
+    }
+    return getMemberAttributeFromHw(std::forward<AttrT>(attr), memberId);
+  }
+
+  // Read a member attribute from the adapter, bypassing the attribute cache
+  template <typename AttrT>
+  typename std::remove_reference<AttrT>::type::ValueType
+  getMemberAttributeFromHw(AttrT&& attr, sai_object_id_t memberId) {
+    sai_status_t status = impl()._getMemberAttr(attr.saiAttr(), memberId);
     saiApiCheckError(
         status, ApiParameters::ApiType, "Failed to get sai member attribute");
     return attr.value();
   }
 
-  template <typename AttrT, typename... Args>
-  void setMemberAttribute(const AttrT& attr, Args&&... args) {
-    sai_status_t status =
-        impl()._setMemberAttr(attr.saiAttr(), std::forward<Args>(args)...);
+  template <typename AttrT>
+  void setMemberAttribute(const AttrT& attr, sai_object_id_t memberId) {
+    if (memberAttributeCache_.rlock()->contains(memberId, attr)) {
+      return;
+    }
+    sai_status_t status = impl()._setMemberAttr(attr.saiAttr(), memberId);
+    updateCache(*memberAttributeCache_.wlock(), memberId, attr, status);
+    updateRecords(*memberWarmBootRecords_.wlock(), memberId, attr, status);
     saiApiCheckError(
         status, ApiParameters::ApiType, "Failed to set sai attribute");
   }
 
+  /*
+   * Drop all cached attributes, e.g., if the adapter state may have changed
+   * behind our back. Subsequent sets and gets go to the adapter until the
+   * cache is repopulated.
+   */
+  void clearAttributeCache() {
+    attributeCache_.wlock()->clear();
+    memberAttributeCache_.wlock()->clear();
+  }
+
   template <typename T = ApiParameters, typename... Args>
   typename std::enable_if<apiHasMembers<T>::value, sai_object_id_t>::type
   createMember(
@@ -128,8 +366,13 @@ class SaiApi {
     static_assert(
         std::is_same<T, ApiParameters>::value,
         "MemberAttributes must come from correct ApiParameters");
+    auto createAttrsJson = createAttrs.toFollyDynamic();
+    auto reclaimed = memberWarmBootRecords_.wlock()->reclaim(createAttrsJson);
+    if (reclaimed) {
+      return reclaimed.value();
+    }
     sai_object_id_t id;
-    std::vector<sai_attribute_t> saiAttributeTs = createAttrs.saiAttrs();
+    auto saiAttributeTs = createAttrs.saiAttrArray();
     sai_status_t status = impl()._createMember(
         &id,
         saiAttributeTs.data(),
@@ -137,6 +380,7 @@ class SaiApi {
         std::forward<Args>(args)...);
     saiApiCheckError(
         status, T::ApiType, "Failed to create2 sai entity member");
+    memberWarmBootRecords_.wlock()->created(id, std::move(createAttrsJson));
     return id;
   }
 
@@ -144,9 +388,256 @@ class SaiApi {
     sai_status_t status = impl()._removeMember(id);
     saiApiCheckError(
         status, ApiParameters::ApiType, "Failed to remove sai member entity");
+    memberAttributeCache_.wlock()->erase(id);
+    memberWarmBootRecords_.wlock()->erase(id);
+  }
+
+  /*
+   * Bulk versions of createMember() and removeMember(). As with the entry
+   * bulk calls, every member is attempted and its status returned in order;
+   * adapters without the bulk call get one call per member. The ids of the
+   * created members are returned in memberIds, and are only valid where the
+   * status is SAI_STATUS_SUCCESS.
+   */
+  template <typename T = ApiParameters>
+  typename std::enable_if<apiHasMembers<T>::value, std::vector<sai_status_t>>::
+      type
+      bulkCreateMembers(
+          const std::vector<typename T::MemberAttributes::CreateAttributes>&
+              createAttrs,
+          sai_object_id_t switchId,
+          std::vector<sai_object_id_t>* memberIds) {
+    static_assert(
+        std::is_same<T, ApiParameters>::value,
+        "MemberAttributes must come from correct ApiParameters");
+    memberIds->assign(createAttrs.size(), SAI_NULL_OBJECT_ID);
+    std::vector<sai_status_t> statuses(
+        createAttrs.size(), SAI_STATUS_SUCCESS);
+    // Members reclaimed after a warm boot are not created again
+    std::vector<size_t> toCreate;
+    std::vector<folly::dynamic> createAttrsJson;
+    std::vector<decltype(createAttrs[0].saiAttrArray())> saiAttributeTs;
+    saiAttributeTs.reserve(createAttrs.size());
+    {
+      auto records = memberWarmBootRecords_.wlock();
+      for (size_t i = 0; i < createAttrs.size(); ++i) {
+        auto attrsJson = createAttrs[i].toFollyDynamic();
+        auto reclaimed = records->reclaim(attrsJson);
+        if (reclaimed) {
+          (*memberIds)[i] = reclaimed.value();
+          continue;
+        }
+        toCreate.push_back(i);
+        createAttrsJson.push_back(std::move(attrsJson));
+        saiAttributeTs.push_back(createAttrs[i].saiAttrArray());
+      }
+    }
+    if (toCreate.empty()) {
+      return statuses;
+    }
+    std::vector<uint32_t> attrCounts;
+    std::vector<const sai_attribute_t*> attrLists;
+    for (const auto& attrs : saiAttributeTs) {
+      attrCounts.push_back(attrs.size());
+      attrLists.push_back(attrs.data());
+    }
+    std::vector<sai_object_id_t> createdIds(
+        toCreate.size(), SAI_NULL_OBJECT_ID);
+    std::vector<sai_status_t> createStatuses(
+        toCreate.size(), SAI_STATUS_NOT_EXECUTED);
+    sai_status_t status = impl()._bulkCreateMembers(
+        switchId,
+        toCreate.size(),
+        attrCounts.data(),
+        attrLists.data(),
+        SAI_BULK_OP_ERROR_MODE_IGNORE_ERROR,
+        createdIds.data(),
+        createStatuses.data());
+    if (bulkUnsupported(status)) {
+      for (size_t i = 0; i < toCreate.size(); ++i) {
+        createStatuses[i] = impl()._createMember(
+            &createdIds[i],
+            saiAttributeTs[i].data(),
+            saiAttributeTs[i].size(),
+            switchId);
+      }
+    }
+    auto records = memberWarmBootRecords_.wlock();
+    for (size_t i = 0; i < toCreate.size(); ++i) {
+      statuses[toCreate[i]] = createStatuses[i];
+      if (createStatuses[i] == SAI_STATUS_SUCCESS) {
+        (*memberIds)[toCreate[i]] = createdIds[i];
+        records->created(createdIds[i], std::move(createAttrsJson[i]));
+      }
+    }
+    return statuses;
+  }
+
+  template <typename T = ApiParameters>
+  typename std::enable_if<apiHasMembers<T>::value, std::vector<sai_status_t>>::
+      type
+      bulkRemoveMembers(const std::vector<sai_object_id_t>& memberIds) {
+    std::vector<sai_status_t> statuses(
+        memberIds.size(), SAI_STATUS_NOT_EXECUTED);
+    sai_status_t status = impl()._bulkRemoveMembers(
+        memberIds.size(),
+        memberIds.data(),
+        SAI_BULK_OP_ERROR_MODE_IGNORE_ERROR,
+        statuses.data());
+    if (bulkUnsupported(status)) {
+      for (size_t i = 0; i < memberIds.size(); ++i) {
+        statuses[i] = impl()._removeMember(memberIds[i]);
+      }
+    }
+    auto cache = memberAttributeCache_.wlock();
+    auto records = memberWarmBootRecords_.wlock();
+    for (size_t i = 0; i < memberIds.size(); ++i) {
+      if (statuses[i] == SAI_STATUS_SUCCESS) {
+        cache->erase(memberIds[i]);
+        records->erase(memberIds[i]);
+      }
+    }
+    return statuses;
+  }
+
+  // The objects and members this api has created, as SaiWarmBootRecords
+  folly::dynamic warmBootState() const {
+    return folly::dynamic::object(
+        "objects", warmBootRecords_.rlock()->toFollyDynamic())(
+        "members", memberWarmBootRecords_.rlock()->toFollyDynamic());
+  }
+
+  /*
+   * Load what warmBootState() returned before a warm boot. The objects are
+   * reclaimable unless told otherwise, e.g., when objects of this api can't
+   * be told apart by their attributes, and reclaiming the wrong one would
+   * change what the dataplane does until it is reprogrammed.
+   */
+  void loadWarmBootState(const folly::dynamic& state, bool reclaimable = true) {
+    warmBootRecords_.wlock()->loadStale(state["objects"], reclaimable);
+    memberWarmBootRecords_.wlock()->loadStale(state["members"], reclaimable);
+  }
+
+  /*
+   * Remove the objects from before the warm boot that nothing has reclaimed,
+   * members first. Failures are logged rather than thrown, so that one
+   * object the adapter no longer knows about doesn't keep the rest around.
+   */
+  void removeUnreclaimed() {
+    for (auto id : memberWarmBootRecords_.wlock()->takeUnreclaimed()) {
+      removeUnreclaimedMember(id);
+    }
+    auto keys = warmBootRecords_.wlock()->takeUnreclaimed();
+    for (const auto& key : keys) {
+      sai_status_t status = impl()._remove(key);
+      if (status != SAI_STATUS_SUCCESS) {
+        XLOG(WARNING) << "Failed to remove unreclaimed sai object of api "
+                      << ApiParameters::ApiType << ": " << status;
+      }
+    }
+    if (!keys.empty()) {
+      XLOG(INFO) << "Removed " << keys.size()
+                 << " unreclaimed sai objects of api "
+                 << ApiParameters::ApiType;
+    }
   }
 
  private:
+  template <typename T = ApiParameters>
+  typename std::enable_if<apiHasMembers<T>::value>::type
+  removeUnreclaimedMember(sai_object_id_t id) {
+    sai_status_t status = impl()._removeMember(id);
+    if (status != SAI_STATUS_SUCCESS) {
+      XLOG(WARNING) << "Failed to remove unreclaimed sai member of api "
+                    << ApiParameters::ApiType << ": " << status;
+    }
+  }
+
+  template <typename T = ApiParameters>
+  typename std::enable_if<!apiHasMembers<T>::value>::type
+  removeUnreclaimedMember(sai_object_id_t /* id */) {}
+
+  /*
+   * Reclaim the stale entry from before a warm boot, if there is one,
+   * setting only the attributes whose value differs from what is wanted.
+   * An entry that can't be brought in line, e.g., because it has an
+   * attribute that is no longer wanted, is removed to be created again.
+   */
+  template <typename SaiAttrsT>
+  bool reclaimEntry(
+      const KeyType& entry,
+      SaiAttrsT& saiAttributeTs,
+      const folly::dynamic& createAttrs) {
+    auto stale = warmBootRecords_.wlock()->takeStale(entry);
+    if (!stale) {
+      return false;
+    }
+    auto& record = stale.value();
+    bool reclaimed = true;
+    for (const auto& id : record.createAttrs.keys()) {
+      if (!createAttrs.count(id)) {
+        reclaimed = false;
+      }
+    }
+    for (auto& saiAttr : saiAttributeTs) {
+      if (!reclaimed) {
+        break;
+      }
+      auto id = folly::to<std::string>(saiAttr.id);
+      const auto& value = createAttrs[id];
+      auto current = record.attrs.get_ptr(id);
+      if (current && *current == value) {
+        continue;
+      }
+      if (impl()._setAttr(&saiAttr, entry) != SAI_STATUS_SUCCESS) {
+        reclaimed = false;
+      }
+      record.attrs[id] = value;
+    }
+    if (!reclaimed) {
+      sai_status_t status = impl()._remove(entry);
+      saiApiCheckError(
+          status, ApiParameters::ApiType, "Failed to remove stale sai entity");
+      return false;
+    }
+    record.createAttrs = createAttrs;
+    warmBootRecords_.wlock()->adopt(entry, std::move(record));
+    return true;
+  }
+
+  template <typename RecordKeyT, typename AttrT>
+  static void updateRecords(
+      SaiWarmBootRecords<RecordKeyT>& records,
+      const RecordKeyT& key,
+      const AttrT& attr,
+      sai_status_t status) {
+    if (status == SAI_STATUS_SUCCESS) {
+      records.set(key, attr.toFollyDynamic());
+    } else {
+      records.invalidate(key, attr.toFollyDynamic());
+    }
+  }
+
+  // A failed set may or may not have reached the hardware, so forget the
+  // attribute rather than keep a value that is possibly stale
+  template <typename CacheKeyT, typename AttrT>
+  static void updateCache(
+      SaiAttributeCache<CacheKeyT>& cache,
+      const CacheKeyT& key,
+      const AttrT& attr,
+      sai_status_t status) {
+    if (status == SAI_STATUS_SUCCESS) {
+      cache.set(key, attr);
+    } else {
+      cache.template invalidate<AttrT>(key);
+    }
+  }
+
+  static bool bulkUnsupported(sai_status_t status) {
+    return status == SAI_STATUS_NOT_IMPLEMENTED ||
+        status == SAI_STATUS_NOT_SUPPORTED;
+  }
+
   // boost visitor that takes a SaiAttribute and returns a pointer to the
   // underlying sai_attribute_t.
   class getSaiAttributeVisitor
@@ -188,6 +679,12 @@ class SaiApi {
   ApiT& impl() {
     return static_cast<ApiT&>(*this);
   }
+
+  folly::Synchronized<SaiAttributeCache<KeyType>> attributeCache_;
+  folly::Synchronized<SaiAttributeCache<sai_object_id_t>> memberAttributeCache_;
+  folly::Synchronized<SaiWarmBootRecords<KeyType>> warmBootRecords_;
+  folly::Synchronized<SaiWarmBootRecords<sai_object_id_t>>
+      memberWarmBootRecords_;
 };
 
 } // namespace fboss
@@ -30,5 +30,54 @@ SaiApiTable::SaiApiTable() {
   virtualRouterApi_ = std::make_unique<VirtualRouterApi>();
   vlanApi_ = std::make_unique<VlanApi>();
 }
+
+folly::dynamic SaiApiTable::warmBootState() const {
+  folly::dynamic state = folly::dynamic::object;
+  state["bridge"] = bridgeApi().warmBootState();
+  state["fdb"] = fdbApi().warmBootState();
+  state["hostif"] = hostifApi().warmBootState();
+  state["neighbor"] = neighborApi().warmBootState();
+  state["nextHop"] = nextHopApi().warmBootState();
+  state["nextHopGroup"] = nextHopGroupApi().warmBootState();
+  state["port"] = portApi().warmBootState();
+  state["route"] = routeApi().warmBootState();
+  state["routerInterface"] = routerInterfaceApi().warmBootState();
+  state["virtualRouter"] = virtualRouterApi().warmBootState();
+  state["vlan"] = vlanApi().warmBootState();
+  return state;
+}
+
+void SaiApiTable::loadWarmBootState(const folly::dynamic& state) {
+  bridgeApi().loadWarmBootState(state["bridge"]);
+  fdbApi().loadWarmBootState(state["fdb"]);
+  hostifApi().loadWarmBootState(state["hostif"]);
+  neighborApi().loadWarmBootState(state["neighbor"]);
+  nextHopApi().loadWarmBootState(state["nextHop"]);
+  // Every ECMP group is created with the same attributes, so a group can't
+  // be matched to the next hops it had. Build the groups again, and move the
+  // routes over to them, rather than reclaim a group with other members.
+  nextHopGroupApi().loadWarmBootState(
+      state["nextHopGroup"], false /* reclaimable */);
+  portApi().loadWarmBootState(state["port"]);
+  routeApi().loadWarmBootState(state["route"]);
+  routerInterfaceApi().loadWarmBootState(state["routerInterface"]);
+  virtualRouterApi().loadWarmBootState(state["virtualRouter"]);
+  vlanApi().loadWarmBootState(state["vlan"]);
+}
+
+void SaiApiTable::removeUnreclaimed() {
+  // Users of an object go before the object they use
+  routeApi().removeUnreclaimed();
+  nextHopGroupApi().removeUnreclaimed();
+  nextHopApi().removeUnreclaimed();
+  neighborApi().removeUnreclaimed();
+  fdbApi().removeUnreclaimed();
+  routerInterfaceApi().removeUnreclaimed();
+  virtualRouterApi().removeUnreclaimed();
+  vlanApi().removeUnreclaimed();
+  bridgeApi().removeUnreclaimed();
+  hostifApi().removeUnreclaimed();
+  portApi().removeUnreclaimed();
+}
 } // namespace fboss
 } // namespace facebook
@@ -23,6 +23,8 @@
 #include "fboss/agent/hw/sai/api/VirtualRouterApi.h"
 #include "fboss/agent/hw/sai/api/VlanApi.h"
 
+#include <folly/dynamic.h>
+
 #include <memory>
 
 namespace facebook {
@@ -34,6 +36,16 @@ class SaiApiTable {
   SaiApiTable(const SaiApiTable& other) = delete;
   SaiApiTable& operator=(const SaiApiTable& other) = delete;
 
+  /*
+   * The SAI objects created through each api, to be written out at graceful
+   * exit, and loaded back on warm boot so that they can be reclaimed (see
+   * SaiApi). The switch itself is not included: the adapter restores it.
+   */
+  folly::dynamic warmBootState() const;
+  void loadWarmBootState(const folly::dynamic& state);
+  // Remove what was loaded by loadWarmBootState() but never reclaimed
+  void removeUnreclaimed();
+
   BridgeApi& bridgeApi() {
     return *bridgeApi_;
   }
@@ -13,10 +13,14 @@
 #include "fboss/agent/hw/sai/api/SaiApiError.h"
 #include "fboss/agent/hw/sai/api/Traits.h"
 
+#include <folly/Conv.h>
 #include <folly/IPAddress.h>
 #include <folly/MacAddress.h>
+#include <folly/dynamic.h>
 #include <folly/logging/xlog.h>
 
+#include <cstddef>
+#include <string>
 #include <type_traits>
 #include <utility>
 #include <vector>
@@ -220,6 +224,49 @@ void _fill(const SaiListT& src, std::vector<T>& dst) {
 
 namespace facebook {
 namespace fboss {
+
+/*
+ * Attribute values as folly::dynamic, for recording what was programmed on
+ * an object across a warm boot (see SaiWarmBootRecords). Object ids do not
+ * fit an int64_t as is, so they, like all integers, are stored as their bit
+ * pattern cast to int64_t.
+ */
+template <typename T>
+typename std::enable_if<std::is_integral<T>::value, folly::dynamic>::type
+saiValueToFollyDynamic(T value) {
+  return static_cast<int64_t>(value);
+}
+
+inline folly::dynamic saiValueToFollyDynamic(const folly::MacAddress& mac) {
+  return mac.toString();
+}
+
+inline folly::dynamic saiValueToFollyDynamic(const folly::IPAddress& ip) {
+  return ip.str();
+}
+
+inline folly::dynamic saiValueToFollyDynamic(const folly::IPAddressV4& ip) {
+  return ip.str();
+}
+
+inline folly::dynamic saiValueToFollyDynamic(const folly::IPAddressV6& ip) {
+  return ip.str();
+}
+
+inline folly::dynamic saiValueToFollyDynamic(
+    const folly::CIDRNetwork& prefix) {
+  return folly::IPAddress::networkToString(prefix);
+}
+
+template <typename T>
+folly::dynamic saiValueToFollyDynamic(const std::vector<T>& values) {
+  folly::dynamic list = folly::dynamic::array;
+  for (const auto& value : values) {
+    list.push_back(saiValueToFollyDynamic(value));
+  }
+  return list;
+}
+
 template <
     typename AttrEnumT,
     AttrEnumT AttrEnum,
@@ -271,6 +318,19 @@ class SaiAttribute<
     return {saiAttr_};
   }
 
+  // See SaiAttributeTuple::saiAttrArray()
+  static constexpr std::size_t maxSaiAttrs = 1;
+  template <typename OutT>
+  void appendSaiAttrs(OutT& out) const {
+    out.push_back(saiAttr_);
+  }
+
+  // {"<attribute id>": value}
+  folly::dynamic toFollyDynamic() const {
+    return folly::dynamic::object(
+        folly::to<std::string>(Id), saiValueToFollyDynamic(value()));
+  }
+
   bool operator==(const SaiAttribute& other) const {
     return other.value() == value();
   }
@@ -377,6 +437,22 @@ class SaiAttribute<
     return {saiAttr_};
   }
 
+  /*
+   * See SaiAttributeTuple::saiAttrArray(). The list in the sai_attribute_t
+   * points at value_, so it is only good for as long as this attribute.
+   */
+  static constexpr std::size_t maxSaiAttrs = 1;
+  template <typename OutT>
+  void appendSaiAttrs(OutT& out) const {
+    out.push_back(saiAttr_);
+  }
+
+  // {"<attribute id>": value}
+  folly::dynamic toFollyDynamic() const {
+    return folly::dynamic::object(
+        folly::to<std::string>(Id), saiValueToFollyDynamic(value()));
+  }
+
   bool operator==(const SaiAttribute& other) const {
     return other.value() == value();
   }
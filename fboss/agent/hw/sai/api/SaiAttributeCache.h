@@ -0,0 +1,109 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include <folly/Optional.h>
+
+#include <boost/any.hpp>
+
+#include <functional>
+#include <type_traits>
+#include <unordered_map>
+
+extern "C" {
+#include <sai.h>
+}
+
+namespace facebook {
+namespace fboss {
+
+/*
+ * SaiAttributeCache remembers, for each SAI object, the value of every
+ * attribute last successfully set on it. KeyT is whatever identifies the
+ * object to the api: a sai_object_id_t, or an entry like a RouteEntry.
+ *
+ * Values are stored as the attribute's ValueType, so a get<AttrT>() returns
+ * exactly the type the SaiAttribute would have produced from the adapter.
+ *
+ * Only attributes we programmed are cached. Attributes that are never set
+ * (read only state like oper status, or lists the adapter fills in) are
+ * never in the cache, and reading them always goes to the adapter.
+ */
+template <typename KeyT>
+class SaiAttributeCache {
+ public:
+  template <typename AttrT>
+  folly::Optional<typename AttrT::ValueType> get(const KeyT& key) const {
+    auto attrs = cache_.find(key);
+    if (attrs == cache_.end()) {
+      return folly::none;
+    }
+    auto value = attrs->second.find(AttrT::Id);
+    if (value == attrs->second.end()) {
+      return folly::none;
+    }
+    return boost::any_cast<typename AttrT::ValueType>(value->second);
+  }
+
+  // true if attr is already the cached value for key
+  template <typename AttrT>
+  bool contains(const KeyT& key, const AttrT& attr) const {
+    auto cached = get<AttrT>(key);
+    return cached && cached.value() == attr.value();
+  }
+
+  template <typename AttrT>
+  void set(const KeyT& key, const AttrT& attr) {
+    cache_[key][AttrT::Id] = attr.value();
+  }
+
+  // Forget one attribute, e.g., after a failed set left its value unknown
+  template <typename AttrT>
+  void invalidate(const KeyT& key) {
+    auto attrs = cache_.find(key);
+    if (attrs != cache_.end()) {
+      attrs->second.erase(AttrT::Id);
+    }
+  }
+
+  // Forget every attribute of an object, e.g., once it is removed
+  void erase(const KeyT& key) {
+    cache_.erase(key);
+  }
+
+  void clear() {
+    cache_.clear();
+  }
+
+  size_t size() const {
+    return cache_.size();
+  }
+
+ private:
+  /*
+   * The std::hash specializations for entry types are declared after the
+   * Api classes that instantiate this cache, so only look the hash up once
+   * a key actually gets hashed.
+   */
+  struct KeyHash {
+    template <typename K>
+    size_t operator()(const K& key) const {
+      return std::hash<K>()(key);
+    }
+  };
+  std::unordered_map<
+      KeyT,
+      std::unordered_map<sai_attr_id_t, boost::any>,
+      KeyHash>
+      cache_;
+};
+
+} // namespace fboss
+} // namespace facebook
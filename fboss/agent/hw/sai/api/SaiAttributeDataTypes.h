@@ -12,8 +12,12 @@
 #include "fboss/agent/hw/sai/api/SaiApiError.h"
 
 #include <folly/Optional.h>
+#include <folly/dynamic.h>
 #include <folly/logging/xlog.h>
 
+#include <array>
+#include <cstddef>
+#include <initializer_list>
 #include <tuple>
 
 #include <boost/variant.hpp>
@@ -25,6 +29,63 @@ extern "C" {
 namespace facebook {
 namespace fboss {
 
+/*
+ * SaiAttributeArray holds the sai_attribute_t structs of a SaiAttributeTuple
+ * inline, with room for as many as its attributes can make up, so getting
+ * them for a create doesn't allocate. List values are not copied: the
+ * structs point into the attributes they came from, which must outlive the
+ * array.
+ */
+template <std::size_t N>
+class SaiAttributeArray {
+ public:
+  void push_back(const sai_attribute_t& attr) {
+    attrs_[size_++] = attr;
+  }
+  sai_attribute_t* data() {
+    return attrs_.data();
+  }
+  const sai_attribute_t* data() const {
+    return attrs_.data();
+  }
+  std::size_t size() const {
+    return size_;
+  }
+  sai_attribute_t* begin() {
+    return attrs_.data();
+  }
+  sai_attribute_t* end() {
+    return attrs_.data() + size_;
+  }
+  const sai_attribute_t* begin() const {
+    return attrs_.data();
+  }
+  const sai_attribute_t* end() const {
+    return attrs_.data() + size_;
+  }
+
+ private:
+  std::array<sai_attribute_t, N> attrs_;
+  std::size_t size_{0};
+};
+
+namespace detail {
+constexpr std::size_t saiAttrsSum(std::initializer_list<std::size_t> counts) {
+  std::size_t sum = 0;
+  for (auto count : counts) {
+    sum += count;
+  }
+  return sum;
+}
+constexpr std::size_t saiAttrsMax(std::initializer_list<std::size_t> counts) {
+  std::size_t max = 0;
+  for (auto count : counts) {
+    max = count > max ? count : max;
+  }
+  return max;
+}
+} // namespace detail
+
 /*
  * SaiAttributeTuple, SaiAttributeVariant, and SaiAttributeOptional have the
  * same interface as a normal attribute, but actually hide a tuple or variant of
@@ -49,6 +110,8 @@ class SaiAttributeTuple {
   using ValueType = std::tuple<typename AttrTs::ValueType...>;
   static constexpr std::size_t size =
       std::tuple_size<std::tuple<AttrTs...>>::value;
+  static constexpr std::size_t maxSaiAttrs =
+      detail::saiAttrsSum({std::size_t{0}, AttrTs::maxSaiAttrs...});
 
   SaiAttributeTuple(const AttrTs&... ts) : tuple_(ts...) {}
 
@@ -59,7 +122,27 @@ class SaiAttributeTuple {
   // TODO: once all *Apis move to the new model, stop calling this
   // saiAttrV and takeover saiAttr
   std::vector<sai_attribute_t> saiAttrs() const {
-    return saiAttrVector();
+    std::vector<sai_attribute_t> saiAttrs;
+    saiAttrs.reserve(maxSaiAttrs);
+    appendSaiAttrs(saiAttrs);
+    return saiAttrs;
+  }
+
+  // saiAttrs() without the heap allocation, for creating objects
+  SaiAttributeArray<maxSaiAttrs> saiAttrArray() const {
+    SaiAttributeArray<maxSaiAttrs> saiAttrs;
+    appendSaiAttrs(saiAttrs);
+    return saiAttrs;
+  }
+
+  template <typename OutT>
+  void appendSaiAttrs(OutT& out) const {
+    appendSaiAttrsImpl(out, std::make_index_sequence<size>{});
+  }
+
+  // The attributes of the tuple, merged into one object
+  folly::dynamic toFollyDynamic() const {
+    return toFollyDynamicImpl(std::make_index_sequence<size>{});
   }
 
   bool operator==(const SaiAttributeTuple& other) const {
@@ -74,22 +157,20 @@ class SaiAttributeTuple {
   ValueType valueImpl(std::index_sequence<I...>) const {
     return std::make_tuple(std::get<I>(tuple_).value()...);
   }
-  std::vector<sai_attribute_t> saiAttrVector() const {
-    return saiAttrVectorImpl(std::make_index_sequence<size>{});
-  }
   template <std::size_t... I>
-  std::vector<sai_attribute_t> saiAttrVectorImpl(
-      std::index_sequence<I...>) const {
-    std::vector<sai_attribute_t> saiAttrs;
-    std::vector<std::vector<sai_attribute_t>> saiAttrVs{
-        std::get<I>(tuple_).saiAttrs()...};
-    std::for_each(
-        saiAttrVs.begin(),
-        saiAttrVs.end(),
-        [&saiAttrs](const std::vector<sai_attribute_t>& saiAttrV) {
-          saiAttrs.insert(saiAttrs.end(), saiAttrV.begin(), saiAttrV.end());
-        });
-    return saiAttrs;
+  folly::dynamic toFollyDynamicImpl(std::index_sequence<I...>) const {
+    folly::dynamic attrs = folly::dynamic::object;
+    std::vector<folly::dynamic> parts{std::get<I>(tuple_).toFollyDynamic()...};
+    for (const auto& part : parts) {
+      attrs.update(part);
+    }
+    return attrs;
+  }
+  template <typename OutT, std::size_t... I>
+  void appendSaiAttrsImpl(OutT& out, std::index_sequence<I...>) const {
+    // Expands to one appendSaiAttrs() per attribute, in order
+    (void)std::initializer_list<int>{
+        (std::get<I>(tuple_).appendSaiAttrs(out), 0)...};
   }
   std::tuple<AttrTs...> tuple_;
 };
@@ -98,6 +179,8 @@ template <typename... AttrTs>
 class SaiAttributeVariant {
  public:
   using ValueType = boost::variant<typename AttrTs::ValueType...>;
+  static constexpr std::size_t maxSaiAttrs =
+      detail::saiAttrsMax({std::size_t{0}, AttrTs::maxSaiAttrs...});
 
   template <typename AttrT>
   SaiAttributeVariant(AttrT&& attr) : variant_(std::forward<AttrT>(attr)){};
@@ -119,6 +202,13 @@ class SaiAttributeVariant {
   std::vector<sai_attribute_t> saiAttrs() const {
     return boost::apply_visitor(saiAttrVisitor(), variant_);
   }
+  template <typename OutT>
+  void appendSaiAttrs(OutT& out) const {
+    boost::apply_visitor(appendSaiAttrsVisitor<OutT>(out), variant_);
+  }
+  folly::dynamic toFollyDynamic() const {
+    return boost::apply_visitor(toFollyDynamicVisitor(), variant_);
+  }
   bool operator==(const SaiAttributeVariant& other) {
     return variant_ == other.variant_;
   }
@@ -143,6 +233,33 @@ class SaiAttributeVariant {
       folly::assume_unreachable();
     }
   };
+  template <typename OutT>
+  class appendSaiAttrsVisitor : public boost::static_visitor<void> {
+   public:
+    explicit appendSaiAttrsVisitor(OutT& out) : out_(out) {}
+    template <typename AttrT>
+    void operator()(const AttrT& attr) const {
+      attr.appendSaiAttrs(out_);
+    }
+    void operator()(const boost::blank& /* blank */) const {
+      saiCheckError(
+          SAI_STATUS_FAILURE,
+          "Attempted to get saiAttr from blank SaiAttributeVariant");
+    }
+
+   private:
+    OutT& out_;
+  };
+  class toFollyDynamicVisitor : public boost::static_visitor<folly::dynamic> {
+   public:
+    template <typename AttrT>
+    folly::dynamic operator()(const AttrT& attr) const {
+      return attr.toFollyDynamic();
+    }
+    folly::dynamic operator()(const boost::blank& /* blank */) const {
+      return folly::dynamic::object;
+    }
+  };
   class valueVisitor : public boost::static_visitor<ValueType> {
    public:
     template <typename AttrT>
@@ -165,6 +282,7 @@ template <typename AttrT>
 class SaiAttributeOptional {
  public:
   using ValueType = folly::Optional<typename AttrT::ValueType>;
+  static constexpr std::size_t maxSaiAttrs = AttrT::maxSaiAttrs;
   SaiAttributeOptional() {}
   /* implicit */ SaiAttributeOptional(const folly::None&) {}
   /* implicit */ SaiAttributeOptional(const typename AttrT::ValueType& v)
@@ -188,6 +306,19 @@ class SaiAttributeOptional {
     }
     return optional_.value().saiAttrs();
   }
+  template <typename OutT>
+  void appendSaiAttrs(OutT& out) const {
+    if (optional_) {
+      optional_.value().appendSaiAttrs(out);
+    }
+  }
+  // An object without the attribute, if it is not set
+  folly::dynamic toFollyDynamic() const {
+    if (!optional_) {
+      return folly::dynamic::object;
+    }
+    return optional_.value().toFollyDynamic();
+  }
   bool operator==(const SaiAttributeOptional& other) const {
     return optional_ == other.optional_;
   }
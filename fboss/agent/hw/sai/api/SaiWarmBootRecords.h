@@ -0,0 +1,244 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include <folly/Optional.h>
+#include <folly/dynamic.h>
+#include <folly/json.h>
+
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+extern "C" {
+#include <sai.h>
+}
+
+namespace facebook {
+namespace fboss {
+
+inline folly::dynamic saiKeyToFollyDynamic(sai_object_id_t id) {
+  return static_cast<int64_t>(id);
+}
+
+template <typename EntryT>
+folly::dynamic saiKeyToFollyDynamic(const EntryT& entry) {
+  return entry.toFollyDynamic();
+}
+
+template <typename KeyT>
+struct SaiKeyFromFollyDynamic {
+  static KeyT fromFollyDynamic(const folly::dynamic& json) {
+    return KeyT::fromFollyDynamic(json);
+  }
+};
+
+template <>
+struct SaiKeyFromFollyDynamic<sai_object_id_t> {
+  static sai_object_id_t fromFollyDynamic(const folly::dynamic& json) {
+    return static_cast<sai_object_id_t>(json.asInt());
+  }
+};
+
+/*
+ * SaiWarmBootRecords remembers, for each SAI object an api has created and
+ * not yet removed, the attributes it was created with and the value of every
+ * attribute programmed on it since. Attributes are kept as the
+ * SaiAttribute::toFollyDynamic() object {"<attribute id>": value}, so the
+ * records can be written out at graceful exit.
+ *
+ * On warm boot, the records of the previous run are loaded back as stale
+ * objects, which the adapter still has. Rather than creating an object
+ * again, the api reclaims the stale one that matches it: an entry (route,
+ * neighbor, fdb) by its key, an object with an id by the values of the
+ * attributes it is created with. Whatever has not been reclaimed once the
+ * switch has been reprogrammed is no longer wanted, and is removed.
+ */
+template <typename KeyT>
+class SaiWarmBootRecords {
+ public:
+  struct Record {
+    folly::dynamic createAttrs;
+    folly::dynamic attrs;
+    // Taken over from before a warm boot rather than created
+    bool reclaimed{false};
+  };
+
+  void created(const KeyT& key, folly::dynamic createAttrs) {
+    auto attrs = createAttrs;
+    live_[key] = Record{std::move(createAttrs), std::move(attrs), false};
+  }
+
+  void set(const KeyT& key, const folly::dynamic& attr) {
+    auto record = live_.find(key);
+    if (record != live_.end()) {
+      record->second.attrs.update(attr);
+    }
+  }
+
+  // Forget attributes whose value is unknown, e.g., after a failed set
+  void invalidate(const KeyT& key, const folly::dynamic& attr) {
+    auto record = live_.find(key);
+    if (record == live_.end()) {
+      return;
+    }
+    for (const auto& id : attr.keys()) {
+      record->second.attrs.erase(id);
+    }
+  }
+
+  /*
+   * true if key was reclaimed and every attribute in attr already has that
+   * value on it. Objects we created ourselves are left to the attribute
+   * cache, which knows what was set on them.
+   */
+  bool reclaimedWith(const KeyT& key, const folly::dynamic& attr) const {
+    auto record = live_.find(key);
+    if (record == live_.end() || !record->second.reclaimed) {
+      return false;
+    }
+    for (const auto& value : attr.items()) {
+      auto current = record->second.attrs.get_ptr(value.first);
+      if (!current || *current != value.second) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void erase(const KeyT& key) {
+    live_.erase(key);
+  }
+
+  folly::dynamic toFollyDynamic() const {
+    folly::dynamic records = folly::dynamic::array;
+    for (const auto& record : live_) {
+      records.push_back(folly::dynamic::object(
+          "key", saiKeyToFollyDynamic(record.first))(
+          "createAttrs", record.second.createAttrs)(
+          "attrs", record.second.attrs));
+    }
+    return records;
+  }
+
+  /*
+   * Load the records written by the previous run as stale objects.
+   * Objects that are not reclaimable are never handed out again, e.g.,
+   * because objects of that kind can't be told apart by their attributes;
+   * they are only kept to be removed.
+   */
+  void loadStale(const folly::dynamic& records, bool reclaimable) {
+    for (const auto& json : records) {
+      auto key = SaiKeyFromFollyDynamic<KeyT>::fromFollyDynamic(json["key"]);
+      Record record{json["createAttrs"], json["attrs"], false};
+      if (reclaimable) {
+        staleByAttrs_.emplace(fingerprint(record), key);
+      }
+      stale_[key] = std::move(record);
+    }
+    reclaimable_ = reclaimable;
+  }
+
+  // Reclaim a stale object with an id that was created the same way
+  folly::Optional<KeyT> reclaim(const folly::dynamic& createAttrs) {
+    if (staleByAttrs_.empty()) {
+      return folly::none;
+    }
+    auto match = staleByAttrs_.find(fingerprint(createAttrs));
+    if (match == staleByAttrs_.end()) {
+      return folly::none;
+    }
+    KeyT key = match->second;
+    staleByAttrs_.erase(match);
+    auto record = stale_.find(key);
+    record->second.reclaimed = true;
+    live_[key] = std::move(record->second);
+    stale_.erase(record);
+    return key;
+  }
+
+  /*
+   * Take the stale record for an entry; the caller brings the entry in line
+   * with what it wants and then adopt()s it.
+   */
+  folly::Optional<Record> takeStale(const KeyT& key) {
+    if (!reclaimable_) {
+      return folly::none;
+    }
+    auto record = stale_.find(key);
+    if (record == stale_.end()) {
+      return folly::none;
+    }
+    Record stale = std::move(record->second);
+    stale_.erase(record);
+    return stale;
+  }
+
+  void adopt(const KeyT& key, Record record) {
+    record.reclaimed = true;
+    live_[key] = std::move(record);
+  }
+
+  // The stale objects nothing has reclaimed, which are now up for removal
+  std::vector<KeyT> takeUnreclaimed() {
+    std::vector<KeyT> keys;
+    keys.reserve(stale_.size());
+    for (const auto& record : stale_) {
+      keys.push_back(record.first);
+    }
+    stale_.clear();
+    staleByAttrs_.clear();
+    reclaimable_ = false;
+    return keys;
+  }
+
+  size_t size() const {
+    return live_.size();
+  }
+
+  size_t staleSize() const {
+    return stale_.size();
+  }
+
+ private:
+  // Create attributes as the values the object now has for them
+  static std::string fingerprint(const Record& record) {
+    folly::dynamic attrs = folly::dynamic::object;
+    for (const auto& attr : record.createAttrs.keys()) {
+      auto value = record.attrs.get_ptr(attr);
+      attrs[attr] = value ? *value : record.createAttrs[attr];
+    }
+    return fingerprint(attrs);
+  }
+
+  static std::string fingerprint(const folly::dynamic& attrs) {
+    folly::json::serialization_opts opts;
+    opts.sort_keys = true;
+    return folly::json::serialize(attrs, opts);
+  }
+
+  // See SaiAttributeCache::KeyHash
+  struct KeyHash {
+    template <typename K>
+    size_t operator()(const K& key) const {
+      return std::hash<K>()(key);
+    }
+  };
+
+  std::unordered_map<KeyT, Record, KeyHash> live_;
+  std::unordered_map<KeyT, Record, KeyHash> stale_;
+  std::unordered_multimap<std::string, KeyT> staleByAttrs_;
+  bool reclaimable_{false};
+};
+
+} // namespace fboss
+} // namespace facebook
@@ -61,16 +61,21 @@ struct SwitchApiParameters {
         EnumType,
         SAI_SWITCH_ATTR_MAX_NUMBER_OF_SUPPORTED_PORTS,
         sai_uint32_t>;
+    // Set on create to attach to the state kept across a warm boot, and
+    // before removing the switch to keep the state for the next one
+    using RestartWarm =
+        SaiAttribute<EnumType, SAI_SWITCH_ATTR_RESTART_WARM, bool>;
     using CreateAttributes = SaiAttributeTuple<
         InitSwitch,
         SaiAttributeOptional<HwInfo>,
-        SaiAttributeOptional<SrcMac>>;
+        SaiAttributeOptional<SrcMac>,
+        SaiAttributeOptional<RestartWarm>>;
     Attributes() {}
     Attributes(const CreateAttributes& attrs) {
-      std::tie(initSwitch, hwInfo, srcMac) = attrs.value();
+      std::tie(initSwitch, hwInfo, srcMac, restartWarm) = attrs.value();
     }
     CreateAttributes attrs() const {
-      return {initSwitch, hwInfo, srcMac};
+      return {initSwitch, hwInfo, srcMac, restartWarm};
     }
     bool operator==(const Attributes& other) const {
       return attrs() == other.attrs();
@@ -81,6 +86,7 @@ struct SwitchApiParameters {
     typename InitSwitch::ValueType initSwitch;
     typename folly::Optional<HwInfo::ValueType> hwInfo;
     typename folly::Optional<SrcMac::ValueType> srcMac;
+    typename folly::Optional<RestartWarm::ValueType> restartWarm;
   };
 };
 
@@ -108,6 +114,15 @@ class SwitchApi : public SaiApi<SwitchApi, SwitchApiParameters> {
     return _setAttr(&attr, switch_id);
   }
 
+  sai_status_t registerFdbEventCallback(
+      sai_object_id_t switch_id,
+      sai_fdb_event_notification_fn fdb_event_cb) {
+    sai_attribute_t attr;
+    attr.id = SAI_SWITCH_ATTR_FDB_EVENT_NOTIFY;
+    attr.value.ptr = (void*)fdb_event_cb;
+    return _setAttr(&attr, switch_id);
+  }
+
  private:
   sai_status_t _create(
       sai_object_id_t* switch_id,
@@ -53,6 +53,22 @@ struct apiUsesEntry<RouteApiParameters> : public std::true_type {};
 template <>
 struct apiUsesEntry<FdbApiParameters> : public std::true_type {};
 
+/*
+ * apiKey<T>::type is what identifies an object of an ApiTypes to
+ * remove/getAttribute/setAttribute: T::EntryType if apiUsesEntry<T>::value,
+ * otherwise sai_object_id_t.
+ */
+template <typename ApiTypes, typename Enable = void>
+struct apiKey {
+  using type = sai_object_id_t;
+};
+template <typename ApiTypes>
+struct apiKey<
+    ApiTypes,
+    typename std::enable_if<apiUsesEntry<ApiTypes>::value>::type> {
+  using type = typename ApiTypes::EntryType;
+};
+
 /*
  * apiHasMembers<T>::value is true if T is an ApiTypes which
  * has nested "members". Examples of SaiApis whose types satisfy
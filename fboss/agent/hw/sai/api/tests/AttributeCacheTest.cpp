@@ -0,0 +1,63 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/hw/sai/api/SaiAttribute.h"
+#include "fboss/agent/hw/sai/api/SaiAttributeCache.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using namespace facebook::fboss;
+
+using BoolAttr = SaiAttribute<sai_attr_id_t, 0, bool>;
+using UInt32Attr = SaiAttribute<sai_attr_id_t, 1, sai_uint32_t>;
+using VecAttr = SaiAttribute<sai_attr_id_t, 2, std::vector<sai_uint32_t>>;
+
+TEST(AttributeCache, setAndGet) {
+  SaiAttributeCache<sai_object_id_t> cache;
+  EXPECT_FALSE(cache.get<BoolAttr>(42));
+  cache.set(42, BoolAttr{true});
+  cache.set(42, UInt32Attr{100});
+  EXPECT_EQ(1, cache.size());
+  EXPECT_TRUE(cache.get<BoolAttr>(42).value());
+  EXPECT_EQ(100, cache.get<UInt32Attr>(42).value());
+  // Other objects and attributes are unaffected
+  EXPECT_FALSE(cache.get<BoolAttr>(43));
+  EXPECT_FALSE(cache.get<VecAttr>(42));
+
+  cache.set(42, UInt32Attr{200});
+  EXPECT_EQ(200, cache.get<UInt32Attr>(42).value());
+}
+
+TEST(AttributeCache, contains) {
+  SaiAttributeCache<sai_object_id_t> cache;
+  std::vector<sai_uint32_t> lanes{1, 2, 3, 4};
+  EXPECT_FALSE(cache.contains(42, VecAttr{lanes}));
+  cache.set(42, VecAttr{lanes});
+  EXPECT_TRUE(cache.contains(42, VecAttr{lanes}));
+  EXPECT_FALSE(cache.contains(42, VecAttr{std::vector<sai_uint32_t>{1}}));
+  EXPECT_FALSE(cache.contains(43, VecAttr{lanes}));
+}
+
+TEST(AttributeCache, invalidateAndErase) {
+  SaiAttributeCache<sai_object_id_t> cache;
+  cache.set(42, BoolAttr{true});
+  cache.set(42, UInt32Attr{100});
+  cache.set(43, BoolAttr{false});
+  cache.invalidate<BoolAttr>(42);
+  EXPECT_FALSE(cache.get<BoolAttr>(42));
+  EXPECT_TRUE(cache.get<UInt32Attr>(42));
+
+  cache.erase(42);
+  EXPECT_FALSE(cache.get<UInt32Attr>(42));
+  EXPECT_TRUE(cache.get<BoolAttr>(43));
+  cache.clear();
+  EXPECT_EQ(0, cache.size());
+}
@@ -33,6 +33,22 @@ TEST(AttributeDataTypes, attributeTupleGetSaiAttr) {
   EXPECT_EQ(saiAttrs[2].value.objlist.count, 42);
 }
 
+TEST(AttributeDataTypes, attributeTupleGetSaiAttrArray) {
+  std::vector<sai_object_id_t> vec;
+  vec.resize(42);
+  using NestedTuple =
+      SaiAttributeTuple<B, SaiAttributeOptional<I>, AttrVariant, VecAttr>;
+  static_assert(NestedTuple::maxSaiAttrs == 4, "one per attribute");
+  NestedTuple at{B{true}, folly::none, AttrVariant{I{42}}, VecAttr{vec}};
+  auto saiAttrs = at.saiAttrArray();
+  // The unset optional takes no room
+  EXPECT_EQ(saiAttrs.size(), 3);
+  EXPECT_TRUE(saiAttrs.data()[0].value.booldata);
+  EXPECT_EQ(saiAttrs.data()[1].value.s32, 42);
+  EXPECT_EQ(saiAttrs.data()[2].value.objlist.count, 42);
+  EXPECT_EQ(at.saiAttrs().size(), saiAttrs.size());
+}
+
 TEST(AttributeDataTypes, attributeTupleGetValue) {
   std::vector<sai_object_id_t> vec;
   vec.resize(42);
@@ -132,3 +132,34 @@ TEST_F(PortApiTest, removePort) {
     }
   }
 }
+
+TEST_F(PortApiTest, setAttributeSkipsCachedValue) {
+  auto id = createPort(25000, {42}, true);
+  PortApiParameters::Attributes::Speed speed(50000);
+  EXPECT_EQ(SAI_STATUS_SUCCESS, portApi->setAttribute(speed, id));
+  EXPECT_EQ(50000, fs->pm.get(id).speed);
+
+  // Change the port behind the api's back: setting the same speed again is
+  // a no-op, and gets are served from the cache until read from hardware.
+  fs->pm.get(id).speed = 100000;
+  EXPECT_EQ(SAI_STATUS_SUCCESS, portApi->setAttribute(speed, id));
+  EXPECT_EQ(100000, fs->pm.get(id).speed);
+  EXPECT_EQ(
+      50000,
+      portApi->getAttribute(PortApiParameters::Attributes::Speed{}, id));
+  EXPECT_EQ(
+      100000,
+      portApi->getAttributeFromHw(PortApiParameters::Attributes::Speed{}, id));
+
+  portApi->clearAttributeCache();
+  EXPECT_EQ(SAI_STATUS_SUCCESS, portApi->setAttribute(speed, id));
+  EXPECT_EQ(50000, fs->pm.get(id).speed);
+}
+
+TEST_F(PortApiTest, getUnsetAttributeReadsHardware) {
+  auto id = createPort(25000, {42}, true);
+  PortApiParameters::Attributes::AdminState adminState;
+  EXPECT_TRUE(portApi->getAttribute(adminState, id));
+  fs->pm.get(id).adminState = false;
+  EXPECT_FALSE(portApi->getAttribute(adminState, id));
+}
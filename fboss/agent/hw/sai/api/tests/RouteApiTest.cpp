@@ -80,3 +80,69 @@ TEST_F(RouteApiTest, setRouteNextHop) {
       routeApi->getAttribute(RouteApiParameters::Attributes::NextHopId(), r),
       42);
 }
+
+TEST_F(RouteApiTest, bulkCreateAndRemoveRoutes) {
+  std::vector<RouteApiParameters::RouteEntry> entries{
+      {0, 0, folly::CIDRNetwork(ip4, 16)}, {0, 0, folly::CIDRNetwork(ip6, 48)}};
+  std::vector<RouteApiParameters::Attributes::CreateAttributes> attrs{
+      {SAI_PACKET_ACTION_FORWARD, 5}, {SAI_PACKET_ACTION_DROP, folly::none}};
+  auto statuses = routeApi->bulkCreate(entries, attrs);
+  EXPECT_EQ(
+      (std::vector<sai_status_t>{SAI_STATUS_SUCCESS, SAI_STATUS_SUCCESS}),
+      statuses);
+  EXPECT_EQ(
+      routeApi->getAttribute(
+          RouteApiParameters::Attributes::NextHopId(), entries[0]),
+      5);
+  EXPECT_EQ(
+      routeApi->getAttribute(
+          RouteApiParameters::Attributes::PacketAction(), entries[1]),
+      SAI_PACKET_ACTION_DROP);
+
+  auto routeCount = fs->rm.map().size();
+  statuses = routeApi->bulkRemove(entries);
+  EXPECT_EQ(
+      (std::vector<sai_status_t>{SAI_STATUS_SUCCESS, SAI_STATUS_SUCCESS}),
+      statuses);
+  EXPECT_EQ(routeCount - 2, fs->rm.map().size());
+}
+
+TEST_F(RouteApiTest, bulkSetRouteNextHop) {
+  std::vector<RouteApiParameters::RouteEntry> entries{
+      {0, 0, folly::CIDRNetwork(ip4, 16)}, {0, 0, folly::CIDRNetwork(ip4, 8)}};
+  std::vector<RouteApiParameters::Attributes::CreateAttributes> attrs{
+      {SAI_PACKET_ACTION_FORWARD, 5}, {SAI_PACKET_ACTION_FORWARD, 6}};
+  routeApi->bulkCreate(entries, attrs);
+  std::vector<RouteApiParameters::Attributes::NextHopId> nextHops{
+      RouteApiParameters::Attributes::NextHopId(42),
+      RouteApiParameters::Attributes::NextHopId(43)};
+  auto statuses = routeApi->bulkSetAttribute(entries, nextHops);
+  EXPECT_EQ(
+      (std::vector<sai_status_t>{SAI_STATUS_SUCCESS, SAI_STATUS_SUCCESS}),
+      statuses);
+  EXPECT_EQ(
+      routeApi->getAttribute(
+          RouteApiParameters::Attributes::NextHopId(), entries[0]),
+      42);
+  EXPECT_EQ(
+      routeApi->getAttribute(
+          RouteApiParameters::Attributes::NextHopId(), entries[1]),
+      43);
+  routeApi->bulkRemove(entries);
+}
+
+TEST_F(RouteApiTest, bulkRemoveReportsEachFailure) {
+  RouteApiParameters::RouteEntry r1(0, 0, folly::CIDRNetwork(ip4, 16));
+  RouteApiParameters::RouteEntry r2(0, 0, folly::CIDRNetwork(ip6, 48));
+  routeApi->create(r1, {SAI_PACKET_ACTION_FORWARD, 5});
+  routeApi->create(r2, {SAI_PACKET_ACTION_FORWARD, 5});
+  // The entry in the middle was never created
+  std::vector<RouteApiParameters::RouteEntry> entries{
+      r1, {0, 0, folly::CIDRNetwork(ip4, 8)}, r2};
+  auto statuses = routeApi->bulkRemove(entries);
+  EXPECT_EQ(
+      (std::vector<sai_status_t>{
+          SAI_STATUS_SUCCESS, SAI_STATUS_FAILURE, SAI_STATUS_SUCCESS}),
+      statuses);
+  EXPECT_EQ(0, fs->rm.map().count(FakeRouteEntry{0, 0, r2.destination()}));
+}
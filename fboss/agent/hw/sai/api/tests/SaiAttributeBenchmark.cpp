@@ -0,0 +1,77 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/hw/sai/api/PortApi.h"
+#include "fboss/agent/hw/sai/api/RouteApi.h"
+
+#include <folly/Benchmark.h>
+#include <folly/init/Init.h>
+
+#include <vector>
+
+using facebook::fboss::PortApiParameters;
+using facebook::fboss::RouteApiParameters;
+
+namespace {
+
+PortApiParameters::Attributes::CreateAttributes portCreateAttrs() {
+  PortApiParameters::Attributes::HwLaneList lanes{
+      std::vector<uint32_t>{1, 2, 3, 4}};
+  PortApiParameters::Attributes::Speed speed{100000};
+  PortApiParameters::Attributes::AdminState adminState{true};
+  return {lanes, speed, adminState};
+}
+
+RouteApiParameters::Attributes::CreateAttributes routeCreateAttrs() {
+  RouteApiParameters::Attributes::PacketAction packetAction{
+      SAI_PACKET_ACTION_FORWARD};
+  RouteApiParameters::Attributes::NextHopId nextHopId{42};
+  return {packetAction, nextHopId};
+}
+
+// The sai_attribute_t structs of a create, the way SaiApi used to get them
+template <typename CreateAttributesT>
+void saiAttrVector(size_t iters, const CreateAttributesT& createAttrs) {
+  for (size_t i = 0; i < iters; ++i) {
+    auto saiAttrs = createAttrs.saiAttrs();
+    folly::doNotOptimizeAway(saiAttrs.data());
+  }
+}
+
+template <typename CreateAttributesT>
+void saiAttrArray(size_t iters, const CreateAttributesT& createAttrs) {
+  for (size_t i = 0; i < iters; ++i) {
+    auto saiAttrs = createAttrs.saiAttrArray();
+    folly::doNotOptimizeAway(saiAttrs.data());
+  }
+}
+
+} // namespace
+
+BENCHMARK(portSaiAttrVector, iters) {
+  saiAttrVector(iters, portCreateAttrs());
+}
+
+BENCHMARK_RELATIVE(portSaiAttrArray, iters) {
+  saiAttrArray(iters, portCreateAttrs());
+}
+
+BENCHMARK(routeSaiAttrVector, iters) {
+  saiAttrVector(iters, routeCreateAttrs());
+}
+
+BENCHMARK_RELATIVE(routeSaiAttrArray, iters) {
+  saiAttrArray(iters, routeCreateAttrs());
+}
+
+int main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  folly::runBenchmarks();
+  return 0;
+}
@@ -0,0 +1,107 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/hw/sai/api/SaiAttribute.h"
+#include "fboss/agent/hw/sai/api/SaiWarmBootRecords.h"
+#include "fboss/agent/hw/sai/api/VlanApi.h"
+#include "fboss/agent/hw/sai/fake/FakeSai.h"
+
+#include <gtest/gtest.h>
+
+using namespace facebook::fboss;
+
+using BoolAttr = SaiAttribute<sai_attr_id_t, 0, bool>;
+using UInt32Attr = SaiAttribute<sai_attr_id_t, 1, sai_uint32_t>;
+
+namespace {
+folly::dynamic createAttrs(sai_uint32_t value) {
+  return UInt32Attr{value}.toFollyDynamic();
+}
+} // namespace
+
+TEST(WarmBootRecords, toFollyDynamic) {
+  SaiWarmBootRecords<sai_object_id_t> records;
+  records.created(42, createAttrs(100));
+  records.set(42, BoolAttr{true}.toFollyDynamic());
+  // Objects we did not create are not recorded
+  records.set(43, BoolAttr{true}.toFollyDynamic());
+  auto json = records.toFollyDynamic();
+  ASSERT_EQ(1, json.size());
+  EXPECT_EQ(42, json[0]["key"].asInt());
+  EXPECT_EQ(createAttrs(100), json[0]["createAttrs"]);
+  auto attrs = createAttrs(100);
+  attrs.update(BoolAttr{true}.toFollyDynamic());
+  EXPECT_EQ(attrs, json[0]["attrs"]);
+
+  records.invalidate(42, BoolAttr{true}.toFollyDynamic());
+  EXPECT_EQ(createAttrs(100), records.toFollyDynamic()[0]["attrs"]);
+  records.erase(42);
+  EXPECT_EQ(0, records.size());
+}
+
+TEST(WarmBootRecords, reclaim) {
+  SaiWarmBootRecords<sai_object_id_t> before;
+  before.created(42, createAttrs(100));
+  before.created(43, createAttrs(200));
+  before.set(43, BoolAttr{true}.toFollyDynamic());
+
+  SaiWarmBootRecords<sai_object_id_t> records;
+  records.loadStale(before.toFollyDynamic(), true);
+  EXPECT_EQ(2, records.staleSize());
+  EXPECT_FALSE(records.reclaim(createAttrs(300)));
+  EXPECT_EQ(43, records.reclaim(createAttrs(200)).value());
+  // Each stale object is reclaimed at most once
+  EXPECT_FALSE(records.reclaim(createAttrs(200)));
+  EXPECT_EQ(1, records.size());
+  EXPECT_TRUE(records.reclaimedWith(43, BoolAttr{true}.toFollyDynamic()));
+  EXPECT_FALSE(records.reclaimedWith(43, BoolAttr{false}.toFollyDynamic()));
+
+  auto unreclaimed = records.takeUnreclaimed();
+  ASSERT_EQ(1, unreclaimed.size());
+  EXPECT_EQ(42, unreclaimed[0]);
+  EXPECT_EQ(0, records.staleSize());
+}
+
+TEST(WarmBootRecords, reclaimedWithOnlyForReclaimed) {
+  SaiWarmBootRecords<sai_object_id_t> records;
+  records.created(42, createAttrs(100));
+  EXPECT_FALSE(records.reclaimedWith(42, createAttrs(100)));
+}
+
+TEST(WarmBootRecords, notReclaimable) {
+  SaiWarmBootRecords<sai_object_id_t> before;
+  before.created(42, createAttrs(100));
+
+  SaiWarmBootRecords<sai_object_id_t> records;
+  records.loadStale(before.toFollyDynamic(), false);
+  EXPECT_FALSE(records.reclaim(createAttrs(100)));
+  EXPECT_FALSE(records.takeStale(42));
+  EXPECT_EQ(1, records.takeUnreclaimed().size());
+}
+
+TEST(WarmBootRecords, vlanApiWarmBoot) {
+  auto fs = FakeSai::getInstance();
+  sai_api_initialize(0, nullptr);
+  auto vlanApi = std::make_unique<VlanApi>();
+  auto kept = vlanApi->create({42}, 0);
+  auto dropped = vlanApi->create({43}, 0);
+  auto state = vlanApi->warmBootState();
+
+  // The adapter keeps both vlans across the restart
+  vlanApi = std::make_unique<VlanApi>();
+  vlanApi->loadWarmBootState(state);
+  auto vlanCount = fs->vm.map().size();
+  EXPECT_EQ(kept, vlanApi->create({42}, 0));
+  EXPECT_EQ(vlanCount, fs->vm.map().size());
+
+  vlanApi->removeUnreclaimed();
+  EXPECT_EQ(vlanCount - 1, fs->vm.map().size());
+  EXPECT_EQ(0, fs->vm.map().count(dropped));
+  EXPECT_EQ(1, fs->vm.map().count(kept));
+}
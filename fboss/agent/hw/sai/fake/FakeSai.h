@@ -10,6 +10,7 @@
 #pragma once
 
 #include "fboss/agent/hw/sai/fake/FakeSaiBridge.h"
+#include "fboss/agent/hw/sai/fake/FakeSaiCallStats.h"
 #include "fboss/agent/hw/sai/fake/FakeSaiFdb.h"
 #include "fboss/agent/hw/sai/fake/FakeSaiHostif.h"
 #include "fboss/agent/hw/sai/fake/FakeSaiLag.h"
@@ -48,6 +49,7 @@ struct FakeSai {
   FakeSwitchManager swm;
   FakeVirtualRouterManager vrm;
   FakeVlanManager vm;
+  FakeSaiCallStats callStats;
   bool initialized = false;
 };
 
@@ -21,6 +21,7 @@ sai_status_t create_bridge_fn(
     sai_object_id_t /* switch_id */,
     uint32_t attr_count,
     const sai_attribute_t* attr_list) {
+  facebook::fboss::FakeSaiCall call(SAI_API_BRIDGE);
   auto fs = FakeSai::getInstance();
   folly::Optional<sai_bridge_type_t> bridgeType;
   // See if we have a bridge type.
@@ -50,6 +51,7 @@ sai_status_t create_bridge_fn(
 }
 
 sai_status_t remove_bridge_fn(sai_object_id_t bridge_id) {
+  facebook::fboss::FakeSaiCall call(SAI_API_BRIDGE);
   auto fs = FakeSai::getInstance();
   fs->brm.remove(bridge_id);
   return SAI_STATUS_SUCCESS;
@@ -59,12 +61,14 @@ sai_status_t get_bridge_attribute_fn(
     sai_object_id_t /* bridge_id */,
     uint32_t /* attr_count */,
     sai_attribute_t* /* attr */) {
+  facebook::fboss::FakeSaiCall call(SAI_API_BRIDGE);
   return SAI_STATUS_FAILURE;
 }
 
 sai_status_t set_bridge_attribute_fn(
     sai_object_id_t /* bridge_id */,
     const sai_attribute_t* /* attr */) {
+  facebook::fboss::FakeSaiCall call(SAI_API_BRIDGE);
   return SAI_STATUS_FAILURE;
 }
 
@@ -73,6 +77,7 @@ sai_status_t create_bridge_port_fn(
     sai_object_id_t /* switch_id */,
     uint32_t attr_count,
     const sai_attribute_t* attr_list) {
+  facebook::fboss::FakeSaiCall call(SAI_API_BRIDGE);
   auto fs = FakeSai::getInstance();
   folly::Optional<sai_object_id_t> portId;
   folly::Optional<int32_t> type;
@@ -96,6 +101,7 @@ sai_status_t create_bridge_port_fn(
 }
 
 sai_status_t remove_bridge_port_fn(sai_object_id_t bridge_port_id) {
+  facebook::fboss::FakeSaiCall call(SAI_API_BRIDGE);
   auto fs = FakeSai::getInstance();
   fs->brm.removeMember(bridge_port_id);
   return SAI_STATUS_SUCCESS;
@@ -105,6 +111,7 @@ sai_status_t get_bridge_port_attribute_fn(
     sai_object_id_t bridge_port_id,
     uint32_t attr_count,
     sai_attribute_t* attr) {
+  facebook::fboss::FakeSaiCall call(SAI_API_BRIDGE);
   auto fs = FakeSai::getInstance();
   auto& bridgePort = fs->brm.getMember(bridge_port_id);
   for (int i = 0; i < attr_count; ++i) {
@@ -128,6 +135,7 @@ sai_status_t get_bridge_port_attribute_fn(
 sai_status_t set_bridge_port_attribute_fn(
     sai_object_id_t bridge_port_id,
     const sai_attribute_t* attr) {
+  facebook::fboss::FakeSaiCall call(SAI_API_BRIDGE);
   auto fs = FakeSai::getInstance();
   auto& bridgePort = fs->brm.getMember(bridge_port_id);
   sai_status_t res;
@@ -0,0 +1,93 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/hw/sai/fake/FakeSaiCallStats.h"
+
+#include "fboss/agent/hw/sai/fake/FakeSai.h"
+
+namespace {
+// Histogram buckets of 1us up to 1ms; slower calls land in the last bucket
+constexpr int64_t kLatencyBucketUs = 1;
+constexpr int64_t kLatencyMaxUs = 1000;
+
+// How deep the current thread is in fake api calls
+thread_local int fakeSaiCallDepth = 0;
+} // namespace
+
+namespace facebook {
+namespace fboss {
+
+FakeSaiCallStats::ApiStats::ApiStats()
+    : latencyUs(kLatencyBucketUs, 0, kLatencyMaxUs) {}
+
+void FakeSaiCallStats::setLatency(
+    sai_api_t api,
+    std::chrono::nanoseconds latency) {
+  std::lock_guard<std::mutex> g(mutex_);
+  latency_[api] = latency;
+}
+
+std::chrono::nanoseconds FakeSaiCallStats::latency(sai_api_t api) const {
+  std::lock_guard<std::mutex> g(mutex_);
+  auto latency = latency_.find(api);
+  return latency == latency_.end() ? std::chrono::nanoseconds(0)
+                                   : latency->second;
+}
+
+void FakeSaiCallStats::called(sai_api_t api, std::chrono::nanoseconds took) {
+  std::lock_guard<std::mutex> g(mutex_);
+  auto& stats = stats_[api];
+  ++stats.calls;
+  stats.latencyUs.addValue(
+      std::chrono::duration_cast<std::chrono::microseconds>(took).count());
+}
+
+uint64_t FakeSaiCallStats::calls(sai_api_t api) const {
+  std::lock_guard<std::mutex> g(mutex_);
+  auto stats = stats_.find(api);
+  return stats == stats_.end() ? 0 : stats->second.calls;
+}
+
+std::map<sai_api_t, FakeSaiCallStats::ApiStats> FakeSaiCallStats::stats()
+    const {
+  std::lock_guard<std::mutex> g(mutex_);
+  return stats_;
+}
+
+void FakeSaiCallStats::clear() {
+  std::lock_guard<std::mutex> g(mutex_);
+  stats_.clear();
+}
+
+FakeSaiCall::FakeSaiCall(sai_api_t api)
+    : api_(api), outermost_(fakeSaiCallDepth++ == 0) {
+  if (!outermost_) {
+    return;
+  }
+  start_ = std::chrono::steady_clock::now();
+  auto latency = FakeSai::getInstance()->callStats.latency(api_);
+  if (latency.count() > 0) {
+    // Spin rather than sleep: latencies of interest are far below what a
+    // sleep can resolve
+    auto until = start_ + latency;
+    while (std::chrono::steady_clock::now() < until) {
+    }
+  }
+}
+
+FakeSaiCall::~FakeSaiCall() {
+  --fakeSaiCallDepth;
+  if (outermost_) {
+    FakeSai::getInstance()->callStats.called(
+        api_, std::chrono::steady_clock::now() - start_);
+  }
+}
+
+} // namespace fboss
+} // namespace facebook
@@ -0,0 +1,78 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include <folly/stats/Histogram.h>
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+
+extern "C" {
+#include <sai.h>
+}
+
+namespace facebook {
+namespace fboss {
+
+/*
+ * FakeSaiCallStats counts the calls made to each fake api and how long they
+ * took, and can add a simulated latency to each call to model a slower
+ * adapter. Together they let the managers be benchmarked at scale without
+ * hardware.
+ *
+ * Only calls from outside the fake count: a create that sets its attributes
+ * through the api's own set function is one call.
+ */
+class FakeSaiCallStats {
+ public:
+  struct ApiStats {
+    ApiStats();
+    uint64_t calls{0};
+    // Microseconds per call, simulated latency included
+    folly::Histogram<int64_t> latencyUs;
+  };
+
+  void setLatency(sai_api_t api, std::chrono::nanoseconds latency);
+  std::chrono::nanoseconds latency(sai_api_t api) const;
+
+  void called(sai_api_t api, std::chrono::nanoseconds took);
+  uint64_t calls(sai_api_t api) const;
+  std::map<sai_api_t, ApiStats> stats() const;
+  // Forget the calls made so far; simulated latencies are kept
+  void clear();
+
+ private:
+  mutable std::mutex mutex_;
+  std::map<sai_api_t, std::chrono::nanoseconds> latency_;
+  std::map<sai_api_t, ApiStats> stats_;
+};
+
+/*
+ * Declared at the top of each fake api function: waits out the api's
+ * simulated latency and records the call when it goes out of scope.
+ */
+class FakeSaiCall {
+ public:
+  explicit FakeSaiCall(sai_api_t api);
+  ~FakeSaiCall();
+  FakeSaiCall(const FakeSaiCall&) = delete;
+  FakeSaiCall& operator=(const FakeSaiCall&) = delete;
+
+ private:
+  sai_api_t api_;
+  // False for calls the fake makes to itself
+  bool outermost_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+} // namespace fboss
+} // namespace facebook
@@ -22,6 +22,7 @@ sai_status_t create_fdb_entry_fn(
     const sai_fdb_entry_t* fdb_entry,
     uint32_t attr_count,
     const sai_attribute_t* attr_list) {
+  facebook::fboss::FakeSaiCall call(SAI_API_FDB);
   auto fs = FakeSai::getInstance();
   auto mac = facebook::fboss::fromSaiMacAddress(fdb_entry->mac_address);
   sai_object_id_t bridgePortId = 0;
@@ -43,6 +44,7 @@ sai_status_t create_fdb_entry_fn(
 }
 
 sai_status_t remove_fdb_entry_fn(const sai_fdb_entry_t* fdb_entry) {
+  facebook::fboss::FakeSaiCall call(SAI_API_FDB);
   auto fs = FakeSai::getInstance();
   auto mac = facebook::fboss::fromSaiMacAddress(fdb_entry->mac_address);
   fs->fdbm.remove(std::make_tuple(fdb_entry->switch_id, fdb_entry->bv_id, mac));
@@ -52,6 +54,7 @@ sai_status_t remove_fdb_entry_fn(const sai_fdb_entry_t* fdb_entry) {
 sai_status_t set_fdb_entry_attribute_fn(
     const sai_fdb_entry_t* fdb_entry,
     const sai_attribute_t* attr) {
+  facebook::fboss::FakeSaiCall call(SAI_API_FDB);
   auto fs = FakeSai::getInstance();
   auto mac = facebook::fboss::fromSaiMacAddress(fdb_entry->mac_address);
   auto fdbKey = std::make_tuple(fdb_entry->switch_id, fdb_entry->bv_id, mac);
@@ -70,6 +73,7 @@ sai_status_t get_fdb_entry_attribute_fn(
     const sai_fdb_entry_t* fdb_entry,
     uint32_t attr_count,
     sai_attribute_t* attr_list) {
+  facebook::fboss::FakeSaiCall call(SAI_API_FDB);
   auto fs = FakeSai::getInstance();
   auto mac = facebook::fboss::fromSaiMacAddress(fdb_entry->mac_address);
   auto fdbKey = std::make_tuple(fdb_entry->switch_id, fdb_entry->bv_id, mac);
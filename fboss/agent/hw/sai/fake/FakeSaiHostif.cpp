@@ -23,6 +23,7 @@ sai_status_t send_hostif_fn(
     const void* /* buffer */,
     uint32_t attr_count,
     const sai_attribute_t* attr_list) {
+  facebook::fboss::FakeSaiCall call(SAI_API_HOSTIF);
   sai_object_id_t tx_port;
   sai_hostif_tx_type_t tx_type;
   for (int i = 0; i < attr_count; ++i) {
@@ -45,6 +46,7 @@ sai_status_t create_hostif_trap_fn(
     sai_object_id_t /* switch_id */,
     uint32_t attr_count,
     const sai_attribute_t* attr_list) {
+  facebook::fboss::FakeSaiCall call(SAI_API_HOSTIF);
   auto fs = FakeSai::getInstance();
   sai_hostif_trap_type_t trapType;
   sai_packet_action_t packetAction;
@@ -69,6 +71,7 @@ sai_status_t create_hostif_trap_fn(
 }
 
 sai_status_t remove_hostif_trap_fn(sai_object_id_t hostif_trap_id) {
+  facebook::fboss::FakeSaiCall call(SAI_API_HOSTIF);
   auto fs = FakeSai::getInstance();
   fs->htm.remove(hostif_trap_id);
   return SAI_STATUS_SUCCESS;
@@ -77,6 +80,7 @@ sai_status_t remove_hostif_trap_fn(sai_object_id_t hostif_trap_id) {
 sai_status_t set_hostif_trap_attribute_fn(
     sai_object_id_t /* hostif_trap_id */,
     const sai_attribute_t* attr) {
+  facebook::fboss::FakeSaiCall call(SAI_API_HOSTIF);
   switch (attr->id) {
     default:
       return SAI_STATUS_INVALID_PARAMETER;
@@ -88,6 +92,7 @@ sai_status_t get_hostif_trap_attribute_fn(
     sai_object_id_t hostif_trap_id,
     uint32_t attr_count,
     sai_attribute_t* attr) {
+  facebook::fboss::FakeSaiCall call(SAI_API_HOSTIF);
   auto fs = FakeSai::getInstance();
   const auto& hostifTrap = fs->htm.get(hostif_trap_id);
   for (int i = 0; i < attr_count; ++i) {
@@ -113,6 +118,7 @@ sai_status_t create_hostif_trap_group_fn(
     sai_object_id_t /* switch_id */,
     uint32_t attr_count,
     const sai_attribute_t* attr_list) {
+  facebook::fboss::FakeSaiCall call(SAI_API_HOSTIF);
   auto fs = FakeSai::getInstance();
   uint32_t queueId = 0;
   for (int i = 0; i < attr_count; ++i) {
@@ -129,6 +135,7 @@ sai_status_t create_hostif_trap_group_fn(
 }
 
 sai_status_t remove_hostif_trap_group_fn(sai_object_id_t hostif_trap_group_id) {
+  facebook::fboss::FakeSaiCall call(SAI_API_HOSTIF);
   auto fs = FakeSai::getInstance();
   fs->htgm.remove(hostif_trap_group_id);
   return SAI_STATUS_SUCCESS;
@@ -137,6 +144,7 @@ sai_status_t remove_hostif_trap_group_fn(sai_object_id_t hostif_trap_group_id) {
 sai_status_t set_hostif_trap_group_attribute_fn(
     sai_object_id_t /* hostif_trap_group_id */,
     const sai_attribute_t* attr) {
+  facebook::fboss::FakeSaiCall call(SAI_API_HOSTIF);
   switch (attr->id) {
     default:
       return SAI_STATUS_INVALID_PARAMETER;
@@ -148,6 +156,7 @@ sai_status_t get_hostif_trap_group_attribute_fn(
     sai_object_id_t hostif_trap_group_id,
     uint32_t attr_count,
     sai_attribute_t* attr) {
+  facebook::fboss::FakeSaiCall call(SAI_API_HOSTIF);
   auto fs = FakeSai::getInstance();
   const auto& hostifTrapGroup = fs->htgm.get(hostif_trap_group_id);
   for (int i = 0; i < attr_count; ++i) {
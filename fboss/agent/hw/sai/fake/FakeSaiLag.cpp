@@ -23,6 +23,7 @@ sai_status_t create_lag_fn(
     sai_object_id_t /* switch_id */,
     uint32_t attr_count,
     const sai_attribute_t* attr_list) {
+  facebook::fboss::FakeSaiCall call(SAI_API_LAG);
   auto fs = FakeSai::getInstance();
   *lag_id = fs->lm.create();
   for (int i = 0; i < attr_count; ++i) {
@@ -36,6 +37,7 @@ sai_status_t create_lag_fn(
 }
 
 sai_status_t remove_lag_fn(sai_object_id_t lag_id) {
+  facebook::fboss::FakeSaiCall call(SAI_API_LAG);
   auto fs = FakeSai::getInstance();
   fs->lm.remove(lag_id);
   return SAI_STATUS_SUCCESS;
@@ -45,6 +47,7 @@ sai_status_t get_lag_attribute_fn(
     sai_object_id_t lag_id,
     uint32_t attr_count,
     sai_attribute_t* attr) {
+  facebook::fboss::FakeSaiCall call(SAI_API_LAG);
   auto fs = FakeSai::getInstance();
   for (int i = 0; i < attr_count; ++i) {
     switch (attr[i].id) {
@@ -66,6 +69,7 @@ sai_status_t get_lag_attribute_fn(
 sai_status_t set_lag_attribute_fn(
     sai_object_id_t /* lag_id */,
     const sai_attribute_t* attr) {
+  facebook::fboss::FakeSaiCall call(SAI_API_LAG);
   switch (attr->id) {
     default:
       return SAI_STATUS_NOT_SUPPORTED;
@@ -78,6 +82,7 @@ sai_status_t create_lag_member_fn(
     sai_object_id_t /* switch_id */,
     uint32_t attr_count,
     const sai_attribute_t* attr_list) {
+  facebook::fboss::FakeSaiCall call(SAI_API_LAG);
   auto fs = FakeSai::getInstance();
   folly::Optional<sai_object_id_t> lagId;
   folly::Optional<sai_object_id_t> portId;
@@ -109,6 +114,7 @@ sai_status_t create_lag_member_fn(
 }
 
 sai_status_t remove_lag_member_fn(sai_object_id_t lag_member_id) {
+  facebook::fboss::FakeSaiCall call(SAI_API_LAG);
   auto fs = FakeSai::getInstance();
   fs->lm.removeMember(lag_member_id);
   return SAI_STATUS_SUCCESS;
@@ -118,6 +124,7 @@ sai_status_t get_lag_member_attribute_fn(
     sai_object_id_t lag_member_id,
     uint32_t attr_count,
     sai_attribute_t* attr) {
+  facebook::fboss::FakeSaiCall call(SAI_API_LAG);
   auto fs = FakeSai::getInstance();
   auto& lagMember = fs->lm.getMember(lag_member_id);
   for (int i = 0; i < attr_count; ++i) {
@@ -138,6 +145,7 @@ sai_status_t get_lag_member_attribute_fn(
 sai_status_t set_lag_member_attribute_fn(
     sai_object_id_t lag_member_id,
     const sai_attribute_t* attr) {
+  facebook::fboss::FakeSaiCall call(SAI_API_LAG);
   auto fs = FakeSai::getInstance();
   auto& lagMember = fs->lm.getMember(lag_member_id);
   sai_status_t res;
@@ -22,6 +22,7 @@ sai_status_t create_neighbor_entry_fn(
     const sai_neighbor_entry_t* neighbor_entry,
     uint32_t attr_count,
     const sai_attribute_t* attr_list) {
+  facebook::fboss::FakeSaiCall call(SAI_API_NEIGHBOR);
   auto fs = FakeSai::getInstance();
   auto ip = facebook::fboss::fromSaiIpAddress(neighbor_entry->ip_address);
   folly::Optional<folly::MacAddress> dstMac;
@@ -45,6 +46,7 @@ sai_status_t create_neighbor_entry_fn(
 
 sai_status_t remove_neighbor_entry_fn(
     const sai_neighbor_entry_t* neighbor_entry) {
+  facebook::fboss::FakeSaiCall call(SAI_API_NEIGHBOR);
   auto fs = FakeSai::getInstance();
   auto ip = facebook::fboss::fromSaiIpAddress(neighbor_entry->ip_address);
   fs->nm.remove(
@@ -55,6 +57,7 @@ sai_status_t remove_neighbor_entry_fn(
 sai_status_t set_neighbor_entry_attribute_fn(
     const sai_neighbor_entry_t* neighbor_entry,
     const sai_attribute_t* attr) {
+  facebook::fboss::FakeSaiCall call(SAI_API_NEIGHBOR);
   auto fs = FakeSai::getInstance();
   auto ip = facebook::fboss::fromSaiIpAddress(neighbor_entry->ip_address);
   auto n =
@@ -74,6 +77,7 @@ sai_status_t get_neighbor_entry_attribute_fn(
     const sai_neighbor_entry_t* neighbor_entry,
     uint32_t attr_count,
     sai_attribute_t* attr_list) {
+  facebook::fboss::FakeSaiCall call(SAI_API_NEIGHBOR);
   auto fs = FakeSai::getInstance();
   auto ip = facebook::fboss::fromSaiIpAddress(neighbor_entry->ip_address);
   auto n =
@@ -22,6 +22,7 @@ sai_status_t create_next_hop_fn(
     sai_object_id_t /* switch_id */,
     uint32_t attr_count,
     const sai_attribute_t* attr_list) {
+  facebook::fboss::FakeSaiCall call(SAI_API_NEXT_HOP);
   auto fs = FakeSai::getInstance();
   folly::Optional<sai_next_hop_type_t> type;
   folly::Optional<folly::IPAddress> ip;
@@ -50,6 +51,7 @@ sai_status_t create_next_hop_fn(
 }
 
 sai_status_t remove_next_hop_fn(sai_object_id_t next_hop_id) {
+  facebook::fboss::FakeSaiCall call(SAI_API_NEXT_HOP);
   auto fs = FakeSai::getInstance();
   fs->nhm.remove(next_hop_id);
   return SAI_STATUS_SUCCESS;
@@ -58,6 +60,7 @@ sai_status_t remove_next_hop_fn(sai_object_id_t next_hop_id) {
 sai_status_t set_next_hop_attribute_fn(
     sai_object_id_t /* next_hop_id */,
     const sai_attribute_t* attr) {
+  facebook::fboss::FakeSaiCall call(SAI_API_NEXT_HOP);
   switch (attr->id) {
     default:
       return SAI_STATUS_INVALID_PARAMETER;
@@ -69,6 +72,7 @@ sai_status_t get_next_hop_attribute_fn(
     sai_object_id_t next_hop_id,
     uint32_t attr_count,
     sai_attribute_t* attr) {
+  facebook::fboss::FakeSaiCall call(SAI_API_NEXT_HOP);
   auto fs = FakeSai::getInstance();
   const auto& nextHop = fs->nhm.get(next_hop_id);
   for (int i = 0; i < attr_count; ++i) {
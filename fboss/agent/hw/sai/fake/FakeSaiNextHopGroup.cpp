@@ -23,6 +23,7 @@ sai_status_t create_next_hop_group_fn(
     sai_object_id_t /* switch_id */,
     uint32_t attr_count,
     const sai_attribute_t* attr_list) {
+  facebook::fboss::FakeSaiCall call(SAI_API_NEXT_HOP_GROUP);
   auto fs = FakeSai::getInstance();
   folly::Optional<int32_t> type;
   for (int i = 0; i < attr_count; ++i) {
@@ -47,6 +48,7 @@ sai_status_t create_next_hop_group_fn(
 }
 
 sai_status_t remove_next_hop_group_fn(sai_object_id_t next_hop_group_id) {
+  facebook::fboss::FakeSaiCall call(SAI_API_NEXT_HOP_GROUP);
   auto fs = FakeSai::getInstance();
   fs->nhgm.remove(next_hop_group_id);
   return SAI_STATUS_SUCCESS;
@@ -56,6 +58,7 @@ sai_status_t get_next_hop_group_attribute_fn(
     sai_object_id_t next_hop_group_id,
     uint32_t attr_count,
     sai_attribute_t* attr) {
+  facebook::fboss::FakeSaiCall call(SAI_API_NEXT_HOP_GROUP);
   auto fs = FakeSai::getInstance();
   const auto& nextHopGroup = fs->nhgm.get(next_hop_group_id);
   for (int i = 0; i < attr_count; ++i) {
@@ -82,6 +85,7 @@ sai_status_t get_next_hop_group_attribute_fn(
 sai_status_t set_next_hop_group_attribute_fn(
     sai_object_id_t /* next_hop_group_id */,
     const sai_attribute_t* attr) {
+  facebook::fboss::FakeSaiCall call(SAI_API_NEXT_HOP_GROUP);
   switch (attr->id) {
     default:
       return SAI_STATUS_NOT_SUPPORTED;
@@ -94,6 +98,7 @@ sai_status_t create_next_hop_group_member_fn(
     sai_object_id_t /* switch_id */,
     uint32_t attr_count,
     const sai_attribute_t* attr_list) {
+  facebook::fboss::FakeSaiCall call(SAI_API_NEXT_HOP_GROUP);
   auto fs = FakeSai::getInstance();
   folly::Optional<sai_object_id_t> nextHopGroupId;
   folly::Optional<sai_object_id_t> nextHopId;
@@ -120,6 +125,7 @@ sai_status_t create_next_hop_group_member_fn(
 
 sai_status_t remove_next_hop_group_member_fn(
     sai_object_id_t next_hop_group_member_id) {
+  facebook::fboss::FakeSaiCall call(SAI_API_NEXT_HOP_GROUP);
   auto fs = FakeSai::getInstance();
   fs->nhgm.removeMember(next_hop_group_member_id);
   return SAI_STATUS_SUCCESS;
@@ -129,6 +135,7 @@ sai_status_t get_next_hop_group_member_attribute_fn(
     sai_object_id_t next_hop_group_member_id,
     uint32_t attr_count,
     sai_attribute_t* attr) {
+  facebook::fboss::FakeSaiCall call(SAI_API_NEXT_HOP_GROUP);
   auto fs = FakeSai::getInstance();
   auto& nextHopGroupMember = fs->nhgm.getMember(next_hop_group_member_id);
   for (int i = 0; i < attr_count; ++i) {
@@ -149,6 +156,7 @@ sai_status_t get_next_hop_group_member_attribute_fn(
 sai_status_t set_next_hop_group_member_attribute_fn(
     sai_object_id_t next_hop_group_member_id,
     const sai_attribute_t* attr) {
+  facebook::fboss::FakeSaiCall call(SAI_API_NEXT_HOP_GROUP);
   switch (attr->id) {
     default:
       return SAI_STATUS_NOT_SUPPORTED;
@@ -156,6 +164,52 @@ sai_status_t set_next_hop_group_member_attribute_fn(
   return SAI_STATUS_SUCCESS;
 }
 
+sai_status_t create_next_hop_group_members_fn(
+    sai_object_id_t switch_id,
+    uint32_t object_count,
+    const uint32_t* attr_count,
+    const sai_attribute_t** attr_list,
+    sai_bulk_op_error_mode_t mode,
+    sai_object_id_t* object_id,
+    sai_status_t* object_statuses) {
+  facebook::fboss::FakeSaiCall call(SAI_API_NEXT_HOP_GROUP);
+  sai_status_t ret = SAI_STATUS_SUCCESS;
+  for (uint32_t i = 0; i < object_count; ++i) {
+    if (ret != SAI_STATUS_SUCCESS &&
+        mode == SAI_BULK_OP_ERROR_MODE_STOP_ON_ERROR) {
+      object_statuses[i] = SAI_STATUS_NOT_EXECUTED;
+      continue;
+    }
+    object_statuses[i] = create_next_hop_group_member_fn(
+        &object_id[i], switch_id, attr_count[i], attr_list[i]);
+    if (object_statuses[i] != SAI_STATUS_SUCCESS) {
+      ret = SAI_STATUS_FAILURE;
+    }
+  }
+  return ret;
+}
+
+sai_status_t remove_next_hop_group_members_fn(
+    uint32_t object_count,
+    const sai_object_id_t* object_id,
+    sai_bulk_op_error_mode_t mode,
+    sai_status_t* object_statuses) {
+  facebook::fboss::FakeSaiCall call(SAI_API_NEXT_HOP_GROUP);
+  sai_status_t ret = SAI_STATUS_SUCCESS;
+  for (uint32_t i = 0; i < object_count; ++i) {
+    if (ret != SAI_STATUS_SUCCESS &&
+        mode == SAI_BULK_OP_ERROR_MODE_STOP_ON_ERROR) {
+      object_statuses[i] = SAI_STATUS_NOT_EXECUTED;
+      continue;
+    }
+    object_statuses[i] = remove_next_hop_group_member_fn(object_id[i]);
+    if (object_statuses[i] != SAI_STATUS_SUCCESS) {
+      ret = SAI_STATUS_FAILURE;
+    }
+  }
+  return ret;
+}
+
 namespace facebook {
 namespace fboss {
 
@@ -177,6 +231,10 @@ void populate_next_hop_group_api(
       &set_next_hop_group_member_attribute_fn;
   _next_hop_group_api.get_next_hop_group_member_attribute =
       &get_next_hop_group_member_attribute_fn;
+  _next_hop_group_api.create_next_hop_group_members =
+      &create_next_hop_group_members_fn;
+  _next_hop_group_api.remove_next_hop_group_members =
+      &remove_next_hop_group_members_fn;
   *next_hop_group_api = &_next_hop_group_api;
 }
 
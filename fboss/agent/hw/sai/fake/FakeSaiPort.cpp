@@ -21,6 +21,7 @@ sai_status_t create_port_fn(
     sai_object_id_t /* switch_id */,
     uint32_t attr_count,
     const sai_attribute_t* attr_list) {
+  facebook::fboss::FakeSaiCall call(SAI_API_PORT);
   auto fs = FakeSai::getInstance();
   folly::Optional<bool> adminState;
   std::vector<uint32_t> lanes;
@@ -54,6 +55,7 @@ sai_status_t create_port_fn(
 }
 
 sai_status_t remove_port_fn(sai_object_id_t port_id) {
+  facebook::fboss::FakeSaiCall call(SAI_API_PORT);
   auto fs = FakeSai::getInstance();
   fs->pm.remove(port_id);
   return SAI_STATUS_SUCCESS;
@@ -62,6 +64,7 @@ sai_status_t remove_port_fn(sai_object_id_t port_id) {
 sai_status_t set_port_attribute_fn(
     sai_object_id_t port_id,
     const sai_attribute_t* attr) {
+  facebook::fboss::FakeSaiCall call(SAI_API_PORT);
   auto fs = FakeSai::getInstance();
   auto& port = fs->pm.get(port_id);
   sai_status_t res;
@@ -97,6 +100,7 @@ sai_status_t get_port_attribute_fn(
     sai_object_id_t port_id,
     uint32_t attr_count,
     sai_attribute_t* attr) {
+  facebook::fboss::FakeSaiCall call(SAI_API_PORT);
   auto fs = FakeSai::getInstance();
   auto port = fs->pm.get(port_id);
   for (int i = 0; i < attr_count; ++i) {
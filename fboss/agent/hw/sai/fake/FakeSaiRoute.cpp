@@ -21,6 +21,7 @@ sai_status_t create_route_entry_fn(
     const sai_route_entry_t* route_entry,
     uint32_t attr_count,
     const sai_attribute_t* attr_list) {
+  facebook::fboss::FakeSaiCall call(SAI_API_ROUTE);
   auto fs = FakeSai::getInstance();
   auto re = std::make_tuple(
       route_entry->switch_id,
@@ -34,6 +35,7 @@ sai_status_t create_route_entry_fn(
 }
 
 sai_status_t remove_route_entry_fn(const sai_route_entry_t* route_entry) {
+  facebook::fboss::FakeSaiCall call(SAI_API_ROUTE);
   auto fs = FakeSai::getInstance();
   auto re = std::make_tuple(
       route_entry->switch_id,
@@ -48,6 +50,7 @@ sai_status_t remove_route_entry_fn(const sai_route_entry_t* route_entry) {
 sai_status_t set_route_entry_attribute_fn(
     const sai_route_entry_t* route_entry,
     const sai_attribute_t* attr) {
+  facebook::fboss::FakeSaiCall call(SAI_API_ROUTE);
   auto fs = FakeSai::getInstance();
   auto re = std::make_tuple(
       route_entry->switch_id,
@@ -58,16 +61,20 @@ sai_status_t set_route_entry_attribute_fn(
     case SAI_ROUTE_ENTRY_ATTR_NEXT_HOP_ID:
       fr.nextHopId = attr->value.oid;
       break;
+    case SAI_ROUTE_ENTRY_ATTR_PACKET_ACTION:
+      fr.packetAction = attr->value.s32;
+      break;
     default:
       return SAI_STATUS_INVALID_PARAMETER;
   }
-  return SAI_STATUS_FAILURE;
+  return SAI_STATUS_SUCCESS;
 }
 
 sai_status_t get_route_entry_attribute_fn(
     const sai_route_entry_t* route_entry,
     uint32_t attr_count,
     sai_attribute_t* attr_list) {
+  facebook::fboss::FakeSaiCall call(SAI_API_ROUTE);
   auto fs = FakeSai::getInstance();
   auto re = std::make_tuple(
       route_entry->switch_id,
@@ -79,6 +86,9 @@ sai_status_t get_route_entry_attribute_fn(
       case SAI_ROUTE_ENTRY_ATTR_NEXT_HOP_ID:
         attr_list[i].value.oid = fr.nextHopId;
         break;
+      case SAI_ROUTE_ENTRY_ATTR_PACKET_ACTION:
+        attr_list[i].value.s32 = fr.packetAction;
+        break;
       default:
         return SAI_STATUS_INVALID_PARAMETER;
     }
@@ -86,6 +96,70 @@ sai_status_t get_route_entry_attribute_fn(
   return SAI_STATUS_SUCCESS;
 }
 
+namespace {
+/*
+ * Run op on each of the object_count entries, the way a bulk api would.
+ * With SAI_BULK_OP_ERROR_MODE_STOP_ON_ERROR the entries after the first
+ * failure are not executed.
+ */
+template <typename OpT>
+sai_status_t bulkRouteOp(
+    uint32_t object_count,
+    sai_bulk_op_error_mode_t mode,
+    sai_status_t* object_statuses,
+    OpT op) {
+  sai_status_t ret = SAI_STATUS_SUCCESS;
+  for (uint32_t i = 0; i < object_count; ++i) {
+    if (ret != SAI_STATUS_SUCCESS &&
+        mode == SAI_BULK_OP_ERROR_MODE_STOP_ON_ERROR) {
+      object_statuses[i] = SAI_STATUS_NOT_EXECUTED;
+      continue;
+    }
+    object_statuses[i] = op(i);
+    if (object_statuses[i] != SAI_STATUS_SUCCESS) {
+      ret = SAI_STATUS_FAILURE;
+    }
+  }
+  return ret;
+}
+} // namespace
+
+sai_status_t create_route_entries_fn(
+    uint32_t object_count,
+    const sai_route_entry_t* route_entry,
+    const uint32_t* attr_count,
+    const sai_attribute_t** attr_list,
+    sai_bulk_op_error_mode_t mode,
+    sai_status_t* object_statuses) {
+  facebook::fboss::FakeSaiCall call(SAI_API_ROUTE);
+  return bulkRouteOp(object_count, mode, object_statuses, [&](uint32_t i) {
+    return create_route_entry_fn(&route_entry[i], attr_count[i], attr_list[i]);
+  });
+}
+
+sai_status_t remove_route_entries_fn(
+    uint32_t object_count,
+    const sai_route_entry_t* route_entry,
+    sai_bulk_op_error_mode_t mode,
+    sai_status_t* object_statuses) {
+  facebook::fboss::FakeSaiCall call(SAI_API_ROUTE);
+  return bulkRouteOp(object_count, mode, object_statuses, [&](uint32_t i) {
+    return remove_route_entry_fn(&route_entry[i]);
+  });
+}
+
+sai_status_t set_route_entries_attribute_fn(
+    uint32_t object_count,
+    const sai_route_entry_t* route_entry,
+    const sai_attribute_t* attr_list,
+    sai_bulk_op_error_mode_t mode,
+    sai_status_t* object_statuses) {
+  facebook::fboss::FakeSaiCall call(SAI_API_ROUTE);
+  return bulkRouteOp(object_count, mode, object_statuses, [&](uint32_t i) {
+    return set_route_entry_attribute_fn(&route_entry[i], &attr_list[i]);
+  });
+}
+
 namespace facebook {
 namespace fboss {
 
@@ -96,6 +170,9 @@ void populate_route_api(sai_route_api_t** route_api) {
   _route_api.remove_route_entry = &remove_route_entry_fn;
   _route_api.set_route_entry_attribute = &set_route_entry_attribute_fn;
   _route_api.get_route_entry_attribute = &get_route_entry_attribute_fn;
+  _route_api.create_route_entries = &create_route_entries_fn;
+  _route_api.remove_route_entries = &remove_route_entries_fn;
+  _route_api.set_route_entries_attribute = &set_route_entries_attribute_fn;
   *route_api = &_route_api;
 }
 
@@ -36,12 +36,34 @@ sai_status_t get_route_entry_attribute_fn(
     uint32_t attr_count,
     sai_attribute_t* attr_list);
 
+sai_status_t create_route_entries_fn(
+    uint32_t object_count,
+    const sai_route_entry_t* route_entry,
+    const uint32_t* attr_count,
+    const sai_attribute_t** attr_list,
+    sai_bulk_op_error_mode_t mode,
+    sai_status_t* object_statuses);
+
+sai_status_t remove_route_entries_fn(
+    uint32_t object_count,
+    const sai_route_entry_t* route_entry,
+    sai_bulk_op_error_mode_t mode,
+    sai_status_t* object_statuses);
+
+sai_status_t set_route_entries_attribute_fn(
+    uint32_t object_count,
+    const sai_route_entry_t* route_entry,
+    const sai_attribute_t* attr_list,
+    sai_bulk_op_error_mode_t mode,
+    sai_status_t* object_statuses);
+
 namespace facebook {
 namespace fboss {
 
 struct FakeRoute {
   FakeRoute() {}
-  sai_object_id_t nextHopId;
+  sai_object_id_t nextHopId{SAI_NULL_OBJECT_ID};
+  sai_int32_t packetAction{SAI_PACKET_ACTION_FORWARD};
 };
 
 using FakeRouteEntry =
@@ -22,6 +22,7 @@ sai_status_t create_router_interface_fn(
     sai_object_id_t /* switch_id */,
     uint32_t attr_count,
     const sai_attribute_t* attr_list) {
+  facebook::fboss::FakeSaiCall call(SAI_API_ROUTER_INTERFACE);
   auto fs = FakeSai::getInstance();
   folly::Optional<int32_t> type;
   folly::Optional<sai_object_id_t> vlanId;
@@ -61,6 +62,7 @@ sai_status_t create_router_interface_fn(
 }
 
 sai_status_t remove_router_interface_fn(sai_object_id_t router_interface_id) {
+  facebook::fboss::FakeSaiCall call(SAI_API_ROUTER_INTERFACE);
   auto fs = FakeSai::getInstance();
   fs->rim.remove(router_interface_id);
   return SAI_STATUS_SUCCESS;
@@ -69,6 +71,7 @@ sai_status_t remove_router_interface_fn(sai_object_id_t router_interface_id) {
 sai_status_t set_router_interface_attribute_fn(
     sai_object_id_t router_interface_id,
     const sai_attribute_t* attr) {
+  facebook::fboss::FakeSaiCall call(SAI_API_ROUTER_INTERFACE);
   auto fs = FakeSai::getInstance();
   auto& ri = fs->rim.get(router_interface_id);
   switch (attr->id) {
@@ -85,6 +88,7 @@ sai_status_t get_router_interface_attribute_fn(
     sai_object_id_t router_interface_id,
     uint32_t attr_count,
     sai_attribute_t* attr) {
+  facebook::fboss::FakeSaiCall call(SAI_API_ROUTER_INTERFACE);
   auto fs = FakeSai::getInstance();
   const auto& ri = fs->rim.get(router_interface_id);
   for (int i = 0; i < attr_count; ++i) {
@@ -24,6 +24,7 @@ sai_status_t create_switch_fn(
     sai_object_id_t* switch_id,
     uint32_t attr_count,
     const sai_attribute_t* attr_list) {
+  facebook::fboss::FakeSaiCall call(SAI_API_SWITCH);
   auto fs = FakeSai::getInstance();
   *switch_id = fs->swm.create();
   for (int i = 0; i < attr_count; ++i) {
@@ -33,6 +34,7 @@ sai_status_t create_switch_fn(
 }
 
 sai_status_t remove_switch_fn(sai_object_id_t switch_id) {
+  facebook::fboss::FakeSaiCall call(SAI_API_SWITCH);
   auto fs = FakeSai::getInstance();
   fs->swm.remove(switch_id);
   return SAI_STATUS_SUCCESS;
@@ -41,6 +43,7 @@ sai_status_t remove_switch_fn(sai_object_id_t switch_id) {
 sai_status_t set_switch_attribute_fn(
     sai_object_id_t switch_id,
     const sai_attribute_t* attr) {
+  facebook::fboss::FakeSaiCall call(SAI_API_SWITCH);
   auto fs = FakeSai::getInstance();
   auto& sw = fs->swm.get(switch_id);
   sai_status_t res;
@@ -56,6 +59,10 @@ sai_status_t set_switch_attribute_fn(
       sw.setInitStatus(attr->value.booldata);
       res = SAI_STATUS_SUCCESS;
       break;
+    case SAI_SWITCH_ATTR_RESTART_WARM:
+      sw.setRestartWarm(attr->value.booldata);
+      res = SAI_STATUS_SUCCESS;
+      break;
     case SAI_SWITCH_ATTR_PORT_NUMBER:
       // Number of active ports is read only
       res = SAI_STATUS_INVALID_PARAMETER;
@@ -71,6 +78,7 @@ sai_status_t get_switch_attribute_fn(
     sai_object_id_t switch_id,
     uint32_t attr_count,
     sai_attribute_t* attr) {
+  facebook::fboss::FakeSaiCall call(SAI_API_SWITCH);
   auto fs = FakeSai::getInstance();
   const auto& sw = fs->swm.get(switch_id);
   for (int i = 0; i < attr_count; ++i) {
@@ -100,6 +108,9 @@ sai_status_t get_switch_attribute_fn(
       case SAI_SWITCH_ATTR_INIT_SWITCH:
         attr[i].value.booldata = sw.isInitialized();
         break;
+      case SAI_SWITCH_ATTR_RESTART_WARM:
+        attr[i].value.booldata = sw.isRestartWarm();
+        break;
       default:
         return SAI_STATUS_INVALID_PARAMETER;
     }
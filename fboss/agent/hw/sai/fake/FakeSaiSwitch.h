@@ -51,11 +51,18 @@ class FakeSwitch {
   void setInitStatus(bool inited) {
     inited_ = inited;
   }
+  bool isRestartWarm() const {
+    return restartWarm_;
+  }
+  void setRestartWarm(bool restartWarm) {
+    restartWarm_ = restartWarm;
+  }
   sai_object_id_t id;
 
  private:
   folly::MacAddress srcMac_;
   bool inited_{false};
+  bool restartWarm_{false};
 };
 
 using FakeSwitchManager = FakeManager<sai_object_id_t, FakeSwitch>;
@@ -17,16 +17,19 @@ sai_status_t create_virtual_router_fn(
     sai_object_id_t /* switch_id */,
     uint32_t /* attr_count */,
     const sai_attribute_t* /* attr_list */) {
+  facebook::fboss::FakeSaiCall call(SAI_API_VIRTUAL_ROUTER);
   return SAI_STATUS_SUCCESS;
 }
 
 sai_status_t remove_virtual_router_fn(sai_object_id_t /* virtual_router_id */) {
+  facebook::fboss::FakeSaiCall call(SAI_API_VIRTUAL_ROUTER);
   return SAI_STATUS_FAILURE;
 }
 
 sai_status_t set_virtual_router_attribute_fn(
     sai_object_id_t /* virtual_router_id */,
     const sai_attribute_t* /* attr */) {
+  facebook::fboss::FakeSaiCall call(SAI_API_VIRTUAL_ROUTER);
   return SAI_STATUS_FAILURE;
 }
 
@@ -34,6 +37,7 @@ sai_status_t get_virtual_router_attribute_fn(
     sai_object_id_t /* virtual_router_id */,
     uint32_t /* attr_count */,
     sai_attribute_t* /* attr */) {
+  facebook::fboss::FakeSaiCall call(SAI_API_VIRTUAL_ROUTER);
   return SAI_STATUS_FAILURE;
 }
 
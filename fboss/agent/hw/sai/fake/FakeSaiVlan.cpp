@@ -23,6 +23,7 @@ sai_status_t create_vlan_fn(
     sai_object_id_t /* switch_id */,
     uint32_t attr_count,
     const sai_attribute_t* attr_list) {
+  facebook::fboss::FakeSaiCall call(SAI_API_VLAN);
   auto fs = FakeSai::getInstance();
   folly::Optional<uint16_t> vlanId;
   for (int i = 0; i < attr_count; ++i) {
@@ -43,6 +44,7 @@ sai_status_t create_vlan_fn(
 }
 
 sai_status_t remove_vlan_fn(sai_object_id_t vlan_id) {
+  facebook::fboss::FakeSaiCall call(SAI_API_VLAN);
   auto fs = FakeSai::getInstance();
   fs->vm.remove(vlan_id);
   return SAI_STATUS_SUCCESS;
@@ -52,6 +54,7 @@ sai_status_t get_vlan_attribute_fn(
     sai_object_id_t vlan_id,
     uint32_t attr_count,
     sai_attribute_t* attr) {
+  facebook::fboss::FakeSaiCall call(SAI_API_VLAN);
   auto fs = FakeSai::getInstance();
   const auto& vlan = fs->vm.get(vlan_id);
   for (int i = 0; i < attr_count; ++i) {
@@ -77,6 +80,7 @@ sai_status_t get_vlan_attribute_fn(
 sai_status_t set_vlan_attribute_fn(
     sai_object_id_t /* vlan_id */,
     const sai_attribute_t* attr) {
+  facebook::fboss::FakeSaiCall call(SAI_API_VLAN);
   switch (attr->id) {
     default:
       return SAI_STATUS_NOT_SUPPORTED;
@@ -89,6 +93,7 @@ sai_status_t create_vlan_member_fn(
     sai_object_id_t /* switch_id */,
     uint32_t attr_count,
     const sai_attribute_t* attr_list) {
+  facebook::fboss::FakeSaiCall call(SAI_API_VLAN);
   auto fs = FakeSai::getInstance();
   folly::Optional<sai_object_id_t> vlanId;
   for (int i = 0; i < attr_count; ++i) {
@@ -113,6 +118,7 @@ sai_status_t create_vlan_member_fn(
 }
 
 sai_status_t remove_vlan_member_fn(sai_object_id_t vlan_member_id) {
+  facebook::fboss::FakeSaiCall call(SAI_API_VLAN);
   auto fs = FakeSai::getInstance();
   fs->vm.removeMember(vlan_member_id);
   return SAI_STATUS_SUCCESS;
@@ -122,6 +128,7 @@ sai_status_t get_vlan_member_attribute_fn(
     sai_object_id_t vlan_member_id,
     uint32_t attr_count,
     sai_attribute_t* attr) {
+  facebook::fboss::FakeSaiCall call(SAI_API_VLAN);
   auto fs = FakeSai::getInstance();
   auto& vlanMember = fs->vm.getMember(vlan_member_id);
   for (int i = 0; i < attr_count; ++i) {
@@ -142,6 +149,7 @@ sai_status_t get_vlan_member_attribute_fn(
 sai_status_t set_vlan_member_attribute_fn(
     sai_object_id_t vlan_member_id,
     const sai_attribute_t* attr) {
+  facebook::fboss::FakeSaiCall call(SAI_API_VLAN);
   auto fs = FakeSai::getInstance();
   auto& vlanMember = fs->vm.getMember(vlan_member_id);
   sai_status_t res;
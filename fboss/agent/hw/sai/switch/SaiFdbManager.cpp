@@ -73,5 +73,43 @@ std::unique_ptr<SaiFdbEntry> SaiFdbManager::addFdbEntry(
   return std::make_unique<SaiFdbEntry>(apiTable_, entry, attributes);
 }
 
+void SaiFdbManager::processFdbEvents(const std::vector<SaiFdbEvent>& events) {
+  for (const auto& event : events) {
+    L2EntryKey key{event.bridgeId, event.mac};
+    switch (event.type) {
+      case SAI_FDB_EVENT_LEARNED:
+      case SAI_FDB_EVENT_MOVE: {
+        auto portId = managerTable_->portManager().getPortIDForBridgePort(
+            event.bridgePortId);
+        if (portId == PortID(0)) {
+          XLOG(DBG2) << "Ignoring FDB event for " << event.mac
+                     << " on unknown bridge port " << event.bridgePortId;
+          continue;
+        }
+        learnedL2Entries_[key] = portId;
+      } break;
+      case SAI_FDB_EVENT_AGED:
+      case SAI_FDB_EVENT_FLUSHED:
+        learnedL2Entries_.erase(key);
+        break;
+    }
+  }
+  XLOG(DBG3) << "Applied " << events.size() << " FDB events, "
+             << learnedL2Entries_.size() << " learned L2 entries";
+}
+
+std::vector<L2EntryThrift> SaiFdbManager::getL2Entries() const {
+  std::vector<L2EntryThrift> entries;
+  entries.reserve(learnedL2Entries_.size());
+  for (const auto& learned : learnedL2Entries_) {
+    L2EntryThrift entry;
+    entry.mac = learned.first.second.toString();
+    entry.port = learned.second;
+    entry.vlanID = learned.first.first;
+    entries.push_back(std::move(entry));
+  }
+  return entries;
+}
+
 } // namespace fboss
 } // namespace facebook
@@ -12,11 +12,17 @@
 
 #include "fboss/agent/hw/sai/api/FdbApi.h"
 #include "fboss/agent/hw/sai/api/SaiApiTable.h"
+#include "fboss/agent/if/gen-cpp2/ctrl_types.h"
 #include "fboss/agent/state/StateDelta.h"
 #include "fboss/agent/types.h"
 
+#include <folly/MacAddress.h>
+
+#include <map>
 #include <memory>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace facebook {
 namespace fboss {
@@ -48,6 +54,18 @@ class SaiFdbEntry {
   FdbApiParameters::Attributes attributes_;
 };
 
+/*
+ * A learn, age, move or flush of a dynamic FDB entry, as reported by the
+ * SAI FDB event notification.
+ */
+struct SaiFdbEvent {
+  sai_fdb_event_t type;
+  sai_object_id_t bridgeId;
+  folly::MacAddress mac;
+  // Not set for aged and flushed entries
+  sai_object_id_t bridgePortId{SAI_NULL_OBJECT_ID};
+};
+
 class SaiFdbManager {
  public:
   SaiFdbManager(
@@ -59,8 +77,18 @@ class SaiFdbManager {
       const folly::MacAddress& mac,
       const PortDescriptor& portDesc);
 
+  /*
+   * Apply a batch of FDB events to the table of dynamically learned L2
+   * entries. The batch must hold at most one event per (VLAN, MAC).
+   */
+  void processFdbEvents(const std::vector<SaiFdbEvent>& events);
+  std::vector<L2EntryThrift> getL2Entries() const;
+
  private:
   SaiFdbEntry* getFdbEntryImpl(const FdbApiParameters::EntryType& entry) const;
+  using L2EntryKey = std::pair<sai_object_id_t, folly::MacAddress>;
+  // Learned entries and the port they were learned on
+  std::map<L2EntryKey, PortID> learnedL2Entries_;
   SaiApiTable* apiTable_;
   SaiManagerTable* managerTable_;
   const SaiPlatform* platform_;
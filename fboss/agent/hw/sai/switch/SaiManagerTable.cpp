@@ -29,10 +29,11 @@ namespace fboss {
 
 SaiManagerTable::SaiManagerTable(
     SaiApiTable* apiTable,
-    const SaiPlatform* platform)
+    const SaiPlatform* platform,
+    bool warmBoot)
     : apiTable_(apiTable) {
-  switchManager_ =
-      std::make_unique<SaiSwitchManager>(apiTable_, this, platform);
+  switchManager_ = std::make_unique<SaiSwitchManager>(
+      apiTable_, this, platform, warmBoot);
   bridgeManager_ =
       std::make_unique<SaiBridgeManager>(apiTable_, this, platform);
   fdbManager_ = std::make_unique<SaiFdbManager>(apiTable_, this, platform);
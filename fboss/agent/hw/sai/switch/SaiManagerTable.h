@@ -31,7 +31,10 @@ class SaiVlanManager;
 
 class SaiManagerTable {
  public:
-  SaiManagerTable(SaiApiTable* apiTable, const SaiPlatform* platform);
+  SaiManagerTable(
+      SaiApiTable* apiTable,
+      const SaiPlatform* platform,
+      bool warmBoot = false);
   ~SaiManagerTable();
 
   SaiBridgeManager& bridgeManager();
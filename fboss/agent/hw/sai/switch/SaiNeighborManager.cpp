@@ -134,6 +134,12 @@ void SaiNeighborManager::removeNeighbor(
     const std::shared_ptr<NeighborEntryT>& swEntry) {
   XLOG(INFO) << "removeNeighbor " << swEntry->getIP();
   auto saiEntry = saiEntryFromSwEntry(swEntry);
+  auto itr = neighbors_.find(saiEntry);
+  if (itr != neighbors_.end()) {
+    // The next hop group members go away before the next hop they use
+    managerTable_->nextHopGroupManager().handleUnresolvedNeighbor(
+        saiEntry, itr->second->nextHopId());
+  }
   auto count = neighbors_.erase(saiEntry);
   if (count == 0) {
     count = unresolvedNeighbors_.erase(saiEntry);
@@ -145,6 +151,20 @@ void SaiNeighborManager::removeNeighbor(
 }
 
 void SaiNeighborManager::processNeighborDelta(const StateDelta& delta) {
+  // Neighbors resolved by the delta join their next hop groups together,
+  // one bulk member create per group
+  auto& nextHopGroupManager = managerTable_->nextHopGroupManager();
+  nextHopGroupManager.startMemberBatch();
+  try {
+    processNeighborDeltaImpl(delta);
+  } catch (const std::exception&) {
+    nextHopGroupManager.commitMemberBatch();
+    throw;
+  }
+  nextHopGroupManager.commitMemberBatch();
+}
+
+void SaiNeighborManager::processNeighborDeltaImpl(const StateDelta& delta) {
   for (const auto& vlanDelta : delta.getVlansDelta()) {
     auto processChanged =
         [this](const auto& oldNeighbor, const auto& newNeighbor) {
@@ -90,6 +90,7 @@ class SaiNeighborManager {
   void clear();
 
  private:
+  void processNeighborDeltaImpl(const StateDelta& delta);
   SaiNeighbor* getNeighborImpl(
       const NeighborApiParameters::EntryType& entry) const;
   SaiApiTable* apiTable_;
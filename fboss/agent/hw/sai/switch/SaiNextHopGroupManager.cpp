@@ -11,6 +11,7 @@
 #include "fboss/agent/hw/sai/switch/SaiNextHopGroupManager.h"
 
 #include "fboss/agent/FbossError.h"
+#include "fboss/agent/hw/sai/api/SaiApiError.h"
 #include "fboss/agent/hw/sai/switch/SaiManagerTable.h"
 #include "fboss/agent/hw/sai/switch/SaiNeighborManager.h"
 #include "fboss/agent/hw/sai/switch/SaiNextHopManager.h"
@@ -35,7 +36,17 @@ SaiNextHopGroupMember::SaiNextHopGroupMember(
 
 SaiNextHopGroupMember::~SaiNextHopGroupMember() {
   auto& nextHopGroupApi = apiTable_->nextHopGroupApi();
-  nextHopGroupApi.remove(id_);
+  nextHopGroupApi.removeMember(id_);
+}
+
+std::unique_ptr<SaiNextHopGroupMember> SaiNextHopGroupMember::adopt(
+    SaiApiTable* apiTable,
+    const NextHopGroupApiParameters::MemberAttributes& attributes,
+    sai_object_id_t memberId) {
+  std::unique_ptr<SaiNextHopGroupMember> member(
+      new SaiNextHopGroupMember(apiTable, attributes));
+  member->id_ = memberId;
+  return member;
 }
 
 bool SaiNextHopGroupMember::operator==(
@@ -86,17 +97,47 @@ bool SaiNextHopGroup::empty() const {
 }
 
 void SaiNextHopGroup::addMember(sai_object_id_t nextHopId) {
-  NextHopGroupApiParameters::MemberAttributes attributes{{id_, nextHopId}};
+  addMembers({nextHopId});
+}
+
+void SaiNextHopGroup::addMembers(
+    const std::vector<sai_object_id_t>& nextHopIds) {
+  using MemberAttributes = NextHopGroupApiParameters::MemberAttributes;
+  std::vector<MemberAttributes> attributes;
+  std::vector<MemberAttributes::CreateAttributes> createAttrs;
+  for (auto nextHopId : nextHopIds) {
+    if (members_.find(nextHopId) != members_.end()) {
+      continue;
+    }
+    createAttrs.push_back({id_, nextHopId});
+    attributes.emplace_back(createAttrs.back());
+  }
+  if (attributes.empty()) {
+    return;
+  }
   auto switchId = managerTable_->switchManager().getSwitchSaiId();
-  auto member =
-      std::make_unique<SaiNextHopGroupMember>(apiTable_, attributes, switchId);
-  sai_object_id_t memberId = member->id();
-  members_.emplace(std::make_pair(memberId, std::move(member)));
-  memberIdMap_.emplace(std::make_pair(memberId, id_));
+  std::vector<sai_object_id_t> memberIds;
+  auto statuses = apiTable_->nextHopGroupApi().bulkCreateMembers(
+      createAttrs, switchId, &memberIds);
+  // Take the members that were created before reporting any failure, so
+  // that they are still removed with the group
+  sai_status_t failure = SAI_STATUS_SUCCESS;
+  for (size_t i = 0; i < attributes.size(); ++i) {
+    if (statuses[i] != SAI_STATUS_SUCCESS) {
+      failure = statuses[i];
+      continue;
+    }
+    members_.emplace(
+        attributes[i].nextHopId,
+        SaiNextHopGroupMember::adopt(apiTable_, attributes[i], memberIds[i]));
+  }
+  saiApiCheckError(
+      failure,
+      NextHopGroupApiParameters::ApiType,
+      "Failed to create next hop group members");
 }
 
 void SaiNextHopGroup::removeMember(sai_object_id_t nextHopId) {
-  memberIdMap_.erase(nextHopId);
   members_.erase(nextHopId);
 }
 
@@ -116,29 +157,34 @@ SaiNextHopGroupManager::incRefOrAddNextHopGroup(
   if (!ins.second) {
     return nextHopGroup;
   }
+  std::vector<sai_object_id_t> resolvedNextHopIds;
   for (const auto& swNextHop : swNextHops) {
-    InterfaceID interfaceId = swNextHop.intf();
-    auto routerInterface =
-        managerTable_->routerInterfaceManager().getRouterInterface(interfaceId);
-    if (!routerInterface) {
-      throw FbossError("Missing SAI router interface for ", interfaceId);
-    }
-    folly::IPAddress ip = swNextHop.addr();
-    auto switchId = managerTable_->switchManager().getSwitchSaiId();
-    NeighborApiParameters::EntryType neighborEntry{
-        switchId, routerInterface->id(), ip};
+    auto neighborEntry = neighborEntryFor(swNextHop);
     nextHopsByNeighbor_[neighborEntry].insert(swNextHops);
     auto neighbor = managerTable_->neighborManager().getNeighbor(neighborEntry);
     if (!neighbor) {
-      XLOG(INFO) << "L2 Unresolved neighbor for " << ip;
+      XLOG(INFO) << "L2 Unresolved neighbor for " << swNextHop.addr();
       continue;
-    } else {
-      nextHopGroup->addMember(neighbor->nextHopId());
     }
+    resolvedNextHopIds.push_back(neighbor->nextHopId());
   }
+  nextHopGroup->addMembers(resolvedNextHopIds);
   return nextHopGroup;
 }
 
+NeighborApiParameters::EntryType SaiNextHopGroupManager::neighborEntryFor(
+    const NextHop& swNextHop) const {
+  InterfaceID interfaceId = swNextHop.intf();
+  auto routerInterface =
+      managerTable_->routerInterfaceManager().getRouterInterface(interfaceId);
+  if (!routerInterface) {
+    throw FbossError("Missing SAI router interface for ", interfaceId);
+  }
+  auto switchId = managerTable_->switchManager().getSwitchSaiId();
+  return NeighborApiParameters::EntryType{
+      switchId, routerInterface->id(), swNextHop.addr()};
+}
+
 void SaiNextHopGroupManager::unregisterNeighborResolutionHandling(
     const RouteNextHopEntry::NextHopSet& swNextHops) {
   for (const auto& swNextHop : swNextHops) {
@@ -155,6 +201,7 @@ void SaiNextHopGroupManager::unregisterNeighborResolutionHandling(
         switchId, routerInterface->id(), ip};
     nextHopsByNeighbor_[neighborEntry].erase(swNextHops);
   }
+  pendingMemberAdds_.erase(swNextHops);
 }
 
 void SaiNextHopGroupManager::handleResolvedNeighbor(
@@ -174,7 +221,11 @@ void SaiNextHopGroupManager::handleResolvedNeighbor(
           << "resolved neighbor " << neighborEntry.ip();
       continue;
     }
-    nextHopGroup->addMember(nextHopId);
+    if (memberBatchOpen_) {
+      pendingMemberAdds_[nextHopSet].insert(nextHopId);
+    } else {
+      nextHopGroup->addMember(nextHopId);
+    }
   }
 }
 
@@ -194,9 +245,31 @@ void SaiNextHopGroupManager::handleUnresolvedNeighbor(
           << "No next hop group using next hop set associated with newly "
           << "unresolved neighbor " << neighborEntry.ip();
     }
+    auto pending = pendingMemberAdds_.find(nextHopSet);
+    if (pending != pendingMemberAdds_.end()) {
+      pending->second.erase(nextHopId);
+    }
     nextHopGroup->removeMember(nextHopId);
   }
 }
 
+void SaiNextHopGroupManager::startMemberBatch() {
+  memberBatchOpen_ = true;
+}
+
+void SaiNextHopGroupManager::commitMemberBatch() {
+  memberBatchOpen_ = false;
+  auto pendingMemberAdds = std::move(pendingMemberAdds_);
+  pendingMemberAdds_.clear();
+  for (const auto& pending : pendingMemberAdds) {
+    SaiNextHopGroup* nextHopGroup = nextHopGroups_.get(pending.first);
+    if (!nextHopGroup || pending.second.empty()) {
+      continue;
+    }
+    nextHopGroup->addMembers(std::vector<sai_object_id_t>(
+        pending.second.begin(), pending.second.end()));
+  }
+}
+
 } // namespace fboss
 } // namespace facebook
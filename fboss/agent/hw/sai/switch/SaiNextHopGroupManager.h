@@ -17,8 +17,10 @@
 #include "fboss/agent/types.h"
 #include "fboss/lib/RefMap.h"
 
+#include <map>
 #include <memory>
 #include <unordered_map>
+#include <vector>
 
 #include <boost/container/flat_set.hpp>
 
@@ -49,7 +51,21 @@ class SaiNextHopGroupMember {
     return id_;
   }
 
+  /*
+   * Take ownership of a member that has already been created in SAI, e.g.,
+   * by bulkCreateMembers(). It is removed on destruction like any other.
+   */
+  static std::unique_ptr<SaiNextHopGroupMember> adopt(
+      SaiApiTable* apiTable,
+      const NextHopGroupApiParameters::MemberAttributes& attributes,
+      sai_object_id_t memberId);
+
  private:
+  SaiNextHopGroupMember(
+      SaiApiTable* apiTable,
+      const NextHopGroupApiParameters::MemberAttributes& attributes)
+      : apiTable_(apiTable), attributes_(attributes) {}
+
   SaiApiTable* apiTable_;
   NextHopGroupApiParameters::MemberAttributes attributes_;
   sai_object_id_t id_;
@@ -73,6 +89,8 @@ class SaiNextHopGroup {
   bool empty() const;
   std::size_t size() const;
   void addMember(sai_object_id_t nextHopId);
+  // Adds the next hops that are not members yet, in one bulk call
+  void addMembers(const std::vector<sai_object_id_t>& nextHopIds);
   void removeMember(sai_object_id_t nextHopId);
   const NextHopGroupApiParameters::Attributes attributes() const {
     return attributes_;
@@ -87,9 +105,9 @@ class SaiNextHopGroup {
   NextHopGroupApiParameters::Attributes attributes_;
   RouteNextHopEntry::NextHopSet swNextHops_;
   sai_object_id_t id_;
+  // Members by the id of their next hop
   std::unordered_map<sai_object_id_t, std::unique_ptr<SaiNextHopGroupMember>>
       members_;
-  std::unordered_map<sai_object_id_t, sai_object_id_t> memberIdMap_;
 };
 
 class SaiNextHopGroupManager {
@@ -110,7 +128,19 @@ class SaiNextHopGroupManager {
       const NeighborApiParameters::EntryType& neighborEntry,
       sai_object_id_t nextHopId);
 
+  /*
+   * While a batch is open, the members that resolved neighbors add are
+   * collected per group, and each group gets all of its new members in one
+   * bulk create on commitMemberBatch(), rather than one create per neighbor.
+   * Members of unresolved neighbors are still removed right away, as their
+   * next hop is about to go away.
+   */
+  void startMemberBatch();
+  void commitMemberBatch();
+
  private:
+  NeighborApiParameters::EntryType neighborEntryFor(
+      const NextHop& swNextHop) const;
   SaiApiTable* apiTable_;
   SaiManagerTable* managerTable_;
   const SaiPlatform* platform_;
@@ -119,6 +149,12 @@ class SaiNextHopGroupManager {
       NeighborApiParameters::NeighborEntry,
       boost::container::flat_set<RouteNextHopEntry::NextHopSet>>
       nextHopsByNeighbor_;
+  bool memberBatchOpen_{false};
+  // Next hops waiting to be added to each group in the open batch
+  std::map<
+      RouteNextHopEntry::NextHopSet,
+      boost::container::flat_set<sai_object_id_t>>
+      pendingMemberAdds_;
 };
 
 } // namespace fboss
@@ -39,6 +39,10 @@ sai_object_id_t SaiPortManager::addPort(const std::shared_ptr<Port>& swPort) {
   auto saiPort =
       std::make_unique<SaiPort>(apiTable_, managerTable_, attributes);
   sai_object_id_t saiId = saiPort->id();
+  if (saiPort->getBridgePort()) {
+    bridgePortSaiIds_.emplace(
+        std::make_pair(saiPort->getBridgePort()->id(), swPort->getID()));
+  }
   ports_.emplace(std::make_pair(swPort->getID(), std::move(saiPort)));
   portSaiIds_.emplace(std::make_pair(saiId, swPort->getID()));
   return saiId;
@@ -50,6 +54,9 @@ void SaiPortManager::removePort(PortID swId) {
     throw FbossError("Attempted to remove non-existent port: ", swId);
   }
   portSaiIds_.erase(itr->second->id());
+  if (itr->second->getBridgePort()) {
+    bridgePortSaiIds_.erase(itr->second->getBridgePort()->id());
+  }
   ports_.erase(itr);
 }
 
@@ -129,6 +136,15 @@ PortID SaiPortManager::getPortID(sai_object_id_t saiId) const {
   return itr->second;
 }
 
+PortID SaiPortManager::getPortIDForBridgePort(
+    sai_object_id_t bridgePortSaiId) const {
+  auto itr = bridgePortSaiIds_.find(bridgePortSaiId);
+  if (itr == bridgePortSaiIds_.end()) {
+    return PortID(0);
+  }
+  return itr->second;
+}
+
 SaiPort::SaiPort(
     SaiApiTable* apiTable,
     SaiManagerTable* managerTable,
@@ -79,6 +79,8 @@ class SaiPortManager {
   const SaiPort* getPort(PortID swId) const;
   SaiPort* getPort(PortID swId);
   PortID getPortID(sai_object_id_t saiId) const;
+  // PortID(0) if no port owns the bridge port
+  PortID getPortIDForBridgePort(sai_object_id_t bridgePortSaiId) const;
 
  private:
   SaiPort* getPortImpl(PortID swId) const;
@@ -87,6 +89,7 @@ class SaiPortManager {
   const SaiPlatform* platform_;
   std::unordered_map<PortID, std::unique_ptr<SaiPort>> ports_;
   std::unordered_map<sai_object_id_t, PortID> portSaiIds_;
+  std::unordered_map<sai_object_id_t, PortID> bridgePortSaiIds_;
 };
 
 } // namespace fboss
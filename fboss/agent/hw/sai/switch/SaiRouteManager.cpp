@@ -15,6 +15,8 @@
 #include "fboss/agent/hw/sai/switch/SaiSwitchManager.h"
 #include "fboss/agent/hw/sai/switch/SaiVirtualRouterManager.h"
 
+#include <folly/String.h>
+
 namespace facebook {
 namespace fboss {
 
@@ -33,8 +35,23 @@ SaiRoute::SaiRoute(
   routeApi.create(entry_, attributes.attrs());
 }
 
+SaiRoute::SaiRoute(
+    SaiApiTable* apiTable,
+    SaiManagerTable* managerTable,
+    const RouteApiParameters::EntryType& entry,
+    const RouteApiParameters::Attributes& attributes,
+    std::shared_ptr<SaiNextHopGroup> nextHopGroup,
+    AlreadyCreated)
+    : apiTable_(apiTable),
+      managerTable_(managerTable),
+      entry_(entry),
+      attributes_(attributes),
+      nextHopGroup_(nextHopGroup) {}
+
 SaiRoute::~SaiRoute() {
-  apiTable_->routeApi().remove(entry_);
+  if (created_) {
+    apiTable_->routeApi().remove(entry_);
+  }
 }
 
 bool SaiRoute::operator==(const SaiRoute& other) const {
@@ -128,7 +145,7 @@ std::vector<std::unique_ptr<SaiRoute>> SaiRouteManager::makeInterfaceToMeRoutes(
 }
 
 template <typename AddrT>
-void SaiRouteManager::addRoute(
+SaiRouteManager::PendingRoute SaiRouteManager::makePendingRoute(
     RouterID routerId,
     const std::shared_ptr<Route<AddrT>>& swRoute) {
   RouteApiParameters::EntryType entry =
@@ -188,9 +205,21 @@ void SaiRouteManager::addRoute(
   }
 
   RouteApiParameters::Attributes attributes{{packetAction, nextHopIdOpt}};
+  return PendingRoute{entry, attributes, nextHopGroup};
+}
+
+template <typename AddrT>
+void SaiRouteManager::addRoute(
+    RouterID routerId,
+    const std::shared_ptr<Route<AddrT>>& swRoute) {
+  auto pending = makePendingRoute(routerId, swRoute);
   auto route = std::make_unique<SaiRoute>(
-      apiTable_, managerTable_, entry, attributes, nextHopGroup);
-  routes_.emplace(std::make_pair(entry, std::move(route)));
+      apiTable_,
+      managerTable_,
+      pending.entry,
+      pending.attributes,
+      pending.nextHopGroup);
+  routes_.emplace(std::make_pair(pending.entry, std::move(route)));
 }
 
 template <typename AddrT>
@@ -207,6 +236,8 @@ void SaiRouteManager::removeRoute(
 }
 
 void SaiRouteManager::processRouteDelta(const StateDelta& delta) {
+  std::vector<RouteApiParameters::EntryType> toRemove;
+  std::vector<PendingRoute> toAdd;
   for (const auto& routeDelta : delta.getRouteTablesDelta()) {
     RouterID routerId;
     if (routeDelta.getOld()) {
@@ -218,11 +249,17 @@ void SaiRouteManager::processRouteDelta(const StateDelta& delta) {
                               const auto& oldRoute, const auto& newRoute) {
       changeRoute(routerId, oldRoute, newRoute);
     };
-    auto processAdded = [this, routerId](const auto& newRoute) {
-      addRoute(routerId, newRoute);
+    auto processAdded = [this, routerId, &toAdd](const auto& newRoute) {
+      toAdd.push_back(makePendingRoute(routerId, newRoute));
     };
-    auto processRemoved = [this, routerId](const auto& oldRoute) {
-      removeRoute(routerId, oldRoute);
+    auto processRemoved = [this, routerId, &toRemove](const auto& oldRoute) {
+      auto entry = routeEntryFromSwRoute(routerId, oldRoute);
+      if (routes_.find(entry) == routes_.end()) {
+        throw FbossError(
+            "Failed to remove non-existent route to ",
+            oldRoute->prefix().str());
+      }
+      toRemove.push_back(entry);
     };
     DeltaFunctions::forEachChanged(
         routeDelta.getRoutesV4Delta(),
@@ -235,6 +272,75 @@ void SaiRouteManager::processRouteDelta(const StateDelta& delta) {
         processAdded,
         processRemoved);
   }
+  programRoutes(toRemove, std::move(toAdd));
+}
+
+void SaiRouteManager::programRoutes(
+    const std::vector<RouteApiParameters::EntryType>& toRemove,
+    std::vector<PendingRoute> toAdd) {
+  auto& routeApi = apiTable_->routeApi();
+  sai_status_t firstFailure = SAI_STATUS_SUCCESS;
+  std::vector<std::string> failedPrefixes;
+  auto recordFailure = [&](const RouteApiParameters::EntryType& entry,
+                           sai_status_t status) {
+    if (failedPrefixes.empty()) {
+      firstFailure = status;
+    }
+    failedPrefixes.push_back(
+        folly::IPAddress::networkToString(entry.destination()));
+  };
+
+  // Removes go first, freeing hardware resources for the adds. Routes that
+  // fail to be removed stay in routes_.
+  if (!toRemove.empty()) {
+    auto statuses = routeApi.bulkRemove(toRemove);
+    for (size_t i = 0; i < toRemove.size(); ++i) {
+      if (statuses[i] != SAI_STATUS_SUCCESS) {
+        recordFailure(toRemove[i], statuses[i]);
+        continue;
+      }
+      auto itr = routes_.find(toRemove[i]);
+      itr->second->markRemoved();
+      routes_.erase(itr);
+    }
+  }
+
+  if (!toAdd.empty()) {
+    std::vector<RouteApiParameters::EntryType> entries;
+    std::vector<RouteApiParameters::Attributes::CreateAttributes> attrs;
+    entries.reserve(toAdd.size());
+    attrs.reserve(toAdd.size());
+    for (const auto& pending : toAdd) {
+      entries.push_back(pending.entry);
+      attrs.push_back(pending.attributes.attrs());
+    }
+    auto statuses = routeApi.bulkCreate(entries, attrs);
+    for (size_t i = 0; i < toAdd.size(); ++i) {
+      if (statuses[i] != SAI_STATUS_SUCCESS) {
+        // Dropping the pending route releases its next hop group reference
+        recordFailure(toAdd[i].entry, statuses[i]);
+        continue;
+      }
+      auto route = std::make_unique<SaiRoute>(
+          apiTable_,
+          managerTable_,
+          toAdd[i].entry,
+          toAdd[i].attributes,
+          std::move(toAdd[i].nextHopGroup),
+          SaiRoute::AlreadyCreated{});
+      routes_.emplace(std::make_pair(toAdd[i].entry, std::move(route)));
+    }
+  }
+
+  if (!failedPrefixes.empty()) {
+    throw SaiApiError(
+        firstFailure,
+        SAI_API_ROUTE,
+        "Failed to program ",
+        failedPrefixes.size(),
+        " routes: ",
+        folly::join(", ", failedPrefixes));
+  }
 }
 
 SaiRoute* SaiRouteManager::getRoute(
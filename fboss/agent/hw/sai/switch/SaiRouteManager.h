@@ -18,6 +18,7 @@
 
 #include <memory>
 #include <unordered_map>
+#include <vector>
 
 namespace facebook {
 namespace fboss {
@@ -28,12 +29,23 @@ class SaiPlatform;
 
 class SaiRoute {
  public:
+  // Tag for constructing a SaiRoute for an entry that was already created,
+  // e.g., by a bulk create
+  struct AlreadyCreated {};
+
   SaiRoute(
       SaiApiTable* apiTable,
       SaiManagerTable* managerTable,
       const RouteApiParameters::EntryType& entry,
       const RouteApiParameters::Attributes& attributes,
       std::shared_ptr<SaiNextHopGroup> nextHopGroup);
+  SaiRoute(
+      SaiApiTable* apiTable,
+      SaiManagerTable* managerTable,
+      const RouteApiParameters::EntryType& entry,
+      const RouteApiParameters::Attributes& attributes,
+      std::shared_ptr<SaiNextHopGroup> nextHopGroup,
+      AlreadyCreated);
   ~SaiRoute();
   SaiRoute(const SaiRoute& other) = delete;
   SaiRoute(SaiRoute&& other) = delete;
@@ -46,6 +58,11 @@ class SaiRoute {
   const RouteApiParameters::Attributes attributes() const {
     return attributes_;
   }
+  // The entry was removed from SAI by someone else (e.g., a bulk remove), so
+  // destroying this route must not remove it again
+  void markRemoved() {
+    created_ = false;
+  }
 
  private:
   SaiApiTable* apiTable_;
@@ -53,6 +70,7 @@ class SaiRoute {
   RouteApiParameters::EntryType entry_;
   RouteApiParameters::Attributes attributes_;
   std::shared_ptr<SaiNextHopGroup> nextHopGroup_;
+  bool created_{true};
 };
 
 class SaiRouteManager {
@@ -87,6 +105,12 @@ class SaiRouteManager {
       RouterID routerId,
       const std::shared_ptr<Route<AddrT>>& swRoute);
 
+  /*
+   * Program all the route additions and removals in delta with one bulk
+   * remove followed by one bulk create. Entries which fail are reported
+   * together in a single SaiApiError, after every other entry has been
+   * programmed.
+   */
   void processRouteDelta(const StateDelta& delta);
 
   SaiRoute* getRoute(const RouteApiParameters::EntryType& entry);
@@ -95,6 +119,22 @@ class SaiRouteManager {
   void clear();
 
  private:
+  // A route computed from the switch state, not yet created in SAI
+  struct PendingRoute {
+    RouteApiParameters::EntryType entry;
+    RouteApiParameters::Attributes attributes;
+    std::shared_ptr<SaiNextHopGroup> nextHopGroup;
+  };
+
+  template <typename AddrT>
+  PendingRoute makePendingRoute(
+      RouterID routerId,
+      const std::shared_ptr<Route<AddrT>>& swRoute);
+
+  void programRoutes(
+      const std::vector<RouteApiParameters::EntryType>& toRemove,
+      std::vector<PendingRoute> toAdd);
+
   SaiRoute* getRouteImpl(const RouteApiParameters::EntryType& entry) const;
 
   SaiApiTable* apiTable_;
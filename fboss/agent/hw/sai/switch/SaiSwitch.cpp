@@ -9,6 +9,11 @@
  */
 
 #include "fboss/agent/hw/sai/switch/SaiSwitch.h"
+#include "fboss/agent/Constants.h"
+#include "fboss/agent/RestartTimeTracker.h"
+#include "fboss/agent/SysError.h"
+#include "fboss/agent/Utils.h"
+#include "fboss/agent/hw/sai/api/AddressUtil.h"
 #include "fboss/agent/hw/sai/api/HostifApi.h"
 #include "fboss/agent/hw/sai/api/SaiApiTable.h"
 #include "fboss/agent/hw/sai/switch/SaiHostifManager.h"
@@ -27,13 +32,51 @@
 #include "fboss/agent/state/StateDelta.h"
 #include "fboss/agent/state/SwitchState.h"
 
+#include <folly/FileUtil.h>
+#include <folly/futures/Future.h>
+#include <folly/io/async/EventBase.h>
+#include <folly/json.h>
+#include <folly/logging/xlog.h>
+#include <gflags/gflags.h>
+
+#include <unistd.h>
+
+#include <exception>
+#include <functional>
 #include <iomanip>
 #include <memory>
 #include <sstream>
+#include <vector>
 
 extern "C" {
 #include <sai.h>
 }
+
+DEFINE_int32(
+    sai_fdb_event_batch_ms,
+    50,
+    "How long to collect FDB learn and age events for before applying them "
+    "to the L2 table in one batch");
+
+namespace {
+// Files in the platform's warm boot directory, as for BcmWarmBootHelper
+constexpr auto kWarmBootFlag = "can_warm_boot_0";
+constexpr auto kForceColdBootFlag = "cold_boot_once_0";
+constexpr auto kWarmBootStateFile = "sai_switch_state";
+
+// Remove the given file, returning whether it existed
+bool removeFile(const std::string& filename) {
+  if (unlink(filename.c_str()) == 0) {
+    return true;
+  }
+  if (errno == ENOENT) {
+    return false;
+  }
+  throw facebook::fboss::SysError(
+      errno, "error while trying to remove warm boot file ", filename);
+}
+} // namespace
+
 namespace facebook {
 namespace fboss {
 
@@ -60,6 +103,12 @@ void __gPacketRxCallback(
       switch_id, buffer_size, buffer, attr_count, attr_list);
 }
 
+void __gFdbEventCallback(
+    uint32_t count,
+    const sai_fdb_event_notification_data_t* data) {
+  __gSaiSwitch->fdbEventCallback(count, data);
+}
+
 HwInitResult SaiSwitch::init(Callback* callback) noexcept {
   std::lock_guard<std::mutex> lock(saiSwitchMutex_);
   return initLocked(lock, callback);
@@ -187,6 +236,52 @@ void SaiSwitch::packetRxCallback(
       lock, switch_id, buffer_size, buffer, attr_count, attr_list);
 }
 
+void SaiSwitch::fdbEventCallback(
+    uint32_t count,
+    const sai_fdb_event_notification_data_t* data) {
+  bool scheduleBatch = false;
+  {
+    auto pending = pendingFdbEvents_.wlock();
+    scheduleBatch = pending->empty();
+    for (uint32_t i = 0; i < count; ++i) {
+      SaiFdbEvent event;
+      event.type = data[i].event_type;
+      event.bridgeId = data[i].fdb_entry.bv_id;
+      event.mac = fromSaiMacAddress(data[i].fdb_entry.mac_address);
+      for (uint32_t j = 0; j < data[i].attr_count; ++j) {
+        if (data[i].attr[j].id == SAI_FDB_ENTRY_ATTR_BRIDGE_PORT_ID) {
+          event.bridgePortId = data[i].attr[j].value.oid;
+        }
+      }
+      // Only the last event for an entry matters, e.g. a learn followed by
+      // an age within the same batch leaves nothing to learn
+      (*pending)[std::make_pair(event.bridgeId, event.mac)] = event;
+    }
+    scheduleBatch = scheduleBatch && !pending->empty();
+  }
+  if (scheduleBatch) {
+    auto evb = fdbEventThread_->getEventBase();
+    evb->runInEventBaseThread([this, evb] {
+      evb->runAfterDelay(
+          [this] { processFdbEventBatch(); }, FLAGS_sai_fdb_event_batch_ms);
+    });
+  }
+}
+
+void SaiSwitch::processFdbEventBatch() {
+  std::vector<SaiFdbEvent> events;
+  {
+    auto pending = pendingFdbEvents_.wlock();
+    events.reserve(pending->size());
+    for (const auto& entry : *pending) {
+      events.push_back(entry.second);
+    }
+    pending->clear();
+  }
+  std::lock_guard<std::mutex> lock(saiSwitchMutex_);
+  managerTableLocked(lock)->fdbManager().processFdbEvents(events);
+}
+
 BootType SaiSwitch::getBootType() const {
   std::lock_guard<std::mutex> lock(saiSwitchMutex_);
   return getBootTypeLocked(lock);
@@ -218,21 +313,71 @@ HwInitResult SaiSwitch::initLocked(
     const std::lock_guard<std::mutex>& lock,
     Callback* callback) noexcept {
   HwInitResult ret;
-  ret.bootType = BootType::COLD_BOOT;
-  bootType_ = BootType::COLD_BOOT;
+  auto warmBootState = loadWarmBootStateLocked(lock);
+  bootType_ = warmBootState.isNull() ? BootType::COLD_BOOT : BootType::WARM_BOOT;
+  ret.bootType = bootType_;
 
   saiApiTable_ = std::make_unique<SaiApiTable>();
-  managerTable_ =
-      std::make_unique<SaiManagerTable>(apiTableLocked(lock), platform_);
+  if (bootType_ == BootType::WARM_BOOT) {
+    apiTableLocked(lock)->loadWarmBootState(warmBootState[kHwSwitch]);
+    restart_time::mark(RestartEvent::WARM_BOOT_CACHE_POPULATED);
+  }
+  managerTable_ = std::make_unique<SaiManagerTable>(
+      apiTableLocked(lock), platform_, bootType_ == BootType::WARM_BOOT);
   switchId_ = managerTable_->switchManager().getSwitchSaiId();
   callback_ = callback;
+  fdbEventThread_ =
+      std::make_unique<folly::ScopedEventBaseThread>("SaiFdbEvents");
+  if (platform_->supportsConcurrentSaiApiCalls()) {
+    concurrentDeltaThread_ =
+        std::make_unique<folly::ScopedEventBaseThread>("SaiDeltas");
+  }
 
   auto state = std::make_shared<SwitchState>();
   ret.switchState = state;
   __gSaiSwitch = this;
+  if (bootType_ == BootType::WARM_BOOT) {
+    // Reprogramming the state we had reclaims the objects the adapter kept;
+    // the ones it no longer needs go in clearWarmBootCache()
+    ret.switchState = stateChangedLocked(
+        lock,
+        StateDelta(
+            state,
+            SwitchState::fromFollyDynamic(warmBootState[kSwSwitch])));
+  }
   return ret;
 }
 
+folly::dynamic SaiSwitch::loadWarmBootStateLocked(
+    const std::lock_guard<std::mutex>& /* lock */) noexcept {
+  auto warmBootDir = platform_->getWarmBootDir();
+  if (warmBootDir.empty()) {
+    return nullptr;
+  }
+  try {
+    utilCreateDir(warmBootDir);
+    // Warm boot only if the last exit was graceful and nobody asked for a
+    // cold boot since
+    auto canWarmBoot = removeFile(warmBootDir + "/" + kWarmBootFlag);
+    auto forceColdBoot = removeFile(warmBootDir + "/" + kForceColdBootFlag);
+    if (!canWarmBoot || forceColdBoot) {
+      return nullptr;
+    }
+    restart_time::mark(RestartEvent::WARM_BOOT_STATE_LOADING);
+    std::string contents;
+    auto stateFile = warmBootDir + "/" + kWarmBootStateFile;
+    if (!folly::readFile(stateFile.c_str(), contents)) {
+      throw SysError(errno, "Unable to read switch state from ", stateFile);
+    }
+    auto warmBootState = folly::parseJson(contents);
+    restart_time::mark(RestartEvent::WARM_BOOT_STATE_LOADED);
+    return warmBootState;
+  } catch (const std::exception& ex) {
+    XLOG(ERR) << "Unable to load warm boot state, cold booting: " << ex.what();
+    return nullptr;
+  }
+}
+
 void SaiSwitch::packetRxCallbackLocked(
     const std::lock_guard<std::mutex>& lock,
     sai_object_id_t switch_id,
@@ -270,13 +415,48 @@ void SaiSwitch::unregisterCallbacksLocked(
 std::shared_ptr<SwitchState> SaiSwitch::stateChangedLocked(
     const std::lock_guard<std::mutex>& lock,
     const StateDelta& delta) {
-  managerTableLocked(lock)->vlanManager().processVlanDelta(
-      delta.getVlansDelta());
-  managerTableLocked(lock)->routerInterfaceManager().processInterfaceDelta(
-      delta);
-  managerTableLocked(lock)->neighborManager().processNeighborDelta(delta);
-  managerTableLocked(lock)->routeManager().processRouteDelta(delta);
-  managerTableLocked(lock)->hostifManager().processHostifDelta(delta);
+  auto managerTable = managerTableLocked(lock);
+  // Each lane is programmed in order, as its objects reference the ones
+  // programmed before them. Different lanes share no objects.
+  std::vector<std::function<void()>> lanes{
+      [managerTable, &delta] {
+        // A router interface is on a vlan, a neighbor on a router interface
+        // and routes resolve to neighbors
+        managerTable->vlanManager().processVlanDelta(delta.getVlansDelta());
+        managerTable->routerInterfaceManager().processInterfaceDelta(delta);
+        managerTable->neighborManager().processNeighborDelta(delta);
+        managerTable->routeManager().processRouteDelta(delta);
+      },
+      [managerTable, &delta] {
+        managerTable->hostifManager().processHostifDelta(delta);
+      },
+  };
+  if (!concurrentDeltaThread_) {
+    for (const auto& lane : lanes) {
+      lane();
+    }
+    return delta.newState();
+  }
+  std::vector<folly::Future<folly::Unit>> futs;
+  for (size_t i = 1; i < lanes.size(); ++i) {
+    const auto& lane = lanes[i];
+    futs.push_back(folly::via(
+        concurrentDeltaThread_->getEventBase(), [&lane] { lane(); }));
+  }
+  // The other lanes use the delta, so wait for them even if this one fails
+  std::exception_ptr error;
+  try {
+    lanes[0]();
+  } catch (const std::exception&) {
+    error = std::current_exception();
+  }
+  for (auto& result : folly::collectAll(futs.begin(), futs.end()).get()) {
+    // Rethrow any error, as programming the lanes in order would have
+    result.value();
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
   return delta.newState();
 }
 
@@ -346,23 +526,45 @@ void SaiSwitch::updateStatsLocked(
     SwitchStats* /* switchStats */) {}
 
 void SaiSwitch::fetchL2TableLocked(
-    const std::lock_guard<std::mutex>& /* lock */,
-    std::vector<L2EntryThrift>* /* l2Table */) {}
+    const std::lock_guard<std::mutex>& lock,
+    std::vector<L2EntryThrift>* l2Table) {
+  *l2Table = managerTableLocked(lock)->fdbManager().getL2Entries();
+}
 
 void SaiSwitch::gracefulExitLocked(
-    const std::lock_guard<std::mutex>& /* lock */,
-    folly::dynamic& /* switchState */) {}
+    const std::lock_guard<std::mutex>& lock,
+    folly::dynamic& switchState) {
+  auto warmBootDir = platform_->getWarmBootDir();
+  if (warmBootDir.empty()) {
+    return;
+  }
+  switchState[kHwSwitch] = toFollyDynamicLocked(lock);
+  if (!dumpStateToFile(warmBootDir + "/" + kWarmBootStateFile, switchState)) {
+    XLOG(ERR) << "Unable to write warm boot state, next boot will be cold";
+    return;
+  }
+  managerTableLocked(lock)->switchManager().gracefulExit();
+  // The adapter now owns everything we programmed; the managers must not
+  // remove any of it on the way out
+  managerTable_.release();
+  auto flag = warmBootDir + "/" + kWarmBootFlag;
+  if (!folly::writeFile(std::string(), flag.c_str())) {
+    XLOG(ERR) << "Unable to write " << flag << ", next boot will be cold";
+  }
+}
 
 folly::dynamic SaiSwitch::toFollyDynamicLocked(
-    const std::lock_guard<std::mutex>& /* lock */) const {
-  return folly::dynamic::object();
+    const std::lock_guard<std::mutex>& lock) const {
+  return apiTableLocked(lock)->warmBootState();
 }
 
 void SaiSwitch::initialConfigAppliedLocked(
     const std::lock_guard<std::mutex>& /* lock */) {}
 
 void SaiSwitch::clearWarmBootCacheLocked(
-    const std::lock_guard<std::mutex>& /* lock */) {}
+    const std::lock_guard<std::mutex>& lock) {
+  apiTableLocked(lock)->removeUnreclaimed();
+}
 
 void SaiSwitch::switchRunStateChangedLocked(
     const std::lock_guard<std::mutex>& lock,
@@ -371,6 +573,7 @@ void SaiSwitch::switchRunStateChangedLocked(
     case SwitchRunState::INITIALIZED: {
       auto& switchApi = apiTableLocked(lock)->switchApi();
       switchApi.registerRxCallback(switchId_, __gPacketRxCallback);
+      switchApi.registerFdbEventCallback(switchId_, __gFdbEventCallback);
     } break;
     default:
       break;
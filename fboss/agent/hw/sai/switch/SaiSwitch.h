@@ -11,11 +11,18 @@
 
 #include "fboss/agent/HwSwitch.h"
 #include "fboss/agent/hw/sai/api/SaiApiTable.h"
+#include "fboss/agent/hw/sai/switch/SaiFdbManager.h"
 #include "fboss/agent/hw/sai/switch/SaiManagerTable.h"
 #include "fboss/agent/hw/sai/switch/SaiRxPacket.h"
 
+#include <folly/MacAddress.h>
+#include <folly/Synchronized.h>
+#include <folly/io/async/ScopedEventBaseThread.h>
+
+#include <map>
 #include <memory>
 #include <mutex>
+#include <utility>
 
 namespace facebook {
 namespace fboss {
@@ -83,6 +90,16 @@ class SaiSwitch : public HwSwitch {
       uint32_t attr_count,
       const sai_attribute_t* attr_list);
 
+  /*
+   * Invoked immediately by the non-method SAI FDB event callback. Does not
+   * take saiSwitchMutex_: the events are only queued, coalesced per
+   * (VLAN, MAC), and applied to the L2 table in one batch by the FDB event
+   * thread once --sai_fdb_event_batch_ms have passed.
+   */
+  void fdbEventCallback(
+      uint32_t count,
+      const sai_fdb_event_notification_data_t* data);
+
   BootType getBootType() const override;
 
   const SaiManagerTable* managerTable() const;
@@ -116,6 +133,13 @@ class SaiSwitch : public HwSwitch {
   void unregisterCallbacksLocked(
       const std::lock_guard<std::mutex>& lock) noexcept;
 
+  /*
+   * The state written at the last graceful exit, {"swSwitch": ...,
+   * "hwSwitch": ...}, if we can warm boot from it; null otherwise.
+   */
+  folly::dynamic loadWarmBootStateLocked(
+      const std::lock_guard<std::mutex>& lock) noexcept;
+
   std::shared_ptr<SwitchState> stateChangedLocked(
       const std::lock_guard<std::mutex>& lock,
       const StateDelta& delta);
@@ -196,6 +220,9 @@ class SaiSwitch : public HwSwitch {
       uint32_t attr_count,
       const sai_attribute_t* attr_list);
 
+  // Runs on the FDB event thread
+  void processFdbEventBatch();
+
   BootType getBootTypeLocked(const std::lock_guard<std::mutex>& lock) const;
 
   const SaiManagerTable* managerTableLocked(
@@ -221,6 +248,15 @@ class SaiSwitch : public HwSwitch {
   mutable std::mutex saiSwitchMutex_;
 
   sai_object_id_t switchId_;
+
+  // The latest FDB event for each (VLAN, MAC) not yet applied
+  using FdbEventKey = std::pair<sai_object_id_t, folly::MacAddress>;
+  folly::Synchronized<std::map<FdbEventKey, SaiFdbEvent>> pendingFdbEvents_;
+  // Programs the control plane delta alongside the forwarding delta, if the
+  // platform supports concurrent SAI calls
+  std::unique_ptr<folly::ScopedEventBaseThread> concurrentDeltaThread_;
+  // Declared last so it is stopped before anything it uses is destroyed
+  std::unique_ptr<folly::ScopedEventBaseThread> fdbEventThread_;
 };
 
 } // namespace fboss
@@ -27,11 +27,16 @@ std::vector<int8_t> getConnectionHandle() {
 }
 
 SwitchApiParameters::Attributes getSwitchAttributes(
-    const SaiPlatform* platform) {
+    const SaiPlatform* platform,
+    bool warmBoot) {
   SwitchApiParameters::Attributes::InitSwitch initSwitch(true);
   SwitchApiParameters::Attributes::HwInfo hwInfo(getConnectionHandle());
   SwitchApiParameters::Attributes::SrcMac srcMac(platform->getLocalMac());
-  return {{initSwitch, hwInfo, srcMac}};
+  folly::Optional<SwitchApiParameters::Attributes::RestartWarm> restartWarm;
+  if (warmBoot) {
+    restartWarm = SwitchApiParameters::Attributes::RestartWarm(true);
+  }
+  return {{initSwitch, hwInfo, srcMac, restartWarm}};
 }
 } // namespace
 
@@ -61,10 +66,23 @@ bool SaiSwitchInstance::operator!=(const SaiSwitchInstance& other) const {
 SaiSwitchManager::SaiSwitchManager(
     SaiApiTable* apiTable,
     SaiManagerTable* managerTable,
-    const SaiPlatform* platform)
+    const SaiPlatform* platform,
+    bool warmBoot)
     : apiTable_(apiTable), managerTable_(managerTable), platform_(platform) {
   switch_ = std::make_unique<SaiSwitchInstance>(
-      apiTable_, getSwitchAttributes(platform));
+      apiTable_, getSwitchAttributes(platform, warmBoot));
+}
+
+void SaiSwitchManager::gracefulExit() {
+  auto& switchApi = apiTable_->switchApi();
+  SwitchApiParameters::Attributes::RestartWarm restartWarm{true};
+  auto status = switchApi.setAttribute(restartWarm, getSwitchSaiId());
+  if (status != SAI_STATUS_SUCCESS) {
+    throw FbossError("Failed to prepare switch for warm restart: ", status);
+  }
+  // With RestartWarm set, removing the switch makes the adapter save its
+  // state rather than tear down what was programmed
+  switch_.reset();
 }
 
 SaiSwitchInstance* SaiSwitchManager::getSwitchImpl() const {
@@ -56,10 +56,16 @@ class SaiSwitchManager {
   SaiSwitchManager(
       SaiApiTable* apiTable,
       SaiManagerTable* managerTable,
-      const SaiPlatform* platform);
+      const SaiPlatform* platform,
+      bool warmBoot = false);
   const SaiSwitchInstance* getSwitch() const;
   SaiSwitchInstance* getSwitch();
   sai_object_id_t getSwitchSaiId() const;
+  /*
+   * Hand what is programmed over to the adapter to be kept across a warm
+   * boot. The switch is removed, so nothing may use it afterwards.
+   */
+  void gracefulExit();
 
  private:
   SaiSwitchInstance* getSwitchImpl() const;
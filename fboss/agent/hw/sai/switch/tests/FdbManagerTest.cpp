@@ -57,3 +57,37 @@ TEST_F(FdbManagerTest, addFdbEntry) {
   checkFdbEntry(intfId, mac1, portDesc);
   fdbEntry.reset();
 }
+
+TEST_F(FdbManagerTest, processFdbEvents) {
+  folly::MacAddress mac1{"00:11:11:11:11:11"};
+  folly::MacAddress mac2{"00:22:22:22:22:22"};
+  auto vlanId = VlanID(intf0.id);
+  auto port0 = PortID(intf0.remoteHosts[0].port.id);
+  auto port1 = PortID(testInterfaces[2].remoteHosts[0].port.id);
+  auto bridgePort = [&](PortID portId) {
+    const auto& portManager = saiManagerTable->portManager();
+    return portManager.getPort(portId)->getBridgePort()->id();
+  };
+  auto& fdbManager = saiManagerTable->fdbManager();
+
+  fdbManager.processFdbEvents(
+      {{SAI_FDB_EVENT_LEARNED, vlanId, mac1, bridgePort(port0)},
+       {SAI_FDB_EVENT_LEARNED, vlanId, mac2, bridgePort(port0)}});
+  auto entries = fdbManager.getL2Entries();
+  ASSERT_EQ(2, entries.size());
+  EXPECT_EQ(mac1.toString(), entries[0].mac);
+  EXPECT_EQ(port0, entries[0].port);
+  EXPECT_EQ(vlanId, entries[0].vlanID);
+
+  fdbManager.processFdbEvents(
+      {{SAI_FDB_EVENT_MOVE, vlanId, mac1, bridgePort(port1)},
+       {SAI_FDB_EVENT_AGED, vlanId, mac2}});
+  entries = fdbManager.getL2Entries();
+  ASSERT_EQ(1, entries.size());
+  EXPECT_EQ(mac1.toString(), entries[0].mac);
+  EXPECT_EQ(port1, entries[0].port);
+
+  // Events for bridge ports we don't know about are dropped
+  fdbManager.processFdbEvents({{SAI_FDB_EVENT_LEARNED, vlanId, mac2, 12345}});
+  EXPECT_EQ(1, fdbManager.getL2Entries().size());
+}
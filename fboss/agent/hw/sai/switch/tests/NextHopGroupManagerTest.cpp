@@ -160,7 +160,38 @@ TEST_F(NextHopGroupManagerTest, resolveNeighborAfter) {
    */
 }
 
-TEST_F(NextHopGroupManagerTest, unresolveNeighbor) {}
+TEST_F(NextHopGroupManagerTest, resolveNeighborInBatch) {
+  ResolvedNextHop nh1{h0.ip, InterfaceID(intf0.id), ECMP_WEIGHT};
+  ResolvedNextHop nh2{h1.ip, InterfaceID(intf1.id), ECMP_WEIGHT};
+  RouteNextHopEntry::NextHopSet swNextHops{nh1, nh2};
+  auto& nextHopGroupManager = saiManagerTable->nextHopGroupManager();
+  auto saiNextHopGroup =
+      nextHopGroupManager.incRefOrAddNextHopGroup(swNextHops);
+  nextHopGroupManager.startMemberBatch();
+  auto arpEntry0 = makeArpEntry(intf0.id, h0);
+  saiManagerTable->neighborManager().addNeighbor(arpEntry0);
+  auto arpEntry1 = makeArpEntry(intf1.id, h1);
+  saiManagerTable->neighborManager().addNeighbor(arpEntry1);
+  checkNextHopGroup(saiNextHopGroup->id(), {});
+  nextHopGroupManager.commitMemberBatch();
+  checkNextHopGroup(saiNextHopGroup->id(), {h0.ip, h1.ip});
+}
+
+TEST_F(NextHopGroupManagerTest, unresolveNeighbor) {
+  auto arpEntry0 = makeArpEntry(intf0.id, h0);
+  saiManagerTable->neighborManager().addNeighbor(arpEntry0);
+  auto arpEntry1 = makeArpEntry(intf1.id, h1);
+  saiManagerTable->neighborManager().addNeighbor(arpEntry1);
+  ResolvedNextHop nh1{h0.ip, InterfaceID(intf0.id), ECMP_WEIGHT};
+  ResolvedNextHop nh2{h1.ip, InterfaceID(intf1.id), ECMP_WEIGHT};
+  RouteNextHopEntry::NextHopSet swNextHops{nh1, nh2};
+  auto saiNextHopGroup =
+      saiManagerTable->nextHopGroupManager().incRefOrAddNextHopGroup(
+          swNextHops);
+  checkNextHopGroup(saiNextHopGroup->id(), {h0.ip, h1.ip});
+  saiManagerTable->neighborManager().removeNeighbor(arpEntry0);
+  checkNextHopGroup(saiNextHopGroup->id(), {h1.ip});
+}
 
 TEST_F(NextHopGroupManagerTest, derefThenResolve) {}
 
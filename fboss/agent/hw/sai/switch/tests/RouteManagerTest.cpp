@@ -15,9 +15,29 @@
 #include "fboss/agent/hw/sai/switch/SaiSwitchManager.h"
 #include "fboss/agent/hw/sai/switch/tests/ManagerTestBase.h"
 #include "fboss/agent/state/Route.h"
+#include "fboss/agent/state/RouteTable.h"
+#include "fboss/agent/state/RouteTableRib.h"
+#include "fboss/agent/state/StateDelta.h"
+#include "fboss/agent/state/SwitchState.h"
 #include "fboss/agent/types.h"
 
 using namespace facebook::fboss;
+
+namespace {
+std::shared_ptr<SwitchState> makeRouteState(
+    const std::vector<std::shared_ptr<Route<folly::IPAddressV4>>>& routes) {
+  auto rib = std::make_shared<RouteTableRib<folly::IPAddressV4>>();
+  for (const auto& route : routes) {
+    rib->addRoute(route);
+  }
+  auto routeTable = std::make_shared<RouteTable>(RouterID(0));
+  routeTable->setRib(rib);
+  auto state = std::make_shared<SwitchState>();
+  state->addRouteTable(routeTable);
+  return state;
+}
+} // namespace
+
 class RouteManagerTest : public ManagerTestBase {
  public:
   void SetUp() override {
@@ -165,6 +185,34 @@ TEST_F(RouteManagerTest, removeNonexistentRoute) {
       saiManagerTable->routeManager().removeRoute(RouterID(0), r2), FbossError);
 }
 
+TEST_F(RouteManagerTest, processRouteDelta) {
+  auto r1 = makeRoute(tr1);
+  tr2.nextHopInterfaces = tr1.nextHopInterfaces;
+  auto r2 = makeRoute(tr2);
+  auto& routeManager = saiManagerTable->routeManager();
+  auto e1 = routeManager.routeEntryFromSwRoute(RouterID(0), r1);
+  auto e2 = routeManager.routeEntryFromSwRoute(RouterID(0), r2);
+
+  auto bothRoutes = makeRouteState({r1, r2});
+  routeManager.processRouteDelta(StateDelta(makeRouteState({}), bothRoutes));
+  EXPECT_TRUE(routeManager.getRoute(e1));
+  EXPECT_TRUE(routeManager.getRoute(e2));
+
+  routeManager.processRouteDelta(
+      StateDelta(bothRoutes, makeRouteState({r2})));
+  EXPECT_FALSE(routeManager.getRoute(e1));
+  EXPECT_TRUE(routeManager.getRoute(e2));
+}
+
+TEST_F(RouteManagerTest, processRouteDeltaRemoveNonexistentRoute) {
+  auto r1 = makeRoute(tr1);
+  auto& routeManager = saiManagerTable->routeManager();
+  EXPECT_THROW(
+      routeManager.processRouteDelta(
+          StateDelta(makeRouteState({r1}), makeRouteState({}))),
+      FbossError);
+}
+
 /*
  * Test for ToMe routes doesn't want to do all the setup, because
  * setting up the router interfaces will result in creating ToMeRoutes
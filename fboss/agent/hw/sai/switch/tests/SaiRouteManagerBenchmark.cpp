@@ -0,0 +1,156 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/hw/sai/fake/FakeSai.h"
+#include "fboss/agent/hw/sai/switch/SaiManagerTable.h"
+#include "fboss/agent/hw/sai/switch/SaiNeighborManager.h"
+#include "fboss/agent/hw/sai/switch/SaiRouteManager.h"
+#include "fboss/agent/hw/sai/switch/tests/ManagerTestBase.h"
+#include "fboss/agent/state/ArpEntry.h"
+#include "fboss/agent/state/RouteTable.h"
+#include "fboss/agent/state/RouteTableRib.h"
+#include "fboss/agent/state/StateDelta.h"
+#include "fboss/agent/state/SwitchState.h"
+
+#include <folly/Benchmark.h>
+#include <folly/init/Init.h>
+#include <gflags/gflags.h>
+
+#include <iostream>
+#include <memory>
+#include <vector>
+
+DEFINE_int32(
+    benchmark_routes,
+    500000,
+    "Number of routes to program in each benchmark iteration");
+DEFINE_int32(
+    benchmark_neighbor_flaps,
+    1000,
+    "Number of times to unresolve and resolve a next hop in neighborChurn");
+DEFINE_int64(
+    fake_sai_latency_ns,
+    0,
+    "Simulated latency the fake SAI adds to every call");
+
+using namespace facebook::fboss;
+
+namespace {
+
+/*
+ * The manager test setup, outside of gtest: ports, vlans, interfaces and
+ * resolved neighbors for every test interface.
+ */
+class ManagerBenchmarkSetup : public ManagerTestBase {
+ public:
+  ManagerBenchmarkSetup() {
+    setupStage = SetupStage::PORT | SetupStage::VLAN | SetupStage::INTERFACE |
+        SetupStage::NEIGHBOR;
+    SetUp();
+  }
+
+  // numRoutes /24s, each over the first four test interfaces
+  std::shared_ptr<SwitchState> makeRouteState(int numRoutes) const {
+    auto rib = std::make_shared<RouteTableRib<folly::IPAddressV4>>();
+    TestRoute testRoute;
+    for (int i = 0; i < 4; ++i) {
+      testRoute.nextHopInterfaces.push_back(testInterfaces.at(i));
+    }
+    // Start above 1.0.0.0 and stay clear of the test interface subnets
+    for (int i = 0; i < numRoutes; ++i) {
+      testRoute.destination = {
+          folly::IPAddressV4::fromLongHBO((1 << 24) + (i << 8)), 24};
+      rib->addRoute(makeRoute(testRoute));
+    }
+    auto routeTable = std::make_shared<RouteTable>(RouterID(0));
+    routeTable->setRib(rib);
+    auto state = std::make_shared<SwitchState>();
+    state->addRouteTable(routeTable);
+    return state;
+  }
+
+ private:
+  void TestBody() override {}
+};
+
+ManagerBenchmarkSetup& setup() {
+  static auto* setup = new ManagerBenchmarkSetup();
+  return *setup;
+}
+
+} // namespace
+
+// Reported per route, so iters/s is routes programmed per second
+BENCHMARK_MULTI(programRoutes) {
+  std::shared_ptr<SwitchState> empty;
+  std::shared_ptr<SwitchState> routes;
+  BENCHMARK_SUSPEND {
+    empty = std::make_shared<SwitchState>();
+    routes = setup().makeRouteState(FLAGS_benchmark_routes);
+  }
+  setup().saiManagerTable->routeManager().processRouteDelta(
+      StateDelta(empty, routes));
+  BENCHMARK_SUSPEND {
+    setup().saiManagerTable->routeManager().processRouteDelta(
+        StateDelta(routes, empty));
+  }
+  return FLAGS_benchmark_routes;
+}
+
+// Reported per flap of one next hop under all the routes
+BENCHMARK_MULTI(neighborChurn) {
+  std::shared_ptr<SwitchState> empty;
+  std::shared_ptr<SwitchState> routes;
+  std::shared_ptr<ArpEntry> neighbor;
+  BENCHMARK_SUSPEND {
+    empty = std::make_shared<SwitchState>();
+    routes = setup().makeRouteState(FLAGS_benchmark_routes);
+    setup().saiManagerTable->routeManager().processRouteDelta(
+        StateDelta(empty, routes));
+    const auto& testInterface = setup().testInterfaces.at(1);
+    neighbor =
+        setup().makeArpEntry(testInterface.id, testInterface.remoteHosts[0]);
+  }
+  auto& neighborManager = setup().saiManagerTable->neighborManager();
+  for (int i = 0; i < FLAGS_benchmark_neighbor_flaps; ++i) {
+    neighborManager.removeNeighbor(neighbor);
+    neighborManager.addNeighbor(neighbor);
+  }
+  BENCHMARK_SUSPEND {
+    setup().saiManagerTable->routeManager().processRouteDelta(
+        StateDelta(routes, empty));
+  }
+  return FLAGS_benchmark_neighbor_flaps;
+}
+
+int main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  auto fs = FakeSai::getInstance();
+  for (auto api : {SAI_API_FDB,
+                   SAI_API_NEIGHBOR,
+                   SAI_API_NEXT_HOP,
+                   SAI_API_NEXT_HOP_GROUP,
+                   SAI_API_ROUTE}) {
+    fs->callStats.setLatency(
+        api, std::chrono::nanoseconds(FLAGS_fake_sai_latency_ns));
+  }
+  // Only count the calls made by the benchmarks
+  setup();
+  fs->callStats.clear();
+  folly::runBenchmarks();
+
+  std::cout << "\nFake SAI calls (api: calls, p50/p99 latency in us)\n";
+  for (const auto& entry : fs->callStats.stats()) {
+    const auto& latencyUs = entry.second.latencyUs;
+    std::cout << entry.first << ": " << entry.second.calls << ", "
+              << latencyUs.getPercentileEstimate(0.5) << "/"
+              << latencyUs.getPercentileEstimate(0.99) << "\n";
+  }
+  return 0;
+}
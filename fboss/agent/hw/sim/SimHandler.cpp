@@ -19,5 +19,23 @@ using std::unique_ptr;
 
 namespace facebook { namespace fboss {
 
-SimHandler::SimHandler(SwSwitch* sw, SimSwitch* /*hw*/) : ThriftHandler(sw) {}
+SimHandler::SimHandler(SwSwitch* sw, SimSwitch* hw)
+    : ThriftHandler(sw), replayer_(hw), stateReplayer_(sw) {}
+
+void SimHandler::replayPcap(
+    PcapReplayStats& stats,
+    std::unique_ptr<std::string> path,
+    int32_t port,
+    int32_t vlan,
+    double pps) {
+  ensureConfigured();
+  stats = replayer_.replay(*path, PortID(port), VlanID(vlan), pps);
+}
+
+void SimHandler::replayStateJournal(
+    std::vector<StateUpdateReplayStats>& stats,
+    std::unique_ptr<std::string> path) {
+  ensureConfigured();
+  stats = stateReplayer_.replay(*path);
+}
 }} // facebook::fboss
@@ -11,6 +11,8 @@
 
 #include "fboss/agent/hw/sim/gen-cpp2/SimCtrl.h"
 #include "fboss/agent/ThriftHandler.h"
+#include "fboss/agent/hw/sim/SimPacketReplayer.h"
+#include "fboss/agent/hw/sim/SimStateReplayer.h"
 
 namespace facebook { namespace fboss {
 
@@ -22,10 +24,24 @@ class SimHandler : virtual public SimCtrlSvIf,
  public:
   SimHandler(SwSwitch* sw, SimSwitch* hw);
 
+  void replayPcap(
+      PcapReplayStats& stats,
+      std::unique_ptr<std::string> path,
+      int32_t port,
+      int32_t vlan,
+      double pps) override;
+
+  void replayStateJournal(
+      std::vector<StateUpdateReplayStats>& stats,
+      std::unique_ptr<std::string> path) override;
+
  private:
   // Forbidden copy constructor and assignment operator
   SimHandler(SimHandler const &) = delete;
   SimHandler& operator=(SimHandler const &) = delete;
+
+  SimPacketReplayer replayer_;
+  SimStateReplayer stateReplayer_;
 };
 
 }} // facebook::fboss
@@ -0,0 +1,101 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/hw/sim/SimPacketReplayer.h"
+
+#include "fboss/agent/capture/PcapFile.h"
+#include "fboss/agent/hw/mock/MockRxPacket.h"
+#include "fboss/agent/hw/sim/SimSwitch.h"
+
+#include <folly/Optional.h>
+#include <folly/logging/xlog.h>
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using std::chrono::duration_cast;
+using std::chrono::microseconds;
+using std::chrono::nanoseconds;
+using std::chrono::steady_clock;
+using std::chrono::system_clock;
+
+namespace facebook { namespace fboss {
+
+PcapReplayStats SimPacketReplayer::replay(
+    folly::StringPiece path,
+    PortID port,
+    VlanID vlan,
+    double pps) {
+  std::vector<std::unique_ptr<MockRxPacket>> pkts;
+  // Offset of each packet from the start of the replay
+  std::vector<nanoseconds> offsets;
+  auto file = PcapFile::openForReading(path);
+  file.readGlobalHeader();
+  system_clock::time_point timestamp;
+  std::unique_ptr<folly::IOBuf> buf;
+  folly::Optional<system_clock::time_point> firstTimestamp;
+  while (file.readPacket(&timestamp, &buf)) {
+    if (!firstTimestamp) {
+      firstTimestamp = timestamp;
+    }
+    if (pps > 0) {
+      offsets.push_back(duration_cast<nanoseconds>(
+          std::chrono::duration<double>(pkts.size() / pps)));
+    } else if (pps == 0) {
+      offsets.push_back(std::max(
+          nanoseconds(0),
+          duration_cast<nanoseconds>(timestamp - *firstTimestamp)));
+    }
+    pkts.push_back(std::make_unique<MockRxPacket>(std::move(buf)));
+    pkts.back()->setSrcPort(port);
+    pkts.back()->setSrcVlan(vlan);
+  }
+
+  std::vector<int64_t> latencies;
+  latencies.reserve(pkts.size());
+  auto start = steady_clock::now();
+  for (size_t i = 0; i < pkts.size(); ++i) {
+    if (!offsets.empty()) {
+      std::this_thread::sleep_until(start + offsets[i]);
+    }
+    auto injected = steady_clock::now();
+    hw_->injectPacket(std::move(pkts[i]));
+    latencies.push_back(
+        duration_cast<nanoseconds>(steady_clock::now() - injected).count());
+  }
+  auto duration = duration_cast<microseconds>(steady_clock::now() - start);
+
+  PcapReplayStats stats;
+  stats.packets = latencies.size();
+  stats.durationUs = duration.count();
+  stats.pktsPerSec = duration.count() > 0
+      ? latencies.size() * 1000000.0 / duration.count()
+      : 0;
+  std::sort(latencies.begin(), latencies.end());
+  auto percentile = [&](double pct) -> int64_t {
+    if (latencies.empty()) {
+      return 0;
+    }
+    auto idx = static_cast<size_t>(pct / 100 * (latencies.size() - 1));
+    return latencies[idx];
+  };
+  stats.latencyP50Ns = percentile(50);
+  stats.latencyP90Ns = percentile(90);
+  stats.latencyP99Ns = percentile(99);
+  stats.latencyMaxNs = percentile(100);
+  XLOG(INFO) << "Replayed " << stats.packets << " packets from " << path
+             << " in " << stats.durationUs << "us, " << stats.pktsPerSec
+             << " pps, p50 " << stats.latencyP50Ns << "ns, p99 "
+             << stats.latencyP99Ns << "ns";
+  return stats;
+}
+
+}} // facebook::fboss
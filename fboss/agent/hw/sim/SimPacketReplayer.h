@@ -0,0 +1,53 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include "fboss/agent/hw/sim/gen-cpp2/sim_ctrl_types.h"
+#include "fboss/agent/types.h"
+
+#include <folly/Range.h>
+
+namespace facebook { namespace fboss {
+
+class SimSwitch;
+
+/*
+ * Replays packets captured in a pcap file into the agent, through the sim
+ * switch's rx path, and measures how fast it handles them. This reproduces
+ * control plane storms seen in production offline, from the captures the
+ * agent itself takes.
+ *
+ * The whole file is read before the first packet is injected, so file I/O
+ * does not count towards the measured rate.
+ */
+class SimPacketReplayer {
+ public:
+  explicit SimPacketReplayer(SimSwitch* hw) : hw_(hw) {}
+
+  /*
+   * Inject the packets in path as received on port and vlan. pps above 0
+   * sends them at that rate, 0 keeps the gaps between their timestamps, and
+   * below 0 sends each as soon as the one before it is handled.
+   */
+  PcapReplayStats replay(
+      folly::StringPiece path,
+      PortID port,
+      VlanID vlan,
+      double pps);
+
+ private:
+  // Forbidden copy constructor and assignment operator
+  SimPacketReplayer(SimPacketReplayer const &) = delete;
+  SimPacketReplayer& operator=(SimPacketReplayer const &) = delete;
+
+  SimSwitch* hw_{nullptr};
+};
+
+}} // facebook::fboss
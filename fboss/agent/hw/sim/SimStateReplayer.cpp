@@ -0,0 +1,69 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/hw/sim/SimStateReplayer.h"
+
+#include "fboss/agent/StateUpdateJournal.h"
+#include "fboss/agent/SwSwitch.h"
+#include "fboss/agent/state/SwitchState.h"
+
+#include <folly/String.h>
+#include <folly/logging/xlog.h>
+
+#include <chrono>
+
+using std::chrono::duration_cast;
+using std::chrono::microseconds;
+using std::chrono::steady_clock;
+
+namespace facebook { namespace fboss {
+
+namespace {
+
+void applyState(
+    SwSwitch* sw,
+    folly::StringPiece name,
+    std::shared_ptr<SwitchState> state) {
+  sw->updateStateBlocking(
+      name, [state](const std::shared_ptr<SwitchState>& oldState) {
+        // The journalled state's nodes are shared, so that the next state
+        // only differs from it where the journal says it does
+        auto newState = state->clone();
+        newState->inheritGeneration(*oldState);
+        return newState;
+      });
+}
+
+} // namespace
+
+std::vector<StateUpdateReplayStats> SimStateReplayer::replay(
+    folly::StringPiece path) {
+  StateUpdateJournalReader journal(path.str());
+  applyState(sw_, "journal initial state", journal.getInitialState());
+
+  std::vector<StateUpdateReplayStats> results;
+  StateUpdateJournalReader::Update update;
+  while (journal.next(&update)) {
+    auto name = folly::join(", ", update.names);
+    auto start = steady_clock::now();
+    applyState(sw_, name, update.state);
+    auto took = duration_cast<microseconds>(steady_clock::now() - start);
+
+    StateUpdateReplayStats stats;
+    stats.names = update.names;
+    stats.journalledUs = update.applyTime.count();
+    stats.replayedUs = took.count();
+    XLOG(DBG2) << "replayed " << name << " in " << took.count()
+               << "us, journalled " << update.applyTime.count() << "us";
+    results.push_back(std::move(stats));
+  }
+  return results;
+}
+
+}} // facebook::fboss
@@ -0,0 +1,45 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include "fboss/agent/hw/sim/gen-cpp2/sim_ctrl_types.h"
+
+#include <folly/Range.h>
+
+#include <vector>
+
+namespace facebook { namespace fboss {
+
+class SwSwitch;
+
+/*
+ * Replays a journal written with --state_update_journal through the agent,
+ * one journalled batch of updates at a time, and times each of them. This
+ * reproduces the update latencies of a production update sequence offline,
+ * so that a regression can be bisected on it.
+ *
+ * The journal's initial state is applied first and is not timed. Each batch
+ * is read before its timing starts, so journal I/O does not count.
+ */
+class SimStateReplayer {
+ public:
+  explicit SimStateReplayer(SwSwitch* sw) : sw_(sw) {}
+
+  std::vector<StateUpdateReplayStats> replay(folly::StringPiece path);
+
+ private:
+  // Forbidden copy constructor and assignment operator
+  SimStateReplayer(SimStateReplayer const &) = delete;
+  SimStateReplayer& operator=(SimStateReplayer const &) = delete;
+
+  SwSwitch* sw_{nullptr};
+};
+
+}} // facebook::fboss
@@ -9,6 +9,10 @@
  */
 #include "fboss/agent/hw/sim/SimSwitch.h"
 
+#include "fboss/agent/state/AclEntry.h"
+#include "fboss/agent/state/ArpEntry.h"
+#include "fboss/agent/state/NdpEntry.h"
+#include "fboss/agent/state/Route.h"
 #include "fboss/agent/state/StateDelta.h"
 #include "fboss/agent/state/SwitchState.h"
 #include "fboss/agent/hw/mock/MockRxPacket.h"
@@ -17,11 +21,49 @@
 #include <folly/Conv.h>
 #include <folly/dynamic.h>
 #include <folly/Memory.h>
+#include <folly/logging/xlog.h>
+#include <gflags/gflags.h>
+
+#include <thread>
 
 using std::make_unique;
 using std::make_shared;
 using std::shared_ptr;
 using std::string;
+using namespace std::chrono;
+
+DEFINE_bool(
+    sim_performance_model,
+    false,
+    "Make the sim switch take as long, and have as much room, to program "
+    "state as the sim_* flags say");
+DEFINE_int32(sim_route_program_us, 10, "Time to program a route");
+DEFINE_int32(sim_host_program_us, 10, "Time to program a neighbor entry");
+DEFINE_int32(sim_ecmp_program_us, 100, "Time to program an ECMP group");
+DEFINE_int32(sim_acl_program_us, 50, "Time to program an ACL entry");
+DEFINE_int64(sim_max_routes, 0, "Route table size, 0 for no limit");
+DEFINE_int64(sim_max_hosts, 0, "Neighbor table size, 0 for no limit");
+DEFINE_int64(sim_max_ecmp_groups, 0, "ECMP group table size, 0 for no limit");
+DEFINE_int64(sim_max_acls, 0, "ACL table size, 0 for no limit");
+DEFINE_int64(
+    sim_port_pps,
+    0,
+    "Packets per second counted in and out of each port, of 512 bytes each");
+
+namespace {
+constexpr int64_t kSimPacketBytes = 512;
+
+template <typename DeltaT, typename Fn>
+void forEachDeltaEntry(const DeltaT& delta, Fn fn) {
+  for (const auto& entry : delta) {
+    fn(entry.getOld(), entry.getNew());
+  }
+}
+
+bool overCapacity(int64_t used, int64_t capacity) {
+  return capacity > 0 && used > capacity;
+}
+} // namespace
 
 namespace facebook { namespace fboss {
 
@@ -44,10 +86,118 @@ HwInitResult SimSwitch::init(HwSwitch::Callback* callback) {
 }
 
 std::shared_ptr<SwitchState> SimSwitch::stateChanged(const StateDelta& delta) {
-  // TODO
+  if (FLAGS_sim_performance_model) {
+    return modelStateChanged(delta);
+  }
+  return delta.newState();
+}
+
+template <typename RouteT>
+void SimSwitch::routeChanged(
+    const std::shared_ptr<RouteT>& oldRoute,
+    const std::shared_ptr<RouteT>& newRoute,
+    Tables* tables,
+    Programmed* programmed) const {
+  ++programmed->routes;
+  tables->routes += (newRoute ? 1 : 0) - (oldRoute ? 1 : 0);
+  if (oldRoute) {
+    const auto& nhops = oldRoute->getForwardInfo().getNextHopSet();
+    auto group = tables->ecmpGroups.find(nhops);
+    if (group != tables->ecmpGroups.end() && --group->second == 0) {
+      tables->ecmpGroups.erase(group);
+      ++programmed->ecmpGroups;
+    }
+  }
+  if (newRoute) {
+    const auto& nhops = newRoute->getForwardInfo().getNextHopSet();
+    if (nhops.size() > 1 && tables->ecmpGroups[nhops]++ == 0) {
+      ++programmed->ecmpGroups;
+    }
+  }
+}
+
+std::shared_ptr<SwitchState> SimSwitch::modelStateChanged(
+    const StateDelta& delta) {
+  auto tables = tables_;
+  Programmed programmed;
+  auto routeFn = [&](const auto& oldRoute, const auto& newRoute) {
+    routeChanged(oldRoute, newRoute, &tables, &programmed);
+  };
+  for (const auto& routeTableDelta : delta.getRouteTablesDelta()) {
+    forEachDeltaEntry(routeTableDelta.getRoutesV4Delta(), routeFn);
+    forEachDeltaEntry(routeTableDelta.getRoutesV6Delta(), routeFn);
+  }
+  for (const auto& fibDelta : delta.getFibsDelta()) {
+    forEachDeltaEntry(fibDelta.getV4FibDelta(), routeFn);
+    forEachDeltaEntry(fibDelta.getV6FibDelta(), routeFn);
+  }
+  auto entryFn = [](int64_t* used, uint64_t* programmed) {
+    return [used, programmed](const auto& oldEntry, const auto& newEntry) {
+      ++*programmed;
+      *used += (newEntry ? 1 : 0) - (oldEntry ? 1 : 0);
+    };
+  };
+  for (const auto& vlanDelta : delta.getVlansDelta()) {
+    forEachDeltaEntry(
+        vlanDelta.getArpDelta(), entryFn(&tables.hosts, &programmed.hosts));
+    forEachDeltaEntry(
+        vlanDelta.getNdpDelta(), entryFn(&tables.hosts, &programmed.hosts));
+  }
+  forEachDeltaEntry(
+      delta.getAclsDelta(), entryFn(&tables.acls, &programmed.acls));
+
+  // Like a full hardware table, refuse the whole change. The SwSwitch
+  // retries it with its next update.
+  if (overCapacity(tables.routes, FLAGS_sim_max_routes) ||
+      overCapacity(tables.hosts, FLAGS_sim_max_hosts) ||
+      overCapacity(tables.ecmpGroups.size(), FLAGS_sim_max_ecmp_groups) ||
+      overCapacity(tables.acls, FLAGS_sim_max_acls)) {
+    XLOG(ERR) << "Sim switch tables full, not applying update: "
+              << tables.routes << " routes, " << tables.hosts << " hosts, "
+              << tables.ecmpGroups.size() << " ECMP groups, " << tables.acls
+              << " ACLs";
+    return delta.oldState();
+  }
+
+  std::this_thread::sleep_for(
+      microseconds(FLAGS_sim_route_program_us) * programmed.routes +
+      microseconds(FLAGS_sim_host_program_us) * programmed.hosts +
+      microseconds(FLAGS_sim_ecmp_program_us) * programmed.ecmpGroups +
+      microseconds(FLAGS_sim_acl_program_us) * programmed.acls);
+  tables_ = std::move(tables);
   return delta.newState();
 }
 
+void SimSwitch::updateStats(SwitchStats* /*switchStats*/) {
+  auto now = steady_clock::now();
+  auto elapsed = lastStatsUpdate_ == steady_clock::time_point()
+      ? microseconds(0)
+      : duration_cast<microseconds>(now - lastStatsUpdate_);
+  lastStatsUpdate_ = now;
+  if (FLAGS_sim_port_pps <= 0) {
+    return;
+  }
+  auto pkts = FLAGS_sim_port_pps * elapsed.count() / 1000000;
+  auto portStats = portStats_.wlock();
+  for (uint32_t idx = 1; idx <= numPorts_; ++idx) {
+    auto it = portStats->find(PortID(idx));
+    if (it == portStats->end()) {
+      HwPortStats stats;
+      stats.inBytes_ = stats.inUnicastPkts_ = 0;
+      stats.outBytes_ = stats.outUnicastPkts_ = 0;
+      it = portStats->emplace(PortID(idx), stats).first;
+    }
+    it->second.inUnicastPkts_ += pkts;
+    it->second.inBytes_ += pkts * kSimPacketBytes;
+    it->second.outUnicastPkts_ += pkts;
+    it->second.outBytes_ += pkts * kSimPacketBytes;
+  }
+}
+
+std::map<PortID, HwPortStats> SimSwitch::getPortStats() const {
+  return *portStats_.rlock();
+}
+
 std::unique_ptr<TxPacket> SimSwitch::allocatePacket(uint32_t size) {
   return make_unique<MockTxPacket>(size);
 }
@@ -10,14 +10,30 @@
 #pragma once
 
 #include "fboss/agent/HwSwitch.h"
+#include "fboss/agent/state/RouteNextHopEntry.h"
 
 #include <folly/Optional.h>
+#include <folly/Synchronized.h>
+
+#include <chrono>
+#include <map>
 
 namespace facebook { namespace fboss {
 
 class SimPlatform;
 class SwitchState;
 
+/*
+ * A HwSwitch with no hardware behind it. By default it takes every state
+ * change as is, straight away.
+ *
+ * With --sim_performance_model it instead behaves like an ASIC of the size
+ * and speed given by the sim_* flags: programming each route, host, ECMP
+ * group and ACL takes that long, a change that does not fit in the tables is
+ * not applied, and port counters advance at a steady rate. This lets the
+ * whole agent run at scale, so its own cost and update latency can be
+ * measured against the hardware timings it would see.
+ */
 class SimSwitch : public HwSwitch {
  public:
   SimSwitch(SimPlatform* platform, uint32_t numPorts);
@@ -43,8 +59,8 @@ class SimSwitch : public HwSwitch {
   void initialConfigApplied() override {}
   void switchRunStateChanged(SwitchRunState newState) override {}
 
-  // TODO
-  void updateStats(SwitchStats* /*switchStats*/) override {}
+  void updateStats(SwitchStats* switchStats) override;
+  std::map<PortID, HwPortStats> getPortStats() const override;
 
   void fetchL2Table(std::vector<L2EntryThrift>* /*l2Table*/) override {
     return;
@@ -91,10 +107,42 @@ class SimSwitch : public HwSwitch {
   SimSwitch(SimSwitch const &) = delete;
   SimSwitch& operator=(SimSwitch const &) = delete;
 
+  /*
+   * What the performance model has programmed in its tables.
+   */
+  struct Tables {
+    int64_t routes{0};
+    int64_t hosts{0};
+    int64_t acls{0};
+    // Routes using each multipath next hop set, one ECMP group per set
+    std::map<RouteNextHopEntry::NextHopSet, uint32_t> ecmpGroups;
+  };
+  /*
+   * Number of objects programmed by one state change.
+   */
+  struct Programmed {
+    uint64_t routes{0};
+    uint64_t hosts{0};
+    uint64_t ecmpGroups{0};
+    uint64_t acls{0};
+  };
+
+  std::shared_ptr<SwitchState> modelStateChanged(const StateDelta& delta);
+  template <typename RouteT>
+  void routeChanged(
+      const std::shared_ptr<RouteT>& oldRoute,
+      const std::shared_ptr<RouteT>& newRoute,
+      Tables* tables,
+      Programmed* programmed) const;
+
   HwSwitch::Callback* callback_{nullptr};
   uint32_t numPorts_{0};
   uint64_t txCount_{0};
   BootType bootType_{BootType::UNINITIALIZED};
+  // Only used by the update thread
+  Tables tables_;
+  std::chrono::steady_clock::time_point lastStatsUpdate_;
+  folly::Synchronized<std::map<PortID, HwPortStats>> portStats_;
 };
 
 }} // facebook::fboss
@@ -5,5 +5,43 @@ namespace py neteng.fboss.sim_ctrl
 include "fboss/agent/if/fboss.thrift"
 include "fboss/agent/if/ctrl.thrift"
 
+struct PcapReplayStats {
+  1: i64 packets
+  2: i64 durationUs
+  3: double pktsPerSec
+  // Time the agent took to handle each packet
+  4: i64 latencyP50Ns
+  5: i64 latencyP90Ns
+  6: i64 latencyP99Ns
+  7: i64 latencyMaxNs
+}
+
+struct StateUpdateReplayStats {
+  // The updates applied together as one batch
+  1: list<string> names
+  // Time the hardware took to apply the batch when it was journalled
+  2: i64 journalledUs
+  // Time the replayed batch took to be applied, from being queued
+  3: i64 replayedUs
+}
+
 service SimCtrl extends ctrl.FbossCtrl {
+  /*
+   * Inject the packets of a pcap file as if they had been received on the
+   * given port and VLAN, pps packets a second, or with the gaps between
+   * their capture timestamps if pps is 0, or as fast as they are handled if
+   * pps is negative.  Returns once they have all been handled.
+   */
+  PcapReplayStats replayPcap(1: string path, 2: i32 port, 3: i32 vlan,
+                             4: double pps)
+    throws (1: fboss.FbossBaseError error)
+
+  /*
+   * Apply the state updates of a journal written with
+   * --state_update_journal, one batch at a time, from the journal's initial
+   * state.  Returns the time each batch took once they have all been
+   * applied.
+   */
+  list<StateUpdateReplayStats> replayStateJournal(1: string path)
+    throws (1: fboss.FbossBaseError error)
 }
@@ -47,8 +47,10 @@ void HwTest::SetUp() {
   // Each test then sets up its own state as needed.
   folly::SingletonVault::singleton()->destroyInstances();
   folly::SingletonVault::singleton()->reenableInstances();
+  auto start = std::chrono::steady_clock::now();
   std::tie(platform_, hwSwitch_) = createHw();
   initHwSwitch();
+  initDuration_ = std::chrono::steady_clock::now() - start;
   if (FLAGS_setup_thrift) {
     thriftThread_ = createThriftThread();
   }
@@ -10,6 +10,7 @@
 #pragma once
 
 #include <gtest/gtest.h>
+#include <chrono>
 #include <memory>
 #include <utility>
 
@@ -128,6 +129,14 @@ class HwTest : public ::testing::Test, public HwSwitch::Callback {
     return programmedState_;
   }
 
+  /*
+   * Time SetUp() took to create and initialize the HwSwitch, for a cold or
+   * warm boot as HwSwitch::getBootType() says
+   */
+  std::chrono::duration<double> getInitDuration() const {
+    return initDuration_;
+  }
+
  private:
   std::shared_ptr<SwitchState> initHwSwitch();
 
@@ -154,6 +163,7 @@ class HwTest : public ::testing::Test, public HwSwitch::Callback {
   std::unique_ptr<Platform> platform_;
   std::unique_ptr<std::thread> thriftThread_;
   std::shared_ptr<SwitchState> programmedState_{nullptr};
+  std::chrono::duration<double> initDuration_{0};
 };
 
 } // namespace fboss
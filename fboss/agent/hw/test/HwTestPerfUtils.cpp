@@ -0,0 +1,63 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/hw/test/HwTestPerfUtils.h"
+
+#include "fboss/agent/FbossError.h"
+
+#include <folly/File.h>
+#include <folly/FileUtil.h>
+#include <folly/json.h>
+#include <folly/logging/xlog.h>
+#include <gflags/gflags.h>
+#include <gtest/gtest.h>
+
+#include <fcntl.h>
+
+DEFINE_string(
+    perf_results_file,
+    "",
+    "File to append performance test results to, one JSON object per line");
+
+namespace facebook {
+namespace fboss {
+namespace utility {
+
+void recordPerfResult(
+    const std::string& metric,
+    double value,
+    const std::string& unit,
+    folly::dynamic params) {
+  folly::dynamic result = folly::dynamic::object;
+  auto testInfo = ::testing::UnitTest::GetInstance()->current_test_info();
+  if (testInfo) {
+    result["test"] = folly::to<std::string>(
+        testInfo->test_case_name(), ".", testInfo->name());
+  }
+  result["metric"] = metric;
+  result["value"] = value;
+  result["unit"] = unit;
+  result["params"] = std::move(params);
+  auto line = folly::toJson(result);
+  XLOG(INFO) << "perf result: " << line;
+
+  if (FLAGS_perf_results_file.empty()) {
+    return;
+  }
+  line.push_back('\n');
+  folly::File file(
+      FLAGS_perf_results_file, O_WRONLY | O_CREAT | O_APPEND, 0644);
+  if (folly::writeFull(file.fd(), line.data(), line.size()) < 0) {
+    throw FbossError("failed to write to ", FLAGS_perf_results_file);
+  }
+}
+
+} // namespace utility
+} // namespace fboss
+} // namespace facebook
@@ -0,0 +1,50 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include <folly/dynamic.h>
+
+#include <chrono>
+#include <string>
+
+namespace facebook {
+namespace fboss {
+namespace utility {
+
+/*
+ * Performance tests report each measurement here. It is logged, and if
+ * --perf_results_file is set, appended to that file as one line of JSON:
+ *
+ *   {"test": "...", "metric": "...", "value": 1.5, "unit": "...",
+ *    "params": {...}}
+ *
+ * so that runs on different SDK or agent versions can be compared.
+ */
+void recordPerfResult(
+    const std::string& metric,
+    double value,
+    const std::string& unit,
+    folly::dynamic params = folly::dynamic::object);
+
+/*
+ * Seconds taken to run fn
+ */
+template <typename FN>
+double timeSeconds(FN fn) {
+  auto start = std::chrono::steady_clock::now();
+  fn();
+  return std::chrono::duration<double>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+} // namespace utility
+} // namespace fboss
+} // namespace facebook
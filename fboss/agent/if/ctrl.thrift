@@ -10,6 +10,7 @@ include "fboss/agent/if/fboss.thrift"
 include "common/fb303/if/fb303.thrift"
 include "common/network/if/Address.thrift"
 include "fboss/agent/if/mpls.thrift"
+include "fboss/agent/hw/hardware_stats.thrift"
 include "fboss/agent/if/optic.thrift"
 include "fboss/qsfp_service/if/transceiver.thrift"
 
@@ -113,6 +114,108 @@ struct MplsRouteDetails {
   5: list<NextHopThrift> nextHops,
 }
 
+struct RouteTableFilter {
+  // Only routes to this prefix or to prefixes inside it
+  1: optional IpPrefix prefix,
+  // Only this client's routes, with the next hops it gave
+  2: optional i16 clientId,
+}
+
+struct RouteTableChunk {
+  1: list<UnicastRoute> routes,
+}
+
+/*
+ * Where the time of one route add, delete or sync went.  Times are in
+ * microseconds.
+ */
+struct RouteUpdateTrace {
+  1: i64 timestampMsecs,
+  2: i16 clientId,
+  3: string updateType,
+  4: i32 routesAdded,
+  5: i32 routesDeleted,
+  // Waiting for the update thread, or for the RIB to be free
+  6: i64 queueUsecs,
+  // Computing the new routes
+  7: i64 ribUsecs,
+  // Programming the new routes into the switch state and hardware
+  8: i64 fibUsecs,
+}
+
+/*
+ * Counters to look up with getCounterValues().  A counter is returned if it
+ * matches any one of the criteria.
+ */
+struct CounterQuery {
+  1: list<string> keys
+  2: list<string> prefixes
+  // Parts of counter names between '.'s, such as a port name or "in_bytes"
+  3: list<string> components
+  // Matched against the whole name
+  4: list<string> regexes
+}
+
+/*
+ * Counters in bulk, sorted by name: names[i] has the value values[i].
+ */
+struct CounterValues {
+  1: list<string> names
+  2: list<i64> values
+}
+
+struct EventLoopSample {
+  1: string threadName,
+  2: i64 timestampMsecs,
+  3: i64 busyUsecs,
+  // The work last named on the thread before the loop ended, if any
+  4: string source,
+}
+
+struct ThreadStall {
+  1: string threadName,
+  2: i64 timestampMsecs,
+  // How long the work had been running when its stack was captured
+  3: i64 stalledMsecs,
+  // The StateUpdate or other work the thread was running
+  4: string source,
+  // Symbolized frames of the thread, innermost first; empty if it could not
+  // be captured
+  5: list<string> stack,
+}
+
+// CPU time the agent spent handling trapped packets
+struct RxCpuUsage {
+  // "handler.<arp|lldp|ipv4|ipv6|lacp|other>" or "cpu_queue.<queue>"
+  1: string name,
+  2: i64 packets,
+  3: i64 cpuTimeUsecs,
+  // Only counted with --rx_tlb_counters
+  4: i64 dtlbMisses,
+}
+
+// Where and how an agent thread is actually scheduled
+struct ThreadPlacementInfo {
+  1: string name,
+  2: i32 tid,
+  3: list<i32> cpus,
+  // "OTHER", "FIFO" or "RR"
+  4: string policy,
+  5: i32 priority,
+  6: i32 nice,
+}
+
+// Estimated memory used by a part of the SwitchState
+struct StateSubtreeMemory {
+  // eg "routeTables.0", "vlans.1.arp", "acls", or "total"
+  1: string name,
+  2: i64 bytes,
+  3: i64 nodes,
+  // The part of the above shared with the applied state
+  4: i64 sharedBytes,
+  5: i64 sharedNodes,
+}
+
 struct ArpEntryThrift {
   1: string mac,
   2: i32 port,
@@ -133,6 +236,10 @@ struct L2EntryThrift {
   4: optional i32 trunk
 }
 
+struct L2TableChunk {
+  1: list<L2EntryThrift> entries,
+}
+
 enum LacpPortRateThrift {
   SLOW = 0,
   FAST = 1,
@@ -305,6 +412,91 @@ struct PortInfoThrift {
   17: list<PortQueueThrift> portQueues = [],
 }
 
+/*
+ * One sample of a port's counters, taken by the fast port sampler.
+ * Counters are cumulative, as in PortCounters.
+ */
+struct PortFastSample {
+  1: i64 timestampUsecs,
+  2: i64 inBytes,
+  3: i64 outBytes,
+  4: i64 inDiscards,
+  5: i64 outDiscards,
+  // Bytes queued for egress on the port when sampled
+  6: i64 outQueueLength,
+}
+
+/*
+ * Hardware stats from one stats update, keyed by port ID.  Each
+ * StatsListenerClient first gets the stats of every port, then only the
+ * ports whose stats changed since the previous update.
+ */
+struct HwStatsUpdate {
+  1: i64 timestampSecs,
+  2: map<i32, hardware_stats.HwPortStats> portStats,
+  // True if portStats has every port, rather than just the changed ones
+  3: bool full,
+}
+
+struct PortFastSamples {
+  1: i32 portId,
+  2: i32 intervalMsecs,
+  // Most recent samples, oldest first
+  3: list<PortFastSample> samples,
+  // Peak rates between two consecutive samples, and peak queue length, over
+  // the last minute
+  4: i64 maxInBytesPerSec,
+  5: i64 maxOutBytesPerSec,
+  6: i64 maxOutQueueLength,
+}
+
+// Latency of one hardware SDK API, over all its calls
+struct HwApiCallStats {
+  1: string api,
+  2: i64 calls,
+  // Calls that returned an error
+  3: i64 errors,
+  4: i64 totalUsecs,
+  5: i64 maxUsecs,
+  6: i64 p50Usecs,
+  7: i64 p99Usecs,
+}
+
+struct HwApiCall {
+  1: string api,
+  // Hash of the arguments, to tell repeated calls apart
+  2: i64 argsDigest,
+  3: i64 timestampUsecs,
+  4: i64 latencyNsecs,
+  5: i32 rc,
+}
+
+struct HwApiTrace {
+  // Most time spent first
+  1: list<HwApiCallStats> apis,
+  // Oldest first
+  2: list<HwApiCall> recentCalls,
+}
+
+/*
+ * A queue's buffer use crossing the congestion threshold, in either
+ * direction.
+ */
+struct BufferCongestionEvent {
+  1: i64 timestampMsecs,
+  2: string portName,
+  3: bool ingress,
+  4: i32 queue,
+  // Bytes in use when the threshold was crossed
+  5: i64 bytesUsed,
+  // Most bytes in use while congested; only set once cleared
+  6: i64 peakBytesUsed,
+  7: i64 thresholdBytes,
+  // False when buffer use rose above the threshold, true once it has
+  // dropped back below it
+  8: bool cleared,
+}
+
 struct NdpEntryThrift {
   1: Address.BinaryAddress ip,
   2: string mac,
@@ -341,6 +533,15 @@ enum CaptureDirection {
   CAPTURE_TX_RX = 2
 }
 
+/*
+ * Which packet a capture loses when packets arrive faster than they can be
+ * written to disk
+ */
+enum CaptureDropPolicy {
+  DROP_NEWEST = 0,
+  DROP_OLDEST = 1
+}
+
 
 enum CpuCosQueueId {
   LOPRI = 0,
@@ -356,6 +557,41 @@ struct RxCaptureFilter {
 
 struct CaptureFilter {
   1: RxCaptureFilter rxCaptureFilter;
+  /*
+   * Header matches, applied to both RX and TX packets before they are copied
+   * into the capture.  An empty list matches anything.  Otherwise a packet
+   * has to match at least one entry of every non-empty list.
+   */
+  // Ethertype following any 802.1q tags
+  2: list<i32> etherTypes
+  // IPv4 protocol, or the IPv6 next header
+  3: list<i32> ipProtocols
+  // TCP or UDP source or destination port
+  4: list<i32> l4Ports
+}
+
+/*
+ * One frame for txPktBatch, in the same form txPkt and txPktL2 take.
+ */
+struct TxPkt {
+  // Front panel port to send the frame out of; if unset the frame is
+  // switched, as by txPktL2
+  1: optional i32 port,
+  2: binary data,
+}
+
+/*
+ * Forwarded traffic for a capture to copy to the CPU.  Unset fields match
+ * anything.
+ */
+struct DataplaneCapture {
+  1: optional IpPrefix srcIp
+  2: optional IpPrefix dstIp
+  3: optional i16 ipProtocol
+  4: optional i32 l4SrcPort
+  5: optional i32 l4DstPort
+  // Stop mirroring after this long, even if the capture is still running
+  6: i32 timeoutSeconds = 300
 }
 
 struct CaptureInfo {
@@ -375,6 +611,33 @@ struct CaptureInfo {
    * set of criteria that packet must meet to be captured
    */
   4: CaptureFilter  filter
+  5: CaptureDropPolicy dropPolicy = DROP_NEWEST
+  /*
+   * Once the capture file reaches maxFileBytes it is renamed to <name>.1,
+   * older files shift up to <name>.<maxFiles - 1>, and a new file is
+   * started.  0 keeps everything in a single file.
+   */
+  6: i64 maxFileBytes = 0
+  7: i32 maxFiles = 0
+  /*
+   * Also capture forwarded traffic matching these fields, by mirroring it
+   * to the CPU for the length of the capture.  Such a capture only sees
+   * packets received on the capture CPU queue.
+   */
+  8: optional DataplaneCapture dataplane
+}
+
+struct CaptureStats {
+  1: string name
+  2: bool active
+  // Packets that matched the capture
+  3: i64 packetsReceived
+  4: i64 packetsSent
+  // Matched packets that were not written because the capture fell behind
+  5: i64 packetsDropped
+  6: i64 bytesWritten
+  // Longest time taken by a single write to the capture file
+  7: i64 maxFlushUsecs
 }
 
 struct RouteUpdateLoggingInfo {
@@ -458,6 +721,18 @@ service FbossCtrl extends fb303.FacebookService {
   void flushCountersNow()
     throws (1: fboss.FbossBaseError error)
 
+  /*
+   * Just the counters matching query, from the agent's interned counters.
+   * This only visits the counters that match, so collectors that poll a
+   * subset, such as those of a few ports, should prefer it to getCounters().
+   */
+  CounterValues getCounterValues(1: CounterQuery query)
+    throws (1: fboss.FbossBaseError error)
+  map<string, i64> getSelectedCounters(1: list<string> keys)
+    throws (1: fboss.FbossBaseError error)
+  map<string, i64> getRegexCounters(1: string regex)
+    throws (1: fboss.FbossBaseError error)
+
   /*
    * Add/Delete IPv4/IPV6 routes
    * - decide if it is v4 or v6 from destination ip address
@@ -530,6 +805,13 @@ service FbossCtrl extends fb303.FacebookService {
    */
   void txPktL3(1: fbbinary payload) throws (1: fboss.FbossBaseError error)
 
+  /*
+   * Transmit many frames in one call, each as txPkt or txPktL2 would, to
+   * generate control plane load without a round trip per frame.
+   */
+  void txPktBatch(1: list<TxPkt> pkts)
+    throws (1: fboss.FbossBaseError error)
+
   /*
    * Flush the ARP/NDP entry with the specified IP address.
    *
@@ -566,6 +848,26 @@ service FbossCtrl extends fb303.FacebookService {
     throws (1: fboss.FbossBaseError error)
   void registerForNeighborChanged()
     throws (1: fboss.FbossBaseError error) (thread='eb')
+  /*
+   * Push neighbor changes to the caller's NeighborListenerClient with
+   * neighborChangesBatched, gathered up over
+   * --neighbor_listener_batch_ms, until the connection closes.
+   */
+  void registerForNeighborChangesBatched()
+    throws (1: fboss.FbossBaseError error) (thread='eb')
+  /*
+   * Push the hardware stats to the caller's StatsListenerClient after every
+   * stats update, until the connection closes.
+   */
+  void registerForStatsUpdates()
+    throws (1: fboss.FbossBaseError error) (thread='eb')
+  /*
+   * Push the status of every port to the caller's PortStatusListenerClient,
+   * then the status of each port whose state, speed or enablement changes,
+   * as it changes, until the connection closes.
+   */
+  void registerForPortStatusChanged()
+    throws (1: fboss.FbossBaseError error) (thread='eb')
   list<string> getInterfaceList()
     throws (1: fboss.FbossBaseError error)
   /*
@@ -578,6 +880,61 @@ service FbossCtrl extends fb303.FacebookService {
     throws (1: fboss.FbossBaseError error)
   list<RouteDetails> getRouteTableDetails()
     throws (1: fboss.FbossBaseError error)
+
+  /*
+   * The route table in chunks of up to chunkSize routes, from the switch
+   * state at the time of the call.  Routes are only converted as the client
+   * reads them, so unlike getRouteTable() the table is never held in memory
+   * all at once.  Without a client filter only resolved routes are returned,
+   * as from getRouteTable().
+   */
+  stream<RouteTableChunk> streamRouteTable(
+    1: RouteTableFilter filter,
+    2: i32 chunkSize,
+  ) throws (1: fboss.FbossBaseError error)
+
+  /*
+   * A sample of recent route updates, oldest first, to tell which client's
+   * updates are slow and where the time goes.
+   */
+  list<RouteUpdateTrace> getRouteUpdateTraces()
+    throws (1: fboss.FbossBaseError error)
+
+  /*
+   * Recent EventBase loops of the agent threads that were busy for longer
+   * than --slow_event_loop_ms, slowest first, to tell what stalled a thread.
+   */
+  list<EventLoopSample> getSlowEventLoops()
+    throws (1: fboss.FbossBaseError error)
+
+  /*
+   * The last update and rx thread stalls longer than --stall_threshold_ms,
+   * oldest first, with the stack of the thread while it was stuck.
+   */
+  list<ThreadStall> getThreadStalls()
+    throws (1: fboss.FbossBaseError error)
+
+  /*
+   * The packet handlers and CPU queues that used the most agent CPU time on
+   * trapped packets in the last windowSeconds (at most 60), most first.
+   */
+  list<RxCpuUsage> getRxCpuUsage(1: i32 windowSeconds, 2: i32 count)
+    throws (1: fboss.FbossBaseError error)
+
+  /*
+   * Memory used by each part of the desired SwitchState, and how much of it
+   * is shared with the applied state, followed by the total.
+   */
+  list<StateSubtreeMemory> getStateMemoryUsage()
+    throws (1: fboss.FbossBaseError error)
+
+  /*
+   * The CPUs and scheduling policy of every agent thread, as applied from
+   * the threads section of the agent config.
+   */
+  list<ThreadPlacementInfo> getThreadPlacement()
+    throws (1: fboss.FbossBaseError error)
+
   InterfaceDetail getInterfaceDetail(1: i32 interfaceId)
     throws (1: fboss.FbossBaseError error)
 
@@ -642,6 +999,38 @@ service FbossCtrl extends fb303.FacebookService {
   /* clear stats for specified port(s) */
   void clearPortStats(1: list<i32> ports)
 
+  /*
+   * Sample the counters of the given ports every intervalMsecs, for
+   * microburst visibility beyond the regular stats interval.  Replaces any
+   * previous set of ports; an empty list stops sampling.
+   */
+  void setPortFastSampling(1: list<i32> ports, 2: i32 intervalMsecs)
+    throws (1: fboss.FbossBaseError error)
+  PortFastSamples getPortFastSamples(1: i32 portId)
+    throws (1: fboss.FbossBaseError error)
+
+  /*
+   * Poll the counters of the named ACL stats every stats interval for the
+   * next durationSecs, e.g. while a dashboard reads them.  ACL stats that
+   * nobody watches are polled less often.
+   */
+  void watchAclStats(1: list<string> statNames, 2: i32 durationSecs)
+    throws (1: fboss.FbossBaseError error)
+
+  /*
+   * Recent buffer congestion events, oldest first.  Only available when the
+   * agent tracks congestion from BST threshold triggers.
+   */
+  list<BufferCongestionEvent> getBufferCongestionEvents()
+    throws (1: fboss.FbossBaseError error)
+
+  /*
+   * Time spent in hardware SDK calls, per API, and the most recent calls.
+   * Only available when the agent runs with --bcm_sdk_trace.
+   */
+  HwApiTrace getHwApiTrace()
+    throws (1: fboss.FbossBaseError error)
+
   /* Legacy names for getPortInfo() and getAllPortInfo() */
   PortInfoThrift getPortStats(1: i32 portId)
     throws (1: fboss.FbossBaseError error)
@@ -658,6 +1047,13 @@ service FbossCtrl extends fb303.FacebookService {
     throws (1: fboss.FbossBaseError error)
   list<L2EntryThrift> getL2Table()
     throws (1: fboss.FbossBaseError error)
+  /*
+   * The L2 table in chunks of up to chunkSize entries.  The hardware table
+   * is read once, when the client asks for the first chunk, and the entries
+   * are then handed out from that snapshot.
+   */
+  stream<L2TableChunk> streamL2Table(1: i32 chunkSize)
+    throws (1: fboss.FbossBaseError error)
   list<AclEntryThrift> getAclTable()
     throws (1: fboss.FbossBaseError error)
 
@@ -691,6 +1087,8 @@ service FbossCtrl extends fb303.FacebookService {
     throws (1: fboss.FbossBaseError error)
   void stopAllPktCaptures()
     throws (1: fboss.FbossBaseError error)
+  CaptureStats getPktCaptureStats(1: string name)
+    throws (1: fboss.FbossBaseError error)
 
   /*
    * Log all updates to routes that match this prefix, or are more
@@ -723,6 +1121,15 @@ service FbossCtrl extends fb303.FacebookService {
    */
   string getCurrentStateJSON(1: string jsonPointer)
 
+  /*
+   * Serialize entries [offset, offset + limit) of the list of nodes at the
+   * path pointed by JSON pointer, e.g. "/routeTables/entries/0/ribV4", as
+   * {"entries": [...], "total": <number of entries>}
+   */
+  string getCurrentStateJSONPage(1: string jsonPointer, 2: i64 offset,
+                                 3: i32 limit)
+    throws (1: fboss.FbossBaseError error)
+
   /*
    * Apply patch at given path within the state tree. jsonPatch must  be
    * a valid JSON object string
@@ -738,6 +1145,19 @@ service FbossCtrl extends fb303.FacebookService {
     throws (1: fboss.FbossBaseError error)
 }
 
+/*
+ * The neighbors resolved and unresolved since the previous batch.  A
+ * neighbor that changed more than once is only in the list for its latest
+ * change.
+ */
+struct NeighborChanges {
+  1: list<Address.BinaryAddress> added,
+  2: list<Address.BinaryAddress> removed,
+  // Changes were dropped because the listener fell behind, so it should
+  // fetch the ARP and NDP tables afresh.  The lists are then empty.
+  3: bool resync,
+}
+
 service NeighborListenerClient extends fb303.FacebookService {
   /*
    * Sends list of neighbors that have changed to the subscriber.
@@ -748,4 +1168,29 @@ service NeighborListenerClient extends fb303.FacebookService {
    */
   void neighborsChanged(1: list<string> added, 2: list<string> removed)
     throws (1: fboss.FbossBaseError error)
+
+  /*
+   * Sends a batch of neighbor changes to a subscriber that registered with
+   * registerForNeighborChangesBatched.
+   */
+  void neighborChangesBatched(1: NeighborChanges changes)
+    throws (1: fboss.FbossBaseError error)
+}
+
+service PortStatusListenerClient extends fb303.FacebookService {
+  /*
+   * Sends the new status of the ports that changed to the subscriber, or of
+   * every port if full is set.
+   */
+  void portStatusChanged(1: map<i32, PortStatus> ports, 2: bool full)
+    throws (1: fboss.FbossBaseError error)
+}
+
+service StatsListenerClient extends fb303.FacebookService {
+  /*
+   * Sends the hardware stats from the latest stats update to the
+   * subscriber.
+   */
+  void statsUpdated(1: HwStatsUpdate update)
+    throws (1: fboss.FbossBaseError error)
 }
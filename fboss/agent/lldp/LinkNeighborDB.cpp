@@ -56,9 +56,6 @@ LinkNeighborDB::LinkNeighborDB() {
 void LinkNeighborDB::update(const LinkNeighbor& neighbor) {
   lock_guard<mutex> guard(mutex_);
 
-  // Go ahead and prune expired neighbors each time we get updated.
-  pruneLocked(steady_clock::now());
-
   auto it = byLocalPort_.find(neighbor.getLocalPort());
   if (it == byLocalPort_.end()) {
     // This is the first time we have seen data for this port.
@@ -67,6 +64,11 @@ void LinkNeighborDB::update(const LinkNeighbor& neighbor) {
     it = ret.first;
   }
 
+  // Prune only the port we heard from, so each frame costs work in the
+  // neighbors of one port rather than in the whole table. Readers prune
+  // everything with pruneExpiredNeighbors() first.
+  pruneLocked(&it->second, steady_clock::now());
+
   NeighborKey key(neighbor);
   // It would be nicer to use insert_or_assign() once we move to C++17
   it->second[key] = neighbor;
@@ -124,16 +126,21 @@ void LinkNeighborDB::pruneLocked(steady_clock::time_point now) {
   // implementing right now.
 
   for (auto& portEntry : byLocalPort_) {
-    // Advance the iterator manually to avoid make sure we don't
-    // have invalid iterators to erased elements.
-    auto& map = portEntry.second;
-    auto it = map.begin();
-    while (it != map.end()) {
-      auto current = it;
-      ++it;
-      if (current->second.isExpired(now)) {
-        map.erase(current);
-      }
+    pruneLocked(&portEntry.second, now);
+  }
+}
+
+void LinkNeighborDB::pruneLocked(
+    NeighborMap* map,
+    steady_clock::time_point now) {
+  // Advance the iterator manually to avoid make sure we don't
+  // have invalid iterators to erased elements.
+  auto it = map->begin();
+  while (it != map->end()) {
+    auto current = it;
+    ++it;
+    if (current->second.isExpired(now)) {
+      map->erase(current);
     }
   }
 }
@@ -68,6 +68,9 @@ class LinkNeighborDB {
   LinkNeighborDB& operator=(LinkNeighborDB const &) = delete;
 
   void pruneLocked(std::chrono::steady_clock::time_point now);
+  void pruneLocked(
+      NeighborMap* map,
+      std::chrono::steady_clock::time_point now);
 
   std::mutex mutex_;
   std::map<PortID, NeighborMap> byLocalPort_;
@@ -13,6 +13,10 @@
 #include <folly/MacAddress.h>
 #include <folly/logging/xlog.h>
 #include <netinet/icmp6.h>
+#include <boost/container/flat_map.hpp>
+#include <algorithm>
+#include <chrono>
+#include <set>
 #include "fboss/agent/FbossError.h"
 #include "fboss/agent/SwSwitch.h"
 #include "fboss/agent/TxPacket.h"
@@ -71,53 +75,89 @@ namespace facebook { namespace fboss {
 /*
  * IPv6RAImpl is the class that actually handles sending out the RA packets.
  *
- * This uses AsyncTimeout to receive timeout notifications in the SwSwitch's
- * background event thread, and send out RA packets every time the timer fires.
+ * This uses one AsyncTimeout to receive timeout notifications in the
+ * SwSwitch's background event thread, for whichever interface is due to send
+ * next, and sends out the RA packets of every interface that is due each time
+ * the timer fires. All of its methods run in the background thread.
  */
 class IPv6RAImpl : private folly::AsyncTimeout {
  public:
-  IPv6RAImpl(SwSwitch* sw,
-             const SwitchState* state,
-             const Interface* intf);
+  explicit IPv6RAImpl(SwSwitch* sw);
 
   SwSwitch* getSw() const {
     return sw_;
   }
 
-  static void start(IPv6RAImpl* ra);
+  void setAdvertisement(
+      InterfaceID intfID,
+      std::chrono::milliseconds interval,
+      folly::IOBuf buf);
+  void removeAdvertisement(InterfaceID intfID);
+
   static void stop(IPv6RAImpl* ra);
 
  private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Advertisement {
+    std::chrono::milliseconds interval;
+    folly::IOBuf buf;
+    Clock::time_point nextSend;
+  };
+
   // Forbidden copy constructor and assignment operator
   IPv6RAImpl(IPv6RAImpl const &) = delete;
   IPv6RAImpl& operator=(IPv6RAImpl const &) = delete;
 
-  void timeoutExpired() noexcept override {
-    sendRouteAdvertisement();
-    scheduleTimeout(interval_);
-  }
+  void timeoutExpired() noexcept override;
 
-  void initPacket(const Interface* intf);
-  void sendRouteAdvertisement();
+  void schedule(InterfaceID intfID, Advertisement* adv);
+  void rescheduleTimer();
+  void sendRouteAdvertisement(const folly::IOBuf& buf);
 
-  std::chrono::milliseconds interval_;
-  folly::IOBuf buf_;
+  boost::container::flat_map<InterfaceID, Advertisement> advertisements_;
+  // When each interface is next due to send
+  std::set<std::pair<Clock::time_point, InterfaceID>> schedule_;
   SwSwitch* const sw_{nullptr};
 };
 
-IPv6RAImpl::IPv6RAImpl(
-    SwSwitch* sw,
-    const SwitchState* /*state*/,
-    const Interface* intf)
-    : AsyncTimeout(sw->getBackgroundEvb()), sw_(sw) {
-  std::chrono::seconds raInterval(
-      intf->getNdpConfig().routerAdvertisementSeconds);
-  interval_ = raInterval;
-  initPacket(intf);
+IPv6RAImpl::IPv6RAImpl(SwSwitch* sw)
+    : AsyncTimeout(sw->getBackgroundEvb()), sw_(sw) {}
+
+void IPv6RAImpl::setAdvertisement(
+    InterfaceID intfID,
+    std::chrono::milliseconds interval,
+    folly::IOBuf buf) {
+  auto it = advertisements_.find(intfID);
+  if (it == advertisements_.end()) {
+    it = advertisements_
+             .emplace(intfID, Advertisement{interval, std::move(buf), {}})
+             .first;
+    schedule(intfID, &it->second);
+    return;
+  }
+  // Only the packet changed, so the interface keeps its place
+  it->second.buf = std::move(buf);
+  if (it->second.interval != interval) {
+    schedule_.erase(std::make_pair(it->second.nextSend, intfID));
+    it->second.interval = interval;
+    schedule(intfID, &it->second);
+  }
 }
 
-void IPv6RAImpl::start(IPv6RAImpl* ra) {
-  ra->scheduleTimeout(ra->interval_);
+void IPv6RAImpl::removeAdvertisement(InterfaceID intfID) {
+  auto it = advertisements_.find(intfID);
+  if (it == advertisements_.end()) {
+    return;
+  }
+  /*
+   * Send one last route advertisement for the interface, as we did not
+   * know whether it is going away or RAs are being turned off on it
+   */
+  sendRouteAdvertisement(it->second.buf);
+  schedule_.erase(std::make_pair(it->second.nextSend, intfID));
+  advertisements_.erase(it);
+  rescheduleTimer();
 }
 
 void IPv6RAImpl::stop(IPv6RAImpl* ra) {
@@ -126,22 +166,57 @@ void IPv6RAImpl::stop(IPv6RAImpl* ra) {
    * advertisement to avoid RA's timing out while
    * controller is restarted
    */
-  ra->sendRouteAdvertisement();
+  for (const auto& entry : ra->advertisements_) {
+    ra->sendRouteAdvertisement(entry.second.buf);
+  }
   delete ra;
 }
 
-void IPv6RAImpl::initPacket(const Interface* intf) {
-  auto totalLength = IPv6RouteAdvertiser::getPacketSize(intf);
-  buf_ = IOBuf(IOBuf::CREATE, totalLength);
-  buf_.append(totalLength);
-  RWPrivateCursor cursor(&buf_);
-  IPv6RouteAdvertiser::createAdvertisementPacket(
-    intf, &cursor, MacAddress("33:33:00:00:00:01"), IPAddressV6("ff02::1"));
+void IPv6RAImpl::schedule(InterfaceID intfID, Advertisement* adv) {
+  /*
+   * The first RA goes out between half an interval and an interval from now,
+   * at an offset that depends on the interface. Interfaces added in the same
+   * update then stay spread out over their interval.
+   */
+  auto offset = static_cast<uint32_t>(intfID) * 2654435761u;
+  auto half = adv->interval / 2;
+  auto stagger = std::chrono::duration_cast<std::chrono::milliseconds>(
+      half * (offset / static_cast<double>(1ull << 32)));
+  adv->nextSend = Clock::now() + half + stagger;
+  schedule_.emplace(adv->nextSend, intfID);
+  rescheduleTimer();
 }
 
-void IPv6RAImpl::sendRouteAdvertisement() {
+void IPv6RAImpl::rescheduleTimer() {
+  if (schedule_.empty()) {
+    cancelTimeout();
+    return;
+  }
+  auto delay = std::chrono::duration_cast<std::chrono::milliseconds>(
+      schedule_.begin()->first - Clock::now());
+  scheduleTimeout(std::max(delay, std::chrono::milliseconds(0)));
+}
+
+void IPv6RAImpl::timeoutExpired() noexcept {
+  auto now = Clock::now();
+  while (!schedule_.empty() && schedule_.begin()->first <= now) {
+    auto intfID = schedule_.begin()->second;
+    schedule_.erase(schedule_.begin());
+    auto& adv = advertisements_.at(intfID);
+    sendRouteAdvertisement(adv.buf);
+    adv.nextSend += adv.interval;
+    if (adv.nextSend <= now) {
+      // We fell more than an interval behind, don't send to catch up
+      adv.nextSend = now + adv.interval;
+    }
+    schedule_.emplace(adv.nextSend, intfID);
+  }
+  rescheduleTimer();
+}
+
+void IPv6RAImpl::sendRouteAdvertisement(const folly::IOBuf& buf) {
   XLOG(DBG5) << "sending route advertisement:\n"
-             << PktUtil::hexDump(Cursor(&buf_));
+             << PktUtil::hexDump(Cursor(&buf));
 
   // Allocate a new packet, and copy our data into it.
   //
@@ -149,42 +224,57 @@ void IPv6RAImpl::sendRouteAdvertisement() {
   // The TxPacket is required to use DMA memory for its buffer, so we can't do
   // a simple clone.
   //
-  // TODO: In the future it would be nice to support allocating buf_ in a DMA
+  // TODO: In the future it would be nice to support allocating buf in a DMA
   // buffer so that we really can just clone a reference to it here, rather
   // than doing a copy.
-  uint32_t pktLen = buf_.length();
+  uint32_t pktLen = buf.length();
   auto pkt = sw_->allocatePacket(pktLen);
   RWPrivateCursor cursor(pkt->buf());
-  cursor.push(buf_.data(), buf_.length());
+  cursor.push(buf.data(), buf.length());
 
   sw_->sendNetworkControlPacketAsync(std::move(pkt), folly::none);
 }
 
-IPv6RouteAdvertiser::IPv6RouteAdvertiser(SwSwitch* sw,
-                                         const SwitchState* state,
-                                         const Interface* intf) {
-  adv_ = new IPv6RAImpl(sw, state, intf);
-  sw->getBackgroundEvb()->runInEventBaseThread(IPv6RAImpl::start, adv_);
+IPv6RouteAdvertiser::IPv6RouteAdvertiser(SwSwitch* sw)
+    : adv_(new IPv6RAImpl(sw)) {}
+
+IPv6RouteAdvertiser::~IPv6RouteAdvertiser() {
+  adv_->getSw()->getBackgroundEvb()->runInEventBaseThread(
+      IPv6RAImpl::stop, adv_);
 }
 
-IPv6RouteAdvertiser::IPv6RouteAdvertiser(IPv6RouteAdvertiser&& other) noexcept
-  : adv_(other.adv_) {
-    other.adv_ = nullptr;
+void IPv6RouteAdvertiser::setInterface(const Interface* intf) {
+  auto totalLength = getPacketSize(intf);
+  IOBuf buf(IOBuf::CREATE, totalLength);
+  buf.append(totalLength);
+  RWPrivateCursor cursor(&buf);
+  createAdvertisementPacket(
+    intf, &cursor, MacAddress("33:33:00:00:00:01"), IPAddressV6("ff02::1"));
+
+  std::chrono::milliseconds interval(
+      std::chrono::seconds(intf->getNdpConfig().routerAdvertisementSeconds));
+  auto* adv = adv_;
+  auto intfID = intf->getID();
+  adv_->getSw()->getBackgroundEvb()->runInEventBaseThread(
+      [adv, intfID, interval, buf = std::move(buf)]() mutable {
+        adv->setAdvertisement(intfID, interval, std::move(buf));
+      });
 }
 
-IPv6RouteAdvertiser::~IPv6RouteAdvertiser() {
-  if (!adv_) {
-    return;
-  }
+void IPv6RouteAdvertiser::removeInterface(InterfaceID intfID) {
+  auto* adv = adv_;
   adv_->getSw()->getBackgroundEvb()->runInEventBaseThread(
-      IPv6RAImpl::stop, adv_);
+      [adv, intfID]() { adv->removeAdvertisement(intfID); });
 }
 
-IPv6RouteAdvertiser& IPv6RouteAdvertiser::operator=(
-    IPv6RouteAdvertiser&& other) noexcept {
-  adv_ = other.adv_;
-  other.adv_ = nullptr;
-  return *this;
+/* static */ bool IPv6RouteAdvertiser::advertisementChanged(
+    const Interface* oldIntf,
+    const Interface* newIntf) {
+  return !(oldIntf->getNdpConfig() == newIntf->getNdpConfig()) ||
+      oldIntf->getAddresses() != newIntf->getAddresses() ||
+      oldIntf->getMac() != newIntf->getMac() ||
+      oldIntf->getMtu() != newIntf->getMtu() ||
+      oldIntf->getVlanID() != newIntf->getVlanID();
 }
 
 /* static */ uint32_t IPv6RouteAdvertiser::getPacketSize(
@@ -13,6 +13,8 @@
 #include <folly/io/Cursor.h>
 #include <folly/io/async/AsyncTimeout.h>
 
+#include "fboss/agent/types.h"
+
 namespace folly {
 
 class MacAddress;
@@ -29,21 +31,31 @@ class SwSwitch;
 
 /**
  * IPv6RouteAdvertiser takes care of periodically sending out IPv6 route
- * advertisement packets on an interface.
+ * advertisement packets on every interface that has them enabled.
  *
- * When you create an IPv6RouteAdvertiser object, it will begin sending out RA
- * packets at the interval specified in the interface's NdpConfig.  When you
- * destroy the IPv6RouteAdvertiser it will stop sending out RA packets.
+ * Each interface's RA packet is built once, when the interface is added, and
+ * only rebuilt when something the RA carries changes. A single timer in the
+ * background thread sends them all, with each interface's sends offset into
+ * its interval so that interfaces added together do not all send at once.
+ * When an interface is removed, or the IPv6RouteAdvertiser is destroyed, one
+ * last RA is sent for each interface removed.
  */
 class IPv6RouteAdvertiser {
  public:
-  IPv6RouteAdvertiser(SwSwitch* sw, const SwitchState* state,
-                      const Interface* intf);
+  explicit IPv6RouteAdvertiser(SwSwitch* sw);
   ~IPv6RouteAdvertiser();
 
-  // IPv6RouteAdvertiser objects are movable
-  IPv6RouteAdvertiser(IPv6RouteAdvertiser&& other) noexcept;
-  IPv6RouteAdvertiser& operator=(IPv6RouteAdvertiser&& other) noexcept;
+  /*
+   * Start sending RAs for intf, at the interval in its NdpConfig, or replace
+   * the RA being sent for it if it has one already.
+   */
+  void setInterface(const Interface* intf);
+  void removeInterface(InterfaceID intfID);
+
+  // Whether the RAs for these two versions of an interface differ
+  static bool advertisementChanged(
+      const Interface* oldIntf,
+      const Interface* newIntf);
 
   static uint32_t getPacketSize(const Interface* intf);
   static void createAdvertisementPacket(const Interface* intf,
@@ -52,14 +64,19 @@ class IPv6RouteAdvertiser {
                                         const folly::IPAddressV6& dstIP);
 
  private:
+  // Forbidden copy constructor and assignment operator
+  IPv6RouteAdvertiser(IPv6RouteAdvertiser const &) = delete;
+  IPv6RouteAdvertiser& operator=(IPv6RouteAdvertiser const &) = delete;
+
   /*
-   * All of the work is actually done by an IPv6RAImpl object.
+   * All of the work is actually done by an IPv6RAImpl object, in the
+   * background thread.
    *
    * The separation between IPv6RouteAdvertiser and IPv6RAImpl is primarily to
    * handle proper synchronization with the background thread when the
-   * IPv6RAImpl object is destroyed.  When the IPv6RAImpl is destroyed, the
-   * IPv6RAImpl still needs to remain around briefly until the timeout can be
-   * cancelled in the background thread.
+   * IPv6RouteAdvertiser is destroyed.  When the IPv6RouteAdvertiser is
+   * destroyed, the IPv6RAImpl still needs to remain around briefly until the
+   * timeout can be cancelled in the background thread.
    */
   IPv6RAImpl* adv_{nullptr};
 };
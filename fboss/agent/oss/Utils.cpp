@@ -11,11 +11,14 @@
 
 #include <folly/system/ThreadName.h>
 
+#include "fboss/agent/ThreadPlacement.h"
+
 namespace facebook {
 namespace fboss {
 
 void initThread(folly::StringPiece name) {
   folly::setThreadName(name);
+  thread_placement::apply(name);
 }
 } // namespace fboss
 } // namespace facebook
@@ -9,8 +9,11 @@
  */
 #include "fboss/agent/packet/ArpHdr.h"
 
+#include <folly/lang/Bits.h>
 #include <stdexcept>
 
+#include "fboss/agent/packet/PktUtil.h"
+
 namespace facebook { namespace fboss {
 
 using folly::IPAddressV4;
@@ -19,23 +22,20 @@ using folly::io::Cursor;
 
 ArpHdr::ArpHdr(Cursor& cursor) {
   try {
-    htype = cursor.readBE<uint16_t>();
-    ptype = cursor.readBE<uint16_t>();
-    hlen = cursor.read<uint8_t>();
-    plen = cursor.read<uint8_t>();
-    oper = cursor.readBE<uint16_t>();
-    uint8_t macAddress[6];
-    uint32_t ipAddress;
-    cursor.pull(&macAddress, 6);
+    uint8_t scratch[SIZE];
+    const auto* buf = PktUtil::pullHeader(&cursor, scratch, sizeof(scratch));
+    htype = PktUtil::loadBE<uint16_t>(&buf[0]);
+    ptype = PktUtil::loadBE<uint16_t>(&buf[2]);
+    hlen = buf[4];
+    plen = buf[5];
+    oper = PktUtil::loadBE<uint16_t>(&buf[6]);
     sha = MacAddress::fromBinary(
-      folly::ByteRange(&macAddress[0], MacAddress::SIZE));
-    cursor.pull(&ipAddress, 4);
-    spa = IPAddressV4::fromLong(ipAddress);
-    cursor.pull(&macAddress, 6);
+      folly::ByteRange(&buf[8], MacAddress::SIZE));
+    // IPAddressV4::fromLong() takes network byte order
+    spa = IPAddressV4::fromLong(folly::loadUnaligned<uint32_t>(&buf[14]));
     tha = MacAddress::fromBinary(
-      folly::ByteRange(&macAddress[0], MacAddress::SIZE));
-    cursor.pull(&ipAddress, 4);
-    tpa = IPAddressV4::fromLong(ipAddress);
+      folly::ByteRange(&buf[18], MacAddress::SIZE));
+    tpa = IPAddressV4::fromLong(folly::loadUnaligned<uint32_t>(&buf[24]));
   } catch (const std::out_of_range& e) {
     throw HdrParseError("ARP header too small");
   }
@@ -53,6 +53,8 @@ enum class ARP_OPER : uint16_t {
  */
 struct ArpHdr {
  public:
+  // For an Ethernet/IPv4 ARP message
+  enum { SIZE = 28 };
   /*
    * default constructor
    */
@@ -58,11 +58,12 @@ void DHCPv4Packet::parse(Cursor* cursor) {
       CHECK(dhcpCookie.size() == kOptionsCookieSize);
     }
     if (cursor->totalLength()) {
+      // Straight into options, with room for the relay agent option
+      auto origSize = options.size();
       auto optionsLen = cursor->totalLength();
-      uint8_t optionsRaw[optionsLen];
-      options.reserve(options.size() + optionsLen);
-      cursor->pullAtMost(optionsRaw, optionsLen);
-      copy(optionsRaw, optionsRaw + optionsLen, back_inserter(options));
+      options.reserve(origSize + optionsLen + kRelayOptionsReserve);
+      options.resize(origSize + optionsLen);
+      cursor->pull(&options[origSize], optionsLen);
     }
   } catch (std::out_of_range& e) {
     throw FbossError("Too small packet, "
@@ -89,12 +90,9 @@ size_t DHCPv4Packet::appendOption(uint8_t op, uint8_t len,
     options.push_back(op);
     return 1;
   }
-  auto origSize = options.size();
-  options.reserve(options.size() + 2 + len);
   options.push_back(op);
   options.push_back(len);
-  copy(bytes, bytes + len, std::back_inserter(options));
-  CHECK(options.size() == origSize + 2 + len);
+  options.insert(options.end(), bytes, bytes + len);
   return 2 + len;
 }
 
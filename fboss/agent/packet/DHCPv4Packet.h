@@ -33,6 +33,8 @@ struct DHCPv4Packet {
   enum : uint16_t { kFlagBroadcast = 0x8000 };
   enum : size_t { kFixedPartBytes = 236 };
   enum : size_t { kMinSize = 300 };
+  // Spare room parse() leaves in options, for an agent option and END
+  enum : size_t { kRelayOptionsReserve = 16 };
   static const uint8_t kOptionsCookie[kOptionsCookieSize];
 
   void parse(folly::io::Cursor* cursor);
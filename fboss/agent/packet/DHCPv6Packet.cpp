@@ -80,19 +80,12 @@ void DHCPv6Packet::addInterfaceIDOption(MacAddress macAddr) {
 */
 size_t DHCPv6Packet::appendOption(uint16_t op, uint16_t len,
     const uint8_t* bytes) {
-  IOBuf buf(IOBuf::CREATE, 4);
-  buf.append(4);
-  RWPrivateCursor cursor(&buf);
   // values in network byte order
-  cursor.writeBE<uint16_t>(op);
-  cursor.writeBE<uint16_t>(len);
-
-  auto origSize = options.size();
-  options.reserve(origSize + 4 + len);
-  copy(buf.data(), buf.data() + 4, std::back_inserter(options));
-  copy(bytes, bytes + len, std::back_inserter(options));
-
-  CHECK(options.size() == origSize + 4 + len);
+  options.push_back(op >> 8);
+  options.push_back(op & 0xff);
+  options.push_back(len >> 8);
+  options.push_back(len & 0xff);
+  options.insert(options.end(), bytes, bytes + len);
   return 4 + len;
 }
 
@@ -110,11 +103,10 @@ void DHCPv6Packet::parse(Cursor* cursor) {
       transactionId = (high << 16) + low;
     }
     if (cursor->totalLength()) {
+      auto origSize = options.size();
       auto optionsLen = cursor->totalLength();
-      uint8_t optionsRaw[optionsLen];
-      options.reserve(options.size() + optionsLen);
-      cursor->pullAtMost(optionsRaw, optionsLen);
-      copy(optionsRaw, optionsRaw + optionsLen, back_inserter(options));
+      options.resize(origSize + optionsLen);
+      cursor->pull(&options[origSize], optionsLen);
     }
   } catch (std::out_of_range& e) {
     throw FbossError("DHCPv6 packet parse error: too small packet");
@@ -60,6 +60,8 @@ struct DHCPv6Packet {
   enum { LINKADDR_BYTES = 16 };
   enum { PEERADDR_BYTES = 16 };
   enum { TRANSACTIONID_BYTES = 3 };
+  // option-code + option-len
+  enum { OPTION_HEADER_BYTES = 4 };
 
  public:
   DHCPv6Packet() {}
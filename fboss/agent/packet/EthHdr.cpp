@@ -12,6 +12,8 @@
 #include <stdexcept>
 #include <sstream>
 
+#include "fboss/agent/packet/PktUtil.h"
+
 namespace facebook { namespace fboss {
 
 using folly::MacAddress;
@@ -21,24 +23,21 @@ using std::stringstream;
 
 EthHdr::EthHdr(Cursor& cursor) {
   try {
-    uint8_t buf[14];
-    cursor.pull(buf, sizeof(buf));
+    uint8_t scratch[14];
+    const auto* buf = PktUtil::pullHeader(&cursor, scratch, sizeof(scratch));
     dstAddr = MacAddress::fromBinary(
       folly::ByteRange(&buf[0], MacAddress::SIZE));
     srcAddr = MacAddress::fromBinary(
       folly::ByteRange(&buf[6], MacAddress::SIZE));
-    etherType = (static_cast<uint16_t>(buf[12]) << 8)
-              |  static_cast<uint16_t>(buf[13]);
+    etherType = PktUtil::loadBE<uint16_t>(&buf[12]);
     // Look for VLAN tags.
     while (etherType == static_cast<uint16_t>(ETHERTYPE::ETHERTYPE_VLAN)
        ||  etherType == static_cast<uint16_t>(ETHERTYPE::ETHERTYPE_QINQ)) {
-      cursor.pull(buf, 4);
+      buf = PktUtil::pullHeader(&cursor, scratch, 4);
       uint32_t tag = (static_cast<uint32_t>(etherType) << 16)
-                   | (static_cast<uint32_t>(buf[0]) << 8)
-                   |  static_cast<uint32_t>(buf[1]);
+                   |  PktUtil::loadBE<uint16_t>(&buf[0]);
       vlanTags.push_back(VlanTag(tag));
-      etherType = (static_cast<uint16_t>(buf[2]) << 8)
-                |  static_cast<uint16_t>(buf[3]);
+      etherType = PktUtil::loadBE<uint16_t>(&buf[2]);
     }
   } catch (const std::out_of_range& e) {
     throw HdrParseError("Ethernet header too small");
@@ -32,9 +32,11 @@ using folly::io::RWPrivateCursor;
 
 ICMPHdr::ICMPHdr(Cursor& cursor) {
   try {
-    type = cursor.read<uint8_t>();
-    code = cursor.read<uint8_t>();
-    csum = cursor.readBE<uint16_t>();
+    uint8_t scratch[SIZE];
+    const auto* buf = PktUtil::pullHeader(&cursor, scratch, sizeof(scratch));
+    type = buf[0];
+    code = buf[1];
+    csum = PktUtil::loadBE<uint16_t>(&buf[2]);
   } catch (const std::out_of_range& e) {
     throw HdrParseError("ICMPv6 header too small");
   }
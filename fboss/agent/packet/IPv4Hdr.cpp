@@ -27,8 +27,9 @@ using folly::io::Appender;
 
 IPv4Hdr::IPv4Hdr(Cursor& cursor) {
   try {
-    uint8_t buf[12];
-    cursor.pull(buf, sizeof(buf));
+    // The header up to the options
+    uint8_t scratch[20];
+    const auto* buf = PktUtil::pullHeader(&cursor, scratch, sizeof(scratch));
     version = buf[0] >> 4;
     if (version != IPV4_VERSION) {
       throw HdrParseError("IPv4: version != 4");
@@ -39,13 +40,11 @@ IPv4Hdr::IPv4Hdr(Cursor& cursor) {
     }
     dscp = buf[1] >> 2;
     ecn = buf[1] & 0x03;
-    length = (static_cast<uint16_t>(buf[2]) << 8)
-           |  static_cast<uint16_t>(buf[3]);
+    length = PktUtil::loadBE<uint16_t>(&buf[2]);
     if (length < size()) {
       throw HdrParseError("IPv4: total length < ihl * 4");
     }
-    id = (static_cast<uint16_t>(buf[4]) << 8)
-       |  static_cast<uint16_t>(buf[5]);
+    id = PktUtil::loadBE<uint16_t>(&buf[4]);
     dontFragment = static_cast<bool>(buf[6] >> 6);
     moreFragments = static_cast<bool>((buf[6] & 0x20) >> 5);
     fragmentOffset = (static_cast<uint16_t>(buf[6] & 0x1F) << 8)
@@ -55,13 +54,10 @@ IPv4Hdr::IPv4Hdr(Cursor& cursor) {
       throw HdrParseError("IPv4: TTL == 0");
     }
     protocol = buf[9];
-    csum = (static_cast<uint16_t>(buf[10]) << 8)
-         |  static_cast<uint16_t>(buf[11]);
+    csum = PktUtil::loadBE<uint16_t>(&buf[10]);
     // TODO: check the checksum
-    uint32_t srcAddrRaw = cursor.readBE<uint32_t>();
-    uint32_t dstAddrRaw = cursor.readBE<uint32_t>();
-    srcAddr = IPAddressV4::fromLongHBO(srcAddrRaw);
-    dstAddr = IPAddressV4::fromLongHBO(dstAddrRaw);
+    srcAddr = IPAddressV4::fromLongHBO(PktUtil::loadBE<uint32_t>(&buf[12]));
+    dstAddr = IPAddressV4::fromLongHBO(PktUtil::loadBE<uint32_t>(&buf[16]));
 
     if (UNLIKELY(ihl > 5)) {
       cursor.pull(optionBuf, (ihl - 5) * sizeof(uint32_t));
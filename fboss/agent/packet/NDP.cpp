@@ -23,8 +23,10 @@ using folly::io::Cursor;
 
 NDPOptionHdr::NDPOptionHdr(folly::io::Cursor& cursor) {
   try {
-    type_ = cursor.read<uint8_t>();
-    length_ = cursor.read<uint8_t>();
+    uint8_t scratch[2];
+    const auto* buf = PktUtil::pullHeader(&cursor, scratch, sizeof(scratch));
+    type_ = buf[0];
+    length_ = buf[1];
   } catch (const std::out_of_range& e) {
     throw HdrParseError("NDP Option header is not present");
   }
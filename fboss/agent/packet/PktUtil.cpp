@@ -9,6 +9,7 @@
  */
 #include "fboss/agent/packet/PktUtil.h"
 
+#include <folly/lang/Bits.h>
 #include <folly/Format.h>
 #include <folly/IPAddressV4.h>
 #include <folly/IPAddressV6.h>
@@ -16,6 +17,14 @@
 #include <folly/io/Cursor.h>
 #include "fboss/agent/FbossError.h"
 
+#include <algorithm>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 using folly::IPAddressV4;
 using folly::IPAddressV6;
 using folly::MacAddress;
@@ -26,6 +35,85 @@ using folly::IOBuf;
 using folly::StringPiece;
 using std::string;
 
+namespace {
+
+// Fold a sum of 16 bit words into 16 bits, keeping its one's complement value
+uint16_t foldSum(uint64_t sum) {
+  sum = (sum & 0xffffffff) + (sum >> 32);
+  sum = (sum & 0xffffffff) + (sum >> 32);
+  sum = (sum & 0xffff) + (sum >> 16);
+  sum = (sum & 0xffff) + (sum >> 16);
+  sum = (sum & 0xffff) + (sum >> 16);
+  return static_cast<uint16_t>(sum);
+}
+
+/*
+ * The one's complement sum of the 16 bit words of [data, data + length), in
+ * host byte order.  RFC 1071 sums are byte order independent, so the words
+ * can be read natively and the result swapped once.  An odd last byte is
+ * padded with a zero, as the first byte of a word.
+ */
+uint64_t sumNative(const uint8_t* data, size_t length) {
+  uint64_t sum = 0;
+#if defined(__SSE2__)
+  // 16 bit words widened into four 32 bit lanes, two words per lane per
+  // block, so the lanes are flushed before they can overflow
+  constexpr size_t kBlocksPerFlush = 16384;
+  const __m128i zero = _mm_setzero_si128();
+  while (length >= 16) {
+    auto blocks = std::min(length / 16, kBlocksPerFlush);
+    __m128i acc = _mm_setzero_si128();
+    for (size_t i = 0; i < blocks; ++i) {
+      auto words =
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+      acc = _mm_add_epi32(acc, _mm_unpacklo_epi16(words, zero));
+      acc = _mm_add_epi32(acc, _mm_unpackhi_epi16(words, zero));
+      data += 16;
+    }
+    length -= blocks * 16;
+    alignas(16) uint32_t lanes[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+    sum += uint64_t(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+  }
+#elif defined(__ARM_NEON)
+  constexpr size_t kBlocksPerFlush = 16384;
+  while (length >= 16) {
+    auto blocks = std::min(length / 16, kBlocksPerFlush);
+    uint32x4_t acc = vdupq_n_u32(0);
+    for (size_t i = 0; i < blocks; ++i) {
+      acc = vpadalq_u16(acc, vld1q_u16(reinterpret_cast<const uint16_t*>(data)));
+      data += 16;
+    }
+    length -= blocks * 16;
+    sum += uint64_t(vgetq_lane_u32(acc, 0)) + vgetq_lane_u32(acc, 1) +
+        vgetq_lane_u32(acc, 2) + vgetq_lane_u32(acc, 3);
+  }
+#endif
+  // Whatever is left, or everything without SIMD, two words at a time
+  while (length >= 4) {
+    sum += folly::loadUnaligned<uint32_t>(data);
+    data += 4;
+    length -= 4;
+  }
+  if (length >= 2) {
+    sum += folly::loadUnaligned<uint16_t>(data);
+    data += 2;
+    length -= 2;
+  }
+  if (length) {
+    uint8_t last[2] = {*data, 0};
+    sum += folly::loadUnaligned<uint16_t>(last);
+  }
+  return sum;
+}
+
+// The sum of [data, data + length) as big endian 16 bit words
+uint16_t sumBigEndian(const uint8_t* data, size_t length) {
+  return folly::Endian::big(foldSum(sumNative(data, length)));
+}
+
+} // namespace
+
 namespace facebook { namespace fboss {
 
 MacAddress PktUtil::readMac(Cursor* cursor) {
@@ -42,6 +130,19 @@ MacAddress PktUtil::readMac(Cursor* cursor) {
   return MacAddress::fromBinary(folly::ByteRange(buf, MacAddress::SIZE));
 }
 
+const uint8_t*
+PktUtil::pullHeader(Cursor* cursor, uint8_t* scratch, size_t length) {
+  // Common case is that the header is contiguous
+  if (cursor->length() >= length) {
+    const auto* data = cursor->data();
+    cursor->skip(length);
+    return data;
+  }
+
+  cursor->pull(scratch, length);
+  return scratch;
+}
+
 IPAddressV4 PktUtil::readIPv4(Cursor* cursor) {
   // Note that IPAddressV4 accepts a network-byte order uint32_t,
   // so we use cursor->read() rather than cursor->readBE().
@@ -68,8 +169,7 @@ uint16_t PktUtil::internetChecksum(folly::io::Cursor start, uint64_t length) {
 }
 
 uint16_t PktUtil::internetChecksum(const uint8_t* buffer, uint32_t size) {
-  auto buf = IOBuf(IOBuf::WRAP_BUFFER, buffer, size);
-  return finalizeChecksum(Cursor(&buf), size, 0);
+  return finalizeChecksum(sumBigEndian(buffer, size));
 }
 
 uint16_t PktUtil::internetChecksum(const IOBuf* buf) {
@@ -79,20 +179,25 @@ uint16_t PktUtil::internetChecksum(const IOBuf* buf) {
 uint32_t PktUtil::partialChecksumImpl(folly::io::Cursor cursor,
                                       uint64_t length,
                                       uint32_t value) {
-  // Checksum all the pairs of bytes first
-  while  (length > 1) {
-    value += cursor.readBE<uint16_t>();
-    length -= 2;
-  }
-  if (length) {
-    // Bytes are interpreted in n/w byte order
-    // so this last octet represents the 8 MSbits
-    // of the last 16 bit number in this buffer.
-    uint16_t last = cursor.read<uint8_t>();
-    value += (last << 8);
-    --length;
+  // Sum each contiguous piece of the chain at once.  A piece that starts at
+  // an odd offset has its bytes in the other half of each word, which for a
+  // one's complement sum is the same as swapping the bytes of its sum.
+  uint64_t sum = value;
+  bool odd = false;
+  while (length > 0) {
+    auto piece = cursor.peekBytes();
+    if (piece.empty()) {
+      throw std::out_of_range("underflow computing checksum");
+    }
+    auto pieceLength = std::min<uint64_t>(piece.size(), length);
+    auto pieceSum = sumBigEndian(piece.data(), pieceLength);
+    sum += odd ? folly::Endian::swap(pieceSum) : pieceSum;
+    odd ^= (pieceLength & 1);
+    cursor.skip(pieceLength);
+    length -= pieceLength;
   }
-  return value;
+  // Callers may add more to the partial sum, so leave it room
+  return foldSum(sum);
 }
 
 uint32_t PktUtil::partialChecksum(folly::io::Cursor cursor,
@@ -109,6 +214,31 @@ uint16_t PktUtil::finalizeChecksum(folly::io::Cursor start,
   return finalizeChecksum(sum);
 }
 
+uint16_t PktUtil::updateChecksum(
+    uint16_t checksum,
+    uint16_t oldValue,
+    uint16_t newValue) {
+  // RFC 1624 equation 3: HC' = ~(~HC + ~m + m')
+  uint32_t sum = static_cast<uint16_t>(~checksum);
+  sum += static_cast<uint16_t>(~oldValue);
+  sum += newValue;
+  return finalizeChecksum(sum);
+}
+
+uint16_t PktUtil::updateChecksum(
+    uint16_t checksum,
+    uint32_t oldValue,
+    uint32_t newValue) {
+  checksum = updateChecksum(
+      checksum,
+      static_cast<uint16_t>(oldValue >> 16),
+      static_cast<uint16_t>(newValue >> 16));
+  return updateChecksum(
+      checksum,
+      static_cast<uint16_t>(oldValue & 0xffff),
+      static_cast<uint16_t>(newValue & 0xffff));
+}
+
 uint16_t PktUtil::finalizeChecksum(uint32_t sum) {
   // Add carry.
   while (sum >> 16) {
@@ -14,6 +14,7 @@
 #include <folly/MacAddress.h>
 #include <folly/IPAddressV4.h>
 #include <folly/IPAddressV6.h>
+#include <folly/lang/Bits.h>
 
 namespace folly {
 class IOBuf;
@@ -51,6 +52,29 @@ class PktUtil {
    */
   static folly::IPAddressV6 readIPv6(folly::io::Cursor* cursor);
 
+  /**
+   * Point at the next length bytes of the packet, and advance the cursor
+   * past them. Headers are nearly always contiguous, in which case this
+   * points into the packet's buffer; otherwise the bytes are copied to
+   * scratch, which must have room for length bytes.
+   *
+   * Header parsers use this to check the length of a header once, and then
+   * decode its fields from fixed offsets. Throws std::out_of_range, like
+   * Cursor::pull(), if fewer than length bytes are left.
+   */
+  static const uint8_t* pullHeader(
+      folly::io::Cursor* cursor,
+      uint8_t* scratch,
+      size_t length);
+
+  /**
+   * Load a big endian T from p, which need not be aligned.
+   */
+  template <typename T>
+  static T loadBE(const uint8_t* p) {
+    return folly::Endian::big(folly::loadUnaligned<T>(p));
+  }
+
   /*
    * Compute internet checksum (as defined in RFC 1071) over a sequence
    * of bytes. Code is as given in RFC 1071 section 4.1, with some
@@ -85,6 +109,21 @@ class PktUtil {
                                    uint32_t value);
   static uint16_t finalizeChecksum(uint32_t value);
 
+  /*
+   * The checksum after a 16 or 32 bit field covered by checksum changes from
+   * oldValue to newValue, as in RFC 1624, without summing the rest of the
+   * data again.  All values are in host byte order, and a 32 bit field must
+   * start at an even offset.
+   */
+  static uint16_t updateChecksum(
+      uint16_t checksum,
+      uint16_t oldValue,
+      uint16_t newValue);
+  static uint16_t updateChecksum(
+      uint16_t checksum,
+      uint32_t oldValue,
+      uint32_t newValue);
+
   /**
    * Return a string containing a human readable hex dump of the binary data.
    */
@@ -57,6 +57,23 @@ uint32_t FlowRecord::size() const {
   return 4 /* flowFormat */ + 4 /* flowDataLen */ + this->flowDataLen;
 }
 
+void CounterRecord::serialize(RWPrivateCursor* cursor) const {
+  serializeDataFormat(cursor, this->counterFormat);
+  // serialize XDR opaque sFlow counter_data
+  cursor->writeBE<uint32_t>(this->counterDataLen);
+  cursor->push(this->counterData, this->counterDataLen);
+  if (this->counterDataLen % XDR_BASIC_BLOCK_SIZE != 0) {
+    int fillCnt =
+        XDR_BASIC_BLOCK_SIZE - this->counterDataLen % XDR_BASIC_BLOCK_SIZE;
+    std::vector<byte> crud(XDR_BASIC_BLOCK_SIZE, 0);
+    cursor->push(crud.data(), fillCnt);
+  }
+}
+
+uint32_t CounterRecord::size() const {
+  return 4 /* counterFormat */ + 4 /* counterDataLen */ + this->counterDataLen;
+}
+
 void FlowSample::serialize(RWPrivateCursor* cursor) const {
   cursor->writeBE<uint32_t>(this->sequenceNumber);
   serializeSflowDataSource(cursor, this->sourceID);
@@ -79,6 +96,20 @@ uint32_t FlowSample::size(const uint32_t frecordsSize) const {
       4 /* flowRecordCnt */ + frecordsSize;
 }
 
+void CountersSample::serialize(RWPrivateCursor* cursor) const {
+  cursor->writeBE<uint32_t>(this->sequenceNumber);
+  serializeSflowDataSource(cursor, this->sourceID);
+  cursor->writeBE<uint32_t>(this->counterRecordsCnt);
+  for (int i = 0; i < this->counterRecordsCnt; i++) {
+    this->counterRecords[i].serialize(cursor);
+  }
+}
+
+uint32_t CountersSample::size(const uint32_t crecordsSize) const {
+  return 4 /* sequenceNumber */ + 4 /* sourceId */ +
+      4 /* counterRecordsCnt */ + crecordsSize;
+}
+
 void SampleRecord::serialize(RWPrivateCursor* cursor) const {
   serializeDataFormat(cursor, this->sampleType);
   cursor->writeBE<uint32_t>(this->sampleDataLen);
@@ -142,6 +173,33 @@ uint32_t SampledHeader::size() const {
       4 /* headerLength */ + this->headerLength;
 }
 
+void IfCounters::serialize(RWPrivateCursor* cursor) const {
+  cursor->writeBE<uint32_t>(this->ifIndex);
+  cursor->writeBE<uint32_t>(this->ifType);
+  cursor->writeBE<uint64_t>(this->ifSpeed);
+  cursor->writeBE<uint32_t>(this->ifDirection);
+  cursor->writeBE<uint32_t>(this->ifStatus);
+  cursor->writeBE<uint64_t>(this->ifInOctets);
+  cursor->writeBE<uint32_t>(this->ifInUcastPkts);
+  cursor->writeBE<uint32_t>(this->ifInMulticastPkts);
+  cursor->writeBE<uint32_t>(this->ifInBroadcastPkts);
+  cursor->writeBE<uint32_t>(this->ifInDiscards);
+  cursor->writeBE<uint32_t>(this->ifInErrors);
+  cursor->writeBE<uint32_t>(this->ifInUnknownProtos);
+  cursor->writeBE<uint64_t>(this->ifOutOctets);
+  cursor->writeBE<uint32_t>(this->ifOutUcastPkts);
+  cursor->writeBE<uint32_t>(this->ifOutMulticastPkts);
+  cursor->writeBE<uint32_t>(this->ifOutBroadcastPkts);
+  cursor->writeBE<uint32_t>(this->ifOutDiscards);
+  cursor->writeBE<uint32_t>(this->ifOutErrors);
+  cursor->writeBE<uint32_t>(this->ifPromiscuousMode);
+}
+
+uint32_t IfCounters::size() const {
+  return 3 * 8 /* ifSpeed, ifInOctets, ifOutOctets */ +
+      16 * 4 /* everything else */;
+}
+
 } // namespace sflow
 } // namespace fboss
 } // namespace facebook
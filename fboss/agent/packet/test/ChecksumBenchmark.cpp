@@ -0,0 +1,89 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/packet/PktUtil.h"
+
+#include <folly/Benchmark.h>
+#include <folly/Random.h>
+#include <folly/init/Init.h>
+#include <folly/io/Cursor.h>
+#include <folly/io/IOBuf.h>
+
+#include <vector>
+
+using namespace facebook::fboss;
+using folly::IOBuf;
+using folly::io::Cursor;
+
+namespace {
+
+std::vector<uint8_t> randomBytes(size_t size) {
+  std::vector<uint8_t> bytes(size);
+  for (auto& byte : bytes) {
+    byte = folly::Random::rand32(256);
+  }
+  return bytes;
+}
+
+// An IPv4 header, as IPv4Hdr::computeChecksum() sums it
+void sumContiguous(size_t iters, size_t size) {
+  std::vector<uint8_t> bytes;
+  BENCHMARK_SUSPEND {
+    bytes = randomBytes(size);
+  }
+  for (size_t i = 0; i < iters; ++i) {
+    folly::doNotOptimizeAway(
+        PktUtil::internetChecksum(bytes.data(), bytes.size()));
+  }
+}
+
+// A payload split at an odd offset, as ICMP and UDP packets are summed
+void sumChained(size_t iters, size_t size) {
+  std::unique_ptr<IOBuf> buf;
+  BENCHMARK_SUSPEND {
+    auto bytes = randomBytes(size);
+    buf = IOBuf::copyBuffer(bytes.data(), 7);
+    buf->appendChain(IOBuf::copyBuffer(bytes.data() + 7, size - 7));
+  }
+  for (size_t i = 0; i < iters; ++i) {
+    folly::doNotOptimizeAway(
+        PktUtil::finalizeChecksum(Cursor(buf.get()), size, 0));
+  }
+}
+
+} // namespace
+
+BENCHMARK_PARAM(sumContiguous, 20)
+BENCHMARK_PARAM(sumContiguous, 64)
+BENCHMARK_PARAM(sumContiguous, 576)
+BENCHMARK_PARAM(sumContiguous, 1500)
+BENCHMARK_PARAM(sumContiguous, 9000)
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK_PARAM(sumChained, 64)
+BENCHMARK_PARAM(sumChained, 1500)
+BENCHMARK_PARAM(sumChained, 9000)
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK(updateChecksum, iters) {
+  uint16_t csum = 0x1234;
+  for (size_t i = 0; i < iters; ++i) {
+    csum = PktUtil::updateChecksum(
+        csum, static_cast<uint16_t>(i), static_cast<uint16_t>(i + 1));
+  }
+  folly::doNotOptimizeAway(csum);
+}
+
+int main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  folly::runBenchmarks();
+  return 0;
+}
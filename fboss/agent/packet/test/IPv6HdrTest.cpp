@@ -112,6 +112,27 @@ TEST(IPv6HdrTest, cursor_data_constructor) {
   EXPECT_EQ(dstAddr, ipv6Hdr.dstAddr);
 }
 
+TEST(IPv6HdrTest, cursor_data_constructor_chained) {
+  IPAddressV6 srcAddr("2620:0:1cfe:face:b00c::3");
+  IPAddressV6 dstAddr("2620:0:1cfe:face:b00c::4");
+  IPv6Hdr hdr(srcAddr, dstAddr);
+  hdr.payloadLength = 8;
+  hdr.nextHeader = static_cast<uint8_t>(IP_PROTO::IP_PROTO_UDP);
+  hdr.hopLimit = 64;
+  folly::IOBuf buf(folly::IOBuf::CREATE, IPv6Hdr::SIZE);
+  buf.append(IPv6Hdr::SIZE);
+  folly::io::RWPrivateCursor writer(&buf);
+  hdr.serialize(&writer);
+
+  // Split the header in the middle of the source address
+  auto tail = folly::IOBuf::copyBuffer(buf.data() + 16, IPv6Hdr::SIZE - 16);
+  buf.trimEnd(IPv6Hdr::SIZE - 16);
+  buf.appendChain(std::move(tail));
+  Cursor cursor(&buf);
+  EXPECT_EQ(hdr, IPv6Hdr(cursor));
+  EXPECT_TRUE(cursor.isAtEnd());
+}
+
 TEST(IPv6HdrTest, parseBroadcast) {
   // Test a broadcast packet from a node with no IP to all nodes
   auto pkt = MockRxPacket::fromHex(
@@ -0,0 +1,151 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/packet/ArpHdr.h"
+#include "fboss/agent/packet/EthHdr.h"
+#include "fboss/agent/packet/ICMPHdr.h"
+#include "fboss/agent/packet/IPv4Hdr.h"
+#include "fboss/agent/packet/IPv6Hdr.h"
+#include "fboss/agent/packet/NDP.h"
+#include "fboss/agent/packet/PktUtil.h"
+
+#include <folly/Benchmark.h>
+#include <folly/init/Init.h>
+#include <folly/io/Cursor.h>
+#include <folly/io/IOBuf.h>
+
+using namespace facebook::fboss;
+using folly::IOBuf;
+using folly::io::Cursor;
+
+namespace {
+
+const char* kEthHdr =
+    // dst mac, src mac
+    "02 00 00 00 00 01  02 00 00 00 00 02"
+    // 802.1q, VLAN 1, IPv6
+    "81 00  00 01  86 dd";
+
+const char* kIPv4Hdr =
+    // version, IHL, DSCP, ECN, total length
+    "45  00  00 14"
+    // id, flags, fragment offset
+    "00 00  00 00"
+    // TTL, UDP, checksum
+    "40  11  00 00"
+    // 10.0.0.1 -> 10.0.0.2
+    "0a 00 00 01  0a 00 00 02";
+
+const char* kIPv6Hdr =
+    // version, traffic class, flow label
+    "60 00 00 00"
+    // payload length, UDP, hop limit
+    "00 00  11  40"
+    // 2401:db00::1 -> 2401:db00::2
+    "24 01 db 00 00 00 00 00  00 00 00 00 00 00 00 01"
+    "24 01 db 00 00 00 00 00  00 00 00 00 00 00 00 02";
+
+const char* kICMPHdr =
+    // neighbor advertisement, code, checksum
+    "88  00  12 34";
+
+const char* kArpHdr =
+    // ethernet, IPv4, hlen, plen, reply
+    "00 01  08 00  06  04  00 02"
+    // sender mac, sender ip
+    "02 00 00 00 00 02  0a 00 00 02"
+    // target mac, target ip
+    "02 00 00 00 00 01  0a 00 00 01";
+
+const char* kNDPOption =
+    // target link-layer address
+    "02  01  02 00 00 00 00 02";
+
+// The header in one buffer, which parsers decode in place
+IOBuf contiguous(const char* hex) {
+  return PktUtil::parseHexData(hex);
+}
+
+// The header split after its first byte, so parsers have to copy it out
+IOBuf chained(const char* hex) {
+  auto buf = PktUtil::parseHexData(hex);
+  auto tail = IOBuf::copyBuffer(buf.data() + 1, buf.length() - 1);
+  buf.trimEnd(buf.length() - 1);
+  buf.appendChain(std::move(tail));
+  return buf;
+}
+
+template <typename HdrT>
+void parse(size_t iters, IOBuf (*makeBuf)(const char*), const char* hex) {
+  IOBuf buf;
+  BENCHMARK_SUSPEND {
+    buf = makeBuf(hex);
+  }
+  for (size_t i = 0; i < iters; ++i) {
+    Cursor cursor(&buf);
+    HdrT hdr(cursor);
+    folly::doNotOptimizeAway(hdr);
+  }
+}
+
+} // namespace
+
+BENCHMARK(ethHdrChained, iters) {
+  parse<EthHdr>(iters, chained, kEthHdr);
+}
+
+BENCHMARK_RELATIVE(ethHdrContiguous, iters) {
+  parse<EthHdr>(iters, contiguous, kEthHdr);
+}
+
+BENCHMARK(ipv4HdrChained, iters) {
+  parse<IPv4Hdr>(iters, chained, kIPv4Hdr);
+}
+
+BENCHMARK_RELATIVE(ipv4HdrContiguous, iters) {
+  parse<IPv4Hdr>(iters, contiguous, kIPv4Hdr);
+}
+
+BENCHMARK(ipv6HdrChained, iters) {
+  parse<IPv6Hdr>(iters, chained, kIPv6Hdr);
+}
+
+BENCHMARK_RELATIVE(ipv6HdrContiguous, iters) {
+  parse<IPv6Hdr>(iters, contiguous, kIPv6Hdr);
+}
+
+BENCHMARK(icmpHdrChained, iters) {
+  parse<ICMPHdr>(iters, chained, kICMPHdr);
+}
+
+BENCHMARK_RELATIVE(icmpHdrContiguous, iters) {
+  parse<ICMPHdr>(iters, contiguous, kICMPHdr);
+}
+
+BENCHMARK(arpHdrChained, iters) {
+  parse<ArpHdr>(iters, chained, kArpHdr);
+}
+
+BENCHMARK_RELATIVE(arpHdrContiguous, iters) {
+  parse<ArpHdr>(iters, contiguous, kArpHdr);
+}
+
+BENCHMARK(ndpOptionHdrChained, iters) {
+  parse<NDPOptionHdr>(iters, chained, kNDPOption);
+}
+
+BENCHMARK_RELATIVE(ndpOptionHdrContiguous, iters) {
+  parse<NDPOptionHdr>(iters, contiguous, kNDPOption);
+}
+
+int main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  folly::runBenchmarks();
+  return 0;
+}
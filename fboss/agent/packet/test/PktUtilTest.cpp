@@ -118,6 +118,28 @@ TEST(PktUtilTest, ReadIPv6) {
   EXPECT_THROW(PktUtil::readIPv6(&c), std::out_of_range);
 }
 
+TEST(PktUtilTest, PullHeader) {
+  auto buf = setupBuf();
+  uint8_t scratch[8];
+
+  // A contiguous header is used in place
+  Cursor c(&buf);
+  EXPECT_EQ(buf.data(), PktUtil::pullHeader(&c, scratch, 8));
+  EXPECT_EQ(Cursor(&buf) + 8, c);
+
+  // One that spans two buffers is copied out
+  c = Cursor(&buf) + 16;
+  const auto* header = PktUtil::pullHeader(&c, scratch, 8);
+  EXPECT_EQ(scratch, header);
+  EXPECT_EQ(0, memcmp("\x17\x18\x19\x1a\x21\x22\x23\x24", header, 8));
+  EXPECT_EQ(Cursor(&buf) + 24, c);
+  EXPECT_EQ(0x2526, PktUtil::loadBE<uint16_t>(c.data()));
+
+  // Test parsing when the buffer is too short to contain the header
+  c = Cursor(&buf) + 36;
+  EXPECT_THROW(PktUtil::pullHeader(&c, scratch, 8), std::out_of_range);
+}
+
 TEST(PktUtilTest, HexDump) {
   size_t length = 64;
   IOBuf buf(IOBuf::CREATE, length);
@@ -213,3 +235,49 @@ TEST(Checksum, TestKnownOdd) {
   expected = ~expected;
   EXPECT_EQ(expected, PktUtil::internetChecksum(bytes, 9));
 }
+
+TEST(Checksum, TestChained) {
+  // The same sum whichever way the bytes are split, including at odd offsets
+  uint8_t bytes[1500];
+  for (auto& byte : bytes) {
+    byte = Random::rand32(std::numeric_limits<uint8_t>::max());
+  }
+  auto expected = PktUtil::internetChecksum(bytes, sizeof(bytes));
+  for (auto split : {1, 2, 3, 17, 64, 749, 1499}) {
+    auto buf = IOBuf::copyBuffer(bytes, split);
+    buf->appendChain(IOBuf::copyBuffer(bytes + split, sizeof(bytes) - split));
+    EXPECT_EQ(
+        expected, PktUtil::finalizeChecksum(Cursor(buf.get()), sizeof(bytes), 0))
+        << "split at " << split;
+  }
+
+  // And when summing starts inside a buffer
+  auto buf = IOBuf::copyBuffer(bytes, sizeof(bytes));
+  EXPECT_EQ(
+      PktUtil::internetChecksum(bytes + 5, 100),
+      PktUtil::finalizeChecksum(Cursor(buf.get()) + 5, 100, 0));
+}
+
+TEST(Checksum, TestUpdate) {
+  uint8_t bytes[20] = {0x45, 0x00, 0x00, 0x73, 0x00, 0x00, 0x40, 0x00,
+                       0x40, 0x11, 0x00, 0x00, 0xc0, 0xa8, 0x00, 0x01,
+                       0xc0, 0xa8, 0x00, 0xc7};
+  auto csum = PktUtil::internetChecksum(bytes, sizeof(bytes));
+
+  // Decrement the TTL, the high byte of the TTL/protocol word
+  uint16_t oldWord = (bytes[8] << 8) | bytes[9];
+  --bytes[8];
+  uint16_t newWord = (bytes[8] << 8) | bytes[9];
+  csum = PktUtil::updateChecksum(csum, oldWord, newWord);
+  EXPECT_EQ(PktUtil::internetChecksum(bytes, sizeof(bytes)), csum);
+
+  // Rewrite the destination to 10.1.2.3
+  uint32_t oldAddr = 0xc0a800c7;
+  uint32_t newAddr = 0x0a010203;
+  bytes[16] = 0x0a;
+  bytes[17] = 0x01;
+  bytes[18] = 0x02;
+  bytes[19] = 0x03;
+  csum = PktUtil::updateChecksum(csum, oldAddr, newAddr);
+  EXPECT_EQ(PktUtil::internetChecksum(bytes, sizeof(bytes)), csum);
+}
@@ -129,3 +129,67 @@ TEST(SflowStructsTest, Serialize) {
     EXPECT_EQ(b.at(i), data[i]);
   }
 }
+
+TEST(SflowStructsTest, CountersSample) {
+  constexpr size_t bufSize = 256;
+
+  sflow::IfCounters counters{};
+  counters.ifIndex = 7;
+  counters.ifType = 6; // ethernetCsmacd
+  counters.ifSpeed = 100000000000;
+  counters.ifDirection = 1; // full duplex
+  counters.ifStatus = 3; // admin and oper up
+  counters.ifInOctets = 0x100000000;
+  counters.ifInUcastPkts = 5;
+  counters.ifOutOctets = 42;
+  counters.ifOutErrors = 1;
+  EXPECT_EQ(88, counters.size());
+
+  std::vector<uint8_t> cb(bufSize);
+  auto cbuf = folly::IOBuf::wrapBuffer(cb.data(), bufSize);
+  auto cc = std::make_shared<folly::io::RWPrivateCursor>(cbuf.get());
+  counters.serialize(cc.get());
+  EXPECT_EQ(88, bufSize - cc->length());
+
+  sflow::CounterRecord crecord;
+  crecord.counterFormat = 1; // generic interface counters
+  crecord.counterDataLen = counters.size();
+  crecord.counterData = cb.data();
+  EXPECT_EQ(96, crecord.size());
+
+  sflow::CountersSample csample;
+  csample.sequenceNumber = 3;
+  csample.sourceID = 7;
+  csample.counterRecordsCnt = 1;
+  csample.counterRecords = &crecord;
+  EXPECT_EQ(108, csample.size(crecord.size()));
+
+  std::vector<uint8_t> b(bufSize);
+  auto buf = folly::IOBuf::wrapBuffer(b.data(), bufSize);
+  auto cursor = std::make_shared<folly::io::RWPrivateCursor>(buf.get());
+  csample.serialize(cursor.get());
+  size_t csampleSize = bufSize - cursor->length();
+  EXPECT_EQ(108, csampleSize);
+
+  constexpr auto data = folly::make_array<uint8_t>(
+      0x00, 0x00, 0x00, 0x03, // seq no.
+      0x00, 0x00, 0x00, 0x07, // source ID
+      0x00, 0x00, 0x00, 0x01, // record cnt
+      0x00, 0x00, 0x00, 0x01, // counter format
+      0x00, 0x00, 0x00, 0x58, // counter data size
+      0x00, 0x00, 0x00, 0x07, // ifIndex
+      0x00, 0x00, 0x00, 0x06, // ifType
+      0x00, 0x00, 0x00, 0x17, 0x48, 0x76, 0xe8, 0x00, // ifSpeed
+      0x00, 0x00, 0x00, 0x01, // ifDirection
+      0x00, 0x00, 0x00, 0x03, // ifStatus
+      0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, // ifInOctets
+      0x00, 0x00, 0x00, 0x05); // ifInUcastPkts
+
+  for (int i = 0; i < data.size(); ++i) {
+    EXPECT_EQ(b.at(i), data[i]);
+  }
+  // ifOutOctets is 56 bytes into the counter data
+  EXPECT_EQ(42, b.at(20 + 56 + 7));
+  // ifOutErrors, just before ifPromiscuousMode at the very end
+  EXPECT_EQ(1, b.at(csampleSize - 5));
+}
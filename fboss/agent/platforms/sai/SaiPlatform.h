@@ -38,6 +38,15 @@ class SaiPlatform : public Platform {
     return nullptr;
   }
 
+  /*
+   * Whether the adapter can take calls for objects of different types from
+   * different threads at once. If so, SaiSwitch programs the parts of a
+   * state delta that share no objects concurrently.
+   */
+  virtual bool supportsConcurrentSaiApiCalls() const {
+    return false;
+  }
+
  private:
   void initImpl() override;
   std::unique_ptr<SaiSwitch> saiSwitch_;
@@ -23,6 +23,7 @@ ConfigApplier::ConfigApplier(
     RouterID vrf,
     IPv4NetworkToRouteMap* v4NetworkToRoute,
     IPv6NetworkToRouteMap* v6NetworkToRoute,
+    NextHopDependencyIndex* nextHopDependencies,
     folly::Range<DirectlyConnectedRouteIterator> directlyConnectedRouteRange,
     folly::Range<StaticRouteNoNextHopsIterator> staticCpuRouteRange,
     folly::Range<StaticRouteNoNextHopsIterator> staticDropRouteRange,
@@ -32,6 +33,7 @@ ConfigApplier::ConfigApplier(
     : vrf_(vrf),
       v4NetworkToRoute_(v4NetworkToRoute),
       v6NetworkToRoute_(v6NetworkToRoute),
+      nextHopDependencies_(nextHopDependencies),
       directlyConnectedRouteRange_(directlyConnectedRouteRange),
       staticCpuRouteRange_(staticCpuRouteRange),
       staticDropRouteRange_(staticDropRouteRange),
@@ -40,10 +42,12 @@ ConfigApplier::ConfigApplier(
       cookie_(cookie) {
   CHECK_NOTNULL(v4NetworkToRoute_);
   CHECK_NOTNULL(v6NetworkToRoute_);
+  CHECK_NOTNULL(nextHopDependencies_);
 }
 
 void ConfigApplier::updateRibAndFib() {
-  RouteUpdater updater(v4NetworkToRoute_, v6NetworkToRoute_);
+  RouteUpdater updater(
+      v4NetworkToRoute_, v6NetworkToRoute_, nextHopDependencies_);
 
   // Enable ALPM
   updater.addRoute(
@@ -111,7 +115,14 @@ void ConfigApplier::updateRibAndFib() {
   // Trigger recrusive resolution
   updater.updateDone();
 
-  fibUpdateCallback_(vrf_, *v4NetworkToRoute_, *v6NetworkToRoute_, cookie_);
+  // The FIB is rebuilt from scratch on reconfiguration: it may have been
+  // restored from a warm boot state that the RIB knows nothing about.
+  fibUpdateCallback_(
+      vrf_,
+      *v4NetworkToRoute_,
+      *v6NetworkToRoute_,
+      nullptr /* changedPrefixes */,
+      cookie_);
 }
 
 void ConfigApplier::addInterfaceRoutes(
@@ -19,6 +19,7 @@
 
 #include "fboss/agent/gen-cpp2/switch_config_types.h"
 #include "fboss/agent/rib/NetworkToRouteMap.h"
+#include "fboss/agent/rib/NextHopDependencyIndex.h"
 #include "fboss/agent/rib/RoutingInformationBase.h"
 #include "fboss/agent/types.h"
 
@@ -48,6 +49,7 @@ class ConfigApplier {
       RouterID vrf,
       IPv4NetworkToRouteMap* v4RouteTable,
       IPv6NetworkToRouteMap* v6RouteTable,
+      NextHopDependencyIndex* nextHopDependencies,
       folly::Range<DirectlyConnectedRouteIterator> directlyConnectedRouteRange,
       folly::Range<StaticRouteNoNextHopsIterator> staticCpuRouteRange,
       folly::Range<StaticRouteNoNextHopsIterator> staticDropRouteRange,
@@ -66,6 +68,7 @@ class ConfigApplier {
   RouterID vrf_;
   IPv4NetworkToRouteMap* v4NetworkToRoute_;
   IPv6NetworkToRouteMap* v6NetworkToRoute_;
+  NextHopDependencyIndex* nextHopDependencies_;
   folly::Range<DirectlyConnectedRouteIterator> directlyConnectedRouteRange_;
   folly::Range<StaticRouteNoNextHopsIterator> staticCpuRouteRange_;
   folly::Range<StaticRouteNoNextHopsIterator> staticDropRouteRange_;
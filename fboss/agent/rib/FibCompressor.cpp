@@ -0,0 +1,352 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/rib/FibCompressor.h"
+
+#include <folly/IPAddressV4.h>
+#include <folly/IPAddressV6.h>
+#include <folly/Range.h>
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <iterator>
+#include <tuple>
+
+namespace facebook {
+namespace fboss {
+namespace rib {
+
+namespace {
+
+template <typename Bytes>
+int bitAt(const Bytes& bytes, uint8_t bit) {
+  return (bytes[bit / 8] >> (7 - bit % 8)) & 1;
+}
+
+} // namespace
+
+template <typename AddrT>
+constexpr uint8_t FibCompressor<AddrT>::kMaxMask;
+
+template <typename AddrT>
+bool FibCompressor<AddrT>::ForwardingKey::operator<(
+    const ForwardingKey& other) const {
+  return std::tie(action, nhops, connected) <
+      std::tie(other.action, other.nhops, other.connected);
+}
+
+template <typename AddrT>
+FibCompressor<AddrT>::FibCompressor() {
+  // Id 0 is no route
+  forwardings_.emplace_back();
+}
+
+template <typename AddrT>
+FibCompressor<AddrT>::~FibCompressor() {}
+
+template <typename AddrT>
+void FibCompressor<AddrT>::update(
+    const RoutePtr& oldRoute,
+    const RoutePtr& newRoute) {
+  const auto& route = newRoute ? newRoute : oldRoute;
+  CHECK(route);
+  auto network = route->prefix().network.toByteArray();
+  auto mask = route->prefix().mask;
+
+  Node* node = &root_;
+  node->dirty = true;
+  for (uint8_t bit = 0; bit < mask; ++bit) {
+    auto& child = node->children[bitAt(network, bit)];
+    if (!child) {
+      child = std::make_unique<Node>();
+    }
+    node = child.get();
+    node->dirty = true;
+  }
+
+  ForwardingId id = 0;
+  if (newRoute && newRoute->isResolved()) {
+    id = intern(*newRoute);
+  }
+  if (node->route) {
+    unref(node->route);
+    --numRoutes_;
+  }
+  node->route = id;
+  if (id) {
+    ++numRoutes_;
+  }
+}
+
+template <typename AddrT>
+typename FibCompressor<AddrT>::Changes FibCompressor<AddrT>::flush() {
+  Bytes network{};
+  computeChoices(&root_, 0, network, 0);
+  select(&root_, 0, network, 0);
+
+  Changes changes;
+  for (const auto& entry : pending_) {
+    const auto& prefix = entry.first;
+    auto before = entry.second.first;
+    auto after = entry.second.second;
+    if (before == after) {
+      // Changed and changed back
+    } else if (!after) {
+      changes.removed.push_back(makeRoute(prefix, before));
+    } else if (!before) {
+      changes.addedChanged.emplace_back(nullptr, makeRoute(prefix, after));
+    } else {
+      changes.addedChanged.emplace_back(
+          makeRoute(prefix, before), makeRoute(prefix, after));
+    }
+    unref(before);
+  }
+  pending_.clear();
+  freeIds_.insert(freeIds_.end(), releasedIds_.begin(), releasedIds_.end());
+  releasedIds_.clear();
+  return changes;
+}
+
+template <typename AddrT>
+typename FibCompressor<AddrT>::ForwardingId FibCompressor<AddrT>::intern(
+    const facebook::fboss::Route<AddrT>& route) {
+  const auto& fwd = route.getForwardInfo();
+  ForwardingKey key{fwd.getAction(), fwd.getNextHopSet(), route.isConnected()};
+  auto it = forwardingIds_.find(key);
+  if (it != forwardingIds_.end()) {
+    ref(it->second);
+    return it->second;
+  }
+
+  ForwardingId id;
+  if (!freeIds_.empty()) {
+    id = freeIds_.back();
+    freeIds_.pop_back();
+  } else {
+    id = forwardings_.size();
+    forwardings_.emplace_back();
+  }
+  auto& forwarding = forwardings_[id];
+  forwarding.key = forwardingIds_.emplace(std::move(key), id).first;
+  forwarding.fwd = fwd;
+  forwarding.connected = route.isConnected();
+  forwarding.refs = 1;
+  return id;
+}
+
+template <typename AddrT>
+void FibCompressor<AddrT>::ref(ForwardingId id) {
+  if (id) {
+    ++forwardings_[id].refs;
+  }
+}
+
+template <typename AddrT>
+void FibCompressor<AddrT>::unref(ForwardingId id) {
+  if (!id) {
+    return;
+  }
+  auto& forwarding = forwardings_[id];
+  CHECK_GT(forwarding.refs, 0);
+  if (--forwarding.refs == 0) {
+    forwardingIds_.erase(forwarding.key);
+    releasedIds_.push_back(id);
+  }
+}
+
+template <typename AddrT>
+typename FibCompressor<AddrT>::RoutePtr FibCompressor<AddrT>::makeRoute(
+    const Prefix& prefix,
+    ForwardingId id) const {
+  const auto& forwarding = forwardings_[id];
+  auto route = std::make_shared<facebook::fboss::Route<AddrT>>(prefix);
+  route->setResolved(forwarding.fwd);
+  if (forwarding.connected) {
+    route->setConnected();
+  }
+  return route;
+}
+
+template <typename AddrT>
+typename FibCompressor<AddrT>::Prefix FibCompressor<AddrT>::toPrefix(
+    const Bytes& network,
+    uint8_t mask) {
+  return Prefix{
+      AddrT::fromBinary(folly::ByteRange(network.data(), network.size())),
+      mask};
+}
+
+template <typename AddrT>
+typename FibCompressor<AddrT>::Bytes FibCompressor<AddrT>::childNetwork(
+    const Bytes& network,
+    uint8_t mask,
+    int side) {
+  auto child = network;
+  if (side) {
+    child[mask / 8] |= 0x80 >> (mask % 8);
+  }
+  return child;
+}
+
+template <typename AddrT>
+const typename FibCompressor<AddrT>::ForwardingSet&
+FibCompressor<AddrT>::computeChoices(
+    Node* node,
+    ForwardingId inherited,
+    const Bytes& network,
+    uint8_t mask) {
+  // What this subtree forwards with where nothing below overrides it
+  auto below = node->route ? node->route : inherited;
+  if (!node->dirty && node->choicesInherited == below) {
+    return node->choices;
+  }
+
+  if (mask == kMaxMask) {
+    node->choices = {below};
+    node->choicesInherited = below;
+    node->dirty = false;
+    node->reselect = true;
+    return node->choices;
+  }
+
+  ForwardingSet sides[2];
+  for (int side = 0; side < 2; ++side) {
+    auto& child = node->children[side];
+    if (!child) {
+      // A missing child is a leaf forwarding like this node
+      sides[side] = {below};
+      continue;
+    }
+    auto childNet = childNetwork(network, mask, side);
+    sides[side] = computeChoices(child.get(), below, childNet, mask + 1);
+    if (child->isEmptyLeaf()) {
+      // Left behind by a removed route
+      prune(child.get(), childNet, mask + 1);
+      child.reset();
+    }
+  }
+
+  ForwardingSet choices;
+  std::set_intersection(
+      sides[0].begin(),
+      sides[0].end(),
+      sides[1].begin(),
+      sides[1].end(),
+      std::back_inserter(choices));
+  if (choices.empty()) {
+    // Choice sets holding no route are always exactly {0}, as a covering
+    // entry can't stand in for the missing route
+    if (sides[0].front() == 0 || sides[1].front() == 0) {
+      choices = {0};
+    } else {
+      std::set_union(
+          sides[0].begin(),
+          sides[0].end(),
+          sides[1].begin(),
+          sides[1].end(),
+          std::back_inserter(choices));
+    }
+  }
+  node->choices = std::move(choices);
+  node->choicesInherited = below;
+  node->dirty = false;
+  node->reselect = true;
+  return node->choices;
+}
+
+template <typename AddrT>
+void FibCompressor<AddrT>::select(
+    Node* node,
+    ForwardingId parentSelected,
+    const Bytes& network,
+    uint8_t mask) {
+  if (!node->reselect && node->selectedParent == parentSelected) {
+    return;
+  }
+
+  const auto& choices = node->choices;
+  auto selected = parentSelected;
+  if (!std::binary_search(choices.begin(), choices.end(), parentSelected)) {
+    selected = choices.front();
+    CHECK(selected) << "no route below a compressed entry";
+  }
+  setEntry(
+      &node->entry, network, mask, selected != parentSelected ? selected : 0);
+
+  auto below = node->choicesInherited;
+  for (int side = 0; mask < kMaxMask && side < 2; ++side) {
+    auto childNet = childNetwork(network, mask, side);
+    if (node->children[side]) {
+      // The child took over its prefix from this node
+      setEntry(&node->childEntries[side], childNet, mask + 1, 0);
+      select(node->children[side].get(), selected, childNet, mask + 1);
+    } else {
+      setEntry(
+          &node->childEntries[side],
+          childNet,
+          mask + 1,
+          below != selected ? below : 0);
+    }
+  }
+
+  node->selected = selected;
+  node->selectedParent = parentSelected;
+  node->reselect = false;
+}
+
+template <typename AddrT>
+void FibCompressor<AddrT>::setEntry(
+    ForwardingId* entry,
+    const Bytes& network,
+    uint8_t mask,
+    ForwardingId id) {
+  if (*entry == id) {
+    return;
+  }
+  auto prefix = toPrefix(network, mask);
+  auto it = pending_.find(prefix);
+  if (it == pending_.end()) {
+    // Keep what was programmed until the change is returned by flush()
+    ref(*entry);
+    pending_.emplace(prefix, std::make_pair(*entry, id));
+  } else {
+    it->second.second = id;
+  }
+  if (*entry) {
+    --numEntries_;
+  }
+  if (id) {
+    ++numEntries_;
+  }
+  ref(id);
+  unref(*entry);
+  *entry = id;
+}
+
+template <typename AddrT>
+void FibCompressor<AddrT>::prune(
+    Node* node,
+    const Bytes& network,
+    uint8_t mask) {
+  setEntry(&node->entry, network, mask, 0);
+  for (int side = 0; mask < kMaxMask && side < 2; ++side) {
+    setEntry(
+        &node->childEntries[side],
+        childNetwork(network, mask, side),
+        mask + 1,
+        0);
+  }
+}
+
+template class FibCompressor<folly::IPAddressV4>;
+template class FibCompressor<folly::IPAddressV6>;
+
+} // namespace rib
+} // namespace fboss
+} // namespace facebook
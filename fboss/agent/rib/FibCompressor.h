@@ -0,0 +1,178 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include "fboss/agent/state/Route.h"
+#include "fboss/agent/state/RouteNextHopEntry.h"
+#include "fboss/agent/state/RouteTypes.h"
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace facebook {
+namespace fboss {
+namespace rib {
+
+/*
+ * FibCompressor keeps the smallest set of prefixes that forwards exactly like
+ * the routes of one FIB, for programming into hardware in place of the FIB.
+ * Adjacent prefixes that share their next hops are merged under a covering
+ * prefix, and more specifics that forward like the prefix covering them are
+ * left out.
+ *
+ * The set is found with ORTC (Draves et al., "Constructing Optimal IP Routing
+ * Tables"), run over a binary trie of the routes:
+ *  - bottom up, each trie node gets the forwarding choices that need the
+ *    fewest entries below it: the intersection of its children's choices if
+ *    not empty, their union otherwise. Parts of the address space with no
+ *    route can't be expressed as an entry, so a node covering one only gets
+ *    "no route" as a choice, and a covering prefix never takes its place.
+ *  - top down, a node keeps what it inherited from its parent if that is one
+ *    of its choices, and otherwise gets an entry for one of them.
+ *
+ * Routes forward the same when they have the same action, next hops and
+ * connected flag. Compressed routes take their forwarding from any one of the
+ * routes they stand for, so admin distance and the like are not retained.
+ *
+ * Updates are incremental: only the trie nodes on the path to a changed route,
+ * and the parts of its subtree that inherit from it, are recomputed, and
+ * flush() returns just the entries that changed since the last flush.
+ */
+template <typename AddrT>
+class FibCompressor {
+ public:
+  using RoutePtr = std::shared_ptr<facebook::fboss::Route<AddrT>>;
+  using Prefix = facebook::fboss::RoutePrefix<AddrT>;
+
+  struct Changes {
+    std::vector<RoutePtr> removed;
+    // (old, new) pairs, old being null for added entries
+    std::vector<std::pair<RoutePtr, RoutePtr>> addedChanged;
+  };
+
+  FibCompressor();
+  ~FibCompressor();
+
+  /*
+   * Apply a FIB route change: oldRoute is null for an added route, newRoute
+   * is null for a removed one. Unresolved routes count as removed.
+   */
+  void update(const RoutePtr& oldRoute, const RoutePtr& newRoute);
+
+  /*
+   * Recompute the compressed set and return how it changed since the last
+   * flush. The changes are assumed to be programmed.
+   */
+  Changes flush();
+
+  // Routes in the FIB
+  size_t numRoutes() const {
+    return numRoutes_;
+  }
+  // Entries in the compressed set
+  size_t numEntries() const {
+    return numEntries_;
+  }
+
+ private:
+  // Forbidden copy constructor and assignment operator
+  FibCompressor(FibCompressor const&) = delete;
+  FibCompressor& operator=(FibCompressor const&) = delete;
+
+  // Forwarding ids: 0 is no route, others index forwardings_
+  using ForwardingId = uint32_t;
+  using ForwardingSet = std::vector<ForwardingId>;
+  using Bytes = typename AddrT::ByteArray;
+  static constexpr uint8_t kMaxMask = sizeof(Bytes) * 8;
+
+  struct ForwardingKey {
+    RouteForwardAction action;
+    RouteNextHopEntry::NextHopSet nhops;
+    bool connected;
+
+    bool operator<(const ForwardingKey& other) const;
+  };
+  struct Forwarding {
+    typename std::map<ForwardingKey, ForwardingId>::iterator key;
+    RouteNextHopEntry fwd{RouteForwardAction::DROP,
+                          AdminDistance::MAX_ADMIN_DISTANCE};
+    bool connected{false};
+    // Trie nodes, entries and pending changes using this forwarding
+    uint32_t refs{0};
+  };
+
+  struct Node {
+    std::unique_ptr<Node> children[2];
+    // The route at this prefix, if any
+    ForwardingId route{0};
+    // Bottom up pass: choices for this subtree, and what was inherited from
+    // above when they were computed
+    ForwardingSet choices;
+    ForwardingId choicesInherited{0};
+    bool dirty{true};
+    // Top down pass: what this node forwards with, and what its parent
+    // forwarded with at the time
+    ForwardingId selected{0};
+    ForwardingId selectedParent{0};
+    bool reselect{true};
+    // Entries in the compressed set for this prefix, and for each missing
+    // child's prefix
+    ForwardingId entry{0};
+    ForwardingId childEntries[2]{0, 0};
+
+    bool isEmptyLeaf() const {
+      return !route && !children[0] && !children[1];
+    }
+  };
+
+  ForwardingId intern(const facebook::fboss::Route<AddrT>& route);
+  void ref(ForwardingId id);
+  void unref(ForwardingId id);
+  RoutePtr makeRoute(const Prefix& prefix, ForwardingId id) const;
+
+  static Prefix toPrefix(const Bytes& network, uint8_t mask);
+  static Bytes childNetwork(const Bytes& network, uint8_t mask, int side);
+
+  const ForwardingSet& computeChoices(
+      Node* node,
+      ForwardingId inherited,
+      const Bytes& network,
+      uint8_t mask);
+  void select(
+      Node* node,
+      ForwardingId parentSelected,
+      const Bytes& network,
+      uint8_t mask);
+  void setEntry(
+      ForwardingId* entry,
+      const Bytes& network,
+      uint8_t mask,
+      ForwardingId id);
+  void prune(Node* node, const Bytes& network, uint8_t mask);
+
+  Node root_;
+  std::map<ForwardingKey, ForwardingId> forwardingIds_;
+  std::vector<Forwarding> forwardings_;
+  // Ids free for reuse, and ids released during the current update, only
+  // reused after the next flush
+  std::vector<ForwardingId> freeIds_;
+  std::vector<ForwardingId> releasedIds_;
+  // Prefix -> (entry at the last flush, entry now)
+  std::map<Prefix, std::pair<ForwardingId, ForwardingId>> pending_;
+  size_t numRoutes_{0};
+  size_t numEntries_{0};
+};
+
+} // namespace rib
+} // namespace fboss
+} // namespace facebook
@@ -23,10 +23,12 @@ namespace rib {
 ForwardingInformationBaseUpdater::ForwardingInformationBaseUpdater(
     RouterID vrf,
     const IPv4NetworkToRouteMap& v4NetworkToRoute,
-    const IPv6NetworkToRouteMap& v6NetworkToRoute)
+    const IPv6NetworkToRouteMap& v6NetworkToRoute,
+    const ChangedPrefixes* changedPrefixes)
     : vrf_(vrf),
       v4NetworkToRoute_(v4NetworkToRoute),
-      v6NetworkToRoute_(v6NetworkToRoute) {}
+      v6NetworkToRoute_(v6NetworkToRoute),
+      changedPrefixes_(changedPrefixes) {}
 
 std::shared_ptr<SwitchState> ForwardingInformationBaseUpdater::operator()(
     const std::shared_ptr<SwitchState>& state) {
@@ -45,6 +47,19 @@ std::shared_ptr<SwitchState> ForwardingInformationBaseUpdater::operator()(
 
   auto nextFibContainer = previousFibContainer->modify(&nextState);
 
+  if (changedPrefixes_ && previousFibContainer->getFibV4() &&
+      previousFibContainer->getFibV6()) {
+    nextFibContainer->writableFields()->fibV4 = createPatchedFib(
+        previousFibContainer->getFibV4(),
+        v4NetworkToRoute_,
+        changedPrefixes_->v4);
+    nextFibContainer->writableFields()->fibV6 = createPatchedFib(
+        previousFibContainer->getFibV6(),
+        v6NetworkToRoute_,
+        changedPrefixes_->v6);
+    return nextState;
+  }
+
   nextFibContainer->writableFields()->fibV4 =
       std::shared_ptr<ForwardingInformationBaseV4>(
           createUpdatedFib(v4NetworkToRoute_));
@@ -55,6 +70,45 @@ std::shared_ptr<SwitchState> ForwardingInformationBaseUpdater::operator()(
   return nextState;
 }
 
+template <typename AddressT>
+std::shared_ptr<typename facebook::fboss::ForwardingInformationBase<AddressT>>
+ForwardingInformationBaseUpdater::createPatchedFib(
+    const std::shared_ptr<
+        typename facebook::fboss::ForwardingInformationBase<AddressT>>& fib,
+    const facebook::fboss::rib::NetworkToRouteMap<AddressT>& rib,
+    const std::vector<RoutePrefix<AddressT>>& changedPrefixes) {
+  if (changedPrefixes.empty()) {
+    return fib;
+  }
+
+  // fib may already be published, so the routes are patched into a copy of
+  // it. The copy shares every route node that is not patched below.
+  std::shared_ptr<facebook::fboss::ForwardingInformationBase<AddressT>>
+      patchedFib = fib->isPublished() ? fib->clone() : fib;
+
+  for (const auto& ribPrefix : changedPrefixes) {
+    facebook::fboss::RoutePrefix<AddressT> fibPrefix{ribPrefix.network,
+                                                     ribPrefix.mask};
+
+    auto ribRouteIt = rib.exactMatch(ribPrefix.network, ribPrefix.mask);
+    if (ribRouteIt == rib.end() || !ribRouteIt->value().isResolved()) {
+      patchedFib->removeNodeIf(fibPrefix);
+      continue;
+    }
+
+    std::shared_ptr<facebook::fboss::Route<AddressT>> fibRoute =
+        toFibRoute(ribRouteIt->value());
+    auto existingRoute = patchedFib->exactMatch(fibPrefix);
+    if (!existingRoute) {
+      patchedFib->addNode(std::move(fibRoute));
+    } else if (!existingRoute->isSame(fibRoute.get())) {
+      patchedFib->updateNode(std::move(fibRoute));
+    }
+  }
+
+  return patchedFib;
+}
+
 template <typename AddressT>
 std::unique_ptr<typename facebook::fboss::ForwardingInformationBase<AddressT>>
 ForwardingInformationBaseUpdater::createUpdatedFib(
@@ -71,11 +125,11 @@ ForwardingInformationBaseUpdater::createUpdatedFib(
       continue;
     }
 
-    std::unique_ptr<facebook::fboss::Route<AddressT>> fibRoute =
+    std::shared_ptr<facebook::fboss::Route<AddressT>> fibRoute =
         toFibRoute(ribRoute);
 
     auto prefix = fibRoute->prefix();
-    updatedFib.emplace(prefix, fibRoute.release());
+    updatedFib.emplace(prefix, std::move(fibRoute));
   }
 
   return std::make_unique<ForwardingInformationBase<AddressT>>(updatedFib);
@@ -110,7 +164,7 @@ ForwardingInformationBaseUpdater::toFibNextHop(
 }
 
 template <typename AddrT>
-std::unique_ptr<facebook::fboss::Route<AddrT>>
+std::shared_ptr<facebook::fboss::Route<AddrT>>
 ForwardingInformationBaseUpdater::toFibRoute(const Route<AddrT>& ribRoute) {
   CHECK(ribRoute.isResolved());
 
@@ -118,7 +172,9 @@ ForwardingInformationBaseUpdater::toFibRoute(const Route<AddrT>& ribRoute) {
   fibPrefix.network = ribRoute.prefix().network;
   fibPrefix.mask = ribRoute.prefix().mask;
 
-  auto fibRoute = std::make_unique<facebook::fboss::Route<AddrT>>(fibPrefix);
+  // One allocation for the route and its control block: there is one of
+  // these for every route in the FIB
+  auto fibRoute = std::make_shared<facebook::fboss::Route<AddrT>>(fibPrefix);
 
   fibRoute->setResolved(toFibNextHop(ribRoute.getForwardInfo()));
   if (ribRoute.isConnected()) {
@@ -128,10 +184,10 @@ ForwardingInformationBaseUpdater::toFibRoute(const Route<AddrT>& ribRoute) {
   return fibRoute;
 }
 
-template std::unique_ptr<facebook::fboss::Route<folly::IPAddressV4>>
+template std::shared_ptr<facebook::fboss::Route<folly::IPAddressV4>>
 ForwardingInformationBaseUpdater::toFibRoute<folly::IPAddressV4>(
     const Route<folly::IPAddressV4>&);
-template std::unique_ptr<facebook::fboss::Route<folly::IPAddressV6>>
+template std::shared_ptr<facebook::fboss::Route<folly::IPAddressV6>>
 ForwardingInformationBaseUpdater::toFibRoute<folly::IPAddressV6>(
     const Route<folly::IPAddressV6>&);
 
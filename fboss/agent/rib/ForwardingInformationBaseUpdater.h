@@ -11,12 +11,14 @@
 
 #include "fboss/agent/rib/NetworkToRouteMap.h"
 #include "fboss/agent/rib/Route.h"
+#include "fboss/agent/rib/RouteTypes.h"
 #include "fboss/agent/state/ForwardingInformationBase.h"
 #include "fboss/agent/state/Route.h"
 #include "fboss/agent/state/RouteNextHopEntry.h"
 #include "fboss/agent/types.h"
 
 #include <memory>
+#include <vector>
 
 namespace facebook {
 namespace fboss {
@@ -30,12 +32,23 @@ namespace rib {
 
 class RouteNextHopEntry;
 
+/*
+ * ForwardingInformationBaseUpdater publishes the routes of a VRF in the RIB to
+ * the FIB of that VRF in a SwitchState.
+ *
+ * If changedPrefixes is null, the FIBs are rebuilt from every resolved route in
+ * the RIB. Otherwise, only the routes for changedPrefixes are added, replaced
+ * or removed in a copy of the existing FIBs. Routes with unchanged forwarding
+ * information keep their existing nodes, so that consumers of the resulting
+ * StateDelta only see the routes that actually changed.
+ */
 class ForwardingInformationBaseUpdater {
  public:
   ForwardingInformationBaseUpdater(
       RouterID vrf,
       const IPv4NetworkToRouteMap& v4NetworkToRoute,
-      const IPv6NetworkToRouteMap& v6NetworkToRoute);
+      const IPv6NetworkToRouteMap& v6NetworkToRoute,
+      const ChangedPrefixes* changedPrefixes = nullptr);
 
   std::shared_ptr<SwitchState> operator()(
       const std::shared_ptr<SwitchState>& state);
@@ -43,7 +56,7 @@ class ForwardingInformationBaseUpdater {
   static facebook::fboss::RouteNextHopEntry toFibNextHop(
       const RouteNextHopEntry& ribNextHopEntry);
   template <typename AddrT>
-  static std::unique_ptr<facebook::fboss::Route<AddrT>>
+  static std::shared_ptr<facebook::fboss::Route<AddrT>>
   toFibRoute(const Route<AddrT>& ribRoute);
 
  private:
@@ -52,9 +65,18 @@ class ForwardingInformationBaseUpdater {
   createUpdatedFib(
       const facebook::fboss::rib::NetworkToRouteMap<AddressT>& ribRange);
 
+  template <typename AddressT>
+  std::shared_ptr<typename facebook::fboss::ForwardingInformationBase<AddressT>>
+  createPatchedFib(
+      const std::shared_ptr<
+          typename facebook::fboss::ForwardingInformationBase<AddressT>>& fib,
+      const facebook::fboss::rib::NetworkToRouteMap<AddressT>& rib,
+      const std::vector<RoutePrefix<AddressT>>& changedPrefixes);
+
   RouterID vrf_;
   const IPv4NetworkToRouteMap& v4NetworkToRoute_;
   const IPv6NetworkToRouteMap& v6NetworkToRoute_;
+  const ChangedPrefixes* changedPrefixes_;
 };
 
 } // namespace rib
@@ -28,7 +28,16 @@ namespace rib {
 template <typename AddressT>
 class NetworkToRouteMap
     : public facebook::network::RadixTree<AddressT, Route<AddressT>> {
+  using Base = facebook::network::RadixTree<AddressT, Route<AddressT>>;
+
  public:
+  // Route tables see a lot of churn, allocate their nodes from a pool
+  NetworkToRouteMap()
+      : Base(
+            typename Base::NodeDeleteCallback(),
+            facebook::network::RadixTreeTraits<AddressT, Route<AddressT>>(),
+            true /* useNodePool */) {}
+
   folly::dynamic toFollyDynamic() const {
     folly::dynamic routesJson = folly::dynamic::array;
     for (const auto& route : *this) {
@@ -0,0 +1,93 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/rib/NextHopDependencyIndex.h"
+
+namespace facebook {
+namespace fboss {
+namespace rib {
+
+void NextHopDependencyIndex::addDependency(
+    const folly::CIDRNetwork& route,
+    const folly::IPAddress& nextHop) {
+  if (nextHop.isV4()) {
+    v4NextHopToRoutes_[nextHop.asV4()].insert(route);
+  } else {
+    v6NextHopToRoutes_[nextHop.asV6()].insert(route);
+  }
+  routeToNextHops_[route].push_back(nextHop);
+}
+
+template <typename AddressT>
+void NextHopDependencyIndex::removeDependency(
+    NextHopToRoutes<AddressT>* nextHopToRoutes,
+    const AddressT& nextHop,
+    const folly::CIDRNetwork& route) {
+  auto it = nextHopToRoutes->find(nextHop);
+  if (it == nextHopToRoutes->end()) {
+    return;
+  }
+  it->second.erase(route);
+  if (it->second.empty()) {
+    nextHopToRoutes->erase(it);
+  }
+}
+
+void NextHopDependencyIndex::removeDependencies(
+    const folly::CIDRNetwork& route) {
+  auto it = routeToNextHops_.find(route);
+  if (it == routeToNextHops_.end()) {
+    return;
+  }
+  for (const auto& nextHop : it->second) {
+    if (nextHop.isV4()) {
+      removeDependency(&v4NextHopToRoutes_, nextHop.asV4(), route);
+    } else {
+      removeDependency(&v6NextHopToRoutes_, nextHop.asV6(), route);
+    }
+  }
+  routeToNextHops_.erase(it);
+}
+
+template <typename AddressT>
+void NextHopDependencyIndex::getDependentsImpl(
+    const NextHopToRoutes<AddressT>& nextHopToRoutes,
+    const AddressT& network,
+    uint8_t mask,
+    std::vector<folly::CIDRNetwork>* dependents) {
+  // Addresses inside network are contiguous in address order, starting at
+  // the (masked) network address itself.
+  for (auto it = nextHopToRoutes.lower_bound(network);
+       it != nextHopToRoutes.end() && it->first.inSubnet(network, mask);
+       ++it) {
+    dependents->insert(dependents->end(), it->second.begin(), it->second.end());
+  }
+}
+
+void NextHopDependencyIndex::getDependents(
+    const folly::CIDRNetwork& network,
+    std::vector<folly::CIDRNetwork>* dependents) const {
+  if (network.first.isV4()) {
+    getDependentsImpl(
+        v4NextHopToRoutes_,
+        network.first.asV4().mask(network.second),
+        network.second,
+        dependents);
+  } else {
+    getDependentsImpl(
+        v6NextHopToRoutes_,
+        network.first.asV6().mask(network.second),
+        network.second,
+        dependents);
+  }
+}
+
+} // namespace rib
+} // namespace fboss
+} // namespace facebook
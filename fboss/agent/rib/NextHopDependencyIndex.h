@@ -0,0 +1,77 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include <boost/container/flat_set.hpp>
+#include <folly/IPAddress.h>
+
+#include <map>
+#include <vector>
+
+namespace facebook {
+namespace fboss {
+namespace rib {
+
+/*
+ * NextHopDependencyIndex records, for every route in a VRF, the recursive
+ * next hops it was resolved through. Interface next hops, which are resolved
+ * by construction, are not recorded.
+ *
+ * A change to the route for a network N can only affect the resolution of
+ * routes with a next hop inside N: either that next hop resolved through N, or
+ * N is a new, more specific match for it. RouteUpdater uses this index to limit
+ * re-resolution to the routes that (transitively) depend on the prefixes
+ * changed in an update.
+ */
+class NextHopDependencyIndex {
+ public:
+  void addDependency(
+      const folly::CIDRNetwork& route,
+      const folly::IPAddress& nextHop);
+  void removeDependencies(const folly::CIDRNetwork& route);
+
+  /*
+   * Appends to dependents every route that has a recursive next hop inside
+   * network.
+   */
+  void getDependents(
+      const folly::CIDRNetwork& network,
+      std::vector<folly::CIDRNetwork>* dependents) const;
+
+  bool empty() const {
+    return routeToNextHops_.empty();
+  }
+
+ private:
+  template <typename AddressT>
+  using NextHopToRoutes =
+      std::map<AddressT, boost::container::flat_set<folly::CIDRNetwork>>;
+
+  template <typename AddressT>
+  static void getDependentsImpl(
+      const NextHopToRoutes<AddressT>& nextHopToRoutes,
+      const AddressT& network,
+      uint8_t mask,
+      std::vector<folly::CIDRNetwork>* dependents);
+
+  template <typename AddressT>
+  static void removeDependency(
+      NextHopToRoutes<AddressT>* nextHopToRoutes,
+      const AddressT& nextHop,
+      const folly::CIDRNetwork& route);
+
+  NextHopToRoutes<folly::IPAddressV4> v4NextHopToRoutes_;
+  NextHopToRoutes<folly::IPAddressV6> v6NextHopToRoutes_;
+  std::map<folly::CIDRNetwork, std::vector<folly::IPAddress>> routeToNextHops_;
+};
+
+} // namespace rib
+} // namespace fboss
+} // namespace facebook
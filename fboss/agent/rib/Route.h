@@ -97,6 +97,9 @@ class Route {
   bool hasNoEntry() const {
     return nexthopsmulti.isEmpty();
   }
+  std::vector<ClientID> getClients() const {
+    return nexthopsmulti.getClients();
+  }
 
   bool has(ClientID clientId, const RouteNextHopEntry& entry) const;
 
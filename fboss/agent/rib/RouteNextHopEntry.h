@@ -13,6 +13,7 @@
 
 #include <folly/dynamic.h>
 
+#include "fboss/agent/state/Interned.h"
 #include "fboss/agent/rib/RouteNextHop.h"
 #include "fboss/agent/rib/RouteTypes.h"
 
@@ -38,6 +39,10 @@ class RouteNextHopEntry {
  public:
   using Action = RouteForwardAction;
   using NextHopSet = boost::container::flat_set<NextHop>;
+  // Hashes the addresses and weights of the next hops
+  struct NextHopSetHash {
+    size_t operator()(const NextHopSet& nhops) const;
+  };
 
   RouteNextHopEntry(Action action, AdminDistance distance)
       : adminDistance_(distance), action_(action) {
@@ -47,9 +52,9 @@ class RouteNextHopEntry {
   RouteNextHopEntry(NextHopSet nhopSet, AdminDistance distance);
 
   RouteNextHopEntry(NextHop nhop, AdminDistance distance)
-      : adminDistance_(distance), action_(Action::NEXTHOPS) {
-    nhopSet_.emplace(std::move(nhop));
-  }
+      : adminDistance_(distance),
+        action_(Action::NEXTHOPS),
+        nhopSet_(NextHopSet{std::move(nhop)}) {}
 
   AdminDistance getAdminDistance() const {
     return adminDistance_;
@@ -60,7 +65,7 @@ class RouteNextHopEntry {
   }
 
   const NextHopSet& getNextHopSet() const {
-    return nhopSet_;
+    return nhopSet_.get();
   }
 
   // Get the sum of the weights of all the nexthops in the entry
@@ -91,7 +96,7 @@ class RouteNextHopEntry {
 
   // Reset the NextHopSet
   void reset() {
-    nhopSet_.clear();
+    nhopSet_ = InternedNextHopSet();
     action_ = Action::DROP;
   }
 
@@ -111,7 +116,12 @@ class RouteNextHopEntry {
  private:
   AdminDistance adminDistance_;
   Action action_{Action::DROP};
-  NextHopSet nhopSet_;
+  // Shared with every other entry with the same next hops
+  using InternedNextHopSet = Interned<NextHopSet, NextHopSetHash>;
+  InternedNextHopSet nhopSet_;
+
+  friend bool operator==(
+      const RouteNextHopEntry& a, const RouteNextHopEntry& b);
 };
 
 /**
@@ -87,48 +87,25 @@ void RouteNextHopsMulti::update(ClientID clientId, RouteNextHopEntry nhe) {
   } else {
     iter->second = std::move(nhe);
   }
-
-  // Let's check whether this has a preferred admin distance
-  if (map_.size() == 1) {
-    lowestAdminDistanceClientId_ = clientId;
-    return;
-  }
-  auto entry = getEntryForClient(lowestAdminDistanceClientId_);
-  if (!entry) {
-    lowestAdminDistanceClientId_ = findLowestAdminDistance();
-  } else if (nhe.getAdminDistance() < entry->getAdminDistance()) {
-    // Arbritary choice to use the newest one if we have multiple
-    // with the same admin distance
-    lowestAdminDistanceClientId_ = clientId;
-  }
+  findBestEntry();
 }
 
-ClientID RouteNextHopsMulti::findLowestAdminDistance() {
-  if (map_.size() == 0) {
-    // We'll set it on the next add
-    return ClientID(-1);
-  }
-  auto lowest = map_.begin();
-  auto it = map_.begin();
-  while (it != map_.end()) {
-    if (it->second.getAdminDistance() < lowest->second.getAdminDistance()) {
-      lowest = it;
-    } else if (it->second.isSame(lowest->second) && it->first < lowest->first) {
-      // If we have two clients with the same admin distance, pick the lowest
-      // client id - this is an arbritary, but deterministic, choice
-      lowest = it;
+void RouteNextHopsMulti::findBestEntry() {
+  bestEntry_ = kNoBestEntry;
+  // map_ is in ClientID order, so the first of several entries with the
+  // lowest admin distance is the one from the lowest ClientID
+  for (uint32_t i = 0; i < map_.size(); ++i) {
+    if (bestEntry_ == kNoBestEntry ||
+        map_.nth(i)->second.getAdminDistance() <
+            map_.nth(bestEntry_)->second.getAdminDistance()) {
+      bestEntry_ = i;
     }
-    ++it;
   }
-  return lowest->first;
 }
 
 void RouteNextHopsMulti::delEntryForClient(ClientID clientId) {
-  map_.erase(clientId);
-
-  // Let's regen the next best entry
-  if (lowestAdminDistanceClientId_ == clientId) {
-    lowestAdminDistanceClientId_ = findLowestAdminDistance();
+  if (map_.erase(clientId)) {
+    findBestEntry();
   }
 }
 
@@ -149,13 +126,21 @@ bool RouteNextHopsMulti::isSame(ClientID id, const RouteNextHopEntry& nhe)
 
 std::pair<ClientID, const RouteNextHopEntry*> RouteNextHopsMulti::getBestEntry()
     const {
-  auto entry = getEntryForClient(lowestAdminDistanceClientId_);
-  if (entry) {
-    return std::make_pair(lowestAdminDistanceClientId_, entry);
-  } else {
+  if (bestEntry_ == kNoBestEntry) {
     // Throw an exception if the map is empty. Shall not happen
     throw FbossError("Unexpected empty RouteNextHopsMulti");
   }
+  auto best = map_.nth(bestEntry_);
+  return std::make_pair(best->first, &best->second);
+}
+
+std::vector<ClientID> RouteNextHopsMulti::getClients() const {
+  std::vector<ClientID> clients;
+  clients.reserve(map_.size());
+  for (const auto& entry : map_) {
+    clients.push_back(entry.first);
+  }
+  return clients;
 }
 
 } // namespace rib
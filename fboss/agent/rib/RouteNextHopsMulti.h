@@ -15,6 +15,8 @@
 
 #include <boost/container/flat_map.hpp>
 
+#include <limits>
+
 #include "fboss/agent/if/gen-cpp2/ctrl_types.h"
 #include "fboss/agent/rib/RouteNextHopEntry.h"
 #include "fboss/agent/types.h"
@@ -46,9 +48,15 @@ namespace rib {
  */
 class RouteNextHopsMulti {
  protected:
-  ClientID findLowestAdminDistance();
+  static constexpr uint32_t kNoBestEntry =
+      std::numeric_limits<uint32_t>::max();
+
+  void findBestEntry();
   boost::container::flat_map<ClientID, RouteNextHopEntry> map_;
-  ClientID lowestAdminDistanceClientId_;
+  // Position in map_ of the entry with the lowest admin distance, ties
+  // going to the lowest ClientID. update() and delEntryForClient() keep it
+  // current, so getBestEntry() does not search map_.
+  uint32_t bestEntry_{kNoBestEntry};
 
  public:
   folly::dynamic toFollyDynamic() const;
@@ -61,6 +69,7 @@ class RouteNextHopsMulti {
 
   void clear() {
     map_.clear();
+    bestEntry_ = kNoBestEntry;
   }
 
   bool operator==(const RouteNextHopsMulti& p2) const {
@@ -80,6 +89,9 @@ class RouteNextHopsMulti {
 
   std::pair<ClientID, const RouteNextHopEntry*> getBestEntry() const;
 
+  // The clients with an entry, in ClientID order
+  std::vector<ClientID> getClients() const;
+
   bool isSame(ClientID clientId, const RouteNextHopEntry& nhe) const;
 };
 
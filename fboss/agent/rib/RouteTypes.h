@@ -13,6 +13,7 @@
 #include <folly/FBString.h>
 #include <folly/IPAddress.h>
 #include <folly/dynamic.h>
+#include <vector>
 #include "fboss/agent/if/gen-cpp2/ctrl_types.h"
 #include "fboss/agent/types.h"
 
@@ -72,6 +73,15 @@ using PrefixV6 = RoutePrefix<folly::IPAddressV6>;
 void toAppend(const PrefixV4& prefix, std::string* result);
 void toAppend(const PrefixV6& prefix, std::string* result);
 
+/**
+ * The prefixes whose forwarding information may have changed in an update to
+ * the RIB. This includes prefixes that were deleted.
+ */
+struct ChangedPrefixes {
+  std::vector<PrefixV4> v4;
+  std::vector<PrefixV6> v6;
+};
+
 } // namespace rib
 } // namespace fboss
 } // namespace facebook
@@ -11,6 +11,7 @@
 #include "RouteUpdater.h"
 
 #include <numeric>
+#include <set>
 
 #include <boost/container/flat_map.hpp>
 #include <boost/container/flat_set.hpp>
@@ -40,8 +41,19 @@ static const auto kInterfaceRouteClientId =
 
 RouteUpdater::RouteUpdater(
     IPv4NetworkToRouteMap* v4Routes,
-    IPv6NetworkToRouteMap* v6Routes)
-    : v4Routes_(v4Routes), v6Routes_(v6Routes) {}
+    IPv6NetworkToRouteMap* v6Routes,
+    NextHopDependencyIndex* nextHopDependencies)
+    : v4Routes_(v4Routes),
+      v6Routes_(v6Routes),
+      nextHopDependencies_(nextHopDependencies) {}
+
+template <typename AddressT>
+void RouteUpdater::markChanged(const Prefix<AddressT>& prefix) {
+  if (nextHopDependencies_) {
+    changedPrefixes_.emplace_back(
+        folly::IPAddress(prefix.network), prefix.mask);
+  }
+}
 
 template <typename AddressT>
 void RouteUpdater::addRouteImpl(
@@ -58,12 +70,14 @@ void RouteUpdater::addRouteImpl(
     }
 
     route->update(clientID, entry);
+    markChanged(prefix);
     return;
   }
 
   CHECK(it == routes->end());
   routes->insert(
       prefix.network, prefix.mask, Route<AddressT>(prefix, clientID, entry));
+  markChanged(prefix);
 }
 
 void RouteUpdater::addRoute(
@@ -130,13 +144,21 @@ void RouteUpdater::delRouteImpl(
   }
 
   Route<AddressT>& route = it->value();
+  if (!route.getEntryForClient(clientID)) {
+    return;
+  }
   route.delEntryForClient(clientID);
+  markChanged(prefix);
 
   XLOG(DBG3) << "Deleted next-hops for prefix " << prefix.str()
              << "from client " << clientID;
 
   if (route.hasNoEntry()) {
     XLOG(DBG3) << "...and then deleted route " << route.str();
+    if (nextHopDependencies_) {
+      nextHopDependencies_->removeDependencies(
+          {folly::IPAddress(prefix.network), prefix.mask});
+    }
     routes->erase(it);
   }
 }
@@ -158,12 +180,20 @@ void RouteUpdater::delRoute(
 template <typename AddressT>
 void RouteUpdater::removeAllRoutesFromClientImpl(
     NetworkToRouteMap<AddressT>* routes,
-    ClientID clientID) {
+    ClientID clientID,
+    const boost::container::flat_set<Prefix<AddressT>>* keep) {
   std::vector<typename NetworkToRouteMap<AddressT>::Iterator> toDelete;
 
   for (auto it : *routes) {
     Route<AddressT>& route = it->value();
+    if (!route.getEntryForClient(clientID)) {
+      continue;
+    }
+    if (keep && keep->find(route.prefix()) != keep->end()) {
+      continue;
+    }
     route.delEntryForClient(clientID);
+    markChanged(route.prefix());
     if (route.hasNoEntry()) {
       // The nexthops we removed was the only one.  Delete the route.
       toDelete.push_back(it);
@@ -172,6 +202,11 @@ void RouteUpdater::removeAllRoutesFromClientImpl(
 
   // Now, delete whatever routes went from 1 nexthoplist to 0.
   for (auto it : toDelete) {
+    if (nextHopDependencies_) {
+      const auto& prefix = it->value().prefix();
+      nextHopDependencies_->removeDependencies(
+          {folly::IPAddress(prefix.network), prefix.mask});
+    }
     routes->erase(it);
   }
 }
@@ -181,6 +216,14 @@ void RouteUpdater::removeAllRoutesForClient(ClientID clientID) {
   removeAllRoutesFromClientImpl<IPAddressV6>(v6Routes_, clientID);
 }
 
+void RouteUpdater::removeRoutesForClientExcept(
+    ClientID clientID,
+    const flat_set<PrefixV4>& keepV4,
+    const flat_set<PrefixV6>& keepV6) {
+  removeAllRoutesFromClientImpl<IPAddressV4>(v4Routes_, clientID, &keepV4);
+  removeAllRoutesFromClientImpl<IPAddressV6>(v6Routes_, clientID, &keepV6);
+}
+
 // Some helper functions for recursive weight resolution
 // These aren't really usefully reusable, but structuring them
 // this way helps with clarifying their meaning.
@@ -451,6 +494,13 @@ void RouteUpdater::resolveOne(Route<AddressT>* route) {
   // mark this route is in processing. This processing bit shall be cleared
   // in setUnresolvable() or setResolved()
   route->setProcessing();
+  ++resolvedRouteCount_;
+
+  folly::CIDRNetwork network{folly::IPAddress(route->prefix().network),
+                             route->prefix().mask};
+  if (nextHopDependencies_) {
+    nextHopDependencies_->removeDependencies(network);
+  }
 
   bool hasToCpu{false};
   bool hasDrop{false};
@@ -483,6 +533,10 @@ void RouteUpdater::resolveOne(Route<AddressT>* route) {
         continue;
       }
 
+      if (nextHopDependencies_) {
+        nextHopDependencies_->addDependency(network, addr);
+      }
+
       if (addr.isV4()) {
         getFwdInfoFromNhop(
             v4Routes_,
@@ -545,7 +599,75 @@ void RouteUpdater::updateDoneImpl(NetworkToRouteMap<AddressT>* routes) {
   resolve(routes);
 }
 
+template <typename AddressT>
+Route<AddressT>* FOLLY_NULLABLE RouteUpdater::clearForward(
+    NetworkToRouteMap<AddressT>* routes,
+    const Prefix<AddressT>& prefix) {
+  auto it = routes->exactMatch(prefix.network, prefix.mask);
+  if (it == routes->end()) {
+    // The route was deleted in this update
+    return nullptr;
+  }
+  Route<AddressT>* route = &(it->value());
+  route->clearForward();
+  return route;
+}
+
+void RouteUpdater::updateDoneIncremental() {
+  // A route has to be re-resolved if it changed in this update or if it has a
+  // next hop inside a route that has to be re-resolved.
+  std::set<folly::CIDRNetwork> affected;
+  std::vector<folly::CIDRNetwork> toVisit;
+  toVisit.swap(changedPrefixes_);
+  while (!toVisit.empty()) {
+    auto network = std::move(toVisit.back());
+    toVisit.pop_back();
+    if (!affected.insert(network).second) {
+      continue;
+    }
+    nextHopDependencies_->getDependents(network, &toVisit);
+  }
+
+  // Forwarding info of every affected route has to be cleared before any of
+  // them is resolved. Otherwise resolveOne() could resolve one affected route
+  // through the stale forwarding info of another.
+  std::vector<RouteV4*> v4Affected;
+  std::vector<RouteV6*> v6Affected;
+  for (const auto& network : affected) {
+    if (network.first.isV4()) {
+      PrefixV4 prefix{network.first.asV4(), network.second};
+      affectedPrefixes_.v4.push_back(prefix);
+      auto route = clearForward(v4Routes_, prefix);
+      if (route) {
+        v4Affected.push_back(route);
+      }
+    } else {
+      PrefixV6 prefix{network.first.asV6(), network.second};
+      affectedPrefixes_.v6.push_back(prefix);
+      auto route = clearForward(v6Routes_, prefix);
+      if (route) {
+        v6Affected.push_back(route);
+      }
+    }
+  }
+
+  for (auto route : v4Affected) {
+    if (route->needResolve()) {
+      resolveOne(route);
+    }
+  }
+  for (auto route : v6Affected) {
+    if (route->needResolve()) {
+      resolveOne(route);
+    }
+  }
+}
+
 void RouteUpdater::updateDone() {
+  if (nextHopDependencies_) {
+    updateDoneIncremental();
+    return;
+  }
   updateDoneImpl(v4Routes_);
   updateDoneImpl(v6Routes_);
 }
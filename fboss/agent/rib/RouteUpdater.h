@@ -13,11 +13,13 @@
 #include "fboss/agent/types.h"
 
 #include "fboss/agent/rib/NetworkToRouteMap.h"
+#include "fboss/agent/rib/NextHopDependencyIndex.h"
 #include "fboss/agent/rib/Route.h"
 #include "fboss/agent/rib/RouteNextHopEntry.h"
 #include "fboss/agent/rib/RouteNextHopsMulti.h"
 #include "fboss/agent/rib/RouteTypes.h"
 
+#include <boost/container/flat_set.hpp>
 #include <folly/IPAddress.h>
 
 namespace facebook {
@@ -47,12 +49,18 @@ namespace rib {
  *    only IP nexthops will be in the final ECMP group.
  * 5. If and only if TO_CPU is the only nexthop (directly or indirectly) of
  *    a route, TO_CPU action will be only path in the resolved ECMP group.
+ *
+ * Without a NextHopDependencyIndex, updateDone() re-resolves every route. When
+ * one is provided, it must have been maintained by every previous RouteUpdater
+ * over the same route tables; updateDone() then only re-resolves the routes
+ * changed in this update and the routes that depend on them.
  */
 class RouteUpdater {
  public:
   RouteUpdater(
       IPv4NetworkToRouteMap* v4Routes,
-      IPv6NetworkToRouteMap* v6Routes);
+      IPv6NetworkToRouteMap* v6Routes,
+      NextHopDependencyIndex* nextHopDependencies = nullptr);
 
   void addRoute(
       const folly::IPAddress& network,
@@ -71,12 +79,34 @@ class RouteUpdater {
   delRoute(const folly::IPAddress& network, uint8_t mask, ClientID clientID);
   void delLinkLocalRoutes();
   void removeAllRoutesForClient(ClientID clientID);
+  // Removes clientID's routes other than those in keepV4 and keepV6, leaving
+  // the kept ones unchanged rather than removing and re-adding them
+  void removeRoutesForClientExcept(
+      ClientID clientID,
+      const boost::container::flat_set<PrefixV4>& keepV4,
+      const boost::container::flat_set<PrefixV6>& keepV6);
 
   void updateDone();
 
+  // The number of routes resolved by updateDone()
+  std::size_t getResolvedRouteCount() const {
+    return resolvedRouteCount_;
+  }
+
+  // The prefixes re-resolved or deleted by an incremental updateDone()
+  const ChangedPrefixes& getAffectedPrefixes() const {
+    return affectedPrefixes_;
+  }
+
  private:
   IPv4NetworkToRouteMap* v4Routes_{nullptr};
   IPv6NetworkToRouteMap* v6Routes_{nullptr};
+  NextHopDependencyIndex* nextHopDependencies_{nullptr};
+
+  // Prefixes whose set of entries changed since this RouteUpdater was created
+  std::vector<folly::CIDRNetwork> changedPrefixes_;
+  std::size_t resolvedRouteCount_{0};
+  ChangedPrefixes affectedPrefixes_;
 
   // TODO(samank): rename in original file
   template <typename AddressT>
@@ -97,9 +127,18 @@ class RouteUpdater {
   template <typename AddressT>
   void removeAllRoutesFromClientImpl(
       NetworkToRouteMap<AddressT>* routes,
-      ClientID clientID);
+      ClientID clientID,
+      const boost::container::flat_set<Prefix<AddressT>>* keep = nullptr);
   template <typename AddressT>
   void updateDoneImpl(NetworkToRouteMap<AddressT>* routes);
+  void updateDoneIncremental();
+
+  template <typename AddressT>
+  void markChanged(const Prefix<AddressT>& prefix);
+  template <typename AddressT>
+  Route<AddressT>* FOLLY_NULLABLE clearForward(
+      NetworkToRouteMap<AddressT>* routes,
+      const Prefix<AddressT>& prefix);
 
   template <typename AddressT>
   void resolve(NetworkToRouteMap<AddressT>* routes);
@@ -13,10 +13,15 @@
 #include "fboss/agent/rib/RouteNextHopEntry.h"
 #include "fboss/agent/rib/RouteUpdater.h"
 
+#include <folly/Conv.h>
+#include <folly/logging/xlog.h>
+
+#include <map>
 #include <memory>
 #include <utility>
 
 #include "fboss/agent/AddressUtil.h"
+#include "fboss/agent/Utils.h"
 
 namespace {
 class Timer {
@@ -34,12 +39,77 @@ class Timer {
   std::chrono::microseconds* duration_;
   std::chrono::time_point<std::chrono::steady_clock> start_;
 };
+
+constexpr auto kV4Routes = "v4Routes";
+constexpr auto kV6Routes = "v6Routes";
 } // namespace
 
 namespace facebook {
 namespace fboss {
 namespace rib {
 
+namespace {
+template <typename PrefixT>
+using PrefixTimes = std::map<PrefixT, std::chrono::steady_clock::time_point>;
+
+template <typename PrefixT>
+void coalesceChanges(
+    const std::vector<PrefixT>& changed,
+    std::chrono::steady_clock::time_point now,
+    std::chrono::milliseconds window,
+    PrefixTimes<PrefixT>* published,
+    PrefixTimes<PrefixT>* held,
+    std::vector<PrefixT>* toPublish,
+    RoutingInformationBase::UpdateStatistics* stats) {
+  for (const auto& prefix : changed) {
+    if (held->count(prefix)) {
+      ++stats->routesCoalesced;
+      continue;
+    }
+    auto it = published->find(prefix);
+    if (it != published->end() && now - it->second < window) {
+      held->emplace(prefix, now);
+      ++stats->routesHeld;
+      continue;
+    }
+    (*published)[prefix] = now;
+    toPublish->push_back(prefix);
+  }
+}
+
+template <typename PrefixT>
+void releaseHeld(
+    std::chrono::steady_clock::time_point now,
+    std::chrono::milliseconds window,
+    PrefixTimes<PrefixT>* published,
+    PrefixTimes<PrefixT>* held,
+    std::vector<PrefixT>* toPublish) {
+  for (auto it = held->begin(); it != held->end();) {
+    if (now - it->second < window) {
+      ++it;
+      continue;
+    }
+    (*published)[it->first] = now;
+    toPublish->push_back(it->first);
+    it = held->erase(it);
+  }
+}
+
+template <typename PrefixT>
+void forgetPublished(
+    std::chrono::steady_clock::time_point now,
+    std::chrono::milliseconds window,
+    PrefixTimes<PrefixT>* published) {
+  for (auto it = published->begin(); it != published->end();) {
+    if (now - it->second < window) {
+      ++it;
+    } else {
+      it = published->erase(it);
+    }
+  }
+}
+} // namespace
+
 void RoutingInformationBase::reconfigure(
     const RouterIDAndNetworkToInterfaceRoutes& configRouterIDToInterfaceRoutes,
     const std::vector<cfg::StaticRouteWithNextHops>& staticRoutesWithNextHops,
@@ -47,7 +117,10 @@ void RoutingInformationBase::reconfigure(
     const std::vector<cfg::StaticRouteNoNextHops>& staticRoutesToCpu,
     FibUpdateFunction updateFibCallback,
     void* cookie) {
-  auto lockedRouteTables = synchronizedRouteTables_.wlock();
+  // Only one reconfiguration may be in flight at a time. The upgrade lock
+  // excludes other reconfigurations but not update(), so route updates to VRFs
+  // other than the one currently being reconfigured can proceed.
+  auto lockedRouteTables = synchronizedRouteTables_.ulock();
 
   // Config application is accomplished in the following sequence of steps:
   // 1. Update the VRFs held in RoutingInformationBase's SynchronizedRouteTables
@@ -67,18 +140,22 @@ void RoutingInformationBase::reconfigure(
   //
   // Steps 2-5 take place in ConfigApplier.
 
-  *lockedRouteTables =
-      constructRouteTables(lockedRouteTables, configRouterIDToInterfaceRoutes);
+  auto newRouteTables =
+      constructRouteTables(*lockedRouteTables, configRouterIDToInterfaceRoutes);
+  {
+    auto writeLockedRouteTables = lockedRouteTables.moveFromUpgradeToWrite();
+    *writeLockedRouteTables = std::move(newRouteTables);
+    lockedRouteTables = writeLockedRouteTables.moveFromWriteToUpgrade();
+  }
 
-  // Because of this sequential loop over each VRF, config application scales
-  // linearly with the number of VRFs. If FBOSS is run in a multi-VRF routing
-  // architecture in the future, this slow-down can be avoided by parallelizing
-  // this loop. Converting this loop to use task-level parallelism should be
-  // straightfoward because it has been written to avoid dependencies across
-  // different iterations of the loop.
-  for (auto& vrfAndRouteTable : *lockedRouteTables) {
+  // Each VRF is reconfigured under its own lock, so an update() to one VRF
+  // only waits for the reconfiguration of that VRF. The loop itself stays
+  // sequential because every iteration invokes updateFibCallback with the same
+  // cookie, which callers use to accumulate a single SwitchState.
+  for (const auto& vrfAndRouteTable : *lockedRouteTables) {
     auto vrf = vrfAndRouteTable.first;
     const auto& interfaceRoutes = configRouterIDToInterfaceRoutes.at(vrf);
+    auto lockedRouteTable = vrfAndRouteTable.second->wlock();
 
     // A ConfigApplier object should be independent of the VRF whose routes it
     // is processing. However, because interface and static routes for _all_
@@ -89,8 +166,9 @@ void RoutingInformationBase::reconfigure(
     // processing by the use of boost::filter_iterator.
     ConfigApplier configApplier(
         vrf,
-        &(vrfAndRouteTable.second.v4NetworkToRoute),
-        &(vrfAndRouteTable.second.v6NetworkToRoute),
+        &(lockedRouteTable->v4NetworkToRoute),
+        &(lockedRouteTable->v6NetworkToRoute),
+        &(lockedRouteTable->nextHopDependencies),
         folly::range(interfaceRoutes.cbegin(), interfaceRoutes.cend()),
         folly::range(staticRoutesToCpu.cbegin(), staticRoutesToCpu.cend()),
         folly::range(staticRoutesToNull.cbegin(), staticRoutesToNull.cend()),
@@ -100,6 +178,9 @@ void RoutingInformationBase::reconfigure(
         cookie);
 
     configApplier.updateRibAndFib();
+    // The FIB was rebuilt from every route, held back ones included
+    lockedRouteTable->v4Held.clear();
+    lockedRouteTable->v6Held.clear();
   }
 }
 
@@ -117,24 +198,42 @@ RoutingInformationBase::UpdateStatistics RoutingInformationBase::update(
 
   Timer updateTimer(&stats.duration);
 
-  auto lockedRouteTables = synchronizedRouteTables_.wlock();
+  // The shared lock on the set of VRFs keeps reconfigure() from removing this
+  // VRF while it is being updated; the exclusive lock on its RouteTable
+  // serializes updates, and hence FIB callbacks, within the VRF.
+  auto lockTimer = std::make_unique<Timer>(&stats.lockWait);
+  auto lockedRouteTables = synchronizedRouteTables_.rlock();
 
   auto it = lockedRouteTables->find(routerID);
   if (it == lockedRouteTables->end()) {
     throw FbossError("VRF ", routerID, " not configured");
   }
 
+  auto lockedRouteTable = it->second->wlock();
+  lockTimer.reset();
+
   RouteUpdater updater(
-      &(it->second.v4NetworkToRoute), &(it->second.v6NetworkToRoute));
+      &(lockedRouteTable->v4NetworkToRoute),
+      &(lockedRouteTable->v6NetworkToRoute),
+      &(lockedRouteTable->nextHopDependencies));
 
-  if (resetClientsRoutes) {
-    updater.removeAllRoutesForClient(clientID);
-  }
+  // Resetting a client's routes re-adds the ones it still has, which leaves
+  // the unchanged ones alone, and then removes only the ones it dropped
+  boost::container::flat_set<PrefixV4> keepV4;
+  boost::container::flat_set<PrefixV6> keepV6;
 
   for (const auto& route : toAdd) {
     auto network = facebook::network::toIPAddress(route.dest.ip);
     auto mask = static_cast<uint8_t>(route.dest.prefixLength);
 
+    if (resetClientsRoutes) {
+      if (network.isV4()) {
+        keepV4.insert({network.asV4().mask(mask), mask});
+      } else {
+        keepV6.insert({network.asV6().mask(mask), mask});
+      }
+    }
+
     if (network.isV4()) {
       ++stats.v4RoutesAdded;
     } else {
@@ -148,6 +247,11 @@ RoutingInformationBase::UpdateStatistics RoutingInformationBase::update(
         RouteNextHopEntry::from(route, adminDistanceFromClientID));
   }
 
+  if (resetClientsRoutes) {
+    updater.removeRoutesForClientExcept(clientID, keepV4, keepV6);
+    lockedRouteTable->staleClients.erase(clientID);
+  }
+
   for (const auto& prefix : toDelete) {
     auto network = facebook::network::toIPAddress(prefix.ip);
     auto mask = static_cast<uint8_t>(prefix.prefixLength);
@@ -162,41 +266,237 @@ RoutingInformationBase::UpdateStatistics RoutingInformationBase::update(
   }
 
   updater.updateDone();
+  stats.routesResolved = updater.getResolvedRouteCount();
+
+  const ChangedPrefixes* changedPrefixes = &updater.getAffectedPrefixes();
+  ChangedPrefixes toPublish;
+  if (coalescingWindow_.count() > 0) {
+    auto now = std::chrono::steady_clock::now();
+    coalesceChanges(
+        changedPrefixes->v4,
+        now,
+        coalescingWindow_,
+        &lockedRouteTable->v4Published,
+        &lockedRouteTable->v4Held,
+        &toPublish.v4,
+        &stats);
+    coalesceChanges(
+        changedPrefixes->v6,
+        now,
+        coalescingWindow_,
+        &lockedRouteTable->v6Published,
+        &lockedRouteTable->v6Held,
+        &toPublish.v6,
+        &stats);
+    // Take along whatever has been held long enough
+    releaseHeld(
+        now,
+        coalescingWindow_,
+        &lockedRouteTable->v4Published,
+        &lockedRouteTable->v4Held,
+        &toPublish.v4);
+    releaseHeld(
+        now,
+        coalescingWindow_,
+        &lockedRouteTable->v6Published,
+        &lockedRouteTable->v6Held,
+        &toPublish.v6);
+    if (toPublish.v4.empty() && toPublish.v6.empty()) {
+      return stats;
+    }
+    changedPrefixes = &toPublish;
+  }
 
-  fibUpdateCallback(
-      routerID,
-      it->second.v4NetworkToRoute,
-      it->second.v6NetworkToRoute,
-      cookie);
+  {
+    Timer fibTimer(&stats.fibUpdateDuration);
+    fibUpdateCallback(
+        routerID,
+        lockedRouteTable->v4NetworkToRoute,
+        lockedRouteTable->v6NetworkToRoute,
+        changedPrefixes,
+        cookie);
+  }
 
   return stats;
 }
 
+std::size_t RoutingInformationBase::publishCoalescedRoutes(
+    FibUpdateFunction fibUpdateCallback,
+    void* cookie) {
+  std::size_t published = 0;
+  auto lockedRouteTables = synchronizedRouteTables_.rlock();
+  for (const auto& vrfAndRouteTable : *lockedRouteTables) {
+    auto lockedRouteTable = vrfAndRouteTable.second->wlock();
+    auto now = std::chrono::steady_clock::now();
+    ChangedPrefixes toPublish;
+    releaseHeld(
+        now,
+        coalescingWindow_,
+        &lockedRouteTable->v4Published,
+        &lockedRouteTable->v4Held,
+        &toPublish.v4);
+    releaseHeld(
+        now,
+        coalescingWindow_,
+        &lockedRouteTable->v6Published,
+        &lockedRouteTable->v6Held,
+        &toPublish.v6);
+    forgetPublished(now, coalescingWindow_, &lockedRouteTable->v4Published);
+    forgetPublished(now, coalescingWindow_, &lockedRouteTable->v6Published);
+    if (toPublish.v4.empty() && toPublish.v6.empty()) {
+      continue;
+    }
+    published += toPublish.v4.size() + toPublish.v6.size();
+
+    fibUpdateCallback(
+        vrfAndRouteTable.first,
+        lockedRouteTable->v4NetworkToRoute,
+        lockedRouteTable->v6NetworkToRoute,
+        &toPublish,
+        cookie);
+  }
+  return published;
+}
+
+namespace {
+// Routes from these clients come from config, which adds them back
+bool isConfigClient(ClientID clientID) {
+  return clientID == StdClientIds2ClientID(StdClientIds::STATIC_ROUTE) ||
+      clientID == StdClientIds2ClientID(StdClientIds::INTERFACE_ROUTE) ||
+      clientID == StdClientIds2ClientID(StdClientIds::LINKLOCAL_ROUTE) ||
+      clientID == StdClientIds2ClientID(StdClientIds::STATIC_INTERNAL);
+}
+
+template <typename AddressT>
+void restoreRoutes(
+    const NetworkToRouteMap<AddressT>& routes,
+    RouteUpdater* updater,
+    boost::container::flat_set<ClientID>* clients) {
+  for (const auto& it : routes) {
+    const auto& route = it.value();
+    for (auto clientID : route.getClients()) {
+      if (isConfigClient(clientID)) {
+        continue;
+      }
+      updater->addRoute(
+          folly::IPAddress(route.prefix().network),
+          route.prefix().mask,
+          clientID,
+          *route.getEntryForClient(clientID));
+      clients->insert(clientID);
+    }
+  }
+}
+} // namespace
+
+folly::dynamic RoutingInformationBase::toFollyDynamic() const {
+  folly::dynamic snapshot = folly::dynamic::object;
+  auto lockedRouteTables = synchronizedRouteTables_.rlock();
+  for (const auto& vrfAndRouteTable : *lockedRouteTables) {
+    auto lockedRouteTable = vrfAndRouteTable.second->rlock();
+    folly::dynamic vrfSnapshot = folly::dynamic::object;
+    vrfSnapshot[kV4Routes] = lockedRouteTable->v4NetworkToRoute.toFollyDynamic();
+    vrfSnapshot[kV6Routes] = lockedRouteTable->v6NetworkToRoute.toFollyDynamic();
+    snapshot[folly::to<std::string>(vrfAndRouteTable.first)] =
+        std::move(vrfSnapshot);
+  }
+  return snapshot;
+}
+
+void RoutingInformationBase::restore(const folly::dynamic& snapshot) {
+  auto lockedRouteTables = synchronizedRouteTables_.wlock();
+  for (const auto& vrfAndSnapshot : snapshot.items()) {
+    RouterID vrf(folly::to<int>(vrfAndSnapshot.first.asString()));
+    auto routeTable = std::make_shared<SynchronizedRouteTable>();
+    {
+      auto lockedRouteTable = routeTable->wlock();
+      RouteUpdater updater(
+          &(lockedRouteTable->v4NetworkToRoute),
+          &(lockedRouteTable->v6NetworkToRoute),
+          &(lockedRouteTable->nextHopDependencies));
+      restoreRoutes(
+          *IPv4NetworkToRouteMap::fromFollyDynamic(
+              vrfAndSnapshot.second[kV4Routes]),
+          &updater,
+          &lockedRouteTable->staleClients);
+      restoreRoutes(
+          *IPv6NetworkToRouteMap::fromFollyDynamic(
+              vrfAndSnapshot.second[kV6Routes]),
+          &updater,
+          &lockedRouteTable->staleClients);
+      updater.updateDone();
+      XLOG(INFO) << "Restored " << lockedRouteTable->v4NetworkToRoute.size()
+                 << " v4 and " << lockedRouteTable->v6NetworkToRoute.size()
+                 << " v6 routes of VRF " << vrf << " from "
+                 << lockedRouteTable->staleClients.size() << " clients";
+    }
+    (*lockedRouteTables)[vrf] = std::move(routeTable);
+  }
+}
+
+std::size_t RoutingInformationBase::sweepStaleRoutes(
+    FibUpdateFunction fibUpdateCallback,
+    void* cookie) {
+  std::size_t removed = 0;
+  auto lockedRouteTables = synchronizedRouteTables_.rlock();
+  for (const auto& vrfAndRouteTable : *lockedRouteTables) {
+    auto lockedRouteTable = vrfAndRouteTable.second->wlock();
+    if (lockedRouteTable->staleClients.empty()) {
+      continue;
+    }
+
+    auto before = lockedRouteTable->v4NetworkToRoute.size() +
+        lockedRouteTable->v6NetworkToRoute.size();
+    RouteUpdater updater(
+        &(lockedRouteTable->v4NetworkToRoute),
+        &(lockedRouteTable->v6NetworkToRoute),
+        &(lockedRouteTable->nextHopDependencies));
+    for (auto clientID : lockedRouteTable->staleClients) {
+      XLOG(INFO) << "Removing stale routes of client " << clientID
+                 << " from VRF " << vrfAndRouteTable.first;
+      updater.removeAllRoutesForClient(clientID);
+    }
+    lockedRouteTable->staleClients.clear();
+    updater.updateDone();
+    removed += before - lockedRouteTable->v4NetworkToRoute.size() -
+        lockedRouteTable->v6NetworkToRoute.size();
+
+    fibUpdateCallback(
+        vrfAndRouteTable.first,
+        lockedRouteTable->v4NetworkToRoute,
+        lockedRouteTable->v6NetworkToRoute,
+        &updater.getAffectedPrefixes(),
+        cookie);
+  }
+  return removed;
+}
+
 RoutingInformationBase::RouterIDToRouteTable
 RoutingInformationBase::constructRouteTables(
-    const SynchronizedRouteTables::WLockedPtr& lockedRouteTables,
+    const RouterIDToRouteTable& routeTables,
     const RouterIDAndNetworkToInterfaceRoutes& configRouterIDToInterfaceRoutes)
     const {
   RouterIDToRouteTable newRouteTables;
 
-  RouterIDToRouteTable::iterator newRouteTablesIter;
   for (const auto& routerIDAndInterfaceRoutes :
        configRouterIDToInterfaceRoutes) {
     const RouterID configVrf = routerIDAndInterfaceRoutes.first;
 
-    newRouteTablesIter = newRouteTables.emplace_hint(
-        newRouteTables.cend(), configVrf, RouteTable());
-
-    auto oldRouteTablesIter = lockedRouteTables->find(configVrf);
-    if (oldRouteTablesIter == lockedRouteTables->end()) {
-      // configVrf did not exist in the RIB, so it has been added to
-      // newRouteTables with an empty set of routes
+    auto oldRouteTablesIter = routeTables.find(configVrf);
+    if (oldRouteTablesIter == routeTables.end()) {
+      // configVrf did not exist in the RIB, so it is added to newRouteTables
+      // with an empty set of routes
+      newRouteTables.emplace_hint(
+          newRouteTables.cend(),
+          configVrf,
+          std::make_shared<SynchronizedRouteTable>());
       continue;
     }
 
-    // configVrf exists in the RIB, so it will be shallow copied into
+    // configVrf exists in the RIB, so its RouteTable is shared with
     // newRouteTables.
-    newRouteTablesIter->second = std::move(oldRouteTablesIter->second);
+    newRouteTables.emplace_hint(
+        newRouteTables.cend(), configVrf, oldRouteTablesIter->second);
   }
 
   return newRouteTables;
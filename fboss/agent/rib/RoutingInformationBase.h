@@ -11,8 +11,12 @@
 
 #include "fboss/agent/types.h"
 
+#include <boost/container/flat_set.hpp>
 #include <folly/Synchronized.h>
+#include <folly/dynamic.h>
+#include <chrono>
 #include <functional>
+#include <map>
 #include <memory>
 #include <thread>
 #include <vector>
@@ -20,6 +24,8 @@
 #include "fboss/agent/gen-cpp2/switch_config_types.h"
 #include "fboss/agent/if/gen-cpp2/FbossCtrl.h"
 #include "fboss/agent/rib/NetworkToRouteMap.h"
+#include "fboss/agent/rib/NextHopDependencyIndex.h"
+#include "fboss/agent/rib/RouteTypes.h"
 
 namespace facebook {
 namespace fboss {
@@ -27,10 +33,14 @@ namespace rib {
 
 class RoutingInformationBase {
  public:
+  // changedPrefixes is the set of prefixes whose forwarding information may
+  // differ from what was last published to the FIB of vrf. It is null when
+  // the FIB has to be rebuilt from scratch, as it is after reconfigure().
   using FibUpdateFunction = std::function<void(
       RouterID vrf,
       const IPv4NetworkToRouteMap& v4NetworkToRoute,
       const IPv6NetworkToRouteMap& v6NetworkToRoute,
+      const ChangedPrefixes* changedPrefixes,
       void* cookie)>;
 
   struct UpdateStatistics {
@@ -38,11 +48,21 @@ class RoutingInformationBase {
     std::size_t v4RoutesDeleted{0};
     std::size_t v6RoutesAdded{0};
     std::size_t v6RoutesDeleted{0};
+    // Routes whose forwarding info was recomputed by recursive resolution
+    std::size_t routesResolved{0};
+    // With a coalescing window, prefix changes held back from the FIB, and
+    // changes folded into one already held back, which the FIB never sees
+    std::size_t routesHeld{0};
+    std::size_t routesCoalesced{0};
     std::chrono::microseconds duration{0};
+    // Parts of duration spent waiting for the VRF's RouteTable, and in
+    // fibUpdateCallback
+    std::chrono::microseconds lockWait{0};
+    std::chrono::microseconds fibUpdateDuration{0};
   };
 
-  /* update first acquires exclusive ownership of the RIB and executes the
-   * following sequence of actions:
+  /* update first acquires exclusive ownership of the RouteTable for routerID
+   * and executes the following sequence of actions:
    * 1. Injects and removes routes in `toAdd` and `toDelete`, respectively.
    * 2. Triggers recursive (IP) resolution.
    * 3. Updates the FIB synchronously.
@@ -53,6 +73,9 @@ class RoutingInformationBase {
    * this mapping is exposed via SwSwitch, which we can't a dependency on here.
    * The adminDistanceFromClientID allows callsites to propogate admin distances
    * per client.
+   *
+   * Updates to different VRFs may run concurrently. Updates to the same VRF,
+   * including their invocations of fibUpdateCallback, are serialized.
    */
   UpdateStatistics update(
       RouterID routerID,
@@ -87,31 +110,86 @@ class RoutingInformationBase {
       FibUpdateFunction fibUpdateCallback,
       void* cookie);
 
+  /*
+   * A snapshot of the routes of every VRF, which a restarted agent can load
+   * with restore() so that it does not start with an empty RIB.
+   */
+  folly::dynamic toFollyDynamic() const;
+
+  /*
+   * Loads the routes of a toFollyDynamic() snapshot, replacing any VRF it
+   * holds. This is meant to be called before the first reconfigure(), which
+   * publishes the restored routes to the FIB. Routes that come from config
+   * are left out, since reconfigure() adds those back itself.
+   *
+   * The clients of the restored routes are marked stale. The first update()
+   * that resets a client's routes clears the mark, and drops the restored
+   * routes the client did not add again; sweepStaleRoutes() drops the routes
+   * of the clients that have not done so.
+   */
+  void restore(const folly::dynamic& snapshot);
+
+  // Returns the number of routes removed
+  std::size_t sweepStaleRoutes(
+      FibUpdateFunction fibUpdateCallback,
+      void* cookie);
+
+  /*
+   * Route flap coalescing. With a non-zero window, update() publishes the
+   * change of a prefix to the FIB right away only if the prefix was not
+   * published within the last window. Otherwise the change is held back, and
+   * any further changes to the prefix are folded into it, until the hold has
+   * lasted window; the next update() or publishCoalescedRoutes() then
+   * publishes it. A flapping prefix thus reaches the FIB at most once per
+   * window, and callers bound the delay by calling publishCoalescedRoutes()
+   * periodically. The window is meant to be set before the first update().
+   */
+  void setCoalescingWindow(std::chrono::milliseconds window) {
+    coalescingWindow_ = window;
+  }
+
+  // Returns the number of held back prefixes published
+  std::size_t publishCoalescedRoutes(
+      FibUpdateFunction fibUpdateCallback,
+      void* cookie);
+
  private:
   struct RouteTable {
     RouteTable() = default;
 
     IPv4NetworkToRouteMap v4NetworkToRoute;
     IPv6NetworkToRouteMap v6NetworkToRoute;
+    NextHopDependencyIndex nextHopDependencies;
+    // Clients whose routes were restored and have not been synced since
+    boost::container::flat_set<ClientID> staleClients;
+    // With a coalescing window, when prefixes were last published to the FIB
+    // (pruned once older than the window), and the prefixes held back with
+    // when they were first held
+    std::map<PrefixV4, std::chrono::steady_clock::time_point> v4Published;
+    std::map<PrefixV6, std::chrono::steady_clock::time_point> v6Published;
+    std::map<PrefixV4, std::chrono::steady_clock::time_point> v4Held;
+    std::map<PrefixV6, std::chrono::steady_clock::time_point> v6Held;
 
     UpdateStatistics lastUpdateStats_;
   };
 
-  // Currently, route updates to separate VRFs are made to be sequential. In the
-  // event FBOSS has to operate in a routing architecture with numerous VRFs,
-  // we can avoid a slow down by a factor of the the number of VRFs by
-  // parallelizing route updates across VRFs. This can be accomplished simply by
-  // associating the mutex implicit in folly::Synchronized with an individual
-  // RouteTable.
-  using RouterIDToRouteTable = boost::container::flat_map<RouterID, RouteTable>;
+  // Each VRF's RouteTable is guarded by its own lock so that route updates to
+  // separate VRFs proceed in parallel. The lock on RouterIDToRouteTable only
+  // protects the set of VRFs: update() holds it shared for the duration of the
+  // update, while reconfigure() holds it exclusively just long enough to add
+  // and remove VRFs.
+  using SynchronizedRouteTable = folly::Synchronized<RouteTable>;
+  using RouterIDToRouteTable = boost::container::
+      flat_map<RouterID, std::shared_ptr<SynchronizedRouteTable>>;
   using SynchronizedRouteTables = folly::Synchronized<RouterIDToRouteTable>;
 
   RouterIDToRouteTable constructRouteTables(
-      const SynchronizedRouteTables::WLockedPtr& lockedRouteTables,
+      const RouterIDToRouteTable& routeTables,
       const RouterIDAndNetworkToInterfaceRoutes&
           configRouterIDToInterfaceRoutes) const;
 
   SynchronizedRouteTables synchronizedRouteTables_;
+  std::chrono::milliseconds coalescingWindow_{0};
 };
 
 } // namespace rib
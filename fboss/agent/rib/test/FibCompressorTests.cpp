@@ -0,0 +1,144 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/rib/FibCompressor.h"
+
+#include <folly/Conv.h>
+#include <folly/IPAddress.h>
+#include <folly/IPAddressV4.h>
+#include <gtest/gtest.h>
+
+#include <map>
+#include <string>
+
+using facebook::fboss::AdminDistance;
+using facebook::fboss::InterfaceID;
+using facebook::fboss::ResolvedNextHop;
+using facebook::fboss::RouteNextHopEntry;
+using facebook::fboss::ECMP_WEIGHT;
+using folly::IPAddress;
+using folly::IPAddressV4;
+
+using Compressor = facebook::fboss::rib::FibCompressor<IPAddressV4>;
+using Route = facebook::fboss::Route<IPAddressV4>;
+
+namespace {
+
+std::shared_ptr<Route> makeRoute(const std::string& prefix, int nextHop) {
+  auto network = IPAddress::createNetwork(prefix);
+  auto route = std::make_shared<Route>(
+      Route::Prefix{network.first.asV4(), network.second});
+  route->setResolved(RouteNextHopEntry(
+      ResolvedNextHop(
+          IPAddress(folly::to<std::string>("1.1.1.", nextHop)),
+          InterfaceID(1),
+          ECMP_WEIGHT),
+      AdminDistance::EBGP));
+  return route;
+}
+
+// What is programmed after applying changes
+class Programmed {
+ public:
+  void apply(const Compressor::Changes& changes) {
+    for (const auto& route : changes.removed) {
+      EXPECT_EQ(1, routes_.erase(route->prefix().str()));
+    }
+    for (const auto& oldAndNew : changes.addedChanged) {
+      auto prefix = oldAndNew.second->prefix().str();
+      EXPECT_EQ(oldAndNew.first != nullptr, routes_.count(prefix) > 0);
+      routes_[prefix] = oldAndNew.second;
+    }
+  }
+
+  std::map<std::string, std::shared_ptr<Route>> routes_;
+};
+
+} // namespace
+
+TEST(FibCompressor, MergeSiblings) {
+  Compressor compressor;
+  compressor.update(nullptr, makeRoute("10.0.0.0/25", 1));
+  compressor.update(nullptr, makeRoute("10.0.0.128/25", 1));
+  Programmed programmed;
+  programmed.apply(compressor.flush());
+
+  ASSERT_EQ(1, programmed.routes_.size());
+  EXPECT_EQ(1, programmed.routes_.count("10.0.0.0/24"));
+  EXPECT_EQ(2, compressor.numRoutes());
+  EXPECT_EQ(1, compressor.numEntries());
+}
+
+TEST(FibCompressor, DropRedundantMoreSpecific) {
+  Compressor compressor;
+  compressor.update(nullptr, makeRoute("0.0.0.0/0", 1));
+  compressor.update(nullptr, makeRoute("10.0.0.0/8", 2));
+  compressor.update(nullptr, makeRoute("10.1.0.0/16", 2));
+  compressor.update(nullptr, makeRoute("10.1.1.0/24", 1));
+  Programmed programmed;
+  programmed.apply(compressor.flush());
+
+  EXPECT_EQ(3, programmed.routes_.size());
+  EXPECT_EQ(1, programmed.routes_.count("0.0.0.0/0"));
+  EXPECT_EQ(1, programmed.routes_.count("10.0.0.0/8"));
+  EXPECT_EQ(1, programmed.routes_.count("10.1.1.0/24"));
+}
+
+TEST(FibCompressor, KeepNoRouteGaps) {
+  // Without a default route, 10.0.1.0/24 must keep missing
+  Compressor compressor;
+  compressor.update(nullptr, makeRoute("10.0.0.0/24", 1));
+  compressor.update(nullptr, makeRoute("10.0.2.0/24", 1));
+  compressor.update(nullptr, makeRoute("10.0.3.0/24", 1));
+  Programmed programmed;
+  programmed.apply(compressor.flush());
+
+  EXPECT_EQ(2, programmed.routes_.size());
+  EXPECT_EQ(1, programmed.routes_.count("10.0.0.0/24"));
+  EXPECT_EQ(1, programmed.routes_.count("10.0.2.0/23"));
+}
+
+TEST(FibCompressor, Incremental) {
+  Compressor compressor;
+  auto low = makeRoute("10.0.0.0/25", 1);
+  auto high = makeRoute("10.0.0.128/25", 1);
+  compressor.update(nullptr, low);
+  compressor.update(nullptr, high);
+  Programmed programmed;
+  programmed.apply(compressor.flush());
+
+  // Nothing changed, nothing to program
+  auto changes = compressor.flush();
+  EXPECT_TRUE(changes.removed.empty());
+  EXPECT_TRUE(changes.addedChanged.empty());
+
+  // Splitting the aggregate only takes one more specific
+  auto newHigh = makeRoute("10.0.0.128/25", 2);
+  compressor.update(high, newHigh);
+  changes = compressor.flush();
+  EXPECT_TRUE(changes.removed.empty());
+  EXPECT_EQ(1, changes.addedChanged.size());
+  programmed.apply(changes);
+  EXPECT_EQ(2, programmed.routes_.size());
+  EXPECT_EQ(1, programmed.routes_.count("10.0.0.0/24"));
+  EXPECT_EQ(1, programmed.routes_.count("10.0.0.128/25"));
+
+  // And merging it back
+  compressor.update(newHigh, high);
+  programmed.apply(compressor.flush());
+  EXPECT_EQ(1, programmed.routes_.size());
+  EXPECT_EQ(1, programmed.routes_.count("10.0.0.0/24"));
+
+  compressor.update(low, nullptr);
+  compressor.update(high, nullptr);
+  programmed.apply(compressor.flush());
+  EXPECT_TRUE(programmed.routes_.empty());
+  EXPECT_EQ(0, compressor.numRoutes());
+  EXPECT_EQ(0, compressor.numEntries());
+}
@@ -48,9 +48,10 @@ void dynamicFibUpdate(
     facebook::fboss::RouterID vrf,
     const facebook::fboss::rib::IPv4NetworkToRouteMap& v4NetworkToRoute,
     const facebook::fboss::rib::IPv6NetworkToRouteMap& v6NetworkToRoute,
+    const facebook::fboss::rib::ChangedPrefixes* changedPrefixes,
     void* cookie) {
   facebook::fboss::rib::ForwardingInformationBaseUpdater fibUpdater(
-      vrf, v4NetworkToRoute, v6NetworkToRoute);
+      vrf, v4NetworkToRoute, v6NetworkToRoute, changedPrefixes);
 
   auto sw = static_cast<facebook::fboss::SwSwitch*>(cookie);
   sw->updateStateBlocking("", std::move(fibUpdater));
@@ -511,3 +512,167 @@ TEST(Rib, Update) {
   // + the one that gets added by default
   EXPECT_FIB_SIZE(state, vrfZero, 4, 4);
 }
+
+TEST(Rib, UpdateOnlyReplacesChangedFibRoutes) {
+  using namespace facebook::fboss;
+
+  const RouterID vrfZero{0};
+
+  cfg::SwitchConfig config;
+  config.vlans.resize(1);
+  config.vlans[0].id = 1;
+  config.interfaces.resize(1);
+  config.interfaces[0].intfID = 1;
+  config.interfaces[0].vlanID = 1;
+  config.interfaces[0].routerID = 0;
+  config.interfaces[0].__isset.mac = true;
+  config.interfaces[0].mac_ref().value_unchecked() = "00:02:00:00:00:01";
+  config.interfaces[0].ipAddresses.resize(1);
+  config.interfaces[0].ipAddresses[0] = "192.168.0.19/24";
+
+  auto testHandle = createTestHandle(&config, ENABLE_STANDALONE_RIB);
+  auto sw = testHandle->getSw();
+
+  auto nexthop = folly::IPAddressV4("192.168.0.20");
+  auto prefixA = folly::CIDRNetworkV4(folly::IPAddressV4("7.1.0.0"), 16);
+  auto prefixB = folly::CIDRNetworkV4(folly::IPAddressV4("7.2.0.0"), 16);
+
+  std::vector<UnicastRoute> routeToPrefixA;
+  routeToPrefixA.push_back(
+      createUnicastRoute(prefixA.first, prefixA.second, nexthop));
+  sw->rib()->update(
+      vrfZero,
+      ClientID(10),
+      AdminDistance::EBGP,
+      routeToPrefixA,
+      {},
+      false /* sync */,
+      "rib update unit test",
+      &dynamicFibUpdate,
+      static_cast<void*>(sw));
+
+  auto stateBefore = sw->getState();
+  auto interfaceRouteBefore = getRoute(
+      stateBefore, vrfZero, folly::IPAddressV4("192.168.0.0"), 24);
+  auto routeABefore =
+      getRoute(stateBefore, vrfZero, prefixA.first, prefixA.second);
+  ASSERT_NE(nullptr, interfaceRouteBefore);
+  ASSERT_NE(nullptr, routeABefore);
+
+  std::vector<UnicastRoute> routeToPrefixB;
+  routeToPrefixB.push_back(
+      createUnicastRoute(prefixB.first, prefixB.second, nexthop));
+  sw->rib()->update(
+      vrfZero,
+      ClientID(10),
+      AdminDistance::EBGP,
+      routeToPrefixB,
+      {},
+      false /* sync */,
+      "rib update unit test",
+      &dynamicFibUpdate,
+      static_cast<void*>(sw));
+
+  // Routes untouched by the update are carried over into the new FIB as is
+  auto stateAfter = sw->getState();
+  EXPECT_EQ(
+      interfaceRouteBefore,
+      getRoute(stateAfter, vrfZero, folly::IPAddressV4("192.168.0.0"), 24));
+  EXPECT_EQ(
+      routeABefore,
+      getRoute(stateAfter, vrfZero, prefixA.first, prefixA.second));
+  auto routeBBefore =
+      getRoute(stateAfter, vrfZero, prefixB.first, prefixB.second);
+  ASSERT_NE(nullptr, routeBBefore);
+
+  facebook::fboss::IpPrefix prefixToDelete;
+  prefixToDelete.set_ip(facebook::network::toBinaryAddress(prefixA.first));
+  prefixToDelete.set_prefixLength(prefixA.second);
+  sw->rib()->update(
+      vrfZero,
+      ClientID(10),
+      AdminDistance::EBGP,
+      {},
+      {prefixToDelete},
+      false /* sync */,
+      "rib update unit test",
+      &dynamicFibUpdate,
+      static_cast<void*>(sw));
+
+  stateAfter = sw->getState();
+  EXPECT_NO_ROUTE(stateAfter, vrfZero, prefixA.first, prefixA.second);
+  EXPECT_EQ(
+      routeBBefore,
+      getRoute(stateAfter, vrfZero, prefixB.first, prefixB.second));
+}
+
+TEST(Rib, RestoreSnapshotAndSweepStaleRoutes) {
+  using namespace facebook::fboss;
+
+  const RouterID vrfZero{0};
+
+  cfg::SwitchConfig config;
+  config.vlans.resize(1);
+  config.vlans[0].id = 1;
+  config.interfaces.resize(1);
+  config.interfaces[0].intfID = 1;
+  config.interfaces[0].vlanID = 1;
+  config.interfaces[0].routerID = 0;
+  config.interfaces[0].__isset.mac = true;
+  config.interfaces[0].mac_ref().value_unchecked() = "00:02:00:00:00:01";
+  config.interfaces[0].ipAddresses.resize(1);
+  config.interfaces[0].ipAddresses[0] = "192.168.0.19/24";
+
+  auto testHandle = createTestHandle(&config, ENABLE_STANDALONE_RIB);
+  auto sw = testHandle->getSw();
+
+  auto nexthop = folly::IPAddressV4("192.168.0.20");
+  auto prefixA = folly::CIDRNetworkV4(folly::IPAddressV4("7.1.0.0"), 16);
+  auto prefixB = folly::CIDRNetworkV4(folly::IPAddressV4("7.2.0.0"), 16);
+  std::vector<UnicastRoute> routeToPrefixA{
+      createUnicastRoute(prefixA.first, prefixA.second, nexthop)};
+  std::vector<UnicastRoute> routeToPrefixB{
+      createUnicastRoute(prefixB.first, prefixB.second, nexthop)};
+
+  for (auto clientAndRoute :
+       {std::make_pair(ClientID(10), routeToPrefixA),
+        std::make_pair(ClientID(20), routeToPrefixB)}) {
+    sw->rib()->update(
+        vrfZero,
+        clientAndRoute.first,
+        AdminDistance::EBGP,
+        clientAndRoute.second,
+        {},
+        false /* sync */,
+        "rib update unit test",
+        &dynamicFibUpdate,
+        static_cast<void*>(sw));
+  }
+
+  auto noopFibUpdate = [](RouterID,
+                          const rib::IPv4NetworkToRouteMap&,
+                          const rib::IPv6NetworkToRouteMap&,
+                          const rib::ChangedPrefixes*,
+                          void*) {};
+
+  // The interface route comes from config, and is not restored
+  rib::RoutingInformationBase restored;
+  restored.restore(sw->rib()->toFollyDynamic());
+  EXPECT_EQ(2, restored.toFollyDynamic()["0"]["v4Routes"]["routes"].size());
+
+  // Client 10 syncs the same route, client 20 never comes back
+  auto stats = restored.update(
+      vrfZero,
+      ClientID(10),
+      AdminDistance::EBGP,
+      routeToPrefixA,
+      {},
+      true /* sync */,
+      "rib sync unit test",
+      noopFibUpdate,
+      nullptr);
+  EXPECT_EQ(0, stats.routesResolved);
+  EXPECT_EQ(1, restored.sweepStaleRoutes(noopFibUpdate, nullptr));
+  EXPECT_EQ(1, restored.toFollyDynamic()["0"]["v4Routes"]["routes"].size());
+  EXPECT_EQ(0, restored.sweepStaleRoutes(noopFibUpdate, nullptr));
+}
@@ -0,0 +1,159 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/rib/RoutingInformationBase.h"
+
+#include "fboss/agent/AddressUtil.h"
+#include "fboss/agent/rib/NetworkToRouteMap.h"
+#include "fboss/agent/types.h"
+
+#include <folly/IPAddressV4.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using facebook::fboss::AdminDistance;
+using facebook::fboss::ClientID;
+using facebook::fboss::InterfaceID;
+using facebook::fboss::IpPrefix;
+using facebook::fboss::RouterID;
+using facebook::fboss::UnicastRoute;
+using facebook::fboss::rib::ChangedPrefixes;
+using facebook::fboss::rib::IPv4NetworkToRouteMap;
+using facebook::fboss::rib::IPv6NetworkToRouteMap;
+using facebook::fboss::rib::PrefixV4;
+using facebook::fboss::rib::RoutingInformationBase;
+using facebook::network::toBinaryAddress;
+
+namespace {
+
+const ClientID kBgpClientID(0);
+const RouterID kVrf(0);
+
+// The prefixes each FIB update published
+void recordFibUpdate(
+    RouterID /* vrf */,
+    const IPv4NetworkToRouteMap& /* v4NetworkToRoute */,
+    const IPv6NetworkToRouteMap& /* v6NetworkToRoute */,
+    const ChangedPrefixes* changedPrefixes,
+    void* cookie) {
+  auto published = static_cast<std::vector<PrefixV4>*>(cookie);
+  if (changedPrefixes) {
+    const auto& v4 = changedPrefixes->v4;
+    published->insert(published->end(), v4.begin(), v4.end());
+  }
+}
+
+class RouteCoalescingTest : public ::testing::Test {
+ public:
+  void SetUp() override {
+    RoutingInformationBase::RouterIDAndNetworkToInterfaceRoutes interfaces;
+    folly::IPAddressV4 interfaceAddress("10.0.0.1");
+    interfaces[kVrf].emplace(
+        folly::CIDRNetwork(interfaceAddress.mask(24), 24),
+        std::make_pair(InterfaceID(1), folly::IPAddress(interfaceAddress)));
+    rib_.reconfigure(
+        interfaces,
+        {} /* staticRoutesWithNextHops */,
+        {} /* staticRoutesToNull */,
+        {} /* staticRoutesToCpu */,
+        &recordFibUpdate,
+        &published_);
+    published_.clear();
+  }
+
+  RoutingInformationBase::UpdateStatistics add() {
+    UnicastRoute route;
+    route.dest = prefix();
+    route.nextHopAddrs.push_back(
+        toBinaryAddress(folly::IPAddressV4("10.0.0.2")));
+    return rib_.update(
+        kVrf,
+        kBgpClientID,
+        AdminDistance::EBGP,
+        {route},
+        {} /* prefixes to delete */,
+        false /* reset routes for client */,
+        "add",
+        &recordFibUpdate,
+        &published_);
+  }
+
+  RoutingInformationBase::UpdateStatistics del() {
+    return rib_.update(
+        kVrf,
+        kBgpClientID,
+        AdminDistance::EBGP,
+        {} /* routes to add */,
+        {prefix()},
+        false /* reset routes for client */,
+        "delete",
+        &recordFibUpdate,
+        &published_);
+  }
+
+  static IpPrefix prefix() {
+    IpPrefix prefix;
+    prefix.ip = toBinaryAddress(folly::IPAddressV4("100.0.0.0"));
+    prefix.prefixLength = 24;
+    return prefix;
+  }
+
+  RoutingInformationBase rib_;
+  std::vector<PrefixV4> published_;
+};
+
+} // namespace
+
+TEST_F(RouteCoalescingTest, PublishImmediatelyWithoutWindow) {
+  add();
+  del();
+  add();
+  EXPECT_EQ(3, published_.size());
+}
+
+TEST_F(RouteCoalescingTest, HoldFlapsWithinWindow) {
+  rib_.setCoalescingWindow(std::chrono::hours(1));
+
+  // A prefix that has not changed lately goes straight to the FIB
+  auto stats = add();
+  EXPECT_EQ(0, stats.routesHeld);
+  ASSERT_EQ(1, published_.size());
+
+  stats = del();
+  EXPECT_EQ(1, stats.routesHeld);
+  stats = add();
+  EXPECT_EQ(0, stats.routesHeld);
+  EXPECT_EQ(1, stats.routesCoalesced);
+  EXPECT_EQ(1, published_.size());
+
+  // Still within the window
+  EXPECT_EQ(0, rib_.publishCoalescedRoutes(&recordFibUpdate, &published_));
+  EXPECT_EQ(1, published_.size());
+}
+
+TEST_F(RouteCoalescingTest, PublishOnceWindowPasses) {
+  auto window = std::chrono::milliseconds(20);
+  rib_.setCoalescingWindow(window);
+
+  add();
+  del();
+  add();
+  ASSERT_EQ(1, published_.size());
+
+  std::this_thread::sleep_for(2 * window);
+  EXPECT_EQ(1, rib_.publishCoalescedRoutes(&recordFibUpdate, &published_));
+  ASSERT_EQ(2, published_.size());
+  EXPECT_EQ(published_[0], published_[1]);
+
+  // Nothing left held back
+  EXPECT_EQ(0, rib_.publishCoalescedRoutes(&recordFibUpdate, &published_));
+}
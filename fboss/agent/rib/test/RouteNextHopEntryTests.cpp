@@ -158,3 +158,19 @@ TEST(RouteNextHopEntry, EmptyListIsDrop) {
   ASSERT_EQ(nextHopEntry.getAdminDistance(), kDefaultAdminDistance);
   ASSERT_EQ(nextHopEntry.getNextHopSet().size(), 0);
 }
+
+TEST(RouteNextHopEntry, EqualNextHopSetsAreShared) {
+  RouteNextHopEntry::NextHopSet nhops(nextHops.begin(), nextHops.end());
+  RouteNextHopEntry entry1(nhops, kDefaultAdminDistance);
+  RouteNextHopEntry entry2(nhops, kDefaultAdminDistance);
+
+  ASSERT_EQ(&entry1.getNextHopSet(), &entry2.getNextHopSet());
+  ASSERT_EQ(entry1, entry2);
+
+  RouteNextHopEntry::NextHopSet fewerNhops(
+      nextHops.begin(), nextHops.end() - 1);
+  RouteNextHopEntry entry3(fewerNhops, kDefaultAdminDistance);
+
+  ASSERT_NE(&entry1.getNextHopSet(), &entry3.getNextHopSet());
+  ASSERT_FALSE(entry1 == entry3);
+}
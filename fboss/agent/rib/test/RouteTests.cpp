@@ -11,6 +11,7 @@
 #include "fboss/agent/FbossError.h"
 #include "fboss/agent/Utils.h"
 #include "fboss/agent/rib/NetworkToRouteMap.h"
+#include "fboss/agent/rib/NextHopDependencyIndex.h"
 #include "fboss/agent/rib/RouteNextHop.h"
 #include "fboss/agent/rib/RouteNextHopEntry.h"
 #include "fboss/agent/rib/RouteTypes.h"
@@ -21,6 +22,7 @@
 #include <folly/logging/xlog.h>
 
 #include <gtest/gtest.h>
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -1601,6 +1603,158 @@ TEST(Route, withInvalidLabelForwardingAction) {
       FbossError);
 }
 
+// Incremental resolution should always produce the same routes as resolving
+// every route from scratch.
+TEST(Route, IncrementalResolutionMatchesFullResolution) {
+  IPv4NetworkToRouteMap fullV4Routes;
+  IPv6NetworkToRouteMap fullV6Routes;
+  IPv4NetworkToRouteMap incrementalV4Routes;
+  IPv6NetworkToRouteMap incrementalV6Routes;
+  NextHopDependencyIndex nextHopDependencies;
+
+  auto update = [&](std::function<void(RouteUpdater*)> changes) {
+    {
+      RouteUpdater updater(&fullV4Routes, &fullV6Routes);
+      changes(&updater);
+      updater.updateDone();
+    }
+    {
+      RouteUpdater updater(
+          &incrementalV4Routes, &incrementalV6Routes, &nextHopDependencies);
+      changes(&updater);
+      updater.updateDone();
+    }
+    EXPECT_ROUTES_MATCH(&fullV4Routes, &incrementalV4Routes);
+    EXPECT_ROUTES_MATCH(&fullV6Routes, &incrementalV6Routes);
+  };
+
+  update([](RouteUpdater* updater) {
+    updater->addInterfaceRoute(
+        IPAddress("1.1.1.1"), 24, IPAddress("1.1.1.1"), InterfaceID(1));
+    updater->addInterfaceRoute(
+        IPAddress("2.2.2.2"), 24, IPAddress("2.2.2.2"), InterfaceID(2));
+    updater->addInterfaceRoute(
+        IPAddress("1::1"), 48, IPAddress("1::1"), InterfaceID(1));
+  });
+
+  // 20/8 resolves through 10/8, 30/8 is unresolvable and 2001::/64 has a v4
+  // next hop
+  update([](RouteUpdater* updater) {
+    updater->addRoute(
+        IPAddress("10.0.0.0"),
+        8,
+        kClientA,
+        RouteNextHopEntry(makeNextHops({"1.1.1.10"}), kDistance));
+    updater->addRoute(
+        IPAddress("20.0.0.0"),
+        8,
+        kClientA,
+        RouteNextHopEntry(makeNextHops({"10.1.1.1"}), kDistance));
+    updater->addRoute(
+        IPAddress("30.0.0.0"),
+        8,
+        kClientA,
+        RouteNextHopEntry(makeNextHops({"40.1.1.1"}), kDistance));
+    updater->addRoute(
+        IPAddress("2001::"),
+        64,
+        kClientA,
+        RouteNextHopEntry(makeNextHops({"20.1.1.1", "1::10"}), kDistance));
+  });
+  EXPECT_FALSE(getRoute(incrementalV4Routes, "30.0.0.0/8")->isResolved());
+
+  // 30/8 becomes resolvable
+  update([](RouteUpdater* updater) {
+    updater->addRoute(
+        IPAddress("40.0.0.0"),
+        8,
+        kClientB,
+        RouteNextHopEntry(makeNextHops({"2.2.2.10"}), kDistance));
+  });
+  EXPECT_RESOLVED(getRoute(incrementalV4Routes, "30.0.0.0/8"));
+
+  // A more specific route takes over resolution of 20/8 and, transitively,
+  // of 2001::/64
+  update([](RouteUpdater* updater) {
+    updater->addRoute(
+        IPAddress("10.1.0.0"),
+        16,
+        kClientB,
+        RouteNextHopEntry(makeNextHops({"2.2.2.20"}), kDistance));
+  });
+  EXPECT_FWD_INFO(
+      getRoute(incrementalV4Routes, "20.0.0.0/8"), InterfaceID(2), "2.2.2.20");
+
+  update([](RouteUpdater* updater) {
+    updater->delRoute(IPAddress("10.1.0.0"), 16, kClientB);
+  });
+  EXPECT_FWD_INFO(
+      getRoute(incrementalV4Routes, "20.0.0.0/8"), InterfaceID(1), "1.1.1.10");
+
+  update([](RouteUpdater* updater) {
+    updater->removeAllRoutesForClient(kClientB);
+  });
+  EXPECT_FALSE(getRoute(incrementalV4Routes, "30.0.0.0/8")->isResolved());
+
+  // Moving an interface re-resolves everything that resolves through it
+  update([](RouteUpdater* updater) {
+    updater->delRoute(
+        IPAddress("1.1.1.0"),
+        24,
+        StdClientIds2ClientID(StdClientIds::INTERFACE_ROUTE));
+    updater->addInterfaceRoute(
+        IPAddress("1.1.1.1"), 24, IPAddress("1.1.1.1"), InterfaceID(3));
+  });
+  EXPECT_FWD_INFO(
+      getRoute(incrementalV4Routes, "20.0.0.0/8"), InterfaceID(3), "1.1.1.10");
+}
+
+TEST(Route, IncrementalResolutionOnlyResolvesDependents) {
+  IPv4NetworkToRouteMap v4Routes;
+  IPv6NetworkToRouteMap v6Routes;
+  NextHopDependencyIndex nextHopDependencies;
+
+  constexpr auto kNumRoutes = 100;
+  {
+    RouteUpdater updater(&v4Routes, &v6Routes, &nextHopDependencies);
+    updater.addInterfaceRoute(
+        IPAddress("1.1.1.1"), 24, IPAddress("1.1.1.1"), InterfaceID(1));
+    updater.addInterfaceRoute(
+        IPAddress("2.2.2.2"), 24, IPAddress("2.2.2.2"), InterfaceID(2));
+    for (auto i = 0; i < kNumRoutes; ++i) {
+      updater.addRoute(
+          IPAddressV4::fromLongHBO((100 << 24) + (i << 8)),
+          24,
+          kClientA,
+          RouteNextHopEntry(makeNextHops({"1.1.1.10"}), kDistance));
+    }
+    updater.updateDone();
+    EXPECT_EQ(kNumRoutes + 2, updater.getResolvedRouteCount());
+  }
+
+  {
+    RouteUpdater updater(&v4Routes, &v6Routes, &nextHopDependencies);
+    updater.addRoute(
+        IPAddress("50.0.0.0"),
+        8,
+        kClientA,
+        RouteNextHopEntry(makeNextHops({"2.2.2.10"}), kDistance));
+    updater.updateDone();
+    EXPECT_EQ(1, updater.getResolvedRouteCount());
+    EXPECT_RESOLVED(getRoute(v4Routes, "50.0.0.0/8"));
+  }
+
+  {
+    RouteUpdater updater(&v4Routes, &v6Routes, &nextHopDependencies);
+    updater.addInterfaceRoute(
+        IPAddress("1.1.1.1"), 24, IPAddress("1.1.1.1"), InterfaceID(3));
+    updater.updateDone();
+    EXPECT_EQ(kNumRoutes + 1, updater.getResolvedRouteCount());
+    EXPECT_FWD_INFO(
+        getRoute(v4Routes, "100.0.0.0/24"), InterfaceID(3), "1.1.1.10");
+  }
+}
+
 /*
  * Class that makes it easy to run tests with the following
  * configurable entities:
@@ -0,0 +1,138 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/rib/RoutingInformationBase.h"
+
+#include "fboss/agent/AddressUtil.h"
+#include "fboss/agent/rib/NetworkToRouteMap.h"
+#include "fboss/agent/types.h"
+
+#include <folly/Benchmark.h>
+#include <folly/IPAddressV4.h>
+#include <folly/init/Init.h>
+
+#include <thread>
+#include <vector>
+
+using facebook::fboss::AdminDistance;
+using facebook::fboss::ClientID;
+using facebook::fboss::InterfaceID;
+using facebook::fboss::RouterID;
+using facebook::fboss::UnicastRoute;
+using facebook::fboss::rib::ChangedPrefixes;
+using facebook::fboss::rib::IPv4NetworkToRouteMap;
+using facebook::fboss::rib::IPv6NetworkToRouteMap;
+using facebook::fboss::rib::RoutingInformationBase;
+using facebook::network::toBinaryAddress;
+
+DEFINE_int32(
+    routes_per_vrf,
+    10000,
+    "The number of routes each thread programs into its VRF per iteration");
+
+namespace {
+
+const ClientID kBgpClientID(0);
+
+void noopFibUpdate(
+    RouterID /* vrf */,
+    const IPv4NetworkToRouteMap& /* v4NetworkToRoute */,
+    const IPv6NetworkToRouteMap& /* v6NetworkToRoute */,
+    const ChangedPrefixes* /* changedPrefixes */,
+    void* /* cookie */) {}
+
+// VRF i has a single interface, i, with the address 10.i.0.1/16. Every route
+// programmed into VRF i resolves through that interface.
+RoutingInformationBase::RouterIDAndNetworkToInterfaceRoutes interfaceRoutes(
+    std::size_t numVrfs) {
+  RoutingInformationBase::RouterIDAndNetworkToInterfaceRoutes routes;
+  for (std::size_t vrf = 0; vrf < numVrfs; ++vrf) {
+    folly::IPAddressV4 interfaceAddress =
+        folly::IPAddressV4::fromLongHBO((10 << 24) | (vrf << 16) | 1);
+    routes[RouterID(vrf)].emplace(
+        folly::CIDRNetwork(interfaceAddress.mask(16), 16),
+        std::make_pair(InterfaceID(vrf), folly::IPAddress(interfaceAddress)));
+  }
+  return routes;
+}
+
+std::vector<UnicastRoute> routesForVrf(std::size_t vrf, std::size_t count) {
+  auto nextHop = toBinaryAddress(
+      folly::IPAddressV4::fromLongHBO((10 << 24) | (vrf << 16) | 2));
+
+  std::vector<UnicastRoute> routes;
+  routes.reserve(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    // 100.0.0.0/24, 100.0.1.0/24, ...
+    UnicastRoute route;
+    route.dest.ip = toBinaryAddress(
+        folly::IPAddressV4::fromLongHBO((100 << 24) + (i << 8)));
+    route.dest.prefixLength = 24;
+    route.nextHopAddrs.push_back(nextHop);
+    routes.push_back(std::move(route));
+  }
+  return routes;
+}
+
+// Each of numVrfs threads syncs FLAGS_routes_per_vrf routes into its own
+// VRF. With per-VRF locking, the time per iteration should stay roughly flat as
+// numVrfs grows, up to the number of available cores.
+void ribSyncFibAcrossVrfs(uint32_t iters, std::size_t numVrfs) {
+  RoutingInformationBase rib;
+  std::vector<std::vector<UnicastRoute>> routes;
+
+  BENCHMARK_SUSPEND {
+    rib.reconfigure(
+        interfaceRoutes(numVrfs),
+        {} /* staticRoutesWithNextHops */,
+        {} /* staticRoutesToNull */,
+        {} /* staticRoutesToCpu */,
+        &noopFibUpdate,
+        nullptr);
+
+    for (std::size_t vrf = 0; vrf < numVrfs; ++vrf) {
+      routes.push_back(routesForVrf(vrf, FLAGS_routes_per_vrf));
+    }
+  }
+
+  for (uint32_t iter = 0; iter < iters; ++iter) {
+    std::vector<std::thread> threads;
+    for (std::size_t vrf = 0; vrf < numVrfs; ++vrf) {
+      threads.emplace_back([&rib, &routes, vrf]() {
+        rib.update(
+            RouterID(vrf),
+            kBgpClientID,
+            AdminDistance::EBGP,
+            routes[vrf],
+            {} /* prefixes to delete */,
+            true /* reset routes for client */,
+            "benchmark sync fib",
+            &noopFibUpdate,
+            nullptr);
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+}
+
+} // namespace
+
+BENCHMARK_PARAM(ribSyncFibAcrossVrfs, 1)
+BENCHMARK_RELATIVE_PARAM(ribSyncFibAcrossVrfs, 2)
+BENCHMARK_RELATIVE_PARAM(ribSyncFibAcrossVrfs, 4)
+BENCHMARK_RELATIVE_PARAM(ribSyncFibAcrossVrfs, 8)
+BENCHMARK_RELATIVE_PARAM(ribSyncFibAcrossVrfs, 16)
+
+int main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  folly::runBenchmarks();
+  return 0;
+}
@@ -16,7 +16,10 @@
 
 namespace facebook { namespace fboss {
 
-using AclMapTraits = NodeMapTraits<std::string, AclEntry>;
+struct AclMapTraits : public NodeMapTraits<std::string, AclEntry> {
+  using NodeContainer =
+      PersistentSortedMap<std::string, std::shared_ptr<AclEntry>>;
+};
 /*
  * A container for the set of entries.
  */
@@ -30,6 +30,10 @@ constexpr auto kPortID = "portId";
 constexpr auto kRate = "rate";
 constexpr auto kActivity = "activity";
 constexpr auto kPriority = "priority";
+constexpr auto kMicroBfd = "microBfd";
+constexpr auto kPeer = "peer";
+constexpr auto kIntervalMsecs = "intervalMsecs";
+constexpr auto kDetectMultiplier = "detectMultiplier";
 } // namespace
 
 namespace facebook {
@@ -69,6 +73,22 @@ AggregatePortFields::Subport AggregatePortFields::Subport::fromFollyDynamic(
   return Subport(id, priority, rate, activity);
 }
 
+folly::dynamic AggregatePortFields::MicroBfd::toFollyDynamic() const {
+  folly::dynamic microBfd = folly::dynamic::object;
+  microBfd[kPeer] = peer.str();
+  microBfd[kIntervalMsecs] = interval.count();
+  microBfd[kDetectMultiplier] = detectMultiplier;
+  return microBfd;
+}
+
+AggregatePortFields::MicroBfd AggregatePortFields::MicroBfd::fromFollyDynamic(
+    const folly::dynamic& json) {
+  return MicroBfd(
+      folly::IPAddress(json[kPeer].asString()),
+      std::chrono::milliseconds(json[kIntervalMsecs].asInt()),
+      json[kDetectMultiplier].asInt());
+}
+
 AggregatePortFields::AggregatePortFields(
     AggregatePortID id,
     const std::string& name,
@@ -106,6 +126,9 @@ folly::dynamic AggregatePortFields::toFollyDynamic() const {
   aggPortFields[kSubports] = std::move(subports);
   aggPortFields[kSystemID] = systemID_.toString();
   aggPortFields[kSystemPriority] = static_cast<uint16_t>(systemPriority_);
+  if (microBfd_) {
+    aggPortFields[kMicroBfd] = microBfd_->toFollyDynamic();
+  }
   return aggPortFields;
 }
 
@@ -119,7 +142,7 @@ AggregatePortFields AggregatePortFields::fromFollyDynamic(
     ports.emplace_hint(ports.cend(), Subport::fromFollyDynamic(port));
   }
 
-  return AggregatePortFields(
+  AggregatePortFields fields(
       AggregatePortID(json[kId].getInt()),
       json[kName].getString(),
       json[kDescription].getString(),
@@ -127,6 +150,10 @@ AggregatePortFields AggregatePortFields::fromFollyDynamic(
       folly::MacAddress(json[kSystemID].getString()),
       json[kMinimumLinkCount].getInt(),
       std::move(ports));
+  if (json.count(kMicroBfd)) {
+    fields.microBfd_ = MicroBfd::fromFollyDynamic(json[kMicroBfd]);
+  }
+  return fields;
 }
 
 AggregatePort::SubportsDifferenceType AggregatePort::subportsCount() const {
@@ -15,9 +15,13 @@
 #include "fboss/agent/types.h"
 
 #include <boost/container/flat_set.hpp>
+#include <folly/IPAddress.h>
 #include <folly/MacAddress.h>
+#include <folly/Optional.h>
 #include <folly/Range.h>
 
+#include <chrono>
+
 namespace facebook {
 namespace fboss {
 
@@ -87,6 +91,28 @@ struct AggregatePortFields {
   using SubportToForwardingState =
       boost::container::flat_map<PortID, Forwarding>;
 
+  // Micro-BFD session parameters, shared by the sessions of all members
+  struct MicroBfd {
+    MicroBfd() {}
+    MicroBfd(folly::IPAddress p, std::chrono::milliseconds i, uint8_t m)
+        : peer(p), interval(i), detectMultiplier(m) {}
+
+    bool operator==(const MicroBfd& rhs) const {
+      return peer == rhs.peer && interval == rhs.interval &&
+          detectMultiplier == rhs.detectMultiplier;
+    }
+    bool operator!=(const MicroBfd& rhs) const {
+      return !(*this == rhs);
+    }
+
+    folly::dynamic toFollyDynamic() const;
+    static MicroBfd fromFollyDynamic(const folly::dynamic& json);
+
+    folly::IPAddress peer;
+    std::chrono::milliseconds interval{0};
+    uint8_t detectMultiplier{0};
+  };
+
   AggregatePortFields(
       AggregatePortID id,
       const std::string& name,
@@ -116,6 +142,7 @@ struct AggregatePortFields {
   uint8_t minimumLinkCount_;
   Subports ports_;
   SubportToForwardingState portToFwdState_;
+  folly::Optional<MicroBfd> microBfd_;
 };
 
 /*
@@ -128,6 +155,7 @@ class AggregatePort : public NodeBaseT<AggregatePort, AggregatePortFields> {
   using SubportsConstRange =
       folly::Range<AggregatePortFields::Subports::const_iterator>;
   using Forwarding = AggregatePortFields::Forwarding;
+  using MicroBfd = AggregatePortFields::MicroBfd;
   using SubportAndForwardingStateConstRange = folly::Range<
       AggregatePortFields::SubportToForwardingState::const_iterator>;
   using SubportAndForwardingStateValueType =
@@ -211,6 +239,14 @@ class AggregatePort : public NodeBaseT<AggregatePort, AggregatePortFields> {
     writableFields()->minimumLinkCount_ = minLinkCount;
   }
 
+  const folly::Optional<MicroBfd>& getMicroBfd() const {
+    return getFields()->microBfd_;
+  }
+
+  void setMicroBfd(folly::Optional<MicroBfd> microBfd) {
+    writableFields()->microBfd_ = std::move(microBfd);
+  }
+
   AggregatePort::Forwarding getForwardingState(PortID port) {
     auto it = getFields()->portToFwdState_.find(port);
     if (it == getFields()->portToFwdState_.cend()) {
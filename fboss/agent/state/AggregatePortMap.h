@@ -15,7 +15,11 @@ namespace facebook { namespace fboss {
 
 class AggregatePort;
 
-using AggregatePortMapTraits = NodeMapTraits<AggregatePortID, AggregatePort>;
+struct AggregatePortMapTraits
+    : public NodeMapTraits<AggregatePortID, AggregatePort> {
+  using NodeContainer =
+      DenseIdMap<AggregatePortID, std::shared_ptr<AggregatePort>>;
+};
 
 /*
  * A container for the set of aggregate ports.
@@ -0,0 +1,285 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <folly/lang/Bits.h>
+#include <glog/logging.h>
+
+namespace facebook { namespace fboss {
+
+/*
+ * DenseIdMap is an ordered map from small integer IDs, such as PortID or
+ * VlanID, implemented as a vector indexed directly by the ID plus a bitmap
+ * of the IDs present.
+ *
+ * find() is an index and a bit test rather than the binary search a
+ * boost::container::flat_map does, which matters for maps looked up on
+ * every packet.  Iteration visits the present IDs in increasing order,
+ * skipping absent ones a bitmap word at a time.
+ *
+ * The vector is as long as the largest ID inserted, so copying the map costs
+ * O(largest ID) rather than O(size).  Keys are limited to 16 bits to keep
+ * that bounded.
+ *
+ * The interface follows boost::container::flat_map, with a few differences:
+ *  - Erasing never shrinks the vector; only clear() does.
+ *  - Inserting an ID larger than any before invalidates all iterators.
+ */
+template <typename KeyT, typename ValueT>
+class DenseIdMap {
+  static_assert(
+      sizeof(KeyT) <= sizeof(uint16_t),
+      "DenseIdMap keys must be at most 16 bits wide");
+
+  static constexpr size_t kBitsPerWord = 64;
+
+ public:
+  using key_type = KeyT;
+  using mapped_type = ValueT;
+  using value_type = std::pair<KeyT, ValueT>;
+  using size_type = size_t;
+
+  template <bool kConst>
+  class IteratorImpl {
+    using MapPtr =
+        std::conditional_t<kConst, const DenseIdMap*, DenseIdMap*>;
+
+   public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = DenseIdMap::value_type;
+    using difference_type = ptrdiff_t;
+    using pointer =
+        std::conditional_t<kConst, const value_type*, value_type*>;
+    using reference =
+        std::conditional_t<kConst, const value_type&, value_type&>;
+
+    IteratorImpl() {}
+
+    // iterator converts to const_iterator
+    template <
+        bool kOtherConst,
+        typename = std::enable_if_t<kConst && !kOtherConst>>
+    /* implicit */ IteratorImpl(const IteratorImpl<kOtherConst>& other)
+        : map_(other.map_), index_(other.index_) {}
+
+    reference operator*() const {
+      return map_->slots_[index_];
+    }
+    pointer operator->() const {
+      return &map_->slots_[index_];
+    }
+
+    IteratorImpl& operator++() {
+      index_ = map_->nextPresent(index_ + 1);
+      return *this;
+    }
+    IteratorImpl operator++(int) {
+      IteratorImpl tmp(*this);
+      ++(*this);
+      return tmp;
+    }
+    IteratorImpl& operator--() {
+      index_ = map_->prevPresent(index_);
+      return *this;
+    }
+    IteratorImpl operator--(int) {
+      IteratorImpl tmp(*this);
+      --(*this);
+      return tmp;
+    }
+
+    template <bool kOtherConst>
+    bool operator==(const IteratorImpl<kOtherConst>& other) const {
+      return index_ == other.index_;
+    }
+    template <bool kOtherConst>
+    bool operator!=(const IteratorImpl<kOtherConst>& other) const {
+      return !operator==(other);
+    }
+
+   private:
+    friend class DenseIdMap;
+    template <bool>
+    friend class IteratorImpl;
+
+    IteratorImpl(MapPtr map, size_t index) : map_(map), index_(index) {}
+
+    MapPtr map_{nullptr};
+    // slots_.size() at the end of the map
+    size_t index_{0};
+  };
+
+  using iterator = IteratorImpl<false>;
+  using const_iterator = IteratorImpl<true>;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  DenseIdMap() {}
+
+  size_t size() const {
+    return size_;
+  }
+  bool empty() const {
+    return size_ == 0;
+  }
+  void clear() {
+    slots_.clear();
+    present_.clear();
+    size_ = 0;
+  }
+
+  iterator begin() {
+    return iterator(this, nextPresent(0));
+  }
+  const_iterator begin() const {
+    return const_iterator(this, nextPresent(0));
+  }
+  iterator end() {
+    return iterator(this, slots_.size());
+  }
+  const_iterator end() const {
+    return const_iterator(this, slots_.size());
+  }
+  reverse_iterator rbegin() {
+    return reverse_iterator(end());
+  }
+  const_reverse_iterator rbegin() const {
+    return const_reverse_iterator(end());
+  }
+  reverse_iterator rend() {
+    return reverse_iterator(begin());
+  }
+  const_reverse_iterator rend() const {
+    return const_reverse_iterator(begin());
+  }
+
+  iterator find(const KeyT& key) {
+    auto index = indexOf(key);
+    return iterator(this, isPresent(index) ? index : slots_.size());
+  }
+  const_iterator find(const KeyT& key) const {
+    auto index = indexOf(key);
+    return const_iterator(this, isPresent(index) ? index : slots_.size());
+  }
+  size_t count(const KeyT& key) const {
+    return isPresent(indexOf(key)) ? 1 : 0;
+  }
+
+  const_iterator lower_bound(const KeyT& key) const {
+    return const_iterator(this, nextPresent(indexOf(key)));
+  }
+  const_iterator upper_bound(const KeyT& key) const {
+    return const_iterator(this, nextPresent(indexOf(key) + 1));
+  }
+
+  std::pair<iterator, bool> insert(value_type value) {
+    auto index = indexOf(value.first);
+    if (isPresent(index)) {
+      return std::make_pair(iterator(this, index), false);
+    }
+    if (index >= slots_.size()) {
+      grow(index);
+    }
+    slots_[index].second = std::move(value.second);
+    present_[index / kBitsPerWord] |= bit(index);
+    ++size_;
+    return std::make_pair(iterator(this, index), true);
+  }
+  template <typename... Args>
+  std::pair<iterator, bool> emplace(Args&&... args) {
+    return insert(value_type(std::forward<Args>(args)...));
+  }
+
+  size_t erase(const KeyT& key) {
+    auto index = indexOf(key);
+    if (!isPresent(index)) {
+      return 0;
+    }
+    // Drop the value so the map doesn't keep it alive
+    slots_[index].second = ValueT();
+    present_[index / kBitsPerWord] &= ~bit(index);
+    --size_;
+    return 1;
+  }
+  iterator erase(const_iterator pos) {
+    DCHECK(pos != end());
+    auto next = nextPresent(pos.index_ + 1);
+    erase(pos->first);
+    return iterator(this, next);
+  }
+
+ private:
+  static size_t indexOf(const KeyT& key) {
+    return static_cast<size_t>(key);
+  }
+  static uint64_t bit(size_t index) {
+    return uint64_t(1) << (index % kBitsPerWord);
+  }
+
+  bool isPresent(size_t index) const {
+    return index < slots_.size() &&
+        (present_[index / kBitsPerWord] & bit(index));
+  }
+
+  // Extend slots_ by whole bitmap words to cover index
+  void grow(size_t index) {
+    auto words = index / kBitsPerWord + 1;
+    slots_.reserve(words * kBitsPerWord);
+    for (auto i = slots_.size(); i < words * kBitsPerWord; ++i) {
+      slots_.emplace_back(KeyT(i), ValueT());
+    }
+    present_.resize(words, 0);
+  }
+
+  // The first present index at or after from, or slots_.size() if none
+  size_t nextPresent(size_t from) const {
+    auto word = from / kBitsPerWord;
+    if (word >= present_.size()) {
+      return slots_.size();
+    }
+    auto bits = present_[word] & (~uint64_t(0) << (from % kBitsPerWord));
+    while (!bits) {
+      if (++word == present_.size()) {
+        return slots_.size();
+      }
+      bits = present_[word];
+    }
+    return word * kBitsPerWord + folly::findFirstSet(bits) - 1;
+  }
+
+  // The last present index before before, which must exist
+  size_t prevPresent(size_t before) const {
+    DCHECK_GT(before, 0);
+    auto last = before - 1;
+    auto word = last / kBitsPerWord;
+    auto bits = present_[word] &
+        (~uint64_t(0) >> (kBitsPerWord - 1 - last % kBitsPerWord));
+    while (!bits) {
+      DCHECK_GT(word, 0);
+      bits = present_[--word];
+    }
+    return word * kBitsPerWord + folly::findLastSet(bits) - 1;
+  }
+
+  // slots_[i].first is always KeyT(i); second is empty unless i is present
+  std::vector<value_type> slots_;
+  // Bit i % 64 of present_[i / 64] is set if slots_[i] holds an entry
+  std::vector<uint64_t> present_;
+  size_t size_{0};
+};
+
+}} // namespace facebook::fboss
@@ -11,6 +11,8 @@
 
 #include "fboss/agent/state/NodeMap-defs.h"
 
+#include <algorithm>
+
 namespace facebook {
 namespace fboss {
 
@@ -59,6 +61,52 @@ ForwardingInformationBase<AddressT>::longestMatch(
   return longestMatchRoute;
 }
 
+template <typename AddressT>
+std::vector<std::shared_ptr<Route<AddressT>>>
+ForwardingInformationBase<AddressT>::longestMatchBatch(
+    folly::Range<const AddressT*> addresses) const {
+  std::vector<std::shared_ptr<Route<AddressT>>> matches(addresses.size());
+  if (addresses.empty()) {
+    return matches;
+  }
+
+  // Sort the batch once. The addresses covered by any one prefix then form a
+  // contiguous run starting at the first address not less than the prefix's
+  // network, so each route only visits the addresses it covers.
+  std::vector<std::pair<AddressT, size_t>> sortedAddresses;
+  sortedAddresses.reserve(addresses.size());
+  for (size_t i = 0; i < addresses.size(); ++i) {
+    sortedAddresses.emplace_back(addresses[i], i);
+  }
+  std::sort(sortedAddresses.begin(), sortedAddresses.end());
+
+  // Mask length of the best match so far, per entry of sortedAddresses
+  std::vector<int16_t> longestMatchLengths(sortedAddresses.size(), -1);
+  for (const auto& prefixAndRoute : Base::getAllNodes()) {
+    const auto& prefix = prefixAndRoute.first;
+    auto network = prefix.network.mask(prefix.mask);
+    auto it = std::lower_bound(
+        sortedAddresses.begin(),
+        sortedAddresses.end(),
+        network,
+        [](const std::pair<AddressT, size_t>& entry, const AddressT& address) {
+          return entry.first < address;
+        });
+    for (; it != sortedAddresses.end() &&
+         it->first.inSubnet(network, prefix.mask);
+         ++it) {
+      auto& longestMatchLength =
+          longestMatchLengths[it - sortedAddresses.begin()];
+      if (prefix.mask > longestMatchLength) {
+        longestMatchLength = prefix.mask;
+        matches[it->second] = prefixAndRoute.second;
+      }
+    }
+  }
+
+  return matches;
+}
+
 FBOSS_INSTANTIATE_NODE_MAP(
     ForwardingInformationBase<folly::IPAddressV4>,
     ForwardingInformationBaseTraits<folly::IPAddressV4>);
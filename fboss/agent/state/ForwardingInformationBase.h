@@ -15,6 +15,10 @@
 
 #include <folly/IPAddressV4.h>
 #include <folly/IPAddressV6.h>
+#include <folly/Range.h>
+
+#include <memory>
+#include <vector>
 
 namespace facebook {
 namespace fboss {
@@ -41,6 +45,14 @@ class ForwardingInformationBase
 
   std::shared_ptr<Route<AddressT>> longestMatch(const AddressT& address) const;
 
+  /*
+   * Longest match for each of a batch of addresses, in a single pass over
+   * the FIB rather than one pass per address. The i'th entry of the result
+   * is the match for addresses[i], or null if there is none.
+   */
+  std::vector<std::shared_ptr<Route<AddressT>>> longestMatchBatch(
+      folly::Range<const AddressT*> addresses) const;
+
  private:
   // Inherit the constructors required for clone()
   using Base::Base;
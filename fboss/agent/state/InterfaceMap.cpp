@@ -26,6 +26,14 @@ InterfaceMap::~InterfaceMap() {
 
 std::shared_ptr<Interface>
 InterfaceMap::getInterfaceIf(RouterID router, const IPAddress& ip) const {
+  if (isPublished()) {
+    auto addresses = addressIndex_.find(router);
+    if (addresses == addressIndex_.end()) {
+      return nullptr;
+    }
+    auto intf = addresses->second.find(ip);
+    return intf == addresses->second.end() ? nullptr : intf->second;
+  }
   for (auto itr = begin(); itr != end(); ++itr) {
     if ((*itr)->getRouterID() == router && (*itr)->hasAddress(ip)) {
       return *itr;
@@ -36,6 +44,16 @@ InterfaceMap::getInterfaceIf(RouterID router, const IPAddress& ip) const {
 
 const std::shared_ptr<Interface>&
 InterfaceMap::getInterface(RouterID router, const IPAddress& ip) const {
+  if (isPublished()) {
+    auto addresses = addressIndex_.find(router);
+    if (addresses != addressIndex_.end()) {
+      auto intf = addresses->second.find(ip);
+      if (intf != addresses->second.end()) {
+        return intf->second;
+      }
+    }
+    throw FbossError("No interface with ip : ", ip);
+  }
   for (auto itr = begin(); itr != end(); ++itr) {
     if ((*itr)->getRouterID() == router && (*itr)->hasAddress(ip)) {
       return *itr;
@@ -46,6 +64,10 @@ InterfaceMap::getInterface(RouterID router, const IPAddress& ip) const {
 
 std::shared_ptr<Interface>
 InterfaceMap::getInterfaceInVlanIf(VlanID vlan) const {
+  if (isPublished()) {
+    auto intf = vlanIndex_.find(vlan);
+    return intf == vlanIndex_.end() ? nullptr : intf->second;
+  }
   for (auto itr = begin(); itr != end(); ++itr) {
     if ((*itr)->getVlanID() == vlan ) {
       return *itr;
@@ -81,6 +103,22 @@ void InterfaceMap::addInterface(const std::shared_ptr<Interface>& interface) {
   addNode(interface);
 }
 
+void InterfaceMap::publish() {
+  if (isPublished()) {
+    return;
+  }
+  // In InterfaceID order, so the first interface with an address or in a
+  // vlan wins, as it does when walking the map
+  for (const auto& intf : *this) {
+    auto& addresses = addressIndex_[intf->getRouterID()];
+    for (const auto& addr : intf->getAddresses()) {
+      addresses.emplace(addr.first, intf);
+    }
+    vlanIndex_.emplace(intf->getVlanID(), intf);
+  }
+  NodeMapT::publish();
+}
+
 folly::dynamic InterfaceMap::toFollyDynamic() const {
   folly::dynamic intfs = folly::dynamic::array;
   for (const auto& intf: *this) {
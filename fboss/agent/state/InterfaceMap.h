@@ -8,7 +8,9 @@
  *
  */
 #pragma once
+#include <unordered_map>
 #include <vector>
+#include <boost/container/flat_map.hpp>
 #include <folly/IPAddress.h>
 #include "fboss/agent/types.h"
 #include "fboss/agent/state/NodeMap.h"
@@ -97,6 +99,12 @@ class InterfaceMap : public NodeMapT<InterfaceMap, InterfaceMapTraits> {
 
   void addInterface(const std::shared_ptr<Interface>& interface);
 
+  /*
+   * Builds the indexes the address and vlan lookups above use once the map
+   * can no longer change. Until then those lookups walk the interfaces.
+   */
+  void publish() override;
+
   /*
    * Serialize to a folly::dynamic object
    */
@@ -116,6 +124,17 @@ class InterfaceMap : public NodeMapT<InterfaceMap, InterfaceMapTraits> {
   // Inherit the constructors required for clone()
   using NodeMapT::NodeMapT;
   friend class CloneAllocator;
+
+  /*
+   * The interface of each address, and the interface getInterfaceInVlanIf()
+   * returns for each vlan, so trapped packets do not walk every interface
+   * to find out whether they are for us. These are not part of the fields:
+   * a clone starts without them and gets its own on publish().
+   */
+  using AddressToInterface =
+      std::unordered_map<folly::IPAddress, std::shared_ptr<Interface>>;
+  boost::container::flat_map<RouterID, AddressToInterface> addressIndex_;
+  boost::container::flat_map<VlanID, std::shared_ptr<Interface>> vlanIndex_;
 };
 
 }} // facebook::fboss
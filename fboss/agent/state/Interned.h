@@ -0,0 +1,128 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace facebook { namespace fboss {
+
+/*
+ * An immutable T that shares one copy with every other Interned<T> of the
+ * same value. Many routes have the same next hops, so RouteNextHopEntry
+ * keeps its next hop set this way: the routes then hold a pointer to it
+ * each, rather than a copy, and comparing two sets is a pointer compare.
+ *
+ * The copies live in a table of all the values in use, and are removed from
+ * it when the last Interned of that value goes away. The table is shared by
+ * all threads.
+ */
+template <typename T, typename Hash = std::hash<T>>
+class Interned {
+ public:
+  // The empty T
+  Interned() : value_(empty()) {}
+  explicit Interned(T value) : value_(intern(std::move(value))) {}
+
+  const T& get() const {
+    return *value_;
+  }
+
+  bool operator==(const Interned& other) const {
+    return value_ == other.value_;
+  }
+  bool operator!=(const Interned& other) const {
+    return value_ != other.value_;
+  }
+  bool operator<(const Interned& other) const {
+    return value_ != other.value_ && *value_ < *other.value_;
+  }
+
+  // Number of distinct values in use
+  static size_t tableSize() {
+    auto& t = table();
+    std::lock_guard<std::mutex> lock(t.mutex);
+    return t.values.size();
+  }
+
+ private:
+  struct DerefHash {
+    size_t operator()(std::reference_wrapper<const T> value) const {
+      return Hash()(value.get());
+    }
+  };
+  struct DerefEqual {
+    bool operator()(
+        std::reference_wrapper<const T> a,
+        std::reference_wrapper<const T> b) const {
+      return a.get() == b.get();
+    }
+  };
+  /*
+   * Keyed by the interned copy itself, which the entry's weak_ptr owns. An
+   * entry may briefly outlive its copy, between the last reference going
+   * away and the deleter taking the lock.
+   */
+  struct Table {
+    std::mutex mutex;
+    std::unordered_map<
+        std::reference_wrapper<const T>,
+        std::weak_ptr<const T>,
+        DerefHash,
+        DerefEqual>
+        values;
+  };
+
+  static Table& table() {
+    // Leaked, so it outlives Interned values destroyed at exit
+    static auto* table = new Table();
+    return *table;
+  }
+
+  static const std::shared_ptr<const T>& empty() {
+    static const auto* empty = new std::shared_ptr<const T>(intern(T()));
+    return *empty;
+  }
+
+  static std::shared_ptr<const T> intern(T value) {
+    auto& t = table();
+    std::lock_guard<std::mutex> lock(t.mutex);
+    auto entry = t.values.find(std::cref(value));
+    if (entry != t.values.end()) {
+      if (auto interned = entry->second.lock()) {
+        return interned;
+      }
+      // On its way out; the deleter will see it is no longer in the table
+      t.values.erase(entry);
+    }
+    std::shared_ptr<const T> interned(new T(std::move(value)), release);
+    t.values.emplace(std::cref(*interned), interned);
+    return interned;
+  }
+
+  static void release(const T* value) {
+    {
+      auto& t = table();
+      std::lock_guard<std::mutex> lock(t.mutex);
+      auto entry = t.values.find(std::cref(*value));
+      if (entry != t.values.end() && &entry->first.get() == value) {
+        t.values.erase(entry);
+      }
+    }
+    delete value;
+  }
+
+  std::shared_ptr<const T> value_;
+};
+
+}} // facebook::fboss
@@ -47,9 +47,17 @@ LabelForwardingInformationBase* LabelForwardingInformationBase::programLabel(
     throw FbossError("invalid label next hop");
   }
 
-  auto* writableLabelFib = modify(state);
-  auto entry = writableLabelFib->getLabelForwardingEntryIf(label);
+  auto entry = getLabelForwardingEntryIf(label);
+  if (entry) {
+    const auto* existing = entry->getEntryForClient(client);
+    if (existing && existing->getAdminDistance() == distance &&
+        existing->getNextHopSet() == nexthops) {
+      // Nothing changes, leave the entry out of the StateDelta
+      return this;
+    }
+  }
 
+  auto* writableLabelFib = modify(state);
   if (!entry) {
     XLOG(DBG3) << "programmed label:" << label
                << " in label forwarding information base for client:" << client;
@@ -94,11 +102,19 @@ LabelForwardingInformationBase*
 LabelForwardingInformationBase::purgeEntriesForClient(
     std::shared_ptr<SwitchState>* state,
     ClientID client) {
+  return purgeEntriesForClient(state, client, {});
+}
+
+LabelForwardingInformationBase*
+LabelForwardingInformationBase::purgeEntriesForClient(
+    std::shared_ptr<SwitchState>* state,
+    ClientID client,
+    const boost::container::flat_set<Label>& keep) {
   auto* writableLabelFib = modify(state);
 
   auto iter = writableLabelFib->writableNodes().begin();
   while (iter != writableLabelFib->writableNodes().end()) {
-    if (iter->second->getEntryForClient(client)) {
+    if (iter->second->getEntryForClient(client) && !keep.count(iter->first)) {
       auto* entry = iter->second->modify(state);
       entry->delEntryForClient(client);
       if (entry->isEmpty()) {
@@ -50,6 +50,16 @@ class LabelForwardingInformationBase
       std::shared_ptr<SwitchState>* state,
       ClientID client);
 
+  /*
+   * Like purgeEntriesForClient(), but leaves the client's entries for the
+   * labels in keep alone.  Used to sync a client's labels without touching
+   * the entries that stay, so they don't show up in the StateDelta.
+   */
+  LabelForwardingInformationBase* purgeEntriesForClient(
+      std::shared_ptr<SwitchState>* state,
+      ClientID client,
+      const boost::container::flat_set<Label>& keep);
+
   static bool isValidNextHopSet(const LabelNextHopSet& nexthops);
 
  private:
@@ -26,6 +26,8 @@ static constexpr folly::StringPiece kSeed{"seed"};
 static constexpr folly::StringPiece kIPv4Fields{"v4Fields"};
 static constexpr folly::StringPiece kIPv6Fields{"v6Fields"};
 static constexpr folly::StringPiece kTransportFields{"transportFields"};
+static constexpr folly::StringPiece kResilientFlowsetSize{
+    "resilientFlowsetSize"};
 }; // namespace
 
 namespace facebook {
@@ -37,13 +39,15 @@ LoadBalancerFields::LoadBalancerFields(
     uint32_t seed,
     LoadBalancerFields::IPv4Fields v4Fields,
     LoadBalancerFields::IPv6Fields v6Fields,
-    LoadBalancerFields::TransportFields transportFields)
+    LoadBalancerFields::TransportFields transportFields,
+    uint32_t resilientFlowsetSize)
     : id_(id),
       algorithm_(algorithm),
       seed_(seed),
       v4Fields_(v4Fields),
       v6Fields_(v6Fields),
-      transportFields_(transportFields) {}
+      transportFields_(transportFields),
+      resilientFlowsetSize_(resilientFlowsetSize) {}
 
 LoadBalancer::LoadBalancer(
     LoadBalancerID id,
@@ -51,8 +55,16 @@ LoadBalancer::LoadBalancer(
     uint32_t seed,
     LoadBalancer::IPv4Fields v4Fields,
     LoadBalancer::IPv6Fields v6Fields,
-    LoadBalancer::TransportFields transportFields)
-    : NodeBaseT(id, algorithm, seed, v4Fields, v6Fields, transportFields) {}
+    LoadBalancer::TransportFields transportFields,
+    uint32_t resilientFlowsetSize)
+    : NodeBaseT(
+          id,
+          algorithm,
+          seed,
+          v4Fields,
+          v6Fields,
+          transportFields,
+          resilientFlowsetSize) {}
 
 LoadBalancerID LoadBalancer::getID() const {
   return getFields()->id_;
@@ -82,6 +94,10 @@ LoadBalancer::TransportFieldsRange LoadBalancer::getTransportFields() const {
       getFields()->transportFields_.end());
 }
 
+uint32_t LoadBalancer::getResilientFlowsetSize() const {
+  return getFields()->resilientFlowsetSize_;
+}
+
 std::shared_ptr<LoadBalancer> LoadBalancer::fromFollyDynamic(
     const folly::dynamic& json) {
   auto id = static_cast<LoadBalancerID>(json[kLoadBalancerID].asInt());
@@ -151,13 +167,21 @@ std::shared_ptr<LoadBalancer> LoadBalancer::fromFollyDynamic(
     }
   }
 
+  // Missing from states written before resilient hashing was supported
+  auto resilientFlowsetSize = json.getDefault(kResilientFlowsetSize, 0).asInt();
+  if (resilientFlowsetSize < 0 ||
+      resilientFlowsetSize > std::numeric_limits<uint32_t>::max()) {
+    throw FbossError("Invalid resilient flowset size ", resilientFlowsetSize);
+  }
+
   return std::make_shared<LoadBalancer>(
       id,
       algorithm,
       seed,
       std::move(ipv4Fields),
       std::move(ipv6Fields),
-      std::move(transportFields));
+      std::move(transportFields),
+      resilientFlowsetSize);
 }
 
 folly::dynamic LoadBalancer::toFollyDynamic() const {
@@ -187,6 +211,8 @@ folly::dynamic LoadBalancer::toFollyDynamic() const {
         static_cast<int64_t>(transportField));
   }
 
+  serialized[kResilientFlowsetSize] = getResilientFlowsetSize();
+
   return serialized;
 }
 
@@ -214,6 +240,7 @@ uint32_t LoadBalancer::generateDeterministicSeed(
 bool LoadBalancer::operator==(const LoadBalancer& rhs) const {
   return getID() == rhs.getID() && getSeed() == rhs.getSeed() &&
       getAlgorithm() == rhs.getAlgorithm() &&
+      getResilientFlowsetSize() == rhs.getResilientFlowsetSize() &&
       std::equal(
              getIPv4Fields().begin(),
              getIPv4Fields().end(),
@@ -39,7 +39,8 @@ struct LoadBalancerFields {
       uint32_t seed,
       IPv4Fields v4Fields,
       IPv6Fields v6Fields,
-      TransportFields transportFields);
+      TransportFields transportFields,
+      uint32_t resilientFlowsetSize);
 
   template <typename Fn>
   void forEachChild(Fn /* unused */) {}
@@ -50,6 +51,8 @@ struct LoadBalancerFields {
   IPv4Fields v4Fields_;
   IPv6Fields v6Fields_;
   TransportFields transportFields_;
+  // 0 unless the ECMP LoadBalancer uses resilient hashing
+  uint32_t resilientFlowsetSize_{0};
 };
 
 /* A LoadBalancer represents a logical point in the data-path which may
@@ -98,7 +101,8 @@ class LoadBalancer : public NodeBaseT<LoadBalancer, LoadBalancerFields> {
       uint32_t seed,
       IPv4Fields v4Fields,
       IPv6Fields v6Fields,
-      TransportFields transportFields);
+      TransportFields transportFields,
+      uint32_t resilientFlowsetSize = 0);
 
   LoadBalancerID getID() const;
   uint32_t getSeed() const;
@@ -106,6 +110,11 @@ class LoadBalancer : public NodeBaseT<LoadBalancer, LoadBalancerFields> {
   IPv4FieldsRange getIPv4Fields() const;
   IPv6FieldsRange getIPv6Fields() const;
   TransportFieldsRange getTransportFields() const;
+  /*
+   * Number of flowsets per ECMP group when resilient hashing is used, 0 for
+   * regular hashing.
+   */
+  uint32_t getResilientFlowsetSize() const;
 
   static std::shared_ptr<LoadBalancer> fromFollyDynamic(
       const folly::dynamic& json);
@@ -14,6 +14,7 @@
 #include "fboss/agent/state/NodeBase.h"
 
 #include <boost/container/flat_map.hpp>
+#include <unordered_map>
 
 namespace facebook { namespace fboss {
 
@@ -103,7 +104,14 @@ class NeighborResponseTable
     return this->getFields()->toFollyDynamic();
   }
 
-  folly::Optional<NeighborResponseEntry> getEntry(AddressType ip) {
+  folly::Optional<NeighborResponseEntry> getEntry(AddressType ip) const {
+    if (this->isPublished()) {
+      auto it = index_.find(ip);
+      if (it == index_.end()) {
+        return folly::Optional<NeighborResponseEntry>();
+      }
+      return it->second;
+    }
     const auto& table = getTable();
     auto it = table.find(ip);
     if (it == table.end()) {
@@ -132,11 +140,32 @@ class NeighborResponseTable
     entry.interfaceID = intfID;
   }
 
+  /*
+   * Builds the index getEntry() uses once the table can no longer change.
+   * Until then getEntry() searches the table.
+   */
+  void publish() override {
+    if (this->isPublished()) {
+      return;
+    }
+    const auto& table = getTable();
+    index_.reserve(table.size());
+    index_.insert(table.begin(), table.end());
+    Parent::publish();
+  }
+
  private:
   // Inherit the constructors required for clone()
   typedef NodeBaseT<SUBCLASS, NeighborResponseTableFields<IPADDR>> Parent;
   using Parent::Parent;
   friend class CloneAllocator;
+
+  /*
+   * Hashed copy of the table, so ARP requests and neighbor solicitations
+   * for our addresses cost one lookup. Not part of the fields: a clone
+   * starts without it and gets its own on publish().
+   */
+  std::unordered_map<AddressType, NeighborResponseEntry> index_;
 };
 
 }} // facebook::fboss
@@ -30,6 +30,8 @@ struct NeighborTableTraits {
   typedef IPADDR KeyType;
   typedef ENTRY Node;
   typedef NodeMapNoExtraFields ExtraFields;
+  // Neighbor tables can hold thousands of entries and change constantly
+  typedef PersistentSortedMap<KeyType, std::shared_ptr<Node>> NodeContainer;
 
   static KeyType getKey(const std::shared_ptr<Node>& entry) {
     return entry->getIP();
@@ -39,12 +41,8 @@ struct NeighborTableTraits {
 /*
  * A map of IP --> MAC for the IP addresses of other nodes on a VLAN.
  *
- * TODO: We should switch from NodeMap to PrefixMap when the new PrefixMap
- * implementation is ready.
- *
- * Any change to a NodeMap is O(N), so it is really only suitable for small
- * maps that do not change frequently.  Our new PrefixMap implementation will
- * allow us to perform cheaper copy-on-write updates.
+ * The entries are kept in a PersistentSortedMap, so a change to one entry
+ * only copies O(log N) of the table when the table is cloned.
  */
 template<typename IPADDR, typename ENTRY, typename SUBCLASS>
 class NeighborTable
@@ -15,6 +15,34 @@
 
 namespace facebook { namespace fboss {
 
+namespace detail {
+
+// Fields that skip published children in forEachChild() provide a const
+// forEachChildNode() visiting all of them
+template <typename FieldsT, typename Fn>
+auto forEachChildOf(const FieldsT& fields, const Fn& fn, int)
+    -> decltype(fields.forEachChildNode(fn)) {
+  fields.forEachChildNode(fn);
+}
+template <typename FieldsT, typename Fn>
+void forEachChildOf(const FieldsT& fields, const Fn& fn, long) {
+  const_cast<FieldsT&>(fields).forEachChild(fn);
+}
+
+// Fields with heap storage worth accounting provide heapBytes()
+template <typename FieldsT>
+auto heapBytesOf(const FieldsT& fields, const NodeBase::SharedBytesFn& shared,
+                 int) -> decltype(fields.heapBytes(shared)) {
+  return fields.heapBytes(shared);
+}
+template <typename FieldsT>
+size_t heapBytesOf(const FieldsT& /*fields*/,
+                   const NodeBase::SharedBytesFn& /*shared*/, long) {
+  return 0;
+}
+
+} // namespace detail
+
 template<typename NodeT, typename FieldsT>
 std::shared_ptr<NodeT> NodeBaseT<NodeT, FieldsT>::clone() const {
   return std::allocate_shared<NodeT>(CloneAllocator(), self());
@@ -31,4 +59,20 @@ void NodeBaseT<NodeT, FieldsT>::publish() {
   NodeBase::publish();
 }
 
+template<typename NodeT, typename FieldsT>
+void NodeBaseT<NodeT, FieldsT>::forEachChildNode(
+    const std::function<void(const NodeBase*)>& fn) const {
+  detail::forEachChildOf(fields_, [&fn](const NodeBase* child) {
+    if (child) {
+      fn(child);
+    }
+  }, 0);
+}
+
+template<typename NodeT, typename FieldsT>
+size_t NodeBaseT<NodeT, FieldsT>::ownBytes(
+    const SharedBytesFn& shared) const {
+  return sizeof(NodeT) + detail::heapBytesOf(fields_, shared, 0);
+}
+
 }} // facebook::fboss
@@ -15,6 +15,7 @@
 #include <boost/cast.hpp>
 #include <boost/container/flat_map.hpp>
 #include <glog/logging.h>
+#include <functional>
 #include <memory>
 #include <type_traits>
 
@@ -113,6 +114,32 @@ class NodeBase {
     return nodeID_;
   }
 
+  /*
+   * Call fn on every child node, published or not.
+   *
+   * Unlike the Fields forEachChild() used by publish(), this is const and
+   * virtual, so that the tree can be walked without knowing the node types.
+   * StateMemoryUsage uses it to account memory per subtree.
+   */
+  virtual void forEachChildNode(
+      const std::function<void(const NodeBase*)>& /*fn*/) const {}
+
+  /*
+   * Reports storage owned by a node that may be shared with other nodes: an
+   * address identifying it, and its size.  Returns false if that address was
+   * reported before, so the caller need not report what it contains.
+   */
+  using SharedBytesFn = std::function<bool(const void*, size_t)>;
+
+  /*
+   * Approximate bytes used by this node, not counting its children.  Storage
+   * that a clone may share with the original, such as the tree nodes of a
+   * PersistentSortedMap, is reported to shared rather than included.
+   */
+  virtual size_t ownBytes(const SharedBytesFn& /*shared*/) const {
+    return 0;
+  }
+
  protected:
   NodeBase();
   NodeBase(NodeID id, uint32_t generation)
@@ -200,6 +227,10 @@ class NodeBaseT : public NodeBase {
 
   void publish() override;
 
+  void forEachChildNode(
+      const std::function<void(const NodeBase*)>& fn) const override;
+  size_t ownBytes(const SharedBytesFn& shared) const override;
+
   const Fields* getFields() const {
     return &fields_;
   }
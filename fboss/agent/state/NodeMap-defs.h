@@ -53,33 +53,36 @@ NodeMapT<MapTypeT, TraitsT>::getNodeIf(KeyType key) const {
 
 template <typename MapTypeT, typename TraitsT>
 void NodeMapT<MapTypeT, TraitsT>::addNode(const std::shared_ptr<Node>& node) {
-  auto& nodes = writableNodes();
-  auto ret = nodes.insert(std::make_pair(TraitsT::getKey(node), node));
+  auto fields = this->writableFields();
+  auto ret = fields->nodes.insert(std::make_pair(TraitsT::getKey(node), node));
   if (!ret.second) {
     throw FbossError("duplicate node ID ", TraitsT::getKey(node));
   }
+  fields->changes.keyChanged(ret.first->first);
 }
 
 template <typename MapTypeT, typename TraitsT>
 void
 NodeMapT<MapTypeT, TraitsT>::updateNode(const std::shared_ptr<Node>& node) {
-  auto& nodes = writableNodes();
-  auto it = nodes.find(TraitsT::getKey(node));
-  if (it == nodes.end()) {
+  auto fields = this->writableFields();
+  auto it = fields->nodes.find(TraitsT::getKey(node));
+  if (it == fields->nodes.end()) {
     throw FbossError("node ID ", TraitsT::getKey(node), " does not exist");
   }
   it->second = node;
+  fields->changes.keyChanged(it->first);
 }
 
 template <typename MapTypeT, typename TraitsT>
 void NodeMapT<MapTypeT, TraitsT>::removeNode(
     const std::shared_ptr<Node>& node) {
-  auto& nodes = writableNodes();
-  auto it = nodes.find(TraitsT::getKey(node));
-  if (it == nodes.end()) {
+  auto fields = this->writableFields();
+  auto it = fields->nodes.find(TraitsT::getKey(node));
+  if (it == fields->nodes.end()) {
     throw FbossError("node ID ", TraitsT::getKey(node), " does not exist");
   }
-  nodes.erase(it);
+  fields->changes.keyChanged(it->first);
+  fields->nodes.erase(it);
 }
 
 template <typename MapTypeT, typename TraitsT>
@@ -95,13 +98,14 @@ NodeMapT<MapTypeT, TraitsT>::removeNode(const KeyType& key) {
 template <typename MapTypeT, typename TraitsT>
 std::shared_ptr<typename TraitsT::Node>
 NodeMapT<MapTypeT, TraitsT>::removeNodeIf(const KeyType& key) {
-  auto& nodes = writableNodes();
-  auto it = nodes.find(key);
-  if (it == nodes.end()) {
+  auto fields = this->writableFields();
+  auto it = fields->nodes.find(key);
+  if (it == fields->nodes.end()) {
     return nullptr;
   }
   std::shared_ptr<Node> node = it->second;
-  nodes.erase(it);
+  fields->changes.keyChanged(key);
+  fields->nodes.erase(it);
   return node;
 }
 
@@ -10,12 +10,182 @@
 #pragma once
 
 #include <boost/container/flat_map.hpp>
+#include <boost/container/flat_set.hpp>
+#include <folly/Traits.h>
 
+#include <atomic>
+
+#include "fboss/agent/state/DenseIdMap.h"
 #include "fboss/agent/state/NodeBase.h"
 #include "fboss/agent/state/NodeMapIterator.h"
+#include "fboss/agent/state/PersistentSortedMap.h"
 
 namespace facebook { namespace fboss {
 
+/*
+ * The container NodeMapT stores its children in.  This is a flat_map unless
+ * the traits class selects a different one by defining a NodeContainer type.
+ *
+ * A flat_map is the cheapest to look up and iterate, but cloning the map
+ * copies the whole vector.  Large maps that are modified often should use
+ * PersistentSortedMap, whose clones share structure with the original.
+ * Maps keyed by small dense IDs that are looked up per packet should use
+ * DenseIdMap, which finds a node by indexing rather than searching.
+ */
+template <typename TraitsT, typename = void>
+struct NodeMapContainer {
+  using type = boost::container::flat_map<
+      typename TraitsT::KeyType,
+      std::shared_ptr<typename TraitsT::Node>>;
+};
+
+template <typename TraitsT>
+struct NodeMapContainer<TraitsT, folly::void_t<typename TraitsT::NodeContainer>> {
+  using type = typename TraitsT::NodeContainer;
+};
+
+/*
+ * Container specific operations used by NodeMapT and NodeMapDelta.
+ */
+template <typename NodeContainer>
+struct NodeContainerOps {
+  // Call fn on every node that may need publishing
+  template <typename Fn>
+  static void forEachUnpublished(NodeContainer& nodes, Fn fn) {
+    for (const auto& nodePtr : nodes) {
+      fn(nodePtr.second.get());
+    }
+  }
+
+  // Estimated from the entries, the container is not shared between maps
+  static size_t heapBytes(
+      const NodeContainer& nodes,
+      const NodeBase::SharedBytesFn& /*shared*/) {
+    return nodes.size() * sizeof(typename NodeContainer::value_type);
+  }
+
+  // Advance both iterators past the identical entries they point at
+  template <typename Iterator>
+  static void skipUnchanged(
+      const NodeContainer& oldNodes,
+      Iterator& oldIt,
+      const NodeContainer& newNodes,
+      Iterator& newIt) {
+    while (oldIt != oldNodes.end() && newIt != newNodes.end() &&
+           oldIt->second == newIt->second) {
+      ++oldIt;
+      ++newIt;
+    }
+  }
+};
+
+template <typename KeyT, typename ValueT, size_t kMaxEntries>
+struct NodeContainerOps<PersistentSortedMap<KeyT, ValueT, kMaxEntries>> {
+  using NodeContainer = PersistentSortedMap<KeyT, ValueT, kMaxEntries>;
+
+  // Subtrees shared with a published map were published with it
+  template <typename Fn>
+  static void forEachUnpublished(NodeContainer& nodes, Fn fn) {
+    nodes.publishValues([&](const ValueT& node) { fn(node.get()); });
+  }
+
+  // Tree nodes may be shared with clones of the map
+  static size_t heapBytes(
+      const NodeContainer& nodes,
+      const NodeBase::SharedBytesFn& shared) {
+    nodes.forEachTreeNode(shared);
+    return 0;
+  }
+
+  // Skip whole shared subtrees rather than comparing their entries
+  template <typename Iterator>
+  static void skipUnchanged(
+      const NodeContainer& oldNodes,
+      Iterator& oldIt,
+      const NodeContainer& newNodes,
+      Iterator& newIt) {
+    while (oldIt != oldNodes.end() && newIt != newNodes.end() &&
+           oldIt->second == newIt->second) {
+      if (!NodeContainer::skipShared(oldNodes, oldIt, newNodes, newIt)) {
+        ++oldIt;
+        ++newIt;
+      }
+    }
+  }
+};
+
+/*
+ * NodeMapChanges records which keys of a NodeMap were modified since it was
+ * copied from another map, so that NodeMapDelta between the two only has to
+ * visit those keys instead of walking both maps.
+ *
+ * Every version of the map contents gets a process-wide unique number, which
+ * changes on each modification.  A copy remembers the version it was made
+ * from, so the recorded keys are only used against that exact, unmodified
+ * source.  Tracking is given up once too many keys changed, or when the
+ * container is modified directly through writableNodes().
+ */
+template <typename KeyType>
+class NodeMapChanges {
+ public:
+  using KeySet = boost::container::flat_set<KeyType>;
+
+  // Past this many changes a full walk of both maps is cheaper
+  static constexpr size_t kMaxTrackedKeys = 1024;
+
+  NodeMapChanges() {}
+  NodeMapChanges(const NodeMapChanges& other)
+    : parentVersion_(other.version_),
+      tracking_(true) {}
+  NodeMapChanges& operator=(const NodeMapChanges& other) {
+    version_ = nextVersion();
+    parentVersion_ = other.version_;
+    tracking_ = true;
+    keys_.clear();
+    return *this;
+  }
+
+  void keyChanged(const KeyType& key) {
+    version_ = nextVersion();
+    if (!tracking_) {
+      return;
+    }
+    if (keys_.size() >= kMaxTrackedKeys) {
+      untracked();
+      return;
+    }
+    keys_.insert(key);
+  }
+
+  void untracked() {
+    version_ = nextVersion();
+    tracking_ = false;
+    keys_.clear();
+  }
+
+  /*
+   * The keys that changed since this map was copied from old, or null if
+   * they are not known.
+   */
+  const KeySet* changedSince(const NodeMapChanges& old) const {
+    if (!tracking_ || parentVersion_ != old.version_) {
+      return nullptr;
+    }
+    return &keys_;
+  }
+
+ private:
+  static uint64_t nextVersion() {
+    static std::atomic<uint64_t> next{1};
+    return next.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  uint64_t version_{nextVersion()};
+  uint64_t parentVersion_{0};
+  bool tracking_{false};
+  KeySet keys_;
+};
+
 /*
  * NodeMapFields defines the fields contained inside a NodeMapT instantiation
  */
@@ -24,8 +194,7 @@ struct NodeMapFields {
   using KeyType = typename TraitsT::KeyType;
   using Node = typename TraitsT::Node;
   using ExtraFields = typename TraitsT::ExtraFields;
-  using NodeContainer =
-      boost::container::flat_map<KeyType, std::shared_ptr<Node>>;
+  using NodeContainer = typename NodeMapContainer<TraitsT>::type;
 
   NodeMapFields() {}
   NodeMapFields(NodeContainer nodes) : nodes(std::move(nodes)) {}
@@ -35,14 +204,26 @@ struct NodeMapFields {
 
   template<typename Fn>
   void forEachChild(Fn fn) {
+    NodeContainerOps<NodeContainer>::forEachUnpublished(nodes, fn);
+    extra.forEachChild(fn);
+  }
+
+  // Every child, including the published ones forEachChild() skips
+  template <typename Fn>
+  void forEachChildNode(Fn fn) const {
     for (const auto& nodePtr : nodes) {
       fn(nodePtr.second.get());
     }
-    extra.forEachChild(fn);
+    const_cast<ExtraFields&>(extra).forEachChild(fn);
+  }
+
+  size_t heapBytes(const NodeBase::SharedBytesFn& shared) const {
+    return NodeContainerOps<NodeContainer>::heapBytes(nodes, shared);
   }
 
   NodeContainer nodes;
   ExtraFields extra;
+  NodeMapChanges<KeyType> changes;
 };
 
 struct NodeMapNoExtraFields {
@@ -90,6 +271,7 @@ class NodeMapT : public NodeBaseT<MapTypeT,
   using NodeContainer = typename Fields::NodeContainer;
   using Iterator = NodeMapIterator<Node, NodeContainer>;
   using ReverseIterator = ReverseNodeMapIterator<Node, NodeContainer>;
+  using ChangedKeySet = typename NodeMapChanges<KeyType>::KeySet;
 
   const std::shared_ptr<Node>& getNode(KeyType key) const;
   std::shared_ptr<Node> getNodeIf(KeyType key) const;
@@ -101,8 +283,15 @@ class NodeMapT : public NodeBaseT<MapTypeT,
   const NodeContainer& getAllNodes() const {
     return this->getFields()->nodes;
   }
+  /*
+   * Callers may change any entry through the returned container, so this
+   * stops the change tracking NodeMapDelta relies on to skip unchanged keys.
+   * Prefer addNode(), updateNode() and removeNode() where possible.
+   */
   NodeContainer& writableNodes() {
-    return this->writableFields()->nodes;
+    auto fields = this->writableFields();
+    fields->changes.untracked();
+    return fields->nodes;
   }
 
   const ExtraFields& getExtraFields() const {
@@ -124,6 +313,34 @@ class NodeMapT : public NodeBaseT<MapTypeT,
   ReverseIterator rend() const {
     return(ReverseIterator(getAllNodes().rend()));
   }
+  Iterator lowerBound(const KeyType& key) const {
+    return Iterator(getAllNodes().lower_bound(key));
+  }
+
+  /*
+   * The keys that were added, removed or updated since this map was cloned
+   * from oldMap, or null if that is not known and the maps must be compared
+   * in full.
+   */
+  const ChangedKeySet* changedKeysSince(const NodeMapT& oldMap) const {
+    return this->getFields()->changes.changedSince(oldMap.getFields()->changes);
+  }
+
+  /*
+   * Advance oldIt and newIt past any nodes that are the same in both maps.
+   */
+  static void skipUnchanged(
+      const NodeMapT& oldMap,
+      Iterator& oldIt,
+      const NodeMapT& newMap,
+      Iterator& newIt) {
+    auto oldBase = oldIt.base();
+    auto newBase = newIt.base();
+    NodeContainerOps<NodeContainer>::skipUnchanged(
+        oldMap.getAllNodes(), oldBase, newMap.getAllNodes(), newBase);
+    oldIt = Iterator(oldBase);
+    newIt = Iterator(newBase);
+  }
 
 
   /*
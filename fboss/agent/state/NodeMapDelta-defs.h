@@ -30,15 +30,23 @@ NodeMapDelta<MAP, VALUE, MAPPOINTERTRAITS>::Iterator::Iterator(
     newMap_(newMap),
     value_(nullNode_, nullNode_) {
   // Advance to the first difference
-  while (oldIt_ != oldMap_->end() &&
-         newIt_ != newMap_->end() &&
-         *oldIt_ == *newIt_) {
-    ++oldIt_;
-    ++newIt_;
-  }
+  MapType::skipUnchanged(*oldMap_, oldIt_, *newMap_, newIt_);
   updateValue();
 }
 
+template<typename MAP, typename VALUE, typename MAPPOINTERTRAITS>
+NodeMapDelta<MAP, VALUE, MAPPOINTERTRAITS>::Iterator::Iterator(
+    const MapType* oldMap,
+    const MapType* newMap,
+    const ChangedKeys* changedKeys)
+  : oldMap_(oldMap),
+    newMap_(newMap),
+    changedKeys_(changedKeys),
+    changedIt_(changedKeys->begin()),
+    value_(nullNode_, nullNode_) {
+  seekChangedKey();
+}
+
 template<typename MAP, typename VALUE, typename MAPPOINTERTRAITS>
 NodeMapDelta<MAP, VALUE, MAPPOINTERTRAITS>::Iterator::Iterator()
   : oldIt_(),
@@ -73,8 +81,37 @@ void NodeMapDelta<MAP, VALUE, MAPPOINTERTRAITS>::Iterator::updateValue() {
   }
 }
 
+template<typename MAP, typename VALUE, typename MAPPOINTERTRAITS>
+void NodeMapDelta<MAP, VALUE, MAPPOINTERTRAITS>::Iterator::seekChangedKey() {
+  // Position both sides at the next changed key that is still different.
+  // A key may have been changed and then changed back, or added and then
+  // removed again, in which case there is nothing to report for it.
+  for (; changedIt_ != changedKeys_->end(); ++changedIt_) {
+    const auto& key = *changedIt_;
+    oldIt_ = oldMap_->lowerBound(key);
+    newIt_ = newMap_->lowerBound(key);
+    bool inOld = oldIt_ != oldMap_->end() && !(key < Traits::getKey(*oldIt_));
+    bool inNew = newIt_ != newMap_->end() && !(key < Traits::getKey(*newIt_));
+    if ((inOld || inNew) && !(inOld && inNew && *oldIt_ == *newIt_)) {
+      updateValue();
+      return;
+    }
+  }
+  oldIt_ = oldMap_->end();
+  newIt_ = newMap_->end();
+  updateValue();
+}
+
 template<typename MAP, typename VALUE, typename MAPPOINTERTRAITS>
 void NodeMapDelta<MAP, VALUE, MAPPOINTERTRAITS>::Iterator::advance() {
+  if (changedKeys_) {
+    // advance() shouldn't be called if we are already at the end
+    CHECK(changedIt_ != changedKeys_->end());
+    ++changedIt_;
+    seekChangedKey();
+    return;
+  }
+
   // If we have already hit the end of one side, advance the other.
   // We are immediately done after this.
   if (oldIt_ == oldMap_->end()) {
@@ -103,12 +140,7 @@ void NodeMapDelta<MAP, VALUE, MAPPOINTERTRAITS>::Iterator::advance() {
   }
 
   // Advance past any unchanged nodes.
-  while (oldIt_ != oldMap_->end() &&
-         newIt_ != newMap_->end() &&
-         *oldIt_ == *newIt_) {
-    ++oldIt_;
-    ++newIt_;
-  }
+  MapType::skipUnchanged(*oldMap_, oldIt_, *newMap_, newIt_);
   updateValue();
 }
 
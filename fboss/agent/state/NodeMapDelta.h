@@ -151,10 +151,19 @@ class NodeMapDelta<MAP, VALUE, MAPPOINTERTRAITS>::Iterator {
   using pointer = VALUE*;
   using reference = VALUE&;
 
+  using ChangedKeys = typename MapType::ChangedKeySet;
+
   Iterator(const MapType* oldMap,
            typename MapType::Iterator oldIt,
            const MapType* newMap,
            typename MapType::Iterator newIt);
+  /*
+   * Iterate over only the given keys, which must include every key that
+   * differs between the two maps.
+   */
+  Iterator(const MapType* oldMap,
+           const MapType* newMap,
+           const ChangedKeys* changedKeys);
   Iterator();
 
   const value_type& operator*() const {
@@ -187,11 +196,15 @@ class NodeMapDelta<MAP, VALUE, MAPPOINTERTRAITS>::Iterator {
 
   void advance();
   void updateValue();
+  void seekChangedKey();
 
   InnerIter oldIt_{nullptr};
   InnerIter newIt_{nullptr};
   const MapType* oldMap_{nullptr};
   const MapType* newMap_{nullptr};
+  // Set when only the keys recorded by the new map need to be visited
+  const ChangedKeys* changedKeys_{nullptr};
+  typename ChangedKeys::const_iterator changedIt_;
   VALUE value_;
 
   static std::shared_ptr<Node> nullNode_;
@@ -213,6 +226,11 @@ NodeMapDelta<MAP, VALUE, MAPPOINTERTRAITS>::begin() const {
   if (!new_) {
     return Iterator(getOld(), old_->begin(), getOld(), old_->end());
   }
+  // If the new map was cloned from the old one and knows which keys it
+  // modified since, only look at those.
+  if (auto changedKeys = new_->changedKeysSince(*old_)) {
+    return Iterator(getOld(), getNew(), changedKeys);
+  }
   return Iterator(getOld(), old_->begin(), getNew(), new_->begin());
 }
 
@@ -53,6 +53,10 @@ class NodeMapIterator : public std::iterator<std::forward_iterator_tag,
     return it_ != other.it_;
   }
 
+  const typename NodeContainer::const_iterator& base() const {
+    return it_;
+  }
+
  private:
   typename NodeContainer::const_iterator it_;
 };
@@ -0,0 +1,639 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <glog/logging.h>
+
+namespace facebook { namespace fboss {
+
+/*
+ * PersistentSortedMap is an ordered map implemented as a copy-on-write B+
+ * tree.
+ *
+ * Copying the map only copies the root pointer, and the copy shares all of
+ * its tree nodes with the original.  A modification only copies the tree
+ * nodes on the path from the root to the changed entry that are still shared
+ * with another map, so it costs O(log n) rather than the O(n) a
+ * boost::container::flat_map copy costs.  This makes it a good NodeMap
+ * container for large maps that are cloned and modified often, such as
+ * neighbor tables.
+ *
+ * Two maps derived from each other share every subtree that neither has
+ * changed, which skipShared() uses to compare them in time proportional to
+ * the number of changes rather than the size of the maps.
+ *
+ * The interface follows boost::container::flat_map, with a few differences:
+ *  - Only find() on a non-const map returns a mutable iterator.  It copies the
+ *    path to the entry if it is shared, so the entry's value may be assigned
+ *    through it.  All other iteration is const.
+ *  - Any modification invalidates all iterators.
+ */
+template <typename KeyT, typename ValueT, size_t kMaxEntries = 32>
+class PersistentSortedMap {
+  static_assert(kMaxEntries >= 4, "tree nodes must hold at least 4 entries");
+
+  struct Leaf;
+
+ public:
+  using key_type = KeyT;
+  using mapped_type = ValueT;
+  using value_type = std::pair<KeyT, ValueT>;
+  using size_type = size_t;
+
+  template <bool kConst>
+  class IteratorImpl {
+   public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = PersistentSortedMap::value_type;
+    using difference_type = ptrdiff_t;
+    using pointer =
+        std::conditional_t<kConst, const value_type*, value_type*>;
+    using reference =
+        std::conditional_t<kConst, const value_type&, value_type&>;
+
+    IteratorImpl() {}
+
+    // iterator converts to const_iterator
+    template <
+        bool kOtherConst,
+        typename = std::enable_if_t<kConst && !kOtherConst>>
+    /* implicit */ IteratorImpl(const IteratorImpl<kOtherConst>& other)
+        : map_(other.map_), leaf_(other.leaf_), index_(other.index_) {}
+
+    reference operator*() const {
+      return leaf_->entries[index_];
+    }
+    pointer operator->() const {
+      return &leaf_->entries[index_];
+    }
+
+    IteratorImpl& operator++() {
+      DCHECK(leaf_);
+      if (++index_ == leaf_->entries.size()) {
+        *this = map_->template upperBound<kConst>(leaf_->entries.back().first);
+      }
+      return *this;
+    }
+    IteratorImpl operator++(int) {
+      IteratorImpl tmp(*this);
+      ++(*this);
+      return tmp;
+    }
+    IteratorImpl& operator--() {
+      if (!leaf_) {
+        *this = map_->template lastEntry<kConst>();
+      } else if (index_ == 0) {
+        *this = map_->template lastBefore<kConst>(leaf_->entries[0].first);
+      } else {
+        --index_;
+      }
+      return *this;
+    }
+    IteratorImpl operator--(int) {
+      IteratorImpl tmp(*this);
+      --(*this);
+      return tmp;
+    }
+
+    template <bool kOtherConst>
+    bool operator==(const IteratorImpl<kOtherConst>& other) const {
+      return leaf_ == other.leaf_ && index_ == other.index_;
+    }
+    template <bool kOtherConst>
+    bool operator!=(const IteratorImpl<kOtherConst>& other) const {
+      return !operator==(other);
+    }
+
+   private:
+    friend class PersistentSortedMap;
+    template <bool>
+    friend class IteratorImpl;
+
+    IteratorImpl(const PersistentSortedMap* map, Leaf* leaf, size_t index)
+        : map_(map), leaf_(leaf), index_(index) {}
+
+    const PersistentSortedMap* map_{nullptr};
+    // Null at the end of the map
+    Leaf* leaf_{nullptr};
+    size_t index_{0};
+  };
+
+  using iterator = IteratorImpl<false>;
+  using const_iterator = IteratorImpl<true>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  PersistentSortedMap() {}
+
+  size_t size() const {
+    return size_;
+  }
+  bool empty() const {
+    return size_ == 0;
+  }
+  void clear() {
+    root_.reset();
+    size_ = 0;
+  }
+
+  const_iterator begin() const {
+    if (!root_) {
+      return end();
+    }
+    return const_iterator(this, leftmostLeaf(root_.get()), 0);
+  }
+  const_iterator end() const {
+    return const_iterator(this, nullptr, 0);
+  }
+  const_reverse_iterator rbegin() const {
+    return const_reverse_iterator(end());
+  }
+  const_reverse_iterator rend() const {
+    return const_reverse_iterator(begin());
+  }
+
+  const_iterator find(const KeyT& key) const {
+    auto it = lower_bound(key);
+    if (it == end() || key < it->first) {
+      return end();
+    }
+    return it;
+  }
+  iterator find(const KeyT& key) {
+    if (static_cast<const PersistentSortedMap*>(this)->find(key) == end()) {
+      return iterator(this, nullptr, 0);
+    }
+    return findWritable(key);
+  }
+  size_t count(const KeyT& key) const {
+    return find(key) == end() ? 0 : 1;
+  }
+
+  const_iterator lower_bound(const KeyT& key) const {
+    return lowerBound<true>(key);
+  }
+  const_iterator upper_bound(const KeyT& key) const {
+    return upperBound<true>(key);
+  }
+
+  std::pair<iterator, bool> insert(value_type value) {
+    KeyT key = value.first;
+    if (find(key) != end()) {
+      return std::make_pair(findWritable(key), false);
+    }
+    if (!root_) {
+      root_ = std::make_shared<Leaf>();
+    }
+    auto sibling = insertImpl(root_, std::move(value));
+    if (sibling) {
+      // The root split, grow the tree by one level
+      auto newRoot = std::make_shared<Inner>();
+      newRoot->firstKeys.push_back(firstKey(root_.get()));
+      newRoot->firstKeys.push_back(firstKey(sibling.get()));
+      newRoot->children.push_back(std::move(root_));
+      newRoot->children.push_back(std::move(sibling));
+      root_ = std::move(newRoot);
+    }
+    ++size_;
+    return std::make_pair(findWritable(key), true);
+  }
+
+  size_t erase(const KeyT& key) {
+    if (find(key) == end()) {
+      return 0;
+    }
+    eraseImpl(root_, key);
+    --size_;
+    // Shrink the tree while the root has a single child
+    while (!root_->isLeaf && asInner(root_.get())->children.size() == 1) {
+      auto child = asInner(root_.get())->children[0];
+      root_ = std::move(child);
+    }
+    if (size_ == 0) {
+      root_.reset();
+    }
+    return 1;
+  }
+  const_iterator erase(const_iterator pos) {
+    DCHECK(pos != end());
+    KeyT key = pos->first;
+    erase(key);
+    return upper_bound(key);
+  }
+
+  /*
+   * Calls fn(value) for every value in subtrees that haven't been visited by
+   * a previous publishValues() call on this map or on a map they are shared
+   * with, and marks those subtrees as visited.  Modified subtrees are visited
+   * again.
+   *
+   * NodeMap uses this to publish just the nodes that changed since the map
+   * was cloned.
+   */
+  template <typename Fn>
+  void publishValues(Fn fn) {
+    if (root_) {
+      publishValuesImpl(root_.get(), fn);
+    }
+  }
+
+  /*
+   * Call fn(treeNode, bytes) for each node of the tree, the address telling
+   * nodes shared with other maps apart.  The subtree under a node is skipped
+   * if fn returns false, as when it has seen the node before.  Used to
+   * account memory.
+   */
+  template <typename Fn>
+  void forEachTreeNode(const Fn& fn) const {
+    if (root_) {
+      forEachTreeNodeImpl(root_.get(), fn);
+    }
+  }
+
+  /*
+   * aIt and bIt must point at the same key in a and b.  If a and b share a
+   * subtree containing that key, advance both iterators past the rest of the
+   * subtree, whose entries are by definition identical in the two maps, and
+   * return true.  Otherwise leave the iterators alone and return false.
+   */
+  static bool skipShared(
+      const PersistentSortedMap& a,
+      const_iterator& aIt,
+      const PersistentSortedMap& b,
+      const_iterator& bIt) {
+    DCHECK(aIt != a.end() && bIt != b.end());
+    const auto& key = aIt->first;
+    // The trees may have different depths, so compare the whole paths.
+    auto aPath = a.pathTo(key);
+    auto bPath = b.pathTo(key);
+    for (auto node : aPath) {
+      if (std::find(bPath.begin(), bPath.end(), node) != bPath.end()) {
+        KeyT last = lastKey(node);
+        aIt = a.upper_bound(last);
+        bIt = b.upper_bound(last);
+        return true;
+      }
+    }
+    return false;
+  }
+
+ private:
+  struct TreeNode {
+    explicit TreeNode(bool leaf) : isLeaf(leaf) {}
+    TreeNode(const TreeNode& other) : isLeaf(other.isLeaf) {}
+
+    const bool isLeaf;
+    // Set by publishValues(), cleared by copying the node
+    bool published{false};
+  };
+  using TreeNodePtr = std::shared_ptr<TreeNode>;
+
+  struct Leaf : public TreeNode {
+    Leaf() : TreeNode(true) {}
+    std::vector<value_type> entries;
+  };
+
+  struct Inner : public TreeNode {
+    Inner() : TreeNode(false) {}
+    // firstKeys[i] is the smallest key under children[i]
+    std::vector<KeyT> firstKeys;
+    std::vector<TreeNodePtr> children;
+  };
+
+  static Leaf* asLeaf(TreeNode* node) {
+    DCHECK(node->isLeaf);
+    return static_cast<Leaf*>(node);
+  }
+  static Inner* asInner(TreeNode* node) {
+    DCHECK(!node->isLeaf);
+    return static_cast<Inner*>(node);
+  }
+
+  static size_t childIndex(const Inner* inner, const KeyT& key) {
+    auto it = std::upper_bound(
+        inner->firstKeys.begin(), inner->firstKeys.end(), key);
+    return it == inner->firstKeys.begin() ? 0
+                                          : it - inner->firstKeys.begin() - 1;
+  }
+  static size_t entryCount(TreeNode* node) {
+    return node->isLeaf ? asLeaf(node)->entries.size()
+                        : asInner(node)->children.size();
+  }
+  static const KeyT& firstKey(TreeNode* node) {
+    return node->isLeaf ? asLeaf(node)->entries.front().first
+                        : asInner(node)->firstKeys.front();
+  }
+  static const KeyT& lastKey(TreeNode* node) {
+    while (!node->isLeaf) {
+      node = asInner(node)->children.back().get();
+    }
+    return asLeaf(node)->entries.back().first;
+  }
+  static Leaf* leftmostLeaf(TreeNode* node) {
+    while (!node->isLeaf) {
+      node = asInner(node)->children.front().get();
+    }
+    return asLeaf(node);
+  }
+  static Leaf* rightmostLeaf(TreeNode* node) {
+    while (!node->isLeaf) {
+      node = asInner(node)->children.back().get();
+    }
+    return asLeaf(node);
+  }
+
+  std::vector<TreeNode*> pathTo(const KeyT& key) const {
+    std::vector<TreeNode*> path;
+    for (auto node = root_.get(); node;) {
+      path.push_back(node);
+      node = node->isLeaf
+          ? nullptr
+          : asInner(node)->children[childIndex(asInner(node), key)].get();
+    }
+    return path;
+  }
+
+  /*
+   * Make the node in slot safe to modify: copy it if another map or node
+   * shares it, and mark it unpublished since it is about to change.
+   */
+  static TreeNode* makeWritable(TreeNodePtr& slot) {
+    if (slot.use_count() > 1) {
+      if (slot->isLeaf) {
+        slot = std::make_shared<Leaf>(*asLeaf(slot.get()));
+      } else {
+        slot = std::make_shared<Inner>(*asInner(slot.get()));
+      }
+    }
+    slot->published = false;
+    return slot.get();
+  }
+
+  iterator findWritable(const KeyT& key) {
+    TreeNodePtr* slot = &root_;
+    while (!(*slot)->isLeaf) {
+      auto inner = asInner(makeWritable(*slot));
+      slot = &inner->children[childIndex(inner, key)];
+    }
+    auto leaf = asLeaf(makeWritable(*slot));
+    auto it = std::lower_bound(
+        leaf->entries.begin(),
+        leaf->entries.end(),
+        key,
+        [](const value_type& entry, const KeyT& k) { return entry.first < k; });
+    DCHECK(it != leaf->entries.end() && !(key < it->first));
+    return iterator(this, leaf, it - leaf->entries.begin());
+  }
+
+  template <bool kConst>
+  IteratorImpl<kConst> lowerBound(const KeyT& key) const {
+    return bound<kConst>(key, [](const value_type& entry, const KeyT& k) {
+      return entry.first < k;
+    });
+  }
+  template <bool kConst>
+  IteratorImpl<kConst> upperBound(const KeyT& key) const {
+    return bound<kConst>(key, [](const value_type& entry, const KeyT& k) {
+      return !(k < entry.first);
+    });
+  }
+
+  /*
+   * First entry for which before(entry, key) is false.
+   */
+  template <bool kConst, typename Before>
+  IteratorImpl<kConst> bound(const KeyT& key, Before before) const {
+    // The subtree just after the path we descend, where the result is if it
+    // isn't on the path.
+    TreeNode* next = nullptr;
+    auto node = root_.get();
+    if (!node) {
+      return IteratorImpl<kConst>(this, nullptr, 0);
+    }
+    while (!node->isLeaf) {
+      auto inner = asInner(node);
+      auto idx = childIndex(inner, key);
+      if (idx + 1 < inner->children.size()) {
+        next = inner->children[idx + 1].get();
+      }
+      node = inner->children[idx].get();
+    }
+    auto leaf = asLeaf(node);
+    auto it = std::lower_bound(
+        leaf->entries.begin(), leaf->entries.end(), key, before);
+    if (it != leaf->entries.end()) {
+      return IteratorImpl<kConst>(this, leaf, it - leaf->entries.begin());
+    }
+    return IteratorImpl<kConst>(this, next ? leftmostLeaf(next) : nullptr, 0);
+  }
+
+  /*
+   * Last entry with a key less than key, which must be in the map.
+   */
+  template <bool kConst>
+  IteratorImpl<kConst> lastBefore(const KeyT& key) const {
+    TreeNode* prev = nullptr;
+    auto node = root_.get();
+    while (!node->isLeaf) {
+      auto inner = asInner(node);
+      auto idx = childIndex(inner, key);
+      if (idx > 0) {
+        prev = inner->children[idx - 1].get();
+      }
+      node = inner->children[idx].get();
+    }
+    auto leaf = asLeaf(node);
+    auto it = std::lower_bound(
+        leaf->entries.begin(),
+        leaf->entries.end(),
+        key,
+        [](const value_type& entry, const KeyT& k) { return entry.first < k; });
+    if (it != leaf->entries.begin()) {
+      return IteratorImpl<kConst>(this, leaf, it - leaf->entries.begin() - 1);
+    }
+    CHECK(prev) << "decremented an iterator at the beginning of the map";
+    auto prevLeaf = rightmostLeaf(prev);
+    return IteratorImpl<kConst>(this, prevLeaf, prevLeaf->entries.size() - 1);
+  }
+
+  template <bool kConst>
+  IteratorImpl<kConst> lastEntry() const {
+    CHECK(root_) << "decremented an iterator into an empty map";
+    auto leaf = rightmostLeaf(root_.get());
+    return IteratorImpl<kConst>(this, leaf, leaf->entries.size() - 1);
+  }
+
+  /*
+   * Insert value, which must not be in the map, under slot.  Returns the new
+   * right sibling if the node in slot had to split.
+   */
+  static TreeNodePtr insertImpl(TreeNodePtr& slot, value_type&& value) {
+    auto node = makeWritable(slot);
+    if (node->isLeaf) {
+      auto& entries = asLeaf(node)->entries;
+      auto it = std::lower_bound(
+          entries.begin(),
+          entries.end(),
+          value.first,
+          [](const value_type& entry, const KeyT& k) {
+            return entry.first < k;
+          });
+      entries.insert(it, std::move(value));
+      if (entries.size() <= kMaxEntries) {
+        return nullptr;
+      }
+      auto sibling = std::make_shared<Leaf>();
+      auto half = entries.begin() + entries.size() / 2;
+      sibling->entries.assign(
+          std::make_move_iterator(half), std::make_move_iterator(entries.end()));
+      entries.erase(half, entries.end());
+      return sibling;
+    }
+
+    auto inner = asInner(node);
+    auto idx = childIndex(inner, value.first);
+    if (value.first < inner->firstKeys[idx]) {
+      inner->firstKeys[idx] = value.first;
+    }
+    auto split = insertImpl(inner->children[idx], std::move(value));
+    if (!split) {
+      return nullptr;
+    }
+    inner->firstKeys.insert(
+        inner->firstKeys.begin() + idx + 1, firstKey(split.get()));
+    inner->children.insert(
+        inner->children.begin() + idx + 1, std::move(split));
+    if (inner->children.size() <= kMaxEntries) {
+      return nullptr;
+    }
+    auto sibling = std::make_shared<Inner>();
+    auto half = inner->children.size() / 2;
+    sibling->firstKeys.assign(
+        inner->firstKeys.begin() + half, inner->firstKeys.end());
+    sibling->children.assign(
+        inner->children.begin() + half, inner->children.end());
+    inner->firstKeys.resize(half);
+    inner->children.resize(half);
+    return sibling;
+  }
+
+  /*
+   * Erase key, which must be in the map, from under slot.  Children that
+   * become empty are removed, and small children are merged with a neighbor,
+   * but the node in slot itself is left for the caller to fix up.
+   */
+  static void eraseImpl(TreeNodePtr& slot, const KeyT& key) {
+    auto node = makeWritable(slot);
+    if (node->isLeaf) {
+      auto& entries = asLeaf(node)->entries;
+      auto it = std::lower_bound(
+          entries.begin(),
+          entries.end(),
+          key,
+          [](const value_type& entry, const KeyT& k) {
+            return entry.first < k;
+          });
+      DCHECK(it != entries.end() && !(key < it->first));
+      entries.erase(it);
+      return;
+    }
+
+    auto inner = asInner(node);
+    auto idx = childIndex(inner, key);
+    eraseImpl(inner->children[idx], key);
+    auto child = inner->children[idx].get();
+    auto childEntries = entryCount(child);
+    if (childEntries == 0) {
+      inner->firstKeys.erase(inner->firstKeys.begin() + idx);
+      inner->children.erase(inner->children.begin() + idx);
+      return;
+    }
+    inner->firstKeys[idx] = firstKey(child);
+    if (childEntries >= kMaxEntries / 4 || inner->children.size() == 1) {
+      return;
+    }
+    // Merge the child with a neighbor if they fit in one node
+    auto left = idx + 1 < inner->children.size() ? idx : idx - 1;
+    auto right = left + 1;
+    if (entryCount(inner->children[left].get()) +
+            entryCount(inner->children[right].get()) >
+        kMaxEntries) {
+      return;
+    }
+    auto leftNode = makeWritable(inner->children[left]);
+    auto rightNode = inner->children[right].get();
+    if (leftNode->isLeaf) {
+      auto& from = asLeaf(rightNode)->entries;
+      auto& to = asLeaf(leftNode)->entries;
+      to.insert(to.end(), from.begin(), from.end());
+    } else {
+      auto fromInner = asInner(rightNode);
+      auto toInner = asInner(leftNode);
+      toInner->firstKeys.insert(
+          toInner->firstKeys.end(),
+          fromInner->firstKeys.begin(),
+          fromInner->firstKeys.end());
+      toInner->children.insert(
+          toInner->children.end(),
+          fromInner->children.begin(),
+          fromInner->children.end());
+    }
+    inner->firstKeys.erase(inner->firstKeys.begin() + right);
+    inner->children.erase(inner->children.begin() + right);
+  }
+
+  template <typename Fn>
+  static void forEachTreeNodeImpl(TreeNode* node, const Fn& fn) {
+    if (node->isLeaf) {
+      auto leaf = asLeaf(node);
+      fn(static_cast<const void*>(node),
+         sizeof(Leaf) + leaf->entries.capacity() * sizeof(value_type));
+      return;
+    }
+    auto inner = asInner(node);
+    if (!fn(static_cast<const void*>(node),
+            sizeof(Inner) + inner->firstKeys.capacity() * sizeof(KeyT) +
+                inner->children.capacity() * sizeof(TreeNodePtr))) {
+      return;
+    }
+    for (const auto& child : inner->children) {
+      forEachTreeNodeImpl(child.get(), fn);
+    }
+  }
+
+  template <typename Fn>
+  static void publishValuesImpl(TreeNode* node, Fn& fn) {
+    if (node->published) {
+      return;
+    }
+    if (node->isLeaf) {
+      for (const auto& entry : asLeaf(node)->entries) {
+        fn(entry.second);
+      }
+    } else {
+      for (const auto& child : asInner(node)->children) {
+        publishValuesImpl(child.get(), fn);
+      }
+    }
+    node->published = true;
+  }
+
+  TreeNodePtr root_;
+  size_t size_{0};
+};
+
+}} // facebook::fboss
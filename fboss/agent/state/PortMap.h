@@ -16,7 +16,9 @@ namespace facebook { namespace fboss {
 
 class SwitchState;
 class Port;
-typedef NodeMapTraits<PortID, Port> PortMapTraits;
+struct PortMapTraits : public NodeMapTraits<PortID, Port> {
+  using NodeContainer = DenseIdMap<PortID, std::shared_ptr<Port>>;
+};
 
 /*
  * A container for the set of ports.
@@ -144,6 +144,9 @@ class Route : public NodeBaseT<Route<AddrT>, RouteFields<AddrT>> {
   bool hasNoEntry() const {
     return RouteBase::getFields()->nexthopsmulti.isEmpty();
   }
+  std::vector<ClientID> getClients() const {
+    return RouteBase::getFields()->nexthopsmulti.getClients();
+  }
 
   bool has(ClientID clientId, const RouteNextHopEntry& entry) const;
 
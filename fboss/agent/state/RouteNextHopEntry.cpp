@@ -11,6 +11,7 @@
 
 #include "fboss/agent/FbossError.h"
 
+#include <boost/functional/hash.hpp>
 #include <folly/logging/xlog.h>
 #include <gflags/gflags.h>
 #include <numeric>
@@ -51,11 +52,21 @@ RouteNextHopEntry::RouteNextHopEntry(NextHopSet nhopSet, AdminDistance distance)
     : adminDistance_(distance),
       action_(Action::NEXTHOPS),
       nhopSet_(std::move(nhopSet)) {
-  if (nhopSet_.size() == 0) {
+  if (getNextHopSet().size() == 0) {
     throw FbossError("Empty nexthop set is passed to the RouteNextHopEntry");
   }
 }
 
+size_t RouteNextHopEntry::NextHopSetHash::operator()(
+    const NextHopSet& nhops) const {
+  size_t hash = 0;
+  for (const auto& nhop : nhops) {
+    boost::hash_combine(hash, std::hash<folly::IPAddress>()(nhop.addr()));
+    boost::hash_combine(hash, nhop.weight());
+  }
+  return hash;
+}
+
 NextHopWeight RouteNextHopEntry::getTotalWeight() const {
   return totalWeight(getNextHopSet());
 }
@@ -82,8 +93,9 @@ std::string RouteNextHopEntry::str() const {
 }
 
 bool operator==(const RouteNextHopEntry& a, const RouteNextHopEntry& b) {
+  // Equal next hop sets are the same interned set
   return (a.getAction() == b.getAction()
-          and a.getNextHopSet() == b.getNextHopSet()
+          and a.nhopSet_ == b.nhopSet_
           and a.getAdminDistance() == b.getAdminDistance());
 }
 
@@ -132,7 +144,7 @@ folly::dynamic RouteNextHopEntry::toFollyDynamic() const {
   folly::dynamic entry = folly::dynamic::object;
   entry[kAction] = forwardActionStr(action_);
   folly::dynamic nhops = folly::dynamic::array;
-  for (const auto& nhop: nhopSet_) {
+  for (const auto& nhop : getNextHopSet()) {
     nhops.push_back(nhop.toFollyDynamic());
   }
   entry[kNexthops] = std::move(nhops);
@@ -149,9 +161,11 @@ RouteNextHopEntry::fromFollyDynamic(const folly::dynamic& entryJson) {
       : AdminDistance(entryJson[kAdminDistance].asInt());
   RouteNextHopEntry entry(Action::DROP, adminDistance);
   entry.action_ = action;
+  NextHopSet nhopSet;
   for (const auto& nhop : entryJson[kNexthops]) {
-    entry.nhopSet_.insert(util::nextHopFromFollyDynamic(nhop));
+    nhopSet.insert(util::nextHopFromFollyDynamic(nhop));
   }
+  entry.nhopSet_ = InternedNextHopSet(std::move(nhopSet));
   return entry;
 }
 
@@ -159,7 +173,7 @@ bool RouteNextHopEntry::isValid(bool forMplsRoute) const {
   bool valid = true;
   if (!forMplsRoute) {
     /* for ip2mpls routes, next hop label forwarding action must be push */
-    for (const auto& nexthop : nhopSet_) {
+    for (const auto& nexthop : getNextHopSet()) {
       if (action_ != Action::NEXTHOPS) {
         continue;
       }
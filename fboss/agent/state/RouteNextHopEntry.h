@@ -13,6 +13,7 @@
 
 #include <folly/dynamic.h>
 
+#include "fboss/agent/state/Interned.h"
 #include "fboss/agent/state/RouteNextHop.h"
 #include "fboss/agent/state/RouteTypes.h"
 
@@ -24,6 +25,10 @@ class RouteNextHopEntry {
  public:
   using Action = RouteForwardAction;
   using NextHopSet = boost::container::flat_set<NextHop>;
+  // Hashes the addresses and weights of the next hops
+  struct NextHopSetHash {
+    size_t operator()(const NextHopSet& nhops) const;
+  };
 
   RouteNextHopEntry(Action action, AdminDistance distance)
       : adminDistance_(distance), action_(action) {
@@ -33,9 +38,9 @@ class RouteNextHopEntry {
   RouteNextHopEntry(NextHopSet nhopSet, AdminDistance distance);
 
   RouteNextHopEntry(NextHop nhop, AdminDistance distance)
-      : adminDistance_(distance), action_(Action::NEXTHOPS) {
-    nhopSet_.emplace(std::move(nhop));
-  }
+      : adminDistance_(distance),
+        action_(Action::NEXTHOPS),
+        nhopSet_(NextHopSet{std::move(nhop)}) {}
 
   AdminDistance getAdminDistance() const {
     return adminDistance_;
@@ -46,7 +51,7 @@ class RouteNextHopEntry {
   }
 
   const NextHopSet& getNextHopSet() const {
-    return nhopSet_;
+    return nhopSet_.get();
   }
 
   NextHopSet normalizedNextHops() const;
@@ -79,7 +84,7 @@ class RouteNextHopEntry {
 
   // Reset the NextHopSet
   void reset() {
-    nhopSet_.clear();
+    nhopSet_ = InternedNextHopSet();
     action_ = Action::DROP;
   }
 
@@ -88,7 +93,12 @@ class RouteNextHopEntry {
  private:
   AdminDistance adminDistance_;
   Action action_{Action::DROP};
-  NextHopSet nhopSet_;
+  // Shared with every other entry with the same next hops
+  using InternedNextHopSet = Interned<NextHopSet, NextHopSetHash>;
+  InternedNextHopSet nhopSet_;
+
+  friend bool operator==(
+      const RouteNextHopEntry& a, const RouteNextHopEntry& b);
 };
 
 /**
@@ -15,6 +15,8 @@
 
 #include <boost/container/flat_map.hpp>
 
+#include <limits>
+
 #include "fboss/agent/state/RouteNextHopEntry.h"
 #include "fboss/agent/if/gen-cpp2/ctrl_types.h"
 #include "fboss/agent/types.h"
@@ -44,9 +46,15 @@ namespace facebook { namespace fboss {
  */
 class RouteNextHopsMulti {
  protected:
-   ClientID findLowestAdminDistance();
+   static constexpr uint32_t kNoBestEntry =
+       std::numeric_limits<uint32_t>::max();
+
+   void findBestEntry();
    boost::container::flat_map<ClientID, RouteNextHopEntry> map_;
-   ClientID lowestAdminDistanceClientId_;
+   // Position in map_ of the entry with the lowest admin distance, ties
+   // going to the lowest ClientID. update() and delEntryForClient() keep it
+   // current, so getBestEntry() does not search map_.
+   uint32_t bestEntry_{kNoBestEntry};
 
  public:
   folly::dynamic toFollyDynamic() const;
@@ -59,6 +67,7 @@ class RouteNextHopsMulti {
 
   void clear() {
     map_.clear();
+    bestEntry_ = kNoBestEntry;
   }
 
   bool operator==(const RouteNextHopsMulti& p2) const {
@@ -78,6 +87,9 @@ class RouteNextHopsMulti {
 
   std::pair<ClientID, const RouteNextHopEntry *> getBestEntry() const;
 
+  // The clients with an entry, in ClientID order
+  std::vector<ClientID> getClients() const;
+
   bool isSame(ClientID clientId, const RouteNextHopEntry& nhe) const;
 };
 
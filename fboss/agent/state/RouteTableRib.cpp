@@ -104,18 +104,68 @@ template <typename AddrT>
 void RouteTableRib<AddrT>::addRoute(
     const std::shared_ptr<Route<AddrT>>& route) {
   nodeMap_->addRoute(route);
+  addClientPrefixes(*route);
 }
 
 template <typename AddrT>
 void RouteTableRib<AddrT>::updateRoute(
     const std::shared_ptr<Route<AddrT>>& route) {
+  auto old = nodeMap_->getRouteIf(route->prefix());
   nodeMap_->updateRoute(route);
+  if (old) {
+    removeClientPrefixes(*old);
+  }
+  addClientPrefixes(*route);
 }
 
 template <typename AddrT>
 void RouteTableRib<AddrT>::removeRoute(
     const std::shared_ptr<Route<AddrT>>& route) {
   nodeMap_->removeRoute(route);
+  removeClientPrefixes(*route);
+}
+
+template <typename AddrT>
+const typename RouteTableRib<AddrT>::ClientPrefixes&
+RouteTableRib<AddrT>::prefixesForClient(ClientID clientId) const {
+  static const ClientPrefixes kEmpty;
+  auto it = clientPrefixes_.find(clientId);
+  return it == clientPrefixes_.end() ? kEmpty : it->second;
+}
+
+template <typename AddrT>
+void RouteTableRib<AddrT>::addClientPrefix(
+    ClientID clientId,
+    const Prefix& prefix) {
+  clientPrefixes_[clientId].insert(prefix);
+}
+
+template <typename AddrT>
+void RouteTableRib<AddrT>::removeClientPrefix(
+    ClientID clientId,
+    const Prefix& prefix) {
+  auto it = clientPrefixes_.find(clientId);
+  if (it == clientPrefixes_.end()) {
+    return;
+  }
+  it->second.erase(prefix);
+  if (it->second.empty()) {
+    clientPrefixes_.erase(it);
+  }
+}
+
+template <typename AddrT>
+void RouteTableRib<AddrT>::addClientPrefixes(const Route<AddrT>& route) {
+  for (auto clientId : route.getClients()) {
+    addClientPrefix(clientId, route.prefix());
+  }
+}
+
+template <typename AddrT>
+void RouteTableRib<AddrT>::removeClientPrefixes(const Route<AddrT>& route) {
+  for (auto clientId : route.getClients()) {
+    removeClientPrefix(clientId, route.prefix());
+  }
 }
 
 template class RouteTableRib<folly::IPAddressV4>;
@@ -16,6 +16,10 @@
 #include "fboss/agent/state/RouteTypes.h"
 #include "fboss/lib/RadixTree.h"
 
+#include <boost/container/flat_map.hpp>
+
+#include <set>
+
 namespace facebook { namespace fboss {
 
 template<typename AddrT>
@@ -80,6 +84,7 @@ class RouteTableRib : public NodeBase {
   using RouteType = Route<AddrT>;
   using RoutesRadixTree = facebook::network::RadixTree<AddrT,
         std::shared_ptr<Route<AddrT>>>;
+  using ClientPrefixes = std::set<Prefix>;
 
   bool empty() const {
     return nodeMap_->empty();
@@ -104,6 +109,18 @@ class RouteTableRib : public NodeBase {
     NodeBase::publish();
   }
 
+  void forEachChildNode(
+      const std::function<void(const NodeBase*)>& fn) const override {
+    fn(nodeMap_.get());
+  }
+
+  size_t ownBytes(const SharedBytesFn& /*shared*/) const override {
+    // The radix tree holds one node per route, plus the inner nodes where
+    // prefixes branch, which are not counted
+    return sizeof(*this) +
+        radixTree_.size() * sizeof(typename RoutesRadixTree::TreeNode);
+  }
+
   RouteTableRib* modify(RouterID id, std::shared_ptr<SwitchState>* state);
 
   std::shared_ptr<RouteTableRib> clone() const {
@@ -119,6 +136,7 @@ class RouteTableRib : public NodeBase {
     // Note: this is the default NodeMap clone(), only the nodeMap pointer is
     // cloned, while all the routes are still the old route pointer.
     routeTableRib->nodeMap_ = nodeMap_->clone();
+    routeTableRib->clientPrefixes_ = clientPrefixes_;
     return routeTableRib;
   }
 
@@ -153,6 +171,19 @@ class RouteTableRib : public NodeBase {
     return nodeMap_->getRouteIf(prefix);
   }
 
+  /*
+   * The prefixes of the routes with an entry from clientId, so that walking
+   * one client's routes does not mean walking every route in the table.
+   *
+   * addRoute(), updateRoute() and removeRoute() keep this in step with the
+   * entries of the routes passed to them. A route changed after it was
+   * passed, as RouteUpdater does when adding or deleting a client's entry,
+   * must be followed by addClientPrefix() or removeClientPrefix().
+   */
+  const ClientPrefixes& prefixesForClient(ClientID clientId) const;
+  void addClientPrefix(ClientID clientId, const Prefix& prefix);
+  void removeClientPrefix(ClientID clientId, const Prefix& prefix);
+
   void cloneToRadixTreeWithForwardClear() {
     // We should expect this function is called only before we publish the rib
     CHECK(!isPublished());
@@ -209,8 +240,12 @@ class RouteTableRib : public NodeBase {
   }
 
  private:
+  void addClientPrefixes(const Route<AddrT>& route);
+  void removeClientPrefixes(const Route<AddrT>& route);
+
   RoutesRadixTree radixTree_;
   std::shared_ptr<RoutesNodeMap> nodeMap_;
+  boost::container::flat_map<ClientID, ClientPrefixes> clientPrefixes_;
 };
 
 }}
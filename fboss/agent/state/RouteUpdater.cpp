@@ -123,6 +123,7 @@ void RouteUpdater::addRouteImpl(const PrefixT& prefix, RibT *ribCloned,
       newRoute = old;
     }
     newRoute->update(clientId, std::move(entry));
+    rib->addClientPrefix(clientId, prefix);
     XLOG(DBG3) << "Updated route " << newRoute->str();
   } else {
     auto newRoute = make_shared<RouteT>(prefix, clientId, std::move(entry));
@@ -193,6 +194,7 @@ void RouteUpdater::delRouteImpl(
     rib->updateRoute(old);
   }
   old->delEntryForClient(clientId);
+  rib->removeClientPrefix(clientId, prefix);
   // TODO Do I need to publish the change??
   XLOG(DBG3) << "Deleted nexthops for client " << clientId << " from route "
              << prefix.str();
@@ -215,30 +217,22 @@ void RouteUpdater::delRoute(
 }
 
 template<typename AddrT, typename RibT>
-void RouteUpdater::removeAllRoutesForClientImpl(RibT *ribCloned,
-                                                ClientID clientId) {
-  auto rib = makeClone(ribCloned);
-
-  std::vector<std::shared_ptr<Route<AddrT>>> routesToDelete;
-
-  // make sure rib is cloned before any change
-  CHECK(ribCloned->cloned);
-  for (auto& routeNode : rib->writableRoutes()->writableNodes()) {
-    auto route = routeNode.second;
-    if (route->isPublished()) {
-      route = route->clone();
-      routeNode.second = route;
-    }
-    route->delEntryForClient(clientId);
-    if (route->hasNoEntry()) {
-      // The nexthops we removed was the only one.  Delete the route.
-      routesToDelete.push_back(routeNode.second);
+void RouteUpdater::removeAllRoutesForClientImpl(
+    RibT *ribCloned,
+    ClientID clientId,
+    const boost::container::flat_set<RoutePrefix<AddrT>>* keep) {
+  // Find the routes to change first, so that none of the others are cloned
+  // and the RIB itself is only cloned if there is something to remove
+  std::vector<RoutePrefix<AddrT>> toRemove;
+  for (const auto& prefix : ribCloned->rib->prefixesForClient(clientId)) {
+    if (keep && keep->find(prefix) != keep->end()) {
+      continue;
     }
+    toRemove.push_back(prefix);
   }
 
-  // Now, delete whatever routes went from 1 nexthoplist to 0.
-  for (std::shared_ptr<Route<AddrT>>& route : routesToDelete) {
-    rib->removeRoute(route);
+  for (const auto& prefix : toRemove) {
+    delRouteImpl(prefix, ribCloned, clientId);
   }
 }
 
@@ -247,6 +241,15 @@ void RouteUpdater::removeAllRoutesForClient(RouterID rid, ClientID clientId) {
   removeAllRoutesForClientImpl<IPAddressV6>(getRibV6(rid), clientId);
 }
 
+void RouteUpdater::removeRoutesForClientExcept(
+    RouterID rid,
+    ClientID clientId,
+    const boost::container::flat_set<PrefixV4>& keepV4,
+    const boost::container::flat_set<PrefixV6>& keepV6) {
+  removeAllRoutesForClientImpl<IPAddressV4>(getRibV4(rid), clientId, &keepV4);
+  removeAllRoutesForClientImpl<IPAddressV6>(getRibV6(rid), clientId, &keepV6);
+}
+
 // Some helper functions for recursive weight resolution
 // These aren't really usefully reusable, but structuring them
 // this way helps with clarifying their meaning.
@@ -77,6 +77,15 @@ class RouteUpdater {
   // method to delete all routes from a client
   void removeAllRoutesForClient(RouterID rid, ClientID clientId);
 
+  // method to delete the routes from a client other than those in keepV4
+  // and keepV6. This is how a sync drops the routes a client no longer has
+  // after re-adding the rest: routes it kept are never cloned or touched.
+  void removeRoutesForClientExcept(
+      RouterID rid,
+      ClientID clientId,
+      const boost::container::flat_set<PrefixV4>& keepV4,
+      const boost::container::flat_set<PrefixV6>& keepV6);
+
   std::shared_ptr<RouteTableMap> updateDone();
 
   // Add all interface routes (directly connected routes) and link local routes
@@ -123,7 +132,10 @@ class RouteUpdater {
   template<typename PrefixT, typename RibT>
   void delRouteImpl(const PrefixT& prefix, RibT *ribCloned, ClientID clientId);
   template<typename AddrT, typename RibT>
-  void removeAllRoutesForClientImpl(RibT *ribCloned, ClientID clientId);
+  void removeAllRoutesForClientImpl(
+      RibT *ribCloned,
+      ClientID clientId,
+      const boost::container::flat_set<RoutePrefix<AddrT>>* keep = nullptr);
 
   // resolve all routes that are not resolved yet
   void resolve();
@@ -0,0 +1,107 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/state/StateMemoryUsage.h"
+
+#include <folly/Conv.h>
+
+#include "fboss/agent/state/ForwardingInformationBaseContainer.h"
+#include "fboss/agent/state/ForwardingInformationBaseMap.h"
+#include "fboss/agent/state/RouteTable.h"
+#include "fboss/agent/state/RouteTableMap.h"
+#include "fboss/agent/state/SwitchState.h"
+#include "fboss/agent/state/Vlan.h"
+#include "fboss/agent/state/VlanMap.h"
+
+namespace facebook { namespace fboss {
+
+StateMemoryUsage::StateMemoryUsage(
+    const std::shared_ptr<SwitchState>& state,
+    const std::shared_ptr<SwitchState>& other) {
+  if (other) {
+    collect(other.get());
+  }
+
+  // The per VRF and per VLAN subtrees go first, so that the maps holding
+  // them are only charged for themselves
+  for (const auto& table : *state->getRouteTables()) {
+    account(
+        folly::to<std::string>("routeTables.", table->getID()), table.get());
+  }
+  for (const auto& fib : *state->getFibs()) {
+    account(folly::to<std::string>("fibs.", fib->getID()), fib.get());
+  }
+  for (const auto& vlan : *state->getVlans()) {
+    auto prefix = folly::to<std::string>("vlans.", vlan->getID());
+    account(prefix + ".arp", vlan->getArpTable().get());
+    account(prefix + ".ndp", vlan->getNdpTable().get());
+    account(prefix, vlan.get());
+  }
+
+  account("ports", state->getPorts().get());
+  account("aggregatePorts", state->getAggregatePorts().get());
+  account("vlans", state->getVlans().get());
+  account("interfaces", state->getInterfaces().get());
+  account("routeTables", state->getRouteTables().get());
+  account("acls", state->getAcls().get());
+  account("sflowCollectors", state->getSflowCollectors().get());
+  account("qosPolicies", state->getQosPolicies().get());
+  account("controlPlane", state->getControlPlane().get());
+  account("loadBalancers", state->getLoadBalancers().get());
+  account("mirrors", state->getMirrors().get());
+  account("fibs", state->getFibs().get());
+  account("labelFib", state->getLabelForwardingInformationBase().get());
+  account("switchState", state.get());
+}
+
+void StateMemoryUsage::collect(const NodeBase* node) {
+  if (!other_.insert(node).second) {
+    return;
+  }
+  node->ownBytes([this](const void* storage, size_t /*bytes*/) {
+    return other_.insert(storage).second;
+  });
+  node->forEachChildNode([this](const NodeBase* child) { collect(child); });
+}
+
+void StateMemoryUsage::account(const std::string& name, const NodeBase* node) {
+  Usage usage;
+  account(node, &usage);
+  total_.bytes += usage.bytes;
+  total_.nodes += usage.nodes;
+  total_.sharedBytes += usage.sharedBytes;
+  total_.sharedNodes += usage.sharedNodes;
+  subtrees_.emplace_back(name, usage);
+}
+
+void StateMemoryUsage::account(const NodeBase* node, Usage* usage) {
+  if (!node || !seen_.insert(node).second) {
+    return;
+  }
+  auto bytes = node->ownBytes([this, usage](const void* storage, size_t n) {
+    if (!seen_.insert(storage).second) {
+      return false;
+    }
+    usage->bytes += n;
+    if (other_.count(storage)) {
+      usage->sharedBytes += n;
+    }
+    return true;
+  });
+  usage->bytes += bytes;
+  ++usage->nodes;
+  if (other_.count(node)) {
+    usage->sharedBytes += bytes;
+    ++usage->sharedNodes;
+  }
+  node->forEachChildNode(
+      [this, usage](const NodeBase* child) { account(child, usage); });
+}
+
+}} // facebook::fboss
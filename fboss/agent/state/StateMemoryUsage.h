@@ -0,0 +1,80 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace facebook { namespace fboss {
+
+class NodeBase;
+class SwitchState;
+
+/*
+ * StateMemoryUsage walks a SwitchState and reports the memory used by each
+ * part of it: the routes of each VRF, the neighbor tables of each VLAN, the
+ * ACLs, the ports and so on.
+ *
+ * Copy-on-write states share the nodes that did not change.  Given a second
+ * state, such as the applied state when accounting the desired one, the
+ * usage shared with it is reported alongside.  Within one state a node is
+ * counted once, under the first subtree that reaches it.
+ *
+ * Bytes are an estimate: the node objects, and the containers NodeMaps keep
+ * their children in, but not what the fields of a node allocate themselves.
+ * They are meant to catch regressions, not to add up to the process RSS.
+ */
+class StateMemoryUsage {
+ public:
+  struct Usage {
+    uint64_t bytes{0};
+    uint64_t nodes{0};
+    // The part of the above also in the other state
+    uint64_t sharedBytes{0};
+    uint64_t sharedNodes{0};
+  };
+
+  explicit StateMemoryUsage(
+      const std::shared_ptr<SwitchState>& state,
+      const std::shared_ptr<SwitchState>& other = nullptr);
+
+  /*
+   * Usage per subtree, named like "routeTables.0", "vlans.1.arp" or "acls".
+   */
+  const std::vector<std::pair<std::string, Usage>>& getSubtrees() const {
+    return subtrees_;
+  }
+
+  const Usage& getTotal() const {
+    return total_;
+  }
+
+ private:
+  // Forbidden copy constructor and assignment operator
+  StateMemoryUsage(StateMemoryUsage const &) = delete;
+  StateMemoryUsage& operator=(StateMemoryUsage const &) = delete;
+
+  void collect(const NodeBase* node);
+  void account(const std::string& name, const NodeBase* node);
+  void account(const NodeBase* node, Usage* usage);
+
+  // Nodes and shared storage of the other state
+  std::unordered_set<const void*> other_;
+  // Nodes and shared storage already counted
+  std::unordered_set<const void*> seen_;
+  std::vector<std::pair<std::string, Usage>> subtrees_;
+  Usage total_;
+};
+
+}} // facebook::fboss
@@ -9,6 +9,7 @@
  */
 #pragma once
 
+#include <chrono>
 #include <memory>
 
 #include <folly/IntrusiveList.h>
@@ -29,12 +30,48 @@ class SwitchState;
  * single update notification to the HwSwitch and other update subscribers.
  * Therefore the applyUpdate() may be called with an unpublished SwitchState in
  * some cases.
+ *
+ * Each update carries a Priority.  The update thread always works on the
+ * highest priority class that has pending updates, and only coalesces updates
+ * within a class, so failover critical updates are never queued behind bulk
+ * route programming.  Updates of the same class are applied in FIFO order.
  */
 class StateUpdate {
  public:
-  explicit StateUpdate(folly::StringPiece name, bool allowCoalesce = true)
+  /*
+   * Priority classes, highest first.  Updates that don't fall into one of the
+   * more specific classes should use CONFIG.
+   */
+  enum class Priority : uint8_t {
+    LINK,     // Port oper state and LACP forwarding changes
+    NEIGHBOR, // ARP/NDP entry changes and the mirror resolution they drive
+    ROUTE,    // Unicast and MPLS route programming
+    CONFIG,   // Config application and everything else
+  };
+  static constexpr size_t kNumPriorities =
+      static_cast<size_t>(Priority::CONFIG) + 1;
+
+  static const char* priorityName(Priority priority) {
+    switch (priority) {
+      case Priority::LINK:
+        return "link";
+      case Priority::NEIGHBOR:
+        return "neighbor";
+      case Priority::ROUTE:
+        return "route";
+      case Priority::CONFIG:
+        return "config";
+    }
+    return "unknown";
+  }
+
+  explicit StateUpdate(
+      folly::StringPiece name,
+      bool allowCoalesce = true,
+      Priority priority = Priority::CONFIG)
       : name_(name.str()),
-        allowCoalesce_(allowCoalesce) {}
+        allowCoalesce_(allowCoalesce),
+        priority_(priority) {}
   virtual ~StateUpdate() {}
 
   const std::string& getName() const {
@@ -45,6 +82,10 @@ class StateUpdate {
     return allowCoalesce_;
   }
 
+  Priority getPriority() const {
+    return priority_;
+  }
+
   /*
    * Apply the update, and return a new SwitchState.
    *
@@ -85,11 +126,15 @@ class StateUpdate {
 
   std::string name_;
   bool allowCoalesce_;
+  Priority priority_;
+
+  // When SwSwitch queued this update, for queueing latency stats.
+  std::chrono::steady_clock::time_point queuedAt_;
 
   // An intrusive list hook for maintaining the list of pending updates.
   folly::IntrusiveListHook listHook_;
-  // The SwSwitch code needs access to our listHook_ member so it can maintain
-  // the update list.
+  // The SwSwitch code needs access to our listHook_ and queuedAt_ members so
+  // it can maintain the update lists.
   friend class SwSwitch;
 };
 
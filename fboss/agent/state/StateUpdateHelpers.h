@@ -30,8 +30,9 @@ class FunctionStateUpdate : public StateUpdate {
     StateUpdateFn;
 
   FunctionStateUpdate(folly::StringPiece name, StateUpdateFn fn,
-                      bool allowCoalesce = true)
-    : StateUpdate(name, allowCoalesce),
+                      bool allowCoalesce = true,
+                      Priority priority = Priority::CONFIG)
+    : StateUpdate(name, allowCoalesce, priority),
       function_(fn) {}
 
   std::shared_ptr<SwitchState> applyUpdate(
@@ -102,8 +103,9 @@ class BlockingStateUpdate : public StateUpdate {
   BlockingStateUpdate(folly::StringPiece name,
                       StateUpdateFn fn,
                       std::shared_ptr<BlockingUpdateResult> result,
-                      bool allowCoalesce = true)
-    : StateUpdate(name, allowCoalesce),
+                      bool allowCoalesce = true,
+                      Priority priority = Priority::CONFIG)
+    : StateUpdate(name, allowCoalesce, priority),
       function_(fn),
       result_(result) {}
 
@@ -10,9 +10,11 @@
 #pragma once
 
 #include <chrono>
+#include <map>
 #include <memory>
 
 #include <folly/FBString.h>
+#include <folly/IPAddress.h>
 #include <folly/dynamic.h>
 #include <folly/Memory.h>
 
@@ -40,6 +42,25 @@ template <typename AddressT> class Route;
 class SflowCollector;
 class SflowCollectorMap;
 
+// The BFD timers of a next hop
+struct BfdPeer {
+  BfdPeer() {}
+  BfdPeer(std::chrono::milliseconds i, uint8_t m)
+      : interval(i), detectMultiplier(m) {}
+
+  bool operator==(const BfdPeer& rhs) const {
+    return interval == rhs.interval &&
+        detectMultiplier == rhs.detectMultiplier;
+  }
+  bool operator!=(const BfdPeer& rhs) const {
+    return !(*this == rhs);
+  }
+
+  std::chrono::milliseconds interval{0};
+  uint8_t detectMultiplier{0};
+};
+using BfdPeers = std::map<folly::IPAddress, BfdPeer>;
+
 struct SwitchStateFields {
   SwitchStateFields();
 
@@ -104,6 +125,8 @@ struct SwitchStateFields {
   // source IP of the DHCP reply pkt to the client host
   folly::IPAddressV4 dhcpV4ReplySrc;
   folly::IPAddressV6 dhcpV6ReplySrc;
+  // next hops checked with BFD
+  BfdPeers bfdPeers;
 };
 
 /*
@@ -293,6 +316,13 @@ class SwitchState : public NodeBaseT<SwitchState, SwitchStateFields> {
      writableFields()->dhcpV6ReplySrc = v6ReplySrc;
   }
 
+  const BfdPeers& getBfdPeers() const {
+    return getFields()->bfdPeers;
+  }
+  void setBfdPeers(BfdPeers bfdPeers) {
+    writableFields()->bfdPeers = std::move(bfdPeers);
+  }
+
   const std::shared_ptr<LoadBalancerMap>& getLoadBalancers() const;
   const std::shared_ptr<MirrorMap>& getMirrors() const;
   const std::shared_ptr<ForwardingInformationBaseMap>& getFibs() const;
@@ -0,0 +1,278 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/state/SwitchStateJson.h"
+
+#include "fboss/agent/FbossError.h"
+#include "fboss/agent/state/AclMap.h"
+#include "fboss/agent/state/ArpTable.h"
+#include "fboss/agent/state/ControlPlane.h"
+#include "fboss/agent/state/InterfaceMap.h"
+#include "fboss/agent/state/LabelForwardingInformationBase.h"
+#include "fboss/agent/state/LoadBalancerMap.h"
+#include "fboss/agent/state/MirrorMap.h"
+#include "fboss/agent/state/NdpTable.h"
+#include "fboss/agent/state/PortMap.h"
+#include "fboss/agent/state/QosPolicyMap.h"
+#include "fboss/agent/state/Route.h"
+#include "fboss/agent/state/RouteTable.h"
+#include "fboss/agent/state/RouteTableMap.h"
+#include "fboss/agent/state/RouteTableRib.h"
+#include "fboss/agent/state/SflowCollectorMap.h"
+#include "fboss/agent/state/SwitchState.h"
+#include "fboss/agent/state/Vlan.h"
+#include "fboss/agent/state/VlanMap.h"
+
+#include <folly/Conv.h>
+#include <folly/Range.h>
+
+#include <algorithm>
+#include <iterator>
+#include <string>
+
+namespace {
+// These must match the keys the nodes use in toFollyDynamic()
+constexpr auto kEntries = "entries";
+constexpr auto kTotal = "total";
+constexpr auto kInterfaces = "interfaces";
+constexpr auto kPorts = "ports";
+constexpr auto kVlans = "vlans";
+constexpr auto kRouteTables = "routeTables";
+constexpr auto kDefaultVlan = "defaultVlan";
+constexpr auto kAcls = "acls";
+constexpr auto kSflowCollectors = "sFlowCollectors";
+constexpr auto kControlPlane = "controlPlane";
+constexpr auto kQosPolicies = "qosPolicies";
+constexpr auto kLoadBalancers = "loadBalancers";
+constexpr auto kMirrors = "mirrors";
+constexpr auto kLabelForwardingInformationBase = "labelFib";
+constexpr auto kRibV4 = "ribV4";
+constexpr auto kRibV6 = "ribV6";
+constexpr auto kRoutes = "routes";
+constexpr auto kArpTable = "arpTable";
+constexpr auto kNdpTable = "ndpTable";
+} // namespace
+
+namespace facebook {
+namespace fboss {
+
+namespace {
+
+using Tokens = folly::Range<const std::string*>;
+
+struct Page {
+  size_t offset;
+  size_t limit;
+};
+
+size_t toIndex(const std::string& token, size_t size) {
+  auto index = folly::tryTo<size_t>(token);
+  if (!index.hasValue() || index.value() >= size) {
+    throw FbossError("JSON Pointer does not address proper object");
+  }
+  return index.value();
+}
+
+// Finishes resolving the pointer within JSON that has been serialized
+folly::dynamic resolveJson(
+    folly::dynamic json,
+    Tokens tokens,
+    const Page* page) {
+  const folly::dynamic* target = &json;
+  for (const auto& token : tokens) {
+    if (target->isObject()) {
+      target = target->get_ptr(token);
+    } else if (target->isArray()) {
+      target = &(*target)[toIndex(token, target->size())];
+    } else {
+      target = nullptr;
+    }
+    if (!target) {
+      throw FbossError("JSON Pointer does not address proper object");
+    }
+  }
+  if (!page) {
+    return *target;
+  }
+  if (!target->isArray()) {
+    throw FbossError("JSON Pointer does not address a list");
+  }
+  folly::dynamic entries = folly::dynamic::array;
+  auto begin = std::min(page->offset, target->size());
+  auto end = begin + std::min(page->limit, target->size() - begin);
+  for (auto i = begin; i < end; ++i) {
+    entries.push_back((*target)[i]);
+  }
+  return folly::dynamic::object(kEntries, std::move(entries))(
+      kTotal, target->size());
+}
+
+template <typename NodesT>
+folly::dynamic pageOf(const NodesT& nodes, const Page& page) {
+  folly::dynamic entries = folly::dynamic::array;
+  auto it = nodes.begin();
+  for (size_t i = 0; i < page.offset && it != nodes.end(); ++i) {
+    ++it;
+  }
+  for (size_t i = 0; i < page.limit && it != nodes.end(); ++i, ++it) {
+    entries.push_back((*it)->toFollyDynamic());
+  }
+  return folly::dynamic::object(kEntries, std::move(entries))(
+      kTotal, nodes.size());
+}
+
+struct LeafResolver {
+  template <typename NodeT>
+  folly::dynamic operator()(const NodeT& node, Tokens tokens, const Page* page)
+      const {
+    return resolveJson(node->toFollyDynamic(), tokens, page);
+  }
+};
+
+/*
+ * A node map serializes as {"entries": [...], "extraFields": ...}; walk into
+ * a single entry without serializing the others.
+ */
+template <typename MapT, typename NodeResolver>
+folly::dynamic resolveMap(
+    const MapT& map,
+    Tokens tokens,
+    const Page* page,
+    NodeResolver resolveNode) {
+  if (tokens.empty() || (tokens.size() == 1 && tokens[0] == kEntries)) {
+    if (page) {
+      return pageOf(map, *page);
+    }
+    auto json = map.toFollyDynamic();
+    return tokens.empty() ? json : json[kEntries];
+  }
+  if (tokens[0] == kEntries) {
+    auto it = map.begin();
+    std::advance(it, toIndex(tokens[1], map.size()));
+    return resolveNode(*it, tokens.subpiece(2), page);
+  }
+  return resolveJson(map.toFollyDynamic(), tokens, page);
+}
+
+// A RIB serializes as {"routes": [...]}
+template <typename RibT>
+folly::dynamic resolveRib(const RibT& rib, Tokens tokens, const Page* page) {
+  if (tokens.empty() || (tokens.size() == 1 && tokens[0] == kRoutes)) {
+    if (page) {
+      return pageOf(*rib.routes(), *page);
+    }
+    auto json = rib.toFollyDynamic();
+    return tokens.empty() ? json : json[kRoutes];
+  }
+  if (tokens[0] == kRoutes) {
+    auto it = rib.routes()->begin();
+    std::advance(it, toIndex(tokens[1], rib.size()));
+    return LeafResolver()(*it, tokens.subpiece(2), page);
+  }
+  return resolveJson(rib.toFollyDynamic(), tokens, page);
+}
+
+struct RouteTableResolver {
+  folly::dynamic operator()(
+      const std::shared_ptr<RouteTable>& table,
+      Tokens tokens,
+      const Page* page) const {
+    if (!tokens.empty() && tokens[0] == kRibV4) {
+      return resolveRib(*table->getRibV4(), tokens.subpiece(1), page);
+    }
+    if (!tokens.empty() && tokens[0] == kRibV6) {
+      return resolveRib(*table->getRibV6(), tokens.subpiece(1), page);
+    }
+    return resolveJson(table->toFollyDynamic(), tokens, page);
+  }
+};
+
+struct VlanResolver {
+  folly::dynamic operator()(
+      const std::shared_ptr<Vlan>& vlan,
+      Tokens tokens,
+      const Page* page) const {
+    if (!tokens.empty() && tokens[0] == kArpTable) {
+      return resolveMap(
+          *vlan->getArpTable(), tokens.subpiece(1), page, LeafResolver());
+    }
+    if (!tokens.empty() && tokens[0] == kNdpTable) {
+      return resolveMap(
+          *vlan->getNdpTable(), tokens.subpiece(1), page, LeafResolver());
+    }
+    return resolveJson(vlan->toFollyDynamic(), tokens, page);
+  }
+};
+
+folly::dynamic resolveState(
+    const SwitchState& state,
+    Tokens tokens,
+    const Page* page) {
+  if (tokens.empty()) {
+    return resolveJson(state.toFollyDynamic(), tokens, page);
+  }
+  const auto& field = tokens[0];
+  auto rest = tokens.subpiece(1);
+  if (field == kInterfaces) {
+    return resolveMap(*state.getInterfaces(), rest, page, LeafResolver());
+  } else if (field == kPorts) {
+    return resolveMap(*state.getPorts(), rest, page, LeafResolver());
+  } else if (field == kVlans) {
+    return resolveMap(*state.getVlans(), rest, page, VlanResolver());
+  } else if (field == kRouteTables) {
+    return resolveMap(
+        *state.getRouteTables(), rest, page, RouteTableResolver());
+  } else if (field == kAcls) {
+    return resolveMap(*state.getAcls(), rest, page, LeafResolver());
+  } else if (field == kSflowCollectors) {
+    return resolveMap(*state.getSflowCollectors(), rest, page, LeafResolver());
+  } else if (field == kQosPolicies) {
+    return resolveMap(*state.getQosPolicies(), rest, page, LeafResolver());
+  } else if (field == kLoadBalancers) {
+    return resolveMap(*state.getLoadBalancers(), rest, page, LeafResolver());
+  } else if (field == kMirrors) {
+    return resolveMap(*state.getMirrors(), rest, page, LeafResolver());
+  } else if (field == kLabelForwardingInformationBase) {
+    return resolveMap(
+        *state.getLabelForwardingInformationBase(),
+        rest,
+        page,
+        LeafResolver());
+  } else if (field == kControlPlane) {
+    return LeafResolver()(state.getControlPlane(), rest, page);
+  } else if (field == kDefaultVlan) {
+    return resolveJson(
+        static_cast<uint32_t>(state.getDefaultVlan()), rest, page);
+  }
+  throw FbossError("JSON Pointer does not address proper object");
+}
+
+} // namespace
+
+folly::dynamic switchStateToFollyDynamic(
+    const SwitchState& state,
+    const folly::json_pointer& ptr) {
+  const auto& tokens = ptr.tokens();
+  return resolveState(
+      state, Tokens(tokens.data(), tokens.data() + tokens.size()), nullptr);
+}
+
+folly::dynamic switchStateEntriesToFollyDynamic(
+    const SwitchState& state,
+    const folly::json_pointer& ptr,
+    size_t offset,
+    size_t limit) {
+  const auto& tokens = ptr.tokens();
+  Page page{offset, limit};
+  return resolveState(
+      state, Tokens(tokens.data(), tokens.data() + tokens.size()), &page);
+}
+
+} // namespace fboss
+} // namespace facebook
@@ -0,0 +1,48 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include <folly/dynamic.h>
+#include <folly/json_pointer.h>
+
+#include <cstddef>
+
+namespace facebook {
+namespace fboss {
+
+class SwitchState;
+
+/*
+ * The part of SwitchState::toFollyDynamic() that a JSON pointer addresses,
+ * without serializing the rest of the state.
+ *
+ * The pointer is resolved against the node tree first: node maps, route
+ * tables, RIBs and VLAN neighbor tables are walked node by node, so only the
+ * node the pointer ends up in is serialized.  Throws FbossError if the
+ * pointer doesn't address anything in the state.
+ */
+folly::dynamic switchStateToFollyDynamic(
+    const SwitchState& state,
+    const folly::json_pointer& ptr);
+
+/*
+ * Like switchStateToFollyDynamic(), for a pointer that addresses a list of
+ * nodes, e.g. "/routeTables/entries/0/ribV6" or "/vlans/entries/0/ndpTable".
+ * Only the entries in [offset, offset + limit) are serialized, and returned
+ * as {"entries": [...], "total": <number of entries in the list>}.
+ */
+folly::dynamic switchStateEntriesToFollyDynamic(
+    const SwitchState& state,
+    const folly::json_pointer& ptr,
+    size_t offset,
+    size_t limit);
+
+} // namespace fboss
+} // namespace facebook
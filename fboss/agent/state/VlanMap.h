@@ -17,7 +17,9 @@ namespace facebook { namespace fboss {
 
 class SwitchState;
 class Vlan;
-typedef NodeMapTraits<VlanID, Vlan> VlanMapTraits;
+struct VlanMapTraits : public NodeMapTraits<VlanID, Vlan> {
+  using NodeContainer = DenseIdMap<VlanID, std::shared_ptr<Vlan>>;
+};
 
 /*
  * A container for the set of VLANs.
@@ -13,6 +13,9 @@
 #include "fboss/agent/hw/mock/MockPlatform.h"
 #include "fboss/agent/state/AclMap.h"
 #include "fboss/agent/state/AclEntry.h"
+#include "fboss/agent/state/MatchAction.h"
+#include "fboss/agent/state/Mirror.h"
+#include "fboss/agent/state/MirrorMap.h"
 #include "fboss/agent/state/Port.h"
 #include "fboss/agent/state/SwitchState.h"
 
@@ -726,3 +729,30 @@ TEST(Acl, TrafficCounterCompatibility) {
   EXPECT_EQ(aclAction.getTrafficCounter()->types.size(), 1);
   EXPECT_EQ(aclAction.getTrafficCounter()->types[0], cfg::CounterType::PACKETS);
 }
+
+TEST(Acl, DataplaneCaptureEntriesKept) {
+  auto platform = createMockPlatform();
+  auto stateV0 = make_shared<SwitchState>();
+  stateV0->addAcl(make_shared<AclEntry>(0, "acl0"));
+  auto captureAcl = make_shared<AclEntry>(1000000, "pktcapture.cap0");
+  MatchAction action;
+  action.setIngressMirror("pktcapture.cap0");
+  captureAcl->setAclAction(action);
+  stateV0->addAcl(captureAcl);
+  auto mirrors = make_shared<MirrorMap>();
+  mirrors->addMirror(
+      make_shared<Mirror>("pktcapture.cap0", PortID(0), folly::none));
+  stateV0->resetMirrors(mirrors);
+
+  // Config never has the capture's ACL or mirror, but leaves them in place
+  cfg::SwitchConfig config;
+  config.acls.resize(1);
+  config.acls[0].name = "acl1";
+  config.acls[0].actionType = cfg::AclActionType::DENY;
+  auto stateV1 = publishAndApplyConfig(stateV0, &config, platform.get());
+  ASSERT_NE(nullptr, stateV1);
+  EXPECT_EQ(nullptr, stateV1->getAcl("acl0"));
+  EXPECT_NE(nullptr, stateV1->getAcl("acl1"));
+  EXPECT_EQ(captureAcl, stateV1->getAcl("pktcapture.cap0"));
+  EXPECT_NE(nullptr, stateV1->getMirrors()->getMirrorIf("pktcapture.cap0"));
+}
@@ -0,0 +1,155 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/state/DenseIdMap.h"
+#include "fboss/agent/state/NodeMap.h"
+
+#include <folly/Random.h>
+#include <gtest/gtest.h>
+
+#include <map>
+#include <memory>
+#include <vector>
+
+using namespace facebook::fboss;
+
+namespace {
+using TestMap = DenseIdMap<uint16_t, std::shared_ptr<int>>;
+using RefMap = std::map<uint16_t, std::shared_ptr<int>>;
+
+void expectEqual(const RefMap& expected, const TestMap& actual) {
+  ASSERT_EQ(expected.size(), actual.size());
+  EXPECT_EQ(expected.empty(), actual.empty());
+  auto it = actual.begin();
+  for (const auto& entry : expected) {
+    ASSERT_TRUE(it != actual.end());
+    EXPECT_EQ(entry.first, it->first);
+    EXPECT_EQ(entry.second, it->second);
+    ++it;
+  }
+  EXPECT_TRUE(it == actual.end());
+
+  auto rit = actual.rbegin();
+  for (auto ref = expected.rbegin(); ref != expected.rend(); ++ref, ++rit) {
+    ASSERT_TRUE(rit != actual.rend());
+    EXPECT_EQ(ref->first, rit->first);
+  }
+  EXPECT_TRUE(rit == actual.rend());
+}
+
+// The keys whose values differ between the two maps, found with
+// NodeContainerOps::skipUnchanged() the way NodeMapDelta does.
+std::vector<uint16_t> changedKeys(const TestMap& oldMap, const TestMap& newMap) {
+  std::vector<uint16_t> changed;
+  auto oldIt = oldMap.begin();
+  auto newIt = newMap.begin();
+  while (true) {
+    NodeContainerOps<TestMap>::skipUnchanged(oldMap, oldIt, newMap, newIt);
+    if (oldIt == oldMap.end() && newIt == newMap.end()) {
+      break;
+    }
+    if (newIt == newMap.end() ||
+        (oldIt != oldMap.end() && oldIt->first < newIt->first)) {
+      changed.push_back(oldIt->first);
+      ++oldIt;
+    } else if (oldIt == oldMap.end() || newIt->first < oldIt->first) {
+      changed.push_back(newIt->first);
+      ++newIt;
+    } else {
+      changed.push_back(oldIt->first);
+      ++oldIt;
+      ++newIt;
+    }
+  }
+  return changed;
+}
+} // namespace
+
+TEST(DenseIdMap, CompareWithStdMap) {
+  RefMap expected;
+  TestMap actual;
+  // Spans several bitmap words, with long runs of absent keys
+  auto const kKeySpace = 500;
+  for (auto i = 0; i < 5000; ++i) {
+    uint16_t key = folly::Random::rand32(kKeySpace);
+    auto op = folly::Random::rand32(3);
+    if (op == 0) {
+      auto value = std::make_shared<int>(i);
+      auto inserted = expected.insert(std::make_pair(key, value)).second;
+      auto ret = actual.insert(std::make_pair(key, value));
+      ASSERT_EQ(inserted, ret.second);
+      EXPECT_EQ(key, ret.first->first);
+      EXPECT_EQ(expected[key], ret.first->second);
+    } else if (op == 1) {
+      ASSERT_EQ(expected.erase(key), actual.erase(key));
+    } else {
+      auto value = std::make_shared<int>(i);
+      auto it = actual.find(key);
+      ASSERT_EQ(expected.count(key), it == actual.end() ? 0 : 1);
+      ASSERT_EQ(expected.count(key), actual.count(key));
+      if (it != actual.end()) {
+        it->second = value;
+        expected[key] = value;
+      }
+    }
+    auto lower = actual.lower_bound(key);
+    auto refLower = expected.lower_bound(key);
+    ASSERT_EQ(refLower == expected.end(), lower == actual.end());
+    if (lower != actual.end()) {
+      EXPECT_EQ(refLower->first, lower->first);
+    }
+    auto upper = actual.upper_bound(key);
+    auto refUpper = expected.upper_bound(key);
+    ASSERT_EQ(refUpper == expected.end(), upper == actual.end());
+    if (upper != actual.end()) {
+      EXPECT_EQ(refUpper->first, upper->first);
+    }
+  }
+  expectEqual(expected, actual);
+
+  while (!actual.empty()) {
+    auto next = actual.erase(actual.begin());
+    expected.erase(expected.begin());
+    EXPECT_TRUE(next == actual.begin());
+  }
+  expectEqual(expected, actual);
+}
+
+TEST(DenseIdMap, ErasedEntriesReleaseValues) {
+  TestMap map;
+  auto value = std::make_shared<int>(1);
+  std::weak_ptr<int> weak = value;
+  map.emplace(std::make_pair(uint16_t(4000), std::move(value)));
+  EXPECT_EQ(1, map.size());
+  EXPECT_EQ(4000, map.begin()->first);
+  EXPECT_EQ(4000, map.rbegin()->first);
+
+  map.erase(4000);
+  EXPECT_TRUE(weak.expired());
+  EXPECT_TRUE(map.empty());
+  EXPECT_TRUE(map.begin() == map.end());
+  EXPECT_TRUE(map.find(4000) == map.end());
+}
+
+TEST(DenseIdMap, SkipUnchanged) {
+  TestMap orig;
+  for (uint16_t i = 0; i < 300; i += 3) {
+    orig.insert(std::make_pair(i, std::make_shared<int>(i)));
+  }
+
+  auto copy = orig;
+  copy.erase(3);
+  copy.find(150)->second = std::make_shared<int>(-1);
+  copy.insert(std::make_pair(uint16_t(1000), std::make_shared<int>(1000)));
+
+  EXPECT_EQ((std::vector<uint16_t>{3, 150, 1000}), changedKeys(orig, copy));
+  EXPECT_EQ((std::vector<uint16_t>{3, 150, 1000}), changedKeys(copy, orig));
+  EXPECT_TRUE(changedKeys(orig, orig).empty());
+  EXPECT_EQ(100, changedKeys(TestMap(), orig).size());
+}
@@ -18,6 +18,7 @@
 #include <gtest/gtest.h>
 #include <array>
 #include <memory>
+#include <vector>
 
 namespace {
 
@@ -190,6 +191,48 @@ TEST_F(ForwardingInformationBaseV6Test, DecreasingLPMSequence) {
   }
 }
 
+TEST_F(ForwardingInformationBaseV4Test, BatchLPMMatchesSingleLPM) {
+  // Includes an address with no match and a duplicate
+  std::vector<folly::IPAddressV4> addresses{
+      folly::IPAddressV4("161.16.8.1"),
+      folly::IPAddressV4("0.0.0.0"),
+      folly::IPAddressV4("192.0.0.0"),
+      folly::IPAddressV4("64.1.0.1"),
+      folly::IPAddressV4("72.1.2.3"),
+      folly::IPAddressV4("0.0.0.0"),
+      folly::IPAddressV4("52.0.0.1")};
+
+  auto matches = fib.longestMatchBatch(folly::range(addresses));
+  ASSERT_EQ(addresses.size(), matches.size());
+  for (size_t i = 0; i < addresses.size(); ++i) {
+    EXPECT_EQ(fib.longestMatch(addresses[i]), matches[i]);
+  }
+  EXPECT_EQ(nullptr, matches[2]);
+  CHECK_LPM(matches[4], ip4_72, 6);
+
+  EXPECT_TRUE(
+      fib.longestMatchBatch(folly::Range<const folly::IPAddressV4*>())
+          .empty());
+}
+
+TEST_F(ForwardingInformationBaseV6Test, BatchLPMMatchesSingleLPM) {
+  std::vector<folly::IPAddressV6> addresses;
+  folly::IPAddressV6 address("FFFF:FFFF:FFFF:FFFF:FFFF:FFFF:FFFF:FFFF");
+  for (uint16_t mask = 0; mask <= address.bitCount(); mask += 8) {
+    addresses.push_back(address.mask(mask));
+  }
+  addresses.push_back(folly::IPAddressV6("A110:801::"));
+  addresses.push_back(folly::IPAddressV6("4001:1::"));
+
+  auto matches = fib.longestMatchBatch(folly::range(addresses));
+  ASSERT_EQ(addresses.size(), matches.size());
+  for (size_t i = 0; i < addresses.size(); ++i) {
+    EXPECT_EQ(fib.longestMatch(addresses[i]), matches[i]);
+  }
+  CHECK_LPM(matches[addresses.size() - 2], ip6_160, 3);
+  CHECK_LPM(matches[addresses.size() - 1], ip6_64, 3);
+}
+
 TEST(ForwardingInformationBaseV4, IPv4DefaultPrefixComparesSmallest) {
   ForwardingInformationBaseV4 oldFib;
   ForwardingInformationBaseV4 newFib;
@@ -88,6 +88,63 @@ TEST(Interface, addrToReach) {
   EXPECT_EQ(0, ret.mask);
 }
 
+TEST(InterfaceMap, lookupByAddressAndVlan) {
+  auto platform = createMockPlatform();
+  cfg::SwitchConfig config;
+  config.vlans.resize(2);
+  config.vlans[0].id = 1;
+  config.vlans[1].id = 2;
+  config.interfaces.resize(3);
+  for (int i = 0; i < 3; ++i) {
+    auto* intfConfig = &config.interfaces[i];
+    intfConfig->intfID = i + 1;
+    // Interfaces 2 and 3 share vlan 2
+    intfConfig->vlanID = i == 0 ? 1 : 2;
+    intfConfig->routerID = i == 2 ? 1 : 0;
+    intfConfig->mac_ref().value_unchecked() = "00:02:00:11:22:33";
+    intfConfig->__isset.mac = true;
+    intfConfig->ipAddresses.resize(2);
+    intfConfig->ipAddresses[0] = folly::to<std::string>("10.1.", i, ".1/24");
+    // The same address in both VRFs
+    intfConfig->ipAddresses[1] = i == 0 ? "::1/64" : "2::1/64";
+  }
+
+  auto state =
+      publishAndApplyConfig(make_shared<SwitchState>(), &config, platform.get());
+  ASSERT_NE(nullptr, state);
+
+  auto check = [](const shared_ptr<InterfaceMap>& intfs) {
+    EXPECT_EQ(
+        InterfaceID(1),
+        intfs->getInterfaceIf(RouterID(0), IPAddress("10.1.0.1"))->getID());
+    EXPECT_EQ(
+        InterfaceID(2),
+        intfs->getInterface(RouterID(0), IPAddress("2::1"))->getID());
+    EXPECT_EQ(
+        InterfaceID(3),
+        intfs->getInterfaceIf(RouterID(1), IPAddress("2::1"))->getID());
+    EXPECT_EQ(nullptr, intfs->getInterfaceIf(RouterID(1), IPAddress("::1")));
+    EXPECT_EQ(nullptr, intfs->getInterfaceIf(RouterID(2), IPAddress("::1")));
+    EXPECT_THROW(
+        intfs->getInterface(RouterID(0), IPAddress("10.1.0.2")), FbossError);
+    EXPECT_EQ(InterfaceID(2), intfs->getInterfaceInVlanIf(VlanID(2))->getID());
+    EXPECT_EQ(nullptr, intfs->getInterfaceInVlanIf(VlanID(3)));
+  };
+
+  // Walking the unpublished map and using the published indexes agree
+  check(state->getInterfaces());
+  state->publish();
+  check(state->getInterfaces());
+
+  // A clone does not use its original's indexes once it changes
+  auto intfs = state->getInterfaces()->clone();
+  intfs->removeNode(InterfaceID(1));
+  EXPECT_EQ(nullptr, intfs->getInterfaceIf(RouterID(0), IPAddress("10.1.0.1")));
+  intfs->publish();
+  EXPECT_EQ(nullptr, intfs->getInterfaceIf(RouterID(0), IPAddress("10.1.0.1")));
+  EXPECT_EQ(nullptr, intfs->getInterfaceInVlanIf(VlanID(1)));
+}
+
 TEST(Interface, applyConfig) {
   auto platform = createMockPlatform();
   cfg::SwitchConfig config;
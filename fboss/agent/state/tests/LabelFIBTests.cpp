@@ -372,6 +372,56 @@ TEST(LabelFIBTests, purgeEntriesForClient) {
   EXPECT_EQ(*entryAdded5003, *entry5003);
 }
 
+TEST(LabelFIBTests, programSameLabelLeavesEntry) {
+  auto stateA = testStateA();
+  auto entryToAdd = std::make_shared<LabelForwardingEntry>(
+      5001,
+      StdClientIds2ClientID(StdClientIds::OPENR),
+      util::getPushLabelNextHopEntry(AdminDistance::DIRECTLY_CONNECTED));
+  addOrUpdateEntryWithProgramLabel(
+      &stateA, StdClientIds2ClientID(StdClientIds::OPENR), entryToAdd.get());
+  stateA->publish();
+
+  auto stateB = stateA;
+  addOrUpdateEntryWithProgramLabel(
+      &stateB, StdClientIds2ClientID(StdClientIds::OPENR), entryToAdd.get());
+  EXPECT_EQ(
+      stateA->getLabelForwardingInformationBase(),
+      stateB->getLabelForwardingInformationBase());
+}
+
+TEST(LabelFIBTests, purgeEntriesForClientKeep) {
+  auto stateA = testStateA();
+  for (auto label : {5001, 5002}) {
+    auto entryToAdd = std::make_shared<LabelForwardingEntry>(
+        label,
+        StdClientIds2ClientID(StdClientIds::OPENR),
+        util::getPushLabelNextHopEntry(AdminDistance::DIRECTLY_CONNECTED));
+    addOrUpdateEntryWithProgramLabel(
+        &stateA, StdClientIds2ClientID(StdClientIds::OPENR), entryToAdd.get());
+  }
+  stateA->publish();
+  auto entry5001 =
+      stateA->getLabelForwardingInformationBase()->getLabelForwardingEntry(
+          5001);
+
+  auto stateB = stateA;
+  SwitchState::modify(&stateB);
+  stateB->getLabelForwardingInformationBase()->purgeEntriesForClient(
+      &stateB, StdClientIds2ClientID(StdClientIds::OPENR), {5001});
+  stateB->publish();
+
+  // The kept entry is the same node, so it is not part of the delta
+  EXPECT_EQ(
+      entry5001,
+      stateB->getLabelForwardingInformationBase()->getLabelForwardingEntry(
+          5001));
+  EXPECT_EQ(
+      nullptr,
+      stateB->getLabelForwardingInformationBase()->getLabelForwardingEntryIf(
+          5002));
+}
+
 TEST(LabelFIBTests, oneLabelManyClients) {
   auto stateA = testStateA();
   // 1) open r adds 5001 (directly connected), and bgp adds 5002 (static route)
@@ -208,6 +208,62 @@ TEST(LoadBalancer, deserializationInverseOfSerlization) {
           origTransportSrcAndDst.begin(), origTransportSrcAndDst.end()));
 }
 
+TEST(LoadBalancer, resilientFlowsetSize) {
+  auto platform = createMockPlatform();
+  auto baseState = std::make_shared<SwitchState>();
+
+  cfg::SwitchConfig baseConfig;
+  baseConfig.loadBalancers = defaultLoadBalancers();
+  auto startState =
+      publishAndApplyConfig(baseState, &baseConfig, platform.get());
+  ASSERT_NE(nullptr, startState);
+  auto startEcmpLoadBalancer =
+      startState->getLoadBalancers()->getLoadBalancerIf(LoadBalancerID::ECMP);
+  ASSERT_NE(nullptr, startEcmpLoadBalancer);
+  EXPECT_EQ(0, startEcmpLoadBalancer->getResilientFlowsetSize());
+
+  cfg::SwitchConfig config;
+  config.loadBalancers = defaultLoadBalancers();
+  config.loadBalancers[0].set_resilientFlowsetSize(256);
+  auto endState = publishAndApplyConfig(startState, &config, platform.get());
+  ASSERT_NE(nullptr, endState);
+  auto endEcmpLoadBalancer =
+      endState->getLoadBalancers()->getLoadBalancerIf(LoadBalancerID::ECMP);
+  ASSERT_NE(nullptr, endEcmpLoadBalancer);
+  EXPECT_EQ(256, endEcmpLoadBalancer->getResilientFlowsetSize());
+  EXPECT_NE(*startEcmpLoadBalancer, *endEcmpLoadBalancer);
+
+  auto deserialized =
+      LoadBalancer::fromFollyDynamic(endEcmpLoadBalancer->toFollyDynamic());
+  EXPECT_EQ(*endEcmpLoadBalancer, *deserialized);
+
+  // States written without the field use regular hashing
+  auto serialized = startEcmpLoadBalancer->toFollyDynamic();
+  serialized.erase("resilientFlowsetSize");
+  EXPECT_EQ(
+      0,
+      LoadBalancer::fromFollyDynamic(serialized)->getResilientFlowsetSize());
+}
+
+TEST(LoadBalancer, resilientFlowsetSizeInvalid) {
+  auto platform = createMockPlatform();
+  auto initialState = std::make_shared<SwitchState>();
+
+  cfg::SwitchConfig lagConfig;
+  lagConfig.loadBalancers = defaultLoadBalancers();
+  lagConfig.loadBalancers[1].set_resilientFlowsetSize(256);
+  EXPECT_THROW(
+      publishAndApplyConfig(initialState, &lagConfig, platform.get()),
+      FbossError);
+
+  cfg::SwitchConfig zeroConfig;
+  zeroConfig.loadBalancers = defaultLoadBalancers();
+  zeroConfig.loadBalancers[0].set_resilientFlowsetSize(0);
+  EXPECT_THROW(
+      publishAndApplyConfig(initialState, &zeroConfig, platform.get()),
+      FbossError);
+}
+
 namespace {
 
 void checkLoadBalancersDelta(
@@ -0,0 +1,100 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/state/NodeMapDelta.h"
+#include "fboss/agent/state/Port.h"
+#include "fboss/agent/state/PortMap.h"
+
+#include <folly/Benchmark.h>
+#include <folly/init/Init.h>
+
+#include <memory>
+#include <string>
+
+using facebook::fboss::NodeMapDelta;
+using facebook::fboss::PortID;
+using facebook::fboss::PortMap;
+
+namespace {
+
+// Number of ports changed by each update
+constexpr auto kChangedPorts = 4;
+
+std::shared_ptr<PortMap> makePorts(size_t numPorts) {
+  auto ports = std::make_shared<PortMap>();
+  for (size_t i = 0; i < numPorts; ++i) {
+    ports->registerPort(PortID(i), "port" + std::to_string(i));
+  }
+  ports->publish();
+  return ports;
+}
+
+/*
+ * Clone oldPorts and update a few ports spread over the map.  If trackChanges
+ * is false the clone is modified through writableNodes(), so the delta has to
+ * walk both maps in full.
+ */
+std::shared_ptr<PortMap> updatePorts(
+    const std::shared_ptr<PortMap>& oldPorts,
+    bool trackChanges) {
+  auto newPorts = oldPorts->clone();
+  for (auto i = 0; i < kChangedPorts; ++i) {
+    auto id = PortID(i * oldPorts->size() / kChangedPorts);
+    auto port = oldPorts->getPort(id)->clone();
+    port->setName("changed");
+    if (trackChanges) {
+      newPorts->updatePort(port);
+    } else {
+      newPorts->writableNodes().find(id)->second = port;
+    }
+  }
+  newPorts->publish();
+  return newPorts;
+}
+
+void deltaIteration(size_t iters, size_t numPorts, bool trackChanges) {
+  std::shared_ptr<PortMap> oldPorts;
+  std::shared_ptr<PortMap> newPorts;
+  BENCHMARK_SUSPEND {
+    oldPorts = makePorts(numPorts);
+    newPorts = updatePorts(oldPorts, trackChanges);
+  }
+  size_t changed = 0;
+  for (size_t i = 0; i < iters; ++i) {
+    NodeMapDelta<PortMap> delta(oldPorts.get(), newPorts.get());
+    for (const auto& entry : delta) {
+      folly::doNotOptimizeAway(entry.getNew());
+      ++changed;
+    }
+  }
+  CHECK_EQ(iters * kChangedPorts, changed);
+}
+
+void fullDelta(size_t iters, size_t numPorts) {
+  deltaIteration(iters, numPorts, false);
+}
+
+void trackedDelta(size_t iters, size_t numPorts) {
+  deltaIteration(iters, numPorts, true);
+}
+
+} // namespace
+
+BENCHMARK_PARAM(fullDelta, 64)
+BENCHMARK_RELATIVE_PARAM(trackedDelta, 64)
+BENCHMARK_PARAM(fullDelta, 1024)
+BENCHMARK_RELATIVE_PARAM(trackedDelta, 1024)
+BENCHMARK_PARAM(fullDelta, 16384)
+BENCHMARK_RELATIVE_PARAM(trackedDelta, 16384)
+
+int main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  folly::runBenchmarks();
+  return 0;
+}
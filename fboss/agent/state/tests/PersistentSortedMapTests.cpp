@@ -0,0 +1,167 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/state/NodeMap.h"
+#include "fboss/agent/state/PersistentSortedMap.h"
+
+#include <folly/Random.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <vector>
+
+using namespace facebook::fboss;
+
+namespace {
+// Small nodes so that the tests build deep trees
+using TestMap = PersistentSortedMap<int, std::shared_ptr<int>, 4>;
+using RefMap = std::map<int, std::shared_ptr<int>>;
+
+void expectEqual(const RefMap& expected, const TestMap& actual) {
+  ASSERT_EQ(expected.size(), actual.size());
+  EXPECT_EQ(expected.empty(), actual.empty());
+  auto it = actual.begin();
+  for (const auto& entry : expected) {
+    ASSERT_TRUE(it != actual.end());
+    EXPECT_EQ(entry.first, it->first);
+    EXPECT_EQ(entry.second, it->second);
+    ++it;
+  }
+  EXPECT_TRUE(it == actual.end());
+
+  auto rit = actual.rbegin();
+  for (auto ref = expected.rbegin(); ref != expected.rend(); ++ref, ++rit) {
+    ASSERT_TRUE(rit != actual.rend());
+    EXPECT_EQ(ref->first, rit->first);
+  }
+  EXPECT_TRUE(rit == actual.rend());
+}
+
+// The keys whose values differ between the two maps, found with
+// NodeContainerOps::skipUnchanged() the way NodeMapDelta does.
+std::vector<int> changedKeys(const TestMap& oldMap, const TestMap& newMap) {
+  std::vector<int> changed;
+  auto oldIt = oldMap.begin();
+  auto newIt = newMap.begin();
+  while (true) {
+    NodeContainerOps<TestMap>::skipUnchanged(oldMap, oldIt, newMap, newIt);
+    if (oldIt == oldMap.end() && newIt == newMap.end()) {
+      break;
+    }
+    if (newIt == newMap.end() ||
+        (oldIt != oldMap.end() && oldIt->first < newIt->first)) {
+      changed.push_back(oldIt->first);
+      ++oldIt;
+    } else if (oldIt == oldMap.end() || newIt->first < oldIt->first) {
+      changed.push_back(newIt->first);
+      ++newIt;
+    } else {
+      changed.push_back(oldIt->first);
+      ++oldIt;
+      ++newIt;
+    }
+  }
+  return changed;
+}
+} // namespace
+
+TEST(PersistentSortedMap, CompareWithStdMap) {
+  RefMap expected;
+  TestMap actual;
+  auto const kKeySpace = 500;
+  for (auto i = 0; i < 5000; ++i) {
+    int key = folly::Random::rand32(kKeySpace);
+    auto op = folly::Random::rand32(3);
+    if (op == 0) {
+      auto value = std::make_shared<int>(i);
+      auto inserted = expected.insert(std::make_pair(key, value)).second;
+      auto ret = actual.insert(std::make_pair(key, value));
+      ASSERT_EQ(inserted, ret.second);
+      EXPECT_EQ(key, ret.first->first);
+      EXPECT_EQ(expected[key], ret.first->second);
+    } else if (op == 1) {
+      ASSERT_EQ(expected.erase(key), actual.erase(key));
+    } else {
+      auto value = std::make_shared<int>(i);
+      auto it = actual.find(key);
+      ASSERT_EQ(expected.count(key), it == actual.end() ? 0 : 1);
+      if (it != actual.end()) {
+        it->second = value;
+        expected[key] = value;
+      }
+    }
+    auto lower = actual.lower_bound(key);
+    auto refLower = expected.lower_bound(key);
+    ASSERT_EQ(refLower == expected.end(), lower == actual.end());
+    if (lower != actual.end()) {
+      EXPECT_EQ(refLower->first, lower->first);
+    }
+  }
+  expectEqual(expected, actual);
+
+  while (!actual.empty()) {
+    auto next = actual.erase(actual.begin());
+    expected.erase(expected.begin());
+    EXPECT_TRUE(next == actual.begin());
+  }
+  expectEqual(expected, actual);
+}
+
+TEST(PersistentSortedMap, CopiesShareNodes) {
+  TestMap orig;
+  RefMap origRef;
+  for (auto i = 0; i < 1000; ++i) {
+    auto value = std::make_shared<int>(i);
+    orig.insert(std::make_pair(i, value));
+    origRef.emplace(i, value);
+  }
+
+  // Changing a copy leaves the original alone
+  auto copy = orig;
+  auto copyRef = origRef;
+  copy.erase(10);
+  copyRef.erase(10);
+  auto value = std::make_shared<int>(-1);
+  copy.find(500)->second = value;
+  copyRef[500] = value;
+  copy.insert(std::make_pair(2000, value));
+  copyRef.emplace(2000, value);
+  expectEqual(origRef, orig);
+  expectEqual(copyRef, copy);
+
+  EXPECT_EQ((std::vector<int>{10, 500, 2000}), changedKeys(orig, copy));
+  EXPECT_EQ((std::vector<int>{10, 500, 2000}), changedKeys(copy, orig));
+  EXPECT_TRUE(changedKeys(orig, orig).empty());
+  EXPECT_EQ(1000, changedKeys(TestMap(), orig).size());
+}
+
+TEST(PersistentSortedMap, PublishValuesSkipsSharedSubtrees) {
+  TestMap orig;
+  for (auto i = 0; i < 1000; ++i) {
+    orig.insert(std::make_pair(i, std::make_shared<int>(i)));
+  }
+  auto visited = 0;
+  orig.publishValues([&](const std::shared_ptr<int>&) { ++visited; });
+  EXPECT_EQ(1000, visited);
+
+  visited = 0;
+  orig.publishValues([&](const std::shared_ptr<int>&) { ++visited; });
+  EXPECT_EQ(0, visited);
+
+  // Only the leaf that changed in the copy is visited
+  auto copy = orig;
+  copy.find(1)->second = std::make_shared<int>(-1);
+  std::vector<int> values;
+  copy.publishValues(
+      [&](const std::shared_ptr<int>& node) { values.push_back(*node); });
+  EXPECT_GE(4, values.size());
+  EXPECT_NE(values.end(), std::find(values.begin(), values.end(), -1));
+}
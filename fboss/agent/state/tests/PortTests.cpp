@@ -12,6 +12,8 @@
 #include "fboss/agent/test/TestUtils.h"
 #include "fboss/agent/hw/mock/MockPlatform.h"
 #include "fboss/agent/state/DeltaFunctions.h"
+#include "fboss/agent/state/Interface.h"
+#include "fboss/agent/state/InterfaceMap.h"
 #include "fboss/agent/state/NodeMapDelta.h"
 #include "fboss/agent/state/Port.h"
 #include "fboss/agent/state/PortQueue.h"
@@ -19,8 +21,11 @@
 #include "fboss/agent/state/StateDelta.h"
 #include "fboss/agent/state/SwitchState.h"
 
+#include <gflags/gflags.h>
 #include <gtest/gtest.h>
 
+DECLARE_int32(config_apply_threads);
+
 using namespace facebook::fboss;
 using std::make_pair;
 using std::make_shared;
@@ -120,6 +125,104 @@ TEST(Port, applyConfig) {
     publishAndApplyConfig(stateV3, &config, platform.get()), FbossError);
 }
 
+TEST(Port, applyConfigSkipsUnchangedPorts) {
+  auto platform = createMockPlatform();
+  auto stateV0 = make_shared<SwitchState>();
+  stateV0->registerPort(PortID(1), "port1");
+
+  cfg::SwitchConfig config;
+  config.ports.resize(1);
+  config.ports[0].logicalID = 1;
+  config.ports[0].name_ref().value_unchecked() = "port1";
+  config.ports[0].state = cfg::PortState::ENABLED;
+  config.vlans.resize(1);
+  config.vlans[0].id = 2;
+  config.vlanPorts.resize(1);
+  config.vlanPorts[0].logicalPort = 1;
+  config.vlanPorts[0].vlanID = 2;
+  config.interfaces.resize(1);
+  config.interfaces[0].intfID = 2;
+  config.interfaces[0].vlanID = 2;
+  config.interfaces[0].__isset.mac = true;
+  config.interfaces[0].mac_ref().value_unchecked() = "00:00:00:00:00:22";
+
+  auto stateV1 = publishAndApplyConfig(stateV0, &config, platform.get());
+  ASSERT_NE(nullptr, stateV1);
+
+  // Disable the port outside of the config
+  stateV1->publish();
+  auto stateV2 = stateV1->clone();
+  auto portV2 = stateV2->getPort(PortID(1))->modify(&stateV2);
+  portV2->setAdminState(cfg::PortState::DISABLED);
+
+  // The port section is the same as in the previous config, so it is not
+  // re-derived and the port stays disabled
+  auto newConfig = config;
+  newConfig.interfaces[0].__isset.mtu = true;
+  newConfig.interfaces[0].mtu_ref().value_unchecked() = 9000;
+  auto stateV3 = publishAndApplyConfig(
+      stateV2, &newConfig, platform.get(), nullptr, &config);
+  ASSERT_NE(nullptr, stateV3);
+  auto intfV3 = stateV3->getInterfaces()->getInterface(InterfaceID(2));
+  EXPECT_EQ(9000, intfV3->getMtu());
+  EXPECT_EQ(stateV2->getPorts(), stateV3->getPorts());
+  EXPECT_EQ(
+      cfg::PortState::DISABLED, stateV3->getPort(PortID(1))->getAdminState());
+
+  // Without a previous config everything is rebuilt
+  auto stateV4 = publishAndApplyConfig(stateV3, &newConfig, platform.get());
+  ASSERT_NE(nullptr, stateV4);
+  EXPECT_EQ(
+      cfg::PortState::ENABLED, stateV4->getPort(PortID(1))->getAdminState());
+}
+
+TEST(Port, applyConfigInParallel) {
+  auto platform = createMockPlatform();
+  auto stateV0 = make_shared<SwitchState>();
+  stateV0->registerPort(PortID(1), "port1");
+  stateV0->registerPort(PortID(2), "port2");
+
+  cfg::SwitchConfig config;
+  config.ports.resize(2);
+  for (int i = 0; i < 2; ++i) {
+    config.ports[i].logicalID = i + 1;
+    config.ports[i].name_ref().value_unchecked() =
+        folly::to<std::string>("port", i + 1);
+    config.ports[i].state = cfg::PortState::ENABLED;
+  }
+  config.vlans.resize(1);
+  config.vlans[0].id = 2;
+  config.vlanPorts.resize(2);
+  for (int i = 0; i < 2; ++i) {
+    config.vlanPorts[i].logicalPort = i + 1;
+    config.vlanPorts[i].vlanID = 2;
+  }
+  config.interfaces.resize(1);
+  config.interfaces[0].intfID = 2;
+  config.interfaces[0].vlanID = 2;
+  config.interfaces[0].__isset.mac = true;
+  config.interfaces[0].mac_ref().value_unchecked() = "00:00:00:00:00:22";
+  config.interfaces[0].ipAddresses.push_back("10.0.0.1/24");
+
+  auto oldThreads = FLAGS_config_apply_threads;
+  FLAGS_config_apply_threads = 1;
+  auto serial = publishAndApplyConfig(stateV0, &config, platform.get());
+  FLAGS_config_apply_threads = 4;
+  auto parallel = publishAndApplyConfig(stateV0, &config, platform.get());
+  FLAGS_config_apply_threads = oldThreads;
+
+  ASSERT_NE(nullptr, serial);
+  ASSERT_NE(nullptr, parallel);
+  EXPECT_EQ(serial->toFollyDynamic(), parallel->toFollyDynamic());
+
+  // Errors from any of the sections still fail the whole config
+  config.interfaces.push_back(config.interfaces[0]);
+  FLAGS_config_apply_threads = 4;
+  EXPECT_THROW(
+      publishAndApplyConfig(stateV0, &config, platform.get()), FbossError);
+  FLAGS_config_apply_threads = oldThreads;
+}
+
 TEST(Port, ToFromJSON) {
   std::string jsonStr = R"(
         {
@@ -647,3 +750,55 @@ TEST(PortMap, iterateOrder) {
   ++it;
   EXPECT_EQ(ports->end(), it);
 }
+
+TEST(PortMap, deltaUsesTrackedChanges) {
+  auto portsV0 = make_shared<PortMap>();
+  for (auto i = 1; i <= 10; ++i) {
+    portsV0->registerPort(PortID(i), "port" + std::to_string(i));
+  }
+  portsV0->publish();
+
+  // A clone records the ports it modifies, including ones that end up
+  // unchanged again.
+  auto portsV1 = portsV0->clone();
+  auto port3 = portsV0->getPort(PortID(3))->clone();
+  port3->setName("newPort3");
+  portsV1->updatePort(port3);
+  portsV1->updatePort(portsV0->getPort(PortID(5)));
+  auto port7 = portsV1->removeNode(PortID(7));
+  portsV1->registerPort(PortID(11), "port11");
+  portsV1->registerPort(PortID(12), "port12");
+  portsV1->removeNode(PortID(12));
+  portsV1->publish();
+
+  auto changedKeys = portsV1->changedKeysSince(*portsV0);
+  ASSERT_NE(nullptr, changedKeys);
+  EXPECT_EQ(5, changedKeys->size());
+  EXPECT_EQ(nullptr, portsV0->changedKeysSince(*portsV1));
+
+  std::vector<std::pair<shared_ptr<Port>, shared_ptr<Port>>> changes;
+  NodeMapDelta<PortMap> portsDelta(portsV0.get(), portsV1.get());
+  for (const auto& delta : portsDelta) {
+    changes.emplace_back(delta.getOld(), delta.getNew());
+  }
+  ASSERT_EQ(3, changes.size());
+  EXPECT_EQ(portsV0->getPort(PortID(3)), changes[0].first);
+  EXPECT_EQ(port3, changes[0].second);
+  EXPECT_EQ(port7, changes[1].first);
+  EXPECT_EQ(nullptr, changes[1].second);
+  EXPECT_EQ(nullptr, changes[2].first);
+  EXPECT_EQ(portsV1->getPort(PortID(11)), changes[2].second);
+  checkChangedPorts(portsV0, portsV1, {3});
+
+  // Changing the container directly drops the tracking, and the delta falls
+  // back to comparing the full maps.
+  auto portsV2 = portsV1->clone();
+  portsV2->writableNodes().find(PortID(1))->second =
+      portsV1->getPort(PortID(1))->clone();
+  portsV2->publish();
+  EXPECT_EQ(nullptr, portsV2->changedKeysSince(*portsV1));
+  checkChangedPorts(portsV1, portsV2, {1});
+
+  // Tracking only applies to the map the clone was made from
+  EXPECT_EQ(nullptr, portsV1->clone()->changedKeysSince(*portsV0));
+}
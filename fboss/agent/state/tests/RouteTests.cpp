@@ -280,6 +280,124 @@ TEST(RouteUpdater, dedup) {
   EXPECT_EQ(t2r4, t4r4);
 }
 
+TEST(RouteUpdater, syncOnlyRemovesDroppedRoutes) {
+  auto stateV1 = applyInitConfig();
+  ASSERT_NE(nullptr, stateV1);
+
+  auto rid = RouterID(0);
+  RouteNextHopSet nhop1 = makeNextHops({"1.1.1.10"});
+  RouteNextHopSet nhop2 = makeNextHops({"2.2.2.10"});
+  RouteV4::Prefix r1{IPAddressV4("10.1.1.0"), 24};
+  RouteV4::Prefix r2{IPAddressV4("20.1.1.0"), 24};
+  RouteV6::Prefix r3{IPAddressV6("1001::0"), 48};
+  RouteV6::Prefix r4{IPAddressV6("2001::0"), 48};
+
+  RouteUpdater u2(stateV1->getRouteTables());
+  u2.addRoute(
+      rid, r1.network, r1.mask, CLIENT_A, RouteNextHopEntry(nhop1, DISTANCE));
+  u2.addRoute(
+      rid, r2.network, r2.mask, CLIENT_A, RouteNextHopEntry(nhop2, DISTANCE));
+  u2.addRoute(
+      rid, r3.network, r3.mask, CLIENT_A, RouteNextHopEntry(nhop1, DISTANCE));
+  u2.addRoute(
+      rid, r4.network, r4.mask, CLIENT_A, RouteNextHopEntry(nhop2, DISTANCE));
+  u2.addRoute(
+      rid, r4.network, r4.mask, CLIENT_B, RouteNextHopEntry(nhop1, DISTANCE));
+  auto tables2 = u2.updateDone();
+  ASSERT_NE(nullptr, tables2);
+  tables2->publish();
+
+  // Syncing the same routes changes nothing
+  RouteUpdater u3(tables2);
+  u3.addRoute(
+      rid, r1.network, r1.mask, CLIENT_A, RouteNextHopEntry(nhop1, DISTANCE));
+  u3.addRoute(
+      rid, r2.network, r2.mask, CLIENT_A, RouteNextHopEntry(nhop2, DISTANCE));
+  u3.addRoute(
+      rid, r3.network, r3.mask, CLIENT_A, RouteNextHopEntry(nhop1, DISTANCE));
+  u3.addRoute(
+      rid, r4.network, r4.mask, CLIENT_A, RouteNextHopEntry(nhop2, DISTANCE));
+  u3.removeRoutesForClientExcept(rid, CLIENT_A, {r1, r2}, {r3, r4});
+  EXPECT_EQ(nullptr, u3.updateDone());
+
+  // Dropping r2 and r4 only touches those two
+  RouteUpdater u4(tables2);
+  u4.addRoute(
+      rid, r1.network, r1.mask, CLIENT_A, RouteNextHopEntry(nhop1, DISTANCE));
+  u4.addRoute(
+      rid, r3.network, r3.mask, CLIENT_A, RouteNextHopEntry(nhop1, DISTANCE));
+  u4.removeRoutesForClientExcept(rid, CLIENT_A, {r1}, {r3});
+  auto tables4 = u4.updateDone();
+  ASSERT_NE(nullptr, tables4);
+  EXPECT_NODEMAP_MATCH(tables4);
+  tables4->publish();
+
+  EXPECT_EQ(GET_ROUTE_V4(tables2, rid, r1), GET_ROUTE_V4(tables4, rid, r1));
+  EXPECT_EQ(GET_ROUTE_V6(tables2, rid, r3), GET_ROUTE_V6(tables4, rid, r3));
+  EXPECT_NO_ROUTE(tables4, rid, "20.1.1.0/24");
+  // CLIENT_B still has r4
+  auto t4r4 = GET_ROUTE_V6(tables4, rid, r4);
+  EXPECT_FALSE(t4r4->getEntryForClient(CLIENT_A));
+  EXPECT_TRUE(t4r4->getEntryForClient(CLIENT_B));
+}
+
+TEST(RouteTableRib, prefixesForClient) {
+  auto stateV1 = applyInitConfig();
+  ASSERT_NE(nullptr, stateV1);
+
+  auto rid = RouterID(0);
+  RouteNextHopSet nhop1 = makeNextHops({"1.1.1.10"});
+  RouteNextHopSet nhop2 = makeNextHops({"2.2.2.10"});
+  RouteV4::Prefix r1{IPAddressV4("10.1.1.0"), 24};
+  RouteV4::Prefix r2{IPAddressV4("20.1.1.0"), 24};
+  RouteV6::Prefix r3{IPAddressV6("1001::0"), 48};
+
+  RouteUpdater u2(stateV1->getRouteTables());
+  u2.addRoute(
+      rid, r1.network, r1.mask, CLIENT_A, RouteNextHopEntry(nhop1, DISTANCE));
+  u2.addRoute(
+      rid, r2.network, r2.mask, CLIENT_A, RouteNextHopEntry(nhop2, DISTANCE));
+  u2.addRoute(
+      rid, r2.network, r2.mask, CLIENT_B, RouteNextHopEntry(nhop1, DISTANCE));
+  u2.addRoute(
+      rid, r3.network, r3.mask, CLIENT_B, RouteNextHopEntry(nhop1, DISTANCE));
+  auto tables2 = u2.updateDone();
+  ASSERT_NE(nullptr, tables2);
+  tables2->publish();
+
+  using PrefixesV4 = RouteTableRib<IPAddressV4>::ClientPrefixes;
+  using PrefixesV6 = RouteTableRib<IPAddressV6>::ClientPrefixes;
+  auto ribV4 = tables2->getRouteTable(rid)->getRibV4();
+  auto ribV6 = tables2->getRouteTable(rid)->getRibV6();
+  EXPECT_EQ(PrefixesV4({r1, r2}), ribV4->prefixesForClient(CLIENT_A));
+  EXPECT_EQ(PrefixesV4({r2}), ribV4->prefixesForClient(CLIENT_B));
+  EXPECT_EQ(PrefixesV6(), ribV6->prefixesForClient(CLIENT_A));
+  EXPECT_EQ(PrefixesV6({r3}), ribV6->prefixesForClient(CLIENT_B));
+
+  // Deleting an entry, and the last entry of a route, both update the index
+  RouteUpdater u3(tables2);
+  u3.delRoute(rid, r2.network, r2.mask, CLIENT_A);
+  u3.delRoute(rid, r3.network, r3.mask, CLIENT_B);
+  auto tables3 = u3.updateDone();
+  ASSERT_NE(nullptr, tables3);
+  tables3->publish();
+
+  ribV4 = tables3->getRouteTable(rid)->getRibV4();
+  ribV6 = tables3->getRouteTable(rid)->getRibV6();
+  EXPECT_EQ(PrefixesV4({r1}), ribV4->prefixesForClient(CLIENT_A));
+  EXPECT_EQ(PrefixesV4({r2}), ribV4->prefixesForClient(CLIENT_B));
+  EXPECT_EQ(PrefixesV6(), ribV6->prefixesForClient(CLIENT_B));
+  // The older tables are unchanged
+  EXPECT_EQ(
+      PrefixesV4({r1, r2}),
+      tables2->getRouteTable(rid)->getRibV4()->prefixesForClient(CLIENT_A));
+
+  // And the index is rebuilt on deserialization
+  auto deserialized =
+      RouteTableRib<IPAddressV4>::fromFollyDynamic(ribV4->toFollyDynamic());
+  EXPECT_EQ(PrefixesV4({r2}), deserialized->prefixesForClient(CLIENT_B));
+}
+
 TEST(Route, resolve) {
   auto stateV1 = applyInitConfig();
   ASSERT_NE(nullptr, stateV1);
@@ -1794,6 +1912,40 @@ TEST(Route, listRanking) {
   EXPECT_THROW(nhm.getBestEntry().second->getNextHopSet(), FbossError);
 }
 
+TEST(Route, listRankingTiesAndDemotion) {
+  auto list01 = newNextHops(3, "1.1.1.");
+  auto list20 = newNextHops(3, "20.20.20.");
+  auto list30 = newNextHops(3, "30.30.30.");
+
+  // Ties go to the lowest client, whatever order they were added in
+  RouteNextHopsMulti nhm;
+  nhm.update(ClientID(30), RouteNextHopEntry(list30, AdminDistance::EBGP));
+  nhm.update(ClientID(20), RouteNextHopEntry(list20, AdminDistance::EBGP));
+  EXPECT_EQ(ClientID(20), nhm.getBestEntry().first);
+
+  // Adding a client ahead of the best one in the map keeps the best entry
+  nhm.update(
+      ClientID(1), RouteNextHopEntry(list01, AdminDistance::MAX_ADMIN_DISTANCE));
+  EXPECT_EQ(ClientID(20), nhm.getBestEntry().first);
+  EXPECT_TRUE(nhm.getBestEntry().second->getNextHopSet() == list20);
+
+  // The best client getting worse gives way to the next best
+  nhm.update(
+      ClientID(20),
+      RouteNextHopEntry(list20, AdminDistance::MAX_ADMIN_DISTANCE));
+  EXPECT_EQ(ClientID(30), nhm.getBestEntry().first);
+
+  nhm.update(
+      ClientID(1), RouteNextHopEntry(list01, AdminDistance::STATIC_ROUTE));
+  EXPECT_EQ(ClientID(1), nhm.getBestEntry().first);
+
+  // A copy's best entry is its own
+  auto copy = nhm;
+  nhm.delEntryForClient(ClientID(1));
+  EXPECT_EQ(ClientID(1), copy.getBestEntry().first);
+  EXPECT_EQ(ClientID(30), nhm.getBestEntry().first);
+}
+
 bool stringStartsWith(std::string s1, std::string prefix) {
   return s1.compare(0, prefix.size(), prefix) == 0;
 }
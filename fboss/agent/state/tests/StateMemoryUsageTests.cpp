@@ -0,0 +1,92 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/state/StateMemoryUsage.h"
+
+#include "fboss/agent/state/ArpTable.h"
+#include "fboss/agent/state/SwitchState.h"
+#include "fboss/agent/state/Vlan.h"
+#include "fboss/agent/state/VlanMap.h"
+#include "fboss/agent/test/TestUtils.h"
+
+#include <gtest/gtest.h>
+
+using namespace facebook::fboss;
+using folly::IPAddressV4;
+using folly::MacAddress;
+
+namespace {
+
+StateMemoryUsage::Usage getSubtree(
+    const StateMemoryUsage& memory,
+    const std::string& name) {
+  for (const auto& subtree : memory.getSubtrees()) {
+    if (subtree.first == name) {
+      return subtree.second;
+    }
+  }
+  ADD_FAILURE() << "no subtree " << name;
+  return StateMemoryUsage::Usage();
+}
+
+} // namespace
+
+TEST(StateMemoryUsage, Subtrees) {
+  auto state = testStateA();
+  StateMemoryUsage memory(state);
+
+  auto ports = getSubtree(memory, "ports");
+  // The map and its 20 ports
+  EXPECT_EQ(21, ports.nodes);
+  EXPECT_GT(ports.bytes, 0);
+  auto routes = getSubtree(memory, "routeTables.0");
+  EXPECT_GT(routes.nodes, 0);
+  EXPECT_GT(getSubtree(memory, "vlans.1.arp").nodes, 0);
+  EXPECT_EQ(0, memory.getTotal().sharedNodes);
+
+  uint64_t nodes = 0;
+  uint64_t bytes = 0;
+  for (const auto& subtree : memory.getSubtrees()) {
+    nodes += subtree.second.nodes;
+    bytes += subtree.second.bytes;
+  }
+  EXPECT_EQ(nodes, memory.getTotal().nodes);
+  EXPECT_EQ(bytes, memory.getTotal().bytes);
+}
+
+TEST(StateMemoryUsage, SharedWithOtherState) {
+  auto state = testStateA();
+  state->publish();
+
+  // The same state shares everything
+  StateMemoryUsage same(state, state);
+  EXPECT_EQ(same.getTotal().nodes, same.getTotal().sharedNodes);
+  EXPECT_EQ(same.getTotal().bytes, same.getTotal().sharedBytes);
+
+  // Adding an arp entry copies the path from the root to the arp table
+  auto newState = state;
+  auto vlan = state->getVlans()->getVlan(VlanID(1))->modify(&newState);
+  auto arpTable = vlan->getArpTable()->modify(&vlan, &newState);
+  arpTable->addEntry(
+      IPAddressV4("10.0.0.10"),
+      MacAddress("fa:ce:b0:0c:00:0a"),
+      PortDescriptor(PortID(1)),
+      InterfaceID(1));
+  newState->publish();
+
+  StateMemoryUsage memory(newState, state);
+  auto arp = getSubtree(memory, "vlans.1.arp");
+  // Only the existing arp entries are shared
+  EXPECT_EQ(arp.nodes - 2, arp.sharedNodes);
+  auto ports = getSubtree(memory, "ports");
+  EXPECT_EQ(ports.nodes, ports.sharedNodes);
+  EXPECT_EQ(ports.bytes, ports.sharedBytes);
+  EXPECT_EQ(0, getSubtree(memory, "vlans").sharedNodes);
+  EXPECT_EQ(0, getSubtree(memory, "switchState").sharedNodes);
+}
@@ -0,0 +1,356 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/Utils.h"
+#include "fboss/agent/state/ArpTable.h"
+#include "fboss/agent/state/NodeMapDelta.h"
+#include "fboss/agent/state/Port.h"
+#include "fboss/agent/state/PortDescriptor.h"
+#include "fboss/agent/state/PortMap.h"
+#include "fboss/agent/state/Route.h"
+#include "fboss/agent/state/RouteDelta.h"
+#include "fboss/agent/state/RouteTable.h"
+#include "fboss/agent/state/RouteTableMap.h"
+#include "fboss/agent/state/RouteTableRib.h"
+#include "fboss/agent/state/StateDelta.h"
+#include "fboss/agent/state/SwitchState.h"
+#include "fboss/agent/state/Vlan.h"
+#include "fboss/agent/state/VlanMap.h"
+#include "fboss/agent/state/VlanMapDelta.h"
+
+#include <folly/Benchmark.h>
+#include <folly/FileUtil.h>
+#include <folly/IPAddressV4.h>
+#include <folly/MacAddress.h>
+#include <folly/init/Init.h>
+#include <folly/json.h>
+#include <folly/memory/MallctlHelper.h>
+#include <folly/memory/Malloc.h>
+#include <gflags/gflags.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+DEFINE_int32(state_ports, 128, "Number of ports in the benchmark state");
+DEFINE_int32(state_vlans, 32, "Number of vlans in the benchmark state");
+DEFINE_int32(
+    state_neighbors,
+    4096,
+    "Number of ARP entries in the benchmark state, spread over the vlans");
+DEFINE_int32(state_routes, 100000, "Number of routes in the benchmark state");
+DEFINE_int32(
+    coalesced_updates,
+    16,
+    "Number of port updates applied together in the coalescing benchmarks");
+DEFINE_string(
+    memory_json,
+    "",
+    "Write the memory measurements to this file as JSON. Timings can be "
+    "had as JSON from folly's --json flag");
+
+using namespace facebook::fboss;
+using folly::IPAddressV4;
+using folly::MacAddress;
+
+namespace {
+
+IPAddressV4 neighborIp(int i) {
+  // 10.0.0.1 onwards
+  return IPAddressV4::fromLongHBO((10 << 24) + i + 1);
+}
+
+VlanID neighborVlan(int i) {
+  return VlanID(i % FLAGS_state_vlans + 1);
+}
+
+RouteFields<IPAddressV4>::Prefix routePrefix(int i) {
+  // /24s from 20.0.0.0 onwards
+  return {IPAddressV4::fromLongHBO((20 << 24) + (i << 8)), 24};
+}
+
+std::shared_ptr<Route<IPAddressV4>> makeRoute(
+    const RouteFields<IPAddressV4>::Prefix& prefix,
+    int firstNextHop) {
+  RouteNextHopEntry::NextHopSet nextHops;
+  for (int i = firstNextHop; i < firstNextHop + 2; ++i) {
+    nextHops.emplace(ResolvedNextHop(
+        neighborIp(i % FLAGS_state_neighbors),
+        InterfaceID(neighborVlan(i % FLAGS_state_neighbors)),
+        ECMP_WEIGHT));
+  }
+  RouteNextHopEntry entry(nextHops, AdminDistance::EBGP);
+  auto route = std::make_shared<Route<IPAddressV4>>(prefix);
+  route->update(StdClientIds2ClientID(StdClientIds::BGPD), entry);
+  route->setResolved(entry);
+  return route;
+}
+
+/*
+ * A published state with the ports, vlans, neighbors and routes asked for on
+ * the command line. Neighbor i is on vlan i % vlans, behind port i % ports.
+ */
+std::shared_ptr<SwitchState> makeState() {
+  auto state = std::make_shared<SwitchState>();
+  for (int i = 1; i <= FLAGS_state_ports; ++i) {
+    state->registerPort(PortID(i), "port" + std::to_string(i));
+  }
+
+  auto vlans = std::make_shared<VlanMap>();
+  std::vector<std::shared_ptr<ArpTable>> arpTables;
+  for (int i = 1; i <= FLAGS_state_vlans; ++i) {
+    auto vlan = std::make_shared<Vlan>(VlanID(i), "vlan" + std::to_string(i));
+    arpTables.push_back(std::make_shared<ArpTable>());
+    vlan->setArpTable(arpTables.back());
+    vlans->addVlan(vlan);
+  }
+  for (int i = 0; i < FLAGS_state_neighbors; ++i) {
+    auto vlan = neighborVlan(i);
+    arpTables.at(vlan - 1)->addEntry(
+        neighborIp(i),
+        MacAddress::fromHBO(0x020000000000 + i),
+        PortDescriptor(PortID(i % FLAGS_state_ports + 1)),
+        InterfaceID(vlan));
+  }
+  state->resetVlans(vlans);
+
+  auto rib = std::make_shared<RouteTableRib<IPAddressV4>>();
+  for (int i = 0; i < FLAGS_state_routes; ++i) {
+    rib->addRoute(makeRoute(routePrefix(i), i));
+  }
+  auto routeTable = std::make_shared<RouteTable>(RouterID(0));
+  routeTable->setRib(rib);
+  state->addRouteTable(routeTable);
+
+  state->publish();
+  return state;
+}
+
+const std::shared_ptr<SwitchState>& benchmarkState() {
+  static auto* state = new std::shared_ptr<SwitchState>(makeState());
+  return *state;
+}
+
+/*
+ * Change one leaf of the state the way the update functions handed to
+ * SwSwitch::updateState() do: modify() clones the path from the leaf up,
+ * unless it is unpublished already.
+ */
+void modifyPort(std::shared_ptr<SwitchState>* state, int i) {
+  auto id = PortID(i % FLAGS_state_ports + 1);
+  auto port = (*state)->getPorts()->getPort(id)->modify(state);
+  port->setOperState(!port->isUp());
+}
+
+void modifyNeighbor(std::shared_ptr<SwitchState>* state, int i) {
+  i %= FLAGS_state_neighbors;
+  auto arpTable = (*state)->getVlans()->getVlan(neighborVlan(i))
+      ->getArpTable()->modify(neighborVlan(i), state);
+  auto entry = arpTable->getEntry(neighborIp(i));
+  arpTable->updateEntry(
+      neighborIp(i),
+      MacAddress::fromHBO(entry->getMac().u64HBO() ^ 1),
+      entry->getPort(),
+      entry->getIntfID());
+}
+
+void modifyRoute(std::shared_ptr<SwitchState>* state, int i) {
+  auto prefix = routePrefix(i % FLAGS_state_routes);
+  auto rib = (*state)->getRouteTables()->getRouteTable(RouterID(0))
+      ->getRibV4()->modify(RouterID(0), state);
+  rib->updateRoute(makeRoute(prefix, i + 1));
+}
+
+template <typename ModifyFn>
+void modifyOneLeaf(size_t iters, ModifyFn modifyFn) {
+  const auto& state = benchmarkState();
+  for (size_t i = 0; i < iters; ++i) {
+    auto newState = state;
+    modifyFn(&newState, i);
+    // As SwSwitch does before it makes the new state current
+    newState->publish();
+    folly::doNotOptimizeAway(newState);
+  }
+}
+
+/*
+ * The updates SwSwitch has queued are applied one after the other to the
+ * same state, and only the result is published. Compare with what the same
+ * updates cost applied and published one at a time.
+ */
+void portUpdates(size_t iters, bool coalesce) {
+  const auto& state = benchmarkState();
+  for (size_t i = 0; i < iters; ++i) {
+    auto newState = state;
+    for (int j = 0; j < FLAGS_coalesced_updates; ++j) {
+      modifyPort(&newState, j * FLAGS_state_ports / FLAGS_coalesced_updates);
+      if (!coalesce) {
+        newState->publish();
+      }
+    }
+    newState->publish();
+    folly::doNotOptimizeAway(newState);
+  }
+}
+
+size_t iterateDelta(const StateDelta& delta) {
+  size_t changed = 0;
+  for (const auto& portDelta : delta.getPortsDelta()) {
+    folly::doNotOptimizeAway(portDelta.getNew());
+    ++changed;
+  }
+  for (const auto& vlanDelta : delta.getVlansDelta()) {
+    for (const auto& arpDelta : vlanDelta.getArpDelta()) {
+      folly::doNotOptimizeAway(arpDelta.getNew());
+      ++changed;
+    }
+  }
+  for (const auto& routeTableDelta : delta.getRouteTablesDelta()) {
+    for (const auto& routeDelta : routeTableDelta.getRoutesV4Delta()) {
+      folly::doNotOptimizeAway(routeDelta.getNew());
+      ++changed;
+    }
+  }
+  return changed;
+}
+
+// Only jemalloc keeps the count, so this is 0 under any other allocator
+size_t allocatedBytes() {
+  if (!folly::usingJEMalloc()) {
+    return 0;
+  }
+  folly::mallctlWrite<uint64_t>("epoch", 1);
+  size_t allocated = 0;
+  folly::mallctlRead("stats.allocated", &allocated);
+  return allocated;
+}
+
+// Bytes taken by what fn returns, beyond what it shares with the state
+template <typename Fn>
+int64_t memoryOf(Fn fn) {
+  auto before = allocatedBytes();
+  auto result = fn();
+  auto after = allocatedBytes();
+  folly::doNotOptimizeAway(result);
+  return static_cast<int64_t>(after) - static_cast<int64_t>(before);
+}
+
+folly::dynamic measureMemory() {
+  folly::dynamic memory = folly::dynamic::object;
+  memory["state"] = memoryOf(makeState);
+  const auto& state = benchmarkState();
+  auto modified = [&state](auto modifyFn) {
+    return memoryOf([&state, &modifyFn] {
+      auto newState = state;
+      modifyFn(&newState, 0);
+      return newState;
+    });
+  };
+  memory["modifyPort"] = modified(modifyPort);
+  memory["modifyNeighbor"] = modified(modifyNeighbor);
+  memory["modifyRoute"] = modified(modifyRoute);
+  memory["toFollyDynamic"] = memoryOf([&state] {
+    return std::make_shared<folly::dynamic>(state->toFollyDynamic());
+  });
+  memory["jsonSize"] =
+      static_cast<int64_t>(folly::toJson(state->toFollyDynamic()).size());
+  return memory;
+}
+
+} // namespace
+
+BENCHMARK(clone, iters) {
+  const auto& state = benchmarkState();
+  for (size_t i = 0; i < iters; ++i) {
+    auto newState = state->clone();
+    folly::doNotOptimizeAway(newState);
+  }
+}
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK(modifyOnePort, iters) {
+  modifyOneLeaf(iters, modifyPort);
+}
+
+BENCHMARK(modifyOneNeighbor, iters) {
+  modifyOneLeaf(iters, modifyNeighbor);
+}
+
+BENCHMARK(modifyOneRoute, iters) {
+  modifyOneLeaf(iters, modifyRoute);
+}
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK(separatePortUpdates, iters) {
+  portUpdates(iters, false);
+}
+
+BENCHMARK_RELATIVE(coalescedPortUpdates, iters) {
+  portUpdates(iters, true);
+}
+
+BENCHMARK_DRAW_LINE();
+
+// A port, a neighbor and a route changed
+BENCHMARK(deltaIteration, iters) {
+  std::shared_ptr<SwitchState> newState;
+  BENCHMARK_SUSPEND {
+    newState = benchmarkState();
+    modifyPort(&newState, 0);
+    modifyNeighbor(&newState, 0);
+    modifyRoute(&newState, 0);
+    newState->publish();
+  }
+  for (size_t i = 0; i < iters; ++i) {
+    StateDelta delta(benchmarkState(), newState);
+    CHECK_EQ(3, iterateDelta(delta));
+  }
+}
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK(toFollyDynamic, iters) {
+  const auto& state = benchmarkState();
+  for (size_t i = 0; i < iters; ++i) {
+    auto json = state->toFollyDynamic();
+    folly::doNotOptimizeAway(json);
+  }
+}
+
+BENCHMARK(fromFollyDynamic, iters) {
+  folly::dynamic json;
+  BENCHMARK_SUSPEND {
+    json = benchmarkState()->toFollyDynamic();
+  }
+  for (size_t i = 0; i < iters; ++i) {
+    auto state = SwitchState::fromFollyDynamic(json);
+    folly::doNotOptimizeAway(state);
+  }
+}
+
+int main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  auto memory = measureMemory();
+  folly::runBenchmarks();
+
+  folly::dynamic results = folly::dynamic::object(
+      "ports", FLAGS_state_ports)("vlans", FLAGS_state_vlans)(
+      "neighbors", FLAGS_state_neighbors)("routes", FLAGS_state_routes)(
+      "memoryBytes", memory);
+  auto json = folly::toPrettyJson(results);
+  if (FLAGS_memory_json.empty()) {
+    LOG(INFO) << json;
+  } else if (!folly::writeFile(json, FLAGS_memory_json.c_str())) {
+    LOG(ERROR) << "Failed to write " << FLAGS_memory_json;
+    return 1;
+  }
+  return 0;
+}
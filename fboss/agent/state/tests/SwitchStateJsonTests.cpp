@@ -0,0 +1,96 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/FbossError.h"
+#include "fboss/agent/state/SwitchState.h"
+#include "fboss/agent/state/SwitchStateJson.h"
+#include "fboss/agent/test/TestUtils.h"
+
+#include <gtest/gtest.h>
+
+using namespace facebook::fboss;
+using folly::json_pointer;
+
+namespace {
+
+folly::dynamic fromFullState(
+    const SwitchState& state,
+    const std::string& ptr) {
+  auto json = state.toFollyDynamic();
+  return *json.get_ptr(json_pointer::parse(ptr));
+}
+
+} // namespace
+
+TEST(SwitchStateJson, matchesFullSerialization) {
+  auto state = testStateA();
+  for (auto ptr : {"",
+                   "/ports",
+                   "/ports/entries",
+                   "/ports/entries/3",
+                   "/vlans/entries/0/vlanName",
+                   "/vlans/entries/1",
+                   "/vlans/entries/0/arpTable",
+                   "/routeTables/entries/0/ribV4/routes",
+                   "/routeTables/entries/0/ribV6/routes/0",
+                   "/defaultVlan",
+                   "/controlPlane"}) {
+    EXPECT_EQ(
+        fromFullState(*state, ptr),
+        switchStateToFollyDynamic(*state, json_pointer::parse(ptr)))
+        << ptr;
+  }
+}
+
+TEST(SwitchStateJson, badPointers) {
+  auto state = testStateA();
+  for (auto ptr : {"/nonexistent",
+                   "/ports/entries/100",
+                   "/ports/entries/x",
+                   "/ports/entries/0/nonexistent",
+                   "/routeTables/entries/0/ribV4/routes/1000"}) {
+    EXPECT_THROW(
+        switchStateToFollyDynamic(*state, json_pointer::parse(ptr)),
+        FbossError)
+        << ptr;
+  }
+}
+
+TEST(SwitchStateJson, pages) {
+  auto state = testStateA();
+  auto ports = fromFullState(*state, "/ports/entries");
+
+  auto page = switchStateEntriesToFollyDynamic(
+      *state, json_pointer::parse("/ports"), 5, 3);
+  EXPECT_EQ(ports.size(), page["total"].asInt());
+  ASSERT_EQ(3, page["entries"].size());
+  for (size_t i = 0; i < 3; ++i) {
+    EXPECT_EQ(ports[5 + i], page["entries"][i]);
+  }
+
+  // The last page is short, and pages past the end are empty
+  page = switchStateEntriesToFollyDynamic(
+      *state, json_pointer::parse("/ports/entries"), ports.size() - 1, 3);
+  EXPECT_EQ(1, page["entries"].size());
+  page = switchStateEntriesToFollyDynamic(
+      *state, json_pointer::parse("/ports"), ports.size() + 10, 3);
+  EXPECT_EQ(0, page["entries"].size());
+
+  auto routes = fromFullState(*state, "/routeTables/entries/0/ribV4/routes");
+  page = switchStateEntriesToFollyDynamic(
+      *state, json_pointer::parse("/routeTables/entries/0/ribV4"), 1, 100);
+  EXPECT_EQ(routes.size(), page["total"].asInt());
+  ASSERT_EQ(routes.size() - 1, page["entries"].size());
+  EXPECT_EQ(routes[1], page["entries"][0]);
+
+  EXPECT_THROW(
+      switchStateEntriesToFollyDynamic(
+          *state, json_pointer::parse("/ports/entries/0"), 0, 10),
+      FbossError);
+}
@@ -419,3 +419,28 @@ TEST(VlanMap, applyConfig) {
 
   checkChangedVlans(vlansV2, vlansV3, {}, {}, {99});
 }
+
+TEST(ArpResponseTable, publishedLookups) {
+  MacAddress mac("02:00:00:00:00:01");
+  IPAddressV4 ip1("10.0.0.1");
+  IPAddressV4 ip2("10.0.0.2");
+  auto table = make_shared<ArpResponseTable>();
+  table->setEntry(ip1, mac, InterfaceID(1));
+  EXPECT_EQ(InterfaceID(1), table->getEntry(ip1)->interfaceID);
+
+  table->publish();
+  auto entry = table->getEntry(ip1);
+  ASSERT_TRUE(entry.hasValue());
+  EXPECT_EQ(mac, entry->mac);
+  EXPECT_EQ(InterfaceID(1), entry->interfaceID);
+  EXPECT_FALSE(table->getEntry(ip2).hasValue());
+
+  // A clone sees its own changes, and builds its own index when published
+  auto newTable = table->clone();
+  newTable->setEntry(ip2, mac, InterfaceID(2));
+  EXPECT_EQ(InterfaceID(2), newTable->getEntry(ip2)->interfaceID);
+  newTable->publish();
+  EXPECT_EQ(InterfaceID(2), newTable->getEntry(ip2)->interfaceID);
+  EXPECT_EQ(InterfaceID(1), newTable->getEntry(ip1)->interfaceID);
+  EXPECT_FALSE(table->getEntry(ip2).hasValue());
+}
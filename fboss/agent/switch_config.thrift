@@ -621,12 +621,25 @@ const MinimumCapacity ALL_LINKS = {
   "linkPercentage": 1
 }
 
+/**
+ * RFC 7130 micro-BFD, run on each member port of an AggregatePort. A member
+ * whose session goes down stops forwarding, whatever LACP makes of it, until
+ * the session comes back up.
+ */
+struct MicroBfd {
+  // The peer's address on the interface of the AggregatePort
+  1: string peerAddress
+  2: i32 intervalMsecs = 50
+  3: i32 detectMultiplier = 3
+}
+
 struct AggregatePort {
   1: i16 key
   2: string name
   3: string description
   4: list<AggregatePortMember> memberPorts
   5: MinimumCapacity minimumCapacity = ALL_LINKS
+  6: optional MicroBfd microBfd
 }
 
 struct Lacp {
@@ -881,6 +894,11 @@ struct LoadBalancer {
   // If not set, the seed will be chosen so as to remain constant across process
   // restarts
   4: optional i32 seed
+  // Only valid for the ECMP LoadBalancer. If set, ECMP groups use resilient
+  // hashing: flows hash into a table of this many flowsets per group, so a
+  // next hop going away only moves the flows that were using it, rather than
+  // rehashing every flow across the remaining next hops
+  5: optional i32 resilientFlowsetSize
 }
 
 enum CounterType {
@@ -899,6 +917,17 @@ struct TrafficCounter {
  * This contains all of the hardware-independent configuration for a
  * single switch/router in the network.
  */
+/**
+ * An RFC 5881 single hop BFD session with a directly connected next hop.
+ * Once the session has come up, the next hop is taken out of forwarding
+ * whenever it goes down, until it comes back up.
+ */
+struct BfdPeer {
+  1: string address
+  2: i32 intervalMsecs = 50
+  3: i32 detectMultiplier = 3
+}
+
 struct SwitchConfig {
   1: i64 version = 0
   2: list<Port> ports
@@ -988,4 +1017,6 @@ struct SwitchConfig {
   38: list<StaticMplsRouteNoNextHops> staticMplsRoutesToCPU = []
   // ingress LER routes
   39: list<StaticIp2MplsRoute> staticIp2MplsRoutes = []
+  // Next hops to check the liveness of with BFD
+  40: list<BfdPeer> bfdPeers = []
 }
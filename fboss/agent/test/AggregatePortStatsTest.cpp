@@ -202,3 +202,32 @@ TEST(AggregatePortStats, UpdateAggregatePortName) {
   EXPECT_FALSE(counters.checkExist(initialFlapsCounterName));
   EXPECT_TRUE(counters.checkExist(updatedFlapsCounterName));
 }
+
+TEST(AggregatePortStats, EnableMembersTogether) {
+  const AggregatePortID aggregatePortID = AggregatePortID(1);
+  const auto aggregatePortName = "Port-Channel1";
+  const auto flapsCounterName = "Port-Channel1.flaps.sum";
+
+  auto config = createConfig(aggregatePortID, aggregatePortName);
+  auto handle = createTestHandle(&config);
+  auto sw = handle->getSw();
+
+  CounterCache counters(sw);
+
+  auto oldAggPort = getAggregatePort(sw, aggregatePortID);
+
+  ProgramForwardingState addPortsToAggregatePort(
+      aggregatePortID,
+      {{PortID(1), AggregatePort::Forwarding::ENABLED},
+       {PortID(2), AggregatePort::Forwarding::ENABLED}});
+  sw->updateStateNoCoalescing(
+      "Adding both ports to AggregatePort", addPortsToAggregatePort);
+
+  waitForStateUpdates(sw);
+  auto newAggPort = getAggregatePort(sw, aggregatePortID);
+  EXPECT_EQ(2, newAggPort->forwardingSubportCount());
+  AggregatePortStats::recordStatistics(sw, oldAggPort, newAggPort);
+
+  counters.update();
+  counters.checkDelta(flapsCounterName, 1);
+}
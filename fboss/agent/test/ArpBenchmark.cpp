@@ -13,6 +13,7 @@
 #include <folly/Memory.h>
 #include "fboss/agent/SwSwitch.h"
 #include "fboss/agent/TunManager.h"
+#include "fboss/agent/TxPacket.h"
 #include "fboss/agent/hw/mock/MockRxPacket.h"
 #include "fboss/agent/hw/sim/SimPlatform.h"
 #include "fboss/agent/hw/sim/SimSwitch.h"
@@ -176,6 +177,24 @@ BENCHMARK(ArpRequestNotMine, numIters) {
   }
 }
 
+BENCHMARK(TxPacketAlloc, numIters) {
+  // Allocate and free an ARP reply sized packet, the way the ARP, NDP and
+  // LLDP handlers do for every packet they send
+  for (size_t n = 0; n < numIters; ++n) {
+    auto pkt = sw->allocatePacket(68);
+    folly::doNotOptimizeAway(pkt);
+  }
+}
+
+BENCHMARK(TxPacketAllocL3, numIters) {
+  // Allocate and free an MTU sized packet, as packets forwarded from the
+  // tun interfaces are
+  for (size_t n = 0; n < numIters; ++n) {
+    auto pkt = sw->allocateL3TxPacket(1500);
+    folly::doNotOptimizeAway(pkt);
+  }
+}
+
 int main(int argc, char** argv) {
   gflags::ParseCommandLineFlags(&argc, &argv, true);
 
@@ -37,11 +37,14 @@
 #include "fboss/agent/test/TestUtils.h"
 
 #include <boost/range/combine.hpp>
+#include <gflags/gflags.h>
 #include <gtest/gtest.h>
 #include <array>
 #include <future>
 #include <string>
 
+DECLARE_int32(pending_packets_per_neighbor);
+
 using namespace facebook::fboss;
 using facebook::network::toBinaryAddress;
 using facebook::network::toIPAddress;
@@ -614,6 +617,37 @@ TEST(ArpTest, TableUpdates) {
   EXPECT_EQ(InterfaceID(1), entry->getIntfID());
 }
 
+TEST(ArpTest, ReplyBurst) {
+  auto handle = setupTestHandle();
+  auto sw = handle->getSw();
+  VlanID vlanID(1);
+
+  // Replies arriving back to back are written to the SwitchState together
+  EXPECT_HW_CALL(sw, stateChanged(_)).Times(testing::AtLeast(1));
+  constexpr int kNumReplies = 20;
+  for (int i = 0; i < kNumReplies; ++i) {
+    sw->getNeighborUpdater()->receivedArpMine(
+        vlanID,
+        IPAddressV4(folly::to<std::string>("10.0.0.", 100 + i)),
+        MacAddress(folly::to<std::string>("00:02:00:01:03:", 10 + i)),
+        PortDescriptor(PortID(1)),
+        ARP_OP_REPLY);
+  }
+  waitForStateUpdates(sw);
+
+  auto arpTable = sw->getState()->getVlans()->getVlan(vlanID)->getArpTable();
+  EXPECT_EQ(kNumReplies, arpTable->getAllNodes().size());
+  for (int i = 0; i < kNumReplies; ++i) {
+    auto entry = arpTable->getEntry(
+        IPAddressV4(folly::to<std::string>("10.0.0.", 100 + i)));
+    EXPECT_EQ(
+        MacAddress(folly::to<std::string>("00:02:00:01:03:", 10 + i)),
+        entry->getMac());
+    EXPECT_EQ(PortDescriptor(PortID(1)), entry->getPort());
+    EXPECT_EQ(InterfaceID(1), entry->getIntfID());
+  }
+}
+
 TEST(ArpTest, NotMine) {
   auto handle = setupTestHandle();
   auto sw = handle->getSw();
@@ -914,6 +948,75 @@ TEST(ArpTest, PendingArp) {
   EXPECT_EQ(entry->isPending(), false);
 };
 
+TEST(ArpTest, PendingArpHoldsPackets) {
+  gflags::FlagSaver flagSaver;
+  FLAGS_pending_packets_per_neighbor = 1;
+  auto handle = setupTestHandle();
+  auto sw = handle->getSw();
+
+  VlanID vlanID(1);
+  IPAddressV4 senderIP = IPAddressV4("10.0.0.1");
+
+  // Cache the current stats
+  CounterCache counters(sw);
+
+  // Create an IP pkt for 10.0.0.10
+  auto hex = PktUtil::parseHexData(
+    // dst mac, src mac
+    "02 00 01 00 00 01  02 00 02 01 02 03"
+    // 802.1q, VLAN 1
+    "81 00 00 01"
+    // IPv4
+    "08 00"
+    // Version(4), IHL(5), DSCP(0), ECN(0), Total Length(20)
+    "45  00  00 14"
+    // Identification(0), Flags(0), Fragment offset(0)
+    "00 00  00 00"
+    // TTL(31), Protocol(6), Checksum (0, fake)
+    "1F  06  00 00"
+    // Source IP (1.2.3.4)
+    "01 02 03 04"
+    // Destination IP (10.0.0.10)
+    "0a 00 00 0a"
+  );
+  std::string frame(reinterpret_cast<const char*>(hex.data()), hex.length());
+
+  // The first packet triggers an ARP request and is held.  The second is
+  // dropped, as only one packet is held per neighbor.
+  EXPECT_HW_CALL(sw, stateChanged(_)).Times(1);
+  EXPECT_SWITCHED_PKT(sw, "ARP request",
+             checkArpRequest(senderIP, MacAddress("00:02:00:00:00:01"),
+                             IPAddressV4("10.0.0.10"), vlanID));
+
+  handle->rxPacket(make_unique<IOBuf>(hex), PortID(1), vlanID);
+  handle->rxPacket(make_unique<IOBuf>(hex), PortID(1), vlanID);
+  waitForStateUpdates(sw);
+
+  counters.update();
+  counters.checkDelta(SwitchStats::kCounterPrefix + "arp.request.tx.sum", 1);
+  counters.checkDelta(SwitchStats::kCounterPrefix + "trapped.drops.sum", 1);
+  counters.checkDelta(
+      SwitchStats::kCounterPrefix + "pending_pkt.queued.sum", 1);
+  counters.checkDelta(
+      SwitchStats::kCounterPrefix + "pending_pkt.flushed.sum", 0);
+
+  // Resolving the entry sends the held packet back into the pipeline as is
+  EXPECT_HW_CALL(sw, stateChanged(_)).Times(1);
+  EXPECT_SWITCHED_PKT(sw, "held packet", [frame](const TxPacket* pkt) {
+    auto buf = pkt->buf();
+    if (std::string(reinterpret_cast<const char*>(buf->data()),
+                    buf->length()) != frame) {
+      throw FbossError("held packet does not match the trapped one");
+    }
+  });
+  sendArpReply(handle.get(), "10.0.0.10", "02:10:20:30:40:22", 1);
+  waitForStateUpdates(sw);
+
+  counters.update();
+  counters.checkDelta(
+      SwitchStats::kCounterPrefix + "pending_pkt.flushed.sum", 1);
+}
+
 TEST(ArpTest, PendingArpCleanup) {
   auto handle = setupTestHandle(std::chrono::seconds(1));
   auto sw = handle->getSw();
@@ -1209,6 +1312,45 @@ TEST(ArpTest, PortFlapRecover) {
   EXPECT_EQ(unaffectedEntry->isPending(), false);
 }
 
+TEST(ArpTest, LivenessHoldDown) {
+  auto handle = setupTestHandle();
+  auto sw = handle->getSw();
+
+  VlanID vlanID(1);
+  IPAddressV4 senderIP = IPAddressV4("10.0.0.1");
+  IPAddressV4 targetIP = IPAddressV4("10.0.0.2");
+  MacAddress targetMAC = MacAddress("02:10:20:30:40:22");
+
+  testSendArpRequest(sw, vlanID, senderIP, targetIP);
+  WaitForArpEntryReachable arpReachable(sw, targetIP);
+  sendArpReply(handle.get(), targetIP.str(), targetMAC.toString(), 1);
+  waitForStateUpdates(sw);
+  EXPECT_TRUE(arpReachable.wait());
+
+  // Held down, the entry is pending in the SwitchState but not in the cache
+  WaitForArpEntryPending arpPending(sw, targetIP);
+  EXPECT_HW_CALL(sw, stateChanged(_)).Times(testing::AtLeast(1));
+  sw->getNeighborUpdater()->livenessChanged(vlanID, targetIP, false);
+  EXPECT_TRUE(arpPending.wait());
+  auto resolved =
+      sw->getNeighborUpdater()->getResolvedNeighbor(vlanID, targetIP);
+  ASSERT_TRUE(resolved);
+  EXPECT_EQ(targetMAC, resolved->first);
+  EXPECT_EQ(PortDescriptor(PortID(1)), resolved->second);
+
+  // A reply does not bring it back
+  sendArpReply(handle.get(), targetIP.str(), targetMAC.toString(), 1);
+  waitForStateUpdates(sw);
+  waitForBackgroundThread(sw);
+  waitForStateUpdates(sw);
+  EXPECT_TRUE(getArpEntry(sw, targetIP, vlanID)->isPending());
+
+  WaitForArpEntryReachable arpReleased(sw, targetIP);
+  sw->getNeighborUpdater()->livenessChanged(vlanID, targetIP, true);
+  EXPECT_TRUE(arpReleased.wait());
+  EXPECT_EQ(targetMAC, getArpEntry(sw, targetIP, vlanID)->getMac());
+}
+
 TEST(ArpTest, receivedPacketWithDirectlyConnectedDestination) {
   auto handle = setupTestHandle();
   auto sw = handle->getSw();
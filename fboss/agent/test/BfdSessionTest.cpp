@@ -0,0 +1,176 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/BfdSession.h"
+
+#include <folly/io/IOBuf.h>
+#include <gtest/gtest.h>
+
+using namespace facebook::fboss;
+using std::chrono::microseconds;
+using std::chrono::milliseconds;
+using State = BfdSession::State;
+
+namespace {
+
+const microseconds kInterval(50000);
+
+BfdControlPacket roundTrip(const BfdControlPacket& packet) {
+  auto buf = folly::IOBuf::create(BfdControlPacket::LENGTH);
+  buf->append(BfdControlPacket::LENGTH);
+  folly::io::RWPrivateCursor writer(buf.get());
+  packet.to(&writer);
+  folly::io::Cursor reader(buf.get());
+  return BfdControlPacket::from(&reader);
+}
+
+// Exchanges packets until neither session changes state
+void converge(
+    BfdSession& a,
+    BfdSession& b,
+    BfdSession::Clock::time_point now) {
+  for (auto i = 0; i < 4; ++i) {
+    b.received(a.nextPacket(), now);
+    a.received(b.nextPacket(), now);
+  }
+}
+
+} // namespace
+
+TEST(BfdSessionTest, PacketRoundTrip) {
+  BfdControlPacket packet;
+  packet.diag = BfdControlPacket::Diag::DETECTION_TIME_EXPIRED;
+  packet.state = State::INIT;
+  packet.poll = true;
+  packet.detectMultiplier = 3;
+  packet.myDiscriminator = 0x01020304;
+  packet.yourDiscriminator = 0x0a0b0c0d;
+  packet.desiredMinTxInterval = microseconds(1000000);
+  packet.requiredMinRxInterval = kInterval;
+
+  auto parsed = roundTrip(packet);
+  EXPECT_EQ(BfdControlPacket::VERSION, parsed.version);
+  EXPECT_EQ(packet.diag, parsed.diag);
+  EXPECT_EQ(packet.state, parsed.state);
+  EXPECT_TRUE(parsed.poll);
+  EXPECT_FALSE(parsed.final);
+  EXPECT_EQ(packet.detectMultiplier, parsed.detectMultiplier);
+  EXPECT_EQ(BfdControlPacket::LENGTH, parsed.length);
+  EXPECT_EQ(packet.myDiscriminator, parsed.myDiscriminator);
+  EXPECT_EQ(packet.yourDiscriminator, parsed.yourDiscriminator);
+  EXPECT_EQ(packet.desiredMinTxInterval, parsed.desiredMinTxInterval);
+  EXPECT_EQ(packet.requiredMinRxInterval, parsed.requiredMinRxInterval);
+  EXPECT_TRUE(parsed.isValid());
+}
+
+TEST(BfdSessionTest, InvalidPackets) {
+  BfdSession session(1, kInterval, 3);
+  auto packet = session.nextPacket();
+  EXPECT_TRUE(packet.isValid());
+
+  auto noDiscriminator = packet;
+  noDiscriminator.myDiscriminator = 0;
+  EXPECT_FALSE(noDiscriminator.isValid());
+
+  auto noMultiplier = packet;
+  noMultiplier.detectMultiplier = 0;
+  EXPECT_FALSE(noMultiplier.isValid());
+
+  auto upWithoutPeer = packet;
+  upWithoutPeer.state = State::UP;
+  EXPECT_FALSE(upWithoutPeer.isValid());
+
+  auto authenticated = packet;
+  authenticated.authPresent = true;
+  EXPECT_FALSE(authenticated.isValid());
+
+  auto buf = folly::IOBuf::create(BfdControlPacket::LENGTH - 1);
+  buf->append(BfdControlPacket::LENGTH - 1);
+  folly::io::Cursor reader(buf.get());
+  EXPECT_ANY_THROW(BfdControlPacket::from(&reader));
+}
+
+TEST(BfdSessionTest, ThreeWayHandshake) {
+  auto now = BfdSession::Clock::now();
+  BfdSession a(1, kInterval, 3);
+  BfdSession b(2, kInterval, 3);
+
+  EXPECT_TRUE(b.received(a.nextPacket(), now));
+  EXPECT_EQ(State::INIT, b.getState());
+  EXPECT_TRUE(a.received(b.nextPacket(), now));
+  EXPECT_EQ(State::UP, a.getState());
+  EXPECT_TRUE(b.received(a.nextPacket(), now));
+  EXPECT_EQ(State::UP, b.getState());
+
+  // Slow until up, then at the configured interval
+  EXPECT_EQ(kInterval, a.txInterval());
+  EXPECT_EQ(kInterval, b.txInterval());
+}
+
+TEST(BfdSessionTest, SlowBeforeUp) {
+  BfdSession session(1, kInterval, 3);
+  EXPECT_EQ(microseconds(1000000), session.txInterval());
+  EXPECT_EQ(microseconds(1000000), session.nextPacket().desiredMinTxInterval);
+  EXPECT_FALSE(session.detectionDeadline());
+}
+
+TEST(BfdSessionTest, PollAnsweredWithFinal) {
+  auto now = BfdSession::Clock::now();
+  BfdSession a(1, kInterval, 3);
+  BfdSession b(2, kInterval, 3);
+  b.received(a.nextPacket(), now);
+  a.received(b.nextPacket(), now);
+  ASSERT_EQ(State::UP, a.getState());
+
+  // a came up and polls for the faster rate
+  auto poll = a.nextPacket();
+  EXPECT_TRUE(poll.poll);
+  b.received(poll, now);
+  EXPECT_TRUE(b.finalPending());
+  auto final = b.nextPacket();
+  EXPECT_TRUE(final.final);
+  EXPECT_FALSE(final.poll);
+  EXPECT_FALSE(b.finalPending());
+
+  a.received(final, now);
+  EXPECT_FALSE(a.nextPacket().poll);
+}
+
+TEST(BfdSessionTest, DetectionTimeExpires) {
+  auto now = BfdSession::Clock::now();
+  BfdSession a(1, kInterval, 3);
+  BfdSession b(2, kInterval, 3);
+  converge(a, b, now);
+  ASSERT_EQ(State::UP, a.getState());
+
+  auto deadline = a.detectionDeadline();
+  ASSERT_TRUE(deadline);
+  EXPECT_EQ(now + 3 * kInterval, *deadline);
+
+  EXPECT_FALSE(a.checkDetectionTime(*deadline - milliseconds(1)));
+  EXPECT_TRUE(a.checkDetectionTime(*deadline));
+  EXPECT_EQ(State::DOWN, a.getState());
+
+  auto packet = a.nextPacket();
+  EXPECT_EQ(BfdControlPacket::Diag::DETECTION_TIME_EXPIRED, packet.diag);
+  EXPECT_EQ(0, packet.yourDiscriminator);
+
+  // The peer follows it down
+  EXPECT_TRUE(b.received(packet, now));
+  EXPECT_EQ(State::DOWN, b.getState());
+}
+
+TEST(BfdSessionTest, IgnoresOtherDiscriminator) {
+  auto now = BfdSession::Clock::now();
+  BfdSession a(1, kInterval, 3);
+  auto packet = BfdSession(2, kInterval, 3).nextPacket();
+  packet.yourDiscriminator = 7;
+  EXPECT_FALSE(a.received(packet, now));
+  EXPECT_EQ(State::DOWN, a.getState());
+}
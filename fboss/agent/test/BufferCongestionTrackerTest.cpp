@@ -0,0 +1,77 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/hw/BufferCongestionTracker.h"
+
+#include <folly/Conv.h>
+#include <gtest/gtest.h>
+
+using namespace facebook::fboss;
+
+namespace {
+constexpr auto kEgress = BufferCongestionTracker::Direction::Egress;
+constexpr auto kIngress = BufferCongestionTracker::Direction::Ingress;
+} // namespace
+
+TEST(BufferCongestionTracker, CrossThreshold) {
+  BufferCongestionTracker tracker(1000, 10);
+  EXPECT_FALSE(tracker.update("eth1/1/1", kEgress, 0, 999));
+  EXPECT_TRUE(tracker.getEvents().empty());
+  EXPECT_FALSE(tracker.anyCongested());
+
+  EXPECT_TRUE(tracker.update("eth1/1/1", kEgress, 0, 1200));
+  EXPECT_TRUE(tracker.anyCongested());
+  // Staying above half the threshold is still the same congestion
+  EXPECT_TRUE(tracker.update("eth1/1/1", kEgress, 0, 3000));
+  EXPECT_TRUE(tracker.update("eth1/1/1", kEgress, 0, 600));
+  EXPECT_EQ(1, tracker.getEvents().size());
+
+  EXPECT_FALSE(tracker.update("eth1/1/1", kEgress, 0, 400));
+  EXPECT_FALSE(tracker.anyCongested());
+
+  auto events = tracker.getEvents();
+  ASSERT_EQ(2, events.size());
+  EXPECT_FALSE(events[0].cleared);
+  EXPECT_EQ("eth1/1/1", events[0].portName);
+  EXPECT_FALSE(events[0].ingress);
+  EXPECT_EQ(0, events[0].queue);
+  EXPECT_EQ(1200, events[0].bytesUsed);
+  EXPECT_EQ(1000, events[0].thresholdBytes);
+  EXPECT_TRUE(events[1].cleared);
+  EXPECT_EQ(400, events[1].bytesUsed);
+  EXPECT_EQ(3000, events[1].peakBytesUsed);
+}
+
+TEST(BufferCongestionTracker, QueuesAreIndependent) {
+  BufferCongestionTracker tracker(1000, 10);
+  tracker.update("eth1/1/1", kEgress, 0, 2000);
+  tracker.update("eth1/1/1", kEgress, 1, 2000);
+  tracker.update("eth1/1/1", kIngress, 0, 2000);
+  tracker.update("eth1/2/1", kEgress, 0, 2000);
+  EXPECT_EQ(4, tracker.getEvents().size());
+
+  tracker.update("eth1/1/1", kEgress, 0, 0);
+  tracker.update("eth1/1/1", kEgress, 1, 0);
+  tracker.update("eth1/1/1", kIngress, 0, 0);
+  EXPECT_TRUE(tracker.anyCongested());
+  tracker.update("eth1/2/1", kEgress, 0, 0);
+  EXPECT_FALSE(tracker.anyCongested());
+  EXPECT_EQ(8, tracker.getEvents().size());
+}
+
+TEST(BufferCongestionTracker, KeepsRecentEvents) {
+  BufferCongestionTracker tracker(1000, 3);
+  for (int i = 0; i < 5; ++i) {
+    tracker.update(folly::to<std::string>("eth1/", i, "/1"), kEgress, 0, 1000);
+  }
+  auto events = tracker.getEvents();
+  ASSERT_EQ(3, events.size());
+  EXPECT_EQ("eth1/2/1", events[0].portName);
+  EXPECT_EQ("eth1/4/1", events[2].portName);
+}
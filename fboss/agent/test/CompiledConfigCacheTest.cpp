@@ -0,0 +1,70 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/CompiledConfigCache.h"
+
+#include "fboss/agent/AgentConfig.h"
+#include "fboss/agent/state/SwitchState.h"
+#include "fboss/agent/test/TestUtils.h"
+
+#include <folly/experimental/TestUtil.h>
+#include <gtest/gtest.h>
+
+using namespace facebook::fboss;
+using std::chrono::seconds;
+
+namespace {
+
+AgentConfig makeConfig(const std::string& raw) {
+  cfg::AgentConfig thrift;
+  thrift.sw.defaultVlan = 1;
+  return AgentConfig(std::move(thrift), raw);
+}
+
+} // namespace
+
+TEST(CompiledConfigCache, Config) {
+  folly::test::TemporaryDirectory dir;
+  CompiledConfigCache cache(dir.path().string());
+  EXPECT_EQ(nullptr, cache.loadConfig("config"));
+
+  cache.storeConfig(makeConfig("config"));
+  auto loaded = cache.loadConfig("config");
+  ASSERT_NE(nullptr, loaded);
+  EXPECT_EQ(makeConfig("config").thrift, loaded->thrift);
+  EXPECT_EQ("config", loaded->raw);
+
+  EXPECT_EQ(nullptr, cache.loadConfig("changed config"));
+}
+
+TEST(CompiledConfigCache, State) {
+  folly::test::TemporaryDirectory dir;
+  CompiledConfigCache cache(dir.path().string());
+  auto config = makeConfig("config");
+  auto bootState = std::make_shared<SwitchState>();
+  bootState->publish();
+  auto state = testStateA();
+  state->setArpTimeout(seconds(42));
+  state->setMaxNeighborProbes(7);
+  state->setDhcpV4RelaySrc(folly::IPAddressV4("10.0.0.1"));
+  EXPECT_EQ(nullptr, cache.loadState(config, *bootState));
+
+  cache.storeState(config, *bootState, *state);
+  auto loaded = cache.loadState(config, *bootState);
+  ASSERT_NE(nullptr, loaded);
+  EXPECT_EQ(state->toFollyDynamic(), loaded->toFollyDynamic());
+  EXPECT_EQ(seconds(42), loaded->getArpTimeout());
+  EXPECT_EQ(7, loaded->getMaxNeighborProbes());
+  EXPECT_EQ(folly::IPAddressV4("10.0.0.1"), loaded->getDhcpV4RelaySrc());
+  EXPECT_EQ(bootState->getGeneration() + 1, loaded->getGeneration());
+
+  // Neither a different config nor a different boot state may use it
+  EXPECT_EQ(nullptr, cache.loadState(makeConfig("other"), *bootState));
+  EXPECT_EQ(nullptr, cache.loadState(config, *testStateB()));
+}
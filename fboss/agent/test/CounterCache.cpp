@@ -11,6 +11,7 @@
 
 #include "common/stats/ServiceData.h"
 #include "common/stats/ThreadCachedServiceData.h"
+#include "fboss/agent/CounterRegistry.h"
 #include "fboss/agent/SwSwitch.h"
 
 namespace facebook { namespace fboss {
@@ -20,6 +21,7 @@ void CounterCache::update() {
   prev_.swap(current_);
   current_.clear();
   fbData->getCounters(current_);
+  CounterRegistry::get()->getCounters(current_);
 }
 
 }} // facebook::fboss
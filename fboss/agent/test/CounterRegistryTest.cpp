@@ -0,0 +1,165 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/CounterRegistry.h"
+
+#include <folly/Conv.h>
+#include <gtest/gtest.h>
+
+using namespace facebook::fboss;
+
+TEST(CounterRegistry, SetAndExport) {
+  CounterRegistry registry;
+  auto up = registry.acquire("eth1/1/1.up");
+  auto flaps = registry.acquire("eth1/1/1.flaps");
+  EXPECT_NE(up, flaps);
+  EXPECT_EQ(2, registry.size());
+
+  std::map<std::string, int64_t> counters;
+  registry.getCounters(counters);
+  // Counters without a value are not exported
+  EXPECT_TRUE(counters.empty());
+
+  registry.setValue(up, 1);
+  registry.incrementValue(flaps);
+  registry.incrementValue(flaps, 2);
+  registry.getCounters(counters);
+  EXPECT_EQ(2, counters.size());
+  EXPECT_EQ(1, counters["eth1/1/1.up"]);
+  EXPECT_EQ(3, counters["eth1/1/1.flaps"]);
+
+  registry.clearValue(up);
+  counters.clear();
+  registry.getCounters(counters);
+  EXPECT_EQ(0, counters.count("eth1/1/1.up"));
+  EXPECT_EQ(1, counters.count("eth1/1/1.flaps"));
+}
+
+TEST(CounterRegistry, AcquireRelease) {
+  CounterRegistry registry;
+  auto first = registry.acquire("port1.up");
+  auto second = registry.acquire("port1.up");
+  EXPECT_EQ(first, second);
+  registry.setValue(first, 1);
+
+  // Still registered until every acquire() is released
+  registry.release(first);
+  EXPECT_EQ(1, registry.size());
+  EXPECT_EQ(1, registry.getValue(second));
+
+  registry.release(second);
+  EXPECT_EQ(0, registry.size());
+  std::map<std::string, int64_t> counters;
+  registry.getCounters(counters);
+  EXPECT_TRUE(counters.empty());
+  EXPECT_ANY_THROW(registry.release(second));
+
+  // Released handles are reused, starting out with no value
+  auto other = registry.acquire("port2.up");
+  EXPECT_EQ(first, other);
+  EXPECT_EQ(0, registry.getValue(other));
+}
+
+TEST(CounterRegistry, ManyCounters) {
+  // Enough counters to need more than one chunk of slots
+  CounterRegistry registry;
+  std::vector<CounterRegistry::Handle> handles;
+  for (int i = 0; i < 3000; ++i) {
+    handles.push_back(registry.acquire(folly::to<std::string>("c", i)));
+    registry.setValue(handles.back(), i);
+  }
+  for (int i = 0; i < 3000; ++i) {
+    EXPECT_EQ(i, registry.getValue(handles[i]));
+  }
+  std::map<std::string, int64_t> counters;
+  registry.getCounters(counters);
+  EXPECT_EQ(3000, counters.size());
+  EXPECT_EQ(2999, counters["c2999"]);
+}
+
+TEST(CounterRegistry, AcquireAll) {
+  CounterRegistry registry;
+  auto existing = registry.acquire("port1.flaps");
+  std::vector<std::string> names = {"port1.up", "port1.flaps", "port1.up"};
+  auto handles = registry.acquireAll(names);
+  ASSERT_EQ(3, handles.size());
+  EXPECT_NE(handles[0], handles[1]);
+  EXPECT_EQ(existing, handles[1]);
+  EXPECT_EQ(handles[0], handles[2]);
+  EXPECT_EQ(2, registry.size());
+
+  registry.releaseAll(handles);
+  // Only the counter acquired on its own is left
+  EXPECT_EQ(1, registry.size());
+  registry.release(existing);
+  EXPECT_EQ(0, registry.size());
+}
+
+TEST(CounterRegistry, Query) {
+  CounterRegistry registry;
+  for (auto name :
+       {"eth1/1/1.in_bytes",
+        "eth1/1/1.queue3.out_bytes",
+        "eth1/1/2.in_bytes",
+        "eth1/1/2.queue3.out_bytes",
+        "eth1/1/20.in_bytes",
+        "eth1/1/3.in_bytes"}) {
+    registry.setValue(registry.acquire(name), 1);
+  }
+  // Never set, so never returned
+  registry.acquire("eth1/1/2.flaps");
+
+  auto names = [&](const CounterRegistry::Query& query) {
+    std::vector<std::string> found;
+    for (const auto& counter : registry.query(query)) {
+      found.push_back(counter.first);
+    }
+    return found;
+  };
+  using Names = std::vector<std::string>;
+
+  CounterRegistry::Query query;
+  query.keys = {"eth1/1/1.in_bytes", "eth1/1/2.flaps", "missing"};
+  EXPECT_EQ(Names({"eth1/1/1.in_bytes"}), names(query));
+
+  query = CounterRegistry::Query();
+  query.prefixes = {"eth1/1/2."};
+  EXPECT_EQ(
+      Names({"eth1/1/2.in_bytes", "eth1/1/2.queue3.out_bytes"}), names(query));
+
+  query = CounterRegistry::Query();
+  query.components = {"queue3"};
+  EXPECT_EQ(
+      Names({"eth1/1/1.queue3.out_bytes", "eth1/1/2.queue3.out_bytes"}),
+      names(query));
+
+  // Criteria are combined, without repeating counters
+  query = CounterRegistry::Query();
+  query.prefixes = {"eth1/1/3."};
+  query.regexes = {"eth1/1/[13]\\.in_bytes"};
+  EXPECT_EQ(Names({"eth1/1/1.in_bytes", "eth1/1/3.in_bytes"}), names(query));
+
+  // The cached regex match sees counters added since
+  registry.setValue(registry.acquire("eth1/1/11.in_bytes"), 1);
+  query.regexes = {"eth1/1/1.?\\.in_bytes"};
+  EXPECT_EQ(
+      Names({"eth1/1/1.in_bytes", "eth1/1/11.in_bytes", "eth1/1/3.in_bytes"}),
+      names(query));
+
+  // Released counters leave the indexes
+  auto handle = registry.acquire("eth1/1/20.in_bytes");
+  registry.release(handle);
+  registry.release(handle);
+  query = CounterRegistry::Query();
+  query.components = {"eth1/1/20"};
+  EXPECT_TRUE(names(query).empty());
+
+  query.regexes = {"("};
+  EXPECT_ANY_THROW(registry.query(query));
+}
@@ -378,6 +378,8 @@ TEST(DHCPv4HandlerTest, DHCPRequest) {
   counters.update();
   counters.checkDelta(SwitchStats::kCounterPrefix + "dhcpV4.pkt.sum", 1);
   counters.checkDelta(SwitchStats::kCounterPrefix + "trapped.pkts.sum", 1);
+  counters.checkDelta(
+      SwitchStats::kCounterPrefix + "vlan.1.dhcpV4.relayed.sum", 1);
 }
 
 TEST(DHCPv4HandlerOverrideTest, DHCPRequest) {
@@ -478,6 +480,8 @@ TEST(DHCPv4HandlerTest, DHCPReply) {
   counters.update();
   counters.checkDelta(SwitchStats::kCounterPrefix + "dhcpV4.pkt.sum", 1);
   counters.checkDelta(SwitchStats::kCounterPrefix + "trapped.pkts.sum", 1);
+  counters.checkDelta(
+      SwitchStats::kCounterPrefix + "vlan.1.dhcpV4.relayed.sum", 1);
 }
 
 TEST(DHCPv4ReplySrcTest, DHCPReply) {
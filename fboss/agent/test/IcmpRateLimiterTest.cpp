@@ -0,0 +1,71 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/IcmpRateLimiter.h"
+
+#include <gflags/gflags.h>
+#include <gtest/gtest.h>
+
+DECLARE_int32(icmp_rate_limit_pps);
+DECLARE_int32(icmp_rate_limit_burst);
+
+using namespace facebook::fboss;
+using folly::IPAddress;
+
+namespace {
+
+class IcmpRateLimiterTest : public ::testing::Test {
+ public:
+  void SetUp() override {
+    FLAGS_icmp_rate_limit_pps = 10;
+    FLAGS_icmp_rate_limit_burst = 5;
+  }
+
+ private:
+  gflags::FlagSaver flagSaver_;
+};
+
+} // namespace
+
+TEST_F(IcmpRateLimiterTest, BurstThenRate) {
+  IcmpRateLimiter limiter;
+  auto type = IcmpRateLimiter::Type::V4_TTL_EXCEEDED;
+  IPAddress src("10.0.0.1");
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_TRUE(limiter.allow(type, src, 100.0));
+  }
+  EXPECT_FALSE(limiter.allow(type, src, 100.0));
+  // One token every 100ms
+  EXPECT_FALSE(limiter.allow(type, src, 100.05));
+  EXPECT_TRUE(limiter.allow(type, src, 100.1));
+  EXPECT_FALSE(limiter.allow(type, src, 100.1));
+}
+
+TEST_F(IcmpRateLimiterTest, PerTypeAndPrefix) {
+  IcmpRateLimiter limiter;
+  auto ttl = IcmpRateLimiter::Type::V6_HOP_LIMIT_EXCEEDED;
+  auto tooBig = IcmpRateLimiter::Type::V6_PACKET_TOO_BIG;
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_TRUE(limiter.allow(ttl, IPAddress("2401:db00::1"), 100.0));
+  }
+  // The rest of the /64 shares the bucket
+  EXPECT_FALSE(limiter.allow(ttl, IPAddress("2401:db00::2"), 100.0));
+  // Other types and prefixes have their own
+  EXPECT_TRUE(limiter.allow(tooBig, IPAddress("2401:db00::1"), 100.0));
+  EXPECT_TRUE(limiter.allow(ttl, IPAddress("2401:db00:0:1::1"), 100.0));
+}
+
+TEST_F(IcmpRateLimiterTest, Disabled) {
+  FLAGS_icmp_rate_limit_pps = 0;
+  IcmpRateLimiter limiter;
+  auto type = IcmpRateLimiter::Type::V4_TTL_EXCEEDED;
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_TRUE(limiter.allow(type, IPAddress("10.0.0.1"), 100.0));
+  }
+}
@@ -134,6 +134,24 @@ TEST(LldpManagerTest, LldpSend) {
   lldpManager.sendLldpOnAllPorts();
 }
 
+TEST(LldpManagerTest, LldpSendFromCachedFrames) {
+  auto handle = setupTestHandle();
+  auto sw = handle->getSw();
+
+  // The second round is served from the frames built by the first and must
+  // still carry complete LLDPDUs
+  EXPECT_HW_CALL(
+      sw,
+      sendPacketOutOfPortAsync_(
+          TxPacketMatcher::createMatcher("Lldp PDU", checkLldpPDU()),
+          _,
+          folly::Optional<uint8_t>(kNCStrictPriorityQueue)))
+      .Times(AtLeast(2));
+  LldpManager lldpManager(sw);
+  lldpManager.sendLldpOnAllPorts();
+  lldpManager.sendLldpOnAllPorts();
+}
+
 TEST(LldpManagerTest, LldpSendPeriodic) {
   auto handle = setupTestHandle();
   auto sw = handle->getSw();
@@ -30,7 +30,7 @@ class MockTunManager : public TunManager {
   MOCK_METHOD1(sendPacketToHost_, bool(
         std::tuple<InterfaceID, std::shared_ptr<RxPacket>>));
   bool sendPacketToHost(InterfaceID, std::unique_ptr<RxPacket> pkt) override;
-  MOCK_METHOD1(doProbe, void(std::lock_guard<std::mutex>&));
+  MOCK_METHOD1(doProbe, void(folly::SharedMutex::WriteHolder&));
 };
 
 }}  // namespace facebook::fboss
@@ -0,0 +1,305 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/StateObserver.h"
+#include "fboss/agent/SwSwitch.h"
+#include "fboss/agent/gen-cpp2/switch_config_types.h"
+#include "fboss/agent/state/ArpTable.h"
+#include "fboss/agent/state/NdpTable.h"
+#include "fboss/agent/state/StateDelta.h"
+#include "fboss/agent/state/VlanMapDelta.h"
+#include "fboss/agent/test/HwTestHandle.h"
+#include "fboss/agent/test/TestPacketFactory.h"
+#include "fboss/agent/test/TestUtils.h"
+
+#include <folly/Benchmark.h>
+#include <folly/Format.h>
+#include <folly/IPAddress.h>
+#include <folly/MacAddress.h>
+#include <folly/init/Init.h>
+#include <folly/stats/Histogram.h>
+#include <folly/synchronization/Baton.h>
+#include <gflags/gflags.h>
+#include <gmock/gmock.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+DEFINE_int32(
+    neighbor_vlans,
+    16,
+    "Number of vlans the neighbors are spread over, at most 255");
+DEFINE_int32(
+    neighbor_resolve_timeout_s,
+    120,
+    "How long to wait for all the neighbors of a storm to be resolved");
+
+using namespace facebook::fboss;
+using folly::IPAddress;
+using folly::IPAddressV4;
+using folly::IPAddressV6;
+using folly::MacAddress;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const MacAddress kSwitchMac("02:00:00:00:00:01");
+// Ports per vlan, so neighbors arrive on several ports of their vlan
+constexpr int kPortsPerVlan = 4;
+
+/*
+ * Vlan v (from 1) has interface v, with 10.v.0.1/16 and 2401:db00:0:v::1/64,
+ * and ports v, v + vlans, and so on.
+ */
+cfg::SwitchConfig makeConfig() {
+  cfg::SwitchConfig config;
+  auto numVlans = FLAGS_neighbor_vlans;
+  auto numPorts = numVlans * kPortsPerVlan;
+  config.ports.resize(numPorts);
+  config.vlanPorts.resize(numPorts);
+  for (int p = 0; p < numPorts; ++p) {
+    config.ports[p].logicalID = p + 1;
+    config.ports[p].name_ref().value_unchecked() =
+        folly::to<std::string>("port", p + 1);
+    config.vlanPorts[p].logicalPort = p + 1;
+    config.vlanPorts[p].vlanID = p % numVlans + 1;
+  }
+  config.vlans.resize(numVlans);
+  config.interfaces.resize(numVlans);
+  for (int v = 1; v <= numVlans; ++v) {
+    auto& vlan = config.vlans[v - 1];
+    vlan.id = v;
+    vlan.name = folly::to<std::string>("Vlan", v);
+    vlan.intfID_ref().value_unchecked() = v;
+    auto& intf = config.interfaces[v - 1];
+    intf.intfID = v;
+    intf.routerID = 0;
+    intf.vlanID = v;
+    intf.ipAddresses.resize(2);
+    intf.ipAddresses[0] = folly::sformat("10.{}.0.1/16", v);
+    intf.ipAddresses[1] = folly::sformat("2401:db00:0:{:x}::1/64", v);
+  }
+  return config;
+}
+
+// Neighbor i is on vlan i % vlans, and is host i / vlans + 2 of its subnet
+struct Neighbor {
+  VlanID vlan;
+  PortID port;
+  MacAddress mac;
+  IPAddress ip;
+};
+
+template <typename AddrT>
+Neighbor makeNeighbor(int i) {
+  auto numVlans = FLAGS_neighbor_vlans;
+  int v = i % numVlans + 1;
+  int host = i / numVlans + 2;
+  auto port = v + numVlans * ((i / numVlans) % kPortsPerVlan);
+  auto mac = MacAddress::fromHBO(0x020100000000 + i);
+  if (std::is_same<AddrT, IPAddressV4>::value) {
+    return {VlanID(v),
+            PortID(port),
+            mac,
+            IPAddressV4::fromLongHBO((10 << 24) + (v << 16) + host)};
+  }
+  return {VlanID(v),
+          PortID(port),
+          mac,
+          IPAddress(folly::sformat("2401:db00:0:{:x}::{:x}", v, host))};
+}
+
+folly::IOBuf makeFrame(const Neighbor& neighbor, const IPAddressV4& ip) {
+  auto vlan = static_cast<uint16_t>(neighbor.vlan);
+  return createArpReply(
+      ip,
+      neighbor.mac,
+      IPAddressV4::fromLongHBO((10 << 24) + (vlan << 16) + 1),
+      kSwitchMac,
+      neighbor.vlan);
+}
+
+folly::IOBuf makeFrame(const Neighbor& neighbor, const IPAddressV6& ip) {
+  auto vlan = static_cast<uint16_t>(neighbor.vlan);
+  return createNeighborAdvertisement(
+      ip,
+      neighbor.mac,
+      IPAddressV6(folly::sformat("2401:db00:0:{:x}::1", vlan)),
+      kSwitchMac,
+      neighbor.vlan);
+}
+
+/*
+ * Watches the state for the neighbors of a storm, and times each from when
+ * its frame was received to when its entry was published.
+ */
+template <typename NTable>
+class NeighborWatcher : public AutoRegisterStateObserver {
+ public:
+  NeighborWatcher(SwSwitch* sw, size_t numNeighbors)
+      : AutoRegisterStateObserver(sw, "NeighborBenchmark"),
+        rxTimes_(numNeighbors) {}
+
+  void expect(const IPAddress& ip, size_t index) {
+    indexes_.emplace(ip, index);
+  }
+  void received(size_t index) {
+    rxTimes_[index] = Clock::now();
+  }
+
+  void stateUpdated(const StateDelta& delta) override {
+    ++updates_;
+    auto now = Clock::now();
+    size_t resolved = 0;
+    for (const auto& vlanDelta : delta.getVlansDelta()) {
+      for (const auto& entryDelta :
+           vlanDelta.template getNeighborDelta<NTable>()) {
+        const auto& entry = entryDelta.getNew();
+        if (!entry || entry->isPending() || entryDelta.getOld()) {
+          continue;
+        }
+        auto index = indexes_.find(IPAddress(entry->getIP()));
+        if (index == indexes_.end()) {
+          continue;
+        }
+        latencyUs_.addValue(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                now - rxTimes_[index->second])
+                .count());
+        ++resolved;
+      }
+    }
+    if (resolved && (resolved_ += resolved) == indexes_.size()) {
+      done_.post();
+    }
+  }
+
+  bool wait() {
+    return done_.try_wait_for(
+        std::chrono::seconds(FLAGS_neighbor_resolve_timeout_s));
+  }
+  size_t updates() const {
+    return updates_;
+  }
+  const folly::Histogram<int64_t>& latencyUs() const {
+    return latencyUs_;
+  }
+
+ private:
+  std::unordered_map<IPAddress, size_t> indexes_;
+  std::vector<Clock::time_point> rxTimes_;
+  std::atomic<size_t> updates_{0};
+  std::atomic<size_t> resolved_{0};
+  // 1ms buckets up to a minute
+  folly::Histogram<int64_t> latencyUs_{1000, 0, 60 * 1000 * 1000};
+  folly::Baton<> done_;
+};
+
+struct StormStats {
+  size_t storms{0};
+  size_t neighbors{0};
+  size_t updates{0};
+  folly::Histogram<int64_t> latencyUs{1000, 0, 60 * 1000 * 1000};
+};
+
+std::map<std::string, StormStats>& stormStats() {
+  static auto* stats = new std::map<std::string, StormStats>();
+  return *stats;
+}
+
+/*
+ * Receive an ARP reply or a neighbor advertisement from each of numNeighbors
+ * new neighbors, and wait for all of them to be in the state. Reported per
+ * neighbor, so iters/s is neighbors resolved per second.
+ */
+template <typename NTable>
+unsigned neighborStorm(const std::string& name, size_t numNeighbors) {
+  using AddrT = typename NTable::AddressType;
+  folly::BenchmarkSuspender suspender;
+  auto config = makeConfig();
+  auto handle = createTestHandle(&config);
+  auto sw = handle->getSw();
+  sw->initialConfigApplied(Clock::now());
+
+  std::vector<Neighbor> neighbors;
+  std::vector<std::unique_ptr<folly::IOBuf>> frames;
+  neighbors.reserve(numNeighbors);
+  frames.reserve(numNeighbors);
+  auto watcher = std::make_unique<NeighborWatcher<NTable>>(sw, numNeighbors);
+  for (size_t i = 0; i < numNeighbors; ++i) {
+    neighbors.push_back(makeNeighbor<AddrT>(i));
+    const auto& neighbor = neighbors.back();
+    frames.push_back(std::make_unique<folly::IOBuf>(
+        makeFrame(neighbor, AddrT(neighbor.ip.str()))));
+    watcher->expect(neighbor.ip, i);
+  }
+  suspender.dismiss();
+
+  for (size_t i = 0; i < numNeighbors; ++i) {
+    watcher->received(i);
+    handle->rxPacket(
+        std::move(frames[i]), neighbors[i].port, neighbors[i].vlan);
+  }
+  CHECK(watcher->wait()) << "Timed out resolving " << numNeighbors
+                         << " neighbors";
+
+  suspender.rehire();
+  auto& stats = stormStats()[folly::to<std::string>(name, "_", numNeighbors)];
+  ++stats.storms;
+  stats.neighbors += numNeighbors;
+  stats.updates += watcher->updates();
+  stats.latencyUs.merge(watcher->latencyUs());
+  watcher.reset();
+  handle.reset();
+  return numNeighbors;
+}
+
+unsigned arpStorm(size_t numNeighbors) {
+  return neighborStorm<ArpTable>("arpStorm", numNeighbors);
+}
+
+unsigned ndpStorm(size_t numNeighbors) {
+  return neighborStorm<NdpTable>("ndpStorm", numNeighbors);
+}
+
+} // namespace
+
+BENCHMARK_NAMED_PARAM_MULTI(arpStorm, 10k, 10000)
+BENCHMARK_NAMED_PARAM_MULTI(arpStorm, 100k, 100000)
+BENCHMARK_DRAW_LINE();
+BENCHMARK_NAMED_PARAM_MULTI(ndpStorm, 10k, 10000)
+BENCHMARK_NAMED_PARAM_MULTI(ndpStorm, 100k, 100000)
+
+int main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  CHECK(FLAGS_neighbor_vlans > 0 && FLAGS_neighbor_vlans <= 255);
+  // MockHwSwitch calls we don't set expectations for are expected here
+  testing::GMOCK_FLAG(verbose) = "error";
+  folly::runBenchmarks();
+
+  std::cout << "\nNeighbor storms (benchmark: neighbors per state update, "
+            << "p50/p99 resolution latency in ms)\n";
+  for (const auto& entry : stormStats()) {
+    const auto& stats = entry.second;
+    std::cout << entry.first << ": "
+              << stats.neighbors / std::max<size_t>(stats.updates, 1) << ", "
+              << stats.latencyUs.getPercentileEstimate(0.5) / 1000 << "/"
+              << stats.latencyUs.getPercentileEstimate(0.99) / 1000 << "\n";
+  }
+  return 0;
+}
@@ -0,0 +1,68 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+#include <gflags/gflags.h>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "fboss/agent/NeighborHitScanner.h"
+#include "fboss/agent/hw/mock/MockHwSwitch.h"
+#include "fboss/agent/test/HwTestHandle.h"
+#include "fboss/agent/test/TestUtils.h"
+
+using namespace facebook::fboss;
+using folly::IPAddress;
+using std::chrono::hours;
+
+DECLARE_int32(neighbor_hit_scan_interval_s);
+
+namespace {
+// The scanner the SwSwitch runs itself would race with the one under test
+std::unique_ptr<HwTestHandle> createHandleWithoutScanner() {
+  gflags::FlagSaver flagSaver;
+  FLAGS_neighbor_hit_scan_interval_s = 0;
+  return createTestHandle();
+}
+} // namespace
+
+TEST(NeighborHitScanner, answersFromLastScan) {
+  auto handle = createHandleWithoutScanner();
+  auto sw = handle->getSw();
+  NeighborHitScanner scanner(sw, hours(1));
+
+  const IPAddress hitIP("10.0.0.10");
+  const IPAddress idleIP("2401:db00::10");
+  EXPECT_FALSE(scanner.isHit(RouterID(0), hitIP).hasValue());
+
+  NeighborHits hits{{RouterID(0), hitIP}};
+  EXPECT_HW_CALL(sw, getAndClearNeighborHits())
+      .WillOnce(testing::Return(folly::make_optional(hits)))
+      .WillOnce(testing::Return(folly::make_optional(NeighborHits())));
+
+  scanner.scan();
+  EXPECT_TRUE(scanner.isHit(RouterID(0), hitIP).value());
+  EXPECT_FALSE(scanner.isHit(RouterID(0), idleIP).value());
+  EXPECT_FALSE(scanner.isHit(RouterID(1), hitIP).value());
+
+  // Hit bits are cleared by each scan
+  scanner.scan();
+  EXPECT_FALSE(scanner.isHit(RouterID(0), hitIP).value());
+}
+
+TEST(NeighborHitScanner, unsupportedHw) {
+  auto handle = createHandleWithoutScanner();
+  auto sw = handle->getSw();
+  NeighborHitScanner scanner(sw, hours(1));
+
+  EXPECT_HW_CALL(sw, getAndClearNeighborHits())
+      .WillOnce(testing::Return(folly::none));
+  scanner.scan();
+  EXPECT_FALSE(scanner.isHit(RouterID(0), IPAddress("10.0.0.10")).hasValue());
+}
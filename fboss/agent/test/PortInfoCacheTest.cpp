@@ -0,0 +1,56 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include "fboss/agent/PortInfoCache.h"
+#include "fboss/agent/state/Port.h"
+#include "fboss/agent/state/PortMap.h"
+#include "fboss/agent/state/StateDelta.h"
+#include "fboss/agent/state/SwitchState.h"
+#include "fboss/agent/test/HwTestHandle.h"
+#include "fboss/agent/test/TestUtils.h"
+
+using namespace facebook::fboss;
+
+TEST(PortInfoCache, followsStateDeltas) {
+  auto handle = createTestHandle();
+  auto sw = handle->getSw();
+  PortInfoCache cache(sw);
+
+  auto initState = testStateA();
+  initState->publish();
+  cache.stateUpdated(StateDelta(std::make_shared<SwitchState>(), initState));
+  auto initial = cache.getSnapshot();
+  EXPECT_EQ(initState->getPorts()->size(), initial->size());
+  EXPECT_EQ("port1", initial->at(1).name);
+
+  // Only the changed port is rebuilt, and earlier snapshots are untouched
+  auto changedState = initState->clone();
+  auto port = changedState->getPorts()->getPort(PortID(1))->modify(
+      &changedState);
+  port->setDescription("uplink");
+  changedState->publish();
+  cache.stateUpdated(StateDelta(initState, changedState));
+  auto changed = cache.getSnapshot();
+  EXPECT_EQ("uplink", changed->at(1).description);
+  EXPECT_EQ("", initial->at(1).description);
+  EXPECT_EQ(initial->at(2), changed->at(2));
+
+  auto removedState = changedState->clone();
+  auto ports = removedState->getPorts()->modify(&removedState);
+  ports->removeNode(PortID(1));
+  cache.stateUpdated(StateDelta(changedState, removedState));
+  EXPECT_EQ(0, cache.getSnapshot()->count(1));
+  EXPECT_EQ(initial->size() - 1, cache.getSnapshot()->size());
+
+  cache.statsUpdated();
+  EXPECT_EQ(initial->size() - 1, cache.getSnapshot()->size());
+}
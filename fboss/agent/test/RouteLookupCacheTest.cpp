@@ -0,0 +1,63 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/RouteLookupCache.h"
+
+#include <gtest/gtest.h>
+
+using namespace facebook::fboss;
+using folly::IPAddressV4;
+
+namespace {
+std::shared_ptr<Route<IPAddressV4>> makeRoute(const std::string& network) {
+  RoutePrefixV4 prefix{IPAddressV4(network), 24};
+  return std::make_shared<Route<IPAddressV4>>(prefix);
+}
+} // namespace
+
+TEST(RouteLookupCache, HitsAndMisses) {
+  RouteLookupCache<IPAddressV4> cache;
+  auto state = std::make_shared<SwitchState>();
+  state->publish();
+  IPAddressV4 dest("10.0.0.1");
+  std::shared_ptr<Route<IPAddressV4>> route;
+
+  EXPECT_FALSE(cache.lookup(state, RouterID(0), dest, &route));
+  auto match = makeRoute("10.0.0.0");
+  cache.insert(state, RouterID(0), dest, match);
+  EXPECT_TRUE(cache.lookup(state, RouterID(0), dest, &route));
+  EXPECT_EQ(match, route);
+
+  // Other vrfs and addresses are not the same entry
+  EXPECT_FALSE(cache.lookup(state, RouterID(1), dest, &route));
+  EXPECT_FALSE(
+      cache.lookup(state, RouterID(0), IPAddressV4("10.0.0.2"), &route));
+
+  // No route is cached as well
+  IPAddressV4 unreachable("192.168.0.1");
+  cache.insert(state, RouterID(0), unreachable, nullptr);
+  route = match;
+  EXPECT_TRUE(cache.lookup(state, RouterID(0), unreachable, &route));
+  EXPECT_EQ(nullptr, route);
+}
+
+TEST(RouteLookupCache, NewStateEmptiesCache) {
+  RouteLookupCache<IPAddressV4> cache;
+  auto state = std::make_shared<SwitchState>();
+  state->publish();
+  IPAddressV4 dest("10.0.0.1");
+  std::shared_ptr<Route<IPAddressV4>> route;
+  cache.insert(state, RouterID(0), dest, makeRoute("10.0.0.0"));
+
+  auto newState = state->clone();
+  newState->publish();
+  EXPECT_FALSE(cache.lookup(newState, RouterID(0), dest, &route));
+  // Nor is the old state's entry back when looking in the old state again
+  EXPECT_FALSE(cache.lookup(state, RouterID(0), dest, &route));
+}
@@ -0,0 +1,234 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/AddressUtil.h"
+#include "fboss/agent/SwSwitch.h"
+#include "fboss/agent/ThriftHandler.h"
+#include "fboss/agent/test/HwTestHandle.h"
+#include "fboss/agent/test/TestUtils.h"
+
+#include <folly/Benchmark.h>
+#include <folly/Conv.h>
+#include <folly/FileUtil.h>
+#include <folly/Format.h>
+#include <folly/IPAddress.h>
+#include <folly/String.h>
+#include <folly/init/Init.h>
+#include <gflags/gflags.h>
+#include <gmock/gmock.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+DECLARE_int32(route_update_trace_sample_rate);
+DECLARE_int32(route_update_traces);
+
+DEFINE_int32(
+    benchmark_route_batch,
+    10000,
+    "Number of routes in each addUnicastRoutes() call");
+
+using namespace facebook::fboss;
+using facebook::network::toBinaryAddress;
+
+namespace {
+
+constexpr int16_t kClientId = 786;
+
+/*
+ * Where the time of the updates in one benchmark went, from the traces the
+ * ThriftHandler keeps of every update.
+ */
+struct StageTimes {
+  int64_t updates{0};
+  int64_t queueUsecs{0};
+  int64_t ribUsecs{0};
+  int64_t fibUsecs{0};
+  // Largest agent RSS with all the routes programmed
+  int64_t rssBytes{0};
+};
+
+std::map<std::string, StageTimes>& stageTimes() {
+  static auto* times = new std::map<std::string, StageTimes>();
+  return *times;
+}
+
+cfg::SwitchConfig makeConfig() {
+  cfg::SwitchConfig config;
+  config.vlans.resize(1);
+  config.vlans[0].id = 1;
+  config.interfaces.resize(1);
+  config.interfaces[0].intfID = 1;
+  config.interfaces[0].vlanID = 1;
+  config.interfaces[0].routerID = 0;
+  config.interfaces[0].__isset.mac = true;
+  config.interfaces[0].mac_ref().value_unchecked() = "00:02:00:00:00:01";
+  config.interfaces[0].ipAddresses.resize(1);
+  config.interfaces[0].ipAddresses[0] = "2401:db00:2110:3001::1/64";
+  return config;
+}
+
+// numRoutes /64s, each over two next hops on the interface subnet
+std::vector<UnicastRoute> makeRoutes(size_t numRoutes) {
+  std::vector<UnicastRoute> routes(numRoutes);
+  auto nextHop1 = toBinaryAddress(folly::IPAddress("2401:db00:2110:3001::2"));
+  auto nextHop2 = toBinaryAddress(folly::IPAddress("2401:db00:2110:3001::3"));
+  for (size_t i = 0; i < numRoutes; ++i) {
+    auto& route = routes[i];
+    route.dest.ip = toBinaryAddress(folly::IPAddress(
+        folly::sformat("2401:db00:{:x}:{:x}::", i >> 16, i & 0xffff)));
+    route.dest.prefixLength = 64;
+    route.nextHopAddrs.push_back(nextHop1);
+    route.nextHopAddrs.push_back(nextHop2);
+  }
+  return routes;
+}
+
+int64_t currentRssBytes() {
+  std::string statm;
+  std::vector<folly::StringPiece> pages;
+  if (!folly::readFile("/proc/self/statm", statm)) {
+    return 0;
+  }
+  folly::split(' ', statm, pages);
+  if (pages.size() < 2) {
+    return 0;
+  }
+  return folly::to<int64_t>(pages[1]) * sysconf(_SC_PAGESIZE);
+}
+
+void recordStageTimes(const std::string& name, ThriftHandler& handler) {
+  std::vector<RouteUpdateTrace> traces;
+  handler.getRouteUpdateTraces(traces);
+  auto& times = stageTimes()[name];
+  for (const auto& trace : traces) {
+    ++times.updates;
+    times.queueUsecs += trace.queueUsecs;
+    times.ribUsecs += trace.ribUsecs;
+    times.fibUsecs += trace.fibUsecs;
+  }
+  times.rssBytes = std::max(times.rssBytes, currentRssBytes());
+}
+
+/*
+ * Program numRoutes new prefixes into a switch that has none, through
+ * addUnicastRoutes() in batches or through one syncFib(). Reported per
+ * route, so iters/s is routes programmed per second.
+ */
+unsigned programRoutes(
+    const std::string& name,
+    SwitchFlags flags,
+    bool useSyncFib,
+    size_t numRoutes) {
+  folly::BenchmarkSuspender suspender;
+  auto config = makeConfig();
+  auto handle = createTestHandle(&config, flags);
+  auto sw = handle->getSw();
+  sw->initialConfigApplied(std::chrono::steady_clock::now());
+  sw->fibSynced();
+  auto handler = std::make_unique<ThriftHandler>(sw);
+  auto routes = makeRoutes(numRoutes);
+  std::vector<std::unique_ptr<std::vector<UnicastRoute>>> batches;
+  if (useSyncFib) {
+    batches.push_back(
+        std::make_unique<std::vector<UnicastRoute>>(std::move(routes)));
+  } else {
+    size_t batchSize = std::max(FLAGS_benchmark_route_batch, 1);
+    for (size_t start = 0; start < routes.size(); start += batchSize) {
+      auto end = std::min(start + batchSize, routes.size());
+      batches.push_back(std::make_unique<std::vector<UnicastRoute>>(
+          routes.begin() + start, routes.begin() + end));
+    }
+  }
+  suspender.dismiss();
+
+  for (auto& batch : batches) {
+    if (useSyncFib) {
+      handler->syncFib(kClientId, std::move(batch));
+    } else {
+      handler->addUnicastRoutes(kClientId, std::move(batch));
+    }
+  }
+
+  suspender.rehire();
+  recordStageTimes(folly::to<std::string>(name, "_", numRoutes), *handler);
+  // Tearing down a switch with a million routes is not what we measure
+  handler.reset();
+  handle.reset();
+  return numRoutes;
+}
+
+unsigned legacyAdd(size_t numRoutes) {
+  return programRoutes("legacyAdd", DEFAULT, false, numRoutes);
+}
+
+unsigned legacySyncFib(size_t numRoutes) {
+  return programRoutes("legacySyncFib", DEFAULT, true, numRoutes);
+}
+
+unsigned ribAdd(size_t numRoutes) {
+  return programRoutes("ribAdd", ENABLE_STANDALONE_RIB, false, numRoutes);
+}
+
+unsigned ribSyncFib(size_t numRoutes) {
+  return programRoutes("ribSyncFib", ENABLE_STANDALONE_RIB, true, numRoutes);
+}
+
+} // namespace
+
+BENCHMARK_NAMED_PARAM_MULTI(legacyAdd, 10k, 10000)
+BENCHMARK_NAMED_PARAM_MULTI(legacyAdd, 100k, 100000)
+BENCHMARK_NAMED_PARAM_MULTI(legacyAdd, 1m, 1000000)
+BENCHMARK_DRAW_LINE();
+BENCHMARK_NAMED_PARAM_MULTI(ribAdd, 10k, 10000)
+BENCHMARK_NAMED_PARAM_MULTI(ribAdd, 100k, 100000)
+BENCHMARK_NAMED_PARAM_MULTI(ribAdd, 1m, 1000000)
+BENCHMARK_DRAW_LINE();
+BENCHMARK_NAMED_PARAM_MULTI(legacySyncFib, 10k, 10000)
+BENCHMARK_NAMED_PARAM_MULTI(legacySyncFib, 100k, 100000)
+BENCHMARK_NAMED_PARAM_MULTI(legacySyncFib, 1m, 1000000)
+BENCHMARK_DRAW_LINE();
+BENCHMARK_NAMED_PARAM_MULTI(ribSyncFib, 10k, 10000)
+BENCHMARK_NAMED_PARAM_MULTI(ribSyncFib, 100k, 100000)
+BENCHMARK_NAMED_PARAM_MULTI(ribSyncFib, 1m, 1000000)
+
+int main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  // Trace every update, and keep the traces of a whole benchmark run
+  FLAGS_route_update_trace_sample_rate = 1;
+  FLAGS_route_update_traces = std::max(FLAGS_route_update_traces, 1000);
+  // MockHwSwitch calls we don't set expectations for are expected here
+  testing::GMOCK_FLAG(verbose) = "error";
+  folly::runBenchmarks();
+
+  std::cout << "\nRoute update stages (benchmark: updates, average "
+            << "queue/rib/fib in us)\n";
+  for (const auto& entry : stageTimes()) {
+    const auto& times = entry.second;
+    if (times.updates == 0) {
+      continue;
+    }
+    std::cout << entry.first << ": " << times.updates << ", "
+              << times.queueUsecs / times.updates << "/"
+              << times.ribUsecs / times.updates << "/"
+              << times.fibUsecs / times.updates << "\n";
+  }
+
+  std::cout << "\nAgent RSS with the routes programmed (benchmark: MB)\n";
+  for (const auto& entry : stageTimes()) {
+    std::cout << entry.first << ": " << entry.second.rssBytes / (1 << 20)
+              << "\n";
+  }
+  return 0;
+}
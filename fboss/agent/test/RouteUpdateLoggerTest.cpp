@@ -16,6 +16,7 @@
 #include "fboss/agent/test/TestUtils.h"
 #include "fboss/agent/test/HwTestHandle.h"
 #include <folly/IPAddress.h>
+#include <folly/synchronization/Baton.h>
 
 #include <gtest/gtest.h>
 #include <memory>
@@ -52,6 +53,35 @@ class MockRouteLogger : public RouteLogger<AddrT> {
   std::vector<std::pair<std::string, std::string>> changed;
 };
 
+// Holds up the first log until released
+class BlockingRouteLogger : public MockRouteLogger<folly::IPAddressV4> {
+ public:
+  void logAddedRoute(
+      const std::shared_ptr<Route<folly::IPAddressV4>>& newRoute,
+      const std::vector<std::string>& identifiers) override {
+    block();
+    MockRouteLogger::logAddedRoute(newRoute, identifiers);
+  }
+
+  void logChangedRoute(
+      const std::shared_ptr<Route<folly::IPAddressV4>>& oldRoute,
+      const std::shared_ptr<Route<folly::IPAddressV4>>& newRoute,
+      const std::vector<std::string>& identifiers) override {
+    block();
+    MockRouteLogger::logChangedRoute(oldRoute, newRoute, identifiers);
+  }
+
+  void block() {
+    if (!blocked.ready()) {
+      blocked.post();
+      release.wait();
+    }
+  }
+
+  folly::Baton<> blocked;
+  folly::Baton<> release;
+};
+
 class RouteUpdateLoggerTest : public ::testing::Test {
  public:
   void SetUp() override {
@@ -336,4 +366,41 @@ TEST_F(RouteUpdateLoggerTest, ClearForOneUser) {
   EXPECT_EQ(4, mockRouteLoggerV6->added.size());
 }
 
+// With a logging thread, matched routes are logged off the update thread
+TEST_F(RouteUpdateLoggerTest, LogAsync) {
+  auto v4 = std::make_unique<MockRouteLogger<folly::IPAddressV4>>();
+  auto v6 = std::make_unique<MockRouteLogger<folly::IPAddressV6>>();
+  auto v4Logger = v4.get();
+  auto v6Logger = v6.get();
+  RouteUpdateLogger logger(sw, std::move(v4), std::move(v6), 100);
+  logger.startLoggingForPrefix(RouteUpdateLoggingInstance(
+      {folly::IPAddress("0.0.0.0"), 0}, user, false));
+  logger.startLoggingForPrefix(RouteUpdateLoggingInstance(
+      {folly::IPAddress("::"), 0}, user, false));
+  logger.stateUpdated(*deltaAdd);
+  logger.flush();
+  EXPECT_EQ(5, v4Logger->added.size());
+  EXPECT_EQ(3, v6Logger->added.size());
+  EXPECT_EQ(1, v4Logger->changed.size());
+  EXPECT_EQ(1, v6Logger->changed.size());
+}
+
+// Logs beyond the queue limit are dropped rather than held
+TEST_F(RouteUpdateLoggerTest, LogAsyncQueueFull) {
+  auto v4 = std::make_unique<BlockingRouteLogger>();
+  auto v4Logger = v4.get();
+  RouteUpdateLogger logger(
+      sw,
+      std::move(v4),
+      std::make_unique<MockRouteLogger<folly::IPAddressV6>>(),
+      1);
+  logger.startLoggingForPrefix(RouteUpdateLoggingInstance(
+      {folly::IPAddress("0.0.0.0"), 0}, user, false));
+  logger.stateUpdated(*deltaAdd);
+  v4Logger->blocked.wait();
+  v4Logger->release.post();
+  logger.flush();
+  EXPECT_EQ(1, v4Logger->added.size() + v4Logger->changed.size());
+}
+
 }
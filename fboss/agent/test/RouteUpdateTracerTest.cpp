@@ -0,0 +1,76 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/RouteUpdateTracer.h"
+
+#include <gtest/gtest.h>
+
+using namespace facebook::fboss;
+
+namespace {
+RouteUpdateTracer::Update makeUpdate(ClientID client, uint32_t added) {
+  RouteUpdateTracer::Update update;
+  update.client = client;
+  update.updateType = "addUnicastRoutes";
+  update.routesAdded = added;
+  update.queue = std::chrono::microseconds(10);
+  update.rib = std::chrono::microseconds(20);
+  update.fib = std::chrono::microseconds(30);
+  return update;
+}
+} // namespace
+
+TEST(RouteUpdateTracer, Traces) {
+  RouteUpdateTracer tracer(1, 10);
+  EXPECT_TRUE(tracer.getTraces().empty());
+
+  std::chrono::system_clock::time_point now(std::chrono::seconds(5));
+  tracer.record(makeUpdate(ClientID(786), 3), now);
+  auto traces = tracer.getTraces();
+  ASSERT_EQ(1, traces.size());
+  EXPECT_EQ(5000, traces[0].timestampMsecs);
+  EXPECT_EQ(786, traces[0].clientId);
+  EXPECT_EQ("addUnicastRoutes", traces[0].updateType);
+  EXPECT_EQ(3, traces[0].routesAdded);
+  EXPECT_EQ(0, traces[0].routesDeleted);
+  EXPECT_EQ(10, traces[0].queueUsecs);
+  EXPECT_EQ(20, traces[0].ribUsecs);
+  EXPECT_EQ(30, traces[0].fibUsecs);
+}
+
+TEST(RouteUpdateTracer, Sampling) {
+  RouteUpdateTracer tracer(3, 10);
+  for (uint32_t i = 0; i < 7; ++i) {
+    tracer.record(makeUpdate(ClientID(0), i));
+  }
+  auto traces = tracer.getTraces();
+  ASSERT_EQ(3, traces.size());
+  EXPECT_EQ(0, traces[0].routesAdded);
+  EXPECT_EQ(3, traces[1].routesAdded);
+  EXPECT_EQ(6, traces[2].routesAdded);
+}
+
+TEST(RouteUpdateTracer, KeepsMostRecent) {
+  RouteUpdateTracer tracer(1, 2);
+  for (uint32_t i = 0; i < 5; ++i) {
+    tracer.record(makeUpdate(ClientID(i % 2 ? 0 : 786), i));
+  }
+  auto traces = tracer.getTraces();
+  ASSERT_EQ(2, traces.size());
+  EXPECT_EQ(3, traces[0].routesAdded);
+  EXPECT_EQ(0, traces[0].clientId);
+  EXPECT_EQ(4, traces[1].routesAdded);
+  EXPECT_EQ(786, traces[1].clientId);
+}
+
+TEST(RouteUpdateTracer, HistogramNames) {
+  EXPECT_EQ(
+      "route_update.client.786.queue.us",
+      RouteUpdateTracer::histogramName(ClientID(786), "queue.us"));
+}
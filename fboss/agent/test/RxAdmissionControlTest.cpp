@@ -0,0 +1,144 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/RxAdmissionControl.h"
+
+#include "fboss/agent/packet/PktUtil.h"
+
+#include <gflags/gflags.h>
+#include <gtest/gtest.h>
+
+DECLARE_int32(rx_admission_pps);
+DECLARE_int32(rx_admission_burst);
+DECLARE_int32(rx_admission_control_pps);
+DECLARE_int32(rx_admission_control_burst);
+
+using namespace facebook::fboss;
+using folly::IPAddress;
+using folly::io::Cursor;
+using Class = RxAdmissionControl::Class;
+
+namespace {
+
+class RxAdmissionControlTest : public ::testing::Test {
+ public:
+  void SetUp() override {
+    FLAGS_rx_admission_pps = 10;
+    FLAGS_rx_admission_burst = 5;
+    FLAGS_rx_admission_control_pps = 10;
+    FLAGS_rx_admission_control_burst = 10;
+  }
+
+  RxAdmissionControl admission{[](const IPAddress& ip) {
+    return ip == IPAddress("10.0.0.1") || ip == IPAddress("2401:db00::1");
+  }};
+
+ private:
+  gflags::FlagSaver flagSaver_;
+};
+
+// Classifies hex, an Ethernet payload after the ethertype
+Class classify(
+    const RxAdmissionControl& admission,
+    uint16_t ethertype,
+    const std::string& hex) {
+  auto buf = PktUtil::parseHexData(hex);
+  Cursor cursor(&buf);
+  return admission.classify(ethertype, cursor);
+}
+
+const std::string kIpv4Tcp =
+    // version, ihl, tos, length, id, flags, ttl, protocol TCP, checksum
+    "45 00 00 28 00 00 40 00 40 06 00 00"
+    // src 10.0.0.2, dst 10.0.0.1
+    "0a 00 00 02 0a 00 00 01";
+
+} // namespace
+
+TEST_F(RxAdmissionControlTest, BurstThenRate) {
+  PortID port(1);
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_TRUE(admission.admit(port, Class::ARP, 100.0));
+  }
+  EXPECT_FALSE(admission.admit(port, Class::ARP, 100.0));
+  // One token every 100ms
+  EXPECT_FALSE(admission.admit(port, Class::ARP, 100.05));
+  EXPECT_TRUE(admission.admit(port, Class::ARP, 100.1));
+  EXPECT_FALSE(admission.admit(port, Class::ARP, 100.1));
+}
+
+TEST_F(RxAdmissionControlTest, PerPortAndClass) {
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_TRUE(admission.admit(PortID(1), Class::IPV4, 100.0));
+  }
+  EXPECT_FALSE(admission.admit(PortID(1), Class::IPV4, 100.0));
+  // A flood of one kind on one port leaves the rest alone
+  EXPECT_TRUE(admission.admit(PortID(1), Class::IPV6, 100.0));
+  EXPECT_TRUE(admission.admit(PortID(2), Class::IPV4, 100.0));
+  // Control packets have their own, bigger share
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_TRUE(admission.admit(PortID(1), Class::CONTROL, 100.0));
+  }
+  EXPECT_FALSE(admission.admit(PortID(1), Class::CONTROL, 100.0));
+}
+
+TEST_F(RxAdmissionControlTest, Disabled) {
+  FLAGS_rx_admission_pps = 0;
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_TRUE(admission.admit(PortID(1), Class::OTHER, 100.0));
+  }
+}
+
+TEST_F(RxAdmissionControlTest, Classify) {
+  EXPECT_EQ(Class::CONTROL, classify(admission, 0x88cc, "00"));
+  EXPECT_EQ(Class::CONTROL, classify(admission, 0x8809, "01"));
+  EXPECT_EQ(Class::ARP, classify(admission, 0x0806, "00"));
+  EXPECT_EQ(Class::OTHER, classify(admission, 0x9000, "00"));
+
+  // BGP to one of our addresses, from either end of the session
+  EXPECT_EQ(
+      Class::CONTROL, classify(admission, 0x0800, kIpv4Tcp + "c0 00 00 b3"));
+  EXPECT_EQ(
+      Class::CONTROL, classify(admission, 0x0800, kIpv4Tcp + "00 b3 c0 00"));
+  // Other TCP is not
+  EXPECT_EQ(
+      Class::IPV4, classify(admission, 0x0800, kIpv4Tcp + "c0 00 00 16"));
+  // Nor is BGP to someone else
+  EXPECT_EQ(
+      Class::IPV4,
+      classify(
+          admission,
+          0x0800,
+          "45 00 00 28 00 00 40 00 40 06 00 00"
+          "0a 00 00 02 0a 00 00 09 c0 00 00 b3"));
+  // Nor a header cut short
+  EXPECT_EQ(Class::IPV4, classify(admission, 0x0800, "45 00"));
+
+  EXPECT_EQ(
+      Class::CONTROL,
+      classify(
+          admission,
+          0x86dd,
+          // version, flow label, length, next header TCP, hop limit
+          "60 00 00 00 00 14 06 40"
+          // src 2401:db00::2, dst 2401:db00::1
+          "24 01 db 00 00 00 00 00 00 00 00 00 00 00 00 02"
+          "24 01 db 00 00 00 00 00 00 00 00 00 00 00 00 01"
+          "c0 00 00 b3"));
+  EXPECT_EQ(
+      Class::IPV6,
+      classify(
+          admission,
+          0x86dd,
+          // UDP
+          "60 00 00 00 00 14 11 40"
+          "24 01 db 00 00 00 00 00 00 00 00 00 00 00 00 02"
+          "24 01 db 00 00 00 00 00 00 00 00 00 00 00 00 01"
+          "c0 00 00 b3"));
+}
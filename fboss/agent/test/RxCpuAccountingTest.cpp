@@ -0,0 +1,82 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/RxCpuAccounting.h"
+
+#include <gtest/gtest.h>
+
+using namespace facebook::fboss;
+using std::chrono::microseconds;
+using std::chrono::seconds;
+using std::chrono::steady_clock;
+
+namespace {
+using Handler = RxCpuAccounting::Handler;
+
+steady_clock::time_point at(int second) {
+  return steady_clock::time_point(seconds(second));
+}
+} // namespace
+
+TEST(RxCpuAccountingTest, TopByCpuTime) {
+  RxCpuAccounting accounting;
+  accounting.record(Handler::ARP, 2, microseconds(5), at(1000));
+  accounting.record(Handler::IPV6, 3, microseconds(20), at(1000));
+  accounting.record(Handler::IPV6, 3, microseconds(10), at(1001));
+  accounting.record(Handler::OTHER, -1, microseconds(1), at(1001));
+
+  auto top = accounting.top(seconds(60), 10, at(1001));
+  ASSERT_EQ(5, top.size());
+  EXPECT_EQ("handler.ipv6", top[0].name);
+  EXPECT_EQ(2, top[0].packets);
+  EXPECT_EQ(microseconds(30), top[0].cpuTime);
+  EXPECT_EQ("cpu_queue.3", top[1].name);
+  EXPECT_EQ(microseconds(30), top[1].cpuTime);
+  EXPECT_EQ("handler.arp", top[2].name);
+  EXPECT_EQ("cpu_queue.2", top[3].name);
+  EXPECT_EQ("handler.other", top[4].name);
+
+  top = accounting.top(seconds(60), 1, at(1001));
+  ASSERT_EQ(1, top.size());
+  EXPECT_EQ("handler.ipv6", top[0].name);
+}
+
+TEST(RxCpuAccountingTest, Window) {
+  RxCpuAccounting accounting;
+  accounting.record(Handler::ARP, 0, microseconds(5), at(1000));
+  accounting.record(Handler::LLDP, 0, microseconds(5), at(1010));
+
+  auto top = accounting.top(seconds(5), 10, at(1010));
+  ASSERT_EQ(2, top.size());
+  EXPECT_EQ("handler.lldp", top[0].name);
+  EXPECT_EQ("cpu_queue.0", top[1].name);
+  EXPECT_EQ(1, top[1].packets);
+
+  // A second 60s on reuses the slot, dropping what was there
+  accounting.record(Handler::LACP, 0, microseconds(5), at(1060));
+  top = accounting.top(seconds(60), 10, at(1060));
+  ASSERT_EQ(3, top.size());
+  EXPECT_EQ(2, top[0].packets);
+  for (const auto& usage : top) {
+    EXPECT_NE("handler.arp", usage.name);
+  }
+}
+
+TEST(RxCpuAccountingTest, DtlbMisses) {
+  RxCpuAccounting accounting;
+  accounting.record(Handler::ARP, 2, microseconds(5), at(1000));
+  accounting.recordDtlbMisses(Handler::ARP, 2, 7, at(1000));
+  // Nothing recorded for this second yet, so the misses are dropped
+  accounting.recordDtlbMisses(Handler::ARP, 2, 100, at(1001));
+
+  auto top = accounting.top(seconds(60), 10, at(1001));
+  ASSERT_EQ(2, top.size());
+  EXPECT_EQ(7, top[0].dtlbMisses);
+  EXPECT_EQ(7, top[1].dtlbMisses);
+}
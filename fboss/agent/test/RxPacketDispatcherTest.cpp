@@ -0,0 +1,88 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/RxPacketDispatcher.h"
+
+#include "fboss/agent/SwSwitch.h"
+#include "fboss/agent/hw/mock/MockRxPacket.h"
+#include "fboss/agent/test/HwTestHandle.h"
+#include "fboss/agent/test/TestUtils.h"
+
+#include <folly/Conv.h>
+#include <folly/MacAddress.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+
+using namespace facebook::fboss;
+using folly::MacAddress;
+using std::unique_ptr;
+
+namespace {
+
+unique_ptr<MockRxPacket> makePacket(folly::StringPiece ethertype, PortID port) {
+  auto pkt = MockRxPacket::fromHex(folly::to<std::string>(
+      // dst mac, src mac
+      "01 80 c2 00 00 0e  02 00 01 00 00 01",
+      // ethertype
+      ethertype));
+  pkt->padToLength(68);
+  pkt->setSrcPort(port);
+  return pkt;
+}
+
+} // unnamed namespace
+
+TEST(RxPacketDispatcherTest, QueueSelection) {
+  const size_t kDataQueues = 4;
+  // LLDP and LACP, tagged or not, go on the control queue
+  for (auto ethertype : {"88 cc", "88 09", "81 00 00 01  88 09"}) {
+    auto pkt = makePacket(ethertype, PortID(1));
+    EXPECT_EQ(
+        RxPacketDispatcher::kControlQueue,
+        RxPacketDispatcher::queueFor(pkt.get(), kDataQueues));
+  }
+
+  // Everything else is hashed over the data queues, consistently
+  for (auto ethertype : {"08 06", "08 00", "86 dd"}) {
+    for (int port = 1; port <= 20; ++port) {
+      auto pkt = makePacket(ethertype, PortID(port));
+      auto queue = RxPacketDispatcher::queueFor(pkt.get(), kDataQueues);
+      EXPECT_GE(queue, 1u);
+      EXPECT_LE(queue, kDataQueues);
+      EXPECT_EQ(
+          queue, RxPacketDispatcher::queueFor(pkt->clone().get(), kDataQueues));
+    }
+  }
+}
+
+TEST(RxPacketDispatcherTest, DispatchAndStop) {
+  auto handle = createTestHandle(testStateA(), MacAddress("00:02:00:00:00:01"));
+  auto sw = handle->getSw();
+
+  std::atomic<int> handled{0};
+  RxPacketDispatcher dispatcher(
+      sw,
+      [&handled](unique_ptr<RxPacket> /*pkt*/) { ++handled; },
+      2,
+      128);
+  EXPECT_EQ(3, dispatcher.numQueues());
+
+  // Packets given to a stopped dispatcher are dropped
+  dispatcher.dispatch(makePacket("08 06", PortID(1)));
+
+  dispatcher.start();
+  for (int i = 0; i < 50; ++i) {
+    dispatcher.dispatch(makePacket("88 cc", PortID(1)));
+    dispatcher.dispatch(makePacket("08 06", PortID(1 + i % 10)));
+  }
+  // stop waits for everything already queued to be handled
+  dispatcher.stop();
+  EXPECT_EQ(100, handled.load());
+}
@@ -0,0 +1,55 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/StallDetector.h"
+
+#include <folly/system/ThreadName.h>
+#include <gflags/gflags.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <thread>
+
+DECLARE_int32(stall_threshold_ms);
+
+using namespace facebook::fboss;
+
+namespace {
+bool isStuckWork(const ThreadStall& stall) {
+  return stall.threadName == "StallTest" && stall.source == "stuck work";
+}
+} // namespace
+
+TEST(StallDetector, stalledWorkHasStack) {
+  gflags::FlagSaver saver;
+  FLAGS_stall_threshold_ms = 20;
+
+  std::thread thread([]() {
+    folly::setThreadName("StallTest");
+    {
+      StallDetector::Work work("stuck work");
+      std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    }
+    // Quick work is not reported
+    StallDetector::Work work("quick work");
+  });
+  thread.join();
+
+  auto stalls = StallDetector::getStalls();
+  auto found = std::find_if(stalls.begin(), stalls.end(), isStuckWork);
+  ASSERT_NE(stalls.end(), found);
+  EXPECT_GE(found->stalledMsecs, 20);
+  EXPECT_FALSE(found->stack.empty());
+  // Each piece of work is reported once, however long it stalls
+  EXPECT_EQ(1, std::count_if(stalls.begin(), stalls.end(), isStuckWork));
+  EXPECT_TRUE(std::none_of(
+      stalls.begin(), stalls.end(), [](const ThreadStall& stall) {
+        return stall.source == "quick work";
+      }));
+}
@@ -0,0 +1,73 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/StateUpdateJournal.h"
+
+#include "fboss/agent/state/StateDelta.h"
+#include "fboss/agent/state/SwitchState.h"
+#include "fboss/agent/test/TestUtils.h"
+
+#include <folly/experimental/TestUtil.h>
+#include <gtest/gtest.h>
+
+using namespace facebook::fboss;
+using std::chrono::microseconds;
+
+TEST(StateUpdateJournal, Replay) {
+  auto stateA = testStateA();
+  stateA->publish();
+  auto stateB = testStateB();
+  stateB->publish();
+  auto stateA2 = testStateA();
+  stateA2->publish();
+
+  folly::test::TemporaryFile file;
+  {
+    StateUpdateJournal journal(file.path().string());
+    journal.append({"to B"}, StateDelta(stateA, stateB), microseconds(10));
+    journal.append(
+        {"back to A", "and more"},
+        StateDelta(stateB, stateA2),
+        microseconds(20));
+  }
+
+  StateUpdateJournalReader reader(file.path().string());
+  EXPECT_EQ(
+      stateA->toFollyDynamic(), reader.getInitialState()->toFollyDynamic());
+
+  StateUpdateJournalReader::Update update;
+  ASSERT_TRUE(reader.next(&update));
+  EXPECT_EQ(std::vector<std::string>{"to B"}, update.names);
+  EXPECT_EQ(microseconds(10), update.applyTime);
+  EXPECT_EQ(stateB->toFollyDynamic(), update.state->toFollyDynamic());
+  EXPECT_TRUE(update.state->isPublished());
+
+  ASSERT_TRUE(reader.next(&update));
+  EXPECT_EQ(2, update.names.size());
+  EXPECT_EQ(microseconds(20), update.applyTime);
+  EXPECT_EQ(stateA2->toFollyDynamic(), update.state->toFollyDynamic());
+
+  EXPECT_FALSE(reader.next(&update));
+}
+
+TEST(StateUpdateJournal, UnchangedPartsNotSerialized) {
+  auto state = testStateA();
+  state->publish();
+  auto newState = state->clone();
+  newState->setDefaultVlan(VlanID(2));
+  newState->publish();
+
+  folly::dynamic summary;
+  auto delta =
+      StateUpdateJournal::serializeDelta(StateDelta(state, newState), &summary);
+  EXPECT_EQ(1, delta.size());
+  EXPECT_EQ(2, delta["defaultVlan"].asInt());
+  EXPECT_EQ(folly::dynamic::array("defaultVlan"), summary["other"]);
+  EXPECT_EQ(0, summary["routesAdded"].asInt());
+}
@@ -0,0 +1,138 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "common/stats/ThreadLocalStats.h"
+
+#include <folly/Benchmark.h>
+#include <folly/Synchronized.h>
+#include <folly/stats/TimeseriesHistogram.h>
+#include <gflags/gflags.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using facebook::stats::ThreadLocalStatsT;
+using facebook::stats::TLStatsThreadSafe;
+
+namespace {
+
+constexpr size_t kNumThreads = 4;
+
+/*
+ * What TLHistogram used to be: a single histogram shared by every thread,
+ * behind a lock, with the clock read on every update.
+ */
+class LockedHistogram {
+ public:
+  LockedHistogram(size_t bucketWidth, int64_t minValue, int64_t maxValue)
+      : histogram_(
+            folly::in_place, bucketWidth, minValue, maxValue,
+            folly::MultiLevelTimeSeries<int64_t>{
+                60,
+                {
+                    std::chrono::seconds{60}, std::chrono::seconds{600},
+                    std::chrono::seconds{3600}, std::chrono::seconds{0},
+                }}) {}
+
+  void addValue(int64_t value) {
+    auto now = std::chrono::duration_cast<
+        folly::TimeseriesHistogram<int64_t>::Duration>(
+        std::chrono::steady_clock::now().time_since_epoch());
+    histogram_->addValue(folly::TimeseriesHistogram<int64_t>::TimePoint(now),
+                         value);
+  }
+
+ private:
+  folly::Synchronized<folly::TimeseriesHistogram<int64_t>> histogram_;
+};
+
+using Stats = ThreadLocalStatsT<TLStatsThreadSafe>;
+
+template <typename Fn>
+void runThreads(size_t numIters, Fn fn) {
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([&, t] { fn(t, numIters / kNumThreads); });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+} // unnamed namespace
+
+BENCHMARK(LockedHistogramAdd, numIters) {
+  LockedHistogram histogram(100, 0, 10000);
+  for (size_t n = 0; n < numIters; ++n) {
+    histogram.addValue(n % 10000);
+  }
+}
+
+BENCHMARK_RELATIVE(ThreadLocalHistogramAdd, numIters) {
+  Stats stats;
+  Stats::TLHistogram histogram(&stats, "bench", 100, 0, 10000);
+  for (size_t n = 0; n < numIters; ++n) {
+    histogram.addValue(n % 10000);
+  }
+  stats.aggregate();
+}
+
+BENCHMARK(LockedHistogramAddThreads, numIters) {
+  // Every thread updates the same histogram
+  LockedHistogram histogram(100, 0, 10000);
+  runThreads(numIters, [&](size_t, size_t iters) {
+    for (size_t n = 0; n < iters; ++n) {
+      histogram.addValue(n % 10000);
+    }
+  });
+}
+
+BENCHMARK_RELATIVE(ThreadLocalHistogramAddThreads, numIters) {
+  // Each thread has its own shard, which this thread keeps aggregating
+  std::vector<std::unique_ptr<Stats>> stats;
+  std::vector<std::unique_ptr<Stats::TLHistogram>> histograms;
+  for (size_t t = 0; t < kNumThreads; ++t) {
+    stats.push_back(std::make_unique<Stats>());
+    histograms.push_back(std::make_unique<Stats::TLHistogram>(
+        stats.back().get(), "bench", 100, 0, 10000));
+  }
+  std::atomic<bool> done{false};
+  std::thread aggregator([&] {
+    while (!done) {
+      for (auto& s : stats) {
+        s->aggregate();
+      }
+    }
+  });
+  runThreads(numIters, [&](size_t t, size_t iters) {
+    for (size_t n = 0; n < iters; ++n) {
+      histograms[t]->addValue(n % 10000);
+    }
+  });
+  done = true;
+  aggregator.join();
+  histograms.clear();
+}
+
+BENCHMARK(ThreadLocalTimeseriesAdd, numIters) {
+  Stats stats;
+  Stats::TLTimeseries timeseries(&stats, "bench");
+  for (size_t n = 0; n < numIters; ++n) {
+    timeseries.addValue(1);
+  }
+  stats.aggregate();
+}
+
+int main(int argc, char** argv) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  folly::runBenchmarks();
+  return 0;
+}
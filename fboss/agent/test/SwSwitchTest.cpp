@@ -15,6 +15,7 @@
 #include "fboss/agent/SwitchStats.h"
 #include "fboss/agent/NeighborUpdater.h"
 #include "fboss/agent/PortStats.h"
+#include "fboss/agent/StateObserver.h"
 #include "fboss/agent/state/ArpTable.h"
 #include "fboss/agent/state/Interface.h"
 #include "fboss/agent/state/Port.h"
@@ -27,8 +28,11 @@
 #include <folly/IPAddressV4.h>
 #include <folly/IPAddressV6.h>
 #include <folly/MacAddress.h>
+#include <folly/io/async/ScopedEventBaseThread.h>
+#include <folly/synchronization/Baton.h>
 
 #include <algorithm>
+#include <vector>
 
 
 using namespace facebook::fboss;
@@ -186,3 +190,97 @@ TEST_F(SwSwitchTest, TestStateNonCoalescing) {
   // 0 neighbor entries expected, i.e. entries must be purged
   verifyReachableCnt(0);
 }
+
+TEST_F(SwSwitchTest, LinkStatesChangedTogether) {
+  sw->updateState("Bring Ports Up", [](const std::shared_ptr<SwitchState>& s) {
+    return bringAllPortsUp(s);
+  });
+  waitForStateUpdates(sw);
+
+  sw->linkStatesChanged(
+      {{PortID(1), false}, {PortID(2), false}, {PortID(1), true}});
+  waitForStateUpdates(sw);
+
+  auto ports = sw->getAppliedState()->getPorts();
+  EXPECT_TRUE(ports->getPort(PortID(1))->isUp());
+  EXPECT_FALSE(ports->getPort(PortID(2))->isUp());
+  EXPECT_TRUE(ports->getPort(PortID(3))->isUp());
+}
+
+TEST_F(SwSwitchTest, UpdatesAppliedInPriorityOrder) {
+  // Hold the update thread so that all of the updates below are pending at
+  // the same time.
+  folly::Baton<> updateThreadBlocked;
+  folly::Baton<> unblockUpdateThread;
+  sw->getUpdateEvb()->runInEventBaseThread([&]() {
+    updateThreadBlocked.post();
+    unblockUpdateThread.wait();
+  });
+  updateThreadBlocked.wait();
+
+  std::vector<std::string> applied;
+  auto recordUpdate = [&applied](std::string name) {
+    return [&applied, name](const std::shared_ptr<SwitchState>& /*state*/) {
+      applied.push_back(name);
+      return std::shared_ptr<SwitchState>();
+    };
+  };
+  sw->updateState(
+      "config", recordUpdate("config"), StateUpdate::Priority::CONFIG);
+  sw->updateState("route1", recordUpdate("route1"), StateUpdate::Priority::ROUTE);
+  sw->updateState(
+      "neighbor", recordUpdate("neighbor"), StateUpdate::Priority::NEIGHBOR);
+  sw->updateState("route2", recordUpdate("route2"), StateUpdate::Priority::ROUTE);
+  sw->updateState("link", recordUpdate("link"), StateUpdate::Priority::LINK);
+
+  unblockUpdateThread.post();
+  waitForStateUpdates(sw);
+  // Highest class first, FIFO within a class
+  EXPECT_EQ(
+      (std::vector<std::string>{"link", "neighbor", "route1", "route2", "config"}),
+      applied);
+}
+
+namespace {
+class RecordingAsyncObserver : public AutoRegisterStateObserver {
+ public:
+  RecordingAsyncObserver(SwSwitch* sw, folly::EventBase* evb)
+      : AutoRegisterStateObserver(sw, "RecordingAsyncObserver", evb),
+        evb_(evb) {}
+
+  void stateUpdated(const StateDelta& delta) override {
+    EXPECT_TRUE(evb_->isInEventBaseThread());
+    generations.push_back(delta.newState()->getGeneration());
+  }
+
+  // Only accessed from evb_
+  std::vector<uint32_t> generations;
+
+ private:
+  folly::EventBase* evb_;
+};
+} // namespace
+
+TEST_F(SwSwitchTest, AsyncStateObserver) {
+  folly::ScopedEventBaseThread observerThread;
+  auto evb = observerThread.getEventBase();
+  RecordingAsyncObserver observer(sw, evb);
+
+  // Queue more deltas than the observer may have pending, so that the update
+  // thread has to wait for it at least once.
+  const auto kUpdates = 3 * SwSwitch::kDefaultMaxPendingStateDeltas;
+  EXPECT_HW_CALL(sw, stateChanged(_)).Times(kUpdates);
+  for (uint32_t i = 0; i < kUpdates; ++i) {
+    sw->updateStateNoCoalescing(
+        "bump generation", [](const std::shared_ptr<SwitchState>& state) {
+          return state->clone();
+        });
+  }
+  waitForStateUpdates(sw);
+
+  evb->runInEventBaseThreadAndWait([&observer, kUpdates]() {
+    ASSERT_EQ(kUpdates, observer.generations.size());
+    EXPECT_TRUE(std::is_sorted(
+        observer.generations.begin(), observer.generations.end()));
+  });
+}
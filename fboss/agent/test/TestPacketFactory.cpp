@@ -16,8 +16,14 @@
 #include <folly/MoveWrapper.h>
 #include <folly/String.h>
 #include <folly/io/IOBuf.h>
+#include "fboss/agent/ArpHandler.h"
 #include "fboss/agent/IPv4Handler.h"
 #include "fboss/agent/IPv6Handler.h"
+#include "fboss/agent/packet/ArpHdr.h"
+#include "fboss/agent/packet/ICMPHdr.h"
+#include "fboss/agent/packet/IPProto.h"
+#include "fboss/agent/packet/IPv6Hdr.h"
+#include "fboss/agent/packet/NDP.h"
 #include "fboss/agent/packet/PktUtil.h"
 #include "fboss/agent/packet/EthHdr.h"
 #include "fboss/agent/TxPacket.h"
@@ -131,6 +137,80 @@ folly::IOBuf createV6Packet(
   return pkt;
 }
 
+folly::IOBuf createArpReply(
+    folly::IPAddressV4 senderIp,
+    folly::MacAddress senderMac,
+    folly::IPAddressV4 targetIp,
+    folly::MacAddress targetMac,
+    VlanID vlan) {
+  // Ethernet header with a VLAN tag, and the 28 byte ARP message
+  constexpr uint32_t kArpLen = EthHdr::SIZE + 28;
+  IOBuf pkt(IOBuf::CREATE, kArpLen);
+  pkt.append(kArpLen);
+
+  folly::io::RWPrivateCursor rwCursor(&pkt);
+  TxPacket::writeEthHeader(
+      &rwCursor, targetMac, senderMac, vlan, ArpHandler::ETHERTYPE_ARP);
+  rwCursor.writeBE<uint16_t>(
+      static_cast<uint16_t>(ARP_HTYPE::ARP_HTYPE_ETHERNET));
+  rwCursor.writeBE<uint16_t>(static_cast<uint16_t>(ARP_PTYPE::ARP_PTYPE_IPV4));
+  rwCursor.writeBE<uint8_t>(static_cast<uint8_t>(ARP_HLEN::ARP_HLEN_ETHERNET));
+  rwCursor.writeBE<uint8_t>(static_cast<uint8_t>(ARP_PLEN::ARP_PLEN_IPV4));
+  rwCursor.writeBE<uint16_t>(ARP_OP_REPLY);
+  rwCursor.push(senderMac.bytes(), folly::MacAddress::SIZE);
+  rwCursor.write<uint32_t>(senderIp.toLong());
+  rwCursor.push(targetMac.bytes(), folly::MacAddress::SIZE);
+  rwCursor.write<uint32_t>(targetIp.toLong());
+
+  XLOG(DBG2) << "\n" << folly::hexDump(pkt.data(), pkt.length());
+
+  return pkt;
+}
+
+folly::IOBuf createNeighborAdvertisement(
+    const folly::IPAddressV6& srcIp,
+    folly::MacAddress srcMac,
+    const folly::IPAddressV6& dstIp,
+    folly::MacAddress dstMac,
+    VlanID vlan) {
+  NDPOptions ndpOptions;
+  ndpOptions.targetLinkLayerAddress.emplace(srcMac);
+  uint32_t bodyLength = ICMPHdr::ICMPV6_UNUSED_LEN + IPAddressV6::byteCount() +
+      ndpOptions.computeTotalLength();
+
+  IPv6Hdr ipv6(srcIp, dstIp);
+  ipv6.payloadLength = ICMPHdr::SIZE + bodyLength;
+  ipv6.nextHeader = static_cast<uint8_t>(IP_PROTO::IP_PROTO_IPV6_ICMP);
+  ipv6.hopLimit = 255;
+  ICMPHdr icmp6(
+      static_cast<uint8_t>(ICMPv6Type::ICMPV6_TYPE_NDP_NEIGHBOR_ADVERTISEMENT),
+      static_cast<uint8_t>(ICMPv6Code::ICMPV6_CODE_NDP_MESSAGE_CODE),
+      0);
+
+  auto pktLen = icmp6.computeTotalLengthV6(bodyLength);
+  IOBuf pkt(IOBuf::CREATE, pktLen);
+  pkt.append(pktLen);
+  folly::io::RWPrivateCursor rwCursor(&pkt);
+  icmp6.serializeFullPacket(
+      &rwCursor,
+      dstMac,
+      srcMac,
+      vlan,
+      ipv6,
+      bodyLength,
+      [&](folly::io::RWPrivateCursor* cursor) {
+        cursor->writeBE<uint32_t>(
+            NeighborAdvertisementFlags::SOLICITED |
+            NeighborAdvertisementFlags::OVERRIDE);
+        cursor->push(srcIp.bytes(), IPAddressV6::byteCount());
+        ndpOptions.serialize(cursor);
+      });
+
+  XLOG(DBG2) << "\n" << folly::hexDump(pkt.data(), pkt.length());
+
+  return pkt;
+}
+
 /* Convenience function to copy a buffer to a TxPacket.
  * L2 Header is advanced from RxPacket but headroom is provided in TxPacket.
  */
@@ -18,6 +18,8 @@
 #include <folly/String.h>
 #include <folly/io/IOBuf.h>
 
+#include "fboss/agent/types.h"
+
 #include <memory>
 
 namespace facebook {
@@ -37,6 +39,28 @@ folly::IOBuf createV6Packet(
     folly::MacAddress srcMac,
     folly::MacAddress dstMac);
 
+/*
+ * An ARP reply from senderIp/senderMac to targetIp/targetMac, tagged with
+ * vlan.
+ */
+folly::IOBuf createArpReply(
+    folly::IPAddressV4 senderIp,
+    folly::MacAddress senderMac,
+    folly::IPAddressV4 targetIp,
+    folly::MacAddress targetMac,
+    VlanID vlan);
+
+/*
+ * A solicited neighbor advertisement for srcIp, with srcMac as its target
+ * link-layer address, tagged with vlan.
+ */
+folly::IOBuf createNeighborAdvertisement(
+    const folly::IPAddressV6& srcIp,
+    folly::MacAddress srcMac,
+    const folly::IPAddressV6& dstIp,
+    folly::MacAddress dstMac,
+    VlanID vlan);
+
 /* Convenience function to copy a buffer to a TxPacket.
  * L2 Header is advanced from RxPacket but headroom is provided in TxPacket.
  */
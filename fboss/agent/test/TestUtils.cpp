@@ -203,10 +203,10 @@ MockPlatform* getMockPlatform(std::unique_ptr<SwSwitch>& sw) {
 }
 
 std::shared_ptr<SwitchState> waitForStateUpdates(SwSwitch* sw) {
-  // All StateUpdates scheduled from this thread will be applied in order,
-  // so we can simply perform a blocking no-op update.  When it is done
-  // we can be sure that all previously scheduled updates have also been
-  // applied.
+  // StateUpdates are applied highest priority class first and in order
+  // within a class, so we can simply perform a blocking no-op update in the
+  // lowest priority class.  When it is done we can be sure that all
+  // previously scheduled updates have also been applied.
   std::shared_ptr<SwitchState> snapshot{nullptr};
   auto snapshotUpdate = [&snapshot](const shared_ptr<SwitchState>& state)
       -> std::shared_ptr<SwitchState>{
@@ -214,7 +214,8 @@ std::shared_ptr<SwitchState> waitForStateUpdates(SwSwitch* sw) {
     snapshot = state;
     return nullptr;
   };
-  sw->updateStateBlocking("waitForStateUpdates", snapshotUpdate);
+  sw->updateStateBlocking(
+      "waitForStateUpdates", snapshotUpdate, StateUpdate::Priority::CONFIG);
   return snapshot;
 }
 
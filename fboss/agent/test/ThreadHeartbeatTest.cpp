@@ -0,0 +1,56 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/ThreadHeartbeat.h"
+
+#include <folly/io/async/ScopedEventBaseThread.h>
+#include <gflags/gflags.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <thread>
+
+DECLARE_int32(event_loop_sample_rate);
+DECLARE_int32(slow_event_loop_ms);
+
+using namespace facebook::fboss;
+
+TEST(ThreadHeartbeat, slowLoopsAreAttributed) {
+  gflags::FlagSaver saver;
+  FLAGS_event_loop_sample_rate = 1;
+  FLAGS_slow_event_loop_ms = 10;
+
+  folly::ScopedEventBaseThread thread("SlowLoopTest");
+  auto evb = thread.getEventBase();
+  ThreadHeartbeat heartbeat(
+      evb, "SlowLoopTest", 1000, [](int /*delay*/, int /*backlog*/) {});
+
+  for (int i = 0; i < 3; ++i) {
+    evb->runInEventBaseThreadAndWait([]() {
+      ThreadHeartbeat::setLoopSource("slow work");
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    });
+  }
+  // The last loop is sampled once it ends
+  evb->runInEventBaseThreadAndWait([]() {});
+
+  auto loops = ThreadHeartbeat::getSlowLoops();
+  auto found = std::find_if(
+      loops.begin(), loops.end(), [](const EventLoopSample& loop) {
+        return loop.threadName == "SlowLoopTest" && loop.source == "slow work";
+      });
+  ASSERT_NE(loops.end(), found);
+  EXPECT_GE(found->busyUsecs, 20000);
+  EXPECT_TRUE(std::is_sorted(
+      loops.begin(),
+      loops.end(),
+      [](const EventLoopSample& a, const EventLoopSample& b) {
+        return a.busyUsecs > b.busyUsecs;
+      }));
+}
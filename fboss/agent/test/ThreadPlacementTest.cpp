@@ -0,0 +1,89 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/ThreadPlacement.h"
+
+#include "fboss/agent/FbossError.h"
+#include "fboss/agent/Utils.h"
+
+#include <sched.h>
+#include <thread>
+
+#include <folly/ScopeGuard.h>
+#include <gtest/gtest.h>
+
+using namespace facebook::fboss;
+
+namespace {
+
+cfg::ThreadPlacement pinnedTo(int cpu) {
+  cfg::ThreadPlacement placement;
+  placement.cpus.push_back(cpu);
+  return placement;
+}
+
+std::vector<int> cpusOfThisThread() {
+  std::vector<int> cpus;
+  cpu_set_t set;
+  EXPECT_EQ(0, sched_getaffinity(0, sizeof(set), &set));
+  for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+    if (CPU_ISSET(cpu, &set)) {
+      cpus.push_back(cpu);
+    }
+  }
+  return cpus;
+}
+
+} // namespace
+
+TEST(ThreadPlacementTest, PinsMatchingThreads) {
+  auto allowed = cpusOfThisThread();
+  ASSERT_FALSE(allowed.empty());
+  auto cpu = allowed.back();
+  thread_placement::init({{"fbossTestThread", pinnedTo(cpu)},
+                          {"fbossTestPool*", pinnedTo(cpu)}});
+  SCOPE_EXIT {
+    thread_placement::init({});
+  };
+
+  auto cpusOf = [](const std::string& name) {
+    std::vector<int> cpus;
+    std::thread([&] {
+      initThread(name);
+      cpus = cpusOfThisThread();
+    }).join();
+    return cpus;
+  };
+  EXPECT_EQ(std::vector<int>{cpu}, cpusOf("fbossTestThread"));
+  EXPECT_EQ(std::vector<int>{cpu}, cpusOf("fbossTestPool3"));
+  EXPECT_EQ(allowed, cpusOf("fbossOtherThread"));
+}
+
+TEST(ThreadPlacementTest, ReportsThreads) {
+  auto threads = thread_placement::current();
+  ASSERT_FALSE(threads.empty());
+  for (const auto& thread : threads) {
+    EXPECT_FALSE(thread.cpus.empty());
+    EXPECT_EQ("OTHER", thread.policy);
+  }
+}
+
+TEST(ThreadPlacementTest, InvalidPlacement) {
+  EXPECT_THROW(
+      thread_placement::init({{"fbossTestThread", pinnedTo(-1)}}),
+      FbossError);
+
+  cfg::ThreadPlacement fifo;
+  fifo.policy = cfg::ThreadSchedPolicy::FIFO;
+  EXPECT_THROW(
+      thread_placement::init({{"fbossTestThread", fifo}}), FbossError);
+  fifo.priority = 10;
+  thread_placement::init({{"fbossTestThread", fifo}});
+  thread_placement::init({});
+}
@@ -8,6 +8,7 @@
  *
  */
 #include "fboss/agent/AddressUtil.h"
+#include "fboss/agent/RouteTableStreamer.h"
 #include "fboss/agent/SwSwitch.h"
 #include "fboss/agent/ThriftHandler.h"
 #include "fboss/agent/test/TestUtils.h"
@@ -300,3 +301,87 @@ TEST(ThriftTest, syncFib) {
   EXPECT_EQ(4 + 1, tables3->getRouteTable(rid)->getRibV4()->size());
   EXPECT_EQ(4 + 1, tables3->getRouteTable(rid)->getRibV6()->size());
 }
+
+TEST(ThriftTest, streamRouteTable) {
+  cfg::SwitchConfig config;
+  config.vlans.resize(1);
+  config.vlans[0].id = 1;
+  config.interfaces.resize(1);
+  config.interfaces[0].intfID = 1;
+  config.interfaces[0].vlanID = 1;
+  config.interfaces[0].routerID = 0;
+  config.interfaces[0].__isset.mac = true;
+  config.interfaces[0].mac_ref().value_unchecked() = "00:02:00:00:00:01";
+  config.interfaces[0].ipAddresses.resize(2);
+  config.interfaces[0].ipAddresses[0] = "10.0.0.1/24";
+  config.interfaces[0].ipAddresses[1] = "2401:db00:2110:3001::0001/64";
+
+  auto handle = createTestHandle(&config);
+  auto sw = handle->getSw();
+  sw->initialConfigApplied(std::chrono::steady_clock::now());
+  sw->fibSynced();
+  ThriftHandler handler(sw);
+
+  handler.addUnicastRoute(10, makeUnicastRoute("7.1.0.0/16", "11.11.11.11"));
+  handler.addUnicastRoute(10, makeUnicastRoute("7.2.0.0/16", "11.11.11.11"));
+  handler.addUnicastRoute(10, makeUnicastRoute("aaaa:1::0/64", "11:11::0"));
+  handler.addUnicastRoute(20, makeUnicastRoute("7.3.0.0/16", "22.22.22.22"));
+
+  auto drain = [&](const RouteTableFilter& filter, size_t chunkSize) {
+    RouteTableStreamer streamer(sw->getState(), filter, chunkSize);
+    std::vector<std::vector<UnicastRoute>> chunks;
+    while (auto chunk = streamer.nextChunk()) {
+      EXPECT_LE(chunk->size(), chunkSize);
+      chunks.push_back(std::move(*chunk));
+    }
+    return chunks;
+  };
+
+  // Client 10's routes, with its own next hops
+  RouteTableFilter byClient;
+  byClient.__isset.clientId = true;
+  byClient.clientId_ref().value_unchecked() = 10;
+  auto chunks = drain(byClient, 2);
+  ASSERT_EQ(2, chunks.size());
+  EXPECT_EQ(2, chunks[0].size());
+  ASSERT_EQ(1, chunks[1].size());
+  EXPECT_EQ(64, chunks[1][0].dest.prefixLength);
+  ASSERT_EQ(1, chunks[1][0].nextHopAddrs.size());
+  EXPECT_EQ(
+      IPAddress("11:11::0"),
+      facebook::network::toIPAddress(chunks[1][0].nextHopAddrs[0]));
+
+  // Narrowed down by prefix
+  auto byPrefix = byClient;
+  byPrefix.__isset.prefix = true;
+  byPrefix.prefix_ref().value_unchecked().ip =
+      toBinaryAddress(IPAddress("7.2.0.0"));
+  byPrefix.prefix_ref().value_unchecked().prefixLength = 15;
+  chunks = drain(byPrefix, 10);
+  ASSERT_EQ(1, chunks.size());
+  ASSERT_EQ(1, chunks[0].size());
+  EXPECT_EQ(
+      IPAddress("7.2.0.0"),
+      facebook::network::toIPAddress(chunks[0][0].dest.ip));
+
+  // Without a client only resolved routes are returned, so the client
+  // routes above, whose next hops are unreachable, are left out
+  RouteTableFilter inSubnet;
+  inSubnet.__isset.prefix = true;
+  inSubnet.prefix_ref().value_unchecked().ip =
+      toBinaryAddress(IPAddress("10.0.0.0"));
+  inSubnet.prefix_ref().value_unchecked().prefixLength = 8;
+  chunks = drain(inSubnet, 10);
+  ASSERT_EQ(1, chunks.size());
+  ASSERT_EQ(1, chunks[0].size());
+  EXPECT_EQ(24, chunks[0][0].dest.prefixLength);
+  auto all = drain(RouteTableFilter(), 1000);
+  ASSERT_EQ(1, all.size());
+  for (const auto& route : all[0]) {
+    EXPECT_NE(16, route.dest.prefixLength);
+  }
+
+  // Matching nothing ends the stream right away
+  byClient.clientId_ref().value_unchecked() = 30;
+  EXPECT_TRUE(drain(byClient, 10).empty());
+}
@@ -0,0 +1,145 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/bcm_wrapper/SdkCallLog.h"
+
+#include <cerrno>
+#include <cstdlib>
+
+#include <folly/Conv.h>
+#include <folly/String.h>
+#include <gflags/gflags.h>
+
+DEFINE_string(
+    sdk_call_log,
+    "",
+    "Record every SDK call to this file, for sdk_replay. Only agents linked "
+    "with the generated SDK call recorder can record");
+
+namespace facebook { namespace fboss {
+
+namespace {
+
+constexpr char kMagic[8] = {'F', 'B', 'S', 'D', 'K', 'L', 'G', '1'};
+constexpr size_t kWriteBufferSize = 1 << 20;
+
+struct RecordHeader {
+  uint32_t payloadLen;
+  uint64_t callId;
+  uint64_t startNsecs;
+  uint64_t latencyNsecs;
+  int32_t rc;
+} __attribute__((packed));
+
+void flushLog() {
+  if (auto log = SdkCallLogWriter::get()) {
+    log->flush();
+  }
+}
+
+} // namespace
+
+SdkCallLogWriter* SdkCallLogWriter::get() {
+  // Leaked, SDK calls may still be made while static objects are destroyed
+  static auto log = []() -> SdkCallLogWriter* {
+    if (FLAGS_sdk_call_log.empty()) {
+      return nullptr;
+    }
+    auto writer = new SdkCallLogWriter(FLAGS_sdk_call_log);
+    atexit(flushLog);
+    return writer;
+  }();
+  return log;
+}
+
+SdkCallLogWriter::SdkCallLogWriter(const std::string& path)
+    : opened_(std::chrono::steady_clock::now()) {
+  file_ = fopen(path.c_str(), "w");
+  if (!file_) {
+    throw std::runtime_error(folly::to<std::string>(
+        "unable to open SDK call log ", path, ": ", folly::errnoStr(errno)));
+  }
+  setvbuf(file_, nullptr, _IOFBF, kWriteBufferSize);
+  fwrite(kMagic, sizeof(kMagic), 1, file_);
+}
+
+SdkCallLogWriter::~SdkCallLogWriter() {
+  fclose(file_);
+}
+
+std::chrono::nanoseconds SdkCallLogWriter::now() const {
+  return std::chrono::steady_clock::now() - opened_;
+}
+
+void SdkCallLogWriter::append(
+    SdkCallRecord* record,
+    std::chrono::nanoseconds start) {
+  RecordHeader header;
+  header.payloadLen = record->payload_.size();
+  header.callId = record->callId_;
+  header.startNsecs = start.count();
+  header.latencyNsecs = record->latency_.count();
+  header.rc = record->rc_;
+  std::lock_guard<std::mutex> g(lock_);
+  fwrite(&header, sizeof(header), 1, file_);
+  fwrite(record->payload_.data(), record->payload_.size(), 1, file_);
+}
+
+void SdkCallLogWriter::flush() {
+  std::lock_guard<std::mutex> g(lock_);
+  fflush(file_);
+}
+
+SdkCallLogReader::SdkCallLogReader(const std::string& path) {
+  file_ = fopen(path.c_str(), "r");
+  if (!file_) {
+    throw std::runtime_error(folly::to<std::string>(
+        "unable to open SDK call log ", path, ": ", folly::errnoStr(errno)));
+  }
+  char magic[sizeof(kMagic)];
+  if (fread(magic, sizeof(magic), 1, file_) != 1 ||
+      memcmp(magic, kMagic, sizeof(kMagic)) != 0) {
+    fclose(file_);
+    throw std::runtime_error(path + " is not an SDK call log");
+  }
+}
+
+SdkCallLogReader::~SdkCallLogReader() {
+  fclose(file_);
+}
+
+bool SdkCallLogReader::next() {
+  RecordHeader header;
+  if (fread(&header, sizeof(header), 1, file_) != 1) {
+    // A record cut short by the agent exiting ends the log too
+    return false;
+  }
+  payload_.resize(header.payloadLen);
+  if (header.payloadLen &&
+      fread(payload_.data(), header.payloadLen, 1, file_) != 1) {
+    return false;
+  }
+  offset_ = 0;
+  callId_ = header.callId;
+  rc_ = header.rc;
+  start_ = std::chrono::nanoseconds(header.startNsecs);
+  latency_ = std::chrono::nanoseconds(header.latencyNsecs);
+  return true;
+}
+
+void SdkCallLogReader::read(void* out, size_t len) {
+  if (offset_ + len > payload_.size()) {
+    throw std::runtime_error(folly::to<std::string>(
+        "SDK call log record for call ", callId_, " is truncated"));
+  }
+  memcpy(out, payload_.data() + offset_, len);
+  offset_ += len;
+}
+
+}} // facebook::fboss
@@ -0,0 +1,193 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace facebook { namespace fboss {
+
+/*
+ * A compact binary log of SDK calls, so that the hardware programming done by
+ * a production agent can be replayed against a lab switch, or fed to a timing
+ * model, to benchmark it on real update sequences.
+ *
+ * The log is written by the __wrap_opennsl_* functions HeaderToRecorder
+ * generates from the SDK headers. The agent is linked with --wrap for each
+ * of them, so every SDK call goes through the recorder without any change to
+ * the callers. Nothing is recorded unless --sdk_call_log names a file.
+ *
+ * The file is a magic followed by one record per call:
+ *
+ *   u32 payload length, u64 call id, u64 start (ns since the log was opened),
+ *   u64 latency (ns), i32 return value, payload
+ *
+ * The payload holds the arguments in order, as they were before the call: a
+ * value is its bytes, a pointer is an element count (0 for null) followed by
+ * the elements it points to. The call id is a hash of the function name, so
+ * logs stay valid across rebuilds of the recorder.
+ */
+class SdkCallRecord {
+ public:
+  explicit SdkCallRecord(uint64_t callId) : callId_(callId) {}
+
+  template <typename T>
+  void addValue(const T& value) {
+    static_assert(std::is_trivially_copyable<T>::value, "not plain data");
+    append(&value, sizeof(value));
+  }
+
+  template <typename T>
+  void addArray(const T* elems, size_t count) {
+    static_assert(std::is_trivially_copyable<T>::value, "not plain data");
+    uint32_t n = elems ? count : 0;
+    append(&n, sizeof(n));
+    append(elems, n * sizeof(T));
+  }
+
+  void addString(const char* str) {
+    addArray(str, str ? strlen(str) + 1 : 0);
+  }
+
+  void finish(int rc, std::chrono::nanoseconds latency) {
+    rc_ = rc;
+    latency_ = latency;
+  }
+
+ private:
+  friend class SdkCallLogWriter;
+
+  void append(const void* data, size_t len) {
+    auto bytes = static_cast<const uint8_t*>(data);
+    payload_.insert(payload_.end(), bytes, bytes + len);
+  }
+
+  uint64_t callId_{0};
+  int rc_{0};
+  std::chrono::nanoseconds latency_{0};
+  std::vector<uint8_t> payload_;
+};
+
+class SdkCallLogWriter {
+ public:
+  /*
+   * The log named by --sdk_call_log, opened on first use, or null if no log
+   * is wanted.
+   */
+  static SdkCallLogWriter* get();
+
+  /*
+   * Time since the log was opened, for the start of a call.
+   */
+  std::chrono::nanoseconds now() const;
+
+  void append(SdkCallRecord* record, std::chrono::nanoseconds start);
+
+  void flush();
+
+ private:
+  explicit SdkCallLogWriter(const std::string& path);
+  ~SdkCallLogWriter();
+
+  // Forbidden copy constructor and assignment operator
+  SdkCallLogWriter(SdkCallLogWriter const &) = delete;
+  SdkCallLogWriter& operator=(SdkCallLogWriter const &) = delete;
+
+  std::chrono::steady_clock::time_point opened_;
+  std::mutex lock_;
+  std::FILE* file_{nullptr};
+};
+
+/*
+ * What a pointer argument pointed to, read back from the log.
+ */
+template <typename T>
+struct SdkCallArg {
+  bool present{false};
+  std::vector<T> elems;
+
+  T* get() {
+    return present ? elems.data() : nullptr;
+  }
+};
+
+class SdkCallLogReader {
+ public:
+  explicit SdkCallLogReader(const std::string& path);
+  ~SdkCallLogReader();
+
+  /*
+   * Move to the next record, false at the end of the log.
+   */
+  bool next();
+
+  uint64_t callId() const {
+    return callId_;
+  }
+  int rc() const {
+    return rc_;
+  }
+  std::chrono::nanoseconds start() const {
+    return start_;
+  }
+  std::chrono::nanoseconds latency() const {
+    return latency_;
+  }
+
+  template <typename T>
+  T value() {
+    T value;
+    read(&value, sizeof(value));
+    return value;
+  }
+
+  template <typename T>
+  SdkCallArg<T> array() {
+    SdkCallArg<T> arg;
+    auto count = value<uint32_t>();
+    arg.present = count > 0;
+    arg.elems.resize(count);
+    read(arg.elems.data(), count * sizeof(T));
+    return arg;
+  }
+
+ private:
+  // Forbidden copy constructor and assignment operator
+  SdkCallLogReader(SdkCallLogReader const &) = delete;
+  SdkCallLogReader& operator=(SdkCallLogReader const &) = delete;
+
+  void read(void* out, size_t len);
+
+  std::FILE* file_{nullptr};
+  uint64_t callId_{0};
+  int rc_{0};
+  std::chrono::nanoseconds start_{0};
+  std::chrono::nanoseconds latency_{0};
+  std::vector<uint8_t> payload_;
+  size_t offset_{0};
+};
+
+/*
+ * Implemented by the replayer HeaderToRecorder generates.
+ */
+// Reissue the call at the reader's current record; false if the call id is
+// not one the replayer knows
+bool replaySdkCall(SdkCallLogReader* log, int* rc);
+// Name of the function for a call id, or null if unknown
+const char* sdkCallName(uint64_t callId);
+
+}} // facebook::fboss
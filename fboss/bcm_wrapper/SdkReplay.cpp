@@ -0,0 +1,130 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/bcm_wrapper/SdkCallLog.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <folly/Format.h>
+#include <folly/init/Init.h>
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
+DEFINE_string(replay_log, "", "SDK call log recorded with --sdk_call_log");
+DEFINE_bool(
+    dry_run,
+    false,
+    "Don't make any SDK calls, only total up the recorded latencies");
+DEFINE_bool(
+    paced,
+    false,
+    "Keep the recorded gaps between calls, rather than replaying them back "
+    "to back");
+
+using namespace facebook::fboss;
+using std::chrono::duration_cast;
+using std::chrono::microseconds;
+using std::chrono::nanoseconds;
+using std::chrono::steady_clock;
+
+namespace {
+
+struct ApiStats {
+  uint64_t calls{0};
+  nanoseconds recorded{0};
+  nanoseconds replayed{0};
+  // Replayed calls that returned something else than when recorded
+  uint64_t rcMismatches{0};
+};
+
+} // namespace
+
+/*
+ * Reissue the SDK calls from a log recorded on a production agent, against
+ * the switch this runs on, and compare the time each API takes with the time
+ * it took when recorded. With --dry_run this only reads the log, as a timing
+ * model of the recorded sequence.
+ *
+ * The log has to start with the agent, as the calls that initialize the SDK
+ * and the unit are replayed from it like any other.
+ */
+int main(int argc, char** argv) {
+  folly::init(&argc, &argv, true);
+  if (FLAGS_replay_log.empty()) {
+    LOG(ERROR) << "--replay_log is required";
+    return 1;
+  }
+
+  SdkCallLogReader log(FLAGS_replay_log);
+  std::map<uint64_t, ApiStats> apis;
+  uint64_t unknown = 0;
+  auto begin = steady_clock::now();
+  while (log.next()) {
+    auto& stats = apis[log.callId()];
+    ++stats.calls;
+    stats.recorded += log.latency();
+    if (FLAGS_dry_run) {
+      continue;
+    }
+    if (FLAGS_paced) {
+      auto due = begin + log.start();
+      while (steady_clock::now() < due) {
+      }
+    }
+    int rc = 0;
+    auto start = steady_clock::now();
+    if (!replaySdkCall(&log, &rc)) {
+      ++unknown;
+      continue;
+    }
+    stats.replayed += steady_clock::now() - start;
+    if (rc != log.rc()) {
+      ++stats.rcMismatches;
+    }
+  }
+  auto elapsed = steady_clock::now() - begin;
+
+  std::vector<std::pair<uint64_t, ApiStats>> byTime(apis.begin(), apis.end());
+  std::sort(byTime.begin(), byTime.end(), [](const auto& a, const auto& b) {
+    return std::max(a.second.recorded, a.second.replayed) >
+        std::max(b.second.recorded, b.second.replayed);
+  });
+  std::cout << folly::sformat(
+      "{:<48} {:>10} {:>14} {:>14} {:>10}\n",
+      "api",
+      "calls",
+      "recorded_us",
+      "replayed_us",
+      "rc_diffs");
+  nanoseconds totalRecorded{0};
+  for (const auto& entry : byTime) {
+    const auto& stats = entry.second;
+    auto name = sdkCallName(entry.first);
+    totalRecorded += stats.recorded;
+    std::cout << folly::sformat(
+        "{:<48} {:>10} {:>14} {:>14} {:>10}\n",
+        name ? name : folly::sformat("{:#x}", entry.first),
+        stats.calls,
+        duration_cast<microseconds>(stats.recorded).count(),
+        duration_cast<microseconds>(stats.replayed).count(),
+        stats.rcMismatches);
+  }
+  std::cout << folly::sformat(
+      "recorded SDK time {}us, replay took {}us, {} calls unknown to this "
+      "replayer\n",
+      duration_cast<microseconds>(totalRecorded).count(),
+      duration_cast<microseconds>(elapsed).count(),
+      unknown);
+  return 0;
+}
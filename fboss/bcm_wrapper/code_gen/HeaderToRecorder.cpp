@@ -0,0 +1,61 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "RecorderGen.h"
+
+#include <clang/Tooling/CommonOptionsParser.h>
+#include <clang/Tooling/Tooling.h>
+#include <llvm/Support/CommandLine.h>
+
+static llvm::cl::extrahelp commonHelp(
+    clang::tooling::CommonOptionsParser::HelpMessage);
+static llvm::cl::OptionCategory headerToRecorderCategory(
+    "HeaderToRecorder options");
+
+enum class Output { Recorder, Replayer, WrapFlags };
+static llvm::cl::opt<Output> output(
+    "output",
+    llvm::cl::desc("What to generate from the SDK headers"),
+    llvm::cl::values(
+        clEnumValN(
+            Output::Recorder,
+            "recorder",
+            "__wrap_ functions recording each SDK call, for the agent"),
+        clEnumValN(
+            Output::Replayer,
+            "replayer",
+            "replaySdkCall() reissuing recorded calls, for sdk_replay"),
+        clEnumValN(
+            Output::WrapFlags,
+            "wrap-flags",
+            "linker options routing SDK calls through the recorder")),
+    llvm::cl::init(Output::Recorder),
+    llvm::cl::cat(headerToRecorderCategory));
+
+int main(int argc, char **argv) {
+  clang::tooling::CommonOptionsParser optionsParser(
+      argc, const_cast<const char**>(argv), headerToRecorderCategory);
+  clang::tooling::ClangTool tool(
+      optionsParser.getCompilations(), optionsParser.getSourcePathList());
+  facebook::fboss::RecorderGen gen(optionsParser.getSourcePathList());
+  clang::ast_matchers::MatchFinder mf;
+  mf.addMatcher(facebook::fboss::RecorderGen::functionDeclMatcher(), &gen);
+  tool.run(clang::tooling::newFrontendActionFactory(&mf).get());
+  switch (output) {
+    case Output::Recorder:
+      llvm::outs() << gen.getRecorder();
+      break;
+    case Output::Replayer:
+      llvm::outs() << gen.getReplayer();
+      break;
+    case Output::WrapFlags:
+      llvm::outs() << gen.getWrapFlags();
+      break;
+  }
+}
@@ -0,0 +1,273 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "RecorderGen.h"
+
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+#include <folly/Format.h>
+
+namespace {
+
+constexpr auto kSdkPrefix = "opennsl_";
+
+bool isCountName(const std::string& name) {
+  return name.find("count") != std::string::npos ||
+      name.find("size") != std::string::npos ||
+      name.find("max") != std::string::npos;
+}
+
+} // namespace
+
+namespace facebook { namespace fboss {
+
+RecordedParam::RecordedParam(
+    const clang::ParmVarDecl& param,
+    const clang::ParmVarDecl* previous) {
+  name = param.getName().str();
+  if (name.empty()) {
+    throw std::runtime_error("unnamed parameter");
+  }
+  auto qt = param.getType();
+  type = qt.getAsString();
+  if (qt->isFunctionPointerType()) {
+    throw std::runtime_error("function pointer parameter " + name);
+  }
+  if (!qt->isPointerType()) {
+    if (!qt->isScalarType() && !qt->isStructureType()) {
+      throw std::runtime_error("unsupported parameter " + name);
+    }
+    kind = Kind::VALUE;
+    elementType = qt.getUnqualifiedType().getAsString();
+    return;
+  }
+
+  auto pointee = qt->getPointeeType();
+  if (pointee->isVoidType() || pointee->isPointerType() ||
+      pointee->isIncompleteType()) {
+    throw std::runtime_error("opaque pointer parameter " + name);
+  }
+  elementType = pointee.getUnqualifiedType().getAsString();
+  if (pointee->isCharType()) {
+    kind = Kind::STRING;
+    return;
+  }
+  kind = Kind::ARRAY;
+  // The SDK passes arrays as (int count, T *array)
+  count = "1";
+  if (previous && previous->getType()->isIntegerType() &&
+      isCountName(previous->getName().str())) {
+    count = previous->getName().str();
+  }
+}
+
+RecordedFunction::RecordedFunction(const clang::FunctionDecl& function) {
+  name = function.getName().str();
+  if (!function.getReturnType()->isIntegerType()) {
+    throw std::runtime_error("does not return an SDK error code");
+  }
+  if (function.isVariadic()) {
+    throw std::runtime_error("variadic");
+  }
+  const clang::ParmVarDecl* previous = nullptr;
+  for (const clang::ParmVarDecl* param : function.parameters()) {
+    params_.emplace_back(*param, previous);
+    previous = param;
+  }
+}
+
+uint64_t RecordedFunction::callId(const std::string& name) {
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (auto c : name) {
+    hash = (hash ^ static_cast<uint8_t>(c)) * 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+std::string RecordedFunction::getRecorder() const {
+  std::stringstream decl;
+  std::stringstream args;
+  std::stringstream record;
+  int i = 0;
+  for (const auto& param : params_) {
+    if (i++) {
+      decl << ", ";
+      args << ", ";
+    }
+    decl << param.type << " " << param.name;
+    args << param.name;
+    switch (param.kind) {
+      case RecordedParam::Kind::VALUE:
+        record << folly::sformat("  record.addValue({});\n", param.name);
+        break;
+      case RecordedParam::Kind::ARRAY:
+        if (param.count == "1") {
+          record << folly::sformat("  record.addArray({}, 1);\n", param.name);
+        } else {
+          record << folly::sformat(
+              "  record.addArray({0}, {1} > 0 ? {1} : 0);\n",
+              param.name,
+              param.count);
+        }
+        break;
+      case RecordedParam::Kind::STRING:
+        record << folly::sformat("  record.addString({});\n", param.name);
+        break;
+    }
+  }
+
+  std::stringstream ss;
+  ss << folly::sformat("extern \"C\" int __real_{}({});\n", name, decl.str());
+  ss << folly::sformat("extern \"C\" int __wrap_{}({}) {{\n", name, decl.str());
+  ss << "  auto log = facebook::fboss::SdkCallLogWriter::get();\n";
+  ss << "  if (!log) {\n";
+  ss << folly::sformat("    return __real_{}({});\n", name, args.str());
+  ss << "  }\n";
+  ss << folly::sformat(
+      "  facebook::fboss::SdkCallRecord record({:#x}ULL);\n", callId(name));
+  ss << record.str();
+  ss << "  auto start = log->now();\n";
+  ss << folly::sformat("  int rc = __real_{}({});\n", name, args.str());
+  ss << "  record.finish(rc, log->now() - start);\n";
+  ss << "  log->append(&record, start);\n";
+  ss << "  return rc;\n";
+  ss << "}\n";
+  return ss.str();
+}
+
+std::string RecordedFunction::getReplayCase() const {
+  std::stringstream read;
+  std::stringstream args;
+  int i = 0;
+  for (const auto& param : params_) {
+    if (i++) {
+      args << ", ";
+    }
+    switch (param.kind) {
+      case RecordedParam::Kind::VALUE:
+        read << folly::sformat(
+            "      auto {} = log->value<{}>();\n",
+            param.name,
+            param.elementType);
+        args << param.name;
+        break;
+      case RecordedParam::Kind::ARRAY:
+      case RecordedParam::Kind::STRING:
+        read << folly::sformat(
+            "      auto {} = log->array<{}>();\n",
+            param.name,
+            param.elementType);
+        args << param.name << ".get()";
+        break;
+    }
+  }
+
+  std::stringstream ss;
+  ss << folly::sformat("    case {:#x}ULL: {{ // {}\n", callId(name), name);
+  ss << read.str();
+  ss << folly::sformat("      *rc = {}({});\n", name, args.str());
+  ss << "      return true;\n";
+  ss << "    }\n";
+  return ss.str();
+}
+
+const clang::ast_matchers::DeclarationMatcher&
+RecorderGen::functionDeclMatcher() {
+  static const clang::ast_matchers::DeclarationMatcher matcher =
+      clang::ast_matchers::functionDecl(
+          clang::ast_matchers::matchesName("^::opennsl_"))
+          .bind("fd");
+  return matcher;
+}
+
+RecorderGen::RecorderGen(std::vector<std::string> headers)
+    : headers_(std::move(headers)) {}
+
+void RecorderGen::run(
+    const clang::ast_matchers::MatchFinder::MatchResult& result) {
+  const clang::FunctionDecl* fd =
+      result.Nodes.getNodeAs<clang::FunctionDecl>("fd");
+  if (!fd || fd->hasBody() || !fd->isFirstDecl()) {
+    // Inline helpers in the headers are not SDK calls
+    return;
+  }
+  auto name = fd->getName().str();
+  if (name.compare(0, strlen(kSdkPrefix), kSdkPrefix) != 0) {
+    return;
+  }
+  try {
+    functions_.push_back(std::make_unique<RecordedFunction>(*fd));
+  } catch (const std::exception& e) {
+    skipped_.push_back(folly::sformat("{}: {}", name, e.what()));
+  }
+}
+
+std::string RecorderGen::getIncludes() const {
+  std::stringstream ss;
+  ss << "#include \"fboss/bcm_wrapper/SdkCallLog.h\"\n\n";
+  ss << "extern \"C\" {\n";
+  for (const auto& header : headers_) {
+    ss << folly::sformat("#include \"{}\"\n", header);
+  }
+  ss << "}\n";
+  return ss.str();
+}
+
+std::string RecorderGen::getRecorder() const {
+  std::stringstream ss;
+  ss << "// Generated by HeaderToRecorder, do not edit.\n";
+  for (const auto& skipped : skipped_) {
+    ss << "// Not recorded: " << skipped << "\n";
+  }
+  ss << getIncludes() << "\n";
+  for (const auto& function : functions_) {
+    ss << function->getRecorder() << "\n";
+  }
+  return ss.str();
+}
+
+std::string RecorderGen::getReplayer() const {
+  std::stringstream ss;
+  ss << "// Generated by HeaderToRecorder, do not edit.\n";
+  ss << getIncludes() << "\n";
+  ss << "namespace facebook { namespace fboss {\n\n";
+  ss << "bool replaySdkCall(SdkCallLogReader* log, int* rc) {\n";
+  ss << "  switch (log->callId()) {\n";
+  for (const auto& function : functions_) {
+    ss << function->getReplayCase();
+  }
+  ss << "  }\n";
+  ss << "  return false;\n";
+  ss << "}\n\n";
+  ss << "const char* sdkCallName(uint64_t callId) {\n";
+  ss << "  switch (callId) {\n";
+  for (const auto& function : functions_) {
+    ss << folly::sformat(
+        "    case {:#x}ULL:\n      return \"{}\";\n",
+        RecordedFunction::callId(function->name),
+        function->name);
+  }
+  ss << "  }\n";
+  ss << "  return nullptr;\n";
+  ss << "}\n\n";
+  ss << "}} // facebook::fboss\n";
+  return ss.str();
+}
+
+std::string RecorderGen::getWrapFlags() const {
+  std::stringstream ss;
+  for (const auto& function : functions_) {
+    ss << "-Wl,--wrap=" << function->name << "\n";
+  }
+  return ss.str();
+}
+
+}} // facebook::fboss
@@ -0,0 +1,103 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <clang/ASTMatchers/ASTMatchers.h>
+#include <clang/ASTMatchers/ASTMatchFinder.h>
+#include <clang/Tooling/Tooling.h>
+
+namespace facebook { namespace fboss {
+
+/*
+ * One parameter of an SDK function, and how the recorder saves it.
+ */
+class RecordedParam {
+ public:
+  enum class Kind {
+    // Saved by value
+    VALUE,
+    // A pointer to count elements, count being another parameter's name or 1
+    ARRAY,
+    // A NUL terminated char*
+    STRING,
+  };
+
+  // Throws std::runtime_error if the parameter can't be recorded, eg a
+  // function pointer or a pointer to an opaque type
+  RecordedParam(
+      const clang::ParmVarDecl& param,
+      const clang::ParmVarDecl* previous);
+
+  std::string name;
+  // Type as declared, eg "opennsl_l3_route_t *"
+  std::string type;
+  // Unqualified type of a VALUE, or of what an ARRAY or STRING points to
+  std::string elementType;
+  Kind kind;
+  std::string count;
+};
+
+/*
+ * An SDK function the recorder wraps. Knows how to write the __wrap_ function
+ * that records the call and the replayer case that reissues it.
+ */
+class RecordedFunction {
+ public:
+  // Throws std::runtime_error if the function can't be recorded
+  explicit RecordedFunction(const clang::FunctionDecl& function);
+
+  // FNV-1a of the name, the call id in the log
+  static uint64_t callId(const std::string& name);
+
+  std::string getRecorder() const;
+  std::string getReplayCase() const;
+
+  std::string name;
+
+ private:
+  std::vector<RecordedParam> params_;
+};
+
+/*
+ * Visits the SDK function declarations of the parsed headers and generates
+ * the SDK call recorder and replayer sources from them, along with the
+ * linker options that route the agent's SDK calls through the recorder. See
+ * fboss/bcm_wrapper/SdkCallLog.h for the log itself.
+ */
+class RecorderGen : public clang::ast_matchers::MatchFinder::MatchCallback {
+ public:
+  explicit RecorderGen(std::vector<std::string> headers);
+  void run(
+      const clang::ast_matchers::MatchFinder::MatchResult& result) override;
+  // matcher for the SDK functions
+  static const clang::ast_matchers::DeclarationMatcher& functionDeclMatcher();
+
+  // __wrap_ functions, to link into the agent
+  std::string getRecorder() const;
+  // replaySdkCall() and sdkCallName(), to link into sdk_replay
+  std::string getReplayer() const;
+  // -Wl,--wrap= options, one per line
+  std::string getWrapFlags() const;
+
+ private:
+  std::string getIncludes() const;
+
+  std::vector<std::string> headers_;
+  std::vector<std::unique_ptr<RecordedFunction>> functions_;
+  // Functions left out, and why
+  std::vector<std::string> skipped_;
+};
+
+}} // facebook::fboss
@@ -0,0 +1,347 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+#ifndef COMPACT_RADIX_TREE_H
+#error "This should only be included by CompactRadixTree.h"
+#endif
+
+namespace facebook { namespace network {
+
+template<typename IPADDRTYPE, typename T>
+typename CompactRadixTree<IPADDRTYPE, T>::TreeDirection
+CompactRadixTree<IPADDRTYPE, T>::searchDirection(const TreeNode& node,
+    const IPADDRTYPE& toSearch, uint8_t toSearchMasklen) {
+  // Same rules as RadixTreeNode::searchDirection
+  if (node.masklen < toSearchMasklen) {
+    if (toSearch.mask(node.masklen) == node.ipAddress) {
+      // Note that bit lookup is 0 indexed.
+      return toSearch.getNthMSBit(node.masklen) == 1 ? TreeDirection::RIGHT :
+        TreeDirection::LEFT;
+    }
+    return TreeDirection::PARENT;
+  }
+  if (node.masklen == toSearchMasklen && node.ipAddress == toSearch) {
+    return TreeDirection::THIS_NODE;
+  }
+  return TreeDirection::PARENT;
+}
+
+template<typename IPADDRTYPE, typename T>
+typename CompactRadixTree<IPADDRTYPE, T>::NodeIndex
+CompactRadixTree<IPADDRTYPE, T>::longestMatchImpl(const IPADDRTYPE& ipaddr,
+    uint8_t masklen, bool& foundExact, bool includeNonValueNodes) const {
+  // Can't trust the clients to have 0s in all bits after mask length
+  const auto toMatch = ipaddr.mask(masklen);
+
+  auto parent = TreeNode::kNoNode;
+  auto lastValueNodeSeen = TreeNode::kNoNode;
+  auto curNode = root_;
+  while (curNode != TreeNode::kNoNode) {
+    const auto& node = nodes_[curNode];
+    auto searchDir = searchDirection(node, toMatch, masklen);
+    if (searchDir == TreeDirection::PARENT) {
+      // We took one extra step in the hope of getting a better
+      // match but this didn't succeed. So back up one step
+      curNode = parent;
+      break;
+    }
+    if (node.hasValue) {
+      lastValueNodeSeen = curNode;
+    }
+    if (searchDir == TreeDirection::THIS_NODE) {
+      foundExact = node.hasValue || includeNonValueNodes;
+      break;
+    }
+    auto next = searchDir == TreeDirection::LEFT ? node.left : node.right;
+    if (next == TreeNode::kNoNode) {
+      break;
+    }
+    parent = curNode;
+    curNode = next;
+  }
+  return includeNonValueNodes ? curNode : lastValueNodeSeen;
+}
+
+template<typename IPADDRTYPE, typename T>
+typename CompactRadixTree<IPADDRTYPE, T>::NodeIndex
+CompactRadixTree<IPADDRTYPE, T>::allocNode(const IPADDRTYPE& ip,
+    uint8_t masklen) {
+  if (!freeList_.empty()) {
+    auto index = freeList_.back();
+    freeList_.pop_back();
+    nodes_[index] = TreeNode(ip, masklen);
+    return index;
+  }
+  CHECK_LT(nodes_.size(), TreeNode::kNoNode);
+  nodes_.emplace_back(ip, masklen);
+  values_.emplace_back();
+  return static_cast<NodeIndex>(nodes_.size() - 1);
+}
+
+template<typename IPADDRTYPE, typename T>
+void CompactRadixTree<IPADDRTYPE, T>::freeNode(NodeIndex index) {
+  values_[index].clear();
+  nodes_[index].hasValue = false;
+  nodes_[index].parent = TreeNode::kNoNode;
+  nodes_[index].left = TreeNode::kNoNode;
+  nodes_[index].right = TreeNode::kNoNode;
+  freeList_.push_back(index);
+}
+
+template<typename IPADDRTYPE, typename T>
+void CompactRadixTree<IPADDRTYPE, T>::replaceChild(NodeIndex parent,
+    NodeIndex oldChild, NodeIndex newChild) {
+  if (parent == TreeNode::kNoNode) {
+    CHECK_EQ(root_, oldChild);
+    root_ = newChild;
+  } else if (nodes_[parent].left == oldChild) {
+    nodes_[parent].left = newChild;
+  } else {
+    CHECK_EQ(nodes_[parent].right, oldChild);
+    nodes_[parent].right = newChild;
+  }
+  if (newChild != TreeNode::kNoNode) {
+    nodes_[newChild].parent = parent;
+  }
+}
+
+/*
+ * Insert follows RadixTree::insert step for step, the only difference being
+ * that nodes are addressed by index. Every allocNode may move the arena, so
+ * no TreeNode references are held across allocations.
+ */
+template <typename IPADDRTYPE, typename T>
+template <typename VALUE>
+std::pair<typename CompactRadixTree<IPADDRTYPE, T>::Iterator, bool>
+CompactRadixTree<IPADDRTYPE, T>::insert(const IPADDRTYPE& ipaddr,
+    uint8_t mask, VALUE&& value) {
+  auto foundExact = false;
+  // Can't trust the clients to have 0s in all bits after mask length
+  auto toAdd = ipaddr.mask(mask);
+  auto bestMatch = longestMatchImpl(toAdd, mask, foundExact,
+      true /*include non value nodes*/);
+  if (foundExact) {
+    CHECK_NE(bestMatch, TreeNode::kNoNode);
+    if (nodes_[bestMatch].hasValue) {
+      // Prefix already exists in the tree
+      return std::make_pair(Iterator(this, bestMatch), false);
+    }
+    nodes_[bestMatch].hasValue = true;
+    values_[bestMatch] = std::forward<VALUE>(value);
+    ++size_;
+    return std::make_pair(Iterator(this, bestMatch), true);
+  }
+  auto newNode = allocNode(toAdd, mask);
+  nodes_[newNode].hasValue = true;
+  values_[newNode] = std::forward<VALUE>(value);
+
+  if (bestMatch == TreeNode::kNoNode) {
+    if (root_ == TreeNode::kNoNode) {
+      // Empty tree, make this the root
+      root_ = newNode;
+    } else {
+      // The root exists but this ipaddr, mask failed to match even the
+      // root. We need a less specific root.
+      auto oldRoot = root_;
+      auto prefix = IPADDRTYPE::longestCommonPrefix(
+        {nodes_[oldRoot].ipAddress, nodes_[oldRoot].masklen}, {toAdd, mask});
+      auto newRoot = newNode;
+      if (prefix.first != toAdd || prefix.second != mask) {
+        // Add new root as a non value internal node
+        newRoot = allocNode(prefix.first, prefix.second);
+      }
+      auto oldRootDirection = searchDirection(nodes_[newRoot],
+          nodes_[oldRoot].ipAddress, nodes_[oldRoot].masklen);
+      CHECK(oldRootDirection == TreeDirection::LEFT ||
+         oldRootDirection == TreeDirection::RIGHT);
+      setChild(newRoot, oldRootDirection, oldRoot);
+      if (newRoot != newNode) {
+        setChild(newRoot, oldRootDirection == TreeDirection::LEFT ?
+            TreeDirection::RIGHT : TreeDirection::LEFT, newNode);
+      }
+      nodes_[newRoot].parent = TreeNode::kNoNode;
+      root_ = newRoot;
+    }
+  } else {
+    auto toAddDirection = searchDirection(nodes_[bestMatch], toAdd, mask);
+    CHECK(toAddDirection == TreeDirection::LEFT ||
+        toAddDirection == TreeDirection::RIGHT);
+    auto bestMatchChild = child(bestMatch, toAddDirection);
+    if (bestMatchChild == TreeNode::kNoNode) {
+      setChild(bestMatch, toAddDirection, newNode);
+    } else {
+      auto prefix = IPADDRTYPE::longestCommonPrefix(
+        {nodes_[bestMatchChild].ipAddress, nodes_[bestMatchChild].masklen},
+        {toAdd, mask});
+      if (prefix.first != toAdd || prefix.second != mask) {
+        // We need to insert a non value internal node as a parent of
+        // bestMatchChild and new node.
+        auto internalNode = allocNode(prefix.first, prefix.second);
+        setChild(bestMatch, toAddDirection, internalNode);
+        auto newNodeDirection = searchDirection(nodes_[internalNode],
+            toAdd, mask);
+        CHECK(newNodeDirection == TreeDirection::LEFT ||
+            newNodeDirection == TreeDirection::RIGHT);
+        setChild(internalNode, newNodeDirection, newNode);
+        setChild(internalNode, newNodeDirection == TreeDirection::LEFT ?
+            TreeDirection::RIGHT : TreeDirection::LEFT, bestMatchChild);
+      } else {
+        // New node needs to be inserted  b/w bestMatch and bestMatchChild
+        setChild(bestMatch, toAddDirection, newNode);
+        auto bestMatchChildDirection = searchDirection(nodes_[newNode],
+            nodes_[bestMatchChild].ipAddress, nodes_[bestMatchChild].masklen);
+        DCHECK(bestMatchChildDirection == TreeDirection::LEFT ||
+            bestMatchChildDirection == TreeDirection::RIGHT);
+        setChild(newNode, bestMatchChildDirection, bestMatchChild);
+      }
+    }
+  }
+  ++size_;
+  return std::make_pair(Iterator(this, newNode), true);
+}
+
+/*
+ * As with RadixTree::erase, all non value nodes must have 2 children
+ * before and after erase. See RadixTree::erase for why each case below
+ * maintains that.
+ */
+template<typename IPADDRTYPE, typename T>
+bool CompactRadixTree<IPADDRTYPE, T>::eraseImpl(NodeIndex toDelete) {
+  if (toDelete == TreeNode::kNoNode) {
+    return false;
+  }
+  CHECK(nodes_[toDelete].hasValue);
+  auto parent = nodes_[toDelete].parent;
+  auto left = nodes_[toDelete].left;
+  auto right = nodes_[toDelete].right;
+  if (left != TreeNode::kNoNode && right != TreeNode::kNoNode) {
+    // The prefix is still the longest common prefix of its children, keep
+    // it around as a non value node.
+    values_[toDelete].clear();
+    nodes_[toDelete].hasValue = false;
+  } else if (left != TreeNode::kNoNode || right != TreeNode::kNoNode) {
+    // One child, let the grandparent adopt it.
+    replaceChild(parent, toDelete, left != TreeNode::kNoNode ? left : right);
+    freeNode(toDelete);
+  } else if (parent != TreeNode::kNoNode) {
+    replaceChild(parent, toDelete, TreeNode::kNoNode);
+    freeNode(toDelete);
+    if (!nodes_[parent].hasValue) {
+      // A non value node left with one child must go as well
+      auto sibling = nodes_[parent].left != TreeNode::kNoNode ?
+        nodes_[parent].left : nodes_[parent].right;
+      CHECK_NE(sibling, TreeNode::kNoNode);
+      replaceChild(nodes_[parent].parent, parent, sibling);
+      freeNode(parent);
+    }
+  } else {
+    // To be deleted node has no parent and no children. Its thus the root
+    // (and only node) in the tree.
+    CHECK_EQ(root_, toDelete);
+    root_ = TreeNode::kNoNode;
+    freeNode(toDelete);
+  }
+  --size_;
+  if (root_ == TreeNode::kNoNode) {
+    // Empty tree, drop the free list as well
+    clear();
+  }
+  return true;
+}
+
+template<typename IPADDRTYPE, typename T>
+void CompactRadixTree<IPADDRTYPE, T>::compact() {
+  std::vector<TreeNode> nodes;
+  std::vector<folly::Optional<T>> values;
+  nodes.reserve(nodeCount());
+  values.reserve(nodeCount());
+  std::vector<NodeIndex> newIndex(nodes_.size(), TreeNode::kNoNode);
+  // Preorder walk, including non value nodes. Parents are always visited
+  // before their children, so their new index is known by then.
+  for (auto itr = ConstIterator(this, root_, true); !itr.atEnd(); ++itr) {
+    auto oldIndex = itr.index();
+    const auto& oldNode = nodes_[oldIndex];
+    newIndex[oldIndex] = static_cast<NodeIndex>(nodes.size());
+    nodes.push_back(oldNode);
+    values.push_back(std::move(values_[oldIndex]));
+    auto& newNode = nodes.back();
+    if (oldNode.parent != TreeNode::kNoNode) {
+      newNode.parent = newIndex[oldNode.parent];
+      auto& parent = nodes[newNode.parent];
+      // Look at the old parent, the new one may already have a remapped
+      // left child whose new index equals oldIndex.
+      if (nodes_[oldNode.parent].left == oldIndex) {
+        parent.left = newIndex[oldIndex];
+      } else {
+        parent.right = newIndex[oldIndex];
+      }
+    }
+  }
+  root_ = nodes.empty() ? TreeNode::kNoNode : 0;
+  nodes_.swap(nodes);
+  values_.swap(values);
+  freeList_.clear();
+  freeList_.shrink_to_fit();
+}
+
+template<typename IPADDRTYPE, typename T>
+bool CompactRadixTree<IPADDRTYPE, T>::subTreesEqual(
+    const CompactRadixTree& treeA, NodeIndex nodeA,
+    const CompactRadixTree& treeB, NodeIndex nodeB) {
+  if (nodeA == TreeNode::kNoNode || nodeB == TreeNode::kNoNode) {
+    return nodeA == nodeB;
+  }
+  const auto& a = treeA.nodes_[nodeA];
+  const auto& b = treeB.nodes_[nodeB];
+  if (a.ipAddress != b.ipAddress || a.masklen != b.masklen ||
+      a.hasValue != b.hasValue ||
+      (a.hasValue && !(treeA.value(nodeA) == treeB.value(nodeB)))) {
+    return false;
+  }
+  return subTreesEqual(treeA, a.left, treeB, b.left) &&
+    subTreesEqual(treeA, a.right, treeB, b.right);
+}
+
+template <typename IPADDRTYPE, typename T, typename TREE,
+         typename DESIREDITERTYPE>
+void CompactRadixTreeIteratorImpl<IPADDRTYPE, T, TREE, DESIREDITERTYPE>::
+increment() {
+  // Same walk as RadixTreeIteratorImpl::radixTreeItrIncrement
+  auto previous = TreeNode::kNoNode;
+  auto done = false;
+  while (!done && cursor_ != TreeNode::kNoNode) {
+    const auto& node = treeNode();
+    if (cursor_ == subTreeEnd_) {
+      // We are iterating over sub-tree and we reached the end
+      cursor_ = TreeNode::kNoNode;
+    } else if (previous == TreeNode::kNoNode || node.parent == previous) {
+      // Going down the tree
+      previous = cursor_;
+      if (node.left != TreeNode::kNoNode) {
+        cursor_ = node.left;
+      } else if (node.right != TreeNode::kNoNode) {
+        cursor_ = node.right;
+      } else {
+        cursor_ = node.parent;
+        continue;
+      }
+    } else if (node.left == previous) {
+      // Coming up the tree from left.
+      previous = cursor_;
+      if (node.right != TreeNode::kNoNode) {
+        cursor_ = node.right;
+      } else {
+        cursor_ = node.parent;
+        continue;
+      }
+    } else if (node.right == previous) {
+      // Coming up the tree from right
+      previous = cursor_;
+      cursor_ = node.parent;
+      continue;
+    }
+    done = (cursor_ == TreeNode::kNoNode || includeNonValueNodes_ ||
+        treeNode().hasValue);
+  }
+  normalize();
+}
+
+}} //facebook::network
@@ -0,0 +1,472 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#ifndef COMPACT_RADIX_TREE_H
+#define COMPACT_RADIX_TREE_H
+
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <glog/logging.h>
+
+#include <folly/Conv.h>
+#include <folly/Optional.h>
+#include <folly/IPAddressV4.h>
+#include <folly/IPAddressV6.h>
+
+namespace facebook { namespace network {
+
+/*
+ * CompactRadixTree is a path compressed binary trie with the same shape as
+ * RadixTree, but laid out for lookup speed rather than for pointer
+ * stability:
+ *
+ * - All nodes live in a single contiguous arena (std::vector) and refer to
+ *   each other by 32 bit index instead of by pointer. A node is just the
+ *   prefix, mask length and three links, so an IPv6 node takes 32 bytes and
+ *   two nodes share a cache line.
+ * - Values are stored out of line, in a second arena indexed by the same
+ *   node index. A lookup only touches the value of the node it returns.
+ * - Slots freed by erase are recycled. compact() re-lays the arena in DFS
+ *   preorder so that a walk from the root mostly moves forward in memory;
+ *   call it after bulk loading a table.
+ *
+ * The API mirrors RadixTree (insert/erase/exactMatch/longestMatch,
+ * preorder iterators which dereference to themselves and expose
+ * ipAddress(), masklen() and value()), so users of RadixTree<AddrT, T> can
+ * switch over without changing call sites. The differences are:
+ * - Iterators are invalidated by insert, erase and compact (any call that
+ *   may grow or re-lay the arena), not just by erasing the node they
+ *   point at.
+ * - There is no node delete callback, and no trail lookups.
+ * - Only IPAddressV4 and IPAddressV6 are supported. Use one tree per
+ *   address family.
+ */
+template<typename IPADDRTYPE>
+struct CompactRadixTreeNode {
+  typedef uint32_t NodeIndex;
+  static constexpr NodeIndex kNoNode = ~NodeIndex(0);
+
+  CompactRadixTreeNode(const IPADDRTYPE& ipAddr, uint8_t mlen):
+    ipAddress(ipAddr), masklen(mlen) {}
+
+  bool isLeaf() const { return left == kNoNode && right == kNoNode; }
+
+  IPADDRTYPE ipAddress;
+  uint8_t masklen{0};
+  bool hasValue{false};
+  NodeIndex parent{kNoNode};
+  NodeIndex left{kNoNode};
+  NodeIndex right{kNoNode};
+};
+
+template<typename IPADDRTYPE>
+constexpr typename CompactRadixTreeNode<IPADDRTYPE>::NodeIndex
+CompactRadixTreeNode<IPADDRTYPE>::kNoNode;
+
+/*
+ * Forward Iterator to traverse a CompactRadixTree
+ * Traverses the tree in DFS/preorder fashion, same as RadixTreeIterator
+ */
+template <typename IPADDRTYPE, typename T, typename TREE,
+         typename DESIREDITERTYPE>
+class CompactRadixTreeIteratorImpl :
+  public std::iterator<std::forward_iterator_tag, DESIREDITERTYPE> {
+ public:
+  typedef DESIREDITERTYPE ValueType;
+  typedef CompactRadixTreeNode<IPADDRTYPE> TreeNode;
+  typedef typename TreeNode::NodeIndex NodeIndex;
+
+  // default constructor
+  CompactRadixTreeIteratorImpl() {
+  }
+  CompactRadixTreeIteratorImpl(TREE* tree, NodeIndex cursor,
+      bool includeNonValNodes = false): tree_(tree), cursor_(cursor),
+  includeNonValueNodes_(includeNonValNodes) {
+    if (cursor_ != TreeNode::kNoNode &&
+        (!includeNonValueNodes_ && !treeNode().hasValue)) {
+      ++(*this);
+    }
+    normalize();
+  }
+
+  DESIREDITERTYPE& operator++() {
+    checkDereference(); // check if we are already at end
+    increment();
+    return static_cast<DESIREDITERTYPE&>(*this);
+  }
+
+  DESIREDITERTYPE  operator++(int) {
+    DESIREDITERTYPE tmp(static_cast<DESIREDITERTYPE&>(*this));
+    ++(*this);
+    return tmp;
+  }
+
+  // Returns iterator over subtree of current node.
+  DESIREDITERTYPE subTreeIterator() const {
+    DESIREDITERTYPE tmp(static_cast<const DESIREDITERTYPE&>(*this));
+    if (cursor_ != TreeNode::kNoNode) {
+      tmp.subTreeEnd_ = treeNode().parent;
+      tmp.normalize();
+    }
+    return tmp;
+  }
+
+  void reset() {
+    cursor_ = TreeNode::kNoNode;
+    subTreeEnd_ = TreeNode::kNoNode;
+    includeNonValueNodes_ = false;
+  }
+
+  bool operator==(const CompactRadixTreeIteratorImpl& r) const {
+    return cursor_ == r.cursor_ && subTreeEnd_ == r.subTreeEnd_ &&
+      includeNonValueNodes_ == r.includeNonValueNodes_;
+  }
+
+  bool operator!=(const CompactRadixTreeIteratorImpl& r) const {
+    return !(*this == r);
+  }
+
+  const DESIREDITERTYPE& operator*() const {
+    checkDereference();
+    return static_cast<const DESIREDITERTYPE&>(*this);
+  }
+
+  const DESIREDITERTYPE* operator->() const {
+    checkDereference();
+    return static_cast<const DESIREDITERTYPE*>(this);
+  }
+
+  DESIREDITERTYPE& operator*() {
+    checkDereference();
+    return static_cast<DESIREDITERTYPE&>(*this);
+  }
+
+  DESIREDITERTYPE* operator->() {
+    checkDereference();
+    return static_cast<DESIREDITERTYPE*>(this);
+  }
+
+  bool atEnd() const { return cursor_ == TreeNode::kNoNode; }
+
+  T& value() const {
+    checkDereference();
+    checkValueNode();
+    return tree_->value(cursor_);
+  }
+
+  const IPADDRTYPE& ipAddress() const {
+    checkDereference();
+    return treeNode().ipAddress;
+  }
+
+  uint8_t masklen() const {
+    checkDereference();
+    return treeNode().masklen;
+  }
+
+  bool isValueNode() const {
+    checkDereference();
+    return treeNode().hasValue;
+  }
+
+  std::string str(bool printValue = true) const {
+    checkDereference();
+    auto nodeStr = folly::to<std::string>(ipAddress().str(), "/",
+        masklen());
+    if (printValue) {
+      nodeStr += !isValueNode() ? "(*)" :
+        folly::to<std::string>("(", value(), ")");
+    }
+    return nodeStr;
+  }
+
+  // Arena index of the node at this cursor location
+  NodeIndex index() const { return cursor_; }
+  TREE* tree() const { return tree_; }
+  bool includeNonValueNodes() const { return includeNonValueNodes_; }
+
+  void checkValueNode() const {
+    CHECK(treeNode().hasValue);
+  }
+ protected:
+  const TreeNode& treeNode() const { return tree_->node(cursor_); }
+  void increment();
+  void normalize() {
+    if (cursor_ == TreeNode::kNoNode) {
+      reset();
+    }
+  }
+  void checkDereference() const {
+    CHECK(!atEnd());
+  }
+  TREE* tree_{nullptr};
+  NodeIndex cursor_{TreeNode::kNoNode};
+  NodeIndex subTreeEnd_{TreeNode::kNoNode};
+  bool  includeNonValueNodes_{false};
+};
+
+template <typename IPADDRTYPE, typename T>
+class CompactRadixTree;
+
+/*
+ * Iterator over a compact radix tree
+ */
+template <typename IPADDRTYPE, typename T>
+class CompactRadixTreeIterator : public CompactRadixTreeIteratorImpl<
+  IPADDRTYPE, T, CompactRadixTree<IPADDRTYPE, T>,
+  CompactRadixTreeIterator<IPADDRTYPE, T>> {
+ public:
+  typedef CompactRadixTreeIteratorImpl<IPADDRTYPE, T,
+          CompactRadixTree<IPADDRTYPE, T>,
+          CompactRadixTreeIterator<IPADDRTYPE, T>> IteratorImpl;
+  using IteratorImpl::checkValueNode;
+ private:
+  using IteratorImpl::tree_;
+  using IteratorImpl::cursor_;
+  using IteratorImpl::checkDereference;
+
+ public:
+  // Inherit constructors
+  using IteratorImpl::IteratorImpl;
+  // default constructor
+  CompactRadixTreeIterator() {
+  }
+
+  template<typename VALUE>
+  void setValue(VALUE&& value) const {
+    checkDereference();
+    checkValueNode();
+    tree_->value(cursor_) = std::forward<VALUE>(value);
+  }
+};
+
+/*
+ * Const Iterator over a compact radix tree
+ */
+template <typename IPADDRTYPE, typename T>
+class CompactRadixTreeConstIterator : public CompactRadixTreeIteratorImpl<
+  IPADDRTYPE, const T, const CompactRadixTree<IPADDRTYPE, T>,
+  CompactRadixTreeConstIterator<IPADDRTYPE, T>> {
+ public:
+  typedef CompactRadixTreeIteratorImpl<IPADDRTYPE, const T,
+          const CompactRadixTree<IPADDRTYPE, T>,
+          CompactRadixTreeConstIterator<IPADDRTYPE, T>> IteratorImpl;
+  typedef CompactRadixTreeIterator<IPADDRTYPE, T> NonConstIterator;
+
+  // Inherit constructors
+  using IteratorImpl::IteratorImpl;
+  // default constructor
+  CompactRadixTreeConstIterator() {
+  }
+  explicit CompactRadixTreeConstIterator(NonConstIterator itr) :
+    CompactRadixTreeConstIterator(itr.tree(), itr.index(),
+        itr.includeNonValueNodes()) {}
+};
+
+template<typename IPADDRTYPE, typename T>
+class CompactRadixTree {
+ public:
+  typedef CompactRadixTreeNode<IPADDRTYPE>             TreeNode;
+  typedef typename TreeNode::NodeIndex                 NodeIndex;
+  typedef CompactRadixTreeIterator<IPADDRTYPE, T>      Iterator;
+  typedef CompactRadixTreeConstIterator<IPADDRTYPE, T> ConstIterator;
+
+  CompactRadixTree() {}
+
+  CompactRadixTree(const CompactRadixTree& r) = delete;
+  CompactRadixTree& operator=(const CompactRadixTree& r) = delete;
+  CompactRadixTree(CompactRadixTree&& r) noexcept {
+    *this = std::move(r);
+  }
+  // Move radix tree onto this
+  CompactRadixTree& operator=(CompactRadixTree&& r) noexcept {
+    nodes_ = std::move(r.nodes_);
+    values_ = std::move(r.values_);
+    freeList_ = std::move(r.freeList_);
+    root_ = r.root_;
+    size_ = r.size_;
+    r.clear();
+    return *this;
+  }
+
+  Iterator  begin()  { return Iterator(this, root_); }
+  Iterator  end()    { return Iterator(this, TreeNode::kNoNode); }
+  ConstIterator begin() const { return ConstIterator(this, root_); }
+  ConstIterator end()   const {
+    return ConstIterator(this, TreeNode::kNoNode);
+  }
+
+  // Free all nodes and clear the tree.
+  void clear() {
+    nodes_.clear();
+    values_.clear();
+    freeList_.clear();
+    root_ = TreeNode::kNoNode;
+    size_ = 0;
+  }
+
+  /*
+   * Clone this radix tree onto another. Since nodes are linked by index
+   * this is a straight copy of the arenas.
+   */
+  template <typename U = T>
+  typename std::enable_if<std::is_copy_constructible<U>::value,
+                          CompactRadixTree>::type
+    clone() const {
+    static_assert(std::is_same<T, U>::value,
+        "clone template type must be the same as Radix tree value type");
+    CompactRadixTree copy;
+    copy.nodes_ = nodes_;
+    copy.values_ = values_;
+    copy.freeList_ = freeList_;
+    copy.root_ = root_;
+    copy.size_ = size_;
+    return copy;
+  }
+
+  /*
+   * Insert a IP, mask, value in tree. Returns inserted node, true
+   * if a node was inserted. If a node for IP, mask already existed
+   * in the tree we return that node, false.
+   */
+  template <typename VALUE>
+  std::pair<Iterator, bool>  insert(const IPADDRTYPE& ipaddr,
+      uint8_t masklen, VALUE&& value);
+
+  // Erase a IP, mask
+  bool erase(const IPADDRTYPE& ipaddr, uint8_t masklen) {
+    return erase(exactMatch(ipaddr, masklen));
+  }
+
+  // Erase node pointed to be iterator
+  bool erase(Iterator itr) {
+    return eraseImpl(itr.index());
+  }
+
+  // Given a IP, mask return the node with longest match for it
+  // NOTE: masklen is unsigned and must be <= ipaddr.bitCount()
+  ConstIterator longestMatch(const IPADDRTYPE& ipaddr,
+      uint8_t masklen) const {
+    auto foundExact = false;
+    return ConstIterator(this,
+        longestMatchImpl(ipaddr, masklen, foundExact));
+  }
+
+  // Non const longest match
+  Iterator longestMatch(const IPADDRTYPE& ipaddr, uint8_t masklen) {
+    auto foundExact = false;
+    return Iterator(this, longestMatchImpl(ipaddr, masklen, foundExact));
+  }
+
+  /*
+   * Given a IP, mask return node whose IP, mask which matches this prefix
+   * exactly
+   */
+  ConstIterator exactMatch(const IPADDRTYPE& ipaddr,
+      uint8_t masklen) const {
+    auto foundExact = false;
+    auto match = longestMatchImpl(ipaddr, masklen, foundExact);
+    return ConstIterator(this, foundExact ? match : TreeNode::kNoNode);
+  }
+
+  // Non const exact match
+  Iterator exactMatch(const IPADDRTYPE& ipaddr, uint8_t masklen) {
+    auto foundExact = false;
+    auto match = longestMatchImpl(ipaddr, masklen, foundExact);
+    return Iterator(this, foundExact ? match : TreeNode::kNoNode);
+  }
+
+  /*
+   * Re-lay the node arena in DFS preorder and drop free slots. Invalidates
+   * all iterators.
+   */
+  void compact();
+
+  // Equality
+  bool operator==(const CompactRadixTree& r) const {
+    return size_ == r.size_ && subTreesEqual(*this, root_, r, r.root_);
+  }
+
+  // Inequality
+  bool operator!=(const CompactRadixTree& r) const {
+    return !(*this == r);
+  }
+
+  size_t size()  const { return size_; }
+  // Number of nodes in the tree, including non value nodes
+  size_t nodeCount() const { return nodes_.size() - freeList_.size(); }
+  /*
+   * Bytes held by the arenas. Does not include heap memory owned by the
+   * values themselves.
+   */
+  size_t memoryUsage() const {
+    return nodes_.capacity() * sizeof(TreeNode) +
+      values_.capacity() * sizeof(folly::Optional<T>) +
+      freeList_.capacity() * sizeof(NodeIndex);
+  }
+
+  NodeIndex root() const { return root_; }
+  const TreeNode& node(NodeIndex index) const { return nodes_[index]; }
+  const T& value(NodeIndex index) const { return values_[index].value(); }
+  T& value(NodeIndex index) { return values_[index].value(); }
+
+ private:
+  enum class TreeDirection { LEFT, RIGHT, PARENT, THIS_NODE};
+
+  // Given a IP, mask pair determine where that might lie w.r.t. node
+  static TreeDirection searchDirection(const TreeNode& node,
+      const IPADDRTYPE& toSearch, uint8_t masklen);
+
+  static bool subTreesEqual(const CompactRadixTree& treeA, NodeIndex nodeA,
+      const CompactRadixTree& treeB, NodeIndex nodeB);
+
+  // Worker function to do the actual longest match lookup.
+  NodeIndex longestMatchImpl(const IPADDRTYPE& ipaddr, uint8_t masklen,
+      bool& foundExact, bool includeNonValueNodes = false) const;
+
+  bool eraseImpl(NodeIndex toDelete);
+
+  NodeIndex& child(NodeIndex parent, TreeDirection direction) {
+    DCHECK(direction == TreeDirection::LEFT ||
+        direction == TreeDirection::RIGHT);
+    return direction == TreeDirection::LEFT ? nodes_[parent].left :
+      nodes_[parent].right;
+  }
+
+  // Make newChild the child of parent in the given direction
+  void setChild(NodeIndex parent, TreeDirection direction,
+      NodeIndex newChild) {
+    child(parent, direction) = newChild;
+    if (newChild != TreeNode::kNoNode) {
+      nodes_[newChild].parent = parent;
+    }
+  }
+
+  // Replace oldChild with newChild under parent, or at the root
+  void replaceChild(NodeIndex parent, NodeIndex oldChild,
+      NodeIndex newChild);
+
+  /*
+   * Allocate a node, reusing a previously freed slot if there is one.
+   * May reallocate the arena, so callers must not hold TreeNode references
+   * across this call.
+   */
+  NodeIndex allocNode(const IPADDRTYPE& ip, uint8_t masklen);
+  void freeNode(NodeIndex index);
+
+  std::vector<TreeNode> nodes_;
+  std::vector<folly::Optional<T>> values_;
+  std::vector<NodeIndex> freeList_;
+  NodeIndex root_{TreeNode::kNoNode};
+  size_t  size_{0};
+};
+
+}} // facebook::network
+
+#include "CompactRadixTree-inl.h"
+
+#endif //COMPACT_RADIX_TREE_H
@@ -0,0 +1,164 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+#include "ConcurrentTimeSeriesWithMinMax.h"
+
+#include <cassert>
+#include <stdexcept>
+#include <thread>
+
+namespace facebook {
+namespace fboss {
+
+template <class ValueType>
+constexpr typename ConcurrentTimeSeriesWithMinMax<ValueType>::BucketId
+    ConcurrentTimeSeriesWithMinMax<ValueType>::kClearing;
+template <class ValueType>
+constexpr typename ConcurrentTimeSeriesWithMinMax<ValueType>::BucketId
+    ConcurrentTimeSeriesWithMinMax<ValueType>::kUnused;
+
+template <class ValueType>
+ConcurrentTimeSeriesWithMinMax<ValueType>::ConcurrentTimeSeriesWithMinMax(
+    Duration interval,
+    Duration bucketInterval)
+    : bucketInterval_(bucketInterval),
+      numBuckets_(interval.count() / bucketInterval.count()),
+      buckets_(new Bucket[numBuckets_]) {
+  assert(interval.count() >= bucketInterval.count());
+  assert(bucketInterval.count() > 0);
+  assert(interval.count() > 0);
+}
+
+template <class ValueType>
+typename ConcurrentTimeSeriesWithMinMax<ValueType>::BucketId
+ConcurrentTimeSeriesWithMinMax<ValueType>::bucketId(Time t) const {
+  auto sinceEpoch =
+      std::chrono::duration_cast<Duration>(t.time_since_epoch());
+  return sinceEpoch.count() / bucketInterval_.count();
+}
+
+/*
+ * Claim the bucket for the value's time if it still holds an earlier one,
+ * then fold the value into its min and max.
+ */
+template <class ValueType>
+void ConcurrentTimeSeriesWithMinMax<ValueType>::addValue(
+    ValueType value,
+    Time t) {
+  auto id = bucketId(t);
+  if (id <= bucketId(std::chrono::system_clock::now()) -
+          static_cast<BucketId>(numBuckets_)) {
+    return;
+  }
+  auto& bucket = buckets_[id % numBuckets_];
+  auto current = bucket.id.load(std::memory_order_acquire);
+  while (current != id) {
+    if (current == kClearing) {
+      std::this_thread::yield();
+      current = bucket.id.load(std::memory_order_acquire);
+    } else if (current > id) {
+      // Reused for a later time already
+      return;
+    } else if (bucket.id.compare_exchange_weak(
+                   current, kClearing, std::memory_order_acquire)) {
+      bucket.max.store(
+          std::numeric_limits<ValueType>::lowest(), std::memory_order_relaxed);
+      bucket.min.store(
+          std::numeric_limits<ValueType>::max(), std::memory_order_relaxed);
+      bucket.id.store(id, std::memory_order_release);
+      current = id;
+    }
+  }
+
+  auto max = bucket.max.load(std::memory_order_relaxed);
+  while (value > max &&
+         !bucket.max.compare_exchange_weak(
+             max, value, std::memory_order_relaxed)) {
+  }
+  auto min = bucket.min.load(std::memory_order_relaxed);
+  while (value < min &&
+         !bucket.min.compare_exchange_weak(
+             min, value, std::memory_order_relaxed)) {
+  }
+}
+
+/*
+ * A bucket is skipped if it is cleared for a new time while being read,
+ * as it then no longer holds values from the range asked for.
+ */
+template <class ValueType>
+template <typename Fn>
+void ConcurrentTimeSeriesWithMinMax<ValueType>::forEachBucket(
+    BucketId first,
+    BucketId last,
+    Fn fn) const {
+  bool isValid = false;
+  for (size_t i = 0; i < numBuckets_; ++i) {
+    const auto& bucket = buckets_[i];
+    auto id = bucket.id.load(std::memory_order_acquire);
+    if (id < first || id > last) {
+      continue;
+    }
+    auto min = bucket.min.load(std::memory_order_relaxed);
+    auto max = bucket.max.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (bucket.id.load(std::memory_order_relaxed) != id) {
+      continue;
+    }
+    isValid = true;
+    fn(min, max);
+  }
+  if (!isValid) {
+    throw std::runtime_error("Empty Buffer!");
+  }
+}
+
+template <class ValueType>
+ValueType ConcurrentTimeSeriesWithMinMax<ValueType>::getMax() const {
+  auto now = bucketId(std::chrono::system_clock::now());
+  auto oldest = now - static_cast<BucketId>(numBuckets_) + 1;
+  ValueType result = std::numeric_limits<ValueType>::lowest();
+  forEachBucket(oldest, now, [&](ValueType, ValueType max) {
+    result = std::max(result, max);
+  });
+  return result;
+}
+
+template <class ValueType>
+ValueType ConcurrentTimeSeriesWithMinMax<ValueType>::getMin() const {
+  auto now = bucketId(std::chrono::system_clock::now());
+  auto oldest = now - static_cast<BucketId>(numBuckets_) + 1;
+  ValueType result = std::numeric_limits<ValueType>::max();
+  forEachBucket(oldest, now, [&](ValueType min, ValueType) {
+    result = std::min(result, min);
+  });
+  return result;
+}
+
+template <class ValueType>
+ValueType ConcurrentTimeSeriesWithMinMax<ValueType>::getMax(
+    Time start,
+    Time end) const {
+  ValueType result = std::numeric_limits<ValueType>::lowest();
+  // Buckets starting at or after start and before end
+  auto first = bucketId(start - std::chrono::nanoseconds(1)) + 1;
+  auto last = bucketId(end - std::chrono::nanoseconds(1));
+  forEachBucket(first, last, [&](ValueType, ValueType max) {
+    result = std::max(result, max);
+  });
+  return result;
+}
+
+template <class ValueType>
+ValueType ConcurrentTimeSeriesWithMinMax<ValueType>::getMin(
+    Time start,
+    Time end) const {
+  ValueType result = std::numeric_limits<ValueType>::max();
+  auto first = bucketId(start - std::chrono::nanoseconds(1)) + 1;
+  auto last = bucketId(end - std::chrono::nanoseconds(1));
+  forEachBucket(first, last, [&](ValueType min, ValueType) {
+    result = std::min(result, min);
+  });
+  return result;
+}
+
+} // namespace fboss
+} // namespace facebook
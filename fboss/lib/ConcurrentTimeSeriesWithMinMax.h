@@ -0,0 +1,103 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <type_traits>
+
+namespace facebook {
+namespace fboss {
+
+/*
+ * A TimeSeriesWithMinMax that many threads can add values to at once
+ * without taking a lock, for recording hot path samples such as per packet
+ * latencies.
+ *
+ * The buckets are a fixed ring indexed by time, each holding its min and
+ * max as atomics that adding a value updates with compare and swap. The
+ * thread that first adds to a bucket once its time has come round again
+ * clears it; other threads adding to that bucket wait for the clear, which
+ * is a handful of stores. Values older than the ring, or for a bucket that
+ * has already been reused for a later time, are dropped.
+ *
+ * Only integral value types are supported, so the atomics are lock free.
+ */
+template <class ValueType>
+class ConcurrentTimeSeriesWithMinMax {
+  static_assert(
+      std::is_integral<ValueType>::value,
+      "ConcurrentTimeSeriesWithMinMax values must be integers");
+
+ public:
+  using Time = std::chrono::time_point<std::chrono::system_clock>;
+  using Duration = std::chrono::seconds;
+
+  /*
+   * interval : Length of time to record max over.
+   * bucketInterval : The granularity of the data.
+   */
+  explicit ConcurrentTimeSeriesWithMinMax(
+      Duration interval = Duration(60),
+      Duration bucketInterval = Duration(1));
+
+  /*
+   * Add a value at the current time.
+   */
+  void addValue(ValueType value) {
+    addValue(value, std::chrono::system_clock::now());
+  }
+
+  /*
+   * Add a value at a specified time.
+   */
+  void addValue(ValueType value, Time t);
+
+  /*
+   * Get the maximum and minimum values recorded over the interval. These
+   * throw std::runtime_error if nothing was.
+   */
+  ValueType getMax() const;
+  ValueType getMin() const;
+
+  /*
+   * Get the maximum and minimum values in the buckets starting in
+   * [start, end). These throw std::runtime_error if there are none.
+   */
+  ValueType getMax(Time start, Time end) const;
+  ValueType getMin(Time start, Time end) const;
+
+ private:
+  // Number of a bucket, counting bucketInterval_ from the epoch
+  using BucketId = int64_t;
+  // Id of a bucket being cleared for its new time
+  static constexpr BucketId kClearing = std::numeric_limits<BucketId>::min();
+  // Id of a bucket nothing has been added to
+  static constexpr BucketId kUnused = kClearing + 1;
+
+  struct Bucket {
+    std::atomic<BucketId> id{kUnused};
+    std::atomic<ValueType> max{std::numeric_limits<ValueType>::lowest()};
+    std::atomic<ValueType> min{std::numeric_limits<ValueType>::max()};
+  };
+
+  BucketId bucketId(Time t) const;
+
+  /*
+   * Fold fn(min, max) over the buckets with ids in [first, last], throwing
+   * if there are none.
+   */
+  template <typename Fn>
+  void forEachBucket(BucketId first, BucketId last, Fn fn) const;
+
+  Duration bucketInterval_;
+  size_t numBuckets_;
+  std::unique_ptr<Bucket[]> buckets_;
+};
+
+} // namespace fboss
+} // namespace facebook
+
+#include "ConcurrentTimeSeriesWithMinMax-inl.h"
@@ -0,0 +1,161 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "HugePageMemory.h"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+#include <folly/Exception.h>
+#include <folly/Format.h>
+#include <folly/logging/xlog.h>
+
+#include <sys/mman.h>
+
+namespace {
+constexpr size_t kKb = 1024;
+
+bool mapped(void* addr) {
+  return addr != MAP_FAILED;
+}
+
+void* mapAnonymous(size_t size, int extraFlags) {
+  return ::mmap(
+      nullptr,
+      size,
+      PROT_READ | PROT_WRITE,
+      MAP_PRIVATE | MAP_ANONYMOUS | extraFlags,
+      -1,
+      0);
+}
+} // namespace
+
+namespace facebook {
+namespace fboss {
+
+constexpr size_t HugePageMemory::kHugePageSize;
+
+HugePageMemory::HugePageMemory(size_t size, bool allowFallback)
+    : size_((size + kHugePageSize - 1) & ~(kHugePageSize - 1)) {
+  if (size_ == 0) {
+    folly::throwSystemErrorExplicit(EINVAL, "size is 0");
+  }
+
+  // Reserved huge pages are populated up front, or the map fails
+  addr_ = mapAnonymous(size_, MAP_HUGETLB | MAP_POPULATE);
+  if (mapped(addr_)) {
+    backing_ = Backing::HUGETLB;
+  } else if (allowFallback) {
+    XLOG(DBG1) << "No reserved huge pages for " << size_
+               << " bytes: " << folly::errnoStr(errno);
+    // Map twice the size to find a huge page aligned range, which is what
+    // khugepaged and the fault path need to use transparent huge pages
+    auto raw = mapAnonymous(size_ + kHugePageSize, 0);
+    if (!mapped(raw)) {
+      addr_ = nullptr;
+      folly::throwSystemError(
+          folly::sformat("Cannot map {:#x} bytes", size_));
+    }
+    auto start = reinterpret_cast<uintptr_t>(raw);
+    auto aligned = (start + kHugePageSize - 1) & ~(kHugePageSize - 1);
+    if (aligned > start) {
+      ::munmap(raw, aligned - start);
+    }
+    auto end = start + size_ + kHugePageSize;
+    if (end > aligned + size_) {
+      ::munmap(reinterpret_cast<void*>(aligned + size_),
+               end - (aligned + size_));
+    }
+    addr_ = reinterpret_cast<void*>(aligned);
+    ::madvise(addr_, size_, MADV_HUGEPAGE);
+    // Fault the pages in now that the advice is set, so the fault path can
+    // hand out huge pages
+    std::memset(addr_, 0, size_);
+    backing_ = Backing::NORMAL;
+  } else {
+    addr_ = nullptr;
+    folly::throwSystemError(
+        folly::sformat("Cannot map {:#x} bytes of huge pages", size_));
+  }
+
+  size_t pageSize = 0;
+  size_t anonHugeBytes = 0;
+  pageInfo(addr_, &pageSize, &anonHugeBytes);
+  if (backing_ == Backing::HUGETLB && pageSize < kHugePageSize) {
+    // Should not happen, but the point of the region is its page size
+    XLOG(WARN) << "MAP_HUGETLB region has " << pageSize << " byte pages";
+    backing_ = Backing::NORMAL;
+  } else if (backing_ == Backing::NORMAL && anonHugeBytes > 0) {
+    backing_ = Backing::TRANSPARENT;
+  }
+
+  XLOG(INFO) << folly::format(
+      "Mapped {:#x} bytes at {:#x}, backed by {} pages ({} bytes in "
+      "transparent huge pages)",
+      size_,
+      reinterpret_cast<uint64_t>(addr_),
+      backingName(backing_),
+      anonHugeBytes);
+}
+
+HugePageMemory::~HugePageMemory() {
+  if (addr_) {
+    ::munmap(addr_, size_);
+  }
+}
+
+const char* HugePageMemory::backingName(Backing backing) {
+  switch (backing) {
+    case Backing::HUGETLB:
+      return "hugetlb";
+    case Backing::TRANSPARENT:
+      return "transparent huge";
+    case Backing::NORMAL:
+      return "normal";
+  }
+  return "unknown";
+}
+
+void HugePageMemory::pageInfo(
+    const void* addr,
+    size_t* kernelPageSize,
+    size_t* anonHugeBytes) {
+  *kernelPageSize = 0;
+  *anonHugeBytes = 0;
+  auto target = reinterpret_cast<uintptr_t>(addr);
+  std::ifstream smaps("/proc/self/smaps");
+  std::string line;
+  bool inRange = false;
+  while (std::getline(smaps, line)) {
+    unsigned long start = 0;
+    unsigned long end = 0;
+    // Mapping lines start with "start-end", attribute lines with "Name:"
+    if (sscanf(line.c_str(), "%lx-%lx ", &start, &end) == 2) {
+      if (inRange) {
+        return;
+      }
+      inRange = target >= start && target < end;
+      continue;
+    }
+    if (!inRange) {
+      continue;
+    }
+    size_t kb = 0;
+    if (sscanf(line.c_str(), "KernelPageSize: %zu kB", &kb) == 1) {
+      *kernelPageSize = kb * kKb;
+    } else if (sscanf(line.c_str(), "AnonHugePages: %zu kB", &kb) == 1) {
+      *anonHugeBytes = kb * kKb;
+    }
+  }
+}
+
+} // namespace fboss
+} // namespace facebook
@@ -0,0 +1,78 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include <boost/noncopyable.hpp>
+
+#include <cstddef>
+
+namespace facebook {
+namespace fboss {
+
+/**
+ * An anonymous memory region backed by huge pages where the system has
+ * them, so that buffers touched on every packet fit in a few TLB entries.
+ *
+ * Reserved huge pages (MAP_HUGETLB) are tried first, then transparent huge
+ * pages, then normal pages. Either way the backing is verified against
+ * /proc/self/smaps once the region is populated, and backing() reports what
+ * the region actually got.
+ */
+class HugePageMemory : public boost::noncopyable {
+ public:
+  enum class Backing {
+    HUGETLB,
+    TRANSPARENT,
+    NORMAL,
+  };
+
+  static constexpr size_t kHugePageSize = 2 * 1024 * 1024;
+
+  /**
+   * Map at least size bytes, rounded up to whole huge pages. Throws
+   * std::system_error if the region can't be mapped, or if it can't be
+   * backed by huge pages and allowFallback is false.
+   */
+  explicit HugePageMemory(size_t size, bool allowFallback = true);
+
+  ~HugePageMemory();
+
+  void* data() const {
+    return addr_;
+  }
+
+  size_t getSize() const {
+    return size_;
+  }
+
+  Backing backing() const {
+    return backing_;
+  }
+
+  static const char* backingName(Backing backing);
+
+  /**
+   * Kernel page size and transparent huge page bytes of the mapping at
+   * addr, as the kernel reports them in /proc/self/smaps. Both are 0 if no
+   * mapping contains addr.
+   */
+  static void pageInfo(
+      const void* addr,
+      size_t* kernelPageSize,
+      size_t* anonHugeBytes);
+
+ private:
+  void* addr_{nullptr};
+  size_t size_{0};
+  Backing backing_{Backing::NORMAL};
+};
+
+} // namespace fboss
+} // namespace facebook
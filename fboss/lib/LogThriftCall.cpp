@@ -9,7 +9,35 @@
  */
 
 #include "fboss/lib/LogThriftCall.h"
+
+#include "common/stats/ServiceData.h"
+
+#include <folly/Conv.h>
+#include <folly/String.h>
+#include <folly/Synchronized.h>
 #include <folly/logging/xlog.h>
+#include <gflags/gflags.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+DEFINE_int32(
+    thrift_call_log_sample_rate,
+    1,
+    "Log one in this many calls of each thrift method");
+DEFINE_string(
+    thrift_call_log_method_sample_rates,
+    "",
+    "Comma separated method=rate pairs overriding "
+    "--thrift_call_log_sample_rate for those methods, such as "
+    "getAllPortInfo=100,getCounters=1000");
+DEFINE_int32(
+    thrift_call_log_slow_ms,
+    0,
+    "Always log thrift calls that take at least this long, 0 to not");
 
 using apache::thrift::Cpp2ConnContext;
 using apache::thrift::Cpp2RequestContext;
@@ -17,9 +45,53 @@ using apache::thrift::Cpp2RequestContext;
 namespace facebook {
 namespace fboss {
 
+struct LogThriftCall::Method {
+  explicit Method(const std::string& func)
+      : histogram(folly::to<std::string>("thrift_call.", func, ".us")) {
+    sampleRate = FLAGS_thrift_call_log_sample_rate;
+    std::vector<folly::StringPiece> rates;
+    folly::split(',', FLAGS_thrift_call_log_method_sample_rates, rates, true);
+    for (auto rate : rates) {
+      folly::StringPiece name, value;
+      if (folly::split('=', rate, name, value) && name == func) {
+        sampleRate = folly::tryTo<int32_t>(value).value_or(sampleRate);
+      }
+    }
+    sampleRate = std::max(sampleRate, 1);
+    fbData->addHistogram(histogram, 1000, 0, 1000000);
+    fbData->exportHistogramPercentile(histogram, 50, 99);
+  }
+
+  int32_t sampleRate{1};
+  std::atomic<uint64_t> calls{0};
+  const std::string histogram;
+};
+
+LogThriftCall::Method& LogThriftCall::getMethod(const std::string& func) {
+  // Leaked, so calls still in flight at exit can use it
+  static auto* methods = new folly::Synchronized<
+      std::unordered_map<std::string, std::unique_ptr<Method>>>();
+  {
+    auto locked = methods->rlock();
+    auto it = locked->find(func);
+    if (it != locked->end()) {
+      return *it->second;
+    }
+  }
+  auto locked = methods->wlock();
+  auto& method = (*locked)[func];
+  if (!method) {
+    method = std::make_unique<Method>(func);
+  }
+  return *method;
+}
+
 LogThriftCall::LogThriftCall(const std::string& func, Cpp2RequestContext* ctx)
-    : func_(func), start_(std::chrono::steady_clock::now()) {
-  if (!ctx) {
+    : func_(func),
+      start_(std::chrono::steady_clock::now()),
+      method_(getMethod(func)) {
+  sampled_ = method_.calls++ % method_.sampleRate == 0;
+  if (!ctx || !sampled_) {
     return;
   }
   Cpp2ConnContext* ctx2 = ctx->getConnectionContext();
@@ -34,9 +106,17 @@ LogThriftCall::LogThriftCall(const std::string& func, Cpp2RequestContext* ctx)
 }
 
 LogThriftCall::~LogThriftCall() {
-  auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+  auto us = std::chrono::duration_cast<std::chrono::microseconds>(
       std::chrono::steady_clock::now() - start_);
-  XLOG(INFO) << func_ << " thrift request succeeded in " << ms.count() << "ms";
+  fbData->addHistogramValue(method_.histogram, us.count());
+  auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(us);
+  bool slow = FLAGS_thrift_call_log_slow_ms > 0 &&
+      ms.count() >= FLAGS_thrift_call_log_slow_ms;
+  if (!sampled_ && !slow) {
+    return;
+  }
+  XLOG(INFO) << func_ << " thrift request succeeded in " << ms.count() << "ms"
+             << (slow ? " (slow)" : "");
 }
 
 } // namespace fboss
@@ -11,11 +11,23 @@
 #pragma once
 
 #include <thrift/lib/cpp2/server/Cpp2ConnContext.h>
+#include <chrono>
 #include <string>
 
 namespace facebook {
 namespace fboss {
 
+/*
+ * Logs a thrift call when it is received and when it returns, and records
+ * how long it took in a histogram for its method, which is always done.
+ *
+ * Logging is sampled: only one in --thrift_call_log_sample_rate calls of a
+ * method are logged, or the rate given for it in
+ * --thrift_call_log_method_sample_rates, so frequently polled methods need
+ * not format and write log lines for every call. Calls taking at least
+ * --thrift_call_log_slow_ms are logged when they return whether sampled or
+ * not.
+ */
 class LogThriftCall {
  public:
   explicit LogThriftCall(
@@ -24,8 +36,14 @@ class LogThriftCall {
   ~LogThriftCall();
 
  private:
+  struct Method;
+
+  static Method& getMethod(const std::string& func);
+
   const std::string func_;
   const std::chrono::time_point<std::chrono::steady_clock> start_;
+  Method& method_;
+  bool sampled_{false};
 };
 
 } // namespace fboss
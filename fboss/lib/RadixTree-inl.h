@@ -5,6 +5,18 @@
 
 namespace facebook { namespace network {
 
+template<typename IPADDRTYPE, typename T>
+void RadixTreeNode<IPADDRTYPE, T>::Deleter::operator()(
+    RadixTreeNode* node) const {
+  auto pool = node->pool();
+  if (pool) {
+    node->~RadixTreeNode();
+    pool->deallocate(node);
+  } else {
+    delete node;
+  }
+}
+
 template<typename IPADDRTYPE, typename T>
 typename RadixTreeNode<IPADDRTYPE, T>::TreeDirection
 RadixTreeNode<IPADDRTYPE, T>::searchDirection(const IPADDRTYPE& toSearch,
@@ -140,7 +152,7 @@ RadixTree<IPADDRTYPE, T, TreeTraits>::insert(const IPADDRTYPE& ipaddr,
       // specific root.
       auto prefix = IPADDRTYPE::longestCommonPrefix(
         {root_->ipAddress(), root_->masklen()}, {toAdd, mask});
-      std::unique_ptr<TreeNode> newRoot = nullptr;
+      NodePtr newRoot = nullptr;
       if (prefix.first == toAdd && prefix.second == mask) {
         // To be added node is the new root
         newRoot = std::move(newNode);
@@ -209,7 +221,7 @@ RadixTree<IPADDRTYPE, T, TreeTraits>::insert(const IPADDRTYPE& ipaddr,
         // bestMatchChild and new node.
         auto internalNode = makeNode(prefix.first, prefix.second);
         auto internalNodeRaw = internalNode.get();
-        std::unique_ptr<TreeNode> oldBestMatchChild = nullptr;
+        NodePtr oldBestMatchChild = nullptr;
         if (toAddDirection ==  TreeDirection::LEFT) {
           oldBestMatchChild = bestMatch->resetLeft(std::move(internalNode));
         } else {
@@ -228,7 +240,7 @@ RadixTree<IPADDRTYPE, T, TreeTraits>::insert(const IPADDRTYPE& ipaddr,
         CHECK(internalNode == nullptr);
       } else {
         // New node needs to be inserted  b/w bestMatch and bestMatchChild
-        std::unique_ptr<TreeNode> oldBestMatchChild = nullptr;
+        NodePtr oldBestMatchChild = nullptr;
         if (toAddDirection ==  TreeDirection::LEFT) {
           oldBestMatchChild = bestMatch->resetLeft(std::move(newNode));
         } else {
@@ -391,18 +403,43 @@ bool RadixTree<IPADDRTYPE, T, TreeTraits>::radixSubTreesEqual(
 
 
 template<typename IPADDRTYPE, typename T, typename TreeTraits>
-std::unique_ptr<typename RadixTree<IPADDRTYPE, T, TreeTraits>::TreeNode>
+template<typename... VALUE>
+typename RadixTree<IPADDRTYPE, T, TreeTraits>::NodePtr
+RadixTree<IPADDRTYPE, T, TreeTraits>::makeNode(const IPADDRTYPE& ip,
+    uint8_t masklen, VALUE&&... value) {
+  if (!useNodePool_) {
+    return NodePtr(new TreeNode(ip, masklen, std::forward<VALUE>(value)...,
+          nodeDeleteCallback_));
+  }
+  if (!pool_) {
+    pool_ = std::make_unique<RadixTreeNodePool>(sizeof(TreeNode));
+  }
+  static_assert(alignof(TreeNode) <= alignof(std::max_align_t),
+      "RadixTreeNodePool slots are only aligned to max_align_t");
+  auto slot = pool_->allocate();
+  TreeNode* node = nullptr;
+  try {
+    node = new (slot) TreeNode(ip, masklen, std::forward<VALUE>(value)...,
+          nodeDeleteCallback_);
+  } catch (...) {
+    pool_->deallocate(slot);
+    throw;
+  }
+  node->setPool(pool_.get());
+  return NodePtr(node);
+}
+
+template<typename IPADDRTYPE, typename T, typename TreeTraits>
+typename RadixTree<IPADDRTYPE, T, TreeTraits>::NodePtr
 RadixTree<IPADDRTYPE, T, TreeTraits>::cloneSubTree(const TreeNode* node) {
   if (!node) {
     return nullptr;
   }
-  std::unique_ptr<TreeNode> copy;
+  NodePtr copy;
   if (node->isValueNode()) {
-    copy = std::make_unique<TreeNode>(node->ipAddress(),
-      node->masklen(), node->value(), node->nodeDeleteCallback());
+    copy = makeNode(node->ipAddress(), node->masklen(), node->value());
   } else {
-    copy = std::make_unique<TreeNode>(node->ipAddress(),
-      node->masklen(), node->nodeDeleteCallback());
+    copy = makeNode(node->ipAddress(), node->masklen());
   }
   copy->resetLeft(cloneSubTree(node->left()));
   copy->resetRight(cloneSubTree(node->right()));
@@ -5,9 +5,11 @@
 
 #include <sys/socket.h>
 #include <algorithm>
+#include <cstddef>
 #include <exception>
 #include <functional>
 #include <memory>
+#include <new>
 #include <string>
 #include <utility>
 #include <vector>
@@ -22,6 +24,81 @@
 #include <folly/IPAddressV6.h>
 
 namespace facebook { namespace network {
+/*
+ * Slab allocator for RadixTree nodes. Nodes are carved out of slabs of
+ * nodesPerSlab nodes each, freed nodes are kept on a free list for reuse,
+ * and slabs are only handed back to the heap, all at once, when the pool
+ * is destroyed. Trading a node's worth of slack per slab for far fewer
+ * heap allocations keeps big, churning route tables from fragmenting the
+ * heap.
+ * Not thread safe, each RadixTree owns its own pool.
+ */
+class RadixTreeNodePool {
+ public:
+  static constexpr size_t kDefaultNodesPerSlab = 1024;
+
+  explicit RadixTreeNodePool(size_t nodeSize,
+      size_t nodesPerSlab = kDefaultNodesPerSlab):
+    slotSize_(slotSize(nodeSize)), nodesPerSlab_(nodesPerSlab) {
+    CHECK_GT(nodesPerSlab_, 0);
+  }
+
+  RadixTreeNodePool(const RadixTreeNodePool&) = delete;
+  RadixTreeNodePool& operator=(const RadixTreeNodePool&) = delete;
+
+  void* allocate() {
+    void* slot = freeList_;
+    if (slot) {
+      freeList_ = *static_cast<void**>(slot);
+    } else {
+      if (slabs_.empty() || nextSlot_ == nodesPerSlab_) {
+        slabs_.emplace_back(new char[slotSize_ * nodesPerSlab_]);
+        nextSlot_ = 0;
+      }
+      slot = slabs_.back().get() + slotSize_ * nextSlot_++;
+    }
+    ++allocationCount_;
+    peakLiveNodes_ = std::max(peakLiveNodes_, ++liveNodes_);
+    return slot;
+  }
+
+  void deallocate(void* slot) {
+    DCHECK_GT(liveNodes_, 0);
+    *static_cast<void**>(slot) = freeList_;
+    freeList_ = slot;
+    --liveNodes_;
+  }
+
+  // Number of heap allocations made by the pool
+  size_t slabCount() const { return slabs_.size(); }
+  // Number of nodes handed out over the lifetime of the pool
+  size_t allocationCount() const { return allocationCount_; }
+  size_t liveNodes() const { return liveNodes_; }
+  size_t peakLiveNodes() const { return peakLiveNodes_; }
+  size_t bytesReserved() const {
+    return slabs_.size() * slotSize_ * nodesPerSlab_;
+  }
+
+ private:
+  static size_t slotSize(size_t nodeSize) {
+    // new char[] memory is aligned for any fundamental type, keep every
+    // slot in the slab that way too. Slots must also fit the free list
+    // link.
+    constexpr auto kAlign = alignof(std::max_align_t);
+    auto size = std::max(nodeSize, sizeof(void*));
+    return (size + kAlign - 1) / kAlign * kAlign;
+  }
+
+  const size_t slotSize_;
+  const size_t nodesPerSlab_;
+  std::vector<std::unique_ptr<char[]>> slabs_;
+  size_t nextSlot_{0};
+  void* freeList_{nullptr};
+  size_t allocationCount_{0};
+  size_t liveNodes_{0};
+  size_t peakLiveNodes_{0};
+};
+
 /*
  * Node in RadixTree, holds IP, mask. Will hold  value for nodes
  * created as a result of user inserts. Other type of nodes are
@@ -36,6 +113,12 @@ class RadixTreeNode {
   typedef std::function<void(const RadixTreeNode<IPADDRTYPE, T>&)>
     NodeDeleteCallback;
 
+  // Frees a node either to the pool it came from or to the heap
+  struct Deleter {
+    void operator()(RadixTreeNode* node) const;
+  };
+  typedef std::unique_ptr<RadixTreeNode, Deleter> NodePtr;
+
   RadixTreeNode(const IPADDRTYPE& ipAddr, uint8_t mlen,
       NodeDeleteCallback deleteCallback):
     ipAddress_(ipAddr), masklen_(mlen), deleteCallback_(deleteCallback) {}
@@ -68,6 +151,9 @@ class RadixTreeNode {
   const T& value() const { return value_.value();  }
   T&       value()       { return value_.value();  }
   NodeDeleteCallback nodeDeleteCallback() const { return deleteCallback_; }
+  // Pool this node was allocated from, null for heap allocated nodes
+  RadixTreeNodePool* pool() const { return pool_; }
+  void setPool(RadixTreeNodePool* pool) { pool_ = pool; }
   std::string str(bool printValue = true) const {
     auto nodeStr = folly::to<std::string>(ipAddress_.str(), "/", masklen_);
     if (printValue) {
@@ -93,8 +179,7 @@ class RadixTreeNode {
           this->value() == r.value());
   }
 
-  std::unique_ptr<RadixTreeNode>
-    resetLeft(std::unique_ptr<RadixTreeNode> newLeft) {
+  NodePtr resetLeft(NodePtr newLeft) {
     auto old = std::move(left_);
     left_ = std::move(newLeft);
     if (left_) {
@@ -103,8 +188,7 @@ class RadixTreeNode {
     return old;
   }
 
-  std::unique_ptr<RadixTreeNode>
-    resetRight(std::unique_ptr<RadixTreeNode> newRight) {
+  NodePtr resetRight(NodePtr newRight) {
     auto old = std::move(right_);
     right_ = std::move(newRight);
     if (right_) {
@@ -129,10 +213,11 @@ class RadixTreeNode {
   IPADDRTYPE ipAddress_;
   uint32_t masklen_{0}; // Number of bits to match.
   folly::Optional<T> value_;
-  std::unique_ptr<RadixTreeNode> left_{nullptr};
-  std::unique_ptr<RadixTreeNode> right_{nullptr};
+  NodePtr left_{nullptr};
+  NodePtr right_{nullptr};
   RadixTreeNode* parent_{nullptr};
   NodeDeleteCallback deleteCallback_;
+  RadixTreeNodePool* pool_{nullptr};
 };
 
 
@@ -345,16 +430,23 @@ template<typename IPADDRTYPE, typename T,
 class RadixTree {
  public:
   typedef RadixTreeNode<IPADDRTYPE, T>           TreeNode;
+  typedef typename TreeNode::NodePtr             NodePtr;
   typedef typename TreeNode::TreeDirection       TreeDirection;
   typedef typename TreeNode::NodeDeleteCallback  NodeDeleteCallback;
   typedef typename TreeTraits::Iterator          Iterator;
   typedef typename TreeTraits::ConstIterator     ConstIterator;
   typedef typename std::vector<ConstIterator>    VecConstIterators;
 
+  /*
+   * With useNodePool set, nodes are allocated from a slab pool owned by the
+   * tree (see RadixTreeNodePool) rather than one by one from the heap.
+   */
   explicit RadixTree(NodeDeleteCallback nodeDelCallback =
       NodeDeleteCallback(),
-      const TreeTraits& treeTraits = TreeTraits()):
-    nodeDeleteCallback_(nodeDelCallback), traits_(treeTraits) {}
+      const TreeTraits& treeTraits = TreeTraits(),
+      bool useNodePool = false):
+    useNodePool_(useNodePool), nodeDeleteCallback_(nodeDelCallback),
+    traits_(treeTraits) {}
 
   RadixTree(const RadixTree& r) = delete;
   RadixTree& operator=(const RadixTree& r) = delete;
@@ -364,20 +456,25 @@ class RadixTree {
   ConstIterator begin() const { return traits_.makeCItr(root_.get()); }
   ConstIterator end()   const { return traits_.makeCItr(nullptr);  }
 
-  // Free all nodes and clear the tree.
+  // Free all nodes and clear the tree. Frees the node pool as well.
   void clear() {
     root_.reset(nullptr);
     size_ = 0;
+    pool_.reset();
   }
   RadixTree(RadixTree&& r) noexcept
-   : nodeDeleteCallback_(r.nodeDeleteCallback_),
+   : useNodePool_(r.useNodePool_), nodeDeleteCallback_(r.nodeDeleteCallback_),
   traits_(r.traits_) {
     *this = std::move(r);
   }
   // Move radix tree onto this
   RadixTree& operator=(RadixTree&& r) noexcept {
-    // Don't copy the traits and delete callback, use
-    // ones with which this Radix tree was created
+    // Don't copy the traits, delete callback and pool option, use
+    // ones with which this Radix tree was created. The pool however
+    // has to come along with the nodes allocated from it. Nodes
+    // being replaced must go back to the old pool before it is freed.
+    auto oldPool = std::move(pool_);
+    pool_ = std::move(r.pool_);
     size_ = r.size_;
     makeRoot(std::move(r.root_));
     r.size_ = 0;
@@ -389,9 +486,9 @@ class RadixTree {
     clone() const {
     static_assert(std::is_same<T, U>::value,
         "clone template type must be the same as Radix tree value type");
-    RadixTree copy(nodeDeleteCallback_, traits_);
+    RadixTree copy(nodeDeleteCallback_, traits_, useNodePool_);
     copy.size_ = size_;
-    copy.root_ = cloneSubTree(root_.get());
+    copy.root_ = copy.cloneSubTree(root_.get());
     return copy;
   }
   /*
@@ -531,8 +628,12 @@ class RadixTree {
   TreeNode* root() { return root_.get();  }
   NodeDeleteCallback nodeDeleteCallback() const { return nodeDeleteCallback_; }
   const TreeTraits&  traits() const { return traits_; }
+  bool useNodePool() const { return useNodePool_; }
+  // Node pool, null unless useNodePool is set and nodes were allocated
+  const RadixTreeNodePool* nodePool() const { return pool_.get(); }
  private:
-  static std::unique_ptr<TreeNode> cloneSubTree(const TreeNode* node);
+  // Clone a sub tree, allocating nodes the way this tree does
+  NodePtr cloneSubTree(const TreeNode* node);
   // Worker function to do the actual longest match lookup.
   const TreeNode* longestMatchImpl(const IPADDRTYPE& ipaddr,
       uint8_t masklen, bool& foundExact, bool includeNonValueNodes = false,
@@ -547,20 +648,11 @@ class RadixTree {
             masklen, foundExact, includeNonValueNodes, trail));
   }
 
-  std::unique_ptr<TreeNode> makeNode(const IPADDRTYPE& ip,
-      uint8_t masklen) {
-    return std::make_unique<TreeNode>(ip, masklen, nodeDeleteCallback_);
-  }
-
-  template<typename VALUE>
-  std::unique_ptr<TreeNode> makeNode(const IPADDRTYPE& ip,
-      uint8_t masklen, VALUE&& value) {
-    return std::make_unique<TreeNode>(ip, masklen,
-                                        std::forward<VALUE>(value),
-                                        nodeDeleteCallback_);
-  }
+  // Make a node, with or without a value
+  template<typename... VALUE>
+  NodePtr makeNode(const IPADDRTYPE& ip, uint8_t masklen, VALUE&&... value);
 
-  void makeRoot(std::unique_ptr<TreeNode> newRoot) {
+  void makeRoot(NodePtr newRoot) {
     CHECK(root_ != newRoot || root_ == nullptr);
     if (newRoot) {
         newRoot->setParent(nullptr);
@@ -571,7 +663,10 @@ class RadixTree {
   inline void trailAppend(VecConstIterators* trail,
   bool includeNonValueNodes, const TreeNode* node) const;
 
-  std::unique_ptr<TreeNode> root_{nullptr};
+  bool useNodePool_{false};
+  // Must outlive root_, nodes hand their memory back to it
+  std::unique_ptr<RadixTreeNodePool> pool_{nullptr};
+  NodePtr root_{nullptr};
   size_t  size_{0};
   NodeDeleteCallback nodeDeleteCallback_;
   TreeTraits  traits_;
@@ -879,15 +974,17 @@ class RadixTree<folly::IPAddress, T> {
   typedef RadixTreeConstIterator<folly::IPAddress, T> ConstIterator;
   typedef std::vector<ConstIterator>           VecConstIterators;
 
+  // useNodePool applies to both the V4 and the V6 tree
   explicit RadixTree(NodeDeleteCallback4 nodeDeleteCallback4 =
       NodeDeleteCallback4(), NodeDeleteCallback6 nodeDeleteCallback6 =
-      NodeDeleteCallback6()): ipv6Tree_(nodeDeleteCallback6,
-      V6TreeInCompositeTreeTraits<T>()), ipv4Tree_(nodeDeleteCallback4,
-      V4TreeInCompositeTreeTraits<T>(ipv6Tree_)) {}
+      NodeDeleteCallback6(), bool useNodePool = false):
+    ipv6Tree_(nodeDeleteCallback6, V6TreeInCompositeTreeTraits<T>(),
+      useNodePool), ipv4Tree_(nodeDeleteCallback4,
+      V4TreeInCompositeTreeTraits<T>(ipv6Tree_), useNodePool) {}
 
   RadixTree(RadixTree&& r) noexcept :
     RadixTree(r.ipv4Tree_.nodeDeleteCallback(),
-      r.ipv6Tree_.nodeDeleteCallback()) {
+      r.ipv6Tree_.nodeDeleteCallback(), r.ipv4Tree_.useNodePool()) {
     *this = std::move(r);
   }
   RadixTree& operator=(RadixTree&& r) noexcept {
@@ -908,7 +1005,7 @@ class RadixTree<folly::IPAddress, T> {
     static_assert(std::is_same<T, U>::value,
         "clone template type must be the same as Radix tree value type");
     RadixTree r(ipv4Tree_.nodeDeleteCallback(),
-      ipv6Tree_.nodeDeleteCallback());
+      ipv6Tree_.nodeDeleteCallback(), ipv4Tree_.useNodePool());
     r.ipv4Tree_ = ipv4Tree_.clone();
     r.ipv6Tree_ = ipv6Tree_.clone();
     return r;
@@ -50,52 +50,91 @@ void RestClient::createEndpoint() {
 }
 
 void RestClient::setTimeout(std::chrono::milliseconds timeout) {
-  timeout_ = timeout;
+  timeoutMs_ = timeout.count();
 }
 
-std::string RestClient::requestWithOutput(std::string path) {
-  CURL* curl;
-  CURLcode resp;
-  std::stringbuf write_buffer;
-  endpoint_ = endpoint_ + path;
-  /* for curl errors */
-  char error[CURL_ERROR_SIZE];
+void RestClient::CurlDeleter::operator()(void* curl) const {
+  curl_easy_cleanup(static_cast<CURL*>(curl));
+}
 
-  curl = curl_easy_init();
-  if (curl) {
-    /* Set the curl options */
-    curl_easy_setopt(curl, CURLOPT_URL, endpoint_.c_str());
+std::string RestClient::perform(const std::string& path) {
+  if (!curl_) {
+    curl_.reset(curl_easy_init());
+    if (!curl_) {
+      throw FbossError("Error initializing curl interface");
+    }
+    auto curl = static_cast<CURL*>(curl_.get());
+    /* Set the curl options that are the same for every request */
     curl_easy_setopt(curl, CURLOPT_PROTOCOLS,CURLPROTO_HTTP);
     curl_easy_setopt(curl, CURLOPT_PORT, port_);
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, timeout_.count());
     curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, RestClient::writer);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &write_buffer);
-    curl_easy_setopt(curl, CURLOPT_ERRORBUFFER, error);
     curl_easy_setopt(curl, CURLOPT_FAILONERROR, 1L);
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
 
     /* if an interface is specified use that */
     if (!interface_.empty()) {
       curl_easy_setopt(curl, CURLOPT_INTERFACE, interface_.c_str());
     }
+  }
 
-    resp = curl_easy_perform(curl);
-    curl_easy_cleanup(curl);
-    if (resp == CURLE_OK) {
-      return write_buffer.str();
-    } else {
-      throw FbossError("Error querying api: ", endpoint_, " error: ", error);
+  auto curl = static_cast<CURL*>(curl_.get());
+  auto url = endpoint_ + path;
+  std::stringbuf write_buffer;
+  /* for curl errors */
+  char error[CURL_ERROR_SIZE] = {0};
+  curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+  curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, timeoutMs_.load());
+  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &write_buffer);
+  curl_easy_setopt(curl, CURLOPT_ERRORBUFFER, error);
+
+  CURLcode resp = curl_easy_perform(curl);
+  // The buffers are gone once we return
+  curl_easy_setopt(curl, CURLOPT_WRITEDATA, nullptr);
+  curl_easy_setopt(curl, CURLOPT_ERRORBUFFER, nullptr);
+  if (resp != CURLE_OK) {
+    throw FbossError("Error querying api: ", url, " error: ", error);
+  }
+  return write_buffer.str();
+}
+
+folly::Future<std::string> RestClient::requestWithOutputAsync(
+    std::string path) {
+  std::shared_ptr<folly::SharedPromise<std::string>> promise;
+  {
+    std::lock_guard<std::mutex> g(inFlightMutex_);
+    auto it = inFlight_.find(path);
+    if (it != inFlight_.end()) {
+      return it->second->getFuture();
     }
+    promise = std::make_shared<folly::SharedPromise<std::string>>();
+    inFlight_.emplace(path, promise);
   }
-  throw FbossError("Error initializing curl interface");
+  auto future = promise->getFuture();
+  thread_.getEventBase()->runInEventBaseThread([this, path, promise]() {
+    auto result = folly::makeTryWith([&] { return perform(path); });
+    {
+      // Later requests for the path send it again
+      std::lock_guard<std::mutex> g(inFlightMutex_);
+      inFlight_.erase(path);
+    }
+    promise->setTry(std::move(result));
+  });
+  return future;
+}
+
+folly::Future<bool> RestClient::requestAsync(std::string path) {
+  return requestWithOutputAsync(std::move(path))
+      .then([](const std::string& ret) {
+        return ret.find("done") != std::string::npos;
+      });
+}
+
+std::string RestClient::requestWithOutput(std::string path) {
+  return requestWithOutputAsync(std::move(path)).get();
 }
 
 bool RestClient::request(std::string path) {
-  auto ret = requestWithOutput(path);
-  std::size_t status = ret.find("done");
-  if (status != std::string::npos) {
-    return true;
-  }
-  return false;
+  return requestAsync(std::move(path)).get();
 }
 
 size_t RestClient::writer(char *buffer, size_t size,
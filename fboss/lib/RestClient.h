@@ -10,11 +10,28 @@
 #pragma once
 
 #include <string>
+#include <atomic>
 #include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <folly/IPAddress.h>
+#include <folly/futures/Future.h>
+#include <folly/futures/SharedPromise.h>
+#include <folly/io/async/ScopedEventBaseThread.h>
 
 namespace facebook { namespace fboss {
 
+/*
+ * Client for the HTTP apis of a single endpoint.
+ *
+ * Requests are performed one at a time on a thread of the client's own,
+ * through one curl handle kept for the life of the client, so repeated
+ * requests reuse its connection rather than setting up a new one each time.
+ * The async variants return straight away; a request for the same path as
+ * one still in flight shares that request's result rather than being sent
+ * again.
+ */
 class RestClient {
  public:
   RestClient(std::string hostname, int port);
@@ -25,6 +42,8 @@ class RestClient {
    */
   bool request(std::string path);
   std::string requestWithOutput(std::string path);
+  folly::Future<bool> requestAsync(std::string path);
+  folly::Future<std::string> requestWithOutputAsync(std::string path);
   void setTimeout(std::chrono::milliseconds timeout);
 
  private:
@@ -32,15 +51,28 @@ class RestClient {
   RestClient(RestClient const &) = delete;
   RestClient& operator=(RestClient const &) = delete;
 
+  struct CurlDeleter {
+    void operator()(void* curl) const;
+  };
+
   static size_t writer(char *buffer, size_t size,
                         size_t entries, std::stringbuf *writer_buffer);
   void createEndpoint();
+  // Only called in the client's thread
+  std::string perform(const std::string& path);
   std::string hostname_;
   folly::IPAddress ipAddress_;
   std::string interface_;
   int port_;
-  std::chrono::milliseconds timeout_{1000};
+  std::atomic<int64_t> timeoutMs_{1000};
   std::string endpoint_;
+  // The curl easy handle, opaque here so only the .cpp needs curl.h
+  std::unique_ptr<void, CurlDeleter> curl_;
+  std::mutex inFlightMutex_;
+  std::map<std::string, std::shared_ptr<folly::SharedPromise<std::string>>>
+      inFlight_;
+  // Last, so it is stopped before the handle it uses goes away
+  folly::ScopedEventBaseThread thread_{"RestClient"};
 };
 
 }} // namespace facebook::fboss
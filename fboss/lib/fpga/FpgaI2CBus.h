@@ -0,0 +1,183 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include "fboss/lib/fpga/FpgaI2CController.h"
+#include "fboss/lib/usb/TransceiverI2CApi.h"
+
+#include <folly/io/async/ScopedEventBaseThread.h>
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace facebook {
+namespace fboss {
+
+/*
+ * TransceiverI2CApi over FPGA I2C controllers, one controller per port.
+ *
+ * The platform maps the FPGA registers and hands them over, e.g.:
+ *
+ *   PciDevice fpga(vendorId, deviceId);
+ *   fpga.open();
+ *   auto io = std::make_unique<PhysicalMemory32<>>(
+ *       fpga.getMemoryRegionAddress(), fpga.getMemoryRegionSize());
+ *   io->mmap();
+ *   return std::make_unique<FpgaI2CBus<PhysicalMemory32<>>>(
+ *       std::move(io), controllerOffsets);
+ *
+ * controllerOffsets[i] is the register block of the controller for module
+ * i + 1.  Every port has its own controller, lock and event base, so
+ * QsfpModule::futureRefresh() refreshes the ports in parallel.
+ *
+ * If the FPGA also latches the modules' presence and interrupt lines, call
+ * setStatusRegisters() with where they are so getModuleStatus() can report
+ * them.  Each is a run of 32-bit words with bit i set for module i + 1.
+ */
+template <typename IoT>
+class FpgaI2CBus : public TransceiverI2CApi {
+ public:
+  FpgaI2CBus(
+      std::unique_ptr<IoT> io,
+      const std::vector<uint32_t>& controllerOffsets)
+      : io_(std::move(io)) {
+    for (auto offset : controllerOffsets) {
+      ports_.push_back(std::make_unique<Port>(io_.get(), offset));
+    }
+  }
+
+  // The registers are mapped for the lifetime of the bus
+  void open() override {}
+  void close() override {}
+  void verifyBus(bool /*autoReset*/) override {}
+
+  void moduleRead(
+      unsigned int module,
+      uint8_t i2cAddress,
+      int offset,
+      int len,
+      uint8_t* buf) override {
+    auto& port = getPort(module);
+    std::lock_guard<std::mutex> g(port.mutex);
+    // Reads past the controller buffer are split, as with the CP2112
+    for (int done = 0; done < len; done += kMaxLen) {
+      port.controller.read(
+          i2cAddress,
+          offset + done,
+          std::min<int>(kMaxLen, len - done),
+          buf + done);
+    }
+  }
+
+  void moduleWrite(
+      unsigned int module,
+      uint8_t i2cAddress,
+      int offset,
+      int len,
+      const uint8_t* buf) override {
+    auto& port = getPort(module);
+    std::lock_guard<std::mutex> g(port.mutex);
+    port.controller.write(i2cAddress, offset, len, buf);
+  }
+
+  void moduleTransfer(unsigned int module, const std::vector<ModuleOp>& ops)
+      override {
+    // Hold the port once for the whole batch
+    auto& port = getPort(module);
+    std::lock_guard<std::mutex> g(port.mutex);
+    for (const auto& op : ops) {
+      if (op.write) {
+        port.controller.write(op.i2cAddress, op.offset, op.len, op.buf);
+        continue;
+      }
+      for (int done = 0; done < op.len; done += kMaxLen) {
+        port.controller.read(
+            op.i2cAddress,
+            op.offset + done,
+            std::min<int>(kMaxLen, op.len - done),
+            op.buf + done);
+      }
+    }
+  }
+
+  bool isPresent(unsigned int module) override {
+    uint8_t buf = 0;
+    try {
+      moduleRead(module, TransceiverI2CApi::ADDR_QSFP, 0, sizeof(buf), &buf);
+    } catch (const I2cError&) {
+      return false;
+    }
+    return true;
+  }
+
+  void setStatusRegisters(uint32_t presentOffset, uint32_t interruptOffset) {
+    presentOffset_ = presentOffset;
+    interruptOffset_ = interruptOffset;
+    hasStatusRegisters_ = true;
+  }
+
+  bool getModuleStatus(std::vector<ModuleStatus>* status) override {
+    if (!hasStatusRegisters_) {
+      return false;
+    }
+    status->resize(ports_.size());
+    for (size_t word = 0; word * 32 < ports_.size(); ++word) {
+      auto present = io_->read(presentOffset_ + word * 4);
+      auto interrupt = io_->read(interruptOffset_ + word * 4);
+      for (size_t bit = 0; bit < 32 && word * 32 + bit < ports_.size();
+           ++bit) {
+        auto& module = (*status)[word * 32 + bit];
+        module.present = present & (1u << bit);
+        module.interrupt = interrupt & (1u << bit);
+      }
+    }
+    return true;
+  }
+
+  folly::EventBase* getEventBase(unsigned int module) override {
+    return getPort(module).thread.getEventBase();
+  }
+
+  size_t getNumPorts() const {
+    return ports_.size();
+  }
+
+ private:
+  enum : int { kMaxLen = FpgaI2CController<IoT>::kMaxLen };
+
+  struct Port {
+    Port(IoT* io, uint32_t offset) : controller(io, offset) {}
+
+    FpgaI2CController<IoT> controller;
+    std::mutex mutex;
+    folly::ScopedEventBaseThread thread;
+  };
+
+  Port& getPort(unsigned int module) {
+    CHECK_GT(module, 0);
+    CHECK_LE(module, ports_.size());
+    return *ports_[module - 1];
+  }
+
+  // Forbidden copy constructor and assignment operator
+  FpgaI2CBus(FpgaI2CBus const&) = delete;
+  FpgaI2CBus& operator=(FpgaI2CBus const&) = delete;
+
+  std::unique_ptr<IoT> io_;
+  std::vector<std::unique_ptr<Port>> ports_;
+  bool hasStatusRegisters_{false};
+  uint32_t presentOffset_{0};
+  uint32_t interruptOffset_{0};
+};
+
+} // namespace fboss
+} // namespace facebook
@@ -0,0 +1,147 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include "fboss/lib/usb/TransceiverI2CApi.h"
+
+#include <folly/Conv.h>
+#include <glog/logging.h>
+
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+namespace facebook {
+namespace fboss {
+
+/*
+ * Drives one FPGA I2C controller through its memory mapped registers.
+ *
+ * IoT is the 32-bit register window, such as PhysicalMemory32<> mapped over
+ * the FPGA's PCI BAR.  Each controller owns a block of registers starting at
+ * baseOffset:
+ *
+ *   CONTROL (0x00)  [7:0] register offset, [14:8] 7-bit I2C address,
+ *                   [23:16] length - 1, bit 28 read, bit 31 start
+ *   STATUS  (0x04)  bit 0 done, bit 1 NACK, bit 2 timeout; write 1s to clear
+ *   DATA    (0x80)  128 byte transfer buffer, little endian words
+ *
+ * A transaction fills DATA for writes, sets CONTROL with the start bit and
+ * polls STATUS until done.  Controllers are independent, so transactions on
+ * different controllers can run in parallel; each controller must only be
+ * used by one thread at a time.
+ */
+template <typename IoT>
+class FpgaI2CController {
+ public:
+  enum : uint32_t {
+    kControl = 0x00,
+    kStatus = 0x04,
+    kData = 0x80,
+    kMaxLen = 128,
+    kBlockSize = 0x100,
+
+    kControlRead = 1u << 28,
+    kControlStart = 1u << 31,
+
+    kStatusDone = 1u << 0,
+    kStatusNack = 1u << 1,
+    kStatusTimeout = 1u << 2,
+  };
+
+  FpgaI2CController(
+      IoT* io,
+      uint32_t baseOffset,
+      std::chrono::milliseconds timeout = std::chrono::milliseconds(100))
+      : io_(io), baseOffset_(baseOffset), timeout_(timeout) {}
+
+  void read(uint8_t i2cAddress, int offset, int len, uint8_t* buf) {
+    checkArgs(offset, len);
+    runTransaction(i2cAddress, offset, len, true);
+    for (int word = 0; word * 4 < len; ++word) {
+      auto val = io_->read(baseOffset_ + kData + word * 4);
+      for (int i = 0; i < 4 && word * 4 + i < len; ++i) {
+        buf[word * 4 + i] = val >> (i * 8);
+      }
+    }
+  }
+
+  void write(uint8_t i2cAddress, int offset, int len, const uint8_t* buf) {
+    checkArgs(offset, len);
+    for (int word = 0; word * 4 < len; ++word) {
+      uint32_t val = 0;
+      for (int i = 0; i < 4 && word * 4 + i < len; ++i) {
+        val |= uint32_t(buf[word * 4 + i]) << (i * 8);
+      }
+      io_->write(baseOffset_ + kData + word * 4, val);
+    }
+    runTransaction(i2cAddress, offset, len, false);
+  }
+
+ private:
+  void checkArgs(int offset, int len) const {
+    CHECK_GE(offset, 0);
+    CHECK_LE(offset, 255);
+    CHECK_GT(len, 0);
+    CHECK_LE(len, int(kMaxLen));
+  }
+
+  void runTransaction(uint8_t i2cAddress, int offset, int len, bool read) {
+    // Clear whatever the last transaction left behind
+    io_->write(
+        baseOffset_ + kStatus, kStatusDone | kStatusNack | kStatusTimeout);
+
+    uint32_t control = kControlStart | (uint32_t(i2cAddress & 0x7f) << 8) |
+        (uint32_t(len - 1) << 16) | uint32_t(offset);
+    if (read) {
+      control |= kControlRead;
+    }
+    io_->write(baseOffset_ + kControl, control);
+
+    // A full 128 byte transaction takes a few milliseconds at 400kHz, so
+    // spin briefly before backing off to sleeps.
+    auto end = std::chrono::steady_clock::now() + timeout_;
+    for (int polls = 0;; ++polls) {
+      auto status = io_->read(baseOffset_ + kStatus);
+      if (status & (kStatusNack | kStatusTimeout)) {
+        throw I2cError(folly::to<std::string>(
+            "FPGA I2C ",
+            read ? "read" : "write",
+            " of address ",
+            int(i2cAddress),
+            " at offset ",
+            offset,
+            " failed: ",
+            (status & kStatusNack) ? "NACK" : "bus timeout"));
+      }
+      if (status & kStatusDone) {
+        return;
+      }
+      if (std::chrono::steady_clock::now() > end) {
+        throw I2cError(folly::to<std::string>(
+            "FPGA I2C transaction with address ",
+            int(i2cAddress),
+            " timed out"));
+      }
+      if (polls >= kSpinPolls) {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+      }
+    }
+  }
+
+  static constexpr int kSpinPolls = 64;
+
+  IoT* io_;
+  const uint32_t baseOffset_;
+  const std::chrono::milliseconds timeout_;
+};
+
+} // namespace fboss
+} // namespace facebook
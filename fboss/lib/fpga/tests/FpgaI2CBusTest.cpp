@@ -0,0 +1,143 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/lib/fpga/FpgaI2CBus.h"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <map>
+
+using namespace facebook::fboss;
+
+namespace {
+
+using Controller = FpgaI2CController<class FakeFpgaIo>;
+
+/*
+ * Register window that acts out each controller's transactions against an
+ * EEPROM as soon as the start bit is written.
+ */
+class FakeFpgaIo {
+ public:
+  uint32_t read(uint32_t offset) const {
+    auto it = regs_.find(offset);
+    return it == regs_.end() ? 0 : it->second;
+  }
+
+  void write(uint32_t offset, uint32_t val) {
+    auto reg = offset % Controller::kBlockSize;
+    auto base = offset - reg;
+    if (reg == Controller::kStatus) {
+      regs_[offset] &= ~val;
+      return;
+    }
+    regs_[offset] = val;
+    if (reg == Controller::kControl && (val & Controller::kControlStart)) {
+      runTransaction(base, val);
+    }
+  }
+
+  // EEPROM contents behind each controller, at I2C address 0x50
+  std::map<uint32_t, std::array<uint8_t, 256>> eeproms;
+
+ private:
+  void runTransaction(uint32_t base, uint32_t control) {
+    auto offset = control & 0xff;
+    auto address = (control >> 8) & 0x7f;
+    auto len = ((control >> 16) & 0xff) + 1;
+    auto eeprom = eeproms.find(base);
+    if (address != TransceiverI2CApi::ADDR_QSFP || eeprom == eeproms.end()) {
+      regs_[base + Controller::kStatus] = Controller::kStatusNack;
+      return;
+    }
+    for (uint32_t i = 0; i < len; ++i) {
+      auto dataReg = base + Controller::kData + (i / 4) * 4;
+      auto shift = (i % 4) * 8;
+      auto& byte = eeprom->second[offset + i];
+      if (control & Controller::kControlRead) {
+        regs_[dataReg] = (regs_[dataReg] & ~(0xffu << shift)) |
+            (uint32_t(byte) << shift);
+      } else {
+        byte = regs_[dataReg] >> shift;
+      }
+    }
+    regs_[base + Controller::kStatus] = Controller::kStatusDone;
+  }
+
+  std::map<uint32_t, uint32_t> regs_;
+};
+
+constexpr uint8_t kQsfp = TransceiverI2CApi::ADDR_QSFP;
+
+std::unique_ptr<FpgaI2CBus<FakeFpgaIo>> makeBus(FakeFpgaIo** io) {
+  auto fake = std::make_unique<FakeFpgaIo>();
+  *io = fake.get();
+  std::vector<uint32_t> offsets{0x1000, 0x1100};
+  return std::make_unique<FpgaI2CBus<FakeFpgaIo>>(std::move(fake), offsets);
+}
+
+} // namespace
+
+TEST(FpgaI2CBus, ReadWrite) {
+  FakeFpgaIo* io;
+  auto bus = makeBus(&io);
+  auto& eeprom = io->eeproms[0x1000];
+  for (size_t i = 0; i < eeprom.size(); ++i) {
+    eeprom[i] = i;
+  }
+
+  // Longer than one controller transaction
+  std::array<uint8_t, 256> buf;
+  bus->moduleRead(1, kQsfp, 0, buf.size(), buf.data());
+  EXPECT_EQ(eeprom, buf);
+
+  uint8_t page[] = {0xaa, 0xbb, 0xcc, 0xdd, 0xee};
+  bus->moduleWrite(1, kQsfp, 127, sizeof(page), page);
+  EXPECT_EQ(0xaa, eeprom[127]);
+  EXPECT_EQ(0xee, eeprom[131]);
+  // Other ports are untouched
+  EXPECT_EQ(0, io->eeproms.count(0x1100));
+}
+
+TEST(FpgaI2CBus, Presence) {
+  FakeFpgaIo* io;
+  auto bus = makeBus(&io);
+  io->eeproms[0x1100];
+  EXPECT_FALSE(bus->isPresent(1));
+  EXPECT_TRUE(bus->isPresent(2));
+
+  uint8_t buf[1];
+  EXPECT_THROW(bus->moduleRead(1, kQsfp, 0, 1, buf), I2cError);
+}
+
+TEST(FpgaI2CBus, PortsHaveOwnEventBase) {
+  FakeFpgaIo* io;
+  auto bus = makeBus(&io);
+  EXPECT_EQ(2, bus->getNumPorts());
+  EXPECT_NE(nullptr, bus->getEventBase(1));
+  EXPECT_NE(bus->getEventBase(1), bus->getEventBase(2));
+}
+
+TEST(FpgaI2CBus, ModuleStatus) {
+  FakeFpgaIo* io;
+  auto bus = makeBus(&io);
+  std::vector<TransceiverI2CApi::ModuleStatus> status;
+  EXPECT_FALSE(bus->getModuleStatus(&status));
+
+  bus->setStatusRegisters(0x10, 0x20);
+  io->write(0x10, 0x2);
+  io->write(0x20, 0x1);
+  ASSERT_TRUE(bus->getModuleStatus(&status));
+  ASSERT_EQ(2, status.size());
+  EXPECT_FALSE(status[0].present);
+  EXPECT_TRUE(status[0].interrupt);
+  EXPECT_TRUE(status[1].present);
+  EXPECT_FALSE(status[1].interrupt);
+}
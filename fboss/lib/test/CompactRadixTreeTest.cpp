@@ -0,0 +1,198 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#include <memory>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "common/base/Random.h"
+#include <folly/IPAddressV4.h>
+#include <folly/IPAddressV6.h>
+
+#include "fboss/lib/CompactRadixTree.h"
+#include "fboss/lib/RadixTree.h"
+
+using namespace facebook;
+using namespace facebook::network;
+using namespace std;
+
+namespace {
+using IPAddressV4 = folly::IPAddressV4;
+using IPAddressV6 = folly::IPAddressV6;
+
+template<typename IPAddrType>
+struct RandomPrefix;
+
+template<>
+struct RandomPrefix<IPAddressV4> {
+  static pair<IPAddressV4, uint8_t> get() {
+    auto mask = folly::Random::rand32(33);
+    auto ip = IPAddressV4::fromLongHBO(folly::Random::rand32());
+    return make_pair(ip.mask(mask), mask);
+  }
+};
+
+template<>
+struct RandomPrefix<IPAddressV6> {
+  static pair<IPAddressV6, uint8_t> get() {
+    auto mask = folly::Random::rand32(129);
+    folly::ByteArray16 ba;
+    *(uint64_t*)(&ba[0]) = folly::Random::rand64();
+    *(uint64_t*)(&ba[8]) = folly::Random::rand64();
+    return make_pair(IPAddressV6(ba).mask(mask), mask);
+  }
+};
+
+/*
+ * Walk both trees in preorder, including non value nodes. Since both trees
+ * implement the same path compressed trie, they must agree node for node.
+ */
+template<typename IPAddrType, typename T>
+void expectSameShape(const RadixTree<IPAddrType, T>& rtree,
+    const CompactRadixTree<IPAddrType, T>& ctree) {
+  EXPECT_EQ(rtree.size(), ctree.size());
+  typename RadixTree<IPAddrType, T>::ConstIterator ritr(rtree.root(), true);
+  typename CompactRadixTree<IPAddrType, T>::ConstIterator citr(&ctree,
+      ctree.root(), true);
+  auto nodes = 0;
+  for (; !ritr.atEnd() && !citr.atEnd(); ++ritr, ++citr, ++nodes) {
+    ASSERT_EQ(ritr->ipAddress(), citr->ipAddress());
+    ASSERT_EQ(ritr->masklen(), citr->masklen());
+    ASSERT_EQ(ritr.node()->isValueNode(), citr->isValueNode());
+    if (citr->isValueNode()) {
+      ASSERT_EQ(ritr->value(), citr->value());
+    }
+  }
+  EXPECT_TRUE(ritr.atEnd());
+  EXPECT_TRUE(citr.atEnd());
+  EXPECT_EQ(nodes, ctree.nodeCount());
+}
+
+template<typename IPAddrType>
+void compareWithRadixTree() {
+  RadixTree<IPAddrType, int> rtree;
+  CompactRadixTree<IPAddrType, int> ctree;
+  vector<pair<IPAddrType, uint8_t>> inserted;
+  auto const kInsertCount = 2000;
+  for (auto i = 0; i < kInsertCount; ++i) {
+    auto pfx = RandomPrefix<IPAddrType>::get();
+    auto rinsert = rtree.insert(pfx.first, pfx.second, i);
+    auto cinsert = ctree.insert(pfx.first, pfx.second, i);
+    ASSERT_EQ(rinsert.second, cinsert.second);
+    EXPECT_EQ(rinsert.first->value(), cinsert.first->value());
+    inserted.push_back(pfx);
+  }
+  expectSameShape(rtree, ctree);
+
+  // Lookups for inserted prefixes, and random addresses and masks
+  for (auto i = 0; i < kInsertCount; ++i) {
+    auto pfx = i % 2 ? inserted[i] : RandomPrefix<IPAddrType>::get();
+    auto rexact = rtree.exactMatch(pfx.first, pfx.second);
+    auto cexact = ctree.exactMatch(pfx.first, pfx.second);
+    ASSERT_EQ(rexact == rtree.end(), cexact == ctree.end());
+    if (cexact != ctree.end()) {
+      EXPECT_EQ(rexact->value(), cexact->value());
+    }
+    auto rlongest = rtree.longestMatch(pfx.first, IPAddrType::bitCount());
+    auto clongest = ctree.longestMatch(pfx.first, IPAddrType::bitCount());
+    ASSERT_EQ(rlongest == rtree.end(), clongest == ctree.end());
+    if (clongest != ctree.end()) {
+      EXPECT_EQ(rlongest->ipAddress(), clongest->ipAddress());
+      EXPECT_EQ(rlongest->masklen(), clongest->masklen());
+    }
+  }
+
+  // Erase half, then insert some more so that freed arena slots get reused
+  for (auto i = 0; i < kInsertCount / 2; ++i) {
+    auto& pfx = inserted[folly::Random::rand32(inserted.size())];
+    EXPECT_EQ(rtree.erase(pfx.first, pfx.second),
+        ctree.erase(pfx.first, pfx.second));
+  }
+  expectSameShape(rtree, ctree);
+  for (auto i = 0; i < kInsertCount / 4; ++i) {
+    auto pfx = RandomPrefix<IPAddrType>::get();
+    EXPECT_EQ(rtree.insert(pfx.first, pfx.second, i).second,
+        ctree.insert(pfx.first, pfx.second, i).second);
+  }
+  expectSameShape(rtree, ctree);
+
+  // Re-laying the arena changes nothing visible
+  auto copy = ctree.clone();
+  ctree.compact();
+  EXPECT_TRUE(copy == ctree);
+  EXPECT_LE(ctree.memoryUsage(), copy.memoryUsage());
+  expectSameShape(rtree, ctree);
+
+  // Erase everything
+  for (const auto& pfx : inserted) {
+    rtree.erase(pfx.first, pfx.second);
+    ctree.erase(pfx.first, pfx.second);
+  }
+  for (auto itr = rtree.begin(); itr != rtree.end(); itr = rtree.begin()) {
+    EXPECT_TRUE(ctree.erase(itr->ipAddress(), itr->masklen()));
+    rtree.erase(itr);
+  }
+  EXPECT_EQ(0, ctree.size());
+  EXPECT_EQ(0, ctree.nodeCount());
+  EXPECT_TRUE(ctree.begin() == ctree.end());
+}
+}
+
+TEST(CompactRadixTree, CompareWithRadixTree4) {
+  compareWithRadixTree<IPAddressV4>();
+}
+
+TEST(CompactRadixTree, CompareWithRadixTree6) {
+  compareWithRadixTree<IPAddressV6>();
+}
+
+TEST(CompactRadixTree, Basic) {
+  CompactRadixTree<IPAddressV4, std::unique_ptr<int>> ctree;
+  EXPECT_TRUE(ctree.begin() == ctree.end());
+  EXPECT_TRUE(ctree.longestMatch(IPAddressV4("10.0.0.1"), 32) == ctree.end());
+
+  EXPECT_TRUE(ctree.insert(IPAddressV4("10.0.0.0"), 8,
+        std::make_unique<int>(8)).second);
+  EXPECT_TRUE(ctree.insert(IPAddressV4("10.1.0.0"), 16,
+        std::make_unique<int>(16)).second);
+  EXPECT_TRUE(ctree.insert(IPAddressV4("10.2.0.0"), 16,
+        std::make_unique<int>(162)).second);
+  // Duplicate insert returns the existing node
+  auto dup = ctree.insert(IPAddressV4("10.1.0.0"), 16,
+      std::make_unique<int>(0));
+  EXPECT_FALSE(dup.second);
+  EXPECT_EQ(16, *dup.first->value());
+  EXPECT_EQ(3, ctree.size());
+
+  // Host bits past the mask are ignored
+  auto itr = ctree.longestMatch(IPAddressV4("10.1.2.3"), 32);
+  ASSERT_TRUE(itr != ctree.end());
+  EXPECT_EQ(IPAddressV4("10.1.0.0"), itr->ipAddress());
+  EXPECT_EQ(16, itr->masklen());
+  itr = ctree.longestMatch(IPAddressV4("10.3.2.3"), 32);
+  EXPECT_EQ(8, itr->masklen());
+  EXPECT_TRUE(ctree.exactMatch(IPAddressV4("10.1.0.0"), 15) == ctree.end());
+  EXPECT_TRUE(ctree.exactMatch(IPAddressV4("10.1.9.9"), 16) != ctree.end());
+
+  // Set value via iterator
+  ctree.exactMatch(IPAddressV4("10.2.0.0"), 16)->setValue(
+      std::make_unique<int>(42));
+  EXPECT_EQ(42, *ctree.exactMatch(IPAddressV4("10.2.0.0"), 16)->value());
+
+  // Sub tree iteration under 10/8 sees all 3 prefixes, in preorder
+  auto subTree = ctree.exactMatch(IPAddressV4("10.0.0.0"), 8)
+    .subTreeIterator();
+  vector<uint8_t> masks;
+  for (; subTree != ctree.end(); ++subTree) {
+    masks.push_back(subTree->masklen());
+  }
+  EXPECT_EQ((vector<uint8_t>{8, 16, 16}), masks);
+
+  // Move
+  CompactRadixTree<IPAddressV4, std::unique_ptr<int>> moved(std::move(ctree));
+  EXPECT_EQ(0, ctree.size());
+  EXPECT_EQ(3, moved.size());
+  EXPECT_TRUE(moved.erase(IPAddressV4("10.0.0.0"), 8));
+  EXPECT_FALSE(moved.erase(IPAddressV4("10.0.0.0"), 8));
+  EXPECT_EQ(2, moved.size());
+  EXPECT_TRUE(moved.longestMatch(IPAddressV4("10.3.2.3"), 32) == moved.end());
+}
@@ -0,0 +1,61 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <system_error>
+
+#include "fboss/lib/HugePageMemory.h"
+
+namespace facebook {
+namespace fboss {
+
+TEST(HugePageMemoryTest, map) {
+  EXPECT_THROW(HugePageMemory(0), std::system_error);
+
+  HugePageMemory memory(HugePageMemory::kHugePageSize + 1);
+  // Rounded up to whole huge pages, and aligned to one
+  EXPECT_EQ(2 * HugePageMemory::kHugePageSize, memory.getSize());
+  EXPECT_EQ(
+      0,
+      reinterpret_cast<uintptr_t>(memory.data()) %
+          HugePageMemory::kHugePageSize);
+  std::memset(memory.data(), 0xab, memory.getSize());
+
+  size_t pageSize = 0;
+  size_t anonHugeBytes = 0;
+  HugePageMemory::pageInfo(memory.data(), &pageSize, &anonHugeBytes);
+  switch (memory.backing()) {
+    case HugePageMemory::Backing::HUGETLB:
+      EXPECT_GE(pageSize, HugePageMemory::kHugePageSize);
+      break;
+    case HugePageMemory::Backing::TRANSPARENT:
+      EXPECT_GT(anonHugeBytes, 0);
+      break;
+    case HugePageMemory::Backing::NORMAL:
+      EXPECT_EQ(0, anonHugeBytes);
+      break;
+  }
+}
+
+TEST(HugePageMemoryTest, pageInfo) {
+  int onStack = 0;
+  size_t pageSize = 0;
+  size_t anonHugeBytes = 0;
+  HugePageMemory::pageInfo(&onStack, &pageSize, &anonHugeBytes);
+  EXPECT_GT(pageSize, 0);
+
+  HugePageMemory::pageInfo(nullptr, &pageSize, &anonHugeBytes);
+  EXPECT_EQ(0, pageSize);
+  EXPECT_EQ(0, anonHugeBytes);
+}
+
+} // namespace fboss
+} // namespace facebook
@@ -1,5 +1,7 @@
 // Copyright 2004-present Facebook. All Rights Reserved.
 
+#include <cstdio>
+#include <memory>
 #include <set>
 #include <vector>
 #include "common/init/Init.h"
@@ -7,6 +9,7 @@
 #include <folly/IPAddressV4.h>
 #include <folly/IPAddressV6.h>
 #include <folly/Benchmark.h>
+#include "fboss/lib/CompactRadixTree.h"
 #include "fboss/lib/RadixTree.h"
 #include "PyRadixWrapper.h"
 
@@ -21,6 +24,8 @@ DEFINE_int32(erase_count, 1000,
              "The number of elements to erase on each erase iteration");
 DEFINE_int32(lookup_count, 5000,
              "The number of elements to look up on each lookup iteration");
+DEFINE_int32(large_insert_count, 1000000,
+             "The number of V6 prefixes in the large table benchmarks");
 namespace {
 set<Prefix4> insertSet4;
 set<Prefix4> eraseSet4;
@@ -31,6 +36,8 @@ set<Prefix6> eraseSet6;
 set<Prefix6> exactMatchSet6;
 set<Prefix6> longestMatchSet6;
 vector<int>  valueSet;
+vector<Prefix6> largeInsert6;
+vector<IPAddressV6> largeLookup6;
 
 // V4 Benchmarks
 template<typename TREE>
@@ -191,6 +198,160 @@ BENCHMARK_RELATIVE(RadixTreeLongestMatch6) {
   }
 }
 
+// Large V6 table benchmarks, RadixTree vs CompactRadixTree
+
+template<typename TREE>
+void setupLargeTree6(TREE& tree) {
+  auto count = 0;
+  for (const auto& pfx: largeInsert6) {
+    tree.insert(pfx.ip, pfx.mask, count++);
+  }
+}
+
+BENCHMARK(RadixTreeInsert6Large) {
+  auto rtree = std::make_unique<RadixTree<IPAddressV6, int>>();
+  setupLargeTree6(*rtree);
+  BENCHMARK_SUSPEND {
+    rtree.reset();
+  }
+}
+
+BENCHMARK_RELATIVE(CompactRadixTreeInsert6Large) {
+  auto ctree = std::make_unique<CompactRadixTree<IPAddressV6, int>>();
+  setupLargeTree6(*ctree);
+  BENCHMARK_SUSPEND {
+    ctree.reset();
+  }
+}
+
+BENCHMARK(RadixTreeLongestMatch6Large, iters) {
+  RadixTree<IPAddressV6, int> rtree;
+  BENCHMARK_SUSPEND {
+    setupLargeTree6(rtree);
+  }
+  for (size_t i = 0; i < iters; ++i) {
+    for (const auto& addr: largeLookup6) {
+      folly::doNotOptimizeAway(rtree.longestMatch(addr, 128));
+    }
+  }
+  BENCHMARK_SUSPEND {
+    rtree.clear();
+  }
+}
+
+BENCHMARK_RELATIVE(CompactRadixTreeLongestMatch6Large, iters) {
+  CompactRadixTree<IPAddressV6, int> ctree;
+  BENCHMARK_SUSPEND {
+    setupLargeTree6(ctree);
+    ctree.compact();
+  }
+  for (size_t i = 0; i < iters; ++i) {
+    for (const auto& addr: largeLookup6) {
+      folly::doNotOptimizeAway(ctree.longestMatch(addr, 128));
+    }
+  }
+  BENCHMARK_SUSPEND {
+    ctree.clear();
+  }
+}
+
+// Heap allocated vs pooled nodes, on the large V6 table
+
+BENCHMARK(RadixTreeHeapNodesInsert6Large) {
+  auto rtree = std::make_unique<RadixTree<IPAddressV6, int>>();
+  setupLargeTree6(*rtree);
+  BENCHMARK_SUSPEND {
+    rtree.reset();
+  }
+}
+
+BENCHMARK_RELATIVE(RadixTreePooledNodesInsert6Large) {
+  auto rtree = std::make_unique<RadixTree<IPAddressV6, int>>(
+      RadixTree<IPAddressV6, int>::NodeDeleteCallback(),
+      RadixTreeTraits<IPAddressV6, int>(), true /* useNodePool */);
+  setupLargeTree6(*rtree);
+  BENCHMARK_SUSPEND {
+    rtree.reset();
+  }
+}
+
+BENCHMARK(RadixTreeHeapNodesClone6Large) {
+  RadixTree<IPAddressV6, int> rtree;
+  BENCHMARK_SUSPEND {
+    setupLargeTree6(rtree);
+  }
+  auto copy = rtree.clone();
+  BENCHMARK_SUSPEND {
+    copy.clear();
+    rtree.clear();
+  }
+}
+
+BENCHMARK_RELATIVE(RadixTreePooledNodesClone6Large) {
+  RadixTree<IPAddressV6, int> rtree(
+      RadixTree<IPAddressV6, int>::NodeDeleteCallback(),
+      RadixTreeTraits<IPAddressV6, int>(), true /* useNodePool */);
+  BENCHMARK_SUSPEND {
+    setupLargeTree6(rtree);
+  }
+  auto copy = rtree.clone();
+  BENCHMARK_SUSPEND {
+    copy.clear();
+    rtree.clear();
+  }
+}
+
+/*
+ * Heap allocations and peak node memory for loading the large V6 table,
+ * then churning a tenth of it out and back in. Heap allocated nodes cost
+ * one allocation each, so their numbers follow from the pool counters.
+ */
+void printNodePoolStats6() {
+  RadixTree<IPAddressV6, int> rtree(
+      RadixTree<IPAddressV6, int>::NodeDeleteCallback(),
+      RadixTreeTraits<IPAddressV6, int>(), true /* useNodePool */);
+  setupLargeTree6(rtree);
+  for (auto round = 0; round < 3; ++round) {
+    for (size_t i = 0; i < largeInsert6.size() / 10; ++i) {
+      rtree.erase(largeInsert6[i].ip, largeInsert6[i].mask);
+    }
+    for (size_t i = 0; i < largeInsert6.size() / 10; ++i) {
+      rtree.insert(largeInsert6[i].ip, largeInsert6[i].mask, i);
+    }
+  }
+  const auto* pool = rtree.nodePool();
+  auto nodeSize = sizeof(RadixTreeNode<IPAddressV6, int>);
+  printf("%zu V6 prefixes, 3 rounds of 10%% churn\n", rtree.size());
+  printf("  Heap nodes:   %10zu allocations, %10zu peak bytes\n",
+      pool->allocationCount(), pool->peakLiveNodes() * nodeSize);
+  printf("  Pooled nodes: %10zu allocations, %10zu peak bytes\n",
+      pool->slabCount(), pool->bytesReserved());
+}
+
+/*
+ * Memory held by the tree structure itself for the large V6 table. For
+ * RadixTree this is one heap allocation per node (malloc overhead not
+ * included), for CompactRadixTree it is the size of its arenas.
+ */
+void printLargeTreeMemoryFootprint6() {
+  RadixTree<IPAddressV6, int> rtree;
+  CompactRadixTree<IPAddressV6, int> ctree;
+  setupLargeTree6(rtree);
+  setupLargeTree6(ctree);
+  size_t rtreeNodes = 0;
+  for (RadixTree<IPAddressV6, int>::ConstIterator itr(rtree.root(), true);
+      !itr.atEnd(); ++itr) {
+    ++rtreeNodes;
+  }
+  auto rtreeBytes = rtreeNodes * sizeof(RadixTreeNode<IPAddressV6, int>);
+  auto ctreeBytes = ctree.memoryUsage();
+  ctree.compact();
+  printf("%zu V6 prefixes, %zu tree nodes\n", rtree.size(), rtreeNodes);
+  printf("  RadixTree:                  %10zu bytes (%zu per node)\n",
+      rtreeBytes, sizeof(RadixTreeNode<IPAddressV6, int>));
+  printf("  CompactRadixTree:           %10zu bytes\n", ctreeBytes);
+  printf("  CompactRadixTree compacted: %10zu bytes\n", ctree.memoryUsage());
+}
 }
 
 int main(int /*argc*/, char* /*argv*/ []) {
@@ -246,6 +407,23 @@ int main(int /*argc*/, char* /*argv*/ []) {
     auto newIp = pfx.ip.mask(newMask);
     longestMatchSet6.insert(Prefix6(newIp, newMask));
   }
+
+  // Large random V6 table, looked up by host addresses under its prefixes
+  largeInsert6.reserve(FLAGS_large_insert_count);
+  for (auto i = 0; i < FLAGS_large_insert_count; ++i) {
+    // Mostly /48 - /64 as in a real table
+    auto mask = 48 + folly::Random::rand32(17);
+    ByteArray16 ba;
+    *(uint64_t*)(&ba[0]) = folly::Random::rand64();
+    *(uint64_t*)(&ba[8]) = folly::Random::rand64();
+    auto ip = IPAddressV6(ba);
+    largeInsert6.push_back(Prefix6(ip.mask(mask), mask));
+    if (largeLookup6.size() < FLAGS_lookup_count) {
+      largeLookup6.push_back(ip);
+    }
+  }
   runBenchmarks();
+  printLargeTreeMemoryFootprint6();
+  printNodePoolStats6();
 }
 
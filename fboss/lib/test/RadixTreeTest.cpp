@@ -1467,3 +1467,95 @@ TEST(RadixTree, SubTreeIterator) {
   }
   EXPECT_EQ(rtree.end().subTreeIterator(), rtree.end());
 }
+
+TEST(RadixTree, NodePool) {
+  RadixTree<IPAddressV4, std::unique_ptr<int>> heapTree;
+  RadixTree<IPAddressV4, std::unique_ptr<int>> pooledTree(
+      RadixTree<IPAddressV4, std::unique_ptr<int>>::NodeDeleteCallback(),
+      RadixTreeTraits<IPAddressV4, std::unique_ptr<int>>(),
+      true /* useNodePool */);
+  EXPECT_EQ(nullptr, heapTree.nodePool());
+  // Pool is only created on the first insert
+  EXPECT_EQ(nullptr, pooledTree.nodePool());
+
+  std::vector<std::pair<IPAddressV4, uint8_t>> inserted;
+  auto const kInsertCount = 3000;
+  for (auto i = 0; i < kInsertCount; ++i) {
+    auto mask = folly::Random::rand32(33);
+    auto ip = IPAddressV4::fromLongHBO(folly::Random::rand32()).mask(mask);
+    EXPECT_EQ(heapTree.insert(ip, mask, std::make_unique<int>(i)).second,
+        pooledTree.insert(ip, mask, std::make_unique<int>(i)).second);
+    inserted.emplace_back(ip, mask);
+  }
+  auto pool = pooledTree.nodePool();
+  ASSERT_NE(nullptr, pool);
+  EXPECT_EQ(nullptr, heapTree.nodePool());
+  size_t nodes = 0;
+  for (RadixTree<IPAddressV4, std::unique_ptr<int>>::ConstIterator
+      itr(pooledTree.root(), true); !itr.atEnd(); ++itr) {
+    ++nodes;
+  }
+  EXPECT_EQ(nodes, pool->liveNodes());
+  EXPECT_LT(pool->slabCount(), pool->allocationCount());
+
+  // Erase and re-insert, freed nodes get reused rather than new slabs
+  auto peak = pool->peakLiveNodes();
+  auto slabs = pool->slabCount();
+  for (auto i = 0; i < kInsertCount / 2; ++i) {
+    heapTree.erase(inserted[i].first, inserted[i].second);
+    pooledTree.erase(inserted[i].first, inserted[i].second);
+  }
+  EXPECT_GT(peak, pool->liveNodes());
+  for (auto i = 0; i < kInsertCount / 2; ++i) {
+    heapTree.insert(inserted[i].first, inserted[i].second,
+        std::make_unique<int>(i));
+    pooledTree.insert(inserted[i].first, inserted[i].second,
+        std::make_unique<int>(i));
+  }
+  EXPECT_EQ(peak, pool->peakLiveNodes());
+  EXPECT_EQ(slabs, pool->slabCount());
+  EXPECT_EQ(heapTree.size(), pooledTree.size());
+  for (const auto& pfx: inserted) {
+    auto heapItr = heapTree.exactMatch(pfx.first, pfx.second);
+    auto pooledItr = pooledTree.exactMatch(pfx.first, pfx.second);
+    ASSERT_TRUE(pooledItr != pooledTree.end());
+    EXPECT_EQ(*heapItr->value(), *pooledItr->value());
+  }
+
+  // Moving a pooled tree takes its pool along
+  RadixTree<IPAddressV4, std::unique_ptr<int>> movedTree(
+      std::move(pooledTree));
+  EXPECT_EQ(pool, movedTree.nodePool());
+  EXPECT_EQ(nullptr, pooledTree.nodePool());
+  EXPECT_EQ(0, pooledTree.size());
+  heapTree = std::move(movedTree);
+  EXPECT_EQ(pool, heapTree.nodePool());
+  EXPECT_EQ(nodes, pool->liveNodes());
+
+  // Clearing frees the pool
+  heapTree.clear();
+  EXPECT_EQ(nullptr, heapTree.nodePool());
+}
+
+TEST(RadixTree, NodePoolClone) {
+  RadixTree<IPAddress, int> ipTree(
+      RadixTree<IPAddress, int>::NodeDeleteCallback4(),
+      RadixTree<IPAddress, int>::NodeDeleteCallback6(),
+      true /* useNodePool */);
+  RadixTree<IPAddressV4, int> v4Tree(
+      RadixTree<IPAddressV4, int>::NodeDeleteCallback(),
+      RadixTreeTraits<IPAddressV4, int>(), true /* useNodePool */);
+  setupTestTree4(v4Tree);
+  for (auto v4itr: v4Tree) {
+    ipTree.insert(IPAddress(v4itr->ipAddress()), v4itr->masklen(),
+        v4itr->value());
+  }
+  auto v4TreeCopy = v4Tree.clone();
+  auto ipTreeCopy = ipTree.clone();
+  EXPECT_TRUE(v4Tree == v4TreeCopy);
+  EXPECT_TRUE(ipTree == ipTreeCopy);
+  ASSERT_NE(nullptr, v4TreeCopy.nodePool());
+  EXPECT_NE(v4Tree.nodePool(), v4TreeCopy.nodePool());
+  EXPECT_EQ(v4Tree.nodePool()->liveNodes(),
+      v4TreeCopy.nodePool()->liveNodes());
+}
@@ -1,4 +1,5 @@
 // Copyright 2004-present Facebook. All Rights Reserved.
+#include "fboss/lib/ConcurrentTimeSeriesWithMinMax.h"
 #include "fboss/lib/TimeSeriesWithMinMax.h"
 
 #include <folly/Benchmark.h>
@@ -6,6 +7,7 @@
 #include "common/init/Init.h"
 
 #include <algorithm>
+#include <thread>
 #include <vector>
 
 using namespace facebook::fboss;
@@ -37,6 +39,50 @@ BENCHMARK(VectorComparison, n) {
   }
 }
 
+namespace {
+
+constexpr int kThreads = 4;
+
+// Each of kThreads threads adds n values to the same time series
+template <typename TimeSeries>
+void addFromThreads(int n) {
+  TimeSeries buf;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&buf, n]() {
+      for (int i = 0; i < n; i++) {
+        buf.addValue(i);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  doNotOptimizeAway(buf.getMax());
+}
+
+} // namespace
+
+BENCHMARK(ConcurrentInsertionTest, n) {
+  ConcurrentTimeSeriesWithMinMax<int> buf;
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < n; j++) {
+      buf.addValue(j);
+    }
+    buf.getMax();
+  }
+}
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK(MultiThreadedInsertionTest, n) {
+  addFromThreads<TimeSeriesWithMinMax<int>>(n);
+}
+
+BENCHMARK_RELATIVE(MultiThreadedConcurrentInsertionTest, n) {
+  addFromThreads<ConcurrentTimeSeriesWithMinMax<int>>(n);
+}
+
 int main(int argc, char** argv) {
   facebook::initFacebook(&argc, &argv);
   runBenchmarks();
@@ -1,9 +1,11 @@
 // Copyright 2004-present Facebook. All Rights Reserved.
+#include "fboss/lib/ConcurrentTimeSeriesWithMinMax.h"
 #include "fboss/lib/TimeSeriesWithMinMax.h"
 
 #include <gtest/gtest.h>
 #include <chrono>
 #include <thread>
+#include <vector>
 
 using namespace facebook::fboss;
 
@@ -69,3 +71,44 @@ TEST(TimeSeriesWithMinMax, BasicTest) {
   } catch (std::runtime_error& e) {
   }
 }
+
+TEST(ConcurrentTimeSeriesWithMinMax, BasicTest) {
+  ConcurrentTimeSeriesWithMinMax<int> buffer(seconds(3), seconds(1));
+  EXPECT_THROW(buffer.getMax(), std::runtime_error);
+
+  buffer.addValue(5);
+  buffer.addValue(7);
+  buffer.addValue(3);
+  EXPECT_EQ(buffer.getMax(), 7);
+  EXPECT_EQ(buffer.getMin(), 3);
+
+  auto now = std::chrono::system_clock::now();
+  // Outside the interval
+  buffer.addValue(100, now - seconds(5));
+  EXPECT_EQ(buffer.getMax(), 7);
+  buffer.addValue(1, now - seconds(2));
+  EXPECT_EQ(buffer.getMin(), 1);
+  EXPECT_EQ(buffer.getMin(now - seconds(3), now - seconds(2)), 1);
+  EXPECT_EQ(buffer.getMax(now - seconds(3), now - seconds(2)), 1);
+
+  // A second later reuses that bucket, which starts afresh
+  buffer.addValue(6, now + seconds(1));
+  EXPECT_EQ(buffer.getMin(), 3);
+}
+
+TEST(ConcurrentTimeSeriesWithMinMax, ManyThreads) {
+  ConcurrentTimeSeriesWithMinMax<int64_t> buffer(seconds(60), seconds(1));
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; ++t) {
+    threads.emplace_back([&buffer, t]() {
+      for (int64_t i = 0; i < 10000; ++i) {
+        buffer.addValue(t * 10000 + i);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(buffer.getMin(), 0);
+  EXPECT_EQ(buffer.getMax(), 79999);
+}
@@ -12,17 +12,30 @@
 
 #include <glog/logging.h>
 
+#include <algorithm>
+#include <cstring>
+
 #include "fboss/lib/usb/UsbError.h"
 
+using folly::ByteRange;
 using folly::MutableByteRange;
 using std::lock_guard;
 
+namespace {
+// The CP2112 can't read more than 128 bytes at a time
+constexpr int kMaxReadLen = 128;
+// The CP2112 can only write 61 bytes at a time, and we burn one for
+// the offset
+constexpr int kMaxWriteLen = 60;
+} // namespace
+
 namespace facebook { namespace fboss {
 
 void BaseWedgeI2CBus::open() {
   dev_->open();
 
   selectedPort_ = NO_PORT;
+  heldPort_ = NO_PORT;
   verifyBus(true);
   initBus();
 
@@ -35,45 +48,60 @@ void BaseWedgeI2CBus::close() {
 
 void BaseWedgeI2CBus::read(uint8_t address, int offset,
                            int len, uint8_t* buf) {
-  CHECK_LE(offset, 255);
-
-  // CP2112 uses addresses in the on-the-wire format, while we generally
-  // pass them around in Linux standard format.
-  address <<= 1;
-
-  // Note that we don't use the writeRead() command, since this
-  // locks up the CP2112 chip if it times out.  We perform a separate write,
-  // followed by a read.  This releases the I2C bus between operations, but
-  // that's okay since there aren't any other master devices on the bus.
-
-  // Also note that we can't read more than 128 bytes at a time.
-  dev_->writeByte(address, offset);
-  if (len > 128) {
-    dev_->read(address, MutableByteRange(buf, 128));
-    dev_->writeByte(address, offset + 128);
-    dev_->read(address, MutableByteRange(buf + 128, len - 128));
-  } else {
-    dev_->read(address, MutableByteRange(buf, len));
-  }
+  transfer({ModuleOp{false, address, offset, len, buf}});
 }
 
 void BaseWedgeI2CBus::write(uint8_t address, int offset,
                             int len, const uint8_t* buf) {
-  CHECK_LE(offset, 255);
-
-  // CP2112 uses addresses in the on-the-wire format, while we generally
-  // pass them around in Linux standard format.
-  address <<= 1;
-
-  // The CP2112 can only write 61 bytes at a time, and we burn one for
-  // the offset
-  CHECK_LE(len, 60);
+  transfer({ModuleOp{true, address, offset, len, const_cast<uint8_t*>(buf)}});
+}
 
-  // XXX:  surely there's an easier way to do this?
-  uint8_t output[61]; // USB buffer size;
-  output[0] = offset;
-  memcpy(output + 1, buf, len);
-  dev_->write(address, MutableByteRange(output, len + 1));
+void BaseWedgeI2CBus::transfer(const std::vector<ModuleOp>& ops) {
+  // Size the scratch space for offsets and offset-prefixed writes up front,
+  // so the ranges we hand out below stay valid.
+  size_t scratchLen = 0;
+  for (const auto& op : ops) {
+    CHECK_LE(op.offset, 255);
+    if (op.write) {
+      CHECK_LE(op.len, kMaxWriteLen);
+      scratchLen += op.len + 1;
+    } else {
+      scratchLen += (op.len + kMaxReadLen - 1) / kMaxReadLen;
+    }
+  }
+  std::vector<uint8_t> scratch(scratchLen);
+  auto next = scratch.data();
+
+  std::vector<CP2112Intf::Transaction> xfers;
+  for (const auto& op : ops) {
+    // CP2112 uses addresses in the on-the-wire format, while we generally
+    // pass them around in Linux standard format.
+    uint8_t address = op.i2cAddress << 1;
+
+    if (op.write) {
+      next[0] = op.offset;
+      memcpy(next + 1, op.buf, op.len);
+      xfers.push_back(
+          CP2112Intf::Transaction::write(address, ByteRange(next, op.len + 1)));
+      next += op.len + 1;
+      continue;
+    }
+
+    // Note that we don't use the writeRead() command, since this
+    // locks up the CP2112 chip if it times out.  We perform a separate write,
+    // followed by a read.  This releases the I2C bus between operations, but
+    // that's okay since there aren't any other master devices on the bus.
+    for (int done = 0; done < op.len; done += kMaxReadLen) {
+      *next = op.offset + done;
+      xfers.push_back(
+          CP2112Intf::Transaction::write(address, ByteRange(next, 1)));
+      ++next;
+      auto chunk = std::min(kMaxReadLen, op.len - done);
+      xfers.push_back(CP2112Intf::Transaction::read(
+          address, MutableByteRange(op.buf + done, chunk)));
+    }
+  }
+  dev_->transfer(xfers);
 }
 
 void BaseWedgeI2CBus::moduleRead(unsigned int module, uint8_t address,
@@ -83,8 +111,7 @@ void BaseWedgeI2CBus::moduleRead(unsigned int module, uint8_t address,
 
   read(address, offset, len, buf);
 
-  // TODO: remove this after we ensure exclusive access to cp2112 chip
-  unselectQsfp();
+  finishAccess(module);
 }
 
 void BaseWedgeI2CBus::moduleWrite(unsigned int module, uint8_t address,
@@ -94,8 +121,30 @@ void BaseWedgeI2CBus::moduleWrite(unsigned int module, uint8_t address,
 
   write(address, offset, len, buf);
 
-  // TODO: remove this after we ensure exclusive access to cp2112 chip
-  unselectQsfp();
+  finishAccess(module);
+}
+
+void BaseWedgeI2CBus::moduleTransfer(unsigned int module,
+                                     const std::vector<ModuleOp>& ops) {
+  // Select the module once for the whole batch rather than around every op
+  selectQsfp(module);
+  CHECK_NE(selectedPort_, NO_PORT);
+
+  transfer(ops);
+
+  finishAccess(module);
+}
+
+void BaseWedgeI2CBus::beginModuleAccess(unsigned int module) {
+  CHECK_EQ(heldPort_, NO_PORT);
+  selectQsfp(module);
+  heldPort_ = module;
+}
+
+void BaseWedgeI2CBus::endModuleAccess(unsigned int module) {
+  CHECK_EQ(heldPort_, module);
+  heldPort_ = NO_PORT;
+  finishAccess(module);
 }
 
 bool BaseWedgeI2CBus::isPresent(unsigned int module) {
@@ -123,6 +172,14 @@ void BaseWedgeI2CBus::selectQsfp(unsigned int port) {
   }
 }
 
+void BaseWedgeI2CBus::finishAccess(unsigned int module) {
+  if (heldPort_ == module) {
+    return;
+  }
+  // TODO: remove this after we ensure exclusive access to cp2112 chip
+  unselectQsfp();
+}
+
 void BaseWedgeI2CBus::unselectQsfp() {
   VLOG(4) << "unselecting all QSFPs";
   if (selectedPort_ != NO_PORT) {
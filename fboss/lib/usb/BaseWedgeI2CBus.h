@@ -42,6 +42,10 @@ class BaseWedgeI2CBus : public TransceiverI2CApi {
       int offset,
       int len,
       const uint8_t* buf) override;
+  void moduleTransfer(unsigned int module, const std::vector<ModuleOp>& ops)
+      override;
+  void beginModuleAccess(unsigned int module) override;
+  void endModuleAccess(unsigned int module) override;
   void read(uint8_t i2cAddress, int offset, int len, uint8_t* buf);
   void write(uint8_t i2cAddress, int offset, int len, const uint8_t* buf);
 
@@ -57,6 +61,8 @@ class BaseWedgeI2CBus : public TransceiverI2CApi {
 
   std::unique_ptr<CP2112Intf> dev_;
   unsigned int selectedPort_{NO_PORT};
+  // Module kept selected by beginModuleAccess(), if any
+  unsigned int heldPort_{NO_PORT};
 
  private:
   /*
@@ -65,6 +71,14 @@ class BaseWedgeI2CBus : public TransceiverI2CApi {
    */
   void selectQsfp(unsigned int module);
   void unselectQsfp();
+  // Unselect after an access, unless the module is held selected
+  void finishAccess(unsigned int module);
+
+  /*
+   * Run the ops as a single batch of CP2112 transactions against whichever
+   * QSFP is currently selected.
+   */
+  void transfer(const std::vector<ModuleOp>& ops);
 
   // Forbidden copy constructor and assignment operator
   BaseWedgeI2CBus(BaseWedgeI2CBus const &) = delete;
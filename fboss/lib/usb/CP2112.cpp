@@ -285,6 +285,35 @@ void CP2112::setSMBusConfig(SMBusConfig config) {
 void CP2112::read(uint8_t address,
                   MutableByteRange buf,
                   milliseconds timeout) {
+  ensureGoodState();
+  readImpl(address, buf, timeout);
+}
+
+void CP2112::write(uint8_t address, ByteRange buf, milliseconds timeout) {
+  ensureGoodState();
+  writeImpl(address, buf, timeout);
+}
+
+void CP2112::transfer(const std::vector<Transaction>& xfers,
+                      milliseconds timeout) {
+  ensureGoodState();
+  auto end = steady_clock::now() + timeout;
+  for (const auto& xfer : xfers) {
+    auto timeLeft = updateTimeLeft(end, false);
+    if (timeLeft <= milliseconds(0)) {
+      throw UsbError("timed out running batch of I2C transactions");
+    }
+    if (xfer.isRead()) {
+      readImpl(xfer.address, xfer.readBuf, timeLeft);
+    } else {
+      writeImpl(xfer.address, xfer.writeBuf, timeLeft);
+    }
+  }
+}
+
+void CP2112::readImpl(uint8_t address,
+                      MutableByteRange buf,
+                      milliseconds timeout) {
   if (buf.size() > 512) {
     throw UsbError("cannot read more than 512 bytes at once");
   }
@@ -294,7 +323,6 @@ void CP2112::read(uint8_t address,
     // status after issuing a 0-length read appears to confirm this.
     throw UsbError("0-length reads are not allowed");
   }
-  ensureGoodState();
 
   // Send the read request
   uint8_t usbBuf[64];
@@ -307,7 +335,7 @@ void CP2112::read(uint8_t address,
   processReadResponse(buf, timeout);
 }
 
-void CP2112::write(uint8_t address, ByteRange buf, milliseconds timeout) {
+void CP2112::writeImpl(uint8_t address, ByteRange buf, milliseconds timeout) {
   if (buf.size() > 61) {
     throw UsbError("cannot write more than 61 bytes at once");
   }
@@ -317,7 +345,6 @@ void CP2112::write(uint8_t address, ByteRange buf, milliseconds timeout) {
     // status after issuing a 0-length write appears to confirm this.
     throw UsbError("attempted 0-length write");
   }
-  ensureGoodState();
 
   VLOG(5) << "writing to i2c address " << std::hex << (int)address;
 
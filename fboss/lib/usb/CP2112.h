@@ -16,6 +16,7 @@
 
 #include <chrono>
 #include <cstdint>
+#include <vector>
 
 struct libusb_transfer;
 
@@ -42,6 +43,46 @@ class CP2112Intf {
 
   virtual std::chrono::milliseconds getDefaultTimeout() const = 0;
 
+  /*
+   * One SMBus read or write in a batch passed to transfer().  Reads have a
+   * non-empty readBuf, and writes a non-empty writeBuf.
+   */
+  struct Transaction {
+    static Transaction read(uint8_t address, folly::MutableByteRange buf) {
+      return Transaction{address, buf, folly::ByteRange()};
+    }
+    static Transaction write(uint8_t address, folly::ByteRange buf) {
+      return Transaction{address, folly::MutableByteRange(), buf};
+    }
+    bool isRead() const {
+      return !readBuf.empty();
+    }
+
+    uint8_t address;
+    folly::MutableByteRange readBuf;
+    folly::ByteRange writeBuf;
+  };
+
+  /*
+   * Run a batch of transactions back to back, in order, stopping at the
+   * first one that fails.  The default runs them one at a time, each with
+   * the full timeout; CP2112 applies the timeout to the whole batch.
+   */
+  virtual void transfer(
+      const std::vector<Transaction>& xfers,
+      std::chrono::milliseconds timeout) {
+    for (const auto& xfer : xfers) {
+      if (xfer.isRead()) {
+        read(xfer.address, xfer.readBuf, timeout);
+      } else {
+        write(xfer.address, xfer.writeBuf, timeout);
+      }
+    }
+  }
+  void transfer(const std::vector<Transaction>& xfers) {
+    transfer(xfers, getDefaultTimeout());
+  }
+
   // Move shortened read/write forms to base interface so they
   // can be used in tests
   void read(uint8_t address, folly::MutableByteRange buf) {
@@ -314,6 +355,19 @@ class CP2112 : public CP2112Intf {
              std::chrono::milliseconds timeout) override;
   using CP2112Intf::write;
 
+  /*
+   * Run a batch of reads and writes.
+   *
+   * The chip only runs one SMBus transaction at a time, so the batch still
+   * waits for each one to complete before starting the next.  What it saves
+   * is the work between them: the device state is only checked once, and
+   * each transaction is only validated and sent, without returning to the
+   * caller in between.
+   */
+  void transfer(const std::vector<Transaction>& xfers,
+                std::chrono::milliseconds timeout) override;
+  using CP2112Intf::transfer;
+
   /*
    * An atomic write followed by read, without releasing the I2C bus.
    *
@@ -395,6 +449,11 @@ class CP2112 : public CP2112Intf {
   void ensureGoodState();
   void flushTransfers();
 
+  void readImpl(uint8_t address, folly::MutableByteRange buf,
+                std::chrono::milliseconds timeout);
+  void writeImpl(uint8_t address, folly::ByteRange buf,
+                 std::chrono::milliseconds timeout);
+
   static std::string getBusyStatusMsg(uint8_t status1);
   static std::string getCompleteStatusMsg(uint8_t status1);
   void processReadResponse(folly::MutableByteRange buf,
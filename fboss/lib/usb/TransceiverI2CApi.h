@@ -14,6 +14,7 @@
 #include <cstdint>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 namespace facebook { namespace fboss {
 
@@ -44,8 +45,60 @@ class TransceiverI2CApi {
   virtual void moduleWrite(unsigned int module, uint8_t i2cAddress,
                            int offset, int len, const uint8_t* buf) = 0;
 
+  /*
+   * One read or write in a batch passed to moduleTransfer().  For writes
+   * buf is only read from.
+   */
+  struct ModuleOp {
+    bool write;
+    uint8_t i2cAddress;
+    int offset;
+    int len;
+    uint8_t* buf;
+  };
+
+  /*
+   * Run a batch of reads and writes against one module, in order.  Buses
+   * that can select the module once for the whole batch and queue the
+   * transactions back to back should override this.
+   */
+  virtual void moduleTransfer(unsigned int module,
+                              const std::vector<ModuleOp>& ops) {
+    for (const auto& op : ops) {
+      if (op.write) {
+        moduleWrite(module, op.i2cAddress, op.offset, op.len, op.buf);
+      } else {
+        moduleRead(module, op.i2cAddress, op.offset, op.len, op.buf);
+      }
+    }
+  }
+
+  /*
+   * Group a series of accesses to one module.  Between the two calls the
+   * bus may keep the module selected rather than selecting and unselecting
+   * it around every read and write, and other threads may be kept off the
+   * bus.  Calls must be paired, on the same thread.
+   */
+  virtual void beginModuleAccess(unsigned int /*module*/) {}
+  virtual void endModuleAccess(unsigned int /*module*/) {}
+
   virtual void verifyBus(bool autoReset) = 0;
 
+  struct ModuleStatus {
+    bool present{false};
+    bool interrupt{false};
+  };
+
+  /*
+   * For buses that can read every module's presence and interrupt lines at
+   * once, e.g. from CPLD or FPGA registers, fill in the status of each
+   * module (entry 0 for module 1) and return true.  Returns false if there
+   * is no such source, and modules can only be found by polling each one.
+   */
+  virtual bool getModuleStatus(std::vector<ModuleStatus>* /*status*/) {
+    return false;
+  }
+
   virtual bool isPresent(unsigned int module) = 0;
 
   /*
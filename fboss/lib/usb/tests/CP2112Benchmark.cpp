@@ -0,0 +1,132 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/lib/usb/BaseWedgeI2CBus.h"
+
+#include <folly/Benchmark.h>
+#include "common/init/Init.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+
+using namespace facebook::fboss;
+
+namespace {
+
+// Rough cost of a single USB round trip to the CP2112
+constexpr auto kTransactionLatency = std::chrono::microseconds(20);
+
+void spin(std::chrono::microseconds duration) {
+  auto end = std::chrono::steady_clock::now() + duration;
+  while (std::chrono::steady_clock::now() < end) {
+  }
+}
+
+/*
+ * A CP2112 that answers every read with zeros after a fixed delay, so the
+ * benchmark measures how many transactions each access pattern needs.
+ */
+class FakeCP2112 : public CP2112Intf {
+ public:
+  void open(bool /*setSmbusConfig*/) override {}
+  void close() override {}
+  void resetDevice() override {}
+
+  void read(uint8_t /*address*/,
+            folly::MutableByteRange buf,
+            std::chrono::milliseconds /*timeout*/) override {
+    spin(kTransactionLatency);
+    std::fill(buf.begin(), buf.end(), 0);
+  }
+  using CP2112Intf::read;
+
+  void write(uint8_t /*address*/,
+             folly::ByteRange /*buf*/,
+             std::chrono::milliseconds /*timeout*/) override {
+    spin(kTransactionLatency);
+  }
+  using CP2112Intf::write;
+
+  std::chrono::milliseconds getDefaultTimeout() const override {
+    return std::chrono::milliseconds(500);
+  }
+};
+
+// Like wedge, selecting a QSFP takes a write to each of two PCA9548s
+class FakeWedgeI2CBus : public BaseWedgeI2CBus {
+ public:
+  FakeWedgeI2CBus() : BaseWedgeI2CBus(std::make_unique<FakeCP2112>()) {}
+
+  void verifyBus(bool /*autoReset*/) override {}
+
+ protected:
+  void initBus() override {}
+  void selectQsfpImpl(unsigned int module) override {
+    dev_->writeByte(0xe8, module);
+    dev_->writeByte(0xec, module);
+    selectedPort_ = module;
+  }
+};
+
+constexpr unsigned int kModule = 1;
+constexpr uint8_t kPageSelect = 127;
+
+// The reads a QSFP refresh makes: the lower page, then pages 0 and 3
+struct QsfpPages {
+  std::array<uint8_t, 128> lower;
+  std::array<uint8_t, 128> page0;
+  std::array<uint8_t, 128> page3;
+  uint8_t page0Select{0};
+  uint8_t page3Select{3};
+};
+
+void refreshSeparately(FakeWedgeI2CBus& bus, QsfpPages& pages) {
+  auto addr = TransceiverI2CApi::ADDR_QSFP;
+  bus.moduleRead(kModule, addr, 0, 128, pages.lower.data());
+  bus.moduleWrite(kModule, addr, kPageSelect, 1, &pages.page0Select);
+  bus.moduleRead(kModule, addr, 128, 128, pages.page0.data());
+  bus.moduleWrite(kModule, addr, kPageSelect, 1, &pages.page3Select);
+  bus.moduleRead(kModule, addr, 128, 128, pages.page3.data());
+}
+
+void refreshBatched(FakeWedgeI2CBus& bus, QsfpPages& pages) {
+  auto addr = TransceiverI2CApi::ADDR_QSFP;
+  bus.moduleTransfer(
+      kModule,
+      {{false, addr, 0, 128, pages.lower.data()},
+       {true, addr, kPageSelect, 1, &pages.page0Select},
+       {false, addr, 128, 128, pages.page0.data()},
+       {true, addr, kPageSelect, 1, &pages.page3Select},
+       {false, addr, 128, 128, pages.page3.data()}});
+}
+
+} // namespace
+
+BENCHMARK(QsfpPagesSeparateOps, n) {
+  FakeWedgeI2CBus bus;
+  QsfpPages pages;
+  for (unsigned int i = 0; i < n; ++i) {
+    refreshSeparately(bus, pages);
+  }
+}
+
+BENCHMARK_RELATIVE(QsfpPagesBatched, n) {
+  FakeWedgeI2CBus bus;
+  QsfpPages pages;
+  for (unsigned int i = 0; i < n; ++i) {
+    refreshBatched(bus, pages);
+  }
+}
+
+int main(int argc, char** argv) {
+  facebook::initFacebook(&argc, &argv);
+  folly::runBenchmarks();
+  return 0;
+}
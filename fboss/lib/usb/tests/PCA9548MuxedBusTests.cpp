@@ -300,3 +300,68 @@ TEST(PCA9548MuxedBusTests, MultiLayerMultiMux) {
     EXPECT_EQ(root2->children(7)[1]->mux()->selected(), 0);
   }
 }
+
+TEST(PCA9548MuxedBusTests, ModuleTransferSelectsOnce) {
+  FakeMuxBus<1, 1> bus;
+  bus.open();
+
+  uint8_t page[256];
+  uint8_t pageSelect = 3;
+  const uint8_t pageSelectWrite[] = {127, 3};
+  auto addr = TransceiverI2CApi::ADDR_QSFP;
+  {
+    InSequence dummy;
+
+    // select
+    EXPECT_CALL(*bus.fakeDev(), write(_, _, _)).Times(1);
+    // 256 byte read is split in two offset writes and reads
+    EXPECT_CALL(*bus.fakeDev(), write(_, _, _)).Times(1);
+    EXPECT_CALL(*bus.fakeDev(), read(_, _, _)).Times(1);
+    EXPECT_CALL(*bus.fakeDev(), write(_, _, _)).Times(1);
+    EXPECT_CALL(*bus.fakeDev(), read(_, _, _)).Times(1);
+    // page select write, with the offset prefixed
+    EXPECT_CALL(
+        *bus.fakeDev(),
+        write(
+            addr << 1,
+            folly::ByteRange(pageSelectWrite, sizeof(pageSelectWrite)),
+            _))
+        .Times(1);
+    // unselect
+    EXPECT_CALL(*bus.fakeDev(), write(_, _, _)).Times(1);
+
+    bus.moduleTransfer(
+        1,
+        {{false, addr, 0, sizeof(page), page},
+         {true, addr, 127, 1, &pageSelect}});
+  }
+}
+
+TEST(PCA9548MuxedBusTests, ModuleAccessKeepsSelection) {
+  FakeMuxBus<1, 1> bus;
+  bus.open();
+
+  uint8_t buf[1];
+  auto addr = TransceiverI2CApi::ADDR_QSFP;
+  {
+    InSequence dummy;
+
+    // select
+    EXPECT_CALL(*bus.fakeDev(), write(_, _, _)).Times(1);
+    // two reads, each an offset write and a read, with no mux writes
+    // in between
+    EXPECT_CALL(*bus.fakeDev(), write(_, _, _)).Times(1);
+    EXPECT_CALL(*bus.fakeDev(), read(_, _, _)).Times(1);
+    EXPECT_CALL(*bus.fakeDev(), write(_, _, _)).Times(1);
+    EXPECT_CALL(*bus.fakeDev(), read(_, _, _)).Times(1);
+    // unselect
+    EXPECT_CALL(*bus.fakeDev(), write(_, _, _)).Times(1);
+
+    bus.beginModuleAccess(1);
+    bus.moduleRead(1, addr, 0, sizeof(buf), buf);
+    bus.moduleRead(1, addr, 3, sizeof(buf), buf);
+    EXPECT_TRUE(bus.roots()[0]->mux()->isSelected(0));
+    bus.endModuleAccess(1);
+    EXPECT_EQ(bus.roots()[0]->mux()->selected(), 0);
+  }
+}
@@ -13,6 +13,7 @@
 
 #include <cstdint>
 #include <mutex>
+#include <vector>
 
 #include <folly/Synchronized.h>
 
@@ -43,6 +44,32 @@ namespace fboss {
  * variant of Mdio being used.
  */
 
+/*
+ * One register access in a list passed to transactCl45(). Reads store the
+ * value they read in data.
+ */
+struct MdioOp {
+  static MdioOp read(
+      phy::PhyAddress physAddr,
+      phy::Cl45DeviceAddress devAddr,
+      phy::Cl45RegisterAddress regAddr) {
+    return MdioOp{false, physAddr, devAddr, regAddr, 0};
+  }
+  static MdioOp write(
+      phy::PhyAddress physAddr,
+      phy::Cl45DeviceAddress devAddr,
+      phy::Cl45RegisterAddress regAddr,
+      phy::Cl45Data data) {
+    return MdioOp{true, physAddr, devAddr, regAddr, data};
+  }
+
+  bool isWrite{false};
+  phy::PhyAddress physAddr{0};
+  phy::Cl45DeviceAddress devAddr{0};
+  phy::Cl45RegisterAddress regAddr{0};
+  phy::Cl45Data data{0};
+};
+
 class Mdio {
  public:
   virtual ~Mdio() {}
@@ -58,6 +85,18 @@ class Mdio {
       phy::Cl45DeviceAddress devAddr,
       phy::Cl45RegisterAddress regAddr,
       phy::Cl45Data data) = 0;
+
+  // Perform ops in order. This does them one at a time; variants whose
+  // hardware can queue several accesses should override it to do so.
+  virtual void transactCl45(std::vector<MdioOp>* ops) {
+    for (auto& op : *ops) {
+      if (op.isWrite) {
+        writeCl45(op.physAddr, op.devAddr, op.regAddr, op.data);
+      } else {
+        op.data = readCl45(op.physAddr, op.devAddr, op.regAddr);
+      }
+    }
+  }
 };
 
 template <typename IO>
@@ -84,6 +123,12 @@ class MdioController {
     io_.lock()->writeCl45(physAddr, devAddr, regAddr, data);
   }
 
+  // Perform a list of reads and writes, holding the controller for all of
+  // them rather than taking it once per register.
+  void transactCl45(std::vector<MdioOp>* ops) {
+    io_.lock()->transactCl45(ops);
+  }
+
   // This can be useful by clients to do multiple MDIO reads/writes
   // w/out releasing the controller. Sample:
   // {
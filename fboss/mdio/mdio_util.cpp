@@ -7,12 +7,17 @@
  *  of patent rights can be found in the PATENTS file in the same directory.
  *
  */
+#include "fboss/mdio/Mdio.h"
+
 #include <folly/init/Init.h>
 #include <folly/logging/Init.h>
 #include <folly/logging/xlog.h>
 
 #include <gflags/gflags.h>
 
+#include <chrono>
+#include <vector>
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -21,11 +26,31 @@ FOLLY_INIT_LOGGING_CONFIG("fboss=DBG2; default:async=true");
 
 extern int mdio_read(int phy, int dev, int reg);
 extern void mdio_write(int phy, int dev, int reg, int data);
+// Platforms that can issue several accesses at once may provide this
+extern void mdio_transact(std::vector<facebook::fboss::MdioOp>* ops)
+    __attribute__((weak));
+
+using facebook::fboss::MdioOp;
+
+static void transact(std::vector<MdioOp>* ops) {
+  if (mdio_transact) {
+    mdio_transact(ops);
+    return;
+  }
+  for (auto& op : *ops) {
+    if (op.isWrite) {
+      mdio_write(op.physAddr, op.devAddr, op.regAddr, op.data);
+    } else {
+      op.data = mdio_read(op.physAddr, op.devAddr, op.regAddr);
+    }
+  }
+}
 
 static void usage(const char* cmd) {
   fprintf(stderr, "Usage:\n");
   fprintf(stderr, "\t%s read PHY DEVICE REGISTER\n", cmd);
   fprintf(stderr, "\t%s write PHY DEVICE REGISTER DATA\n", cmd);
+  fprintf(stderr, "\t%s dump PHY DEVICE REGISTER COUNT\n", cmd);
 }
 
 int main(int argc, char* argv[]) {
@@ -39,11 +64,13 @@ int main(int argc, char* argv[]) {
   }
 
   bool doWrite{false};
+  bool doDump{false};
 
   int phyAddr;
   int devAddr;
   int regAddr;
   int data;
+  int count;
 
   if (strcmp(argv[1], "read") == 0) {
     if (argc != 5) {
@@ -56,6 +83,12 @@ int main(int argc, char* argv[]) {
       return 1;
     }
     doWrite = true;
+  } else if (strcmp(argv[1], "dump") == 0) {
+    if (argc != 6) {
+      usage(argv[0]);
+      return 1;
+    }
+    doDump = true;
   }
 
   auto checkParameter = [](int value, int low, int high, const char *what) {
@@ -79,8 +112,28 @@ int main(int argc, char* argv[]) {
     checkParameter(data, 0, 255 * 255, "data");
   }
 
+  if (doDump) {
+    count = strtoul(argv[5], nullptr, 0);
+    checkParameter(count, 1, 65536 - regAddr, "count");
+  }
+
   try {
-    if (doWrite) {
+    if (doDump) {
+      std::vector<MdioOp> ops;
+      for (int i = 0; i < count; ++i) {
+        ops.push_back(MdioOp::read(phyAddr, devAddr, regAddr + i));
+      }
+      auto start = std::chrono::steady_clock::now();
+      transact(&ops);
+      std::chrono::duration<double> elapsed =
+          std::chrono::steady_clock::now() - start;
+      for (const auto& op : ops) {
+        printf("%#x: %#x\n", op.regAddr, op.data);
+      }
+      fprintf(stderr, "%d registers in %.3fs, %.0f transactions/sec\n",
+              count, elapsed.count(),
+              elapsed.count() > 0 ? count / elapsed.count() : 0);
+    } else if (doWrite) {
       mdio_write(phyAddr, devAddr, regAddr, data);
     } else {
       printf("%#x\n", mdio_read(phyAddr, devAddr, regAddr));
@@ -1,6 +1,7 @@
 #include "NetlinkManager.h"
 #include <chrono>
 #include "NetlinkManagerException.h"
+#include "common/stats/ThreadCachedServiceData.h"
 #include "folly/Format.h"
 #include "folly/ScopeGuard.h"
 #include "folly/futures/Future.h"
@@ -13,6 +14,11 @@ using facebook::fb303::cpp2::fb_status;
 DEFINE_string(ip, "::1", "ip of the switch. Default to local host");
 DEFINE_int32(fboss_port, 5909, "Port for the fboss ctrl thrift service");
 DEFINE_bool(debug, false, "Enable debug mode");
+DEFINE_int32(
+    netlink_route_batch_ms,
+    50,
+    "Coalesce netlink route updates over this many milliseconds before "
+    "sending them to the agent");
 DEFINE_string(
     interfaces,
     "",
@@ -26,6 +32,11 @@ struct nl_dump_params initDumpParams() {
   dumpParams.dp_fd = stdout;
   return dumpParams;
 }
+
+constexpr auto kRouteEvents = "netlink_manager.route_events";
+constexpr auto kRouteEventsCoalesced = "netlink_manager.route_events_coalesced";
+constexpr auto kRouteRpcs = "netlink_manager.route_rpcs";
+constexpr auto kRouteEventsPerRpc = "netlink_manager.route_events_per_rpc";
 } // namespace
 namespace facebook {
 namespace fboss {
@@ -166,7 +177,30 @@ void NetlinkManager::registerWNetlink() {
 
 void NetlinkManager::startListening() {
   int fd = nl_cache_mngr_get_fd(nlResources_->manager);
-  poller_ = std::make_unique<NetlinkPoller>(eb_, fd, nlResources_->manager);
+  poller_ = std::make_unique<NetlinkPoller>(
+      eb_, fd, nlResources_->manager, [this]() { resyncRoutes(); });
+}
+
+void NetlinkManager::resyncRoutes() {
+  auto start = std::chrono::steady_clock::now();
+  // This diffs a fresh dump against the cache, and calls back for each
+  // route that was added, removed or changed in the meantime, which then
+  // go through the usual batching.
+  auto errCode = nl_cache_resync(
+      nlResources_->sock, nlResources_->routeCache, netlinkRouteUpdated, this);
+  auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - start);
+  tcData().addStatValue("netlink_manager.route_resyncs", 1, stats::SUM);
+  tcData().addStatValue(
+      "netlink_manager.route_resync_ms", duration.count(), stats::AVG);
+  if (errCode < 0) {
+    // Only a full sync can recover from here
+    LOG(ERROR) << "Route cache resync failed, syncing the full FIB: "
+               << nl_geterror(errCode);
+    callSyncFib();
+    return;
+  }
+  VLOG(1) << "Resynced route cache in " << duration.count() << "ms";
 }
 
 void NetlinkManager::terminateEventBase() {
@@ -237,7 +271,9 @@ void NetlinkManager::netlinkRouteUpdated(
   }
 
   switch (nlOperation) {
-    case NL_ACT_NEW: {
+    case NL_ACT_NEW:
+    case NL_ACT_CHANGE: {
+      // Adding a route replaces any existing one for the prefix
       nlm->addRouteViaFbossThrift(nlDst, nexthops);
       break;
     }
@@ -245,11 +281,6 @@ void NetlinkManager::netlinkRouteUpdated(
       nlm->deleteRouteViaFbossThrift(nlDst);
       break;
     }
-    case NL_ACT_CHANGE: {
-      VLOG(2) << "Not updating state due to unimplemented"
-              << "NL_ACT_CHANGE netlink operation";
-      break;
-    }
     default: {
       VLOG(0) << "Not updating state due to unknown netlink operation "
               << std::to_string(nlOperation);
@@ -265,39 +296,108 @@ void NetlinkManager::addRouteViaFbossThrift(
   UnicastRoute unicastRoute;
   unicastRoute.dest = nlAddrToIpPrefix(nlDst);
   unicastRoute.nextHopAddrs = nexthops;
-  eb_->runInEventBaseThread([this, unicastRoute]() {
-    FbossClient fbossClient = getFbossClient(FLAGS_ip, FLAGS_fboss_port);
-    fbossClient->future_addUnicastRoute(FBOSS_CLIENT_ID, unicastRoute)
-        .thenValue(
-            [](auto&&) { VLOG(2) << "NetlinkManager route add success"; })
+  auto prefix = unicastRoute.dest;
+  queueRouteUpdate(std::move(prefix), std::move(unicastRoute));
+}
+
+void NetlinkManager::deleteRouteViaFbossThrift(struct nl_addr* nlDst) {
+  queueRouteUpdate(nlAddrToIpPrefix(nlDst), folly::none);
+}
+
+void NetlinkManager::queueRouteUpdate(
+    IpPrefix prefix,
+    folly::Optional<UnicastRoute> route) {
+  // Netlink callbacks run from the poller, on eb_'s thread
+  DCHECK(eb_->isInEventBaseThread());
+  ++pendingEvents_;
+
+  auto key = std::make_pair(binAddrToStr(prefix.ip), prefix.prefixLength);
+  auto it = pendingRoutes_.find(key);
+  if (it == pendingRoutes_.end()) {
+    PendingRoute pending;
+    pending.prefix = std::move(prefix);
+    pending.addedInBatch = route.hasValue();
+    pending.route = std::move(route);
+    pendingRoutes_.emplace(std::move(key), std::move(pending));
+  } else if (!route && it->second.addedInBatch) {
+    // Added and deleted again before the agent heard about it
+    pendingRoutes_.erase(it);
+  } else {
+    it->second.route = std::move(route);
+  }
+
+  if (!flushScheduled_) {
+    flushScheduled_ = true;
+    eb_->runAfterDelay(
+        [this]() { flushRouteUpdates(); }, FLAGS_netlink_route_batch_ms);
+  }
+}
+
+void NetlinkManager::flushRouteUpdates() {
+  flushScheduled_ = false;
+  auto events = pendingEvents_;
+  pendingEvents_ = 0;
+
+  std::vector<UnicastRoute> adds;
+  std::vector<IpPrefix> deletes;
+  for (auto& entry : pendingRoutes_) {
+    if (entry.second.route) {
+      adds.push_back(std::move(*entry.second.route));
+    } else {
+      deletes.push_back(std::move(entry.second.prefix));
+    }
+  }
+  pendingRoutes_.clear();
+
+  int rpcs = (adds.empty() ? 0 : 1) + (deletes.empty() ? 0 : 1);
+  tcData().addStatValue(kRouteEvents, events, stats::SUM);
+  tcData().addStatValue(
+      kRouteEventsCoalesced,
+      events - adds.size() - deletes.size(),
+      stats::SUM);
+  if (!rpcs) {
+    return;
+  }
+  tcData().addStatValue(kRouteRpcs, rpcs, stats::SUM);
+  tcData().addStatValue(kRouteEventsPerRpc, events / rpcs, stats::AVG);
+  VLOG(2) << "Sending " << adds.size() << " route adds and " << deletes.size()
+          << " route deletes for " << events << " netlink updates";
+
+  // Keep the client alive until the calls complete
+  std::shared_ptr<FbossCtrlAsyncClient> fbossClient =
+      getFbossClient(FLAGS_ip, FLAGS_fboss_port);
+  if (!deletes.empty()) {
+    auto numDeletes = deletes.size();
+    fbossClient->future_deleteUnicastRoutes(FBOSS_CLIENT_ID, deletes)
+        .thenValue([numDeletes](auto&&) {
+          VLOG(2) << "NetlinkManager deleted " << numDeletes << " routes";
+        })
         .thenError(
             folly::tag_t<std::exception>{},
-            [unicastRoute](const std::exception& ex) {
-              BinaryAddress binaryDst = unicastRoute.dest.ip;
+            [numDeletes](const std::exception& ex) {
               VLOG(2) << folly::sformat(
-                  "Route add failed for destination {}. Error sending thrift calls to FBOSS agent: {}",
-                  binAddrToStr(binaryDst),
+                  "Deleting {} routes failed. Error sending thrift calls to FBOSS agent: {}",
+                  numDeletes,
                   ex.what());
-            });
-  });
-}
-
-void NetlinkManager::deleteRouteViaFbossThrift(struct nl_addr* nlDst) {
-  IpPrefix prefix = nlAddrToIpPrefix(nlDst);
-
-  eb_->runInEventBaseThread([this, prefix]() {
-    FbossClient fbossClient = getFbossClient(FLAGS_ip, FLAGS_fboss_port);
-    fbossClient->future_deleteUnicastRoute(FBOSS_CLIENT_ID, prefix)
-        .thenValue(
-            [](auto&&) { VLOG(2) << "NetlinkManager route delete success"; })
-        .thenError(folly::tag_t<std::exception>{}, [prefix](const std::exception& ex) {
-          BinaryAddress binaryDst = prefix.ip;
-          VLOG(2) << folly::sformat(
-              "Route delete failed for destination {}. Error sending thrift calls to FBOSS agent: {}",
-              binAddrToStr(binaryDst),
-              ex.what());
-        });
-  });
+            })
+        .ensure([fbossClient]() {});
+  }
+  if (!adds.empty()) {
+    auto numAdds = adds.size();
+    fbossClient->future_addUnicastRoutes(FBOSS_CLIENT_ID, adds)
+        .thenValue([numAdds](auto&&) {
+          VLOG(2) << "NetlinkManager added " << numAdds << " routes";
+        })
+        .thenError(
+            folly::tag_t<std::exception>{},
+            [numAdds](const std::exception& ex) {
+              VLOG(2) << folly::sformat(
+                  "Adding {} routes failed. Error sending thrift calls to FBOSS agent: {}",
+                  numAdds,
+                  ex.what());
+            })
+        .ensure([fbossClient]() {});
+  }
 }
 } // namespace fboss
 } // namespace facebook
@@ -5,8 +5,12 @@ extern "C" {
 #include <netlink/socket.h>
 }
 
+#include <folly/Optional.h>
+#include <map>
 #include <mutex>
 #include <string>
+#include <utility>
+#include <vector>
 #include "NetlinkPoller.h"
 #include "NlResources.h"
 #include "fboss/agent/if/gen-cpp2/FbossCtrl.h"
@@ -40,6 +44,11 @@ class NetlinkManager {
       const std::string& ip,
       const int& port);
   void startListening();
+  /*
+   * Bring the route cache back in line with the kernel after notifications
+   * were lost, sending the agent only the routes that changed.
+   */
+  void resyncRoutes();
   void testFbossClient();
   void callSyncFib();
   static void netlinkRouteUpdated(
@@ -65,10 +74,18 @@ class NetlinkManager {
         return "unknown";
     }
   }
+  /*
+   * Route updates are coalesced over --netlink_route_batch_ms and sent to
+   * the agent as one addUnicastRoutes and one deleteUnicastRoutes call.
+   * Only the last update to each prefix in a batch is sent, and a route
+   * both added and deleted within a batch is not sent at all.
+   */
   void addRouteViaFbossThrift(
       struct nl_addr* nlDst,
       const std::vector<BinaryAddress>& nexthops);
   void deleteRouteViaFbossThrift(struct nl_addr* nlDst);
+  void queueRouteUpdate(IpPrefix prefix, folly::Optional<UnicastRoute> route);
+  void flushRouteUpdates();
   void logAndDie(const char* msg);
   void terminateEventBase();
 
@@ -77,6 +94,19 @@ class NetlinkManager {
   std::unique_ptr<NetlinkPoller> poller_{nullptr};
   std::unique_ptr<NlResources> nlResources_{nullptr};
   std::mutex interfacesMutex_;
+
+  struct PendingRoute {
+    IpPrefix prefix;
+    // Set for adds, unset for deletes
+    folly::Optional<UnicastRoute> route;
+    // The batch's first update for the prefix was an add, so the agent
+    // doesn't know about the route yet
+    bool addedInBatch{false};
+  };
+  // Only touched from eb_'s thread
+  std::map<std::pair<std::string, int16_t>, PendingRoute> pendingRoutes_;
+  size_t pendingEvents_{0};
+  bool flushScheduled_{false};
 };
 } // namespace fboss
 } // namespace facebook
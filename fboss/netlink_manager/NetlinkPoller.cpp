@@ -1,15 +1,22 @@
 #include "NetlinkPoller.h"
+#include "common/stats/ThreadCachedServiceData.h"
 #include "folly/io/async/EventBase.h"
 
+extern "C" {
+#include <netlink/errno.h>
+}
+
 namespace facebook {
 namespace fboss {
 
 NetlinkPoller::NetlinkPoller(
     folly::EventBase* eb,
     int fd,
-    struct nl_cache_mngr* manager)
+    struct nl_cache_mngr* manager,
+    std::function<void()> onOverrun)
     : folly::EventHandler(eb, folly::NetworkSocket::fromFd(fd)),
-      manager_(manager) {
+      manager_(manager),
+      onOverrun_(std::move(onOverrun)) {
   DCHECK(eb) << "NULL pointer to EventBase";
   if (fd == -1) {
     int mngrFd = nl_cache_mngr_get_fd(manager);
@@ -19,8 +26,25 @@ NetlinkPoller::NetlinkPoller(
 }
 
 void NetlinkPoller::handlerReady(uint16_t /*events*/) noexcept {
-  nl_cache_mngr_data_ready(manager_);
-  return;
+  // Drain everything that is queued, rather than one read per wakeup
+  for (int reads = 0; reads < kMaxReadsPerWakeup; ++reads) {
+    auto err = nl_cache_mngr_data_ready(manager_);
+    if (err > 0) {
+      continue;
+    }
+    // libnl reports ENOBUFS, i.e. the kernel dropped notifications
+    // because our receive buffer was full, as NLE_NOMEM
+    if (err == -NLE_NOMEM) {
+      LOG(WARNING) << "Netlink socket overrun, notifications were lost";
+      tcData().addStatValue("netlink_manager.socket_overruns", 1, stats::SUM);
+      if (onOverrun_) {
+        onOverrun_();
+      }
+    } else if (err < 0) {
+      VLOG(1) << "Error reading netlink notifications: " << nl_geterror(err);
+    }
+    break;
+  }
 }
 } // namespace fboss
 } // namespace facebook
@@ -4,6 +4,8 @@ extern "C" {
 
 #include <folly/io/async/EventHandler.h>
 
+#include <functional>
+
 namespace folly {
 class EventBase;
 }
@@ -18,11 +20,23 @@ namespace fboss {
 
 class NetlinkPoller : public folly::EventHandler {
  public:
-  NetlinkPoller(folly::EventBase* eb, int fd, struct nl_cache_mngr* manager);
+  /*
+   * onOverrun is called when the socket buffer overflowed and notifications
+   * were lost, so whoever owns the caches can resync them.
+   */
+  NetlinkPoller(
+      folly::EventBase* eb,
+      int fd,
+      struct nl_cache_mngr* manager,
+      std::function<void()> onOverrun = nullptr);
   void handlerReady(uint16_t events) noexcept override;
 
  private:
+  // Upper bound on reads per wakeup, so a flood can't starve the event base
+  static constexpr int kMaxReadsPerWakeup = 64;
+
   struct nl_cache_mngr* manager_;
+  std::function<void()> onOverrun_;
 };
 
 } // namespace fboss
@@ -2,6 +2,27 @@
 #include "NetlinkManager.h"
 #include "NetlinkManagerException.h"
 
+#include <gflags/gflags.h>
+#include <sys/socket.h>
+
+DEFINE_int32(
+    netlink_rcvbuf_bytes,
+    8 * 1024 * 1024,
+    "Receive buffer size for the netlink notification socket. Notifications "
+    "are lost, and the route cache has to be resynced, if it overflows");
+
+namespace {
+void setReceiveBuffer(int fd, int bytes) {
+  // SO_RCVBUFFORCE can go past net.core.rmem_max, but needs CAP_NET_ADMIN
+  if (setsockopt(fd, SOL_SOCKET, SO_RCVBUFFORCE, &bytes, sizeof(bytes)) == 0) {
+    return;
+  }
+  if (setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &bytes, sizeof(bytes)) != 0) {
+    PLOG(WARNING) << "Failed to set netlink receive buffer to " << bytes;
+  }
+}
+} // namespace
+
 namespace facebook {
 namespace fboss {
 
@@ -24,6 +45,8 @@ NlResources::NlResources() {
   NetlinkManager::checkError(errCode, "Allocating cache manager failed");
   VLOG(1) << "Allocated cache manager";
 
+  setReceiveBuffer(nl_cache_mngr_get_fd(manager), FLAGS_netlink_rcvbuf_bytes);
+
   nl_cache_mngt_provide(routeCache);
 }
 
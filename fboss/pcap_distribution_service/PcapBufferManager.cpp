@@ -8,17 +8,32 @@ uint16_t PcapBufferManager::UNKNOWN = 0xFFFF;
 
 PcapBufferManager::PcapBufferManager() {
   for(auto e : PcapBufferManager::getEthertypes()){
-    buffers_[e] = PcapCircularBuffer();
+    buffers_.emplace(e, 100);
   }
 }
 
-void PcapBufferManager::addPkt(PcapPkt&& pkt, uint16_t ethertype) {
+PcapCircularBuffer& PcapBufferManager::getBuffer(uint16_t ethertype) {
   auto it = buffers_.find(ethertype);
   if (it == buffers_.end()) {
-    buffers_[UNKNOWN].addPkt(std::move(pkt));
-  } else {
-    it->second.addPkt(std::move(pkt));
+    return buffers_.at(UNKNOWN);
+  }
+  return it->second;
+}
+
+void PcapBufferManager::addPkt(PcapPkt&& pkt, uint16_t ethertype) {
+  getBuffer(ethertype).addPkt(std::move(pkt));
+}
+
+void PcapBufferManager::setBufferSize(uint16_t ethertype, int size) {
+  getBuffer(ethertype).resize(size);
+}
+
+std::map<int16_t, int32_t> PcapBufferManager::getBufferSizes() {
+  std::map<int16_t, int32_t> sizes;
+  for (auto& buffer : buffers_) {
+    sizes[buffer.first] = buffer.second.capacity();
   }
+  return sizes;
 }
 
 /*
@@ -28,25 +43,25 @@ void PcapBufferManager::addPkt(PcapPkt&& pkt, uint16_t ethertype) {
 void PcapBufferManager::dumpPackets(
     std::vector<CapturedPacket>& out,
     uint16_t ethertype) {
-  auto buf = buffers_[ethertype].release();
-  for (int i = 0; i < buf.size(); i++) {
+  auto buf = getBuffer(ethertype).snapshot();
+  for (const auto& pkt : buf) {
     CapturedPacket p;
-    p.rx = buf[i].isRx();
+    p.rx = pkt->isRx();
 
     PacketData data;
     folly::IOBuf packetData;
 
     if (p.rx) {
       RxPacketData r;
-      r.srcPort = buf[i].port();
-      r.srcVlan = buf[i].vlan();
-      buf[i].buf()->cloneInto(packetData);
+      r.srcPort = pkt->port();
+      r.srcVlan = pkt->vlan();
+      pkt->buf()->cloneInto(packetData);
       r.packetData = packetData.moveToFbString();
-      r.reasons = buf[i].getReasons();
+      r.reasons = pkt->getReasons();
       data.set_rxpkt(r);
     } else {
       TxPacketData t;
-      buf[i].buf()->cloneInto(packetData);
+      pkt->buf()->cloneInto(packetData);
       t.packetData = packetData.moveToFbString();
       data.set_txpkt(t);
     }
@@ -21,6 +21,9 @@ class PcapBufferManager {
   PcapBufferManager();
   void addPkt(PcapPkt&& pkt, uint16_t ethertype);
   void dumpPackets(std::vector<CapturedPacket>& out, uint16_t ethertype);
+  // Ethertypes without a buffer of their own share the UNKNOWN one
+  void setBufferSize(uint16_t ethertype, int size);
+  std::map<int16_t, int32_t> getBufferSizes();
   static uint16_t UNKNOWN;
   static const std::vector<uint16_t>& getEthertypes() {
     static const std::vector<uint16_t> ethertypes = {
@@ -33,6 +36,9 @@ class PcapBufferManager {
   }
 
  private:
+  PcapCircularBuffer& getBuffer(uint16_t ethertype);
+
+  // Only ever populated in the constructor, so lookups need no locking
   std::map<uint16_t, PcapCircularBuffer> buffers_;
 };
 }
@@ -1,47 +1,99 @@
 #pragma once
 
-#include <boost/circular_buffer.hpp>
-
 #include "fboss/agent/capture/PcapPkt.h"
 
-#include "folly/Synchronized.h"
-
+#include <algorithm>
+#include <atomic>
 #include <memory>
-#include <mutex>
+#include <vector>
 
 namespace facebook { namespace fboss {
 
+/*
+ * A fixed size ring holding the most recent packets.
+ *
+ * addPkt() claims the next slot with a single atomic increment and publishes
+ * the packet into it, so writers never wait on each other or on readers.
+ * Any number of readers can take a snapshot() at the same time.  Packets are
+ * immutable once published, so a snapshot only holds references to them
+ * rather than copying them out of the ring.
+ */
 class PcapCircularBuffer {
  public:
   explicit PcapCircularBuffer(int n = 100)
-      : buf_(boost::circular_buffer<PcapPkt>(n)) {}
+      : ring_(std::make_shared<Ring>(n)) {}
 
   void addPkt(PcapPkt pkt) {
-    buf_.wlock()->push_back(std::move(pkt));
+    auto ring = std::atomic_load(&ring_);
+    auto seq = ring->head.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_store(
+        &ring->slots[seq % ring->slots.size()],
+        std::make_shared<const Entry>(seq, std::move(pkt)));
   }
 
+  /*
+   * Swap in a ring of a different size, keeping the newest packets that fit.
+   * Packets being added while the ring is swapped may be lost.
+   */
   void resize(int n) {
-    buf_.wlock()->set_capacity(n);
+    auto newRing = std::make_shared<Ring>(n);
+    auto pkts = snapshot();
+    auto first = pkts.size() > newRing->slots.size()
+        ? pkts.size() - newRing->slots.size()
+        : 0;
+    for (auto i = first; i < pkts.size(); ++i) {
+      auto seq = newRing->head++;
+      newRing->slots[seq] = std::make_shared<const Entry>(seq, *pkts[i]);
+    }
+    std::atomic_store(&ring_, newRing);
   }
 
   int size() {
-    return buf_.rlock()->size();
+    auto ring = std::atomic_load(&ring_);
+    return std::min<uint64_t>(
+        ring->head.load(std::memory_order_relaxed), ring->slots.size());
   }
 
   int capacity() {
-    return buf_.rlock()->capacity();
+    return std::atomic_load(&ring_)->slots.size();
   }
 
-  // release the buffer to a user to dump, and swap in
-  // a new buffer
-  boost::circular_buffer<PcapPkt> release() {
-    return buf_.copy();
-  }
+  /*
+   * Return the packets currently in the ring, oldest first.  Slots that get
+   * overwritten while the snapshot is being taken are left out, rather than
+   * returning packets newer than the rest of the snapshot.
+   */
+  std::vector<std::shared_ptr<const PcapPkt>> snapshot() {
+    auto ring = std::atomic_load(&ring_);
+    auto end = ring->head.load(std::memory_order_acquire);
+    auto begin = end > ring->slots.size() ? end - ring->slots.size() : 0;
 
-  // can add new functions, such as get after timestamp
+    std::vector<std::shared_ptr<const PcapPkt>> pkts;
+    pkts.reserve(end - begin);
+    for (auto seq = begin; seq < end; ++seq) {
+      auto entry = std::atomic_load(&ring->slots[seq % ring->slots.size()]);
+      // Empty means the writer that claimed this slot has not published yet
+      if (entry && entry->seq == seq) {
+        pkts.emplace_back(entry, &entry->pkt);
+      }
+    }
+    return pkts;
+  }
 
  private:
-  folly::Synchronized<boost::circular_buffer<PcapPkt>> buf_;
+  struct Entry {
+    Entry(uint64_t s, PcapPkt p) : seq(s), pkt(std::move(p)) {}
+    const uint64_t seq;
+    const PcapPkt pkt;
+  };
+  struct Ring {
+    explicit Ring(int n) : slots(std::max(n, 1)) {}
+    // Sequence number of the next packet to add
+    std::atomic<uint64_t> head{0};
+    std::vector<std::shared_ptr<const Entry>> slots;
+  };
+
+  std::shared_ptr<Ring> ring_;
 };
 
 }}
@@ -2,17 +2,23 @@
 #include "fboss/pcap_distribution_service/ThriftHandler.h"
 #include "fboss/pcap_distribution_service/PcapBufferManager.h"
 
+#include <atomic>
 #include <memory>
+#include <thread>
 
 #include "folly/init/Init.h"
 
+#include <folly/ScopeGuard.h>
 #include <folly/SocketAddress.h>
 #include <folly/io/async/EventBase.h>
+#include <folly/system/ThreadName.h>
+#include <gflags/gflags.h>
 
 #include <thrift/lib/cpp/async/TAsyncSocket.h>
 #include <thrift/lib/cpp2/async/HeaderClientChannel.h>
 #include <thrift/lib/cpp2/server/ThriftServer.h>
 
+#include "fboss/agent/capture/PcapShmRing.h"
 #include "fboss/agent/if/gen-cpp2/FbossCtrl.h"
 #include "fboss/agent/if/gen-cpp2/ctrl_constants.h"
 
@@ -23,6 +29,58 @@ using namespace facebook::fboss;
 using namespace apache::thrift;
 using namespace apache::thrift::async;
 
+DEFINE_string(
+    pcap_shm_ring,
+    "/fboss_pcap_ring",
+    "Shared memory ring the agent publishes packets through; empty to have "
+    "them sent over thrift");
+DEFINE_int32(
+    pcap_shm_ring_kb,
+    4096,
+    "Size of the shared memory packet ring, packets that do not fit are "
+    "dropped by the agent");
+
+namespace {
+
+/*
+ * Hand packets from the agent's ring to the handler the same way as the ones
+ * that come over thrift, until stop is set.
+ */
+void readPackets(
+    PcapShmRing* ring,
+    ThriftHandler* handler,
+    const std::atomic<bool>* stop) {
+  folly::setThreadName("PcapShmRing");
+  auto onPacket = [handler](const PcapShmRing::Record& rec) {
+    auto data = folly::fbstring(
+        reinterpret_cast<const char*>(rec.data.data()), rec.data.size());
+    if (rec.rx) {
+      auto pkt = make_unique<RxPacketData>();
+      pkt->srcPort = rec.srcPort;
+      pkt->srcVlan = rec.srcVlan;
+      pkt->packetData = std::move(data);
+      for (const auto& r : rec.reasons) {
+        RxReason reason;
+        reason.bytes = r.first;
+        reason.description = r.second.str();
+        pkt->reasons.push_back(std::move(reason));
+      }
+      handler->receiveRxPacket(std::move(pkt), rec.ethertype);
+    } else {
+      auto pkt = make_unique<TxPacketData>();
+      pkt->packetData = std::move(data);
+      handler->receiveTxPacket(std::move(pkt), rec.ethertype);
+    }
+  };
+  while (!stop->load()) {
+    if (ring->read(onPacket) == 0) {
+      ring->wait(std::chrono::milliseconds(100));
+    }
+  }
+}
+
+} // namespace
+
 int main(int argc, char** argv) {
   folly::init(&argc, &argv, true);
 
@@ -32,6 +90,30 @@ int main(int argc, char** argv) {
   auto buff = make_unique<PcapBufferManager>();
   auto pushsub = make_shared<ThriftHandler>(move(dist), move(buff));
 
+  // The ring must exist before the agent is asked to start the dump, it
+  // falls back to thrift when there is none
+  unique_ptr<PcapShmRing> ring;
+  if (!FLAGS_pcap_shm_ring.empty()) {
+    try {
+      ring = PcapShmRing::create(
+          FLAGS_pcap_shm_ring, size_t(FLAGS_pcap_shm_ring_kb) * 1024);
+    } catch (const std::exception& ex) {
+      LOG(ERROR) << "Receiving packets over thrift: " << ex.what();
+    }
+  }
+  std::atomic<bool> stopReading{false};
+  std::thread ringReader;
+  if (ring) {
+    ringReader = std::thread(
+        readPackets, ring.get(), pushsub.get(), &stopReading);
+  }
+  SCOPE_EXIT {
+    if (ringReader.joinable()) {
+      stopReading.store(true);
+      ringReader.join();
+    }
+  };
+
   SocketAddress ctrl_address("::1", ctrl_constants::DEFAULT_CTRL_PORT());
   auto socket = TAsyncSocket::newSocket(evb.get(), ctrl_address);
   auto chan = HeaderClientChannel::newChannel(socket);
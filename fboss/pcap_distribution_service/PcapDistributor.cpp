@@ -2,6 +2,7 @@
 
 #include <folly/GLog.h>
 #include <functional>
+#include <iterator>
 #include <map>
 #include <memory>
 #include <tuple>
@@ -10,65 +11,209 @@
 #include <folly/Synchronized.h>
 #include <folly/io/async/EventBase.h>
 
+#include <gflags/gflags.h>
+
 #include <thrift/lib/cpp/async/TAsyncSocket.h>
 #include <thrift/lib/cpp2/async/HeaderClientChannel.h>
 #include <thrift/lib/cpp2/server/ThriftServer.h>
 
 #include "fboss/pcap_distribution_service/if/gen-cpp2/PcapSubscriber.h"
 
+DEFINE_int32(pcap_subscriber_batch_size, 64,
+             "Maximum number of packets sent to a subscriber in one call");
+DEFINE_int32(pcap_subscriber_backlog, 4096,
+             "Packets queued for a subscriber before new ones are dropped");
+DEFINE_int32(pcap_subscriber_max_in_flight, 4,
+             "Batches that may be outstanding to one subscriber at once");
+DEFINE_int32(pcap_subscriber_evict_ms, 10000,
+             "Unsubscribe a subscriber that has not accepted a batch for "
+             "this long while packets are being dropped for it");
+
 using namespace std;
 using namespace folly;
 using namespace apache::thrift::server;
 using namespace apache::thrift::async;
 using namespace apache::thrift;
 
+using std::chrono::milliseconds;
+using std::chrono::steady_clock;
+
+namespace {
+size_t packetBytes(const facebook::fboss::CapturedPacket& pkt) {
+  return pkt.rx ? pkt.pkt.get_rxpkt().packetData.size()
+                : pkt.pkt.get_txpkt().packetData.size();
+}
+} // unnamed namespace
+
 namespace facebook { namespace fboss {
 
 void PcapDistributor::subscribe(unique_ptr<string> hostname, int port) {
   auto creation = [&, hostname = move(hostname), port ]() {
-    auto locked_map = subs_.wlock();
-    auto locked_callbacks = callbacks_.wlock();
     SocketAddress addr(*hostname, port, true);
     auto socket = TAsyncSocket::newSocket(evb_.get(), addr);
     auto chan = HeaderClientChannel::newChannel(socket);
-    auto key = pair<string, int>(*hostname, port);
-    ChannelCloserCB closer(this, key);
-    locked_map->erase(key);
-    locked_callbacks->erase(key);
-    locked_callbacks->emplace(key, move(closer));
-    chan->setCloseCallback(&locked_callbacks->at(key));
-    locked_map->emplace(
-        key, make_unique<PcapSubscriberAsyncClient>(move(chan)));
+    auto key = SubscriberKey(*hostname, port);
+    auto sub = make_shared<Subscriber>(this, key);
+    chan->setCloseCallback(&sub->closer);
+    sub->client = make_unique<PcapSubscriberAsyncClient>(move(chan));
+
+    shared_ptr<Subscriber> old;
+    {
+      auto locked_map = subs_.wlock();
+      auto& entry = (*locked_map)[key];
+      old = move(entry);
+      entry = move(sub);
+    }
+    if (old) {
+      old->active = false;
+    }
     LOG(INFO) << "CREATED SUBSCRIBER: " << *hostname << " " << port;
   };
   evb_->runInEventBaseThread(move(creation));
 }
 
 void PcapDistributor::unsubscribe(const string& hostname, int port) {
-  subs_.wlock()->erase(pair<string, int>(hostname, port));
-  callbacks_.wlock()->erase(pair<string, int>(hostname, port));
+  shared_ptr<Subscriber> sub;
+  {
+    auto locked_map = subs_.wlock();
+    auto it = locked_map->find(SubscriberKey(hostname, port));
+    if (it == locked_map->end()) {
+      return;
+    }
+    sub = move(it->second);
+    locked_map->erase(it);
+  }
+  sub->active = false;
   LOG(INFO) << "UNSUBSCRIBED CLIENT: " << hostname << " " << port;
+  // The client, and the channel closing with it, belong to the EventBase
+  evb_->runInEventBaseThread([sub = move(sub)]() mutable { sub.reset(); });
 }
 
 void PcapDistributor::distributeRxPacket(RxPacketData* packetData) {
+  CapturedPacket pkt;
+  pkt.rx = true;
+  pkt.pkt.set_rxpkt(*packetData);
+  distribute(pkt);
+}
+
+void PcapDistributor::distributeTxPacket(TxPacketData* packetData) {
+  CapturedPacket pkt;
+  pkt.rx = false;
+  pkt.pkt.set_txpkt(*packetData);
+  distribute(pkt);
+}
+
+void PcapDistributor::distribute(const CapturedPacket& pkt) {
   auto locked_map = subs_.rlock();
-  auto onError = [](runtime_error&& e) {
-    FB_LOG_EVERY_MS(ERROR, 1000) << e.what();
-  };
   for (auto& i : *locked_map) {
-    i.second->future_receiveRxPacket(*packetData)
-        .thenError(folly::tag_t<std::runtime_error>{}, move(onError));
+    const auto& sub = i.second;
+    {
+      auto backlog = sub->backlog.wlock();
+      if (backlog->size() >=
+          static_cast<size_t>(FLAGS_pcap_subscriber_backlog)) {
+        sub->packetsDropped.fetch_add(1, std::memory_order_relaxed);
+        continue;
+      }
+      backlog->push_back(pkt);
+    }
+    if (!sub->flushScheduled.exchange(true)) {
+      evb_->runInEventBaseThread([this, sub]() { flush(sub); });
+    }
   }
 }
 
-void PcapDistributor::distributeTxPacket(TxPacketData* packetData) {
+void PcapDistributor::flush(const shared_ptr<Subscriber>& sub) {
+  sub->flushScheduled = false;
+  if (!sub->active) {
+    return;
+  }
+
+  while (sub->inFlight <
+         static_cast<uint32_t>(FLAGS_pcap_subscriber_max_in_flight)) {
+    vector<CapturedPacket> batch;
+    {
+      auto backlog = sub->backlog.wlock();
+      if (backlog->empty()) {
+        return;
+      }
+      auto batchSize = std::max(FLAGS_pcap_subscriber_batch_size, 1);
+      auto end = backlog->begin() +
+          std::min<size_t>(backlog->size(), batchSize);
+      batch.assign(
+          make_move_iterator(backlog->begin()), make_move_iterator(end));
+      backlog->erase(backlog->begin(), end);
+    }
+
+    size_t bytes = 0;
+    for (const auto& pkt : batch) {
+      bytes += packetBytes(pkt);
+    }
+    auto numPkts = batch.size();
+    if (sub->inFlight++ == 0) {
+      // Only time the subscriber while it has something outstanding
+      sub->lastProgress = steady_clock::now();
+    }
+    sub->client->future_receivePackets(batch)
+        .via(evb_.get())
+        .thenTry([this, sub, numPkts, bytes](Try<Unit>&& result) {
+          batchSent(sub, numPkts, bytes, result);
+        });
+  }
+
+  // Every batch is still outstanding.  Give up on a subscriber that has
+  // stopped taking packets altogether.
+  auto full = sub->backlog.rlock()->size() >=
+      static_cast<size_t>(FLAGS_pcap_subscriber_backlog);
+  if (full &&
+      steady_clock::now() - sub->lastProgress >
+          milliseconds(FLAGS_pcap_subscriber_evict_ms)) {
+    LOG(WARNING) << "EVICTING SLOW SUBSCRIBER: " << sub->key.first << " "
+                 << sub->key.second;
+    unsubscribe(sub->key.first, sub->key.second);
+  }
+}
+
+void PcapDistributor::batchSent(
+    const shared_ptr<Subscriber>& sub,
+    size_t numPkts,
+    size_t bytes,
+    const Try<Unit>& result) {
+  --sub->inFlight;
+  if (result.hasException()) {
+    FB_LOG_EVERY_MS(ERROR, 1000) << result.exception().what();
+    sub->packetsDropped.fetch_add(numPkts, std::memory_order_relaxed);
+    if (sub->active &&
+        steady_clock::now() - sub->lastProgress >
+            milliseconds(FLAGS_pcap_subscriber_evict_ms)) {
+      LOG(WARNING) << "EVICTING FAILING SUBSCRIBER: " << sub->key.first << " "
+                   << sub->key.second;
+      unsubscribe(sub->key.first, sub->key.second);
+      return;
+    }
+  } else {
+    sub->packetsSent.fetch_add(numPkts, std::memory_order_relaxed);
+    sub->bytesSent.fetch_add(bytes, std::memory_order_relaxed);
+    sub->batchesSent.fetch_add(1, std::memory_order_relaxed);
+    sub->lastProgress = steady_clock::now();
+  }
+  flush(sub);
+}
+
+vector<SubscriberStats> PcapDistributor::getSubscriberStats() {
+  vector<SubscriberStats> stats;
   auto locked_map = subs_.rlock();
-  auto onError = [](runtime_error&& e) {
-    FB_LOG_EVERY_MS(ERROR, 1000) << e.what();
-  };
-  for (auto& i : *locked_map) {
-    i.second->future_receiveTxPacket(*packetData)
-        .thenError(folly::tag_t<std::runtime_error>{}, move(onError));
+  for (const auto& i : *locked_map) {
+    const auto& sub = i.second;
+    SubscriberStats s;
+    s.hostname = sub->key.first;
+    s.port = sub->key.second;
+    s.packetsSent = sub->packetsSent.load(std::memory_order_relaxed);
+    s.bytesSent = sub->bytesSent.load(std::memory_order_relaxed);
+    s.batchesSent = sub->batchesSent.load(std::memory_order_relaxed);
+    s.packetsDropped = sub->packetsDropped.load(std::memory_order_relaxed);
+    s.backlog = sub->backlog.rlock()->size();
+    stats.push_back(std::move(s));
   }
+  return stats;
 }
 }}
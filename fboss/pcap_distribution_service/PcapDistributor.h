@@ -1,7 +1,11 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <deque>
 #include <memory>
 #include <map>
+#include <vector>
 
 #include <thrift/lib/cpp2/async/RequestChannel.h>
 
@@ -10,6 +14,7 @@
 #include "fboss/pcap_distribution_service/if/gen-cpp2/pcap_pubsub_constants.h"
 
 #include "folly/Synchronized.h"
+#include "folly/Try.h"
 
 namespace facebook { namespace fboss {
 
@@ -21,6 +26,11 @@ class PcapDistributor {
    * This class handles subscriptions from clients, and distributes
    * packets received from the switch to all clients.
    *
+   * Each subscriber has its own bounded backlog.  Packets are sent to it in
+   * batches, with a few batches in flight at once, so a burst costs one RPC
+   * per batch rather than one per packet.  A subscriber that keeps its
+   * backlog full without making progress is unsubscribed.
+   *
    */
  public:
   explicit PcapDistributor(std::shared_ptr<folly::EventBase> b) : evb_(b) {}
@@ -28,6 +38,7 @@ class PcapDistributor {
   void unsubscribe(const std::string& hostname, int port);
   void distributeRxPacket(RxPacketData* packetData);
   void distributeTxPacket(TxPacketData* packetData);
+  std::vector<SubscriberStats> getSubscriberStats();
 
  private:
   /*
@@ -50,13 +61,43 @@ class PcapDistributor {
     const std::pair<std::string, int> key_;
   };
 
-  // Map of hostname and port to client object
-  folly::Synchronized<std::map<
-      std::pair<std::string, int>,
-      std::unique_ptr<PcapSubscriberAsyncClient>>>
+  using SubscriberKey = std::pair<std::string, int>;
+
+  struct Subscriber {
+    Subscriber(PcapDistributor* p, SubscriberKey k)
+        : key(k), closer(p, std::move(k)) {}
+
+    const SubscriberKey key;
+    // Declared before the client, so it outlives the channel it is set on
+    ChannelCloserCB closer;
+    // Only used from the EventBase thread
+    std::unique_ptr<PcapSubscriberAsyncClient> client;
+    uint32_t inFlight{0};
+    std::chrono::steady_clock::time_point lastProgress{
+        std::chrono::steady_clock::now()};
+
+    folly::Synchronized<std::deque<CapturedPacket>> backlog;
+    std::atomic<bool> flushScheduled{false};
+    // Cleared once unsubscribed, so queued flushes stop sending
+    std::atomic<bool> active{true};
+
+    std::atomic<uint64_t> packetsSent{0};
+    std::atomic<uint64_t> bytesSent{0};
+    std::atomic<uint64_t> batchesSent{0};
+    std::atomic<uint64_t> packetsDropped{0};
+  };
+
+  void distribute(const CapturedPacket& pkt);
+  void flush(const std::shared_ptr<Subscriber>& sub);
+  void batchSent(
+      const std::shared_ptr<Subscriber>& sub,
+      size_t numPkts,
+      size_t bytes,
+      const folly::Try<folly::Unit>& result);
+
+  // Map of hostname and port to subscriber
+  folly::Synchronized<std::map<SubscriberKey, std::shared_ptr<Subscriber>>>
       subs_;
-  folly::Synchronized<std::map<std::pair<std::string, int>, ChannelCloserCB>>
-      callbacks_;
   std::shared_ptr<folly::EventBase> evb_;
 };
 }}
@@ -51,4 +51,16 @@ void ThriftHandler::dumpPacketsByType(
     buffMgr_->dumpPackets(out, type);
   }
 }
+
+void ThriftHandler::setBufferSize(int16_t ethertype, int32_t size) {
+  buffMgr_->setBufferSize(ethertype, size);
+}
+
+void ThriftHandler::getBufferSizes(map<int16_t, int32_t>& out) {
+  out = buffMgr_->getBufferSizes();
+}
+
+void ThriftHandler::getSubscriberStats(vector<SubscriberStats>& out) {
+  out = dist_->getSubscriberStats();
+}
 }}
@@ -45,6 +45,17 @@ class ThriftHandler : virtual public PcapPushSubscriberSvIf {
       std::vector<CapturedPacket>& out,
       std::unique_ptr<std::vector<int16_t>> ethertypes) override;
 
+  /*
+   * Methods to size the per ethertype packet buffers
+   */
+  void setBufferSize(int16_t ethertype, int32_t size) override;
+  void getBufferSizes(std::map<int16_t, int32_t>& out) override;
+
+  /*
+   * Delivery counters for each subscriber
+   */
+  void getSubscriberStats(std::vector<SubscriberStats>& out) override;
+
  private:
   std::unique_ptr<PcapDistributor> dist_;
   std::unique_ptr<PcapBufferManager> buffMgr_;
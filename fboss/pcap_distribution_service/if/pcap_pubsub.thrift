@@ -42,6 +42,19 @@ struct CapturedPacket {
   2: required PacketData pkt
 }
 
+// Delivery counters for one subscriber
+struct SubscriberStats {
+  1: string hostname,
+  2: i32 port,
+  3: i64 packetsSent,
+  4: i64 bytesSent,
+  5: i64 batchesSent,
+  // Dropped because the backlog was full, or the batch failed to send
+  6: i64 packetsDropped,
+  // Packets waiting to be sent
+  7: i32 backlog
+}
+
 // This interface is for a user to connect to the service,
 // and open subscriptions and request packet dumps
 service PcapPushSubscriber {
@@ -63,6 +76,13 @@ service PcapPushSubscriber {
   // Request by type of packet, or get all ethertypes
   list<CapturedPacket> dumpAllPackets()
   list<CapturedPacket> dumpPacketsByType(1: list<i16> ethertypes)
+
+  // Change how many packets are kept for an ethertype.  Types
+  // without their own buffer share the one for unknown ethertypes.
+  void setBufferSize(1: i16 ethertype, 2: i32 size)
+  map<i16, i32> getBufferSizes()
+
+  list<SubscriberStats> getSubscriberStats()
 }
 
 // This interface is for a subscriber to receive a packet stream
@@ -72,4 +92,8 @@ service PcapSubscriber {
   // distributor upon receiving a packet from the switch.
   void receiveRxPacket(1: RxPacketData packet)
   void receiveTxPacket(1: TxPacketData packet)
+
+  // The distributor batches packets per subscriber, and sends them
+  // with this rather than one call per packet.
+  void receivePackets(1: list<CapturedPacket> packets)
 }
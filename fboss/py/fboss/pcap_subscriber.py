@@ -25,6 +25,15 @@ class PcapSubscriber(ThriftSub.Iface):
     def unsubscribe(self):
         self._client.unsubscribe(self.hostname, self.port)
 
+    # The distributor sends packets in batches. Hand each one to the
+    # per-packet handlers, so subclasses only need to override those.
+    def receivePackets(self, packets):
+        for packet in packets:
+            if packet.rx:
+                self.receiveRxPacket(packet.pkt.get_rxpkt())
+            else:
+                self.receiveTxPacket(packet.pkt.get_txpkt())
+
     # inherit this class and override the on receive functions
     # additionally, these functions need to be thread-safe
 
@@ -19,6 +19,12 @@ DEFINE_int32(
     5,
     "Interval (in seconds) to run the main loop that determines "
     "if we need to change or fetch data for transceivers");
+DEFINE_int32(
+    transceiver_event_interval_ms,
+    100,
+    "Interval (in milliseconds) to check for transceiver insertions, "
+    "removals and interrupts, on platforms that can read them for "
+    "all transceivers at once. The main loop remains as a safety net.");
 
 int doServerLoop(std::shared_ptr<apache::thrift::ThriftServer>
         thriftServer, std::shared_ptr<QsfpServiceHandler>);
@@ -58,6 +64,16 @@ int main(int argc, char **argv) {
   // Note: This doesn't block, this merely starts it's own thread
   scheduler.start();
 
+  // Kept separate so events aren't held up behind a full refresh pass
+  folly::FunctionScheduler eventScheduler;
+  eventScheduler.addFunction(
+      [mgr = handler->getTransceiverManager()]() {
+        mgr->processTransceiverEvents();
+      },
+      std::chrono::milliseconds(FLAGS_transceiver_event_interval_ms),
+      "processTransceiverEvents");
+  eventScheduler.start();
+
 
   doServerLoop(server, handler);
 
@@ -51,4 +51,11 @@ void QsfpServiceHandler::syncPorts(
   manager_->syncPorts(info, std::move(ports));
 }
 
+void QsfpServiceHandler::getTransceiverInfoDelta(
+    TransceiverInfoDelta& delta,
+    int64_t sinceVersion) {
+  LogThriftCall log(__func__, getConnectionContext());
+  manager_->getTransceiverInfoDelta(delta, sinceVersion);
+}
+
 }} // facebook::fboss
@@ -39,6 +39,12 @@ class QsfpServiceHandler : public facebook::fboss::QsfpServiceSvIf,
     std::map<int32_t, TransceiverInfo>& info,
     std::unique_ptr<std::map<int32_t, PortStatus>> ports) override;
 
+  /*
+   * Only the transceivers that changed since sinceVersion.
+   */
+  void getTransceiverInfoDelta(
+    TransceiverInfoDelta& delta, int64_t sinceVersion) override;
+
   /*
    * Customise the transceiver based on the speed at which it has
    * been configured to operate at
@@ -11,6 +11,7 @@
 #pragma once
 
 #include <folly/io/async/EventBase.h>
+#include <chrono>
 #include "fboss/qsfp_service/TransceiverManager.h"
 
 namespace facebook { namespace fboss {
@@ -25,6 +26,8 @@ class StatsPublisher {
   static void bumpWriteFailure();
   static void bumpModuleErrors();
   static void missingPorts(TransceiverID module);
+  // Time taken to refresh every transceiver on one I2C bus
+  static void busRefreshed(int bus, std::chrono::milliseconds duration);
 
  private:
   TransceiverManager* transceiverManager_{nullptr};
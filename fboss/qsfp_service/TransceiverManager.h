@@ -20,12 +20,19 @@ class TransceiverManager {
   virtual void syncPorts(
     std::map<int32_t, TransceiverInfo>& info,
     std::unique_ptr<std::map<int32_t, PortStatus>> ports) = 0;
+  virtual void getTransceiverInfoDelta(
+    TransceiverInfoDelta& delta, int64_t sinceVersion) = 0;
 
   bool isValidTransceiver(int32_t id) {
     return id < transceivers_.size() && id >= 0;
   }
   virtual int getNumQsfpModules() = 0;
   virtual void refreshTransceivers() = 0;
+  /*
+   * Refresh just the transceivers whose presence changed or that raised an
+   * interrupt, on platforms that can tell without polling every one.
+   */
+  virtual void processTransceiverEvents() {}
   virtual int numPortsPerTransceiver() = 0;
  private:
   // Forbidden copy constructor and assignment operator
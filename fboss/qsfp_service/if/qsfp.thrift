@@ -37,4 +37,12 @@ service QsfpService extends fb303.FacebookService {
   map<i32, transceiver.TransceiverInfo> syncPorts(1: map<i32, ctrl.PortStatus> ports)
     throws (1: fboss.FbossBaseError error)
 
+  /*
+   * The transceivers that changed since sinceVersion, the version returned
+   * by an earlier call, or all of them for a version of 0.
+   */
+  transceiver.TransceiverInfoDelta getTransceiverInfoDelta(
+      1: i64 sinceVersion)
+    throws (1: fboss.FbossBaseError error)
+
 }
@@ -161,6 +161,20 @@ struct TransceiverInfo {
   14: optional TransceiverStats stats,
 }
 
+/*
+ * The transceivers whose presence, type, vendor, cable, settings, thresholds
+ * or alarm flags changed since an earlier version.  New sensor readings or
+ * stats alone don't make a transceiver count as changed.
+ */
+struct TransceiverInfoDelta {
+  // Pass this back to get the changes after this one
+  1: i64 version,
+  // The version asked about isn't one this qsfp_service handed out, e.g.
+  // because it restarted, so changed holds every transceiver instead
+  2: bool full,
+  3: map<i32, TransceiverInfo> changed,
+}
+
 typedef binary (cpp2.type = "folly::IOBuf") IOBuf
 
 struct RawDOMData {
@@ -9,6 +9,7 @@
  */
 #include "fboss/qsfp_service/lib/QsfpCache.h"
 
+#include "fboss/agent/BootTrace.h"
 #include "fboss/qsfp_service/lib/QsfpClient.h"
 
 #include <folly/logging/xlog.h>
@@ -124,6 +125,7 @@ folly::Future<folly::Unit> QsfpCache::confirmAlive() {
       XLOG(DBG1) << "qsfp_service restarted. aliveSince: " << remoteAliveSince_
                  << " -> " << aliveSince;
       std::tie(remoteAliveSince_,  remoteGen_) = std::make_tuple(aliveSince, 0);
+      remoteVersion_ = 0;
     }
   };
 
@@ -131,6 +133,38 @@ folly::Future<folly::Unit> QsfpCache::confirmAlive() {
      getAliveSince).thenValue(storeIt);
 }
 
+folly::Future<folly::Unit> QsfpCache::pollChanges() {
+  CHECK(evb_->isInEventBaseThread());
+
+  auto getDelta = [since = remoteVersion_](
+                      std::unique_ptr<QsfpServiceAsyncClient> client) {
+    auto options = QsfpClient::getRpcOptions();
+    return client->future_getTransceiverInfoDelta(options, since);
+  };
+  auto applyDelta = [this](TransceiverInfoDelta&& delta) {
+    XLOG(DBG3) << "Got " << delta.changed.size()
+               << " changed transceivers from qsfp_service, version "
+               << delta.version << (delta.full ? " (full)" : "");
+    tcvrs_.withWLock([&delta](auto& lockedTcvrs) {
+      if (delta.full) {
+        // Anything not in a full delta is no longer known to qsfp_service
+        lockedTcvrs.clear();
+      }
+      for (auto& item : delta.changed) {
+        lockedTcvrs[TransceiverID(item.first)] = std::move(item.second);
+      }
+    });
+    remoteVersion_ = delta.version;
+  };
+
+  return QsfpClient::createClient(evb_)
+      .thenValue(getDelta)
+      .thenValue(applyDelta)
+      .thenError(folly::tag_t<std::exception>{}, [](const std::exception& e) {
+        XLOG(ERR) << "Exception fetching transceiver changes: " << e.what();
+      });
+}
+
 folly::Future<folly::Unit> QsfpCache::doSync(PortMapThrift&& toSync) {
   CHECK(evb_->isInEventBaseThread());
 
@@ -156,6 +190,8 @@ folly::Future<folly::Unit> QsfpCache::doSync(PortMapThrift&& toSync) {
   // lock out other request attempts
   XLOG(DBG4) << "Starting new request";
   activeReq_ = folly::SharedPromise<folly::Unit>();
+  // qsfp_service customizes the transceivers while it syncs the ports
+  auto span = std::make_shared<boot_trace::Span>("QsfpCache::syncPorts");
 
   auto baseFut = (remoteAliveSince_ < 0) ? confirmAlive() : folly::makeFuture();
   return std::move(baseFut)
@@ -169,7 +205,8 @@ folly::Future<folly::Unit> QsfpCache::doSync(PortMapThrift&& toSync) {
             XLOG(ERR) << "Exception talking to qsfp_service: " << e.what();
             this->maybeSync();
           })
-      .ensure([this]() {
+      .ensure([this, span]() mutable {
+        span.reset();
         // make sure we allow other requests in again
         activeReq_->setValue();
         XLOG(DBG4) << "Finished request";
@@ -224,7 +261,9 @@ folly::Future<TransceiverInfo> QsfpCache::futureGet(TransceiverID tcvrId) {
 }
 
 void QsfpCache::timeoutExpired() noexcept {
-  confirmAlive().then(&QsfpCache::maybeSync, this);
+  confirmAlive()
+      .then(&QsfpCache::maybeSync, this)
+      .then(&QsfpCache::pollChanges, this);
   scheduleTimeout(kLivenessCheckInterval);
 }
 
@@ -58,6 +58,14 @@
  * and store the last aliveSince. If this changes, we reset remoteGen_
  * back to zero so we will re-sync all ports.
  *
+ * Picking up transceiver changes
+ * ------------------------------
+ * syncPorts only returns the transceivers of the ports being synced, so
+ * on every liveness check we also ask for the transceivers that changed
+ * since the last version qsfp_service handed us (getTransceiverInfoDelta).
+ * Only those are sent and updated in the cache. After a restart we start
+ * again from version 0, which returns every transceiver.
+ *
  * Threading model
  * ---------------
  * All thrift calls to qsfp_service are done on evb_. No guarantee for
@@ -130,6 +138,9 @@ class QsfpCache : private folly::AsyncTimeout {
   // checks qsfp_service is alive and detects restarts
   folly::Future<folly::Unit> confirmAlive();
 
+  // fetches the transceivers that changed since remoteVersion_
+  folly::Future<folly::Unit> pollChanges();
+
   /* Called after successful sync to update transceivers in to our
    * cache.
    */
@@ -158,6 +169,9 @@ class QsfpCache : private folly::AsyncTimeout {
   // last aliveSince from qsfp_service
   int64_t remoteAliveSince_{-1};
 
+  // transceiver version we are up to date with, 0 for none
+  int64_t remoteVersion_{0};
+
   std::atomic_bool initialized_{false};
 };
 
@@ -28,4 +28,8 @@ void StatsPublisher::missingPorts(TransceiverID /* unused */) {
 }
 // static
 void StatsPublisher::bumpModuleErrors() {}
+// static
+void StatsPublisher::busRefreshed(
+    int /* unused */,
+    std::chrono::milliseconds /* unused */) {}
 }}
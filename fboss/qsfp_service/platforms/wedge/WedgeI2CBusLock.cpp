@@ -12,6 +12,8 @@
 
 #include "fboss/qsfp_service/StatsPublisher.h"
 
+#include <folly/ScopeGuard.h>
+
 using folly::MutableByteRange;
 using std::lock_guard;
 
@@ -27,7 +29,7 @@ void WedgeI2CBusLock::openLocked() {
 }
 
 void WedgeI2CBusLock::open() {
-  lock_guard<std::mutex> g(busMutex_);
+  lock_guard<std::recursive_mutex> g(busMutex_);
   openLocked();
 }
 
@@ -37,7 +39,7 @@ void WedgeI2CBusLock::closeLocked() {
 }
 
 void WedgeI2CBusLock::close() {
-  lock_guard<std::mutex> g(busMutex_);
+  lock_guard<std::recursive_mutex> g(busMutex_);
   closeLocked();
 }
 
@@ -46,6 +48,11 @@ void WedgeI2CBusLock::verifyBus(bool autoReset) {
   wedgeI2CBus_->verifyBus(autoReset);
 }
 
+bool WedgeI2CBusLock::getModuleStatus(std::vector<ModuleStatus>* status) {
+  BusGuard g(this);
+  return wedgeI2CBus_->getModuleStatus(status);
+}
+
 void WedgeI2CBusLock::moduleRead(unsigned int module, uint8_t address,
                              int offset, int len, uint8_t *buf) {
   BusGuard g(this);
@@ -58,6 +65,43 @@ void WedgeI2CBusLock::moduleWrite(unsigned int module, uint8_t address,
   wedgeI2CBus_->moduleWrite(module, address, offset, len, buf);
 }
 
+void WedgeI2CBusLock::moduleTransfer(unsigned int module,
+                                     const std::vector<ModuleOp>& ops) {
+  BusGuard g(this);
+  wedgeI2CBus_->moduleTransfer(module, ops);
+}
+
+void WedgeI2CBusLock::beginModuleAccess(unsigned int module) {
+  // Held until endModuleAccess(), so the bus stays open and nobody else
+  // changes the mux selection in between
+  busMutex_.lock();
+  try {
+    if (!opened_) {
+      openLocked();
+      accessOpened_ = true;
+    }
+    wedgeI2CBus_->beginModuleAccess(module);
+  } catch (...) {
+    if (accessOpened_) {
+      accessOpened_ = false;
+      closeLocked();
+    }
+    busMutex_.unlock();
+    throw;
+  }
+}
+
+void WedgeI2CBusLock::endModuleAccess(unsigned int module) {
+  SCOPE_EXIT {
+    if (accessOpened_) {
+      accessOpened_ = false;
+      closeLocked();
+    }
+    busMutex_.unlock();
+  };
+  wedgeI2CBus_->endModuleAccess(module);
+}
+
 void WedgeI2CBusLock::read(uint8_t address, int offset,
                            int len, uint8_t *buf) {
   BusGuard g(this);
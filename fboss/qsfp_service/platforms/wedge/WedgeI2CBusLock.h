@@ -29,10 +29,15 @@ class WedgeI2CBusLock : public TransceiverI2CApi {
                   int offset, int len, uint8_t* buf);
   void moduleWrite(unsigned int module, uint8_t i2cAddress,
                   int offset, int len, const uint8_t* buf);
+  void moduleTransfer(unsigned int module,
+                      const std::vector<ModuleOp>& ops) override;
+  void beginModuleAccess(unsigned int module) override;
+  void endModuleAccess(unsigned int module) override;
   void read(uint8_t i2cAddress, int offset, int len, uint8_t* buf);
   void write(uint8_t i2cAddress, int offset, int len, const uint8_t* buf);
 
   void verifyBus(bool autoReset);
+  bool getModuleStatus(std::vector<ModuleStatus>* status) override;
   bool isPresent(unsigned int module) override;
   void ensureOutOfReset(unsigned int module) override;
 
@@ -47,8 +52,11 @@ class WedgeI2CBusLock : public TransceiverI2CApi {
   void closeLocked();
 
   std::unique_ptr<BaseWedgeI2CBus> wedgeI2CBus_{nullptr};
-  mutable std::mutex busMutex_;
+  // Recursive so accesses can be made inside beginModuleAccess()
+  mutable std::recursive_mutex busMutex_;
   bool opened_{false};
+  // Whether beginModuleAccess() opened the bus, and so should close it
+  bool accessOpened_{false};
 
   class BusGuard {
     /* This class is a simple guard that:
@@ -79,7 +87,7 @@ class WedgeI2CBusLock : public TransceiverI2CApi {
    private:
     WedgeI2CBusLock* busLock_{nullptr};
     bool performedOpen_{false};
-    std::lock_guard<std::mutex> lock_;
+    std::lock_guard<std::recursive_mutex> lock_;
   };
 };
 
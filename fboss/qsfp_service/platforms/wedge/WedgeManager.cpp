@@ -1,30 +1,82 @@
 #include "fboss/qsfp_service/platforms/wedge/WedgeManager.h"
 
+#include <chrono>
+
+#include <folly/Conv.h>
+#include <folly/ScopeGuard.h>
 #include <folly/gen/Base.h>
 
 #include <folly/logging/xlog.h>
+#include "fboss/agent/FbossError.h"
+#include "fboss/qsfp_service/StatsPublisher.h"
 #include "fboss/qsfp_service/platforms/wedge/WedgeQsfp.h"
 #include "fboss/qsfp_service/sff/QsfpModule.h"
 
 namespace facebook { namespace fboss {
 
-WedgeManager::WedgeManager() {}
+namespace {
+
+// Whether the change from oldInfo to newInfo is one that deltas report
+bool deltaChanged(
+    const std::shared_ptr<const TransceiverInfo>& oldInfo,
+    const std::shared_ptr<const TransceiverInfo>& newInfo) {
+  if (!oldInfo || !newInfo) {
+    return oldInfo != newInfo;
+  }
+  // Leave out what changes on every refresh
+  auto withoutReadings = [](TransceiverInfo info) {
+    if (info.__isset.sensor) {
+      auto& sensor = info.sensor_ref().value_unchecked();
+      sensor.temp.value = 0;
+      sensor.vcc.value = 0;
+    }
+    for (auto& channel : info.channels) {
+      channel.sensors.rxPwr.value = 0;
+      channel.sensors.txBias.value = 0;
+      channel.sensors.txPwr.value = 0;
+    }
+    info.stats_ref().value_unchecked() = TransceiverStats();
+    info.__isset.stats = false;
+    return info;
+  };
+  return !(withoutReadings(*oldInfo) == withoutReadings(*newInfo));
+}
+
+} // namespace
+
+WedgeManager::WedgeManager()
+    : firstVersion_(std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::system_clock::now().time_since_epoch())
+                        .count()) {}
 
 void WedgeManager::initTransceiverMap() {
   // If we can't get access to the USB devices, don't bother to
   // create the QSFP objects;  this is likely to be a permanent
   // error.
-  try {
-    wedgeI2cBus_ = getI2CBus();
-  } catch (const I2cError& ex) {
-    XLOG(ERR) << "failed to initialize I2C interface: " << ex.what();
-    return;
+  auto numBuses = getNumI2CBuses();
+  std::vector<I2CBus> buses(numBuses);
+  for (int bus = 0; bus < numBuses; ++bus) {
+    try {
+      buses[bus].api = createI2CBus(bus);
+    } catch (const I2cError& ex) {
+      XLOG(ERR) << "failed to initialize I2C interface " << bus << ": "
+                << ex.what();
+      return;
+    }
+    if (numBuses > 1) {
+      buses[bus].refreshThread =
+          std::make_unique<folly::ScopedEventBaseThread>(
+              folly::to<std::string>("QsfpI2CBus", bus));
+    }
   }
+  i2cBuses_ = std::move(buses);
 
   // Wedge port 0 is the CPU port, so the first port associated with
   // a QSFP+ is port 1.  We start the transceiver IDs with 0, though.
   for (int idx = 0; idx < getNumQsfpModules(); idx++) {
-    auto qsfpImpl = std::make_unique<WedgeQsfp>(idx, wedgeI2cBus_.get());
+    auto& bus = i2cBuses_.at(getI2CBusForQsfp(idx));
+    bus.qsfps.push_back(idx);
+    auto qsfpImpl = std::make_unique<WedgeQsfp>(idx, bus.api.get());
     auto qsfp = std::make_unique<QsfpModule>(
         std::move(qsfpImpl), numPortsPerTransceiver());
     transceivers_.push_back(move(qsfp));
@@ -43,20 +95,92 @@ void WedgeManager::getTransceiversInfo(std::map<int32_t, TransceiverInfo>& info,
       folly::gen::appendTo(*ids);
   }
 
+  auto snapshot = getInfoSnapshot();
   for (const auto& i : *ids) {
-    TransceiverInfo trans;
-    if (isValidTransceiver(i)) {
-      try {
-        trans = transceivers_[TransceiverID(i)]->getTransceiverInfo();
-      } catch (const std::exception& ex) {
-        XLOG(ERR) << "Transceiver " << i
-                  << ": Error calling getTransceiverInfo(): " << ex.what();
+    if (snapshot && i >= 0 &&
+        i < static_cast<int32_t>(snapshot->infos.size()) &&
+        snapshot->infos[i]) {
+      info[i] = *snapshot->infos[i];
+    } else {
+      info[i] = TransceiverInfo();
+    }
+  }
+}
+
+void WedgeManager::publishTransceiverInfo(const std::vector<int32_t>& ids) {
+  std::lock_guard<std::mutex> g(publishMutex_);
+  auto old = getInfoSnapshot();
+  auto snapshot = old ? std::make_shared<InfoSnapshot>(*old)
+                      : std::make_shared<InfoSnapshot>();
+  snapshot->infos.resize(transceivers_.size());
+  snapshot->changedIn.resize(transceivers_.size(), firstVersion_);
+  auto version = old ? old->version + 1 : firstVersion_;
+  bool changed = false;
+
+  auto update = [&](int32_t id) {
+    if (!isValidTransceiver(id)) {
+      return;
+    }
+    auto& info = snapshot->infos[id];
+    auto previous = info;
+    try {
+      info = std::make_shared<const TransceiverInfo>(
+          transceivers_[id]->getTransceiverInfo());
+    } catch (const std::exception& ex) {
+      XLOG(DBG2) << "Transceiver " << id
+                 << ": Error calling getTransceiverInfo(): " << ex.what();
+      info.reset();
+    }
+    if (deltaChanged(previous, info)) {
+      snapshot->changedIn[id] = version;
+      changed = true;
+    }
+  };
+  if (ids.empty()) {
+    for (int32_t id = 0; id < static_cast<int32_t>(transceivers_.size());
+         ++id) {
+      update(id);
+    }
+  } else {
+    for (auto id : ids) {
+      update(id);
+    }
+  }
+
+  if (changed || !old) {
+    snapshot->version = version;
+  }
+  *infoSnapshot_.wlock() = std::move(snapshot);
+}
+
+void WedgeManager::getTransceiverInfoDelta(
+    TransceiverInfoDelta& delta,
+    int64_t sinceVersion) {
+  auto snapshot = getInfoSnapshot();
+  if (!snapshot) {
+    throw FbossError("Transceivers not yet refreshed");
+  }
+  delta.version = snapshot->version;
+  delta.full = sinceVersion < firstVersion_ || sinceVersion > delta.version;
+  for (size_t id = 0; id < snapshot->infos.size(); ++id) {
+    const auto& info = snapshot->infos[id];
+    if (delta.full) {
+      if (info) {
+        delta.changed[id] = *info;
       }
+    } else if (snapshot->changedIn[id] > sinceVersion) {
+      // Transceivers without info, e.g. removed ones, are sent as not
+      // present, as from getTransceiversInfo()
+      delta.changed[id] = info ? *info : TransceiverInfo();
     }
-    info[i] = trans;
   }
 }
 
+std::shared_ptr<const WedgeManager::InfoSnapshot>
+WedgeManager::getInfoSnapshot() const {
+  return *infoSnapshot_.rlock();
+}
+
 void WedgeManager::getTransceiversRawDOMData(
     std::map<int32_t, RawDOMData>& info,
     std::unique_ptr<std::vector<int32_t>> ids) {
@@ -82,6 +206,7 @@ void WedgeManager::getTransceiversRawDOMData(
 
 void WedgeManager::customizeTransceiver(int32_t idx, cfg::PortSpeed speed) {
   transceivers_.at(idx)->customizeTransceiver(speed);
+  publishTransceiverInfo({idx});
 }
 
 void WedgeManager::syncPorts(
@@ -97,39 +222,162 @@ void WedgeManager::syncPorts(
       }) |
       folly::gen::as<std::vector>();
 
-  for (auto& group : groups) {
-    int32_t transceiverIdx = group.key();
-    XLOG(INFO) << "Syncing ports of transceiver " << transceiverIdx;
+  std::vector<int32_t> synced;
+  SCOPE_EXIT {
+    if (!synced.empty()) {
+      publishTransceiverInfo(synced);
+    }
+  };
+  // Syncing can customize the transceivers, which takes a few writes each,
+  // so the transceivers of each bus are synced on that bus's thread
+  std::vector<std::vector<size_t>> groupsByBus(i2cBuses_.size());
+  for (size_t i = 0; i < groups.size(); ++i) {
+    int32_t transceiverIdx = groups[i].key();
+    synced.push_back(transceiverIdx);
+    if (isValidTransceiver(transceiverIdx) && !i2cBuses_.empty()) {
+      groupsByBus[getI2CBusForQsfp(transceiverIdx)].push_back(i);
+    } else {
+      XLOG(ERR) << "Transceiver " << transceiverIdx
+                << ": Error calling syncPorts(): no such transceiver";
+    }
+  }
+
+  std::vector<TransceiverMap> infoByBus(groupsByBus.size());
+  auto syncBus = [&](int bus) {
+    for (auto i : groupsByBus[bus]) {
+      int32_t transceiverIdx = groups[i].key();
+      XLOG(INFO) << "Syncing ports of transceiver " << transceiverIdx;
+      try {
+        auto transceiver = transceivers_[transceiverIdx].get();
+        transceiver->transceiverPortsChanged(groups[i].values());
+        infoByBus[bus][transceiverIdx] = transceiver->getTransceiverInfo();
+      } catch (const std::exception& ex) {
+        XLOG(ERR) << "Transceiver " << transceiverIdx
+                  << ": Error calling syncPorts(): " << ex.what();
+      }
+    }
+  };
+  if (i2cBuses_.size() == 1) {
+    syncBus(0);
+  } else {
+    std::vector<folly::Future<folly::Unit>> futs;
+    for (int bus = 0; bus < static_cast<int>(i2cBuses_.size()); ++bus) {
+      if (groupsByBus[bus].empty()) {
+        continue;
+      }
+      futs.push_back(folly::via(
+          i2cBuses_[bus].refreshThread->getEventBase(),
+          [&syncBus, bus] { syncBus(bus); }));
+    }
+    folly::collectAll(futs.begin(), futs.end()).wait();
+  }
+  for (auto& busInfo : infoByBus) {
+    for (auto& entry : busInfo) {
+      info[entry.first] = std::move(entry.second);
+    }
+  }
+}
+
+void WedgeManager::refreshTransceivers() {
+  XLOG(DBG2) << "Start refreshing all transceivers...";
+  if (i2cBuses_.size() == 1) {
+    refreshBus(0);
+  } else {
+    // Each bus is independent, so refresh them all at once
+    std::vector<folly::Future<folly::Unit>> futs;
+    for (int bus = 0; bus < static_cast<int>(i2cBuses_.size()); ++bus) {
+      futs.push_back(folly::via(
+          i2cBuses_[bus].refreshThread->getEventBase(),
+          [this, bus] { refreshBus(bus); }));
+    }
+    folly::collectAll(futs.begin(), futs.end()).wait();
+  }
+  publishTransceiverInfo();
+  XLOG(DBG2) << "Finished refreshing all transceivers";
+}
 
+void WedgeManager::processTransceiverEvents() {
+  std::vector<int32_t> refreshed;
+  SCOPE_EXIT {
+    if (!refreshed.empty()) {
+      publishTransceiverInfo(refreshed);
+    }
+  };
+  for (int bus = 0; bus < static_cast<int>(i2cBuses_.size()); ++bus) {
+    auto& i2cBus = i2cBuses_[bus];
+    if (!i2cBus.hasModuleStatus) {
+      continue;
+    }
+
+    std::vector<TransceiverI2CApi::ModuleStatus> status;
     try {
-      auto transceiver = transceivers_.at(transceiverIdx).get();
-      transceiver->transceiverPortsChanged(group.values());
-      info[transceiverIdx] = transceiver->getTransceiverInfo();
+      i2cBus.hasModuleStatus = i2cBus.api->getModuleStatus(&status);
     } catch (const std::exception& ex) {
-      XLOG(ERR) << "Transceiver " << transceiverIdx
-                << ": Error calling syncPorts(): " << ex.what();
+      XLOG(ERR) << "Error reading module status on I2C bus " << bus << ": "
+                << ex.what();
+      continue;
+    }
+    if (!i2cBus.hasModuleStatus) {
+      XLOG(INFO) << "I2C bus " << bus << " has no module status registers, "
+                 << "relying on polling";
+      continue;
+    }
+
+    for (auto idx : i2cBus.qsfps) {
+      if (idx >= static_cast<int>(status.size())) {
+        continue;
+      }
+      const auto& moduleStatus = status[idx];
+      auto last = i2cBus.present.find(idx);
+      auto presenceChanged =
+          last != i2cBus.present.end() && last->second != moduleStatus.present;
+      i2cBus.present[idx] = moduleStatus.present;
+      if (!presenceChanged && !moduleStatus.interrupt) {
+        continue;
+      }
+
+      XLOG(DBG2) << "Transceiver " << idx << " "
+                 << (presenceChanged ? "presence changed" : "interrupt")
+                 << ", refreshing";
+      refreshed.push_back(idx);
+      try {
+        if (presenceChanged) {
+          transceivers_[idx]->refresh();
+        } else {
+          transceivers_[idx]->refreshOnInterrupt();
+        }
+      } catch (const std::exception& ex) {
+        XLOG(ERR) << "Transceiver " << idx
+                  << ": Error refreshing after event: " << ex.what();
+      }
     }
   }
 }
 
-void WedgeManager::refreshTransceivers() {
+void WedgeManager::refreshBus(int bus) {
+  auto start = std::chrono::steady_clock::now();
+  auto& i2cBus = i2cBuses_[bus];
   try {
-    wedgeI2cBus_->verifyBus(false);
+    i2cBus.api->verifyBus(false);
   } catch (const std::exception& ex) {
-    XLOG(ERR) << "Error calling verifyBus(): " << ex.what();
+    XLOG(ERR) << "Error calling verifyBus() on I2C bus " << bus << ": "
+              << ex.what();
     return;
   }
 
   std::vector<folly::Future<folly::Unit>> futs;
-  XLOG(DBG2) << "Start refreshing all transceivers...";
-
-  for (const auto& transceiver : transceivers_) {
-    XLOG(DBG3) << "Fired to refresh transceiver " << transceiver->getID();
-    futs.push_back(transceiver->futureRefresh());
+  for (auto idx : i2cBus.qsfps) {
+    XLOG(DBG3) << "Fired to refresh transceiver " << idx;
+    futs.push_back(transceivers_[idx]->futureRefresh());
   }
-
   folly::collectAll(futs.begin(), futs.end()).wait();
-  XLOG(DBG2) << "Finished refreshing all transceivers";
+
+  auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - start);
+  XLOG(DBG2) << "Refreshed " << i2cBus.qsfps.size()
+             << " transceivers on I2C bus " << bus << " in "
+             << duration.count() << "ms";
+  StatsPublisher::busRefreshed(bus, duration);
 }
 
 std::unique_ptr<TransceiverI2CApi> WedgeManager::getI2CBus() {
@@ -1,6 +1,11 @@
 #pragma once
 
 #include <boost/container/flat_map.hpp>
+#include <folly/Synchronized.h>
+#include <folly/io/async/ScopedEventBaseThread.h>
+
+#include <memory>
+#include <mutex>
 
 #include "fboss/lib/usb/WedgeI2CBus.h"
 #include "fboss/qsfp_service/platforms/wedge/WedgeI2CBusLock.h"
@@ -22,6 +27,9 @@ class WedgeManager : public TransceiverManager {
     std::unique_ptr<std::vector<int32_t>> ids) override;
   void customizeTransceiver(int32_t idx, cfg::PortSpeed speed) override;
   void syncPorts(TransceiverMap& info, std::unique_ptr<PortMap> ports) override;
+  void getTransceiverInfoDelta(
+      TransceiverInfoDelta& delta,
+      int64_t sinceVersion) override;
 
   int getNumQsfpModules() override {
     return 16;
@@ -31,15 +39,73 @@ class WedgeManager : public TransceiverManager {
     return 4;
   }
   void refreshTransceivers() override;
+  void processTransceiverEvents() override;
 
  protected:
   virtual std::unique_ptr<TransceiverI2CApi> getI2CBus();
-  std::unique_ptr<TransceiverI2CApi>
-      wedgeI2cBus_; /* thread safe handle to access bus */
+
+  /*
+   * Platforms with more than one independent I2C controller can spread
+   * their QSFPs over several buses, which are then refreshed in parallel.
+   * By default there is one bus, from getI2CBus(), and the QSFPs are split
+   * over the buses in order, in equal sized groups.
+   */
+  virtual int getNumI2CBuses() const {
+    return 1;
+  }
+  virtual std::unique_ptr<TransceiverI2CApi> createI2CBus(int /*bus*/) {
+    return getI2CBus();
+  }
+  virtual int getI2CBusForQsfp(int idx) {
+    return idx * getNumI2CBuses() / getNumQsfpModules();
+  }
 
  private:
+  struct I2CBus {
+    /* thread safe handle to access bus */
+    std::unique_ptr<TransceiverI2CApi> api;
+    std::vector<int> qsfps;
+    // Only set with more than one bus, to refresh this bus's QSFPs on
+    std::unique_ptr<folly::ScopedEventBaseThread> refreshThread;
+    // Cleared once the bus turns out to have no module status registers
+    bool hasModuleStatus{true};
+    // Presence of each QSFP on the bus as of the last status read
+    std::map<int, bool> present;
+  };
+
   // Forbidden copy constructor and assignment operator
   WedgeManager(WedgeManager const &) = delete;
   WedgeManager& operator=(WedgeManager const &) = delete;
+
+  void refreshBus(int bus);
+
+  /*
+   * What getTransceiversInfo() serves from: each transceiver's info as of
+   * its last refresh, indexed by id, or null if it has none yet.  Snapshots
+   * are never modified once published, so readers only need to grab the
+   * pointer.
+   *
+   * The version goes up with every publish that changes a transceiver in a
+   * way getTransceiverInfoDelta() reports.  It starts from the time the
+   * manager was created, so versions handed out before a restart are always
+   * older than any handed out after it.
+   */
+  struct InfoSnapshot {
+    std::vector<std::shared_ptr<const TransceiverInfo>> infos;
+    // The version each transceiver last changed in
+    std::vector<int64_t> changedIn;
+    int64_t version{0};
+  };
+
+  // Refetch the info of the given transceivers, or of all of them, and
+  // publish a new snapshot
+  void publishTransceiverInfo(const std::vector<int32_t>& ids = {});
+  std::shared_ptr<const InfoSnapshot> getInfoSnapshot() const;
+
+  std::vector<I2CBus> i2cBuses_;
+  const int64_t firstVersion_;
+  // Serializes publishers, readers don't take it
+  std::mutex publishMutex_;
+  folly::Synchronized<std::shared_ptr<const InfoSnapshot>> infoSnapshot_;
 };
 }} // facebook::fboss
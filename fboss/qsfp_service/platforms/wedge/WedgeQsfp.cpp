@@ -32,6 +32,30 @@ WedgeQsfp::WedgeQsfp(int module, TransceiverI2CApi* wedgeI2CBus)
 WedgeQsfp::~WedgeQsfp() {
 }
 
+void WedgeQsfp::beginAccess() {
+  try {
+    threadSafeI2CBus_->beginModuleAccess(module_ + 1);
+    accessHeld_ = true;
+  } catch (const std::exception& ex) {
+    // Each access will select the module itself instead
+    XLOG(DBG2) << "Failed to select transceiver " << module_
+               << " for grouped access: " << ex.what();
+  }
+}
+
+void WedgeQsfp::endAccess() {
+  if (!accessHeld_) {
+    return;
+  }
+  accessHeld_ = false;
+  try {
+    threadSafeI2CBus_->endModuleAccess(module_ + 1);
+  } catch (const std::exception& ex) {
+    XLOG(ERR) << "Failed to unselect transceiver " << module_ << ": "
+              << ex.what();
+  }
+}
+
 // Note that the module_ starts at 0, but the I2C bus module
 // assumes that QSFP module numbers extend from 1 to 16.
 //
@@ -86,6 +86,9 @@ class WedgeQsfp : public TransceiverImpl {
   /* This function unset the reset status of Qsfp */
   void ensureOutOfReset() override;
 
+  void beginAccess() override;
+  void endAccess() override;
+
   /* Returns the name for the port */
   folly::StringPiece getName() override;
 
@@ -99,6 +102,7 @@ class WedgeQsfp : public TransceiverImpl {
   int module_;
   std::string moduleName_;
   TransceiverI2CApi* threadSafeI2CBus_;
+  bool accessHeld_{false};
   WedgeQsfpStats wedgeQsfpstats_;
 };
 
@@ -47,22 +47,90 @@ class WedgeManagerTest : public ::testing::Test {
 };
 
 TEST_F(WedgeManagerTest, getTransceiverInfo) {
-  // If no ids are passed in, info for all should be returned
+  // Info is fetched from each transceiver once per refresh
   for (const auto& trans : wedgeManager_->mockTransceivers_) {
-    EXPECT_CALL(*trans, getTransceiverInfo()).Times(1);
+    TransceiverInfo info;
+    info.present = true;
+    info.port = trans == wedgeManager_->mockTransceivers_[3] ? 3 : 0;
+    EXPECT_CALL(*trans, getTransceiverInfo()).WillOnce(Return(info));
   }
+  wedgeManager_->refreshTransceivers();
+
+  // ... and then served from the snapshot. If no ids are passed in, info
+  // for all should be returned
   std::map<int32_t, TransceiverInfo> transInfo;
   wedgeManager_->getTransceiversInfo(transInfo,
       std::make_unique<std::vector<int32_t>>());
+  EXPECT_EQ(wedgeManager_->getNumQsfpModules(), transInfo.size());
+  for (const auto& info : transInfo) {
+    EXPECT_TRUE(info.second.present);
+  }
 
   // Otherwise, just return the ids requested
+  transInfo.clear();
   std::vector<int32_t> data = {1, 3, 7};
-  for (const auto& i : data) {
-    MockQsfpModule* qsfp = wedgeManager_->mockTransceivers_[i];
-    EXPECT_CALL(*qsfp, getTransceiverInfo()).Times(1);
-  }
   wedgeManager_->getTransceiversInfo(transInfo,
       std::make_unique<std::vector<int32_t>>(data));
+  EXPECT_EQ(3, transInfo.size());
+  EXPECT_EQ(3, transInfo[3].port);
+}
+
+TEST_F(WedgeManagerTest, getTransceiverInfoBeforeRefresh) {
+  // Nothing published yet, so every transceiver is reported absent
+  for (const auto& trans : wedgeManager_->mockTransceivers_) {
+    EXPECT_CALL(*trans, getTransceiverInfo()).Times(0);
+  }
+  std::map<int32_t, TransceiverInfo> transInfo;
+  wedgeManager_->getTransceiversInfo(transInfo,
+      std::make_unique<std::vector<int32_t>>());
+  EXPECT_EQ(wedgeManager_->getNumQsfpModules(), transInfo.size());
+  for (const auto& info : transInfo) {
+    EXPECT_FALSE(info.second.present);
+  }
+}
+
+TEST_F(WedgeManagerTest, getTransceiverInfoDelta) {
+  auto& trans = wedgeManager_->mockTransceivers_;
+  TransceiverInfo info;
+  info.present = true;
+  info.__isset.sensor = true;
+  info.sensor_ref().value_unchecked().temp.value = 30;
+
+  // New sensor readings don't count as a change, losing the module does
+  auto warmer = info;
+  warmer.sensor_ref().value_unchecked().temp.value = 31;
+  auto removed = info;
+  removed.present = false;
+  for (int i = 0; i < static_cast<int>(trans.size()); ++i) {
+    auto second = i == 2 ? warmer : i == 5 ? removed : info;
+    EXPECT_CALL(*trans[i], getTransceiverInfo())
+        .WillOnce(Return(info))
+        .WillOnce(Return(second))
+        .WillOnce(Return(second));
+  }
+
+  wedgeManager_->refreshTransceivers();
+  TransceiverInfoDelta delta;
+  wedgeManager_->getTransceiverInfoDelta(delta, 0);
+  EXPECT_TRUE(delta.full);
+  EXPECT_EQ(wedgeManager_->getNumQsfpModules(), delta.changed.size());
+  auto version = delta.version;
+
+  wedgeManager_->refreshTransceivers();
+  delta = TransceiverInfoDelta();
+  wedgeManager_->getTransceiverInfoDelta(delta, version);
+  EXPECT_FALSE(delta.full);
+  EXPECT_GT(delta.version, version);
+  ASSERT_EQ(1, delta.changed.size());
+  EXPECT_FALSE(delta.changed.at(5).present);
+
+  // Nothing changed since then
+  version = delta.version;
+  wedgeManager_->refreshTransceivers();
+  delta = TransceiverInfoDelta();
+  wedgeManager_->getTransceiverInfoDelta(delta, version);
+  EXPECT_EQ(version, delta.version);
+  EXPECT_TRUE(delta.changed.empty());
 }
 
 }
@@ -10,6 +10,8 @@
 #include "QsfpModule.h"
 
 #include <boost/assign.hpp>
+#include <algorithm>
+#include <cstring>
 #include <string>
 #include <iomanip>
 #include "fboss/agent/FbossError.h"
@@ -18,14 +20,20 @@
 #include "fboss/qsfp_service/StatsPublisher.h"
 #include "fboss/lib/usb/TransceiverI2CApi.h"
 
+#include <folly/ScopeGuard.h>
 #include <folly/io/IOBuf.h>
 #include <folly/io/async/EventBase.h>
 #include <folly/logging/xlog.h>
 
 DEFINE_int32(
     qsfp_data_refresh_interval,
-    10,
+    30,
     "how often to refetch qsfp data that changes frequently");
+DEFINE_int32(
+    qsfp_flags_refresh_interval,
+    5,
+    "how often to poll the qsfp status and interrupt flags between refetches "
+    "of the rest of the qsfp data. Raised flags trigger an immediate refetch");
 DEFINE_int32(
     customize_interval,
     30,
@@ -53,7 +61,7 @@ constexpr int kUsecBetweenPowerModeFlap = 100000;
 namespace facebook { namespace fboss {
 
 // As per SFF-8636
-static SffFieldInfo::SffFieldMap qsfpFields = {
+constexpr SffFieldLayout::Entry kQsfpFieldEntries[] = {
   // Base page values, including alarms and sensors
   {SffField::IDENTIFIER, {QsfpPages::LOWER, 0, 1} },
   {SffField::STATUS, {QsfpPages::LOWER, 1, 2} },
@@ -106,6 +114,8 @@ static SffFieldInfo::SffFieldMap qsfpFields = {
   {SffField::TX_BIAS_THRESH, {QsfpPages::PAGE3, 184, 8} },
 };
 
+constexpr SffFieldLayout qsfpFields(kQsfpFieldEntries);
+
 static SffFieldMultiplier qsfpMultiplier = {
   {SffField::LENGTH_SM_KM, 1000},
   {SffField::LENGTH_OM3, 2},
@@ -117,7 +127,7 @@ static SffFieldMultiplier qsfpMultiplier = {
 
 void getQsfpFieldAddress(SffField field, int &dataAddress,
                          int &offset, int &length) {
-  auto info = SffFieldInfo::getSffFieldAddress(qsfpFields, field);
+  const auto& info = qsfpFields.getSffFieldAddress(field);
   dataAddress = info.dataAddress;
   offset = info.offset;
   length = info.length;
@@ -174,7 +184,7 @@ double QsfpModule::getQsfpDACLength() const {
 }
 
 int QsfpModule::getQsfpDACGauge() const {
-  auto info = SffFieldInfo::getSffFieldAddress(qsfpFields, SffField::DAC_GAUGE);
+  const auto& info = qsfpFields.getSffFieldAddress(SffField::DAC_GAUGE);
   const uint8_t *val = getQsfpValuePtr(info.dataAddress,
                                        info.offset, info.length);
   //Guard against FF default value
@@ -403,9 +413,30 @@ PowerControlState QsfpModule::getPowerControlValue() {
  */
 
 bool QsfpModule::getSensorsPerChanInfo(std::vector<Channel>& channels) {
-  int offset;
-  int length;
-  int dataAddress;
+  // All of these are in the lower page, so they are decoded from it in one
+  // pass, at offsets fixed at compile time
+  constexpr auto rxPwrAlarms = qsfpFields[SffField::CHANNEL_RX_PWR_ALARMS];
+  constexpr auto txBiasAlarms = qsfpFields[SffField::CHANNEL_TX_BIAS_ALARMS];
+  constexpr auto txPwrAlarms = qsfpFields[SffField::CHANNEL_TX_PWR_ALARMS];
+  constexpr auto rxPwr = qsfpFields[SffField::CHANNEL_RX_PWR];
+  constexpr auto txBias = qsfpFields[SffField::CHANNEL_TX_BIAS];
+  constexpr auto txPwr = qsfpFields[SffField::CHANNEL_TX_PWR];
+  static_assert(
+      rxPwrAlarms.dataAddress == QsfpPages::LOWER &&
+          txBiasAlarms.dataAddress == QsfpPages::LOWER &&
+          txPwrAlarms.dataAddress == QsfpPages::LOWER &&
+          rxPwr.dataAddress == QsfpPages::LOWER &&
+          txBias.dataAddress == QsfpPages::LOWER &&
+          txPwr.dataAddress == QsfpPages::LOWER,
+      "Per channel sensors are expected in the lower page");
+  static_assert(
+      rxPwr.length >= 2 * CHANNEL_COUNT &&
+          txBias.length >= 2 * CHANNEL_COUNT &&
+          txPwr.length >= 2 * CHANNEL_COUNT,
+      "Per channel sensors are two bytes per channel");
+
+  const uint8_t* lower =
+      getQsfpValuePtr(QsfpPages::LOWER, 0, MAX_QSFP_PAGE_SIZE);
 
   /*
    * Interestingly enough, the QSFP stores the four alarm flags
@@ -419,73 +450,30 @@ bool QsfpModule::getSensorsPerChanInfo(std::vector<Channel>& channels) {
    */
   int bitOffset[] = {4, 0, 4, 0};
   int byteOffset[] = {0, 0, 1, 1};
-
-  getQsfpFieldAddress(SffField::CHANNEL_RX_PWR_ALARMS, dataAddress,
-                      offset, length);
-  const uint8_t *data = getQsfpValuePtr(dataAddress, offset, length);
-
-  for (int channel = 0; channel < CHANNEL_COUNT; channel++) {
-    channels[channel].sensors.rxPwr.flags_ref().value_unchecked() =
-        getQsfpFlags(data + byteOffset[channel], bitOffset[channel]);
-    channels[channel].sensors.rxPwr.__isset.flags = true;
-  }
-
-  getQsfpFieldAddress(SffField::CHANNEL_TX_BIAS_ALARMS, dataAddress,
-                      offset, length);
-  data = getQsfpValuePtr(dataAddress, offset, length);
-
-  for (int channel = 0; channel < CHANNEL_COUNT; channel++) {
-    channels[channel].sensors.txBias.flags_ref().value_unchecked() =
-        getQsfpFlags(data + byteOffset[channel], bitOffset[channel]);
-    channels[channel].sensors.txBias.__isset.flags = true;
-  }
-
-  getQsfpFieldAddress(SffField::CHANNEL_TX_PWR_ALARMS, dataAddress,
-                      offset, length);
-  data = getQsfpValuePtr(dataAddress, offset, length);
+  auto sensorValue = [lower](const SffFieldInfo& field, int channel) {
+    const uint8_t* data = lower + field.offset + 2 * channel;
+    return static_cast<uint16_t>(data[0] << 8 | data[1]);
+  };
 
   for (int channel = 0; channel < CHANNEL_COUNT; channel++) {
-    channels[channel].sensors.txPwr.flags_ref().value_unchecked() =
-        getQsfpFlags(data + byteOffset[channel], bitOffset[channel]);
-    channels[channel].sensors.txPwr.__isset.flags = true;
+    auto& sensors = channels[channel].sensors;
+    auto flagsAt = [&](const SffFieldInfo& field) {
+      return getQsfpFlags(
+          lower + field.offset + byteOffset[channel], bitOffset[channel]);
+    };
+    sensors.rxPwr.flags_ref().value_unchecked() = flagsAt(rxPwrAlarms);
+    sensors.rxPwr.__isset.flags = true;
+    sensors.txBias.flags_ref().value_unchecked() = flagsAt(txBiasAlarms);
+    sensors.txBias.__isset.flags = true;
+    sensors.txPwr.flags_ref().value_unchecked() = flagsAt(txPwrAlarms);
+    sensors.txPwr.__isset.flags = true;
+
+    sensors.rxPwr.value = SffFieldInfo::getPwr(sensorValue(rxPwr, channel));
+    sensors.txBias.value =
+        SffFieldInfo::getTxBias(sensorValue(txBias, channel));
+    sensors.txPwr.value = SffFieldInfo::getPwr(sensorValue(txPwr, channel));
   }
 
-
-  getQsfpFieldAddress(SffField::CHANNEL_RX_PWR, dataAddress,
-                      offset, length);
-  data = getQsfpValuePtr(dataAddress, offset, length);
-
-  for (auto& channel : channels) {
-    uint16_t value = data[0] << 8 | data[1];
-    channel.sensors.rxPwr.value = SffFieldInfo::getPwr(value);
-    data += 2;
-    length--;
-  }
-  CHECK_GE(length, 0);
-
-  getQsfpFieldAddress(SffField::CHANNEL_TX_BIAS, dataAddress,
-                      offset, length);
-  data = getQsfpValuePtr(dataAddress, offset, length);
-  for (auto& channel : channels) {
-    uint16_t value = data[0] << 8 | data[1];
-    channel.sensors.txBias.value = SffFieldInfo::getTxBias(value);
-    data += 2;
-    length--;
-  }
-  CHECK_GE(length, 0);
-
-  getQsfpFieldAddress(SffField::CHANNEL_TX_PWR, dataAddress,
-                      offset, length);
-  data = getQsfpValuePtr(dataAddress, offset, length);
-
-  for (auto& channel : channels) {
-    uint16_t value = data[0] << 8 | data[1];
-    channel.sensors.txPwr.value = SffFieldInfo::getPwr(value);
-    data += 2;
-    length--;
-  }
-  CHECK_GE(length, 0);
-
   return true;
 }
 
@@ -508,7 +496,7 @@ std::string QsfpModule::getQsfpString(SffField field) const {
 double QsfpModule::getQsfpSensor(SffField field,
     double (*conversion)(uint16_t value)) {
 
-  auto info = SffFieldInfo::getSffFieldAddress(qsfpFields, field);
+  const auto& info = qsfpFields.getSffFieldAddress(field);
   const uint8_t *data = getQsfpValuePtr(info.dataAddress,
                                         info.offset, info.length);
   return conversion(data[0] << 8 | data[1]);
@@ -525,7 +513,7 @@ double QsfpModule::getQsfpSensor(SffField field,
  */
 double QsfpModule::getQsfpCableLength(SffField field) const {
   double length;
-  auto info = SffFieldInfo::getSffFieldAddress(qsfpFields, field);
+  const auto& info = qsfpFields.getSffFieldAddress(field);
   const uint8_t *data = getQsfpValuePtr(info.dataAddress,
                                         info.offset, info.length);
   auto multiplier = qsfpMultiplier.at(field);
@@ -538,8 +526,8 @@ double QsfpModule::getQsfpCableLength(SffField field) const {
 }
 
 TransmitterTechnology QsfpModule::getQsfpTransmitterTechnology() const {
-  auto info = SffFieldInfo::getSffFieldAddress(qsfpFields,
-      SffField::DEVICE_TECHNOLOGY);
+  const auto& info =
+      qsfpFields.getSffFieldAddress(SffField::DEVICE_TECHNOLOGY);
   const uint8_t* data =
       getQsfpValuePtr(info.dataAddress, info.offset, info.length);
 
@@ -645,10 +633,12 @@ bool QsfpModule::detectPresenceLocked() {
                << " QSFP status changed to " << currentQsfpStatus;
     dirty_ = true;
     present_ = currentQsfpStatus;
+    staticPageRetries_ = 0;
 
     // If a transceiver went from present to missing, clear the cached data.
     if (!present_) {
       info_.wlock()->reset();
+      *rawDOMData_.wlock() = RawDOMData();
     }
   }
   return currentQsfpStatus;
@@ -697,16 +687,8 @@ TransceiverInfo QsfpModule::parseDataLocked() {
 }
 
 RawDOMData QsfpModule::getRawDOMData() {
-  lock_guard<std::mutex> g(qsfpModuleMutex_);
-  RawDOMData data;
-  if (present_) {
-    data.lower = IOBuf::wrapBufferAsValue(lowerPage_, MAX_QSFP_PAGE_SIZE);
-    data.page0 = IOBuf::wrapBufferAsValue(page0_, MAX_QSFP_PAGE_SIZE);
-    if (!flatMem_) {
-      data.page3_ref() = IOBuf::wrapBufferAsValue(page3_, MAX_QSFP_PAGE_SIZE);
-    }
-  }
-  return data;
+  // Copying the IOBufs only bumps the refcount of the shared pages
+  return rawDOMData_.copy();
 }
 
 bool QsfpModule::safeToCustomize() const {
@@ -812,6 +794,13 @@ void QsfpModule::refresh() {
   refreshLocked();
 }
 
+void QsfpModule::refreshOnInterrupt() {
+  lock_guard<std::mutex> g(qsfpModuleMutex_);
+  // Poll the flags now; if any are latched that refetches the lower page
+  lastFlagsRefreshTime_ = 0;
+  refreshLocked();
+}
+
 folly::Future<folly::Unit> QsfpModule::futureRefresh() {
   auto i2cEvb = qsfpImpl_->getI2cEventBase();
   if (!i2cEvb) {
@@ -835,17 +824,40 @@ folly::Future<folly::Unit> QsfpModule::futureRefresh() {
 }
 
 void QsfpModule::refreshLocked() {
+  // Keep the module selected for the whole refresh
+  qsfpImpl_->beginAccess();
+  SCOPE_EXIT {
+    qsfpImpl_->endAccess();
+  };
+
   detectPresenceLocked();
 
   auto customizeWanted = customizationWanted(FLAGS_customize_interval);
   auto willRefresh = !dirty_ && shouldRefresh(FLAGS_qsfp_data_refresh_interval);
-  if (!dirty_ && !customizeWanted && !willRefresh) {
+
+  // Between refetches of the lower page, only poll its flags, which are
+  // much cheaper to read. Raised flags mean something changed, so then
+  // refetch the rest of the lower page straight away.
+  uint8_t flags[FLAGS_LENGTH];
+  auto polledFlags = present_ && !dirty_ && !customizeWanted && !willRefresh &&
+      std::time(nullptr) - lastFlagsRefreshTime_ >=
+          FLAGS_qsfp_flags_refresh_interval;
+  if (polledFlags) {
+    willRefresh = updateQsfpFlags(flags);
+  }
+
+  // Static pages only need fetching again if the module changed, or they
+  // failed their checksum
+  auto staticPagesWanted = dirty_ || (staticPagesStale_ && willRefresh);
+  if (!staticPagesWanted && !customizeWanted && !willRefresh) {
     return;
   }
 
-  if (dirty_) {
-    // make sure data is up to date before trying to customize.
-    ensureOutOfReset();
+  if (staticPagesWanted) {
+    if (dirty_) {
+      // make sure data is up to date before trying to customize.
+      ensureOutOfReset();
+    }
     updateQsfpData(true);
   }
 
@@ -863,8 +875,26 @@ void QsfpModule::refreshLocked() {
     updateQsfpData(false);
   }
 
+  if (polledFlags && !dirty_) {
+    // The interrupt flags clear when read, so keep the ones the poll saw
+    for (int i = LATCHED_FLAGS_OFFSET; i < FLAGS_LENGTH; ++i) {
+      lowerPage_[i] |= flags[i];
+    }
+  }
+
   // assign
   info_.wlock()->assign(parseDataLocked());
+  publishRawDOMDataLocked();
+}
+
+void QsfpModule::publishRawDOMDataLocked() {
+  RawDOMData data;
+  data.lower = IOBuf::copyBufferAsValue(lowerPage_, MAX_QSFP_PAGE_SIZE);
+  data.page0 = IOBuf::copyBufferAsValue(page0_, MAX_QSFP_PAGE_SIZE);
+  if (!flatMem_) {
+    data.page3_ref() = IOBuf::copyBufferAsValue(page3_, MAX_QSFP_PAGE_SIZE);
+  }
+  *rawDOMData_.wlock() = std::move(data);
 }
 
 void QsfpModule::getFieldValue(SffField fieldName,
@@ -889,6 +919,7 @@ void QsfpModule::updateQsfpData(bool allPages) {
     qsfpImpl_->readTransceiver(TransceiverI2CApi::ADDR_QSFP, 0,
         sizeof(lowerPage_), lowerPage_);
     lastRefreshTime_ = std::time(nullptr);
+    lastFlagsRefreshTime_ = lastRefreshTime_;
     dirty_ = false;
     setQsfpIdprom();
 
@@ -916,6 +947,17 @@ void QsfpModule::updateQsfpData(bool allPages) {
       qsfpImpl_->readTransceiver(TransceiverI2CApi::ADDR_QSFP, 128,
           sizeof(page3_), page3_);
     }
+
+    if (staticPagesChecksumValid()) {
+      staticPagesStale_ = false;
+      staticPageRetries_ = 0;
+    } else {
+      // Some modules ship with bad checksums, so don't retry forever
+      staticPagesStale_ = ++staticPageRetries_ <= MAX_STATIC_PAGE_RETRIES;
+      XLOG(WARN) << "Static page checksum mismatch for transceiver "
+                 << folly::to<std::string>(qsfpImpl_->getName())
+                 << (staticPagesStale_ ? ", will refetch" : ", giving up");
+    }
   } catch (const std::exception& ex) {
     // No matter what kind of exception throws, we need to set the dirty_ flag
     // to true.
@@ -927,6 +969,43 @@ void QsfpModule::updateQsfpData(bool allPages) {
   }
 }
 
+bool QsfpModule::updateQsfpFlags(uint8_t* flags) {
+  // expects the lock to be held
+  try {
+    qsfpImpl_->readTransceiver(
+        TransceiverI2CApi::ADDR_QSFP, 0, FLAGS_LENGTH, flags);
+  } catch (const std::exception& ex) {
+    dirty_ = true;
+    XLOG(ERR) << "Error reading flags for transceiver:"
+              << folly::to<std::string>(qsfpImpl_->getName()) << ": "
+              << ex.what();
+    throw;
+  }
+  lastFlagsRefreshTime_ = std::time(nullptr);
+
+  if (std::memcmp(flags, lowerPage_, FLAGS_LENGTH) != 0) {
+    return true;
+  }
+  return std::any_of(
+      flags + LATCHED_FLAGS_OFFSET, flags + FLAGS_LENGTH, [](uint8_t flag) {
+        return flag != 0;
+      });
+}
+
+bool QsfpModule::staticPagesChecksumValid() const {
+  // CC_BASE (byte 191) covers bytes 128-190, and CC_EXT (byte 223) covers
+  // bytes 192-222, each as the low 8 bits of their sum
+  auto checksum = [this](int begin, int end) {
+    uint8_t sum = 0;
+    for (int i = begin; i < end; ++i) {
+      sum += page0_[i - MAX_QSFP_PAGE_SIZE];
+    }
+    return sum;
+  };
+  return checksum(128, 191) == page0_[191 - MAX_QSFP_PAGE_SIZE] &&
+      checksum(192, 223) == page0_[223 - MAX_QSFP_PAGE_SIZE];
+}
+
 void QsfpModule::customizeTransceiver(cfg::PortSpeed speed) {
   lock_guard<std::mutex> g(qsfpModuleMutex_);
   if (present_) {
@@ -1065,17 +1144,18 @@ void QsfpModule::setRateSelectIfSupported(cfg::PortSpeed speed,
     return;
   }
 
-  int dataLength, dataAddress, dataOffset;
+  int dataLength, rxAddress, rxOffset, txAddress, txOffset;
 
-  getQsfpFieldAddress(SffField::RATE_SELECT_RX, dataAddress,
-                      dataOffset, dataLength);
-  qsfpImpl_->writeTransceiver(TransceiverI2CApi::ADDR_QSFP,
-      dataOffset, sizeof(value), &value);
-
-  getQsfpFieldAddress(SffField::RATE_SELECT_RX, dataAddress,
-                      dataOffset, dataLength);
+  // The rx and tx rate select bytes are next to each other, so set both
+  // with a single write
+  getQsfpFieldAddress(SffField::RATE_SELECT_RX, rxAddress,
+                      rxOffset, dataLength);
+  getQsfpFieldAddress(SffField::RATE_SELECT_TX, txAddress,
+                      txOffset, dataLength);
+  CHECK_EQ(txOffset, rxOffset + 1);
+  std::array<uint8_t, 2> buf = {{value, value}};
   qsfpImpl_->writeTransceiver(TransceiverI2CApi::ADDR_QSFP,
-      dataOffset, sizeof(value), &value);
+      rxOffset, buf.size(), buf.data());
   XLOG(INFO) << "Port: " << folly::to<std::string>(qsfpImpl_->getName())
              << " set rate select to "
              << _RateSelectSetting_VALUES_TO_NAMES.find(newSetting)->second;
@@ -86,9 +86,11 @@ class QsfpModule : public Transceiver {
 
   bool detectPresenceLocked();
   TransceiverInfo parseDataLocked();
+  void publishRawDOMDataLocked();
 
   virtual void refresh() override;
   folly::Future<folly::Unit> futureRefresh() override;
+  void refreshOnInterrupt() override;
   void refreshLocked();
 
   /*
@@ -138,6 +140,11 @@ class QsfpModule : public Transceiver {
     MAX_GAUGE = 30,
     DECIMAL_BASE = 10,
     HEX_BASE = 16,
+    // The status and latched interrupt flags at the start of the lower page
+    FLAGS_LENGTH = 22,
+    LATCHED_FLAGS_OFFSET = 3,
+    // Times to refetch the static pages when their checksums don't match
+    MAX_STATIC_PAGE_RETRIES = 3,
   };
   // QSFP+ requires a bottom 128 byte page describing important monitoring
   // information, and then an upper 128 byte page with less frequently
@@ -158,8 +165,18 @@ class QsfpModule : public Transceiver {
   bool flatMem_{false};
   // This transceiver needs customization
   bool needsCustomization_{false};
+  // The static pages failed their checksum, and should be fetched again
+  bool staticPagesStale_{false};
+  int staticPageRetries_{0};
 
   folly::Synchronized<folly::Optional<TransceiverInfo>> info_;
+  /*
+   * The cached pages as of the last refresh, copied once per refresh into
+   * IOBufs that are never written again. getRawDOMData() hands out clones
+   * that share them, so it neither copies the pages nor takes
+   * qsfpModuleMutex_.
+   */
+  folly::Synchronized<RawDOMData> rawDOMData_;
   /*
    * qsfpModuleMutex_ is held around all the read and writes to the qsfpModule
    *
@@ -174,6 +191,7 @@ class QsfpModule : public Transceiver {
    * too frequently. These MUST be accessed holding qsfpModuleMutex_.
    */
   time_t lastRefreshTime_{0};
+  time_t lastFlagsRefreshTime_{0};
   time_t lastCustomizeTime_{0};
   time_t lastTxEnable_{0};
   time_t lastPowerClassReset_{0};
@@ -321,6 +339,17 @@ class QsfpModule : public Transceiver {
    * there is not much point in refreshing static data on other pages.
    */
   virtual void updateQsfpData(bool allPages = true);
+  /*
+   * Only read the status and latched interrupt flags at the start of the
+   * lower page, into flags.  Returns true if any flag is raised, or the
+   * flags differ from the cached ones, so the rest of the lower page should
+   * be fetched too.
+   */
+  bool updateQsfpFlags(uint8_t* flags);
+  /*
+   * Whether the cached page 0 matches its base and extended checksums.
+   */
+  bool staticPagesChecksumValid() const;
 
  private:
   /*
@@ -53,13 +53,13 @@ FeatureState SffFieldInfo::getFeatureState(const uint8_t support,
   return enabled ? FeatureState::ENABLED : FeatureState::DISABLED;
 }
 
-SffFieldInfo SffFieldInfo::getSffFieldAddress(const SffFieldMap& map,
-                                              const SffField field) {
-  auto info = map.find(field);
-  if (info == map.end()) {
+const SffFieldInfo& SffFieldLayout::getSffFieldAddress(
+    const SffField field) const {
+  const auto& info = (*this)[field];
+  if (info.length == 0) {
     throw FbossError("Invalid SFF Field ID");
   }
-  return info->second;
+  return info;
 }
 
 
@@ -5,6 +5,7 @@
  * of patent rights can be found in the PATENTS file in the same directory.
  */
 #pragma once
+#include <cstddef>
 #include <cstdint>
 #include <map>
 
@@ -97,8 +98,12 @@ enum class SffField {
   VENDOR_MEM_ADDRESS, // Vendor Specific memory address
   USER_EEPROM, // User Writable NVM
   VENDOR_CONTROL, // Vendor Specific Control
+  // Must stay last, see kNumSffFields
 };
 
+constexpr std::size_t kNumSffFields =
+    static_cast<std::size_t>(SffField::VENDOR_CONTROL) + 1;
+
 enum DeviceTechnology : uint8_t {
   TRANSMITTER_TECH_SHIFT = 4,
   OPTICAL_MAX_VALUE = 0b1001,
@@ -180,15 +185,42 @@ class SffFieldInfo {
   // Render result as a member of FeatureState enum
   static FeatureState getFeatureState(uint8_t support, uint8_t enabled = 1);
 
-  typedef std::map<SffField, SffFieldInfo> SffFieldMap;
+};
+
+/*
+ * Where each field of a transceiver type lives, indexed by SffField.  It is
+ * built at compile time from the list of fields the type has, so looking a
+ * field up is an array index, and decoders can take the offsets of the
+ * fields they read as constants.  Fields not in the list have length 0.
+ */
+class SffFieldLayout {
+ public:
+  struct Entry {
+    SffField field;
+    SffFieldInfo info;
+  };
+
+  template <std::size_t N>
+  constexpr explicit SffFieldLayout(const Entry (&entries)[N]) : fields_{} {
+    for (std::size_t i = 0; i < N; ++i) {
+      fields_[static_cast<std::size_t>(entries[i].field)] = entries[i].info;
+    }
+  }
+
+  // Unchecked; for fields known to be in the layout
+  constexpr const SffFieldInfo& operator[](SffField field) const {
+    return fields_[static_cast<std::size_t>(field)];
+  }
 
   /*
-   * This function takes the SfpIDPromField name and returns
-   * the dataAddress, offset and the length as per the SFP DOM
-   * Document mentioned above.
+   * This function takes the SffField name and returns the dataAddress,
+   * offset and the length as per the SFF DOM Document mentioned above.
+   * Throws if the field isn't part of this layout.
    */
-  static SffFieldInfo getSffFieldAddress(const SffFieldMap& map,
-                                         SffField field);
+  const SffFieldInfo& getSffFieldAddress(SffField field) const;
+
+ private:
+  SffFieldInfo fields_[kNumSffFields];
 };
 
 // Store multipliers for various conversion functions:
@@ -47,6 +47,14 @@ class Transceiver {
   virtual void refresh() = 0;
   virtual folly::Future<folly::Unit> futureRefresh() = 0;
 
+  /*
+   * Refresh straight away because the transceiver raised its interrupt,
+   * rather than waiting for the usual refresh intervals.
+   */
+  virtual void refreshOnInterrupt() {
+    refresh();
+  }
+
   /*
    * Return all of the transceiver information
    */
@@ -46,6 +46,14 @@ class TransceiverImpl {
    */
   virtual void ensureOutOfReset(){};
 
+  /*
+   * Bracket a group of accesses, such as a whole refresh, so the
+   * implementation can keep the transceiver selected on the bus between
+   * them rather than selecting it for every read and write.
+   */
+  virtual void beginAccess() {}
+  virtual void endAccess() {}
+
   /*
    * Returns the name of the port
    */
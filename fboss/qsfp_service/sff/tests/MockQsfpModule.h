@@ -60,6 +60,9 @@ class MockQsfpModule : public QsfpModule {
   void setFlatMem() {
     flatMem_ = false;
   }
+  bool staticPagesStale() const {
+    return staticPagesStale_;
+  }
 
 
   void customizeTransceiver(cfg::PortSpeed speed) override {
@@ -90,14 +90,14 @@ TEST_F(QsfpModuleTest, setRateSelect) {
         RateSelectSetting::LESS_THAN_12GB);
     // 40G + LESS_THAN_12GB -> no change
     qsfp_->customizeTransceiver(cfg::PortSpeed::FORTYG);
-    // 100G + LESS_THAN_12GB -> needs change
-    EXPECT_CALL(*transImpl_, writeTransceiver(_, _, _, _)).Times(3);
+    // 100G + LESS_THAN_12GB -> needs change, rx and tx in one write
+    EXPECT_CALL(*transImpl_, writeTransceiver(_, _, _, _)).Times(2);
     qsfp_->customizeTransceiver(cfg::PortSpeed::HUNDREDG);
 
     qsfp_->setRateSelect(RateSelectState::EXTENDED_RATE_SELECT_V2,
         RateSelectSetting::FROM_24GB_to_26GB);
     // 40G + FROM_24GB_to_26GB -> needs change
-    EXPECT_CALL(*transImpl_, writeTransceiver(_, _, _, _)).Times(3);
+    EXPECT_CALL(*transImpl_, writeTransceiver(_, _, _, _)).Times(2);
     qsfp_->customizeTransceiver(cfg::PortSpeed::FORTYG);
     // 100G + FROM_24GB_to_26GB -> no change
     EXPECT_CALL(*transImpl_, writeTransceiver(_, _, _, _)).Times(1);
@@ -401,6 +401,28 @@ TEST_F(QsfpModuleTest, updateQsfpDataFull) {
   qsfp_->actualUpdateQsfpData(true);
 }
 
+TEST_F(QsfpModuleTest, updateQsfpDataBadChecksum) {
+  // Fill the upper pages with ones, which can't match their checksums
+  bool upperPagesValid = false;
+  ON_CALL(*transImpl_, readTransceiver(_, _, _, _)).
+    WillByDefault(Invoke([&](int, int offset, int len, uint8_t* buf) {
+      memset(buf, offset < 128 || upperPagesValid ? 0 : 1, len);
+      return len;
+    }));
+
+  // Refetched a limited number of times before giving up
+  for (int i = 0; i < 3; ++i) {
+    qsfp_->actualUpdateQsfpData(true);
+    EXPECT_TRUE(qsfp_->staticPagesStale());
+  }
+  qsfp_->actualUpdateQsfpData(true);
+  EXPECT_FALSE(qsfp_->staticPagesStale());
+
+  upperPagesValid = true;
+  qsfp_->actualUpdateQsfpData(true);
+  EXPECT_FALSE(qsfp_->staticPagesStale());
+}
+
 TEST_F(QsfpModuleTest, skipCustomizingMissingPorts) {
   // set present_ = false, dirty_ = true
   EXPECT_CALL(*transImpl_, detectTransceiver()).WillRepeatedly(Return(false));
@@ -9,12 +9,15 @@
  */
 
 #include <cstdint>
+#include <cstring>
 #include <folly/Conv.h>
 #include <folly/Memory.h>
 #include <gflags/gflags.h>
 #include <glog/logging.h>
+#include "fboss/agent/FbossError.h"
 #include "fboss/qsfp_service/sff/TransceiverImpl.h"
 #include "fboss/qsfp_service/sff/QsfpModule.h"
+#include "fboss/qsfp_service/sff/SffFieldInfo.h"
 
 #include <gtest/gtest.h>
 
@@ -225,6 +228,13 @@ TEST(SffTest, simpleRead) {
       info.channels[0].sensors.txBias.flags_ref().value_unchecked().alarm.low);
   EXPECT_FALSE(
       info.channels[1].sensors.txBias.flags_ref().value_unchecked().alarm.low);
+
+  // Raw pages are served from the snapshot taken at refresh
+  auto raw = qsfp->getRawDOMData();
+  ASSERT_EQ(kPageLower.size(), raw.lower.computeChainDataLength());
+  EXPECT_EQ(0, memcmp(kPageLower.data(), raw.lower.data(), kPageLower.size()));
+  auto again = qsfp->getRawDOMData();
+  EXPECT_EQ(raw.page0.data(), again.page0.data());
 }
 
 TEST(BadSffTest, simpleRead) {
@@ -237,4 +247,22 @@ TEST(BadSffTest, simpleRead) {
   EXPECT_THROW(qsfp->refresh(), QsfpModuleError);
 }
 
+TEST(SffTest, fieldLayout) {
+  int dataAddress, offset, length;
+  getQsfpFieldAddress(SffField::CHANNEL_RX_PWR, dataAddress, offset, length);
+  EXPECT_EQ(QsfpPages::LOWER, dataAddress);
+  EXPECT_EQ(34, offset);
+  EXPECT_EQ(8, length);
+  getQsfpFieldAddress(SffField::VENDOR_NAME, dataAddress, offset, length);
+  EXPECT_EQ(QsfpPages::PAGE0, dataAddress);
+  EXPECT_EQ(148, offset);
+  EXPECT_EQ(16, length);
+
+  // SFP only, so not in the QSFP layout
+  EXPECT_THROW(
+      getQsfpFieldAddress(
+          SffField::VENDOR_CONTROL, dataAddress, offset, length),
+      FbossError);
+}
+
 } // namespace facebook::fboss